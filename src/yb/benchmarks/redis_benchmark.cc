@@ -0,0 +1,541 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/benchmarks/redis_benchmark.h"
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/strings/numbers.h"
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/strings/substitute.h"
+
+#include "yb/redisserver/redis_server.h"
+
+#include "yb/util/enums.h"
+#include "yb/util/hdr_histogram.h"
+#include "yb/util/monotime.h"
+#include "yb/util/net/net_util.h"
+#include "yb/util/net/socket.h"
+#include "yb/util/random.h"
+#include "yb/util/random_util.h"
+
+DEFINE_int32(redis_benchmark_num_connections, 16,
+             "Number of connections to redis servers, each of them is served by its own thread. "
+             "Connections are distributed over target_redis_server_addresses round robin.");
+
+DEFINE_int32(redis_benchmark_pipeline_depth, 1,
+             "Number of commands sent by each connection before waiting for their responses.");
+
+DEFINE_int64(redis_benchmark_num_ops, 1000000, "Total number of commands to execute.");
+
+DEFINE_int32(redis_benchmark_duration_sec, 0,
+             "Stop the benchmark after this number of seconds, 0 for no time limit.");
+
+DEFINE_string(redis_benchmark_key_distribution, "uniform",
+              "Distribution of the accessed keys: uniform, zipfian or hotspot.");
+
+DEFINE_double(redis_benchmark_zipfian_theta, 0.99,
+              "Skew of the zipfian distribution, should be in (0, 1).");
+
+DEFINE_double(redis_benchmark_hot_key_fraction, 0.2,
+              "Fraction of keys that are hot for the hotspot distribution.");
+
+DEFINE_double(redis_benchmark_hot_op_fraction, 0.8,
+              "Fraction of operations that access hot keys for the hotspot distribution.");
+
+DEFINE_string(redis_benchmark_command_ratios, "get:50,set:50",
+              "Comma separated list of <command>:<weight> pairs that defines the command mix. "
+              "Supported commands are get, set, hset and tsadd.");
+
+DEFINE_int32(redis_benchmark_hash_fields, 16, "Number of fields in hashes modified by HSET.");
+
+DEFINE_int64(redis_benchmark_seed, 0,
+             "Seed of the random generators, so runs with the same flags issue the same commands.");
+
+DEFINE_string(redis_benchmark_hdr_output_prefix, "",
+              "When set, percentile distribution of latencies of each command, in microseconds, is "
+              "written to <prefix>.<command>.hgrm in the HdrHistogram text format.");
+
+DECLARE_int64(num_rows);
+DECLARE_int64(value_size_bytes);
+
+namespace yb {
+namespace benchmarks {
+
+namespace {
+
+// Latencies above this value, in microseconds, are recorded as this value.
+const uint64_t kMaxLatencyUs = 60 * 1000 * 1000;
+const int kHistogramSignificantDigits = 3;
+
+// Values are indexes in kCommandNames.
+enum class CommandType {
+  kGet,
+  kSet,
+  kHSet,
+  kTsAdd,
+};
+
+const char* const kCommandNames[] = {"get", "set", "hset", "tsadd"};
+
+const size_t kNumCommands = arraysize(kCommandNames);
+
+double Zeta(uint64_t n, double theta) {
+  double result = 0;
+  for (uint64_t i = 1; i <= n; ++i) {
+    result += 1 / std::pow(static_cast<double>(i), theta);
+  }
+  return result;
+}
+
+void AppendBulkString(const Slice& value, std::string* out) {
+  out->append("$");
+  out->append(std::to_string(value.size()));
+  out->append("\r\n");
+  out->append(value.cdata(), value.size());
+  out->append("\r\n");
+}
+
+void AppendCommand(std::initializer_list<Slice> args, std::string* out) {
+  out->append("*");
+  out->append(std::to_string(args.size()));
+  out->append("\r\n");
+  for (const auto& arg : args) {
+    AppendBulkString(arg, out);
+  }
+}
+
+// Skips the reply that starts at pos. Sets complete to false when the buffer does not contain
+// the whole reply yet, and error to true when the reply is or contains an error.
+Status SkipReply(const std::string& buffer, size_t* pos, bool* complete, bool* error) {
+  *complete = false;
+  if (*pos >= buffer.size()) {
+    return Status::OK();
+  }
+  const size_t line_end = buffer.find("\r\n", *pos);
+  if (line_end == std::string::npos) {
+    return Status::OK();
+  }
+  const char type = buffer[*pos];
+  const std::string line = buffer.substr(*pos + 1, line_end - *pos - 1);
+  size_t end = line_end + 2;
+  switch (type) {
+    case '-':
+      *error = true;
+      FALLTHROUGH_INTENDED;
+    case '+': FALLTHROUGH_INTENDED;
+    case ':':
+      break;
+    case '$': {
+      int64_t length = 0;
+      if (!safe_strto64(line, &length)) {
+        return STATUS_SUBSTITUTE(Corruption, "Bad bulk string length: $0", line);
+      }
+      if (length >= 0) {
+        end += length + 2;
+        if (end > buffer.size()) {
+          return Status::OK();
+        }
+      }
+      break;
+    }
+    case '*': {
+      int64_t count = 0;
+      if (!safe_strto64(line, &count)) {
+        return STATUS_SUBSTITUTE(Corruption, "Bad array length: $0", line);
+      }
+      for (int64_t i = 0; i < count; ++i) {
+        RETURN_NOT_OK(SkipReply(buffer, &end, complete, error));
+        if (!*complete) {
+          return Status::OK();
+        }
+      }
+      break;
+    }
+    default:
+      return STATUS_SUBSTITUTE(Corruption, "Unexpected reply type: $0", type);
+  }
+  *pos = end;
+  *complete = true;
+  return Status::OK();
+}
+
+class RedisBenchmark {
+ public:
+  RedisBenchmark(std::vector<Endpoint> endpoints,
+                 std::unique_ptr<KeyGenerator> key_generator,
+                 std::vector<uint32_t> command_weights)
+      : endpoints_(std::move(endpoints)),
+        key_generator_(std::move(key_generator)),
+        command_weights_(std::move(command_weights)) {
+    for (size_t i = 0; i != kNumCommands; ++i) {
+      histograms_.emplace_back(new HdrHistogram(kMaxLatencyUs, kHistogramSignificantDigits));
+    }
+    total_weight_ = 0;
+    for (auto weight : command_weights_) {
+      total_weight_ += weight;
+    }
+  }
+
+  CHECKED_STATUS Run() {
+    std::vector<std::thread> threads;
+    std::vector<Status> statuses(FLAGS_redis_benchmark_num_connections);
+    start_ = MonoTime::Now(MonoTime::FINE);
+    for (int i = 0; i != FLAGS_redis_benchmark_num_connections; ++i) {
+      threads.emplace_back([this, i, &statuses] {
+        statuses[i] = RunConnection(i);
+        if (!statuses[i].ok()) {
+          stop_.store(true, std::memory_order_release);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start_);
+    for (const auto& status : statuses) {
+      RETURN_NOT_OK(status);
+    }
+    Report(elapsed);
+    return Status::OK();
+  }
+
+ private:
+  // Reserves up to FLAGS_redis_benchmark_pipeline_depth commands for the next pipeline.
+  int64_t ReserveOps() {
+    if (stop_.load(std::memory_order_acquire)) {
+      return 0;
+    }
+    if (FLAGS_redis_benchmark_duration_sec > 0 &&
+        MonoTime::Now(MonoTime::FINE).GetDeltaSince(start_).ToSeconds() >=
+            FLAGS_redis_benchmark_duration_sec) {
+      stop_.store(true, std::memory_order_release);
+      return 0;
+    }
+    const int64_t depth = FLAGS_redis_benchmark_pipeline_depth;
+    auto reserved = reserved_ops_.fetch_add(depth, std::memory_order_acq_rel);
+    return std::max<int64_t>(0, std::min(depth, FLAGS_redis_benchmark_num_ops - reserved));
+  }
+
+  CommandType NextCommand(std::mt19937_64* rng) {
+    uint64_t value = std::uniform_int_distribution<uint64_t>(0, total_weight_ - 1)(*rng);
+    for (size_t i = 0; i != kNumCommands; ++i) {
+      if (value < command_weights_[i]) {
+        return static_cast<CommandType>(i);
+      }
+      value -= command_weights_[i];
+    }
+    LOG(FATAL) << "Command weights are out of range: " << value;
+    return CommandType::kGet;
+  }
+
+  void AppendNextCommand(CommandType type,
+                         const std::string& value,
+                         int64_t* timestamp,
+                         std::mt19937_64* rng,
+                         std::string* out) {
+    const std::string key = std::to_string(key_generator_->Next(rng));
+    switch (type) {
+      case CommandType::kGet:
+        AppendCommand({"GET", "key:" + key}, out);
+        return;
+      case CommandType::kSet:
+        AppendCommand({"SET", "key:" + key, value}, out);
+        return;
+      case CommandType::kHSet: {
+        const auto field = std::uniform_int_distribution<int32_t>(
+            0, FLAGS_redis_benchmark_hash_fields - 1)(*rng);
+        AppendCommand({"HSET", "hkey:" + key, "f" + std::to_string(field), value}, out);
+        return;
+      }
+      case CommandType::kTsAdd:
+        // Timestamps of different connections never collide, so each TSADD adds an entry.
+        *timestamp += FLAGS_redis_benchmark_num_connections;
+        AppendCommand({"TSADD", "tskey:" + key, std::to_string(*timestamp), value}, out);
+        return;
+    }
+    FATAL_INVALID_ENUM_VALUE(CommandType, type);
+  }
+
+  CHECKED_STATUS RunConnection(int idx) {
+    const auto& endpoint = endpoints_[idx % endpoints_.size()];
+    Socket socket;
+    RETURN_NOT_OK(socket.Init(0));
+    RETURN_NOT_OK(socket.SetNoDelay(true));
+    RETURN_NOT_OK(socket.Connect(endpoint));
+
+    std::mt19937_64 rng(FLAGS_redis_benchmark_seed + idx);
+    Random value_rng(static_cast<uint32_t>(FLAGS_redis_benchmark_seed + idx));
+    const std::string value = RandomHumanReadableString(FLAGS_value_size_bytes, &value_rng);
+    int64_t timestamp = idx;
+
+    std::string request;
+    std::vector<CommandType> types;
+    std::string buffer;
+    std::vector<uint8_t> read_buffer(64 * 1024);
+    for (;;) {
+      const auto num_ops = ReserveOps();
+      if (num_ops == 0) {
+        break;
+      }
+      request.clear();
+      types.clear();
+      for (int64_t i = 0; i != num_ops; ++i) {
+        types.push_back(NextCommand(&rng));
+        AppendNextCommand(types.back(), value, &timestamp, &rng, &request);
+      }
+
+      const auto start = MonoTime::Now(MonoTime::FINE);
+      size_t written = 0;
+      RETURN_NOT_OK(socket.BlockingWrite(
+          reinterpret_cast<const uint8_t*>(request.data()), request.size(), &written,
+          MonoTime::Max()));
+
+      size_t pos = 0;
+      for (auto type : types) {
+        bool complete = false;
+        bool error = false;
+        for (;;) {
+          size_t reply_pos = pos;
+          RETURN_NOT_OK(SkipReply(buffer, &reply_pos, &complete, &error));
+          if (complete) {
+            pos = reply_pos;
+            break;
+          }
+          int32_t read = 0;
+          RETURN_NOT_OK(socket.Recv(read_buffer.data(), read_buffer.size(), &read));
+          buffer.append(reinterpret_cast<const char*>(read_buffer.data()), read);
+        }
+        const auto latency = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+        histograms_[static_cast<size_t>(type)]->Increment(
+            std::min<uint64_t>(latency.ToMicroseconds(), kMaxLatencyUs));
+        if (error) {
+          errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      buffer.erase(0, pos);
+    }
+    return socket.Close();
+  }
+
+  void Report(const MonoDelta& elapsed) {
+    uint64_t total = 0;
+    for (size_t i = 0; i != kNumCommands; ++i) {
+      const auto& histogram = *histograms_[i];
+      if (histogram.TotalCount() == 0) {
+        continue;
+      }
+      total += histogram.TotalCount();
+      LOG(INFO) << strings::Substitute(
+          "$0: count=$1 mean=$2us p50=$3us p90=$4us p99=$5us p99.9=$6us max=$7us",
+          kCommandNames[i], histogram.TotalCount(), histogram.MeanValue(),
+          histogram.ValueAtPercentile(50), histogram.ValueAtPercentile(90),
+          histogram.ValueAtPercentile(99), histogram.ValueAtPercentile(99.9),
+          histogram.MaxValue());
+      if (!FLAGS_redis_benchmark_hdr_output_prefix.empty()) {
+        WritePercentileDistribution(
+            histogram,
+            FLAGS_redis_benchmark_hdr_output_prefix + "." + kCommandNames[i] + ".hgrm");
+      }
+    }
+    LOG(INFO) << strings::Substitute(
+        "Executed $0 commands in $1s, $2 ops/sec, $3 errors",
+        total, elapsed.ToSeconds(), total / std::max(elapsed.ToSeconds(), 1e-6),
+        errors_.load(std::memory_order_acquire));
+  }
+
+  void WritePercentileDistribution(const HdrHistogram& histogram, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+      LOG(ERROR) << "Failed to open " << path;
+      return;
+    }
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    PercentileIterator iter(&histogram, 5);
+    HistogramIterationValue value;
+    while (iter.HasNext()) {
+      if (!iter.Next(&value).ok()) {
+        break;
+      }
+      const double percentile = value.percentile_level_iterated_to / 100;
+      out << strings::Substitute(
+          "$0 $1 $2 $3\n", value.value_iterated_to, percentile, value.total_count_to_this_value,
+          percentile < 1 ? 1 / (1 - percentile) : std::numeric_limits<double>::infinity());
+    }
+    out << strings::Substitute(
+        "#[Mean = $0, Max = $1, Total count = $2]\n",
+        histogram.MeanValue(), histogram.MaxValue(), histogram.TotalCount());
+  }
+
+  const std::vector<Endpoint> endpoints_;
+  const std::unique_ptr<KeyGenerator> key_generator_;
+  const std::vector<uint32_t> command_weights_;
+  uint64_t total_weight_;
+  std::vector<std::unique_ptr<HdrHistogram>> histograms_;
+  MonoTime start_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int64_t> reserved_ops_{0};
+  std::atomic<uint64_t> errors_{0};
+};
+
+Status ParseCommandWeights(const std::string& ratios, std::vector<uint32_t>* weights) {
+  weights->assign(kNumCommands, 0);
+  uint64_t total = 0;
+  for (const std::string& entry : strings::Split(ratios, ",", strings::SkipEmpty())) {
+    std::vector<std::string> parts = strings::Split(entry, ":");
+    uint32_t weight = 0;
+    if (parts.size() != 2 || !safe_strtou32(parts[1], &weight)) {
+      return STATUS_SUBSTITUTE(InvalidArgument, "Bad command ratio: $0", entry);
+    }
+    auto it = std::find(std::begin(kCommandNames), std::end(kCommandNames), parts[0]);
+    if (it == std::end(kCommandNames)) {
+      return STATUS_SUBSTITUTE(InvalidArgument, "Unsupported command: $0", parts[0]);
+    }
+    (*weights)[it - std::begin(kCommandNames)] += weight;
+    total += weight;
+  }
+  if (total == 0) {
+    return STATUS_SUBSTITUTE(InvalidArgument, "No commands in ratios: $0", ratios);
+  }
+  return Status::OK();
+}
+
+} // namespace
+
+KeyGenerator::KeyGenerator(Distribution distribution, uint64_t num_keys, double zipfian_theta)
+    : distribution_(distribution), num_keys_(num_keys) {
+  switch (distribution_) {
+    case Distribution::kUniform:
+      break;
+    case Distribution::kZipfian: {
+      const double theta = zipfian_theta;
+      zipfian_theta_ = theta;
+      zipfian_alpha_ = 1 / (1 - theta);
+      zipfian_zetan_ = Zeta(num_keys_, theta);
+      zipfian_eta_ = (1 - std::pow(2.0 / num_keys_, 1 - theta)) /
+                     (1 - Zeta(2, theta) / zipfian_zetan_);
+      break;
+    }
+    case Distribution::kHotspot:
+      hot_keys_ = std::max<uint64_t>(1, num_keys_ * FLAGS_redis_benchmark_hot_key_fraction);
+      break;
+  }
+}
+
+Status KeyGenerator::Create(const std::string& distribution,
+                            uint64_t num_keys,
+                            double zipfian_theta,
+                            std::unique_ptr<KeyGenerator>* result) {
+  if (num_keys < 2) {
+    return STATUS_SUBSTITUTE(InvalidArgument, "Too few keys: $0", num_keys);
+  }
+  Distribution value;
+  if (distribution == "uniform") {
+    value = Distribution::kUniform;
+  } else if (distribution == "zipfian") {
+    if (zipfian_theta <= 0 || zipfian_theta >= 1) {
+      return STATUS_SUBSTITUTE(InvalidArgument, "Zipfian theta should be in (0, 1): $0",
+                               zipfian_theta);
+    }
+    value = Distribution::kZipfian;
+  } else if (distribution == "hotspot") {
+    if (FLAGS_redis_benchmark_hot_key_fraction <= 0 ||
+        FLAGS_redis_benchmark_hot_key_fraction > 1 ||
+        FLAGS_redis_benchmark_hot_op_fraction < 0 ||
+        FLAGS_redis_benchmark_hot_op_fraction > 1) {
+      return STATUS(InvalidArgument, "Hot key and op fractions should be in [0, 1]");
+    }
+    value = Distribution::kHotspot;
+  } else {
+    return STATUS_SUBSTITUTE(InvalidArgument, "Unknown key distribution: $0", distribution);
+  }
+  result->reset(new KeyGenerator(value, num_keys, zipfian_theta));
+  return Status::OK();
+}
+
+uint64_t KeyGenerator::Next(std::mt19937_64* rng) const {
+  switch (distribution_) {
+    case Distribution::kUniform:
+      return std::uniform_int_distribution<uint64_t>(0, num_keys_ - 1)(*rng);
+    case Distribution::kZipfian: {
+      // Algorithm from "Quickly Generating Billion-Record Synthetic Databases", Gray et al.
+      const double u = std::uniform_real_distribution<double>(0, 1)(*rng);
+      const double uz = u * zipfian_zetan_;
+      if (uz < 1) {
+        return 0;
+      }
+      if (uz < 1 + std::pow(0.5, zipfian_theta_)) {
+        return 1;
+      }
+      const auto result = static_cast<uint64_t>(
+          num_keys_ * std::pow(zipfian_eta_ * u - zipfian_eta_ + 1, zipfian_alpha_));
+      return std::min(result, num_keys_ - 1);
+    }
+    case Distribution::kHotspot:
+      if (std::uniform_real_distribution<double>(0, 1)(*rng) <
+              FLAGS_redis_benchmark_hot_op_fraction ||
+          hot_keys_ == num_keys_) {
+        return std::uniform_int_distribution<uint64_t>(0, hot_keys_ - 1)(*rng);
+      }
+      return std::uniform_int_distribution<uint64_t>(hot_keys_, num_keys_ - 1)(*rng);
+  }
+  FATAL_INVALID_ENUM_VALUE(Distribution, distribution_);
+}
+
+Status RunRedisBenchmark(const std::string& addresses) {
+  if (FLAGS_redis_benchmark_num_connections <= 0 || FLAGS_redis_benchmark_pipeline_depth <= 0) {
+    return STATUS(InvalidArgument, "Number of connections and pipeline depth should be positive");
+  }
+  std::vector<HostPort> host_ports;
+  RETURN_NOT_OK(HostPort::ParseStrings(
+      addresses, redisserver::RedisServer::kDefaultPort, &host_ports));
+  std::vector<Endpoint> endpoints;
+  for (const auto& host_port : host_ports) {
+    std::vector<Endpoint> resolved;
+    RETURN_NOT_OK(host_port.ResolveAddresses(&resolved));
+    if (resolved.empty()) {
+      return STATUS_SUBSTITUTE(NetworkError, "Failed to resolve $0", host_port.ToString());
+    }
+    endpoints.push_back(resolved.front());
+  }
+  if (endpoints.empty()) {
+    return STATUS(InvalidArgument, "No redis server addresses");
+  }
+
+  std::unique_ptr<KeyGenerator> key_generator;
+  RETURN_NOT_OK(KeyGenerator::Create(
+      FLAGS_redis_benchmark_key_distribution, FLAGS_num_rows, FLAGS_redis_benchmark_zipfian_theta,
+      &key_generator));
+  std::vector<uint32_t> command_weights;
+  RETURN_NOT_OK(ParseCommandWeights(FLAGS_redis_benchmark_command_ratios, &command_weights));
+
+  LOG(INFO) << "Running redis benchmark against " << addresses
+            << " with " << FLAGS_redis_benchmark_num_connections << " connections, pipeline depth "
+            << FLAGS_redis_benchmark_pipeline_depth << ", " << FLAGS_num_rows << " "
+            << FLAGS_redis_benchmark_key_distribution << " keys and command ratios "
+            << FLAGS_redis_benchmark_command_ratios;
+
+  RedisBenchmark benchmark(std::move(endpoints), std::move(key_generator),
+                           std::move(command_weights));
+  return benchmark.Run();
+}
+
+} // namespace benchmarks
+} // namespace yb
@@ -0,0 +1,69 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_BENCHMARKS_REDIS_BENCHMARK_H
+#define YB_BENCHMARKS_REDIS_BENCHMARK_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "yb/util/status.h"
+
+namespace yb {
+namespace benchmarks {
+
+// Picks indexes of keys in [0, num_keys) according to the configured distribution:
+//   uniform - all keys are equally likely.
+//   zipfian - popularity of the key with rank i is proportional to 1 / i^zipfian_theta, as in YCSB.
+//   hotspot - hot_op_fraction of the operations go to the first hot_key_fraction of the keys.
+class KeyGenerator {
+ public:
+  static CHECKED_STATUS Create(const std::string& distribution,
+                               uint64_t num_keys,
+                               double zipfian_theta,
+                               std::unique_ptr<KeyGenerator>* result);
+
+  uint64_t Next(std::mt19937_64* rng) const;
+
+ private:
+  enum class Distribution {
+    kUniform,
+    kZipfian,
+    kHotspot,
+  };
+
+  KeyGenerator(Distribution distribution, uint64_t num_keys, double zipfian_theta);
+
+  Distribution distribution_;
+  uint64_t num_keys_;
+
+  // Precomputed constants of the zipfian distribution.
+  double zipfian_theta_ = 0;
+  double zipfian_alpha_ = 0;
+  double zipfian_zetan_ = 0;
+  double zipfian_eta_ = 0;
+
+  uint64_t hot_keys_ = 0;
+};
+
+// Sends the mix of GET/SET/HSET/TSADD commands, encoded in the Redis protocol, directly to the
+// redis servers at comma separated host:port addresses. Each connection keeps the configured
+// number of commands in flight and latencies of them are reported as HDR histograms.
+CHECKED_STATUS RunRedisBenchmark(const std::string& addresses);
+
+} // namespace benchmarks
+} // namespace yb
+
+#endif // YB_BENCHMARKS_REDIS_BENCHMARK_H
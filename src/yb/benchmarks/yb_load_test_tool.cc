@@ -19,6 +19,8 @@
 #include <boost/bind.hpp>
 #include <boost/thread/mutex.hpp>
 
+#include "yb/benchmarks/redis_benchmark.h"
+#include "yb/benchmarks/ycsb_benchmark.h"
 #include "yb/client/client.h"
 #include "yb/redisserver/redis_constants.h"
 #include "yb/redisserver/redis_parser.h"
@@ -84,6 +86,16 @@ DEFINE_string(
     target_redis_server_addresses, "",
     "comma separated list of <host:port> addresses of the redis proxy server(s)");
 
+DEFINE_bool(
+    redis_benchmark, false,
+    "Benchmark redis servers at target_redis_server_addresses by sending them commands encoded "
+    "in the Redis protocol directly, see redis_benchmark_* flags. The redis table should exist.");
+
+DEFINE_bool(
+    ycsb_benchmark, false,
+    "Run a YCSB core workload against the cluster at load_test_master_addresses, see "
+    "ycsb_benchmark_* flags.");
+
 DEFINE_bool(create_redis_table_and_exit, false, "If true, create the redis table and exit.");
 
 DEFINE_bool(writes_only, false, "Writes a new set of rows into an existing table.");
@@ -161,7 +173,11 @@ int main(int argc, char *argv[]) {
       "Usage:\n"
       "    load_test_tool --load_test_master_endpoint http://<metamaster rest endpoint>\n"
       "    load_test_tool --load_test_master_addresses master1:port1,...,masterN:portN\n"
-      "    load_test_tool --target_redis_server_addresses proxy1:port1,...,proxyN:portN");
+      "    load_test_tool --target_redis_server_addresses proxy1:port1,...,proxyN:portN\n"
+      "    load_test_tool --redis_benchmark "
+      "--target_redis_server_addresses proxy1:port1,...,proxyN:portN\n"
+      "    load_test_tool --ycsb_benchmark --ycsb_benchmark_workload a "
+      "--load_test_master_addresses master1:port1,...,masterN:portN");
   yb::ParseCommandLineFlags(&argc, &argv, true);
   yb::InitGoogleLoggingSafe(argv[0]);
 
@@ -179,6 +195,28 @@ int main(int argc, char *argv[]) {
   if (!FLAGS_reads_only)
     LOG(INFO) << "num_keys = " << FLAGS_num_rows;
 
+  if (FLAGS_redis_benchmark) {
+    if (FLAGS_target_redis_server_addresses.empty()) {
+      LOG(FATAL) << "Redis benchmark requires target_redis_server_addresses.";
+    }
+    for (int i = 0; i < FLAGS_num_iter; ++i) {
+      CHECK_OK(yb::benchmarks::RunRedisBenchmark(FLAGS_target_redis_server_addresses));
+      LOG(INFO) << "Benchmark completed (iteration: " << i + 1 << " out of " << FLAGS_num_iter
+                << ")";
+    }
+    return 0;
+  }
+
+  if (FLAGS_ycsb_benchmark) {
+    shared_ptr<YBClient> client = CreateYBClient();
+    for (int i = 0; i < FLAGS_num_iter; ++i) {
+      CHECK_OK(yb::benchmarks::RunYcsbBenchmark(client.get()));
+      LOG(INFO) << "Benchmark completed (iteration: " << i + 1 << " out of " << FLAGS_num_iter
+                << ")";
+    }
+    return 0;
+  }
+
   for (int i = 0; i < FLAGS_num_iter; ++i) {
     if (!use_redis_table) {
       const YBTableName table_name("my_keyspace", FLAGS_table_name);
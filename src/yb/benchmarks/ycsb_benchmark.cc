@@ -0,0 +1,647 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/benchmarks/ycsb_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/benchmarks/redis_benchmark.h"
+
+#include "yb/client/client.h"
+#include "yb/client/yb_op.h"
+
+#include "yb/common/partition.h"
+#include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_type.h"
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/strings/substitute.h"
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/enums.h"
+#include "yb/util/hdr_histogram.h"
+#include "yb/util/jsonwriter.h"
+#include "yb/util/logging.h"
+#include "yb/util/monotime.h"
+#include "yb/util/random.h"
+#include "yb/util/random_util.h"
+
+DEFINE_string(ycsb_benchmark_workload, "a", "YCSB core workload to run: a, b, c, d, e or f.");
+
+DEFINE_string(ycsb_benchmark_table_name, "usertable",
+              "Name of the table in my_keyspace used by the YCSB benchmark.");
+
+DEFINE_bool(ycsb_benchmark_load, true,
+            "Create the table when it does not exist and insert ycsb_benchmark_record_count "
+            "records before running the workload.");
+
+DEFINE_int64(ycsb_benchmark_record_count, 1000000, "Number of records loaded into the table.");
+
+DEFINE_int64(ycsb_benchmark_operation_count, 1000000, "Number of operations to measure.");
+
+DEFINE_int32(ycsb_benchmark_duration_sec, 0,
+             "Stop measuring after this number of seconds, 0 for no time limit.");
+
+DEFINE_int32(ycsb_benchmark_warmup_sec, 10,
+             "Operations executed during this number of seconds after the start of the workload "
+             "are not measured.");
+
+DEFINE_int32(ycsb_benchmark_threads, 32,
+             "Number of client threads, each of them keeps one operation in flight.");
+
+DEFINE_string(ycsb_benchmark_request_distribution, "",
+              "Distribution of the accessed records: uniform, zipfian or latest. Empty for the "
+              "default of the workload, that is latest for workload d and zipfian for others.");
+
+DEFINE_double(ycsb_benchmark_zipfian_constant, 0.99,
+              "Skew of the zipfian and latest distributions, should be in (0, 1).");
+
+DEFINE_int32(ycsb_benchmark_field_count, 10,
+             "Number of fields of the records in the table created by the benchmark.");
+
+DEFINE_int32(ycsb_benchmark_field_length, 100, "Length of the values written to fields.");
+
+DEFINE_int32(ycsb_benchmark_max_scan_length, 100,
+             "Scans of workload e read a uniformly distributed number of records in "
+             "[1, ycsb_benchmark_max_scan_length].");
+
+DEFINE_int32(ycsb_benchmark_timeline_interval_ms, 1000,
+             "Interval between the samples of the throughput timeline.");
+
+DEFINE_string(ycsb_benchmark_json_output, "",
+              "When set, the settings, per operation latencies and throughput timeline of the run "
+              "are written to this file as JSON.");
+
+DEFINE_int64(ycsb_benchmark_seed, 0,
+             "Seed of the random generators, so runs with the same flags issue the same "
+             "operations.");
+
+DECLARE_int32(num_replicas);
+DECLARE_int32(num_tablets);
+DECLARE_int32(rpc_timeout_sec);
+
+namespace yb {
+namespace benchmarks {
+
+namespace {
+
+// Latencies above this value, in microseconds, are recorded as this value.
+const uint64_t kMaxLatencyUs = 60 * 1000 * 1000;
+const int kHistogramSignificantDigits = 3;
+
+const char* const kKeyspace = "my_keyspace";
+const char* const kKeyColumn = "ycsb_key";
+
+// Values are indexes in kOperationNames.
+enum class OperationType {
+  kRead,
+  kUpdate,
+  kInsert,
+  kScan,
+  kReadModifyWrite,
+};
+
+const char* const kOperationNames[] = {"read", "update", "insert", "scan", "read_modify_write"};
+
+const size_t kNumOperations = arraysize(kOperationNames);
+
+struct Workload {
+  char name;
+  // Proportions of operations, in the kOperationNames order.
+  double proportions[kNumOperations];
+  const char* distribution;
+};
+
+// The core workloads as defined in workloads/workload[a-f] of YCSB.
+const Workload kWorkloads[] = {
+  {'a', {0.5, 0.5, 0, 0, 0}, "zipfian"},     // Update heavy.
+  {'b', {0.95, 0.05, 0, 0, 0}, "zipfian"},   // Read mostly.
+  {'c', {1, 0, 0, 0, 0}, "zipfian"},         // Read only.
+  {'d', {0.95, 0, 0.05, 0, 0}, "latest"},    // Read latest.
+  {'e', {0, 0, 0.05, 0.95, 0}, "zipfian"},   // Short ranges.
+  {'f', {0.5, 0, 0, 0, 0.5}, "zipfian"},     // Read-modify-write.
+};
+
+std::string RecordKey(int64_t index) {
+  return "user" + std::to_string(index);
+}
+
+struct Column {
+  int32_t id;
+  std::string name;
+  std::shared_ptr<QLType> type;
+};
+
+struct ThreadState {
+  explicit ThreadState(int64_t seed) : rng(seed), value_rng(static_cast<uint32_t>(seed)) {}
+
+  std::mt19937_64 rng;
+  Random value_rng;
+};
+
+struct TimelineSample {
+  double time_sec;
+  double ops_per_sec;
+};
+
+template <class Op>
+Status CheckResponse(const Op& op) {
+  if (op.response().status() != QLResponsePB::YQL_STATUS_OK) {
+    return STATUS(RemoteError, op.response().error_message());
+  }
+  return Status::OK();
+}
+
+class YcsbBenchmark {
+ public:
+  YcsbBenchmark(client::YBClient* client,
+                const Workload& workload,
+                std::string distribution,
+                std::unique_ptr<KeyGenerator> key_generator)
+      : client_(client),
+        table_name_(kKeyspace, FLAGS_ycsb_benchmark_table_name),
+        workload_(workload),
+        distribution_(std::move(distribution)),
+        key_generator_(std::move(key_generator)),
+        next_insert_(FLAGS_ycsb_benchmark_record_count),
+        num_records_(FLAGS_ycsb_benchmark_record_count) {
+    for (size_t i = 0; i != kNumOperations; ++i) {
+      histograms_.emplace_back(new HdrHistogram(kMaxLatencyUs, kHistogramSignificantDigits));
+    }
+  }
+
+  CHECKED_STATUS Init() {
+    client::YBSchema schema;
+    if (!client_->GetTableSchema(table_name_, &schema).ok()) {
+      if (!FLAGS_ycsb_benchmark_load) {
+        return STATUS_SUBSTITUTE(NotFound, "Table $0 does not exist", table_name_.ToString());
+      }
+      RETURN_NOT_OK(CreateTable());
+    }
+    RETURN_NOT_OK(client_->OpenTable(table_name_, &table_));
+    const auto& table_schema = table_->schema();
+    for (size_t i = 0; i != table_schema.num_columns(); ++i) {
+      const auto column = table_schema.Column(i);
+      columns_.push_back(Column{table_schema.ColumnId(i), column.name(), column.type()});
+      if (column.name() != kKeyColumn) {
+        fields_.push_back(columns_.back());
+      }
+    }
+    if (fields_.empty() || fields_.size() + 1 != columns_.size()) {
+      return STATUS_SUBSTITUTE(IllegalState, "Table $0 does not look like a YCSB table",
+                               table_name_.ToString());
+    }
+    return Status::OK();
+  }
+
+  CHECKED_STATUS Load() {
+    LOG(INFO) << "Loading " << FLAGS_ycsb_benchmark_record_count << " records into "
+              << table_name_.ToString();
+    std::atomic<int64_t> next_record{0};
+    const auto start = MonoTime::Now(MonoTime::FINE);
+    RETURN_NOT_OK(RunThreads([this, &next_record](int idx) -> Status {
+      auto session = NewSession();
+      ThreadState state(FLAGS_ycsb_benchmark_seed + idx);
+      for (;;) {
+        const auto index = next_record.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= FLAGS_ycsb_benchmark_record_count) {
+          return Status::OK();
+        }
+        RETURN_NOT_OK(Insert(session.get(), index, &state));
+      }
+    }));
+    const auto elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start).ToSeconds();
+    LOG(INFO) << strings::Substitute(
+        "Loaded $0 records in $1s, $2 ops/sec", FLAGS_ycsb_benchmark_record_count, elapsed,
+        FLAGS_ycsb_benchmark_record_count / std::max(elapsed, 1e-6));
+    return Status::OK();
+  }
+
+  CHECKED_STATUS Run() {
+    LOG(INFO) << "Running YCSB workload " << workload_.name << " with "
+              << FLAGS_ycsb_benchmark_threads << " threads over "
+              << FLAGS_ycsb_benchmark_record_count << " " << distribution_ << " records";
+    measurement_start_ = MonoTime::Now(MonoTime::FINE);
+    measurement_start_.AddDelta(MonoDelta::FromSeconds(FLAGS_ycsb_benchmark_warmup_sec));
+    CountDownLatch running_threads(FLAGS_ycsb_benchmark_threads);
+    Status status;
+    std::thread runner([this, &running_threads, &status] {
+      status = RunThreads([this, &running_threads](int idx) -> Status {
+        RunWorkloadThread(idx);
+        running_threads.CountDown();
+        return Status::OK();
+      });
+    });
+
+    if (FLAGS_ycsb_benchmark_warmup_sec > 0 &&
+        !running_threads.WaitFor(MonoDelta::FromSeconds(FLAGS_ycsb_benchmark_warmup_sec))) {
+      LOG(INFO) << "Warm-up finished";
+    }
+    RecordTimeline(&running_threads);
+    runner.join();
+    RETURN_NOT_OK(status);
+    const auto elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(measurement_start_);
+    return Report(elapsed);
+  }
+
+ private:
+  CHECKED_STATUS CreateTable() {
+    RETURN_NOT_OK(client_->CreateNamespaceIfNotExists(kKeyspace));
+    client::YBSchemaBuilder builder;
+    builder.AddColumn(kKeyColumn)->HashPrimaryKey()->Type(STRING)->NotNull();
+    for (int i = 0; i != FLAGS_ycsb_benchmark_field_count; ++i) {
+      builder.AddColumn("field" + std::to_string(i))->Type(STRING);
+    }
+    client::YBSchema schema;
+    RETURN_NOT_OK(builder.Build(&schema));
+    LOG(INFO) << "Creating table " << table_name_.ToString();
+    std::unique_ptr<client::YBTableCreator> table_creator(client_->NewTableCreator());
+    return table_creator->table_name(table_name_)
+        .schema(&schema)
+        .num_tablets(FLAGS_num_tablets)
+        .num_replicas(FLAGS_num_replicas)
+        .table_type(client::YBTableType::YQL_TABLE_TYPE)
+        .Create();
+  }
+
+  // Runs body in FLAGS_ycsb_benchmark_threads threads and returns the first failure.
+  CHECKED_STATUS RunThreads(const std::function<Status(int)>& body) {
+    std::vector<std::thread> threads;
+    std::vector<Status> statuses(FLAGS_ycsb_benchmark_threads);
+    for (int i = 0; i != FLAGS_ycsb_benchmark_threads; ++i) {
+      threads.emplace_back([&body, &statuses, i] {
+        statuses[i] = body(i);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (const auto& status : statuses) {
+      RETURN_NOT_OK(status);
+    }
+    return Status::OK();
+  }
+
+  std::shared_ptr<client::YBSession> NewSession() {
+    auto session = client_->NewSession();
+    session->SetTimeout(std::chrono::seconds(FLAGS_rpc_timeout_sec));
+    return session;
+  }
+
+  void RunWorkloadThread(int idx) {
+    auto session = NewSession();
+    ThreadState state(FLAGS_ycsb_benchmark_seed + idx);
+    while (!stop_.load(std::memory_order_acquire)) {
+      const auto start = MonoTime::Now(MonoTime::FINE);
+      const bool measured = !start.ComesBefore(measurement_start_);
+      if (measured &&
+          reserved_ops_.fetch_add(1, std::memory_order_acq_rel) >=
+              FLAGS_ycsb_benchmark_operation_count) {
+        stop_.store(true, std::memory_order_release);
+        break;
+      }
+      const auto type = NextOperation(&state.rng);
+      const auto status = Execute(type, session.get(), &state);
+      if (!measured) {
+        continue;
+      }
+      if (!status.ok()) {
+        errors_[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+        YB_LOG_EVERY_N_SECS(WARNING, 10)
+            << kOperationNames[static_cast<size_t>(type)] << " failed: " << status;
+        continue;
+      }
+      const auto latency = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+      histograms_[static_cast<size_t>(type)]->Increment(
+          std::min<uint64_t>(latency.ToMicroseconds(), kMaxLatencyUs));
+      completed_ops_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Samples the throughput each FLAGS_ycsb_benchmark_timeline_interval_ms, until all threads
+  // finish, stopping them once FLAGS_ycsb_benchmark_duration_sec passes.
+  void RecordTimeline(CountDownLatch* running_threads) {
+    const auto interval = MonoDelta::FromMilliseconds(
+        std::max(FLAGS_ycsb_benchmark_timeline_interval_ms, 1));
+    auto prev_time = MonoTime::Now(MonoTime::FINE);
+    uint64_t prev_ops = completed_ops_.load(std::memory_order_acquire);
+    for (;;) {
+      const bool done = running_threads->WaitFor(interval);
+      const auto now = MonoTime::Now(MonoTime::FINE);
+      const uint64_t ops = completed_ops_.load(std::memory_order_acquire);
+      const double time_sec = now.GetDeltaSince(measurement_start_).ToSeconds();
+      const double ops_per_sec = (ops - prev_ops) / std::max(
+          now.GetDeltaSince(prev_time).ToSeconds(), 1e-6);
+      timeline_.push_back(TimelineSample{time_sec, ops_per_sec});
+      LOG(INFO) << strings::Substitute("$0s: $1 operations, $2 ops/sec", time_sec, ops,
+                                       ops_per_sec);
+      if (done) {
+        return;
+      }
+      if (FLAGS_ycsb_benchmark_duration_sec > 0 &&
+          time_sec >= FLAGS_ycsb_benchmark_duration_sec) {
+        stop_.store(true, std::memory_order_release);
+      }
+      prev_time = now;
+      prev_ops = ops;
+    }
+  }
+
+  OperationType NextOperation(std::mt19937_64* rng) {
+    double value = std::uniform_real_distribution<double>(0, 1)(*rng);
+    size_t last = 0;
+    for (size_t i = 0; i != kNumOperations; ++i) {
+      if (workload_.proportions[i] == 0) {
+        continue;
+      }
+      if (value < workload_.proportions[i]) {
+        return static_cast<OperationType>(i);
+      }
+      value -= workload_.proportions[i];
+      last = i;
+    }
+    // Rounding error of the proportions.
+    return static_cast<OperationType>(last);
+  }
+
+  // Picks the index of an existing record. The latest distribution prefers the most recently
+  // inserted records.
+  int64_t NextRecord(ThreadState* state) {
+    const auto value = static_cast<int64_t>(key_generator_->Next(&state->rng));
+    if (distribution_ == "latest") {
+      return std::max<int64_t>(0, num_records_.load(std::memory_order_acquire) - 1 - value);
+    }
+    return value;
+  }
+
+  CHECKED_STATUS Execute(OperationType type, client::YBSession* session, ThreadState* state) {
+    switch (type) {
+      case OperationType::kRead:
+        return Read(session, NextRecord(state));
+      case OperationType::kUpdate:
+        return Update(session, NextRecord(state), state);
+      case OperationType::kInsert:
+        RETURN_NOT_OK(Insert(
+            session, next_insert_.fetch_add(1, std::memory_order_acq_rel), state));
+        num_records_.fetch_add(1, std::memory_order_acq_rel);
+        return Status::OK();
+      case OperationType::kScan:
+        return Scan(session, NextRecord(state), state);
+      case OperationType::kReadModifyWrite: {
+        const auto index = NextRecord(state);
+        RETURN_NOT_OK(Read(session, index));
+        return Update(session, index, state);
+      }
+    }
+    FATAL_INVALID_ENUM_VALUE(OperationType, type);
+  }
+
+  void SetKey(int64_t index, google::protobuf::RepeatedPtrField<QLExpressionPB>* hash_values) {
+    hash_values->Add()->mutable_value()->set_string_value(RecordKey(index));
+  }
+
+  // Selects all columns, like "SELECT *".
+  void AddSelectedColumns(QLReadRequestPB* req) {
+    auto* rsrow_desc = req->mutable_rsrow_desc();
+    for (const auto& column : columns_) {
+      req->add_selected_exprs()->set_column_id(column.id);
+      req->mutable_column_refs()->add_ids(column.id);
+      auto* rscol_desc = rsrow_desc->add_rscol_descs();
+      rscol_desc->set_name(column.name);
+      column.type->ToQLTypePB(rscol_desc->mutable_ql_type());
+    }
+  }
+
+  void SetField(const Column& field, ThreadState* state, QLWriteRequestPB* req) {
+    auto* column_value = req->add_column_values();
+    column_value->set_column_id(field.id);
+    column_value->mutable_expr()->mutable_value()->set_string_value(
+        RandomHumanReadableString(FLAGS_ycsb_benchmark_field_length, &state->value_rng));
+  }
+
+  CHECKED_STATUS Read(client::YBSession* session, int64_t index) {
+    std::shared_ptr<client::YBqlReadOp> op(table_->NewQLSelect());
+    auto* req = op->mutable_request();
+    SetKey(index, req->mutable_hashed_column_values());
+    AddSelectedColumns(req);
+    RETURN_NOT_OK(session->ReadSync(op));
+    return CheckResponse(*op);
+  }
+
+  // Updates a single random field, as YCSB does by default.
+  CHECKED_STATUS Update(client::YBSession* session, int64_t index, ThreadState* state) {
+    std::shared_ptr<client::YBqlWriteOp> op(table_->NewQLUpdate());
+    auto* req = op->mutable_request();
+    SetKey(index, req->mutable_hashed_column_values());
+    const auto field = std::uniform_int_distribution<size_t>(0, fields_.size() - 1)(state->rng);
+    SetField(fields_[field], state, req);
+    RETURN_NOT_OK(session->Apply(op));
+    return CheckResponse(*op);
+  }
+
+  CHECKED_STATUS Insert(client::YBSession* session, int64_t index, ThreadState* state) {
+    std::shared_ptr<client::YBqlWriteOp> op(table_->NewQLInsert());
+    auto* req = op->mutable_request();
+    SetKey(index, req->mutable_hashed_column_values());
+    for (const auto& field : fields_) {
+      SetField(field, state, req);
+    }
+    RETURN_NOT_OK(session->Apply(op));
+    return CheckResponse(*op);
+  }
+
+  // Reads records starting from the token of the record at index, like
+  // "SELECT * FROM usertable WHERE token(ycsb_key) >= token(?) LIMIT ?" of the YCSB cassandra
+  // binding. Only the tablet of the start token is read, the paging state is not followed.
+  CHECKED_STATUS Scan(client::YBSession* session, int64_t index, ThreadState* state) {
+    std::shared_ptr<client::YBqlReadOp> op(table_->NewQLSelect());
+    auto* req = op->mutable_request();
+    google::protobuf::RepeatedPtrField<QLExpressionPB> start_key;
+    SetKey(index, &start_key);
+    std::string partition_key;
+    RETURN_NOT_OK(table_->partition_schema().EncodeKey(start_key, &partition_key));
+    req->set_hash_code(PartitionSchema::DecodeMultiColumnHashValue(partition_key));
+    req->set_limit(std::uniform_int_distribution<int32_t>(
+        1, FLAGS_ycsb_benchmark_max_scan_length)(state->rng));
+    AddSelectedColumns(req);
+    RETURN_NOT_OK(session->ReadSync(op));
+    return CheckResponse(*op);
+  }
+
+  CHECKED_STATUS Report(const MonoDelta& elapsed) {
+    uint64_t total = 0;
+    uint64_t errors = 0;
+    for (size_t i = 0; i != kNumOperations; ++i) {
+      const auto& histogram = *histograms_[i];
+      const auto op_errors = errors_[i].load(std::memory_order_acquire);
+      errors += op_errors;
+      if (histogram.TotalCount() == 0) {
+        continue;
+      }
+      total += histogram.TotalCount();
+      LOG(INFO) << strings::Substitute(
+          "$0: count=$1 errors=$2 mean=$3us p50=$4us p95=$5us p99=$6us p99.9=$7us max=$8us",
+          kOperationNames[i], histogram.TotalCount(), op_errors, histogram.MeanValue(),
+          histogram.ValueAtPercentile(50), histogram.ValueAtPercentile(95),
+          histogram.ValueAtPercentile(99), histogram.ValueAtPercentile(99.9),
+          histogram.MaxValue());
+    }
+    const double throughput = total / std::max(elapsed.ToSeconds(), 1e-6);
+    LOG(INFO) << strings::Substitute(
+        "Workload $0: executed $1 operations in $2s, $3 ops/sec, $4 errors",
+        workload_.name, total, elapsed.ToSeconds(), throughput, errors);
+    if (FLAGS_ycsb_benchmark_json_output.empty()) {
+      return Status::OK();
+    }
+    return WriteJson(elapsed, total, errors, throughput);
+  }
+
+  CHECKED_STATUS WriteJson(
+      const MonoDelta& elapsed, uint64_t total, uint64_t errors, double throughput) {
+    std::stringstream out;
+    JsonWriter writer(&out, JsonWriter::PRETTY);
+    writer.StartObject();
+    writer.String("workload");
+    writer.String(std::string(1, workload_.name));
+    writer.String("request_distribution");
+    writer.String(distribution_);
+    writer.String("record_count");
+    writer.Int64(FLAGS_ycsb_benchmark_record_count);
+    writer.String("threads");
+    writer.Int(FLAGS_ycsb_benchmark_threads);
+    writer.String("warmup_sec");
+    writer.Int(FLAGS_ycsb_benchmark_warmup_sec);
+    writer.String("runtime_sec");
+    writer.Double(elapsed.ToSeconds());
+    writer.String("operations");
+    writer.Uint64(total);
+    writer.String("errors");
+    writer.Uint64(errors);
+    writer.String("throughput_ops_sec");
+    writer.Double(throughput);
+
+    writer.String("latency_us");
+    writer.StartObject();
+    for (size_t i = 0; i != kNumOperations; ++i) {
+      const auto& histogram = *histograms_[i];
+      const auto op_errors = errors_[i].load(std::memory_order_acquire);
+      if (histogram.TotalCount() == 0 && op_errors == 0) {
+        continue;
+      }
+      writer.String(kOperationNames[i]);
+      writer.StartObject();
+      writer.String("count");
+      writer.Uint64(histogram.TotalCount());
+      writer.String("errors");
+      writer.Uint64(op_errors);
+      writer.String("mean");
+      writer.Double(histogram.MeanValue());
+      for (double percentile : {50.0, 90.0, 95.0, 99.0, 99.9}) {
+        writer.String(strings::Substitute("p$0", percentile));
+        writer.Uint64(histogram.ValueAtPercentile(percentile));
+      }
+      writer.String("max");
+      writer.Uint64(histogram.MaxValue());
+      writer.EndObject();
+    }
+    writer.EndObject();
+
+    writer.String("timeline");
+    writer.StartArray();
+    for (const auto& sample : timeline_) {
+      writer.StartObject();
+      writer.String("time_sec");
+      writer.Double(sample.time_sec);
+      writer.String("ops_sec");
+      writer.Double(sample.ops_per_sec);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    std::ofstream file(FLAGS_ycsb_benchmark_json_output);
+    file << out.str();
+    if (!file) {
+      return STATUS_SUBSTITUTE(IOError, "Failed to write $0", FLAGS_ycsb_benchmark_json_output);
+    }
+    return Status::OK();
+  }
+
+  client::YBClient* const client_;
+  const client::YBTableName table_name_;
+  const Workload& workload_;
+  const std::string distribution_;
+  const std::unique_ptr<KeyGenerator> key_generator_;
+  std::shared_ptr<client::YBTable> table_;
+  // All columns of the table and the fields, that are the columns besides the key.
+  std::vector<Column> columns_;
+  std::vector<Column> fields_;
+
+  std::vector<std::unique_ptr<HdrHistogram>> histograms_;
+  std::atomic<uint64_t> errors_[kNumOperations] = {};
+  std::vector<TimelineSample> timeline_;
+  MonoTime measurement_start_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int64_t> reserved_ops_{0};
+  std::atomic<uint64_t> completed_ops_{0};
+  // Index of the next record to insert and the number of records inserted so far.
+  std::atomic<int64_t> next_insert_;
+  std::atomic<int64_t> num_records_;
+};
+
+} // namespace
+
+Status RunYcsbBenchmark(client::YBClient* client) {
+  const auto& name = FLAGS_ycsb_benchmark_workload;
+  auto workload = std::find_if(
+      std::begin(kWorkloads), std::end(kWorkloads),
+      [&name](const Workload& w) { return name.size() == 1 && std::tolower(name[0]) == w.name; });
+  if (workload == std::end(kWorkloads)) {
+    return STATUS_SUBSTITUTE(InvalidArgument, "Unknown YCSB workload: $0", name);
+  }
+  if (FLAGS_ycsb_benchmark_threads <= 0 || FLAGS_ycsb_benchmark_field_count <= 0 ||
+      FLAGS_ycsb_benchmark_max_scan_length <= 0) {
+    return STATUS(InvalidArgument, "Threads, field count and max scan length should be positive");
+  }
+
+  std::string distribution = FLAGS_ycsb_benchmark_request_distribution.empty()
+      ? workload->distribution : FLAGS_ycsb_benchmark_request_distribution;
+  if (distribution != "uniform" && distribution != "zipfian" && distribution != "latest") {
+    return STATUS_SUBSTITUTE(InvalidArgument, "Unknown request distribution: $0", distribution);
+  }
+  // The latest distribution is the zipfian one counted back from the last inserted record.
+  std::unique_ptr<KeyGenerator> key_generator;
+  RETURN_NOT_OK(KeyGenerator::Create(
+      distribution == "latest" ? "zipfian" : distribution, FLAGS_ycsb_benchmark_record_count,
+      FLAGS_ycsb_benchmark_zipfian_constant, &key_generator));
+
+  YcsbBenchmark benchmark(client, *workload, std::move(distribution), std::move(key_generator));
+  RETURN_NOT_OK(benchmark.Init());
+  if (FLAGS_ycsb_benchmark_load) {
+    RETURN_NOT_OK(benchmark.Load());
+  }
+  return benchmark.Run();
+}
+
+} // namespace benchmarks
+} // namespace yb
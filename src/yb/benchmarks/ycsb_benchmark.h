@@ -0,0 +1,33 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_BENCHMARKS_YCSB_BENCHMARK_H
+#define YB_BENCHMARKS_YCSB_BENCHMARK_H
+
+#include "yb/client/client_fwd.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace benchmarks {
+
+// Runs one of the YCSB core workloads A-F against a CQL table with a string hash key and
+// ycsb_benchmark_field_count string fields, creating and loading it first when requested. The
+// operations are the QL requests that the CQL server would send for the matching statements of
+// the YCSB cassandra binding. Latencies of each operation type are reported as HDR histograms,
+// together with a throughput timeline, and optionally written as JSON for comparison of builds.
+CHECKED_STATUS RunYcsbBenchmark(client::YBClient* client);
+
+} // namespace benchmarks
+} // namespace yb
+
+#endif // YB_BENCHMARKS_YCSB_BENCHMARK_H
@@ -12,17 +12,30 @@
 
 #include "yb/client/async_initializer.h"
 
+#include <gflags/gflags.h>
+
+#include "yb/util/flag_tags.h"
+
 using namespace std::literals;
 
+DEFINE_bool(ybclient_use_server_messenger, true,
+            "Whether clients embedded in a tablet server, e.g. by the CQL and Redis proxies, send "
+            "their RPCs over the messenger of the tablet server, sharing its negotiated "
+            "connections, instead of opening their own connections to every server.");
+TAG_FLAG(ybclient_use_server_messenger, advanced);
+
 namespace yb {
 namespace client {
 
 AsyncClientInitialiser::AsyncClientInitialiser(
     const std::string& client_name, const uint32_t num_reactors, const uint32_t timeout_seconds,
     const std::string& tserver_uuid, const yb::server::ServerBaseOptions* opts,
-    scoped_refptr<MetricEntity> metric_entity)
+    scoped_refptr<MetricEntity> metric_entity, const std::shared_ptr<rpc::Messenger>& messenger)
     : client_future_(client_promise_.get_future()) {
   client_builder_.set_client_name(client_name);
+  if (messenger) {
+    client_builder_.use_messenger(messenger);
+  }
   client_builder_.default_rpc_timeout(MonoDelta::FromSeconds(timeout_seconds));
   client_builder_.add_master_server_addr(opts->master_addresses_flag);
   client_builder_.set_skip_master_leader_resolution(opts->GetMasterAddresses()->size() == 1);
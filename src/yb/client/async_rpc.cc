@@ -11,6 +11,8 @@
 // under the License.
 //
 
+#include <algorithm>
+
 #include "yb/client/async_rpc.h"
 #include "yb/client/batcher.h"
 #include "yb/client/client.h"
@@ -23,8 +25,11 @@
 #include "yb/common/row_operations.h"
 #include "yb/common/transaction.h"
 
+#include "yb/gutil/walltime.h"
+
 #include "yb/util/cast.h"
 #include "yb/util/debug-util.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 
 // TODO: do we need word Redis in following two metrics? ReadRpc and WriteRpc objects emitting
@@ -45,9 +50,50 @@ METRIC_DEFINE_histogram(
     server, handler_latency_yb_client_time_to_send,
     "Time taken for a Write/Read rpc to be sent to the server", yb::MetricUnit::kMicroseconds,
     "Microseconds spent before sending the request to the server", 60000000LU, 2);
+METRIC_DEFINE_histogram(
+    server, yb_client_write_batch_tablets, "Tablets per YB client write batch",
+    yb::MetricUnit::kUnits,
+    "Number of tablets, and thus of Write RPCs, the ops of a flushed write batch are sent to",
+    10000LU, 2);
+METRIC_DEFINE_counter(
+    server, yb_client_local_rpcs_sent, "Local Read/Write RPCs sent by the YB client",
+    yb::MetricUnit::kRequests,
+    "Number of Read/Write RPCs the YB client dispatched in process to the local tablet server");
+METRIC_DEFINE_counter(
+    server, yb_client_remote_rpcs_sent, "Remote Read/Write RPCs sent by the YB client",
+    yb::MetricUnit::kRequests,
+    "Number of Read/Write RPCs the YB client sent over the network to remote tablet servers");
+METRIC_DEFINE_counter(
+    server, yb_client_hedged_reads_sent, "Hedged reads sent by the YB client",
+    yb::MetricUnit::kRequests,
+    "Number of CONSISTENT_PREFIX reads the YB client also sent to a second replica because the "
+    "first one did not respond in time");
+METRIC_DEFINE_counter(
+    server, yb_client_hedged_reads_won, "Hedged reads won by the YB client",
+    yb::MetricUnit::kRequests,
+    "Number of hedged reads whose response arrived before the response of the first replica");
 DECLARE_bool(rpc_dump_all_traces);
 DECLARE_bool(collect_end_to_end_traces);
 
+DEFINE_int32(follower_read_max_staleness_ms, 0,
+             "Maximum staleness of data returned by CONSISTENT_PREFIX reads served by followers. "
+             "A follower that is further behind the leader rejects the read and it is retried on "
+             "the leader. 0 means that staleness is not bounded.");
+TAG_FLAG(follower_read_max_staleness_ms, advanced);
+TAG_FLAG(follower_read_max_staleness_ms, runtime);
+
+DEFINE_bool(yb_client_hedged_reads, false,
+            "Whether a CONSISTENT_PREFIX read sent to a remote replica is also sent to another "
+            "replica once it has been outstanding for longer than the 95th percentile of the "
+            "remote read latency. The first response is used.");
+TAG_FLAG(yb_client_hedged_reads, advanced);
+TAG_FLAG(yb_client_hedged_reads, runtime);
+
+DEFINE_int32(yb_client_hedged_read_min_delay_ms, 10,
+             "Minimum time a CONSISTENT_PREFIX read is outstanding before it is hedged.");
+TAG_FLAG(yb_client_hedged_read_min_delay_ms, advanced);
+TAG_FLAG(yb_client_hedged_read_min_delay_ms, runtime);
+
 using namespace std::placeholders;
 
 namespace yb {
@@ -75,7 +121,25 @@ AsyncRpcMetrics::AsyncRpcMetrics(const scoped_refptr<yb::MetricEntity>& entity)
       remote_read_rpc_time(METRIC_handler_latency_yb_client_read_remote.Instantiate(entity)),
       local_write_rpc_time(METRIC_handler_latency_yb_client_write_local.Instantiate(entity)),
       local_read_rpc_time(METRIC_handler_latency_yb_client_read_local.Instantiate(entity)),
-      time_to_send(METRIC_handler_latency_yb_client_time_to_send.Instantiate(entity)) {
+      time_to_send(METRIC_handler_latency_yb_client_time_to_send.Instantiate(entity)),
+      write_batch_tablets(METRIC_yb_client_write_batch_tablets.Instantiate(entity)),
+      local_rpcs_sent(METRIC_yb_client_local_rpcs_sent.Instantiate(entity)),
+      remote_rpcs_sent(METRIC_yb_client_remote_rpcs_sent.Instantiate(entity)),
+      hedged_reads_sent(METRIC_yb_client_hedged_reads_sent.Instantiate(entity)),
+      hedged_reads_won(METRIC_yb_client_hedged_reads_won.Instantiate(entity)) {
+}
+
+MonoDelta AsyncRpcMetrics::HedgedReadDelay() {
+  const int64_t now = GetMonoTimeMicros();
+  auto refresh = hedged_read_delay_refresh_us_.load(std::memory_order_acquire);
+  if (now >= refresh &&
+      hedged_read_delay_refresh_us_.compare_exchange_strong(refresh, now + 1000000)) {
+    hedged_read_delay_us_.store(remote_read_rpc_time->ValueAtPercentile(95),
+                                std::memory_order_release);
+  }
+  return MonoDelta::FromMicroseconds(std::max<int64_t>(
+      hedged_read_delay_us_.load(std::memory_order_acquire),
+      FLAGS_yb_client_hedged_read_min_delay_ms * 1000LL));
 }
 
 AsyncRpc::AsyncRpc(
@@ -130,9 +194,11 @@ const YBTable* AsyncRpc::table() const {
 void AsyncRpc::SendRpcCb(const Status& status) {
   Status new_status = status;
   if (tablet_invoker_.Done(&new_status)) {
-    ProcessResponseFromTserver(new_status);
-    batcher_->RemoveInFlightOpsAfterFlushing(ops_, new_status, PropagatedHybridTime());
-    batcher_->CheckForFinishedFlush();
+    if (ClaimResponse()) {
+      ProcessResponseFromTserver(new_status);
+      batcher_->RemoveInFlightOpsAfterFlushing(ops_, new_status, PropagatedHybridTime());
+      batcher_->CheckForFinishedFlush();
+    }
     retained_self_.reset();
   }
 }
@@ -181,8 +247,12 @@ bool AsyncRpc::IsLocalCall() const {
 
 void AsyncRpc::SendRpcToTserver() {
   MonoTime end_time = MonoTime::Now(MonoTime::FINE);
-  if (async_rpc_metrics_)
+  if (async_rpc_metrics_) {
     async_rpc_metrics_->time_to_send->Increment(end_time.GetDeltaSince(start_).ToMicroseconds());
+    // Counted per attempt since a retry may go to a different tablet server.
+    (IsLocalCall() ? async_rpc_metrics_->local_rpcs_sent
+                   : async_rpc_metrics_->remote_rpcs_sent)->Increment();
+  }
   CallRemoteMethod();
 }
 
@@ -194,10 +264,13 @@ WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
   const Schema& schema = GetSchema(table()->schema());
 
   req_.set_tablet_id(tablet->tablet_id());
-  req_.set_include_trace(IsTracingEnabled());
+  req_.set_include_trace(IsTracingEnabled() || trace_->sampled());
   const auto& transaction = batcher->transaction_metadata();
   if (!transaction.transaction_id.is_nil()) {
     transaction.ToPB(req_.mutable_write_batch()->mutable_transaction());
+    if (batcher->one_phase_commit()) {
+      req_.mutable_write_batch()->set_one_phase_commit(true);
+    }
     req_.set_propagated_hybrid_time(batcher->propagated_hybrid_time().ToUint64());
   }
 
@@ -418,8 +491,12 @@ ReadRpc::ReadRpc(
     : AsyncRpc(batcher, tablet, ops, yb_consistency_level) {
   TRACE_TO(trace_, "ReadRpc initiated to $0", tablet->tablet_id());
   req_.set_consistency_level(yb_consistency_level);
+  if (yb_consistency_level == YBConsistencyLevel::CONSISTENT_PREFIX &&
+      FLAGS_follower_read_max_staleness_ms > 0) {
+    req_.set_max_staleness_ms(FLAGS_follower_read_max_staleness_ms);
+  }
   req_.set_tablet_id(tablet->tablet_id());
-  req_.set_include_trace(IsTracingEnabled());
+  req_.set_include_trace(IsTracingEnabled() || trace_->sampled());
   req_.set_propagated_hybrid_time(batcher->propagated_hybrid_time().ToUint64());
   const auto& transaction = batcher->transaction_metadata();
   if (!transaction.transaction_id.is_nil()) {
@@ -484,27 +561,124 @@ void ReadRpc::CallRemoteMethod() {
                        // Detailed explanation in WriteRpc::SendRpcToTserver.
   TRACE_TO(trace, "SendRpcToTserver");
   ADOPT_TRACE(trace.get());
+
+  // Local calls keep a pointer to req_ and are not expected to be slow, so only remote follower
+  // reads are hedged. Only the first attempt schedules the hedged request.
+  if (FLAGS_yb_client_hedged_reads && !hedge_scheduled_ && async_rpc_metrics_ &&
+      req_.consistency_level() == YBConsistencyLevel::CONSISTENT_PREFIX && !IsLocalCall()) {
+    hedge_scheduled_ = true;
+    retained_for_hedge_ = shared_from_this();
+    retrier().messenger()->ScheduleOnReactor(
+        std::bind(&ReadRpc::SendHedgedRead, this, tablet_invoker_.current_ts()->permanent_uuid(),
+                  _1),
+        async_rpc_metrics_->HedgedReadDelay());
+  }
+
   tablet_invoker_.proxy()->ReadAsync(
       req_, &resp_, mutable_retrier()->mutable_controller(),
       std::bind(&ReadRpc::SendRpcCb, this, Status::OK()));
   TRACE_TO(trace, "RpcDispatched Asynchronously");
 }
 
+bool ReadRpc::ClaimResponse() {
+  std::lock_guard<std::mutex> lock(hedge_mutex_);
+  if (responded_) {
+    return false;
+  }
+  responded_ = true;
+  return true;
+}
+
+void ReadRpc::SendHedgedRead(const std::string& primary_uuid, const Status& status) {
+  if (!status.ok()) {
+    retained_for_hedge_.reset();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(hedge_mutex_);
+    if (responded_) {
+      retained_for_hedge_.reset();
+      return;
+    }
+  }
+  std::vector<RemoteTabletServer*> candidates;
+  RemoteTabletServer* ts = tablet_invoker_.client().data_->SelectTServer(
+      &tablet(), YBClient::ReplicaSelection::CLOSEST_REPLICA, {primary_uuid}, &candidates);
+  if (ts == nullptr) {
+    retained_for_hedge_.reset();
+    return;
+  }
+  ts->InitProxy(&tablet_invoker_.client(),
+                Bind(&ReadRpc::HedgedReadProxyReady, Unretained(this), ts));
+}
+
+void ReadRpc::HedgedReadProxyReady(RemoteTabletServer* ts, const Status& status) {
+  if (!status.ok()) {
+    retained_for_hedge_.reset();
+    return;
+  }
+  {
+    // req_ is not modified before the response is claimed, so it is safe to copy it here.
+    std::lock_guard<std::mutex> lock(hedge_mutex_);
+    if (responded_) {
+      retained_for_hedge_.reset();
+      return;
+    }
+    hedged_req_.CopyFrom(req_);
+  }
+  VLOG(2) << ToString() << ": hedging read to " << ts->ToString();
+  TRACE_TO(trace_, "Sending hedged read to $0", ts->permanent_uuid());
+  async_rpc_metrics_->hedged_reads_sent->Increment();
+  hedged_controller_.set_deadline(retrier().deadline());
+  ts->proxy()->ReadAsync(
+      hedged_req_, &hedged_resp_, &hedged_controller_,
+      std::bind(&ReadRpc::HedgedReadDone, this));
+}
+
+void ReadRpc::HedgedReadDone() {
+  // The request sent by the retrier could still be in flight, so this object is only released
+  // when the function returns.
+  auto self = std::move(retained_for_hedge_);
+  if (!hedged_controller_.status().ok() || hedged_resp_.has_error()) {
+    // Leave the error handling to the retrier.
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(hedge_mutex_);
+    if (responded_) {
+      return;
+    }
+    responded_ = true;
+    processed_req_ = &hedged_req_;
+    processed_resp_ = &hedged_resp_;
+    processed_controller_ = &hedged_controller_;
+  }
+  TRACE_TO(trace_, "Hedged read won");
+  async_rpc_metrics_->hedged_reads_won->Increment();
+  ProcessResponseFromTserver(Status::OK());
+  batcher_->RemoveInFlightOpsAfterFlushing(ops_, Status::OK(), PropagatedHybridTime());
+  batcher_->CheckForFinishedFlush();
+}
+
 void ReadRpc::ProcessResponseFromTserver(Status status) {
   TRACE_TO(trace_, "ProcessResponseFromTserver($0)", status.ToString(false));
-  if (resp_.has_trace_buffer()) {
-    TRACE_TO(trace_, "Received from server: $0", resp_.trace_buffer());
+  auto& req = *processed_req_;
+  auto& resp = *processed_resp_;
+  const auto& controller =
+      processed_controller_ != nullptr ? *processed_controller_ : retrier().controller();
+  if (resp.has_trace_buffer()) {
+    TRACE_TO(trace_, "Received from server: $0", resp.trace_buffer());
   }
   batcher_->ProcessReadResponse(*this, status);
   if (!status.ok()) return;
-  if (resp_.has_error()) {
+  if (resp.has_error()) {
     LOG(WARNING) << "Read Rpc to tablet server has error:"
-                 << resp_.error().DebugString()
+                 << resp.error().DebugString()
                  << ". Requests not processed.";
     // If there is an error at the Rpc itself,
     // there should be no individual responses. All of them need to be
     // marked as failed.
-    Failed(StatusFromPB(resp_.error().status()));
+    Failed(StatusFromPB(resp.error().status()));
     return;
   }
   // Retrieve Redis and QL responses and make sure we received all the responses back.
@@ -514,30 +688,30 @@ void ReadRpc::ProcessResponseFromTserver(Status status) {
     YBOperation* yb_op = op->yb_op.get();
     switch (yb_op->type()) {
       case YBOperation::Type::REDIS_READ: {
-        if (redis_idx >= resp_.redis_batch().size()) {
+        if (redis_idx >= resp.redis_batch().size()) {
           batcher_->AddOpCountMismatchError();
           return;
         }
         // Restore Redis read request PB and extract response.
         auto* redis_op = down_cast<YBRedisReadOp*>(yb_op);
-        redis_op->mutable_request()->Swap(req_.mutable_redis_batch(redis_idx));
-        redis_op->mutable_response()->Swap(resp_.mutable_redis_batch(redis_idx));
+        redis_op->mutable_request()->Swap(req.mutable_redis_batch(redis_idx));
+        redis_op->mutable_response()->Swap(resp.mutable_redis_batch(redis_idx));
         redis_idx++;
         break;
       }
       case YBOperation::Type::QL_READ: {
-        if (ql_idx >= resp_.ql_batch().size()) {
+        if (ql_idx >= resp.ql_batch().size()) {
           batcher_->AddOpCountMismatchError();
           return;
         }
         // Restore QL read request PB and extract response.
         auto* ql_op = down_cast<YBqlReadOp*>(yb_op);
-        ql_op->mutable_request()->Swap(req_.mutable_ql_batch(ql_idx));
-        ql_op->mutable_response()->Swap(resp_.mutable_ql_batch(ql_idx));
+        ql_op->mutable_request()->Swap(req.mutable_ql_batch(ql_idx));
+        ql_op->mutable_response()->Swap(resp.mutable_ql_batch(ql_idx));
         const auto& ql_response = ql_op->response();
         if (ql_response.has_rows_data_sidecar()) {
           Slice rows_data;
-          CHECK_OK(retrier().controller().GetSidecar(
+          CHECK_OK(controller.GetSidecar(
               ql_response.rows_data_sidecar(), &rows_data));
           down_cast<YBqlReadOp*>(yb_op)->mutable_rows_data()->assign(
               util::to_char_ptr(rows_data.data()), rows_data.size());
@@ -555,13 +729,13 @@ void ReadRpc::ProcessResponseFromTserver(Status status) {
     }
   }
 
-  if (redis_idx != resp_.redis_batch().size() ||
-      ql_idx != resp_.ql_batch().size()) {
+  if (redis_idx != resp.redis_batch().size() ||
+      ql_idx != resp.ql_batch().size()) {
     LOG(ERROR) << Substitute("Read response count mismatch: "
                              "$0 Redis requests sent, $1 responses received. "
                              "$2 QL requests sent, $3 responses received.",
-                             redis_idx, resp_.redis_batch().size(),
-                             ql_idx, resp_.ql_batch().size());
+                             redis_idx, resp.redis_batch().size(),
+                             ql_idx, resp.ql_batch().size());
     batcher_->AddOpCountMismatchError();
     Failed(STATUS(IllegalState, "Read response count mismatch"));
   }
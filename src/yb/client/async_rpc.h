@@ -14,6 +14,9 @@
 #ifndef YB_CLIENT_ASYNC_RPC_H_
 #define YB_CLIENT_ASYNC_RPC_H_
 
+#include <atomic>
+#include <mutex>
+
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc.h"
 
@@ -43,6 +46,20 @@ struct AsyncRpcMetrics {
   scoped_refptr<Histogram> local_write_rpc_time;
   scoped_refptr<Histogram> local_read_rpc_time;
   scoped_refptr<Histogram> time_to_send;
+  scoped_refptr<Histogram> write_batch_tablets;
+  scoped_refptr<Counter> local_rpcs_sent;
+  scoped_refptr<Counter> remote_rpcs_sent;
+  scoped_refptr<Counter> hedged_reads_sent;
+  scoped_refptr<Counter> hedged_reads_won;
+
+  // Returns how long a CONSISTENT_PREFIX read waits for its response before it is hedged.
+  MonoDelta HedgedReadDelay();
+
+ private:
+  // 95th percentile of the remote read latency, refreshed at most once a second since computing
+  // it walks the histogram.
+  std::atomic<int64_t> hedged_read_delay_us_{0};
+  std::atomic<int64_t> hedged_read_delay_refresh_us_{0};
 };
 
 // An Async RPC which is in-flight to a tablet. Initially, the RPC is sent
@@ -75,6 +92,10 @@ class AsyncRpc : public rpc::Rpc, public TabletRpc {
 
   virtual void CallRemoteMethod() = 0;
 
+  // Returns whether the response of this request is to be processed. Hedged reads process only
+  // the first of the responses to their requests.
+  virtual bool ClaimResponse() { return true; }
+
   // This is the last step where errors and responses are collected from the response and
   // stored in batcher. If there's a callback from the user, it is done in this step.
   virtual void ProcessResponseFromTserver(Status status) = 0;
@@ -145,7 +166,7 @@ class ReadRpc : public AsyncRpc {
 
   virtual ~ReadRpc();
 
-  const tserver::ReadResponsePB& resp() const { return resp_; }
+  const tserver::ReadResponsePB& resp() const { return *processed_resp_; }
   std::string ToString() const override;
 
  private:
@@ -158,15 +179,41 @@ class ReadRpc : public AsyncRpc {
   }
 
   HybridTime PropagatedHybridTime() override {
-    return GetPropagatedHybridTime(resp_);
+    return GetPropagatedHybridTime(*processed_resp_);
   }
 
+  bool ClaimResponse() override;
+
+  // Sends a copy of the request to a replica other than primary_uuid, unless a response to the
+  // request has been processed already.
+  void SendHedgedRead(const std::string& primary_uuid, const Status& status);
+  void HedgedReadProxyReady(RemoteTabletServer* ts, const Status& status);
+  void HedgedReadDone();
+
  protected:
   // Request body.
   tserver::ReadRequestPB req_;
 
   // Response body.
   tserver::ReadResponsePB resp_;
+
+  // Request, response and controller to process: those of the hedged request if it completed
+  // first, of the request sent by the retrier otherwise.
+  tserver::ReadRequestPB* processed_req_ = &req_;
+  tserver::ReadResponsePB* processed_resp_ = &resp_;
+  const rpc::RpcController* processed_controller_ = nullptr;
+
+  // Protects responded_ and the copy of req_ made for the hedged request.
+  std::mutex hedge_mutex_;
+  bool responded_ = false;
+  bool hedge_scheduled_ = false;
+
+  tserver::ReadRequestPB hedged_req_;
+  tserver::ReadResponsePB hedged_resp_;
+  rpc::RpcController hedged_controller_;
+
+  // Keeps this object alive while the hedged request is being prepared and is in flight.
+  rpc::RpcCommandPtr retained_for_hedge_;
 };
 
 }  // namespace internal
@@ -406,7 +406,8 @@ void Batcher::FlushBuffersIfReady() {
                                           _1,
                                           BatcherPtr(this)),
                                 &transaction_metadata_,
-                                &propagated_hybrid_time_)) {
+                                &propagated_hybrid_time_,
+                                &one_phase_commit_)) {
         return;
       }
     }
@@ -428,14 +429,19 @@ void Batcher::FlushBuffersIfReady() {
   });
 
   // Now flush the ops for each tablet.
+  size_t num_tablets = 1;
   auto start = ops.begin();
   for (auto it = start; it != ops.end(); ++it) {
     if (it->get()->tablet.get() != start->get()->tablet.get()) {
       FlushBuffer(start->get()->tablet.get(), start, it);
       start = it;
+      num_tablets++;
     }
   }
 
+  if (!read_only_ && async_rpc_metrics_) {
+    async_rpc_metrics_->write_batch_tablets->Increment(num_tablets);
+  }
   FlushBuffer(start->get()->tablet.get(), start, ops.end());
 }
 
@@ -153,6 +153,11 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
     return propagated_hybrid_time_;
   }
 
+  // Whether ops of this batcher commit its transaction in one phase.
+  bool one_phase_commit() const {
+    return one_phase_commit_;
+  }
+
  private:
   friend class RefCountedThreadSafe<Batcher>;
   friend class AsyncRpc;
@@ -273,6 +278,7 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
 
   TransactionMetadata transaction_metadata_;
   HybridTime propagated_hybrid_time_;
+  bool one_phase_commit_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(Batcher);
 };
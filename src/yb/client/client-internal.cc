@@ -775,6 +775,7 @@ class GetTableSchemaRpc : public Rpc {
                     YBSchema* out_schema,
                     PartitionSchema* out_partition_schema,
                     string* out_id,
+                    std::vector<IndexInfoPB>* out_indexes,
                     const MonoTime& deadline,
                     const shared_ptr<rpc::Messenger>& messenger);
 
@@ -797,6 +798,7 @@ class GetTableSchemaRpc : public Rpc {
   YBSchema* out_schema_;
   PartitionSchema* out_partition_schema_;
   string* out_id_;
+  std::vector<IndexInfoPB>* out_indexes_;
   GetTableSchemaResponsePB resp_;
 };
 
@@ -806,6 +808,7 @@ GetTableSchemaRpc::GetTableSchemaRpc(YBClient* client,
                                      YBSchema* out_schema,
                                      PartitionSchema* out_partition_schema,
                                      string* out_id,
+                                     std::vector<IndexInfoPB>* out_indexes,
                                      const MonoTime& deadline,
                                      const shared_ptr<rpc::Messenger>& messenger)
     : Rpc(deadline, messenger),
@@ -814,7 +817,8 @@ GetTableSchemaRpc::GetTableSchemaRpc(YBClient* client,
       table_name_(std::move(table_name)),
       out_schema_(DCHECK_NOTNULL(out_schema)),
       out_partition_schema_(DCHECK_NOTNULL(out_partition_schema)),
-      out_id_(DCHECK_NOTNULL(out_id)) {
+      out_id_(DCHECK_NOTNULL(out_id)),
+      out_indexes_(out_indexes) {
 }
 
 GetTableSchemaRpc::~GetTableSchemaRpc() {
@@ -931,6 +935,10 @@ void GetTableSchemaRpc::SendRpcCb(const Status& status) {
 
       *out_id_ = resp_.identifier().table_id();
       CHECK_GT(out_id_->size(), 0) << "Running against a too-old master";
+
+      if (out_indexes_ != nullptr) {
+        out_indexes_->assign(resp_.indexes().begin(), resp_.indexes().end());
+      }
     }
   }
   if (!new_status.ok()) {
@@ -946,7 +954,8 @@ Status YBClient::Data::GetTableSchema(YBClient* client,
                                       const MonoTime& deadline,
                                       YBSchema* schema,
                                       PartitionSchema* partition_schema,
-                                      string* table_id) {
+                                      string* table_id,
+                                      std::vector<IndexInfoPB>* indexes) {
   Synchronizer sync;
   auto rpc = rpc::StartRpc<GetTableSchemaRpc>(
       client,
@@ -955,6 +964,7 @@ Status YBClient::Data::GetTableSchema(YBClient* client,
       schema,
       partition_schema,
       table_id,
+      indexes,
       deadline,
       messenger_);
   return sync.Wait();
@@ -126,7 +126,8 @@ class YBClient::Data {
                                 const MonoTime& deadline,
                                 YBSchema* schema,
                                 PartitionSchema* partition_schema,
-                                std::string* table_id);
+                                std::string* table_id,
+                                std::vector<IndexInfoPB>* indexes = nullptr);
 
   CHECKED_STATUS InitLocalHostNames();
 
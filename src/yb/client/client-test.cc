@@ -81,6 +81,7 @@
 
 DECLARE_bool(enable_data_block_fsync);
 DECLARE_bool(log_inject_latency);
+DECLARE_bool(yb_client_prefetch_tablet_locations);
 DECLARE_int32(heartbeat_interval_ms);
 DECLARE_int32(log_inject_latency_ms_mean);
 DECLARE_int32(log_inject_latency_ms_stddev);
@@ -89,6 +90,8 @@ DECLARE_int32(max_create_tablets_per_ts);
 DECLARE_int32(scanner_gc_check_interval_us);
 DECLARE_int32(scanner_inject_latency_on_each_batch_ms);
 DECLARE_int32(scanner_max_batch_size_bytes);
+DECLARE_int32(yb_client_tablet_locations_page_size);
+DECLARE_int32(yb_session_background_flush_max_ops);
 DECLARE_int32(scanner_ttl_ms);
 DECLARE_int32(tablet_server_svc_queue_length);
 
@@ -515,6 +518,32 @@ TEST_F(ClientTest, TestListTables) {
   ASSERT_EQ(kTable2Name, tables[0]) << "Tables:" << ToString(tables);
 }
 
+TEST_F(ClientTest, TestUseServerMessenger) {
+  // A client embedded in the tablet server sends its RPCs over the messenger of the server.
+  const auto& messenger = cluster_->mini_tablet_server(0)->server()->messenger();
+  YBClientPtr client;
+  ASSERT_OK(YBClientBuilder()
+      .add_master_server_addr(yb::ToString(cluster_->mini_master()->bound_rpc_addr()))
+      .use_messenger(messenger)
+      .Build(&client));
+  ASSERT_EQ(messenger, client->messenger());
+
+  shared_ptr<YBTable> table;
+  ASSERT_OK(client->OpenTable(kTableName, &table));
+  ASSERT_NO_FATALS(InsertTestRows(client.get(), table.get(), 10));
+  ASSERT_EQ(10, CountRowsFromClient(table.get()));
+
+  // Dropping the client does not shut down the shared messenger.
+  table.reset();
+  client.reset();
+  ASSERT_OK(YBClientBuilder()
+      .add_master_server_addr(yb::ToString(cluster_->mini_master()->bound_rpc_addr()))
+      .use_messenger(messenger)
+      .Build(&client));
+  vector<YBTableName> tables;
+  ASSERT_OK(client->ListTables(&tables));
+}
+
 TEST_F(ClientTest, TestListTabletServers) {
   std::vector<std::unique_ptr<YBTabletServer>> tss;
   ASSERT_OK(client_->ListTabletServers(&tss));
@@ -912,6 +941,44 @@ TEST_F(ClientTest, TestInvalidPredicates) {
 
 
 // Check that the tserver proxy is reset on close, even for empty tables.
+TEST_F(ClientTest, TestScanPrefetch) {
+  ASSERT_NO_FATALS(InsertTestRows(client_table_.get(), FLAGS_test_scan_num_rows));
+
+  {
+    YBScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetPrefetch(true));
+    // Set a small batch size so it reads in multiple batches.
+    ASSERT_OK(scanner.SetBatchSizeBytes(1));
+    ASSERT_OK(scanner.Open());
+    ASSERT_TRUE(scanner.SetPrefetch(false).IsIllegalState());
+
+    int count = 0;
+    int num_prefetches = 0;
+    YBScanBatch batch;
+    while (scanner.HasMoreRows()) {
+      ASSERT_OK(scanner.NextBatch(&batch));
+      count += batch.NumRows();
+      if (scanner.data_->prefetch_in_flight_) {
+        num_prefetches++;
+      }
+    }
+    ASSERT_EQ(FLAGS_test_scan_num_rows, count);
+    ASSERT_GT(num_prefetches, 0);
+  }
+
+  {
+    // Close the scanner while the next batch is being prefetched.
+    YBScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetPrefetch(true));
+    ASSERT_OK(scanner.SetBatchSizeBytes(1));
+    ASSERT_OK(scanner.Open());
+    YBScanBatch batch;
+    ASSERT_OK(scanner.NextBatch(&batch));
+    scanner.Close();
+    ASSERT_FALSE(scanner.data_->prefetch_in_flight_);
+  }
+}
+
 TEST_F(ClientTest, TestScanCloseProxy) {
   const YBTableName kEmptyTable("TestScanCloseProxy");
   shared_ptr<YBTable> table;
@@ -1561,6 +1628,26 @@ TEST_F(ClientTest, TestAsyncFlushResponseAfterSessionDropped) {
   ASSERT_TRUE(s.Wait().ok());
 }
 
+// Test which flushes through FlushFuture and drops the reference to the session before the
+// future is ready.
+TEST_F(ClientTest, TestFlushFuture) {
+  shared_ptr<YBSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+  ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, 1, 1, "row"));
+  auto future = session->FlushFuture();
+  session.reset();
+  ASSERT_OK(future.get());
+
+  // Flush through a functor, which does not have to outlive the flush.
+  session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+  ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, 2, 2, "row"));
+  Synchronizer s;
+  session->FlushAsync([&s](const Status& status) { s.StatusCB(status); });
+  session.reset();
+  ASSERT_OK(s.Wait());
+}
+
 TEST_F(ClientTest, TestSessionClose) {
   shared_ptr<YBSession> session = client_->NewSession();
   ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
@@ -2400,6 +2487,73 @@ TEST_F(ClientTest, TestMasterLookupPermits) {
             client_->data_->meta_cache_->master_lookup_sem_.GetValue());
 }
 
+TEST_F(ClientTest, TestAutoFlushBackground) {
+  FLAGS_yb_session_background_flush_max_ops = 10;
+
+  shared_ptr<YBSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(YBSession::AUTO_FLUSH_BACKGROUND));
+  session->SetTimeoutMillis(10000);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(session->Apply(BuildTestRow(client_table_.get(), i)));
+  }
+  // Flush() waits for the operations flushed in background as well.
+  FlushSessionOrDie(session);
+  ASSERT_FALSE(session->HasPendingOperations());
+  ASSERT_EQ(100, CountRowsFromClient(client_table_.get()));
+}
+
+TEST_F(ClientTest, TestPrefetchTabletLocations) {
+  FLAGS_yb_client_prefetch_tablet_locations = true;
+  FLAGS_yb_client_tablet_locations_page_size = 1;
+
+  // Opening the table with a fresh client caches all of its tablets, one page at a time.
+  YBClientPtr client;
+  ASSERT_OK(YBClientBuilder()
+      .add_master_server_addr(yb::ToString(cluster_->mini_master()->bound_rpc_addr()))
+      .Build(&client));
+  shared_ptr<YBTable> table;
+  ASSERT_OK(client->OpenTable(kTableName, &table));
+
+  GetTableLocationsRequestPB req;
+  GetTableLocationsResponsePB resp;
+  kTableName.SetIntoTableIdentifierPB(req.mutable_table());
+  ASSERT_OK(cluster_->mini_master()->master()->catalog_manager()->GetTableLocations(&req, &resp));
+  ASSERT_EQ(2, resp.tablet_locations_size());
+  for (const auto& location : resp.tablet_locations()) {
+    ASSERT_EQ(1, client->data_->meta_cache_->tablets_by_id_.count(location.tablet_id()));
+  }
+}
+
+TEST_F(ClientTest, TestWarmUp) {
+  YBClientPtr client;
+  ASSERT_OK(YBClientBuilder()
+      .add_master_server_addr(yb::ToString(cluster_->mini_master()->bound_rpc_addr()))
+      .Build(&client));
+  ASSERT_OK(client->WarmUp({kTableName, kTable2Name}, MonoDelta::FromSeconds(30)));
+
+  // All the tablets of the tables are cached and the connections to their tablet servers are set
+  // up.
+  for (const auto* table_name : {&kTableName, &kTable2Name}) {
+    GetTableLocationsRequestPB req;
+    GetTableLocationsResponsePB resp;
+    table_name->SetIntoTableIdentifierPB(req.mutable_table());
+    ASSERT_OK(cluster_->mini_master()->master()->catalog_manager()->GetTableLocations(
+        &req, &resp));
+    for (const auto& location : resp.tablet_locations()) {
+      ASSERT_EQ(1, client->data_->meta_cache_->tablets_by_id_.count(location.tablet_id()));
+    }
+  }
+  std::set<internal::RemoteTabletServer*> servers;
+  client->data_->meta_cache_->GetTableTabletServers(client_table_->id(), &servers);
+  ASSERT_FALSE(servers.empty());
+  for (auto* ts : servers) {
+    ASSERT_NE(nullptr, ts->proxy());
+  }
+
+  ASSERT_NOK(client->WarmUp({YBTableName(kKeyspaceName, "no_such_table")},
+                            MonoDelta::FromSeconds(30)));
+}
+
 // Define callback for deadlock simulation, as well as various helper methods.
 namespace {
 class DLSCallback : public YBStatusCallback {
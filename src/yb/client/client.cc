@@ -70,6 +70,7 @@
 #include "yb/redisserver/redis_constants.h"
 #include "yb/redisserver/redis_parser.h"
 #include "yb/rpc/messenger.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/init.h"
 #include "yb/util/logging.h"
@@ -289,6 +290,12 @@ YBClientBuilder& YBClientBuilder::set_tserver_uuid(const TabletServerId& uuid) {
   return *this;
 }
 
+YBClientBuilder& YBClientBuilder::use_messenger(
+    const std::shared_ptr<rpc::Messenger>& messenger) {
+  data_->messenger_ = messenger;
+  return *this;
+}
+
 YBClientBuilder& YBClientBuilder::set_skip_master_leader_resolution(bool value) {
   data_->skip_master_leader_resolution_ = value;
   return *this;
@@ -300,10 +307,14 @@ Status YBClientBuilder::Build(shared_ptr<YBClient>* client) {
   shared_ptr<YBClient> c(new YBClient());
 
   // Init messenger.
-  MessengerBuilder builder(data_->client_name_);
-  builder.set_num_reactors(data_->num_reactors_);
-  builder.set_metric_entity(data_->metric_entity_);
-  RETURN_NOT_OK(builder.Build(&c->data_->messenger_));
+  if (data_->messenger_) {
+    c->data_->messenger_ = data_->messenger_;
+  } else {
+    MessengerBuilder builder(data_->client_name_);
+    builder.set_num_reactors(data_->num_reactors_);
+    builder.set_metric_entity(data_->metric_entity_);
+    RETURN_NOT_OK(builder.Build(&c->data_->messenger_));
+  }
 
   c->data_->master_server_endpoint_ = data_->master_server_endpoint_;
   c->data_->master_server_addrs_ = data_->master_server_addrs_;
@@ -901,6 +912,7 @@ Status YBClient::OpenTable(const YBTableName& table_name, shared_ptr<YBTable>* t
   YBSchema schema;
   string table_id;
   PartitionSchema partition_schema;
+  std::vector<IndexInfoPB> indexes;
   MonoTime deadline = MonoTime::Now(MonoTime::FINE);
   deadline.AddDelta(default_admin_operation_timeout());
   RETURN_NOT_OK(data_->GetTableSchema(this,
@@ -908,7 +920,8 @@ Status YBClient::OpenTable(const YBTableName& table_name, shared_ptr<YBTable>* t
                                       deadline,
                                       &schema,
                                       &partition_schema,
-                                      &table_id));
+                                      &table_id,
+                                      &indexes));
 
   // In the future, probably will look up the table in some map to reuse YBTable
   // instances.
@@ -916,12 +929,80 @@ Status YBClient::OpenTable(const YBTableName& table_name, shared_ptr<YBTable>* t
                                            table_name,
                                            table_id,
                                            schema,
-                                           partition_schema));
+                                           partition_schema,
+                                           std::move(indexes)));
   RETURN_NOT_OK(ret->data_->Open());
   table->swap(ret);
   return Status::OK();
 }
 
+namespace {
+
+// Establishes the connection to a tablet server by resolving its address and sending it a NoOp.
+// Owns itself, since the client may give up waiting before the connection is established.
+class ConnectionWarmUp {
+ public:
+  ConnectionWarmUp(internal::RemoteTabletServer* ts, const MonoTime& deadline,
+                   std::shared_ptr<CountDownLatch> latch)
+      : ts_(ts), latch_(std::move(latch)) {
+    controller_.set_deadline(deadline);
+  }
+
+  void Start(YBClient* client) {
+    ts_->InitProxy(client, Bind(&ConnectionWarmUp::ProxyReady, Unretained(this)));
+  }
+
+ private:
+  void ProxyReady(const Status& status) {
+    if (!status.ok()) {
+      Finished(status);
+      return;
+    }
+    ts_->proxy()->NoOpAsync(req_, &resp_, &controller_, [this] {
+      Finished(controller_.status());
+    });
+  }
+
+  void Finished(const Status& status) {
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to connect to " << ts_->ToString() << ": " << status.ToString();
+    }
+    latch_->CountDown();
+    delete this;
+  }
+
+  internal::RemoteTabletServer* const ts_;
+  std::shared_ptr<CountDownLatch> latch_;
+  tserver::NoOpRequestPB req_;
+  tserver::NoOpResponsePB resp_;
+  rpc::RpcController controller_;
+};
+
+}  // anonymous namespace
+
+Status YBClient::WarmUp(const std::vector<YBTableName>& table_names, const MonoDelta& timeout) {
+  MonoTime deadline = MonoTime::Now(MonoTime::FINE);
+  deadline.AddDelta(timeout);
+
+  std::set<internal::RemoteTabletServer*> servers;
+  for (const auto& table_name : table_names) {
+    shared_ptr<YBTable> table;
+    RETURN_NOT_OK(OpenTable(table_name, &table));
+    table->data_->PrefetchTabletLocations(std::string(), deadline);
+    data_->meta_cache_->GetTableTabletServers(table->id(), &servers);
+  }
+
+  auto latch = std::make_shared<CountDownLatch>(servers.size());
+  for (auto* ts : servers) {
+    (new ConnectionWarmUp(ts, deadline, latch))->Start(this);
+  }
+  if (!latch->WaitUntil(deadline)) {
+    LOG(WARNING) << latch->count() << " of " << servers.size()
+                 << " tablet server connections were not established in " << timeout.ToString();
+  }
+  return Status::OK();
+}
+
 shared_ptr<YBSession> YBClient::NewSession(bool read_only) {
   return std::make_shared<YBSession>(shared_from_this(), read_only);
 }
@@ -987,6 +1068,12 @@ YBTableCreator& YBTableCreator::num_tablets(int32_t count) {
   return *this;
 }
 
+YBTableCreator& YBTableCreator::indexed_table(const YBTable& indexed_table) {
+  data_->indexed_table_name_ = indexed_table.name();
+  data_->indexed_table_id_ = indexed_table.id();
+  return *this;
+}
+
 YBTableCreator& YBTableCreator::schema(const YBSchema* schema) {
   data_->schema_ = schema;
   return *this;
@@ -1086,6 +1173,9 @@ Status YBTableCreator::Create() {
   req.set_name(data_->table_name_.table_name());
   req.mutable_namespace_()->set_name(data_->table_name_.resolved_namespace_name());
   req.set_table_type(data_->table_type_);
+  if (!data_->indexed_table_id_.empty()) {
+    req.mutable_index_info()->set_indexed_table_id(data_->indexed_table_id_);
+  }
 
   // Note that the check that the sum of min_num_replicas for each placement block being less or
   // equal than the overall placement info num_replicas is done on the master side and an error is
@@ -1180,6 +1270,13 @@ Status YBTableCreator::Create() {
     RETURN_NOT_OK(data_->client_->data_->WaitForCreateTableToFinish(data_->client_,
                                                                     data_->table_name_,
                                                                     deadline));
+    // Adding the index alters the indexed table. Wait until its tablets have the new version so
+    // that all subsequent writes maintain the index.
+    if (!data_->indexed_table_id_.empty()) {
+      RETURN_NOT_OK(data_->client_->data_->WaitForAlterTableToFinish(data_->client_,
+                                                                     data_->indexed_table_name_,
+                                                                     deadline));
+    }
   }
 
   LOG(INFO) << "Created table " << data_->table_name_.ToString()
@@ -1197,8 +1294,10 @@ YBTable::YBTable(
     const YBTableName& name,
     const string& table_id,
     const YBSchema& schema,
-    const PartitionSchema& partition_schema)
-  : data_(new YBTable::Data(client, name, table_id, schema, partition_schema)) {
+    const PartitionSchema& partition_schema,
+    std::vector<IndexInfoPB> indexes)
+  : data_(new YBTable::Data(
+        client, name, table_id, schema, partition_schema, std::move(indexes))) {
 }
 
 YBTable::~YBTable() {
@@ -1269,6 +1368,10 @@ const PartitionSchema& YBTable::partition_schema() const {
   return data_->partition_schema_;
 }
 
+const std::vector<IndexInfoPB>& YBTable::indexes() const {
+  return data_->indexes_;
+}
+
 YBPredicate* YBTable::NewComparisonPredicate(const Slice& col_name,
                                              YBPredicate::ComparisonOp op,
                                              YBValue* value) {
@@ -1334,10 +1437,6 @@ Status YBSession::Close() {
 }
 
 Status YBSession::SetFlushMode(FlushMode m) {
-  if (m == AUTO_FLUSH_BACKGROUND) {
-    return STATUS(NotSupported, "AUTO_FLUSH_BACKGROUND has not been implemented in the"
-        " c++ client (see KUDU-456).");
-  }
   if (data_->batcher_->HasPendingOperations()) {
     // TODO: there may be a more reasonable behavior here.
     return STATUS(IllegalState, "Cannot change flush mode when writes are buffered");
@@ -1380,6 +1479,17 @@ void YBSession::FlushAsync(YBStatusCallback* user_callback) {
   data_->FlushAsync(user_callback);
 }
 
+void YBSession::FlushAsync(StatusFunctor callback) {
+  data_->FlushAsync(MakeYBStatusFunctorCallback(std::move(callback)));
+}
+
+std::future<Status> YBSession::FlushFuture() {
+  auto promise = std::make_shared<std::promise<Status>>();
+  auto future = promise->get_future();
+  FlushAsync([promise](const Status& status) { promise->set_value(status); });
+  return future;
+}
+
 bool YBSession::HasPendingOperations() const {
   std::lock_guard<simple_spinlock> l(data_->lock_);
   if (data_->batcher_->HasPendingOperations()) {
@@ -1407,6 +1517,13 @@ void YBSession::ReadAsync(std::shared_ptr<YBOperation> yb_op, YBStatusCallback*
   FlushAsync(cb);
 }
 
+std::future<Status> YBSession::ReadFuture(std::shared_ptr<YBOperation> yb_op) {
+  CHECK(data_->read_only_);
+  CHECK(yb_op->read_only());
+  CHECK_OK(Apply(std::move(yb_op)));
+  return FlushFuture();
+}
+
 Status YBSession::Apply(std::shared_ptr<YBOperation> yb_op) {
   return data_->Apply(std::move(yb_op));
 }
@@ -1797,6 +1914,19 @@ Status YBScanner::SetCacheBlocks(bool cache_blocks) {
   return Status::OK();
 }
 
+Status YBScanner::SetPrefetch(bool prefetch) {
+  if (data_->open_) {
+    return STATUS(IllegalState, "Prefetching must be set before Open()");
+  }
+  data_->prefetch_ = prefetch;
+  return Status::OK();
+}
+
+Status YBScanner::SetStreamWindowBatches(uint32_t window) {
+  data_->stream_window_batches_ = window;
+  return Status::OK();
+}
+
 YBSchema YBScanner::GetProjectionSchema() const {
   return data_->client_projection_;
 }
@@ -1896,6 +2026,14 @@ void YBScanner::Close() {
 
   VLOG(1) << "Ending scan " << ToString();
 
+  // The prefetch request writes to the scanner, so it has to complete before the scanner is
+  // destroyed.
+  if (data_->prefetch_in_flight_) {
+    MonoTime rpc_deadline, batch_deadline;
+    WARN_NOT_OK(data_->WaitForPrefetch(&rpc_deadline, &batch_deadline),
+                "Prefetch failed while closing scanner");
+  }
+
   // Close the scanner on the server-side, if necessary.
   //
   // If the scan did not match any rows, the tserver will not assign a scanner ID.
@@ -1920,6 +2058,7 @@ void YBScanner::Close() {
 bool YBScanner::HasMoreRows() const {
   CHECK(data_->open_);
   return data_->data_in_open_ ||  // more data in hand
+      data_->prefetch_in_flight_ ||  // more data on its way
       data_->last_response_.has_more_results() ||  // more data in this tablet
       data_->MoreTablets();  // more tablets to scan, possibly with more data
 }
@@ -1931,10 +2070,6 @@ Status YBScanner::NextBatch(vector<YBRowResult>* rows) {
 }
 
 Status YBScanner::NextBatch(YBScanBatch* result) {
-  // TODO: do some double-buffering here -- when we return this batch
-  // we should already have fired off the RPC for the next batch, but
-  // need to do some swapping of the response objects around to avoid
-  // stomping on the memory the user is looking at.
   CHECK(data_->open_);
   CHECK(data_->proxy_);
 
@@ -1944,40 +2079,41 @@ Status YBScanner::NextBatch(YBScanBatch* result) {
     // We have data from a previous scan.
     VLOG(1) << "Extracting data from scan " << ToString();
     data_->data_in_open_ = false;
-    return result->data_->Reset(&data_->controller_,
-                                data_->projection_,
-                                &data_->client_projection_,
-                                make_gscoped_ptr(data_->last_response_.release_data()));
-  } else if (data_->last_response_.has_more_results()) {
+    RETURN_NOT_OK(result->data_->Reset(&data_->controller_,
+                                       data_->projection_,
+                                       &data_->client_projection_,
+                                       make_gscoped_ptr(data_->last_response_.release_data())));
+    data_->SendPrefetch();
+    return Status::OK();
+  } else if (data_->prefetch_in_flight_ || data_->last_response_.has_more_results()) {
     // More data is available in this tablet.
     VLOG(1) << "Continuing scan " << ToString();
 
-    // The user has specified a timeout 'data_->timeout_' which should
-    // apply to the total time for each call to NextBatch(). However,
-    // if this is a fault-tolerant scan, it's preferable to set a shorter
-    // timeout (the "default RPC timeout" for each individual RPC call --
-    // so that if the server is hung we have time to fail over and try a
-    // different server.
     MonoTime now = MonoTime::Now(MonoTime::FINE);
 
     MonoTime batch_deadline = now;
     batch_deadline.AddDelta(data_->timeout_);
 
     MonoTime rpc_deadline;
-    if (data_->is_fault_tolerant_) {
-      rpc_deadline = now;
-      rpc_deadline.AddDelta(data_->table_->client()->default_rpc_timeout());
-      rpc_deadline = MonoTime::Earliest(batch_deadline, rpc_deadline);
+    Status rpc_status;
+    if (data_->prefetch_in_flight_) {
+      // A prefetch that timed out at the deadline of its whole batch is reported as a timeout of
+      // this call, as the synchronous request would have been. Retries get the whole timeout of
+      // this call.
+      MonoTime prefetch_batch_deadline;
+      rpc_status = data_->WaitForPrefetch(&rpc_deadline, &prefetch_batch_deadline);
+      if (!rpc_status.ok() && rpc_deadline.Equals(prefetch_batch_deadline)) {
+        rpc_deadline = batch_deadline;
+      }
     } else {
-      rpc_deadline = batch_deadline;
+      rpc_deadline = data_->RpcDeadline(now, batch_deadline);
+      data_->controller_.Reset();
+      data_->controller_.set_deadline(rpc_deadline);
+      data_->PrepareRequest(YBScanner::Data::CONTINUE);
+      rpc_status = data_->proxy_->Scan(data_->next_req_,
+                                       &data_->last_response_,
+                                       &data_->controller_);
     }
-
-    data_->controller_.Reset();
-    data_->controller_.set_deadline(rpc_deadline);
-    data_->PrepareRequest(YBScanner::Data::CONTINUE);
-    Status rpc_status = data_->proxy_->Scan(data_->next_req_,
-                                            &data_->last_response_,
-                                            &data_->controller_);
     const Status server_status = data_->CheckForErrors();
 
     // Success case.
@@ -1986,10 +2122,12 @@ Status YBScanner::NextBatch(YBScanBatch* result) {
         data_->last_primary_key_ = data_->last_response_.last_primary_key();
       }
       data_->scan_attempts_ = 0;
-      return result->data_->Reset(&data_->controller_,
-                                  data_->projection_,
-                                  &data_->client_projection_,
-                                  make_gscoped_ptr(data_->last_response_.release_data()));
+      RETURN_NOT_OK(result->data_->Reset(&data_->controller_,
+                                         data_->projection_,
+                                         &data_->client_projection_,
+                                         make_gscoped_ptr(data_->last_response_.release_data())));
+      data_->SendPrefetch();
+      return Status::OK();
     }
 
     data_->scan_attempts_++;
@@ -34,6 +34,7 @@
 
 #include <stdint.h>
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -102,6 +103,7 @@ class MetaCache;
 class RemoteTablet;
 class RemoteTabletServer;
 class AsyncRpc;
+class ReadRpc;
 class TabletInvoker;
 }  // namespace internal
 
@@ -208,6 +210,11 @@ class YBClientBuilder {
   // proxy clients.
   YBClientBuilder& set_tserver_uuid(const TabletServerId& uuid);
 
+  // Sends the RPCs of the client over the given messenger instead of building one, so a client
+  // embedded in a server shares the negotiated connections of the server to masters and tablet
+  // servers. set_num_reactors and set_client_name do not affect the messenger then.
+  YBClientBuilder& use_messenger(const std::shared_ptr<rpc::Messenger>& messenger);
+
   // Creates the client.
   //
   // The return value may indicate an error in the create operation, or a
@@ -355,6 +362,12 @@ class YBClient : public std::enable_shared_from_this<YBClient> {
   CHECKED_STATUS OpenTable(const YBTableName& table_name,
                            std::shared_ptr<YBTable>* table);
 
+  // Prepares the client to serve the given tables at steady-state latency: opens them, caches the
+  // locations of all of their tablets and establishes the connections to the tablet servers
+  // hosting them in parallel. Returns an error if a table cannot be opened. Connections that are
+  // not established within 'timeout' are left to be established on first use.
+  CHECKED_STATUS WarmUp(const std::vector<YBTableName>& table_names, const MonoDelta& timeout);
+
   // Create a new session for interacting with the cluster.
   // User is responsible for destroying the session object.
   // This is a fully local operation (no RPCs or blocking).
@@ -444,16 +457,19 @@ class YBClient : public std::enable_shared_from_this<YBClient> {
   friend class internal::RemoteTablet;
   friend class internal::RemoteTabletServer;
   friend class internal::AsyncRpc;
+  friend class internal::ReadRpc;
   friend class internal::TabletInvoker;
   friend class PlacementInfoTest;
 
   FRIEND_TEST(ClientTest, TestGetTabletServerBlacklist);
   FRIEND_TEST(ClientTest, TestMasterDown);
   FRIEND_TEST(ClientTest, TestMasterLookupPermits);
+  FRIEND_TEST(ClientTest, TestPrefetchTabletLocations);
   FRIEND_TEST(ClientTest, TestReplicatedMultiTabletTableFailover);
   FRIEND_TEST(ClientTest, TestReplicatedTabletWritesWithLeaderElection);
   FRIEND_TEST(ClientTest, TestScanFaultTolerance);
   FRIEND_TEST(ClientTest, TestScanTimeout);
+  FRIEND_TEST(ClientTest, TestWarmUp);
   FRIEND_TEST(ClientTest, TestWriteWithDeadMaster);
   FRIEND_TEST(MasterFailoverTest, DISABLED_TestPauseAfterCreateTableIssued);
 
@@ -531,6 +547,10 @@ class YBTableCreator {
   // the lifetime of the builder. Required.
   YBTableCreator& schema(const YBSchema* schema);
 
+  // Creates the table as a secondary index of the given table. The columns of the index must have
+  // the same names as the indexed table's columns they copy.
+  YBTableCreator& indexed_table(const YBTable& indexed_table);
+
   // Adds a set of hash partitions to the table.
   //
   // For each set of hash partitions added to the table, the total number of
@@ -675,6 +695,9 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
 
   const PartitionSchema& partition_schema() const;
 
+  // Secondary indexes of the table.
+  const std::vector<IndexInfoPB>& indexes() const;
+
  private:
   class Data;
 
@@ -684,7 +707,8 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
           const YBTableName& name,
           const std::string& table_id,
           const YBSchema& schema,
-          const PartitionSchema& partition_schema);
+          const PartitionSchema& partition_schema,
+          std::vector<IndexInfoPB> indexes);
 
   // Owned.
   Data* data_;
@@ -862,20 +886,20 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
 
     // Apply() calls will return immediately, but the writes will be sent in
     // the background, potentially batched together with other writes from
-    // the same session. If there is not sufficient buffer space, then Apply()
-    // may block for buffer space to be available.
+    // the same session. A write is sent right away when no earlier batch of
+    // the session is in flight. Otherwise it is buffered until the next
+    // Apply() after that batch completes, or until
+    // --yb_session_background_flush_max_ops writes have been buffered. Writes
+    // sent in different batches may be applied in any order.
     //
     // Because writes are applied in the background, any errors will be stored
     // in a session-local buffer. Call CountPendingErrors() or GetPendingErrors()
     // to retrieve them.
     // TODO: provide an API for the user to specify a callback to do their own
     // error reporting.
-    // TODO: specify which threads the background activity runs on (probably the
-    // messenger IO threads?)
-    //
-    // NOTE: This is not implemented yet, see KUDU-456.
     //
-    // The Flush() call can be used to block until the buffer is empty.
+    // The Flush() call sends the buffered writes and blocks until all writes
+    // of the session have completed.
     AUTO_FLUSH_BACKGROUND,
 
     // Apply() calls will return immediately, and the writes will not be
@@ -949,6 +973,9 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
 
   void ReadAsync(std::shared_ptr<YBOperation> yb_op, YBStatusCallback* cb);
 
+  // Same as ReadAsync, but the returned future becomes ready with the status of the read.
+  std::future<Status> ReadFuture(std::shared_ptr<YBOperation> yb_op);
+
   // TODO: add "doAs" ability here for proxy servers to be able to act on behalf of
   // other users, assuming access rights.
 
@@ -1013,6 +1040,14 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
   CHECKED_STATUS Flush() WARN_UNUSED_RESULT;
   void FlushAsync(YBStatusCallback* cb);
 
+  // Same as above, but 'callback' is copied, so it does not have to outlive the flush.
+  void FlushAsync(StatusFunctor callback);
+
+  // Same as FlushAsync, but the returned future becomes ready with the status the callback would
+  // be called with. The future is completed by the thread that completes the flush, so no thread
+  // is blocked while the operations are in flight.
+  std::future<Status> FlushFuture();
+
   // Abort the unflushed or in-flight operations in the session.
   void Abort();
 
@@ -1214,6 +1249,17 @@ class YBScanner {
   // in memory and made available for future scans. Default is true.
   CHECKED_STATUS SetCacheBlocks(bool cache_blocks);
 
+  // Set whether the next batch of the tablet being scanned is requested as soon as NextBatch
+  // returns the current one, so that the tablet server produces it while the caller consumes the
+  // current batch. Close() waits for the batch being prefetched. Default is false.
+  CHECKED_STATUS SetPrefetch(bool prefetch);
+
+  // Set the number of batches the tablet server may scan ahead of the requests for them, so the
+  // following batches are sent without waiting for the scan. Larger windows use more memory on
+  // the tablet server. Works best together with SetPrefetch. Default is 0, i.e. batches are only
+  // scanned when requested.
+  CHECKED_STATUS SetStreamWindowBatches(uint32_t window);
+
   // Begin scanning.
   CHECKED_STATUS Open();
 
@@ -1316,6 +1362,7 @@ class YBScanner {
   class Data;
 
   FRIEND_TEST(ClientTest, TestScanCloseProxy);
+  FRIEND_TEST(ClientTest, TestScanPrefetch);
   FRIEND_TEST(ClientTest, TestScanFaultTolerance);
   FRIEND_TEST(ClientTest, TestScanNoBlockCaching);
   FRIEND_TEST(ClientTest, TestScanTimeout);
@@ -32,6 +32,7 @@
 #ifndef YB_CLIENT_CLIENT_BUILDER_INTERNAL_H_
 #define YB_CLIENT_CLIENT_BUILDER_INTERNAL_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -75,6 +76,9 @@ class YBClientBuilder::Data {
   TabletServerId uuid_;
 
   bool skip_master_leader_resolution_ = false;
+
+  // Messenger shared with the embedding server, if any.
+  std::shared_ptr<rpc::Messenger> messenger_;
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
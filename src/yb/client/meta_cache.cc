@@ -338,7 +338,7 @@ void MetaCache::AddTabletServerProxy(const string& permanent_uuid,
 }
 
 void MetaCache::UpdateTabletServer(const master::TSInfoPB& pb) {
-  DCHECK(lock_.is_write_locked());
+  DCHECK(lock_.is_locked());
   const std::string& permanent_uuid = pb.permanent_uuid();
   auto it = ts_cache_.find(permanent_uuid);
   if (it != ts_cache_.end()) {
@@ -565,7 +565,7 @@ RemoteTabletPtr MetaCache::ProcessTabletLocations(
   RemoteTabletPtr result;
   bool first = true;
 
-  std::lock_guard<rw_spinlock> l(lock_);
+  std::lock_guard<percpu_rwlock> l(lock_);
   for (const TabletLocationsPB& loc : locations) {
     TabletMap& tablets_by_key = tablets_by_table_and_key_[loc.table_id()];
     // First, update the tserver cache, needed for the Refresh calls below.
@@ -711,7 +711,7 @@ class LookupByKeyRpc : public LookupRpc {
 
 RemoteTabletPtr MetaCache::LookupTabletByKeyFastPath(const YBTable* table,
                                                      const string& partition_key) {
-  shared_lock<rw_spinlock> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table->id());
   if (PREDICT_FALSE(!tablets)) {
     // No cache available for this table.
@@ -739,7 +739,7 @@ RemoteTabletPtr MetaCache::LookupTabletByKeyFastPath(const YBTable* table,
 }
 
 RemoteTabletPtr MetaCache::LookupTabletByIdFastPath(const std::string& tablet_id) {
-  shared_lock<rw_spinlock> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   auto it = tablets_by_id_.find(tablet_id);
   if (it != tablets_by_id_.end()) {
     return it->second;
@@ -776,7 +776,7 @@ void MetaCache::LookupTabletById(const string& tablet_id,
 void MetaCache::MarkTSFailed(RemoteTabletServer* ts,
                              const Status& status) {
   LOG(INFO) << "Marking tablet server " << ts->ToString() << " as failed.";
-  shared_lock<rw_spinlock> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
 
   Status ts_status = status.CloneAndPrepend("TS failed");
 
@@ -788,6 +788,28 @@ void MetaCache::MarkTSFailed(RemoteTabletServer* ts,
   }
 }
 
+void MetaCache::AddTabletLocations(
+    const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations) {
+  if (!locations.empty()) {
+    ProcessTabletLocations(locations);
+  }
+}
+
+void MetaCache::GetTableTabletServers(const string& table_id,
+                                      std::set<RemoteTabletServer*>* servers) {
+  shared_lock<rw_spinlock> l(lock_.get_lock());
+  const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table_id);
+  if (tablets == nullptr) {
+    return;
+  }
+  std::vector<RemoteTabletServer*> tablet_servers;
+  for (const auto& entry : *tablets) {
+    tablet_servers.clear();
+    entry.second->GetRemoteTabletServers(&tablet_servers);
+    servers->insert(tablet_servers.begin(), tablet_servers.end());
+  }
+}
+
 bool MetaCache::AcquireMasterLookupPermit() {
   return master_lookup_sem_.TryAcquire();
 }
@@ -36,6 +36,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -77,6 +78,7 @@ class TSInfoPB;
 namespace client {
 
 class ClientTest_TestMasterLookupPermits_Test;
+class ClientTest_TestPrefetchTabletLocations_Test;
 class YBClient;
 class YBTable;
 
@@ -268,6 +270,14 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   // not be returned in future cache lookups.
   void MarkTSFailed(RemoteTabletServer* ts, const Status& status);
 
+  // Caches tablet locations fetched from the master outside of the lookups above, e.g. when a
+  // table is opened.
+  void AddTabletLocations(
+      const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations);
+
+  // Adds the tablet servers hosting the cached tablets of the given table to 'servers'.
+  void GetTableTabletServers(const std::string& table_id, std::set<RemoteTabletServer*>* servers);
+
   // Acquire or release a permit to perform a (slow) master lookup.
   //
   // If acquisition fails, caller may still do the lookup, but is first
@@ -281,6 +291,8 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   friend class LookupByIdRpc;
 
   FRIEND_TEST(client::ClientTest, TestMasterLookupPermits);
+  FRIEND_TEST(client::ClientTest, TestPrefetchTabletLocations);
+  FRIEND_TEST(client::ClientTest, TestWarmUp);
 
   // Called on the slow LookupTablet path when the master responds. Populates
   // the tablet caches and returns a reference to the first one.
@@ -304,7 +316,10 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
 
   YBClient* client_;
 
-  rw_spinlock lock_;
+  // Every op flushed by a Batcher looks its tablet up here, while the caches are only updated on
+  // master lookups. So readers take the lock of their own CPU only and do not contend with each
+  // other.
+  percpu_rwlock lock_;
 
   // Cache of Tablet Server locations: TS UUID -> RemoteTabletServer*.
   //
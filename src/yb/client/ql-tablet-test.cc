@@ -22,6 +22,8 @@
 
 #include "yb/client/ql-dml-test-base.h"
 
+#include "yb/common/wire_protocol.h"
+
 #include "yb/consensus/consensus.pb.h"
 
 #include "yb/master/catalog_manager.h"
@@ -29,6 +31,7 @@
 
 #include "yb/ql/util/statement_result.h"
 
+#include "yb/tserver/backup.proxy.h"
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -41,6 +44,7 @@ namespace yb {
 namespace client {
 
 using ql::RowsResult;
+using tserver::TabletSnapshotOpRequestPB;
 
 namespace {
 
@@ -269,6 +273,79 @@ class QLTabletTest : public QLDmlTestBase {
     return Status::OK();
   }
 
+  // Ingests the files of the first replica of each source tablet through the leader of the
+  // corresponding destination tablet, so all replicas use the same source directory.
+  CHECKED_STATUS IngestFiles() {
+    std::this_thread::sleep_for(1s); // Wait until all tablets are synced and flushed.
+    cluster_->FlushTablets();
+
+    auto source_infos = GetTabletInfos(kTable1Name);
+    auto dest_infos = GetTabletInfos(kTable2Name);
+    auto* source_manager = cluster_->mini_tablet_server(0)->server()->tablet_manager();
+    for (size_t j = 0; j != source_infos.size(); ++j) {
+      tablet::TabletPeerPtr source_peer;
+      source_manager->LookupTablet(source_infos[j]->id(), &source_peer);
+      EXPECT_NE(nullptr, source_peer);
+
+      tserver::IngestFilesRequestPB req;
+      req.set_tablet_id(dest_infos[j]->id());
+      req.set_source_dir(source_peer->tablet()->metadata()->rocksdb_dir());
+      auto* server = LeaderServer(dest_infos[j]->id());
+      if (!server) {
+        return STATUS_FORMAT(NotFound, "No leader for $0", dest_infos[j]->id());
+      }
+      tserver::TabletServerServiceProxy proxy(
+          server->messenger(), server->rpc_server()->GetBoundAddresses().front());
+      tserver::IngestFilesResponsePB resp;
+      rpc::RpcController controller;
+      controller.set_timeout(MonoDelta::FromSeconds(10));
+      RETURN_NOT_OK(proxy.IngestFiles(req, &resp, &controller));
+      if (resp.has_error()) {
+        return StatusFromPB(resp.error().status());
+      }
+    }
+    return Status::OK();
+  }
+
+  // Performs the snapshot operation on all tablets of the table through their leaders.
+  CHECKED_STATUS SnapshotOp(const YBTableName& table_name,
+                            const std::string& snapshot_id,
+                            TabletSnapshotOpRequestPB::Operation operation) {
+    for (const auto& info : GetTabletInfos(table_name)) {
+      auto* server = LeaderServer(info->id());
+      if (!server) {
+        return STATUS_FORMAT(NotFound, "No leader for $0", info->id());
+      }
+      tserver::TabletServerBackupServiceProxy proxy(
+          server->messenger(), server->rpc_server()->GetBoundAddresses().front());
+      TabletSnapshotOpRequestPB req;
+      req.set_dest_uuid(server->permanent_uuid());
+      req.set_tablet_id(info->id());
+      req.set_snapshot_id(snapshot_id);
+      req.set_operation(operation);
+      tserver::TabletSnapshotOpResponsePB resp;
+      rpc::RpcController controller;
+      controller.set_timeout(MonoDelta::FromSeconds(30));
+      RETURN_NOT_OK(proxy.TabletSnapshotOp(req, &resp, &controller));
+      if (resp.has_error()) {
+        return StatusFromPB(resp.error().status());
+      }
+    }
+    return Status::OK();
+  }
+
+  tserver::TabletServer* LeaderServer(const std::string& tablet_id) {
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* server = cluster_->mini_tablet_server(i)->server();
+      tablet::TabletPeerPtr peer;
+      server->tablet_manager()->LookupTablet(tablet_id, &peer);
+      if (peer && peer->LeaderStatus() == consensus::Consensus::LeaderStatus::LEADER_AND_READY) {
+        return server;
+      }
+    }
+    return nullptr;
+  }
+
   scoped_refptr<master::TableInfo> GetTableInfo(const YBTableName& table_name) {
     auto* catalog_manager = cluster_->leader_mini_master()->master()->catalog_manager();
     std::vector<scoped_refptr<master::TableInfo>> all_tables;
@@ -338,6 +415,41 @@ TEST_F(QLTabletTest, ImportToNonEmptyAndRestart) {
   VerifyTable(0, 2 * kTotalKeys, &table2_);
 }
 
+TEST_F(QLTabletTest, IngestFilesAndRestart) {
+  CreateTables(0, kBigSeqNo);
+
+  FillTable(0, kTotalKeys, &table1_);
+  FillTable(kTotalKeys, 2 * kTotalKeys, &table2_);
+
+  ASSERT_OK(IngestFiles());
+  VerifyTable(0, 2 * kTotalKeys, &table2_);
+  ASSERT_OK(WaitSync(0, 2 * kTotalKeys, &table2_));
+
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyTable(0, kTotalKeys, &table1_);
+  VerifyTable(0, 2 * kTotalKeys, &table2_);
+}
+
+TEST_F(QLTabletTest, SnapshotRestore) {
+  CreateTables(0, kBigSeqNo);
+
+  FillTable(0, kTotalKeys, &table1_);
+  ASSERT_OK(SnapshotOp(kTable1Name, "snapshot", TabletSnapshotOpRequestPB::CREATE_ON_TABLET));
+
+  FillTable(kTotalKeys, 2 * kTotalKeys, &table1_);
+  ASSERT_OK(SnapshotOp(kTable1Name, "snapshot", TabletSnapshotOpRequestPB::RESTORE_ON_TABLET));
+  VerifyTable(0, kTotalKeys, &table1_);
+  ASSERT_FALSE(GetValue(client_->NewSession(true /* read_only */), kTotalKeys, &table1_));
+
+  // The restore is not undone by replaying the writes before it.
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyTable(0, kTotalKeys, &table1_);
+  ASSERT_FALSE(GetValue(client_->NewSession(true /* read_only */), kTotalKeys, &table1_));
+
+  ASSERT_OK(SnapshotOp(kTable1Name, "snapshot", TabletSnapshotOpRequestPB::DELETE_ON_TABLET));
+  ASSERT_NOK(SnapshotOp(kTable1Name, "snapshot", TabletSnapshotOpRequestPB::RESTORE_ON_TABLET));
+}
+
 TEST_F(QLTabletTest, LateImport) {
   CreateTables(kBigSeqNo, 0);
 
@@ -39,6 +39,7 @@ DECLARE_int32(log_min_seconds_to_retain);
 DECLARE_bool(transaction_disable_heartbeat_in_tests);
 DECLARE_double(transaction_ignore_applying_probability_in_tests);
 DECLARE_uint64(transaction_check_interval_usec);
+DECLARE_int32(transaction_apply_batch_size_bytes);
 
 namespace yb {
 namespace client {
@@ -246,6 +247,17 @@ TEST_F(QLTransactionTest, Simple) {
   CHECK_OK(cluster_->RestartSync());
 }
 
+// Applies intents of each transaction using several write batches.
+TEST_F(QLTransactionTest, ApplyInSmallBatches) {
+  google::FlagSaver flag_saver;
+
+  FLAGS_transaction_apply_batch_size_bytes = 1;
+  WriteData();
+  VerifyData();
+  CHECK_OK(cluster_->RestartSync());
+  VerifyData();
+}
+
 TEST_F(QLTransactionTest, InsertUpdate) {
   google::FlagSaver flag_saver;
 
@@ -258,6 +270,20 @@ TEST_F(QLTransactionTest, InsertUpdate) {
   CHECK_OK(cluster_->RestartSync());
 }
 
+TEST_F(QLTransactionTest, OnePhaseCommit) {
+  auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+  auto session = CreateSession(false /* read_only */, tc);
+  tc->AllowOnePhaseCommit();
+  const auto key = KeyForTransactionAndIndex(0, 0);
+  const auto value = ValueForTransactionAndIndex(0, 0, WriteOpType::INSERT);
+  ASSERT_OK(WriteRow(session, key, value));
+  CommitAndResetSync(&tc);
+
+  // Transaction was committed without status tablet.
+  ASSERT_EQ(0, CountTransactions());
+  VerifyRow(CreateSession(true /* read_only */), key, value);
+}
+
 TEST_F(QLTransactionTest, Cleanup) {
   WriteData();
   std::this_thread::sleep_for(1s); // TODO(dtxn)
@@ -281,6 +307,29 @@ TEST_F(QLTransactionTest, Heartbeat) {
   VerifyData();
 }
 
+// Keeps many transactions alive using batched heartbeats.
+TEST_F(QLTransactionTest, HeartbeatMany) {
+  constexpr size_t kTransactions = 20;
+  std::vector<YBTransactionPtr> transactions;
+  for (size_t i = 0; i != kTransactions; ++i) {
+    auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, tc);
+    WriteRows(session, i);
+    transactions.push_back(std::move(tc));
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(FLAGS_transaction_timeout_usec * 2));
+  CountDownLatch latch(kTransactions);
+  for (auto& transaction : transactions) {
+    transaction->Commit([&latch](const Status& status) {
+      EXPECT_OK(status);
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  std::this_thread::sleep_for(3s); // Wait long enough for transactions to be applied.
+  VerifyData(kTransactions);
+}
+
 TEST_F(QLTransactionTest, Expire) {
   DontVerifyClusterBeforeNextTearDown(); // TODO(dtxn) temporary
 
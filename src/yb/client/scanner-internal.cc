@@ -70,10 +70,13 @@ YBScanner::Data::Data(YBTable* table, const YBTransactionPtr& transaction)
     data_in_open_(false),
     has_batch_size_bytes_(false),
     batch_size_bytes_(0),
+    stream_window_batches_(0),
     selection_(YBClient::CLOSEST_REPLICA),
     read_mode_(READ_LATEST),
     is_fault_tolerant_(false),
     snapshot_hybrid_time_(kNoHybridTime),
+    prefetch_(false),
+    prefetch_in_flight_(false),
     table_(DCHECK_NOTNULL(table)),
     arena_(1024, 1024*1024),
     spec_encoder_(&internal::GetSchema(table->schema()), &arena_),
@@ -451,6 +454,49 @@ Status YBScanner::Data::KeepAlive() {
   return Status::OK();
 }
 
+void YBScanner::Data::SendPrefetch() {
+  if (!prefetch_ || !last_response_.has_more_results()) {
+    return;
+  }
+  DCHECK(!prefetch_in_flight_);
+  const MonoTime now = MonoTime::Now(MonoTime::FINE);
+  prefetch_batch_deadline_ = now;
+  prefetch_batch_deadline_.AddDelta(timeout_);
+  prefetch_rpc_deadline_ = RpcDeadline(now, prefetch_batch_deadline_);
+
+  prefetch_controller_.Reset();
+  prefetch_controller_.set_deadline(prefetch_rpc_deadline_);
+  prefetch_sync_.Reset();
+  PrepareRequest(YBScanner::Data::CONTINUE);
+  prefetch_in_flight_ = true;
+  proxy_->ScanAsync(next_req_, &prefetch_response_, &prefetch_controller_,
+                    [this] { prefetch_sync_.StatusCB(prefetch_controller_.status()); });
+}
+
+Status YBScanner::Data::WaitForPrefetch(MonoTime* rpc_deadline, MonoTime* batch_deadline) {
+  DCHECK(prefetch_in_flight_);
+  const Status status = prefetch_sync_.Wait();
+  prefetch_in_flight_ = false;
+  last_response_.Swap(&prefetch_response_);
+  controller_.Swap(&prefetch_controller_);
+  *rpc_deadline = prefetch_rpc_deadline_;
+  *batch_deadline = prefetch_batch_deadline_;
+  return status;
+}
+
+MonoTime YBScanner::Data::RpcDeadline(const MonoTime& now, const MonoTime& batch_deadline) const {
+  // The user has specified a timeout 'timeout_' which should apply to the total time for each
+  // call to NextBatch(). However, if this is a fault-tolerant scan, it's preferable to set a
+  // shorter timeout (the "default RPC timeout" for each individual RPC call -- so that if the
+  // server is hung we have time to fail over and try a different server.
+  if (!is_fault_tolerant_) {
+    return batch_deadline;
+  }
+  MonoTime rpc_deadline = now;
+  rpc_deadline.AddDelta(table_->client()->default_rpc_timeout());
+  return MonoTime::Earliest(batch_deadline, rpc_deadline);
+}
+
 bool YBScanner::Data::MoreTablets() const {
   CHECK(open_);
   // TODO(KUDU-565): add a test which has a scan end on a tablet boundary
@@ -491,6 +537,12 @@ void YBScanner::Data::PrepareRequest(RequestType state) {
     next_req_.clear_batch_size_bytes();
   }
 
+  if (state != YBScanner::Data::CLOSE && stream_window_batches_ > 0) {
+    next_req_.set_stream_window_batches(stream_window_batches_);
+  } else {
+    next_req_.clear_stream_window_batches();
+  }
+
   if (state == YBScanner::Data::NEW) {
     next_req_.set_call_seq_id(0);
   } else {
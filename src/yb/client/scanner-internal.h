@@ -42,6 +42,7 @@
 #include "yb/common/scan_spec.h"
 #include "yb/common/predicate_encoder.h"
 #include "yb/tserver/tserver_service.proxy.h"
+#include "yb/util/async_util.h"
 
 namespace yb {
 
@@ -86,6 +87,17 @@ class YBScanner::Data {
 
   CHECKED_STATUS KeepAlive();
 
+  // Sends the request for the next batch of the current tablet, if prefetching is enabled and
+  // the tablet has more results.
+  void SendPrefetch();
+
+  // Waits for the prefetched batch and moves it to 'last_response_' and 'controller_'. Returns
+  // the RPC status and the deadlines the request was sent with.
+  CHECKED_STATUS WaitForPrefetch(MonoTime* rpc_deadline, MonoTime* batch_deadline);
+
+  // Returns the deadline of a single scan RPC of a NextBatch call that ends by 'batch_deadline'.
+  MonoTime RpcDeadline(const MonoTime& now, const MonoTime& batch_deadline) const;
+
   // Returns whether there exist more tablets we should scan.
   //
   // Note: there may not be any actual matching rows in subsequent tablets,
@@ -119,6 +131,8 @@ class YBScanner::Data {
   bool data_in_open_;
   bool has_batch_size_bytes_;
   uint32 batch_size_bytes_;
+  // See SetStreamWindowBatches.
+  uint32 stream_window_batches_;
   YBClient::ReplicaSelection selection_;
 
   ReadMode read_mode_;
@@ -144,6 +158,18 @@ class YBScanner::Data {
   // RPC controller for the last in-flight RPC.
   rpc::RpcController controller_;
 
+  // Whether the next batch is requested before the caller asks for it, see SetPrefetch.
+  bool prefetch_;
+
+  // State of the prefetch request. It is only sent after 'last_response_' and 'controller_' were
+  // handed to the returned batch, and it is moved into them by WaitForPrefetch.
+  bool prefetch_in_flight_;
+  tserver::ScanResponsePB prefetch_response_;
+  rpc::RpcController prefetch_controller_;
+  MonoTime prefetch_rpc_deadline_;
+  MonoTime prefetch_batch_deadline_;
+  Synchronizer prefetch_sync_;
+
   // The table we're scanning.
   YBTable* table_;
 
@@ -38,6 +38,13 @@
 #include "yb/client/batcher.h"
 #include "yb/client/callbacks.h"
 #include "yb/client/error_collector.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_int32(yb_session_background_flush_max_ops, 1000,
+             "In AUTO_FLUSH_BACKGROUND mode, operations applied while an earlier batch of the "
+             "session is in flight are buffered until the batch completes, or until this many "
+             "of them have been buffered.");
+TAG_FLAG(yb_session_background_flush_max_ops, advanced);
 
 namespace yb {
 
@@ -85,9 +92,47 @@ scoped_refptr<Batcher> YBSessionData::NewBatcher() {
   return batcher;
 }
 
+namespace {
+
+// Background flushes report the errors of their operations through the error collector only.
+class IgnoreStatusCallback : public YBStatusCallback {
+ public:
+  void Run(const Status& status) override {}
+};
+
+IgnoreStatusCallback ignore_status_callback;
+
+} // namespace
+
 void YBSessionData::FlushFinished(Batcher* batcher) {
-  std::lock_guard<simple_spinlock> l(lock_);
-  CHECK_EQ(flushed_batchers_.erase(batcher), 1);
+  std::vector<YBStatusCallback*> waiters;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    CHECK_EQ(flushed_batchers_.erase(batcher), 1);
+    if (flushed_batchers_.empty()) {
+      waiters.swap(flush_waiters_);
+    }
+  }
+  if (!waiters.empty()) {
+    const Status s = error_collector_->CountErrors() > 0 ?
+        STATUS(IOError, "Some errors occurred") : Status::OK();
+    for (auto* waiter : waiters) {
+      waiter->Run(s);
+    }
+  }
+}
+
+void YBSessionData::MaybeFlushInBackground() {
+  // Flushing only when the previous batch has completed lets the batches grow with the latency
+  // of the RPCs they are sent in.
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    if (!flushed_batchers_.empty() &&
+        batcher_->CountBufferedOperations() < FLAGS_yb_session_background_flush_max_ops) {
+      return;
+    }
+  }
+  NewBatcher()->FlushAsync(&ignore_status_callback);
 }
 
 void YBSessionData::Abort() {
@@ -105,7 +150,23 @@ Status YBSessionData::Close(bool force) {
 }
 
 void YBSessionData::FlushAsync(YBStatusCallback* callback) {
-  CHECK_NE(flush_mode_, YBSession::AUTO_FLUSH_BACKGROUND) << "TODO: handle flush background mode";
+  if (flush_mode_ == YBSession::AUTO_FLUSH_BACKGROUND) {
+    // Send the buffered operations and call back once they and the ones flushed in background
+    // earlier have completed.
+    if (batcher_->CountBufferedOperations() > 0) {
+      NewBatcher()->FlushAsync(&ignore_status_callback);
+    }
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (!flushed_batchers_.empty()) {
+        flush_waiters_.push_back(callback);
+        return;
+      }
+    }
+    callback->Run(error_collector_->CountErrors() > 0 ?
+        STATUS(IOError, "Some errors occurred") : Status::OK());
+    return;
+  }
 
   // Swap in a new batcher to start building the next batch.
   // Save off the old batcher.
@@ -141,6 +202,9 @@ Status YBSessionData::Apply(std::shared_ptr<YBOperation> yb_op) {
   if (flush_mode_ == YBSession::AUTO_FLUSH_SYNC) {
     return Flush();
   }
+  if (flush_mode_ == YBSession::AUTO_FLUSH_BACKGROUND) {
+    MaybeFlushInBackground();
+  }
 
   return Status::OK();
 }
@@ -33,6 +33,7 @@
 #define YB_CLIENT_SESSION_INTERNAL_H_
 
 #include <unordered_set>
+#include <vector>
 
 #include "yb/client/async_rpc.h"
 #include "yb/client/client.h"
@@ -72,6 +73,10 @@ class YBSessionData : public std::enable_shared_from_this<YBSessionData> {
   // Called by Batcher when a flush has finished.
   void FlushFinished(internal::Batcher* b);
 
+  // In AUTO_FLUSH_BACKGROUND mode, flushes the buffered operations if no earlier batch is in
+  // flight or if enough operations have been buffered meanwhile.
+  void MaybeFlushInBackground();
+
   // Abort the unflushed or in-flight operations.
   void Abort();
 
@@ -112,6 +117,9 @@ class YBSessionData : public std::enable_shared_from_this<YBSessionData> {
   // pointers stay valid.
   std::unordered_set<internal::Batcher*> flushed_batchers_;
 
+  // Callbacks of AUTO_FLUSH_BACKGROUND mode flushes, called once flushed_batchers_ drains.
+  std::vector<YBStatusCallback*> flush_waiters_;
+
   YBSession::FlushMode flush_mode_ = YBSession::AUTO_FLUSH_SYNC;
   YBSession::ExternalConsistencyMode external_consistency_mode_ = YBSession::CLIENT_PROPAGATED;
 
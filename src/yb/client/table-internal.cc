@@ -35,14 +35,26 @@
 #include <string>
 
 #include "yb/client/client-internal.h"
+#include "yb/client/meta_cache.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/sysinfo.h"
 #include "yb/master/master.pb.h"
 #include "yb/master/master.proxy.h"
 #include "yb/rpc/rpc_controller.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/monotime.h"
 
+DEFINE_bool(yb_client_prefetch_tablet_locations, false,
+            "Whether opening a table fetches the locations of all of its tablets into the client's "
+            "meta cache, instead of looking them up from the master on first use of each tablet.");
+TAG_FLAG(yb_client_prefetch_tablet_locations, advanced);
+
+DEFINE_int32(yb_client_tablet_locations_page_size, 100,
+             "Number of tablet locations requested per master RPC when prefetching the tablet "
+             "locations of a table being opened.");
+TAG_FLAG(yb_client_tablet_locations_page_size, advanced);
+
 namespace yb {
 
 using master::GetTableLocationsRequestPB;
@@ -79,14 +91,16 @@ YBTable::Data::Data(
     YBTableName name,
     string id,
     const YBSchema& schema,
-    PartitionSchema partition_schema)
+    PartitionSchema partition_schema,
+    std::vector<IndexInfoPB> indexes)
   : client_(std::move(client)),
     name_(std::move(name)),
     // The table type is set after the table is opened.
     table_type_(YBTableType::UNKNOWN_TABLE_TYPE),
     id_(std::move(id)),
     schema_(schema),
-    partition_schema_(std::move(partition_schema)) {
+    partition_schema_(std::move(partition_schema)),
+    indexes_(std::move(indexes)) {
 }
 
 YBTable::Data::~Data() {
@@ -101,6 +115,9 @@ Status YBTable::Data::Open() {
   deadline.AddDelta(client_->default_admin_operation_timeout());
 
   req.mutable_table()->set_table_id(id_);
+  if (FLAGS_yb_client_prefetch_tablet_locations) {
+    req.set_max_returned_locations(FLAGS_yb_client_tablet_locations_page_size);
+  }
   Status s;
   // TODO: replace this with Async RPC-retrier based RPC in the next revision,
   // adding exponential backoff and allowing this to be used safely in a
@@ -188,8 +205,49 @@ Status YBTable::Data::Open() {
 
   VLOG(1) << "Open Table " << name_.ToString() << ", found "
           << resp.tablet_locations_size() << " tablets";
+
+  // Cache the locations returned already so the first operations on these tablets do not need
+  // to look them up again.
+  client_->data_->meta_cache_->AddTabletLocations(resp.tablet_locations());
+  const string& next_key =
+      resp.tablet_locations(resp.tablet_locations_size() - 1).partition().partition_key_end();
+  if (FLAGS_yb_client_prefetch_tablet_locations && !next_key.empty()) {
+    PrefetchTabletLocations(next_key, deadline);
+  }
   return Status::OK();
 }
 
+void YBTable::Data::PrefetchTabletLocations(string partition_key_start,
+                                            const MonoTime& deadline) {
+  // The prefetch is best-effort: the tablets not cached here are still looked up on first use.
+  GetTableLocationsRequestPB req;
+  req.mutable_table()->set_table_id(id_);
+  req.set_max_returned_locations(FLAGS_yb_client_tablet_locations_page_size);
+  GetTableLocationsResponsePB page;
+  while (MonoTime::Now(MonoTime::FINE).ComesBefore(deadline)) {
+    req.set_partition_key_start(partition_key_start);
+    page.Clear();
+    RpcController rpc;
+    MonoTime rpc_deadline = MonoTime::Now(MonoTime::FINE);
+    rpc_deadline.AddDelta(client_->default_rpc_timeout());
+    rpc.set_deadline(MonoTime::Earliest(rpc_deadline, deadline));
+    Status s = client_->data_->master_proxy()->GetTableLocations(req, &page, &rpc);
+    if (s.ok() && page.has_error()) {
+      s = StatusFromPB(page.error().status());
+    }
+    if (!s.ok() || page.tablet_locations_size() == 0) {
+      LOG_IF(WARNING, !s.ok()) << "Failed to prefetch tablet locations of table "
+                               << name_.ToString() << ": " << s.ToString();
+      return;
+    }
+    client_->data_->meta_cache_->AddTabletLocations(page.tablet_locations());
+    partition_key_start =
+        page.tablet_locations(page.tablet_locations_size() - 1).partition().partition_key_end();
+    if (partition_key_start.empty()) {
+      return;
+    }
+  }
+}
+
 }  // namespace client
 }  // namespace yb
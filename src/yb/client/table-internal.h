@@ -36,6 +36,7 @@
 
 #include "yb/common/partition.h"
 #include "yb/client/client.h"
+#include "yb/master/master.pb.h"
 
 namespace yb {
 
@@ -47,11 +48,16 @@ class YBTable::Data {
        YBTableName name,
        std::string table_id,
        const YBSchema& schema,
-       PartitionSchema partition_schema);
+       PartitionSchema partition_schema,
+       std::vector<IndexInfoPB> indexes);
   ~Data();
 
   CHECKED_STATUS Open();
 
+  // Fetches the locations of the tablets starting at 'partition_key_start' page by page and
+  // caches them.
+  void PrefetchTabletLocations(std::string partition_key_start, const MonoTime& deadline);
+
   std::shared_ptr<YBClient> client_;
 
   YBTableName name_;
@@ -63,6 +69,7 @@ class YBTable::Data {
   // a new YBTable instance (which would simplify the object lifecycle a little?)
   const YBSchema schema_;
   const PartitionSchema partition_schema_;
+  const std::vector<IndexInfoPB> indexes_;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
@@ -58,6 +58,10 @@ class YBTableCreator::Data {
 
   const YBSchema* schema_ = nullptr;
 
+  // For an index table, the name and id of the indexed table.
+  YBTableName indexed_table_name_;
+  TableId indexed_table_id_;
+
   std::vector<const YBPartialRow*> split_rows_;
 
   PartitionSchemaPB partition_schema_;
@@ -191,6 +191,15 @@ bool TabletInvoker::Done(Status* status) {
     *status = resp_error_status;
   }
 
+  // The follower is too far behind the leader to serve a read with bounded staleness, so retry it
+  // on the leader, that always has up to date data.
+  if (consistent_prefix_ &&
+      ErrorCode(rpc_->response_error()) == tserver::TabletServerErrorPB::STALE_FOLLOWER) {
+    consistent_prefix_ = false;
+    retrier_->DelayedRetry(command_, *status);
+    return false;
+  }
+
   // Oops, we failed over to a replica that wasn't a LEADER. Unlikely as
   // we're using consensus configuration information from the master, but still possible
   // (e.g. leader restarted and became a FOLLOWER). Try again.
@@ -74,6 +74,7 @@ class TabletInvoker {
 
   bool IsLocalCall() const;
   const RemoteTabletPtr& tablet() const { return tablet_; }
+  RemoteTabletServer* current_ts() const { return current_ts_; }
   std::shared_ptr<tserver::TabletServerServiceProxy> proxy() const;
   YBClient& client() const { return *client_; }
 
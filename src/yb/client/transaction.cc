@@ -73,15 +73,31 @@ class YBTransaction::Impl final {
   bool Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
                Waiter waiter,
                TransactionMetadata* metadata,
-               HybridTime* propagated_hybrid_time) {
+               HybridTime* propagated_hybrid_time,
+               bool* one_phase_commit) {
     CHECK_NOTNULL(metadata);
     CHECK_NOTNULL(propagated_hybrid_time);
+    CHECK_NOTNULL(one_phase_commit);
 
     VLOG_WITH_PREFIX(1) << "Prepare";
 
     bool has_tablets_without_parameters = false;
     {
       std::lock_guard<std::mutex> lock(mutex_);
+      bool allow_one_phase_commit = allow_one_phase_commit_;
+      allow_one_phase_commit_ = false;
+      if (allow_one_phase_commit && tablets_.empty() && !one_phase_commit_ &&
+          CanCommitInOnePhase(ops)) {
+        // Status tablet is not required, so we don't wait until transaction is ready.
+        VLOG_WITH_PREFIX(1) << "Prepare, one phase commit";
+        one_phase_commit_ = true;
+        *metadata = metadata_;
+        *one_phase_commit = true;
+        *propagated_hybrid_time = manager_->Now();
+        return true;
+      }
+      *one_phase_commit = false;
+
       if (!ready_) {
         RequestStatusTablet();
         waiters_.push_back(std::move(waiter));
@@ -113,6 +129,10 @@ class YBTransaction::Impl final {
 
   void Flushed(
       const internal::InFlightOps& ops, const Status& status, HybridTime propagated_hybrid_time) {
+    if (one_phase_commit_) {
+      OnePhaseCommitFlushed(status, propagated_hybrid_time);
+      return;
+    }
     if (status.ok()) {
       manager_->UpdateClock(propagated_hybrid_time);
       std::lock_guard<std::mutex> lock(mutex_);
@@ -148,6 +168,16 @@ class YBTransaction::Impl final {
       }
       complete_.store(true, std::memory_order_release);
       commit_callback_ = std::move(callback);
+      if (one_phase_commit_) {
+        // Transaction is committed by its flush, so just report its status.
+        if (!one_phase_commit_flushed_) {
+          return;
+        }
+        auto status = one_phase_commit_status_;
+        lock.unlock();
+        commit_callback_(status);
+        return;
+      }
       if (tablets_.empty()) { // TODO(dtxn) abort empty transaction?
         commit_callback_(Status::OK());
         return;
@@ -173,7 +203,44 @@ class YBTransaction::Impl final {
     return metadata_.transaction_id;
   }
 
+  void AllowOnePhaseCommit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allow_one_phase_commit_ = true;
+  }
+
  private:
+  static bool CanCommitInOnePhase(const std::unordered_set<internal::InFlightOpPtr>& ops) {
+    if (ops.empty()) {
+      return false;
+    }
+    const auto* tablet = (**ops.begin()).tablet.get();
+    for (const auto& op : ops) {
+      if (op->tablet.get() != tablet || op->yb_op->read_only()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void OnePhaseCommitFlushed(const Status& status, HybridTime propagated_hybrid_time) {
+    VLOG_WITH_PREFIX(1) << "One phase commit flushed: " << status;
+    if (status.ok()) {
+      manager_->UpdateClock(propagated_hybrid_time);
+    }
+    CommitCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      one_phase_commit_flushed_ = true;
+      one_phase_commit_status_ = status;
+      if (complete_.load(std::memory_order_acquire)) {
+        callback = commit_callback_;
+      }
+    }
+    if (callback) {
+      callback(status);
+    }
+  }
+
   void DoCommit(const Status& status, const YBTransactionPtr& transaction) {
     VLOG_WITH_PREFIX(1) << Format("Commit, tablets: $0, status: $1", tablets_, status);
     if (!status.ok()) {
@@ -257,6 +324,16 @@ class YBTransaction::Impl final {
       return;
     }
 
+    if (status == TransactionStatus::PENDING) {
+      // Heartbeats of pending transactions are batched by transaction manager, while CREATED is
+      // sent immediately, since transaction is not ready until it is replicated.
+      manager_->SendHeartbeat(
+          status_tablet_, metadata_.transaction_id,
+          std::bind(&Impl::HeartbeatDone, this, _1, HybridTime::kInvalidHybridTime, status,
+                    transaction));
+      return;
+    }
+
     tserver::UpdateTransactionRequestPB req;
     req.set_tablet_id(status_tablet_->tablet_id());
     auto& state = *req.mutable_state();
@@ -330,6 +407,12 @@ class YBTransaction::Impl final {
   std::atomic<bool> complete_{false};
   // Transaction is successfully initialized and ready to process intents.
   bool ready_ = false;
+  // Whether the next flush could commit this transaction in one phase.
+  bool allow_one_phase_commit_ = false;
+  // Whether this transaction was committed in one phase.
+  bool one_phase_commit_ = false;
+  bool one_phase_commit_flushed_ = false;
+  Status one_phase_commit_status_;
   CommitCallback commit_callback_;
   Status error_;
   rpc::Rpcs::Handle heartbeat_handle_;
@@ -358,11 +441,17 @@ YBTransaction::YBTransaction(TransactionManager* manager,
 YBTransaction::~YBTransaction() {
 }
 
+void YBTransaction::AllowOnePhaseCommit() {
+  impl_->AllowOnePhaseCommit();
+}
+
 bool YBTransaction::Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
                             Waiter waiter,
                             TransactionMetadata* metadata,
-                            HybridTime* propagated_hybrid_time) {
-  return impl_->Prepare(ops, std::move(waiter), metadata, propagated_hybrid_time);
+                            HybridTime* propagated_hybrid_time,
+                            bool* one_phase_commit) {
+  return impl_->Prepare(
+      ops, std::move(waiter), metadata, propagated_hybrid_time, one_phase_commit);
 }
 
 void YBTransaction::Flushed(
@@ -47,15 +47,26 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
   // This function is used to init metadata of Write/Read request.
   // If we don't have enough information, then the function returns false and stores
   // waiter, that will be invoked when we obtain such information.
+  // one_phase_commit is set to true when ops should be committed by the write itself, see
+  // AllowOnePhaseCommit.
   bool Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
                Waiter waiter,
                TransactionMetadata* metadata,
-               HybridTime* propagated_hybrid_time);
+               HybridTime* propagated_hybrid_time,
+               bool* one_phase_commit);
 
   // Notifies transaction that specified ops were flushed with some status.
   void Flushed(
       const internal::InFlightOps& ops, const Status& status, HybridTime propagated_hybrid_time);
 
+  // Allows the next flush of this transaction to commit it in one phase, i.e. without intents,
+  // status tablet and apply step. This happens when nothing was flushed in this transaction yet,
+  // and all operations of this flush are writes to the same tablet. Otherwise the flush is
+  // processed as usual.
+  // Commit should be invoked after the flush in both cases. After one phase commit, it just
+  // reports the status of the flush.
+  void AllowOnePhaseCommit();
+
   // Commits this transaction.
   void Commit(CommitCallback callback);
 
@@ -15,17 +15,32 @@
 
 #include "yb/client/transaction_manager.h"
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "yb/rpc/rpc.h"
 #include "yb/rpc/thread_pool.h"
 #include "yb/rpc/tasks_pool.h"
 
+#include "yb/tserver/tserver_service.pb.h"
+
+#include "yb/util/flag_tags.h"
 #include "yb/util/random_util.h"
 
 #include "yb/client/client.h"
+#include "yb/client/meta_cache.h"
+#include "yb/client/transaction_rpc.h"
 
 DEFINE_uint64(transaction_table_default_num_tablets, 24,
               "Automatically create transaction table with specified number of tablets if missing. "
               "0 to disable.");
 
+DEFINE_int32(transaction_max_heartbeat_batch_size, 1000,
+             "Maximal number of transactions, whose heartbeats are sent in a single request to "
+             "the status tablet.");
+TAG_FLAG(transaction_max_heartbeat_batch_size, advanced);
+
 namespace yb {
 namespace client {
 
@@ -149,7 +164,112 @@ class TransactionManager::Impl {
     clock_->Update(time);
   }
 
+  void SendHeartbeat(const internal::RemoteTabletPtr& status_tablet,
+                     const TransactionId& id,
+                     HeartbeatCallback callback) {
+    std::unique_lock<std::mutex> lock(heartbeats_mutex_);
+    auto& batch = heartbeats_[status_tablet->tablet_id()];
+    if (!batch.tablet) {
+      batch.tablet = status_tablet;
+    }
+    batch.queued.emplace_back(id, std::move(callback));
+    if (batch.in_flight) {
+      return;
+    }
+    SendHeartbeats(status_tablet->tablet_id(), &batch, &lock);
+  }
+
  private:
+  typedef std::vector<std::pair<TransactionId, HeartbeatCallback>> Heartbeats;
+
+  // There is at most one heartbeat request in flight to each status tablet. Heartbeats of
+  // transactions that are sent meanwhile are queued, and sent in the next request.
+  struct HeartbeatBatch {
+    internal::RemoteTabletPtr tablet;
+    Heartbeats queued;
+    bool in_flight = false;
+  };
+
+  void SendHeartbeats(const TabletId& tablet_id,
+                      HeartbeatBatch* batch,
+                      std::unique_lock<std::mutex>* lock) {
+    auto heartbeats = std::make_shared<Heartbeats>();
+    size_t max_size = std::max(FLAGS_transaction_max_heartbeat_batch_size, 1);
+    if (batch->queued.size() <= max_size) {
+      heartbeats->swap(batch->queued);
+    } else {
+      auto end = batch->queued.begin() + max_size;
+      heartbeats->assign(std::make_move_iterator(batch->queued.begin()),
+                         std::make_move_iterator(end));
+      batch->queued.erase(batch->queued.begin(), end);
+    }
+    batch->in_flight = true;
+    auto tablet = batch->tablet;
+    auto handle = rpcs_.Prepare();
+    lock->unlock();
+
+    tserver::UpdateTransactionRequestPB req;
+    req.set_tablet_id(tablet_id);
+    auto& state = *req.mutable_state();
+    state.set_status(TransactionStatus::PENDING);
+    for (const auto& heartbeat : *heartbeats) {
+      state.add_transaction_ids(heartbeat.first.begin(), heartbeat.first.size());
+    }
+    req.set_propagated_hybrid_time(Now().ToUint64());
+    *handle = HeartbeatTransactions(
+        MonoTime::FineNow() + MonoDelta::FromSeconds(5), // TODO(dtxn)
+        tablet.get(),
+        client_.get(),
+        &req,
+        [this, handle, tablet_id, heartbeats](
+            const Status& status, const tserver::UpdateTransactionResponsePB& response) {
+          HeartbeatsDone(status, response, tablet_id, *heartbeats, handle);
+        });
+    (**handle).SendRpc();
+  }
+
+  void HeartbeatsDone(const Status& status,
+                      const tserver::UpdateTransactionResponsePB& response,
+                      const TabletId& tablet_id,
+                      const Heartbeats& heartbeats,
+                      rpc::Rpcs::Handle handle) {
+    if (response.has_propagated_hybrid_time()) {
+      UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+    rpcs_.Unregister(handle);
+
+    std::unordered_set<TransactionId, TransactionIdHash> expired;
+    if (status.ok()) {
+      for (const auto& id : response.expired_transaction_ids()) {
+        auto decoded_id = FullyDecodeTransactionId(id);
+        if (decoded_id.ok()) {
+          expired.insert(*decoded_id);
+        } else {
+          LOG(DFATAL) << "Bad expired transaction id: " << decoded_id.status();
+        }
+      }
+    }
+    for (const auto& heartbeat : heartbeats) {
+      if (expired.count(heartbeat.first)) {
+        heartbeat.second(STATUS(Expired, "Transaction expired"));
+      } else {
+        heartbeat.second(status);
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(heartbeats_mutex_);
+    auto it = heartbeats_.find(tablet_id);
+    if (it == heartbeats_.end()) {
+      return;
+    }
+    it->second.in_flight = false;
+    if (it->second.queued.empty()) {
+      heartbeats_.erase(it);
+      return;
+    }
+    SendHeartbeats(tablet_id, &it->second, &lock);
+  }
+
   YBClientPtr client_;
   scoped_refptr<ClockBase> clock_;
   std::atomic<bool> status_table_exists_{false};
@@ -157,6 +277,9 @@ class TransactionManager::Impl {
   yb::rpc::ThreadPool thread_pool_; // TODO async operations instead of pool
   yb::rpc::TasksPool<PickStatusTabletTask> tasks_pool_;
   yb::rpc::Rpcs rpcs_;
+
+  std::mutex heartbeats_mutex_;
+  std::unordered_map<TabletId, HeartbeatBatch> heartbeats_;
 };
 
 TransactionManager::TransactionManager(
@@ -170,6 +293,12 @@ void TransactionManager::PickStatusTablet(PickStatusTabletCallback callback) {
   impl_->PickStatusTablet(std::move(callback));
 }
 
+void TransactionManager::SendHeartbeat(const internal::RemoteTabletPtr& status_tablet,
+                                       const TransactionId& id,
+                                       HeartbeatCallback callback) {
+  impl_->SendHeartbeat(status_tablet, id, std::move(callback));
+}
+
 const YBClientPtr& TransactionManager::client() const {
   return impl_->client();
 }
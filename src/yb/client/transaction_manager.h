@@ -23,6 +23,7 @@
 
 #include "yb/common/clock.h"
 #include "yb/common/hybrid_time.h"
+#include "yb/common/transaction.h"
 
 #include "yb/rpc/rpc_fwd.h"
 
@@ -32,6 +33,7 @@ namespace yb {
 namespace client {
 
 typedef std::function<void(const Result<std::string>&)> PickStatusTabletCallback;
+typedef std::function<void(const Status&)> HeartbeatCallback;
 
 // TransactionManager manages multiple transactions.
 class TransactionManager {
@@ -41,6 +43,13 @@ class TransactionManager {
 
   void PickStatusTablet(PickStatusTabletCallback callback);
 
+  // Sends heartbeat for pending transaction. Heartbeats of transactions that share the same
+  // status tablet are coalesced into a single UpdateTransaction request.
+  // Callback receives Expired status when transaction is unknown to its coordinator.
+  void SendHeartbeat(const internal::RemoteTabletPtr& status_tablet,
+                     const TransactionId& id,
+                     HeartbeatCallback callback);
+
   rpc::Rpcs& rpcs();
   const YBClientPtr& client() const;
 
@@ -13,6 +13,7 @@
 
 #include "yb/common/doc_hybrid_time.h"
 
+#include "yb/gutil/macros.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/util/bytes_formatter.h"
 #include "yb/util/cast.h"
@@ -22,7 +23,7 @@
 
 using yb::util::VarInt;
 using yb::util::FastEncodeDescendingSignedVarInt;
-using yb::util::FastDecodeDescendingSignedVarInt;
+using yb::util::FastDecodeDescendingSignedVarInts;
 using yb::util::FormatBytesAsStr;
 using yb::util::FormatSliceAsStr;
 using yb::util::QuotesType;
@@ -84,39 +85,28 @@ char* DocHybridTime::EncodedInDocDbFormat(char* dest) const {
 
 Status DocHybridTime::DecodeFrom(Slice *slice) {
   const size_t previous_size = slice->size();
-  {
-    // Currently we just ignore the generation number as it should always be 0.
-    int64_t ht_generation_number;
-    RETURN_NOT_OK(FastDecodeDescendingSignedVarInt(slice, &ht_generation_number));
-
-    int64_t decoded_micros = 0;
-    RETURN_NOT_OK(FastDecodeDescendingSignedVarInt(slice, &decoded_micros));
-    decoded_micros += kYugaByteMicrosecondEpoch;
-
-    int64_t decoded_logical = 0;
-    RETURN_NOT_OK(FastDecodeDescendingSignedVarInt(slice, &decoded_logical));
-
-    hybrid_time_ = HybridTime::FromMicrosecondsAndLogicalValue(decoded_micros, decoded_logical);
-  }
-
-  int64_t decoded_shifted_write_id = 0;
-  const auto ptr_before_decoding_write_id = slice->data();
-  RETURN_NOT_OK(FastDecodeDescendingSignedVarInt(slice, &decoded_shifted_write_id));
+  // The generation number, physical time, logical time and shifted write id are consecutive
+  // VarInts, so decode them in one batch.
+  // Currently we just ignore the generation number as it should always be 0.
+  int64_t decoded[4];
+  RETURN_NOT_OK(FastDecodeDescendingSignedVarInts(slice, decoded, arraysize(decoded)));
+  hybrid_time_ = HybridTime::FromMicrosecondsAndLogicalValue(
+      decoded[1] + kYugaByteMicrosecondEpoch, decoded[2]);
 
+  const size_t bytes_decoded = previous_size - slice->size();
+  const int64_t decoded_shifted_write_id = decoded[3];
   if (decoded_shifted_write_id < 0) {
     return STATUS_SUBSTITUTE(
         Corruption,
         "Negative decoded_shifted_write_id: $0. Was trying to decode from: $1",
         decoded_shifted_write_id,
         FormatSliceAsStr(
-            Slice(ptr_before_decoding_write_id,
-                  slice->data() + slice->size() - ptr_before_decoding_write_id),
+            Slice(slice->data() - bytes_decoded, bytes_decoded + slice->size()),
             QuotesType::kDoubleQuotes,
             /* max_length = */ 32));
   }
   write_id_ = (decoded_shifted_write_id >> kNumBitsForHybridTimeSize) - 1;
 
-  const size_t bytes_decoded = previous_size - slice->size();
   const size_t size_at_the_end = (*(slice->data() - 1)) & kHybridTimeSizeMask;
   if (size_at_the_end != bytes_decoded) {
     return STATUS_SUBSTITUTE(
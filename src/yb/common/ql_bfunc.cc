@@ -59,4 +59,10 @@ Status QLBfunc::Exec(BFOpcode opcode,
   return QLBfuncExecApiPB::ExecQLOpcode(opcode, params, result);
 }
 
+const QLBfunc::ExecFunc* QLBfunc::FindExecFunc(BFOpcode opcode) {
+  const auto& funcs = QLBfuncExecApiPB::kBFExecFuncsRefAndRaw;
+  const auto index = static_cast<size_t>(opcode);
+  return index < funcs.size() ? &funcs[index] : nullptr;
+}
+
 } // namespace yb
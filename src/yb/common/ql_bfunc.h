@@ -29,6 +29,8 @@
 #ifndef YB_COMMON_QL_BFUNC_H_
 #define YB_COMMON_QL_BFUNC_H_
 
+#include <functional>
+
 #include "yb/common/ql_value.h"
 #include "yb/util/bfql/bfql.h"
 
@@ -65,6 +67,11 @@ class QLBfunc {
   static Status Exec(bfql::BFOpcode opcode,
                      std::vector<QLValueWithPB> *params,
                      QLValueWithPB *result);
+
+  // Returns the function that the Exec() above runs for the opcode, or nullptr for an unknown
+  // opcode. Callers that run the same builtin call many times could look it up once.
+  typedef std::function<Status(std::vector<QLValueWithPB>*, QLValueWithPB*)> ExecFunc;
+  static const ExecFunc* FindExecFunc(bfql::BFOpcode opcode);
 };
 
 } // namespace yb
@@ -0,0 +1,80 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+
+#include "yb/common/ql_expr.h"
+
+#include <gtest/gtest.h>
+
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+namespace {
+
+void AddOperands(bfql::BFOpcode opcode, QLExpressionPB* expr,
+                 QLExpressionPB** lhs, QLExpressionPB** rhs) {
+  auto* bfcall = expr->mutable_bfcall();
+  bfcall->set_opcode(static_cast<int32_t>(opcode));
+  *lhs = bfcall->add_operands();
+  *rhs = bfcall->add_operands();
+}
+
+} // namespace
+
+class QLExprTest : public YBTest {
+};
+
+TEST_F(QLExprTest, CompiledBuiltinCalls) {
+  bfql::BFOpcode opcode;
+  const bfql::BFDecl* bfdecl = nullptr;
+  ASSERT_OK(bfql::FindOpcodeByType(
+      "+", {DataType::INT64, DataType::INT64}, &opcode, &bfdecl, nullptr));
+
+  // col_10 + (5 + col_11)
+  QLExpressionPB expr;
+  QLExpressionPB* lhs;
+  QLExpressionPB* rhs;
+  AddOperands(opcode, &expr, &lhs, &rhs);
+  lhs->set_column_id(10);
+  QLExpressionPB* inner_lhs;
+  QLExpressionPB* inner_rhs;
+  AddOperands(opcode, rhs, &inner_lhs, &inner_rhs);
+  inner_lhs->mutable_value()->set_int64_value(5);
+  inner_rhs->set_column_id(11);
+
+  QLExprExecutor executor;
+  QLCompiledExpr compiled(expr);
+  for (int64_t i = 0; i != 100; ++i) {
+    QLTableRow row;
+    row[ColumnId(10)].value.set_int64_value(i);
+    row[ColumnId(11)].value.set_int64_value(i * 7);
+    QLValueWithPB expected;
+    ASSERT_OK(executor.EvalExpr(expr, row, &expected));
+    ASSERT_EQ(i + 5 + i * 7, expected.int64_value());
+    QLValueWithPB result;
+    ASSERT_OK(compiled.Eval(&executor, row, &result));
+    ASSERT_EQ(expected.value().ShortDebugString(), result.value().ShortDebugString());
+  }
+
+  // Expressions other than builtin calls are evaluated by the executor.
+  QLExpressionPB condition;
+  condition.mutable_condition()->set_op(QL_OP_EXISTS);
+  QLCompiledExpr compiled_condition(condition);
+  QLValueWithPB result;
+  ASSERT_OK(compiled_condition.Eval(&executor, QLTableRow(), &result));
+  ASSERT_FALSE(result.bool_value());
+}
+
+} // namespace yb
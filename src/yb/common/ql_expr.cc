@@ -3,7 +3,6 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/common/ql_expr.h"
-#include "yb/common/ql_bfunc.h"
 
 namespace yb {
 
@@ -88,6 +87,109 @@ CHECKED_STATUS QLExprExecutor::EvalTSCall(const QLBCallPB& ql_expr,
 
 //--------------------------------------------------------------------------------------------------
 
+CHECKED_STATUS QLExprExecutor::EvalAggregate(const QLBCallPB& tscall,
+                                             const QLTableRow& column_map,
+                                             QLValueWithPB *aggr_value) {
+  DCHECK_EQ(tscall.operands().size(), 1) << "Aggregate functions take only one argument";
+  const bfql::TSOpcode opcode = static_cast<bfql::TSOpcode>(tscall.opcode());
+  QLValueWithPB value;
+  RETURN_NOT_OK(EvalExpr(tscall.operands(0), column_map, &value));
+  return AddToAggregate(opcode, value, aggr_value);
+}
+
+CHECKED_STATUS QLExprExecutor::AddToAggregate(bfql::TSOpcode opcode,
+                                              const QLValueWithPB& value,
+                                              QLValueWithPB *aggr_value) {
+  if (opcode == bfql::TSOpcode::kCount) {
+    // COUNT counts the non-null values of its argument.
+    if (!value.IsNull()) {
+      aggr_value->set_int64_value(aggr_value->int64_value() + 1);
+    }
+    return Status::OK();
+  }
+  return AccumulateAggregate(opcode, value, aggr_value);
+}
+
+void QLExprExecutor::InitAggregate(bfql::TSOpcode opcode, QLValueWithPB *aggr_value) {
+  if (opcode == bfql::TSOpcode::kCount) {
+    aggr_value->set_int64_value(0);
+  } else {
+    aggr_value->SetNull();
+  }
+}
+
+CHECKED_STATUS QLExprExecutor::MergeAggregate(bfql::TSOpcode opcode,
+                                              const QLValueWithPB& partial_value,
+                                              QLValueWithPB *aggr_value) {
+  // Partial counts are added up the same way as partial sums.
+  return AccumulateAggregate(
+      opcode == bfql::TSOpcode::kCount ? bfql::TSOpcode::kSum : opcode, partial_value, aggr_value);
+}
+
+CHECKED_STATUS QLExprExecutor::AccumulateAggregate(bfql::TSOpcode opcode,
+                                                   const QLValueWithPB& value,
+                                                   QLValueWithPB *aggr_value) {
+  if (value.IsNull()) {
+    return Status::OK();
+  }
+  if (aggr_value->IsNull()) {
+    aggr_value->Assign(value.value());
+    return Status::OK();
+  }
+  if (!aggr_value->Comparable(value)) {
+    return STATUS(RuntimeError, "Aggregate function arguments have different datatypes");
+  }
+
+  switch (opcode) {
+    case bfql::TSOpcode::kMin:
+      if (value < *aggr_value) {
+        aggr_value->Assign(value.value());
+      }
+      return Status::OK();
+
+    case bfql::TSOpcode::kMax:
+      if (value > *aggr_value) {
+        aggr_value->Assign(value.value());
+      }
+      return Status::OK();
+
+    case bfql::TSOpcode::kSum:
+      switch (value.type()) {
+        case QLValuePB::kInt8Value:
+          aggr_value->set_int8_value(aggr_value->int8_value() + value.int8_value());
+          return Status::OK();
+        case QLValuePB::kInt16Value:
+          aggr_value->set_int16_value(aggr_value->int16_value() + value.int16_value());
+          return Status::OK();
+        case QLValuePB::kInt32Value:
+          aggr_value->set_int32_value(aggr_value->int32_value() + value.int32_value());
+          return Status::OK();
+        case QLValuePB::kInt64Value:
+          aggr_value->set_int64_value(aggr_value->int64_value() + value.int64_value());
+          return Status::OK();
+        case QLValuePB::kFloatValue:
+          aggr_value->set_float_value(aggr_value->float_value() + value.float_value());
+          return Status::OK();
+        case QLValuePB::kDoubleValue:
+          aggr_value->set_double_value(aggr_value->double_value() + value.double_value());
+          return Status::OK();
+        default:
+          return STATUS_SUBSTITUTE(NotSupported, "Cannot add values of type $0", value.type());
+      }
+
+    case bfql::TSOpcode::kNoOp: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kWriteTime: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kTtl: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kCount: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kAvg:
+      break;
+  }
+  return STATUS_SUBSTITUTE(InvalidArgument, "Cannot accumulate aggregate function $0",
+                           static_cast<int32_t>(opcode));
+}
+
+//--------------------------------------------------------------------------------------------------
+
 CHECKED_STATUS QLExprExecutor::EvalSubscriptedColumn(const QLSubscriptedColPB& subcol,
                                                      const QLTableRow& column_map,
                                                      QLValueWithPB *result) {
@@ -295,4 +397,76 @@ CHECKED_STATUS QLExprExecutor::EvalCondition(const QLConditionPB& condition,
 #undef QL_EVALUATE_BETWEEN
 }
 
+//--------------------------------------------------------------------------------------------------
+
+QLCompiledExpr::QLCompiledExpr(const QLExpressionPB& ql_expr) {
+  Compile(ql_expr);
+}
+
+size_t QLCompiledExpr::Compile(const QLExpressionPB& ql_expr) {
+  const size_t index = nodes_.size();
+  nodes_.emplace_back();
+  nodes_[index].expr = &ql_expr;
+  if (ql_expr.expr_case() != QLExpressionPB::ExprCase::kBfcall) {
+    return index;
+  }
+  const QLBCallPB& bfcall = ql_expr.bfcall();
+  const auto* func = QLBfunc::FindExecFunc(static_cast<bfql::BFOpcode>(bfcall.opcode()));
+  if (func == nullptr) {
+    return index;
+  }
+  // The operand nodes are appended after this one, so nodes_ could be reallocated.
+  std::vector<size_t> operands;
+  operands.reserve(bfcall.operands().size());
+  for (const auto& operand : bfcall.operands()) {
+    operands.push_back(Compile(operand));
+  }
+  Node& node = nodes_[index];
+  node.func = func;
+  node.operands = std::move(operands);
+  node.args.resize(node.operands.size());
+  return index;
+}
+
+CHECKED_STATUS QLCompiledExpr::Eval(QLExprExecutor* executor,
+                                    const QLTableRow& column_map,
+                                    QLValueWithPB *result) {
+  return EvalNode(0, executor, column_map, result);
+}
+
+CHECKED_STATUS QLCompiledExpr::EvalNode(size_t index,
+                                        QLExprExecutor* executor,
+                                        const QLTableRow& column_map,
+                                        QLValueWithPB *result) {
+  Node& node = nodes_[index];
+  switch (node.expr->expr_case()) {
+    case QLExpressionPB::ExprCase::kValue:
+      result->Assign(node.expr->value());
+      return Status::OK();
+
+    case QLExpressionPB::ExprCase::kColumnId: {
+      auto iter = column_map.find(ColumnId(node.expr->column_id()));
+      if (iter != column_map.end()) {
+        result->Assign(iter->second.value);
+      } else {
+        result->SetNull();
+      }
+      return Status::OK();
+    }
+
+    default:
+      break;
+  }
+
+  // The result could hold the value of the previous row.
+  result->SetNull();
+  if (node.func == nullptr) {
+    return executor->EvalExpr(*node.expr, column_map, result);
+  }
+  for (size_t i = 0; i != node.operands.size(); ++i) {
+    RETURN_NOT_OK(EvalNode(node.operands[i], executor, column_map, &node.args[i]));
+  }
+  return (*node.func)(&node.args, result);
+}
+
 } // namespace yb
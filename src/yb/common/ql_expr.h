@@ -7,9 +7,11 @@
 #ifndef YB_COMMON_QL_EXPR_H_
 #define YB_COMMON_QL_EXPR_H_
 
+#include "yb/common/ql_bfunc.h"
 #include "yb/common/ql_value.h"
 #include "yb/common/ql_rowblock.h"
 #include "yb/common/schema.h"
+#include "yb/util/bfql/tserver_opcodes.h"
 
 namespace yb {
 
@@ -57,6 +59,70 @@ class QLExprExecutor {
   virtual CHECKED_STATUS EvalCondition(const QLConditionPB& condition,
                                        const QLTableRow& column_map,
                                        QLValueWithPB *result);
+
+  // Evaluate the argument of the aggregate function call "tscall" for the given row and accumulate
+  // it into "aggr_value". Tablet servers use it to compute partial aggregates of the rows they
+  // read. "aggr_value" must be initialized with InitAggregate() before the first row.
+  CHECKED_STATUS EvalAggregate(const QLBCallPB& tscall,
+                               const QLTableRow& column_map,
+                               QLValueWithPB *aggr_value);
+
+  // Initialize the value of an aggregate function before any rows are accumulated into it.
+  static void InitAggregate(bfql::TSOpcode opcode, QLValueWithPB *aggr_value);
+
+  // Accumulate the already evaluated argument "value" of the aggregate function into "aggr_value".
+  static CHECKED_STATUS AddToAggregate(bfql::TSOpcode opcode,
+                                       const QLValueWithPB& value,
+                                       QLValueWithPB *aggr_value);
+
+  // Combine the partial value of an aggregate function computed by a tablet server into
+  // "aggr_value". COUNT partials are added up while the others are accumulated as values.
+  static CHECKED_STATUS MergeAggregate(bfql::TSOpcode opcode,
+                                       const QLValueWithPB& partial_value,
+                                       QLValueWithPB *aggr_value);
+
+ private:
+  // Accumulate "value" into the aggregate "aggr_value". Null values are ignored.
+  static CHECKED_STATUS AccumulateAggregate(bfql::TSOpcode opcode,
+                                            const QLValueWithPB& value,
+                                            QLValueWithPB *aggr_value);
+};
+
+// A QLExpressionPB compiled once to be evaluated for many rows, e.g. all rows read by a request.
+// The expression tree is flattened with the column ids and the functions of builtin calls looked
+// up in advance, and the argument values of builtin calls are reused between rows. Expressions
+// other than constants, columns and builtin calls are evaluated by the executor.
+//
+// A compiled expression refers to the QLExpressionPB it was compiled from, so it should not
+// outlive it. As the argument values are reused, it should not be evaluated concurrently.
+class QLCompiledExpr {
+ public:
+  explicit QLCompiledExpr(const QLExpressionPB& ql_expr);
+
+  // Evaluate the expression for the given row. Same as executor->EvalExpr(ql_expr, ...).
+  CHECKED_STATUS Eval(QLExprExecutor* executor,
+                      const QLTableRow& column_map,
+                      QLValueWithPB *result);
+
+ private:
+  struct Node {
+    const QLExpressionPB* expr;
+    // Function of a builtin call, nullptr when the executor evaluates the expression.
+    const QLBfunc::ExecFunc* func = nullptr;
+    // Indexes of the nodes of the builtin call operands.
+    std::vector<size_t> operands;
+    std::vector<QLValueWithPB> args;
+  };
+
+  // Appends the nodes of the expression and its operands and returns the index of its node.
+  size_t Compile(const QLExpressionPB& ql_expr);
+
+  CHECKED_STATUS EvalNode(size_t index,
+                          QLExprExecutor* executor,
+                          const QLTableRow& column_map,
+                          QLValueWithPB *result);
+
+  std::vector<Node> nodes_;
 };
 
 } // namespace yb
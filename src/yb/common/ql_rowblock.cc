@@ -259,6 +259,28 @@ QLValuePB EvaluateValue(const QLExpressionPB& expr, const QLTableRow& table_row)
   LOG(FATAL) << "Internal error: invalid column or value expression: " << expr.expr_case();
 }
 
+// Return a reference to the value of a column or literal expression without copying it. Other
+// expressions are evaluated into *holder. The result is valid as long as expr, table_row and
+// holder are.
+const QLValuePB& EvaluateValue(
+    const QLExpressionPB& expr, const QLTableRow& table_row, QLValuePB* holder) {
+  switch (expr.expr_case()) {
+    case QLExpressionPB::ExprCase::kColumnId: {
+      const auto it = table_row.find(ColumnId(expr.column_id()));
+      if (it != table_row.end()) {
+        return it->second.value;
+      }
+      holder->Clear();
+      return *holder;
+    }
+    case QLExpressionPB::ExprCase::kValue:
+      return expr.value();
+    default:
+      *holder = EvaluateValue(expr, table_row);
+      return *holder;
+  }
+}
+
 // Evaluate an IN (...) condition.
 Status EvaluateInCondition(const google::protobuf::RepeatedPtrField<yb::QLExpressionPB> &operands,
                            const QLTableRow &row,
@@ -266,8 +288,9 @@ Status EvaluateInCondition(const google::protobuf::RepeatedPtrField<yb::QLExpres
   // Expecting two operands, second should be list of elements.
   CHECK_EQ(operands.size(), 2);
   *result = false;
-  QLValuePB left = EvaluateValue(operands.Get(0), row);
-  QLValuePB right = EvaluateValue(operands.Get(1), row);
+  QLValuePB left_holder, right_holder;
+  const QLValuePB& left = EvaluateValue(operands.Get(0), row, &left_holder);
+  const QLValuePB& right = EvaluateValue(operands.Get(1), row, &right_holder);
 
   for (const QLValuePB& elem : right.list_value().elems()) {
     if (!QLValue::Comparable(left, elem)) return STATUS(RuntimeError, "values not comparable");
@@ -284,9 +307,10 @@ Status EvaluateBetweenCondition(
     const google::protobuf::RepeatedPtrField<yb::QLExpressionPB> &operands,
     const QLTableRow &row, bool *result) {
   CHECK_EQ(operands.size(), 3);
-  QLValuePB v = EvaluateValue(operands.Get(0), row);
-  QLValuePB lower_bound = EvaluateValue(operands.Get(1), row);
-  QLValuePB upper_bound = EvaluateValue(operands.Get(2), row);
+  QLValuePB v_holder, lower_bound_holder, upper_bound_holder;
+  const QLValuePB& v = EvaluateValue(operands.Get(0), row, &v_holder);
+  const QLValuePB& lower_bound = EvaluateValue(operands.Get(1), row, &lower_bound_holder);
+  const QLValuePB& upper_bound = EvaluateValue(operands.Get(2), row, &upper_bound_holder);
   if (!QLValue::Comparable(v, lower_bound) || !QLValue::Comparable(v, upper_bound)) {
     return STATUS(RuntimeError, "values not comparable");
   }
@@ -310,17 +334,20 @@ Status EvaluateCondition(
     }
     case QL_OP_IS_NULL: {
       CHECK_EQ(operands.size(), 1);
-      *result = QLValue::IsNull(EvaluateValue(operands.Get(0), table_row));
+      QLValuePB holder;
+      *result = QLValue::IsNull(EvaluateValue(operands.Get(0), table_row, &holder));
       return Status::OK();
     }
     case QL_OP_IS_NOT_NULL: {
       CHECK_EQ(operands.size(), 1);
-      *result = !QLValue::IsNull(EvaluateValue(operands.Get(0), table_row));
+      QLValuePB holder;
+      *result = !QLValue::IsNull(EvaluateValue(operands.Get(0), table_row, &holder));
       return Status::OK();
     }
     case QL_OP_IS_TRUE: {
       CHECK_EQ(operands.size(), 1);
-      QLValuePB v = EvaluateValue(operands.Get(0), table_row);
+      QLValuePB holder;
+      const QLValuePB& v = EvaluateValue(operands.Get(0), table_row, &holder);
       if (QLValue::type(v) != QLValue::InternalType::kBoolValue)
         return STATUS(RuntimeError, "not a bool value");
       *result = (!QLValue::IsNull(v) && QLValue::bool_value(v));
@@ -328,21 +355,23 @@ Status EvaluateCondition(
     }
     case QL_OP_IS_FALSE: {
       CHECK_EQ(operands.size(), 1);
-      QLValuePB v = EvaluateValue(operands.Get(0), table_row);
+      QLValuePB holder;
+      const QLValuePB& v = EvaluateValue(operands.Get(0), table_row, &holder);
       if (QLValue::type(v) != QLValue::InternalType::kBoolValue)
         return STATUS(RuntimeError, "not a bool value");
       *result = (!QLValue::IsNull(v) && !QLValue::bool_value(v));
       return Status::OK();
     }
 
-#define QL_EVALUATE_RELATIONAL_OP(op, operands, row, result)               \
-      do {                                                                  \
-        CHECK_EQ(operands.size(), 2);                                       \
-        const QLValuePB left = EvaluateValue(operands.Get(0), table_row);  \
-        const QLValuePB right = EvaluateValue(operands.Get(1), table_row); \
-        if (!QLValue::Comparable(left, right))                             \
-          return STATUS(RuntimeError, "values not comparable");             \
-        *result = (left op right);                                          \
+#define QL_EVALUATE_RELATIONAL_OP(op, operands, row, result)                                  \
+      do {                                                                                    \
+        CHECK_EQ(operands.size(), 2);                                                         \
+        QLValuePB left_holder, right_holder;                                                  \
+        const QLValuePB& left = EvaluateValue(operands.Get(0), table_row, &left_holder);      \
+        const QLValuePB& right = EvaluateValue(operands.Get(1), table_row, &right_holder);    \
+        if (!QLValue::Comparable(left, right))                                                \
+          return STATUS(RuntimeError, "values not comparable");                               \
+        *result = (left op right);                                                            \
       } while (0)
 
     case QL_OP_EQUAL: {
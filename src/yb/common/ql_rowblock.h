@@ -92,6 +92,7 @@ class QLRowBlock {
 
   // The rows
   std::vector<QLRow>& rows() { return rows_; }
+  const std::vector<QLRow>& rows() const { return rows_; }
 
   // Return the row by index
   QLRow& row(size_t idx) { return rows_.at(idx); }
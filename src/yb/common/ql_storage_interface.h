@@ -23,6 +23,16 @@
 namespace yb {
 namespace common {
 
+// The iterator of a paged read, kept between the pages of the read. The iterator refers to the
+// projection and the schema it was created with, so the cursor owns them.
+struct QLCursor {
+  Schema projection;
+  Schema schema;
+  std::unique_ptr<QLRowwiseIteratorIf> iter;
+};
+
+typedef std::unique_ptr<QLCursor> QLCursorPtr;
+
 // An interface to support various different storage backends for a QL table.
 class QLStorageIf {
  public:
@@ -43,6 +53,16 @@ class QLStorageIf {
                                           std::unique_ptr<common::QLScanSpec>* spec,
                                           std::unique_ptr<common::QLScanSpec>* static_row_spec,
                                           HybridTime* req_hybrid_time) const = 0;
+
+  // Returns the cursor kept for the page the request reads, or nullptr. The cursor continues where
+  // the previous page of the read stopped.
+  virtual QLCursorPtr TakeCursor(const QLReadRequestPB& request) const {
+    return nullptr;
+  }
+
+  // Keeps the cursor of the request for the next page of the read, which starts at next_row_key.
+  virtual void KeepCursor(const QLReadRequestPB& request, const std::string& next_row_key,
+                          QLCursorPtr cursor) const {}
 };
 
 }  // namespace common
@@ -233,11 +233,12 @@ void QLValue::Serialize(
       CQLEncodeFloat(NetworkByteOrder::Store64, double_value(), buffer);
       return;
     case DECIMAL: {
-      auto decimal = util::DecimalFromComparable(decimal_value());
       bool is_out_of_range = false;
-      CQLEncodeBytes(decimal.EncodeToSerializedBigDecimal(&is_out_of_range), buffer);
+      CQLEncodeBytes(
+          util::ComparableDecimalToSerializedBigDecimal(decimal_value(), &is_out_of_range), buffer);
       if(is_out_of_range) {
-        LOG(ERROR) << "Out of range: Unable to encode decimal " << decimal.ToString()
+        LOG(ERROR) << "Out of range: Unable to encode decimal "
+                   << util::DecimalFromComparable(decimal_value()).ToString()
                    << " into a BigDecimal serialized representation";
       }
       return;
@@ -431,10 +432,7 @@ Status QLValue::Deserialize(
     case DECIMAL: {
       string value;
       RETURN_NOT_OK(CQLDecodeBytes(len, data, &value));
-      Decimal decimal;
-      RETURN_NOT_OK(decimal.DecodeFromSerializedBigDecimal(value));
-      set_decimal_value(decimal.EncodeToComparable());
-      return Status::OK();
+      return util::SerializedBigDecimalToComparable(value, mutable_decimal_value());
     }
     case STRING:
       return CQLDecodeBytes(len, data, mutable_string_value());
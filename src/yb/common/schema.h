@@ -469,12 +469,14 @@ class TableProperties {
   TableProperties()
       : default_time_to_live_(kNoDefaultTtl),
         contain_counters_(false),
-        is_transactional_(false) {}
+        is_transactional_(false),
+        optimize_for_point_lookups_(false) {}
 
   TableProperties(const TableProperties& other) {
     default_time_to_live_ = other.default_time_to_live_;
     contain_counters_ = other.contain_counters_;
     is_transactional_ = other.is_transactional_;
+    optimize_for_point_lookups_ = other.optimize_for_point_lookups_;
   }
 
   // Containing counters is a internal property instead of a user-defined property, so we don't use
@@ -515,12 +517,21 @@ class TableProperties {
     is_transactional_ = is_transactional;
   }
 
+  bool optimize_for_point_lookups() const {
+    return optimize_for_point_lookups_;
+  }
+
+  void SetOptimizeForPointLookups(bool optimize_for_point_lookups) {
+    optimize_for_point_lookups_ = optimize_for_point_lookups;
+  }
+
   void ToTablePropertiesPB(TablePropertiesPB *pb) const {
     if (HasDefaultTimeToLive()) {
       pb->set_default_time_to_live(default_time_to_live_);
     }
     pb->set_contain_counters(contain_counters_);
     pb->set_is_transactional(is_transactional_);
+    pb->set_optimize_for_point_lookups(optimize_for_point_lookups_);
   }
 
   static TableProperties FromTablePropertiesPB(const TablePropertiesPB& pb) {
@@ -534,6 +545,9 @@ class TableProperties {
     if (pb.has_is_transactional()) {
       table_properties.SetTransactional(pb.is_transactional());
     }
+    if (pb.has_optimize_for_point_lookups()) {
+      table_properties.SetOptimizeForPointLookups(pb.optimize_for_point_lookups());
+    }
     return table_properties;
   }
 
@@ -544,12 +558,16 @@ class TableProperties {
     if (pb.has_is_transactional()) {
       SetTransactional(pb.is_transactional());
     }
+    if (pb.has_optimize_for_point_lookups()) {
+      SetOptimizeForPointLookups(pb.optimize_for_point_lookups());
+    }
   }
 
   void Reset() {
     default_time_to_live_ = kNoDefaultTtl;
     contain_counters_ = false;
     is_transactional_ = false;
+    optimize_for_point_lookups_ = false;
   }
 
  private:
@@ -557,6 +575,7 @@ class TableProperties {
   int64_t default_time_to_live_;
   bool contain_counters_;
   bool is_transactional_;
+  bool optimize_for_point_lookups_;
 };
 
 // The schema for a set of rows.
@@ -84,6 +84,10 @@ class TransactionStatusProvider {
   virtual void RequestStatusAt(const TransactionId& id,
                                HybridTime time,
                                TransactionStatusCallback callback) = 0;
+
+  // Returns false only if it is known that there are no intents in this tablet, so readers could
+  // skip resolving intents entirely. Should be checked before RocksDB iterators are created.
+  virtual bool MayHaveIntents() const { return true; }
 };
 
 struct TransactionOperationContext {
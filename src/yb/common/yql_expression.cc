@@ -61,6 +61,17 @@ CHECKED_STATUS YQLExpression::Evaluate(const QLExpressionPB &ql_expr,
         }
       }
 
+      // Counter updates of the form "cref = cref +/- <value>" are written as a delta that is added
+      // to the column when it is read, so the result is the (negated for minus) value.
+      if (IsCounterIncrement(bfcall)) {
+        *write_action = WriteAction::INCREMENT;
+        RETURN_NOT_OK(Evaluate(bfcall.operands(1), table_row, result, write_action));
+        if (bfop_name == "DecCounter") {
+          result->set_int64_value(-result->int64_value());
+        }
+        return Status::OK();
+      }
+
       // TODO (Akashnil or Mihnea) this should be enabled when RemoveFromList is implemented
       /*
       if (bfop_name == "SubListList") {
@@ -114,4 +125,30 @@ CHECKED_STATUS YQLExpression::Evaluate(const QLExpressionPB &ql_expr,
   return Status::OK();
 }
 
+bool YQLExpression::IsCounterIncrement(const QLBCallPB &bfcall) {
+  const string &bfop_name = bfql::kBFOperators[bfcall.opcode()]->op_decl()->cpp_name();
+  return (bfop_name == "IncCounter" || bfop_name == "DecCounter") &&
+         bfcall.operands(0).has_column_id() && bfcall.operands(1).has_value();
+}
+
+bool YQLExpression::IsCollectionUpdate(const QLBCallPB &bfcall, int32_t *column_id) {
+  const string &bfop_name = bfql::kBFOperators[bfcall.opcode()]->op_decl()->cpp_name();
+  if (bfop_name != "AddMapMap" && bfop_name != "AddSetSet" && bfop_name != "SubMapSet" &&
+      bfop_name != "SubSetSet" && bfop_name != "AddListList") {
+    return false;
+  }
+  const QLExpressionPB &lhs = bfcall.operands(0);
+  const QLExpressionPB &rhs = bfcall.operands(1);
+  if (lhs.has_column_id() && rhs.has_value()) {
+    *column_id = lhs.column_id();
+    return true;
+  }
+  // Only lists are prepended to, other collections evaluate the right operand.
+  if (bfop_name == "AddListList" && lhs.has_value() && rhs.has_column_id()) {
+    *column_id = rhs.column_id();
+    return true;
+  }
+  return false;
+}
+
 } // namespace yb
@@ -35,6 +35,7 @@ enum class WriteAction : int {
   PREPEND, // plus for lists
   REMOVE_KEYS, // minus for map and set
   REMOVE_VALUES, // minus for lists
+  INCREMENT, // plus and minus for counters
 };
 
 class YQLExpression {
@@ -44,6 +45,15 @@ class YQLExpression {
                                  const QLTableRow &table_row,
                                  QLValueWithPB *result,
                                  WriteAction *write_action);
+
+  // Whether the call is a counter update of the form "cref +/- <value>", that is written as an
+  // INCREMENT of column cref without reading it.
+  static bool IsCounterIncrement(const QLBCallPB &bfcall);
+
+  // Whether the call is a collection update of the form "cref +/- <value>", or "<value> + cref" for
+  // lists, that is written as an EXTEND, REMOVE_KEYS, APPEND or PREPEND of column cref without
+  // reading it. Sets column_id to the id of cref.
+  static bool IsCollectionUpdate(const QLBCallPB &bfcall, int32_t *column_id);
 };
 
 } // namespace yb
@@ -39,6 +39,7 @@
 
 #include <boost/optional/optional_fwd.hpp>
 
+#include "yb/common/hybrid_time.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
@@ -90,6 +91,10 @@ typedef std::vector<ConsensusRoundPtr> ConsensusRounds;
 
 struct ConsensusOptions {
   std::string tablet_id;
+
+  // Whether the replica could stop leader failure detection while the tablet is idle. Requires
+  // the server to call Consensus::ServersWentDown() when it learns about dead servers.
+  bool allow_quiescence = false;
 };
 
 // After completing bootstrap, some of the results need to be plumbed through
@@ -338,12 +343,34 @@ class Consensus : public RefCountedThreadSafe<Consensus> {
     return STATUS(NotFound, "Not implemented.");
   }
 
+  // Reads the committed operations that follow the one with index after_op_index, up to
+  // max_size_bytes in total unless the first one alone is bigger. Operations evicted from the log
+  // cache are read from the log. The committed OpId is returned in committed_op_id. Used to stream
+  // the changes of the tablet to another cluster.
+  virtual CHECKED_STATUS ReadCommittedOps(int64_t after_op_index,
+                                          int max_size_bytes,
+                                          ReplicateMsgs* msgs,
+                                          OpId* committed_op_id) {
+    return STATUS(NotSupported, "Not implemented.");
+  }
+
+  // Returns the safe hybrid time propagated by the leader, that is covered by operations this
+  // replica has already received. Reads at or below it observe every write the leader has
+  // committed before it, so followers could use it to serve reads. Invalid if unknown.
+  virtual HybridTime LeaderSafeTime() const {
+    return HybridTime::kInvalid;
+  }
+
   // Assuming we are the leader, wait until we have a valid leader lease (i.e. the old leader's
   // lease has expired, and we have replicated a new lease that has not expired yet).
   virtual Status WaitForLeaderLeaseImprecise(MonoTime deadline) = 0;
 
   virtual Status CheckIsActiveLeaderAndHasLease() const = 0;
 
+  // Notifies the replica that the servers with the specified uuids went down. A quiescent follower
+  // of a leader on one of them resumes leader failure detection.
+  virtual void ServersWentDown(const std::vector<std::string>& server_uuids) {}
+
  protected:
   friend class RefCountedThreadSafe<Consensus>;
   friend class tablet::TabletPeer;
@@ -493,6 +520,17 @@ class ReplicaOperationFactory {
  public:
   virtual CHECKED_STATUS StartReplicaOperation(const ConsensusRoundPtr& context) = 0;
 
+  // Returns the hybrid time that the leader propagates to followers, so that they could serve
+  // reads at it. No operation with a lower hybrid time could be committed after this call.
+  virtual HybridTime SafeTimeForFollowers() const {
+    return HybridTime::kInvalid;
+  }
+
+  // Invoked before and after consensus applies a group of committed operations on the current
+  // thread, so that the factory could merge applies of operations within the group.
+  virtual void StartApplyBatch() {}
+  virtual void FinishApplyBatch() {}
+
   virtual ~ReplicaOperationFactory() {}
 };
 
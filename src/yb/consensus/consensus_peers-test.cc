@@ -48,6 +48,8 @@
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_int32(consensus_max_in_flight_requests_per_peer);
+
 namespace yb {
 namespace consensus {
 
@@ -192,6 +194,29 @@ TEST_F(ConsensusPeersTest, TestRemotePeer) {
   CheckLastRemoteEntry(proxy, 2, 20);
 }
 
+// Same as TestRemotePeer, but with requests to the peer pipelined, so new batches are sent
+// before responses to the previous ones arrive.
+TEST_F(ConsensusPeersTest, TestPipelinedRemotePeer) {
+  FLAGS_consensus_max_in_flight_requests_per_peer = 4;
+  message_queue_->Init(MinimumOpId());
+  message_queue_->SetLeaderMode(MinimumOpId(),
+                                MinimumOpId().term(),
+                                BuildRaftConfigPBForTests(3));
+
+  std::unique_ptr<Peer> remote_peer;
+  DelayablePeerProxy<NoOpTestPeerProxy>* proxy =
+      NewRemotePeer(kFollowerUuid, &remote_peer);
+  // Last appended message is in term 7.
+  remote_peer->SetTermForTest(7);
+
+  for (int i = 0; i != 10; ++i) {
+    AppendReplicateMessagesToQueue(message_queue_.get(), clock_, i * 5 + 1, 5);
+    ASSERT_OK(remote_peer->SignalRequest(RequestTriggerMode::NON_EMPTY_ONLY));
+  }
+  WaitForMajorityReplicatedIndex(50);
+  CheckLastRemoteEntry(proxy, 7, 50);
+}
+
 TEST_F(ConsensusPeersTest, TestRemotePeers) {
   message_queue_->Init(MinimumOpId());
   message_queue_->SetLeaderMode(MinimumOpId(),
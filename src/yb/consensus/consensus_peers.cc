@@ -47,6 +47,7 @@
 #include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
@@ -63,7 +64,21 @@ DEFINE_int32(consensus_rpc_timeout_ms, 2000,
              "Timeout used for all consensus internal RPC communications.");
 TAG_FLAG(consensus_rpc_timeout_ms, advanced);
 
+DEFINE_bool(consensus_send_serialized_ops, true,
+            "Whether the leader serializes each replicated operation once and sends the same "
+            "serialized bytes to all followers, instead of serializing it for each of them.");
+TAG_FLAG(consensus_send_serialized_ops, advanced);
+
+DEFINE_int32(raft_quiesce_after_ms, 0,
+             "Time without writes to a tablet, after which its leader stops heartbeating followers "
+             "that have all operations, and those followers stop leader failure detection. The "
+             "next write, or the leader's server going down according to the master, wakes the "
+             "tablet up. 0 to keep heartbeating idle tablets.");
+TAG_FLAG(raft_quiesce_after_ms, advanced);
+TAG_FLAG(raft_quiesce_after_ms, runtime);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
+DECLARE_int32(consensus_max_in_flight_requests_per_peer);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
                  "Fraction of the time when the leader will crash just before sending an "
@@ -115,17 +130,50 @@ Peer::Peer(
       peer_pb_(peer_pb),
       proxy_(proxy.Pass()),
       queue_(queue),
-      failed_attempts_(0),
+      max_in_flight_requests_(std::max(FLAGS_consensus_max_in_flight_requests_per_peer, 1)),
+      last_sent_committed_index_(kMinimumOpIdIndex),
       sem_(1),
+      in_flight_sem_(max_in_flight_requests_),
       heartbeater_(
           peer_pb.permanent_uuid(), MonoDelta::FromMilliseconds(FLAGS_raft_heartbeat_interval_ms),
-          std::bind(&Peer::SignalRequest, this, RequestTriggerMode::ALWAYS_SEND)),
+          std::bind(&Peer::Heartbeat, this)),
       thread_pool_(thread_pool),
       state_(kPeerCreated),
-      consensus_(consensus) {}
+      consensus_(consensus) {
+  for (size_t i = 0; i != max_in_flight_requests_; ++i) {
+    update_requests_.emplace_back(new UpdateRequest);
+    free_update_requests_.push_back(update_requests_.back().get());
+  }
+}
 
 void Peer::SetTermForTest(int term) {
-  response_.set_responder_term(term);
+  for (const auto& update_request : update_requests_) {
+    update_request->response.set_responder_term(term);
+  }
+}
+
+Peer::UpdateRequest* Peer::AcquireUpdateRequest(bool* has_requests_in_flight) {
+  if (!in_flight_sem_.TryAcquire()) {
+    return nullptr;
+  }
+  std::lock_guard<simple_spinlock> lock(peer_lock_);
+  if (PREDICT_FALSE(state_ == kPeerClosed)) {
+    in_flight_sem_.Release();
+    return nullptr;
+  }
+  DCHECK(!free_update_requests_.empty());
+  auto result = free_update_requests_.back();
+  free_update_requests_.pop_back();
+  *has_requests_in_flight = free_update_requests_.size() + 1 < max_in_flight_requests_;
+  return result;
+}
+
+void Peer::ReleaseUpdateRequest(UpdateRequest* update_request) {
+  {
+    std::lock_guard<simple_spinlock> lock(peer_lock_);
+    free_update_requests_.push_back(update_request);
+  }
+  in_flight_sem_.Release();
 }
 
 Status Peer::Init() {
@@ -136,7 +184,37 @@ Status Peer::Init() {
   return Status::OK();
 }
 
+Status Peer::Heartbeat() {
+  if (quiescent_.load(std::memory_order_acquire)) {
+    return Status::OK();
+  }
+  return SignalRequest(RequestTriggerMode::ALWAYS_SEND);
+}
+
+bool Peer::Wake() {
+  if (!quiescent_.exchange(false, std::memory_order_acq_rel)) {
+    return false;
+  }
+  VLOG_WITH_PREFIX_UNLOCKED(1) << "Waking up";
+  // The peer was not contacted while quiescent on purpose, it should not be considered failed.
+  queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
+  return true;
+}
+
+void Peer::Quiesce() {
+  VLOG_WITH_PREFIX_UNLOCKED(1) << "Quiescing";
+  quiescent_.store(true, std::memory_order_release);
+  // An operation could be appended after the quiescing response was handled, with its
+  // SignalRequest() finding the peer still active.
+  if (!queue_->CanPeerQuiesce(peer_pb_.permanent_uuid(), MonoDelta::kZero)) {
+    WARN_NOT_OK(SignalRequest(RequestTriggerMode::ALWAYS_SEND), "Failed to wake up peer");
+  }
+}
+
 Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
+  // Any request other than a heartbeat means the tablet is not idle anymore.
+  Wake();
+
   // If the peer is currently sending, return Status::OK().
   // If there are new requests in the queue we'll get them on ProcessResponse().
   if (!sem_.TryAcquire()) {
@@ -150,6 +228,12 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
       return STATUS(IllegalState, "Peer was closed.");
     }
 
+    // All update requests are in flight, the next one will be sent when a response arrives.
+    if (free_update_requests_.empty()) {
+      sem_.Release();
+      return Status::OK();
+    }
+
     // For the first request sent by the peer, we send it even if the queue is empty, which it will
     // always appear to be for the first request, since this is the negotiation round.
     if (PREDICT_FALSE(state_ == kPeerStarted)) {
@@ -183,25 +267,41 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
 void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   DCHECK_LE(sem_.GetValue(), 0) << "Cannot send request";
 
+  // All update requests are in flight, the next one will be sent when a response arrives.
+  bool has_requests_in_flight = false;
+  UpdateRequest* update_request = AcquireUpdateRequest(&has_requests_in_flight);
+  if (!update_request) {
+    sem_.Release();
+    return;
+  }
+  auto& request = update_request->request;
+
   // The peer has no pending request nor is sending: send the request.
   bool needs_remote_bootstrap = false;
   bool last_exchange_successful = false;
   RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
-  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request_,
-      &replicate_msg_refs_, &needs_remote_bootstrap, &member_type, &last_exchange_successful);
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
+  int64_t commit_index_before = last_sent_committed_index_;
+  std::vector<RefCntBuffer>* serialized_ops = nullptr;
+  if (FLAGS_consensus_send_serialized_ops && proxy_->SupportsRequestExtraData()) {
+    serialized_ops = &update_request->serialized_ops;
+  }
+  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request,
+      &update_request->replicate_msg_refs, &needs_remote_bootstrap, &member_type,
+      &last_exchange_successful, &update_request->sent_lease, serialized_ops);
+  int64_t commit_index_after = request.has_committed_index() ?
+      request.committed_index().index() : kMinimumOpIdIndex;
+  last_sent_committed_index_ = commit_index_after;
 
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(INFO) << "Could not obtain request from queue for peer: "
         << peer_pb_.permanent_uuid() << ". Status: " << s.ToString();
+    ReleaseUpdateRequest(update_request);
     sem_.Release();
     return;
   }
 
   if (PREDICT_FALSE(needs_remote_bootstrap)) {
+    ReleaseUpdateRequest(update_request);
     Status s = SendRemoteBootstrapRequest();
     if (!s.ok()) {
       LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to generate remote bootstrap request for peer: "
@@ -216,6 +316,7 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   if (last_exchange_successful &&
       (member_type == RaftPeerPB::PRE_VOTER || member_type == RaftPeerPB::PRE_OBSERVER)) {
     if (PREDICT_TRUE(consensus_)) {
+      ReleaseUpdateRequest(update_request);
       sem_.Release();
       consensus::ChangeConfigRequestPB req;
       consensus::ChangeConfigResponsePB resp;
@@ -244,15 +345,20 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     }
   }
 
-  request_.set_tablet_id(tablet_id_);
-  request_.set_caller_uuid(leader_uuid_);
-  request_.set_dest_uuid(peer_pb_.permanent_uuid());
+  request.set_tablet_id(tablet_id_);
+  request.set_caller_uuid(leader_uuid_);
+  request.set_dest_uuid(peer_pb_.permanent_uuid());
 
-  const bool req_has_ops = (request_.ops_size() > 0) || (commit_index_after > commit_index_before);
+  const bool req_has_ops = !update_request->replicate_msg_refs.empty() ||
+                           (commit_index_after > commit_index_before);
 
   // If the queue is empty, check if we were told to send a status-only message (which is what
   // happens during heartbeats). If not, just return.
-  if (PREDICT_FALSE(!req_has_ops && trigger_mode == RequestTriggerMode::NON_EMPTY_ONLY)) {
+  // Requests in flight serve as heartbeats, and a status-only request sent after them would be
+  // rejected by the peer until it receives them.
+  if (PREDICT_FALSE(!req_has_ops && (trigger_mode == RequestTriggerMode::NON_EMPTY_ONLY ||
+                                     has_requests_in_flight))) {
+    ReleaseUpdateRequest(update_request);
     sem_.Release();
     return;
   }
@@ -260,21 +366,37 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   // If we're actually sending ops there's no need to heartbeat for a while, reset the heartbeater.
   if (req_has_ops) {
     heartbeater_.Reset();
+    request.clear_quiesce();
+  } else if (FLAGS_raft_quiesce_after_ms > 0 &&
+             queue_->CanPeerQuiesce(peer_pb_.permanent_uuid(),
+                                    MonoDelta::FromMilliseconds(FLAGS_raft_quiesce_after_ms))) {
+    request.set_quiesce(true);
+  } else {
+    request.clear_quiesce();
   }
 
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
-  controller_.Reset();
+  update_request->controller.Reset();
+  if (serialized_ops) {
+    update_request->controller.set_request_extra_data(std::move(*serialized_ops));
+  }
 
-  proxy_->UpdateAsync(&request_, &response_, &controller_, std::bind(&Peer::ProcessResponse, this));
+  proxy_->UpdateAsync(&request, &update_request->response, &update_request->controller,
+                      std::bind(&Peer::ProcessResponse, this, update_request));
+  // The next request could be assembled while this one is in flight.
+  sem_.Release();
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(UpdateRequest* update_request) {
   // Note: This method runs on the reactor thread.
 
-  DCHECK_LE(sem_.GetValue(), 0) << "Got a response when nothing was pending";
+  DCHECK_LT(in_flight_sem_.GetValue(), static_cast<int>(max_in_flight_requests_))
+      << "Got a response when nothing was pending";
 
-  if (!controller_.status().ok()) {
-    if (controller_.status().IsRemoteError()) {
+  const auto& controller = update_request->controller;
+  const auto& response = update_request->response;
+  if (!controller.status().ok()) {
+    if (controller.status().IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
       // failure to serialize a protobuf. Therefore, we generally consider these errors to indicate
       // an unreachable peer.  However, a RemoteError wraps some other error propagated from the
@@ -282,48 +404,61 @@ void Peer::ProcessResponse() {
       // remote is responsive.
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
-    ProcessResponseError(controller_.status());
+    ProcessResponseError(update_request, controller.status());
     return;
   }
 
   // Pass through errors we can respond to, like not found, since in that case
   // we will need to remotely bootstrap. TODO: Handle DELETED response once implemented.
-  if ((response_.has_error() &&
-      response_.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
-      (response_.status().has_error() &&
-          response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
+  if ((response.has_error() &&
+      response.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
+      (response.status().has_error() &&
+          response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
-    ProcessResponseError(StatusFromPB(response_.error().status()));
+    ProcessResponseError(update_request, StatusFromPB(response.error().status()));
     return;
   }
 
   // The queue's handling of the peer response may generate IO (reads against the WAL) and
   // SendNextRequest() may do the same thing. So we run the rest of the response handling logic on
   // our thread pool and not on the reactor thread.
-  Status s = thread_pool_->SubmitClosure(Bind(&Peer::DoProcessResponse, Unretained(this)));
+  Status s = thread_pool_->SubmitClosure(
+      Bind(&Peer::DoProcessResponse, Unretained(this), Unretained(update_request)));
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to process peer response: " << s.ToString()
-        << ": " << response_.ShortDebugString();
-    sem_.Release();
+        << ": " << response.ShortDebugString();
+    ReleaseUpdateRequest(update_request);
   }
 }
 
-void Peer::DoProcessResponse() {
+void Peer::DoProcessResponse(UpdateRequest* update_request) {
   failed_attempts_ = 0;
 
   bool more_pending;
-  queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_, &more_pending);
+  queue_->ResponseFromPeer(
+      peer_pb_.permanent_uuid(), update_request->response, &more_pending,
+      &update_request->sent_lease);
 
   // We're OK to read the state_ without a lock here -- if we get a race,
   // the worst thing that could happen is that we'll make one more request before
   // noticing a close.
-  if (more_pending && ANNOTATE_UNPROTECTED_READ(state_) != kPeerClosed) {
-    SendNextRequest(RequestTriggerMode::ALWAYS_SEND);
-  } else {
-    sem_.Release();
+  if (!more_pending || ANNOTATE_UNPROTECTED_READ(state_) == kPeerClosed) {
+    const bool quiesce = !more_pending && update_request->request.quiesce() &&
+                         update_request->response.quiescent();
+    ReleaseUpdateRequest(update_request);
+    if (quiesce) {
+      Quiesce();
+    }
+    return;
   }
+
+  // Keep the update request till the semaphore is acquired, so a concurrent SignalRequest(),
+  // that did not find a free update request, does not make us miss the pending ops.
+  sem_.Acquire();
+  ReleaseUpdateRequest(update_request);
+  SendNextRequest(RequestTriggerMode::ALWAYS_SEND);
 }
 
 Status Peer::SendRemoteBootstrapRequest() {
@@ -334,9 +469,9 @@ Status Peer::SendRemoteBootstrapRequest() {
 
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Sending request to remotely bootstrap";
   RETURN_NOT_OK(queue_->GetRemoteBootstrapRequestForPeer(peer_pb_.permanent_uuid(), &rb_request_));
-  controller_.Reset();
+  rb_controller_.Reset();
   proxy_->StartRemoteBootstrap(
-      &rb_request_, &rb_response_, &controller_,
+      &rb_request_, &rb_response_, &rb_controller_,
       std::bind(&Peer::ProcessRemoteBootstrapResponse, this));
   return Status::OK();
 }
@@ -350,13 +485,14 @@ void Peer::ProcessRemoteBootstrapResponse() {
   sem_.Release();
 }
 
-void Peer::ProcessResponseError(const Status& status) {
+void Peer::ProcessResponseError(UpdateRequest* update_request, const Status& status) {
   failed_attempts_++;
+  queue_->RequestToPeerFailed(peer_pb_.permanent_uuid());
   LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Couldn't send request to peer " << peer_pb_.permanent_uuid()
       << " for tablet " << tablet_id_
       << " Status: " << status.ToString() << ". Retrying in the next heartbeat period."
-      << " Already tried " << failed_attempts_ << " times.";
-  sem_.Release();
+      << " Already tried " << failed_attempts_.load() << " times.";
+  ReleaseUpdateRequest(update_request);
 }
 
 string Peer::LogPrefixUnlocked() const {
@@ -377,14 +513,24 @@ void Peer::Close() {
   }
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Closing peer: " << peer_pb_.permanent_uuid();
 
-  // Acquire the semaphore to wait for any concurrent request to finish.  They will see the state_
+  // Acquire the semaphores to wait for any concurrent request to finish.  They will see the state_
   // == kPeerClosed and not start any new requests, but we can't currently cancel the already-sent
   // ones. (see KUDU-699)
+  for (size_t i = 0; i != max_in_flight_requests_; ++i) {
+    in_flight_sem_.Acquire();
+  }
   std::lock_guard<Semaphore> l(sem_);
   queue_->UntrackPeer(peer_pb_.permanent_uuid());
-  // We don't own the ops (the queue does).
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops_size(), nullptr);
-  replicate_msg_refs_.clear();
+  for (const auto& update_request : update_requests_) {
+    // We don't own the ops (the queue does).
+    auto& request = update_request->request;
+    request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+    update_request->replicate_msg_refs.clear();
+    update_request->serialized_ops.clear();
+  }
+  for (size_t i = 0; i != max_in_flight_requests_; ++i) {
+    in_flight_sem_.Release();
+  }
 }
 
 Peer::~Peer() {
@@ -392,15 +538,21 @@ Peer::~Peer() {
 }
 
 RpcPeerProxy::RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy)
+                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+                           std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher)
     : hostport_(hostport.Pass()),
-      consensus_proxy_(consensus_proxy.Pass()) {
+      consensus_proxy_(consensus_proxy.Pass()),
+      heartbeat_batcher_(std::move(heartbeat_batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
                                ConsensusResponsePB* response,
                                rpc::RpcController* controller,
                                const rpc::ResponseCallback& callback) {
+  if (heartbeat_batcher_ && MultiRaftHeartbeatBatcher::CanBatch(*request, *controller)) {
+    heartbeat_batcher_->AddRequest(request, response, controller, callback);
+    return;
+  }
   controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
@@ -438,9 +590,11 @@ RpcPeerProxy::~RpcPeerProxy() {}
 
 namespace {
 
-Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger,
-                                          const HostPort& hostport,
-                                          gscoped_ptr<ConsensusServiceProxy>* new_proxy) {
+Status CreateConsensusServiceProxyForHost(
+    const shared_ptr<Messenger>& messenger,
+    const HostPort& hostport,
+    gscoped_ptr<ConsensusServiceProxy>* new_proxy,
+    std::shared_ptr<MultiRaftHeartbeatBatcher>* heartbeat_batcher = nullptr) {
   std::vector<Endpoint> addrs;
   RETURN_NOT_OK(hostport.ResolveAddresses(&addrs));
   if (addrs.size() > 1) {
@@ -449,6 +603,9 @@ Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger
                  << addrs[0];
   }
   new_proxy->reset(new ConsensusServiceProxy(messenger, addrs[0]));
+  if (heartbeat_batcher) {
+    *heartbeat_batcher = MultiRaftHeartbeatBatcher::Get(messenger, addrs[0]);
+  }
   return Status::OK();
 }
 
@@ -462,8 +619,10 @@ Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
   gscoped_ptr<HostPort> hostport(new HostPort);
   RETURN_NOT_OK(HostPortFromPB(peer_pb.last_known_addr(), hostport.get()));
   gscoped_ptr<ConsensusServiceProxy> new_proxy;
-  RETURN_NOT_OK(CreateConsensusServiceProxyForHost(messenger_, *hostport, &new_proxy));
-  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass()));
+  std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher;
+  RETURN_NOT_OK(CreateConsensusServiceProxyForHost(
+      messenger_, *hostport, &new_proxy, &heartbeat_batcher));
+  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass(), std::move(heartbeat_batcher)));
   return Status::OK();
 }
 
@@ -33,6 +33,7 @@
 #ifndef YB_CONSENSUS_CONSENSUS_PEERS_H_
 #define YB_CONSENSUS_CONSENSUS_PEERS_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,6 +47,7 @@
 #include "yb/rpc/rpc_controller.h"
 #include "yb/util/countdown_latch.h"
 #include "yb/util/locks.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/resettable_heartbeater.h"
 #include "yb/util/semaphore.h"
 #include "yb/util/status.h"
@@ -60,6 +62,7 @@ class Log;
 
 namespace consensus {
 class ConsensusServiceProxy;
+class MultiRaftHeartbeatBatcher;
 class PeerProxy;
 class PeerProxyFactory;
 class PeerMessageQueue;
@@ -116,14 +119,21 @@ class VoteResponsePB;
 //        v                               v
 //  SignalRequest()                    return
 //
+// When --consensus_max_in_flight_requests_per_peer is above 1, "processing" only covers assembling
+// and sending of a request, so the next request could be sent before the response to the previous
+// one arrives, as long as the number of requests in flight stays within that limit.
 class Peer {
  public:
   // Initializes a peer and get its status.
   CHECKED_STATUS Init();
 
-  // Signals that this peer has a new request to replicate/store.
+  // Signals that this peer has a new request to replicate/store. Wakes up a quiescent peer.
   CHECKED_STATUS SignalRequest(RequestTriggerMode trigger_mode);
 
+  // Makes a quiescent peer active again, so heartbeats to it are resumed. Returns whether the peer
+  // was quiescent. See --raft_quiesce_after_ms.
+  bool Wake();
+
   const RaftPeerPB& peer_pb() const { return peer_pb_; }
 
   // Returns the PeerProxy if this is a remote peer or NULL if it
@@ -157,15 +167,48 @@ class Peer {
        gscoped_ptr<PeerProxy> proxy, PeerMessageQueue* queue,
        ThreadPool* thread_pool, Consensus* consensus);
 
+  // State of an UpdateConsensus request to the peer.
+  struct UpdateRequest {
+    ConsensusRequestPB request;
+    ConsensusResponsePB response;
+    rpc::RpcController controller;
+
+    // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We may have
+    // loaded these messages from the LogCache, in which case we are potentially sharing the same
+    // object as other peers. Since the PB request itself can't hold reference counts, this holds
+    // them.
+    ReplicateMsgs replicate_msg_refs;
+
+    // Serialized replicate_msg_refs, that are sent after the request instead of its ops.
+    // They are shared with requests to other peers.
+    std::vector<RefCntBuffer> serialized_ops;
+
+    // Lease expirations sent with the request.
+    LeaseExpirations sent_lease;
+  };
+
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
+  // Invoked by the heartbeater, sends a status-only request unless the peer is quiescent.
+  CHECKED_STATUS Heartbeat();
+
+  // Stops heartbeats to the peer, after it accepted a request with the quiesce flag.
+  void Quiesce();
+
+  // Takes an update request that is not in flight, returns nullptr if all of them are in flight.
+  // has_requests_in_flight is set to whether some other update requests are in flight.
+  UpdateRequest* AcquireUpdateRequest(bool* has_requests_in_flight);
+
+  // Returns an update request, whose response was handled.
+  void ReleaseUpdateRequest(UpdateRequest* update_request);
+
   // Signals that a response was received from the peer.  This method is called from the reactor
   // thread and calls DoProcessResponse() on thread_pool_ to do any work that requires IO or
   // lock-taking.
-  void ProcessResponse();
+  void ProcessResponse(UpdateRequest* update_request);
 
   // Run on 'thread_pool'. Does response handling that requires IO or may block.
-  void DoProcessResponse();
+  void DoProcessResponse(UpdateRequest* update_request);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -178,7 +221,7 @@ class Peer {
   void ProcessRemoteBootstrapResponse();
 
   // Signals there was an error sending the request to the peer.
-  void ProcessResponseError(const Status& status);
+  void ProcessResponseError(UpdateRequest* update_request, const Status& status);
 
   std::string LogPrefixUnlocked() const;
 
@@ -192,32 +235,42 @@ class Peer {
   gscoped_ptr<PeerProxy> proxy_;
 
   PeerMessageQueue* queue_;
-  uint64_t failed_attempts_;
+  std::atomic<uint64_t> failed_attempts_{0};
+
+  // Maximum number of update requests in flight, from --consensus_max_in_flight_requests_per_peer.
+  const size_t max_in_flight_requests_;
+
+  // Update requests, there is one for each request that could be in flight.
+  std::vector<std::unique_ptr<UpdateRequest>> update_requests_;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
+  // Update requests that are not in flight. Protected by peer_lock_.
+  std::vector<UpdateRequest*> free_update_requests_;
+
+  // Committed index sent with the latest update request.
+  int64_t last_sent_committed_index_;
 
   // The latest remote bootstrap request and response.
   StartRemoteBootstrapRequestPB rb_request_;
   StartRemoteBootstrapResponsePB rb_response_;
 
-  // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We may have
-  // loaded these messages from the LogCache, in which case we are potentially sharing the same
-  // object as other peers. Since the PB request_ itself can't hold reference counts, this holds
-  // them.
-  ReplicateMsgs replicate_msg_refs_;
-
-  rpc::RpcController controller_;
+  rpc::RpcController rb_controller_;
 
-  // Held if there is an outstanding request.  This is used in order to ensure that we only have a
-  // single request oustanding at a time, and to wait for the outstanding requests at Close().
+  // Held while a request is assembled and sent, or while handling a response, that requires
+  // sending a new request. Also held during the whole remote bootstrap request. This is used in
+  // order to ensure that only one request is being assembled at a time.
   Semaphore sem_;
 
+  // Has a permit for each update request that is not in flight. Used to wait for the outstanding
+  // requests at Close().
+  Semaphore in_flight_sem_;
+
   // Heartbeater for remote peer implementations.  This will send status only requests to the remote
   // peers whenever we go more than 'FLAGS_raft_heartbeat_interval_ms' without sending actual data.
   ResettableHeartbeater heartbeater_;
 
+  // Whether the peer accepted a quiescing request and no request was signaled since then.
+  std::atomic<bool> quiescent_{false};
+
   // Thread pool used to construct requests to this peer.
   ThreadPool* thread_pool_;
 
@@ -246,6 +299,10 @@ class PeerProxy {
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) = 0;
 
+  // Whether UpdateAsync() sends the request extra data of the controller along with the request,
+  // see rpc::RpcController::set_request_extra_data().
+  virtual bool SupportsRequestExtraData() const { return false; }
+
   // Sends a RequestConsensusVote to a remote peer.
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
@@ -293,13 +350,16 @@ class PeerProxyFactory {
 class RpcPeerProxy : public PeerProxy {
  public:
   RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-               gscoped_ptr<ConsensusServiceProxy> consensus_proxy);
+               gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+               std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            ConsensusResponsePB* response,
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override;
 
+  bool SupportsRequestExtraData() const override { return true; }
+
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
@@ -325,6 +385,7 @@ class RpcPeerProxy : public PeerProxy {
  private:
   gscoped_ptr<HostPort> hostport_;
   gscoped_ptr<ConsensusServiceProxy> consensus_proxy_;
+  std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher_;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
@@ -255,6 +255,54 @@ TEST_F(ConsensusQueueTest, TestStartTrackingAfterStart) {
   request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
 }
 
+// Tests that the safe time is sent to peers along with the committed index.
+TEST_F(ConsensusQueueTest, TestPropagatesSafeTime) {
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(2));
+  queue_->TrackPeer(kPeerUuid);
+
+  ConsensusRequestPB request;
+  ReplicateMsgs refs;
+  bool needs_remote_bootstrap;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap));
+  ASSERT_FALSE(request.has_propagated_safe_time());
+
+  HybridTime safe_time = clock_->Now();
+  queue_->SetSafeTimeProvider([safe_time] { return safe_time; });
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap));
+  ASSERT_EQ(safe_time.ToUint64(), request.propagated_safe_time());
+
+  queue_->SetSafeTimeProvider([] { return HybridTime::kInvalid; });
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap));
+  ASSERT_FALSE(request.has_propagated_safe_time());
+}
+
+TEST_F(ConsensusQueueTest, TestPeerQuiesce) {
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(2));
+  queue_->TrackPeer(kPeerUuid);
+
+  // The peer did not respond yet.
+  ASSERT_FALSE(queue_->CanPeerQuiesce(kPeerUuid, MonoDelta::kZero));
+
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  response.set_responder_term(MinimumOpId().term());
+  SetLastReceivedAndLastCommitted(&response, MinimumOpId(), MinimumOpId().index());
+  bool more_pending;
+  queue_->ResponseFromPeer(kPeerUuid, response, &more_pending);
+  ASSERT_FALSE(more_pending);
+
+  ASSERT_TRUE(queue_->CanPeerQuiesce(kPeerUuid, MonoDelta::kZero));
+  // Not idle for long enough.
+  ASSERT_FALSE(queue_->CanPeerQuiesce(kPeerUuid, MonoDelta::FromSeconds(3600)));
+  ASSERT_FALSE(queue_->CanPeerQuiesce("unknown-peer", MonoDelta::kZero));
+
+  // The peer does not have the new operation.
+  AppendReplicateMessagesToQueue(queue_.get(), clock_, 1, 1);
+  ASSERT_FALSE(queue_->CanPeerQuiesce(kPeerUuid, MonoDelta::kZero));
+}
+
 // Tests that the peers gets the messages pages, with the size of a page
 // being 'consensus_max_batch_size_bytes'
 TEST_F(ConsensusQueueTest, TestGetPagedMessages) {
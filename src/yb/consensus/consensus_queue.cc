@@ -39,6 +39,7 @@
 #include <utility>
 
 #include <boost/container/small_vector.hpp>
+#include <boost/optional.hpp>
 
 #include <gflags/gflags.h>
 
@@ -90,6 +91,18 @@ DEFINE_int32(consensus_inject_latency_ms_in_notifications, 0,
 TAG_FLAG(consensus_inject_latency_ms_in_notifications, hidden);
 TAG_FLAG(consensus_inject_latency_ms_in_notifications, unsafe);
 
+DEFINE_int32(consensus_max_in_flight_requests_per_peer, 1,
+             "Maximum number of UpdateConsensus requests that the leader could send to a follower "
+             "without waiting for responses to the previous ones. Values above 1 pipeline "
+             "replication, which helps when the round trip time to followers is high.");
+TAG_FLAG(consensus_max_in_flight_requests_per_peer, advanced);
+
+DEFINE_bool(remote_bootstrap_from_followers, true,
+            "Remote bootstrap a peer from an up to date follower in the same zone as the peer, "
+            "when there is one, instead of from the leader.");
+TAG_FLAG(remote_bootstrap_from_followers, advanced);
+TAG_FLAG(remote_bootstrap_from_followers, runtime);
+
 DECLARE_int32(rpc_max_message_size);
 
 namespace yb {
@@ -167,6 +180,7 @@ void PeerMessageQueue::SetLeaderMode(const OpId& committed_index,
       << queue_state_.active_config->ShortDebugString();
   queue_state_.majority_size_ = MajoritySize(CountVoters(*queue_state_.active_config));
   queue_state_.mode = Mode::LEADER;
+  queue_state_.last_append_time = MonoTime::FineNow();
 
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Queue going to LEADER mode. State: "
       << queue_state_.ToString();
@@ -292,6 +306,7 @@ Status PeerMessageQueue::AppendOperations(const ReplicateMsgs& msgs,
                                                  log_append_callback)));
   lock.lock();
   queue_state_.last_appended = last_id;
+  queue_state_.last_append_time = MonoTime::FineNow();
   UpdateMetrics();
 
   return Status::OK();
@@ -302,10 +317,16 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ReplicateMsgs* msg_refs,
                                         bool* needs_remote_bootstrap,
                                         RaftPeerPB::MemberType* member_type,
-                                        bool* last_exchange_successful) {
+                                        bool* last_exchange_successful,
+                                        LeaseExpirations* sent_lease,
+                                        std::vector<RefCntBuffer>* serialized_ops) {
   TrackedPeer* peer = nullptr;
   OpId preceding_id;
   MonoDelta unreachable_time = MonoDelta::kMin;
+  int64_t next_index;
+  // Safe time should be obtained before the committed index, so all operations with lower hybrid
+  // time are already committed when the committed index is read.
+  HybridTime safe_time = safe_time_provider_ ? safe_time_provider_() : HybridTime::kInvalid;
   {
     LockGuard lock(queue_lock_);
     DCHECK_EQ(queue_state_.state, State::kQueueOpen);
@@ -324,18 +345,33 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
       peer->last_leader_lease_expiration_sent_to_follower =
           MonoTime::FineNow() + MonoDelta::FromMilliseconds(FLAGS_leader_lease_duration_ms);
       peer->last_ht_lease_expiration_sent_to_follower = ht_lease_expiration_micros;
+      if (sent_lease) {
+        sent_lease->leader_lease_expiration = peer->last_leader_lease_expiration_sent_to_follower;
+        sent_lease->ht_lease_expiration = ht_lease_expiration_micros;
+      }
     }
 
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
+    request->clear_ops_compression_codec();
+    msg_refs->clear();
+    if (serialized_ops) {
+      serialized_ops->clear();
+    }
 
     // This is initialized to the queue's last appended op but gets set to the id of the
     // log entry preceding the first one in 'messages' if messages are found for the peer.
     preceding_id = queue_state_.last_appended;
     request->mutable_committed_index()->CopyFrom(queue_state_.committed_index);
+    if (safe_time.is_valid()) {
+      request->set_propagated_safe_time(safe_time.ToUint64());
+    } else {
+      request->clear_propagated_safe_time();
+    }
     request->set_caller_term(queue_state_.current_term);
     unreachable_time =
         MonoTime::Now(MonoTime::FINE).GetDeltaSince(peer->last_successful_communication_time);
+    next_index = peer->next_index;
   }
 
   if (unreachable_time.ToSeconds() > FLAGS_follower_unavailable_considered_failed_sec) {
@@ -370,10 +406,11 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
 
     // We try to get the follower's next_index from our log.
-    Status s = log_cache_.ReadOps(peer->next_index - 1,
+    Status s = log_cache_.ReadOps(next_index - 1,
                                   max_batch_size,
                                   &messages,
-                                  &preceding_id);
+                                  &preceding_id,
+                                  serialized_ops);
     if (PREDICT_FALSE(!s.ok())) {
       if (PREDICT_TRUE(s.IsNotFound())) {
         // It's normal to have a NotFound() here if a follower falls behind where
@@ -402,10 +439,24 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     // "all replicated" point. At some point we may want to allow partially loading
     // (and not pinning) earlier messages. At that point we'll need to do something
     // smarter here, like copy or ref-count.
-    for (const auto& msg : messages) {
-      request->mutable_ops()->AddAllocated(msg.get());
+    // Serialized ops are sent as is, so they are not added to the request.
+    if (!serialized_ops) {
+      for (const auto& msg : messages) {
+        request->mutable_ops()->AddAllocated(msg.get());
+      }
+    } else if (!messages.empty() && log_cache_.ops_compression() != NO_COMPRESSION) {
+      request->set_ops_compression_codec(log_cache_.ops_compression());
+    }
+    if (FLAGS_consensus_max_in_flight_requests_per_peer > 1 && !messages.empty()) {
+      // The next request continues after the ops of this one. A response to the peer, that
+      // arrived in the meantime, takes precedence, since it is based on the actual peer state.
+      LockGuard lock(queue_lock_);
+      if (peer->next_index == next_index) {
+        peer->next_index = messages.back()->id().index() + 1;
+      }
     }
     msg_refs->swap(messages);
+    DCHECK(!serialized_ops || request->ops_size() == 0);
     DCHECK_LE(request->ByteSize(), FLAGS_consensus_max_batch_size_bytes);
   }
 
@@ -413,11 +464,11 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   request->mutable_preceding_id()->CopyFrom(preceding_id);
 
   if (PREDICT_FALSE(VLOG_IS_ON(2))) {
-    if (request->ops_size() > 0) {
+    if (!msg_refs->empty()) {
       VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending request with operations to Peer: " << uuid
-          << ". Size: " << request->ops_size()
-          << ". From: " << request->ops(0).id().ShortDebugString() << ". To: "
-          << request->ops(request->ops_size() - 1).id().ShortDebugString();
+          << ". Size: " << msg_refs->size()
+          << ". From: " << msg_refs->front()->id().ShortDebugString() << ". To: "
+          << msg_refs->back()->id().ShortDebugString();
     } else {
       VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending status only request to Peer: " << uuid
           << ": " << request->DebugString();
@@ -427,9 +478,68 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   return Status::OK();
 }
 
+namespace {
+
+bool SameZone(const CloudInfoPB& lhs, const CloudInfoPB& rhs) {
+  return lhs.placement_cloud() == rhs.placement_cloud() &&
+         lhs.placement_region() == rhs.placement_region() &&
+         lhs.placement_zone() == rhs.placement_zone();
+}
+
+const RaftPeerPB* FindPeerInConfig(const RaftConfigPB& config, const string& uuid) {
+  for (const auto& peer : config.peers()) {
+    if (peer.permanent_uuid() == uuid) {
+      return &peer;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+const RaftPeerPB* PeerMessageQueue::FindRemoteBootstrapSourceUnlocked(const string& uuid) const {
+  if (!FLAGS_remote_bootstrap_from_followers || !queue_state_.active_config) {
+    return nullptr;
+  }
+  const RaftConfigPB& config = *queue_state_.active_config;
+  const RaftPeerPB* dest = FindPeerInConfig(config, uuid);
+  if (dest == nullptr || !dest->cloud_info().has_placement_zone()) {
+    return nullptr;
+  }
+  for (const auto& entry : peers_map_) {
+    const TrackedPeer* candidate = entry.second;
+    if (candidate->uuid == uuid || candidate->uuid == local_peer_pb_.permanent_uuid() ||
+        candidate->member_type != RaftPeerPB::VOTER || candidate->needs_remote_bootstrap ||
+        !candidate->is_last_exchange_successful ||
+        candidate->last_received.index() < queue_state_.committed_index.index()) {
+      continue;
+    }
+    const RaftPeerPB* source = FindPeerInConfig(config, candidate->uuid);
+    if (source != nullptr && source->has_last_known_addr() &&
+        SameZone(source->cloud_info(), dest->cloud_info())) {
+      return source;
+    }
+  }
+  return nullptr;
+}
+
+Status PeerMessageQueue::ReadCommittedOps(int64_t after_op_index,
+                                          int64_t committed_index,
+                                          int max_size_bytes,
+                                          ReplicateMsgs* msgs) {
+  OpId preceding_id;
+  RETURN_NOT_OK(log_cache_.ReadOps(after_op_index, max_size_bytes, msgs, &preceding_id));
+  // The cache also has the operations that are not committed yet.
+  while (!msgs->empty() && msgs->back()->id().index() > committed_index) {
+    msgs->pop_back();
+  }
+  return Status::OK();
+}
+
 Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
                                                           StartRemoteBootstrapRequestPB* req) {
   TrackedPeer* peer = nullptr;
+  boost::optional<RaftPeerPB> source;
   {
     LockGuard lock(queue_lock_);
     DCHECK_EQ(queue_state_.state, State::kQueueOpen);
@@ -438,6 +548,10 @@ Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
     if (PREDICT_FALSE(peer == nullptr || queue_state_.mode == Mode::NON_LEADER)) {
       return STATUS(NotFound, "Peer not tracked or queue not in leader mode.");
     }
+    const RaftPeerPB* follower = FindRemoteBootstrapSourceUnlocked(uuid);
+    if (follower != nullptr) {
+      source = *follower;
+    }
   }
 
   if (PREDICT_FALSE(!peer->needs_remote_bootstrap)) {
@@ -452,8 +566,14 @@ Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
   req->Clear();
   req->set_dest_uuid(uuid);
   req->set_tablet_id(tablet_id_);
-  req->set_bootstrap_peer_uuid(local_peer_pb_.permanent_uuid());
-  *req->mutable_bootstrap_peer_addr() = local_peer_pb_.last_known_addr();
+  // The peer catches up with the leader through Raft after it was bootstrapped from a follower.
+  const RaftPeerPB& source_pb = source ? *source : local_peer_pb_;
+  if (source) {
+    LOG_WITH_PREFIX_UNLOCKED(INFO) << "Remote bootstrapping peer " << uuid << " from follower "
+                                   << source_pb.permanent_uuid() << " in the same zone";
+  }
+  req->set_bootstrap_peer_uuid(source_pb.permanent_uuid());
+  *req->mutable_bootstrap_peer_addr() = source_pb.last_known_addr();
   req->set_caller_term(queue_state_.current_term);
   peer->needs_remote_bootstrap = false; // Now reset the flag.
   return Status::OK();
@@ -611,9 +731,20 @@ void PeerMessageQueue::NotifyPeerIsResponsiveDespiteError(const std::string& pee
   peer->last_successful_communication_time = MonoTime::Now(MonoTime::FINE);
 }
 
+void PeerMessageQueue::RequestToPeerFailed(const std::string& peer_uuid) {
+  if (FLAGS_consensus_max_in_flight_requests_per_peer <= 1) {
+    return;
+  }
+  LockGuard l(queue_lock_);
+  TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+  if (!peer || peer->acked_next_index == kInvalidOpIdIndex) return;
+  peer->next_index = peer->acked_next_index;
+}
+
 void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                         const ConsensusResponsePB& response,
-                                        bool* more_pending) {
+                                        bool* more_pending,
+                                        const LeaseExpirations* sent_lease) {
   DCHECK(response.IsInitialized()) << "Error: Uninitialized: "
       << response.InitializationErrorString() << ". Response: " << response.ShortDebugString();
 
@@ -687,10 +818,20 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     // sent them anything, start after the last-committed op in their log, which
     // is guaranteed by the Raft protocol to be a valid op.
 
+    // When requests are pipelined, a successful response could belong to a request that was sent
+    // before the one, whose response was already handled. Such a response should not move the
+    // peer state back. Errors always reset the peer state, since the following requests are
+    // rejected by the peer as well.
+    const bool pipelined =
+        FLAGS_consensus_max_in_flight_requests_per_peer > 1 && !status.has_error() &&
+        !previous.is_new;
+
     bool peer_has_prefix_of_log = IsOpInLog(status.last_received());
     if (peer_has_prefix_of_log) {
       // If the latest thing in their log is in our log, we are in sync.
-      peer->last_received = status.last_received();
+      if (!pipelined || !OpIdLessThan(status.last_received(), peer->last_received)) {
+        peer->last_received = status.last_received();
+      }
       peer->next_index = peer->last_received.index() + 1;
 
     } else if (!OpIdEquals(status.last_received_current_leader(), MinimumOpId())) {
@@ -711,6 +852,12 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       peer->next_index = peer->last_known_committed_idx + 1;
     }
 
+    peer->acked_next_index = peer->next_index;
+    if (pipelined) {
+      // Don't resend ops that are still in flight.
+      peer->next_index = std::max(peer->next_index, previous.next_index);
+    }
+
     if (PREDICT_FALSE(status.has_error())) {
       peer->is_last_exchange_successful = false;
       switch (status.error().code()) {
@@ -776,11 +923,25 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       }
       majority_replicated.op_id = queue_state_.majority_replicated_opid;
 
-      peer->last_leader_lease_expiration_received_by_follower =
-          peer->last_leader_lease_expiration_sent_to_follower;
+      if (sent_lease) {
+        // Responses to pipelined requests could arrive out of order, so lease expirations should
+        // never move back.
+        if (sent_lease->leader_lease_expiration &&
+            (!peer->last_leader_lease_expiration_received_by_follower ||
+             peer->last_leader_lease_expiration_received_by_follower <
+                 sent_lease->leader_lease_expiration)) {
+          peer->last_leader_lease_expiration_received_by_follower =
+              sent_lease->leader_lease_expiration;
+        }
+        peer->last_ht_lease_expiration_received_by_follower = std::max(
+            peer->last_ht_lease_expiration_received_by_follower, sent_lease->ht_lease_expiration);
+      } else {
+        peer->last_leader_lease_expiration_received_by_follower =
+            peer->last_leader_lease_expiration_sent_to_follower;
 
-      peer->last_ht_lease_expiration_received_by_follower =
-          peer->last_ht_lease_expiration_sent_to_follower;
+        peer->last_ht_lease_expiration_received_by_follower =
+            peer->last_ht_lease_expiration_sent_to_follower;
+      }
 
       majority_replicated.leader_lease_expiration = LeaderLeaseExpirationWatermark();
 
@@ -1019,6 +1180,20 @@ bool PeerMessageQueue::CanPeerBecomeLeader(const std::string& peer_uuid) const {
   return peer_can_be_leader;
 }
 
+bool PeerMessageQueue::CanPeerQuiesce(const std::string& peer_uuid,
+                                      const MonoDelta& idle_time) const {
+  std::lock_guard<simple_spinlock> lock(queue_lock_);
+  if (queue_state_.mode != Mode::LEADER ||
+      MonoTime::FineNow().GetDeltaSince(queue_state_.last_append_time).LessThan(idle_time) ||
+      queue_state_.committed_index.index() != queue_state_.last_appended.index()) {
+    return false;
+  }
+  const TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+  return peer != nullptr && peer->is_last_exchange_successful &&
+         peer->last_received.index() == queue_state_.last_appended.index() &&
+         peer->last_known_committed_idx == queue_state_.committed_index.index();
+}
+
 PeerMessageQueue::~PeerMessageQueue() {
   Close();
 }
@@ -33,6 +33,7 @@
 #ifndef YB_CONSENSUS_CONSENSUS_QUEUE_H_
 #define YB_CONSENSUS_CONSENSUS_QUEUE_H_
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <string>
@@ -44,6 +45,7 @@
 #include "yb/common/hybrid_time.h"
 
 #include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus_util.h"
 #include "yb/consensus/log_cache.h"
 #include "yb/consensus/log_util.h"
 #include "yb/consensus/opid_util.h"
@@ -112,6 +114,10 @@ class PeerMessageQueue {
     // Next index to send to the peer.  This corresponds to "nextIndex" as specified in Raft.
     int64_t next_index = kInvalidOpIdIndex;
 
+    // Next index to send to the peer according to its last response. When requests to the peer
+    // are pipelined, next_index runs ahead of it, and is reset back to it when a request fails.
+    int64_t acked_next_index = kInvalidOpIdIndex;
+
     // The last operation that we've sent to this peer and that it acked. Used for watermark
     // movement.
     OpId last_received;
@@ -223,19 +229,37 @@ class PeerMessageQueue {
   // Returns STATUS(Incomplete, "") if we try to read an operation index from the log that has not
   // been written.
   //
+  // When requests to peers are pipelined, the next request for the peer continues after the ops
+  // of this one, without waiting for a response. 'sent_lease' is set to the lease expirations sent
+  // with the request, so the response to it could be matched with them.
+  //
   // WARNING: In order to avoid copying the same messages to every peer, entries are added to
   // 'request' via AddAllocated() methods.  The owner of 'request' is expected not to delete the
   // request prior to removing the entries through ExtractSubRange() or any other method that does
   // not delete the entries. The simplest way is to pass the same instance of ConsensusRequestPB to
   // RequestForPeer(): the buffer will replace the old entries with new ones without de-allocating
   // the old ones if they are still required.
+  //
+  // If 'serialized_ops' is not null, ops are not added to 'request'. Instead it is filled with
+  // the serialized ops, framed as elements of ConsensusRequestPB::ops (or compressed_ops, see
+  // LogCache::ops_compression()), so they could be sent right after the serialized request.
+  // The same serialized buffers are shared by all peers. 'msg_refs' is filled in both cases.
   virtual CHECKED_STATUS RequestForPeer(
       const std::string& uuid,
       ConsensusRequestPB* request,
       ReplicateMsgs* msg_refs,
       bool* needs_remote_bootstrap,
       RaftPeerPB::MemberType* member_type = nullptr,
-      bool* last_exchange_successful = nullptr);
+      bool* last_exchange_successful = nullptr,
+      LeaseExpirations* sent_lease = nullptr,
+      std::vector<RefCntBuffer>* serialized_ops = nullptr);
+
+  // Reads the operations with indexes in (after_op_index, committed_index], up to max_size_bytes,
+  // from the log cache, which reads the evicted ones from the log.
+  CHECKED_STATUS ReadCommittedOps(int64_t after_op_index,
+                                  int64_t committed_index,
+                                  int max_size_bytes,
+                                  ReplicateMsgs* msgs);
 
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
@@ -249,11 +273,19 @@ class PeerMessageQueue {
   // is alive, even if it may not be fully up and running or able to accept updates.
   void NotifyPeerIsResponsiveDespiteError(const std::string& peer_uuid);
 
+  // Notifies the queue that a request to the peer failed, so when requests are pipelined, the next
+  // request should start right after the last op acknowledged by the peer.
+  void RequestToPeerFailed(const std::string& peer_uuid);
+
   // Updates the request queue with the latest response of a peer, returns whether this peer has
   // more requests pending.
+  //
+  // sent_lease - lease expirations sent with the request, that this response belongs to, as filled
+  // by RequestForPeer. When null, the lease sent with the latest request is used.
   virtual void ResponseFromPeer(const std::string& peer_uuid,
                                 const ConsensusResponsePB& response,
-                                bool* more_pending);
+                                bool* more_pending,
+                                const LeaseExpirations* sent_lease = nullptr);
 
   // Closes the queue, peers are still allowed to call UntrackPeer() and ResponseFromPeer() but no
   // additional peers can be tracked or messages queued.
@@ -278,8 +310,21 @@ class PeerMessageQueue {
 
   CHECKED_STATUS UnRegisterObserver(PeerMessageQueueObserver* observer);
 
+  typedef std::function<HybridTime()> SafeTimeProvider;
+
+  // Sets the function used to obtain the hybrid time propagated to followers along with the
+  // committed index. Should be invoked before the queue is switched to leader mode.
+  void SetSafeTimeProvider(SafeTimeProvider provider) {
+    safe_time_provider_ = std::move(provider);
+  }
+
   bool CanPeerBecomeLeader(const std::string& peer_uuid) const;
 
+  // Whether the leader could stop heartbeating the peer: no operations were appended for
+  // 'idle_time', all operations are committed, and the peer acknowledged all of them along with
+  // the committed index.
+  bool CanPeerQuiesce(const std::string& peer_uuid, const MonoDelta& idle_time) const;
+
   struct Metrics {
     // Keeps track of the number of ops. that are completed by a majority but still need
     // to be replicated to a minority (IsDone() is true, IsAllDone() is false).
@@ -336,6 +381,9 @@ class PeerMessageQueue {
     // The opid of the last operation appended to the queue.
     OpId last_appended = MinimumOpId();
 
+    // The time the last operation was appended to the queue, or the queue switched to leader mode.
+    MonoTime last_append_time = MonoTime::Min();
+
     // The queue's owner current_term.  Set by the last appended operation.  If the queue owner's
     // term is less than the term observed from another peer the queue owner must step down.
     // TODO: it is likely to be cleaner to get this from the ConsensusMetadata rather than by
@@ -356,6 +404,11 @@ class PeerMessageQueue {
     std::string ToString() const;
   };
 
+  // Returns an up to date follower in the same zone as the peer with the specified uuid, to remote
+  // bootstrap the peer from. Returns nullptr if there is no such follower or the leader should be
+  // used.
+  const RaftPeerPB* FindRemoteBootstrapSourceUnlocked(const std::string& uuid) const;
+
   // Returns true iff given 'desired_op' is found in the local WAL.
   // If the op is not found, returns false.
   // If the log cache returns some error other than NotFound, crashes with a fatal error.
@@ -444,6 +497,8 @@ class PeerMessageQueue {
   Metrics metrics_;
 
   server::ClockPtr clock_;
+
+  SafeTimeProvider safe_time_provider_;
 };
 
 inline std::ostream& operator <<(std::ostream& out, PeerMessageQueue::Mode mode) {
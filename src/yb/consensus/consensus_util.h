@@ -14,6 +14,9 @@
 #ifndef YB_CONSENSUS_CONSENSUS_UTIL_H
 #define YB_CONSENSUS_CONSENSUS_UTIL_H
 
+#include "yb/common/hybrid_time.h"
+#include "yb/util/monotime.h"
+
 namespace yb {
 namespace consensus {
 
@@ -28,6 +31,13 @@ enum class RequestTriggerMode {
   ALWAYS_SEND
 };
 
+// Leader lease expirations that the leader sent to a follower with an UpdateConsensus request, and
+// that the follower is known to have received once a response to this request arrives.
+struct LeaseExpirations {
+  MonoTime leader_lease_expiration;
+  MicrosTime ht_lease_expiration = HybridTime::kMin.GetPhysicalValueMicros();
+};
+
 }  // namespace consensus
 }  // namespace yb
 
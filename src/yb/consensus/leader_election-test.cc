@@ -460,6 +460,45 @@ TEST_F(LeaderElectionTest, TestHigherTermAfterDecision) {
 }
 
 // Out-of-date OpId "vote denied" case.
+// Voters do not advance their terms in a pre-election, so they grant votes with the term they had.
+TEST_F(LeaderElectionTest, TestPreElection) {
+  const ConsensusTerm kElectionTerm = 3;
+  const int kNumVoters = 3;
+  const int kMajoritySize = 2;
+
+  InitUUIDs(kNumVoters, 0);
+  InitDelayableMockedProxies(kNumVoters, 0, 0, 0, false);
+  gscoped_ptr<VoteCounter> counter = InitVoteCounter(kNumVoters, kMajoritySize);
+
+  for (const string& voter_uuid : voter_uuids_) {
+    VoteResponsePB response;
+    response.set_responder_uuid(voter_uuid);
+    response.set_responder_term(kElectionTerm - 1);
+    response.set_vote_granted(true);
+    down_cast<DelayablePeerProxy<MockedPeerProxy>*>(proxies_[voter_uuid])
+        ->proxy()->set_vote_response(response);
+  }
+
+  VoteRequestPB request;
+  request.set_candidate_uuid(candidate_uuid_);
+  request.set_candidate_term(kElectionTerm);
+  request.set_tablet_id(tablet_id_);
+  request.set_preelection(true);
+
+  scoped_refptr<LeaderElection> election(
+      new LeaderElection(config_, proxy_factory_.get(), request, counter.Pass(),
+                         MonoDelta::FromSeconds(kLeaderElectionTimeoutSecs),
+                         Bind(&LeaderElectionTest::ElectionCallback, Unretained(this))));
+  election->Run();
+
+  latch_.Wait();
+  ASSERT_EQ(kElectionTerm, result_->election_term);
+  ASSERT_EQ(VOTE_GRANTED, result_->decision);
+  ASSERT_FALSE(result_->has_higher_term);
+
+  pool_->Wait(); // Wait for the election callbacks to finish before we destroy proxies.
+}
+
 TEST_F(LeaderElectionTest, TestWithDenyVotes) {
   const ConsensusTerm kElectionTerm = 2;
   const int kNumGrant = 2;
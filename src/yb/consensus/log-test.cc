@@ -50,6 +50,8 @@ DEFINE_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
 
 DECLARE_int32(log_min_segments_to_retain);
+DECLARE_string(log_compression_codec);
+DECLARE_int32(log_max_recycled_segments);
 
 namespace yb {
 namespace log {
@@ -202,6 +204,72 @@ TEST_F(LogTest, TestMultipleEntriesInABatch) {
   ASSERT_OK(log_->Close());
 }
 
+// Segments written with and without compression should be readable.
+TEST_F(LogTest, TestCompressedSegments) {
+  FLAGS_log_compression_codec = "lz4";
+  BuildLog();
+
+  OpId opid = MakeOpId(1, 1);
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 100));
+  FLAGS_log_compression_codec = "none";
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 100));
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+
+  SegmentSequence segments;
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  ASSERT_GE(segments.size(), 2);
+  ASSERT_EQ(LZ4, segments[0]->header().compression_codec());
+  ASSERT_EQ(NO_COMPRESSION, segments[1]->header().compression_codec());
+  for (int i = 0; i != 2; ++i) {
+    LogEntries entries;
+    ASSERT_OK(segments[i]->ReadEntries(&entries));
+    ASSERT_EQ(100, entries.size());
+    ASSERT_EQ(i * 100 + 1, entries.front()->replicate().id().index());
+  }
+
+  ASSERT_OK(log_->Close());
+}
+
+// Reads segments with and without read ahead and checks that entries are returned in order.
+TEST_F(LogTest, TestReadAheadSegmentReader) {
+  BuildLog();
+
+  constexpr int kSegments = 4;
+  constexpr int kEntriesPerSegment = 10;
+  OpId opid = MakeOpId(1, 1);
+  for (int i = 0; i != kSegments; ++i) {
+    ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, kEntriesPerSegment));
+    ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  }
+
+  for (size_t max_ahead : {0, 1, 3}) {
+    SegmentSequence segments;
+    ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+    const size_t num_segments = segments.size();
+    ReadAheadSegmentReader reader(std::move(segments), max_ahead);
+    reader.Start();
+
+    scoped_refptr<ReadableLogSegment> segment;
+    LogEntries entries;
+    Status read_status;
+    size_t segment_count = 0;
+    int64_t next_index = 1;
+    while (reader.Next(&segment, &entries, &read_status)) {
+      ASSERT_OK(read_status);
+      for (const auto& entry : entries) {
+        ASSERT_EQ(next_index, entry->replicate().id().index());
+        ++next_index;
+      }
+      ++segment_count;
+    }
+    ASSERT_EQ(num_segments, segment_count);
+    ASSERT_EQ(kSegments * kEntriesPerSegment + 1, next_index);
+  }
+
+  ASSERT_OK(log_->Close());
+}
+
 // Tests that everything works properly with fsync enabled:
 // This also tests SyncDir() (see KUDU-261), which is called whenever
 // a new log segment is initialized.
@@ -550,6 +618,59 @@ TEST_F(LogTest, TestGCWithLogRunning) {
   }
 }
 
+// Tests that GCed segments are recycled and reused for new segments.
+TEST_F(LogTest, TestRecycleSegments) {
+  FLAGS_log_max_recycled_segments = 1;
+  FLAGS_log_min_segments_to_retain = 1;
+  BuildLog();
+
+  auto count_recycled = [this] {
+    vector<string> files;
+    CHECK_OK(env_->GetChildren(tablet_wal_path_, &files));
+    return std::count_if(files.begin(), files.end(), [](const string& file) {
+      return HasPrefixString(file, ".recycledsegment-");
+    });
+  };
+
+  const int kNumOpsPerSegment = 10;
+  OpId op_id = MakeOpId(1, 1);
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &op_id, kNumOpsPerSegment));
+    ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  }
+
+  int num_gced_segments = 0;
+  ASSERT_OK(log_->GC(op_id.index(), &num_gced_segments));
+  ASSERT_GE(num_gced_segments, 2);
+  // Only one of GCed segments is kept for reuse.
+  ASSERT_EQ(1, count_recycled());
+
+  // The next allocated segment reuses the recycled one, then it is written and closed.
+  const int64_t first_index = op_id.index();
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &op_id, kNumOpsPerSegment));
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  ASSERT_EQ(0, count_recycled());
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &op_id, kNumOpsPerSegment));
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+
+  SegmentSequence segments;
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  int64_t next_index = first_index;
+  for (const auto& segment : segments) {
+    LogEntries entries;
+    ASSERT_OK(segment->ReadEntries(&entries));
+    for (const auto& entry : entries) {
+      if (entry->replicate().id().index() >= first_index) {
+        ASSERT_EQ(next_index, entry->replicate().id().index());
+        ++next_index;
+      }
+    }
+  }
+  ASSERT_EQ(first_index + 2 * kNumOpsPerSegment, next_index);
+
+  ASSERT_OK(log_->Close());
+}
+
 // This test relies on kEntriesPerIndexChunk being 1000000, and that's no longer
 // the case after D1719 (2fe27d886390038bc734ea28638a1b1435e7d0d4) on Mac.
 #if !defined(__APPLE__)
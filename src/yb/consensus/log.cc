@@ -36,19 +36,23 @@
 #include <mutex>
 
 #include <boost/thread/shared_mutex.hpp>
+#include "yb/cfile/compression_codec.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log_index.h"
 #include "yb/consensus/log_metrics.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/log_sync_coordinator.h"
 #include "yb/consensus/log_util.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/strings/util.h"
 #include "yb/gutil/walltime.h"
 #include "yb/util/coding.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/crc.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/env_util.h"
 #include "yb/util/fault_injection.h"
@@ -90,6 +94,38 @@ DEFINE_int32(group_commit_queue_size_bytes, 4 * 1024 * 1024,
              "Maximum size of the group commit queue in bytes");
 TAG_FLAG(group_commit_queue_size_bytes, advanced);
 
+DEFINE_int32(log_group_commit_max_wait_us, 50,
+             "Maximum time that the log append thread waits for more entry batches to join a "
+             "group before syncing it. The append thread waits only when recent arrival rate "
+             "predicts another batch within this time and the wait is shorter than a log sync. "
+             "0 disables waiting.");
+TAG_FLAG(log_group_commit_max_wait_us, advanced);
+TAG_FLAG(log_group_commit_max_wait_us, runtime);
+
+DEFINE_string(log_compression_codec, "none",
+              "Codec used to compress entry batches of new WAL segments: none, snappy, lz4 or "
+              "zlib. Segments are readable regardless of the codec they were written with.");
+TAG_FLAG(log_compression_codec, advanced);
+
+DEFINE_int32(log_min_batch_bytes_to_checksum_in_caller, 256 * 1024,
+             "Entry batches of at least this size are serialized and checksummed by the thread "
+             "that appends them instead of the log append thread. 0 disables it.");
+TAG_FLAG(log_min_batch_bytes_to_checksum_in_caller, advanced);
+TAG_FLAG(log_min_batch_bytes_to_checksum_in_caller, runtime);
+
+DEFINE_int32(log_max_recycled_segments, 0,
+             "Maximum number of garbage collected WAL segments per tablet that are kept to be "
+             "reused for new segments instead of being deleted. A reused segment is zeroed in the "
+             "background before it is written, so appends overwrite already allocated space "
+             "instead of allocating filesystem blocks.");
+TAG_FLAG(log_max_recycled_segments, advanced);
+
+DEFINE_bool(log_async_writeback, false,
+            "When durable_wal_write is off, start asynchronous writeback of appended WAL data "
+            "with sync_file_range() on each log sync, so dirty pages do not accumulate until the "
+            "kernel flushes them in bursts.");
+TAG_FLAG(log_async_writeback, advanced);
+
 // Fault/latency injection flags.
 // -----------------------------
 DEFINE_bool(log_inject_latency, false,
@@ -122,6 +158,8 @@ static bool dummy = google::RegisterFlagValidator(
     &FLAGS_log_min_segments_to_retain, &ValidateLogsToRetain);
 
 static const char kSegmentPlaceholderFileTemplate[] = ".tmp.newsegmentXXXXXX";
+// Recycled segments are hidden files, so they are ignored by LogReader.
+static const char kRecycledSegmentPrefix[] = ".recycledsegment-";
 
 namespace yb {
 namespace log {
@@ -132,6 +170,19 @@ using env_util::OpenFileForRandom;
 using std::shared_ptr;
 using strings::Substitute;
 
+namespace {
+
+// Exponential moving average with weight of 1/8 for new samples.
+void UpdateAverage(double sample, double* average) {
+  if (*average == 0) {
+    *average = sample;
+  } else {
+    *average += (sample - *average) / 8;
+  }
+}
+
+} // namespace
+
 // This class is responsible for managing the thread that appends to
 // the log file.
 class Log::AppendThread {
@@ -150,8 +201,24 @@ class Log::AppendThread {
  private:
   void RunThread();
 
+  // Updates average interval between entry batch arrivals, after 'batches' batches were taken
+  // from the queue at 'now'.
+  void UpdateArrivalInterval(size_t batches, MonoTime now);
+
+  // Waits for more entry batches to join the group when they are expected to arrive soon.
+  // Returns false if the log is shutting down.
+  bool MaybeWaitForMoreBatches(std::vector<LogEntryBatch*>* entry_batches);
+
   Log* const log_;
 
+  // Time when entry batches were last taken from the queue.
+  MonoTime last_drain_time_;
+
+  // Moving averages of the interval between entry batch arrivals and of the log sync latency,
+  // in microseconds. Only accessed by the append thread.
+  double arrival_interval_us_ = 0;
+  double sync_latency_us_ = 0;
+
   // Lock to protect access to thread_ during shutdown.
   mutable std::mutex lock_;
   scoped_refptr<Thread> thread_;
@@ -184,6 +251,10 @@ void Log::AppendThread::RunThread() {
     if (PREDICT_FALSE(!log_->entry_queue()->BlockingDrainTo(&entry_batches))) {
       shutting_down = true;
     }
+    UpdateArrivalInterval(entry_batches.size(), MonoTime::FineNow());
+    if (!shutting_down && !MaybeWaitForMoreBatches(&entry_batches)) {
+      shutting_down = true;
+    }
 
     if (log_->metrics_) {
       log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
@@ -210,7 +281,10 @@ void Log::AppendThread::RunThread() {
       }
     }
 
+    auto sync_start = MonoTime::FineNow();
     Status s = log_->Sync();
+    UpdateAverage(MonoTime::FineNow().GetDeltaSince(sync_start).ToMicroseconds(),
+                  &sync_latency_us_);
     if (PREDICT_FALSE(!s.ok())) {
       LOG(ERROR) << "Error syncing log" << s.ToString();
       DLOG(FATAL) << "Aborting: " << s.ToString();
@@ -239,6 +313,36 @@ void Log::AppendThread::RunThread() {
   VLOG(1) << "Exiting AppendThread for tablet " << log_->tablet_id();
 }
 
+void Log::AppendThread::UpdateArrivalInterval(size_t batches, MonoTime now) {
+  if (last_drain_time_ && batches != 0) {
+    UpdateAverage(now.GetDeltaSince(last_drain_time_).ToMicroseconds() / batches,
+                  &arrival_interval_us_);
+  }
+  last_drain_time_ = now;
+}
+
+bool Log::AppendThread::MaybeWaitForMoreBatches(std::vector<LogEntryBatch*>* entry_batches) {
+  const double max_wait_us = FLAGS_log_group_commit_max_wait_us;
+  // Waiting pays off only when the next batch is expected soon, and the wait is cheaper than
+  // the sync that the batch would otherwise require.
+  if (max_wait_us <= 0 || arrival_interval_us_ <= 0 || arrival_interval_us_ > max_wait_us ||
+      arrival_interval_us_ > sync_latency_us_) {
+    return true;
+  }
+  auto start = MonoTime::FineNow();
+  auto wait_us = std::min(max_wait_us, arrival_interval_us_ * 2);
+  auto deadline = start + MonoDelta::FromMicroseconds(static_cast<int64_t>(wait_us));
+  size_t old_size = entry_batches->size();
+  bool result = log_->entry_queue()->BlockingDrainTo(entry_batches, deadline);
+  auto now = MonoTime::FineNow();
+  UpdateArrivalInterval(entry_batches->size() - old_size, now);
+  if (log_->metrics_) {
+    log_->metrics_->group_commit_wait_latency->Increment(
+        now.GetDeltaSince(start).ToMicroseconds());
+  }
+  return result;
+}
+
 void Log::AppendThread::Shutdown() {
   log_->entry_queue()->Shutdown();
   std::lock_guard<std::mutex> lock_guard(lock_);
@@ -337,6 +441,15 @@ Status Log::Init() {
     active_segment_sequence_number_ = segments.back()->header().sequence_number();
   }
 
+  // Pick up segments recycled before restart.
+  vector<string> children;
+  RETURN_NOT_OK(fs_manager_->ListDir(log_dir_, &children));
+  for (const string& child : children) {
+    if (HasPrefixString(child, kRecycledSegmentPrefix)) {
+      recycled_segments_.push_back(JoinPathSegments(log_dir_, child));
+    }
+  }
+
   if (durable_wal_write_) {
     YB_LOG_FIRST_N(INFO, 1) << "durable_wal_write is turned on.";
   } else {
@@ -434,6 +547,14 @@ Status Log::AsyncAppend(LogEntryBatch* entry_batch, const StatusCallback& callba
   entry_batch->set_callback(callback);
   entry_batch->MarkReady();
 
+  // Serialize and checksum large batches in the calling thread, so that the append thread, which
+  // writes batches of all callers one at a time, is not bound by it.
+  if (FLAGS_log_min_batch_bytes_to_checksum_in_caller > 0 &&
+      FLAGS_log_compression_codec == "none" &&
+      entry_batch->entry_batch_pb_.ByteSize() >= FLAGS_log_min_batch_bytes_to_checksum_in_caller) {
+    RETURN_NOT_OK(entry_batch->SerializeAndChecksum());
+  }
+
   if (PREDICT_FALSE(!entry_batch_queue_.BlockingPut(entry_batch))) {
     delete entry_batch;
     return kLogShutdownStatus;
@@ -524,7 +645,7 @@ Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
     SCOPED_LATENCY_METRIC(metrics_, append_latency);
     SCOPED_WATCH_STACK(500);
 
-    RETURN_NOT_OK(active_segment_->WriteEntryBatch(entry_batch_data));
+    RETURN_NOT_OK(active_segment_->WriteEntryBatch(entry_batch_data, entry_batch->data_crc()));
 
     // We don't update the last segment offset here anymore. This is done on the Sync() method to
     // guarantee that we only try to read what we have persisted in disk.
@@ -618,9 +739,17 @@ Status Log::Sync() {
     }
   }
 
+  if (!durable_wal_write_ && FLAGS_log_async_writeback && !sync_disabled_) {
+    RETURN_NOT_OK(active_segment_->writable_file()->Flush(WritableFile::FLUSH_ASYNC));
+  }
+
   if (durable_wal_write_ && !sync_disabled_) {
     LOG_SLOW_EXECUTION(WARNING, 50, "Fsync log took a long time") {
-      RETURN_NOT_OK(active_segment_->Sync());
+      if (options_.sync_coordinator) {
+        RETURN_NOT_OK(options_.sync_coordinator->Sync(active_segment_->writable_file().get()));
+      } else {
+        RETURN_NOT_OK(active_segment_->Sync());
+      }
 
       if (log_hooks_) {
         RETURN_NOT_OK_PREPEND(log_hooks_->PostSyncIfFsyncEnabled(),
@@ -681,9 +810,18 @@ Status Log::GetSegmentsToGCUnlocked(int64_t min_op_idx, SegmentSequence* segment
 }
 
 Status Log::Append(LogEntryPB* phys_entry) {
+  return Append(std::vector<LogEntryPB*>{phys_entry});
+}
+
+Status Log::Append(const std::vector<LogEntryPB*>& entries) {
+  DCHECK(!entries.empty());
   LogEntryBatchPB entry_batch_pb;
-  entry_batch_pb.mutable_entry()->AddAllocated(phys_entry);
-  LogEntryBatch entry_batch(phys_entry->type(), &entry_batch_pb, 1);
+  for (LogEntryPB* entry : entries) {
+    DCHECK_EQ(entries.front()->type(), entry->type());
+    entry_batch_pb.mutable_entry()->AddAllocated(entry);
+  }
+  const int num_entries = static_cast<int>(entries.size());
+  LogEntryBatch entry_batch(entries.front()->type(), &entry_batch_pb, num_entries);
   // Mark this as reserved, as we're building it from preallocated data.
   entry_batch.state_ = LogEntryBatch::kEntryReserved;
   // Ready assumes the data is reserved before it is ready.
@@ -692,7 +830,7 @@ Status Log::Append(LogEntryPB* phys_entry) {
   if (s.ok()) {
     s = Sync();
   }
-  entry_batch.entry_batch_pb_.mutable_entry()->ExtractSubrange(0, 1, nullptr);
+  entry_batch.entry_batch_pb_.mutable_entry()->ExtractSubrange(0, num_entries, nullptr);
   return s;
 }
 
@@ -745,9 +883,11 @@ Status Log::GC(int64_t min_op_idx, int32_t* num_gced) {
     // Now that they are no longer referenced by the Log, delete the files.
     *num_gced = 0;
     for (const scoped_refptr<ReadableLogSegment>& segment : segments_to_delete) {
-      LOG(INFO) << "Deleting log segment in path: " << segment->path()
-                << " (GCed ops < " << min_op_idx << ")";
-      RETURN_NOT_OK(fs_manager_->env()->DeleteFile(segment->path()));
+      if (!RecycleSegment(*segment)) {
+        LOG(INFO) << "Deleting log segment in path: " << segment->path()
+                  << " (GCed ops < " << min_op_idx << ")";
+        RETURN_NOT_OK(fs_manager_->env()->DeleteFile(segment->path()));
+      }
       (*num_gced)++;
     }
 
@@ -867,14 +1007,15 @@ Status Log::PreAllocateNewSegment() {
   WritableFileOptions opts;
   opts.sync_on_close = durable_wal_write_;
   opts.o_direct = durable_wal_write_;
-  RETURN_NOT_OK(CreatePlaceholderSegment(opts, &next_segment_path_, &next_segment_file_));
+  uint64_t allocated_size = 0;
+  if (!ReuseRecycledSegment(opts, &allocated_size)) {
+    RETURN_NOT_OK(CreatePlaceholderSegment(opts, &next_segment_path_, &next_segment_file_));
+  }
 
-  if (options_.preallocate_segments) {
-    uint64_t next_segment_size = NextSegmentDesiredSize();
+  uint64_t next_segment_size = NextSegmentDesiredSize();
+  if (options_.preallocate_segments && next_segment_size > allocated_size) {
     TRACE("Preallocating $0 byte segment in $1", next_segment_size, next_segment_path_);
-    // TODO (perf) zero the new segments -- this could result in
-    // additional performance improvements.
-    RETURN_NOT_OK(next_segment_file_->PreAllocate(next_segment_size));
+    RETURN_NOT_OK(next_segment_file_->PreAllocate(next_segment_size - allocated_size));
   }
 
   {
@@ -908,6 +1049,7 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_tablet_id(tablet_id_);
+  header.set_compression_codec(cfile::GetCompressionCodecType(FLAGS_log_compression_codec));
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
@@ -968,6 +1110,80 @@ Status Log::ReplaceSegmentInReaderUnlocked() {
   return reader_->ReplaceLastSegment(readable_segment);
 }
 
+bool Log::RecycleSegment(const ReadableLogSegment& segment) {
+  {
+    std::lock_guard<std::mutex> lock(recycled_segments_mutex_);
+    if (recycled_segments_.size() >=
+            static_cast<size_t>(std::max(FLAGS_log_max_recycled_segments, 0))) {
+      return false;
+    }
+  }
+  const string recycled_path = JoinPathSegments(
+      log_dir_, Substitute("$0$1", kRecycledSegmentPrefix, segment.header().sequence_number()));
+  Status s = fs_manager_->env()->RenameFile(segment.path(), recycled_path);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to recycle log segment " << segment.path() << ": " << s;
+    return false;
+  }
+  LOG(INFO) << "Recycled log segment " << segment.path() << " to " << recycled_path;
+  std::lock_guard<std::mutex> lock(recycled_segments_mutex_);
+  recycled_segments_.push_back(recycled_path);
+  return true;
+}
+
+bool Log::ReuseRecycledSegment(const WritableFileOptions& opts, uint64_t* allocated_size) {
+  string path;
+  {
+    std::lock_guard<std::mutex> lock(recycled_segments_mutex_);
+    if (recycled_segments_.empty()) {
+      return false;
+    }
+    path = std::move(recycled_segments_.back());
+    recycled_segments_.pop_back();
+  }
+  Status s = PrepareRecycledSegment(opts, path, allocated_size);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to reuse recycled log segment " << path << ": " << s;
+    WARN_NOT_OK(fs_manager_->env()->DeleteFile(path), "Failed to delete recycled log segment");
+    return false;
+  }
+  VLOG(1) << "Reusing recycled log segment " << path << " of size " << *allocated_size;
+  return true;
+}
+
+Status Log::PrepareRecycledSegment(const WritableFileOptions& opts,
+                                   const string& path,
+                                   uint64_t* allocated_size) {
+  Env* env = fs_manager_->env();
+  // Zero the old content, otherwise entries of the old segment that follow the last written entry
+  // could be read back after a crash. Since the space is already allocated, this does not change
+  // filesystem metadata, and it is done in the background, before the segment is needed.
+  {
+    RWFileOptions rw_opts;
+    rw_opts.mode = Env::OPEN_EXISTING;
+    gscoped_ptr<RWFile> file;
+    RETURN_NOT_OK(env->NewRWFile(rw_opts, path, &file));
+    RETURN_NOT_OK(file->Size(allocated_size));
+    const size_t kChunkSize = 1024 * 1024;
+    const string zeros(kChunkSize, '\0');
+    for (uint64_t offset = 0; offset < *allocated_size; offset += kChunkSize) {
+      const size_t length = std::min<uint64_t>(kChunkSize, *allocated_size - offset);
+      RETURN_NOT_OK(file->Write(offset, Slice(zeros.data(), length)));
+    }
+    RETURN_NOT_OK(file->Sync());
+    RETURN_NOT_OK(file->Close());
+  }
+
+  WritableFileOptions reuse_opts = opts;
+  reuse_opts.mode = Env::OPEN_EXISTING;
+  reuse_opts.reuse_existing_file = true;
+  gscoped_ptr<WritableFile> segment_file;
+  RETURN_NOT_OK(env->NewWritableFile(reuse_opts, path, &segment_file));
+  next_segment_path_ = path;
+  next_segment_file_.reset(segment_file.release());
+  return Status::OK();
+}
+
 Status Log::CreatePlaceholderSegment(const WritableFileOptions& opts,
                                      string* result_path,
                                      shared_ptr<WritableFile>* out) {
@@ -1002,6 +1218,9 @@ void LogEntryBatch::MarkReserved() {
 }
 
 Status LogEntryBatch::Serialize() {
+  if (state_ == kEntrySerialized) {
+    return Status::OK();
+  }
   DCHECK_EQ(state_, kEntryReady);
   buffer_.clear();
   // FLUSH_MARKER LogEntries are markers and are not serialized.
@@ -1022,6 +1241,12 @@ Status LogEntryBatch::Serialize() {
   return Status::OK();
 }
 
+Status LogEntryBatch::SerializeAndChecksum() {
+  RETURN_NOT_OK(Serialize());
+  data_crc_ = crc::Crc32c(buffer_.data(), buffer_.size());
+  return Status::OK();
+}
+
 void LogEntryBatch::MarkReady() {
   DCHECK_EQ(state_, kEntryReserved);
   state_ = kEntryReady;
@@ -35,9 +35,11 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include <boost/optional.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include "yb/common/schema.h"
@@ -136,6 +138,10 @@ class Log : public RefCountedThreadSafe<Log> {
   // TODO get rid of this method, transition to the asynchronous API
   CHECKED_STATUS Append(LogEntryPB* entry);
 
+  // Synchronously append entries of the same type to the log as a single batch.
+  // Log does not take ownership of the passed entries.
+  CHECKED_STATUS Append(const std::vector<LogEntryPB*>& entries);
+
   // Append the given set of replicate messages, asynchronously.
   // This requires that the replicates have already been assigned OpIds.
   CHECKED_STATUS AsyncAppendReplicates(const ReplicateMsgs& replicates,
@@ -297,6 +303,19 @@ class Log : public RefCountedThreadSafe<Log> {
   // Preallocates the space for a new segment.
   CHECKED_STATUS PreAllocateNewSegment();
 
+  // Renames a garbage collected segment, so it could be reused for a new segment, if there is room
+  // in the recycled segments pool. Returns false if the segment should be deleted instead.
+  bool RecycleSegment(const ReadableLogSegment& segment);
+
+  // Takes a recycled segment, if any, and prepares it to be written as the next segment.
+  // Sets 'allocated_size' to the space already allocated for it.
+  // Returns false if there is no recycled segment that could be used.
+  bool ReuseRecycledSegment(const WritableFileOptions& opts, uint64_t* allocated_size);
+
+  CHECKED_STATUS PrepareRecycledSegment(const WritableFileOptions& opts,
+                                        const std::string& path,
+                                        uint64_t* allocated_size);
+
   // Returns the desired size for the next log segment to be created.
   uint64_t NextSegmentDesiredSize();
 
@@ -407,6 +426,10 @@ class Log : public RefCountedThreadSafe<Log> {
 
   gscoped_ptr<ThreadPool> allocation_pool_;
 
+  // Paths of garbage collected segments, that could be reused for new segments.
+  std::mutex recycled_segments_mutex_;
+  std::vector<std::string> recycled_segments_;
+
   // If true, sync on all appends.
   bool durable_wal_write_;
 
@@ -444,9 +467,18 @@ class LogEntryBatch {
 
   LogEntryBatch(LogEntryTypePB type, LogEntryBatchPB* entry_batch_pb, size_t count);
 
-  // Serializes contents of the entry to an internal buffer.
+  // Serializes contents of the entry to an internal buffer. Does nothing if the entry was already
+  // serialized.
   CHECKED_STATUS Serialize();
 
+  // Serializes the entry and computes the checksum of the serialized data.
+  CHECKED_STATUS SerializeAndChecksum();
+
+  // The CRC32C of data(), if it was computed by SerializeAndChecksum().
+  const boost::optional<uint32_t>& data_crc() const {
+    return data_crc_;
+  }
+
   // Sets the callback that will be invoked after the entry is
   // appended and synced to disk
   void set_callback(const StatusCallback& cb) {
@@ -526,6 +558,8 @@ class LogEntryBatch {
   // 'Serialize()'
   faststring buffer_;
 
+  boost::optional<uint32_t> data_crc_;
+
   enum LogEntryState {
     kEntryInitialized,
     kEntryReserved,
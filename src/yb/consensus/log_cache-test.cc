@@ -32,6 +32,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -171,6 +172,50 @@ TEST_F(LogCacheTest, TestAppendAndGetMessages) {
 }
 
 
+// Serialized ops should be parsed as ops of ConsensusRequestPB, and the serialized form of cached
+// ops should be shared between reads.
+TEST_F(LogCacheTest, TestSerializedOps) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 20, 100));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  // Ops 1..10 are read from disk, 11..20 from the cache.
+  cache_->EvictThroughOp(10);
+
+  ReplicateMsgs messages;
+  std::vector<RefCntBuffer> serialized;
+  OpId preceding;
+  const int64_t bytes_used = cache_->BytesUsed();
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding, &serialized));
+  ASSERT_EQ(20, messages.size());
+  ASSERT_EQ(messages.size(), serialized.size());
+  ASSERT_GT(cache_->BytesUsed(), bytes_used);
+
+  std::string data;
+  for (const auto& buffer : serialized) {
+    data.append(buffer.data(), buffer.size());
+  }
+  ConsensusRequestPB request;
+  ASSERT_TRUE(request.ParsePartialFromString(data));
+  ASSERT_EQ(messages.size(), request.ops_size());
+  for (int i = 0; i != request.ops_size(); ++i) {
+    ASSERT_EQ(messages[i]->ShortDebugString(), request.ops(i).ShortDebugString());
+  }
+
+  ReplicateMsgs cached_messages;
+  std::vector<RefCntBuffer> cached_serialized;
+  ASSERT_OK(cache_->ReadOps(
+      10, 8 * 1024 * 1024, &cached_messages, &preceding, &cached_serialized));
+  ASSERT_EQ(10, cached_serialized.size());
+  for (size_t i = 0; i != cached_serialized.size(); ++i) {
+    ASSERT_EQ(serialized[10 + i].data(), cached_serialized[i].data());
+  }
+
+  // Evicting ops releases their serialized form as well.
+  messages.clear();
+  cached_messages.clear();
+  cache_->EvictThroughOp(20);
+  ASSERT_EQ(0, cache_->BytesUsed());
+}
+
 // Ensure that the cache always yields at least one message,
 // even if that message is larger than the batch size. This ensures
 // that we don't get "stuck" in the case that a large message enters
@@ -297,6 +342,44 @@ TEST_F(LogCacheTest, TestGlobalMemoryLimit) {
   ASSERT_LE(cache_->BytesUsed(), 1024 * 1024);
 }
 
+// Checks that exceeding the global limit evicts least recently used ops of another tablet, instead
+// of recent ops of the tablet that is appending.
+TEST_F(LogCacheTest, TestGlobalEvictionAcrossTablets) {
+  FLAGS_global_log_cache_size_limit_mb = 4;
+  CloseAndReopenCache(MinimumOpId());
+
+  const int kPayloadSize = 768 * 1024;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 3, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_EQ(3, cache_->num_cached_ops());
+
+  // Make sure ops of the other tablet are accessed later.
+  SleepFor(MonoDelta::FromMilliseconds(50));
+
+  const char* kOtherTablet = "other-tablet";
+  scoped_refptr<log::Log> other_log;
+  ASSERT_OK(log::Log::Open(log::LogOptions(),
+                           fs_manager_.get(),
+                           kOtherTablet,
+                           fs_manager_->GetFirstTabletWalDirOrDie(kTestTable, kOtherTablet),
+                           schema_,
+                           0, // schema_version
+                           nullptr,
+                           &other_log));
+  auto other_metric_entity = METRIC_ENTITY_tablet.Instantiate(&metric_registry_, kOtherTablet);
+  LogCache other_cache(other_metric_entity, other_log.get(), kPeerUuid, kOtherTablet);
+  other_cache.Init(MinimumOpId());
+  for (int index = 1; index <= 3; ++index) {
+    ReplicateMsgs msgs = { CreateDummyReplicate(1, index, clock_->Now(), kPayloadSize) };
+    ASSERT_OK(other_cache.AppendOperations(msgs, Bind(&FatalOnError)));
+  }
+  ASSERT_OK(other_log->WaitUntilAllFlushed());
+
+  ASSERT_EQ(3, other_cache.num_cached_ops());
+  ASSERT_LT(cache_->num_cached_ops(), 3);
+  ASSERT_LE(cache_->parent_tracker_->consumption(), 4 * 1024 * 1024);
+}
+
 // Test that the log cache properly replaces messages when an index
 // is reused. This is a regression test for a bug where the memtracker's
 // consumption wasn't properly managed when messages were replaced.
@@ -38,9 +38,11 @@
 #include <vector>
 
 #include <gflags/gflags.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/wire_format_lite.h>
 #include <google/protobuf/wire_format_lite_inl.h>
 
+#include "yb/cfile/compression_codec.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_reader.h"
 #include "yb/consensus/ref_counted_replicate.h"
@@ -50,6 +52,7 @@
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/util/debug-util.h"
+#include "yb/util/faststring.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
@@ -68,6 +71,12 @@ DEFINE_int32(global_log_cache_size_limit_mb, 1024,
              "caching log entries across all tablets is kept under this threshold.");
 TAG_FLAG(global_log_cache_size_limit_mb, advanced);
 
+DEFINE_string(consensus_ops_compression_codec, "none",
+              "Codec used to compress operations replicated to followers: none, snappy, lz4 or "
+              "zlib. Applies only when --consensus_send_serialized_ops is set. Followers should "
+              "support compressed operations before it is enabled.");
+TAG_FLAG(consensus_ops_compression_codec, advanced);
+
 using strings::Substitute;
 
 namespace yb {
@@ -82,6 +91,39 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
 
 static const char kParentMemTrackerId[] = "log_cache";
 
+// Global eviction takes at most this number of bytes from a cache before picking the least recently
+// used one again.
+static constexpr int64_t kGlobalEvictionChunkBytes = 1024 * 1024;
+
+namespace {
+
+// All log caches of the process, used for global eviction.
+struct LogCacheRegistry {
+  std::mutex mutex;
+  std::vector<LogCache*> caches;
+};
+
+LogCacheRegistry& GetLogCacheRegistry() {
+  static LogCacheRegistry* registry = new LogCacheRegistry;
+  return *registry;
+}
+
+void RegisterLogCache(LogCache* cache) {
+  auto& registry = GetLogCacheRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.caches.push_back(cache);
+}
+
+void UnregisterLogCache(LogCache* cache) {
+  auto& registry = GetLogCacheRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = std::find(registry.caches.begin(), registry.caches.end(), cache);
+  CHECK(it != registry.caches.end());
+  registry.caches.erase(it);
+}
+
+} // namespace
+
 typedef vector<const ReplicateMsg*>::const_iterator MsgIter;
 
 LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
@@ -93,8 +135,9 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
     tablet_id_(tablet_id),
     next_sequential_op_index_(0),
     min_pinned_op_index_(0),
+    ops_compression_(cfile::GetCompressionCodecType(FLAGS_consensus_ops_compression_codec)),
     metrics_(metric_entity) {
-
+  CHECK_OK(cfile::GetCompressionCodec(ops_compression_, &ops_codec_));
 
   const int64_t max_ops_size_bytes = FLAGS_log_cache_size_limit_mb * 1024 * 1024;
   const int64_t global_max_ops_size_bytes = FLAGS_global_log_cache_size_limit_mb * 1024 * 1024;
@@ -114,10 +157,15 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
   // code paths elsewhere.
   auto zero_op = std::make_shared<ReplicateMsg>();
   *zero_op->mutable_id() = MinimumOpId();
-  InsertOrDie(&cache_, 0, zero_op);
+  InsertOrDie(&cache_, 0, CacheEntry{zero_op, RefCntBuffer(), MonoTime::Now(MonoTime::COARSE)});
+
+  RegisterLogCache(this);
 }
 
 LogCache::~LogCache() {
+  // Unregister first, so global eviction does not touch this cache while it is destroyed.
+  UnregisterLogCache(this);
+
   tracker_->Release(tracker_->consumption());
   cache_.clear();
 
@@ -155,9 +203,8 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
     for (int64_t i = first_idx_in_batch; i < next_sequential_op_index_; ++i) {
       auto it = cache_.find(i);
       if (it != cache_.end()) {
-        ReplicateMsgPtr msg = it->second;
+        AccountForMessageRemovalUnlocked(it->second);
         cache_.erase(it);
-        AccountForMessageRemovalUnlocked(msg);
       }
     }
   }
@@ -171,29 +218,30 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
   // Try to consume the memory. If it can't be consumed, we may need to evict.
   bool borrowed_memory = false;
   if (!tracker_->TryConsume(mem_required)) {
-    int spare = tracker_->SpareCapacity();
-    int need_to_free = mem_required - spare;
+    int64_t spare = tracker_->SpareCapacity();
     VLOG_WITH_PREFIX_UNLOCKED(1) << "Memory limit would be exceeded trying to append "
                         << HumanReadableNumBytes::ToString(mem_required)
                         << " to log cache (available="
                         << HumanReadableNumBytes::ToString(spare)
                         << "): attempting to evict some operations...";
 
-    // TODO: we should also try to evict from other tablets - probably better to
-    // evict really old ops from another tablet than evict recent ops from this one.
-    EvictSomeUnlocked(min_pinned_op_index_, need_to_free);
+    // Only the per-tablet limit is enforced by evicting ops of this tablet, the server-wide limit
+    // is enforced by global eviction below.
+    int64_t own_spare = tracker_->limit() - tracker_->consumption();
+    if (mem_required > own_spare) {
+      EvictSomeUnlocked(min_pinned_op_index_, mem_required - own_spare);
+    }
 
-    // Force consuming, so that we don't refuse appending data. We might
-    // blow past our limit a little bit (as much as the number of tablets times
-    // the amount of in-flight data in the log), but until implementing the above TODO,
-    // it's difficult to solve this issue.
+    // Force consuming, so that we don't refuse appending data. We might blow past the limit a
+    // little bit, since ops being appended could not be evicted until they are written to the log.
     tracker_->Consume(mem_required);
 
     borrowed_memory = parent_tracker_->LimitExceeded();
   }
 
+  const MonoTime now = MonoTime::Now(MonoTime::COARSE);
   for (const auto& msg : msgs) {
-    InsertOrDie(&cache_,  msg->id().index(), msg);
+    InsertOrDie(&cache_,  msg->id().index(), CacheEntry{msg, RefCntBuffer(), now});
   }
 
   // We drop the lock during the AsyncAppendReplicates call, since it may block
@@ -201,6 +249,13 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
   // our callback and blocked on this lock.
   l.unlock();
 
+  if (borrowed_memory) {
+    int64_t spare_capacity = parent_tracker_->SpareCapacity();
+    if (spare_capacity < 0) {
+      EvictGlobally(-spare_capacity);
+    }
+  }
+
   Status log_status = log_->AsyncAppendReplicates(
     msgs, Bind(&LogCache::LogCallback,
                Unretained(this),
@@ -227,10 +282,12 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
                            const StatusCallback& user_callback,
                            const Status& log_status) {
   if (log_status.ok()) {
-    std::lock_guard<simple_spinlock> l(lock_);
-    if (min_pinned_op_index_ <= last_idx_in_batch) {
-      VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
-      min_pinned_op_index_ = last_idx_in_batch + 1;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (min_pinned_op_index_ <= last_idx_in_batch) {
+        VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
+        min_pinned_op_index_ = last_idx_in_batch + 1;
+      }
     }
 
     // If we went over the global limit in order to log this batch, evict some to
@@ -238,7 +295,7 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
     if (borrowed_memory) {
       int64_t spare_capacity = parent_tracker_->SpareCapacity();
       if (spare_capacity < 0) {
-        EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity);
+        EvictGlobally(-spare_capacity);
       }
     }
   }
@@ -266,7 +323,7 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
     }
     auto iter = cache_.find(op_index);
     if (iter != cache_.end()) {
-      *op_id = iter->second->id();
+      *op_id = iter->second.msg->id();
       return Status::OK();
     }
   }
@@ -285,13 +342,52 @@ int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
   msg_size += 1; // for the type tag
   return msg_size;
 }
+
+// Serializes the message as an element of ConsensusRequestPB::ops, i.e. with the same tagging
+// and length delimiting as TotalByteSizeForMessage() accounts for.
+// When 'codec' is specified, the message is compressed and serialized as an element of
+// ConsensusRequestPB::compressed_ops instead.
+Status SerializeForRequest(
+    const ReplicateMsg& msg, const cfile::CompressionCodec* codec, RefCntBuffer* result) {
+  using google::protobuf::internal::WireFormatLite;
+  using google::protobuf::io::CodedOutputStream;
+
+  const int msg_size = msg.ByteSize();
+  faststring compressed;
+  if (codec) {
+    faststring serialized;
+    serialized.resize(msg_size);
+    msg.SerializeWithCachedSizesToArray(serialized.data());
+    RETURN_NOT_OK(log::CompressLogData(codec, Slice(serialized), &compressed));
+  }
+
+  const uint32_t tag = WireFormatLite::MakeTag(
+      codec ? ConsensusRequestPB::kCompressedOpsFieldNumber : ConsensusRequestPB::kOpsFieldNumber,
+      WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  const uint32_t value_size = codec ? compressed.size() : msg_size;
+  *result = RefCntBuffer(CodedOutputStream::VarintSize32(tag) +
+                         CodedOutputStream::VarintSize32(value_size) + value_size);
+  uint8_t* dst = result->udata();
+  dst = CodedOutputStream::WriteVarint32ToArray(tag, dst);
+  dst = CodedOutputStream::WriteVarint32ToArray(value_size, dst);
+  if (codec) {
+    memcpy(dst, compressed.data(), compressed.size());
+    dst += compressed.size();
+  } else {
+    dst = msg.SerializeWithCachedSizesToArray(dst);
+  }
+  DCHECK_EQ(dst, result->udata() + result->size());
+  return Status::OK();
+}
 } // anonymous namespace
 
 Status LogCache::ReadOps(int64_t after_op_index,
                          int max_size_bytes,
                          ReplicateMsgs* messages,
-                         OpId* preceding_op) {
+                         OpId* preceding_op,
+                         std::vector<RefCntBuffer>* serialized_ops) {
   DCHECK_GE(after_op_index, 0);
+  DCHECK(!serialized_ops || serialized_ops->size() == messages->size());
   RETURN_NOT_OK(LookupOpId(after_op_index, preceding_op));
 
   std::unique_lock<simple_spinlock> l(lock_);
@@ -303,7 +399,7 @@ Status LogCache::ReadOps(int64_t after_op_index,
 
     // If the messages the peer needs haven't been loaded into the queue yet,
     // load them.
-    MessageCache::const_iterator iter = cache_.lower_bound(next_index);
+    MessageCache::iterator iter = cache_.lower_bound(next_index);
     if (iter == cache_.end() || iter->first != next_index) {
       int64_t up_to;
       if (iter == cache_.end()) {
@@ -331,32 +427,77 @@ Status LogCache::ReadOps(int64_t after_op_index,
         remaining_space -= TotalByteSizeForMessage(*msg);
         if (remaining_space > 0) {
           messages->push_back(msg);
+          if (serialized_ops) {
+            serialized_ops->emplace_back();
+          }
           next_index++;
         }
       }
 
     } else {
       // Pull contiguous messages from the cache until the size limit is achieved.
+      const MonoTime now = MonoTime::Now(MonoTime::COARSE);
       for (; iter != cache_.end(); ++iter) {
-        const ReplicateMsgPtr& msg = iter->second;
+        const ReplicateMsgPtr& msg = iter->second.msg;
+        const RefCntBuffer& serialized = iter->second.serialized;
         int64_t index = msg->id().index();
         if (index != next_index) {
           continue;
         }
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
+        remaining_space -= serialized ? static_cast<int64_t>(serialized.size())
+                                      : TotalByteSizeForMessage(*msg);
         if (remaining_space < 0 && !messages->empty()) {
           break;
         }
 
         messages->push_back(msg);
+        if (serialized_ops) {
+          serialized_ops->push_back(serialized);
+        }
+        iter->second.last_access = now;
         next_index++;
       }
     }
   }
+  l.unlock();
+
+  if (serialized_ops) {
+    // Serialize outside of the lock, so appends are not blocked by it.
+    bool has_new_serialized = false;
+    for (size_t i = 0; i != messages->size(); ++i) {
+      auto& serialized = (*serialized_ops)[i];
+      if (!serialized) {
+        RETURN_NOT_OK(SerializeForRequest(*(*messages)[i], ops_codec_, &serialized));
+        has_new_serialized = true;
+      }
+    }
+    if (has_new_serialized) {
+      SaveSerialized(*messages, *serialized_ops);
+    }
+  }
   return Status::OK();
 }
 
+void LogCache::SaveSerialized(const ReplicateMsgs& messages,
+                              const std::vector<RefCntBuffer>& serialized_ops) {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  int64_t bytes_added = 0;
+  for (size_t i = 0; i != messages.size(); ++i) {
+    auto it = cache_.find(messages[i]->id().index());
+    // The op could be evicted or replaced in the meantime, or be read from disk.
+    if (it == cache_.end() || it->second.msg != messages[i] || it->second.serialized) {
+      continue;
+    }
+    it->second.serialized = serialized_ops[i];
+    bytes_added += serialized_ops[i].size();
+  }
+  if (bytes_added > 0) {
+    tracker_->Consume(bytes_added);
+    metrics_.log_cache_size->IncrementBy(bytes_added);
+  }
+}
+
 
 void LogCache::EvictThroughOp(int64_t index) {
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -364,7 +505,7 @@ void LogCache::EvictThroughOp(int64_t index) {
   EvictSomeUnlocked(index, MathLimits<int64_t>::kMax);
 }
 
-void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
+int64_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
   DCHECK(lock_.is_locked());
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting log cache index <= "
                       << stop_after_index
@@ -373,7 +514,7 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
 
   int64_t bytes_evicted = 0;
   for (auto iter = cache_.begin(); iter != cache_.end();) {
-    const ReplicateMsgPtr& msg = iter->second;
+    const ReplicateMsgPtr& msg = iter->second.msg;
     VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
     int64_t msg_index = msg->id().index();
     if (msg_index == 0) {
@@ -394,8 +535,8 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
     }
 
     VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
-    AccountForMessageRemovalUnlocked(msg);
-    bytes_evicted += msg->SpaceUsed();
+    AccountForMessageRemovalUnlocked(iter->second);
+    bytes_evicted += msg->SpaceUsed() + iter->second.serialized.size();
     cache_.erase(iter++);
 
     if (bytes_evicted >= bytes_to_evict) {
@@ -403,11 +544,60 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
     }
   }
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Evicting log cache: after state: " << ToStringUnlocked();
+  return bytes_evicted;
+}
+
+bool LogCache::OldestEvictableAccessTimeUnlocked(MonoTime* access_time) const {
+  DCHECK(lock_.is_locked());
+  for (const auto& index_and_entry : cache_) {
+    const int64_t msg_index = index_and_entry.first;
+    if (msg_index == 0) {
+      continue;
+    }
+    if (msg_index >= min_pinned_op_index_) {
+      break;
+    }
+    if (index_and_entry.second.msg.unique()) {
+      *access_time = index_and_entry.second.last_access;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LogCache::EvictGlobally(int64_t bytes_to_evict) {
+  auto& registry = GetLogCacheRegistry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  while (bytes_to_evict > 0) {
+    LogCache* victim = nullptr;
+    MonoTime victim_access_time;
+    for (LogCache* cache : registry.caches) {
+      // Skip busy caches, there is usually plenty of others to evict from.
+      std::unique_lock<simple_spinlock> lock(cache->lock_, std::try_to_lock);
+      MonoTime access_time;
+      if (lock.owns_lock() && cache->OldestEvictableAccessTimeUnlocked(&access_time) &&
+          (!victim || access_time.ComesBefore(victim_access_time))) {
+        victim = cache;
+        victim_access_time = access_time;
+      }
+    }
+    if (!victim) {
+      break;
+    }
+    std::lock_guard<simple_spinlock> lock(victim->lock_);
+    int64_t evicted = victim->EvictSomeUnlocked(
+        victim->min_pinned_op_index_, std::min(bytes_to_evict, kGlobalEvictionChunkBytes));
+    if (evicted == 0) {
+      break;
+    }
+    bytes_to_evict -= evicted;
+  }
 }
 
-void LogCache::AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg) {
-  tracker_->Release(msg->SpaceUsed());
-  metrics_.log_cache_size->DecrementBy(msg->SpaceUsed());
+void LogCache::AccountForMessageRemovalUnlocked(const CacheEntry& entry) {
+  const int64_t size = entry.msg->SpaceUsed() + entry.serialized.size();
+  tracker_->Release(size);
+  metrics_.log_cache_size->DecrementBy(size);
   metrics_.log_cache_num_ops->Decrement();
 }
 
@@ -457,7 +647,7 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
   lines->push_back(ToStringUnlocked());
   lines->push_back("Messages:");
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     lines->push_back(
       Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
                  counter++, msg->id().term(), msg->id().index(),
@@ -476,7 +666,7 @@ void LogCache::DumpToHtml(std::ostream& out) const {
 
   int counter = 0;
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>REPLICATE $3</td>"
                       "<td>$4</td><td>$5</td></tr>",
                       counter++, msg->id().term(), msg->id().index(),
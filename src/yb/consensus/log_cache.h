@@ -45,6 +45,8 @@
 #include "yb/util/async_util.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -52,6 +54,10 @@ namespace yb {
 class MetricEntity;
 class MemTracker;
 
+namespace cfile {
+class CompressionCodec;
+} // namespace cfile
+
 namespace log {
 class Log;
 class LogReader;
@@ -67,6 +73,10 @@ class ReplicateMsg;
 // can be appended to the end as they are written to the log. Readers
 // fetch entries that were explicitly appended, or they can fetch older
 // entries which are asynchronously fetched from the disk.
+//
+// When the server-wide limit of all log caches is exceeded, ops are evicted from the caches of all
+// tablets, least recently used first, so a busy tablet does not have to evict ops that its
+// followers still read, while an idle tablet keeps old ones.
 class LogCache {
  public:
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
@@ -97,10 +107,16 @@ class LogCache {
   // If the ops being requested are not available in the log, this will synchronously
   // read these ops from disk. Therefore, this function may take a substantial amount
   // of time and should not be called with important locks held, etc.
+  //
+  // If 'serialized_ops' is not null, it is filled with the serialized form of each returned op,
+  // framed as an element of ConsensusRequestPB::ops, or of ConsensusRequestPB::compressed_ops
+  // when ops_compression() is set. Cached ops are serialized only once, and the same buffers are
+  // returned to all readers.
   CHECKED_STATUS ReadOps(int64_t after_op_index,
                  int max_size_bytes,
                  ReplicateMsgs* messages,
-                 OpId* preceding_op);
+                 OpId* preceding_op,
+                 std::vector<RefCntBuffer>* serialized_ops = nullptr);
 
   // Append the operations into the log and the cache.
   // When the messages have completed writing into the on-disk log, fires 'callback'.
@@ -123,6 +139,11 @@ class LogCache {
   // Return the number of bytes of memory currently in use by the cache.
   int64_t BytesUsed() const;
 
+  // Codec used to compress serialized ops returned by ReadOps().
+  CompressionType ops_compression() const {
+    return ops_compression_;
+  }
+
   int64_t num_cached_ops() const {
     return metrics_.log_cache_num_ops->value();
   }
@@ -150,6 +171,7 @@ class LogCache {
 
  private:
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
+  FRIEND_TEST(LogCacheTest, TestGlobalEvictionAcrossTablets);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   friend class LogCacheTest;
@@ -157,11 +179,36 @@ class LogCache {
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
   // 'stop_after_index' has been evicted, whichever comes first.
-  void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+  // Returns the number of evicted bytes.
+  int64_t EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+
+  // Evicts at least 'bytes_to_evict' bytes from all log caches of the server, picking caches
+  // whose oldest evictable op was accessed least recently. Stops earlier when nothing could be
+  // evicted. Should be invoked without the lock of any log cache held.
+  static void EvictGlobally(int64_t bytes_to_evict);
+
+  // Returns false if there is no op that could be evicted. Otherwise sets 'access_time' to the last
+  // access time of the op that would be evicted first.
+  bool OldestEvictableAccessTimeUnlocked(MonoTime* access_time) const;
+
+  struct CacheEntry {
+    ReplicateMsgPtr msg;
+
+    // Serialized msg framed as an element of ConsensusRequestPB::ops. Filled lazily by
+    // ReadOps(), when serialized ops are requested.
+    RefCntBuffer serialized;
+
+    // Time when the op was appended or last returned by ReadOps().
+    MonoTime last_access;
+  };
 
   // Update metrics and MemTracker to account for the removal of the
-  // given message.
-  void AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg);
+  // given entry.
+  void AccountForMessageRemovalUnlocked(const CacheEntry& entry);
+
+  // Stores serialized form of the returned messages in the cache, so subsequent reads reuse it.
+  void SaveSerialized(const ReplicateMsgs& messages,
+                      const std::vector<RefCntBuffer>& serialized_ops);
 
   // Return a string with stats
   std::string StatsStringUnlocked() const;
@@ -186,8 +233,8 @@ class LogCache {
   mutable simple_spinlock lock_;
 
   // An ordered map that serves as the buffer for the cached messages.
-  // Maps from log index -> ReplicateMsg
-  typedef std::map<uint64_t, ReplicateMsgPtr> MessageCache;
+  // Maps from log index -> ReplicateMsg and its serialized form.
+  typedef std::map<uint64_t, CacheEntry> MessageCache;
   MessageCache cache_;
 
   // The next log index to append. Each append operation must either
@@ -200,6 +247,10 @@ class LogCache {
   // Protected by lock_.
   int64_t min_pinned_op_index_;
 
+  // Compression of serialized ops, see ops_compression().
+  const CompressionType ops_compression_;
+  const cfile::CompressionCodec* ops_codec_ = nullptr;
+
   // Pointer to a parent memtracker for all log caches. This
   // exists to compute server-wide cache size and enforce a
   // server-wide memory limit.  When the first instance of a log
@@ -63,6 +63,12 @@ METRIC_DEFINE_histogram(tablet, log_entry_batches_per_group, "Log Group Commit B
                         "Number of log entry batches in a group commit group",
                         1024, 2);
 
+METRIC_DEFINE_histogram(tablet, log_group_commit_wait_latency, "Log Group Commit Wait Latency",
+                        yb::MetricUnit::kMicroseconds,
+                        "Microseconds the append thread waited for more entry batches to join a "
+                        "group before syncing it",
+                        60000000LU, 2);
+
 namespace yb {
 namespace log {
 
@@ -73,7 +79,8 @@ LogMetrics::LogMetrics(const scoped_refptr<MetricEntity>& metric_entity)
       MINIT(append_latency),
       MINIT(group_commit_latency),
       MINIT(roll_latency),
-      MINIT(entry_batches_per_group) {
+      MINIT(entry_batches_per_group),
+      MINIT(group_commit_wait_latency) {
 }
 #undef MINIT
 
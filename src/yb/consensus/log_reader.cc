@@ -47,6 +47,7 @@
 #include "yb/util/metrics.h"
 #include "yb/util/path_util.h"
 #include "yb/util/pb_util.h"
+#include "yb/util/thread.h"
 
 METRIC_DEFINE_counter(tablet, log_reader_bytes_read, "Bytes Read From Log",
                       yb::MetricUnit::kBytes,
@@ -507,5 +508,78 @@ string LogReader::ToString() const {
   return ret;
 }
 
+ReadAheadSegmentReader::ReadAheadSegmentReader(SegmentSequence segments,
+                                               size_t max_segments_ahead)
+    : segments_(std::move(segments)), max_segments_ahead_(max_segments_ahead) {
+}
+
+ReadAheadSegmentReader::~ReadAheadSegmentReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  if (thread_) {
+    thread_->Join();
+  }
+}
+
+void ReadAheadSegmentReader::Start() {
+  if (max_segments_ahead_ == 0 || segments_.size() < 2) {
+    return;
+  }
+  Status s = Thread::Create("log", "segment-readahead",
+                            &ReadAheadSegmentReader::ReadSegments, this, &thread_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to start segment read ahead thread, reading synchronously: " << s;
+    thread_ = nullptr;
+  }
+}
+
+void ReadAheadSegmentReader::ReadSegments() {
+  for (const auto& segment : segments_) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return stop_ || read_ahead_.size() < max_segments_ahead_; });
+      if (stop_) {
+        return;
+      }
+    }
+    ReadResult result;
+    result.status = segment->ReadEntries(&result.entries);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      read_ahead_.push_back(std::move(result));
+    }
+    cond_.notify_all();
+  }
+}
+
+bool ReadAheadSegmentReader::Next(scoped_refptr<ReadableLogSegment>* segment,
+                                  LogEntries* entries,
+                                  Status* read_status) {
+  if (next_segment_ == segments_.size()) {
+    return false;
+  }
+  *segment = segments_[next_segment_];
+  ++next_segment_;
+  entries->clear();
+  if (!thread_) {
+    *read_status = (**segment).ReadEntries(entries);
+    return true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !read_ahead_.empty(); });
+    auto& result = read_ahead_.front();
+    entries->swap(result.entries);
+    *read_status = result.status;
+    read_ahead_.pop_front();
+  }
+  cond_.notify_all();
+  return true;
+}
+
 }  // namespace log
 }  // namespace yb
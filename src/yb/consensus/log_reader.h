@@ -32,7 +32,10 @@
 #ifndef YB_CONSENSUS_LOG_READER_H
 #define YB_CONSENSUS_LOG_READER_H
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,6 +51,9 @@
 #include "yb/util/locks.h"
 
 namespace yb {
+
+class Thread;
+
 namespace log {
 class Log;
 class LogIndex;
@@ -218,6 +224,51 @@ class LogReader {
   DISALLOW_COPY_AND_ASSIGN(LogReader);
 };
 
+// Reads entries of a sequence of segments one segment after another. Up to 'max_segments_ahead'
+// following segments are read by a background thread, while the caller processes entries of the
+// current one, so reading from disk overlaps with e.g. replaying the entries.
+// With max_segments_ahead equal to 0 segments are read synchronously by Next().
+class ReadAheadSegmentReader {
+ public:
+  ReadAheadSegmentReader(SegmentSequence segments, size_t max_segments_ahead);
+
+  // Stops reading ahead and waits for the background thread.
+  ~ReadAheadSegmentReader();
+
+  // Starts reading ahead, falls back to synchronous reads if the thread could not be started.
+  void Start();
+
+  // Takes the next segment and its entries. 'read_status' is set to the status of reading the
+  // segment, entries read before a failure are returned anyway.
+  // Returns false if there are no more segments.
+  bool Next(scoped_refptr<ReadableLogSegment>* segment, LogEntries* entries,
+            Status* read_status);
+
+ private:
+  struct ReadResult {
+    LogEntries entries;
+    Status status;
+  };
+
+  void ReadSegments();
+
+  const SegmentSequence segments_;
+  const size_t max_segments_ahead_;
+
+  // Index of the next segment returned by Next().
+  size_t next_segment_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Segments that were read ahead, but not returned yet.
+  std::deque<ReadResult> read_ahead_;
+  bool stop_ = false;
+
+  scoped_refptr<Thread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadAheadSegmentReader);
+};
+
 }  // namespace log
 }  // namespace yb
 
@@ -0,0 +1,71 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/consensus/log_sync_coordinator.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/env.h"
+#include "yb/util/metrics.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+METRIC_DECLARE_entity(server);
+METRIC_DECLARE_counter(log_sync_coordinator_syncs);
+METRIC_DECLARE_counter(log_sync_coordinator_flushes);
+
+namespace yb {
+namespace log {
+
+class LogSyncCoordinatorTest : public YBTest {
+};
+
+// Syncs files of several "tablets" concurrently and checks that all of them succeed, while the
+// coordinator does not issue more flushes than there were syncs.
+TEST_F(LogSyncCoordinatorTest, ConcurrentSyncs) {
+  constexpr int kFiles = 8;
+  constexpr int kSyncsPerFile = 100;
+
+  MetricRegistry registry;
+  auto entity = METRIC_ENTITY_server.Instantiate(&registry, "test");
+  LogSyncCoordinator coordinator(entity);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kFiles; ++i) {
+    gscoped_ptr<WritableFile> file;
+    ASSERT_OK(env_->NewWritableFile(GetTestPath(strings::Substitute("segment-$0", i)), &file));
+    threads.emplace_back([&coordinator, file = std::shared_ptr<WritableFile>(file.release())] {
+      for (int j = 0; j != kSyncsPerFile; ++j) {
+        ASSERT_OK(file->Append(Slice("entry")));
+        ASSERT_OK(coordinator.Sync(file.get()));
+      }
+      ASSERT_OK(file->Close());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto syncs = METRIC_log_sync_coordinator_syncs.Instantiate(entity)->value();
+  auto flushes = METRIC_log_sync_coordinator_flushes.Instantiate(entity)->value();
+  LOG(INFO) << "Syncs: " << syncs << ", flushes: " << flushes;
+  ASSERT_EQ(kFiles * kSyncsPerFile, syncs);
+  ASSERT_LE(flushes, syncs);
+  ASSERT_GT(flushes, 0);
+}
+
+} // namespace log
+} // namespace yb
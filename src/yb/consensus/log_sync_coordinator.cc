@@ -0,0 +1,180 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/log_sync_coordinator.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <unordered_map>
+
+#include <gflags/gflags.h>
+
+#include "yb/util/env.h"
+#include "yb/util/errno.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+
+DEFINE_int32(log_sync_coordinator_window_us, 0,
+             "Time that the first caller of a sync group waits for syncs of other tablets to join "
+             "the group. Syncs that arrive while the previous group is being flushed always join "
+             "the next group, so 0 still provides batching under load.");
+TAG_FLAG(log_sync_coordinator_window_us, advanced);
+
+DEFINE_bool(log_sync_coordinator_use_syncfs, true,
+            "Flush a sync group containing several WAL segments on the same file system using a "
+            "single syncfs call instead of a fsync per segment. Linux only. Note that syncfs "
+            "reports writeback errors only starting with Linux 5.8.");
+TAG_FLAG(log_sync_coordinator_use_syncfs, advanced);
+
+DECLARE_bool(never_fsync);
+
+METRIC_DEFINE_counter(server, log_sync_coordinator_syncs,
+                      "Log Sync Coordinator Syncs",
+                      yb::MetricUnit::kRequests,
+                      "Number of WAL segment syncs requested through the log sync coordinator.");
+METRIC_DEFINE_counter(server, log_sync_coordinator_flushes,
+                      "Log Sync Coordinator Flushes",
+                      yb::MetricUnit::kOperations,
+                      "Number of fsync and syncfs calls issued by the log sync coordinator.");
+
+namespace yb {
+namespace log {
+
+namespace {
+
+#if defined(__linux__)
+// Flushes the whole file system containing the file.
+Status SyncFileSystem(const std::string& filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return STATUS(IOError, filename, ErrnoToString(errno), errno);
+  }
+  int ret = syncfs(fd);
+  int err = errno;
+  close(fd);
+  if (ret < 0) {
+    return STATUS(IOError, filename, ErrnoToString(err), err);
+  }
+  return Status::OK();
+}
+#endif
+
+} // namespace
+
+LogSyncCoordinator::LogSyncCoordinator(const scoped_refptr<MetricEntity>& metric_entity) {
+  if (metric_entity) {
+    syncs_ = METRIC_log_sync_coordinator_syncs.Instantiate(metric_entity);
+    flushes_ = METRIC_log_sync_coordinator_flushes.Instantiate(metric_entity);
+  }
+}
+
+Status LogSyncCoordinator::Sync(WritableFile* file) {
+  if (syncs_) {
+    syncs_->Increment();
+  }
+  Request request{file};
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_.push_back(&request);
+  for (;;) {
+    if (request.done) {
+      return request.status;
+    }
+    if (!flushing_) {
+      break;
+    }
+    cond_.wait(lock);
+  }
+
+  // No flush is in progress, so this caller flushes the group on behalf of all its members.
+  flushing_ = true;
+  if (FLAGS_log_sync_coordinator_window_us > 0) {
+    lock.unlock();
+    SleepFor(MonoDelta::FromMicroseconds(FLAGS_log_sync_coordinator_window_us));
+    lock.lock();
+  }
+  std::vector<Request*> group;
+  group.swap(pending_);
+  lock.unlock();
+
+  Flush(group);
+
+  lock.lock();
+  flushing_ = false;
+  for (auto* member : group) {
+    member->done = true;
+  }
+  lock.unlock();
+  cond_.notify_all();
+  return request.status;
+}
+
+void LogSyncCoordinator::Flush(const std::vector<Request*>& requests) {
+  std::vector<Request*> remaining;
+#if defined(__linux__)
+  if (FLAGS_log_sync_coordinator_use_syncfs && !FLAGS_never_fsync && requests.size() > 1) {
+    std::unordered_map<dev_t, std::vector<Request*>> by_device;
+    for (auto* request : requests) {
+      struct stat st;
+      if (stat(request->file->filename().c_str(), &st) == 0) {
+        by_device[st.st_dev].push_back(request);
+      } else {
+        remaining.push_back(request);
+      }
+    }
+    for (auto& device_and_requests : by_device) {
+      auto& device_requests = device_and_requests.second;
+      if (device_requests.size() == 1) {
+        remaining.push_back(device_requests.front());
+        continue;
+      }
+      // Write out data buffered by the files and start writeback of all of them, so a single
+      // syncfs waits for all of them and flushes the device once.
+      Status status;
+      for (auto* request : device_requests) {
+        status = request->file->Flush(WritableFile::FLUSH_ASYNC);
+        if (!status.ok()) {
+          break;
+        }
+      }
+      if (status.ok()) {
+        status = SyncFileSystem(device_requests.front()->file->filename());
+        if (flushes_) {
+          flushes_->Increment();
+        }
+      }
+      if (status.ok()) {
+        continue;
+      }
+      LOG(WARNING) << "Failed to sync file system of " << device_requests.size()
+                   << " WAL segments, syncing them one by one: " << status;
+      remaining.insert(remaining.end(), device_requests.begin(), device_requests.end());
+    }
+  } else {
+    remaining = requests;
+  }
+#else
+  remaining = requests;
+#endif
+
+  for (auto* request : remaining) {
+    request->status = request->file->Sync();
+    if (flushes_) {
+      flushes_->Increment();
+    }
+  }
+}
+
+} // namespace log
+} // namespace yb
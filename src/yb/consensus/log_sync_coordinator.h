@@ -0,0 +1,76 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_LOG_SYNC_COORDINATOR_H
+#define YB_CONSENSUS_LOG_SYNC_COORDINATOR_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/metrics.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class WritableFile;
+
+namespace log {
+
+// Coordinates fsyncs of the WAL segments of all tablets of a server.
+//
+// Each tablet log has its own append thread, that syncs the active segment after every group of
+// entry batches. With many tablets on the same device, it results in a large number of small
+// device flushes. Append threads that call Sync while a flush is in progress are gathered into
+// the next group, which is flushed by one of them on behalf of all others. When a group contains
+// segments of several tablets on the same file system, the whole group costs a single syncfs(2)
+// call, i.e. one device flush, instead of one fsync per segment.
+//
+// Sync does not return before the passed file is durable, so per-tablet durability guarantees
+// are the same as with direct fsync.
+class LogSyncCoordinator {
+ public:
+  explicit LogSyncCoordinator(const scoped_refptr<MetricEntity>& metric_entity = nullptr);
+
+  // Makes data written to the file durable, possibly batching it with syncs of other files.
+  CHECKED_STATUS Sync(WritableFile* file);
+
+ private:
+  struct Request {
+    WritableFile* file;
+    Status status;
+    bool done = false;
+  };
+
+  // Flushes files of the requests and fills their statuses.
+  void Flush(const std::vector<Request*>& requests);
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Requests waiting for the next flush.
+  std::vector<Request*> pending_;
+  // Whether some caller is flushing the previous group.
+  bool flushing_ = false;
+
+  scoped_refptr<Counter> syncs_;
+  scoped_refptr<Counter> flushes_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogSyncCoordinator);
+};
+
+} // namespace log
+} // namespace yb
+
+#endif // YB_CONSENSUS_LOG_SYNC_COORDINATOR_H
@@ -40,6 +40,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/cfile/compression_codec.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/fs/fs_manager.h"
@@ -692,10 +693,21 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   }
 
 
+  Slice batch_data = entry_batch_slice;
+  faststring uncompressed_buffer;
+  if (header_.compression_codec() != NO_COMPRESSION) {
+    const cfile::CompressionCodec* codec = nullptr;
+    RETURN_NOT_OK(cfile::GetCompressionCodec(header_.compression_codec(), &codec));
+    RETURN_NOT_OK_PREPEND(
+        UncompressLogData(codec, entry_batch_slice, &uncompressed_buffer, &batch_data),
+        Substitute("Could not uncompress entry in byte range $0-$1",
+                   *offset, *offset + header.msg_length));
+  }
+
   LogEntryBatchPB read_entry_batch;
   s = pb_util::ParseFromArray(&read_entry_batch,
-                              entry_batch_slice.data(),
-                              header.msg_length);
+                              batch_data.data(),
+                              batch_data.size());
 
   if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
                                                     s.ToString()));
@@ -717,6 +729,7 @@ Status WritableLogSegment::WriteHeaderAndOpen(const LogSegmentHeaderPB& new_head
   DCHECK(!IsHeaderWritten()) << "Can only call WriteHeader() once";
   DCHECK(new_header.IsInitialized())
       << "Log segment header must be initialized" << new_header.InitializationErrorString();
+  RETURN_NOT_OK(cfile::GetCompressionCodec(new_header.compression_codec(), &codec_));
   faststring buf;
 
   // First the magic.
@@ -766,9 +779,16 @@ Status WritableLogSegment::WriteFooterAndClose(const LogSegmentFooterPB& footer)
 }
 
 
-Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
+Status WritableLogSegment::WriteEntryBatch(const Slice& batch_data,
+                                           const boost::optional<uint32_t>& batch_crc) {
   DCHECK(is_header_written_);
   DCHECK(!is_footer_written_);
+  Slice data = batch_data;
+  if (codec_) {
+    compressed_buffer_.clear();
+    RETURN_NOT_OK(CompressLogData(codec_, batch_data, &compressed_buffer_));
+    data = Slice(compressed_buffer_);
+  }
   uint8_t header_buf[kEntryHeaderSize];
 
   // First encode the length of the message.
@@ -776,7 +796,7 @@ Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
   InlineEncodeFixed32(&header_buf[0], len);
 
   // Then the CRC of the message.
-  uint32_t msg_crc = crc::Crc32c(&data[0], data.size());
+  uint32_t msg_crc = batch_crc && !codec_ ? *batch_crc : crc::Crc32c(&data[0], data.size());
   InlineEncodeFixed32(&header_buf[4], msg_crc);
 
   // Then the CRC of the header
@@ -827,5 +847,49 @@ bool IsLogFileName(const string& fname) {
   return true;
 }
 
+Status CompressLogData(const cfile::CompressionCodec* codec,
+                       const Slice& data,
+                       faststring* out) {
+  const size_t start = out->size();
+  if (codec) {
+    PutVarint32(out, data.size());
+    const size_t compressed_start = out->size();
+    out->resize(compressed_start + codec->MaxCompressedLength(data.size()));
+    size_t compressed_size = 0;
+    RETURN_NOT_OK(codec->Compress(data, out->data() + compressed_start, &compressed_size));
+    if (compressed_size < data.size()) {
+      out->resize(compressed_start + compressed_size);
+      return Status::OK();
+    }
+    // Store incompressible data as is.
+    out->resize(start);
+  }
+  PutVarint32(out, 0);
+  out->append(data.data(), data.size());
+  return Status::OK();
+}
+
+Status UncompressLogData(const cfile::CompressionCodec* codec,
+                         const Slice& data,
+                         faststring* buffer,
+                         Slice* result) {
+  Slice input = data;
+  uint32_t uncompressed_size = 0;
+  if (PREDICT_FALSE(!GetVarint32(&input, &uncompressed_size))) {
+    return STATUS(Corruption, "Unable to decode uncompressed size");
+  }
+  if (uncompressed_size == 0) {
+    *result = input;
+    return Status::OK();
+  }
+  if (PREDICT_FALSE(!codec)) {
+    return STATUS(Corruption, "Compressed data without compression codec");
+  }
+  buffer->resize(uncompressed_size);
+  RETURN_NOT_OK(codec->Uncompress(input, buffer->data(), uncompressed_size));
+  *result = Slice(buffer->data(), uncompressed_size);
+  return Status::OK();
+}
+
 }  // namespace log
 }  // namespace yb
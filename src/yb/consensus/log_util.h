@@ -40,6 +40,7 @@
 #include <utility>
 #include <vector>
 
+#include <boost/optional.hpp>
 #include <gtest/gtest.h>
 
 #include "yb/consensus/log.pb.h"
@@ -48,12 +49,17 @@
 #include "yb/gutil/ref_counted.h"
 #include "yb/util/atomic.h"
 #include "yb/util/env.h"
+#include "yb/util/faststring.h"
 
 // Used by other classes, now part of the API.
 DECLARE_bool(durable_wal_write);
 
 namespace yb {
 
+namespace cfile {
+class CompressionCodec;
+} // namespace cfile
+
 namespace consensus {
 class ReplicateMsg;
 struct OpIdBiggerThanFunctor;
@@ -71,6 +77,7 @@ extern const size_t kEntryHeaderSize;
 extern const int kLogMajorVersion;
 extern const int kLogMinorVersion;
 
+class LogSyncCoordinator;
 class ReadableLogSegment;
 
 // Options for the State Machine/Write Ahead Log
@@ -89,6 +96,9 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // If set, syncs of the log are batched with syncs of logs of other tablets of the server.
+  std::shared_ptr<LogSyncCoordinator> sync_coordinator;
+
   LogOptions();
 };
 
@@ -332,7 +342,10 @@ class WritableLogSegment {
   // Appends the provided batch of data, including a header
   // and checksum.
   // Makes sure that the log segment has not been closed.
-  CHECKED_STATUS WriteEntryBatch(const Slice& entry_batch_data);
+  // 'entry_batch_crc' is the CRC32C of 'entry_batch_data' if the caller already computed it. It is
+  // ignored if the segment is compressed, since then the checksum covers the compressed data.
+  CHECKED_STATUS WriteEntryBatch(const Slice& entry_batch_data,
+                                 const boost::optional<uint32_t>& entry_batch_crc = boost::none);
 
   // Makes sure the I/O buffers in the underlying writable file are flushed.
   CHECKED_STATUS Sync() {
@@ -391,6 +404,12 @@ class WritableLogSegment {
 
   LogSegmentFooterPB footer_;
 
+  // Codec used to compress entry batches, null if they are not compressed.
+  const cfile::CompressionCodec* codec_ = nullptr;
+
+  // Buffer for the compressed entry batch.
+  faststring compressed_buffer_;
+
   // the offset of the first entry in the log
   int64_t first_entry_offset_;
 
@@ -412,6 +431,19 @@ void CreateBatchFromAllocatedOperations(const ReplicateMsgs& msgs,
 // Checks if 'fname' is a correctly formatted name of log segment file.
 bool IsLogFileName(const std::string& fname);
 
+// Appends 'data' to 'out' in the format of entries of a compressed log segment, i.e. varint32
+// uncompressed size followed by the data compressed with 'codec'. When compression does not
+// reduce the size, the uncompressed size is written as 0 followed by the data itself.
+CHECKED_STATUS CompressLogData(const cfile::CompressionCodec* codec,
+                               const Slice& data,
+                               faststring* out);
+
+// Reverses CompressLogData(). 'result' points either into 'data' or into 'buffer'.
+CHECKED_STATUS UncompressLogData(const cfile::CompressionCodec* codec,
+                                 const Slice& data,
+                                 faststring* buffer,
+                                 Slice* result);
+
 }  // namespace log
 }  // namespace yb
 
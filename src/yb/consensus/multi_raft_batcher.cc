@@ -0,0 +1,162 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <map>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/consensus/consensus.proxy.h"
+#include "yb/rpc/messenger.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
+
+DEFINE_int32(multi_raft_heartbeat_window_ms, 10,
+             "Time to collect heartbeats of tablets sent to the same server into a single RPC.");
+TAG_FLAG(multi_raft_heartbeat_window_ms, advanced);
+TAG_FLAG(multi_raft_heartbeat_window_ms, runtime);
+
+DEFINE_int32(multi_raft_batch_size, 512,
+             "Max number of tablet heartbeats sent to a server in a single RPC.");
+TAG_FLAG(multi_raft_batch_size, advanced);
+TAG_FLAG(multi_raft_batch_size, runtime);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+typedef std::pair<const rpc::Messenger*, Endpoint> BatcherKey;
+
+std::mutex batchers_mutex;
+std::map<BatcherKey, std::weak_ptr<MultiRaftHeartbeatBatcher>> batchers;
+
+} // namespace
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
+    const std::shared_ptr<rpc::Messenger>& messenger, const Endpoint& remote)
+    : messenger_(messenger),
+      remote_(remote),
+      proxy_(new ConsensusServiceProxy(messenger, remote)) {
+}
+
+MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
+  DCHECK(pending_.empty());
+}
+
+std::shared_ptr<MultiRaftHeartbeatBatcher> MultiRaftHeartbeatBatcher::Get(
+    const std::shared_ptr<rpc::Messenger>& messenger, const Endpoint& remote) {
+  std::lock_guard<std::mutex> lock(batchers_mutex);
+  auto& weak_batcher = batchers[BatcherKey(messenger.get(), remote)];
+  auto result = weak_batcher.lock();
+  if (!result) {
+    // Forget batchers that are not used anymore.
+    for (auto it = batchers.begin(); it != batchers.end();) {
+      if (it->second.expired() && &it->second != &weak_batcher) {
+        it = batchers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    result = std::make_shared<MultiRaftHeartbeatBatcher>(messenger, remote);
+    weak_batcher = result;
+  }
+  return result;
+}
+
+bool MultiRaftHeartbeatBatcher::CanBatch(
+    const ConsensusRequestPB& request, const rpc::RpcController& controller) {
+  return FLAGS_multi_raft_heartbeat_window_ms > 0 && request.ops_size() == 0 &&
+         controller.request_extra_data().empty();
+}
+
+void MultiRaftHeartbeatBatcher::AddRequest(const ConsensusRequestPB* request,
+                                           ConsensusResponsePB* response,
+                                           rpc::RpcController* controller,
+                                           const rpc::ResponseCallback& callback) {
+  bool schedule_flush = false;
+  bool flush_now = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(Entry{request, response, controller, callback});
+    schedule_flush = pending_.size() == 1;
+    flush_now = pending_.size() >= static_cast<size_t>(FLAGS_multi_raft_batch_size);
+  }
+  if (flush_now) {
+    Flush();
+  } else if (schedule_flush) {
+    auto self = shared_from_this();
+    // The flush also runs when the task is aborted, e.g. on shutdown, so every request gets its
+    // callback.
+    messenger_->ScheduleOnReactor(
+        [self](const Status& status) { self->Flush(); },
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_window_ms),
+        messenger_);
+  }
+}
+
+void MultiRaftHeartbeatBatcher::Flush() {
+  auto batch = std::make_shared<Batch>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch->entries.swap(pending_);
+  }
+  if (batch->entries.empty()) {
+    return;
+  }
+  if (batch->entries.size() == 1) {
+    SendSeparately(&batch->entries.front());
+    return;
+  }
+  for (const auto& entry : batch->entries) {
+    *batch->request.add_consensus_request() = *entry.request;
+  }
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  auto self = shared_from_this();
+  proxy_->MultiRaftUpdateConsensusAsync(
+      batch->request, &batch->response, &batch->controller,
+      [self, batch] { self->BatchDone(batch); });
+}
+
+void MultiRaftHeartbeatBatcher::BatchDone(const std::shared_ptr<Batch>& batch) {
+  const auto& status = batch->controller.status();
+  const size_t num_responses = batch->response.consensus_response_size();
+  if (!status.ok() || num_responses != batch->entries.size()) {
+    YB_LOG_EVERY_N_SECS(WARNING, 10)
+        << "Failed to send " << batch->entries.size() << " heartbeats to "
+        << remote_ << " in a single RPC, sending them separately: "
+        << (status.ok() ? STATUS(Corruption, "Wrong number of responses") : status).ToString();
+    for (auto& entry : batch->entries) {
+      SendSeparately(&entry);
+    }
+    return;
+  }
+  for (size_t i = 0; i != batch->entries.size(); ++i) {
+    auto& entry = batch->entries[i];
+    entry.response->Swap(batch->response.mutable_consensus_response(i));
+    entry.callback();
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendSeparately(Entry* entry) {
+  entry->controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  proxy_->UpdateConsensusAsync(*entry->request, entry->response, entry->controller,
+                               entry->callback);
+}
+
+}  // namespace consensus
+}  // namespace yb
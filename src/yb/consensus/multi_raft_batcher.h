@@ -0,0 +1,97 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/gutil/macros.h"
+#include "yb/rpc/response_callback.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/rpc/rpc_fwd.h"
+#include "yb/util/net/sockaddr.h"
+
+namespace yb {
+namespace consensus {
+
+class ConsensusServiceProxy;
+
+// Sends status-only consensus requests, i.e. heartbeats, of all tablets led by this server to
+// another server in a single MultiRaftUpdateConsensus RPC.
+//
+// Every tablet leader heartbeats each of its followers, so two servers sharing many tablets would
+// exchange a heartbeat RPC per tablet per heartbeat interval. Heartbeats added to the batcher are
+// held for a short window and sent together, with the term and commit index of each tablet in its
+// own request. The responses are then handed to the callbacks as if each request was sent alone.
+//
+// When the batch RPC fails, its requests are resent one by one, so each of them fails or succeeds
+// with its own RPC status, like unbatched requests do.
+//
+// There is one batcher per messenger and remote server, shared by all tablets.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(const std::shared_ptr<rpc::Messenger>& messenger,
+                            const Endpoint& remote);
+  ~MultiRaftHeartbeatBatcher();
+
+  // Returns the batcher of the messenger for the remote server, creating it on first use.
+  static std::shared_ptr<MultiRaftHeartbeatBatcher> Get(
+      const std::shared_ptr<rpc::Messenger>& messenger, const Endpoint& remote);
+
+  // Whether the request could be sent as part of a batch.
+  static bool CanBatch(const ConsensusRequestPB& request, const rpc::RpcController& controller);
+
+  // Adds the request to the next batch. request, response and controller should stay valid until
+  // callback is invoked.
+  void AddRequest(const ConsensusRequestPB* request,
+                  ConsensusResponsePB* response,
+                  rpc::RpcController* controller,
+                  const rpc::ResponseCallback& callback);
+
+ private:
+  struct Entry {
+    const ConsensusRequestPB* request;
+    ConsensusResponsePB* response;
+    rpc::RpcController* controller;
+    rpc::ResponseCallback callback;
+  };
+
+  struct Batch {
+    std::vector<Entry> entries;
+    MultiRaftConsensusRequestPB request;
+    MultiRaftConsensusResponsePB response;
+    rpc::RpcController controller;
+  };
+
+  void Flush();
+  void BatchDone(const std::shared_ptr<Batch>& batch);
+  void SendSeparately(Entry* entry);
+
+  std::shared_ptr<rpc::Messenger> messenger_;
+  const Endpoint remote_;
+  std::unique_ptr<ConsensusServiceProxy> proxy_;
+
+  std::mutex mutex_;
+  std::vector<Entry> pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftHeartbeatBatcher);
+};
+
+}  // namespace consensus
+}  // namespace yb
+
+#endif  // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
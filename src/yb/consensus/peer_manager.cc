@@ -113,6 +113,19 @@ void PeerManager::SignalRequest(RequestTriggerMode trigger_mode) {
   }
 }
 
+bool PeerManager::WakeQuiescentPeers() {
+  bool result = false;
+  std::lock_guard<simple_spinlock> lock(lock_);
+  for (const auto& entry : peers_) {
+    if (entry.second->Wake()) {
+      WARN_NOT_OK(entry.second->SignalRequest(RequestTriggerMode::ALWAYS_SEND),
+                  "Failed to wake up peer");
+      result = true;
+    }
+  }
+  return result;
+}
+
 void PeerManager::Close() {
   {
     std::lock_guard<simple_spinlock> lock(lock_);
@@ -83,6 +83,9 @@ class PeerManager {
   // Signals all peers of the current configuration that there is a new request pending.
   virtual void SignalRequest(RequestTriggerMode trigger_mode);
 
+  // Resumes heartbeats to quiescent peers. Returns whether some of the peers were quiescent.
+  virtual bool WakeQuiescentPeers();
+
   // Closes all peers.
   virtual void Close();
 
@@ -0,0 +1,384 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+// Benchmarks replication through RaftConsensus. All replicas run in this process and talk to
+// each other through in-process proxies, that delay requests and responses by the configured
+// one-way latency of the link plus the time to transfer them at the configured bandwidth. Each
+// run reports commit latency percentiles and throughput for a number of concurrently replicated
+// operations, that the leader batches into the same requests, and a log sync mode.
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include "yb/common/schema.h"
+#include "yb/common/wire_protocol-test-util.h"
+#include "yb/consensus/consensus-test-util.h"
+#include "yb/consensus/log.h"
+#include "yb/consensus/peer_manager.h"
+#include "yb/consensus/quorum_util.h"
+#include "yb/consensus/raft_consensus.h"
+#include "yb/gutil/stl_util.h"
+#include "yb/gutil/strings/numbers.h"
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/server/logical_clock.h"
+#include "yb/util/hdr_histogram.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/metrics.h"
+#include "yb/util/test_util.h"
+
+DEFINE_int32(raft_consensus_bench_num_replicas, 3, "Number of replicas of the benchmarked tablet.");
+DEFINE_int32(raft_consensus_bench_num_ops, 20000, "Number of operations replicated by each run.");
+DEFINE_int32(raft_consensus_bench_payload_bytes, 256, "Payload size of replicated operations.");
+DEFINE_string(raft_consensus_bench_concurrency, "1,8,64",
+              "Comma separated numbers of operations replicated concurrently, swept by each "
+              "benchmark.");
+DEFINE_int32(raft_consensus_bench_link_latency_us, 500,
+             "One-way latency of links between replicas.");
+DEFINE_int32(raft_consensus_bench_link_bandwidth_mbps, 0,
+             "Bandwidth of links between replicas in megabits per second, 0 for unlimited.");
+DEFINE_int32(raft_consensus_bench_slow_link_latency_us, 20000,
+             "One-way latency of the links to the slow follower in BenchmarkSlowFollower.");
+
+DECLARE_bool(durable_wal_write);
+DECLARE_bool(enable_leader_failure_detection);
+
+METRIC_DECLARE_entity(tablet);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+const char* kTestTable = "TestTable";
+const char* kTestTablet = "TestTablet";
+
+void DoNothing(std::shared_ptr<consensus::StateChangeContext> context) {
+}
+
+std::vector<int64> ParseList(const std::string& value) {
+  std::vector<int64> result;
+  bool (*parse)(const std::string&, int64*) = &safe_strto64;
+  CHECK(SplitStringAndParse(value, ",", parse, &result)) << "Bad list: " << value;
+  return result;
+}
+
+struct LinkOptions {
+  MonoDelta latency;
+  // 0 for unlimited.
+  int bandwidth_mbps;
+};
+
+typedef std::function<LinkOptions(const std::string& from, const std::string& to)>
+    LinkOptionsProvider;
+
+struct LinkStats {
+  std::atomic<int64_t> update_requests{0};
+  std::atomic<int64_t> replicated_ops{0};
+};
+
+// Delays the requests sent to the peer and its responses as if they were sent over a link with
+// the given options.
+class SimulatedLinkPeerProxy : public LocalTestPeerProxy {
+ public:
+  SimulatedLinkPeerProxy(std::string peer_uuid, ThreadPool* pool, TestPeerMapManager* peers,
+                         const LinkOptions& options, LinkStats* stats)
+      : LocalTestPeerProxy(std::move(peer_uuid), pool, peers), options_(options), stats_(stats) {
+  }
+
+  void UpdateAsync(const ConsensusRequestPB* request,
+                   ConsensusResponsePB* response,
+                   rpc::RpcController* controller,
+                   const rpc::ResponseCallback& callback) override {
+    RegisterCallback(kUpdate, callback);
+    stats_->update_requests.fetch_add(1, std::memory_order_relaxed);
+    stats_->replicated_ops.fetch_add(request->ops_size(), std::memory_order_relaxed);
+    const auto delay = TransferTime(request->ByteSize());
+    CHECK_OK(pool_->SubmitFunc([this, request, response, delay] {
+      SleepFor(delay);
+      SendUpdateRequest(request, response);
+    }));
+  }
+
+ protected:
+  void Respond(Method method) override {
+    // Responses are small, so only the latency matters.
+    SleepFor(options_.latency);
+    LocalTestPeerProxy::Respond(method);
+  }
+
+ private:
+  MonoDelta TransferTime(size_t bytes) const {
+    if (options_.bandwidth_mbps == 0) {
+      return options_.latency;
+    }
+    // A megabit per second transfers a bit per microsecond.
+    return MonoDelta::FromMicroseconds(
+        options_.latency.ToMicroseconds() + bytes * 8 / options_.bandwidth_mbps);
+  }
+
+  const LinkOptions options_;
+  LinkStats* const stats_;
+};
+
+class SimulatedLinkPeerProxyFactory : public PeerProxyFactory {
+ public:
+  SimulatedLinkPeerProxyFactory(TestPeerMapManager* peers, std::string local_uuid,
+                                LinkOptionsProvider link_options, LinkStats* stats,
+                                int num_peers)
+      : peers_(peers), local_uuid_(std::move(local_uuid)),
+        link_options_(std::move(link_options)), stats_(stats) {
+    // Requests sleep in the pool for the link latency, so each peer needs its own threads.
+    CHECK_OK(ThreadPoolBuilder("bench-peer-pool").set_max_threads(2 * num_peers).Build(&pool_));
+  }
+
+  CHECKED_STATUS NewProxy(const consensus::RaftPeerPB& peer_pb,
+                          gscoped_ptr<PeerProxy>* proxy) override {
+    proxy->reset(new SimulatedLinkPeerProxy(
+        peer_pb.permanent_uuid(), pool_.get(), peers_,
+        link_options_(local_uuid_, peer_pb.permanent_uuid()), stats_));
+    return Status::OK();
+  }
+
+ private:
+  gscoped_ptr<ThreadPool> pool_;
+  TestPeerMapManager* const peers_;
+  const std::string local_uuid_;
+  const LinkOptionsProvider link_options_;
+  LinkStats* const stats_;
+};
+
+} // namespace
+
+class RaftConsensusBench : public YBTest {
+ public:
+  RaftConsensusBench()
+      : clock_(server::LogicalClock::CreateStartingAt(HybridTime(0))),
+        metric_entity_(METRIC_ENTITY_tablet.Instantiate(&metric_registry_, "raft-bench")),
+        schema_(GetSimpleTestSchema()) {
+    options_.tablet_id = kTestTablet;
+    FLAGS_enable_leader_failure_detection = false;
+  }
+
+  ~RaftConsensusBench() {
+    StopCluster();
+  }
+
+ protected:
+  // Runs the workload for each of the configured concurrencies, with and without log sync.
+  void RunSweep(const std::string& name, const LinkOptionsProvider& link_options) {
+    for (bool durable_wal_write : {false, true}) {
+      for (auto concurrency : ParseList(FLAGS_raft_consensus_bench_concurrency)) {
+        FLAGS_durable_wal_write = durable_wal_write;
+        const auto run_name = strings::Substitute(
+            "$0-$1-$2", name, concurrency, durable_wal_write ? "sync" : "nosync");
+        ASSERT_OK(StartCluster(run_name, link_options));
+        RunWorkload(run_name, concurrency);
+        StopCluster();
+      }
+    }
+  }
+
+  // Builds and starts a configuration of FLAGS_raft_consensus_bench_num_replicas peers and
+  // elects the last one.
+  CHECKED_STATUS StartCluster(const std::string& run_name,
+                              const LinkOptionsProvider& link_options) {
+    config_ = BuildRaftConfigPBForTests(FLAGS_raft_consensus_bench_num_replicas);
+    config_.set_opid_index(kInvalidOpIdIndex);
+    peers_.reset(new TestPeerMapManager(config_));
+    stats_.reset(new LinkStats);
+
+    for (int i = 0; i < config_.peers_size(); i++) {
+      const std::string peer_uuid = config_.peers(i).permanent_uuid();
+      auto parent_mem_tracker = MemTracker::CreateTracker(
+          -1, strings::Substitute("$0-$1", run_name, peer_uuid));
+      const std::string test_path =
+          GetTestPath(strings::Substitute("$0-$1-root", run_name, peer_uuid));
+      FsManagerOpts opts;
+      opts.parent_mem_tracker = parent_mem_tracker;
+      opts.wal_paths = { test_path };
+      opts.data_paths = { test_path };
+      opts.server_type = "tserver_test";
+      gscoped_ptr<FsManager> fs_manager(new FsManager(env_.get(), opts));
+      RETURN_NOT_OK(fs_manager->CreateInitialFileSystemLayout());
+      RETURN_NOT_OK(fs_manager->Open());
+
+      scoped_refptr<log::Log> log;
+      RETURN_NOT_OK(log::Log::Open(log::LogOptions(),
+                                   fs_manager.get(),
+                                   kTestTablet,
+                                   fs_manager->GetFirstTabletWalDirOrDie(kTestTable, kTestTablet),
+                                   schema_,
+                                   0, // schema_version
+                                   nullptr,
+                                   &log));
+      logs_.push_back(log);
+
+      auto proxy_factory = new SimulatedLinkPeerProxyFactory(
+          peers_.get(), peer_uuid, link_options, stats_.get(), config_.peers_size());
+      auto operation_factory = new TestOperationFactory(log.get());
+
+      gscoped_ptr<ConsensusMetadata> cmeta;
+      RETURN_NOT_OK(ConsensusMetadata::Create(fs_manager.get(), kTestTablet, peer_uuid, config_,
+                                              kMinimumTerm, &cmeta));
+
+      RaftPeerPB local_peer_pb;
+      RETURN_NOT_OK(GetRaftConfigMember(config_, peer_uuid, &local_peer_pb));
+      gscoped_ptr<PeerMessageQueue> queue(new PeerMessageQueue(
+          metric_entity_, log, local_peer_pb, kTestTablet, clock_));
+
+      gscoped_ptr<ThreadPool> thread_pool;
+      RETURN_NOT_OK(ThreadPoolBuilder("bench-raft").Build(&thread_pool));
+
+      gscoped_ptr<PeerManager> peer_manager(new PeerManager(
+          options_.tablet_id, peer_uuid, proxy_factory, queue.get(), thread_pool.get(), log));
+
+      scoped_refptr<RaftConsensus> peer(
+          new RaftConsensus(options_,
+                            cmeta.Pass(),
+                            gscoped_ptr<PeerProxyFactory>(proxy_factory).Pass(),
+                            queue.Pass(),
+                            peer_manager.Pass(),
+                            thread_pool.Pass(),
+                            metric_entity_,
+                            peer_uuid,
+                            clock_,
+                            operation_factory,
+                            log,
+                            parent_mem_tracker,
+                            Bind(&DoNothing),
+                            DEFAULT_TABLE_TYPE,
+                            LostLeadershipListener()));
+
+      operation_factory->SetConsensus(peer.get());
+      operation_factories_.emplace_back(operation_factory);
+      fs_managers_.push_back(fs_manager.release());
+      peers_->AddPeer(peer_uuid, peer);
+    }
+
+    ConsensusBootstrapInfo boot_info;
+    for (const auto& entry : peers_->GetPeerMapCopy()) {
+      RETURN_NOT_OK(entry.second->Start(boot_info));
+    }
+    RETURN_NOT_OK(peers_->GetPeerByIdx(config_.peers_size() - 1, &leader_));
+    RETURN_NOT_OK(leader_->EmulateElection());
+    return leader_->WaitUntilLeaderForTests(MonoDelta::FromSeconds(10));
+  }
+
+  void StopCluster() {
+    for (const auto& factory : operation_factories_) {
+      factory->WaitDone();
+    }
+    if (peers_) {
+      for (const auto& entry : peers_->GetPeerMapCopy()) {
+        entry.second->Shutdown();
+      }
+      peers_->Clear();
+    }
+    leader_.reset();
+    operation_factories_.clear();
+    // Logs should be closed before their fs managers are deleted.
+    logs_.clear();
+    STLDeleteElements(&fs_managers_);
+  }
+
+  // Replicates FLAGS_raft_consensus_bench_num_ops operations through the leader, keeping
+  // concurrency of them in flight.
+  void RunWorkload(const std::string& run_name, int concurrency) {
+    HdrHistogram latency_us(60000000LU, 3);
+    std::atomic<int> next_op{0};
+    std::vector<std::thread> threads;
+    const auto start = MonoTime::Now(MonoTime::FINE);
+    for (int i = 0; i != concurrency; ++i) {
+      threads.emplace_back([this, &latency_us, &next_op] {
+        while (next_op.fetch_add(1, std::memory_order_acq_rel) <
+                   FLAGS_raft_consensus_bench_num_ops) {
+          auto msg = std::make_shared<ReplicateMsg>();
+          msg->set_op_type(NO_OP);
+          msg->mutable_noop_request()->mutable_payload_for_tests()->resize(
+              FLAGS_raft_consensus_bench_payload_bytes);
+          msg->set_hybrid_time(clock_->Now().ToUint64());
+
+          Synchronizer sync;
+          const auto op_start = MonoTime::Now(MonoTime::FINE);
+          auto round = leader_->NewRound(std::move(msg), sync.AsStatusCallback());
+          CHECK_OK(leader_->Replicate(round.get()));
+          CHECK_OK(sync.Wait());
+          latency_us.Increment(
+              MonoTime::Now(MonoTime::FINE).GetDeltaSince(op_start).ToMicroseconds());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const auto elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start).ToSeconds();
+
+    const auto requests = stats_->update_requests.load(std::memory_order_acquire);
+    LOG(INFO) << strings::Substitute(
+        "$0: $1 ops/sec, commit latency p50=$2us p99=$3us p99.9=$4us max=$5us, "
+        "$6 ops per update request",
+        run_name, latency_us.TotalCount() / std::max(elapsed, 1e-6),
+        latency_us.ValueAtPercentile(50), latency_us.ValueAtPercentile(99),
+        latency_us.ValueAtPercentile(99.9), latency_us.MaxValue(),
+        requests == 0 ? 0.0 :
+            static_cast<double>(stats_->replicated_ops.load(std::memory_order_acquire)) /
+                requests);
+  }
+
+  ConsensusOptions options_;
+  RaftConfigPB config_;
+  std::vector<FsManager*> fs_managers_;
+  std::vector<scoped_refptr<log::Log>> logs_;
+  gscoped_ptr<TestPeerMapManager> peers_;
+  std::vector<std::unique_ptr<TestOperationFactory>> operation_factories_;
+  scoped_refptr<RaftConsensus> leader_;
+  std::unique_ptr<LinkStats> stats_;
+  scoped_refptr<server::Clock> clock_;
+  MetricRegistry metric_registry_;
+  scoped_refptr<MetricEntity> metric_entity_;
+  const Schema schema_;
+};
+
+TEST_F(RaftConsensusBench, BenchmarkReplication) {
+  const LinkOptions options = {
+      MonoDelta::FromMicroseconds(FLAGS_raft_consensus_bench_link_latency_us),
+      FLAGS_raft_consensus_bench_link_bandwidth_mbps};
+  RunSweep("uniform", [options](const std::string& from, const std::string& to) {
+    return options;
+  });
+}
+
+// The first follower, peer-0, is far from the others, so commits depend on the rest of them.
+TEST_F(RaftConsensusBench, BenchmarkSlowFollower) {
+  const LinkOptions options = {
+      MonoDelta::FromMicroseconds(FLAGS_raft_consensus_bench_link_latency_us),
+      FLAGS_raft_consensus_bench_link_bandwidth_mbps};
+  const LinkOptions slow_options = {
+      MonoDelta::FromMicroseconds(FLAGS_raft_consensus_bench_slow_link_latency_us),
+      FLAGS_raft_consensus_bench_link_bandwidth_mbps};
+  const std::string slow_uuid = "peer-0";
+  RunSweep("slow_follower",
+           [options, slow_options, slow_uuid](const std::string& from, const std::string& to) {
+    return from == slow_uuid || to == slow_uuid ? slow_options : options;
+  });
+}
+
+} // namespace consensus
+} // namespace yb
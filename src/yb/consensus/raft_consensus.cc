@@ -39,6 +39,7 @@
 #include <boost/optional.hpp>
 #include <gflags/gflags.h>
 
+#include "yb/cfile/compression_codec.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/consensus/consensus_peers.h"
@@ -59,6 +60,7 @@
 #include "yb/util/logging.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/pb_util.h"
 #include "yb/util/random.h"
 #include "yb/util/random_util.h"
 #include "yb/util/threadpool.h"
@@ -118,6 +120,19 @@ DEFINE_bool(evict_failed_followers, true,
             "follower_unavailable_considered_failed_sec");
 TAG_FLAG(evict_failed_followers, advanced);
 
+DEFINE_bool(raft_first_voter_runs_initial_election, true,
+            "When a new Raft group starts, only the first voter of its initial config runs an "
+            "election right away, while other replicas wait for the regular election timeout. "
+            "The master lists the replica it picked as the initial leader of a new tablet first, "
+            "so the first election is not split between replicas.");
+TAG_FLAG(raft_first_voter_runs_initial_election, advanced);
+
+DEFINE_bool(use_preelection, true,
+            "Whether to run a pre-election, that does not change terms of replicas, before "
+            "incrementing the term for a regular leader election.");
+TAG_FLAG(use_preelection, advanced);
+TAG_FLAG(use_preelection, runtime);
+
 DEFINE_bool(follower_reject_update_consensus_requests, false,
             "Whether a follower will return an error for all UpdateConsensus() requests. "
             "Warning! This is only intended for testing.");
@@ -320,6 +335,8 @@ RaftConsensus::RaftConsensus(
                                 cmeta.Pass(),
                                 DCHECK_NOTNULL(operation_factory)));
 
+  queue_->SetSafeTimeProvider(
+      std::bind(&ReplicaOperationFactory::SafeTimeForFollowers, operation_factory));
   peer_manager_->SetConsensus(this);
 }
 
@@ -372,7 +389,7 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info) {
 
     // If this is the first term expire the FD immediately so that we have a fast first
     // election, otherwise we just let the timer expire normally.
-    if (state_->GetCurrentTermUnlocked() == 0) {
+    if (state_->GetCurrentTermUnlocked() == 0 && IsInitialLeaderCandidateUnlocked()) {
       // Initialize the failure detector timeout to some time in the past so that
       // the next time the failure detector monitor runs it triggers an election
       // (unless someone else requested a vote from us first, which resets the
@@ -402,6 +419,18 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info) {
   return Status::OK();
 }
 
+bool RaftConsensus::IsInitialLeaderCandidateUnlocked() {
+  if (!FLAGS_raft_first_voter_runs_initial_election) {
+    return true;
+  }
+  for (const RaftPeerPB& peer : state_->GetActiveConfigUnlocked().peers()) {
+    if (peer.member_type() == RaftPeerPB::VOTER) {
+      return peer.permanent_uuid() == state_->GetPeerUuid();
+    }
+  }
+  return true;
+}
+
 bool RaftConsensus::IsRunning() const {
   ReplicaState::UniqueLock lock;
   Status s = state_->LockForRead(&lock);
@@ -484,48 +513,10 @@ Status RaftConsensus::StartElection(
             << "Triggering leader election, mode=" << mode;
       }
 
-      // Increment the term.
-      RETURN_NOT_OK(IncrementTermUnlocked());
-
-      // Snooze to avoid the election timer firing again as much as possible.
-      // We do not disable the election timer while running an election.
-      RETURN_NOT_OK(EnsureFailureDetectorEnabledUnlocked());
-
-      MonoDelta timeout = LeaderElectionExpBackoffDeltaUnlocked();
-      RETURN_NOT_OK(SnoozeFailureDetectorUnlocked(timeout, ALLOW_LOGGING));
-
-      const RaftConfigPB& active_config = state_->GetActiveConfigUnlocked();
-      LOG_WITH_PREFIX_UNLOCKED(INFO) << "Starting election with config: "
-                                     << active_config.ShortDebugString();
-
-      // Initialize the VoteCounter.
-      int num_voters = CountVoters(active_config);
-      int majority_size = MajoritySize(num_voters);
-      gscoped_ptr<VoteCounter> counter(new VoteCounter(num_voters, majority_size));
-      // Vote for ourselves.
-      // TODO: Consider using a separate Mutex for voting, which must sync to disk.
-      RETURN_NOT_OK(state_->SetVotedForCurrentTermUnlocked(state_->GetPeerUuid()));
-      bool duplicate;
-      RETURN_NOT_OK(counter->RegisterVote(state_->GetPeerUuid(), VOTE_GRANTED, &duplicate));
-      CHECK(!duplicate) << state_->LogPrefixUnlocked()
-                        << "Inexplicable duplicate self-vote for term "
-                        << state_->GetCurrentTermUnlocked();
-
-      VoteRequestPB request;
-      request.set_ignore_live_leader(mode == ELECT_EVEN_IF_LEADER_IS_ALIVE);
-      request.set_candidate_uuid(state_->GetPeerUuid());
-      request.set_candidate_term(state_->GetCurrentTermUnlocked());
-      request.set_tablet_id(state_->GetOptions().tablet_id);
-      *request.mutable_candidate_status()->mutable_last_received() =
-        state_->GetLastReceivedOpIdUnlocked();
-
-      election.reset(new LeaderElection(
-          active_config,
-          peer_proxy_factory_.get(),
-          request,
-          counter.Pass(),
-          timeout,
-          Bind(&RaftConsensus::ElectionCallback, this, originator_uuid)));
+      // Elections forced by the leader, e.g. to transfer leadership, are expected to be won, so
+      // only normal elections are preceded by a pre-election.
+      const bool preelection = FLAGS_use_preelection && mode == NORMAL_ELECTION;
+      RETURN_NOT_OK(CreateElectionUnlocked(mode, preelection, originator_uuid, &election));
 
       // Clear the pending election op id so that we won't start the same pending election again.
       state_->ClearPendingElectionOpIdUnlocked();
@@ -546,6 +537,62 @@ Status RaftConsensus::StartElection(
   return Status::OK();
 }
 
+Status RaftConsensus::CreateElectionUnlocked(ElectionMode mode,
+                                             bool preelection,
+                                             const std::string& originator_uuid,
+                                             scoped_refptr<LeaderElection>* election) {
+  // A pre-election asks for votes for the next term, without incrementing our own term.
+  if (!preelection) {
+    // Increment the term.
+    RETURN_NOT_OK(IncrementTermUnlocked());
+  }
+  const ConsensusTerm election_term =
+      state_->GetCurrentTermUnlocked() + (preelection ? 1 : 0);
+
+  // Snooze to avoid the election timer firing again as much as possible.
+  // We do not disable the election timer while running an election.
+  RETURN_NOT_OK(EnsureFailureDetectorEnabledUnlocked());
+
+  MonoDelta timeout = LeaderElectionExpBackoffDeltaUnlocked();
+  RETURN_NOT_OK(SnoozeFailureDetectorUnlocked(timeout, ALLOW_LOGGING));
+
+  const RaftConfigPB& active_config = state_->GetActiveConfigUnlocked();
+  LOG_WITH_PREFIX_UNLOCKED(INFO) << "Starting " << (preelection ? "pre-election" : "election")
+                                 << " with config: " << active_config.ShortDebugString();
+
+  // Initialize the VoteCounter.
+  int num_voters = CountVoters(active_config);
+  int majority_size = MajoritySize(num_voters);
+  gscoped_ptr<VoteCounter> counter(new VoteCounter(num_voters, majority_size));
+  // Vote for ourselves.
+  // TODO: Consider using a separate Mutex for voting, which must sync to disk.
+  if (!preelection) {
+    RETURN_NOT_OK(state_->SetVotedForCurrentTermUnlocked(state_->GetPeerUuid()));
+  }
+  bool duplicate;
+  RETURN_NOT_OK(counter->RegisterVote(state_->GetPeerUuid(), VOTE_GRANTED, &duplicate));
+  CHECK(!duplicate) << state_->LogPrefixUnlocked()
+                    << "Inexplicable duplicate self-vote for term " << election_term;
+
+  VoteRequestPB request;
+  request.set_ignore_live_leader(mode == ELECT_EVEN_IF_LEADER_IS_ALIVE);
+  request.set_candidate_uuid(state_->GetPeerUuid());
+  request.set_candidate_term(election_term);
+  request.set_tablet_id(state_->GetOptions().tablet_id);
+  request.set_preelection(preelection);
+  *request.mutable_candidate_status()->mutable_last_received() =
+    state_->GetLastReceivedOpIdUnlocked();
+
+  election->reset(new LeaderElection(
+      active_config,
+      peer_proxy_factory_.get(),
+      request,
+      counter.Pass(),
+      timeout,
+      Bind(&RaftConsensus::ElectionCallback, this, originator_uuid, preelection)));
+  return Status::OK();
+}
+
 Status RaftConsensus::WaitUntilLeaderForTests(const MonoDelta& timeout) {
   MonoTime deadline = MonoTime::Now(MonoTime::FINE);
   deadline.AddDelta(timeout);
@@ -788,6 +835,7 @@ Status RaftConsensus::BecomeLeaderUnlocked() {
 
   // Disable FD while we are leader.
   RETURN_NOT_OK(EnsureFailureDetectorDisabledUnlocked());
+  follower_quiescent_ = false;
 
   // Don't vote for anyone if we're a leader.
   withhold_votes_until_ = MonoTime::Max();
@@ -1089,6 +1137,27 @@ void RaftConsensus::TryRemoveFollowerTask(const string& uuid,
               state_->LogPrefixThreadSafe() + "Unable to remove follower " + uuid);
 }
 
+namespace {
+
+// Moves compressed ops of the request to its ops.
+Status UncompressOps(ConsensusRequestPB* request) {
+  if (request->compressed_ops().empty()) {
+    return Status::OK();
+  }
+  const cfile::CompressionCodec* codec = nullptr;
+  RETURN_NOT_OK(cfile::GetCompressionCodec(request->ops_compression_codec(), &codec));
+  faststring buffer;
+  for (const auto& compressed : request->compressed_ops()) {
+    Slice data;
+    RETURN_NOT_OK(log::UncompressLogData(codec, compressed, &buffer, &data));
+    RETURN_NOT_OK(pb_util::ParseFromArray(request->add_ops(), data.data(), data.size()));
+  }
+  request->clear_compressed_ops();
+  return Status::OK();
+}
+
+} // anonymous namespace
+
 Status RaftConsensus::Update(ConsensusRequestPB* request,
                              ConsensusResponsePB* response) {
 
@@ -1099,6 +1168,7 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
 
   RETURN_NOT_OK(ExecuteHook(PRE_UPDATE));
   response->set_responder_uuid(state_->GetPeerUuid());
+  RETURN_NOT_OK_PREPEND(UncompressOps(request), "Failed to uncompress ops");
 
   VLOG_WITH_PREFIX(2) << "Replica received request: " << request->ShortDebugString();
 
@@ -1524,6 +1594,16 @@ Status RaftConsensus::UpdateReplica(ConsensusRequestPB* request,
     // we actually reply to the leader, we'll just wait for the messages to be durable.
     FillConsensusResponseOKUnlocked(response);
 
+    // Stop leader failure detection when the leader is idle. It stops heartbeating us once we
+    // confirm that.
+    if (request->quiesce() && deduped_req.messages.empty() &&
+        state_->GetOptions().allow_quiescence) {
+      VLOG_WITH_PREFIX_UNLOCKED(1) << "Quiescing";
+      RETURN_NOT_OK(EnsureFailureDetectorDisabledUnlocked());
+      follower_quiescent_ = true;
+      response->set_quiescent(true);
+    }
+
     // Check if there is an election pending and the op id pending upon has just been committed.
     if (state_->HasOpIdCommittedUnlocked(state_->GetPendingElectionOpIdUnlocked())) {
       start_election = true;
@@ -1731,7 +1811,21 @@ Status RaftConsensus::MarkOperationsAsCommittedUnlocked(const ConsensusRequestPB
 
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Marking committed up to " << apply_up_to.ShortDebugString();
   TRACE(Substitute("Marking committed up to $0", apply_up_to.ShortDebugString()));
-  return state_->AdvanceCommittedIndexUnlocked(apply_up_to);
+  RETURN_NOT_OK(state_->AdvanceCommittedIndexUnlocked(apply_up_to));
+
+  // Leader safe time is usable only when we have all operations committed before it was taken.
+  if (request.has_propagated_safe_time() &&
+      state_->GetLastReceivedOpIdUnlocked().index() >= request.committed_index().index()) {
+    UpdateLeaderSafeTime(request.propagated_safe_time());
+  }
+  return Status::OK();
+}
+
+void RaftConsensus::UpdateLeaderSafeTime(uint64_t safe_time) {
+  uint64_t current = leader_safe_time_.load(std::memory_order_acquire);
+  while ((current == HybridTime::kInvalid.ToUint64() || current < safe_time) &&
+         !leader_safe_time_.compare_exchange_weak(current, safe_time)) {
+  }
 }
 
 void RaftConsensus::FillConsensusResponseOKUnlocked(ConsensusResponsePB* response) {
@@ -1820,6 +1914,11 @@ Status RaftConsensus::RequestVote(const VoteRequestPB* request, VoteResponsePB*
     return RequestVoteRespondInvalidTerm(request, response);
   }
 
+  // A pre-election vote neither advances our term nor is persisted.
+  if (request->preelection()) {
+    return RequestPreVoteUnlocked(request, response);
+  }
+
   // We already voted this term.
   if (request->candidate_term() == state_->GetCurrentTermUnlocked() &&
       state_->HasVotedCurrentTermUnlocked()) {
@@ -1866,6 +1965,28 @@ Status RaftConsensus::RequestVote(const VoteRequestPB* request, VoteResponsePB*
   return RequestVoteRespondVoteGranted(request, response);
 }
 
+Status RaftConsensus::RequestPreVoteUnlocked(const VoteRequestPB* request,
+                                             VoteResponsePB* response) {
+  // We already voted for another candidate in the term of the pre-election.
+  if (request->candidate_term() == state_->GetCurrentTermUnlocked() &&
+      state_->HasVotedCurrentTermUnlocked() &&
+      state_->GetVotedForCurrentTermUnlocked() != request->candidate_uuid()) {
+    return RequestVoteRespondAlreadyVotedForOther(request, response);
+  }
+
+  OpId local_last_logged_opid = GetLatestOpIdFromLog();
+  if (OpIdLessThan(request->candidate_status().last_received(), local_last_logged_opid)) {
+    return RequestVoteRespondLastOpIdTooOld(local_last_logged_opid, request, response);
+  }
+
+  FillVoteResponseVoteGranted(response);
+  LOG(INFO) << Substitute("$0: Granting yes pre-election vote for candidate $1 in term $2.",
+                          GetRequestVoteLogPrefixUnlocked(),
+                          request->candidate_uuid(),
+                          request->candidate_term());
+  return Status::OK();
+}
+
 Status RaftConsensus::IsLeaderReadyForChangeConfigUnlocked(ChangeConfigType type,
                                                            const string& server_uuid) {
   const RaftConfigPB& active_config = state_->GetActiveConfigUnlocked();
@@ -2208,7 +2329,26 @@ Status RaftConsensus::WaitForLeaderLeaseImprecise(MonoTime deadline) {
 }
 
 Status RaftConsensus::CheckIsActiveLeaderAndHasLease() const {
-  return state_->CheckIsActiveLeaderAndHasLease();
+  Status s = state_->CheckIsActiveLeaderAndHasLease();
+  // See leader_status() about quiescent leaders.
+  if (s.IsLeaderHasNoLease() && peer_manager_->WakeQuiescentPeers()) {
+    return STATUS(LeaderNotReadyToServe, "Quiescent leader is renewing its lease.");
+  }
+  return s;
+}
+
+void RaftConsensus::ServersWentDown(const std::vector<std::string>& server_uuids) {
+  ReplicaState::UniqueLock lock;
+  if (!state_->LockForConfigChange(&lock).ok() || !follower_quiescent_) {
+    return;
+  }
+  const auto& leader_uuid = state_->GetLeaderUuidUnlocked();
+  if (std::find(server_uuids.begin(), server_uuids.end(), leader_uuid) == server_uuids.end()) {
+    return;
+  }
+  LOG_WITH_PREFIX_UNLOCKED(INFO) << "Server of quiescent leader " << leader_uuid
+                                 << " went down, resuming leader failure detection";
+  WARN_NOT_OK(EnsureFailureDetectorEnabledUnlocked(), "Failed to enable failure detector");
 }
 
 std::string RaftConsensus::GetRequestVoteLogPrefixUnlocked() const {
@@ -2370,6 +2510,11 @@ Consensus::LeaderStatus RaftConsensus::leader_status() const {
       return LeaderStatus::LEADER_BUT_NOT_READY;
 
     case LeaderLeaseStatus::NO_MAJORITY_REPLICATED_LEASE:
+      // The lease of a quiescent leader expires, since it does not heartbeat its followers. The
+      // client retries on the same server while the woken up leader replicates a new lease.
+      if (peer_manager_->WakeQuiescentPeers()) {
+        return LeaderStatus::LEADER_BUT_NOT_READY;
+      }
       // Will retry to look up the leader, because it might have changed.
       return LeaderStatus::NOT_LEADER;
 
@@ -2508,12 +2653,14 @@ ReplicaState* RaftConsensus::GetReplicaStateForTests() {
 }
 
 void RaftConsensus::ElectionCallback(const std::string& originator_uuid,
+                                     bool preelection,
                                      const ElectionResult& result) {
   // The election callback runs on a reactor thread, so we need to defer to our
   // threadpool. If the threadpool is already shut down for some reason, it's OK --
   // we're OK with the callback never running.
   WARN_NOT_OK(thread_pool_->SubmitClosure(
-              Bind(&RaftConsensus::DoElectionCallback, this, originator_uuid, result)),
+              Bind(&RaftConsensus::DoElectionCallback, this, originator_uuid, preelection,
+                   result)),
               state_->LogPrefixThreadSafe() + "Unable to run election callback");
 }
 
@@ -2565,6 +2712,7 @@ void RaftConsensus::NotifyOriginatorAboutLostElection(const std::string& origina
 }
 
 void RaftConsensus::DoElectionCallback(const std::string& originator_uuid,
+                                       bool preelection,
                                        const ElectionResult& result) {
   // Snooze to avoid the election timer firing again as much as possible.
   {
@@ -2581,7 +2729,8 @@ void RaftConsensus::DoElectionCallback(const std::string& originator_uuid,
                                                 ALLOW_LOGGING));
   }
   if (result.decision == VOTE_DENIED) {
-    LOG_WITH_PREFIX(INFO) << "Leader election lost for term " << result.election_term
+    LOG_WITH_PREFIX(INFO) << (preelection ? "Pre-election" : "Leader election")
+                             << " lost for term " << result.election_term
                              << ". Reason: "
                              << (!result.message.empty() ? result.message : "None given")
                              << ". Originator: " << originator_uuid;
@@ -2598,7 +2747,8 @@ void RaftConsensus::DoElectionCallback(const std::string& originator_uuid,
     return;
   }
 
-  if (result.election_term != state_->GetCurrentTermUnlocked()) {
+  // A pre-election is run for the term after the current one.
+  if (result.election_term != state_->GetCurrentTermUnlocked() + (preelection ? 1 : 0)) {
     LOG_WITH_PREFIX_UNLOCKED(INFO) << "Leader election decision for defunct term "
                                    << result.election_term << ": "
                                    << (result.decision == VOTE_GRANTED ? "won" : "lost");
@@ -2621,6 +2771,22 @@ void RaftConsensus::DoElectionCallback(const std::string& originator_uuid,
     return;
   }
 
+  if (preelection) {
+    LOG_WITH_PREFIX_UNLOCKED(INFO) << "Pre-election won for term " << result.election_term
+                                   << ", starting leader election";
+    scoped_refptr<LeaderElection> election;
+    s = CreateElectionUnlocked(NORMAL_ELECTION, /* preelection */ false, originator_uuid,
+                               &election);
+    lock.unlock();
+    if (!s.ok()) {
+      LOG_WITH_PREFIX(WARNING) << "Failed to start leader election: " << s.ToString();
+      return;
+    }
+    // Start the election outside the lock.
+    election->Run();
+    return;
+  }
+
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Leader election won for term " << result.election_term;
 
   if (result.old_leader_lease_expiration) {
@@ -2655,6 +2821,18 @@ Status RaftConsensus::GetLastOpId(OpIdType type, OpId* id) {
   return Status::OK();
 }
 
+Status RaftConsensus::ReadCommittedOps(int64_t after_op_index,
+                                       int max_size_bytes,
+                                       ReplicateMsgs* msgs,
+                                       OpId* committed_op_id) {
+  RETURN_NOT_OK(GetLastOpId(COMMITTED_OPID, committed_op_id));
+  if (after_op_index >= committed_op_id->index()) {
+    return Status::OK();
+  }
+  return queue_->ReadCommittedOps(
+      after_op_index, committed_op_id->index(), max_size_bytes, msgs);
+}
+
 void RaftConsensus::MarkDirty(std::shared_ptr<StateChangeContext> context) {
   LOG(INFO) << "Calling mark dirty synchronously for reason code " << context->reason;
   mark_dirty_clbk_.Run(context);
@@ -2714,6 +2892,7 @@ void RaftConsensus::NonTxRoundReplicationFinished(ConsensusRound* round,
 }
 
 Status RaftConsensus::EnsureFailureDetectorEnabledUnlocked() {
+  follower_quiescent_ = false;
   if (PREDICT_FALSE(!FLAGS_enable_leader_failure_detection)) {
     return Status::OK();
   }
@@ -2751,6 +2930,12 @@ Status RaftConsensus::SnoozeFailureDetectorUnlocked() {
 
 Status RaftConsensus::SnoozeFailureDetectorUnlocked(const MonoDelta& additional_delta,
                                                     AllowLogging allow_logging) {
+  // Any message that snoozes the failure detector wakes up a quiescent follower.
+  if (PREDICT_FALSE(follower_quiescent_)) {
+    VLOG_WITH_PREFIX_UNLOCKED(1) << "Waking up";
+    RETURN_NOT_OK(EnsureFailureDetectorEnabledUnlocked());
+  }
+
   if (PREDICT_FALSE(!FLAGS_enable_leader_failure_detection)) {
     return Status::OK();
   }
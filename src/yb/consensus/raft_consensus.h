@@ -216,6 +216,17 @@ class RaftConsensus : public Consensus,
 
   virtual CHECKED_STATUS GetLastOpId(OpIdType type, OpId* id) override;
 
+  CHECKED_STATUS ReadCommittedOps(int64_t after_op_index,
+                                  int max_size_bytes,
+                                  ReplicateMsgs* msgs,
+                                  OpId* committed_op_id) override;
+
+  HybridTime LeaderSafeTime() const override {
+    return HybridTime(leader_safe_time_.load(std::memory_order_acquire));
+  }
+
+  void ServersWentDown(const std::vector<std::string>& server_uuids) override;
+
  protected:
   // Trigger that a non-Operation ConsensusRound has finished replication.
   // If the replication was successful, an status will be OK. Otherwise, it
@@ -410,8 +421,17 @@ class RaftConsensus : public Consensus,
 
   // Callback for leader election driver. ElectionCallback is run on the
   // reactor thread, so it simply defers its work to DoElectionCallback.
-  void ElectionCallback(const std::string& originator_uuid, const ElectionResult& result);
-  void DoElectionCallback(const std::string& originator_uuid, const ElectionResult& result);
+  void ElectionCallback(const std::string& originator_uuid, bool preelection,
+                        const ElectionResult& result);
+  void DoElectionCallback(const std::string& originator_uuid, bool preelection,
+                          const ElectionResult& result);
+
+  // Prepares a leader election, or a pre-election that does not increment the term, to be run
+  // outside of the lock.
+  CHECKED_STATUS CreateElectionUnlocked(ElectionMode mode,
+                                        bool preelection,
+                                        const std::string& originator_uuid,
+                                        scoped_refptr<LeaderElection>* election);
   void NotifyOriginatorAboutLostElection(const std::string& originator_uuid);
 
   // Helper struct that tracks the RunLeaderElection as part of leadership transferral.
@@ -440,6 +460,10 @@ class RaftConsensus : public Consensus,
   // This is primarily intended to be used at startup time.
   CHECKED_STATUS ExpireFailureDetectorUnlocked();
 
+  // Whether the local peer should run an election right away when a new Raft group starts, i.e.
+  // it is the first voter of the config, the one picked by the master as the initial leader.
+  bool IsInitialLeaderCandidateUnlocked();
+
   // "Reset" the failure detector to indicate leader activity.
   // The failure detector must currently be enabled.
   // When this is called a failure is guaranteed not to be detected
@@ -527,6 +551,10 @@ class RaftConsensus : public Consensus,
   CHECKED_STATUS MarkOperationsAsCommittedUnlocked(const ConsensusRequestPB& request,
                                                    const LeaderRequest& deduped_req,
                                                    OpId last_from_leader);
+
+  // Advances leader_safe_time_ to the specified value, if it is higher.
+  void UpdateLeaderSafeTime(uint64_t safe_time);
+
   CHECKED_STATUS WaitWritesUnlocked(const LeaderRequest& deduped_req,
                                     Synchronizer* log_synchronizer);
 
@@ -564,6 +592,10 @@ class RaftConsensus : public Consensus,
   // after the new leader successful election.
   bool leader_no_op_committed_ = false;
 
+  // Whether this follower accepted a quiescing request from the leader, and stopped leader failure
+  // detection until the next request. See ConsensusRequestPB::quiesce.
+  bool follower_quiescent_ = false;
+
   // UUID of new desired leader during stepdown.
   TabletServerId protege_leader_uuid_;
 
@@ -571,6 +603,10 @@ class RaftConsensus : public Consensus,
   // on this peer.
   std::atomic<uint64_t> withhold_election_start_until_;
 
+  // Latest safe time propagated by the leader, such that this replica has received all operations
+  // up to the committed index sent along with it. HybridTime::kInvalid's value if not known yet.
+  std::atomic<uint64_t> leader_safe_time_{HybridTime::kInvalid.ToUint64()};
+
   // We record the moment at which we discover that an election has been lost by our "protege"
   // during leader stepdown. Then, when the master asks us to step down again in favor of the same
   // server, we'll reply with the amount of time that has passed to avoid leader stepdown loops.s
@@ -771,6 +771,7 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
 
   OpId prev_id = last_committed_index_;
 
+  operation_factory_->StartApplyBatch();
   while (iter != end_iter) {
     scoped_refptr<ConsensusRound> round = (*iter).second; // Make a copy.
     DCHECK(round);
@@ -824,6 +825,7 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
     prev_id.CopyFrom(round->id());
     round->NotifyReplicationFinished(Status::OK());
   }
+  operation_factory_->FinishApplyBatch();
 
   SetLastCommittedIndexUnlocked(committed_index);
 
@@ -11,6 +11,9 @@
 // under the License.
 //
 
+#include <lz4.h>
+#include <snappy.h>
+
 #include <regex>
 
 #include "yb/client/client.h"
@@ -21,6 +24,8 @@
 #include "yb/gutil/endian.h"
 #include "yb/gutil/strings/substitute.h"
 
+#include "yb/util/enums.h"
+
 namespace yb {
 namespace cqlserver {
 
@@ -164,11 +169,87 @@ Type LoadInt(const Slice& slice, size_t offset) {
   return static_cast<Type>(NetworkByteOrder::Load32(slice.data() + offset));
 }
 
+// Decompress the body of a request. LZ4 compressed body is prefixed with the 4-byte length of
+// the uncompressed body, as done by the Cassandra drivers.
+Status DecompressBody(
+    CQLMessage::CompressionScheme compression_scheme, const Slice& body, RefCntBuffer* result) {
+  switch (compression_scheme) {
+    case CQLMessage::CompressionScheme::LZ4: {
+      if (body.size() < CQLMessage::kIntSize) {
+        return STATUS(NetworkError, "Truncated CQL message");
+      }
+      const uint32_t length = NetworkByteOrder::Load32(body.data());
+      if (length > CQLMessage::kMaxMessageLength) {
+        return STATUS_SUBSTITUTE(NetworkError, "Uncompressed length $0 is too big", length);
+      }
+      *result = RefCntBuffer(length);
+      const int decompressed = LZ4_decompress_safe(
+          to_char_ptr(body.data() + CQLMessage::kIntSize), result->data(),
+          body.size() - CQLMessage::kIntSize, length);
+      if (decompressed < 0 || static_cast<uint32_t>(decompressed) != length) {
+        return STATUS(Corruption, "Error decompressing LZ4 compressed CQL message");
+      }
+      return Status::OK();
+    }
+    case CQLMessage::CompressionScheme::SNAPPY: {
+      size_t length = 0;
+      if (!snappy::GetUncompressedLength(to_char_ptr(body.data()), body.size(), &length)) {
+        return STATUS(Corruption, "Error decompressing Snappy compressed CQL message");
+      }
+      if (length > CQLMessage::kMaxMessageLength) {
+        return STATUS_SUBSTITUTE(NetworkError, "Uncompressed length $0 is too big", length);
+      }
+      *result = RefCntBuffer(length);
+      if (!snappy::RawUncompress(to_char_ptr(body.data()), body.size(), result->data())) {
+        return STATUS(Corruption, "Error decompressing Snappy compressed CQL message");
+      }
+      return Status::OK();
+    }
+    case CQLMessage::CompressionScheme::NONE:
+      return STATUS(NetworkError, "Compressed CQL message while compression is not negotiated");
+  }
+  FATAL_INVALID_ENUM_VALUE(CQLMessage::CompressionScheme, compression_scheme);
+}
+
+// Compress the body, that starts at body_start of mesg, in place.
+void CompressBody(
+    CQLMessage::CompressionScheme compression_scheme, size_t body_start, faststring* mesg) {
+  const size_t length = mesg->size() - body_start;
+  faststring compressed;
+  switch (compression_scheme) {
+    case CQLMessage::CompressionScheme::LZ4: {
+      compressed.resize(CQLMessage::kIntSize + LZ4_compressBound(length));
+      NetworkByteOrder::Store32(compressed.data(), static_cast<uint32_t>(length));
+      const int size = LZ4_compress_default(
+          to_char_ptr(mesg->data() + body_start),
+          reinterpret_cast<char*>(compressed.data() + CQLMessage::kIntSize),
+          length, compressed.size() - CQLMessage::kIntSize);
+      CHECK_GT(size, 0) << "LZ4 compression failed";
+      compressed.resize(CQLMessage::kIntSize + size);
+      break;
+    }
+    case CQLMessage::CompressionScheme::SNAPPY: {
+      compressed.resize(snappy::MaxCompressedLength(length));
+      size_t size = 0;
+      snappy::RawCompress(
+          to_char_ptr(mesg->data() + body_start), length,
+          reinterpret_cast<char*>(compressed.data()), &size);
+      compressed.resize(size);
+      break;
+    }
+    case CQLMessage::CompressionScheme::NONE:
+      return;
+  }
+  mesg->resize(body_start);
+  mesg->append(compressed.data(), compressed.size());
+}
+
 } // namespace
 
 // ------------------------------------ CQL request -----------------------------------
 bool CQLRequest::ParseRequest(
-  const Slice& mesg, unique_ptr<CQLRequest>* request, unique_ptr<CQLResponse>* error_response) {
+  const Slice& mesg, const CompressionScheme compression_scheme,
+  unique_ptr<CQLRequest>* request, unique_ptr<CQLResponse>* error_response) {
 
   *request = nullptr;
   *error_response = nullptr;
@@ -211,10 +292,23 @@ bool CQLRequest::ParseRequest(
     return false;
   }
 
-  const Slice body =
+  Slice body =
       (mesg.size() == kMessageHeaderLength) ?
       Slice() : Slice(&mesg[kMessageHeaderLength], mesg.size() - kMessageHeaderLength);
 
+  RefCntBuffer decompressed_body;
+  if (header.flags & kCompressionFlag) {
+    const Status status = DecompressBody(compression_scheme, body, &decompressed_body);
+    if (!status.ok()) {
+      error_response->reset(
+          new ErrorResponse(
+              header.stream_id, ErrorResponse::Code::PROTOCOL_ERROR,
+              status.message().ToString()));
+      return false;
+    }
+    body = Slice(decompressed_body.udata(), decompressed_body.size());
+  }
+
   // Construct the skeleton request by the opcode
   switch (header.opcode) {
     case Opcode::STARTUP:
@@ -265,6 +359,7 @@ bool CQLRequest::ParseRequest(
             header.stream_id, ErrorResponse::Code::PROTOCOL_ERROR, "Unknown opcode"));
     return false;
   }
+  request->get()->decompressed_body_ = std::move(decompressed_body);
 
   // Parse the request body
   const Status status = request->get()->ParseBody();
@@ -474,6 +569,21 @@ Status StartupRequest::ParseBody() {
   return ParseStringMap(&options_);
 }
 
+CQLMessage::CompressionScheme StartupRequest::compression_scheme() const {
+  const auto it = options_.find("COMPRESSION");
+  if (it == options_.end()) {
+    return CompressionScheme::NONE;
+  }
+  if (it->second == "lz4") {
+    return CompressionScheme::LZ4;
+  }
+  if (it->second == "snappy") {
+    return CompressionScheme::SNAPPY;
+  }
+  // Unsupported compression is rejected by Execute().
+  return CompressionScheme::NONE;
+}
+
 CQLResponse* StartupRequest::Execute() const {
   for (const auto& option : options_) {
     const auto& name = option.first;
@@ -723,18 +833,43 @@ CQLResponse::~CQLResponse() {
 #define SERIALIZE_LONG(buf, pos, value) \
   NetworkByteOrder::Store64(&(buf)[pos], static_cast<int64_t>(value))
 
-void CQLResponse::Serialize(faststring* mesg) const {
+void CQLResponse::Serialize(const CompressionScheme compression_scheme, faststring* mesg) const {
   const size_t start_pos = mesg->size(); // save the start position
   SerializeHeader(mesg);
   SerializeBody(mesg);
+  const Slice trailer = BodyTrailer();
+  mesg->append(trailer.data(), trailer.size());
+  // Empty bodies are not worth compressing, the compression flag tells the client whether this
+  // particular frame is compressed.
+  const size_t body_start = start_pos + kMessageHeaderLength;
+  if (compression_scheme != CompressionScheme::NONE && mesg->size() > body_start) {
+    CompressBody(compression_scheme, body_start, mesg);
+    SERIALIZE_BYTE(mesg->data(), start_pos + kHeaderPosFlags, flags() | kCompressionFlag);
+  }
   SERIALIZE_INT(
       mesg->data(), start_pos + kHeaderPosLength, mesg->size() - start_pos - kMessageHeaderLength);
 }
 
+void CQLResponse::Serialize(const CompressionScheme compression_scheme, faststring* mesg,
+                            RefCntBuffer* trailer) const {
+  // A compressed body can only be sent in whole.
+  const Slice body_trailer = BodyTrailer();
+  if (compression_scheme != CompressionScheme::NONE || body_trailer.empty()) {
+    return Serialize(compression_scheme, mesg);
+  }
+  const size_t start_pos = mesg->size(); // save the start position
+  SerializeHeader(mesg);
+  SerializeBody(mesg);
+  *trailer = RefCntBuffer(body_trailer.data(), body_trailer.size());
+  SERIALIZE_INT(
+      mesg->data(), start_pos + kHeaderPosLength,
+      mesg->size() + trailer->size() - start_pos - kMessageHeaderLength);
+}
+
 void CQLResponse::SerializeHeader(faststring* mesg) const {
   uint8_t buffer[kMessageHeaderLength];
   SERIALIZE_BYTE(buffer, kHeaderPosVersion, version());
-  SERIALIZE_BYTE(buffer, kHeaderPosFlags, flags());
+  SERIALIZE_BYTE(buffer, kHeaderPosFlags, flags() & ~kCompressionFlag);
   SERIALIZE_SHORT(buffer, kHeaderPosStreamId, stream_id());
   SERIALIZE_INT(buffer, kHeaderPosLength, 0);
   SERIALIZE_BYTE(buffer, kHeaderPosOpcode, opcode());
@@ -973,7 +1108,7 @@ void AuthenticateResponse::SerializeBody(faststring* mesg) const {
 
 //----------------------------------------------------------------------------------------
 const unordered_map<string, vector<string>> SupportedResponse::options_ = {
-  {"COMPRESSION", { } },
+  {"COMPRESSION", {"lz4", "snappy"} },
   {"CQL_VERSION", {"3.0.0" /* minimum */, "3.4.2" /* current */} }
 };
 
@@ -1432,7 +1567,10 @@ void RowsResultResponse::SerializeResultBody(faststring* mesg) const {
   SerializeRowsMetadata(
       RowsMetadata(result_->table_name(), result_->column_schemas(),
                    result_->paging_state(), skip_metadata_), mesg);
-  mesg->append(result_->rows_data());
+}
+
+Slice RowsResultResponse::BodyTrailer() const {
+  return Slice(result_->rows_data());
 }
 
 //----------------------------------------------------------------------------------------
@@ -1518,12 +1656,13 @@ SchemaChangeResultResponse::SchemaChangeResultResponse(
 SchemaChangeResultResponse::~SchemaChangeResultResponse() {
 }
 
-void SchemaChangeResultResponse::Serialize(faststring* mesg) const {
-  ResultResponse::Serialize(mesg);
+void SchemaChangeResultResponse::Serialize(
+    const CompressionScheme compression_scheme, faststring* mesg) const {
+  ResultResponse::Serialize(compression_scheme, mesg);
   // TODO: Replace this hack that piggybacks a SCHEMA_CHANGE event along a SCHEMA_CHANGE result
   // response with a formal event notification mechanism.
   SchemaChangeEventResponse event(change_type_, target_, keyspace_, object_, argument_types_);
-  event.Serialize(mesg);
+  event.Serialize(compression_scheme, mesg);
 }
 
 void SchemaChangeResultResponse::SerializeResultBody(faststring* mesg) const {
@@ -1655,8 +1794,9 @@ void AuthSuccessResponse::SerializeBody(faststring* mesg) const {
 CQLServerEvent::CQLServerEvent(std::unique_ptr<EventResponse> event_response)
     : event_response_(std::move(event_response)) {
   CHECK_NOTNULL(event_response_.get());
+  // The same event is sent to all connections, so it is not compressed.
   faststring temp;
-  event_response_->Serialize(&temp);
+  event_response_->Serialize(CQLMessage::CompressionScheme::NONE, &temp);
   serialized_response_ = RefCntBuffer(temp);
 }
 
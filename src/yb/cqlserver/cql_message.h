@@ -29,6 +29,7 @@
 #include "yb/rpc/server_event.h"
 #include "yb/ql/util/statement_params.h"
 #include "yb/ql/util/statement_result.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/slice.h"
 #include "yb/util/status.h"
 #include "yb/util/net/sockaddr.h"
@@ -79,6 +80,13 @@ class CQLMessage {
   static constexpr Flags kCustomPayloadFlag = 0x04; // Since V4
   static constexpr Flags kWarningFlag       = 0x08; // Since V4
 
+  // Compression of frame bodies, negotiated by the COMPRESSION option of STARTUP request.
+  enum class CompressionScheme : uint8_t {
+    NONE   = 0,
+    LZ4    = 1,
+    SNAPPY = 2
+  };
+
   using StreamId = uint16_t;
   static constexpr StreamId kEventStreamId = 0xffff; // Special stream id for events.
 
@@ -216,10 +224,11 @@ class CQLRequest : public CQLMessage {
  public:
   // "Factory" function to parse a CQL serlized request message and construct a request object.
   // Return true iff a request is parsed successfully without error. If an error occurs, an error
-  // response will be returned instead and it should be sent back to the CQL client.
+  // response will be returned instead and it should be sent back to the CQL client. Compressed
+  // request body is decompressed using compression scheme negotiated for the connection.
   static bool ParseRequest(
-      const Slice& mesg, std::unique_ptr<CQLRequest>* request,
-      std::unique_ptr<CQLResponse>* error_response);
+      const Slice& mesg, CompressionScheme compression_scheme,
+      std::unique_ptr<CQLRequest>* request, std::unique_ptr<CQLResponse>* error_response);
 
   static StreamId ParseStreamId(const Slice& mesg) {
     return static_cast<StreamId>(NetworkByteOrder::Load16(mesg.data() + kHeaderPosStreamId));
@@ -304,6 +313,9 @@ class CQLRequest : public CQLMessage {
 
  private:
   Slice body_;
+
+  // Decompressed body of compressed request, body_ points into it.
+  RefCntBuffer decompressed_body_;
 };
 
 // ------------------------------ Individual CQL requests -----------------------------------
@@ -313,6 +325,9 @@ class StartupRequest : public CQLRequest {
   virtual ~StartupRequest() override;
   virtual CQLResponse* Execute() const override;
 
+  // Compression scheme requested by the COMPRESSION option, NONE when it is not specified.
+  CompressionScheme compression_scheme() const;
+
  protected:
   virtual CHECKED_STATUS ParseBody() override;
 
@@ -464,7 +479,15 @@ class RegisterRequest : public CQLRequest {
 // ------------------------------------ CQL response -----------------------------------
 class CQLResponse : public CQLMessage {
  public:
-  virtual void Serialize(faststring* mesg) const;
+  // Serialize the response, its body is compressed using the given compression scheme.
+  virtual void Serialize(CompressionScheme compression_scheme, faststring* mesg) const;
+
+  // Serialize the response like above, except that the trailer of an uncompressed body (the rows
+  // data of a ROWS result) is not appended to the message but returned separately in "trailer" to
+  // be sent right after the message.
+  void Serialize(CompressionScheme compression_scheme, faststring* mesg,
+                 RefCntBuffer* trailer) const;
+
   virtual ~CQLResponse();
  protected:
   CQLResponse(const CQLRequest& request, Opcode opcode);
@@ -473,6 +496,9 @@ class CQLResponse : public CQLMessage {
 
   // Function to serialize a response body that all CQLResponse subclasses need to implement
   virtual void SerializeBody(faststring* mesg) const = 0;
+
+  // Trailing part of the body that follows what SerializeBody() writes. Empty by default.
+  virtual Slice BodyTrailer() const { return Slice(); }
 };
 
 // ------------------------------ Individual CQL responses -----------------------------------
@@ -735,6 +761,9 @@ class RowsResultResponse : public ResultResponse {
  protected:
   virtual void SerializeResultBody(faststring* mesg) const override;
 
+  // The rows data, already encoded in CQL wire format by the tablet servers, is the trailer.
+  virtual Slice BodyTrailer() const override;
+
  private:
   const ql::RowsResult::SharedPtr result_;
   const bool skip_metadata_;
@@ -791,7 +820,7 @@ class SchemaChangeResultResponse : public ResultResponse {
   SchemaChangeResultResponse(const CQLRequest& request, const ql::SchemaChangeResult& result);
   virtual ~SchemaChangeResultResponse() override;
 
-  void Serialize(faststring* mesg) const override;
+  void Serialize(CompressionScheme compression_scheme, faststring* mesg) const override;
 
  protected:
   virtual void SerializeResultBody(faststring* mesg) const override;
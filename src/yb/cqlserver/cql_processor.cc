@@ -19,7 +19,10 @@
 #include <sasl/md5.h>
 
 #include "yb/cqlserver/cql_service.h"
+#include "yb/cqlserver/cql_slow_query_log.h"
 #include "yb/gutil/strings/escaping.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/walltime.h"
 #include "yb/rpc/rpc_context.h"
 #include "yb/util/crypt.h"
 
@@ -64,6 +67,7 @@ extern const char* const kRoleColumnNameSaltedHash;
 
 using std::shared_ptr;
 using std::unique_ptr;
+using strings::Substitute;
 
 using client::YBClient;
 using client::YBSession;
@@ -125,8 +129,12 @@ void CQLProcessor::ProcessCall(rpc::InboundCallPtr call) {
   unique_ptr<CQLResponse> response;
 
   // Parse the CQL request. If the parser failed, it sets the error message in response.
+  start_time_us_ = GetCurrentTimeMicros();
   parse_begin_ = MonoTime::Now(MonoTime::FINE);
-  if (!CQLRequest::ParseRequest(call_->serialized_request(), &request, &response)) {
+  ResetExecutionStats();
+  if (!CQLRequest::ParseRequest(call_->serialized_request(),
+                                call_->connection_context().compression_scheme(),
+                                &request, &response)) {
     cql_metrics_->num_errors_parsing_cql_->Increment();
     SendResponse(*response);
     service_impl_->ReturnProcessor(pos_);
@@ -153,9 +161,16 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   // Serialize the response to return to the CQL client. In case of error, an error response
   // should still be present.
   MonoTime response_begin = MonoTime::Now(MonoTime::FINE);
+  // Response to STARTUP is not compressed, the negotiated compression applies to the messages
+  // that follow it.
+  const auto compression_scheme =
+      request_ != nullptr && request_->opcode() == CQLMessage::Opcode::STARTUP
+          ? CQLMessage::CompressionScheme::NONE
+          : call_->connection_context().compression_scheme();
   faststring msg;
-  response.Serialize(&msg);
-  call_->RespondSuccess(RefCntBuffer(msg), cql_metrics_->rpc_method_metrics_);
+  RefCntBuffer trailer;
+  response.Serialize(compression_scheme, &msg, &trailer);
+  call_->RespondSuccess(RefCntBuffer(msg), trailer, cql_metrics_->rpc_method_metrics_);
 
   MonoTime response_done = MonoTime::Now(MonoTime::FINE);
   cql_metrics_->time_to_process_request_->Increment(
@@ -166,6 +181,9 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   }
   cql_metrics_->time_to_queue_cql_response_->Increment(
       response_done.GetDeltaSince(response_begin).ToMicroseconds());
+  if (request_ != nullptr) {
+    RecordSlowQuery(response_begin, response_done);
+  }
 
   // Release the processor.
   call_ = nullptr;
@@ -176,6 +194,59 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   Return();
 }
 
+void CQLProcessor::RecordSlowQuery(const MonoTime& response_begin, const MonoTime& response_done) {
+  switch (request_->opcode()) {
+    case CQLMessage::Opcode::EXECUTE:
+    case CQLMessage::Opcode::QUERY:
+    case CQLMessage::Opcode::BATCH:
+      break;
+    default:
+      return;
+  }
+  CQLSlowQueryLog* const slow_query_log = service_impl_->slow_query_log();
+  CQLSlowQuery query;
+  query.total_time = response_done.GetDeltaSince(parse_begin_);
+  if (!slow_query_log->ShouldRecord(query.total_time, &query.sampled)) {
+    return;
+  }
+  query.start_time_us = start_time_us_;
+  query.keyspace = ql_env_.CurrentKeyspace();
+  query.query = QueryText();
+  query.decode_time = execute_begin_.GetDeltaSince(parse_begin_);
+  query.respond_time = response_done.GetDeltaSince(response_begin);
+  query.stats = execution_stats();
+  slow_query_log->Record(std::move(query));
+}
+
+std::string CQLProcessor::QueryText() const {
+  switch (request_->opcode()) {
+    case CQLMessage::Opcode::QUERY:
+      return static_cast<const QueryRequest&>(*request_).query();
+    case CQLMessage::Opcode::EXECUTE:
+      if (!stmts_.empty()) {
+        return (*stmts_.begin())->text();
+      }
+      return "EXECUTE " + b2a_hex(static_cast<const ExecuteRequest&>(*request_).query_id());
+    case CQLMessage::Opcode::BATCH: {
+      const auto& queries = static_cast<const BatchRequest&>(*request_).queries();
+      std::string text = Substitute("BATCH of $0 statements", queries.size());
+      if (!queries.empty()) {
+        const auto& query = queries.front();
+        const auto stmt = query.is_prepared
+            ? service_impl_->GetPreparedStatement(query.query_id) : nullptr;
+        if (!query.is_prepared) {
+          text += ", first: " + query.query;
+        } else if (stmt != nullptr) {
+          text += ", first: " + stmt->text();
+        }
+      }
+      return text;
+    }
+    default:
+      return std::string();
+  }
+}
+
 CQLResponse* CQLProcessor::ProcessRequest(const CQLRequest& req) {
   switch (req.opcode()) {
     case CQLMessage::Opcode::PREPARE:
@@ -188,6 +259,8 @@ CQLResponse* CQLProcessor::ProcessRequest(const CQLRequest& req) {
       return ProcessBatch(static_cast<const BatchRequest&>(req));
     case CQLMessage::Opcode::AUTH_RESPONSE:
       return ProcessAuthResponse(static_cast<const AuthResponseRequest&>(req));
+    case CQLMessage::Opcode::STARTUP:
+      return ProcessStartup(static_cast<const StartupRequest&>(req));
     default:
       return req.Execute();
   }
@@ -285,6 +358,14 @@ CQLResponse* CQLProcessor::ProcessBatch(const BatchRequest& req) {
   return nullptr;
 }
 
+CQLResponse* CQLProcessor::ProcessStartup(const StartupRequest& req) {
+  CQLResponse* response = req.Execute();
+  if (response->opcode() != CQLMessage::Opcode::ERROR) {
+    call_->connection_context().set_compression_scheme(req.compression_scheme());
+  }
+  return response;
+}
+
 CQLResponse* CQLProcessor::ProcessAuthResponse(const AuthResponseRequest& req) {
   const auto& params = req.params();
   shared_ptr<Statement> stmt = service_impl_->GetAuthPreparedStatement();
@@ -68,12 +68,13 @@ class CQLProcessor : public ql::QLProcessor {
   // Process a CQL request.
   CQLResponse* ProcessRequest(const CQLRequest& req);
 
-  // Process a PREPARE, EXECUTE, QUERY, BATCH or AUTH_RESPONSE request.
+  // Process a PREPARE, EXECUTE, QUERY, BATCH, AUTH_RESPONSE or STARTUP request.
   CQLResponse* ProcessPrepare(const PrepareRequest& req);
   CQLResponse* ProcessExecute(const ExecuteRequest& req);
   CQLResponse* ProcessQuery(const QueryRequest& req);
   CQLResponse* ProcessBatch(const BatchRequest& req);
   CQLResponse* ProcessAuthResponse(const AuthResponseRequest& req);
+  CQLResponse* ProcessStartup(const StartupRequest& req);
 
   // Get a prepared statement and adds it to the set of statements currently being executed.
   std::shared_ptr<const CQLStatement> GetPreparedStatement(const CQLMessage::QueryId& id);
@@ -87,6 +88,12 @@ class CQLProcessor : public ql::QLProcessor {
   // Send response back to client.
   void SendResponse(const CQLResponse& response);
 
+  // Record the current request in the slow query log if it was slow or is sampled.
+  void RecordSlowQuery(const MonoTime& response_begin, const MonoTime& response_done);
+
+  // Return the text of the query, prepared statement or batch of the current request.
+  std::string QueryText() const;
+
   // Return Processor back to Service.
   void Return();
 
@@ -113,7 +120,8 @@ class CQLProcessor : public ql::QLProcessor {
   // Unprepared query id being executed.
   CQLMessage::QueryId unprepared_id_;
 
-  // Parse and execute begin times.
+  // Wall clock time at which the request was received, and parse and execute begin times.
+  int64_t start_time_us_ = 0;
   MonoTime parse_begin_;
   MonoTime execute_begin_;
 
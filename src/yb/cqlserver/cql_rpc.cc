@@ -24,6 +24,7 @@
 #include "yb/rpc/rpc_introspection.pb.h"
 
 #include "yb/util/debug/trace_event.h"
+#include "yb/util/object_pool.h"
 #include "yb/util/size_literals.h"
 
 using yb::cqlserver::CQLMessage;
@@ -90,7 +91,7 @@ Status CQLConnectionContext::HandleInboundCall(const rpc::ConnectionPtr& connect
   auto reactor = connection->reactor();
   DCHECK(reactor->IsCurrentThread());
 
-  auto call = std::make_shared<CQLInboundCall>(connection,
+  auto call = MakePooledShared<CQLInboundCall>(connection,
       call_processed_listener(),
       ql_session_);
 
@@ -135,8 +136,7 @@ Status CQLInboundCall::ParseFrom(Slice source) {
   TRACE_EVENT0("rpc", "CQLInboundCall::ParseFrom");
 
   // Parsing of CQL message is deferred to CQLServiceImpl::Handle. Just save the serialized data.
-  request_data_.assign(source.data(), source.end());
-  serialized_request_ = Slice(request_data_.data(), request_data_.size());
+  serialized_request_ = StoreRequestData(source);
 
   // Fill the service name method name to transfer the call to. The method name is for debug
   // tracing only. Inside CQLServiceImpl::Handle, we rely on the opcode to dispatch the execution.
@@ -145,6 +145,10 @@ Status CQLInboundCall::ParseFrom(Slice source) {
   return Status::OK();
 }
 
+CQLConnectionContext& CQLInboundCall::connection_context() const {
+  return static_cast<CQLConnectionContext&>(connection()->context());
+}
+
 const std::string& CQLInboundCall::service_name() const {
   static std::string result = "yb.cqlserver.CQLServerService"s;
   return result;
@@ -160,16 +164,20 @@ void CQLInboundCall::Serialize(std::deque<RefCntBuffer>* output) const {
   CHECK_GT(response_msg_buf_.size(), 0);
 
   output->push_back(response_msg_buf_);
+  if (response_trailer_buf_) {
+    output->push_back(response_trailer_buf_);
+  }
 }
 
 void CQLInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code,
                                     const Status& status) {
   faststring msg;
+  const auto compression_scheme = connection_context().compression_scheme();
   switch (error_code) {
     case rpc::ErrorStatusPB::ERROR_SERVER_TOO_BUSY: {
       // Return OVERLOADED error to redirect CQL client to the next host.
       ErrorResponse(stream_id_, ErrorResponse::Code::OVERLOADED, "CQL service queue full")
-          .Serialize(&msg);
+          .Serialize(compression_scheme, &msg);
       break;
     }
     case rpc::ErrorStatusPB::ERROR_APPLICATION: FALLTHROUGH_INTENDED;
@@ -185,7 +193,7 @@ void CQLInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_cod
       LOG(ERROR) << "Unexpected error status: "
                  << rpc::ErrorStatusPB::RpcErrorCodePB_Name(error_code);
       ErrorResponse(stream_id_, ErrorResponse::Code::SERVER_ERROR, "Server error")
-          .Serialize(&msg);
+          .Serialize(compression_scheme, &msg);
       break;
     }
   }
@@ -202,6 +210,12 @@ void CQLInboundCall::RespondSuccess(const RefCntBuffer& buffer,
   QueueResponse(true);
 }
 
+void CQLInboundCall::RespondSuccess(const RefCntBuffer& buffer, const RefCntBuffer& trailer,
+                                    const yb::rpc::RpcMethodMetrics& metrics) {
+  response_trailer_buf_ = trailer;
+  RespondSuccess(buffer, metrics);
+}
+
 void CQLInboundCall::GetCallDetails(rpc::RpcCallInProgressPB *call_in_progress_pb) {
   std::shared_ptr<const CQLRequest> request =
 #ifdef THREAD_SANITIZER
@@ -280,7 +294,7 @@ void CQLInboundCall::LogTrace() const {
 
   if (PREDICT_FALSE(FLAGS_rpc_dump_all_traces || total_time > FLAGS_rpc_slow_query_threshold_ms)) {
     LOG(INFO) << ToString() << " took " << total_time << "ms. Trace:";
-    trace_->Dump(&LOG(INFO), true);
+    DumpTrace(&LOG(INFO));
   }
 }
 
@@ -304,9 +318,10 @@ MonoTime CQLInboundCall::GetClientDeadline() const {
   return MonoTime::Max();
 }
 
-void CQLInboundCall::RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time) {
+void CQLInboundCall::RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time,
+                                           scoped_refptr<Histogram> class_queue_time) {
   if (resume_from_ == nullptr) {
-    InboundCall::RecordHandlingStarted(incoming_queue_time);
+    InboundCall::RecordHandlingStarted(incoming_queue_time, class_queue_time);
   }
 }
 
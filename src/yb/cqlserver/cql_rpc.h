@@ -37,6 +37,15 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
   void DumpPB(const rpc::DumpRunningRpcsRequestPB& req,
               rpc::RpcConnectionPB* resp) override;
 
+  // Compression scheme negotiated by STARTUP request of this connection.
+  CQLMessage::CompressionScheme compression_scheme() const {
+    return compression_scheme_.load(std::memory_order_acquire);
+  }
+
+  void set_compression_scheme(CQLMessage::CompressionScheme compression_scheme) {
+    compression_scheme_.store(compression_scheme, std::memory_order_release);
+  }
+
  private:
   uint64_t ExtractCallId(rpc::InboundCall* call) override;
   void RunNegotiation(rpc::ConnectionPtr connection, const MonoTime& deadline) override;
@@ -54,6 +63,9 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
   // Cassandra ROLE), consider adding a CreateNewConnection method in rpc::ServiceIf so that
   // CQLConnection can be created and returned from CQLServiceImpl.CreateNewConnection().
   ql::QLSession::SharedPtr ql_session_;
+
+  std::atomic<CQLMessage::CompressionScheme> compression_scheme_{
+      CQLMessage::CompressionScheme::NONE};
 };
 
 class CQLInboundCall : public rpc::InboundCall {
@@ -92,10 +104,15 @@ class CQLInboundCall : public rpc::InboundCall {
 
   uint16_t stream_id() const { return stream_id_; }
 
+  CQLConnectionContext& connection_context() const;
+
   const std::string& service_name() const override;
   const std::string& method_name() const override;
   void RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code, const Status& status) override;
   void RespondSuccess(const RefCntBuffer& buffer, const yb::rpc::RpcMethodMetrics& metrics);
+  // Respond with the message in "buffer" followed by the rest of its body in "trailer".
+  void RespondSuccess(const RefCntBuffer& buffer, const RefCntBuffer& trailer,
+                      const yb::rpc::RpcMethodMetrics& metrics);
   void GetCallDetails(rpc::RpcCallInProgressPB *call_in_progress_pb);
   void SetRequest(std::shared_ptr<const CQLRequest> request, CQLServiceImpl* service_impl) {
     service_impl_ = service_impl;
@@ -107,10 +124,13 @@ class CQLInboundCall : public rpc::InboundCall {
   }
 
  private:
-  void RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time) override;
+  void RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time,
+                             scoped_refptr<Histogram> class_queue_time) override;
 
   Callback<void(void)>* resume_from_ = nullptr;
   RefCntBuffer response_msg_buf_;
+  // Trailing part of the response message body, if it is not copied into response_msg_buf_.
+  RefCntBuffer response_trailer_buf_;
   ql::QLSession::SharedPtr ql_session_;
   uint16_t stream_id_;
   std::shared_ptr<const CQLRequest> request_;
@@ -18,6 +18,7 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/cqlserver/cql_service.h"
 #include "yb/rpc/messenger.h"
+#include "yb/server/webserver.h"
 
 using yb::rpc::ServiceIf;
 
@@ -55,6 +56,13 @@ Status CQLServer::Start() {
   std::unique_ptr<ServiceIf> cql_service(new CQLServiceImpl(this, opts_));
   RETURN_NOT_OK(RegisterService(FLAGS_cql_service_queue_length, std::move(cql_service)));
 
+  web_server_->RegisterPathHandler(
+      "/slow-queries", "Slow Queries",
+      [this](const Webserver::WebRequest& req, std::stringstream* output) {
+        slow_query_log_.HtmlOutput(output);
+      },
+      true /* is_styled */, true /* is_on_nav_bar */);
+
   RETURN_NOT_OK(server::RpcAndWebServerBase::Start());
 
   // Start the CQL node list refresh timer.
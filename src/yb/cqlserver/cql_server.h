@@ -22,6 +22,7 @@
 
 #include "yb/cqlserver/cql_server_options.h"
 #include "yb/cqlserver/cql_message.h"
+#include "yb/cqlserver/cql_slow_query_log.h"
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/macros.h"
 #include "yb/server/server_base.h"
@@ -54,12 +55,15 @@ class CQLServer : public server::RpcAndWebServerBase {
 
   const tserver::TabletServer* tserver() const { return tserver_; }
 
+  CQLSlowQueryLog* slow_query_log() { return &slow_query_log_; }
+
  private:
   CQLServerOptions opts_;
   void CQLNodeListRefresh(const boost::system::error_code &e);
   void RescheduleTimer();
   boost::asio::deadline_timer timer_;
   const tserver::TabletServer* const tserver_;
+  CQLSlowQueryLog slow_query_log_;
 
   std::unique_ptr<CQLServerEvent> BuildTopologyChangeEvent(const std::string& event_type,
                                                            const Endpoint& addr);
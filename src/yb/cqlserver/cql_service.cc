@@ -16,6 +16,8 @@
 #include <mutex>
 #include <thread>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include "yb/gutil/strings/join.h"
 
 #include "yb/cqlserver/cql_processor.h"
@@ -34,7 +36,10 @@ DEFINE_int64(cql_service_max_prepared_statement_size_bytes, 0,
              "statements. 0 or negative means unlimited.");
 DEFINE_int32(cql_ybclient_reactor_threads, 24,
              "The number of reactor threads to be used for processing ybclient "
-             "requests originating in the cql layer");
+             "requests originating in the cql layer, when it does not use the messenger of the "
+             "tablet server, see ybclient_use_server_messenger");
+
+DECLARE_bool(ybclient_use_server_messenger);
 
 namespace yb {
 namespace cqlserver {
@@ -58,7 +63,9 @@ CQLServiceImpl::CQLServiceImpl(CQLServer* server, const CQLServerOptions& opts)
       async_client_init_(
           "cql_ybclient", FLAGS_cql_ybclient_reactor_threads, kRpcTimeoutSec,
           server->tserver() ? server->tserver()->permanent_uuid() : "",
-          &opts, server->metric_entity()),
+          &opts, server->metric_entity(),
+          server->tserver() && FLAGS_ybclient_use_server_messenger
+              ? server->tserver()->messenger() : nullptr),
       next_available_processor_(processors_.end()),
       messenger_(server->messenger()),
       cql_rpcserver_env_(new CQLRpcServerEnv(server->first_rpc_address().address().to_string(),
@@ -105,6 +112,10 @@ const std::shared_ptr<client::YBMetaDataCache>& CQLServiceImpl::metadata_cache()
   return metadata_cache_;
 }
 
+CQLSlowQueryLog* CQLServiceImpl::slow_query_log() {
+  return server_->slow_query_log();
+}
+
 void CQLServiceImpl::Shutdown() {
   async_client_init_.Shutdown();
 }
@@ -156,7 +167,7 @@ void CQLServiceImpl::ReturnProcessor(const CQLProcessorListPos& pos) {
 shared_ptr<CQLStatement> CQLServiceImpl::AllocatePreparedStatement(
     const CQLMessage::QueryId& query_id, const string& keyspace, const string& ql_stmt) {
   // Get exclusive lock before allocating a prepared statement and updating the LRU list.
-  std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
+  std::lock_guard<percpu_rwlock> guard(prepared_stmts_lock_);
 
   shared_ptr<CQLStatement> stmt;
   const auto itr = prepared_stmts_map_.find(query_id);
@@ -171,7 +182,7 @@ shared_ptr<CQLStatement> CQLServiceImpl::AllocatePreparedStatement(
   } else {
     // Return existing statement if found.
     stmt = itr->second;
-    MoveLruPreparedStatementUnlocked(stmt);
+    stmt->set_referenced();
   }
 
   VLOG(1) << "InsertPreparedStatement: CQL prepared statement cache count = "
@@ -183,33 +194,35 @@ shared_ptr<CQLStatement> CQLServiceImpl::AllocatePreparedStatement(
 
 shared_ptr<const CQLStatement> CQLServiceImpl::GetPreparedStatement(
     const CQLMessage::QueryId& query_id) {
-  // Get exclusive lock before looking up a prepared statement and updating the LRU list.
-  std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
+  shared_ptr<CQLStatement> stmt;
+  {
+    // Get shared lock before looking up a prepared statement. The LRU list is not updated here.
+    boost::shared_lock<rw_spinlock> guard(prepared_stmts_lock_.get_lock());
 
-  const auto itr = prepared_stmts_map_.find(query_id);
-  if (itr == prepared_stmts_map_.end()) {
-    return nullptr;
+    const auto itr = prepared_stmts_map_.find(query_id);
+    if (itr == prepared_stmts_map_.end()) {
+      return nullptr;
+    }
+    stmt = itr->second;
   }
 
-  shared_ptr<CQLStatement> stmt = itr->second;
-
   // If the statement has not finished preparing, do not return it.
   if (stmt->unprepared()) {
     return nullptr;
   }
   // If the statement is stale, delete it.
   if (stmt->stale()) {
-    DeletePreparedStatementUnlocked(stmt);
+    DeletePreparedStatement(stmt);
     return nullptr;
   }
 
-  MoveLruPreparedStatementUnlocked(stmt);
+  stmt->set_referenced();
   return stmt;
 }
 
 void CQLServiceImpl::DeletePreparedStatement(const shared_ptr<const CQLStatement>& stmt) {
   // Get exclusive lock before deleting the prepared statement.
-  std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
+  std::lock_guard<percpu_rwlock> guard(prepared_stmts_lock_);
 
   DeletePreparedStatementUnlocked(stmt);
 
@@ -223,11 +236,6 @@ void CQLServiceImpl::InsertLruPreparedStatementUnlocked(const shared_ptr<CQLStat
   stmt->set_pos(prepared_stmts_list_.insert(prepared_stmts_list_.begin(), stmt));
 }
 
-void CQLServiceImpl::MoveLruPreparedStatementUnlocked(const shared_ptr<CQLStatement>& stmt) {
-  // Move the statement to the front of the LRU list.
-  prepared_stmts_list_.splice(prepared_stmts_list_.begin(), prepared_stmts_list_, stmt->pos());
-}
-
 void CQLServiceImpl::DeletePreparedStatementUnlocked(
     const std::shared_ptr<const CQLStatement> stmt) {
   // Remove statement from cache by looking it up by query ID and only when it is same statement
@@ -248,10 +256,17 @@ void CQLServiceImpl::DeletePreparedStatementUnlocked(
 void CQLServiceImpl::DeleteLruPreparedStatement() {
   // Get exclusive lock before deleting the least recently used statement at the end of the LRU
   // list from the cache.
-  std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
-
-  if (!prepared_stmts_list_.empty()) {
-    DeletePreparedStatementUnlocked(prepared_stmts_list_.back());
+  std::lock_guard<percpu_rwlock> guard(prepared_stmts_lock_);
+
+  // Move the statements referenced since they were last considered to the front of the list. This
+  // terminates since their referenced marks are cleared along the way.
+  while (!prepared_stmts_list_.empty()) {
+    const auto pos = std::prev(prepared_stmts_list_.end());
+    if (!(*pos)->clear_referenced()) {
+      DeletePreparedStatementUnlocked(*pos);
+      break;
+    }
+    prepared_stmts_list_.splice(prepared_stmts_list_.begin(), prepared_stmts_list_, pos);
   }
 
   VLOG(1) << "DeleteLruPreparedStatement: CQL prepared statement cache count = "
@@ -27,6 +27,7 @@
 #include "yb/cqlserver/cql_server_options.h"
 #include "yb/ql/statement.h"
 
+#include "yb/util/locks.h"
 #include "yb/util/string_case.h"
 
 #include "yb/client/async_initializer.h"
@@ -47,6 +48,7 @@ extern const char* const kRoleColumnNameSaltedHash;
 class CQLMetrics;
 class CQLProcessor;
 class CQLServer;
+class CQLSlowQueryLog;
 
 class CQLServiceImpl : public CQLServerServiceIf {
  public:
@@ -93,25 +95,25 @@ class CQLServiceImpl : public CQLServerServiceIf {
   // Return the CQL RPC environment.
   CQLRpcServerEnv* cql_rpc_env() { return cql_rpcserver_env_.get(); }
 
+  // Return the slow query log of the CQL server.
+  CQLSlowQueryLog* slow_query_log();
+
  private:
   constexpr static int kRpcTimeoutSec = 5;
 
   // Either gets an available processor or creates a new one.
   CQLProcessor *GetProcessor();
 
-  // Insert a prepared statement at the front of the LRU list. "prepared_stmts_mutex_" needs to be
-  // locked before this call.
+  // Insert a prepared statement at the front of the LRU list. "prepared_stmts_lock_" needs to be
+  // locked exclusively before this call.
   void InsertLruPreparedStatementUnlocked(const std::shared_ptr<CQLStatement>& stmt);
 
-  // Move a prepared statement to the front of the LRU list. "prepared_stmts_mutex_" needs to be
-  // locked before this call.
-  void MoveLruPreparedStatementUnlocked(const std::shared_ptr<CQLStatement>& stmt);
-
-  // Delete a prepared statement from the cache and the LRU list. "prepared_stmts_mutex_" needs to
-  // be locked before this call.
+  // Delete a prepared statement from the cache and the LRU list. "prepared_stmts_lock_" needs to
+  // be locked exclusively before this call.
   void DeletePreparedStatementUnlocked(const std::shared_ptr<const CQLStatement> stmt);
 
-  // Delete the least recently used prepared statement from the cache to free up memory.
+  // Delete the least recently used prepared statement from the cache to free up memory. Statements
+  // referenced since they were last considered are given a second chance at the front of the list.
   void DeleteLruPreparedStatement();
 
   // CQLServer of this service.
@@ -141,8 +143,10 @@ class CQLServiceImpl : public CQLServerServiceIf {
   // Prepared statements LRU list (least recently used one at the end).
   CQLStatementList prepared_stmts_list_;
 
-  // Mutex that protects the prepared statements and the LRU list.
-  std::mutex prepared_stmts_mutex_;
+  // Lock that protects the prepared statements and the LRU list. Looking up a prepared statement to
+  // execute it is far more frequent than preparing or deleting one, so it takes only the per-CPU
+  // shared lock and marks the statement referenced instead of moving it in the LRU list.
+  percpu_rwlock prepared_stmts_lock_;
 
   std::shared_ptr<ql::Statement> auth_prepared_stmt_;
 
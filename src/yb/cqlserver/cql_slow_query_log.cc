@@ -0,0 +1,127 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/cqlserver/cql_slow_query_log.h"
+
+#include <algorithm>
+
+#include "yb/gutil/stringprintf.h"
+#include "yb/gutil/strings/join.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/walltime.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/random_util.h"
+#include "yb/util/url-coding.h"
+
+DEFINE_int32(cql_slow_query_threshold_ms, 1000,
+             "CQL queries that take longer than this are recorded in the slow query log and "
+             "written to the server log. 0 or less disables the slow query log.");
+TAG_FLAG(cql_slow_query_threshold_ms, runtime);
+
+DEFINE_double(cql_slow_query_sample_probability, 0,
+              "Probability with which a query that is not slow is recorded in the slow query "
+              "log, to compare the slow queries against.");
+TAG_FLAG(cql_slow_query_sample_probability, runtime);
+TAG_FLAG(cql_slow_query_sample_probability, advanced);
+
+DEFINE_int32(cql_slow_query_log_size, 100,
+             "Number of most recent queries kept in the slow query log.");
+TAG_FLAG(cql_slow_query_log_size, advanced);
+
+namespace yb {
+namespace cqlserver {
+
+using strings::Substitute;
+
+namespace {
+
+std::string FormatMillis(const MonoDelta& delta) {
+  return StringPrintf("%.3f", delta.ToSeconds() * 1000);
+}
+
+std::string FormatTime(int64_t time_us) {
+  std::string result;
+  StringAppendStrftime(&result, "%Y-%m-%d %H:%M:%S", time_us / 1000000, true /* local */);
+  return result;
+}
+
+} // namespace
+
+std::string CQLSlowQuery::ToString() const {
+  return Substitute(
+      "$0 ms (decode $1 ms, parse $2 ms, analyze $3 ms, build $4 ms, "
+      "$5 flushes of $6 ops to $7 tablets $8 ms, respond $9 ms), ",
+      FormatMillis(total_time), FormatMillis(decode_time), FormatMillis(stats.parse_time),
+      FormatMillis(stats.analyze_time), FormatMillis(stats.build_time), stats.num_flushes,
+      stats.num_ops, stats.tablet_ids.size(), FormatMillis(stats.flush_time),
+      FormatMillis(respond_time)) +
+      Substitute("$0 rows scanned, keyspace $1: $2", stats.rows_scanned, keyspace, query);
+}
+
+bool CQLSlowQueryLog::ShouldRecord(const MonoDelta& total_time, bool* sampled) const {
+  if (FLAGS_cql_slow_query_threshold_ms <= 0 || FLAGS_cql_slow_query_log_size <= 0) {
+    return false;
+  }
+  *sampled = total_time.ToMilliseconds() < FLAGS_cql_slow_query_threshold_ms;
+  return !*sampled || RandomActWithProbability(FLAGS_cql_slow_query_sample_probability);
+}
+
+void CQLSlowQueryLog::Record(CQLSlowQuery query) {
+  if (!query.sampled) {
+    LOG(WARNING) << "Slow CQL query: " << query.ToString();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  queries_.push_back(std::move(query));
+  const size_t max_size = std::max(FLAGS_cql_slow_query_log_size, 0);
+  while (queries_.size() > max_size) {
+    queries_.pop_front();
+  }
+}
+
+std::vector<CQLSlowQuery> CQLSlowQueryLog::Queries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<CQLSlowQuery>(queries_.begin(), queries_.end());
+}
+
+void CQLSlowQueryLog::HtmlOutput(std::stringstream* output) const {
+  const std::vector<CQLSlowQuery> queries = Queries();
+  *output << "<h1>Slow Queries</h1>\n";
+  *output << "<p>Queries slower than " << FLAGS_cql_slow_query_threshold_ms << " ms, and sampled "
+          << "fast queries. Times are in milliseconds. Flush time includes batching by the client, "
+          << "the RPCs and the execution by the tablet servers.</p>\n";
+  *output << "<table class='table table-striped'>\n";
+  *output << "  <tr><th>Time</th><th>Sampled</th><th>Total</th><th>Decode</th><th>Parse</th>"
+          << "<th>Analyze</th><th>Build</th><th>Flushes</th><th>Flush</th><th>Respond</th>"
+          << "<th>Ops</th><th>Tablets</th><th>Rows Scanned</th><th>Keyspace</th><th>Query</th>"
+          << "</tr>\n";
+  for (auto it = queries.rbegin(); it != queries.rend(); ++it) {
+    const auto& stats = it->stats;
+    std::vector<std::string> tablet_ids(stats.tablet_ids.begin(), stats.tablet_ids.end());
+    std::sort(tablet_ids.begin(), tablet_ids.end());
+    *output << Substitute(
+        "  <tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td><td>$5</td><td>$6</td>"
+        "<td>$7</td><td>$8</td><td>$9</td>",
+        FormatTime(it->start_time_us), it->sampled ? "yes" : "no", FormatMillis(it->total_time),
+        FormatMillis(it->decode_time), FormatMillis(stats.parse_time),
+        FormatMillis(stats.analyze_time), FormatMillis(stats.build_time), stats.num_flushes,
+        FormatMillis(stats.flush_time), FormatMillis(it->respond_time));
+    *output << Substitute(
+        "<td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td></tr>\n",
+        stats.num_ops, EscapeForHtmlToString(JoinStrings(tablet_ids, " ")), stats.rows_scanned,
+        EscapeForHtmlToString(it->keyspace), EscapeForHtmlToString(it->query));
+  }
+  *output << "</table>\n";
+}
+
+}  // namespace cqlserver
+}  // namespace yb
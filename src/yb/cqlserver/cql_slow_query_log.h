@@ -0,0 +1,78 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+// This file contains the log of the slow CQL queries of a CQL server, together with where each of
+// them spent its time.
+
+#ifndef YB_CQLSERVER_CQL_SLOW_QUERY_LOG_H_
+#define YB_CQLSERVER_CQL_SLOW_QUERY_LOG_H_
+
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "yb/ql/exec/executor.h"
+#include "yb/util/monotime.h"
+
+namespace yb {
+namespace cqlserver {
+
+// A query recorded in the slow query log.
+struct CQLSlowQuery {
+  // Wall clock time at which the query was received, in microseconds since the epoch.
+  int64_t start_time_us = 0;
+  std::string keyspace;
+  std::string query;
+  // True if the query was not slow and was recorded only as a sample of the fast queries.
+  bool sampled = false;
+
+  // Total time from receiving the request to responding.
+  MonoDelta total_time;
+  // Time spent decoding the CQL request and encoding the CQL response.
+  MonoDelta decode_time;
+  MonoDelta respond_time;
+  // Time spent in the QL layer by stage, and the operations and rows it took.
+  ql::ExecutionStats stats;
+
+  std::string ToString() const;
+};
+
+// Bounded log of the most recent slow queries, and of a sample of the fast ones to compare them
+// against. Queries slower than --cql_slow_query_threshold_ms are also written to the server log.
+class CQLSlowQueryLog {
+ public:
+  CQLSlowQueryLog() {}
+
+  // Returns whether a query that took total_time should be recorded, and whether it is a sample.
+  bool ShouldRecord(const MonoDelta& total_time, bool* sampled) const;
+
+  void Record(CQLSlowQuery query);
+
+  // Returns the recorded queries, oldest first.
+  std::vector<CQLSlowQuery> Queries() const;
+
+  // Writes the recorded queries as an HTML table, most recent first.
+  void HtmlOutput(std::stringstream* output) const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<CQLSlowQuery> queries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CQLSlowQueryLog);
+};
+
+}  // namespace cqlserver
+}  // namespace yb
+
+#endif  // YB_CQLSERVER_CQL_SLOW_QUERY_LOG_H_
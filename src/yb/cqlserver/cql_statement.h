@@ -19,6 +19,7 @@
 #ifndef YB_CQLSERVER_CQL_STATEMENT_H_
 #define YB_CQLSERVER_CQL_STATEMENT_H_
 
+#include <atomic>
 #include <list>
 
 #include "yb/cqlserver/cql_message.h"
@@ -34,7 +35,9 @@ class CQLStatement;
 // it when it is being executed by another client in another thread.
 using CQLStatementMap = std::unordered_map<CQLMessage::QueryId, std::shared_ptr<CQLStatement>>;
 
-// A LRU list of CQL statements and position in the list.
+// A LRU list of CQL statements and position in the list. The list is maintained approximately
+// using the CLOCK (second chance) algorithm: a statement is inserted at the front and, when it is
+// used, only marked as referenced so that lookups do not need to modify the list.
 using CQLStatementList = std::list<std::shared_ptr<CQLStatement>>;
 using CQLStatementListPos = CQLStatementList::iterator;
 
@@ -51,12 +54,26 @@ class CQLStatement : public ql::Statement {
   CQLStatementListPos pos() const { return pos_; }
   void set_pos(CQLStatementListPos pos) const { pos_ = pos; }
 
+  // Mark the statement as referenced since it was last considered for eviction from the LRU. Skip
+  // the store when it is marked already to avoid writing to a shared cacheline on every lookup.
+  void set_referenced() const {
+    if (!referenced_.load(std::memory_order_relaxed)) {
+      referenced_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // Clear the referenced mark and return whether it was set.
+  bool clear_referenced() const { return referenced_.exchange(false, std::memory_order_relaxed); }
+
   // Return the query id of a statement.
   static CQLMessage::QueryId GetQueryId(const std::string& keyspace, const std::string& ql_stmt);
 
  private:
   // Position of the statement in the LRU.
   mutable CQLStatementListPos pos_;
+
+  // Has the statement been referenced since it was last considered for eviction?
+  mutable std::atomic<bool> referenced_ = {false};
 };
 
 }  // namespace cqlserver
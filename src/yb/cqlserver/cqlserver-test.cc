@@ -11,6 +11,9 @@
 // under the License.
 //
 
+#include <lz4.h>
+#include <snappy.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,6 +24,7 @@
 #include "yb/cqlserver/cql_message.h"
 #include "yb/cqlserver/cql_server.h"
 
+#include "yb/gutil/endian.h"
 #include "yb/gutil/strings/join.h"
 #include "yb/util/cast.h"
 #include "yb/util/net/net_util.h"
@@ -169,11 +173,73 @@ TEST_F(TestCQLService, OptionsRequest) {
   // Send OPTIONS request using version V4
   SendRequestAndExpectResponse(
       BINARY_STRING("\x04\x00\x00\x00\x05" "\x00\x00\x00\x00"),
-      BINARY_STRING("\x84\x00\x00\x00\x06" "\x00\x00\x00\x2e"
+      BINARY_STRING("\x84\x00\x00\x00\x06" "\x00\x00\x00\x3b"
                     "\x00\x02" "\x00\x0b" "CQL_VERSION"
                                "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
                                "\x00\x0b" "COMPRESSION"
-                               "\x00\x00"));
+                               "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy"));
+}
+
+namespace {
+
+// Compress the body like CQL drivers do, LZ4 compressed body is prefixed with its length.
+string CompressBody(const string& compression, const string& body) {
+  string result;
+  if (compression == "lz4") {
+    result.resize(4 + LZ4_compressBound(body.size()));
+    NetworkByteOrder::Store32(&result[0], body.size());
+    const int size = LZ4_compress_default(
+        body.data(), &result[4], body.size(), result.size() - 4);
+    CHECK_GT(size, 0);
+    result.resize(4 + size);
+  } else {
+    CHECK_EQ("snappy", compression);
+    snappy::Compress(body.data(), body.size(), &result);
+  }
+  return result;
+}
+
+string Frame(const string& header, const string& body) {
+  string length(4, '\0');
+  NetworkByteOrder::Store32(&length[0], body.size());
+  return header + length + body;
+}
+
+} // namespace
+
+TEST_F(TestCQLService, CompressedRequests) {
+  const string kSupportedBody = BINARY_STRING(
+      "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                 "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
+                 "\x00\x0b" "COMPRESSION"
+                 "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy");
+  for (const string compression : {"lz4", "snappy"}) {
+    LOG(INFO) << "Test CQL requests compressed with " << compression;
+    // Negotiate compression, response to STARTUP is not compressed.
+    const string startup_body = BINARY_STRING("\x00\x01" "\x00\x0b" "COMPRESSION" "\x00") +
+                                static_cast<char>(compression.size()) + compression;
+    SendRequestAndExpectResponse(
+        Frame(BINARY_STRING("\x04\x00\x00\x00\x01"), startup_body),
+        BINARY_STRING("\x84\x00\x00\x00\x02" "\x00\x00\x00\x00"));
+
+    // Uncompressed request is still accepted, response is compressed.
+    SendRequestAndExpectResponse(
+        BINARY_STRING("\x04\x00\x00\x00\x05" "\x00\x00\x00\x00"),
+        Frame(BINARY_STRING("\x84\x01\x00\x00\x06"),
+              CompressBody(compression, kSupportedBody)));
+
+    // Compressed request.
+    SendRequestAndExpectResponse(
+        Frame(BINARY_STRING("\x04\x01\x00\x00\x01"), CompressBody(compression, startup_body)),
+        BINARY_STRING("\x84\x00\x00\x00\x02" "\x00\x00\x00\x00"));
+  }
+
+  // Unsupported compression.
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x14"
+                    "\x00\x01" "\x00\x0b" "COMPRESSION" "\x00\x03" "lzo"),
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x24"
+                    "\x00\x00\x00\x0a" "\x00\x1e" "Unsupported option COMPRESSION"));
 }
 
 TEST_F(TestCQLService, InvalidRequest) {
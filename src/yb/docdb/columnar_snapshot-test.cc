@@ -0,0 +1,220 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <memory>
+#include <string>
+
+#include "yb/common/ql_value.h"
+#include "yb/docdb/columnar_snapshot.h"
+#include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/doc_rowwise_iterator.h"
+#include "yb/docdb/docdb_test_base.h"
+#include "yb/docdb/docdb_test_util.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+constexpr int kNumRows = 3000;
+const HybridTime kWriteTime = HybridTime::FromMicros(1000);
+const HybridTime kSnapshotTime = HybridTime::FromMicros(2000);
+
+const Schema kSchema({
+    ColumnSchema("a", DataType::STRING, /* is_nullable = */ false),
+    ColumnSchema("b", DataType::INT64, false),
+    // Non-key columns
+    ColumnSchema("c", DataType::STRING, true),
+    ColumnSchema("d", DataType::INT64, true),
+    ColumnSchema("e", DataType::DOUBLE, true),
+    // Stored as serialized values.
+    ColumnSchema("f", DataType::UUID, true)
+}, {
+    10_ColId,
+    20_ColId,
+    30_ColId,
+    40_ColId,
+    50_ColId,
+    60_ColId
+}, 2);
+
+} // namespace
+
+class ColumnarSnapshotTest : public DocDBTestBase {
+ protected:
+  void WriteRows() {
+    Uuid uuid;
+    ASSERT_OK(uuid.FromString("11111111-2222-3333-4444-555555555555"));
+    for (int i = 0; i != kNumRows; ++i) {
+      const KeyBytes key = DocKey(PrimitiveValues(strings::Substitute("row$0", i), i)).Encode();
+      ASSERT_OK(SetPrimitive(DocPath(key, PrimitiveValue(30_ColId)),
+                             PrimitiveValue(strings::Substitute("c$0", i % 10)), kWriteTime,
+                             InitMarkerBehavior::OPTIONAL));
+      // Every fifth row has no d.
+      if (i % 5 != 0) {
+        ASSERT_OK(SetPrimitive(DocPath(key, PrimitiveValue(40_ColId)),
+                               PrimitiveValue(static_cast<int64_t>(i) * 7), kWriteTime,
+                               InitMarkerBehavior::OPTIONAL));
+      }
+      ASSERT_OK(SetPrimitive(DocPath(key, PrimitiveValue(50_ColId)),
+                             PrimitiveValue::Double(i * 0.5), kWriteTime,
+                             InitMarkerBehavior::OPTIONAL));
+      if (i % 3 == 0) {
+        ASSERT_OK(SetPrimitive(DocPath(key, PrimitiveValue(60_ColId)), PrimitiveValue(uuid),
+                               kWriteTime, InitMarkerBehavior::OPTIONAL));
+      }
+    }
+  }
+
+  void BuildSnapshot() {
+    ASSERT_OK(ColumnarSnapshot::Build(
+        kSchema, rocksdb(), kSnapshotTime, env_.get(), GetTestPath("columnar/1"), &snapshot_));
+    ASSERT_EQ(kNumRows, static_cast<int>(snapshot_->num_rows()));
+  }
+
+  static DocQLScanSpec ScanSpec(const DocKey& start_doc_key = DocKey()) {
+    const std::vector<PrimitiveValue> hashed_components;
+    return DocQLScanSpec(kSchema, -1 /* hash_code */, -1 /* max_hash_code */, hashed_components,
+                         nullptr /* req */, rocksdb::kDefaultQueryId,
+                         false /* include_static_columns */, start_doc_key);
+  }
+
+  // Checks that the iterator returns the same rows as DocRowwiseIterator does, up to max_rows.
+  void CheckRows(const Schema& projection, const DocQLScanSpec& spec,
+                 common::QLRowwiseIteratorIf* iter, int max_rows, int* num_rows) {
+    DocRowwiseIterator expected_iter(
+        projection, kSchema, kNonTransactionalOperationContext, rocksdb(), kSnapshotTime);
+    ASSERT_OK(expected_iter.Init(spec));
+    *num_rows = 0;
+    while (*num_rows != max_rows && expected_iter.HasNext()) {
+      ASSERT_TRUE(iter->HasNext());
+      QLTableRow expected_row;
+      ASSERT_OK(expected_iter.NextRow(projection, &expected_row));
+      QLTableRow row;
+      ASSERT_OK(iter->NextRow(projection, &row));
+      for (size_t i = 0; i != projection.num_columns(); ++i) {
+        const ColumnId column_id = projection.column_id(i);
+        const auto expected = expected_row.find(column_id);
+        const auto actual = row.find(column_id);
+        // Null columns could be left out.
+        if (expected == expected_row.end() || QLValue::IsNull(expected->second.value)) {
+          ASSERT_TRUE(actual == row.end() || QLValue::IsNull(actual->second.value));
+        } else {
+          ASSERT_TRUE(actual != row.end()) << "row " << *num_rows << ", column " << column_id;
+          ASSERT_EQ(expected->second.value.ShortDebugString(),
+                    actual->second.value.ShortDebugString());
+        }
+      }
+      ++*num_rows;
+    }
+    if (*num_rows != max_rows) {
+      ASSERT_FALSE(iter->HasNext());
+    }
+  }
+
+  std::shared_ptr<ColumnarSnapshot> snapshot_;
+};
+
+TEST_F(ColumnarSnapshotTest, Scan) {
+  ASSERT_NO_FATALS(WriteRows());
+  ASSERT_NO_FATALS(BuildSnapshot());
+
+  Schema projection;
+  ASSERT_OK(kSchema.CreateProjectionByNames({"a", "b", "d", "e", "f"}, &projection));
+  ASSERT_TRUE(snapshot_->HasColumns(projection));
+  // c is not decoded by the scan.
+  ASSERT_GT(snapshot_->ColumnFileSize(30_ColId), 0U);
+  ASSERT_EQ(0U, snapshot_->ColumnFileSize(70_ColId));
+
+  const auto spec = ScanSpec();
+  ColumnarSnapshotIterator iter(snapshot_, projection, kSchema, kSnapshotTime);
+  ASSERT_OK(iter.Init(spec));
+  int num_rows = 0;
+  ASSERT_NO_FATALS(CheckRows(projection, spec, &iter, -1 /* max_rows */, &num_rows));
+  ASSERT_EQ(kNumRows, num_rows);
+
+  // A column added after the snapshot was built.
+  Schema new_projection({ ColumnSchema("g", DataType::INT64, true) }, { 70_ColId }, 0);
+  ASSERT_FALSE(snapshot_->HasColumns(new_projection));
+}
+
+TEST_F(ColumnarSnapshotTest, Paging) {
+  ASSERT_NO_FATALS(WriteRows());
+  ASSERT_NO_FATALS(BuildSnapshot());
+
+  Schema projection;
+  ASSERT_OK(kSchema.CreateProjectionByNames({"a", "b", "c", "d"}, &projection));
+  QLReadRequestPB request;
+  request.set_return_paging_state(true);
+
+  // Pages that end in the middle of a batch, and at the end of a batch.
+  for (const int page_size : {700, 1024}) {
+    DocKey start_doc_key;
+    int total_rows = 0;
+    for (;;) {
+      const auto spec = ScanSpec(start_doc_key);
+      ColumnarSnapshotIterator iter(snapshot_, projection, kSchema, kSnapshotTime);
+      ASSERT_OK(iter.Init(spec));
+      int num_rows = 0;
+      ASSERT_NO_FATALS(CheckRows(projection, spec, &iter, page_size, &num_rows));
+      total_rows += num_rows;
+      QLResponsePB response;
+      ASSERT_OK(iter.SetPagingStateIfNecessary(request, &response));
+      if (!response.has_paging_state()) {
+        break;
+      }
+      SubDocKey start_sub_doc_key;
+      ASSERT_OK(start_sub_doc_key.FullyDecodeFrom(response.paging_state().next_row_key()));
+      ASSERT_EQ(kSnapshotTime, start_sub_doc_key.hybrid_time());
+      start_doc_key = start_sub_doc_key.doc_key();
+    }
+    ASSERT_EQ(kNumRows, total_rows);
+  }
+}
+
+TEST_F(ColumnarSnapshotTest, Holder) {
+  ASSERT_NO_FATALS(WriteRows());
+  ASSERT_NO_FATALS(BuildSnapshot());
+
+  ColumnarSnapshotHolder holder;
+  ASSERT_TRUE(holder.Get(kSnapshotTime) == nullptr);
+
+  // A write applied while the snapshot was built.
+  auto write_generation = holder.write_generation();
+  holder.Invalidate();
+  ASSERT_FALSE(holder.Install(snapshot_, write_generation));
+  ASSERT_TRUE(holder.Get(kSnapshotTime) == nullptr);
+
+  write_generation = holder.write_generation();
+  ASSERT_TRUE(holder.Install(snapshot_, write_generation));
+  ASSERT_EQ(snapshot_, holder.Get(kSnapshotTime));
+  ASSERT_EQ(snapshot_, holder.Get(HybridTime::FromMicros(3000)));
+  // Reads before the snapshot time could not be served from it.
+  ASSERT_TRUE(holder.Get(kWriteTime) == nullptr);
+
+  holder.Invalidate();
+  ASSERT_TRUE(holder.Get(kSnapshotTime) == nullptr);
+}
+
+TEST_F(ColumnarSnapshotTest, Empty) {
+  std::shared_ptr<ColumnarSnapshot> snapshot;
+  ASSERT_TRUE(ColumnarSnapshot::Build(
+      kSchema, rocksdb(), kSnapshotTime, env_.get(), GetTestPath("columnar/1"), &snapshot)
+      .IsAborted());
+}
+
+}  // namespace docdb
+}  // namespace yb
@@ -0,0 +1,642 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/columnar_snapshot.h"
+
+#include <string.h>
+
+#include "yb/cfile/cfile_writer.h"
+#include "yb/common/columnblock.h"
+#include "yb/common/encoded_key.h"
+#include "yb/common/partition.h"
+#include "yb/common/types.h"
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/doc_rowwise_iterator.h"
+#include "yb/fs/file_block_manager.h"
+#include "yb/util/bitmap.h"
+#include "yb/util/env.h"
+#include "yb/util/env_util.h"
+#include "yb/util/faststring.h"
+#include "yb/util/path_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Values are appended to the column files and read back in batches of this many rows.
+constexpr size_t kBatchSize = 1024;
+
+// Returns the type the values of a column of the specified QL type are stored as. Values of types
+// that have no CFile encoding are stored as serialized QLValuePB.
+DataType StorageType(DataType ql_type, bool* serialized) {
+  *serialized = false;
+  switch (ql_type) {
+    case INT8: FALLTHROUGH_INTENDED;
+    case INT16: FALLTHROUGH_INTENDED;
+    case INT32: FALLTHROUGH_INTENDED;
+    case INT64: FALLTHROUGH_INTENDED;
+    case FLOAT: FALLTHROUGH_INTENDED;
+    case DOUBLE: FALLTHROUGH_INTENDED;
+    case BOOL: FALLTHROUGH_INTENDED;
+    case BINARY:
+      return ql_type;
+    case STRING:
+      return BINARY;
+    case TIMESTAMP:
+      return INT64;
+    default:
+      *serialized = true;
+      return BINARY;
+  }
+}
+
+EncodingType StorageEncoding(DataType storage_type) {
+  switch (storage_type) {
+    case BOOL:
+      return RLE;
+    case BINARY:
+      // Falls back to plain encoding when the dictionary of a file gets too large.
+      return DICT_ENCODING;
+    default:
+      return BIT_SHUFFLE;
+  }
+}
+
+template <class T>
+void StoreCell(T value, uint8_t* cell) {
+  memcpy(cell, &value, sizeof(value));
+}
+
+template <class T>
+T LoadCell(const uint8_t* cell) {
+  T value;
+  memcpy(&value, cell, sizeof(value));
+  return value;
+}
+
+// Buffers the values of a column and appends them to the file of the column in batches.
+class ColumnWriter {
+ public:
+  // The writer of the encoded document keys of the rows is created with is_key set.
+  ColumnWriter(DataType ql_type, bool is_key, gscoped_ptr<fs::WritableBlock> block)
+      : ql_type_(ql_type), is_key_(is_key), block_id_(block->id()) {
+    storage_type_ = StorageType(ql_type, &serialized_);
+    type_info_ = GetTypeInfo(storage_type_);
+    cfile::WriterOptions options;
+    options.write_posidx = true;
+    // Like the ad hoc index of a DiskRowSet, keys are indexed by value so a scan could start at any
+    // key, and prefix encoded since adjacent keys share long prefixes.
+    options.write_validx = is_key;
+    options.storage_attributes.encoding = is_key ? PREFIX_ENCODING
+                                                 : StorageEncoding(storage_type_);
+    writer_.reset(new cfile::CFileWriter(options, type_info_, !is_key, block.Pass()));
+    cells_.resize(kBatchSize * type_info_->size());
+    null_bitmap_.resize(BitmapSize(kBatchSize));
+    strings_.resize(kBatchSize);
+  }
+
+  CHECKED_STATUS Start() {
+    return writer_->Start();
+  }
+
+  CHECKED_STATUS AddKey(const Slice& key) {
+    DCHECK(is_key_);
+    strings_[count_].assign(key.cdata(), key.size());
+    return Added();
+  }
+
+  // Adds the value of the next row, null when value is not specified.
+  CHECKED_STATUS Add(const QLValuePB* value) {
+    DCHECK(!is_key_);
+    const bool is_null = value == nullptr || value->value_case() == QLValuePB::VALUE_NOT_SET;
+    BitmapChange(null_bitmap_.data(), count_, !is_null);
+    if (!is_null) {
+      SetCell(*value);
+    }
+    return Added();
+  }
+
+  CHECKED_STATUS Finish() {
+    RETURN_NOT_OK(Flush());
+    return writer_->Finish();
+  }
+
+  const fs::BlockId& block_id() const { return block_id_; }
+
+  bool serialized() const { return serialized_; }
+
+ private:
+  void SetCell(const QLValuePB& value) {
+    uint8_t* cell = cells_.data() + count_ * type_info_->size();
+    if (serialized_) {
+      value.SerializeToString(&strings_[count_]);
+      return;
+    }
+    switch (ql_type_) {
+      case INT8: StoreCell<int8_t>(value.int8_value(), cell); return;
+      case INT16: StoreCell<int16_t>(value.int16_value(), cell); return;
+      case INT32: StoreCell<int32_t>(value.int32_value(), cell); return;
+      case INT64: StoreCell<int64_t>(value.int64_value(), cell); return;
+      case TIMESTAMP: StoreCell<int64_t>(value.timestamp_value(), cell); return;
+      case FLOAT: StoreCell<float>(value.float_value(), cell); return;
+      case DOUBLE: StoreCell<double>(value.double_value(), cell); return;
+      case BOOL: StoreCell<bool>(value.bool_value(), cell); return;
+      case STRING: strings_[count_] = value.string_value(); return;
+      case BINARY: strings_[count_] = value.binary_value(); return;
+      default: break;
+    }
+    LOG(DFATAL) << "Unexpected type of a columnar value: " << DataType_Name(ql_type_);
+  }
+
+  CHECKED_STATUS Added() {
+    return ++count_ == kBatchSize ? Flush() : Status::OK();
+  }
+
+  CHECKED_STATUS Flush() {
+    if (count_ == 0) {
+      return Status::OK();
+    }
+    if (storage_type_ == BINARY) {
+      auto* slices = reinterpret_cast<Slice*>(cells_.data());
+      for (size_t i = 0; i != count_; ++i) {
+        slices[i] = Slice(strings_[i]);
+      }
+    }
+    const size_t count = count_;
+    count_ = 0;
+    if (is_key_) {
+      return writer_->AppendEntries(cells_.data(), count);
+    }
+    return writer_->AppendNullableEntries(null_bitmap_.data(), cells_.data(), count);
+  }
+
+  const DataType ql_type_;
+  const bool is_key_;
+  const fs::BlockId block_id_;
+  bool serialized_;
+  DataType storage_type_;
+  const TypeInfo* type_info_;
+  gscoped_ptr<cfile::CFileWriter> writer_;
+
+  // Cells of the rows of the current batch. Binary values are kept in strings_ until the batch is
+  // flushed.
+  std::vector<uint8_t> cells_;
+  std::vector<uint8_t> null_bitmap_;
+  std::vector<std::string> strings_;
+  size_t count_ = 0;
+};
+
+CHECKED_STATUS SetKeyColumnValues(const Schema& schema,
+                                  size_t begin_index,
+                                  size_t column_count,
+                                  const std::vector<PrimitiveValue>& values,
+                                  QLTableRow* table_row) {
+  if (values.size() != column_count) {
+    return STATUS_FORMAT(Corruption, "$0 primary key columns found but $1 expected",
+                         values.size(), column_count);
+  }
+  for (size_t i = 0, j = begin_index; i < column_count; i++, j++) {
+    PrimitiveValue::ToQLValuePB(
+        values[i], schema.column(j).type(), &(*table_row)[schema.column_id(j)].value);
+  }
+  return Status::OK();
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+// ColumnarSnapshot
+// ------------------------------------------------------------------------------------------------
+
+ColumnarSnapshot::ColumnarSnapshot(Env* env, std::string dir, HybridTime hybrid_time)
+    : env_(env), dir_(std::move(dir)), hybrid_time_(hybrid_time) {
+}
+
+ColumnarSnapshot::~ColumnarSnapshot() {
+  key_reader_.reset();
+  columns_.clear();
+  block_manager_.reset();
+  if (env_->FileExists(dir_)) {
+    auto status = env_->DeleteRecursively(dir_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to remove columnar snapshot " << dir_ << ": " << status;
+    }
+  }
+}
+
+Status ColumnarSnapshot::Build(const Schema& schema,
+                               rocksdb::DB* db,
+                               HybridTime read_time,
+                               Env* env,
+                               const std::string& dir,
+                               std::shared_ptr<ColumnarSnapshot>* snapshot) {
+  if (schema.has_statics()) {
+    return STATUS(NotSupported, "Columnar snapshots do not support static columns");
+  }
+  if (schema.table_properties().HasDefaultTimeToLive()) {
+    return STATUS(NotSupported, "Columnar snapshots do not support TTL");
+  }
+  if (schema.table_properties().is_transactional()) {
+    return STATUS(NotSupported, "Columnar snapshots do not support transactional tables");
+  }
+  std::shared_ptr<ColumnarSnapshot> result(new ColumnarSnapshot(env, dir, read_time));
+  RETURN_NOT_OK(result->Write(schema, db));
+  *snapshot = std::move(result);
+  return Status::OK();
+}
+
+Status ColumnarSnapshot::Write(const Schema& schema, rocksdb::DB* db) {
+  schema_.CopyFrom(schema);
+  RETURN_NOT_OK(env_util::CreateDirIfMissing(env_, DirName(dir_)));
+  fs::BlockManagerOptions options;
+  options.root_paths = { dir_ };
+  block_manager_.reset(new fs::FileBlockManager(env_, options));
+  RETURN_NOT_OK(block_manager_->Create());
+  RETURN_NOT_OK(block_manager_->Open());
+
+  auto create_writer = [this](DataType ql_type, bool is_key,
+                              std::unique_ptr<ColumnWriter>* writer) -> Status {
+    gscoped_ptr<fs::WritableBlock> block;
+    RETURN_NOT_OK(block_manager_->CreateBlock(&block));
+    writer->reset(new ColumnWriter(ql_type, is_key, block.Pass()));
+    return (*writer)->Start();
+  };
+
+  std::unique_ptr<ColumnWriter> key_writer;
+  RETURN_NOT_OK(create_writer(BINARY, true /* is_key */, &key_writer));
+  key_block_id_ = key_writer->block_id();
+
+  std::vector<std::unique_ptr<ColumnWriter>> writers;
+  for (size_t i = schema.num_key_columns(); i != schema.num_columns(); ++i) {
+    const DataType ql_type = schema.column(i).type()->main();
+    writers.emplace_back();
+    RETURN_NOT_OK(create_writer(ql_type, false /* is_key */, &writers.back()));
+    column_index_[schema.column_id(i)] = columns_.size();
+    columns_.push_back(Column{
+        schema.column_id(i), ql_type, writers.back()->serialized(), writers.back()->block_id(),
+        nullptr});
+  }
+
+  DocRowwiseIterator iter(schema, schema, boost::none, db, hybrid_time_);
+  const std::vector<PrimitiveValue> hashed_components;
+  DocQLScanSpec spec(schema, -1 /* hash_code */, -1 /* max_hash_code */, hashed_components,
+                     nullptr /* req */, rocksdb::kDefaultQueryId);
+  RETURN_NOT_OK(iter.Init(spec));
+  QLTableRow row;
+  while (iter.HasNext()) {
+    row.clear();
+    RETURN_NOT_OK(iter.NextRow(schema, &row));
+    RETURN_NOT_OK(key_writer->AddKey(iter.row_key().Encode().AsSlice()));
+    for (size_t i = 0; i != columns_.size(); ++i) {
+      const auto it = row.find(columns_[i].id);
+      const QLValuePB* value = nullptr;
+      if (it != row.end()) {
+        if (it->second.ttl_seconds != -1) {
+          return STATUS(NotSupported, "Columnar snapshots do not support TTL");
+        }
+        value = &it->second.value;
+      }
+      RETURN_NOT_OK(writers[i]->Add(value));
+    }
+    ++num_rows_;
+  }
+  if (num_rows_ == 0) {
+    return STATUS(Aborted, "no data written");
+  }
+
+  RETURN_NOT_OK(key_writer->Finish());
+  for (const auto& writer : writers) {
+    RETURN_NOT_OK(writer->Finish());
+  }
+  return OpenReaders();
+}
+
+Status ColumnarSnapshot::OpenReaders() {
+  gscoped_ptr<fs::ReadableBlock> block;
+  RETURN_NOT_OK(block_manager_->OpenBlock(key_block_id_, &block));
+  RETURN_NOT_OK(cfile::CFileReader::Open(block.Pass(), cfile::ReaderOptions(), &key_reader_));
+  for (auto& column : columns_) {
+    RETURN_NOT_OK(block_manager_->OpenBlock(column.block_id, &block));
+    gscoped_ptr<cfile::CFileReader> reader;
+    RETURN_NOT_OK(cfile::CFileReader::Open(block.Pass(), cfile::ReaderOptions(), &reader));
+    column.reader.reset(reader.release());
+  }
+  return Status::OK();
+}
+
+bool ColumnarSnapshot::HasColumns(const Schema& projection) const {
+  for (size_t i = 0; i != projection.num_columns(); ++i) {
+    if (schema_.find_column_by_id(projection.column_id(i)) == Schema::kColumnNotFound) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t ColumnarSnapshot::ColumnFileSize(ColumnId column_id) const {
+  const auto* column = FindColumn(column_id);
+  return column != nullptr ? column->reader->file_size() : 0;
+}
+
+const ColumnarSnapshot::Column* ColumnarSnapshot::FindColumn(ColumnId column_id) const {
+  const auto it = column_index_.find(column_id);
+  return it != column_index_.end() ? &columns_[it->second] : nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+// ColumnarSnapshotIterator
+// ------------------------------------------------------------------------------------------------
+
+Status ColumnarSnapshotIterator::CellToQLValue(const ColumnarSnapshot::Column& column,
+                                               const uint8_t* cell,
+                                               QLValuePB* value) {
+  if (column.serialized) {
+    const auto& slice = *reinterpret_cast<const Slice*>(cell);
+    if (!value->ParseFromArray(slice.data(), slice.size())) {
+      return STATUS_FORMAT(Corruption, "Failed to parse value of column $0", column.id);
+    }
+    return Status::OK();
+  }
+  switch (column.ql_type) {
+    case INT8: value->set_int8_value(LoadCell<int8_t>(cell)); break;
+    case INT16: value->set_int16_value(LoadCell<int16_t>(cell)); break;
+    case INT32: value->set_int32_value(LoadCell<int32_t>(cell)); break;
+    case INT64: value->set_int64_value(LoadCell<int64_t>(cell)); break;
+    case TIMESTAMP: value->set_timestamp_value(LoadCell<int64_t>(cell)); break;
+    case FLOAT: value->set_float_value(LoadCell<float>(cell)); break;
+    case DOUBLE: value->set_double_value(LoadCell<double>(cell)); break;
+    case BOOL: value->set_bool_value(LoadCell<bool>(cell)); break;
+    case STRING: {
+      const auto& slice = *reinterpret_cast<const Slice*>(cell);
+      value->set_string_value(slice.cdata(), slice.size());
+      break;
+    }
+    case BINARY: {
+      const auto& slice = *reinterpret_cast<const Slice*>(cell);
+      value->set_binary_value(slice.cdata(), slice.size());
+      break;
+    }
+    default:
+      return STATUS_FORMAT(Corruption, "Unexpected type of column $0: $1",
+                           column.id, DataType_Name(column.ql_type));
+  }
+  return Status::OK();
+}
+
+ColumnarSnapshotIterator::ColumnarSnapshotIterator(
+    std::shared_ptr<const ColumnarSnapshot> snapshot,
+    const Schema& projection,
+    const Schema& schema,
+    HybridTime read_time)
+    : snapshot_(std::move(snapshot)),
+      projection_(projection),
+      schema_(schema),
+      read_time_(read_time),
+      arena_(32 * 1024, 4 * 1024 * 1024) {
+}
+
+ColumnarSnapshotIterator::~ColumnarSnapshotIterator() {
+}
+
+Status ColumnarSnapshotIterator::Init(ScanSpec* spec) {
+  return STATUS(NotSupported, "Columnar snapshots are only read by QL scans");
+}
+
+Status ColumnarSnapshotIterator::Init(const common::QLScanSpec& spec) {
+  const DocQLScanSpec& doc_spec = dynamic_cast<const DocQLScanSpec&>(spec);
+  DocKey lower_doc_key;
+  DocKey upper_doc_key;
+  RETURN_NOT_OK(doc_spec.lower_bound(&lower_doc_key));
+  RETURN_NOT_OK(doc_spec.upper_bound(&upper_doc_key));
+  if (!upper_doc_key.empty()) {
+    exclusive_upper_bound_key_ = SubDocKey(upper_doc_key).AdvanceOutOfDocKeyPrefix();
+  }
+
+  RETURN_NOT_OK(snapshot_->key_reader_->NewIterator(
+      &key_iter_, cfile::CFileReader::DONT_CACHE_BLOCK));
+  Status status;
+  if (lower_doc_key.empty()) {
+    status = key_iter_->SeekToFirst();
+  } else {
+    const KeyBytes lower_key = lower_doc_key.Encode();
+    faststring encoded_key;
+    encoded_key.append(lower_key.data());
+    Slice raw_key = lower_key.AsSlice();
+    std::vector<const void*> raw_keys = { &raw_key };
+    EncodedKey key(&encoded_key, &raw_keys, 1 /* num_key_cols */);
+    bool exact_match = false;
+    status = key_iter_->SeekAtOrAfter(key, &exact_match);
+  }
+  if (status.IsNotFound()) {
+    done_ = true;
+    return Status::OK();
+  }
+  RETURN_NOT_OK(status);
+  const rowid_t ordinal = key_iter_->GetCurrentOrdinal();
+
+  // Only the non-key columns of the projection are decoded, the key columns come from the
+  // document key.
+  columns_.clear();
+  for (size_t i = 0; i != projection_.num_columns(); ++i) {
+    const ColumnId column_id = projection_.column_id(i);
+    if (schema_.is_key_column(column_id)) {
+      continue;
+    }
+    const auto* column = snapshot_->FindColumn(column_id);
+    if (column == nullptr) {
+      return STATUS_FORMAT(InvalidArgument, "Column $0 is not in the columnar snapshot",
+                           column_id);
+    }
+    ColumnBatch batch;
+    batch.column = column;
+    cfile::CFileIterator* iter = nullptr;
+    RETURN_NOT_OK(column->reader->NewIterator(&iter, cfile::CFileReader::DONT_CACHE_BLOCK));
+    batch.iter.reset(iter);
+    RETURN_NOT_OK(batch.iter->SeekToOrdinal(ordinal));
+    batch.data.resize(kBatchSize * column->reader->type_info()->size());
+    batch.null_bitmap.resize(BitmapSize(kBatchSize));
+    columns_.push_back(std::move(batch));
+  }
+  key_data_.resize(kBatchSize * sizeof(Slice));
+  batch_size_ = 0;
+  batch_index_ = 0;
+  done_ = false;
+  return Status::OK();
+}
+
+Status ColumnarSnapshotIterator::ReadBatch() const {
+  arena_.Reset();
+  size_t count = kBatchSize;
+  ColumnBlock keys(GetTypeInfo(BINARY), nullptr, key_data_.data(), count, &arena_);
+  RETURN_NOT_OK(key_iter_->CopyNextValues(&count, &keys));
+  for (auto& batch : columns_) {
+    size_t column_count = count;
+    ColumnBlock block(batch.column->reader->type_info(), batch.null_bitmap.data(),
+                      batch.data.data(), column_count, &arena_);
+    RETURN_NOT_OK(batch.iter->CopyNextValues(&column_count, &block));
+    if (column_count != count) {
+      return STATUS_FORMAT(Corruption, "Read $0 values of column $1 for $2 keys",
+                           column_count, batch.column->id, count);
+    }
+  }
+  batch_size_ = count;
+  batch_index_ = 0;
+  return Status::OK();
+}
+
+Slice ColumnarSnapshotIterator::current_key() const {
+  return reinterpret_cast<const Slice*>(key_data_.data())[batch_index_];
+}
+
+bool ColumnarSnapshotIterator::HasNext() const {
+  if (!status_.ok()) {
+    // Return true so the error is returned by NextRow.
+    return true;
+  }
+  if (done_) {
+    return false;
+  }
+  if (batch_index_ == batch_size_) {
+    if (!key_iter_->HasNext()) {
+      done_ = true;
+      return false;
+    }
+    status_ = ReadBatch();
+    if (!status_.ok()) {
+      return true;
+    }
+  }
+  if (!exclusive_upper_bound_key_.empty() &&
+      current_key().compare(exclusive_upper_bound_key_.AsSlice()) >= 0) {
+    done_ = true;
+    return false;
+  }
+  return true;
+}
+
+std::string ColumnarSnapshotIterator::ToString() const {
+  return "ColumnarSnapshotIterator";
+}
+
+Status ColumnarSnapshotIterator::NextBlock(RowBlock* dst) {
+  return STATUS(NotSupported, "Columnar snapshots are only read by QL scans");
+}
+
+void ColumnarSnapshotIterator::GetIteratorStats(std::vector<IteratorStats>* stats) const {
+  for (int i = 0; i < projection_.num_columns(); i++) {
+    stats->emplace_back();
+  }
+}
+
+Status ColumnarSnapshotIterator::NextRow(const Schema& projection, QLTableRow* table_row) {
+  if (!status_.ok()) {
+    // An error happened in HasNext.
+    return status_;
+  }
+  if (PREDICT_FALSE(done_)) {
+    return STATUS(NotFound, "end of iter");
+  }
+  if (batch_index_ == batch_size_) {
+    return STATUS(InternalError, "next row has not be prepared for reading");
+  }
+
+  DocKey doc_key;
+  RETURN_NOT_OK(doc_key.FullyDecodeFrom(current_key()));
+  RETURN_NOT_OK(SetKeyColumnValues(
+      schema_, 0, schema_.num_hash_key_columns(), doc_key.hashed_group(), table_row));
+  RETURN_NOT_OK(SetKeyColumnValues(
+      schema_, schema_.num_hash_key_columns(), schema_.num_range_key_columns(),
+      doc_key.range_group(), table_row));
+
+  for (const auto& batch : columns_) {
+    const auto& column = *batch.column;
+    if (!BitmapTest(batch.null_bitmap.data(), batch_index_) ||
+        projection.find_column_by_id(column.id) == Schema::kColumnNotFound) {
+      continue;
+    }
+    auto& table_column = (*table_row)[column.id];
+    RETURN_NOT_OK(CellToQLValue(
+        column, batch.data.data() + batch_index_ * batch.column->reader->type_info()->size(),
+        &table_column.value));
+    // Reads of TTLs and write times are not served from columnar snapshots.
+    table_column.ttl_seconds = -1;
+    table_column.write_time = 0;
+  }
+  ++batch_index_;
+  return Status::OK();
+}
+
+void ColumnarSnapshotIterator::SkipRow() {
+  if (batch_index_ < batch_size_) {
+    ++batch_index_;
+  }
+}
+
+Status ColumnarSnapshotIterator::SetPagingStateIfNecessary(const QLReadRequestPB& request,
+                                                           QLResponsePB* response) const {
+  // Same as DocRowwiseIterator: the paging state has the key of the next row to read, if any.
+  if (!request.return_paging_state() || !HasNext()) {
+    return Status::OK();
+  }
+  RETURN_NOT_OK(status_);
+  DocKey doc_key;
+  RETURN_NOT_OK(doc_key.FullyDecodeFrom(current_key()));
+  QLPagingStatePB* paging_state = response->mutable_paging_state();
+  paging_state->set_next_partition_key(PartitionSchema::EncodeMultiColumnHashValue(doc_key.hash()));
+  paging_state->set_next_row_key(
+      SubDocKey(doc_key, read_time_).Encode(true /* include_hybrid_time */).data());
+  return Status::OK();
+}
+
+// ------------------------------------------------------------------------------------------------
+// ColumnarSnapshotHolder
+// ------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const ColumnarSnapshot> ColumnarSnapshotHolder::Get(HybridTime read_time) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (snapshot_ == nullptr || read_time < snapshot_->hybrid_time()) {
+    return nullptr;
+  }
+  return snapshot_;
+}
+
+void ColumnarSnapshotHolder::Invalidate() {
+  std::shared_ptr<const ColumnarSnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++write_generation_;
+    snapshot.swap(snapshot_);
+  }
+  // The files of the snapshot are removed out of the lock, once the scans that use it complete.
+}
+
+uint64_t ColumnarSnapshotHolder::write_generation() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return write_generation_;
+}
+
+bool ColumnarSnapshotHolder::Install(
+    std::shared_ptr<const ColumnarSnapshot> snapshot, uint64_t write_generation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (write_generation != write_generation_) {
+    return false;
+  }
+  // The previous snapshot, if any, is released out of the lock.
+  snapshot_.swap(snapshot);
+  return true;
+}
+
+}  // namespace docdb
+}  // namespace yb
@@ -0,0 +1,222 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_COLUMNAR_SNAPSHOT_H_
+#define YB_DOCDB_COLUMNAR_SNAPSHOT_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/cfile/cfile_reader.h"
+#include "yb/common/hybrid_time.h"
+#include "yb/common/ql_rowwise_iterator_interface.h"
+#include "yb/common/schema.h"
+#include "yb/docdb/key_bytes.h"
+#include "yb/fs/block_manager.h"
+#include "yb/gutil/gscoped_ptr.h"
+#include "yb/rocksdb/db.h"
+#include "yb/util/memory/arena.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class Env;
+
+namespace docdb {
+
+// Read-optimized copy of the QL rows of a tablet as of some hybrid time, stored column by column.
+//
+// Each non-key column is a CFile with the encoding that suits its type: bit-shuffled numbers, RLE
+// booleans and dictionary encoded strings and blobs. Values of other types, e.g. decimals or
+// collections, are stored as serialized QLValuePB in a dictionary encoded binary column. The
+// encoded document keys of the rows are stored in sorted order in a separate CFile with a value
+// index, so scans could start at any key.
+//
+// Scans decode only the columns they project, so a scan of a few columns of a wide table reads a
+// fraction of the bytes it would read from RocksDB, where the columns of a row are stored together.
+//
+// The snapshot does not keep TTLs or write times, so tables with TTL or static columns are not
+// supported. The files are removed when the snapshot is destroyed.
+class ColumnarSnapshot {
+ public:
+  ~ColumnarSnapshot();
+
+  // Writes the rows of the table with the specified schema visible in db at read_time to a new
+  // snapshot in dir, which should not exist.
+  static CHECKED_STATUS Build(const Schema& schema,
+                              rocksdb::DB* db,
+                              HybridTime read_time,
+                              Env* env,
+                              const std::string& dir,
+                              std::shared_ptr<ColumnarSnapshot>* snapshot);
+
+  // Whether the snapshot has all columns of the projection, i.e. none of them was added to the
+  // table after the snapshot was built.
+  bool HasColumns(const Schema& projection) const;
+
+  // Size of the file of the column, 0 if the snapshot does not have the column.
+  uint64_t ColumnFileSize(ColumnId column_id) const;
+
+  HybridTime hybrid_time() const { return hybrid_time_; }
+
+  size_t num_rows() const { return num_rows_; }
+
+ private:
+  friend class ColumnarSnapshotIterator;
+
+  struct Column {
+    ColumnId id;
+    // The main QL type of the column, e.g. TIMESTAMP, while values are stored as INT64.
+    DataType ql_type;
+    // Whether values are stored as serialized QLValuePB.
+    bool serialized;
+    fs::BlockId block_id;
+    std::unique_ptr<cfile::CFileReader> reader;
+  };
+
+  ColumnarSnapshot(Env* env, std::string dir, HybridTime hybrid_time);
+
+  CHECKED_STATUS Write(const Schema& schema, rocksdb::DB* db);
+  CHECKED_STATUS OpenReaders();
+
+  const Column* FindColumn(ColumnId column_id) const;
+
+  Env* const env_;
+  const std::string dir_;
+  const HybridTime hybrid_time_;
+  size_t num_rows_ = 0;
+
+  // The schema of the table when the snapshot was built.
+  Schema schema_;
+
+  gscoped_ptr<fs::BlockManager> block_manager_;
+  fs::BlockId key_block_id_;
+  gscoped_ptr<cfile::CFileReader> key_reader_;
+  std::vector<Column> columns_;
+  std::unordered_map<ColumnId, size_t> column_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ColumnarSnapshot);
+};
+
+// Iterates over the rows of a columnar snapshot, decoding only the projected columns. Rows are
+// decoded in batches, a column at a time.
+class ColumnarSnapshotIterator : public common::QLRowwiseIteratorIf {
+ public:
+  // projection and schema should stay valid while the iterator is used, like for
+  // DocRowwiseIterator. read_time is only used for the paging state.
+  ColumnarSnapshotIterator(std::shared_ptr<const ColumnarSnapshot> snapshot,
+                           const Schema& projection,
+                           const Schema& schema,
+                           HybridTime read_time);
+  ~ColumnarSnapshotIterator();
+
+  CHECKED_STATUS Init(ScanSpec* spec) override;
+
+  CHECKED_STATUS Init(const common::QLScanSpec& spec) override;
+
+  bool HasNext() const override;
+
+  std::string ToString() const override;
+
+  const Schema& schema() const override {
+    return projection_;
+  }
+
+  CHECKED_STATUS NextBlock(RowBlock* dst) override;
+
+  void GetIteratorStats(std::vector<IteratorStats>* stats) const override;
+
+  bool IsNextStaticColumn() const override {
+    return false;
+  }
+
+  CHECKED_STATUS NextRow(const Schema& projection, QLTableRow* table_row) override;
+
+  void SkipRow() override;
+
+  CHECKED_STATUS SetPagingStateIfNecessary(const QLReadRequestPB& request,
+                                           QLResponsePB* response) const override;
+
+ private:
+  // Values of a batch of rows of a column.
+  struct ColumnBatch {
+    const ColumnarSnapshot::Column* column;
+    std::unique_ptr<cfile::CFileIterator> iter;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> null_bitmap;
+  };
+
+  static CHECKED_STATUS CellToQLValue(const ColumnarSnapshot::Column& column,
+                                      const uint8_t* cell,
+                                      QLValuePB* value);
+
+  CHECKED_STATUS ReadBatch() const;
+
+  // The encoded document key of the current row.
+  Slice current_key() const;
+
+  const std::shared_ptr<const ColumnarSnapshot> snapshot_;
+  const Schema& projection_;
+  const Schema& schema_;
+  const HybridTime read_time_;
+
+  gscoped_ptr<cfile::CFileIterator> key_iter_;
+
+  // Exclusive upper bound of the encoded document keys to scan, empty if unbounded.
+  KeyBytes exclusive_upper_bound_key_;
+
+  // The mutable fields that follow are modified by HasNext, a const method.
+  mutable std::vector<uint8_t> key_data_;
+  mutable std::vector<ColumnBatch> columns_;
+  mutable Arena arena_;
+  mutable size_t batch_size_ = 0;
+  mutable size_t batch_index_ = 0;
+  mutable bool done_ = true;
+  mutable Status status_;
+};
+
+// Holds the columnar snapshot of a tablet, if any, and drops it when the tablet is written to.
+//
+// The snapshot reflects all writes up to its hybrid time. Reads wait for the writes below their
+// read time to be applied, so the snapshot could serve any read at or after its hybrid time until
+// the next write. A snapshot is only installed if no write was applied since the write generation
+// was taken before reading the rows of the snapshot.
+//
+// This class is thread-safe.
+class ColumnarSnapshotHolder {
+ public:
+  // Returns the snapshot that could serve reads at read_time, nullptr if there is none.
+  std::shared_ptr<const ColumnarSnapshot> Get(HybridTime read_time) const;
+
+  // Should be called before each write is applied.
+  void Invalidate();
+
+  uint64_t write_generation() const;
+
+  // Installs the snapshot unless a write was applied since write_generation was taken. Returns
+  // whether the snapshot was installed.
+  bool Install(std::shared_ptr<const ColumnarSnapshot> snapshot, uint64_t write_generation);
+
+ private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<const ColumnarSnapshot> snapshot_;
+  uint64_t write_generation_ = 0;
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif  // YB_DOCDB_COLUMNAR_SNAPSHOT_H_
@@ -13,9 +13,12 @@
 //
 //
 
+#include "yb/rocksdb/db/compaction.h"
 #include "yb/rocksdb/db/dbformat.h"
 
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/doc_kv_util.h"
+#include "yb/docdb/value.h"
 
 namespace yb {
 namespace docdb {
@@ -29,6 +32,11 @@ Status GetPrimitiveValue(const rocksdb::UserBoundaryValues& values,
 namespace {
 
 constexpr rocksdb::UserBoundaryTag kDocHybridTimeTag = 1;
+// Time when a value with its own TTL expires, or the time of a tombstone.
+constexpr rocksdb::UserBoundaryTag kExpirationTag = 2;
+// Write time of a value without its own TTL, i.e. that could only expire by the table TTL.
+// HybridTime::kMax for records that never expire, like those of transactions.
+constexpr rocksdb::UserBoundaryTag kHybridTimeWithoutTtlTag = 3;
 // Here we reserve some tags for future use.
 // Because Tag is persistent.
 constexpr rocksdb::UserBoundaryTag kRangeComponentsStart = 10;
@@ -79,6 +87,49 @@ class DocHybridTimeValue : public rocksdb::UserBoundaryValue {
   Slice encoded_;
 };
 
+// Wrapper for UserBoundaryValue that stores HybridTime with a given tag.
+class HybridTimeBoundaryValue : public rocksdb::UserBoundaryValue {
+ public:
+  HybridTimeBoundaryValue(rocksdb::UserBoundaryTag tag, HybridTime hybrid_time) : tag_(tag) {
+    BigEndian::Store64(buffer_, hybrid_time.ToUint64());
+  }
+
+  static CHECKED_STATUS Create(rocksdb::UserBoundaryTag tag, Slice data,
+                               rocksdb::UserBoundaryValuePtr* value) {
+    CHECK_NOTNULL(value);
+    if (data.size() != sizeof(uint64_t)) {
+      return STATUS_SUBSTITUTE(Corruption, "Wrong size of encoded hybrid time: $0", data.size());
+    }
+
+    *value = std::make_shared<HybridTimeBoundaryValue>(
+        tag, HybridTime(BigEndian::Load64(data.data())));
+    return Status::OK();
+  }
+
+  virtual ~HybridTimeBoundaryValue() {}
+
+  rocksdb::UserBoundaryTag Tag() override {
+    return tag_;
+  }
+
+  Slice Encode() override {
+    return Slice(buffer_, sizeof(buffer_));
+  }
+
+  int CompareTo(const UserBoundaryValue& pre_rhs) override {
+    const auto* rhs = down_cast<const HybridTimeBoundaryValue*>(&pre_rhs);
+    return Slice(buffer_, sizeof(buffer_)).compare(Slice(rhs->buffer_, sizeof(rhs->buffer_)));
+  }
+
+  HybridTime value() const {
+    return HybridTime(BigEndian::Load64(buffer_));
+  }
+
+ private:
+  rocksdb::UserBoundaryTag tag_;
+  char buffer_[sizeof(uint64_t)];
+};
+
 // Wrapper for UserBoundaryValue that stores PrimitiveValue with index.
 class PrimitiveBoundaryValue : public rocksdb::UserBoundaryValue {
  public:
@@ -146,6 +197,9 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
     if (tag == kDocHybridTimeTag) {
       return DocHybridTimeValue::Create(data, value);
     }
+    if (tag == kExpirationTag || tag == kHybridTimeWithoutTtlTag) {
+      return HybridTimeBoundaryValue::Create(tag, data, value);
+    }
     if (tag >= kRangeComponentsStart) {
       return PrimitiveBoundaryValue::Create(tag - kRangeComponentsStart, data, value);
     }
@@ -154,15 +208,21 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
   }
 
   Status Extract(Slice user_key, Slice value, rocksdb::UserBoundaryValues* values) override {
-    if (user_key.size() >= 2 &&
-        static_cast<ValueType>(user_key[0]) == ValueType::kIntentPrefix &&
-        static_cast<ValueType>(user_key[1]) == ValueType::kTransactionId) {
-      // Skipping reverse index from transaction id to keys of write intents belonging to that
-      // transaction.
-      return Status::OK();
+    CHECK_NOTNULL(values);
+    const bool is_intent =
+        !user_key.empty() && static_cast<ValueType>(user_key[0]) == ValueType::kIntentPrefix;
+    if (is_intent) {
+      // Provisional records of transactions are removed explicitly, files with them never expire.
+      values->push_back(std::make_shared<HybridTimeBoundaryValue>(
+          kHybridTimeWithoutTtlTag, HybridTime::kMax));
+      if (user_key.size() >= 2 &&
+          static_cast<ValueType>(user_key[1]) == ValueType::kTransactionId) {
+        // Skipping reverse index from transaction id to keys of write intents belonging to that
+        // transaction.
+        return Status::OK();
+      }
     }
 
-    CHECK_NOTNULL(values);
     boost::container::small_vector<Slice, 20> slices;
     auto user_key_copy = user_key;
     RETURN_NOT_OK(SubDocKey::PartiallyDecode(&user_key_copy, &slices));
@@ -175,6 +235,11 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
 
     rocksdb::UserBoundaryValuePtr temp;
     RETURN_NOT_OK(DocHybridTimeValue::Create(slices.back(), &temp));
+    if (!is_intent) {
+      DocHybridTime doc_ht;
+      RETURN_NOT_OK(down_cast<DocHybridTimeValue*>(temp.get())->value(&doc_ht));
+      values->push_back(ExpirationValue(doc_ht.hybrid_time(), value));
+    }
     values->push_back(std::move(temp));
 
     for (size_t i = 0; i != size; ++i) {
@@ -187,6 +252,26 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
     return Status::OK();
   }
 
+  // Returns the value used to decide whether all records of a file have expired.
+  static rocksdb::UserBoundaryValuePtr ExpirationValue(HybridTime write_time, Slice value) {
+    ValueType value_type;
+    MonoDelta ttl;
+    if (!Value::DecodePrimitiveValueType(value, &value_type).ok() ||
+        !Value::DecodeTTL(value, &ttl).ok()) {
+      return std::make_shared<HybridTimeBoundaryValue>(kHybridTimeWithoutTtlTag, HybridTime::kMax);
+    }
+    if (value_type == ValueType::kTombstone) {
+      return std::make_shared<HybridTimeBoundaryValue>(kExpirationTag, write_time);
+    }
+    if (ttl.Equals(Value::kMaxTtl)) {
+      return std::make_shared<HybridTimeBoundaryValue>(kHybridTimeWithoutTtlTag, write_time);
+    }
+    // A TTL of zero resets the TTL, so the value never expires.
+    const HybridTime expiration = ttl.ToMilliseconds() == kResetTTL
+        ? HybridTime::kMax : ExpirationTime(write_time, ttl);
+    return std::make_shared<HybridTimeBoundaryValue>(kExpirationTag, expiration);
+  }
+
   bool PerformSanityCheck(Slice user_key,
                           const boost::container::small_vector_base<Slice>& slices,
                           const rocksdb::UserBoundaryValues& values) {
@@ -248,6 +333,41 @@ Status GetDocHybridTime(const rocksdb::UserBoundaryValues& values, DocHybridTime
   return time_value->value(out);
 }
 
+bool AllRecordsExpired(const rocksdb::UserBoundaryValues& largest,
+                       HybridTime history_cutoff,
+                       const MonoDelta& table_ttl) {
+  const auto expiration = rocksdb::UserValueWithTag(largest, kExpirationTag);
+  const auto without_ttl = rocksdb::UserValueWithTag(largest, kHybridTimeWithoutTtlTag);
+  if (!expiration && !without_ttl) {
+    // Files written before expiration was tracked, or files without regular records.
+    return false;
+  }
+  if (expiration &&
+      down_cast<HybridTimeBoundaryValue*>(expiration.get())->value() >= history_cutoff) {
+    return false;
+  }
+  if (without_ttl) {
+    bool has_expired = false;
+    const HybridTime write_time = down_cast<HybridTimeBoundaryValue*>(without_ttl.get())->value();
+    if (write_time == HybridTime::kMax ||
+        !HasExpiredTTL(write_time, table_ttl, history_cutoff, &has_expired).ok() ||
+        !has_expired) {
+      return false;
+    }
+  }
+  return true;
+}
+
+HybridTime MinRecordHybridTime(const rocksdb::FdWithBoundaries& file) {
+  const Slice* encoded = file.smallest.user_value_with_tag(kDocHybridTimeTag);
+  DocHybridTime doc_ht;
+  if (encoded == nullptr || !doc_ht.FullyDecodeFrom(*encoded).ok()) {
+    // Files without regular records or intents, e.g. with just the transaction reverse index.
+    return HybridTime::kMin;
+  }
+  return doc_ht.hybrid_time();
+}
+
 rocksdb::UserBoundaryTag TagForRangeComponent(size_t index) {
   return PrimitiveBoundaryValue::TagForIndex(index);
 }
@@ -47,9 +47,9 @@ CHECKED_STATUS DocExprExecutor::EvalTSCall(const QLBCallPB& tscall,
     case bfql::TSOpcode::kAvg: FALLTHROUGH_INTENDED;
     case bfql::TSOpcode::kMin: FALLTHROUGH_INTENDED;
     case bfql::TSOpcode::kMax:
-      // TODO(neil) Call DocDB to execute aggregate functions.
-      // These functions operate across many rows, so some state variables must be kept beyond the
-      // scope of one row. The variable "table_row" is not enough for these operators.
+      // These functions operate across many rows, so they are accumulated over the rows read by
+      // QLReadOperation with EvalAggregate() instead. The variable "table_row" is not enough for
+      // these operators.
       LOG(ERROR) << "Failed to execute aggregate function";
   }
 
@@ -400,6 +400,140 @@ TEST(DocKeyTest, TestKeyMatching) {
   ASSERT_FALSE(may_match(EncodeSimpleSubDocKey(absent_key))) << "Key: " << absent_key;
 }
 
+TEST(DocKeyTest, TestKeyMatchingWithRangeComponents) {
+  DocDbAwareFilterPolicy policy(
+      rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr, 1 /* num_range_components */);
+  ASSERT_STRNE("DocKeyHashedComponentsFilter", policy.Name());
+
+  std::unique_ptr<FilterBitsBuilder> builder(policy.GetFilterBitsBuilder());
+  ASSERT_NE(builder, nullptr);
+  builder->AddKey(policy.GetKeyTransformer()->Transform(EncodeSimpleSubDocKey("foo")));
+  std::unique_ptr<const char[]> buf;
+  rocksdb::Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(policy.GetFilterBitsReader(filter));
+
+  auto may_match = [&](const std::string& sub_doc_key_str) {
+    return reader->MayMatch(policy.GetKeyTransformer()->Transform(sub_doc_key_str));
+  };
+
+  // Same hash and first range component, different subkey and time.
+  ASSERT_TRUE(may_match(EncodeSubDocKey("foo", "range_key", "another_sub_key", 55555L)));
+  // Same hash, different first range component.
+  ASSERT_FALSE(may_match(EncodeSimpleSubDocKeyWithDifferentNonHashPart("foo")));
+}
+
+TEST(DocKeyTest, TestEncodedHashAndRangePrefixSize) {
+  const DocKey doc_key(0, PrimitiveValues("h"), PrimitiveValues("r1", "r2"));
+  const KeyBytes encoded = SubDocKey(doc_key, PrimitiveValue("s")).Encode();
+  const DocKey hashed_only(0, PrimitiveValues("h"), std::vector<PrimitiveValue>());
+
+  auto size = DocKey::EncodedHashAndRangePrefixSize(encoded.AsSlice(), 0);
+  ASSERT_OK(size);
+  ASSERT_EQ(*DocKey::EncodedSize(encoded.AsSlice(), DocKeyPart::HASHED_PART_ONLY), *size);
+
+  size = DocKey::EncodedHashAndRangePrefixSize(encoded.AsSlice(), 1);
+  ASSERT_OK(size);
+  KeyBytes expected = hashed_only.Encode();
+  expected.RemoveValueTypeSuffix(ValueType::kGroupEnd);
+  PrimitiveValue("r1").AppendToKey(&expected);
+  ASSERT_EQ(expected.AsSlice().ToDebugHexString(),
+            Slice(encoded.data().data(), *size).ToDebugHexString());
+
+  // Asking for more range components than present returns the whole document key.
+  size = DocKey::EncodedHashAndRangePrefixSize(encoded.AsSlice(), 5);
+  ASSERT_OK(size);
+  ASSERT_EQ(doc_key.Encode().size(), *size);
+}
+
+TEST(DocKeyTest, TestCotableId) {
+  Uuid table1, table2;
+  ASSERT_OK(table1.FromString("00000000-0000-0000-0000-000000000001"));
+  ASSERT_OK(table2.FromString("00000000-0000-0000-0000-000000000002"));
+
+  DocKey doc_key(PrimitiveValues("r1", 10));
+  doc_key.set_cotable_id(table1);
+  ASSERT_EQ("DocKey(CoTableId=00000000-0000-0000-0000-000000000001, [], [\"r1\", 10])",
+            doc_key.ToString());
+  ASSERT_FALSE(doc_key.empty());
+
+  const KeyBytes encoded = SubDocKey(doc_key, PrimitiveValue("s")).Encode();
+  KeyBytes prefix;
+  DocKey::AppendCotableId(table1, &prefix);
+  ASSERT_EQ(1 + kUuidSize, prefix.size());
+  ASSERT_TRUE(encoded.AsSlice().starts_with(prefix.AsSlice()));
+
+  DocKey decoded;
+  Slice slice = encoded.AsSlice();
+  ASSERT_OK(decoded.DecodeFrom(&slice));
+  ASSERT_EQ(doc_key, decoded);
+  ASSERT_EQ(table1, *decoded.cotable_id());
+  ASSERT_EQ(doc_key.Encode().size(), *DocKey::EncodedSize(encoded.AsSlice(),
+                                                          DocKeyPart::WHOLE_DOC_KEY));
+
+  // The same key of another table is a different document, ordered by the table id.
+  DocKey other_table_key(PrimitiveValues("r1", 10));
+  other_table_key.set_cotable_id(table2);
+  ASSERT_NE(doc_key, other_table_key);
+  ASSERT_LT(doc_key, other_table_key);
+  ASSERT_LT(doc_key.Encode().AsSlice().compare(other_table_key.Encode().AsSlice()), 0);
+
+  // The hashed part of a key includes the table id, so bloom filters tell tables apart.
+  DocKey hashed_key(0x1234, PrimitiveValues("h"), PrimitiveValues("r"));
+  hashed_key.set_cotable_id(table2);
+  KeyBytes hashed_prefix;
+  DocKey::AppendCotableId(table2, &hashed_prefix);
+  DocKey(0x1234, PrimitiveValues("h"), std::vector<PrimitiveValue>()).AppendTo(&hashed_prefix);
+  hashed_prefix.RemoveValueTypeSuffix(ValueType::kGroupEnd);
+  ASSERT_EQ(hashed_prefix.size(),
+            *DocKey::EncodedSize(hashed_key.Encode().AsSlice(), DocKeyPart::HASHED_PART_ONLY));
+
+  // Truncated table id.
+  slice = Slice(prefix.data().data(), 5);
+  ASSERT_NOK(decoded.DecodeFrom(&slice));
+}
+
+TEST(DocKeyTest, TestDocKeyHashedPartTransform) {
+  std::unique_ptr<rocksdb::SliceTransform> transform(NewDocKeyHashedPartTransform());
+  const DocKey doc_key(0, PrimitiveValues("h"), PrimitiveValues("r1"));
+  const KeyBytes encoded1 = SubDocKey(doc_key, PrimitiveValue("s1")).Encode();
+  const KeyBytes encoded2 = SubDocKey(doc_key, PrimitiveValue("s2"), HybridTime(1000)).Encode();
+  const KeyBytes hashed_part =
+      DocKey(0, PrimitiveValues("h"), std::vector<PrimitiveValue>()).Encode();
+
+  // All keys of a document share the prefix, which is the hashed part of the document key.
+  const Slice prefix = transform->Transform(encoded1.AsSlice());
+  ASSERT_EQ(prefix, transform->Transform(encoded2.AsSlice()));
+  ASSERT_EQ(*DocKey::EncodedSize(encoded1.AsSlice(), DocKeyPart::HASHED_PART_ONLY), prefix.size());
+  ASSERT_TRUE(hashed_part.AsSlice().starts_with(prefix));
+
+  // Keys of a document without hashed components and undecodable keys get an empty prefix.
+  const KeyBytes range_only = DocKey(PrimitiveValues("r1")).Encode();
+  ASSERT_TRUE(transform->Transform(range_only.AsSlice()).empty());
+  ASSERT_TRUE(transform->Transform(Slice("\xff")).empty());
+}
+
+TEST(DocKeyTest, TestDocKeyTransform) {
+  std::unique_ptr<rocksdb::SliceTransform> transform(NewDocKeyTransform());
+  const DocKey doc_key(0, PrimitiveValues("h"), PrimitiveValues("r1"));
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  const KeyBytes encoded1 = SubDocKey(doc_key, HybridTime(2000)).Encode();
+  const KeyBytes encoded2 = SubDocKey(doc_key, PrimitiveValue("s2"), HybridTime(1000)).Encode();
+
+  // All keys of a document share the prefix, which is the whole document key.
+  ASSERT_TRUE(transform->InDomain(encoded1.AsSlice()));
+  ASSERT_EQ(encoded_doc_key.AsSlice(), transform->Transform(encoded1.AsSlice()));
+  ASSERT_EQ(encoded_doc_key.AsSlice(), transform->Transform(encoded2.AsSlice()));
+
+  // The prefix sorts before all keys of the document and after all keys of preceding documents.
+  const KeyBytes prev_key =
+      SubDocKey(DocKey(0, PrimitiveValues("h"), PrimitiveValues("r0")), PrimitiveValue("s"),
+                HybridTime(1000)).Encode();
+  ASSERT_LT(encoded_doc_key.AsSlice().compare(encoded1.AsSlice()), 0);
+  ASSERT_LT(prev_key.AsSlice().compare(encoded_doc_key.AsSlice()), 0);
+
+  ASSERT_FALSE(transform->InDomain(Slice("\xff")));
+}
+
 TEST(DocKeyTest, TestWriteId) {
   SubDocKey subdoc_key(DocKey({PrimitiveValue("a"), PrimitiveValue(135)}),
                        DocHybridTime(1000000, 4091, 135));
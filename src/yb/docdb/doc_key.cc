@@ -118,7 +118,17 @@ KeyBytes DocKey::Encode() const {
   return result;
 }
 
+void DocKey::AppendCotableId(const Uuid& cotable_id, KeyBytes* out) {
+  std::string bytes;
+  CHECK_OK(cotable_id.ToBytes(&bytes));
+  out->AppendValueType(ValueType::kTableId);
+  out->AppendRawBytes(bytes);
+}
+
 void DocKey::AppendTo(KeyBytes* out) const {
+  if (cotable_id_) {
+    AppendCotableId(*cotable_id_, out);
+  }
   if (hash_present_) {
     // We are not setting the "more items in group" bit on the hash field because it is not part
     // of "hashed" or "range" groups.
@@ -130,6 +140,7 @@ void DocKey::AppendTo(KeyBytes* out) const {
 }
 
 void DocKey::Clear() {
+  cotable_id_ = boost::none;
   hash_present_ = false;
   hash_ = 0xdead;
   hashed_group_.clear();
@@ -155,6 +166,10 @@ class DecodeDocKeyCallback {
   }
 
   void SetHash(...) const {}
+
+  CHECKED_STATUS SetCotableId(const Slice& cotable_id) const {
+    return Status::OK();
+  }
  private:
   boost::container::small_vector_base<Slice>* out_;
 };
@@ -171,6 +186,10 @@ class DummyCallback {
 
   void SetHash(...) const {}
 
+  CHECKED_STATUS SetCotableId(const Slice& cotable_id) const {
+    return Status::OK();
+  }
+
   PrimitiveValue* AddSubkey() const {
     return nullptr;
   }
@@ -190,6 +209,22 @@ Result<size_t> DocKey::EncodedSize(Slice slice, DocKeyPart part) {
   return slice.cdata() - initial_begin;
 }
 
+Result<size_t> DocKey::EncodedHashAndRangePrefixSize(Slice slice, size_t num_range_components) {
+  auto initial_begin = slice.cdata();
+  RETURN_NOT_OK(DoDecode(&slice, DocKeyPart::HASHED_PART_ONLY, DummyCallback()));
+  for (size_t i = 0; i != num_range_components; ++i) {
+    if (PREDICT_FALSE(slice.empty())) {
+      return STATUS(Corruption, "Unexpected end of key when decoding document key");
+    }
+    if (static_cast<ValueType>(*slice.data()) == ValueType::kGroupEnd) {
+      slice.consume_byte();
+      break;
+    }
+    RETURN_NOT_OK(PrimitiveValue::DecodeKey(&slice, nullptr));
+  }
+  return slice.cdata() - initial_begin;
+}
+
 class DocKey::DecodeFromCallback {
  public:
   explicit DecodeFromCallback(DocKey* key) : key_(key) {
@@ -209,6 +244,13 @@ class DocKey::DecodeFromCallback {
       key_->hash_ = hash;
     }
   }
+
+  CHECKED_STATUS SetCotableId(const Slice& cotable_id) const {
+    Uuid id;
+    RETURN_NOT_OK(id.FromSlice(cotable_id, kUuidSize));
+    key_->cotable_id_ = id;
+    return Status::OK();
+  }
  private:
   DocKey* key_;
 };
@@ -230,6 +272,18 @@ yb::Status DocKey::DoDecode(rocksdb::Slice *slice,
     slice->consume_byte();
   }
 
+  if (!slice->empty() && (*slice)[0] == static_cast<uint8_t>(ValueType::kTableId)) {
+    if (slice->size() < kUuidSize + 1) {
+      return STATUS_SUBSTITUTE(Corruption,
+          "Could not decode the table id of a document key: only $0 bytes left", slice->size());
+    }
+    RETURN_NOT_OK(callback.SetCotableId(Slice(slice->data() + 1, kUuidSize)));
+    slice->remove_prefix(kUuidSize + 1);
+  }
+  if (slice->empty()) {
+    return STATUS(Corruption, "Document key has no components");
+  }
+
   const ValueType first_value_type = static_cast<ValueType>(*slice->data());
 
   if (!IsPrimitiveValueType(first_value_type) && first_value_type != ValueType::kGroupEnd) {
@@ -285,6 +339,11 @@ yb::Status DocKey::FullyDecodeFrom(const rocksdb::Slice& slice) {
 
 string DocKey::ToString() const {
   string result = "DocKey(";
+  if (cotable_id_) {
+    result += "CoTableId=";
+    result += cotable_id_->ToString();
+    result += ", ";
+  }
   if (hash_present_) {
     result += StringPrintf("0x%04x", hash_);
     result += ", ";
@@ -302,7 +361,8 @@ bool DocKey::operator ==(const DocKey& other) const {
 }
 
 bool DocKey::HashedComponentsEqual(const DocKey& other) const {
-  return hash_present_ == other.hash_present_ &&
+  return cotable_id_ == other.cotable_id_ &&
+      hash_present_ == other.hash_present_ &&
       // Only compare hashes and hashed groups if the hash presence flag is set.
       (!hash_present_ || (hash_ == other.hash_ && hashed_group_ == other.hashed_group_));
 }
@@ -316,6 +376,16 @@ int DocKey::CompareTo(const DocKey& other) const {
   //       integration of CQL's hash partition keys in December 2016.
   DCHECK_EQ(hash_present_, other.hash_present_);
 
+  // Similarly, a tablet either contains keys of colocated tables only or no such keys. Keys of
+  // colocated tables are ordered by the bytes of the table id, as in the encoded key.
+  DCHECK_EQ(static_cast<bool>(cotable_id_), static_cast<bool>(other.cotable_id_));
+  if (cotable_id_ && other.cotable_id_ && *cotable_id_ != *other.cotable_id_) {
+    std::string bytes, other_bytes;
+    CHECK_OK(cotable_id_->ToBytes(&bytes));
+    CHECK_OK(other.cotable_id_->ToBytes(&other_bytes));
+    return bytes.compare(other_bytes) < 0 ? -1 : 1;
+  }
+
   int result = 0;
   if (hash_present_) {
     result = CompareUsingLessThan(hash_, other.hash_);
@@ -684,8 +754,77 @@ class HashedComponentsExtractor : public rocksdb::FilterPolicy::KeyTransformer {
   }
 };
 
+class HashedAndRangeComponentsExtractor : public rocksdb::FilterPolicy::KeyTransformer {
+ public:
+  explicit HashedAndRangeComponentsExtractor(size_t num_range_components)
+      : num_range_components_(num_range_components) {}
+
+  HashedAndRangeComponentsExtractor(const HashedAndRangeComponentsExtractor&) = delete;
+  HashedAndRangeComponentsExtractor& operator=(const HashedAndRangeComponentsExtractor&) = delete;
+
+  Slice Transform(Slice key) const override {
+    auto size = DocKey::EncodedHashAndRangePrefixSize(key, num_range_components_);
+    CHECK_OK(size);
+    return Slice(key.data(), *size);
+  }
+
+ private:
+  const size_t num_range_components_;
+};
+
+class DocKeyHashedPartTransform : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "DocKeyHashedPartTransform"; }
+
+  Slice Transform(const Slice& key) const override {
+    auto size = DocKey::EncodedSize(key, DocKeyPart::HASHED_PART_ONLY);
+    return Slice(key.data(), size.ok() ? *size : 0);
+  }
+
+  bool InDomain(const Slice& key) const override { return true; }
+
+  bool InRange(const Slice& prefix) const override { return false; }
+};
+
+class DocKeyTransform : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "DocKeyTransform"; }
+
+  Slice Transform(const Slice& key) const override {
+    auto size = DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY);
+    return Slice(key.data(), size.ok() ? *size : key.size());
+  }
+
+  bool InDomain(const Slice& key) const override {
+    return DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY).ok();
+  }
+
+  bool InRange(const Slice& prefix) const override { return false; }
+};
+
+std::string FilterPolicyName(size_t num_range_components) {
+  // Hash-only filter keeps its original name, so existing SST files still use their filters.
+  if (num_range_components == 0) {
+    return "DocKeyHashedComponentsFilter";
+  }
+  return Substitute("DocKeyHashedAndRangeComponentsFilter$0", num_range_components);
+}
+
 } // namespace
 
+DocDbAwareFilterPolicy::DocDbAwareFilterPolicy(
+    size_t filter_block_size_bits, rocksdb::Logger* logger, size_t num_range_components)
+    : num_range_components_(num_range_components),
+      name_(FilterPolicyName(num_range_components)) {
+  builtin_policy_.reset(rocksdb::NewFixedSizeFilterPolicy(
+      filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate, logger));
+  if (num_range_components != 0) {
+    key_transformer_ = std::make_unique<HashedAndRangeComponentsExtractor>(num_range_components);
+  }
+}
+
+DocDbAwareFilterPolicy::~DocDbAwareFilterPolicy() {
+}
 
 void DocDbAwareFilterPolicy::CreateFilter(
     const rocksdb::Slice* keys, int n, std::string* dst) const {
@@ -712,9 +851,20 @@ rocksdb::FilterPolicy::FilterType DocDbAwareFilterPolicy::GetFilterType() const
 }
 
 const rocksdb::FilterPolicy::KeyTransformer* DocDbAwareFilterPolicy::GetKeyTransformer() const {
+  if (key_transformer_) {
+    return key_transformer_.get();
+  }
   return &HashedComponentsExtractor::GetInstance();
 }
 
+rocksdb::SliceTransform* NewDocKeyHashedPartTransform() {
+  return new DocKeyHashedPartTransform();
+}
+
+rocksdb::SliceTransform* NewDocKeyTransform() {
+  return new DocKeyTransform();
+}
+
 }  // namespace docdb
 
 }  // namespace yb
@@ -18,14 +18,17 @@
 #include <vector>
 
 #include <boost/container/small_vector.hpp>
+#include <boost/optional.hpp>
 
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/filter_policy.h"
+#include "yb/rocksdb/slice_transform.h"
 #include "yb/util/slice.h"
 
 #include "yb/common/encoded_key.h"
 #include "yb/common/schema.h"
 #include "yb/docdb/primitive_value.h"
+#include "yb/util/uuid.h"
 
 namespace yb {
 namespace docdb {
@@ -40,12 +43,15 @@ class DocPath;
 
 // A key that allows us to locate a document. This is the prefix of all RocksDB keys of records
 // inside this document. A document key contains:
+//   - An optional id of the table, when the table is colocated with other tables in one tablet.
 //   - An optional fixed-width hash prefix.
 //   - A group of primitive values representing "hashed" components (this is what the hash is
 //     computed based on, so this group is present/absent together with the hash).
 //   - A group of "range" components suitable for doing ordered scans.
 //
 // The encoded representation of the key is as follows:
+//   - Optional table id: the byte ValueType::kTableId, followed by the 16 bytes of the id. Keys of
+//     a colocated table share this prefix, so the table is a contiguous range of the tablet.
 //   - Optional fixed-width hash prefix, followed by hashed components:
 //     * The byte ValueType::kUInt16Hash, followed by two bytes of the hash prefix.
 //     * Hashed components:
@@ -89,6 +95,19 @@ class DocKey {
   // Clear the range components of the document key only.
   void ClearRangeComponents();
 
+  // Id of the table the document belongs to, when the table is colocated with other tables in
+  // one tablet.
+  const boost::optional<Uuid>& cotable_id() const {
+    return cotable_id_;
+  }
+
+  void set_cotable_id(const Uuid& cotable_id) {
+    cotable_id_ = cotable_id;
+  }
+
+  // Appends the prefix of the encoded document keys of the specified colocated table.
+  static void AppendCotableId(const Uuid& cotable_id, KeyBytes* out);
+
   DocKeyHash hash() const {
     return hash_;
   }
@@ -113,6 +132,11 @@ class DocKey {
 
   static Result<size_t> EncodedSize(Slice slice, DocKeyPart part);
 
+  // Returns the size of the encoded prefix that consists of the hashed part of the document key
+  // and up to num_range_components range components. If the range group has fewer components, the
+  // prefix also includes its terminating kGroupEnd, i.e. it is the whole document key.
+  static Result<size_t> EncodedHashAndRangePrefixSize(Slice slice, size_t num_range_components);
+
   // Decode the current document key from the given slice, but expect all bytes to be consumed, and
   // return an error status if that is not the case.
   CHECKED_STATUS FullyDecodeFrom(const rocksdb::Slice& slice);
@@ -122,7 +146,7 @@ class DocKey {
 
   // Check if it is an empty key.
   bool empty() const {
-    return !hash_present_ && range_group_.empty();
+    return !cotable_id_ && !hash_present_ && range_group_.empty();
   }
 
   bool operator ==(const DocKey& other) const;
@@ -168,6 +192,7 @@ class DocKey {
                                  DocKeyPart part_to_decode,
                                  const Callback& callback);
 
+  boost::optional<Uuid> cotable_id_;
   bool hash_present_;
   DocKeyHash hash_;
   std::vector<PrimitiveValue> hashed_group_;
@@ -503,15 +528,18 @@ inline std::ostream& operator <<(std::ostream& out, const SubDocKey& subdoc_key)
 std::string BestEffortDocDBKeyToStr(const KeyBytes &key_bytes);
 std::string BestEffortDocDBKeyToStr(const rocksdb::Slice &slice);
 
-// This filter policy only takes into account hashed components of keys for filtering.
+// This filter policy only takes into account hashed components of keys for filtering, plus the
+// first num_range_components range components when it is not zero. Filters built with different
+// num_range_components have different names, so RocksDB never applies filter built for one
+// setting to lookups done with another one.
 class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
  public:
-  explicit DocDbAwareFilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger) {
-    builtin_policy_.reset(rocksdb::NewFixedSizeFilterPolicy(
-        filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate, logger));
-  }
+  DocDbAwareFilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger,
+                         size_t num_range_components = 0);
+
+  ~DocDbAwareFilterPolicy();
 
-  const char* Name() const override { return "DocKeyHashedComponentsFilter"; }
+  const char* Name() const override { return name_.c_str(); }
 
   void CreateFilter(const rocksdb::Slice* keys, int n, std::string* dst) const override;
 
@@ -525,10 +553,26 @@ class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
 
   const KeyTransformer* GetKeyTransformer() const override;
 
+  size_t num_range_components() const { return num_range_components_; }
+
  private:
   std::unique_ptr<const rocksdb::FilterPolicy> builtin_policy_;
+  const size_t num_range_components_;
+  const std::string name_;
+  std::unique_ptr<const KeyTransformer> key_transformer_;
 };
 
+// Creates a transform that maps a RocksDB key to the encoded hashed part of its document key, so
+// all keys of a document that has hashed components share the same prefix. Keys without hashed
+// components or that could not be decoded are mapped to an empty prefix. Used as the memtable
+// prefix extractor of a hash based memtable.
+rocksdb::SliceTransform* NewDocKeyHashedPartTransform();
+
+// Creates a transform that maps a RocksDB key to its encoded document key, so all keys of a
+// document share the same prefix. Keys that could not be decoded, e.g. those of provisional
+// records, are not in its domain. Used to align subcompaction boundaries with documents.
+rocksdb::SliceTransform* NewDocKeyTransform();
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -199,6 +199,16 @@ CHECKED_STATUS HasExpiredTTL(const HybridTime& key_hybrid_time, const MonoDelta&
   return Status::OK();
 }
 
+HybridTime ExpirationTime(const HybridTime& write_time, const MonoDelta& ttl) {
+  const uint64_t kMaxPhysicalMicros = server::HybridClock::GetPhysicalValueMicros(HybridTime::kMax);
+  const uint64_t physical_micros = server::HybridClock::GetPhysicalValueMicros(write_time);
+  const uint64_t ttl_micros = ttl.ToMicroseconds();
+  if (ttl_micros >= kMaxPhysicalMicros - physical_micros) {
+    return HybridTime::kMax;
+  }
+  return server::HybridClock::AddPhysicalTimeToHybridTime(write_time, ttl);
+}
+
 const MonoDelta TableTTL(const Schema& schema) {
   MonoDelta ttl = Value::kMaxTtl;
   if (schema.table_properties().HasDefaultTimeToLive()) {
@@ -244,6 +244,10 @@ inline std::string ToShortDebugStr(const std::string& raw_str) {
 CHECKED_STATUS HasExpiredTTL(const HybridTime& key_hybrid_time, const MonoDelta& ttl,
                              const HybridTime& read_hybrid_time, bool* has_expired);
 
+// Returns the time when a value written at write_time with the given ttl expires, HybridTime::kMax
+// if it does not fit into hybrid time.
+HybridTime ExpirationTime(const HybridTime& write_time, const MonoDelta& ttl);
+
 // Computes the table level TTL, given a schema.
 const MonoDelta TableTTL(const Schema& schema);
 
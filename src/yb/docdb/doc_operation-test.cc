@@ -767,6 +767,78 @@ TEST_F(DocOperationTest, MaxFileSizeForCompaction) {
   ASSERT_EQ(expected_files, files.size());
 }
 
+TEST_F(DocOperationTest, QLPartitionDelete) {
+  ColumnSchema hash_column("k", INT32, false, true);
+  ColumnSchema range_column("r", INT32, false, false);
+  ColumnSchema value1_column("v1", INT32, false, false);
+  ColumnSchema value2_column("v2", INT32, false, false);
+  auto columns = { hash_column, range_column, value1_column, value2_column };
+  Schema schema(columns, CreateColumnIds(columns.size()), 2);
+
+  const HybridTime t0 = HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(1000, 0);
+  const HybridTime t1 = HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(2000, 0);
+  const HybridTime t2 = HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(3000, 0);
+  const HybridTime t3 = HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(4000, 0);
+  constexpr int64_t kTtlMs = 1000000;
+
+  WriteQLRow(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, schema, {1, 1, 10, 11}, kTtlMs, t0);
+  WriteQLRow(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, schema, {1, 2, 20, 21}, kTtlMs, t0);
+  WriteQLRow(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, schema, {2, 1, 30, 31}, kTtlMs, t0);
+  ASSERT_OK(FlushRocksDB());
+
+  // Delete the partition of k = 1 with a single tombstone at its hashed key.
+  QLWriteRequestPB delete_req;
+  QLResponsePB delete_resp;
+  delete_req.set_type(QLWriteRequestPB::QL_STMT_DELETE);
+  delete_req.set_hash_code(0);
+  AddPrimaryKeyColumn(&delete_req, 1);
+  WriteQL(&delete_req, schema, &delete_resp, t1);
+  ASSERT_OK(FlushRocksDB());
+
+  ASSERT_EQ(2, ReadQLRow(schema, 1, t0).row_count());
+  ASSERT_EQ(0, ReadQLRow(schema, 1, t1).row_count());
+  ASSERT_EQ(1, ReadQLRow(schema, 2, t1).row_count());
+
+  WriteQLRow(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, schema, {1, 3, 40, 41}, kTtlMs, t2);
+
+  QLRowBlock row_block = ReadQLRow(schema, 1, t2);
+  ASSERT_EQ(1, row_block.row_count());
+  EXPECT_EQ(3, row_block.row(0).column(1).int32_value());
+
+  // Scans that start in the middle of the partition also see the delete.
+  auto count_rows = [this, &schema, t2](int32_t range_value) {
+    QLConditionPB condition;
+    condition.add_operands()->set_column_id(1_ColId);
+    condition.set_op(QL_OP_EQUAL);
+    condition.add_operands()->mutable_value()->set_int32_value(range_value);
+    std::vector<PrimitiveValue> hashed_components = { PrimitiveValue::Int32(1) };
+    DocQLScanSpec ql_scan_spec(schema, -1, -1, hashed_components, &condition,
+                               rocksdb::kDefaultQueryId);
+    DocRowwiseIterator ql_iter(schema, schema, boost::none, rocksdb(), t2);
+    EXPECT_OK(ql_iter.Init(ql_scan_spec));
+    int result = 0;
+    while (ql_iter.HasNext()) {
+      QLTableRow value_map;
+      EXPECT_OK(ql_iter.NextRow(schema, &value_map));
+      ++result;
+    }
+    return result;
+  };
+  ASSERT_EQ(0, count_rows(1));
+  ASSERT_EQ(1, count_rows(3));
+
+  // Full compactions drop the rows deleted with the partition together with the tombstone.
+  CompactHistoryBefore(t3);
+  AssertDocDbDebugDumpStrEq(R"#(
+SubDocKey(DocKey(0x0000, [1], [3]), [SystemColumnId(0); HT(p=3000)]) -> null; ttl: 1000.000s
+SubDocKey(DocKey(0x0000, [1], [3]), [ColumnId(2); HT(p=3000, w=1)]) -> 40; ttl: 1000.000s
+SubDocKey(DocKey(0x0000, [1], [3]), [ColumnId(3); HT(p=3000, w=2)]) -> 41; ttl: 1000.000s
+SubDocKey(DocKey(0x0000, [2], [1]), [SystemColumnId(0); HT(p=1000)]) -> null; ttl: 1000.000s
+SubDocKey(DocKey(0x0000, [2], [1]), [ColumnId(2); HT(p=1000, w=1)]) -> 30; ttl: 1000.000s
+SubDocKey(DocKey(0x0000, [2], [1]), [ColumnId(3); HT(p=1000, w=2)]) -> 31; ttl: 1000.000s
+      )#");
+}
+
 TEST_F(DocOperationTest, MaxFileSizeWithWritesTrigger) {
   google::FlagSaver flag_saver;
 
@@ -11,6 +11,9 @@
 // under the License.
 //
 
+#include <algorithm>
+#include <map>
+
 #include "yb/common/partition.h"
 #include "yb/common/ql_scanspec.h"
 #include "yb/common/ql_storage_interface.h"
@@ -20,15 +23,22 @@
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/docdb_util.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/doc_kv_util.h"
 #include "yb/docdb/doc_expr.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/document_cache.h"
+#include "yb/docdb/redis_ts_block.h"
+#include "yb/docdb/redis_value_cache.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/server/hybrid_clock.h"
+#include "yb/gutil/strings/numbers.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/trace.h"
 
 DECLARE_bool(trace_docdb_calls);
+DECLARE_int32(docdb_bloom_filter_range_components);
 
 using strings::Substitute;
 
@@ -39,6 +49,17 @@ DEFINE_bool(emulate_redis_responses,
     "and HDEL. If emulate_redis_responses is true, we read the required records to compute the "
     "response as specified by the official Redis API documentation. https://redis.io/commands");
 
+DEFINE_int32(redis_document_cache_max_subkeys, 64,
+             "Max number of entries of a Redis hash or set kept in the tablet document cache.");
+TAG_FLAG(redis_document_cache_max_subkeys, advanced);
+TAG_FLAG(redis_document_cache_max_subkeys, runtime);
+
+DEFINE_int64(redis_ts_block_width, 0,
+             "If positive, points of new Redis time series are stored in compressed blocks, a "
+             "block per this range of timestamps. Existing time series keep their format.");
+TAG_FLAG(redis_ts_block_width, advanced);
+TAG_FLAG(redis_ts_block_width, runtime);
+
 namespace yb {
 namespace docdb {
 
@@ -79,6 +100,9 @@ CHECKED_STATUS PrimitiveValueFromSubKey(const RedisKeyValueSubKeyPB &subkey_pb,
       // value sorts on top.
       *primitive_value = PrimitiveValue(subkey_pb.timestamp_subkey(), SortOrder::kDescending);
       break;
+    case RedisKeyValueSubKeyPB::SubkeyCase::kDoubleSubkey:
+      *primitive_value = PrimitiveValue::Double(subkey_pb.double_subkey());
+      break;
     default:
       return STATUS_SUBSTITUTE(IllegalState, "Invalid enum value $0", subkey_pb.subkey_case());
   }
@@ -92,13 +116,18 @@ CHECKED_STATUS PrimitiveValueFromSubKeyStrict(const RedisKeyValueSubKeyPB &subke
   switch (data_type) {
     case REDIS_TYPE_LIST: FALLTHROUGH_INTENDED;
     case REDIS_TYPE_SET: FALLTHROUGH_INTENDED;
-    case REDIS_TYPE_SORTEDSET: FALLTHROUGH_INTENDED;
     case REDIS_TYPE_HASH:
       if (!subkey_pb.has_string_subkey()) {
         return STATUS_SUBSTITUTE(InvalidArgument, "subkey: $0 should be of string type",
                                  subkey_pb.ShortDebugString());
       }
       break;
+    case REDIS_TYPE_SORTEDSET:
+      if (!subkey_pb.has_double_subkey()) {
+        return STATUS_SUBSTITUTE(InvalidArgument, "subkey: $0 should be of double type",
+                                 subkey_pb.ShortDebugString());
+      }
+      break;
     case REDIS_TYPE_TIMESERIES:
       if (!subkey_pb.has_timestamp_subkey()) {
         return STATUS_SUBSTITUTE(InvalidArgument, "subkey: $0 should be of int64 type",
@@ -111,11 +140,12 @@ CHECKED_STATUS PrimitiveValueFromSubKeyStrict(const RedisKeyValueSubKeyPB &subke
   return PrimitiveValueFromSubKey(subkey_pb, primitive_value);
 }
 
-Status GetRedisValueType(
+// Returns the type of the value stored at the key of key_value_pb, or at its subkey with
+// subkey_index if it is not negative. Returns kInvalidValueType if there is no such value.
+Result<ValueType> GetRedisDocType(
     rocksdb::DB* rocksdb,
     const HybridTime &hybrid_time,
     const RedisKeyValuePB &key_value_pb,
-    RedisDataType *type,
     DocWriteBatch* doc_write_batch = nullptr,
     int subkey_index = -1) {
   if (!key_value_pb.has_key()) {
@@ -154,34 +184,45 @@ Status GetRedisValueType(
         hybrid_time, Value::kMaxTtl, /* return_type_only */ true));
   }
 
-  if (!doc_found) {
-    *type = REDIS_TYPE_NONE;
-    return Status::OK();
-  }
+  return doc_found ? doc.value_type() : ValueType::kInvalidValueType;
+}
 
-  switch (doc.value_type()) {
-    case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED;
-    case ValueType::kTombstone:
-      *type = REDIS_TYPE_NONE;
-      return Status::OK();
+// Returns the redis type of the value of the specified type, as returned by GetRedisDocType.
+RedisDataType DocRedisType(ValueType value_type) {
+  switch (value_type) {
     case ValueType::kObject:
-      *type = REDIS_TYPE_HASH;
-      return Status::OK();
+      return REDIS_TYPE_HASH;
     case ValueType::kRedisSet:
-      *type = REDIS_TYPE_SET;
-      return Status::OK();
-    case ValueType::kRedisTS:
-      *type = REDIS_TYPE_TIMESERIES;
-      return Status::OK();
+      return REDIS_TYPE_SET;
+    case ValueType::kRedisSortedSet:
+      return REDIS_TYPE_SORTEDSET;
+    case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisTSBlocks:
+      return REDIS_TYPE_TIMESERIES;
+    case ValueType::kRedisList:
+      return REDIS_TYPE_LIST;
     case ValueType::kNull: FALLTHROUGH_INTENDED; // This value is a set member.
     case ValueType::kString:
-      *type = REDIS_TYPE_STRING;
-      return Status::OK();
+      return REDIS_TYPE_STRING;
     default:
-      return Status::OK();
+      return REDIS_TYPE_NONE;
   }
 }
 
+Status GetRedisValueType(
+    rocksdb::DB* rocksdb,
+    const HybridTime &hybrid_time,
+    const RedisKeyValuePB &key_value_pb,
+    RedisDataType *type,
+    DocWriteBatch* doc_write_batch = nullptr,
+    int subkey_index = -1) {
+  auto doc_type = GetRedisDocType(
+      rocksdb, hybrid_time, key_value_pb, doc_write_batch, subkey_index);
+  RETURN_NOT_OK(doc_type);
+  *type = DocRedisType(*doc_type);
+  return Status::OK();
+}
+
 CHECKED_STATUS GetRedisValue(
     rocksdb::DB *rocksdb,
     HybridTime hybrid_time,
@@ -225,12 +266,19 @@ CHECKED_STATUS GetRedisValue(
       case ValueType::kObject:
         *type = REDIS_TYPE_HASH;
         break;
-      case ValueType::kRedisTS:
+      case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
+      case ValueType::kRedisTSBlocks:
         *type = REDIS_TYPE_TIMESERIES;
         break;
       case ValueType::kRedisSet:
         *type = REDIS_TYPE_SET;
         break;
+      case ValueType::kRedisSortedSet:
+        *type = REDIS_TYPE_SORTEDSET;
+        break;
+      case ValueType::kRedisList:
+        *type = REDIS_TYPE_LIST;
+        break;
       default:
         return STATUS_SUBSTITUTE(IllegalState, "Invalid value type: $0",
                                  static_cast<int>(doc.value_type()));
@@ -277,6 +325,23 @@ bool VerifyTypeAndSetCode(
   return true;
 }
 
+// Returns the type of a redis collection stored as a document of the specified type.
+RedisDataType CollectionRedisType(ValueType value_type) {
+  switch (value_type) {
+    case ValueType::kObject:
+      return REDIS_TYPE_HASH;
+    case ValueType::kRedisSet:
+      return REDIS_TYPE_SET;
+    case ValueType::kRedisSortedSet:
+      return REDIS_TYPE_SORTEDSET;
+    case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisTSBlocks:
+      return REDIS_TYPE_TIMESERIES;
+    default:
+      return REDIS_TYPE_NONE;
+  }
+}
+
 CHECKED_STATUS AddPrimitiveValueToResponseArray(const PrimitiveValue& value,
                                                 RedisArrayPB* redis_array) {
   if (value.IsString()) {
@@ -291,11 +356,11 @@ CHECKED_STATUS AddPrimitiveValueToResponseArray(const PrimitiveValue& value,
 }
 
 template <typename T>
-CHECKED_STATUS PopulateRedisResponseFromInternal(T iter,
-                                                 const T& iter_end,
-                                                 RedisResponsePB *response,
-                                                 bool add_keys,
-                                                 bool add_values) {
+CHECKED_STATUS PopulateResponseFrom(T iter,
+                                    const T& iter_end,
+                                    RedisResponsePB *response,
+                                    bool add_keys,
+                                    bool add_values) {
   response->set_allocated_array_response(new RedisArrayPB());
   for (; iter != iter_end; iter++) {
     const PrimitiveValue& first = iter->first;
@@ -310,18 +375,447 @@ CHECKED_STATUS PopulateRedisResponseFromInternal(T iter,
   return Status::OK();
 }
 
-CHECKED_STATUS PopulateResponseFrom(const SubDocument::ObjectContainer &key_values,
-                                    RedisResponsePB *response,
-                                    bool add_keys,
-                                    bool add_values,
-                                    bool reverse = false) {
-  if (reverse) {
-    return PopulateRedisResponseFromInternal(key_values.rbegin(), key_values.rend(), response,
-                                             add_keys, add_values);
+// Bound of the score range of a sorted set scan, infinite scores are used for unbounded ranges.
+struct SortedSetScoreBound {
+  double score;
+  bool is_exclusive;
+};
+
+SortedSetScoreBound ScoreBoundFromPB(const RedisSubKeyBoundPB& bound_pb, bool is_lower_bound) {
+  if (bound_pb.has_infinity_type()) {
+    const bool positive = bound_pb.infinity_type() == RedisSubKeyBoundPB_InfinityType_POSITIVE;
+    return {positive ? std::numeric_limits<double>::infinity()
+                     : -std::numeric_limits<double>::infinity(),
+            // An infinite bound on the wrong side of the range matches nothing.
+            positive == is_lower_bound};
+  }
+  return {bound_pb.subkey_bound().double_subkey(), bound_pb.is_exclusive()};
+}
+
+// Visitor of the live entries of a redis collection, returns false to stop the scan.
+typedef std::function<Result<bool>(const SubDocKey& key, const Value& value)>
+    CollectionEntryVisitor;
+
+// Streams live primitive entries of the redis collection stored at prefix.doc_key(), whose keys
+// start with prefix, in key order. Unlike GetSubDocument it does not build the subdocument of the
+// collection, so memory used by a scan depends only on what the visitor keeps. The scan starts at
+// start if it is specified (right after it if start_is_exclusive is true) and at prefix otherwise.
+//
+// Tombstones, expired entries and entries older than the latest init marker or tombstone of the
+// whole document are skipped, as well as the size counter and the list bounds of the collection.
+// Sets doc_type to the type of the value stored at the document key, entries are visited only if it
+// is an object type. Expired document is reported as kTombstone. If doc_has_ttl is specified, it is
+// set to whether the document itself has a TTL.
+CHECKED_STATUS ScanCollection(rocksdb::DB* rocksdb,
+                              HybridTime hybrid_time,
+                              const SubDocKey& prefix,
+                              const SubDocKey* start,
+                              bool start_is_exclusive,
+                              ValueType* doc_type,
+                              const CollectionEntryVisitor& visitor,
+                              bool* doc_has_ttl = nullptr) {
+  const KeyBytes encoded_doc_key = prefix.doc_key().Encode();
+  // TODO(dtxn) - pass correct transaction context when we implement cross-shard transactions
+  // support for Redis.
+  auto iter = CreateIntentAwareIterator(
+      rocksdb, BloomFilterMode::USE_BLOOM_FILTER, encoded_doc_key.AsSlice(),
+      rocksdb::kDefaultQueryId, boost::none, hybrid_time);
+  RETURN_NOT_OK(iter->SeekWithoutHt(encoded_doc_key));
+
+  DocHybridTime max_deleted_ts(DocHybridTime::kMin);
+  Value doc_value(PrimitiveValue(ValueType::kInvalidValueType));
+  RETURN_NOT_OK(iter->FindLastWriteTime(encoded_doc_key, hybrid_time, &max_deleted_ts, &doc_value));
+  *doc_type = doc_value.value_type();
+  if (doc_has_ttl) {
+    *doc_has_ttl = doc_value.has_ttl();
+  }
+  if (!IsObjectType(*doc_type)) {
+    return Status::OK();
+  }
+  bool has_expired = false;
+  RETURN_NOT_OK(HasExpiredTTL(
+      max_deleted_ts.hybrid_time(), doc_value.ttl(), hybrid_time, &has_expired));
+  if (has_expired) {
+    *doc_type = ValueType::kTombstone;
+    return Status::OK();
+  }
+
+  if (start == nullptr) {
+    SubDocKey seek_key(prefix);
+    seek_key.SetHybridTimeForReadPath(hybrid_time);
+    RETURN_NOT_OK(iter->SeekForward(seek_key));
+  } else if (start_is_exclusive) {
+    RETURN_NOT_OK(iter->SeekPastSubKey(*start));
   } else {
-    return PopulateRedisResponseFromInternal(key_values.begin(), key_values.end(), response,
-                                             add_keys, add_values);
+    SubDocKey seek_key(*start);
+    seek_key.SetHybridTimeForReadPath(hybrid_time);
+    RETURN_NOT_OK(iter->SeekForward(seek_key));
+  }
+
+  const KeyBytes encoded_prefix = prefix.Encode(/* include_hybrid_time */ false);
+  while (iter->valid() && iter->key().starts_with(encoded_prefix.AsSlice())) {
+    SubDocKey found_key;
+    RETURN_NOT_OK(found_key.FullyDecodeFrom(iter->key()));
+    if (hybrid_time < found_key.hybrid_time()) {
+      found_key.SetHybridTimeForReadPath(hybrid_time);
+      RETURN_NOT_OK(iter->SeekForward(found_key));
+      continue;
+    }
+    // The first entry of each key is its latest version at hybrid_time.
+    if (found_key.num_subkeys() > prefix.num_subkeys() &&
+        found_key.subkeys()[0].value_type() != ValueType::kRedisCardinality &&
+        found_key.subkeys()[0].value_type() != ValueType::kRedisListBounds &&
+        found_key.doc_hybrid_time() >= max_deleted_ts) {
+      Value value;
+      RETURN_NOT_OK(value.Decode(iter->value()));
+      RETURN_NOT_OK(HasExpiredTTL(found_key.hybrid_time(), value.ttl(), hybrid_time, &has_expired));
+      if (IsPrimitiveValueType(value.value_type()) && !has_expired) {
+        auto proceed = visitor(found_key, value);
+        RETURN_NOT_OK(proceed);
+        if (!proceed.get()) {
+          break;
+        }
+      }
+    }
+    RETURN_NOT_OK(iter->SeekPastSubKey(found_key));
+  }
+  return Status::OK();
+}
+
+// Members of a redis sorted set are stored in two parts of the document:
+//   key, kSSForward, score, member -> null
+//   key, kSSReverse, member -> score
+// The forward part is ordered by score, so a score range is read with a single seek followed by
+// iteration over the matching entries only. The reverse part is used to find the old score of a
+// member when it is updated. Both parts are written without intermediate init markers and are
+// invalidated together by the init marker or tombstone of the whole sorted set.
+//
+// Scans members with scores within [low, high] in score order, skipping the first offset of them
+// and stopping after count members, if count is not negative. Sets doc_type to the type of the
+// value stored at doc_key, if it is not kRedisSortedSet result is left empty.
+CHECKED_STATUS ScanSortedSet(rocksdb::DB* rocksdb,
+                             HybridTime hybrid_time,
+                             const DocKey& doc_key,
+                             const SortedSetScoreBound& low,
+                             const SortedSetScoreBound& high,
+                             int64_t offset,
+                             int64_t count,
+                             ValueType* doc_type,
+                             std::vector<std::pair<double, std::string>>* result) {
+  const SubDocKey prefix(doc_key, PrimitiveValue(ValueType::kSSForward));
+  const SubDocKey start(doc_key, PrimitiveValue(ValueType::kSSForward),
+                        PrimitiveValue::Double(low.score));
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, prefix, &start, /* start_is_exclusive */ false, doc_type,
+      [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (count == 0) {
+          return false;
+        }
+        if (key.num_subkeys() != 3 || !key.subkeys()[1].IsDouble() ||
+            !key.subkeys()[2].IsString()) {
+          return STATUS_FORMAT(Corruption, "Unexpected sorted set entry: $0", key);
+        }
+        const double score = key.subkeys()[1].GetDouble();
+        if (score > high.score || (high.is_exclusive && score == high.score)) {
+          return false;
+        }
+        if (low.is_exclusive && score == low.score) {
+          return true;
+        }
+        if (offset > 0) {
+          --offset;
+          return true;
+        }
+        result->emplace_back(score, key.subkeys()[2].GetString());
+        return count < 0 || --count > 0;
+      }));
+  return Status::OK();
+}
+
+// The number of entries of a redis hash or set is kept in the kRedisCardinality subkey of its
+// document, so HLEN and SCARD don't have to iterate over the collection. The counter is written by
+// every command that adds or removes entries, in the same write batch as the entries, and is
+// invalidated together with them by the init marker or tombstone of the document. Maintaining it
+// requires reading the entries being written, so when emulate_redis_responses is off writes drop
+// the counter instead. Collections without the counter, including ones written before it was
+// introduced, are counted by iterating over them.
+bool MaintainCollectionSize() {
+  return FLAGS_emulate_redis_responses;
+}
+
+DocPath CollectionSizePath(const RedisKeyValuePB& kv) {
+  DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  doc_path.AddSubKey(PrimitiveValue(ValueType::kRedisCardinality));
+  return doc_path;
+}
+
+// Returns the number of entries of the collection stored at doc_key, as of hybrid_time.
+Result<int64_t> ReadCollectionSize(rocksdb::DB* rocksdb,
+                                   HybridTime hybrid_time,
+                                   const DocKey& doc_key) {
+  SubDocument counter;
+  bool counter_found = false;
+  // TODO(dtxn) - pass correct transaction context when we implement cross-shard transactions
+  // support for Redis.
+  RETURN_NOT_OK(GetSubDocument(
+      rocksdb, SubDocKey(doc_key, PrimitiveValue(ValueType::kRedisCardinality)),
+      rocksdb::kDefaultQueryId, boost::none, &counter, &counter_found, hybrid_time));
+  if (counter_found && counter.IsInt64()) {
+    return counter.GetInt64();
+  }
+
+  int64_t num_entries = 0;
+  ValueType doc_type;
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, SubDocKey(doc_key), /* start */ nullptr,
+      /* start_is_exclusive */ false, &doc_type,
+      [&num_entries](const SubDocKey& key, const Value& value) -> Result<bool> {
+        ++num_entries;
+        return true;
+      }));
+  return num_entries;
+}
+
+// Returns the number of entries of the collection stored at kv, taking into account writes of the
+// previous operations of doc_write_batch, that were not applied to RocksDB yet.
+Result<int64_t> GetCollectionSize(DocWriteBatch* doc_write_batch,
+                                  HybridTime read_hybrid_time,
+                                  const RedisKeyValuePB& kv) {
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  const KeyBytes encoded_counter_key =
+      SubDocKey(doc_key, PrimitiveValue(ValueType::kRedisCardinality)).Encode(
+          /* include_hybrid_time */ false);
+  for (size_t i = doc_write_batch->size(); i-- > 0;) {
+    const Slice key = doc_write_batch->key(i);
+    if (key == encoded_doc_key.AsSlice()) {
+      // The document was created or deleted by this batch.
+      return 0;
+    }
+    if (key == encoded_counter_key.AsSlice()) {
+      Value value;
+      RETURN_NOT_OK(value.Decode(doc_write_batch->value(i)));
+      if (value.primitive_value().IsInt64()) {
+        return value.primitive_value().GetInt64();
+      }
+      break;
+    }
+  }
+  return ReadCollectionSize(doc_write_batch->rocksdb(), read_hybrid_time, doc_key);
+}
+
+// Updates the size counter of the collection stored at kv, after num_added entries were added to
+// it and num_removed entries were removed from it by the current operation. old_size is the size
+// before the operation, as returned by GetCollectionSize.
+CHECKED_STATUS UpdateCollectionSize(DocWriteBatch* doc_write_batch,
+                                    const RedisKeyValuePB& kv,
+                                    int64_t old_size,
+                                    int64_t num_added,
+                                    int64_t num_removed) {
+  if (num_added == 0 && num_removed == 0) {
+    return Status::OK();
+  }
+  return doc_write_batch->SetPrimitive(
+      CollectionSizePath(kv),
+      Value(PrimitiveValue(old_size + num_added - num_removed)),
+      InitMarkerBehavior::OPTIONAL);
+}
+
+// Drops the size counter of the collection stored at kv, without reading anything.
+CHECKED_STATUS DropCollectionSize(DocWriteBatch* doc_write_batch, const RedisKeyValuePB& kv) {
+  return doc_write_batch->DeleteSubDoc(CollectionSizePath(kv), InitMarkerBehavior::OPTIONAL);
+}
+
+// Elements of a redis list are stored at consecutive kArrayIndex subkeys of its document, from
+// head (inclusive) to tail (exclusive):
+//   key -> kRedisList
+//   key, kRedisListBounds -> head and tail
+//   key, ArrayIndex(i) -> element
+// LPUSH writes below head and RPUSH at tail, pops tombstone the element at the corresponding end,
+// so both ends are updated without touching the other elements, and LRANGE seeks directly to the
+// first requested element. The bounds are kept in a subkey rather than in the value of the
+// document, because rewriting the value of the document would invalidate all its elements.
+// Popping the last element deletes the whole document.
+struct RedisListBounds {
+  int64_t head = 0;
+  int64_t tail = 0;
+
+  int64_t size() const { return tail - head; }
+};
+
+PrimitiveValue EncodeListBounds(const RedisListBounds& bounds) {
+  char buffer[2 * sizeof(uint64_t)];
+  BigEndian::Store64(buffer, bounds.head);
+  BigEndian::Store64(buffer + sizeof(uint64_t), bounds.tail);
+  return PrimitiveValue(std::string(buffer, sizeof(buffer)));
+}
+
+// Returns the value of the subkey of the redis collection stored at doc_key, as of hybrid_time,
+// taking into account writes of the previous operations of doc_write_batch, if it is specified.
+// Returns kTombstone if there is no such subkey.
+Result<PrimitiveValue> ReadCollectionEntry(rocksdb::DB* rocksdb,
+                                           HybridTime hybrid_time,
+                                           const DocKey& doc_key,
+                                           const PrimitiveValue& subkey,
+                                           DocWriteBatch* doc_write_batch = nullptr) {
+  const SubDocKey entry_key(doc_key, subkey);
+  if (doc_write_batch) {
+    const KeyBytes encoded_doc_key = doc_key.Encode();
+    const KeyBytes encoded_entry_key = entry_key.Encode(/* include_hybrid_time */ false);
+    for (size_t i = doc_write_batch->size(); i-- > 0;) {
+      const Slice key = doc_write_batch->key(i);
+      if (key == encoded_doc_key.AsSlice()) {
+        // The collection was created or deleted by this batch, after the entry was written.
+        return PrimitiveValue(ValueType::kTombstone);
+      }
+      if (key == encoded_entry_key.AsSlice()) {
+        Value value;
+        RETURN_NOT_OK(value.Decode(doc_write_batch->value(i)));
+        return value.primitive_value();
+      }
+    }
+  }
+  SubDocument entry;
+  bool entry_found = false;
+  // TODO(dtxn) - pass correct transaction context when we implement cross-shard transactions
+  // support for Redis.
+  RETURN_NOT_OK(GetSubDocument(
+      rocksdb, entry_key, rocksdb::kDefaultQueryId, boost::none, &entry, &entry_found,
+      hybrid_time));
+  if (!entry_found || !entry.IsPrimitive()) {
+    return PrimitiveValue(ValueType::kTombstone);
+  }
+  return PrimitiveValue(entry);
+}
+
+// Returns the bounds of the redis list stored at doc_key, see ReadCollectionEntry.
+Result<RedisListBounds> ReadListBounds(rocksdb::DB* rocksdb,
+                                       HybridTime hybrid_time,
+                                       const DocKey& doc_key,
+                                       DocWriteBatch* doc_write_batch = nullptr) {
+  auto value = ReadCollectionEntry(rocksdb, hybrid_time, doc_key,
+                                   PrimitiveValue(ValueType::kRedisListBounds), doc_write_batch);
+  RETURN_NOT_OK(value);
+  RedisListBounds bounds;
+  if (value->value_type() == ValueType::kTombstone) {
+    return bounds;
+  }
+  if (!value->IsString() || value->GetString().size() != 2 * sizeof(uint64_t)) {
+    return STATUS_FORMAT(Corruption, "Invalid bounds of redis list $0: $1", doc_key, *value);
+  }
+  const char* data = value->GetString().data();
+  bounds.head = static_cast<int64_t>(BigEndian::Load64(data));
+  bounds.tail = static_cast<int64_t>(BigEndian::Load64(data + sizeof(uint64_t)));
+  return bounds;
+}
+
+// Points of a redis time series created while redis_ts_block_width is positive are stored in
+// blocks of consecutive timestamps, see RedisTSBlock, instead of a subkey per point:
+//   key -> kRedisTSBlocks
+//   key, block start (descending) -> encoded block
+// All blocks of a time series have the same width, recorded in each block, so changing the flag
+// does not affect existing time series. A timestamp is looked up in the block with the greatest
+// start not exceeding it, which is the first block at or after the timestamp in key order, and a
+// range of timestamps is read by iterating over the blocks intersecting it. TSADD and TSREM
+// rewrite the blocks they modify. Every point keeps its own expiration time, the block expires
+// together with its latest point.
+PrimitiveValue TSBlockSubKey(int64_t start) {
+  return PrimitiveValue(start, SortOrder::kDescending);
+}
+
+MicrosTime PhysicalMicros(HybridTime hybrid_time) {
+  return server::HybridClock::GetPhysicalValueMicros(hybrid_time);
+}
+
+// Decodes the block of a redis time series stored in value, dropping the points expired by now.
+CHECKED_STATUS DecodeTSBlock(const PrimitiveValue& value, MicrosTime now, RedisTSBlock* block) {
+  if (!value.IsString()) {
+    return STATUS_FORMAT(Corruption, "Invalid redis time series block: $0", value);
+  }
+  RETURN_NOT_OK(RedisTSBlock::Decode(value.GetString(), block));
+  block->RemoveExpired(now);
+  return Status::OK();
+}
+
+// Returns the width of the blocks of the redis time series stored in blocks at doc_key, taking into
+// account writes of the previous operations of doc_write_batch. Returns 0 if it has no blocks.
+Result<int64_t> GetTSBlockWidth(DocWriteBatch* doc_write_batch,
+                                HybridTime read_hybrid_time,
+                                const DocKey& doc_key) {
+  RedisTSBlock block(/* width */ 1);
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  for (size_t i = doc_write_batch->size(); i-- > 0;) {
+    const Slice key = doc_write_batch->key(i);
+    if (key == encoded_doc_key.AsSlice()) {
+      // The time series was created by this batch and no block was written since.
+      return 0;
+    }
+    if (key.starts_with(encoded_doc_key.AsSlice())) {
+      Value value;
+      RETURN_NOT_OK(value.Decode(doc_write_batch->value(i)));
+      if (value.primitive_value().IsString()) {
+        RETURN_NOT_OK(RedisTSBlock::Decode(value.primitive_value().GetString(), &block));
+        return block.width();
+      }
+    }
+  }
+
+  int64_t width = 0;
+  ValueType doc_type;
+  RETURN_NOT_OK(ScanCollection(
+      doc_write_batch->rocksdb(), read_hybrid_time, SubDocKey(doc_key), /* start */ nullptr,
+      /* start_is_exclusive */ false, &doc_type,
+      [&block, &width](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (value.primitive_value().IsString()) {
+          RETURN_NOT_OK(RedisTSBlock::Decode(value.primitive_value().GetString(), &block));
+          width = block.width();
+        }
+        return false;
+      }));
+  return width;
+}
+
+// Returns the width of the blocks that TSADD should write the points to, for the redis time series
+// stored at doc_key as a document of doc_type, or 0 if it should write a subkey per point. Sets
+// create to whether the time series has to be created, empty time series are created anew.
+Result<int64_t> TSBlockWidthForWrite(DocWriteBatch* doc_write_batch,
+                                     HybridTime read_hybrid_time,
+                                     const DocKey& doc_key,
+                                     ValueType doc_type,
+                                     bool* create) {
+  if (doc_type == ValueType::kRedisTS) {
+    *create = false;
+    return 0;
+  }
+  if (doc_type == ValueType::kRedisTSBlocks) {
+    auto width = GetTSBlockWidth(doc_write_batch, read_hybrid_time, doc_key);
+    RETURN_NOT_OK(width);
+    if (*width > 0) {
+      *create = false;
+      return width;
+    }
   }
+  *create = true;
+  return std::max<int64_t>(FLAGS_redis_ts_block_width, 0);
+}
+
+// Writes the block of the redis time series stored at doc_key that starts at start, or deletes it
+// if the block has no points.
+CHECKED_STATUS WriteTSBlock(DocWriteBatch* doc_write_batch,
+                            const DocKey& doc_key,
+                            int64_t start,
+                            const RedisTSBlock& block,
+                            MicrosTime now) {
+  const DocPath doc_path(doc_key.Encode(), TSBlockSubKey(start));
+  if (block.empty()) {
+    return doc_write_batch->DeleteSubDoc(doc_path, InitMarkerBehavior::OPTIONAL);
+  }
+  // Expired points are dropped on decoding, so the points that expire do it after now.
+  const MicrosTime expire_at = block.MaxExpireAt();
+  const MonoDelta ttl = expire_at == 0 ? Value::kMaxTtl
+                                       : MonoDelta::FromMicroseconds(expire_at - now);
+  return doc_write_batch->SetPrimitive(
+      doc_path, Value(PrimitiveValue(block.Encode()), ttl), InitMarkerBehavior::OPTIONAL);
 }
 
 } // anonymous namespace
@@ -357,9 +851,10 @@ Status RedisWriteOperation::Apply(
 
 Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
   const RedisKeyValuePB& kv = request_.key_value();
-  RedisDataType data_type;
-  RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
-                                  doc_write_batch));
+  auto doc_type = GetRedisDocType(
+      doc_write_batch->rocksdb(), read_hybrid_time_, kv, doc_write_batch);
+  RETURN_NOT_OK(doc_type);
+  const RedisDataType data_type = DocRedisType(*doc_type);
 
   const MonoDelta ttl = request_.set_request().has_ttl() ?
       MonoDelta::FromMilliseconds(request_.set_request().ttl()) : Value::kMaxTtl;
@@ -372,6 +867,17 @@ Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
           response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
           return Status::OK();
         }
+        bool create_ts = data_type == REDIS_TYPE_NONE;
+        if (kv.type() == REDIS_TYPE_TIMESERIES) {
+          auto block_width = TSBlockWidthForWrite(
+              doc_write_batch, read_hybrid_time_, DocKey::FromRedisKey(kv.hash_code(), kv.key()),
+              *doc_type, &create_ts);
+          RETURN_NOT_OK(block_width);
+          if (*block_width > 0) {
+            RETURN_NOT_OK(ApplySetTSBlocks(doc_write_batch, *block_width, create_ts));
+            break;
+          }
+        }
         SubDocument kv_entries = SubDocument();
         for (int i = 0; i < kv.subkey_size(); i++) {
           PrimitiveValue subkey_value;
@@ -385,17 +891,34 @@ Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
         }
 
         // For an HSET command (which has only one subkey), we need to read the subkey to find out
-        // if the key already existed, and return 0 or 1 accordingly. This read is unnecessary for
-        // HMSET and TSADD.
-        if (kv.subkey_size() == 1 && EmulateRedisResponse(kv.type())) {
-          RedisDataType type;
-          RETURN_NOT_OK(GetRedisValueType(
-              doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, doc_write_batch, 0));
-          // For HSET/TSADD, we return 0 or 1 depending on if the key already existed.
-          // If flag is false, no int response is returned.
-          response_.set_int_response(type == REDIS_TYPE_NONE ? 1 : 0);
+        // if the key already existed, and return 0 or 1 accordingly. For HMSET the subkeys are
+        // read only to maintain the size of the hash. These reads are unnecessary for TSADD.
+        const bool maintain_size = kv.type() == REDIS_TYPE_HASH && MaintainCollectionSize();
+        int64_t old_size = 0;
+        int64_t num_added = 0;
+        if (maintain_size || (kv.subkey_size() == 1 && EmulateRedisResponse(kv.type()))) {
+          if (maintain_size && data_type != REDIS_TYPE_NONE) {
+            auto size = GetCollectionSize(doc_write_batch, read_hybrid_time_, kv);
+            RETURN_NOT_OK(size);
+            old_size = *size;
+          }
+          for (int i = 0; i < kv.subkey_size(); i++) {
+            RedisDataType type = REDIS_TYPE_NONE;
+            if (data_type != REDIS_TYPE_NONE) {
+              RETURN_NOT_OK(GetRedisValueType(
+                  doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, doc_write_batch, i));
+            }
+            if (type == REDIS_TYPE_NONE) {
+              ++num_added;
+            }
+          }
+          if (kv.subkey_size() == 1 && EmulateRedisResponse(kv.type())) {
+            // For HSET/TSADD, we return 0 or 1 depending on if the key already existed.
+            // If flag is false, no int response is returned.
+            response_.set_int_response(num_added);
+          }
         }
-        if (data_type == REDIS_TYPE_NONE && kv.type() == REDIS_TYPE_TIMESERIES) {
+        if (create_ts && kv.type() == REDIS_TYPE_TIMESERIES) {
           // Need to insert the document instead of extending it.
           RETURN_NOT_OK(doc_write_batch->InsertSubDocument(
               doc_path, kv_entries, InitMarkerBehavior::REQUIRED, ttl));
@@ -403,6 +926,12 @@ Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
           RETURN_NOT_OK(doc_write_batch->ExtendSubDocument(
               doc_path, kv_entries, InitMarkerBehavior::REQUIRED, ttl));
         }
+        if (maintain_size) {
+          RETURN_NOT_OK(UpdateCollectionSize(
+              doc_write_batch, kv, old_size, num_added, /* num_removed */ 0));
+        } else if (kv.type() == REDIS_TYPE_HASH) {
+          RETURN_NOT_OK(DropCollectionSize(doc_write_batch, kv));
+        }
         break;
       }
       case REDIS_TYPE_STRING: {
@@ -439,12 +968,69 @@ Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
   return Status::OK();
 }
 
+Status RedisWriteOperation::ApplySetTSBlocks(
+    DocWriteBatch* doc_write_batch, int64_t block_width, bool create) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  const MicrosTime now = PhysicalMicros(read_hybrid_time_);
+  const MicrosTime expire_at = request_.set_request().has_ttl()
+      ? now + MonoDelta::FromMilliseconds(request_.set_request().ttl()).ToMicroseconds() : 0;
+
+  // Points of the request grouped by the start of their block.
+  std::map<int64_t, std::vector<RedisTSPoint>> block_points;
+  for (int i = 0; i < kv.subkey_size(); i++) {
+    PrimitiveValue timestamp;
+    RETURN_NOT_OK(PrimitiveValueFromSubKeyStrict(kv.subkey(i), kv.type(), &timestamp));
+    RedisTSPoint point;
+    point.timestamp = timestamp.GetInt64();
+    point.value = kv.value(i);
+    point.expire_at = expire_at;
+    block_points[RedisTSBlock::Start(point.timestamp, block_width)].push_back(std::move(point));
+  }
+
+  if (create) {
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(doc_key.Encode()), Value(PrimitiveValue(ValueType::kRedisTSBlocks))));
+  }
+  for (auto& entry : block_points) {
+    RedisTSBlock block(block_width);
+    if (!create) {
+      auto value = ReadCollectionEntry(doc_write_batch->rocksdb(), read_hybrid_time_, doc_key,
+                                       TSBlockSubKey(entry.first), doc_write_batch);
+      RETURN_NOT_OK(value);
+      if (value->value_type() != ValueType::kTombstone) {
+        RETURN_NOT_OK(DecodeTSBlock(*value, now, &block));
+      }
+    }
+    for (auto& point : entry.second) {
+      block.Upsert(std::move(point));
+    }
+    RETURN_NOT_OK(WriteTSBlock(doc_write_batch, doc_key, entry.first, block, now));
+  }
+  return Status::OK();
+}
+
+Status RedisWriteOperation::GetValue(
+    DocWriteBatch* doc_write_batch, RedisDataType* type, string* value) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  if (value_cache_ && kv.has_key() && kv.subkey().empty()) {
+    auto cached = value_cache_->Get(
+        DocKey::FromRedisKey(kv.hash_code(), kv.key()).Encode().AsSlice(), read_hybrid_time_);
+    if (cached) {
+      *type = REDIS_TYPE_STRING;
+      *value = std::move(*cached);
+      return Status::OK();
+    }
+  }
+  return GetRedisValue(doc_write_batch->rocksdb(), read_hybrid_time_, kv, type, value);
+}
+
 Status RedisWriteOperation::ApplyGetSet(DocWriteBatch* doc_write_batch) {
   RedisDataType type;
   string value;
   const RedisKeyValuePB& kv = request_.key_value();
 
-  RETURN_NOT_OK(GetRedisValue(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, &value));
+  RETURN_NOT_OK(GetValue(doc_write_batch, &type, &value));
 
   if (kv.value_size() != 1) {
     return STATUS_SUBSTITUTE(Corruption,
@@ -472,7 +1058,7 @@ Status RedisWriteOperation::ApplyAppend(DocWriteBatch* doc_write_batch) {
         "Append kv should have 1 value, found $0", kv.value_size());
   }
 
-  RETURN_NOT_OK(GetRedisValue(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, &value));
+  RETURN_NOT_OK(GetValue(doc_write_batch, &type, &value));
 
   if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_STRING, type, &response_, true)) {
     // We've already set the error code in the response.
@@ -491,13 +1077,17 @@ Status RedisWriteOperation::ApplyAppend(DocWriteBatch* doc_write_batch) {
 //                  See ENG-807
 Status RedisWriteOperation::ApplyDel(DocWriteBatch* doc_write_batch) {
   const RedisKeyValuePB& kv = request_.key_value();
-  RedisDataType data_type;
-  RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
-                                  doc_write_batch));
+  auto doc_type = GetRedisDocType(
+      doc_write_batch->rocksdb(), read_hybrid_time_, kv, doc_write_batch);
+  RETURN_NOT_OK(doc_type);
+  const RedisDataType data_type = DocRedisType(*doc_type);
   if (data_type != REDIS_TYPE_NONE && data_type != kv.type() && kv.type() != REDIS_TYPE_NONE) {
     response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
     return Status::OK();
   }
+  if (*doc_type == ValueType::kRedisTSBlocks && kv.type() == REDIS_TYPE_TIMESERIES) {
+    return ApplyDelTSBlocks(doc_write_batch);
+  }
   SubDocument values =  SubDocument();
   int num_keys;
   if (kv.type() == REDIS_TYPE_NONE) { // Delete any string, or container.
@@ -528,8 +1118,22 @@ Status RedisWriteOperation::ApplyDel(DocWriteBatch* doc_write_batch) {
       }
     }
   }
+  const bool has_size = data_type != REDIS_TYPE_NONE &&
+                        (kv.type() == REDIS_TYPE_HASH || kv.type() == REDIS_TYPE_SET);
+  int64_t old_size = 0;
+  if (has_size && MaintainCollectionSize() && num_keys > 0) {
+    auto size = GetCollectionSize(doc_write_batch, read_hybrid_time_, kv);
+    RETURN_NOT_OK(size);
+    old_size = *size;
+  }
   DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
   RETURN_NOT_OK(doc_write_batch->ExtendSubDocument(doc_path, values, InitMarkerBehavior::REQUIRED));
+  if (has_size && MaintainCollectionSize()) {
+    RETURN_NOT_OK(UpdateCollectionSize(
+        doc_write_batch, kv, old_size, /* num_added */ 0, /* num_removed */ num_keys));
+  } else if (has_size) {
+    RETURN_NOT_OK(DropCollectionSize(doc_write_batch, kv));
+  }
   response_.set_code(RedisResponsePB_RedisStatusCode_OK);
   if (EmulateRedisResponse(kv.type())) {
     // If the flag is true, we respond with the number of keys actually being deleted. We don't
@@ -539,6 +1143,46 @@ Status RedisWriteOperation::ApplyDel(DocWriteBatch* doc_write_batch) {
   return Status::OK();
 }
 
+Status RedisWriteOperation::ApplyDelTSBlocks(DocWriteBatch* doc_write_batch) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  auto block_width = GetTSBlockWidth(doc_write_batch, read_hybrid_time_, doc_key);
+  RETURN_NOT_OK(block_width);
+  if (*block_width == 0) {
+    return Status::OK();
+  }
+
+  // Timestamps of the request grouped by the start of their block.
+  std::map<int64_t, std::vector<int64_t>> block_timestamps;
+  for (int i = 0; i < kv.subkey_size(); i++) {
+    PrimitiveValue timestamp;
+    RETURN_NOT_OK(PrimitiveValueFromSubKeyStrict(kv.subkey(i), kv.type(), &timestamp));
+    block_timestamps[RedisTSBlock::Start(timestamp.GetInt64(), *block_width)].push_back(
+        timestamp.GetInt64());
+  }
+
+  const MicrosTime now = PhysicalMicros(read_hybrid_time_);
+  for (const auto& entry : block_timestamps) {
+    auto value = ReadCollectionEntry(doc_write_batch->rocksdb(), read_hybrid_time_, doc_key,
+                                     TSBlockSubKey(entry.first), doc_write_batch);
+    RETURN_NOT_OK(value);
+    if (value->value_type() == ValueType::kTombstone) {
+      continue;
+    }
+    RedisTSBlock block(*block_width);
+    RETURN_NOT_OK(DecodeTSBlock(*value, now, &block));
+    bool removed = false;
+    for (int64_t timestamp : entry.second) {
+      removed = block.Remove(timestamp) || removed;
+    }
+    if (removed) {
+      RETURN_NOT_OK(WriteTSBlock(doc_write_batch, doc_key, entry.first, block, now));
+    }
+  }
+  return Status::OK();
+}
+
 Status RedisWriteOperation::ApplySetRange(DocWriteBatch* doc_write_batch) {
   RedisDataType type;
   string value;
@@ -548,7 +1192,7 @@ Status RedisWriteOperation::ApplySetRange(DocWriteBatch* doc_write_batch) {
         "SetRange kv should have 1 value, found $0", kv.value_size());
   }
 
-  RETURN_NOT_OK(GetRedisValue(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, &value));
+  RETURN_NOT_OK(GetValue(doc_write_batch, &type, &value));
 
   if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_STRING, type, &response_, true)) {
     // We've already set the error code in the response.
@@ -572,7 +1216,7 @@ Status RedisWriteOperation::ApplyIncr(DocWriteBatch* doc_write_batch, int64_t in
   string value;
   const RedisKeyValuePB& kv = request_.key_value();
 
-  RETURN_NOT_OK(GetRedisValue(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, &value));
+  RETURN_NOT_OK(GetValue(doc_write_batch, &type, &value));
 
   if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_STRING, type, &response_)) {
     // We've already set the error code in the response.
@@ -606,7 +1250,52 @@ Status RedisWriteOperation::ApplyIncr(DocWriteBatch* doc_write_batch, int64_t in
 }
 
 Status RedisWriteOperation::ApplyPush(DocWriteBatch* doc_write_batch) {
-  return STATUS(NotSupported, "Redis operation has not been implemented");
+  const RedisKeyValuePB& kv = request_.key_value();
+  const auto& push_request = request_.push_request();
+  if (kv.value_size() == 0) {
+    return STATUS(InvalidCommand, "PUSH request has no values set");
+  }
+
+  RedisDataType data_type;
+  RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
+                                  doc_write_batch));
+  if (data_type != REDIS_TYPE_LIST && data_type != REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    return Status::OK();
+  }
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  if (data_type == REDIS_TYPE_NONE && push_request.assume_exists()) {
+    // LPUSHX and RPUSHX do nothing if the list does not exist.
+    response_.set_int_response(0);
+    return Status::OK();
+  }
+
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  RedisListBounds bounds;
+  if (data_type == REDIS_TYPE_LIST) {
+    auto old_bounds = ReadListBounds(
+        doc_write_batch->rocksdb(), read_hybrid_time_, doc_key, doc_write_batch);
+    RETURN_NOT_OK(old_bounds);
+    bounds = *old_bounds;
+  } else {
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key), Value(PrimitiveValue(ValueType::kRedisList))));
+  }
+
+  // Values are pushed one after another, so LPUSH stores them in the reverse order.
+  for (const auto& value : kv.value()) {
+    const int64_t index =
+        push_request.side() == REDIS_SIDE_LEFT ? --bounds.head : bounds.tail++;
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key, PrimitiveValue::ArrayIndex(index)),
+        Value(PrimitiveValue(value)), InitMarkerBehavior::OPTIONAL));
+  }
+  RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+      DocPath(encoded_doc_key, PrimitiveValue(ValueType::kRedisListBounds)),
+      Value(EncodeListBounds(bounds)), InitMarkerBehavior::OPTIONAL));
+  response_.set_int_response(bounds.size());
+  return Status::OK();
 }
 
 Status RedisWriteOperation::ApplyInsert(DocWriteBatch* doc_write_batch) {
@@ -614,11 +1303,53 @@ Status RedisWriteOperation::ApplyInsert(DocWriteBatch* doc_write_batch) {
 }
 
 Status RedisWriteOperation::ApplyPop(DocWriteBatch* doc_write_batch) {
-  return STATUS(NotSupported, "Redis operation has not been implemented");
+  const RedisKeyValuePB& kv = request_.key_value();
+  RedisDataType data_type;
+  RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
+                                  doc_write_batch));
+  if (!VerifyTypeAndSetCode(REDIS_TYPE_LIST, data_type, &response_)) {
+    // We've already set the error code in the response.
+    return Status::OK();
+  }
+
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  auto bounds = ReadListBounds(
+      doc_write_batch->rocksdb(), read_hybrid_time_, doc_key, doc_write_batch);
+  RETURN_NOT_OK(bounds);
+  if (bounds->size() <= 0) {
+    return STATUS_FORMAT(Corruption, "Redis list $0 has no elements", doc_key);
+  }
+  const int64_t index =
+      request_.pop_request().side() == REDIS_SIDE_LEFT ? bounds->head++ : --bounds->tail;
+  auto element = ReadCollectionEntry(doc_write_batch->rocksdb(), read_hybrid_time_, doc_key,
+                                     PrimitiveValue::ArrayIndex(index), doc_write_batch);
+  RETURN_NOT_OK(element);
+  if (!element->IsString()) {
+    return STATUS_FORMAT(Corruption, "Unexpected element $0 of redis list $1 at $2",
+                         *element, doc_key, index);
+  }
+
+  if (bounds->size() == 0) {
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key), Value(PrimitiveValue(ValueType::kTombstone))));
+  } else {
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key, PrimitiveValue::ArrayIndex(index)),
+        Value(PrimitiveValue(ValueType::kTombstone)), InitMarkerBehavior::OPTIONAL));
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key, PrimitiveValue(ValueType::kRedisListBounds)),
+        Value(EncodeListBounds(*bounds)), InitMarkerBehavior::OPTIONAL));
+  }
+  response_.set_string_response(element->GetString());
+  return Status::OK();
 }
 
 Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
   const RedisKeyValuePB& kv = request_.key_value();
+  if (kv.type() == REDIS_TYPE_SORTEDSET) {
+    return ApplyZAdd(doc_write_batch);
+  }
 
   RedisDataType data_type;
   RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
@@ -636,13 +1367,18 @@ Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
   }
 
   int num_keys_found = 0;
+  int64_t old_size = 0;
+  if (MaintainCollectionSize() && data_type != REDIS_TYPE_NONE) {
+    auto size = GetCollectionSize(doc_write_batch, read_hybrid_time_, kv);
+    RETURN_NOT_OK(size);
+    old_size = *size;
+  }
 
   SubDocument set_entries = SubDocument();
 
   for (int i = 0 ; i < kv.subkey_size(); i++) { // We know that each subkey is distinct.
-    if (FLAGS_emulate_redis_responses) {
+    if (FLAGS_emulate_redis_responses && data_type != REDIS_TYPE_NONE) {
       RedisDataType type;
-      string value;
       RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type,
                                       doc_write_batch, i));
       if (type != REDIS_TYPE_NONE) {
@@ -666,6 +1402,12 @@ Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
     RETURN_NOT_OK(
         doc_write_batch->ExtendSubDocument(doc_path, set_entries, InitMarkerBehavior::REQUIRED));
   }
+  if (MaintainCollectionSize()) {
+    RETURN_NOT_OK(UpdateCollectionSize(
+        doc_write_batch, kv, old_size, kv.subkey_size() - num_keys_found, /* num_removed */ 0));
+  } else {
+    RETURN_NOT_OK(DropCollectionSize(doc_write_batch, kv));
+  }
 
   response_.set_code(RedisResponsePB_RedisStatusCode_OK);
   if (FLAGS_emulate_redis_responses) {
@@ -675,6 +1417,89 @@ Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
   return Status::OK();
 }
 
+Status RedisWriteOperation::ApplyZAdd(DocWriteBatch* doc_write_batch) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  if (kv.subkey_size() == 0 || kv.subkey_size() != kv.value_size()) {
+    return STATUS_FORMAT(InvalidCommand,
+        "ZADD request should have the same non zero number of scores and members, found $0 and $1",
+        kv.subkey_size(), kv.value_size());
+  }
+
+  RedisDataType data_type;
+  RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &data_type,
+                                  doc_write_batch));
+  if (data_type != REDIS_TYPE_SORTEDSET && data_type != REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    return Status::OK();
+  }
+
+  const DocKey doc_key = DocKey::FromRedisKey(kv.hash_code(), kv.key());
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  const RedisWriteMode mode = request_.add_request().mode();
+
+  // Read old scores of the members from the reverse part, to replace their forward entries.
+  std::vector<SubDocument> old_scores;
+  std::vector<bool> found;
+  if (data_type == REDIS_TYPE_SORTEDSET) {
+    std::vector<SubDocKey> reverse_keys;
+    reverse_keys.reserve(kv.value_size());
+    for (const auto& member : kv.value()) {
+      reverse_keys.emplace_back(doc_key, PrimitiveValue(ValueType::kSSReverse),
+                                PrimitiveValue(member));
+    }
+    RETURN_NOT_OK(GetSubDocuments(
+        doc_write_batch->rocksdb(), reverse_keys, rocksdb::kDefaultQueryId, boost::none,
+        &old_scores, &found, read_hybrid_time_));
+  } else if (mode != REDIS_WRITEMODE_UPDATE) {
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key), Value(PrimitiveValue(ValueType::kRedisSortedSet))));
+  }
+
+  int64_t num_added = 0;
+  int64_t num_changed = 0;
+  for (int i = 0; i < kv.subkey_size(); i++) {
+    if (!kv.subkey(i).has_double_subkey()) {
+      return STATUS_FORMAT(InvalidArgument, "ZADD score $0 should be of double type",
+                           kv.subkey(i).ShortDebugString());
+    }
+    const double score = kv.subkey(i).double_subkey();
+    const PrimitiveValue member(kv.value(i));
+    const bool exists = !found.empty() && found[i];
+    if (exists ? mode == REDIS_WRITEMODE_INSERT : mode == REDIS_WRITEMODE_UPDATE) {
+      continue;
+    }
+    if (exists) {
+      if (!old_scores[i].IsDouble()) {
+        return STATUS_FORMAT(Corruption, "Unexpected score of sorted set member $0: $1",
+                             member, old_scores[i]);
+      }
+      const double old_score = old_scores[i].GetDouble();
+      if (old_score == score) {
+        continue;
+      }
+      RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+          DocPath(encoded_doc_key, PrimitiveValue(ValueType::kSSForward),
+                  PrimitiveValue::Double(old_score), member),
+          Value(PrimitiveValue(ValueType::kTombstone)), InitMarkerBehavior::OPTIONAL));
+      ++num_changed;
+    } else {
+      ++num_added;
+    }
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key, PrimitiveValue(ValueType::kSSForward),
+                PrimitiveValue::Double(score), member),
+        Value(PrimitiveValue(ValueType::kNull)), InitMarkerBehavior::OPTIONAL));
+    RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+        DocPath(encoded_doc_key, PrimitiveValue(ValueType::kSSReverse), member),
+        Value(PrimitiveValue::Double(score)), InitMarkerBehavior::OPTIONAL));
+  }
+
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response_.set_int_response(
+      request_.add_request().ch() ? num_added + num_changed : num_added);
+  return Status::OK();
+}
+
 Status RedisWriteOperation::ApplyRemove(DocWriteBatch* doc_write_batch) {
   return STATUS(NotSupported, "Redis operation has not been implemented");
 }
@@ -693,6 +1518,8 @@ Status RedisReadOperation::Execute(rocksdb::DB *rocksdb, const HybridTime& hybri
       return ExecuteGetRange(rocksdb, hybrid_time);
     case RedisReadRequestPB::RequestCase::kGetCollectionRangeRequest:
       return ExecuteCollectionGetRange(rocksdb, hybrid_time);
+    case RedisReadRequestPB::RequestCase::kScanRequest:
+      return ExecuteScan(rocksdb, hybrid_time);
     default:
       return STATUS(Corruption,
           Substitute("Unsupported redis write operation: $0", request_.request_case()));
@@ -711,106 +1538,475 @@ Status RedisReadOperation::ExecuteHGetAllLikeCommands(rocksdb::DB *rocksdb,
                                                       ValueType value_type,
                                                       bool add_keys,
                                                       bool add_values) {
-  SubDocKey doc_key(
+  const SubDocKey doc_key(
       DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
-  SubDocument doc;
-  bool doc_found = false;
-  // TODO(dtxn) - pass correct transaction context when we implement cross-shard transactions
-  // support for Redis.
-  RETURN_NOT_OK(GetSubDocument(
-      rocksdb, doc_key, rocksdb::kDefaultQueryId, boost::none, &doc, &doc_found, hybrid_time));
-  if (add_keys || add_values) {
-    response_.set_allocated_array_response(new RedisArrayPB());
+  response_.set_allocated_array_response(new RedisArrayPB());
+  auto cached_doc = GetCachedDocument(hybrid_time);
+  if (cached_doc) {
+    if (!VerifyTypeAndSetCode(value_type, cached_doc->value_type(), &response_)) {
+      return Status::OK();
+    }
+    for (const auto& child : cached_doc->object_container()) {
+      if (add_keys) {
+        RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+            child.first, response_.mutable_array_response()));
+      }
+      if (add_values) {
+        RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+            child.second, response_.mutable_array_response()));
+      }
+    }
+    return Status::OK();
   }
-  if (!doc_found) {
+
+  ValueType doc_type = ValueType::kInvalidValueType;
+  bool doc_has_ttl = false;
+  // Small collections without TTL are also collected to be cached.
+  bool cacheable = document_cache_ != nullptr;
+  boost::optional<SubDocument> doc;
+  int num_entries = 0;
+  // Entries are added to the response while scanning, instead of building the whole subdocument.
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, doc_key, /* start */ nullptr, /* start_is_exclusive */ false,
+      &doc_type, [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (doc_type != value_type) {
+          return false;
+        }
+        if (add_keys) {
+          RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+              key.subkeys()[0], response_.mutable_array_response()));
+        }
+        if (add_values) {
+          RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+              value.primitive_value(), response_.mutable_array_response()));
+        }
+        if (cacheable) {
+          if (value.has_ttl() || ++num_entries > FLAGS_redis_document_cache_max_subkeys) {
+            cacheable = false;
+            doc = boost::none;
+          } else {
+            if (!doc) {
+              doc.emplace(doc_type);
+            }
+            doc->SetChildPrimitive(key.subkeys()[0], value.primitive_value());
+          }
+        }
+        return true;
+      }, &doc_has_ttl));
+  if (doc_type == ValueType::kInvalidValueType || doc_type == ValueType::kTombstone) {
     response_.set_code(RedisResponsePB_RedisStatusCode_OK);
     return Status::OK();
   }
-  if (VerifyTypeAndSetCode(value_type, doc.value_type(), &response_)) {
-    if (add_keys || add_values) {
-      RETURN_NOT_OK(PopulateResponseFrom(doc.object_container(), &response_, add_keys, add_values));
-    } else {
-      response_.set_int_response(doc.object_container().size());
+  if (VerifyTypeAndSetCode(value_type, doc_type, &response_) && doc && !doc_has_ttl) {
+    document_cache_->Put(doc_key.doc_key().Encode().AsSlice(), std::move(*doc), hybrid_time);
+  }
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteCollectionSize(rocksdb::DB *rocksdb,
+                                                 HybridTime hybrid_time,
+                                                 RedisDataType data_type) {
+  auto cached_doc = GetCachedDocument(hybrid_time);
+  if (cached_doc) {
+    if (VerifyTypeAndSetCode(data_type, CollectionRedisType(cached_doc->value_type()), &response_,
+                             /* verify_success_if_missing */ true)) {
+      response_.set_int_response(cached_doc->object_container().size());
     }
+    return Status::OK();
+  }
+  RedisDataType type;
+  RETURN_NOT_OK(GetRedisValueType(rocksdb, hybrid_time, request_.key_value(), &type));
+  if (!VerifyTypeAndSetCode(data_type, type, &response_, /* verify_success_if_missing */ true)) {
+    return Status::OK();
+  }
+  if (type == REDIS_TYPE_NONE) {
+    response_.set_int_response(0);
+    return Status::OK();
   }
+  const DocKey doc_key =
+      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key());
+  if (type == REDIS_TYPE_LIST) {
+    auto bounds = ReadListBounds(rocksdb, hybrid_time, doc_key);
+    RETURN_NOT_OK(bounds);
+    response_.set_int_response(bounds->size());
+    return Status::OK();
+  }
+  auto size = ReadCollectionSize(rocksdb, hybrid_time, doc_key);
+  RETURN_NOT_OK(size);
+  response_.set_int_response(*size);
   return Status::OK();
 }
 
 Status RedisReadOperation::ExecuteCollectionGetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
   const RedisKeyValuePB& key_value = request_.key_value();
-  if (!request_.has_key_value() || !key_value.has_key() || !request_.has_subkey_range() ||
-      !request_.subkey_range().has_lower_bound() || !request_.subkey_range().has_upper_bound()) {
+  const auto request_type = request_.get_collection_range_request().request_type();
+  const bool needs_subkey_range =
+      request_type != RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGE &&
+      request_type != RedisCollectionGetRangeRequestPB_GetRangeRequestType_LRANGE;
+  if (!request_.has_key_value() || !key_value.has_key() ||
+      (needs_subkey_range && (!request_.has_subkey_range() ||
+                              !request_.subkey_range().has_lower_bound() ||
+                              !request_.subkey_range().has_upper_bound()))) {
     return STATUS(InvalidArgument, "Need to specify the key and the subkey range");
   }
 
-  const auto request_type = request_.get_collection_range_request().request_type();
   switch (request_type) {
-    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSRANGEBYTIME: {
-      const RedisSubKeyBoundPB& lower_bound = request_.subkey_range().lower_bound();
-      const RedisSubKeyBoundPB& upper_bound = request_.subkey_range().upper_bound();
-
-      if ((lower_bound.has_infinity_type() &&
-          lower_bound.infinity_type() == RedisSubKeyBoundPB_InfinityType_POSITIVE) ||
-          (upper_bound.has_infinity_type() &&
-              upper_bound.infinity_type() == RedisSubKeyBoundPB_InfinityType_NEGATIVE)) {
-        // Return empty response.
-        response_.set_code(RedisResponsePB_RedisStatusCode_OK);
-        RETURN_NOT_OK(PopulateResponseFrom(SubDocument::ObjectContainer(), &response_,
-            /* add_keys */ true, /* add_values */ true));
-        return Status::OK();
-      }
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSRANGEBYTIME: FALLTHROUGH_INTENDED;
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSREVRANGEBYTIME:
+      return ExecuteTimeSeriesRange(rocksdb, hybrid_time);
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGEBYSCORE: FALLTHROUGH_INTENDED;
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGE:
+      return ExecuteSortedSetRange(rocksdb, hybrid_time);
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_LRANGE:
+      return ExecuteListRange(rocksdb, hybrid_time);
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_UNKNOWN:
+      return STATUS(InvalidCommand, "Unknown Collection Get Range Request not supported");
+  }
+  return Status::OK();
+}
 
-      int64_t low_timestamp = lower_bound.subkey_bound().timestamp_subkey();
-      int64_t high_timestamp = upper_bound.subkey_bound().timestamp_subkey();
-
-      // Look for the appropriate subdoc.
-      SubDocKey doc_key(
-          DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
-
-      // Need to switch the order since we store the timestamps in descending order.
-      SubDocKeyBound low_subkey = (upper_bound.has_infinity_type()) ?
-          SubDocKeyBound(): SubDocKeyBound(doc_key.doc_key(),
-                                           PrimitiveValue(high_timestamp, SortOrder::kDescending),
-                                           upper_bound.is_exclusive(), /* is_lower_bound */ true);
-      SubDocKeyBound high_subkey = (lower_bound.has_infinity_type()) ?
-          SubDocKeyBound(): SubDocKeyBound(doc_key.doc_key(),
-                                           PrimitiveValue(low_timestamp, SortOrder::kDescending),
-                                           lower_bound.is_exclusive(), /* is_lower_bound */ false);
-
-      SubDocument doc;
-      bool doc_found = false;
-      RETURN_NOT_OK(GetSubDocument(
-          rocksdb, doc_key, rocksdb::kDefaultQueryId, boost::none, &doc, &doc_found, hybrid_time,
-          Value::kMaxTtl, false, low_subkey, high_subkey));
-
-      // Validate and populate response.
-      response_.set_allocated_array_response(new RedisArrayPB());
-      if (!doc_found) {
-        response_.set_code(RedisResponsePB_RedisStatusCode_OK);
-        return Status::OK();
-      }
-      if (VerifyTypeAndSetCode(ValueType::kRedisTS, doc.value_type(), &response_)) {
-        // Need to reverse the order here since we store the timestamps in descending order.
-        RETURN_NOT_OK(PopulateResponseFrom(doc.object_container(), &response_, /* add_keys */ true,
-            /* add_values */ true, /* reverse */ true));
-      }
+Status RedisReadOperation::ExecuteTimeSeriesRange(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
+  const RedisSubKeyBoundPB& lower_bound = request_.subkey_range().lower_bound();
+  const RedisSubKeyBoundPB& upper_bound = request_.subkey_range().upper_bound();
+  const bool reverse = request_.get_collection_range_request().request_type() ==
+                       RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSREVRANGEBYTIME;
+
+  response_.set_allocated_array_response(new RedisArrayPB());
+  if ((lower_bound.has_infinity_type() &&
+      lower_bound.infinity_type() == RedisSubKeyBoundPB_InfinityType_POSITIVE) ||
+      (upper_bound.has_infinity_type() &&
+          upper_bound.infinity_type() == RedisSubKeyBoundPB_InfinityType_NEGATIVE)) {
+    // Return empty response.
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    return Status::OK();
+  }
+
+  const int64_t low_timestamp = lower_bound.subkey_bound().timestamp_subkey();
+  const int64_t high_timestamp = upper_bound.subkey_bound().timestamp_subkey();
+  auto below_range = [&](int64_t timestamp) {
+    return !lower_bound.has_infinity_type() &&
+           (timestamp < low_timestamp ||
+            (lower_bound.is_exclusive() && timestamp == low_timestamp));
+  };
+  auto above_range = [&](int64_t timestamp) {
+    return !upper_bound.has_infinity_type() &&
+           (timestamp > high_timestamp ||
+            (upper_bound.is_exclusive() && timestamp == high_timestamp));
+  };
+  // Only the newest entries could be limited, since the scan goes from the upper bound down.
+  int64_t count = reverse ? request_.get_collection_range_request().count() : -1;
+
+  const SubDocKey doc_key(
+      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
+  // Timestamps are stored in descending order, so the scan starts at the upper bound. For a time
+  // series stored in blocks it starts at the block containing the upper bound.
+  SubDocKey start_key;
+  const SubDocKey* start = nullptr;
+  if (!upper_bound.has_infinity_type()) {
+    start_key = SubDocKey(
+        doc_key.doc_key(), PrimitiveValue(high_timestamp, SortOrder::kDescending));
+    start = &start_key;
+  }
+
+  const MicrosTime now = PhysicalMicros(hybrid_time);
+  ValueType doc_type = ValueType::kInvalidValueType;
+  std::vector<std::pair<PrimitiveValue, PrimitiveValue>> entries;
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, doc_key, start, upper_bound.is_exclusive(), &doc_type,
+      [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (count == 0) {
+          return false;
+        }
+        if (doc_type == ValueType::kRedisTSBlocks) {
+          RedisTSBlock block(/* width */ 1);
+          RETURN_NOT_OK(DecodeTSBlock(value.primitive_value(), now, &block));
+          const auto& points = block.points();
+          for (auto it = points.rbegin(); it != points.rend() && count != 0; ++it) {
+            if (below_range(it->timestamp)) {
+              return false;
+            }
+            if (!above_range(it->timestamp)) {
+              entries.emplace_back(PrimitiveValue(it->timestamp), PrimitiveValue(it->value));
+              if (count > 0) {
+                --count;
+              }
+            }
+          }
+          // Older blocks have only timestamps below the start of this one.
+          return count != 0 &&
+                 (lower_bound.has_infinity_type() || key.subkeys()[0].GetInt64() > low_timestamp);
+        }
+        if (doc_type != ValueType::kRedisTS) {
+          return false;
+        }
+        const PrimitiveValue& timestamp = key.subkeys()[0];
+        if (below_range(timestamp.GetInt64())) {
+          return false;
+        }
+        entries.emplace_back(timestamp, value.primitive_value());
+        return count < 0 || --count > 0;
+      }));
+
+  if (doc_type == ValueType::kInvalidValueType || doc_type == ValueType::kTombstone) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    return Status::OK();
+  }
+  if (!VerifyTypeAndSetCode(
+          doc_type == ValueType::kRedisTSBlocks ? ValueType::kRedisTSBlocks : ValueType::kRedisTS,
+          doc_type, &response_)) {
+    return Status::OK();
+  }
+  if (reverse) {
+    return PopulateResponseFrom(entries.begin(), entries.end(), &response_,
+                                /* add_keys */ true, /* add_values */ true);
+  }
+  // Need to reverse the order here since we store the timestamps in descending order.
+  return PopulateResponseFrom(entries.rbegin(), entries.rend(), &response_,
+                              /* add_keys */ true, /* add_values */ true);
+}
+
+Status RedisReadOperation::ExecuteTimeSeriesGet(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
+  const RedisKeyValuePB& key_value = request_.key_value();
+  if (!key_value.has_key() || key_value.subkey_size() != 1) {
+    return STATUS(InvalidArgument, "Need to specify the key and the timestamp");
+  }
+  PrimitiveValue timestamp;
+  RETURN_NOT_OK(PrimitiveValueFromSubKeyStrict(
+      key_value.subkey(0), REDIS_TYPE_TIMESERIES, &timestamp));
+
+  // The point is stored either at the timestamp or in the block with the greatest start not
+  // exceeding it, both are the first entry at or after the timestamp in key order.
+  const SubDocKey doc_key(DocKey::FromRedisKey(key_value.hash_code(), key_value.key()));
+  const SubDocKey start(doc_key.doc_key(), timestamp);
+  const MicrosTime now = PhysicalMicros(hybrid_time);
+  ValueType doc_type = ValueType::kInvalidValueType;
+  boost::optional<std::string> point_value;
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, doc_key, &start, /* start_is_exclusive */ false, &doc_type,
+      [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (doc_type == ValueType::kRedisTS) {
+          if (key.subkeys()[0] == timestamp && value.primitive_value().IsString()) {
+            point_value = value.primitive_value().GetString();
+          }
+        } else if (doc_type == ValueType::kRedisTSBlocks) {
+          RedisTSBlock block(/* width */ 1);
+          RETURN_NOT_OK(DecodeTSBlock(value.primitive_value(), now, &block));
+          const RedisTSPoint* point = block.Find(timestamp.GetInt64());
+          if (point != nullptr) {
+            point_value = point->value;
+          }
+        }
+        return false;
+      }));
+
+  if (!point_value) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_NOT_FOUND);
+    return Status::OK();
+  }
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response_.set_string_response(*point_value);
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteScan(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
+  const auto& scan_request = request_.scan_request();
+  ValueType value_type;
+  bool add_values;
+  switch (scan_request.request_type()) {
+    case RedisScanRequestPB_ScanRequestType_HSCAN:
+      value_type = ValueType::kObject;
+      add_values = true;
+      break;
+    case RedisScanRequestPB_ScanRequestType_SSCAN:
+      value_type = ValueType::kRedisSet;
+      add_values = false;
       break;
+    case RedisScanRequestPB_ScanRequestType_UNKNOWN: FALLTHROUGH_INTENDED;
+    default:
+      return STATUS(InvalidCommand, "Unknown Scan Request not supported");
+  }
+  if (scan_request.count() <= 0) {
+    return STATUS_FORMAT(InvalidArgument, "Invalid scan count: $0", scan_request.count());
+  }
+
+  const SubDocKey doc_key(
+      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
+  SubDocKey start_key;
+  const SubDocKey* start = nullptr;
+  if (!scan_request.cursor().empty()) {
+    rocksdb::Slice cursor(scan_request.cursor());
+    PrimitiveValue last_subkey;
+    RETURN_NOT_OK_PREPEND(last_subkey.DecodeFromKey(&cursor), "Invalid scan cursor");
+    if (!cursor.empty()) {
+      return STATUS(InvalidArgument, "Invalid scan cursor");
+    }
+    start_key = SubDocKey(doc_key.doc_key(), last_subkey);
+    start = &start_key;
+  }
+
+  response_.set_allocated_array_response(new RedisArrayPB());
+  response_.set_cursor("");
+  ValueType doc_type = ValueType::kInvalidValueType;
+  int64_t count = scan_request.count();
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, doc_key, start, /* start_is_exclusive */ true, &doc_type,
+      [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        if (doc_type != value_type) {
+          return false;
+        }
+        RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+            key.subkeys()[0], response_.mutable_array_response()));
+        if (add_values) {
+          RETURN_NOT_OK(AddPrimitiveValueToResponseArray(
+              value.primitive_value(), response_.mutable_array_response()));
+        }
+        if (--count > 0) {
+          return true;
+        }
+        // Page is full, the next one starts right after the last returned subkey.
+        response_.set_cursor(key.subkeys()[0].ToKeyBytes().data());
+        return false;
+      }));
+
+  if (doc_type == ValueType::kInvalidValueType || doc_type == ValueType::kTombstone) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    return Status::OK();
+  }
+  VerifyTypeAndSetCode(value_type, doc_type, &response_);
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteSortedSetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
+  const auto& range_request = request_.get_collection_range_request();
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  SortedSetScoreBound low{-kInfinity, false};
+  SortedSetScoreBound high{kInfinity, false};
+  int64_t offset = 0;
+  int64_t count = -1;
+  // Indexes counted from the end of the set could only be resolved after reading it completely.
+  bool apply_indexes = false;
+  if (range_request.request_type() ==
+          RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGEBYSCORE) {
+    low = ScoreBoundFromPB(request_.subkey_range().lower_bound(), /* is_lower_bound */ true);
+    high = ScoreBoundFromPB(request_.subkey_range().upper_bound(), /* is_lower_bound */ false);
+    offset = range_request.offset();
+    count = range_request.count();
+  } else if (range_request.start() >= 0 && range_request.stop() >= 0) {
+    offset = range_request.start();
+    count = std::max<int64_t>(range_request.stop() - range_request.start() + 1, 0);
+  } else {
+    apply_indexes = true;
+  }
+
+  ValueType doc_type;
+  std::vector<std::pair<double, std::string>> members;
+  RETURN_NOT_OK(ScanSortedSet(
+      rocksdb, hybrid_time,
+      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()),
+      low, high, std::max<int64_t>(offset, 0), count, &doc_type, &members));
+
+  response_.set_allocated_array_response(new RedisArrayPB());
+  if (doc_type == ValueType::kInvalidValueType || doc_type == ValueType::kTombstone) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    return Status::OK();
+  }
+  if (!VerifyTypeAndSetCode(ValueType::kRedisSortedSet, doc_type, &response_)) {
+    return Status::OK();
+  }
+
+  size_t begin = 0;
+  size_t end = members.size();
+  if (apply_indexes) {
+    const int64_t size = members.size();
+    int64_t start = range_request.start() < 0 ? range_request.start() + size
+                                              : range_request.start();
+    int64_t stop = range_request.stop() < 0 ? range_request.stop() + size : range_request.stop();
+    start = std::max<int64_t>(start, 0);
+    stop = std::min(stop, size - 1);
+    begin = start;
+    end = start <= stop ? stop + 1 : start;
+  }
+  auto* array_response = response_.mutable_array_response();
+  for (size_t i = begin; i < end; ++i) {
+    array_response->add_elements(members[i].second);
+    if (range_request.with_scores()) {
+      array_response->add_elements(SimpleDtoa(members[i].first));
     }
-    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_UNKNOWN:
-      return STATUS(InvalidCommand, "Unknown Collection Get Range Request not supported");
   }
   return Status::OK();
 }
 
+Status RedisReadOperation::ExecuteListRange(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
+  const auto& range_request = request_.get_collection_range_request();
+  response_.set_allocated_array_response(new RedisArrayPB());
+  RedisDataType type;
+  RETURN_NOT_OK(GetRedisValueType(rocksdb, hybrid_time, request_.key_value(), &type));
+  if (!VerifyTypeAndSetCode(REDIS_TYPE_LIST, type, &response_,
+                            /* verify_success_if_missing */ true) ||
+      type == REDIS_TYPE_NONE) {
+    return Status::OK();
+  }
+
+  const DocKey doc_key =
+      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key());
+  auto bounds = ReadListBounds(rocksdb, hybrid_time, doc_key);
+  RETURN_NOT_OK(bounds);
+  const int64_t size = bounds->size();
+  int64_t start = range_request.start() < 0 ? range_request.start() + size
+                                            : range_request.start();
+  int64_t stop = range_request.stop() < 0 ? range_request.stop() + size : range_request.stop();
+  start = std::max<int64_t>(start, 0);
+  stop = std::min(stop, size - 1);
+  if (start > stop) {
+    return Status::OK();
+  }
+
+  const int64_t last_index = bounds->head + stop;
+  const SubDocKey start_key(doc_key, PrimitiveValue::ArrayIndex(bounds->head + start));
+  ValueType doc_type;
+  auto* array_response = response_.mutable_array_response();
+  RETURN_NOT_OK(ScanCollection(
+      rocksdb, hybrid_time, SubDocKey(doc_key), &start_key, /* start_is_exclusive */ false,
+      &doc_type,
+      [&](const SubDocKey& key, const Value& value) -> Result<bool> {
+        const auto& subkey = key.subkeys()[0];
+        if (subkey.value_type() != ValueType::kArrayIndex) {
+          return STATUS_FORMAT(Corruption, "Unexpected redis list entry: $0", key);
+        }
+        if (subkey.GetArrayIndex() > last_index) {
+          return false;
+        }
+        RETURN_NOT_OK(AddPrimitiveValueToResponseArray(value.primitive_value(), array_response));
+        return true;
+      }));
+  return Status::OK();
+}
+
 Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
 
   RedisDataType type;
 
   const auto request_type = request_.get_request().request_type();
   switch (request_type) {
+    case RedisGetRequestPB_GetRequestType_TSGET:
+      return ExecuteTimeSeriesGet(rocksdb, hybrid_time);
     case RedisGetRequestPB_GetRequestType_GET: FALLTHROUGH_INTENDED;
-    case RedisGetRequestPB_GetRequestType_TSGET: FALLTHROUGH_INTENDED;
     case RedisGetRequestPB_GetRequestType_HGET: {
+      auto cached_doc = request_type == RedisGetRequestPB_GetRequestType_HGET
+          ? GetCachedDocument(hybrid_time) : nullptr;
+      if (cached_doc && cached_doc->value_type() == ValueType::kObject &&
+          request_.key_value().subkey_size() == 1) {
+        PrimitiveValue subkey;
+        RETURN_NOT_OK(PrimitiveValueFromSubKey(request_.key_value().subkey(0), &subkey));
+        const SubDocument* field = cached_doc->GetChild(subkey);
+        if (field == nullptr || field->IsString()) {
+          type = field ? RedisDataType::REDIS_TYPE_STRING : RedisDataType::REDIS_TYPE_NONE;
+          if (VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_STRING, type, &response_)) {
+            response_.set_string_response(field->GetString());
+          }
+          return Status::OK();
+        }
+      }
       string value;
       RETURN_NOT_OK(GetRedisValue(rocksdb, hybrid_time, request_.key_value(), &type, &value));
 
@@ -849,19 +2045,53 @@ Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_ti
       return STATUS(NotSupported, "MGET not yet supported");
     }
     case RedisGetRequestPB_GetRequestType_HMGET: {
-      RETURN_NOT_OK(GetRedisValueType(rocksdb, hybrid_time, request_.key_value(), &type, nullptr));
+      auto cached_doc = GetCachedDocument(hybrid_time);
+      if (cached_doc) {
+        type = CollectionRedisType(cached_doc->value_type());
+      } else {
+        RETURN_NOT_OK(GetRedisValueType(
+            rocksdb, hybrid_time, request_.key_value(), &type, nullptr));
+      }
       if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_HASH, type, &response_, true)) {
           return Status::OK();
       }
 
+      const auto& key_value = request_.key_value();
+      if (cached_doc) {
+        response_.set_allocated_array_response(new RedisArrayPB());
+        for (const auto& subkey : key_value.subkey()) {
+          PrimitiveValue subkey_primitive;
+          RETURN_NOT_OK(PrimitiveValueFromSubKey(subkey, &subkey_primitive));
+          const SubDocument* field = cached_doc->GetChild(subkey_primitive);
+          response_.mutable_array_response()->add_elements(
+              field && field->IsPrimitive() ? field->GetString() : "");
+        }
+        response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+        return Status::OK();
+      }
+
+      const DocKey doc_key = DocKey::FromRedisKey(key_value.hash_code(), key_value.key());
+      std::vector<SubDocKey> subdoc_keys;
+      subdoc_keys.reserve(key_value.subkey_size());
+      for (const auto& subkey : key_value.subkey()) {
+        PrimitiveValue subkey_primitive;
+        RETURN_NOT_OK(PrimitiveValueFromSubKey(subkey, &subkey_primitive));
+        subdoc_keys.emplace_back(doc_key, subkey_primitive);
+      }
+
+      // Look up all the fields with a single iterator.
+      // TODO(dtxn) - pass correct transaction context when we implement cross-shard transactions
+      // support for Redis.
+      std::vector<SubDocument> docs;
+      std::vector<bool> docs_found;
+      RETURN_NOT_OK(GetSubDocuments(
+          rocksdb, subdoc_keys, rocksdb::kDefaultQueryId, boost::none, &docs, &docs_found,
+          hybrid_time));
+
       response_.set_allocated_array_response(new RedisArrayPB());
-      for (int i = 0; i < request_.key_value().subkey_size(); i++) {
-        // TODO: ENG-1803: It is inefficient to create a new iterator for each subkey causing a
-        // new seek. Consider reusing the same iterator.
-        string value;
-        RETURN_NOT_OK(GetRedisValue(rocksdb, hybrid_time, request_.key_value(), &type, &value, i));
-        if (type == REDIS_TYPE_STRING) {
-          response_.mutable_array_response()->add_elements(value);
+      for (size_t i = 0; i != docs.size(); ++i) {
+        if (docs_found[i] && docs[i].IsPrimitive()) {
+          response_.mutable_array_response()->add_elements(docs[i].GetString());
         } else {
           response_.mutable_array_response()->add_elements(""); // Empty is nil response.
         }
@@ -876,11 +2106,13 @@ Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_ti
     case RedisGetRequestPB_GetRequestType_HVALS:
       return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kObject, false, true);
     case RedisGetRequestPB_GetRequestType_HLEN:
-      return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kObject, false, false);
+      return ExecuteCollectionSize(rocksdb, hybrid_time, REDIS_TYPE_HASH);
     case RedisGetRequestPB_GetRequestType_SMEMBERS:
       return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kRedisSet, true, false);
     case RedisGetRequestPB_GetRequestType_SCARD:
-      return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kRedisSet, false, false);
+      return ExecuteCollectionSize(rocksdb, hybrid_time, REDIS_TYPE_SET);
+    case RedisGetRequestPB_GetRequestType_LLEN:
+      return ExecuteCollectionSize(rocksdb, hybrid_time, REDIS_TYPE_LIST);
     case RedisGetRequestPB_GetRequestType_UNKNOWN: {
       return STATUS(InvalidCommand, "Unknown Get Request not supported");
     }
@@ -947,21 +2179,74 @@ Status RedisReadOperation::ExecuteGetRange(rocksdb::DB *rocksdb, HybridTime hybr
   return Status::OK();
 }
 
+std::shared_ptr<const SubDocument> RedisReadOperation::GetCachedDocument(HybridTime hybrid_time) {
+  if (!document_cache_ || !request_.key_value().has_key()) {
+    return nullptr;
+  }
+  const auto& key_value = request_.key_value();
+  return document_cache_->Get(
+      DocKey::FromRedisKey(key_value.hash_code(), key_value.key()).Encode().AsSlice(),
+      hybrid_time);
+}
+
 const RedisResponsePB& RedisReadOperation::response() {
   return response_;
 }
 
 namespace {
 
+// Whether the request only updates counters by increments of the form "c = c +/- <value>", which
+// are written as deltas without reading the columns.
+// Whether the column value is written as a change of the current value of its column, without
+// reading it: a counter increment or an update of a collection with a constant collection.
+bool IsInPlaceUpdate(const QLColumnValuePB& column_value) {
+  const auto& expr = column_value.expr();
+  if (!column_value.subscript_args().empty() || !expr.has_bfcall()) {
+    return false;
+  }
+  int32_t column_id = 0;
+  if (YQLExpression::IsCounterIncrement(expr.bfcall())) {
+    column_id = expr.bfcall().operands(0).column_id();
+  } else if (!YQLExpression::IsCollectionUpdate(expr.bfcall(), &column_id)) {
+    return false;
+  }
+  return column_id == column_value.column_id();
+}
+
+bool OnlyUpdatesInPlace(const QLWriteRequestPB& request) {
+  if (request.column_values().empty()) {
+    return false;
+  }
+  set<int32_t> updated_ids;
+  for (const auto& column_value : request.column_values()) {
+    if (!IsInPlaceUpdate(column_value)) {
+      return false;
+    }
+    updated_ids.insert(column_value.column_id());
+  }
+  for (const auto* ids : {&request.column_refs().ids(), &request.column_refs().static_ids()}) {
+    for (int32_t id : *ids) {
+      if (updated_ids.count(id) == 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool RequireRead(const QLWriteRequestPB& request) {
   // A QLWriteOperation requires a read if it contains an IF clause or an UPDATE assignment that
   // involves an expresion with a column reference. If the IF clause contains a condition that
   // involves a column reference, the column will be included in "column_refs". However, we cannot
   // rely on non-empty "column_ref" alone to decide if a read is required becaue "IF EXISTS" and
-  // "IF NOT EXISTS" do not involve a column reference explicitly.
-  return request.has_if_expr()
+  // "IF NOT EXISTS" do not involve a column reference explicitly. Maintaining secondary indexes
+  // requires the current values of the indexed columns. Counter increments and additions to or
+  // removals from collections reference the updated columns but do not read them, only updates of
+  // list elements by index read the list, by themselves.
+  return request.has_if_expr() || !request.update_indexes().empty()
       || request.has_column_refs() && (!request.column_refs().ids().empty() ||
-                                       !request.column_refs().static_ids().empty());
+                                       !request.column_refs().static_ids().empty())
+         && !OnlyUpdatesInPlace(request);
 }
 
 // Create projection schemas of static and non-static columns from a rowblock projection schema
@@ -1012,6 +2297,64 @@ void PopulateRow(
   }
 }
 
+// Reads the columns of projection of the row stored at doc_key into table_row, with a point lookup
+// that follows the visibility rules of DocRowwiseIterator. Values written before
+// partition_deleted_ts, the time of the latest delete of the hash partition of the row, are not
+// visible. Sets row_found to whether the row exists, table_row is not changed if it does not.
+CHECKED_STATUS ReadRow(IntentAwareIterator* iter,
+                       const Schema& schema,
+                       const Schema& projection,
+                       const DocKey& doc_key,
+                       HybridTime hybrid_time,
+                       const DocHybridTime& partition_deleted_ts,
+                       QLTableRow* table_row,
+                       bool* row_found) {
+  std::vector<PrimitiveValue> projection_subkeys;
+  projection_subkeys.reserve(projection.num_columns() + 1);
+  projection_subkeys.push_back(PrimitiveValue::SystemColumnId(SystemColumnIds::kLivenessColumn));
+  for (size_t i = projection.num_key_columns(); i < projection.num_columns(); i++) {
+    projection_subkeys.emplace_back(projection.column_id(i));
+  }
+  std::sort(projection_subkeys.begin(), projection_subkeys.end());
+
+  const SubDocKey row_key(doc_key);
+  const MonoDelta table_ttl = TableTTL(schema);
+  SubDocument row;
+  RETURN_NOT_OK(GetSubDocument(
+      iter, row_key, &row, row_found, hybrid_time, table_ttl, &projection_subkeys,
+      false /* return_type_only */, false /* is_iter_valid */, SubDocKeyBound(), SubDocKeyBound(),
+      partition_deleted_ts));
+  if (!*row_found) {
+    // No projected column is found, the row exists if some other column does.
+    RETURN_NOT_OK(HasSubDocument(
+        iter, row_key, row_found, hybrid_time, table_ttl, false /* is_iter_valid */,
+        partition_deleted_ts));
+    if (!*row_found) {
+      return Status::OK();
+    }
+  }
+
+  size_t column_idx = 0;
+  for (const auto* group : {&doc_key.hashed_group(), &doc_key.range_group()}) {
+    for (const auto& component : *group) {
+      PrimitiveValue::ToQLValuePB(component, schema.column(column_idx).type(),
+                                  &(*table_row)[schema.column_id(column_idx)].value);
+      ++column_idx;
+    }
+  }
+  for (size_t i = projection.num_key_columns(); i < projection.num_columns(); i++) {
+    const auto column_id = projection.column_id(i);
+    const SubDocument* column_value = row.GetChild(PrimitiveValue(column_id));
+    if (column_value != nullptr) {
+      auto& column = (*table_row)[column_id];
+      SubDocument::ToQLValuePB(*column_value, projection.column(i).type(), &column.value);
+      column.ttl_seconds = column_value->GetTtl();
+      column.write_time = column_value->GetWritetime();
+    }
+  }
+  return Status::OK();
+}
+
 // Join a static row with a non-static row.
 void JoinStaticRow(
     const Schema& schema, const Schema& static_projection, const QLTableRow& static_row,
@@ -1063,13 +2406,21 @@ QLWriteOperation::QLWriteOperation(
   // non-static columns or writing the full primary key (i.e. range columns are present or table
   // does not have range columns).
   CHECK_OK(InitializeKeys(
-      write_static_columns,
+      write_static_columns || IsPartitionDelete(),
       write_non_static_columns ||
       !request_.range_column_values().empty() ||
       schema.num_range_key_columns() == 0));
 }
 
 Status QLWriteOperation::InitializeKeys(const bool hashed_key, const bool primary_key) {
+  const bool need_hashed_key = hashed_key && hashed_doc_key_ == nullptr;
+  const bool need_primary_key = primary_key && pk_doc_key_ == nullptr;
+  // The keys are initialized when the operation is created, so the later calls usually find the
+  // keys they need already built and encoded.
+  if (!need_hashed_key && !need_primary_key) {
+    return Status::OK();
+  }
+
   // Populate the hashed and range components in the same order as they are in the table schema.
   const auto& hashed_column_values = request_.hashed_column_values();
   const auto& range_column_values = request_.range_column_values();
@@ -1078,18 +2429,20 @@ Status QLWriteOperation::InitializeKeys(const bool hashed_key, const bool primar
   RETURN_NOT_OK(QLKeyColumnValuesToPrimitiveValues(
       hashed_column_values, schema_, 0,
       schema_.num_hash_key_columns(), &hashed_components));
-  RETURN_NOT_OK(QLKeyColumnValuesToPrimitiveValues(
-      range_column_values, schema_, schema_.num_hash_key_columns(),
-      schema_.num_range_key_columns(), &range_components));
+  if (need_primary_key) {
+    RETURN_NOT_OK(QLKeyColumnValuesToPrimitiveValues(
+        range_column_values, schema_, schema_.num_hash_key_columns(),
+        schema_.num_range_key_columns(), &range_components));
+  }
 
   // We need the hash key if writing to the static columns.
-  if (hashed_key && hashed_doc_key_ == nullptr) {
+  if (need_hashed_key) {
     hashed_doc_key_.reset(new DocKey(request_.hash_code(), hashed_components));
     hashed_doc_path_.reset(new DocPath(hashed_doc_key_->Encode()));
   }
   // We need the primary key if writing to non-static columns or writing the full primary key
   // (i.e. range columns are present).
-  if (primary_key && pk_doc_key_ == nullptr) {
+  if (need_primary_key) {
     if (request_.has_hash_code() && !hashed_column_values.empty()) {
       pk_doc_key_.reset(new DocKey(request_.hash_code(), hashed_components, range_components));
     } else {
@@ -1102,6 +2455,12 @@ Status QLWriteOperation::InitializeKeys(const bool hashed_key, const bool primar
   return Status::OK();
 }
 
+bool QLWriteOperation::IsPartitionDelete() const {
+  return request_.type() == QLWriteRequestPB::QL_STMT_DELETE &&
+         request_.column_values().empty() && request_.range_column_values().empty() &&
+         !request_.hashed_column_values().empty() && schema_.num_range_key_columns() > 0;
+}
+
 void QLWriteOperation::GetDocPathsToLock(list<DocPath> *paths, IsolationLevel *level) const {
   if (hashed_doc_path_ != nullptr)
     paths->push_back(*hashed_doc_path_);
@@ -1145,23 +2504,46 @@ Status QLWriteOperation::ReadColumns(rocksdb::DB *rocksdb,
   RETURN_NOT_OK(InitializeKeys(
       !static_projection->columns().empty(), !non_static_projection->columns().empty()));
 
-  // Scan docdb for the static and non-static columns of the row using the hashed / primary key.
-  if (hashed_doc_key_ != nullptr) {
-    DocQLScanSpec spec(*static_projection, *hashed_doc_key_, query_id);
-    DocRowwiseIterator iterator(*static_projection, schema_, txn_op_context_, rocksdb, hybrid_time);
-    RETURN_NOT_OK(iterator.Init(spec));
-    if (iterator.HasNext()) {
-      RETURN_NOT_OK(iterator.NextRow(*static_projection, table_row));
+  // Look up the static and non-static columns of the row using the hashed / primary key. Both are
+  // point lookups, so one iterator serves both of them, unless the bloom filter of the primary key
+  // includes range components and would skip the files that have only the hashed key.
+  std::unique_ptr<IntentAwareIterator> iter;
+  DocHybridTime partition_deleted_ts = DocHybridTime::kMin;
+  const bool row_of_partition = pk_doc_key_ != nullptr && schema_.num_range_key_columns() > 0 &&
+                                !pk_doc_key_->hashed_group().empty();
+  if (hashed_doc_key_ != nullptr || row_of_partition) {
+    // The hashed key is encoded already when it is needed for the static columns.
+    KeyBytes partition_key_buffer;
+    if (hashed_doc_key_ == nullptr) {
+      partition_key_buffer = DocKey(pk_doc_key_->hash(), pk_doc_key_->hashed_group()).Encode();
+    }
+    const KeyBytes& encoded_partition_key =
+        hashed_doc_key_ != nullptr ? hashed_doc_path_->encoded_doc_key() : partition_key_buffer;
+    iter = CreateIntentAwareIterator(
+        rocksdb, BloomFilterMode::USE_BLOOM_FILTER, encoded_partition_key.AsSlice(), query_id,
+        txn_op_context_, hybrid_time);
+    if (row_of_partition) {
+      RETURN_NOT_OK(iter->SeekWithoutHt(encoded_partition_key));
+      RETURN_NOT_OK(iter->FindLastWriteTime(
+          encoded_partition_key, hybrid_time, &partition_deleted_ts, nullptr /* result_value */));
+    }
+    if (hashed_doc_key_ != nullptr) {
+      bool row_found = false;
+      RETURN_NOT_OK(ReadRow(iter.get(), schema_, *static_projection, *hashed_doc_key_, hybrid_time,
+                            DocHybridTime::kMin, table_row, &row_found));
     }
   }
   if (pk_doc_key_ != nullptr) {
-    DocQLScanSpec spec(*non_static_projection, *pk_doc_key_, query_id);
-    DocRowwiseIterator iterator(
-        *non_static_projection, schema_, txn_op_context_, rocksdb, hybrid_time);
-    RETURN_NOT_OK(iterator.Init(spec));
-    if (iterator.HasNext()) {
-      RETURN_NOT_OK(iterator.NextRow(*non_static_projection, table_row));
-    } else {
+    if (iter == nullptr || FLAGS_docdb_bloom_filter_range_components > 0) {
+      iter = CreateIntentAwareIterator(
+          rocksdb, BloomFilterMode::USE_BLOOM_FILTER, pk_doc_path_->encoded_doc_key().AsSlice(),
+          query_id,
+          txn_op_context_, hybrid_time);
+    }
+    bool row_found = false;
+    RETURN_NOT_OK(ReadRow(iter.get(), schema_, *non_static_projection, *pk_doc_key_, hybrid_time,
+                          partition_deleted_ts, table_row, &row_found));
+    if (!row_found) {
       // If no non-static column is found, the row does not exist and we should clear the static
       // columns in the map to indicate the row does not exist.
       table_row->clear();
@@ -1303,6 +2685,12 @@ Status QLWriteOperation::Apply(
                                                                    InitMarkerBehavior::OPTIONAL,
                                                                    ttl));
                   break;
+                case WriteAction::INCREMENT:
+                  RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+                      sub_path,
+                      Value(PrimitiveValue::Int64Delta(sub_doc.GetInt64()), ttl),
+                      InitMarkerBehavior::OPTIONAL));
+                  break;
                 case WriteAction::REMOVE_VALUES:
                   LOG(ERROR) << "Unsupported operation";
                   // TODO(akashnil or mihnea) this should call RemoveFromList once thats implemented
@@ -1380,6 +2768,15 @@ Status QLWriteOperation::Apply(
                 PrimitiveValue(column_id));
             RETURN_NOT_OK(doc_write_batch->DeleteSubDoc(sub_path, InitMarkerBehavior::OPTIONAL));
           }
+        } else if (IsPartitionDelete()) {
+          if (!request_.update_indexes().empty()) {
+            return STATUS(NotSupported,
+                          "Deleting a whole hash partition of an indexed table is not supported");
+          }
+          // A single tombstone at the hashed key deletes the static columns and all rows of the
+          // partition, since readers and compactions apply it to the rows.
+          RETURN_NOT_OK(doc_write_batch->DeleteSubDoc(
+              *hashed_doc_path_, InitMarkerBehavior::OPTIONAL));
         } else {
           RETURN_NOT_OK(doc_write_batch->DeleteSubDoc(
               *pk_doc_path_, InitMarkerBehavior::OPTIONAL));
@@ -1388,6 +2785,9 @@ Status QLWriteOperation::Apply(
       }
     }
 
+    if (!request_.update_indexes().empty()) {
+      RETURN_NOT_OK(UpdateIndexes(table_row));
+    }
   }
 
   response_->set_status(QLResponsePB::YQL_STATUS_OK);
@@ -1395,6 +2795,150 @@ Status QLWriteOperation::Apply(
   return Status::OK();
 }
 
+namespace {
+
+// Does the row have non-null values for all key columns of the index?
+bool HasIndexKey(const IndexInfoPB& index, const QLTableRow& row) {
+  const int key_column_count = index.hash_column_count() + index.range_column_count();
+  for (int idx = 0; idx < key_column_count; idx++) {
+    const auto it = row.find(ColumnId(index.columns(idx).indexed_column_id()));
+    if (it == row.end() || QLValue::IsNull(it->second.value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Do the rows have the same values for the key columns of the index?
+bool IndexKeyEquals(const IndexInfoPB& index, const QLTableRow& row1, const QLTableRow& row2) {
+  const int key_column_count = index.hash_column_count() + index.range_column_count();
+  for (int idx = 0; idx < key_column_count; idx++) {
+    const ColumnId column_id(index.columns(idx).indexed_column_id());
+    if (row1.at(column_id).value != row2.at(column_id).value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Does the write assign any column of the index?
+bool IndexColumnsWritten(const IndexInfoPB& index, const set<ColumnId>& written_column_ids) {
+  for (const auto& column : index.columns()) {
+    if (written_column_ids.count(ColumnId(column.indexed_column_id())) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+Status QLWriteOperation::UpdateIndexes(const QLTableRow& existing_row) {
+  // Static columns cannot be indexed. Nothing to do if the write does not touch the row.
+  if (pk_doc_key_ == nullptr) {
+    return Status::OK();
+  }
+
+  // The row was read with the primary key, so the existing row is empty iff the row does not
+  // exist. Take the primary key values from the request in case it does not.
+  const bool row_existed = !existing_row.empty();
+  QLTableRow old_row = existing_row;
+  for (size_t idx = 0; idx < schema_.num_hash_key_columns(); idx++) {
+    old_row[schema_.column_id(idx)].value = request_.hashed_column_values(idx).value();
+  }
+  for (size_t idx = 0; idx < schema_.num_range_key_columns(); idx++) {
+    old_row[schema_.column_id(schema_.num_hash_key_columns() + idx)].value =
+        request_.range_column_values(idx).value();
+  }
+
+  // Compute the new values of the indexed columns. Collection and counter columns cannot be
+  // indexed, so an indexed column is always assigned a whole value.
+  set<ColumnId> indexed_column_ids;
+  for (const IndexInfoPB& index : request_.update_indexes()) {
+    for (const auto& column : index.columns()) {
+      indexed_column_ids.insert(ColumnId(column.indexed_column_id()));
+    }
+  }
+  set<ColumnId> written_column_ids;
+  const bool row_deleted = request_.type() == QLWriteRequestPB::QL_STMT_DELETE &&
+                           request_.column_values().empty();
+  QLTableRow new_row = old_row;
+  QLExprExecutor executor;
+  for (const auto& column_value : request_.column_values()) {
+    const ColumnId column_id(column_value.column_id());
+    if (indexed_column_ids.count(column_id) == 0 || !column_value.subscript_args().empty()) {
+      continue;
+    }
+    written_column_ids.insert(column_id);
+    if (request_.type() == QLWriteRequestPB::QL_STMT_DELETE) {
+      new_row.erase(column_id);
+    } else {
+      QLValueWithPB value;
+      RETURN_NOT_OK(executor.EvalExpr(column_value.expr(), existing_row, &value));
+      new_row[column_id].value = value.value();
+    }
+  }
+
+  // Delete the old index entry if its key changes and write the new one unless it is unchanged.
+  // A row without values for all key columns of an index is not indexed.
+  for (const IndexInfoPB& index : request_.update_indexes()) {
+    const bool has_old_key = row_existed && HasIndexKey(index, old_row);
+    const bool has_new_key = !row_deleted && HasIndexKey(index, new_row);
+    const bool key_changed = !has_old_key || !has_new_key ||
+                             !IndexKeyEquals(index, old_row, new_row);
+    if (has_old_key && key_changed) {
+      AddIndexRequest(index, QLWriteRequestPB::QL_STMT_DELETE, old_row);
+    }
+    if (has_new_key && (key_changed || IndexColumnsWritten(index, written_column_ids))) {
+      AddIndexRequest(index, QLWriteRequestPB::QL_STMT_INSERT, new_row);
+    }
+  }
+  return Status::OK();
+}
+
+void QLWriteOperation::AddIndexRequest(const IndexInfoPB& index,
+                                       const QLWriteRequestPB::QLStmtType type,
+                                       const QLTableRow& row) {
+  QLWriteRequestPB* const index_request = response_->add_index_requests();
+  index_request->set_type(type);
+  index_request->set_table_id(index.table_id());
+  if (type != QLWriteRequestPB::QL_STMT_DELETE && request_.has_ttl()) {
+    index_request->set_ttl(request_.ttl());
+  }
+  const int hash_column_count = index.hash_column_count();
+  const int key_column_count = hash_column_count + index.range_column_count();
+  for (int idx = 0; idx < index.columns_size(); idx++) {
+    const auto& column = index.columns(idx);
+    const auto it = row.find(ColumnId(column.indexed_column_id()));
+    QLExpressionPB* expr;
+    if (idx < hash_column_count) {
+      expr = index_request->add_hashed_column_values();
+    } else if (idx < key_column_count) {
+      expr = index_request->add_range_column_values();
+    } else if (type == QLWriteRequestPB::QL_STMT_DELETE) {
+      break;
+    } else {
+      QLColumnValuePB* column_value = index_request->add_column_values();
+      column_value->set_column_id(column.column_id());
+      expr = column_value->mutable_expr();
+    }
+    if (it != row.end()) {
+      expr->mutable_value()->CopyFrom(it->second.value);
+    } else {
+      expr->mutable_value();
+    }
+  }
+}
+
+QLReadOperation::QLReadOperation(
+    const QLReadRequestPB& request,
+    const TransactionOperationContextOpt& txn_op_context)
+    : request_(request), txn_op_context_(txn_op_context) {
+}
+
+QLReadOperation::~QLReadOperation() {
+}
+
 Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
                                 const HybridTime& hybrid_time,
                                 const Schema& schema,
@@ -1418,17 +2962,44 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
   const bool read_static_columns = !static_projection.columns().empty();
   const bool read_distinct_columns = request_.distinct();
 
-  std::unique_ptr<common::QLRowwiseIteratorIf> iter;
   std::unique_ptr<common::QLScanSpec> spec, static_row_spec;
   HybridTime req_hybrid_time;
   RETURN_NOT_OK(ql_storage.BuildQLScanSpec(request_, hybrid_time, schema, read_static_columns,
                                              static_projection, &spec, &static_row_spec,
                                              &req_hybrid_time));
-  RETURN_NOT_OK(ql_storage.GetIterator(request_, query_schema, schema, txn_op_context_,
-                                       req_hybrid_time, &iter));
-  RETURN_NOT_OK(iter->Init(*spec));
-  if (FLAGS_trace_docdb_calls) {
-    TRACE("Initialized iterator");
+
+  // The iterator of a paged read is kept for the next page of the read, which continues it instead
+  // of seeking a new one. Reads of static columns fetch the static row of the next page separately,
+  // and transactional reads see their own intents, so their iterators are not kept.
+  const bool keep_cursor = request_.return_paging_state() &&
+                           row_count_limit != std::numeric_limits<std::size_t>::max() &&
+                           !read_static_columns && !txn_op_context_;
+  common::QLCursorPtr cursor;
+  std::unique_ptr<common::QLRowwiseIteratorIf> iter;
+  if (keep_cursor) {
+    cursor = ql_storage.TakeCursor(request_);
+  }
+  if (cursor != nullptr) {
+    iter = std::move(cursor->iter);
+    if (FLAGS_trace_docdb_calls) {
+      TRACE("Continued iterator");
+    }
+  } else {
+    const Schema* projection = &query_schema;
+    const Schema* iter_schema = &schema;
+    if (keep_cursor) {
+      cursor = std::make_unique<common::QLCursor>();
+      cursor->projection = query_schema;
+      cursor->schema = schema;
+      projection = &cursor->projection;
+      iter_schema = &cursor->schema;
+    }
+    RETURN_NOT_OK(ql_storage.GetIterator(request_, *projection, *iter_schema, txn_op_context_,
+                                         req_hybrid_time, &iter));
+    RETURN_NOT_OK(iter->Init(*spec));
+    if (FLAGS_trace_docdb_calls) {
+      TRACE("Initialized iterator");
+    }
   }
   QLTableRow static_row, non_static_row;
   QLTableRow& selected_row = read_distinct_columns ? static_row : non_static_row;
@@ -1446,8 +3017,26 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
     }
   }
 
+  // For aggregate functions, the partial values are accumulated over the matching rows and then
+  // returned in a single rsrow.
+  std::vector<QLValueWithPB> aggr_values;
+  if (request_.is_aggregate()) {
+    aggr_values.resize(request_.selected_exprs().size());
+    for (int i = 0; i < request_.selected_exprs().size(); i++) {
+      const QLExpressionPB& expr = request_.selected_exprs(i);
+      if (!expr.has_tscall()) {
+        return STATUS(InvalidArgument, "Aggregate select expects aggregate function calls only");
+      }
+      QLExprExecutor::InitAggregate(static_cast<bfql::TSOpcode>(expr.tscall().opcode()),
+                                    &aggr_values[i]);
+    }
+  }
+
   // Begin the normal fetch.
-  while (resultset->rsrow_count() < row_count_limit && iter->HasNext()) {
+  size_t match_count = 0;
+  uint64_t rows_scanned = 0;
+  while (match_count < row_count_limit && iter->HasNext()) {
+    ++rows_scanned;
 
     // Note that static columns are sorted before non-static columns in DocDB as follows. This is
     // because "<empty_range_components>" is empty and terminated by kGroupEnd which sorts before
@@ -1497,32 +3086,74 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
     bool match = false;
     RETURN_NOT_OK(spec->Match(selected_row, &match));
     if (match) {
-      RETURN_NOT_OK(PopulateResultSet(selected_row, resultset));
+      match_count++;
+      if (request_.is_aggregate()) {
+        RETURN_NOT_OK(EvalAggregates(selected_row, &aggr_values));
+      } else {
+        RETURN_NOT_OK(PopulateResultSet(selected_row, resultset));
+      }
     }
   }
   if (FLAGS_trace_docdb_calls) {
-    TRACE("Fetched $0 rows.", resultset->rsrow_count());
+    TRACE("Fetched $0 rows.", match_count);
   }
+  response_.set_rows_scanned(rows_scanned);
 
-  if (resultset->rsrow_count() >= row_count_limit) {
+  if (request_.is_aggregate()) {
+    QLRSRow *rsrow = resultset->AllocateRSRow(aggr_values.size());
+    for (size_t i = 0; i < aggr_values.size(); i++) {
+      rsrow->rscol(i)->Assign(aggr_values[i].value());
+    }
+  }
+
+  if (match_count >= row_count_limit) {
     RETURN_NOT_OK(iter->SetPagingStateIfNecessary(request_, &response_));
+    if (cursor != nullptr && response_.has_paging_state() &&
+        !response_.paging_state().next_row_key().empty()) {
+      cursor->iter = std::move(iter);
+      ql_storage.KeepCursor(request_, response_.paging_state().next_row_key(), std::move(cursor));
+    }
   }
 
   return Status::OK();
 }
 
+void QLReadOperation::CompileSelectedExprs() {
+  if (executor_) {
+    return;
+  }
+  executor_.reset(new DocExprExecutor());
+  selected_exprs_.reserve(request_.selected_exprs().size());
+  for (const QLExpressionPB& expr : request_.selected_exprs()) {
+    if (request_.is_aggregate()) {
+      DCHECK_EQ(expr.tscall().operands().size(), 1) << "Aggregate functions take only one argument";
+      selected_exprs_.emplace_back(new QLCompiledExpr(expr.tscall().operands(0)));
+    } else {
+      selected_exprs_.emplace_back(new QLCompiledExpr(expr));
+    }
+  }
+}
+
 CHECKED_STATUS QLReadOperation::PopulateResultSet(const QLTableRow& table_row,
                                                   QLResultSet *resultset) {
-  DocExprExecutor executor;
-  int column_count = request_.selected_exprs().size();
-  QLRSRow *rsrow = resultset->AllocateRSRow(column_count);
-
-  int rscol_index = 0;
-  for (const QLExpressionPB& expr : request_.selected_exprs()) {
-    RETURN_NOT_OK(executor.EvalExpr(expr, table_row, rsrow->rscol(rscol_index)));
-    rscol_index++;
+  CompileSelectedExprs();
+  QLRSRow *rsrow = resultset->AllocateRSRow(static_cast<int32_t>(selected_exprs_.size()));
+  for (size_t i = 0; i < selected_exprs_.size(); i++) {
+    RETURN_NOT_OK(selected_exprs_[i]->Eval(executor_.get(), table_row, rsrow->rscol(i)));
   }
+  return Status::OK();
+}
 
+CHECKED_STATUS QLReadOperation::EvalAggregates(const QLTableRow& table_row,
+                                               std::vector<QLValueWithPB> *aggr_values) {
+  CompileSelectedExprs();
+  QLValueWithPB value;
+  for (size_t i = 0; i < selected_exprs_.size(); i++) {
+    RETURN_NOT_OK(selected_exprs_[i]->Eval(executor_.get(), table_row, &value));
+    RETURN_NOT_OK(QLExprExecutor::AddToAggregate(
+        static_cast<bfql::TSOpcode>(request_.selected_exprs(i).tscall().opcode()), value,
+        &(*aggr_values)[i]));
+  }
   return Status::OK();
 }
 
@@ -29,9 +29,16 @@
 #include "yb/common/ql_resultset.h"
 
 namespace yb {
+
+class QLCompiledExpr;
+
 namespace docdb {
 
+class DocExprExecutor;
 class DocWriteBatch;
+class DocumentCache;
+class RedisValueCache;
+class SubDocument;
 
 class DocOperation {
  public:
@@ -67,8 +74,13 @@ class KuduWriteOperation: public DocOperation {
 class RedisWriteOperation: public DocOperation {
  public:
   // Construct a RedisWriteOperation. Content of request will be swapped out by the constructor.
-  RedisWriteOperation(RedisWriteRequestPB* request, HybridTime read_hybrid_time)
-      : response_(), read_hybrid_time_(read_hybrid_time) { request_.Swap(request); }
+  // value_cache, when specified, is used to look up the current value of a string key instead of
+  // reading it from RocksDB.
+  RedisWriteOperation(RedisWriteRequestPB* request, HybridTime read_hybrid_time,
+                      RedisValueCache* value_cache = nullptr)
+      : response_(), read_hybrid_time_(read_hybrid_time), value_cache_(value_cache) {
+    request_.Swap(request);
+  }
 
   bool RequireReadSnapshot() const override { return false; }
 
@@ -80,26 +92,39 @@ class RedisWriteOperation: public DocOperation {
   const RedisResponsePB &response();
 
  private:
+  // Reads the current value of the key of this operation.
+  CHECKED_STATUS GetValue(DocWriteBatch* doc_write_batch, RedisDataType* type, std::string* value);
+
   CHECKED_STATUS ApplySet(DocWriteBatch *doc_write_batch);
+  // Used to implement TSADD of time series stored in blocks of block_width.
+  CHECKED_STATUS ApplySetTSBlocks(DocWriteBatch *doc_write_batch, int64_t block_width, bool create);
   CHECKED_STATUS ApplyGetSet(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyAppend(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyDel(DocWriteBatch *doc_write_batch);
+  // Used to implement TSREM of time series stored in blocks.
+  CHECKED_STATUS ApplyDelTSBlocks(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplySetRange(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyIncr(DocWriteBatch *doc_write_batch, int64_t incr = 1);
   CHECKED_STATUS ApplyPush(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyInsert(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyPop(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyAdd(DocWriteBatch *doc_write_batch);
+  CHECKED_STATUS ApplyZAdd(DocWriteBatch *doc_write_batch);
   CHECKED_STATUS ApplyRemove(DocWriteBatch *doc_write_batch);
 
   RedisWriteRequestPB request_;
   RedisResponsePB response_;
   HybridTime read_hybrid_time_;
+  RedisValueCache* value_cache_;
 };
 
 class RedisReadOperation {
  public:
-  explicit RedisReadOperation(const yb::RedisReadRequestPB& request) : request_(request) {}
+  // document_cache, when specified, is used to look up whole small collections instead of reading
+  // them from RocksDB, and is filled by the commands that read whole collections.
+  explicit RedisReadOperation(const yb::RedisReadRequestPB& request,
+                              DocumentCache* document_cache = nullptr)
+      : request_(request), document_cache_(document_cache) {}
 
   CHECKED_STATUS Execute(rocksdb::DB *rocksdb, const HybridTime& hybrid_time);
 
@@ -108,19 +133,33 @@ class RedisReadOperation {
  private:
   int ApplyIndex(int32_t index, const int32_t len);
   CHECKED_STATUS ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_time);
-  // Used to implement HGETALL, HKEYS, HVALS, SMEMBERS, HLEN, SCARD
+  // Used to implement HGETALL, HKEYS, HVALS, SMEMBERS
   CHECKED_STATUS ExecuteHGetAllLikeCommands(rocksdb::DB *rocksdb,
                                     HybridTime hybrid_time,
                                     ValueType value_type,
                                     bool add_keys,
                                     bool add_values);
+  // Used to implement HLEN, SCARD
+  CHECKED_STATUS ExecuteCollectionSize(rocksdb::DB *rocksdb,
+                                       HybridTime hybrid_time,
+                                       RedisDataType data_type);
   CHECKED_STATUS ExecuteStrLen(rocksdb::DB *rocksdb, HybridTime hybrid_time);
   CHECKED_STATUS ExecuteExists(rocksdb::DB *rocksdb, HybridTime hybrid_time);
   CHECKED_STATUS ExecuteGetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
   CHECKED_STATUS ExecuteCollectionGetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+  CHECKED_STATUS ExecuteSortedSetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+  CHECKED_STATUS ExecuteListRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+  CHECKED_STATUS ExecuteTimeSeriesRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+  CHECKED_STATUS ExecuteTimeSeriesGet(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+  // Used to implement HSCAN, SSCAN
+  CHECKED_STATUS ExecuteScan(rocksdb::DB *rocksdb, HybridTime hybrid_time);
+
+  // Returns the cached document of the key of this operation visible at hybrid_time, or nullptr.
+  std::shared_ptr<const SubDocument> GetCachedDocument(HybridTime hybrid_time);
 
   const RedisReadRequestPB& request_;
   RedisResponsePB response_;
+  DocumentCache* document_cache_;
 };
 
 class QLWriteOperation : public DocOperation {
@@ -147,6 +186,10 @@ class QLWriteOperation : public DocOperation {
   // Initialize hashed_doc_key_ and/or pk_doc_key_.
   CHECKED_STATUS InitializeKeys(bool hashed_key, bool primary_key);
 
+  // Whether the request deletes a whole hash partition, i.e. gives no range columns for a table
+  // that has them.
+  bool IsPartitionDelete() const;
+
   CHECKED_STATUS ReadColumns(rocksdb::DB *rocksdb,
                              const HybridTime& hybrid_time,
                              Schema *static_projection,
@@ -162,6 +205,14 @@ class QLWriteOperation : public DocOperation {
                                       QLTableRow* table_row,
                                       const rocksdb::QueryId query_id);
 
+  // Add the writes that bring the secondary indexes in the request up to date with this write to
+  // the response. "existing_row" holds the column values read before the write.
+  CHECKED_STATUS UpdateIndexes(const QLTableRow& existing_row);
+
+  // Add a write of the index entry for "row" to the response.
+  void AddIndexRequest(const IndexInfoPB& index, QLWriteRequestPB::QLStmtType type,
+                       const QLTableRow& row);
+
   const Schema& schema_;
 
   // Doc key and doc path for hashed key (i.e. without range columns). Present when there is a
@@ -193,8 +244,8 @@ class QLReadOperation {
  public:
   QLReadOperation(
       const QLReadRequestPB& request,
-      const TransactionOperationContextOpt& txn_op_context)
-      : request_(request), txn_op_context_(txn_op_context) {}
+      const TransactionOperationContextOpt& txn_op_context);
+  ~QLReadOperation();
 
   CHECKED_STATUS Execute(const common::QLStorageIf& ql_storage,
                          const HybridTime& hybrid_time,
@@ -204,12 +255,22 @@ class QLReadOperation {
 
   CHECKED_STATUS PopulateResultSet(const QLTableRow& table_row, QLResultSet *result_set);
 
+  // Accumulate the given row into the partial values of the selected aggregate functions.
+  CHECKED_STATUS EvalAggregates(const QLTableRow& table_row,
+                                std::vector<QLValueWithPB> *aggr_values);
+
   const QLResponsePB& response() const;
 
  private:
+  // Compiles the selected expressions, or the arguments of the selected aggregate functions, once
+  // for all rows read by the request.
+  void CompileSelectedExprs();
+
   const QLReadRequestPB& request_;
   const TransactionOperationContextOpt txn_op_context_;
   QLResponsePB response_;
+  std::unique_ptr<DocExprExecutor> executor_;
+  std::vector<std::unique_ptr<QLCompiledExpr>> selected_exprs_;
 };
 
 }  // namespace docdb
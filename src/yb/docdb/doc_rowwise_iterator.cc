@@ -24,8 +24,11 @@
 #include "yb/docdb/subdocument.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rocksdb/db/compaction.h"
+#include "yb/rocksdb/util/statistics.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 
+DECLARE_int32(docdb_bloom_filter_range_components);
+
 using std::string;
 
 using yb::FormatRocksDBSliceAsStr;
@@ -50,6 +53,22 @@ CHECKED_STATUS ExpectValueType(ValueType expected_value_type,
   }
 }
 
+// When the bloom filter key includes range components, the scan may only use the bloom filter if
+// all rows in its bounds share those components, i.e. both bounds contain them and they are equal.
+bool RangeComponentsForBloomFilterEqual(const DocKey& lower, const DocKey& upper) {
+  if (FLAGS_docdb_bloom_filter_range_components <= 0) {
+    return true;
+  }
+  const size_t num_components = FLAGS_docdb_bloom_filter_range_components;
+  const auto& lower_range = lower.range_group();
+  const auto& upper_range = upper.range_group();
+  if (lower_range.size() < num_components || upper_range.size() < num_components) {
+    return false;
+  }
+  return std::equal(lower_range.begin(), lower_range.begin() + num_components,
+                    upper_range.begin());
+}
+
 }  // namespace
 
 DocRowwiseIterator::DocRowwiseIterator(
@@ -111,7 +130,8 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   RETURN_NOT_OK(doc_spec.lower_bound(&lower_doc_key));
   RETURN_NOT_OK(doc_spec.upper_bound(&upper_doc_key));
   const bool is_fixed_point_get = !lower_doc_key.empty() &&
-      upper_doc_key.HashedComponentsEqual(lower_doc_key);
+      upper_doc_key.HashedComponentsEqual(lower_doc_key) &&
+      RangeComponentsForBloomFilterEqual(lower_doc_key, upper_doc_key);
   const auto mode = is_fixed_point_get ? BloomFilterMode::USE_BLOOM_FILTER :
       BloomFilterMode::DONT_USE_BLOOM_FILTER;
 
@@ -121,11 +141,28 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   const KeyBytes row_key_encoded = row_key_.Encode();
   const Slice row_key_encoded_as_slice = row_key_encoded.AsSlice();
 
-  db_iter_ = CreateIntentAwareIterator(
-      db_, mode, row_key_encoded_as_slice, doc_spec.QueryId(), txn_op_context_, hybrid_time_,
-      doc_spec.CreateFileFilter());
+  auto file_filter = doc_spec.CreateFileFilter();
+  // Both the file filter and the bloom filter with range components could skip files that only
+  // have records of the hashed key of a partition.
+  filtered_iterator_ = file_filter != nullptr ||
+      (mode == BloomFilterMode::USE_BLOOM_FILTER && FLAGS_docdb_bloom_filter_range_components > 0);
+  query_id_ = doc_spec.QueryId();
 
-  RETURN_NOT_OK(db_iter_->SeekWithoutHt(row_key_encoded));
+  db_iter_ = CreateIntentAwareIterator(
+      db_, mode, row_key_encoded_as_slice, query_id_, txn_op_context_, hybrid_time_,
+      std::move(file_filter));
+
+  bool is_iter_valid = false;
+  if (IsRowOfPartition(row_key_) && !row_key_.range_group().empty()) {
+    // The scan starts in the middle of a partition, so it will not visit its hashed key.
+    RETURN_NOT_OK(FindPartitionDeletedTime(false /* is_iter_valid */));
+    is_iter_valid = !filtered_iterator_;
+  }
+  if (is_iter_valid) {
+    RETURN_NOT_OK(db_iter_->SeekForwardWithoutHt(row_key_encoded));
+  } else {
+    RETURN_NOT_OK(db_iter_->SeekWithoutHt(row_key_encoded));
+  }
   row_ready_ = false;
 
   // End scan with the upper bound key bytes.
@@ -164,11 +201,23 @@ bool DocRowwiseIterator::HasNext() const {
       done_ = true;
       return false;
     }
+    if (IsRowOfPartition(row_key_) && !row_key_.HashedComponentsEqual(partition_doc_key_)) {
+      // The scan moved to the next partition. Its hashed key, if any, sorts before its rows, so
+      // the iterator is positioned on or after it.
+      status_ = FindPartitionDeletedTime(true /* is_iter_valid */);
+      if (!status_.ok()) {
+        // Defer error reporting to NextBlock().
+        return true;
+      }
+    }
+    const DocHybridTime& partition_deleted_ts =
+        IsRowOfPartition(row_key_) ? partition_deleted_ts_ : DocHybridTime::kMin;
     KeyBytes old_key(db_iter_->key());
     // The iterator is positioned by the previous GetSubDocument call
     // (which places the iterator outside the previous doc_key).
     status_ = GetSubDocument(db_iter_.get(), SubDocKey(row_key_), &row_, &doc_found, hybrid_time_,
-        TableTTL(schema_), &projection_subkeys_);
+        TableTTL(schema_), &projection_subkeys_, false /* return_type_only */,
+        true /* is_iter_valid */, SubDocKeyBound(), SubDocKeyBound(), partition_deleted_ts);
     // After this, the iter should be positioned right after the subdocument.
     if (!status_.ok()) {
       // Defer error reporting to NextBlock().
@@ -176,20 +225,16 @@ bool DocRowwiseIterator::HasNext() const {
     }
 
     if (!doc_found) {
-      SubDocument full_row;
-      // If doc is not found, decide if some non-projection column exists.
-      // Currently we read the whole doc here,
-      // may be optimized by exiting on the first column in future.
-      status_ = db_iter_->Seek(row_key_);  // Position it for GetSubDocument.
+      // If no projected column is found, decide if some non-projection column exists. This stops
+      // at the first such column and doesn't materialize the rest of the row.
+      status_ = HasSubDocument(db_iter_.get(), SubDocKey(row_key_), &doc_found, hybrid_time_,
+          TableTTL(schema_), false /* is_iter_valid */, partition_deleted_ts);
       if (!status_.ok()) {
         // Defer error reporting to NextBlock().
         return true;
       }
-      status_ = GetSubDocument(db_iter_.get(), SubDocKey(row_key_), &full_row, &doc_found,
-          hybrid_time_, TableTTL(schema_));
-      if (!status_.ok()) {
-        // Defer error reporting to NextBlock().
-        return true;
+      if (!doc_found) {
+        rocksdb::RecordTick(db_iter_->statistics(), rocksdb::NUMBER_DOCDB_DELETED_ROWS_SKIPPED);
       }
     }
     // GetSubDocument must ensure that iterator is pushed forward, to avoid loops.
@@ -203,6 +248,30 @@ bool DocRowwiseIterator::HasNext() const {
   return true;
 }
 
+bool DocRowwiseIterator::IsRowOfPartition(const DocKey& doc_key) const {
+  return schema_.num_range_key_columns() > 0 && !doc_key.hashed_group().empty();
+}
+
+Status DocRowwiseIterator::FindPartitionDeletedTime(bool is_iter_valid) const {
+  partition_doc_key_ = DocKey(row_key_.hash(), row_key_.hashed_group());
+  partition_deleted_ts_ = DocHybridTime::kMin;
+  const KeyBytes encoded_partition_key = partition_doc_key_.Encode();
+  IntentAwareIterator* iter = db_iter_.get();
+  std::unique_ptr<IntentAwareIterator> partition_iter;
+  if (filtered_iterator_) {
+    partition_iter = CreateIntentAwareIterator(
+        db_, BloomFilterMode::USE_BLOOM_FILTER, encoded_partition_key.AsSlice(), query_id_,
+        txn_op_context_, hybrid_time_);
+    iter = partition_iter.get();
+    is_iter_valid = false;
+  }
+  if (!is_iter_valid) {
+    RETURN_NOT_OK(iter->SeekWithoutHt(encoded_partition_key));
+  }
+  return iter->FindLastWriteTime(
+      encoded_partition_key, hybrid_time_, &partition_deleted_ts_, nullptr /* result_value */);
+}
+
 string DocRowwiseIterator::ToString() const {
   return "DocRowwiseIterator";
 }
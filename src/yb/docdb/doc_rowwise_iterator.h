@@ -83,6 +83,11 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
   // Skip the current row.
   void SkipRow() override;
 
+  // The primary key of the row read last.
+  const DocKey& row_key() const {
+    return row_key_;
+  }
+
  private:
 
   // Retrieves the next key to read after the iterator finishes for the given page.
@@ -92,6 +97,14 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
     return DocKey::FromKuduEncodedKey(encoded_key, schema_);
   }
 
+  // Whether the document key is of a row in a hash partition, that could be deleted as a whole by
+  // a write to the hashed key of the partition.
+  bool IsRowOfPartition(const DocKey& doc_key) const;
+
+  // Finds the latest time the partition of row_key_ was deleted at. Unless is_iter_valid, db_iter_
+  // is positioned to the hashed key of the partition first.
+  CHECKED_STATUS FindPartitionDeletedTime(bool is_iter_valid) const;
+
   // Get the non-key column values of a QL row.
   CHECKED_STATUS GetValues(const Schema& projection, vector<SubDocument>* values);
 
@@ -136,6 +149,11 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
 
   std::unique_ptr<IntentAwareIterator> db_iter_;
 
+  // Whether db_iter_ could skip SST files with records of the hashed keys of partitions, so they
+  // should be looked up with a separate iterator.
+  bool filtered_iterator_ = false;
+  rocksdb::QueryId query_id_ = rocksdb::kDefaultQueryId;
+
   // We keep the "pending operation" counter incremented for the lifetime of this iterator so that
   // RocksDB does not get destroyed while the iterator is still in use.
   yb::util::ScopedPendingOperation pending_op_;
@@ -158,6 +176,11 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
 
   mutable std::vector<PrimitiveValue> projection_subkeys_;
 
+  // The hashed key of the partition of the current row, and the latest time the partition was
+  // deleted at.
+  mutable DocKey partition_doc_key_;
+  mutable DocHybridTime partition_deleted_ts_ = DocHybridTime::kMin;
+
   // Used for keeping track of errors that happen in HasNext. Returned
   mutable Status status_;
 };
@@ -0,0 +1,402 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+// Microbenchmarks of DocDB key encoding, reads and write preparation. Each benchmark builds its
+// dataset from --docdb_bench_seed, so runs are reproducible, and logs the time and the number of
+// heap allocations per operation. Allocations are only counted when tcmalloc is used.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <gperftools/malloc_hook.h>
+
+#include "yb/common/schema.h"
+#include "yb/common/transaction.h"
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/doc_operation.h"
+#include "yb/docdb/docdb.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/docdb_test_base.h"
+#include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/value.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/rocksdb/write_batch.h"
+
+DEFINE_int32(docdb_bench_iterations, 100000,
+             "Number of operations measured by each benchmark. Benchmarks of expensive operations "
+             "run a fraction of them.");
+DEFINE_int32(docdb_bench_num_docs, 10000, "Number of documents in the point read datasets.");
+DEFINE_int32(docdb_bench_num_columns, 4, "Number of columns of each document in the datasets.");
+DEFINE_int32(docdb_bench_wide_row_columns, 1000,
+             "Number of columns of the document read by BenchmarkWideRowScan.");
+DEFINE_int32(docdb_bench_seed, 42, "Seed of the datasets and of the order of the reads.");
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+#if defined(TCMALLOC_ENABLED)
+// Allocations made by the current thread, so background RocksDB threads do not affect results.
+thread_local int64_t thread_allocations = 0;
+
+void CountAllocation(const void* ptr, size_t size) {
+  ++thread_allocations;
+}
+#endif
+
+int64_t ThreadAllocations() {
+#if defined(TCMALLOC_ENABLED)
+  return thread_allocations;
+#else
+  return 0;
+#endif
+}
+
+// Transactions are committed at the specified times, but their intents are not applied yet.
+class CommittedTransactionsProvider : public TransactionStatusProvider {
+ public:
+  HybridTime LocalCommitTime(const TransactionId& id) override {
+    auto it = commit_times_.find(id);
+    return it == commit_times_.end() ? HybridTime::kInvalidHybridTime : it->second;
+  }
+
+  void RequestStatusAt(const TransactionId& id,
+                       HybridTime time,
+                       TransactionStatusCallback callback) override {
+    auto commit_time = LocalCommitTime(id);
+    if (commit_time.is_valid() && commit_time <= time) {
+      callback(TransactionStatusResult{TransactionStatus::COMMITTED, commit_time});
+    } else {
+      callback(TransactionStatusResult{TransactionStatus::PENDING, HybridTime::kMin});
+    }
+  }
+
+  void Commit(const TransactionId& id, HybridTime commit_time) {
+    commit_times_.emplace(id, commit_time);
+  }
+
+ private:
+  std::unordered_map<TransactionId, HybridTime, TransactionIdHash> commit_times_;
+};
+
+const HybridTime kWriteTime = HybridTime::FromMicros(1000000);
+const HybridTime kIntentWriteTime = HybridTime::FromMicros(2000000);
+const HybridTime kCommitTime = HybridTime::FromMicros(3000000);
+const HybridTime kReadTime = HybridTime::FromMicros(10000000);
+
+} // namespace
+
+class DocDBBench : public DocDBTestBase {
+ public:
+  DocDBBench() : rng_(FLAGS_docdb_bench_seed) {}
+
+  void SetUp() override {
+    DocDBTestBase::SetUp();
+#if defined(TCMALLOC_ENABLED)
+    ASSERT_TRUE(MallocHook::AddNewHook(&CountAllocation));
+#endif
+  }
+
+  void TearDown() override {
+#if defined(TCMALLOC_ENABLED)
+    ASSERT_TRUE(MallocHook::RemoveNewHook(&CountAllocation));
+#endif
+    DocDBTestBase::TearDown();
+  }
+
+ protected:
+  // Runs op for iterations operations after a short warm up, and logs the time and the number of
+  // allocations per operation.
+  template <class Op>
+  void RunBenchmark(const std::string& name, int iterations, const Op& op) {
+    iterations = std::max(iterations, 1);
+    for (int i = 0; i != std::min(iterations / 10 + 1, 1000); ++i) {
+      ASSERT_OK(op(i));
+    }
+
+    const int64_t allocations_before = ThreadAllocations();
+    const auto start = MonoTime::FineNow();
+    for (int i = 0; i != iterations; ++i) {
+      ASSERT_OK(op(i));
+    }
+    const auto elapsed = MonoTime::FineNow().GetDeltaSince(start);
+    const int64_t allocations = ThreadAllocations() - allocations_before;
+
+#if defined(TCMALLOC_ENABLED)
+    const std::string allocations_str = strings::Substitute(
+        "$0 allocations/op", static_cast<double>(allocations) / iterations);
+#else
+    const std::string allocations_str = "allocations not counted without tcmalloc";
+#endif
+    LOG(INFO) << name << ": " << iterations << " ops, "
+              << elapsed.ToNanoseconds() / iterations << " ns/op, " << allocations_str;
+  }
+
+  static DocKey MakeDocKey(int index) {
+    return DocKey(index & 0xffff,
+                  { PrimitiveValue(strings::Substitute("key_$0", index)) },
+                  { PrimitiveValue(static_cast<int64_t>(index)) });
+  }
+
+  static PrimitiveValue MakeColumnValue(int index, int column) {
+    return PrimitiveValue(strings::Substitute("value_$0_$1_$2", index, column,
+                                              std::string(16, 'x')));
+  }
+
+  // Writes num_docs documents with --docdb_bench_num_columns columns each. ttl_for_doc returns
+  // the TTL of the values of the document.
+  template <class TtlForDoc>
+  void LoadDocs(int num_docs, const TtlForDoc& ttl_for_doc) {
+    doc_keys_.clear();
+    DocWriteBatch dwb(rocksdb());
+    for (int i = 0; i != num_docs; ++i) {
+      doc_keys_.push_back(MakeDocKey(i));
+      const KeyBytes encoded_doc_key = doc_keys_.back().Encode();
+      const MonoDelta ttl = ttl_for_doc(i);
+      for (int column = 0; column != FLAGS_docdb_bench_num_columns; ++column) {
+        ASSERT_OK(dwb.SetPrimitive(DocPath(encoded_doc_key, PrimitiveValue(ColumnId(column))),
+                                   Value(MakeColumnValue(i, column), ttl),
+                                   InitMarkerBehavior::OPTIONAL));
+      }
+      ASSERT_OK(WriteToRocksDBAndClear(&dwb, kWriteTime));
+    }
+    ASSERT_OK(FlushRocksDB());
+    ShuffleReadOrder();
+  }
+
+  void LoadDocs(int num_docs) {
+    LoadDocs(num_docs, [](int index) { return Value::kMaxTtl; });
+  }
+
+  // Reads are done in a random, but reproducible, order of the documents.
+  void ShuffleReadOrder() {
+    read_order_.resize(doc_keys_.size());
+    for (size_t i = 0; i != read_order_.size(); ++i) {
+      read_order_[i] = i;
+    }
+    std::shuffle(read_order_.begin(), read_order_.end(), rng_);
+  }
+
+  const DocKey& DocKeyToRead(int op_index) const {
+    return doc_keys_[read_order_[op_index % read_order_.size()]];
+  }
+
+  // Point reads of whole documents, as done by Redis and QL reads of a single row.
+  void BenchmarkPointGet(const std::string& name,
+                         const TransactionOperationContextOpt& txn_op_context,
+                         MonoDelta table_ttl = Value::kMaxTtl) {
+    SubDocument doc;
+    RunBenchmark(name, FLAGS_docdb_bench_iterations, [&](int i) -> Status {
+      bool doc_found = false;
+      doc = SubDocument();
+      return GetSubDocument(
+          rocksdb(), SubDocKey(DocKeyToRead(i)), rocksdb::kDefaultQueryId, txn_op_context, &doc,
+          &doc_found, kReadTime, table_ttl);
+    });
+  }
+
+  std::mt19937_64 rng_;
+  std::vector<DocKey> doc_keys_;
+  std::vector<size_t> read_order_;
+};
+
+TEST_F(DocDBBench, BenchmarkDocKeyEncode) {
+  std::vector<DocKey> keys;
+  std::vector<KeyBytes> encoded_keys;
+  for (int i = 0; i != FLAGS_docdb_bench_num_docs; ++i) {
+    keys.push_back(MakeDocKey(i));
+    encoded_keys.push_back(keys.back().Encode());
+  }
+
+  RunBenchmark("DocKey::Encode", FLAGS_docdb_bench_iterations, [&keys](int i) -> Status {
+    KeyBytes encoded = keys[i % keys.size()].Encode();
+    return encoded.size() == 0 ? STATUS(IllegalState, "Empty encoded key") : Status::OK();
+  });
+
+  DocKey decoded;
+  RunBenchmark("DocKey::FullyDecodeFrom", FLAGS_docdb_bench_iterations,
+               [&encoded_keys, &decoded](int i) {
+    return decoded.FullyDecodeFrom(encoded_keys[i % encoded_keys.size()].AsSlice());
+  });
+}
+
+TEST_F(DocDBBench, BenchmarkPrimitiveValueDecode) {
+  std::vector<KeyBytes> encoded_keys;
+  std::vector<std::string> encoded_values;
+  for (int i = 0; i != FLAGS_docdb_bench_num_docs; ++i) {
+    encoded_keys.push_back(PrimitiveValue(strings::Substitute("key_$0", i)).ToKeyBytes());
+    encoded_keys.push_back(PrimitiveValue(static_cast<int64_t>(rng_())).ToKeyBytes());
+    encoded_keys.push_back(PrimitiveValue(ColumnId(i % 100)).ToKeyBytes());
+    encoded_values.push_back(Value(MakeColumnValue(i, 0)).Encode());
+    encoded_values.push_back(
+        Value(PrimitiveValue(static_cast<int64_t>(i)), MonoDelta::FromSeconds(60)).Encode());
+  }
+
+  PrimitiveValue primitive_value;
+  RunBenchmark("PrimitiveValue::DecodeFromKey", FLAGS_docdb_bench_iterations,
+               [&encoded_keys, &primitive_value](int i) {
+    Slice slice = encoded_keys[i % encoded_keys.size()].AsSlice();
+    return primitive_value.DecodeFromKey(&slice);
+  });
+
+  Value value;
+  RunBenchmark("Value::Decode", FLAGS_docdb_bench_iterations, [&encoded_values, &value](int i) {
+    return value.Decode(encoded_values[i % encoded_values.size()]);
+  });
+}
+
+TEST_F(DocDBBench, BenchmarkPointGet) {
+  LoadDocs(FLAGS_docdb_bench_num_docs);
+  BenchmarkPointGet("Point get", kNonTransactionalOperationContext);
+
+  auto iter = CreateIntentAwareIterator(
+      rocksdb(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+      kNonTransactionalOperationContext, kReadTime);
+  RunBenchmark("IntentAwareIterator::Seek", FLAGS_docdb_bench_iterations, [&](int i) -> Status {
+    RETURN_NOT_OK(iter->Seek(DocKeyToRead(i)));
+    return iter->valid() ? Status::OK() : STATUS(NotFound, "Document not found");
+  });
+}
+
+TEST_F(DocDBBench, BenchmarkWideRowScan) {
+  const int num_columns = FLAGS_docdb_bench_wide_row_columns;
+  const DocKey doc_key = MakeDocKey(0);
+  const KeyBytes encoded_doc_key = doc_key.Encode();
+  DocWriteBatch dwb(rocksdb());
+  for (int column = 0; column != num_columns; ++column) {
+    ASSERT_OK(dwb.SetPrimitive(DocPath(encoded_doc_key, PrimitiveValue(ColumnId(column))),
+                               MakeColumnValue(0, column), InitMarkerBehavior::OPTIONAL));
+  }
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, kWriteTime));
+  ASSERT_OK(FlushRocksDB());
+
+  SubDocument doc;
+  RunBenchmark(
+      strings::Substitute("Wide row scan of $0 columns", num_columns),
+      FLAGS_docdb_bench_iterations / std::max(num_columns, 1),
+      [&](int i) -> Status {
+    bool doc_found = false;
+    doc = SubDocument();
+    RETURN_NOT_OK(GetSubDocument(
+        rocksdb(), SubDocKey(doc_key), rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, &doc, &doc_found, kReadTime));
+    return doc.object_num_keys() == num_columns
+        ? Status::OK() : STATUS(Corruption, "Wrong number of columns");
+  });
+}
+
+TEST_F(DocDBBench, BenchmarkTtlHeavyPointGet) {
+  // Values of every other document are already expired at kReadTime.
+  LoadDocs(FLAGS_docdb_bench_num_docs, [](int index) {
+    return index % 2 == 0 ? MonoDelta::FromMilliseconds(1) : MonoDelta::FromSeconds(3600);
+  });
+  BenchmarkPointGet("TTL heavy point get", kNonTransactionalOperationContext,
+                    MonoDelta::FromSeconds(7200));
+}
+
+TEST_F(DocDBBench, BenchmarkTransactionalPointGet) {
+  constexpr int kNumTransactions = 16;
+
+  LoadDocs(FLAGS_docdb_bench_num_docs);
+
+  // Every document has a column overwritten by a committed transaction, whose intents were not
+  // applied yet, so reads resolve them.
+  SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+  CommittedTransactionsProvider txn_status_provider;
+  std::vector<TransactionId> transactions;
+  for (int i = 0; i != kNumTransactions; ++i) {
+    transactions.push_back(GenerateTransactionId());
+  }
+  DocWriteBatch dwb(rocksdb());
+  for (size_t i = 0; i != doc_keys_.size(); ++i) {
+    SetCurrentTransactionId(transactions[i % transactions.size()]);
+    ASSERT_OK(dwb.SetPrimitive(DocPath(doc_keys_[i].Encode(), PrimitiveValue(ColumnId(0))),
+                               MakeColumnValue(i, kNumTransactions),
+                               InitMarkerBehavior::OPTIONAL));
+    ASSERT_OK(WriteToRocksDBAndClear(&dwb, kIntentWriteTime));
+  }
+  ResetCurrentTransactionId();
+  for (const auto& transaction : transactions) {
+    txn_status_provider.Commit(transaction, kCommitTime);
+  }
+  ASSERT_OK(FlushRocksDB());
+
+  BenchmarkPointGet(
+      "Transactional point get",
+      TransactionOperationContext(GenerateTransactionId(), &txn_status_provider));
+}
+
+TEST_F(DocDBBench, BenchmarkWriteBatchPreparation) {
+  // QL insert of a row, applied and converted to a RocksDB write batch like on the tablet.
+  ColumnSchema hash_column_schema("k", INT32, false, true);
+  std::vector<ColumnSchema> columns = { hash_column_schema };
+  for (int column = 1; column <= FLAGS_docdb_bench_num_columns; ++column) {
+    columns.emplace_back(strings::Substitute("c$0", column), INT32, false, false);
+  }
+  std::vector<ColumnId> column_ids;
+  for (size_t column = 0; column != columns.size(); ++column) {
+    column_ids.emplace_back(column);
+  }
+  const Schema schema(columns, column_ids, 1);
+
+  QLWriteRequestPB ql_request_template;
+  ql_request_template.set_type(QLWriteRequestPB::QL_STMT_INSERT);
+  ql_request_template.add_hashed_column_values()->mutable_value()->set_int32_value(0);
+  for (int column = 1; column <= FLAGS_docdb_bench_num_columns; ++column) {
+    auto* column_value = ql_request_template.add_column_values();
+    column_value->set_column_id(column);
+    column_value->mutable_expr()->mutable_value()->set_int32_value(column);
+  }
+
+  RunBenchmark("QL insert write batch", FLAGS_docdb_bench_iterations, [&](int i) -> Status {
+    QLWriteRequestPB request(ql_request_template);
+    request.set_hash_code(i & 0xffff);
+    request.mutable_hashed_column_values(0)->mutable_value()->set_int32_value(i);
+    QLResponsePB response;
+    QLWriteOperation op(&request, schema, &response, kNonTransactionalOperationContext);
+    DocWriteBatch doc_write_batch(rocksdb());
+    RETURN_NOT_OK(op.Apply(&doc_write_batch, rocksdb(), HybridTime()));
+    KeyValueWriteBatchPB kv_write_batch;
+    doc_write_batch.MoveToWriteBatchPB(&kv_write_batch);
+    rocksdb::WriteBatch rocksdb_write_batch;
+    PrepareNonTransactionWriteBatch(kv_write_batch, kWriteTime, &rocksdb_write_batch);
+    return Status::OK();
+  });
+
+  // Redis SET of a string value.
+  RedisWriteRequestPB redis_request_template;
+  redis_request_template.mutable_set_request();
+  redis_request_template.mutable_key_value()->add_value(MakeColumnValue(0, 0).GetString());
+
+  RunBenchmark("Redis SET write batch", FLAGS_docdb_bench_iterations, [&](int i) -> Status {
+    RedisWriteRequestPB request(redis_request_template);
+    request.mutable_key_value()->set_key(strings::Substitute("key_$0", i));
+    request.mutable_key_value()->set_hash_code(i & 0xffff);
+    RedisWriteOperation op(&request, kReadTime);
+    DocWriteBatch doc_write_batch(rocksdb());
+    RETURN_NOT_OK(op.Apply(&doc_write_batch, rocksdb(), HybridTime()));
+    KeyValueWriteBatchPB kv_write_batch;
+    doc_write_batch.MoveToWriteBatchPB(&kv_write_batch);
+    rocksdb::WriteBatch rocksdb_write_batch;
+    PrepareNonTransactionWriteBatch(kv_write_batch, kWriteTime, &rocksdb_write_batch);
+    return Status::OK();
+  });
+}
+
+} // namespace docdb
+} // namespace yb
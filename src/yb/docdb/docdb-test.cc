@@ -17,15 +17,18 @@
 #include <string>
 
 #include "yb/rocksdb/db.h"
+#include "yb/rocksdb/db/version_edit.h"
 #include "yb/rocksdb/status.h"
 #include "yb/rocksdb/util/statistics.h"
 
 #include "yb/common/hybrid_time.h"
 #include "yb/docdb/docdb-internal.h"
 #include "yb/docdb/docdb_compaction_filter.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/docdb_test_base.h"
 #include "yb/docdb/docdb_test_util.h"
 #include "yb/docdb/in_mem_docdb.h"
+#include "yb/docdb/intent_aware_iterator.h"
 #include "yb/docdb/intent.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/rocksutil/yb_rocksdb.h"
@@ -1669,5 +1672,288 @@ SubDocKey(DocKey(0x0000, ["h1"], ["r2"]), ["c8"; HT(p=1000)]) -> "v82"
       )#");
 }
 
+TEST_F(DocDBTest, GetSubDocumentsTest) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), PrimitiveValue("value_1a")));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("b")), PrimitiveValue("value_1b")));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue("a")), PrimitiveValue("value_2a")));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(1000)));
+  ASSERT_OK(dwb.DeleteSubDoc(DocPath(kEncodedDocKey1)));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("b")), PrimitiveValue("value_1b_prime")));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(2000)));
+
+  // Keys are intentionally not sorted, and include several keys of the same document.
+  const std::vector<SubDocKey> keys = {
+      SubDocKey(kDocKey2, PrimitiveValue("a")),
+      SubDocKey(kDocKey1, PrimitiveValue("b")),
+      SubDocKey(kDocKey2, PrimitiveValue("missing")),
+      SubDocKey(kDocKey1, PrimitiveValue("a")),
+  };
+
+  std::vector<SubDocument> docs;
+  std::vector<bool> docs_found;
+  ASSERT_OK(GetSubDocuments(
+      rocksdb(), keys, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext, &docs,
+      &docs_found, HybridTime::FromMicros(1500)));
+  ASSERT_EQ(keys.size(), docs.size());
+  ASSERT_EQ((std::vector<bool>{true, true, false, true}), docs_found);
+  ASSERT_EQ("value_2a", docs[0].GetString());
+  ASSERT_EQ("value_1b", docs[1].GetString());
+  ASSERT_EQ("value_1a", docs[3].GetString());
+
+  // The document deletion at 2000 hides the first subkey of kDocKey1.
+  ASSERT_OK(GetSubDocuments(
+      rocksdb(), keys, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext, &docs,
+      &docs_found, HybridTime::FromMicros(2500)));
+  ASSERT_EQ((std::vector<bool>{true, true, false, false}), docs_found);
+  ASSERT_EQ("value_2a", docs[0].GetString());
+  ASSERT_EQ("value_1b_prime", docs[1].GetString());
+}
+
+TEST_F(DocDBTest, CompactionKeepsIntents) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), PrimitiveValue("value_1a")));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(1000)));
+
+  // Provisional records are not valid SubDocKeys, so compaction filter should leave them alone.
+  std::string intent_key(1, static_cast<char>(ValueType::kIntentPrefix));
+  intent_key += "provisional";
+  ASSERT_OK(rocksdb()->Put(WriteOptions(), intent_key, "intent_value"));
+
+  CompactHistoryBefore(HybridTime::FromMicros(2000));
+
+  std::string value;
+  ASSERT_OK(rocksdb()->Get(rocksdb::ReadOptions(), intent_key, &value));
+  ASSERT_EQ("intent_value", value);
+}
+
+TEST_F(DocDBTest, CompactionFileFilterDiscardsExpiredFiles) {
+  const MonoDelta one_ms = MonoDelta::FromMilliseconds(1);
+  const MonoDelta ten_ms = MonoDelta::FromMilliseconds(10);
+  const HybridTime t0 = HybridTime::FromMicros(1000);
+  const HybridTime t1 = server::HybridClock::AddPhysicalTimeToHybridTime(t0, ten_ms);
+  const HybridTime t2 = server::HybridClock::AddPhysicalTimeToHybridTime(t1, ten_ms);
+  const HybridTime t3 = server::HybridClock::AddPhysicalTimeToHybridTime(t2, ten_ms);
+
+  // File with values having their own TTL, and a delete.
+  ASSERT_OK(SetPrimitive(DocPath(kEncodedDocKey1, PrimitiveValue("a")),
+      Value(PrimitiveValue("value_a"), one_ms), t0, InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(DocPath(kEncodedDocKey1, PrimitiveValue("b")),
+      Value(PrimitiveValue("value_b"), MonoDelta::FromMilliseconds(2)), t0,
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(DeleteSubDoc(DocPath(kEncodedDocKey1, PrimitiveValue("c")), t0,
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(FlushRocksDB());
+  // File with a value without TTL.
+  ASSERT_OK(SetPrimitive(DocPath(kEncodedDocKey2, PrimitiveValue("a")),
+      Value(PrimitiveValue("value_a")), t1, InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(FlushRocksDB());
+
+  std::vector<rocksdb::LiveFileMetaData> live_files;
+  rocksdb()->GetLiveFilesMetaData(&live_files);
+  ASSERT_EQ(2, live_files.size());
+  sort(live_files.begin(), live_files.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.name < rhs.name;
+  });
+  std::vector<rocksdb::FileMetaData> files(live_files.size());
+  for (size_t i = 0; i != live_files.size(); ++i) {
+    files[i].largest.user_values = live_files[i].largest.user_values;
+  }
+
+  auto filter = [&files](HybridTime history_cutoff, MonoDelta table_ttl, size_t index) {
+    return DocDBCompactionFileFilter(history_cutoff, table_ttl).Filter(&files[index]);
+  };
+
+  // Values with their own TTL have not expired yet.
+  ASSERT_EQ(rocksdb::FilterDecision::kKeep, filter(t0, Value::kMaxTtl, 0));
+  ASSERT_EQ(rocksdb::FilterDecision::kDiscard, filter(t1, Value::kMaxTtl, 0));
+  // Value without TTL never expires without table TTL.
+  ASSERT_EQ(rocksdb::FilterDecision::kKeep, filter(t3, Value::kMaxTtl, 1));
+  ASSERT_EQ(rocksdb::FilterDecision::kKeep, filter(t2, MonoDelta::FromMilliseconds(20), 1));
+  ASSERT_EQ(rocksdb::FilterDecision::kDiscard, filter(t3, one_ms, 1));
+}
+
+TEST_F(DocDBTest, DocWriteBatchToWriteBatchPB) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), PrimitiveValue("value_1a"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue("b")), PrimitiveValue("value_2b"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_EQ(2, dwb.size());
+
+  KeyValueWriteBatchPB kv_pb;
+  dwb.TEST_CopyToWriteBatchPB(&kv_pb);
+  ASSERT_EQ(2, kv_pb.kv_pairs_size());
+  for (int i = 0; i != kv_pb.kv_pairs_size(); ++i) {
+    ASSERT_EQ(dwb.key(i).ToBuffer(), kv_pb.kv_pairs(i).key());
+    ASSERT_EQ(dwb.value(i).ToBuffer(), kv_pb.kv_pairs(i).value());
+  }
+  SubDocKey subdoc_key;
+  ASSERT_OK(subdoc_key.FullyDecodeFromKeyWithoutHybridTime(kv_pb.kv_pairs(1).key()));
+  ASSERT_EQ(SubDocKey(kDocKey2, PrimitiveValue("b")).ToString(), subdoc_key.ToString());
+  ASSERT_EQ(Value(PrimitiveValue("value_2b")).Encode(), kv_pb.kv_pairs(1).value());
+
+  KeyValueWriteBatchPB moved_pb;
+  dwb.MoveToWriteBatchPB(&moved_pb);
+  ASSERT_TRUE(dwb.IsEmpty());
+  ASSERT_EQ(kv_pb.DebugString(), moved_pb.DebugString());
+}
+
+TEST_F(DocDBTest, HasSubDocumentTest) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), PrimitiveValue("value_1a"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue("a")), PrimitiveValue("value_2a"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(1000)));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue("a")), Value(PrimitiveValue(ValueType::kTombstone)),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(2000)));
+
+  auto check = [this](const DocKey& doc_key, HybridTime scan_ht) {
+    auto iter = CreateIntentAwareIterator(
+        rocksdb(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, scan_ht);
+    bool doc_found = false;
+    EXPECT_OK(HasSubDocument(iter.get(), SubDocKey(doc_key), &doc_found, scan_ht,
+        Value::kMaxTtl, false /* is_iter_valid */));
+    // The iterator should be placed outside of the document.
+    if (iter->valid()) {
+      EXPECT_FALSE(iter->key().starts_with(doc_key.Encode().AsSlice()));
+    }
+    return doc_found;
+  };
+
+  ASSERT_TRUE(check(kDocKey1, HybridTime::FromMicros(1500)));
+  ASSERT_TRUE(check(kDocKey2, HybridTime::FromMicros(1500)));
+  ASSERT_TRUE(check(kDocKey1, HybridTime::FromMicros(2500)));
+  ASSERT_FALSE(check(kDocKey2, HybridTime::FromMicros(2500)));
+  ASSERT_FALSE(check(kDocKey1, HybridTime::FromMicros(500)));
+}
+
+TEST_F(DocDBTest, ReadSkipsFilesNewerThanReadTime) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), PrimitiveValue("value_1a"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(1000)));
+  ASSERT_OK(FlushRocksDB());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue("a")), Value(PrimitiveValue(ValueType::kTombstone)),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue("a")), PrimitiveValue("value_2a"),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(2000)));
+  ASSERT_OK(FlushRocksDB());
+
+  // The file written at 2000 is skipped by reads at earlier times, which should not change what
+  // they see.
+  auto check = [this](const DocKey& doc_key, HybridTime scan_ht) {
+    auto iter = CreateIntentAwareIterator(
+        rocksdb(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, scan_ht);
+    bool doc_found = false;
+    EXPECT_OK(HasSubDocument(iter.get(), SubDocKey(doc_key), &doc_found, scan_ht,
+        Value::kMaxTtl, false /* is_iter_valid */));
+    return doc_found;
+  };
+
+  ASSERT_FALSE(check(kDocKey1, HybridTime::FromMicros(500)));
+  ASSERT_TRUE(check(kDocKey1, HybridTime::FromMicros(1500)));
+  ASSERT_FALSE(check(kDocKey2, HybridTime::FromMicros(1500)));
+  ASSERT_FALSE(check(kDocKey1, HybridTime::FromMicros(2500)));
+  ASSERT_TRUE(check(kDocKey2, HybridTime::FromMicros(2500)));
+}
+
+TEST_F(DocDBTest, Int64DeltasAreAddedOnRead) {
+  const DocPath counter_path(kEncodedDocKey1, PrimitiveValue("counter"));
+  const DocPath deltas_path(kEncodedDocKey1, PrimitiveValue("deltas"));
+  const std::vector<SubDocKey> keys = {
+      SubDocKey(kDocKey1, PrimitiveValue("counter")),
+      SubDocKey(kDocKey1, PrimitiveValue("deltas")),
+  };
+  auto read = [this, &keys](HybridTime read_time) {
+    std::vector<SubDocument> docs;
+    std::vector<bool> docs_found;
+    EXPECT_OK(GetSubDocuments(
+        rocksdb(), keys, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext, &docs,
+        &docs_found, read_time));
+    std::vector<int64_t> result;
+    for (const auto& doc : docs) {
+      result.push_back(doc.IsInt64() ? doc.GetInt64() : -1);
+    }
+    return result;
+  };
+
+  ASSERT_OK(SetPrimitive(counter_path, PrimitiveValue(10), HybridTime::FromMicros(1000),
+                         InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(deltas_path, PrimitiveValue::Int64Delta(1), HybridTime::FromMicros(1000),
+                         InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, PrimitiveValue::Int64Delta(5), HybridTime::FromMicros(2000),
+                         InitMarkerBehavior::OPTIONAL));
+  // Deltas of the same key written by one batch differ by write id.
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      deltas_path, PrimitiveValue::Int64Delta(2), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      deltas_path, PrimitiveValue::Int64Delta(3), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(2000)));
+  ASSERT_OK(SetPrimitive(counter_path, PrimitiveValue::Int64Delta(-2), HybridTime::FromMicros(3000),
+                         InitMarkerBehavior::OPTIONAL));
+
+  ASSERT_EQ((std::vector<int64_t>{10, 1}), read(HybridTime::FromMicros(1500)));
+  ASSERT_EQ((std::vector<int64_t>{15, 6}), read(HybridTime::FromMicros(2500)));
+  ASSERT_EQ((std::vector<int64_t>{13, 6}), read(HybridTime::FromMicros(3500)));
+
+  // Compactions keep the versions that the deltas are added to.
+  CompactHistoryBefore(HybridTime::FromMicros(3500));
+  ASSERT_EQ((std::vector<int64_t>{13, 6}), read(HybridTime::FromMicros(3500)));
+
+  // Deltas written after a delete are added to 0, and a value overwrites the deltas.
+  ASSERT_OK(SetPrimitive(counter_path, PrimitiveValue(ValueType::kTombstone),
+                         HybridTime::FromMicros(4000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, PrimitiveValue::Int64Delta(7), HybridTime::FromMicros(5000),
+                         InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(deltas_path, PrimitiveValue(100), HybridTime::FromMicros(5000),
+                         InitMarkerBehavior::OPTIONAL));
+  ASSERT_EQ((std::vector<int64_t>{7, 100}), read(HybridTime::FromMicros(5500)));
+  CompactHistoryBefore(HybridTime::FromMicros(5500));
+  ASSERT_EQ((std::vector<int64_t>{7, 100}), read(HybridTime::FromMicros(5500)));
+}
+
+TEST_F(DocDBTest, CompactionFilterRemovesKeysOutOfBounds) {
+  KeyBounds bounds;
+  bounds.lower = DocKey::FromRedisKey(0x4000, "").Encode();
+  bounds.upper = DocKey::FromRedisKey(0x8000, "").Encode();
+  DocDBCompactionFilter filter(
+      HybridTime::kMin, std::make_shared<ColumnIds>(), /* is_full_compaction */ true,
+      Value::kMaxTtl, &bounds);
+
+  const auto value = Value(PrimitiveValue("value")).Encode();
+  auto filtered = [&filter, &value](uint16_t hash) {
+    auto key = SubDocKey(DocKey::FromRedisKey(hash, "key"), HybridTime::FromMicros(1000))
+        .Encode().data();
+    std::string new_value;
+    bool value_changed = false;
+    return filter.Filter(0, key, value, &new_value, &value_changed);
+  };
+
+  ASSERT_TRUE(filtered(0x1000));
+  ASSERT_FALSE(filtered(0x4000));
+  ASSERT_FALSE(filtered(0x7fff));
+  ASSERT_TRUE(filtered(0x8000));
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -36,6 +36,7 @@
 #include "yb/docdb/value_type.h"
 
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rocksdb/util/statistics.h"
 #include "yb/rocksutil/write_batch_formatter.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/server/hybrid_clock.h"
@@ -151,6 +152,24 @@ void PrepareDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_
   }
 }
 
+Status PrepareKeyValueWriteBatch(const KeyValueWriteBatchPB& write_batch,
+                                 SharedLockManager *lock_manager,
+                                 LockBatch *keys_locked) {
+  KeyToIntentTypeMap key_to_lock_type;
+  const IntentTypePair intent_types =
+      WriteIntentsForIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+  for (const auto& kv_pair : write_batch.kv_pairs()) {
+    const auto doc_key_size = DocKey::EncodedSize(kv_pair.key(), DocKeyPart::WHOLE_DOC_KEY);
+    RETURN_NOT_OK(doc_key_size);
+    if (*doc_key_size < kv_pair.key().size()) {
+      ApplyIntent(kv_pair.key().substr(0, *doc_key_size), intent_types.weak, &key_to_lock_type);
+    }
+    ApplyIntent(kv_pair.key(), intent_types.strong, &key_to_lock_type);
+  }
+  *keys_locked = LockBatch(lock_manager, std::move(key_to_lock_type));
+  return Status::OK();
+}
+
 Status ApplyDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_ops,
                               const HybridTime& hybrid_time,
                               rocksdb::DB *rocksdb,
@@ -323,14 +342,14 @@ CHECKED_STATUS DocWriteBatch::SetPrimitiveInternal(
     InitMarkerBehavior use_init_marker) {
 
   // The write_id is always incremented by one for each new element of the write batch.
-  if (put_batch_.size() > numeric_limits<IntraTxnWriteId>::max()) {
+  if (entries_.size() > numeric_limits<IntraTxnWriteId>::max()) {
     return STATUS_SUBSTITUTE(
         NotSupported,
         "Trying to add more than $0 key/value pairs in the same single-shard txn.",
         numeric_limits<IntraTxnWriteId>::max());
   }
 
-  const auto write_id = static_cast<IntraTxnWriteId>(put_batch_.size());
+  const auto write_id = static_cast<IntraTxnWriteId>(entries_.size());
   const DocHybridTime hybrid_time =
       DocHybridTime(HybridTime::kMax, write_id);
 
@@ -384,12 +403,10 @@ CHECKED_STATUS DocWriteBatch::SetPrimitiveInternal(
       }
 
       // The document/subdocument that this subkey is supposed to live in does not exist, create it.
-      KeyBytes parent_key(doc_iter->key_prefix());
-
       // Add the parent key to key/value batch before appending the encoded HybridTime to it.
       // (We replicate key/value pairs without the HybridTime and only add it before writing to
       // RocksDB.)
-      put_batch_.emplace_back(std::move(*parent_key.mutable_data()), kObjectValueType);
+      AddEntry(doc_iter->key_prefix().AsSlice(), Slice(kObjectValueType, 1));
 
       // Update our local cache to record the fact that we're adding this subdocument, so that
       // future operations in this DocWriteBatch don't have to add it or look for it in RocksDB.
@@ -404,7 +421,7 @@ CHECKED_STATUS DocWriteBatch::SetPrimitiveInternal(
   cache_.Put(doc_iter->key_prefix(), hybrid_time, value.primitive_value().value_type());
 
   // The key in the key/value batch does not have an encoded HybridTime.
-  put_batch_.emplace_back(doc_iter->key_prefix().AsStringRef(), value.Encode());
+  AddEntry(doc_iter->key_prefix().AsSlice(), value);
 
   return Status::OK();
 }
@@ -596,27 +613,45 @@ Status DocWriteBatch::ReplaceInList(
   }
 }
 
+void DocWriteBatch::AddEntry(const Slice& key, const Slice& value) {
+  entries_.push_back(Entry{arena_.size(), key.size(), value.size()});
+  arena_.append(key.cdata(), key.size());
+  arena_.append(value.cdata(), value.size());
+}
+
+void DocWriteBatch::AddEntry(const Slice& key, const Value& value) {
+  const size_t offset = arena_.size();
+  arena_.append(key.cdata(), key.size());
+  value.EncodeAndAppend(&arena_);
+  entries_.push_back(Entry{offset, key.size(), arena_.size() - offset - key.size()});
+}
+
 void DocWriteBatch::Clear() {
-  put_batch_.clear();
+  arena_.clear();
+  entries_.clear();
   cache_.Clear();
 }
 
-void DocWriteBatch::MoveToWriteBatchPB(KeyValueWriteBatchPB *kv_pb) {
-  kv_pb->mutable_kv_pairs()->Reserve(put_batch_.size());
-  for (auto& entry : put_batch_) {
+void DocWriteBatch::CopyToWriteBatchPB(KeyValueWriteBatchPB *kv_pb) const {
+  kv_pb->mutable_kv_pairs()->Reserve(kv_pb->kv_pairs_size() + entries_.size());
+  for (size_t i = 0; i != entries_.size(); ++i) {
     KeyValuePairPB* kv_pair = kv_pb->add_kv_pairs();
-    kv_pair->mutable_key()->swap(entry.first);
-    kv_pair->mutable_value()->swap(entry.second);
+    const Slice key_slice = key(i);
+    const Slice value_slice = value(i);
+    kv_pair->set_key(key_slice.cdata(), key_slice.size());
+    kv_pair->set_value(value_slice.cdata(), value_slice.size());
   }
 }
 
+void DocWriteBatch::MoveToWriteBatchPB(KeyValueWriteBatchPB *kv_pb) {
+  // Each pair is copied exactly once, from the contiguous buffer into its protobuf field.
+  CopyToWriteBatchPB(kv_pb);
+  arena_.clear();
+  entries_.clear();
+}
+
 void DocWriteBatch::TEST_CopyToWriteBatchPB(KeyValueWriteBatchPB *kv_pb) const {
-  kv_pb->mutable_kv_pairs()->Reserve(put_batch_.size());
-  for (auto& entry : put_batch_) {
-    KeyValuePairPB* kv_pair = kv_pb->add_kv_pairs();
-    kv_pair->mutable_key()->assign(entry.first);
-    kv_pair->mutable_value()->assign(entry.second);
-  }
+  CopyToWriteBatchPB(kv_pb);
 }
 
 int DocWriteBatch::GetAndResetNumRocksDBSeeks() {
@@ -643,6 +678,62 @@ CHECKED_STATUS SeekToLowerBound(const SubDocKeyBound& lower_bound, const HybridT
   return Status::OK();
 }
 
+// Adds to sum the versions of the key of a counter delta that are older than the delta, down to the
+// latest version that is not a delta. A base value that is missing, deleted, expired or overwritten
+// by an ancestor, i.e. older than low_ts, counts as 0.
+CHECKED_STATUS SumOlderInt64Deltas(
+    IntentAwareIterator* iter,
+    const KeyBytes& encoded_key,
+    SubDocKey key,
+    const HybridTime high_ts,
+    const DocHybridTime& low_ts,
+    MonoDelta table_ttl,
+    int64_t* sum) {
+  for (;;) {
+    // The versions of a key are ordered by descending hybrid time and write id.
+    const DocHybridTime& write_time = key.doc_hybrid_time();
+    if (write_time.write_id() != 0) {
+      key.set_hybrid_time(DocHybridTime(write_time.hybrid_time(), write_time.write_id() - 1));
+    } else if (write_time.hybrid_time() != HybridTime::kMin) {
+      key.SetHybridTimeForReadPath(write_time.hybrid_time().Decremented());
+    } else {
+      return Status::OK();
+    }
+    RETURN_NOT_OK(iter->SeekForward(key));
+    if (!iter->valid()) {
+      return Status::OK();
+    }
+    bool only_lacks_ht = false;
+    RETURN_NOT_OK(encoded_key.OnlyLacksHybridTimeFrom(iter->key(), &only_lacks_ht));
+    if (!only_lacks_ht) {
+      return Status::OK();
+    }
+    RETURN_NOT_OK(key.FullyDecodeFrom(iter->key()));
+    if (low_ts > key.doc_hybrid_time()) {
+      return Status::OK();
+    }
+
+    MonoDelta ttl;
+    RETURN_NOT_OK(Value::DecodeTTL(iter->value(), &ttl));
+    ttl = ComputeTTL(ttl, table_ttl);
+    if (!ttl.Equals(Value::kMaxTtl) && high_ts.CompareTo(
+            server::HybridClock::AddPhysicalTimeToHybridTime(key.hybrid_time(), ttl)) > 0) {
+      return Status::OK();
+    }
+
+    Value value;
+    RETURN_NOT_OK(value.Decode(iter->value()));
+    if (value.value_type() == ValueType::kInt64Delta) {
+      *sum += value.primitive_value().GetInt64Delta();
+      continue;
+    }
+    if (value.value_type() == ValueType::kInt64) {
+      *sum += value.primitive_value().GetInt64();
+    }
+    return Status::OK();
+  }
+}
+
 // This works similar to the ScanSubDocument function, but doesn't assume that object init_markers
 // are present. If no init marker is present, or if a tombstone is found at some level,
 // it still looks for subkeys inside it if they have larger timestamps.
@@ -739,6 +830,9 @@ CHECKED_STATUS BuildSubDocument(
         if (low_ts < write_time) {
           low_ts = write_time;
         }
+        if (doc_value.value_type() == ValueType::kTombstone) {
+          rocksdb::RecordTick(iter->statistics(), rocksdb::NUMBER_DOCDB_TOMBSTONES_SKIPPED);
+        }
         if (IsObjectType(doc_value.value_type()) ||
             doc_value.value_type() == ValueType::kArray) {
           *subdocument = SubDocument(doc_value.value_type());
@@ -753,6 +847,14 @@ CHECKED_STATUS BuildSubDocument(
         }
         continue;
       } else {
+        if (doc_value.value_type() == ValueType::kInt64Delta) {
+          // A counter updated without reading it is read as the sum of its latest deltas and of
+          // its value before them.
+          int64_t sum = doc_value.primitive_value().GetInt64Delta();
+          RETURN_NOT_OK(SumOlderInt64Deltas(
+              iter, encoded_key, found_key, high_ts, low_ts, table_ttl, &sum));
+          *doc_value.mutable_primitive_value() = PrimitiveValue(sum);
+        }
         if (!IsPrimitiveValueType(doc_value.value_type())) {
           return STATUS_FORMAT(Corruption,
               "Expected primitive value type, got $0", doc_value.value_type());
@@ -771,7 +873,7 @@ CHECKED_STATUS BuildSubDocument(
           doc_value.mutable_primitive_value()->SetTtl(ttl_seconds);
         }
         doc_value.mutable_primitive_value()->SetWritetime(write_time.hybrid_time().ToUint64());
-        *subdocument = SubDocument(doc_value.primitive_value());
+        *subdocument = SubDocument(std::move(*doc_value.mutable_primitive_value()));
         DOCDB_DEBUG_LOG("SeekForward: $0.AdvanceOutOfSubDoc() = $1", found_key.ToString(),
             found_key.AdvanceOutOfSubDoc().ToString());
         RETURN_NOT_OK(iter->SeekOutOfSubDoc(found_key));
@@ -811,7 +913,7 @@ CHECKED_STATUS BuildSubDocument(
     for (int i = subdocument_key.num_subkeys(); i < found_key.num_subkeys() - 1; i++) {
       current = current->GetOrAddChild(found_key.subkeys()[i]).first;
     }
-    current->SetChild(found_key.subkeys().back(), SubDocument(descendant));
+    current->SetChild(found_key.subkeys().back(), std::move(descendant));
   }
 }
 
@@ -839,6 +941,90 @@ yb::Status GetSubDocument(
       high_subkey);
 }
 
+yb::Status GetSubDocuments(
+    rocksdb::DB* db,
+    const std::vector<SubDocKey>& subdocument_keys,
+    const rocksdb::QueryId query_id,
+    const TransactionOperationContextOpt& txn_op_context,
+    std::vector<SubDocument>* results,
+    std::vector<bool>* docs_found,
+    HybridTime scan_ht,
+    MonoDelta table_ttl) {
+  results->clear();
+  results->resize(subdocument_keys.size());
+  docs_found->assign(subdocument_keys.size(), false);
+  if (subdocument_keys.empty()) {
+    return Status::OK();
+  }
+
+  // Visit the keys in the order they are stored in RocksDB, so that we could only move forward.
+  std::vector<std::pair<KeyBytes, size_t>> order;
+  order.reserve(subdocument_keys.size());
+  for (size_t i = 0; i != subdocument_keys.size(); ++i) {
+    order.emplace_back(subdocument_keys[i].Encode(/* include_hybrid_time */ false), i);
+  }
+  std::sort(order.begin(), order.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first.CompareTo(rhs.first) < 0;
+  });
+
+  // Bloom filter could be used only when all the keys belong to the same document.
+  const DocKey& first_doc_key = subdocument_keys[order.front().second].doc_key();
+  bool single_document = true;
+  for (const auto& subdocument_key : subdocument_keys) {
+    if (subdocument_key.doc_key() != first_doc_key) {
+      single_document = false;
+      break;
+    }
+  }
+  // Different documents are usually stored in different data blocks. Looking up the documents with
+  // MultiGet first reads these blocks into the block cache in parallel, so the iterator below
+  // finds them there instead of reading them one after another.
+  if (!single_document && db->GetDBOptions().multi_get_thread_pool) {
+    std::vector<KeyBytes> doc_keys;
+    const DocKey* prev_doc_key = nullptr;
+    for (const auto& key_and_index : order) {
+      const DocKey& doc_key = subdocument_keys[key_and_index.second].doc_key();
+      if (prev_doc_key == nullptr || *prev_doc_key != doc_key) {
+        doc_keys.push_back(doc_key.Encode());
+        prev_doc_key = &doc_key;
+      }
+    }
+    std::vector<rocksdb::Slice> doc_key_slices;
+    doc_key_slices.reserve(doc_keys.size());
+    for (const auto& doc_key : doc_keys) {
+      doc_key_slices.push_back(doc_key.AsSlice());
+    }
+    rocksdb::ReadOptions read_opts;
+    read_opts.query_id = query_id;
+    std::vector<std::string> values;
+    // Only the side effect on the block cache is needed, the documents themselves are read below.
+    db->MultiGet(read_opts, doc_key_slices, &values);
+  }
+
+  const auto first_doc_key_encoded = first_doc_key.Encode();
+  auto iter = CreateIntentAwareIterator(
+      db,
+      single_document ? BloomFilterMode::USE_BLOOM_FILTER : BloomFilterMode::DONT_USE_BLOOM_FILTER,
+      first_doc_key_encoded.AsSlice(), query_id, txn_op_context, scan_ht);
+
+  const DocKey* prev_doc_key = nullptr;
+  for (const auto& key_and_index : order) {
+    const SubDocKey& subdocument_key = subdocument_keys[key_and_index.second];
+    // Seeking forward is only possible when moving to another document. Keys within the same
+    // document require a real seek, since init markers and tombstones of their common ancestors
+    // have to be visited again.
+    const bool is_iter_valid =
+        prev_doc_key != nullptr && *prev_doc_key != subdocument_key.doc_key();
+    bool doc_found = false;
+    RETURN_NOT_OK(GetSubDocument(
+        iter.get(), subdocument_key, &(*results)[key_and_index.second], &doc_found, scan_ht,
+        table_ttl, nullptr /* projection */, false /* return_type_only */, is_iter_valid));
+    (*docs_found)[key_and_index.second] = doc_found;
+    prev_doc_key = &subdocument_key.doc_key();
+  }
+  return Status::OK();
+}
+
 yb::Status GetSubDocument(
     IntentAwareIterator *db_iter,
     const SubDocKey& subdocument_key,
@@ -850,7 +1036,8 @@ yb::Status GetSubDocument(
     bool return_type_only,
     const bool is_iter_valid,
     const SubDocKeyBound& low_subkey,
-    const SubDocKeyBound& high_subkey) {
+    const SubDocKeyBound& high_subkey,
+    const DocHybridTime& ancestor_deleted_ts) {
   // TODO(dtxn) scan through all involved first transactions to cache statuses in a batch,
   // so during building subdocument we don't need to request them one by one.
   // TODO(dtxn) we need to restart read with scan_ht = commit_ht if some transaction was committed
@@ -863,7 +1050,7 @@ yb::Status GetSubDocument(
   *doc_found = false;
   DOCDB_DEBUG_LOG("GetSubDocument for key $0 @ $1", subdocument_key.ToString(),
       scan_ht.ToDebugString());
-  DocHybridTime max_deleted_ts(DocHybridTime::kMin);
+  DocHybridTime max_deleted_ts(ancestor_deleted_ts);
 
   SubDocKey found_subdoc_key;
 
@@ -904,6 +1091,8 @@ yb::Status GetSubDocument(
       RETURN_NOT_OK(result->ConvertToRedisSet());
     } else if (*doc_found && doc_value.value_type() == ValueType::kRedisTS) {
       RETURN_NOT_OK(result->ConvertToRedisTS());
+    } else if (*doc_found && doc_value.value_type() == ValueType::kRedisSortedSet) {
+      RETURN_NOT_OK(result->ConvertToRedisSortedSet());
     }
     // TODO: Also could handle lists here.
 
@@ -929,6 +1118,64 @@ yb::Status GetSubDocument(
   return db_iter->SeekForwardWithoutHt(subdocument_key.AdvanceOutOfSubDoc());
 }
 
+yb::Status HasSubDocument(
+    IntentAwareIterator *db_iter,
+    const SubDocKey& subdocument_key,
+    bool *doc_found,
+    const HybridTime scan_ht,
+    MonoDelta table_ttl,
+    const bool is_iter_valid,
+    const DocHybridTime& ancestor_deleted_ts) {
+  *doc_found = false;
+  DocHybridTime max_deleted_ts(ancestor_deleted_ts);
+
+  DCHECK(!subdocument_key.has_hybrid_time());
+  KeyBytes key_bytes = subdocument_key.doc_key().Encode();
+
+  if (is_iter_valid) {
+    RETURN_NOT_OK(db_iter->SeekForwardWithoutHt(key_bytes));
+  } else {
+    RETURN_NOT_OK(db_iter->SeekWithoutHt(key_bytes));
+  }
+
+  for (const PrimitiveValue& subkey : subdocument_key.subkeys()) {
+    RETURN_NOT_OK(db_iter->FindLastWriteTime(key_bytes, scan_ht, &max_deleted_ts, nullptr));
+    subkey.AppendToKey(&key_bytes);
+  }
+
+  const DocHybridTime ancestors_deleted_ts = max_deleted_ts;
+  Value doc_value = Value(PrimitiveValue(ValueType::kInvalidValueType));
+  RETURN_NOT_OK(db_iter->FindLastWriteTime(key_bytes, scan_ht, &max_deleted_ts, &doc_value));
+  // An init marker or a primitive value written for the subdocument itself, after its ancestors
+  // were deleted.
+  if (doc_value.value_type() != ValueType::kInvalidValueType &&
+      doc_value.value_type() != ValueType::kTombstone && max_deleted_ts > ancestors_deleted_ts) {
+    *doc_found = true;
+  }
+
+  const size_t num_subkeys = subdocument_key.num_subkeys();
+  SubDocKey found_key;
+  while (!*doc_found && db_iter->valid() && db_iter->key().starts_with(key_bytes.AsSlice())) {
+    RETURN_NOT_OK(found_key.FullyDecodeFrom(db_iter->key()));
+    if (found_key.num_subkeys() <= num_subkeys) {
+      // Records of the subdocument itself were already taken into account above.
+      RETURN_NOT_OK(db_iter->SeekPastSubKey(found_key));
+      continue;
+    }
+    SubDocKey child_key = subdocument_key;
+    child_key.AppendSubKeysAndMaybeHybridTime(found_key.subkeys()[num_subkeys]);
+    RETURN_NOT_OK(db_iter->SeekForwardWithoutHt(
+        child_key.Encode(/* include_hybrid_time */ false)));
+    // BuildSubDocument places the iterator outside of the child, so the loop always progresses.
+    SubDocument descendant(ValueType::kInvalidValueType);
+    RETURN_NOT_OK(BuildSubDocument(db_iter, child_key, &descendant, scan_ht, max_deleted_ts,
+        table_ttl, SubDocKeyBound(), SubDocKeyBound()));
+    *doc_found = descendant.value_type() != ValueType::kInvalidValueType;
+  }
+
+  return db_iter->SeekForwardWithoutHt(subdocument_key.AdvanceOutOfSubDoc());
+}
+
 // ------------------------------------------------------------------------------------------------
 // Debug output
 // ------------------------------------------------------------------------------------------------
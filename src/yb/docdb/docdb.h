@@ -153,12 +153,21 @@ class DocWriteBatch {
       InitMarkerBehavior use_init_marker = InitMarkerBehavior::REQUIRED);
 
   void Clear();
-  bool IsEmpty() const { return put_batch_.empty(); }
+  bool IsEmpty() const { return entries_.empty(); }
 
-  size_t size() const { return put_batch_.size(); }
+  size_t size() const { return entries_.size(); }
 
-  const std::vector<std::pair<std::string, std::string>>& key_value_pairs() const {
-    return put_batch_;
+  // Encoded key (without a hybrid time) of the key/value pair with the given index. The returned
+  // slice points into the internal buffer and is valid until this batch is modified.
+  Slice key(size_t index) const {
+    const auto& entry = entries_[index];
+    return Slice(arena_.data() + entry.offset, entry.key_size);
+  }
+
+  // Encoded value of the key/value pair with the given index, see key() for lifetime.
+  Slice value(size_t index) const {
+    const auto& entry = entries_[index];
+    return Slice(arena_.data() + entry.offset + entry.key_size, entry.value_size);
   }
 
   void MoveToWriteBatchPB(KeyValueWriteBatchPB *kv_pb);
@@ -190,11 +199,28 @@ class DocWriteBatch {
       int num_subkeys,
       InitMarkerBehavior use_init_marker);
 
+  // Appends a key/value pair to the batch. Key and value bytes are copied into arena_.
+  void AddEntry(const Slice& key, const Slice& value);
+  void AddEntry(const Slice& key, const Value& value);
+
+  void CopyToWriteBatchPB(KeyValueWriteBatchPB *kv_pb) const;
+
+  // Location of a key/value pair in arena_. Value bytes immediately follow key bytes.
+  struct Entry {
+    size_t offset;
+    size_t key_size;
+    size_t value_size;
+  };
+
   DocWriteBatchCache cache_;
 
   rocksdb::DB* rocksdb_;
   std::atomic<int64_t>* monotonic_counter_;
-  std::vector<std::pair<std::string, std::string>> put_batch_;
+
+  // Keys and values of all pairs in this batch are stored in one contiguous buffer, so adding a
+  // pair does not allocate separate strings for it.
+  std::string arena_;
+  std::vector<Entry> entries_;
 
   int num_rocksdb_seeks_;
 };
@@ -224,6 +250,13 @@ void PrepareDocWriteOperation(const std::vector<std::unique_ptr<DocOperation>>&
                               bool *need_read_snapshot,
                               const scoped_refptr<Histogram>& write_lock_latency);
 
+// Locks the keys written by a ready-made batch of key-value pairs, e.g. changes replicated from
+// another cluster: each key is locked exclusively, and its document key shared, like the paths of
+// doc operations are locked by PrepareDocWriteOperation.
+CHECKED_STATUS PrepareKeyValueWriteBatch(const KeyValueWriteBatchPB& write_batch,
+                                         SharedLockManager *lock_manager,
+                                         LockBatch *keys_locked);
+
 // This function reads from rocksdb and constructs the write batch.
 //
 // Input: doc_write_ops, read snapshot hybrid_time if requested in PrepareDocWriteOperation().
@@ -348,6 +381,8 @@ class SubDocKeyBound : public SubDocKey {
 // If low and high subkey are specified, only first level keys in the subdocument within that
 // range(inclusive) are returned and the iterator is positioned after high_subkey and not
 // necessarily outside the SubDocument.
+// Values written before ancestor_deleted_ts are not visible. It is used for deletes that cover the
+// document but are stored outside of its key, e.g. a delete of the hash partition of a row.
 yb::Status GetSubDocument(
     IntentAwareIterator *db_iter,
     const SubDocKey& subdocument_key,
@@ -359,7 +394,21 @@ yb::Status GetSubDocument(
     bool return_type_only = false,
     const bool is_iter_valid = true,
     const SubDocKeyBound& low_subkey = SubDocKeyBound(),
-    const SubDocKeyBound& high_subkey = SubDocKeyBound());
+    const SubDocKeyBound& high_subkey = SubDocKeyBound(),
+    const DocHybridTime& ancestor_deleted_ts = DocHybridTime::kMin);
+
+// Checks whether the subdocument identified by subdocument_key has any live value at scan_ts,
+// with the same visibility rules as GetSubDocument. First level subdocuments are checked one at a
+// time and the scan stops at the first one that exists, so no SubDocument is built for the rest.
+// After this, the iter is positioned just outside the subdocument.
+yb::Status HasSubDocument(
+    IntentAwareIterator *db_iter,
+    const SubDocKey& subdocument_key,
+    bool *doc_found,
+    HybridTime scan_ts = HybridTime::kMax,
+    MonoDelta table_ttl = Value::kMaxTtl,
+    bool is_iter_valid = true,
+    const DocHybridTime& ancestor_deleted_ts = DocHybridTime::kMin);
 
 // This version of GetSubDocument creates a new iterator every time. This is not recommended for
 // multiple calls to subdocs that are sequential or near each other, in eg. doc_rowwise_iterator.
@@ -379,6 +428,19 @@ yb::Status GetSubDocument(
     const SubDocKeyBound& low_subkey = SubDocKeyBound(),
     const SubDocKeyBound& high_subkey = SubDocKeyBound());
 
+// Batched version of GetSubDocument. Looks up all of subdocument_keys with a single iterator,
+// visiting them in key order and seeking forward between different documents. results and
+// docs_found are filled in the same order as subdocument_keys.
+yb::Status GetSubDocuments(
+    rocksdb::DB* db,
+    const std::vector<SubDocKey>& subdocument_keys,
+    const rocksdb::QueryId query_id,
+    const TransactionOperationContextOpt& txn_op_context,
+    std::vector<SubDocument>* results,
+    std::vector<bool>* docs_found,
+    HybridTime scan_ts = HybridTime::kMax,
+    MonoDelta table_ttl = Value::kMaxTtl);
+
 // Create a debug dump of the document database. Tries to decode all keys/values despite failures.
 // Reports all errors to the output stream and returns the status of the first failed operation,
 // if any.
@@ -18,6 +18,7 @@
 #include <glog/logging.h>
 
 #include "yb/rocksdb/compaction_filter.h"
+#include "yb/rocksdb/db/version_edit.h"
 #include "yb/rocksdb/util/string_util.h"
 
 #include "yb/docdb/doc_key.h"
@@ -34,18 +35,24 @@ using rocksdb::VectorToString;
 namespace yb {
 namespace docdb {
 
+bool AllRecordsExpired(const rocksdb::UserBoundaryValues& largest,
+                       HybridTime history_cutoff,
+                       const MonoDelta& table_ttl);
+
 // ------------------------------------------------------------------------------------------------
 
 DocDBCompactionFilter::DocDBCompactionFilter(HybridTime history_cutoff,
                                              ColumnIdsPtr deleted_cols,
                                              bool is_full_compaction,
-                                             MonoDelta table_ttl)
+                                             MonoDelta table_ttl,
+                                             const KeyBounds* key_bounds)
     : history_cutoff_(history_cutoff),
       is_full_compaction_(is_full_compaction),
       is_first_key_value_(true),
       filter_usage_logged_(false),
       table_ttl_(table_ttl),
-      deleted_cols_(deleted_cols) {
+      deleted_cols_(deleted_cols),
+      key_bounds_(key_bounds && !key_bounds->empty() ? key_bounds : nullptr) {
 }
 
 DocDBCompactionFilter::~DocDBCompactionFilter() {
@@ -73,6 +80,19 @@ bool DocDBCompactionFilter::Filter(int level,
     filter_usage_logged_ = true;
   }
 
+  // Provisional records of transactions (intents, reverse index and transaction metadata) are not
+  // regular SubDocKeys. They are removed explicitly when transaction is applied, so keep them
+  // without decoding and without touching the overwrite stack of regular records.
+  if (!key.empty() && key[0] == static_cast<char>(ValueType::kIntentPrefix)) {
+    return false;
+  }
+
+  // Records of other tablets are not reachable by reads of this tablet, so they could be dropped
+  // without looking at the overwrite stack.
+  if (key_bounds_ && !key_bounds_->IsWithinBounds(key)) {
+    return true;
+  }
+
   SubDocKey subdoc_key;
 
   // TODO: Find a better way for handling of data corruption encountered during compactions.
@@ -111,9 +131,18 @@ bool DocDBCompactionFilter::Filter(int level,
   // k1 col2 T9   Truncating the stack to [T10], setting prev_overwrite_ht to 10, and therefore
   //              deciding to remove this entry because 9 < 10.
   //
-  const DocHybridTime prev_overwrite_ht =
+  DocHybridTime prev_overwrite_ht =
     overwrite_ht_.empty() ? DocHybridTime::kMin : overwrite_ht_.back();
 
+  // Rows of a hash partition are also overwritten by a delete of the whole partition, that is
+  // written to the hashed key of the partition.
+  const DocKey& doc_key = subdoc_key.doc_key();
+  const bool is_hashed = !doc_key.hashed_group().empty();
+  const bool is_partition_key = is_hashed && doc_key.range_group().empty();
+  if (is_hashed && !is_partition_key && doc_key.HashedComponentsEqual(partition_doc_key_)) {
+    prev_overwrite_ht = max(prev_overwrite_ht, partition_overwrite_ht_);
+  }
+
   // We only keep entries with hybrid_time equal to or later than the latest time the subdocument
   // was fully overwritten or deleted prior to or at the history cutoff hybrid_time. The intuition
   // is that key/value pairs that were overwritten at or before history cutoff time will not be
@@ -148,14 +177,43 @@ bool DocDBCompactionFilter::Filter(int level,
 
   const bool ht_at_or_below_cutoff = ht.hybrid_time() <= history_cutoff_;
 
+  ValueType value_type;
+  CHECK_OK(Value::DecodePrimitiveValueType(existing_value, &value_type));
+  MonoDelta ttl;
+
+  // If the value expires by the time of history cutoff, it is treated as deleted and filtered out.
+  CHECK_OK(Value::DecodeTTL(existing_value, &ttl));
+
+  bool has_expired = false;
+
+  CHECK_OK(HasExpiredTTL(subdoc_key.hybrid_time(), ComputeTTL(ttl, table_ttl_), history_cutoff_,
+                         &has_expired));
+
+  // A counter delta is added to the older versions of its key when read, so unless it has expired,
+  // it does not overwrite them. Deltas are kept as they are: folding a run of deltas into one value
+  // would need the older versions, which this filter only sees after the newer ones are written.
+  const bool overwrites = value_type != ValueType::kInt64Delta || has_expired;
+
   // See if we found a higher hybrid_time not exceeding the history cutoff hybrid_time at which the
   // subdocument (including a primitive value) rooted at the current key was fully overwritten.
   // In case ts > history_cutoff_, we just keep the parent document's highest known overwrite
   // hybrid_time that does not exceed the cutoff hybrid_time. In that case this entry is obviously
   // too new to be garbage-collected.
-  overwrite_ht_.push_back(ht_at_or_below_cutoff ? max(prev_overwrite_ht, ht) : prev_overwrite_ht);
+  overwrite_ht_.push_back(ht_at_or_below_cutoff && overwrites ? max(prev_overwrite_ht, ht)
+                                                              : prev_overwrite_ht);
 
   CHECK_EQ(new_stack_size, overwrite_ht_.size());
+
+  if (is_partition_key) {
+    if (!doc_key.HashedComponentsEqual(partition_doc_key_)) {
+      partition_doc_key_ = doc_key;
+      partition_overwrite_ht_ = DocHybridTime::kMin;
+    }
+    if (subdoc_key.num_subkeys() == 0) {
+      partition_overwrite_ht_ = overwrite_ht_.back();
+    }
+  }
+
   prev_subdoc_key_ = std::move(subdoc_key);
 
   if (prev_subdoc_key_.num_subkeys() > 0 &&
@@ -168,18 +226,6 @@ bool DocDBCompactionFilter::Filter(int level,
     }
   }
 
-  ValueType value_type;
-  CHECK_OK(Value::DecodePrimitiveValueType(existing_value, &value_type));
-  MonoDelta ttl;
-
-  // If the value expires by the time of history cutoff, it is treated as deleted and filtered out.
-  CHECK_OK(Value::DecodeTTL(existing_value, &ttl));
-
-  bool has_expired = false;
-
-  CHECK_OK(HasExpiredTTL(subdoc_key.hybrid_time(), ComputeTTL(ttl, table_ttl_), history_cutoff_,
-                         &has_expired));
-
   // As of 02/2017, we don't have init markers for top level documents in QL. As a result, we can
   // compact away each column if it has expired, including the liveness system column. The init
   // markers in Redis wouldn't be affected since they don't have any TTL associated with them and
@@ -210,9 +256,9 @@ const char* DocDBCompactionFilter::Name() const {
 // ------------------------------------------------------------------------------------------------
 
 DocDBCompactionFilterFactory::DocDBCompactionFilterFactory(
-    shared_ptr<HistoryRetentionPolicy> retention_policy)
-    :
-    retention_policy_(retention_policy) {
+    shared_ptr<HistoryRetentionPolicy> retention_policy, const KeyBounds* key_bounds)
+    : retention_policy_(retention_policy),
+      key_bounds_(key_bounds) {
 }
 
 DocDBCompactionFilterFactory::~DocDBCompactionFilterFactory() {
@@ -223,12 +269,38 @@ unique_ptr<CompactionFilter> DocDBCompactionFilterFactory::CreateCompactionFilte
   return unique_ptr<DocDBCompactionFilter>(
       new DocDBCompactionFilter(retention_policy_->GetHistoryCutoff(),
                                 retention_policy_->GetDeletedColumns(),
-                                context.is_full_compaction, retention_policy_->GetTableTTL()));
+                                context.is_full_compaction, retention_policy_->GetTableTTL(),
+                                key_bounds_));
 }
 
 const char* DocDBCompactionFilterFactory::Name() const {
   return "DocDBCompactionFilterFactory";
 }
 
+// ------------------------------------------------------------------------------------------------
+
+rocksdb::FilterDecision DocDBCompactionFileFilter::Filter(const rocksdb::FileMetaData* file) {
+  return AllRecordsExpired(file->largest.user_values, history_cutoff_, table_ttl_)
+      ? rocksdb::FilterDecision::kDiscard : rocksdb::FilterDecision::kKeep;
+}
+
+DocDBCompactionFileFilterFactory::DocDBCompactionFileFilterFactory(
+    shared_ptr<HistoryRetentionPolicy> retention_policy)
+    : retention_policy_(std::move(retention_policy)) {
+}
+
+DocDBCompactionFileFilterFactory::~DocDBCompactionFileFilterFactory() {
+}
+
+unique_ptr<rocksdb::CompactionFileFilter>
+DocDBCompactionFileFilterFactory::CreateCompactionFileFilter() {
+  return std::make_unique<DocDBCompactionFileFilter>(
+      retention_policy_->GetHistoryCutoff(), retention_policy_->GetTableTTL());
+}
+
+const char* DocDBCompactionFileFilterFactory::Name() const {
+  return "DocDBCompactionFileFilterFactory";
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -27,12 +27,31 @@
 namespace yb {
 namespace docdb {
 
+// Range of encoded keys that belong to a tablet. Empty lower or upper means no bound.
+struct KeyBounds {
+  KeyBytes lower;
+  KeyBytes upper;
+
+  bool IsWithinBounds(const Slice& key) const {
+    return (lower.empty() || key.compare(lower.AsSlice()) >= 0) &&
+           (upper.empty() || key.compare(upper.AsSlice()) < 0);
+  }
+
+  bool empty() const {
+    return lower.empty() && upper.empty();
+  }
+};
+
 class DocDBCompactionFilter : public rocksdb::CompactionFilter {
  public:
+  // Records with keys outside of key_bounds, if specified, are removed by full compactions. Such
+  // records are present in a tablet created from files of a tablet with a wider range of keys,
+  // e.g. after split.
   DocDBCompactionFilter(HybridTime history_cutoff,
                         ColumnIdsPtr deleted_cols,
                         bool is_full_compaction,
-                        MonoDelta table_ttl);
+                        MonoDelta table_ttl,
+                        const KeyBounds* key_bounds = nullptr);
 
   ~DocDBCompactionFilter() override;
   bool Filter(int level,
@@ -92,6 +111,12 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
 
   mutable std::vector<DocHybridTime> overwrite_ht_;
 
+  // The hashed key of the latest hash partition whose hashed key was seen, and the highest hybrid
+  // time lower than or equal to history_cutoff_ at which the whole partition, i.e. its static
+  // columns and all its rows, was deleted. The hashed key sorts before the rows of the partition.
+  mutable DocKey partition_doc_key_;
+  mutable DocHybridTime partition_overwrite_ht_ = DocHybridTime::kMin;
+
   // We use this to only log a message that the filter is being used once on the first call to
   // the Filter function.
   mutable bool filter_usage_logged_;
@@ -100,6 +125,8 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   MonoDelta table_ttl_;
 
   ColumnIdsPtr deleted_cols_;
+
+  const KeyBounds* key_bounds_;
 };
 
 // A strategy for deciding the history cutoff. We may implement this differently in production and
@@ -139,12 +166,41 @@ class FixedHybridTimeRetentionPolicy : public HistoryRetentionPolicy {
 
 class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy);
+  // key_bounds, if specified, should outlive this factory.
+  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy,
+                                        const KeyBounds* key_bounds = nullptr);
   ~DocDBCompactionFilterFactory() override;
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override;
   const char* Name() const override;
 
+ private:
+  std::shared_ptr<HistoryRetentionPolicy> retention_policy_;
+  const KeyBounds* key_bounds_;
+};
+
+// Discards SST files all records of which have expired or are deletes by the history cutoff, using
+// the expiration boundary values of the files. Such files are deleted without being rewritten.
+class DocDBCompactionFileFilter : public rocksdb::CompactionFileFilter {
+ public:
+  DocDBCompactionFileFilter(HybridTime history_cutoff, MonoDelta table_ttl)
+      : history_cutoff_(history_cutoff), table_ttl_(table_ttl) {}
+
+  rocksdb::FilterDecision Filter(const rocksdb::FileMetaData* file) override;
+
+ private:
+  const HybridTime history_cutoff_;
+  const MonoDelta table_ttl_;
+};
+
+class DocDBCompactionFileFilterFactory : public rocksdb::CompactionFileFilterFactory {
+ public:
+  explicit DocDBCompactionFileFilterFactory(
+      std::shared_ptr<HistoryRetentionPolicy> retention_policy);
+  ~DocDBCompactionFileFilterFactory() override;
+  std::unique_ptr<rocksdb::CompactionFileFilter> CreateCompactionFileFilter() override;
+  const char* Name() const override;
+
  private:
   std::shared_ptr<HistoryRetentionPolicy> retention_policy_;
 };
@@ -13,14 +13,23 @@
 
 #include "yb/docdb/docdb_rocksdb_util.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "yb/common/transaction.h"
+#include "yb/gutil/casts.h"
+#include "yb/rocksdb/db/compaction.h"
 
+#include "yb/rocksdb/memtablerep.h"
 #include "yb/rocksdb/rate_limiter.h"
 #include "yb/rocksdb/table.h"
+#include "yb/rocksdb/table/block_based_table_factory.h"
+#include "yb/rocksdb/util/compression.h"
+#include "yb/rocksdb/util/statistics.h"
 
+#include "yb/docdb/expiration_index.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/tombstone_stats.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
@@ -29,11 +38,17 @@
 
 DEFINE_int32(rocksdb_max_background_flushes, 1, "Number threads to do background flushes.");
 DEFINE_bool(rocksdb_disable_compactions, false, "Disable background compactions.");
+DEFINE_bool(rocksdb_allow_concurrent_memtable_write, false,
+            "Allow write batches that are written to the RocksDB of a tablet at the same time to "
+            "be inserted into the memtable in parallel.");
 DEFINE_int32(rocksdb_base_background_compactions, 2,
              "Number threads to do background compactions.");
 DEFINE_int32(rocksdb_max_background_compactions, 4,
              "Increased number of threads to do background compactions (used when compactions need "
              "to catch up.)");
+DEFINE_int32(rocksdb_max_subcompactions, 1,
+             "Maximum number of threads a single compaction is split into by key ranges. Ranges "
+             "never split a document.");
 DEFINE_int32(rocksdb_level0_file_num_compaction_trigger, 5,
              "Number of files to trigger level-0 compaction. -1 if compaction should not be "
              "triggered by number of files at all.");
@@ -52,12 +67,71 @@ DEFINE_uint64(rocksdb_compaction_size_threshold_bytes, 2ULL * 1024 * 1024 * 1024
              "Threshold beyond which compaction is considered large.");
 DEFINE_uint64(rocksdb_max_file_size_for_compaction, 0,
              "Maximal allowed file size to participate in RocksDB compaction. 0 - unlimited.");
+DEFINE_bool(rocksdb_compaction_direct_io, false,
+            "Read the input files and write the output files of compactions with O_DIRECT, "
+            "bypassing the OS page cache, so compactions do not evict the data read by queries.");
+DEFINE_int64(rocksdb_compaction_readahead_size_bytes, 0,
+             "Size of the reads of compaction input files. 0 means 2MB with "
+             "--rocksdb_compaction_direct_io and no readahead otherwise.");
+DEFINE_int64(rocksdb_compaction_direct_io_buffer_size_bytes, 1024 * 1024,
+             "Size of the aligned buffer compaction output files are written from with "
+             "--rocksdb_compaction_direct_io.");
 
 DEFINE_int64(db_block_size_bytes, 32 * 1024,
              "Size of RocksDB block (in bytes).");
 
+DEFINE_int64(rocksdb_max_auto_readahead_size_bytes, 256 * 1024,
+             "Upper bound of the readahead of an iterator that reads the data blocks of an SST "
+             "file one after another. The readahead starts at 8KB after a few sequential blocks "
+             "and doubles up to this size. 0 disables the readahead.");
+TAG_FLAG(rocksdb_max_auto_readahead_size_bytes, advanced);
+
+DEFINE_int64(db_index_block_size_bytes, 0,
+             "Size of RocksDB data index partition (in bytes). With a non-zero value the data "
+             "index of new SST files is split into partitions of that size, only the small "
+             "top-level index is loaded on open and partitions are read through the block cache.");
+
+DEFINE_bool(rocksdb_skip_stats_update_on_db_open, true,
+            "Do not read the table properties of SST files to update deletion statistics when a "
+            "tablet is opened, so opening a tablet does not read its SST files. The statistics "
+            "only affect level style compactions.");
+TAG_FLAG(rocksdb_skip_stats_update_on_db_open, advanced);
+
+DEFINE_bool(rocksdb_data_block_key_parts_encoding, false,
+            "Encode keys of new SST data blocks, that have the same size as the previous key, as "
+            "the parts that differ from it. Saves space for DocDB keys of the columns of a row, "
+            "but SST files written with it can't be read by older versions.");
+TAG_FLAG(rocksdb_data_block_key_parts_encoding, advanced);
+
+DEFINE_int32(rocksdb_compression_dict_bytes, 0,
+             "If positive, new SST files are compressed with ZSTD using a dictionary of up to this "
+             "number of bytes, trained from the first keys and values of each file and stored in "
+             "it. Ignored if ZSTD dictionaries are not supported by the build.");
+TAG_FLAG(rocksdb_compression_dict_bytes, advanced);
+
+DEFINE_int32(rocksdb_compression_parallel_threads, 2,
+             "Number of threads compressing data blocks of each SST file being flushed or "
+             "compacted, while previously compressed blocks are written. With 1, blocks are "
+             "compressed by the thread building the file.");
+TAG_FLAG(rocksdb_compression_parallel_threads, advanced);
+
 DEFINE_bool(use_docdb_aware_bloom_filter, true,
             "Whether to use the DocDbAwareFilterPolicy for both bloom storage and seeks.");
+DEFINE_int32(docdb_bloom_filter_range_components, 0,
+             "Number of leading range components that are added to the hashed components of the "
+             "document key to form the key of the DocDB aware bloom filter. With a non-zero value "
+             "only reads that are bounded by the hash key and that many range components could "
+             "use the bloom filter.");
+DEFINE_int64(docdb_hash_memtable_bucket_count, 64 * 1024,
+             "Number of buckets of the hash based memtable used for point lookup tables.");
+DEFINE_int32(docdb_memtable_prefix_bloom_bits, 1024 * 1024,
+             "Size in bits of the bloom filter of the hashed parts of the document keys in each "
+             "memtable. Reads bounded by a document skip the memtables that have no key of the "
+             "document. 0 disables the filter.");
+TAG_FLAG(docdb_memtable_prefix_bloom_bits, advanced);
+DEFINE_bool(docdb_skip_files_newer_than_read_time, true,
+            "Whether non-transactional reads skip SST files all records of which were written "
+            "after the read time.");
 DEFINE_int32(max_nexts_to_avoid_seek, 8,
              "The number of next calls to try before doing resorting to do a rocksdb seek.");
 DEFINE_bool(trace_docdb_calls, false, "Whether we should trace calls into the docdb.");
@@ -72,7 +146,15 @@ using strings::Substitute;
 namespace yb {
 namespace docdb {
 
+namespace {
+
+constexpr int64_t kDefaultCompactionDirectIOReadaheadSize = 2 * 1024 * 1024;
+constexpr int64_t kCompactionDirectIOAlignment = 4 * 1024;
+
+} // namespace
+
 std::shared_ptr<rocksdb::BoundaryValuesExtractor> DocBoundaryValuesExtractorInstance();
+HybridTime MinRecordHybridTime(const rocksdb::FdWithBoundaries& file);
 
 Status SeekToValidKvAtTs(
     rocksdb::Iterator *iter,
@@ -158,15 +240,17 @@ Status SeekToValidKvAtTs(
   return Status::OK();
 }
 
-void SeekForward(const rocksdb::Slice& slice, rocksdb::Iterator *iter) {
+void SeekForward(const rocksdb::Slice& slice, rocksdb::Iterator *iter,
+                 rocksdb::Statistics* statistics) {
   if (!iter->Valid() || iter->key().compare(slice) >= 0) {
     return;
   }
-  ROCKSDB_SEEK(iter, slice);
+  ROCKSDB_SEEK_WITH_STATISTICS(iter, slice, statistics);
 }
 
-void SeekForward(const KeyBytes& key_bytes, rocksdb::Iterator *iter) {
-  SeekForward(key_bytes.AsSlice(), iter);
+void SeekForward(const KeyBytes& key_bytes, rocksdb::Iterator *iter,
+                 rocksdb::Statistics* statistics) {
+  SeekForward(key_bytes.AsSlice(), iter, statistics);
 }
 
 void SeekPastSubKey(const SubDocKey& sub_doc_key, rocksdb::Iterator* iter) {
@@ -179,7 +263,8 @@ void PerformRocksDBSeek(
     rocksdb::Iterator *iter,
     const rocksdb::Slice &seek_key,
     const char* file_name,
-    int line) {
+    int line,
+    rocksdb::Statistics* statistics) {
 #ifndef NDEBUG
   {
     // Validating that we're only using keys with a max "write id" component, or no HybridTime at
@@ -227,6 +312,7 @@ void PerformRocksDBSeek(
         if (FLAGS_trace_docdb_calls) {
           TRACE("Did $0 Next(s) instead of a Seek", nexts);
         }
+        rocksdb::RecordTick(statistics, rocksdb::NUMBER_DB_SEEK_AVOIDED_BY_NEXT);
         break;
       }
       if (nexts < FLAGS_max_nexts_to_avoid_seek) {
@@ -238,6 +324,7 @@ void PerformRocksDBSeek(
         }
         iter->Seek(seek_key);
         ++seek_count;
+        rocksdb::RecordTick(statistics, rocksdb::NUMBER_DB_SEEK_AFTER_NEXTS);
       }
     }
   }
@@ -277,9 +364,29 @@ rocksdb::ReadOptions PrepareReadOptions(
         NewTableAwareReadFileFilter(read_opts, user_key_for_filter.get());
   }
   read_opts.file_filter = std::move(file_filter);
+  // Iterators which use the bloom filter never leave the document of user_key_for_filter, so they
+  // could only look at its bucket of a hash based memtable. Other iterators need all the keys.
+  read_opts.total_order_seek = bloom_filter_mode != BloomFilterMode::USE_BLOOM_FILTER;
   return read_opts;
 }
 
+// Skips files with records written only after the read time, they are invisible to the read.
+// Files should also pass the filter this one is combined with.
+class HybridTimeFileFilter : public rocksdb::ReadFileFilter {
+ public:
+  HybridTimeFileFilter(HybridTime read_time, std::shared_ptr<rocksdb::ReadFileFilter> base)
+      : read_time_(read_time), base_(std::move(base)) {
+  }
+
+  bool Filter(const rocksdb::FdWithBoundaries& file) const override {
+    return MinRecordHybridTime(file) <= read_time_ && (!base_ || base_->Filter(file));
+  }
+
+ private:
+  const HybridTime read_time_;
+  const std::shared_ptr<rocksdb::ReadFileFilter> base_;
+};
+
 } // namespace
 
 unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
@@ -300,6 +407,12 @@ unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
     const TransactionOperationContextOpt& txn_op_context,
     const HybridTime high_ht,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter) {
+  // Provisional records of the own transaction could be written after its read time, so only
+  // non-transactional reads could skip files by time.
+  if (FLAGS_docdb_skip_files_newer_than_read_time && !txn_op_context &&
+      high_ht != HybridTime::kMax) {
+    file_filter = std::make_shared<HybridTimeFileFilter>(high_ht, std::move(file_filter));
+  }
   rocksdb::ReadOptions read_opts = PrepareReadOptions(rocksdb, bloom_filter_mode,
       user_key_for_filter, query_id, std::move(file_filter));
   return std::make_unique<IntentAwareIterator>(rocksdb, read_opts, high_ht, txn_op_context);
@@ -316,30 +429,72 @@ void InitRocksDBOptions(
   options->info_log_level = YBRocksDBLogger::ConvertToRocksDBLogLevel(FLAGS_minloglevel);
   options->initial_seqno = FLAGS_initial_seqno;
   options->boundary_extractor = DocBoundaryValuesExtractorInstance();
+  options->table_properties_collector_factories.push_back(ExpirationIndexCollectorFactory());
+  options->table_properties_collector_factories.push_back(TombstoneStatsCollectorFactory());
   options->memory_monitor = tablet_options.memory_monitor;
+  if (FLAGS_rocksdb_allow_concurrent_memtable_write) {
+    options->allow_concurrent_memtable_write = true;
+    // Followers of a write group spin waiting for the leader instead of blocking on a mutex.
+    options->enable_write_thread_adaptive_yield = true;
+  }
   options->listeners.insert(
       options->listeners.end(), tablet_options.listeners.begin(),
       tablet_options.listeners.end()); // Append listeners
 
+  // Small blocks of similar values compress much better with a dictionary shared by the file.
+  if (FLAGS_rocksdb_compression_dict_bytes > 0 && rocksdb::ZSTD_TrainDictionarySupported()) {
+    options->compression = rocksdb::kZSTDNotFinalCompression;
+    options->compression_opts.max_dict_bytes = FLAGS_rocksdb_compression_dict_bytes;
+  }
+  options->compression_opts.parallel_threads =
+      std::max(FLAGS_rocksdb_compression_parallel_threads, 1);
+
+  // Only the iterators created with the bloom filter do prefix seeks into the memtables, and those
+  // never leave the document of the seek key, so they can skip memtables by the hashed part of it.
+  // Keys that are not document keys, e.g. intents, all have an empty prefix.
+  if (FLAGS_docdb_memtable_prefix_bloom_bits > 0) {
+    options->memtable_prefix_extractor.reset(NewDocKeyHashedPartTransform());
+    options->memtable_prefix_bloom_bits = FLAGS_docdb_memtable_prefix_bloom_bits;
+  }
+
   // Set block cache options.
   rocksdb::BlockBasedTableOptions table_options;
   if (tablet_options.block_cache) {
     table_options.block_cache = tablet_options.block_cache;
     // Cache the bloom filters in the block cache.
     table_options.cache_index_and_filter_blocks = true;
+    table_options.pinned_blocks_mem_tracker = tablet_options.pinned_blocks_mem_tracker;
   } else {
     table_options.no_block_cache = true;
     table_options.cache_index_and_filter_blocks = false;
   }
+  table_options.block_cache_compressed = tablet_options.block_cache_compressed;
   table_options.block_size = FLAGS_db_block_size_bytes;
+  // With direct I/O only whole pages are written, so data is written once the buffer is full
+  // instead of after every block.
+  table_options.skip_table_builder_flush = FLAGS_rocksdb_compaction_direct_io;
+  table_options.max_auto_readahead_size = std::max<int64_t>(
+      FLAGS_rocksdb_max_auto_readahead_size_bytes, 0);
+  if (FLAGS_db_index_block_size_bytes > 0) {
+    table_options.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    table_options.index_block_size = FLAGS_db_index_block_size_bytes;
+  }
+  if (FLAGS_rocksdb_data_block_key_parts_encoding) {
+    table_options.data_block_key_value_encoding_format =
+        rocksdb::KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefixAndParts;
+  }
 
   // Set our custom bloom filter that is docdb aware.
   if (FLAGS_use_docdb_aware_bloom_filter) {
     table_options.filter_policy.reset(new DocDbAwareFilterPolicy(
-        table_options.filter_block_size * 8, options->info_log.get()));
+        table_options.filter_block_size * 8, options->info_log.get(),
+        std::max(FLAGS_docdb_bloom_filter_range_components, 0)));
   }
 
   options->table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+  options->multi_get_thread_pool = tablet_options.multi_get_thread_pool;
+  options->table_cache = tablet_options.table_cache;
+  options->skip_stats_update_on_db_open = FLAGS_rocksdb_skip_stats_update_on_db_open;
 
   // Compaction related options.
 
@@ -355,6 +510,11 @@ void InitRocksDBOptions(
     options->base_background_compactions = FLAGS_rocksdb_base_background_compactions;
     options->max_background_compactions = FLAGS_rocksdb_max_background_compactions;
     options->max_background_flushes = FLAGS_rocksdb_max_background_flushes;
+    if (FLAGS_rocksdb_max_subcompactions > 1) {
+      options->max_subcompactions = FLAGS_rocksdb_max_subcompactions;
+      // Compaction filter needs to see all keys of a document, so it could remove overwritten ones.
+      options->subcompaction_boundary_extractor.reset(NewDocKeyTransform());
+    }
     options->level0_file_num_compaction_trigger = FLAGS_rocksdb_level0_file_num_compaction_trigger;
     options->level0_slowdown_writes_trigger = FLAGS_rocksdb_level0_slowdown_writes_trigger;
     options->level0_stop_writes_trigger = FLAGS_rocksdb_level0_stop_writes_trigger;
@@ -367,7 +527,11 @@ void InitRocksDBOptions(
     options->compaction_options_universal.min_merge_width =
         FLAGS_rocksdb_universal_compaction_min_merge_width;
     options->compaction_size_threshold_bytes = FLAGS_rocksdb_compaction_size_threshold_bytes;
-    if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
+    options->priority_thread_pool_for_compactions_and_flushes =
+        tablet_options.priority_thread_pool_for_compactions_and_flushes;
+    if (tablet_options.rate_limiter) {
+      options->rate_limiter = tablet_options.rate_limiter;
+    } else if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
       options->rate_limiter.reset(
           rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
     }
@@ -377,6 +541,40 @@ void InitRocksDBOptions(
   if (max_file_size_for_compaction != 0) {
     options->max_file_size_for_compaction = max_file_size_for_compaction;
   }
+
+  if (FLAGS_rocksdb_compaction_direct_io) {
+    options->use_direct_io_for_compaction_reads = true;
+    options->use_direct_io_for_compaction_writes = true;
+    options->writable_file_max_buffer_size = std::max<int64_t>(
+        FLAGS_rocksdb_compaction_direct_io_buffer_size_bytes, kCompactionDirectIOAlignment);
+  }
+  int64_t compaction_readahead_size = FLAGS_rocksdb_compaction_readahead_size_bytes;
+  if (compaction_readahead_size == 0 && FLAGS_rocksdb_compaction_direct_io) {
+    compaction_readahead_size = kDefaultCompactionDirectIOReadaheadSize;
+  }
+  if (compaction_readahead_size > 0) {
+    options->compaction_readahead_size = compaction_readahead_size;
+  }
+}
+
+void InitRocksDBHashMemTableOptions(rocksdb::Options* options) {
+  options->memtable_prefix_extractor.reset(NewDocKeyHashedPartTransform());
+  options->memtable_factory.reset(rocksdb::NewHashSkipListRepFactory(
+      std::max<int64_t>(FLAGS_docdb_hash_memtable_bucket_count, 1)));
+  // Hash skip list memtable does not support concurrent inserts.
+  options->allow_concurrent_memtable_write = false;
+  options->enable_write_thread_adaptive_yield = false;
+}
+
+void InitRocksDBPointLookupOptions(rocksdb::Options* options) {
+  auto table_options = down_cast<rocksdb::BlockBasedTableFactory*>(
+      options->table_factory.get())->table_options();
+  table_options.index_type = rocksdb::BlockBasedTableOptions::kHashSearch;
+  // Only the hash index is prefix based, so iterators that span documents and the bloom filters
+  // keep working on whole keys.
+  table_options.hash_index_prefix_extractor.reset(NewDocKeyHashedPartTransform());
+  options->table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+  options->allow_mmap_reads = true;
 }
 
 }  // namespace docdb
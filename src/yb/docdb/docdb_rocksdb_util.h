@@ -21,6 +21,7 @@
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/statistics.h"
 
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/intent_aware_iterator.h"
@@ -47,9 +48,12 @@ Status SeekToValidKvAtTs(
 
 // See to a rocksdb point that is at least sub_doc_key.
 // If the iterator is already positioned far enough, does not perform a seek.
-void SeekForward(const rocksdb::Slice& slice, rocksdb::Iterator *iter);
+// If statistics is specified, it is used to track how many seeks were avoided by Next() calls.
+void SeekForward(const rocksdb::Slice& slice, rocksdb::Iterator *iter,
+                 rocksdb::Statistics* statistics = nullptr);
 
-void SeekForward(const KeyBytes& key_bytes, rocksdb::Iterator *iter);
+void SeekForward(const KeyBytes& key_bytes, rocksdb::Iterator *iter,
+                 rocksdb::Statistics* statistics = nullptr);
 
 // When we replace HybridTime::kMin in the end of seek key, next seek will skip older versions of
 // this key, but will not skip any subkeys in its subtree. If the iterator is already positioned far
@@ -58,12 +62,14 @@ void SeekPastSubKey(const SubDocKey& sub_doc_key, rocksdb::Iterator* iter);
 
 // A wrapper around the RocksDB seek operation that uses Next() up to the configured number of
 // times to avoid invalidating iterator state. In debug mode it also allows printing detailed
-// information about RocksDB seeks.
+// information about RocksDB seeks. If statistics is specified, the number of seeks avoided by
+// Next() calls and the number of seeks done after exhausting them are recorded there.
 void PerformRocksDBSeek(
     rocksdb::Iterator *iter,
     const rocksdb::Slice &seek_key,
     const char* file_name,
-    int line);
+    int line,
+    rocksdb::Statistics* statistics = nullptr);
 
 // TODO: is there too much overhead in passing file name and line here in release mode?
 #define ROCKSDB_SEEK(iter, key) \
@@ -71,6 +77,11 @@ void PerformRocksDBSeek(
     PerformRocksDBSeek((iter), (key), __FILE__, __LINE__); \
   } while (0)
 
+#define ROCKSDB_SEEK_WITH_STATISTICS(iter, key, statistics) \
+  do { \
+    PerformRocksDBSeek((iter), (key), __FILE__, __LINE__, (statistics)); \
+  } while (0)
+
 enum class BloomFilterMode {
   USE_BLOOM_FILTER,
   DONT_USE_BLOOM_FILTER,
@@ -108,6 +119,19 @@ void InitRocksDBOptions(
     const std::shared_ptr<rocksdb::Statistics>& statistics,
     const tablet::TabletOptions& tablet_options);
 
+// Switches the memtable of 'options' to a hash based one, with a bucket per hashed part of the
+// document key. Point reads and reads within one document, e.g. of a Redis hash or time series,
+// only look at a single bucket and stay ordered. Iterators that span documents see the keys in
+// total order, but have to merge all buckets, so it is only suitable for point lookup tables.
+void InitRocksDBHashMemTableOptions(rocksdb::Options* options);
+
+// Switches the SST files of 'options' to a hash index by the hashed part of the document key, read
+// through mmap, for tables that are only point read. Reads that use the bloom filter never leave
+// the document of their key, so they find its data blocks in one hash lookup instead of a binary
+// search of the index. All other reads do total order seeks with a binary search, as before.
+// Applies to the files written from then on, existing files are rewritten by compactions.
+void InitRocksDBPointLookupOptions(rocksdb::Options* options);
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -110,13 +110,13 @@ Status DocDBRocksDBUtil::PopulateRocksDBWriteBatch(
     HybridTime hybrid_time,
     bool decode_dockey,
     bool increment_write_id) const {
-  for (const auto& entry : dwb.key_value_pairs()) {
+  for (size_t i = 0; i != dwb.size(); ++i) {
     if (decode_dockey) {
       SubDocKey subdoc_key;
       // We don't expect any invalid encoded keys in the write batch. However, these encoded keys
       // don't contain the HybridTime.
-      RETURN_NOT_OK_PREPEND(subdoc_key.FullyDecodeFromKeyWithoutHybridTime(entry.first),
-          Substitute("when decoding key: $0", FormatBytesAsStr(entry.first)));
+      RETURN_NOT_OK_PREPEND(subdoc_key.FullyDecodeFromKeyWithoutHybridTime(dwb.key(i)),
+          Substitute("when decoding key: $0", FormatBytesAsStr(dwb.key(i).ToBuffer())));
     }
   }
 
@@ -133,19 +133,17 @@ Status DocDBRocksDBUtil::PopulateRocksDBWriteBatch(
     // TODO: this block has common code with docdb::PrepareNonTransactionWriteBatch and probably
     // can be refactored, so common code is reused.
     IntraTxnWriteId write_id = 0;
-    for (const auto& entry : dwb.key_value_pairs()) {
-      string rocksdb_key;
+    for (size_t i = 0; i != dwb.size(); ++i) {
+      string rocksdb_key = dwb.key(i).ToBuffer();
       if (hybrid_time.is_valid()) {
         // HybridTime provided. Append a PrimitiveValue with the HybridTime to the key.
         const KeyBytes encoded_ht =
             PrimitiveValue(DocHybridTime(hybrid_time, write_id)).ToKeyBytes();
-        rocksdb_key = entry.first + encoded_ht.data();
-      } else {
-        // Useful when printing out a write batch that does not yet know the HybridTime it will be
-        // committed with.
-        rocksdb_key = entry.first;
+        rocksdb_key += encoded_ht.data();
       }
-      rocksdb_write_batch->Put(rocksdb_key, entry.second);
+      // Without a HybridTime the key is written as is. Useful when printing out a write batch that
+      // does not yet know the HybridTime it will be committed with.
+      rocksdb_write_batch->Put(rocksdb_key, dwb.value(i));
       if (increment_write_id) {
         ++write_id;
       }
@@ -0,0 +1,114 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/document_cache.h"
+#include "yb/docdb/value.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+std::string EncodedKey(const std::string& key) {
+  return DocKey::FromRedisKey(0, key).Encode().data();
+}
+
+SubDocument Hash(const std::string& field, const std::string& value) {
+  SubDocument doc;
+  doc.SetChildPrimitive(PrimitiveValue(field), PrimitiveValue(value));
+  return doc;
+}
+
+void WriteField(const std::string& key, const std::string& field, KeyValueWriteBatchPB* batch) {
+  auto* pair = batch->add_kv_pairs();
+  pair->set_key(SubDocKey(DocKey::FromRedisKey(0, key), PrimitiveValue(field)).Encode().data());
+  pair->set_value(Value(PrimitiveValue("value")).Encode());
+}
+
+} // namespace
+
+class DocumentCacheTest : public YBTest {
+ protected:
+  std::shared_ptr<MemTracker> mem_tracker_ = MemTracker::CreateTracker(-1, "test");
+};
+
+TEST_F(DocumentCacheTest, Validity) {
+  DocumentCache cache(1024 * 1024, mem_tracker_);
+  const auto key = EncodedKey("key");
+
+  cache.Put(key, Hash("f", "1"), HybridTime(1000));
+  ASSERT_EQ(nullptr, cache.Get(key, HybridTime(999)));
+  auto doc = cache.Get(key, HybridTime(2000));
+  ASSERT_NE(nullptr, doc);
+  ASSERT_EQ(Hash("f", "1"), *doc);
+  ASSERT_GT(mem_tracker_->consumption(), 0);
+
+  // A write to the document evicts it.
+  KeyValueWriteBatchPB batch;
+  WriteField("key", "f", &batch);
+  cache.Apply(batch, HybridTime(3000));
+  ASSERT_EQ(nullptr, cache.Get(key, HybridTime(3000)));
+
+  // The document read before the write could be stale.
+  cache.Put(key, Hash("f", "1"), HybridTime(2500));
+  ASSERT_EQ(nullptr, cache.Get(key, HybridTime(4000)));
+
+  cache.Put(key, Hash("f", "2"), HybridTime(3000));
+  doc = cache.Get(key, HybridTime(4000));
+  ASSERT_NE(nullptr, doc);
+  ASSERT_EQ(Hash("f", "2"), *doc);
+
+  // Writes to other documents do not affect it.
+  batch.Clear();
+  WriteField("other", "f", &batch);
+  cache.Apply(batch, HybridTime(5000));
+  ASSERT_NE(nullptr, cache.Get(key, HybridTime(5000)));
+
+  cache.Clear();
+  ASSERT_EQ(0, cache.size());
+  ASSERT_EQ(0, mem_tracker_->consumption());
+}
+
+TEST_F(DocumentCacheTest, Eviction) {
+  constexpr size_t kCapacity = 64 * 1024;
+  auto cache_parent = MemTracker::CreateTracker(kCapacity, "cache_parent", mem_tracker_);
+  {
+    DocumentCache cache(1024 * 1024, cache_parent);
+    const std::string value(128, 'x');
+    for (int i = 0; i != 1000; ++i) {
+      cache.Put(EncodedKey(std::to_string(i)), Hash("f", value), HybridTime(1000));
+    }
+    // The limit of the parent tracker bounds the cache.
+    ASSERT_LE(cache_parent->consumption(), kCapacity);
+    ASSERT_GT(cache.size(), 0);
+    ASSERT_LT(cache.size(), 1000);
+    // The most recently used documents are kept.
+    ASSERT_NE(nullptr, cache.Get(EncodedKey("999"), HybridTime(1000)));
+    ASSERT_EQ(nullptr, cache.Get(EncodedKey("0"), HybridTime(1000)));
+
+    // Documents that would take a large part of the cache are not kept.
+    cache.Put(EncodedKey("large"), Hash("f", std::string(128 * 1024, 'x')), HybridTime(1000));
+    ASSERT_EQ(nullptr, cache.Get(EncodedKey("large"), HybridTime(1000)));
+  }
+  ASSERT_EQ(0, cache_parent->consumption());
+}
+
+} // namespace docdb
+} // namespace yb
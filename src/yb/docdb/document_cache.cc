@@ -0,0 +1,157 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/document_cache.h"
+
+#include <algorithm>
+
+#include "yb/docdb/doc_key.h"
+#include "yb/util/mem_tracker.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Documents that would take a noticeable part of the cache are not worth keeping.
+constexpr size_t kMaxEntryFraction = 16;
+
+// Approximate memory overhead of an entry and of a child of a document, besides their contents.
+constexpr size_t kEntryOverhead = sizeof(std::string) + sizeof(HybridTime) + 96;
+constexpr size_t kChildOverhead = 48;
+
+size_t ApproximateSize(const PrimitiveValue& value) {
+  return sizeof(PrimitiveValue) + (value.IsString() ? value.GetString().size() : 0);
+}
+
+size_t ApproximateSize(const SubDocument& doc) {
+  size_t result = ApproximateSize(static_cast<const PrimitiveValue&>(doc));
+  if (IsObjectType(doc.value_type())) {
+    for (const auto& child : doc.object_container()) {
+      result += kChildOverhead + ApproximateSize(child.first) + ApproximateSize(child.second);
+    }
+  } else if (doc.value_type() == ValueType::kArray) {
+    for (const auto& element : doc.array_container()) {
+      result += ApproximateSize(element);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+DocumentCache::DocumentCache(
+    size_t capacity_bytes, const std::shared_ptr<MemTracker>& parent_mem_tracker)
+    : capacity_bytes_(capacity_bytes),
+      mem_tracker_(MemTracker::CreateTracker(capacity_bytes, "DocumentCache", parent_mem_tracker)) {
+  write_times_.fill(HybridTime::kMin);
+}
+
+DocumentCache::~DocumentCache() {
+  Clear();
+  mem_tracker_->UnregisterFromParent();
+}
+
+void DocumentCache::Apply(const KeyValueWriteBatchPB& put_batch, HybridTime hybrid_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& kv_pair : put_batch.kv_pairs()) {
+    Slice key = kv_pair.key();
+    auto doc_key_size = DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY);
+    if (!doc_key_size.ok()) {
+      // Should not happen, but we could not tell which document is modified.
+      LOG(DFATAL) << "Failed to decode document key: " << doc_key_size.status();
+      ClearUnlocked();
+      write_times_.fill(hybrid_time);
+      return;
+    }
+    const Slice doc_key(key.data(), *doc_key_size);
+    auto& write_time = write_times_[WriteTimeBucket(doc_key)];
+    write_time = std::max(write_time, hybrid_time);
+    Erase(doc_key);
+  }
+}
+
+std::shared_ptr<const SubDocument> DocumentCache::Get(
+    const Slice& encoded_doc_key, HybridTime read_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(encoded_doc_key);
+  if (it == index_.end() || it->second->read_time > read_time) {
+    return nullptr;
+  }
+  entries_.splice(entries_.end(), entries_, it->second);
+  return it->second->doc;
+}
+
+void DocumentCache::Put(const Slice& encoded_doc_key, SubDocument doc, HybridTime read_time) {
+  const size_t size = kEntryOverhead + encoded_doc_key.size() + ApproximateSize(doc);
+  if (size * kMaxEntryFraction > capacity_bytes_) {
+    return;
+  }
+  auto shared_doc = std::make_shared<const SubDocument>(std::move(doc));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (read_time < write_times_[WriteTimeBucket(encoded_doc_key)]) {
+    return;
+  }
+  auto it = index_.find(encoded_doc_key);
+  if (it != index_.end()) {
+    if (it->second->read_time >= read_time) {
+      return;
+    }
+    EraseEntry(it->second);
+  }
+  while (!mem_tracker_->TryConsume(size)) {
+    if (entries_.empty()) {
+      return;
+    }
+    EraseEntry(entries_.begin());
+  }
+  entries_.push_back(Entry{encoded_doc_key.ToBuffer(), std::move(shared_doc), read_time, size});
+  index_.emplace(Slice(entries_.back().key), std::prev(entries_.end()));
+}
+
+void DocumentCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ClearUnlocked();
+}
+
+size_t DocumentCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t DocumentCache::WriteTimeBucket(const Slice& encoded_doc_key) {
+  return Slice::Hash()(encoded_doc_key) % kNumWriteTimeBuckets;
+}
+
+void DocumentCache::Erase(const Slice& key) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+void DocumentCache::EraseEntry(Entries::iterator it) {
+  mem_tracker_->Release(it->size);
+  index_.erase(Slice(it->key));
+  entries_.erase(it);
+}
+
+void DocumentCache::ClearUnlocked() {
+  while (!entries_.empty()) {
+    EraseEntry(entries_.begin());
+  }
+}
+
+} // namespace docdb
+} // namespace yb
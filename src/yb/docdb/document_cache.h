@@ -0,0 +1,104 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_DOCUMENT_CACHE_H_
+#define YB_DOCDB_DOCUMENT_CACHE_H_
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/docdb/docdb.pb.h"
+#include "yb/docdb/subdocument.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+
+class MemTracker;
+
+namespace docdb {
+
+// Bounded cache of small whole documents of a tablet, assembled from RocksDB by previous reads.
+//
+// A document read at some hybrid time is the latest version of the document, unless a write to it
+// was applied after the read started. Writes are applied in hybrid time order and reads wait for
+// the writes below their read time, so a cached document could be used by any read at or after
+// the time it was read at, until the next write to the document evicts it. To detect writes that
+// raced with the read, the cache remembers the latest write time of each of a fixed number of key
+// buckets, and does not accept documents read before the latest write to their bucket.
+//
+// Documents with TTL are not cached, since what is visible depends on the read time.
+//
+// Memory used by the cache is accounted by its own MemTracker. When the tracker or one of its
+// ancestors reaches its limit, least recently used documents are evicted.
+//
+// This class is thread-safe.
+class DocumentCache {
+ public:
+  // capacity_bytes - approximate limit of total size of cached documents.
+  DocumentCache(size_t capacity_bytes, const std::shared_ptr<MemTracker>& parent_mem_tracker);
+  ~DocumentCache();
+
+  // Evicts documents modified by the write batch applied at the specified hybrid time.
+  void Apply(const KeyValueWriteBatchPB& put_batch, HybridTime hybrid_time);
+
+  // Returns the cached document for the specified encoded document key (without a hybrid time),
+  // when it is known to be the document visible at read_time, nullptr otherwise.
+  std::shared_ptr<const SubDocument> Get(const Slice& encoded_doc_key, HybridTime read_time);
+
+  // Caches the document that was read at read_time. Ignored when a write to the document could
+  // have been applied after the read started. Objects and arrays of the document should have
+  // children.
+  void Put(const Slice& encoded_doc_key, SubDocument doc, HybridTime read_time);
+
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const SubDocument> doc;
+    HybridTime read_time;
+    size_t size;
+  };
+
+  typedef std::list<Entry> Entries;
+
+  static constexpr size_t kNumWriteTimeBuckets = 1024;
+
+  static size_t WriteTimeBucket(const Slice& encoded_doc_key);
+
+  void Erase(const Slice& key);
+  void EraseEntry(Entries::iterator it);
+  void ClearUnlocked();
+
+  const size_t capacity_bytes_;
+  std::shared_ptr<MemTracker> mem_tracker_;
+
+  mutable std::mutex mutex_;
+  // Entries in least recently used first order.
+  Entries entries_;
+  std::unordered_map<Slice, Entries::iterator, Slice::Hash> index_;
+  // Latest hybrid time of writes applied to the documents of each bucket.
+  std::array<HybridTime, kNumWriteTimeBuckets> write_times_;
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif  // YB_DOCDB_DOCUMENT_CACHE_H_
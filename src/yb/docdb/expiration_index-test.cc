@@ -0,0 +1,112 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/expiration_index.h"
+#include "yb/docdb/value.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+constexpr uint64_t kSecond = 1000000;
+
+HybridTime TimeAtSecond(uint64_t second) {
+  return HybridTime::FromMicros(second * kSecond);
+}
+
+std::string EncodedKey(const std::string& key, uint64_t write_second) {
+  return SubDocKey(DocKey::FromRedisKey(0, key), TimeAtSecond(write_second)).Encode().data();
+}
+
+class ExpirationIndexTest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+    collector_.reset(ExpirationIndexCollectorFactory()->CreateTablePropertiesCollector(
+        rocksdb::TablePropertiesCollectorFactory::Context()));
+  }
+
+  // Adds record to the index, returns its size.
+  size_t Add(const std::string& key, const Value& value) {
+    const auto encoded_value = value.Encode();
+    EXPECT_OK(collector_->AddUserKey(key, encoded_value, rocksdb::kEntryPut, 0, 0));
+    return key.size() + encoded_value.size();
+  }
+
+  rocksdb::UserCollectedProperties Finish() {
+    rocksdb::UserCollectedProperties properties;
+    EXPECT_OK(collector_->Finish(&properties));
+    return properties;
+  }
+
+  std::unique_ptr<rocksdb::TablePropertiesCollector> collector_;
+};
+
+} // namespace
+
+TEST_F(ExpirationIndexTest, Simple) {
+  const auto a_size = Add(EncodedKey("a", 100),
+                          Value(PrimitiveValue("1"), MonoDelta::FromSeconds(10)));
+  const auto b_size = Add(EncodedKey("b", 100),
+                          Value(PrimitiveValue("2"), MonoDelta::FromSeconds(20)));
+  const auto deleted_size = Add(EncodedKey("c", 105), Value(PrimitiveValue(ValueType::kTombstone)));
+  Add(EncodedKey("d", 100), Value(PrimitiveValue("3")));
+
+  const auto properties = Finish();
+  ASSERT_EQ(0, ExpiredBytes(properties, TimeAtSecond(104)));
+  ASSERT_EQ(deleted_size, ExpiredBytes(properties, TimeAtSecond(105)));
+  ASSERT_EQ(deleted_size, ExpiredBytes(properties, TimeAtSecond(109)));
+  ASSERT_EQ(deleted_size + a_size, ExpiredBytes(properties, TimeAtSecond(110)));
+  // Record without TTL never expires.
+  ASSERT_EQ(deleted_size + a_size + b_size, ExpiredBytes(properties, TimeAtSecond(1000000)));
+
+  ASSERT_EQ(0, ExpiredBytes(rocksdb::UserCollectedProperties(), TimeAtSecond(1000000)));
+}
+
+TEST_F(ExpirationIndexTest, ManyExpirationTimes) {
+  constexpr uint64_t kRecords = 10000;
+  std::vector<uint64_t> expired_by(kRecords + 1);
+  for (uint64_t i = 0; i != kRecords; ++i) {
+    // Record written at second 1000 + i expires at second 1000 + 2 * i.
+    expired_by[i + 1] = expired_by[i] + Add(EncodedKey(std::to_string(i), 1000 + i),
+                                            Value(PrimitiveValue("v"), MonoDelta::FromSeconds(i)));
+  }
+  const auto total = expired_by.back();
+
+  const auto properties = Finish();
+  ASSERT_EQ(0, ExpiredBytes(properties, TimeAtSecond(999)));
+  for (uint64_t i = 0; i != kRecords; i += 97) {
+    // Records up to i expired by second 1000 + 2 * i.
+    const auto actual = expired_by[i + 1];
+    const auto estimate = ExpiredBytes(properties, TimeAtSecond(1000 + 2 * i));
+    ASSERT_LE(estimate, actual) << "i: " << i;
+    // Index is a list of 64 points with almost the same amount of data between them, and
+    // expiration times were rounded up to 64 seconds, i.e. 32 records, while collecting.
+    const auto window = actual - expired_by[i + 1 > 64 ? i + 1 - 64 : 0];
+    ASSERT_GE(estimate + total / 64 + window, actual) << "i: " << i;
+  }
+  ASSERT_EQ(total, ExpiredBytes(properties, TimeAtSecond(1000000)));
+}
+
+} // namespace docdb
+} // namespace yb
@@ -0,0 +1,185 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/expiration_index.h"
+
+#include <map>
+#include <string>
+
+#include "yb/common/doc_hybrid_time.h"
+#include "yb/docdb/doc_kv_util.h"
+#include "yb/docdb/value.h"
+#include "yb/docdb/value_type.h"
+#include "yb/rocksdb/util/coding.h"
+#include "yb/server/hybrid_clock.h"
+
+namespace yb {
+namespace docdb {
+
+const char* const kExpirationIndexProperty = "yb.expiration_index";
+
+namespace {
+
+// Max number of expiration time buckets kept while a file is being built.
+constexpr size_t kMaxBuckets = 1024;
+// Max number of points stored in the index of a file.
+constexpr size_t kMaxPoints = 64;
+constexpr uint64_t kInitialBucketMicros = 1000000;
+
+uint64_t PhysicalMicros(HybridTime hybrid_time) {
+  return server::HybridClock::GetPhysicalValueMicros(hybrid_time);
+}
+
+// Returns expiration time of the record, or HybridTime::kMax if it is not accounted by the index.
+HybridTime RecordExpiration(Slice key, Slice value) {
+  if (key.empty() || static_cast<ValueType>(key[0]) == ValueType::kIntentPrefix) {
+    // Provisional records of transactions are removed explicitly.
+    return HybridTime::kMax;
+  }
+  DocHybridTime doc_ht;
+  ValueType value_type;
+  MonoDelta ttl;
+  if (!doc_ht.DecodeFromEnd(key).ok() ||
+      !Value::DecodePrimitiveValueType(value, &value_type).ok() ||
+      !Value::DecodeTTL(value, &ttl).ok()) {
+    return HybridTime::kMax;
+  }
+  if (value_type == ValueType::kTombstone) {
+    return doc_ht.hybrid_time();
+  }
+  if (ttl.Equals(Value::kMaxTtl) || ttl.ToMilliseconds() == kResetTTL) {
+    return HybridTime::kMax;
+  }
+  return ExpirationTime(doc_ht.hybrid_time(), ttl);
+}
+
+class ExpirationIndexCollector : public rocksdb::TablePropertiesCollector {
+ public:
+  Status AddUserKey(const Slice& key, const Slice& value, rocksdb::EntryType type,
+                    rocksdb::SequenceNumber seq, uint64_t file_size) override {
+    const HybridTime expiration = RecordExpiration(key, value);
+    if (expiration != HybridTime::kMax) {
+      Add(PhysicalMicros(expiration), key.size() + value.size());
+    }
+    return Status::OK();
+  }
+
+  // Stored as varint encoded pairs of deltas of expiration time in microseconds and of the
+  // total size of records that expire by this time.
+  Status Finish(rocksdb::UserCollectedProperties* properties) override {
+    if (buckets_.empty()) {
+      return Status::OK();
+    }
+    std::string encoded;
+    uint64_t prev_micros = 0;
+    uint64_t prev_bytes = 0;
+    uint64_t bytes = 0;
+    size_t point = 1;
+    for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+      bytes += it->second;
+      if (bytes * kMaxPoints >= total_bytes_ * point || std::next(it) == buckets_.end()) {
+        rocksdb::PutVarint64(&encoded, it->first - prev_micros);
+        rocksdb::PutVarint64(&encoded, bytes - prev_bytes);
+        prev_micros = it->first;
+        prev_bytes = bytes;
+        while (bytes * kMaxPoints >= total_bytes_ * point) {
+          ++point;
+        }
+      }
+    }
+    properties->emplace(kExpirationIndexProperty, std::move(encoded));
+    return Status::OK();
+  }
+
+  rocksdb::UserCollectedProperties GetReadableProperties() const override {
+    return {{"yb.expiring_bytes", std::to_string(total_bytes_)}};
+  }
+
+  const char* Name() const override {
+    return "ExpirationIndexCollector";
+  }
+
+ private:
+  void Add(uint64_t micros, uint64_t bytes) {
+    // Expiration is rounded up, so the index never reports a record as expired before it did.
+    buckets_[RoundUp(micros)] += bytes;
+    total_bytes_ += bytes;
+    if (buckets_.size() > kMaxBuckets) {
+      Coarsen();
+    }
+  }
+
+  uint64_t RoundUp(uint64_t micros) const {
+    return (micros / bucket_micros_ + (micros % bucket_micros_ != 0)) * bucket_micros_;
+  }
+
+  void Coarsen() {
+    while (buckets_.size() > kMaxBuckets / 2) {
+      bucket_micros_ *= 2;
+      std::map<uint64_t, uint64_t> buckets;
+      for (const auto& bucket : buckets_) {
+        buckets[RoundUp(bucket.first)] += bucket.second;
+      }
+      buckets_.swap(buckets);
+    }
+  }
+
+  uint64_t bucket_micros_ = kInitialBucketMicros;
+  uint64_t total_bytes_ = 0;
+  // Total size of records by their rounded expiration time in microseconds.
+  std::map<uint64_t, uint64_t> buckets_;
+};
+
+class ExpirationIndexCollectorFactoryImpl : public rocksdb::TablePropertiesCollectorFactory {
+ public:
+  rocksdb::TablePropertiesCollector* CreateTablePropertiesCollector(
+      rocksdb::TablePropertiesCollectorFactory::Context context) override {
+    return new ExpirationIndexCollector();
+  }
+
+  const char* Name() const override {
+    return "ExpirationIndexCollectorFactory";
+  }
+};
+
+} // namespace
+
+std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> ExpirationIndexCollectorFactory() {
+  static std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> instance =
+      std::make_shared<ExpirationIndexCollectorFactoryImpl>();
+  return instance;
+}
+
+uint64_t ExpiredBytes(const rocksdb::UserCollectedProperties& properties, HybridTime time) {
+  auto it = properties.find(kExpirationIndexProperty);
+  if (it == properties.end()) {
+    return 0;
+  }
+  const uint64_t time_micros = PhysicalMicros(time);
+  Slice encoded(it->second);
+  uint64_t micros = 0;
+  uint64_t result = 0;
+  uint64_t micros_delta, bytes_delta;
+  while (rocksdb::GetVarint64(&encoded, &micros_delta) &&
+         rocksdb::GetVarint64(&encoded, &bytes_delta)) {
+    micros += micros_delta;
+    if (micros > time_micros) {
+      break;
+    }
+    result += bytes_delta;
+  }
+  return result;
+}
+
+} // namespace docdb
+} // namespace yb
@@ -0,0 +1,44 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_EXPIRATION_INDEX_H
+#define YB_DOCDB_EXPIRATION_INDEX_H
+
+#include <memory>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/rocksdb/table_properties.h"
+
+namespace yb {
+namespace docdb {
+
+// Name of the user collected table property of an SST file that keeps its expiration index.
+extern const char* const kExpirationIndexProperty;
+
+// Collects expiration index of each SST file, i.e. the amount of data in the file that expires by
+// a given time. Values with their own TTL expire at their write time plus TTL, and tombstones are
+// accounted at their write time, since they are removed together with the values they hide.
+// Values that could only expire by the table TTL are not accounted.
+//
+// The index is a short list of expiration times with the total size of records that expire by
+// each of them, so it is cheap to keep for every file and to check it periodically.
+std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> ExpirationIndexCollectorFactory();
+
+// Returns the total size of records of an SST file with the specified properties, that expired by
+// the specified time. The estimate never exceeds the actual amount of expired data.
+uint64_t ExpiredBytes(const rocksdb::UserCollectedProperties& properties, HybridTime time);
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_EXPIRATION_INDEX_H
@@ -170,8 +170,14 @@ bool DebugHasHybridTime(const Slice& subdoc_key_encoded) {
   return subdoc_key.has_hybrid_time();
 }
 
+thread_local uint64_t intent_seek_count = 0;
+
 } // namespace
 
+uint64_t ThreadIntentSeekCount() {
+  return intent_seek_count;
+}
+
 Status IntentAwareIterator::Seek(const DocKey &doc_key, const HybridTime &hybrid_time) {
   if (intent_iter_) {
     RETURN_NOT_OK(
@@ -190,7 +196,7 @@ Status IntentAwareIterator::SeekWithoutHt(const KeyBytes& key_bytes) {
       key_bytes.ToString(),
       std::bind(&IntentAwareIterator::DebugDump, this));
   if (intent_iter_) {
-    ROCKSDB_SEEK(intent_iter_.get(), GetIntentPrefixForKeyWithoutHt(key_bytes).AsSlice());
+    SeekIntentIter(GetIntentPrefixForKeyWithoutHt(key_bytes));
     RETURN_NOT_OK(SeekForwardToSuitableIntent());
   }
   SeekRegular(key_bytes);
@@ -203,7 +209,7 @@ Status IntentAwareIterator::SeekForwardWithoutHt(const KeyBytes& key_bytes) {
       std::bind(&IntentAwareIterator::DebugDump, this));
   if (intent_iter_
       && (!has_resolved_intent_ || key_bytes.CompareTo(resolved_intent_sub_doc_key_encoded_) > 0)) {
-    docdb::SeekForward(GetIntentPrefixForKeyWithoutHt(key_bytes), intent_iter_.get());
+    SeekForwardIntentIter(GetIntentPrefixForKeyWithoutHt(key_bytes));
     RETURN_NOT_OK(SeekForwardToSuitableIntent());
   }
   SeekForwardRegular(key_bytes);
@@ -230,7 +236,9 @@ Status IntentAwareIterator::SeekPastSubKey(const SubDocKey& subdoc_key) {
     intent_prefix.mutable_data()->push_back(static_cast<char>(ValueType::kIntentType) + 1);
     RETURN_NOT_OK(SeekToSuitableIntent(intent_prefix, HybridTime::kMax, true));
   }
-  docdb::SeekPastSubKey(subdoc_key, iter_.get());
+  KeyBytes key_bytes = subdoc_key.Encode(/* include_hybrid_time */ false);
+  AppendDocHybridTime(DocHybridTime::kMin, &key_bytes);
+  SeekForwardRegular(key_bytes);
   return Status::OK();
 }
 
@@ -281,11 +289,21 @@ Slice IntentAwareIterator::value() {
 }
 
 void IntentAwareIterator::SeekRegular(const KeyBytes& key_bytes) {
-  ROCKSDB_SEEK(iter_.get(), key_bytes.AsSlice());
+  ROCKSDB_SEEK_WITH_STATISTICS(iter_.get(), key_bytes.AsSlice(), statistics_);
 }
 
 void IntentAwareIterator::SeekForwardRegular(const KeyBytes& key_bytes) {
-  docdb::SeekForward(key_bytes, iter_.get());
+  docdb::SeekForward(key_bytes, iter_.get(), statistics_);
+}
+
+void IntentAwareIterator::SeekIntentIter(const KeyBytes& key_bytes) {
+  ++intent_seek_count;
+  ROCKSDB_SEEK_WITH_STATISTICS(intent_iter_.get(), key_bytes.AsSlice(), statistics_);
+}
+
+void IntentAwareIterator::SeekForwardIntentIter(const KeyBytes& key_bytes) {
+  ++intent_seek_count;
+  docdb::SeekForward(key_bytes, intent_iter_.get(), statistics_);
 }
 
 Status IntentAwareIterator::ProcessIntent(const HybridTime& high_ht) {
@@ -336,7 +354,7 @@ Status IntentAwareIterator::SeekToSuitableIntent(const KeyBytes &intent_key_pref
   // just in case.
   // TODO(dtxn): can be optimized to seek forward in case intent_key_prefix is different than
   // resolved_intent_key_prefix_.
-  ROCKSDB_SEEK(intent_iter_.get(), intent_key_prefix.AsSlice());
+  SeekIntentIter(intent_key_prefix);
 
   has_resolved_intent_ = false;
   resolved_intent_txn_dht_ = DocHybridTime::kMin;
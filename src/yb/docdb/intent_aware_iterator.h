@@ -47,8 +47,11 @@ class IntentAwareIterator {
       HybridTime high_ht,
       const TransactionOperationContextOpt& txn_op_context)
       : high_ht_(high_ht), txn_op_context_(txn_op_context),
+        statistics_(rocksdb->GetOptions().statistics.get()),
+        use_intents_(txn_op_context.is_initialized() &&
+                     txn_op_context->txn_status_provider.MayHaveIntents()),
         iter_(rocksdb->NewIterator(read_opts)),
-        intent_iter_(txn_op_context.is_initialized() ? rocksdb->NewIterator(read_opts) : nullptr) {
+        intent_iter_(use_intents_ ? rocksdb->NewIterator(read_opts) : nullptr) {
   }
   IntentAwareIterator(const IntentAwareIterator& other) = delete;
   void operator=(const IntentAwareIterator& other) = delete;
@@ -95,7 +98,13 @@ class IntentAwareIterator {
       DocHybridTime* max_deleted_ts,
       Value* result_value);
 
+  // Statistics of the underlying RocksDB, used by the readers to record what they skip.
+  rocksdb::Statistics* statistics() const { return statistics_; }
+
  private:
+  // All seeks on sub-iterators first try up to FLAGS_max_nexts_to_avoid_seek Next() calls when the
+  // iterator is positioned before the target, and only then fall back to an actual Seek().
+
   // Seek on regular sub-iterator. Regular key-value pairs are final non-intent values written to
   // RocksDB either directly bypassing cross-shard transactions or already resolved from intents
   // during intents cleanup.
@@ -104,6 +113,12 @@ class IntentAwareIterator {
   // Seek forward on regular sub-iterator.
   void SeekForwardRegular(const KeyBytes& key_bytes);
 
+  // Seek intent sub-iterator to the specified key.
+  void SeekIntentIter(const KeyBytes& key_bytes);
+
+  // Seek forward on intent sub-iterator.
+  void SeekForwardIntentIter(const KeyBytes& key_bytes);
+
   // Strong write intents which are either committed or written by the current
   // transaction (stored in txn_op_context) by considered time are considered as suitable.
 
@@ -147,6 +162,11 @@ class IntentAwareIterator {
 
   const HybridTime high_ht_; // Ignoring values with higher HT.
   const TransactionOperationContextOpt txn_op_context_;
+  // Used to track how often bounded Next() calls allow us to avoid an actual seek.
+  rocksdb::Statistics* const statistics_;
+  // Whether the intent sub-iterator is needed. It is not created when the tablet is known to have
+  // no intents, so transactional reads on such tablets cost the same as non-transactional ones.
+  const bool use_intents_;
   std::unique_ptr<rocksdb::Iterator> iter_;
   std::unique_ptr<rocksdb::Iterator> intent_iter_;
 
@@ -161,6 +181,10 @@ class IntentAwareIterator {
   KeyBytes resolved_intent_value_;
 };
 
+// Number of seeks of intent sub-iterators made by the current thread so far. The difference of two
+// values attributes lookups of provisional records to the operation the thread did in between.
+uint64_t ThreadIntentSeekCount();
+
 } // namespace docdb
 } // namespace yb
 
@@ -46,10 +46,14 @@ using yb::util::FastDecodeSignedVarInt;
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED; \
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED; \
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED; \
+    case ValueType::kTableId: FALLTHROUGH_INTENDED; \
     case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED; \
     case ValueType::kObject: FALLTHROUGH_INTENDED; \
     case ValueType::kRedisSet: FALLTHROUGH_INTENDED; \
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED; \
+    case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED; \
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED; \
+    case ValueType::kRedisTSBlocks: FALLTHROUGH_INTENDED; \
     case ValueType::kTtl: FALLTHROUGH_INTENDED; \
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED; \
     case ValueType::kTombstone: \
@@ -100,6 +104,8 @@ string PrimitiveValue::ToString() const {
     case ValueType::kInt64Descending: FALLTHROUGH_INTENDED;
     case ValueType::kInt64:
       return std::to_string(int64_val_);
+    case ValueType::kInt64Delta:
+      return Substitute("Int64Delta($0)", int64_val_);
     case ValueType::kFloatDescending: FALLTHROUGH_INTENDED;
     case ValueType::kFloat:
       return RealToString(float_val_);
@@ -155,8 +161,22 @@ string PrimitiveValue::ToString() const {
       return "{}";
     case ValueType::kRedisSet:
       return "()";
+    case ValueType::kRedisSortedSet:
+      return "(<>)";
+    case ValueType::kRedisList:
+      return "[<>]";
+    case ValueType::kSSForward:
+      return "SSForward";
+    case ValueType::kRedisCardinality:
+      return "RedisCardinality";
+    case ValueType::kRedisListBounds:
+      return "RedisListBounds";
+    case ValueType::kSSReverse:
+      return "SSReverse";
     case ValueType::kRedisTS:
       return "<>";
+    case ValueType::kRedisTSBlocks:
+      return "</>";
     case ValueType::kTombstone:
       return "DEL";
     case ValueType::kArray:
@@ -169,7 +189,8 @@ string PrimitiveValue::ToString() const {
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
-    case ValueType::kIntentPrefix:
+    case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTableId:
       break;
     case ValueType::kLowest:
       return "-Inf";
@@ -189,6 +210,10 @@ void PrimitiveValue::AppendToKey(KeyBytes* key_bytes) const {
     case ValueType::kMaxByte: return;
     case ValueType::kNullDescending: return;
     case ValueType::kNull: return;
+    case ValueType::kSSForward: return;
+    case ValueType::kRedisCardinality: return;
+    case ValueType::kRedisListBounds: return;
+    case ValueType::kSSReverse: return;
     case ValueType::kFalse: return;
     case ValueType::kTrue: return;
 
@@ -311,6 +336,9 @@ void PrimitiveValue::AppendToKey(KeyBytes* key_bytes) const {
       key_bytes->AppendIntentType(static_cast<IntentType>(uint16_val_));
       return;
 
+    case ValueType::kInt64Delta:
+      break;
+
     IGNORE_NON_PRIMITIVE_VALUE_TYPES_IN_SWITCH;
   }
   FATAL_INVALID_ENUM_VALUE(ValueType, type_);
@@ -328,6 +356,9 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kObject: FALLTHROUGH_INTENDED;
     case ValueType::kArray: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisTSBlocks: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSet: return result;
 
     case ValueType::kStringDescending: FALLTHROUGH_INTENDED;
@@ -342,7 +373,8 @@ string PrimitiveValue::ToValue() const {
       return result;
 
     case ValueType::kInt64Descending: FALLTHROUGH_INTENDED;
-    case ValueType::kInt64:
+    case ValueType::kInt64: FALLTHROUGH_INTENDED;
+    case ValueType::kInt64Delta:
       AppendBigEndianUInt64(int64_val_, &result);
       return result;
 
@@ -417,6 +449,11 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED;
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTableId: FALLTHROUGH_INTENDED;
+    case ValueType::kSSForward: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisCardinality: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListBounds: FALLTHROUGH_INTENDED;
+    case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
     case ValueType::kColumnId: FALLTHROUGH_INTENDED;
@@ -459,6 +496,10 @@ Status PrimitiveValue::DecodeKey(rocksdb::Slice* slice, PrimitiveValue* out) {
   switch (value_type) {
     case ValueType::kNullDescending: FALLTHROUGH_INTENDED;
     case ValueType::kNull: FALLTHROUGH_INTENDED;
+    case ValueType::kSSForward: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisCardinality: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListBounds: FALLTHROUGH_INTENDED;
+    case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kHighest: FALLTHROUGH_INTENDED;
@@ -530,20 +571,21 @@ Status PrimitiveValue::DecodeKey(rocksdb::Slice* slice, PrimitiveValue* out) {
 
     case ValueType::kDecimalDescending: FALLTHROUGH_INTENDED;
     case ValueType::kDecimal: {
-      util::Decimal decimal;
-      Slice slice_temp(slice->data(), slice->size());
-      size_t num_decoded_bytes = 0;
-      RETURN_NOT_OK(decimal.DecodeFromComparable(slice_temp, &num_decoded_bytes));
-      if (value_type == ValueType::kDecimalDescending) {
+      auto num_decoded_bytes = util::DecimalComparableEncodedSize(*slice);
+      RETURN_NOT_OK(num_decoded_bytes);
+      if (out) {
+        // The comparable encoding is canonical, so it is kept as is.
+        new(&out->decimal_val_) string(slice->cdata(), *num_decoded_bytes);
         // When we encode a descending decimal, we do a bitwise negation of each byte, which changes
-        // the sign of the number. This way we reverse the sorting order. decimal.Negate() restores
-        // the original sign of the number.
-        decimal.Negate();
-      }
-      if (out) { // TODO avoid using temp variable, when out is nullptr
-        new(&out->decimal_val_) string(decimal.EncodeToComparable());
+        // the sign of the number. This way we reverse the sorting order. Zero, which is the only
+        // single byte encoding, is not negated.
+        if (value_type == ValueType::kDecimalDescending && *num_decoded_bytes > 1) {
+          for (auto& c : out->decimal_val_) {
+            c = ~c;
+          }
+        }
       }
-      slice->remove_prefix(num_decoded_bytes);
+      slice->remove_prefix(*num_decoded_bytes);
       type_ref = value_type;
       return Status::OK();
     }
@@ -741,6 +783,7 @@ Status PrimitiveValue::DecodeKey(rocksdb::Slice* slice, PrimitiveValue* out) {
       type_ref = value_type;
       return Status::OK();
     }
+    case ValueType::kInt64Delta: FALLTHROUGH_INTENDED;
     case ValueType::kMaxByte:
       break;
 
@@ -774,7 +817,10 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kObject: FALLTHROUGH_INTENDED;
     case ValueType::kArray: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisTSBlocks: FALLTHROUGH_INTENDED;
     case ValueType::kTombstone:
       type_ = value_type;
       complex_data_structure_ = nullptr;
@@ -824,6 +870,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
 
     case ValueType::kInt64: FALLTHROUGH_INTENDED;
     case ValueType::kInt64Descending: FALLTHROUGH_INTENDED;
+    case ValueType::kInt64Delta: FALLTHROUGH_INTENDED;
     case ValueType::kArrayIndex: FALLTHROUGH_INTENDED;
     case ValueType::kDoubleDescending: FALLTHROUGH_INTENDED;
     case ValueType::kDouble:
@@ -836,11 +883,10 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
       return Status::OK();
 
     case ValueType::kDecimal: {
-      util::Decimal decimal;
-      size_t num_decoded_bytes = 0;
-      RETURN_NOT_OK(decimal.DecodeFromComparable(slice.ToString(), &num_decoded_bytes));
+      auto num_decoded_bytes = util::DecimalComparableEncodedSize(slice);
+      RETURN_NOT_OK(num_decoded_bytes);
       type_ = value_type;
-      new(&decimal_val_) string(decimal.EncodeToComparable());
+      new(&decimal_val_) string(slice.cdata(), *num_decoded_bytes);
       return Status::OK();
     }
 
@@ -884,6 +930,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED;
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTableId: FALLTHROUGH_INTENDED;
     case ValueType::kUInt16Hash: FALLTHROUGH_INTENDED;
     case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
@@ -896,6 +943,10 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kDecimalDescending: FALLTHROUGH_INTENDED;
     case ValueType::kUuidDescending: FALLTHROUGH_INTENDED;
     case ValueType::kTimestampDescending: FALLTHROUGH_INTENDED;
+    case ValueType::kSSForward: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisCardinality: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListBounds: FALLTHROUGH_INTENDED;
+    case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kLowest: FALLTHROUGH_INTENDED;
     case ValueType::kHighest: FALLTHROUGH_INTENDED;
     case ValueType::kMaxByte:
@@ -945,6 +996,13 @@ PrimitiveValue PrimitiveValue::ArrayIndex(int64_t index) {
   return primitive_value;
 }
 
+PrimitiveValue PrimitiveValue::Int64Delta(int64_t delta) {
+  PrimitiveValue primitive_value;
+  primitive_value.type_ = ValueType::kInt64Delta;
+  primitive_value.int64_val_ = delta;
+  return primitive_value;
+}
+
 PrimitiveValue PrimitiveValue::UInt16Hash(uint16_t hash) {
   PrimitiveValue primitive_value;
   primitive_value.type_ = ValueType::kUInt16Hash;
@@ -1000,6 +1058,10 @@ bool PrimitiveValue::operator==(const PrimitiveValue& other) const {
   switch (type_) {
     case ValueType::kNullDescending: FALLTHROUGH_INTENDED;
     case ValueType::kNull: FALLTHROUGH_INTENDED;
+    case ValueType::kSSForward: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisCardinality: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListBounds: FALLTHROUGH_INTENDED;
+    case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kLowest: FALLTHROUGH_INTENDED;
@@ -1017,6 +1079,7 @@ bool PrimitiveValue::operator==(const PrimitiveValue& other) const {
 
     case ValueType::kInt64Descending: FALLTHROUGH_INTENDED;
     case ValueType::kInt64: FALLTHROUGH_INTENDED;
+    case ValueType::kInt64Delta: FALLTHROUGH_INTENDED;
     case ValueType::kArrayIndex: return int64_val_ == other.int64_val_;
 
     case ValueType::kFloatDescending: FALLTHROUGH_INTENDED;
@@ -1062,6 +1125,10 @@ int PrimitiveValue::CompareTo(const PrimitiveValue& other) const {
   switch (type_) {
     case ValueType::kNullDescending: FALLTHROUGH_INTENDED;
     case ValueType::kNull: FALLTHROUGH_INTENDED;
+    case ValueType::kSSForward: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisCardinality: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListBounds: FALLTHROUGH_INTENDED;
+    case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kLowest: FALLTHROUGH_INTENDED;
@@ -1079,6 +1146,7 @@ int PrimitiveValue::CompareTo(const PrimitiveValue& other) const {
     case ValueType::kInt32:
       return CompareUsingLessThan(int32_val_, other.int32_val_);
     case ValueType::kInt64: FALLTHROUGH_INTENDED;
+    case ValueType::kInt64Delta: FALLTHROUGH_INTENDED;
     case ValueType::kArrayIndex:
       return CompareUsingLessThan(int64_val_, other.int64_val_);
     case ValueType::kDoubleDescending:
@@ -231,6 +231,7 @@ class PrimitiveValue {
   // decimal_str represents a human readable string representing the decimal number, e.g. "0.03".
   static PrimitiveValue Decimal(const std::string& decimal_str, SortOrder sort_order);
   static PrimitiveValue ArrayIndex(int64_t index);
+  static PrimitiveValue Int64Delta(int64_t delta);
   static PrimitiveValue UInt16Hash(uint16_t hash);
   static PrimitiveValue SystemColumnId(ColumnId column_id);
   static PrimitiveValue SystemColumnId(SystemColumnIds system_column_id);
@@ -293,6 +294,17 @@ class PrimitiveValue {
     return int64_val_;
   }
 
+  // The amount added by an increment that was written without reading the previous value.
+  int64_t GetInt64Delta() const {
+    DCHECK(ValueType::kInt64Delta == type_);
+    return int64_val_;
+  }
+
+  int64_t GetArrayIndex() const {
+    DCHECK(ValueType::kArrayIndex == type_);
+    return int64_val_;
+  }
+
   uint16_t GetUInt16() const {
     DCHECK(ValueType::kUInt16Hash == type_ || ValueType::kIntentType == type_);
     return uint16_val_;
@@ -0,0 +1,98 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/ql_cursor_cache.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+QLReadRequestPB PageRequest(uint64_t request_id, const std::string& next_row_key) {
+  QLReadRequestPB request;
+  request.set_request_id(request_id);
+  request.set_schema_version(1);
+  request.set_limit(100);
+  request.set_return_paging_state(true);
+  request.mutable_paging_state()->set_next_row_key(next_row_key);
+  request.mutable_paging_state()->set_total_num_rows_read(request_id * 100);
+  return request;
+}
+
+common::QLCursorPtr NewCursor() {
+  return std::make_unique<common::QLCursor>();
+}
+
+} // namespace
+
+class QLCursorCacheTest : public YBTest {
+};
+
+TEST_F(QLCursorCacheTest, Key) {
+  const auto first_page = PageRequest(1, "");
+  const auto second_page = PageRequest(2, "row2");
+  // The next page continues the cursor of the previous one.
+  ASSERT_EQ(QLCursorCache::Key(first_page, "row2"),
+            QLCursorCache::Key(second_page, second_page.paging_state().next_row_key()));
+  ASSERT_NE(QLCursorCache::Key(first_page, "row2"), QLCursorCache::Key(first_page, "row3"));
+
+  auto other_read = PageRequest(1, "");
+  other_read.set_schema_version(2);
+  ASSERT_NE(QLCursorCache::Key(first_page, "row2"), QLCursorCache::Key(other_read, "row2"));
+}
+
+TEST_F(QLCursorCacheTest, TakeRemoves) {
+  QLCursorCache cache(4, MonoDelta::FromSeconds(60));
+  auto cursor = NewCursor();
+  auto* cursor_ptr = cursor.get();
+  cache.Put("key", std::move(cursor));
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_TRUE(cache.Take("other") == nullptr);
+  ASSERT_EQ(cursor_ptr, cache.Take("key").get());
+  ASSERT_TRUE(cache.Take("key") == nullptr);
+  ASSERT_EQ(0U, cache.size());
+}
+
+TEST_F(QLCursorCacheTest, Capacity) {
+  QLCursorCache cache(2, MonoDelta::FromSeconds(60));
+  cache.Put("key1", NewCursor());
+  cache.Put("key2", NewCursor());
+  cache.Put("key3", NewCursor());
+  ASSERT_EQ(2U, cache.size());
+  ASSERT_TRUE(cache.Take("key1") == nullptr);
+  ASSERT_TRUE(cache.Take("key2") != nullptr);
+  ASSERT_TRUE(cache.Take("key3") != nullptr);
+
+  QLCursorCache disabled(0, MonoDelta::FromSeconds(60));
+  disabled.Put("key", NewCursor());
+  ASSERT_EQ(0U, disabled.size());
+  ASSERT_TRUE(disabled.Take("key") == nullptr);
+}
+
+TEST_F(QLCursorCacheTest, Expiration) {
+  QLCursorCache cache(4, MonoDelta::FromMilliseconds(100));
+  cache.Put("key1", NewCursor());
+  SleepFor(MonoDelta::FromMilliseconds(200));
+  cache.Put("key2", NewCursor());
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_TRUE(cache.Take("key1") == nullptr);
+  ASSERT_TRUE(cache.Take("key2") != nullptr);
+}
+
+}  // namespace docdb
+}  // namespace yb
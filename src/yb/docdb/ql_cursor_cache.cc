@@ -0,0 +1,85 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/ql_cursor_cache.h"
+
+namespace yb {
+namespace docdb {
+
+QLCursorCache::QLCursorCache(size_t capacity, MonoDelta ttl) : capacity_(capacity), ttl_(ttl) {
+}
+
+std::string QLCursorCache::Key(const QLReadRequestPB& request, const std::string& next_row_key) {
+  QLReadRequestPB key_request(request);
+  key_request.clear_request_id();
+  key_request.clear_limit();
+  key_request.clear_remote_endpoint();
+  key_request.clear_query_id();
+  key_request.mutable_paging_state()->Clear();
+  key_request.mutable_paging_state()->set_next_row_key(next_row_key);
+  return key_request.SerializeAsString();
+}
+
+common::QLCursorPtr QLCursorCache::Take(const std::string& key) {
+  std::vector<common::QLCursorPtr> evicted;
+  std::lock_guard<std::mutex> lock(mutex_);
+  EraseExpired(MonoTime::Now(), &evicted);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  auto result = std::move(it->second->cursor);
+  entries_.erase(it->second);
+  index_.erase(it);
+  return result;
+}
+
+void QLCursorCache::Put(std::string key, common::QLCursorPtr cursor) {
+  std::vector<common::QLCursorPtr> evicted;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = MonoTime::Now();
+  EraseExpired(now, &evicted);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    EraseEntry(it->second, &evicted);
+  }
+  if (capacity_ == 0) {
+    evicted.push_back(std::move(cursor));
+    return;
+  }
+  while (entries_.size() >= capacity_) {
+    EraseEntry(entries_.begin(), &evicted);
+  }
+  entries_.push_back(Entry{std::move(key), now + ttl_, std::move(cursor)});
+  index_.emplace(entries_.back().key, std::prev(entries_.end()));
+}
+
+size_t QLCursorCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void QLCursorCache::EraseExpired(MonoTime now, std::vector<common::QLCursorPtr>* evicted) {
+  while (!entries_.empty() && entries_.front().expire_time <= now) {
+    EraseEntry(entries_.begin(), evicted);
+  }
+}
+
+void QLCursorCache::EraseEntry(Entries::iterator it, std::vector<common::QLCursorPtr>* evicted) {
+  evicted->push_back(std::move(it->cursor));
+  index_.erase(it->key);
+  entries_.erase(it);
+}
+
+}  // namespace docdb
+}  // namespace yb
@@ -0,0 +1,82 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_QL_CURSOR_CACHE_H_
+#define YB_DOCDB_QL_CURSOR_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_storage_interface.h"
+#include "yb/util/monotime.h"
+
+namespace yb {
+namespace docdb {
+
+// Bounded cache of the cursors of the paged QL reads of a tablet.
+//
+// Each page of a paged read seeks its own iterator to the row key the previous page stopped at,
+// positioning every memtable and SST file iterator anew. Instead, the iterator of a page is kept
+// here after the page is read, and the request of the next page continues it.
+//
+// A cursor is keyed by the request with the paging state of the next page. The next row key of
+// the paging state includes the hybrid time of the read, so a cursor is only continued by the read
+// at the same read point. Cursors pin the memtables and SST files they read, so they are kept only
+// for a short time, and only the most recent ones are kept.
+//
+// This class is thread-safe.
+class QLCursorCache {
+ public:
+  QLCursorCache(size_t capacity, MonoDelta ttl);
+
+  // Returns the key of the cursor of the request when its next page starts at next_row_key. The
+  // fields that differ between the pages of a read, other than the next row key, are ignored.
+  static std::string Key(const QLReadRequestPB& request, const std::string& next_row_key);
+
+  // Removes and returns the cursor with the key, or nullptr if there is no such unexpired cursor.
+  common::QLCursorPtr Take(const std::string& key);
+
+  void Put(std::string key, common::QLCursorPtr cursor);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    MonoTime expire_time;
+    common::QLCursorPtr cursor;
+  };
+
+  typedef std::list<Entry> Entries;
+
+  // Moves the cursors to evict to the evicted list, so they are destroyed out of the lock.
+  void EraseExpired(MonoTime now, std::vector<common::QLCursorPtr>* evicted);
+  void EraseEntry(Entries::iterator it, std::vector<common::QLCursorPtr>* evicted);
+
+  const size_t capacity_;
+  const MonoDelta ttl_;
+
+  mutable std::mutex mutex_;
+  // Entries in the order they were put, which is also the order they expire in.
+  Entries entries_;
+  std::unordered_map<std::string, Entries::iterator> index_;
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif  // YB_DOCDB_QL_CURSOR_CACHE_H_
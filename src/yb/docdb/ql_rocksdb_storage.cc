@@ -12,15 +12,76 @@
 //
 
 #include "yb/docdb/ql_rocksdb_storage.h"
+#include "yb/docdb/columnar_snapshot.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/docdb_util.h"
 #include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/util/bfql/tserver_opcodes.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_int32(ql_cursor_cache_size, 16,
+             "Number of cursors of paged QL reads a tablet keeps, so the next page of a read "
+             "continues the iterator of the previous page instead of seeking a new one. 0 disables "
+             "keeping the cursors.");
+TAG_FLAG(ql_cursor_cache_size, advanced);
+
+DEFINE_int32(ql_cursor_ttl_ms, 5000,
+             "Milliseconds a cursor of a paged QL read is kept for the next page of the read. "
+             "Kept cursors pin the memtables and SST files they read.");
+TAG_FLAG(ql_cursor_ttl_ms, advanced);
 
 namespace yb {
 namespace docdb {
 
-QLRocksDBStorage::QLRocksDBStorage(rocksdb::DB *rocksdb)
-    : rocksdb_(rocksdb) {
+namespace {
+
+bool ReadsTtlOrWriteTime(const QLExpressionPB& expr);
+
+bool AnyReadsTtlOrWriteTime(const google::protobuf::RepeatedPtrField<QLExpressionPB>& exprs) {
+  for (const auto& expr : exprs) {
+    if (ReadsTtlOrWriteTime(expr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the expression reads the TTL or the write time of a column, which columnar snapshots do
+// not keep.
+bool ReadsTtlOrWriteTime(const QLExpressionPB& expr) {
+  switch (expr.expr_case()) {
+    case QLExpressionPB::ExprCase::kTscall: {
+      const auto opcode = static_cast<bfql::TSOpcode>(expr.tscall().opcode());
+      return opcode == bfql::TSOpcode::kTtl || opcode == bfql::TSOpcode::kWriteTime ||
+             AnyReadsTtlOrWriteTime(expr.tscall().operands());
+    }
+    case QLExpressionPB::ExprCase::kBfcall:
+      return AnyReadsTtlOrWriteTime(expr.bfcall().operands());
+    case QLExpressionPB::ExprCase::kBocall:
+      return AnyReadsTtlOrWriteTime(expr.bocall().operands());
+    case QLExpressionPB::ExprCase::kCondition:
+      return AnyReadsTtlOrWriteTime(expr.condition().operands());
+    default:
+      return false;
+  }
+}
+
+// Whether the request is a scan a columnar snapshot could serve. Reads of specific hash keys are
+// left to RocksDB, which finds them with bloom filters.
+bool IsColumnarScan(const QLReadRequestPB& request, const Schema& schema) {
+  return request.hashed_column_values().empty() && !schema.has_statics() &&
+         !AnyReadsTtlOrWriteTime(request.selected_exprs());
+}
+
+} // namespace
+
+QLRocksDBStorage::QLRocksDBStorage(rocksdb::DB *rocksdb,
+                                   const ColumnarSnapshotHolder* columnar_snapshots)
+    : rocksdb_(rocksdb), columnar_snapshots_(columnar_snapshots),
+      cursor_cache_(FLAGS_ql_cursor_cache_size > 0
+          ? new QLCursorCache(FLAGS_ql_cursor_cache_size,
+                              MonoDelta::FromMilliseconds(FLAGS_ql_cursor_ttl_ms))
+          : nullptr) {
 
 }
 
@@ -31,6 +92,14 @@ CHECKED_STATUS QLRocksDBStorage::GetIterator(
     const TransactionOperationContextOpt& txn_op_context,
     HybridTime req_hybrid_time,
     std::unique_ptr<common::QLRowwiseIteratorIf> *iter) const {
+  if (columnar_snapshots_ != nullptr && !txn_op_context && IsColumnarScan(request, schema)) {
+    auto snapshot = columnar_snapshots_->Get(req_hybrid_time);
+    if (snapshot != nullptr && snapshot->HasColumns(projection)) {
+      iter->reset(new ColumnarSnapshotIterator(
+          std::move(snapshot), projection, schema, req_hybrid_time));
+      return Status::OK();
+    }
+  }
   iter->reset(new DocRowwiseIterator(
       projection, schema, txn_op_context, rocksdb_, req_hybrid_time));
   return Status::OK();
@@ -85,5 +154,21 @@ CHECKED_STATUS QLRocksDBStorage::BuildQLScanSpec(const QLReadRequestPB& request,
   return Status::OK();
 }
 
+common::QLCursorPtr QLRocksDBStorage::TakeCursor(const QLReadRequestPB& request) const {
+  if (cursor_cache_ == nullptr || !request.has_paging_state() ||
+      request.paging_state().next_row_key().empty()) {
+    return nullptr;
+  }
+  return cursor_cache_->Take(QLCursorCache::Key(request, request.paging_state().next_row_key()));
+}
+
+void QLRocksDBStorage::KeepCursor(const QLReadRequestPB& request,
+                                  const std::string& next_row_key,
+                                  common::QLCursorPtr cursor) const {
+  if (cursor_cache_ != nullptr) {
+    cursor_cache_->Put(QLCursorCache::Key(request, next_row_key), std::move(cursor));
+  }
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -19,15 +19,21 @@
 #include "yb/rocksdb/db.h"
 #include "yb/common/ql_rowwise_iterator_interface.h"
 #include "yb/common/ql_storage_interface.h"
+#include "yb/docdb/ql_cursor_cache.h"
 
 namespace yb {
 namespace docdb {
 
+class ColumnarSnapshotHolder;
+
 // Implementation of QLStorageIf with rocksdb as a backend. This is what all of our QL tables use.
 class QLRocksDBStorage : public common::QLStorageIf {
 
  public:
-  explicit QLRocksDBStorage(rocksdb::DB *rocksdb);
+  // Scans are served from the columnar snapshot of columnar_snapshots, when specified, if the
+  // snapshot could serve them.
+  explicit QLRocksDBStorage(rocksdb::DB *rocksdb,
+                            const ColumnarSnapshotHolder* columnar_snapshots = nullptr);
   CHECKED_STATUS GetIterator(const QLReadRequestPB& request,
                              const Schema& projection,
                              const Schema& schema,
@@ -42,8 +48,14 @@ class QLRocksDBStorage : public common::QLStorageIf {
                                   std::unique_ptr<common::QLScanSpec>* spec,
                                   std::unique_ptr<common::QLScanSpec>* static_row_spec,
                                   HybridTime* req_hybrid_time) const override;
+  common::QLCursorPtr TakeCursor(const QLReadRequestPB& request) const override;
+  void KeepCursor(const QLReadRequestPB& request, const std::string& next_row_key,
+                  common::QLCursorPtr cursor) const override;
  private:
   rocksdb::DB *const rocksdb_;
+  const ColumnarSnapshotHolder* const columnar_snapshots_;
+  // Cursors of the paged reads of the tablet, nullptr when cursors are not kept.
+  const std::unique_ptr<QLCursorCache> cursor_cache_;
 };
 
 }  // namespace docdb
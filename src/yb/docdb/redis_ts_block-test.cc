@@ -0,0 +1,112 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/redis_ts_block.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+RedisTSPoint Point(int64_t timestamp, const std::string& value, MicrosTime expire_at = 0) {
+  RedisTSPoint point;
+  point.timestamp = timestamp;
+  point.value = value;
+  point.expire_at = expire_at;
+  return point;
+}
+
+void CheckRoundTrip(const RedisTSBlock& block) {
+  RedisTSBlock decoded(1);
+  ASSERT_OK(RedisTSBlock::Decode(block.Encode(), &decoded));
+  ASSERT_EQ(block.width(), decoded.width());
+  ASSERT_EQ(block.points(), decoded.points());
+}
+
+} // namespace
+
+TEST(RedisTSBlockTest, Start) {
+  ASSERT_EQ(0, RedisTSBlock::Start(0, 100));
+  ASSERT_EQ(0, RedisTSBlock::Start(99, 100));
+  ASSERT_EQ(100, RedisTSBlock::Start(100, 100));
+  ASSERT_EQ(-100, RedisTSBlock::Start(-1, 100));
+  ASSERT_EQ(-100, RedisTSBlock::Start(-100, 100));
+  ASSERT_EQ(-200, RedisTSBlock::Start(-101, 100));
+}
+
+TEST(RedisTSBlockTest, Modify) {
+  RedisTSBlock block(100);
+  block.Upsert(Point(20, "b"));
+  block.Upsert(Point(10, "a", 1000));
+  block.Upsert(Point(30, "c", 2000));
+  block.Upsert(Point(20, "bb", 3000));
+  ASSERT_EQ(3, block.points().size());
+  ASSERT_EQ(10, block.points()[0].timestamp);
+  ASSERT_EQ("bb", block.Find(20)->value);
+  ASSERT_EQ(nullptr, block.Find(15));
+  ASSERT_EQ(3000, block.MaxExpireAt());
+
+  ASSERT_FALSE(block.Remove(15));
+  ASSERT_TRUE(block.Remove(20));
+  ASSERT_EQ(2000, block.MaxExpireAt());
+
+  block.RemoveExpired(1000);
+  ASSERT_EQ(1, block.points().size());
+  ASSERT_EQ(30, block.points()[0].timestamp);
+
+  block.Upsert(Point(40, "d"));
+  ASSERT_EQ(0, block.MaxExpireAt());
+  block.RemoveExpired(5000);
+  ASSERT_EQ(1, block.points().size());
+  ASSERT_EQ(40, block.points()[0].timestamp);
+}
+
+TEST(RedisTSBlockTest, Encoding) {
+  RedisTSBlock block(3600);
+  ASSERT_NO_FATALS(CheckRoundTrip(block));
+
+  // A regular series takes a few bytes per point.
+  for (int i = 0; i != 60; ++i) {
+    block.Upsert(Point(i * 60, "value_" + std::to_string(100 + i)));
+  }
+  ASSERT_NO_FATALS(CheckRoundTrip(block));
+  ASSERT_LT(block.Encode().size(), 60 * 7);
+
+  RedisTSBlock irregular(std::numeric_limits<int64_t>::max());
+  irregular.Upsert(Point(std::numeric_limits<int64_t>::min() + 1, "", 5));
+  irregular.Upsert(Point(-7, "abc", 1));
+  irregular.Upsert(Point(0, "abd"));
+  irregular.Upsert(Point(std::numeric_limits<int64_t>::max() - 1, "x", 1000000));
+  ASSERT_NO_FATALS(CheckRoundTrip(irregular));
+}
+
+TEST(RedisTSBlockTest, Corruption) {
+  RedisTSBlock block(100);
+  block.Upsert(Point(1, "value"));
+  block.Upsert(Point(2, "value2"));
+  const std::string encoded = block.Encode();
+  RedisTSBlock decoded(1);
+  ASSERT_TRUE(RedisTSBlock::Decode(Slice(encoded.data(), encoded.size() - 1), &decoded)
+                  .IsCorruption());
+  ASSERT_TRUE(RedisTSBlock::Decode(encoded + "x", &decoded).IsCorruption());
+  ASSERT_TRUE(RedisTSBlock::Decode(Slice(), &decoded).IsCorruption());
+}
+
+}  // namespace docdb
+}  // namespace yb
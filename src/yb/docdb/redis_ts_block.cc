@@ -0,0 +1,183 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/redis_ts_block.h"
+
+#include <algorithm>
+
+#include "yb/util/fast_varint.h"
+#include "yb/util/result.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Differences are computed modulo 2^64, so that they do not overflow for any timestamps.
+int64_t Difference(uint64_t lhs, uint64_t rhs) {
+  return static_cast<int64_t>(lhs - rhs);
+}
+
+uint64_t Sum(uint64_t lhs, int64_t rhs) {
+  return lhs + static_cast<uint64_t>(rhs);
+}
+
+void AppendVarInt(int64_t value, std::string* dest) {
+  util::FastAppendSignedVarIntToStr(value, dest);
+}
+
+Result<int64_t> ConsumeVarInt(Slice* slice) {
+  int64_t value = 0;
+  RETURN_NOT_OK(util::FastDecodeSignedVarInts(slice, &value, 1));
+  return value;
+}
+
+} // namespace
+
+int64_t RedisTSBlock::Start(int64_t timestamp, int64_t width) {
+  DCHECK_GT(width, 0);
+  const int64_t remainder = timestamp % width;
+  return timestamp - (remainder < 0 ? remainder + width : remainder);
+}
+
+std::vector<RedisTSPoint>::iterator RedisTSBlock::LowerBound(int64_t timestamp) {
+  return std::lower_bound(
+      points_.begin(), points_.end(), timestamp,
+      [](const RedisTSPoint& point, int64_t value) { return point.timestamp < value; });
+}
+
+void RedisTSBlock::Upsert(RedisTSPoint point) {
+  auto it = LowerBound(point.timestamp);
+  if (it != points_.end() && it->timestamp == point.timestamp) {
+    *it = std::move(point);
+  } else {
+    points_.insert(it, std::move(point));
+  }
+}
+
+bool RedisTSBlock::Remove(int64_t timestamp) {
+  auto it = LowerBound(timestamp);
+  if (it == points_.end() || it->timestamp != timestamp) {
+    return false;
+  }
+  points_.erase(it);
+  return true;
+}
+
+void RedisTSBlock::RemoveExpired(MicrosTime now) {
+  points_.erase(
+      std::remove_if(points_.begin(), points_.end(), [now](const RedisTSPoint& point) {
+        return point.expire_at != 0 && point.expire_at <= now;
+      }),
+      points_.end());
+}
+
+const RedisTSPoint* RedisTSBlock::Find(int64_t timestamp) const {
+  auto it = const_cast<RedisTSBlock*>(this)->LowerBound(timestamp);
+  return it != points_.end() && it->timestamp == timestamp ? &*it : nullptr;
+}
+
+MicrosTime RedisTSBlock::MaxExpireAt() const {
+  MicrosTime result = 0;
+  for (const auto& point : points_) {
+    if (point.expire_at == 0) {
+      return 0;
+    }
+    result = std::max(result, point.expire_at);
+  }
+  return result;
+}
+
+std::string RedisTSBlock::Encode() const {
+  std::string result;
+  AppendVarInt(width_, &result);
+  AppendVarInt(points_.size(), &result);
+  uint64_t prev_timestamp = 0;
+  int64_t prev_delta = 0;
+  MicrosTime prev_expire_at = 0;
+  Slice prev_value;
+  for (const auto& point : points_) {
+    const int64_t delta = Difference(point.timestamp, prev_timestamp);
+    AppendVarInt(Difference(delta, prev_delta), &result);
+    prev_timestamp = point.timestamp;
+    prev_delta = delta;
+
+    AppendVarInt(Difference(point.expire_at, prev_expire_at), &result);
+    prev_expire_at = point.expire_at;
+
+    const Slice value(point.value);
+    const size_t max_shared = std::min(value.size(), prev_value.size());
+    size_t shared = 0;
+    while (shared != max_shared && value[shared] == prev_value[shared]) {
+      ++shared;
+    }
+    AppendVarInt(shared, &result);
+    AppendVarInt(value.size() - shared, &result);
+    result.append(point.value, shared, std::string::npos);
+    prev_value = value;
+  }
+  return result;
+}
+
+Status RedisTSBlock::Decode(Slice encoded, RedisTSBlock* block) {
+  const Slice input = encoded;
+  auto width = ConsumeVarInt(&encoded);
+  RETURN_NOT_OK(width);
+  auto size = ConsumeVarInt(&encoded);
+  RETURN_NOT_OK(size);
+  if (*width <= 0 || *size < 0) {
+    return STATUS_FORMAT(Corruption, "Invalid redis time series block: $0", input.ToDebugString());
+  }
+  block->width_ = *width;
+  block->points_.clear();
+  block->points_.reserve(*size);
+  uint64_t timestamp = 0;
+  int64_t delta = 0;
+  MicrosTime expire_at = 0;
+  for (int64_t i = 0; i != *size; ++i) {
+    int64_t numbers[4];
+    RETURN_NOT_OK(util::FastDecodeSignedVarInts(&encoded, numbers, 4));
+    const int64_t shared = numbers[2];
+    const int64_t suffix_size = numbers[3];
+    const std::string* prev_value = block->points_.empty() ? nullptr
+                                                           : &block->points_.back().value;
+    if (shared < 0 || suffix_size < 0 || encoded.size() < static_cast<size_t>(suffix_size) ||
+        static_cast<size_t>(shared) > (prev_value ? prev_value->size() : 0)) {
+      return STATUS_FORMAT(
+          Corruption, "Invalid point $0 of redis time series block: $1", i,
+          input.ToDebugString());
+    }
+    delta = Sum(delta, numbers[0]);
+    timestamp = Sum(timestamp, delta);
+    expire_at = Sum(expire_at, numbers[1]);
+
+    RedisTSPoint point;
+    point.timestamp = static_cast<int64_t>(timestamp);
+    point.expire_at = expire_at;
+    point.value.reserve(shared + suffix_size);
+    if (shared > 0) {
+      point.value.assign(*prev_value, 0, shared);
+    }
+    point.value.append(encoded.cdata(), suffix_size);
+    encoded.remove_prefix(suffix_size);
+    block->points_.push_back(std::move(point));
+  }
+  if (!encoded.empty()) {
+    return STATUS_FORMAT(
+        Corruption, "Extra bytes in redis time series block: $0", input.ToDebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace docdb
+}  // namespace yb
@@ -0,0 +1,86 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_REDIS_TS_BLOCK_H_
+#define YB_DOCDB_REDIS_TS_BLOCK_H_
+
+#include <string>
+#include <vector>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/util/slice.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace docdb {
+
+// A point of a redis time series.
+struct RedisTSPoint {
+  int64_t timestamp = 0;
+  std::string value;
+  // Physical time in microseconds at which the point expires, 0 if it does not expire.
+  MicrosTime expire_at = 0;
+
+  bool operator==(const RedisTSPoint& other) const {
+    return timestamp == other.timestamp && value == other.value && expire_at == other.expire_at;
+  }
+};
+
+// The points of a redis time series whose timestamps fall into [start, start + width), where start
+// is a multiple of width. The points are ordered by timestamp.
+//
+// A block is encoded in a single value, point after point, in the spirit of Gorilla: timestamps as
+// delta-of-deltas, so a series written at a regular interval takes a byte per timestamp, values as
+// the length of the prefix shared with the previous value followed by the rest of the value, and
+// expiration times as deltas from the previous one. All numbers are signed VarInts.
+class RedisTSBlock {
+ public:
+  explicit RedisTSBlock(int64_t width) : width_(width) {}
+
+  // Returns the start of the block of the timestamp.
+  static int64_t Start(int64_t timestamp, int64_t width);
+
+  int64_t width() const { return width_; }
+  const std::vector<RedisTSPoint>& points() const { return points_; }
+  bool empty() const { return points_.empty(); }
+
+  // Adds the point, replacing the point with the same timestamp if any.
+  void Upsert(RedisTSPoint point);
+
+  // Removes the point with the timestamp, returns whether it was present.
+  bool Remove(int64_t timestamp);
+
+  // Removes the points that expire at or before now.
+  void RemoveExpired(MicrosTime now);
+
+  // Returns the point with the timestamp, or nullptr.
+  const RedisTSPoint* Find(int64_t timestamp) const;
+
+  // Returns the latest expiration time of the points, 0 if some point does not expire.
+  MicrosTime MaxExpireAt() const;
+
+  std::string Encode() const;
+
+  static CHECKED_STATUS Decode(Slice encoded, RedisTSBlock* block);
+
+ private:
+  std::vector<RedisTSPoint>::iterator LowerBound(int64_t timestamp);
+
+  int64_t width_;
+  std::vector<RedisTSPoint> points_;
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif  // YB_DOCDB_REDIS_TS_BLOCK_H_
@@ -0,0 +1,110 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/redis_value_cache.h"
+#include "yb/docdb/value.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+std::string EncodedKey(const std::string& key) {
+  return DocKey::FromRedisKey(0, key).Encode().data();
+}
+
+void AddPair(const std::string& key, const Value& value, KeyValueWriteBatchPB* batch) {
+  auto* pair = batch->add_kv_pairs();
+  pair->set_key(key);
+  pair->set_value(value.Encode());
+}
+
+void AddString(const std::string& key, const std::string& value, KeyValueWriteBatchPB* batch) {
+  AddPair(EncodedKey(key), Value(PrimitiveValue(value)), batch);
+}
+
+} // namespace
+
+class RedisValueCacheTest : public YBTest {
+};
+
+TEST_F(RedisValueCacheTest, LatestValue) {
+  RedisValueCache cache(1024 * 1024);
+  const auto key = EncodedKey("key");
+
+  KeyValueWriteBatchPB batch;
+  AddString("key", "1", &batch);
+  cache.Apply(batch, HybridTime(1000));
+  ASSERT_FALSE(cache.Get(key, HybridTime(999)));
+  ASSERT_EQ("1", *cache.Get(key, HybridTime(1000)));
+
+  batch.Clear();
+  AddString("key", "2", &batch);
+  cache.Apply(batch, HybridTime(2000));
+  ASSERT_FALSE(cache.Get(key, HybridTime(1500)));
+  ASSERT_EQ("2", *cache.Get(key, HybridTime(3000)));
+
+  // Value with TTL, deletion or write into the document evict the key.
+  batch.Clear();
+  AddPair(key, Value(PrimitiveValue("3"), MonoDelta::FromSeconds(10)), &batch);
+  cache.Apply(batch, HybridTime(3000));
+  ASSERT_FALSE(cache.Get(key, HybridTime(4000)));
+
+  batch.Clear();
+  AddString("key", "4", &batch);
+  AddString("other", "5", &batch);
+  cache.Apply(batch, HybridTime(4000));
+  ASSERT_EQ(2U, cache.size());
+
+  batch.Clear();
+  AddPair(key, Value(PrimitiveValue(ValueType::kTombstone)), &batch);
+  SubDocKey subdoc_key(DocKey::FromRedisKey(0, "other"));
+  subdoc_key.AppendSubKeysAndMaybeHybridTime(PrimitiveValue("field"));
+  AddPair(subdoc_key.Encode(/* include_hybrid_time */ false).data(),
+          Value(PrimitiveValue("6")), &batch);
+  cache.Apply(batch, HybridTime(5000));
+  ASSERT_EQ(0U, cache.size());
+}
+
+TEST_F(RedisValueCacheTest, Eviction) {
+  constexpr size_t kCapacity = 16 * 1024;
+  constexpr int kKeys = 1000;
+  RedisValueCache cache(kCapacity);
+
+  for (int i = 0; i != kKeys; ++i) {
+    KeyValueWriteBatchPB batch;
+    AddString("key" + std::to_string(i), "value", &batch);
+    cache.Apply(batch, HybridTime(1000 + i));
+    // Keep the first key recently used.
+    ASSERT_TRUE(cache.Get(EncodedKey("key0"), HybridTime::kMax));
+  }
+  ASSERT_LT(cache.size(), static_cast<size_t>(kKeys));
+  ASSERT_GT(cache.size(), 0U);
+  ASSERT_FALSE(cache.Get(EncodedKey("key1"), HybridTime::kMax));
+  ASSERT_TRUE(cache.Get(EncodedKey("key" + std::to_string(kKeys - 1)), HybridTime::kMax));
+
+  // Values that are too big are not cached.
+  KeyValueWriteBatchPB batch;
+  AddString("key0", std::string(kCapacity, 'x'), &batch);
+  cache.Apply(batch, HybridTime(1000 + kKeys));
+  ASSERT_FALSE(cache.Get(EncodedKey("key0"), HybridTime::kMax));
+}
+
+} // namespace docdb
+} // namespace yb
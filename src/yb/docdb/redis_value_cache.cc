@@ -0,0 +1,130 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/redis_value_cache.h"
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/value.h"
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Values that would take a noticeable part of the cache are not worth keeping.
+constexpr size_t kMaxEntryFraction = 16;
+
+// Approximate memory overhead of an entry, besides key and value bytes.
+constexpr size_t kEntryOverhead = sizeof(std::string) * 2 + sizeof(HybridTime) + 64;
+
+size_t EntrySize(size_t key_size, size_t value_size) {
+  return key_size + value_size + kEntryOverhead;
+}
+
+} // namespace
+
+RedisValueCache::RedisValueCache(size_t capacity_bytes) : capacity_bytes_(capacity_bytes) {
+}
+
+void RedisValueCache::Apply(const KeyValueWriteBatchPB& put_batch, HybridTime hybrid_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Value value;
+  for (const auto& kv_pair : put_batch.kv_pairs()) {
+    Slice key = kv_pair.key();
+    auto doc_key_size = DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY);
+    if (!doc_key_size.ok()) {
+      // Should not happen, but we could not tell which document is modified.
+      LOG(DFATAL) << "Failed to decode document key: " << doc_key_size.status();
+      entries_.clear();
+      index_.clear();
+      used_bytes_ = 0;
+      return;
+    }
+    if (*doc_key_size != key.size()) {
+      // Write to a subdocument, the document is not a plain string anymore.
+      Erase(Slice(key.data(), *doc_key_size));
+      continue;
+    }
+    if (!value.Decode(kv_pair.value()).ok() || value.has_ttl() ||
+        value.user_timestamp_micros() != Value::kInvalidUserTimestamp ||
+        value.value_type() != ValueType::kString) {
+      Erase(key);
+      continue;
+    }
+    Put(key, value.primitive_value().GetString(), hybrid_time);
+  }
+}
+
+boost::optional<std::string> RedisValueCache::Get(
+    const Slice& encoded_doc_key, HybridTime read_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(encoded_doc_key);
+  if (it == index_.end() || it->second->write_time > read_time) {
+    return boost::none;
+  }
+  entries_.splice(entries_.end(), entries_, it->second);
+  return it->second->value;
+}
+
+void RedisValueCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  used_bytes_ = 0;
+}
+
+size_t RedisValueCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void RedisValueCache::Put(const Slice& key, std::string value, HybridTime write_time) {
+  auto it = index_.find(key);
+  if (EntrySize(key.size(), value.size()) * kMaxEntryFraction > capacity_bytes_) {
+    if (it != index_.end()) {
+      EraseEntry(it->second);
+    }
+    return;
+  }
+  if (it != index_.end()) {
+    auto& entry = *it->second;
+    used_bytes_ = used_bytes_ - entry.value.size() + value.size();
+    entry.value = std::move(value);
+    entry.write_time = write_time;
+    entries_.splice(entries_.end(), entries_, it->second);
+  } else {
+    entries_.push_back(Entry{key.ToBuffer(), std::move(value), write_time});
+    auto& entry = entries_.back();
+    used_bytes_ += EntrySize(entry.key.size(), entry.value.size());
+    index_.emplace(Slice(entry.key), std::prev(entries_.end()));
+  }
+  while (used_bytes_ > capacity_bytes_) {
+    EraseEntry(entries_.begin());
+  }
+}
+
+void RedisValueCache::Erase(const Slice& key) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+void RedisValueCache::EraseEntry(Entries::iterator it) {
+  used_bytes_ -= EntrySize(it->key.size(), it->value.size());
+  index_.erase(Slice(it->key));
+  entries_.erase(it);
+}
+
+} // namespace docdb
+} // namespace yb
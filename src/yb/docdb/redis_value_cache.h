@@ -0,0 +1,84 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_REDIS_VALUE_CACHE_H_
+#define YB_DOCDB_REDIS_VALUE_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/docdb/docdb.pb.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+namespace docdb {
+
+// Bounded cache of the latest values of recently written Redis string keys of a tablet.
+//
+// Read-modify-write commands (INCR, APPEND, GETSET, SETRANGE) of a hot key read the value written
+// by the previous command from RocksDB, usually from the memtable, just to modify and write it
+// again. This cache keeps such values, so the read could be skipped.
+//
+// The cache is updated by every non-transactional write batch applied to the tablet. A key is
+// cached only when its whole document is overwritten by a string without TTL, any other write to
+// the document evicts it. So a cached value is the latest value of the key, and could be used by
+// any read at or after the hybrid time it was written at.
+//
+// This class is thread-safe.
+class RedisValueCache {
+ public:
+  // capacity_bytes - approximate limit of total size of cached keys and values.
+  explicit RedisValueCache(size_t capacity_bytes);
+
+  // Updates the cache with the write batch applied at the specified hybrid time.
+  void Apply(const KeyValueWriteBatchPB& put_batch, HybridTime hybrid_time);
+
+  // Returns the cached value for the specified encoded document key (without a hybrid time), when
+  // it is known to be the value visible at read_time.
+  boost::optional<std::string> Get(const Slice& encoded_doc_key, HybridTime read_time);
+
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    HybridTime write_time;
+  };
+
+  typedef std::list<Entry> Entries;
+
+  void Put(const Slice& key, std::string value, HybridTime write_time);
+  void Erase(const Slice& key);
+  void EraseEntry(Entries::iterator it);
+
+  const size_t capacity_bytes_;
+
+  mutable std::mutex mutex_;
+  // Entries in least recently used first order.
+  Entries entries_;
+  std::unordered_map<Slice, Entries::iterator, Slice::Hash> index_;
+  size_t used_bytes_ = 0;
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif  // YB_DOCDB_REDIS_VALUE_CACHE_H_
@@ -383,5 +383,42 @@ TEST_F(SharedLockManagerTest, LockBatchReset) {
   EXPECT_TRUE(lb.empty());
 }
 
+TEST_F(SharedLockManagerTest, ConflictingLockWaitsForRelease) {
+  lm_.LockInTest("foo", IntentType::kWeakSerializableRead);
+  // Non-conflicting intents go through the fast path.
+  lm_.LockInTest("foo", IntentType::kWeakSerializableWrite);
+  lm_.LockInTest("bar", IntentType::kStrongSnapshotWrite);
+
+  std::atomic<bool> locked(false);
+  thread t([this, &locked] {
+    lm_.LockInTest("foo", IntentType::kStrongSnapshotWrite);
+    locked = true;
+    lm_.UnlockInTest("foo", IntentType::kStrongSnapshotWrite);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_FALSE(locked);
+  lm_.UnlockInTest("foo", IntentType::kWeakSerializableRead);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_FALSE(locked);
+  lm_.UnlockInTest("foo", IntentType::kWeakSerializableWrite);
+  t.join();
+  ASSERT_TRUE(locked);
+  lm_.UnlockInTest("bar", IntentType::kStrongSnapshotWrite);
+}
+
+TEST_F(SharedLockManagerTest, LockBatchManyKeys) {
+  constexpr int kNumKeys = 1000;
+  KeyToIntentTypeMap keys;
+  for (int i = 0; i != kNumKeys; ++i) {
+    keys.emplace("key" + std::to_string(i), IntentType::kStrongSnapshotWrite);
+  }
+  for (int i = 0; i < 2; ++i) {
+    KeyToIntentTypeMap copy = keys;
+    LockBatch lb(&lm_, std::move(copy));
+    EXPECT_EQ(kNumKeys, lb.size());
+  }
+}
+
 } // namespace docdb
 } // namespace yb
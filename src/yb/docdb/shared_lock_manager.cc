@@ -18,9 +18,11 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include <glog/logging.h>
 
+#include "yb/gutil/walltime.h"
 #include "yb/util/bytes_formatter.h"
 #include "yb/util/enums.h"
 #include "yb/util/logging.h"
+#include "yb/util/spinlock_profiling.h"
 #include "yb/util/trace.h"
 #include "yb/util/tostring.h"
 
@@ -81,6 +83,44 @@ std::array<LockState, kIntentTypeMapSize> MakeConflicts() {
   return result;
 }
 
+// Number of bits used to store the number of holders of each intent type in the packed
+// LockEntry::num_holding word.
+constexpr size_t kIntentCountBits = 64 / kIntentTypeMapSize;
+constexpr uint64_t kIntentCountMask = (1ULL << kIntentCountBits) - 1;
+
+inline uint64_t IntentCountShift(size_t type_idx) {
+  return type_idx * kIntentCountBits;
+}
+
+inline uint64_t IntentCountOne(size_t type_idx) {
+  return 1ULL << IntentCountShift(type_idx);
+}
+
+inline uint64_t IntentCount(uint64_t num_holding, size_t type_idx) {
+  return (num_holding >> IntentCountShift(type_idx)) & kIntentCountMask;
+}
+
+// Same as kIntentConflicts, but expressed as masks over the packed holder counts.
+std::array<uint64_t, kIntentTypeMapSize> MakeConflictMasks(
+    const std::array<LockState, kIntentTypeMapSize>& conflicts) {
+  std::array<uint64_t, kIntentTypeMapSize> result;
+  for (size_t i = 0; i != kIntentTypeMapSize; ++i) {
+    result[i] = 0;
+    for (size_t j = 0; j != kIntentTypeMapSize; ++j) {
+      if (conflicts[i].test(j)) {
+        result[i] |= kIntentCountMask << IntentCountShift(j);
+      }
+    }
+  }
+  return result;
+}
+
+// Number of hash buckets each shard starts with. The table grows when it becomes full.
+constexpr size_t kInitialBucketsPerShard = 64;
+
+// Maximum number of unused entries kept by each shard for reuse.
+constexpr size_t kMaxFreeEntriesPerShard = 1024;
+
 } // namespace
 
 // The conflict matrix. (CONFLICTS[i] & (1 << j)) is one iff LockTypes i and j conflict.
@@ -88,6 +128,13 @@ std::array<LockState, kIntentTypeMapSize> MakeConflicts() {
 // https://docs.google.com/spreadsheets/d/1h8GosY5XnJvrsyjEqyuXdKYlwvfKIaqx_RyDQGd7rSc
 const std::array<LockState, kIntentTypeMapSize> kIntentConflicts = MakeConflicts();
 
+namespace {
+
+const std::array<uint64_t, kIntentTypeMapSize> kIntentConflictMasks =
+    MakeConflictMasks(kIntentConflicts);
+
+} // namespace
+
 bool SharedLockManager::VerifyState(const LockState& state) {
   LockState not_allowed;
   for (auto intent : kIntentTypeList) {
@@ -196,75 +243,177 @@ IntentType SharedLockManager::CombineIntents(const IntentType i1, const IntentTy
   FATAL_INVALID_ENUM_VALUE(IntentType, i1);
 }
 
+bool SharedLockManager::LockEntry::TryLock(size_t type_idx) {
+  uint64_t old_value = num_holding.load();
+  for (;;) {
+    // A saturated holder counter is treated as a conflict, so we wait for one of the holders to
+    // go away instead of overflowing into the neighbouring intent type.
+    if ((old_value & kIntentConflictMasks[type_idx]) != 0 ||
+        IntentCount(old_value, type_idx) == kIntentCountMask) {
+      return false;
+    }
+    if (num_holding.compare_exchange_weak(old_value, old_value + IntentCountOne(type_idx))) {
+      return true;
+    }
+  }
+}
+
 void SharedLockManager::LockEntry::Lock(IntentType lock_type) {
-  // TODO(bojanserafimov): Implement CAS fast path. Only wait when CAS fails.
-  int type_idx = static_cast<size_t>(lock_type);
+  size_t type_idx = static_cast<size_t>(lock_type);
+  if (TryLock(type_idx)) {
+    return;
+  }
+
+  const int64_t wait_start = CycleClock::Now();
   std::unique_lock<std::mutex> lock(mutex);
-  auto& state = this->state;
-  cond_var.wait(lock, [&state, type_idx]() {
-    return (state & kIntentConflicts[type_idx]).none();
-  });
-  ++num_holding[type_idx];
-  state.set(type_idx);
+  // Registering as a waiter before re-checking the state guarantees that the unlocking thread
+  // either observes us as a waiter, or we observe the state after its release.
+  num_waiters.fetch_add(1);
+  while (!TryLock(type_idx)) {
+    cond_var.wait(lock);
+  }
+  num_waiters.fetch_sub(1);
+  lock.unlock();
+  SubmitWaitProfileData(this, CycleClock::Now() - wait_start);
 }
 
 void SharedLockManager::LockEntry::Unlock(IntentType lock_type) {
-  int type_idx = static_cast<int>(lock_type);
-  bool should_notify = false;
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    num_holding[type_idx]--;
-    if (num_holding[type_idx] == 0) {
-      state.reset(type_idx);
-      should_notify = (state == Combine({})
-        || state == Combine({IntentType::kWeakSerializableRead})
-        || state == Combine({IntentType::kWeakSerializableWrite}));
+  size_t type_idx = static_cast<size_t>(lock_type);
+  uint64_t old_value = num_holding.fetch_sub(IntentCountOne(type_idx));
+  DCHECK_NE(IntentCount(old_value, type_idx), 0);
+
+  // Notify only if it is possible that a waiting thread can now lock: either the last holder of
+  // this type is gone, or the counter is no longer saturated.
+  auto old_count = IntentCount(old_value, type_idx);
+  if ((old_count == 1 || old_count == kIntentCountMask) && num_waiters.load() != 0) {
+    // Take the mutex so the notification cannot fall between a waiter's check and its wait.
+    { std::lock_guard<std::mutex> lock(mutex); }
+    cond_var.notify_all();
+  }
+}
+
+SharedLockManager::Shard::Shard() : buckets_(kInitialBucketsPerShard, nullptr) {}
+
+SharedLockManager::Shard::~Shard() {
+  for (auto* entry : buckets_) {
+    while (entry) {
+      auto* next = entry->next;
+      delete entry;
+      entry = next;
     }
   }
+  while (free_list_) {
+    auto* next = free_list_->next;
+    delete free_list_;
+    free_list_ = next;
+  }
+}
 
-  // Notify only if it is possible that a waiting thread can now lock
-  if (should_notify) {
-    cond_var.notify_all();
+SharedLockManager::LockEntry** SharedLockManager::Shard::BucketFor(size_t hash) {
+  // The hash modulo kNumShards was used to pick the shard, so use the remaining bits here.
+  return &buckets_[(hash / kNumShards) & (buckets_.size() - 1)];
+}
+
+SharedLockManager::LockEntry* SharedLockManager::Shard::Find(Slice key, size_t hash) {
+  for (auto* entry = *BucketFor(hash); entry; entry = entry->next) {
+    if (entry->hash == hash && Slice(entry->key) == key) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+SharedLockManager::LockEntry* SharedLockManager::Shard::Reserve(Slice key, size_t hash) {
+  auto* entry = Find(key, hash);
+  if (entry) {
+    ++entry->num_using;
+    return entry;
+  }
+
+  if (free_list_) {
+    entry = free_list_;
+    free_list_ = entry->next;
+    --free_list_size_;
+  } else {
+    entry = new LockEntry;
+  }
+  entry->key.assign(key.cdata(), key.size());
+  entry->hash = hash;
+  entry->num_using = 1;
+
+  auto* bucket = BucketFor(hash);
+  entry->next = *bucket;
+  *bucket = entry;
+  if (++size_ > buckets_.size()) {
+    Rehash();
+  }
+  return entry;
+}
+
+void SharedLockManager::Shard::Release(LockEntry* entry) {
+  if (--entry->num_using != 0) {
+    return;
+  }
+  DCHECK_EQ(entry->num_holding.load(), 0);
+  DCHECK_EQ(entry->num_waiters.load(), 0);
+
+  auto* link = BucketFor(entry->hash);
+  while (*link != entry) {
+    link = &(*link)->next;
+  }
+  *link = entry->next;
+  --size_;
+
+  if (free_list_size_ < kMaxFreeEntriesPerShard) {
+    entry->next = free_list_;
+    free_list_ = entry;
+    ++free_list_size_;
+  } else {
+    delete entry;
+  }
+}
+
+void SharedLockManager::Shard::Rehash() {
+  std::vector<LockEntry*> old_buckets(buckets_.size() * 2, nullptr);
+  old_buckets.swap(buckets_);
+  for (auto* entry : old_buckets) {
+    while (entry) {
+      auto* next = entry->next;
+      auto* bucket = BucketFor(entry->hash);
+      entry->next = *bucket;
+      *bucket = entry;
+      entry = next;
+    }
   }
 }
 
 void SharedLockManager::Lock(const KeyToIntentTypeMap& key_to_intent_type) {
   TRACE("Locking a batch of $0 keys", key_to_intent_type.size());
-  std::vector<SharedLockManager::LockEntry*> reserved = Reserve(key_to_intent_type);
-  size_t idx = 0;
+  // Keys are processed in the sorted order of the batch, which prevents deadlocks between
+  // batches, so we can reserve and lock each entry in a single pass.
   for (const auto& key_and_intent_type : key_to_intent_type) {
     const auto intent_type = key_and_intent_type.second;
     VLOG(4) << "Locking " << docdb::ToString(intent_type) << ": "
             << util::FormatBytesAsStr(key_and_intent_type.first);
-    reserved[idx]->Lock(intent_type);
-    idx++;
-  }
-}
-
-std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(
-    const KeyToIntentTypeMap& key_to_intent_type) {
-  std::vector<SharedLockManager::LockEntry*> reserved;
-  reserved.reserve(key_to_intent_type.size());
-  {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    for (const auto& key_and_intent_type : key_to_intent_type) {
-      auto it = locks_.emplace(key_and_intent_type.first, std::make_unique<LockEntry>()).first;
-      it->second->num_using++;
-      reserved.push_back(&*it->second);
+    Slice key(key_and_intent_type.first);
+    auto hash = key.hash();
+    auto& shard = shards_[hash % kNumShards];
+    LockEntry* entry;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      entry = shard.Reserve(key, hash);
     }
+    entry->Lock(intent_type);
   }
-  return reserved;
 }
 
 void SharedLockManager::Unlock(const KeyToIntentTypeMap& key_to_intent_type) {
   TRACE("Unlocking a batch of $0 keys", key_to_intent_type.size());
-  std::lock_guard<std::mutex> lock(global_mutex_);
   for (const auto& key_and_intent_type : boost::adaptors::reverse(key_to_intent_type)) {
     VLOG(4) << "Unlocking " << docdb::ToString(key_and_intent_type.second) << ": "
             << util::FormatBytesAsStr(key_and_intent_type.first);
-    locks_[key_and_intent_type.first]->Unlock(key_and_intent_type.second);
+    UnlockAndCleanup(key_and_intent_type.first, key_and_intent_type.second);
   }
-  Cleanup(key_to_intent_type);
 }
 
 void SharedLockManager::LockInTest(const string& key, IntentType intent_type) {
@@ -275,14 +424,16 @@ void SharedLockManager::UnlockInTest(const string& key, IntentType intent_type)
   Unlock({{key, intent_type}});
 }
 
-void SharedLockManager::Cleanup(const KeyToIntentTypeMap& key_to_intent_type) {
-  for (const auto& item : key_to_intent_type) {
-    auto it = locks_.find(item.first);
-    it->second->num_using--;
-    if (it->second->num_using == 0) {
-      locks_.erase(it);
-    }
-  }
+void SharedLockManager::UnlockAndCleanup(const std::string& key, IntentType intent_type) {
+  Slice key_slice(key);
+  auto hash = key_slice.hash();
+  auto& shard = shards_[hash % kNumShards];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto* entry = shard.Find(key_slice, hash);
+  DCHECK(entry != nullptr) << "Unlocking key that was not locked: "
+                           << util::FormatBytesAsStr(key);
+  entry->Unlock(intent_type);
+  shard.Release(entry);
 }
 
 }  // namespace docdb
@@ -14,16 +14,19 @@
 #ifndef YB_DOCDB_SHARED_LOCK_MANAGER_H
 #define YB_DOCDB_SHARED_LOCK_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "yb/docdb/shared_lock_manager_fwd.h"
 #include "yb/docdb/lock_batch.h"
+#include "yb/gutil/port.h"
 #include "yb/gutil/spinlock.h"
 #include "yb/util/cross_thread_mutex.h"
+#include "yb/util/slice.h"
 
 namespace yb {
 namespace docdb {
@@ -56,44 +59,78 @@ class SharedLockManager {
   static std::string ToString(const LockState& state);
 
  private:
+  // Number of independent stripes the lock table is split into. Keys are mapped to stripes by
+  // hash, so batches touching unrelated keys do not contend on a single mutex.
+  static constexpr size_t kNumShards = 32;
 
   struct LockEntry {
-    // Taken only for short duration, with no blocking wait.
+    // Protects waiting on cond_var. Only taken when the lock-free fast path fails.
     std::mutex mutex;
 
     std::condition_variable cond_var;
 
-    // Refcounting for garbage collection. Can only be used while the global lock is held.
+    // Refcounting for garbage collection. Can only be used while the shard lock is held.
     size_t num_using = 0;
 
-    // Number of holders for each type
-    std::array<size_t, kIntentTypeMapSize> num_holding;
-    LockState state;
+    // Number of holders for each type, packed into a single word with a fixed number of bits per
+    // intent type, so that uncontended locks can be taken with a single CAS.
+    std::atomic<uint64_t> num_holding{0};
+
+    // Number of threads blocked on cond_var. Unlock only touches the mutex when it is non-zero.
+    std::atomic<size_t> num_waiters{0};
+
+    // The locked key. The buffer is retained when the entry is returned to the free list, so
+    // reusing an entry for a key of similar length does not allocate.
+    std::string key;
+    size_t hash = 0;
+
+    // Next entry in the same hash bucket, or in the shard free list. Guarded by the shard lock.
+    LockEntry* next = nullptr;
 
     void Lock(IntentType lock_type);
 
     void Unlock(IntentType lock_type);
 
-    LockEntry() {
-      num_holding.fill(0);
-    }
+    // Tries to add a holder of the specified type, returns false if it would conflict.
+    bool TryLock(size_t type_idx);
   };
 
-  typedef std::unordered_map<std::string, std::unique_ptr<LockEntry>> LockEntryMap;
+  // Each shard keeps an intrusive, chained hash table of entries that are in use, and a free
+  // list of entries that could be reused, so steady-state locking does not touch the heap.
+  class Shard {
+   public:
+    Shard();
+    ~Shard();
+
+    // Returns the entry for the key, creating or reusing one if necessary, and increments its
+    // refcount.
+    LockEntry* Reserve(Slice key, size_t hash);
+
+    // Returns the entry for the key, that should be already reserved.
+    LockEntry* Find(Slice key, size_t hash);
+
+    // Decrements the entry refcount and recycles the entry when it is no longer used.
+    void Release(LockEntry* entry);
+
+    // Taken only for short duration, with no blocking wait.
+    std::mutex mutex;
+
+   private:
+    LockEntry** BucketFor(size_t hash);
+    void Rehash();
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
-  // as the keys in the batch.
-  std::vector<LockEntry*> Reserve(const KeyToIntentTypeMap& batch);
+    // Power of two sized bucket array, chained through LockEntry::next.
+    std::vector<LockEntry*> buckets_;
+    size_t size_ = 0;
 
-  // Update refcounts and maybe collect garbage.
-  void Cleanup(const KeyToIntentTypeMap& key_to_intent_type);
+    LockEntry* free_list_ = nullptr;
+    size_t free_list_size_ = 0;
+  } CACHELINE_ALIGNED;
 
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
+  // Release the lock on the key, update refcounts and maybe recycle the entry.
+  void UnlockAndCleanup(const std::string& key, IntentType intent_type);
 
-  // Can only be modified if the global mutex is held.
-  LockEntryMap locks_;
+  std::array<Shard, kNumShards> shards_;
 };
 
 extern const std::array<LockState, kIntentTypeMapSize> kIntentConflicts;
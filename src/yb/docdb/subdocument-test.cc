@@ -133,5 +133,52 @@ TEST(SubDocumentTest, Equality) {
   ASSERT_NE(SubDocument({{1, 2}, {3, 4}}), SubDocument({{1, 2}, {5, 4}}));
 }
 
+TEST(SubDocumentTest, ObjectContainer) {
+  constexpr int kNumChildren = 100;
+  SubDocument in_order;
+  for (int i = 0; i != kNumChildren; ++i) {
+    in_order.SetChildPrimitive(PrimitiveValue(i), PrimitiveValue(i * i));
+  }
+  // Children inserted in reverse order end up in the same order.
+  SubDocument reversed;
+  for (int i = kNumChildren; i-- > 0;) {
+    reversed.SetChildPrimitive(PrimitiveValue(i), PrimitiveValue(i * i));
+  }
+  ASSERT_EQ(in_order, reversed);
+  ASSERT_EQ(kNumChildren, in_order.object_num_keys());
+
+  int expected_key = 0;
+  for (const auto& child : in_order.object_container()) {
+    ASSERT_EQ(PrimitiveValue(expected_key), child.first);
+    ASSERT_EQ(PrimitiveValue(expected_key * expected_key), child.second);
+    ++expected_key;
+  }
+  ASSERT_EQ(kNumChildren, expected_key);
+
+  // Overwrite an existing child in the middle.
+  in_order.SetChildPrimitive(PrimitiveValue(50), PrimitiveValue(0));
+  ASSERT_EQ(PrimitiveValue(0), *in_order.GetChild(PrimitiveValue(50)));
+  ASSERT_FALSE(in_order.GetOrAddChild(PrimitiveValue(50)).second);
+  ASSERT_EQ(nullptr, in_order.GetChild(PrimitiveValue(kNumChildren)));
+  ASSERT_EQ(kNumChildren, in_order.object_num_keys());
+
+  SubDocument copy(in_order);
+  ASSERT_EQ(in_order, copy);
+
+  // Remove the last child and a child in the middle.
+  ASSERT_TRUE(copy.DeleteChild(PrimitiveValue(kNumChildren - 1)));
+  ASSERT_FALSE(copy.DeleteChild(PrimitiveValue(kNumChildren - 1)));
+  ASSERT_TRUE(copy.DeleteChild(PrimitiveValue(10)));
+  ASSERT_FALSE(copy.DeleteChild(PrimitiveValue(10)));
+  ASSERT_EQ(kNumChildren - 2, copy.object_num_keys());
+  ASSERT_EQ(nullptr, copy.GetChild(PrimitiveValue(10)));
+  ASSERT_NE(nullptr, copy.GetChild(PrimitiveValue(11)));
+  ASSERT_NE(in_order, copy);
+
+  ASSERT_OK(copy.ConvertToArray());
+  ASSERT_EQ(kNumChildren - 2, static_cast<int>(copy.array_container().size()));
+  ASSERT_EQ(PrimitiveValue(121), copy.array_container()[10]);
+}
+
 } // namespace docdb
 } // namespace yb
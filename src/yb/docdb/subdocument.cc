@@ -13,6 +13,7 @@
 
 #include "yb/docdb/subdocument.h"
 
+#include <algorithm>
 #include <map>
 #include <sstream>
 #include <vector>
@@ -30,6 +31,129 @@ using std::vector;
 namespace yb {
 namespace docdb {
 
+namespace {
+
+// Number of children the flat object container is allocated for on the first insertion.
+constexpr size_t kMinObjectContainerCapacity = 4;
+
+} // namespace
+
+SubDocument::ObjectContainer::ObjectContainer(const ObjectContainer& rhs) {
+  if (rhs.map_) {
+    map_.reset(new Map(*rhs.map_));
+    return;
+  }
+  reserve(rhs.size_);
+  for (; size_ != rhs.size_; ++size_) {
+    new (data_ + size_) value_type(rhs.data_[size_]);
+  }
+}
+
+SubDocument::ObjectContainer::~ObjectContainer() {
+  DestroyFlat();
+}
+
+auto SubDocument::ObjectContainer::LowerBound(const PrimitiveValue& key) const -> value_type* {
+  return std::lower_bound(
+      data_, data_ + size_, key,
+      [](const value_type& entry, const PrimitiveValue& key) { return entry.first < key; });
+}
+
+auto SubDocument::ObjectContainer::find(const PrimitiveValue& key) -> iterator {
+  if (map_) {
+    return iterator(map_->find(key));
+  }
+  auto pos = LowerBound(key);
+  return iterator(pos != data_ + size_ && !(key < pos->first) ? pos : data_ + size_);
+}
+
+auto SubDocument::ObjectContainer::find(const PrimitiveValue& key) const -> const_iterator {
+  if (map_) {
+    return const_iterator(static_cast<const Map&>(*map_).find(key));
+  }
+  auto pos = LowerBound(key);
+  return const_iterator(pos != data_ + size_ && !(key < pos->first) ? pos : data_ + size_);
+}
+
+auto SubDocument::ObjectContainer::emplace(PrimitiveValue key, SubDocument value)
+    -> std::pair<iterator, bool> {
+  if (!map_) {
+    if (size_ == 0 || data_[size_ - 1].first < key) {
+      if (size_ == capacity_) {
+        reserve(std::max(kMinObjectContainerCapacity, capacity_ * 2));
+      }
+      auto result = new (data_ + size_) value_type(std::move(key), std::move(value));
+      ++size_;
+      return std::make_pair(iterator(result), true);
+    }
+    // The last child is not less than the key, so the lower bound is always found.
+    auto pos = LowerBound(key);
+    if (!(key < pos->first)) {
+      return std::make_pair(iterator(pos), false);
+    }
+    ConvertToMap();
+  }
+  auto result = map_->emplace(std::move(key), std::move(value));
+  return std::make_pair(iterator(result.first), result.second);
+}
+
+size_t SubDocument::ObjectContainer::erase(const PrimitiveValue& key) {
+  if (!map_) {
+    auto pos = LowerBound(key);
+    if (pos == data_ + size_ || key < pos->first) {
+      return 0;
+    }
+    if (pos + 1 == data_ + size_) {
+      pos->~value_type();
+      --size_;
+      return 1;
+    }
+    ConvertToMap();
+  }
+  return map_->erase(key);
+}
+
+void SubDocument::ObjectContainer::reserve(size_t capacity) {
+  if (map_ || capacity <= capacity_) {
+    return;
+  }
+  auto new_data = static_cast<value_type*>(::operator new(capacity * sizeof(value_type)));
+  for (size_t i = 0; i != size_; ++i) {
+    // Keys are moved as well, their constness only protects the order of children.
+    new (new_data + i) value_type(
+        std::move(const_cast<PrimitiveValue&>(data_[i].first)), std::move(data_[i].second));
+    data_[i].~value_type();
+  }
+  ::operator delete(data_);
+  data_ = new_data;
+  capacity_ = capacity;
+}
+
+void SubDocument::ObjectContainer::ConvertToMap() {
+  std::unique_ptr<Map> map(new Map());
+  for (size_t i = 0; i != size_; ++i) {
+    map->emplace_hint(
+        map->end(), std::move(const_cast<PrimitiveValue&>(data_[i].first)),
+        std::move(data_[i].second));
+  }
+  DestroyFlat();
+  map_ = std::move(map);
+}
+
+void SubDocument::ObjectContainer::DestroyFlat() {
+  for (size_t i = 0; i != size_; ++i) {
+    data_[i].~value_type();
+  }
+  ::operator delete(data_);
+  data_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+}
+
+bool SubDocument::ObjectContainer::operator==(const ObjectContainer& rhs) const {
+  return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+}
+
 SubDocument::SubDocument(ValueType value_type) : PrimitiveValue(value_type) {
   if (IsObjectType(value_type) ||
       value_type == ValueType::kArray) {
@@ -41,7 +165,10 @@ SubDocument::~SubDocument() {
   switch (type_) {
     case ValueType::kObject: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS:
+    case ValueType::kRedisTSBlocks:
     case ValueType::kRedisSet:
+    case ValueType::kRedisSortedSet:
+    case ValueType::kRedisList:
       if (has_valid_container()) {
         delete &object_container();
       }
@@ -133,6 +260,10 @@ Status SubDocument::ConvertToRedisSet() {
   return ConvertToCollection(ValueType::kRedisSet);
 }
 
+Status SubDocument::ConvertToRedisSortedSet() {
+  return ConvertToCollection(ValueType::kRedisSortedSet);
+}
+
 Status SubDocument::ConvertToArray() {
   if (type_ != ValueType::kObject) {
     return STATUS_FORMAT(
@@ -141,12 +272,12 @@ Status SubDocument::ConvertToArray() {
   if (!has_valid_object_container()) {
     return STATUS(InvalidArgument, "Subdocument doesn't have valid object container");
   }
-  const ObjectContainer& map = object_container();
+  ObjectContainer& map = object_container();
   ArrayContainer* list = new ArrayContainer();
   list->reserve(map.size());
-  // Elements in std::map are ordered by operator< on the key.
+  // Children are ordered by operator< on the key.
   // So iteration goes through sorted key order.
-  for (auto ent : map) {
+  for (auto& ent : map) {
     list->emplace_back(std::move(ent.second));
   }
   type_ = ValueType::kArray;
@@ -187,7 +318,7 @@ pair<SubDocument*, bool> SubDocument::GetOrAddChild(const PrimitiveValue& key) {
   auto& obj_container = object_container();
   auto iter = obj_container.find(key);
   if (iter == obj_container.end()) {
-    auto ret = obj_container.insert(make_pair(key, SubDocument()));
+    auto ret = obj_container.emplace(key, SubDocument());
     CHECK(ret.second);
     return make_pair(&ret.first->second, true);  // New subdocument created.
   } else {
@@ -288,6 +419,18 @@ void SubDocumentToStreamInternal(ostream& out,
       SubDocCollectionToStreamInternal(out, subdoc, indent, "<", ">");
       break;
     }
+    case ValueType::kRedisTSBlocks: {
+      SubDocCollectionToStreamInternal(out, subdoc, indent, "</", "/>");
+      break;
+    }
+    case ValueType::kRedisSortedSet: {
+      SubDocCollectionToStreamInternal(out, subdoc, indent, "(<", ">)");
+      break;
+    }
+    case ValueType::kRedisList: {
+      SubDocCollectionToStreamInternal(out, subdoc, indent, "[<", ">]");
+      break;
+    }
     default:
       LOG(FATAL) << "Invalid subdocument type: " << ToString(subdoc.value_type());
   }
@@ -377,7 +520,7 @@ SubDocument SubDocument::FromQLValuePB(const QLValuePB& value,
   }
 }
 
-void SubDocument::ToQLValuePB(SubDocument doc,
+void SubDocument::ToQLValuePB(const SubDocument& doc,
                               const shared_ptr<QLType>& ql_type,
                               QLValuePB* ql_value) {
   // interpreting empty collections as null values following Cassandra semantics
@@ -441,7 +584,7 @@ void SubDocument::ToQLValuePB(SubDocument doc,
   LOG(FATAL) << "Unsupported datatype in SubDocument: " << ql_type->ToString();
 }
 
-void SubDocument::ToQLExpressionPB(SubDocument doc,
+void SubDocument::ToQLExpressionPB(const SubDocument& doc,
                                    const shared_ptr<QLType>& ql_type,
                                    QLExpressionPB* ql_expr) {
   ToQLValuePB(doc, ql_type, ql_expr->mutable_value());
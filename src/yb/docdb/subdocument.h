@@ -15,6 +15,7 @@
 #define YB_DOCDB_SUBDOCUMENT_H_
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <ostream>
 #include <initializer_list>
@@ -53,21 +54,7 @@ class SubDocument : public PrimitiveValue {
   // A good way to construct single-level subdocuments. Not very performant, primarily useful
   // for tests.
   template<typename T>
-  SubDocument(std::initializer_list<std::initializer_list<T>> elements) {
-    type_ = ValueType::kObject;
-    complex_data_structure_ = nullptr;
-    EnsureContainerAllocated();
-    for (const auto& key_value : elements) {
-      CHECK_EQ(2, key_value.size());
-      auto iter = key_value.begin();
-      const auto& key = *iter;
-      ++iter;
-      const auto& value = *iter;
-      CHECK_EQ(0, object_container().count(PrimitiveValue(key)))
-          << "Duplicate key: " << PrimitiveValue(key).ToString();
-      object_container().emplace(PrimitiveValue(key), SubDocument(PrimitiveValue(value)));
-    }
-  }
+  SubDocument(std::initializer_list<std::initializer_list<T>> elements);
 
   // Move assignment and constructor.
   SubDocument& operator =(SubDocument&& other) {
@@ -87,7 +74,7 @@ class SubDocument : public PrimitiveValue {
   bool operator!=(const SubDocument& other) const { return !(*this == other); }
 
   // "using" did not let us use the alias when instantiating these classes, so we're using typedef.
-  typedef std::map<PrimitiveValue, SubDocument> ObjectContainer;
+  class ObjectContainer;
   typedef std::vector<SubDocument> ArrayContainer;
 
   ObjectContainer& object_container() const {
@@ -108,6 +95,10 @@ class SubDocument : public PrimitiveValue {
   // Assume current subdocument is of map type (kObject type)
   CHECKED_STATUS ConvertToRedisTS();
 
+  // Interpret the SubDocument as a RedisSortedSet.
+  // Assume current subdocument is of map type (kObject type)
+  CHECKED_STATUS ConvertToRedisSortedSet();
+
   // Interpret the SubDocument as an Array.
   // Assume current subdocument is of map type (kObject type)
   CHECKED_STATUS ConvertToArray();
@@ -131,7 +122,7 @@ class SubDocument : public PrimitiveValue {
   void SetChild(const PrimitiveValue& key, SubDocument&& value);
 
   void SetChildPrimitive(const PrimitiveValue& key, PrimitiveValue&& value) {
-    SetChild(key, SubDocument(value));
+    SetChild(key, SubDocument(std::move(value)));
   }
 
   void SetChildPrimitive(const PrimitiveValue& key, const PrimitiveValue& value) {
@@ -146,14 +137,7 @@ class SubDocument : public PrimitiveValue {
   // @return true if a child object was deleted, false if it did not exist.
   bool DeleteChild(const PrimitiveValue& key);
 
-  int object_num_keys() const {
-    DCHECK_EQ(ValueType::kObject, type_);
-    if (!has_valid_object_container()) {
-      return 0;
-    }
-    assert(object_container().size() <= std::numeric_limits<int>::max());
-    return static_cast<int>(object_container().size());
-  }
+  int object_num_keys() const;
 
   // Construct a SubDocument from a QLValuePB.
   static SubDocument FromQLValuePB(const QLValuePB& value,
@@ -161,12 +145,12 @@ class SubDocument : public PrimitiveValue {
                                    WriteAction write_action);
 
   // Construct a QLValuePB from a SubDocument.
-  static void ToQLValuePB(SubDocument doc,
+  static void ToQLValuePB(const SubDocument& doc,
                           const std::shared_ptr<QLType>& ql_type,
                           QLValuePB* v);
 
   // Construct a QLExpressionPB from a SubDocument.
-  static void ToQLExpressionPB(SubDocument doc,
+  static void ToQLExpressionPB(const SubDocument& doc,
                                const std::shared_ptr<QLType>& ql_type,
                                QLExpressionPB* ql_expr);
 
@@ -242,6 +226,140 @@ class SubDocument : public PrimitiveValue {
   friend class InMemDocDbState;
 };
 
+// Children of an object subdocument, ordered by key.
+//
+// Documents are mostly assembled from RocksDB, where children arrive in key order, so children are
+// kept in a flat sorted array that is appended to. That takes a logarithmic number of allocations
+// instead of one map node per child, and keeps children adjacent in memory for iteration. The
+// first insertion out of key order, or removal of a child other than the last one, converts the
+// container to a std::map for the rest of its lifetime.
+class SubDocument::ObjectContainer {
+ public:
+  typedef std::pair<const PrimitiveValue, SubDocument> value_type;
+  typedef std::map<PrimitiveValue, SubDocument> Map;
+
+  template <class Value, class MapIterator>
+  class IteratorBase {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value* pointer;
+    typedef Value& reference;
+
+    IteratorBase() = default;
+    explicit IteratorBase(Value* pos) : pos_(pos) {}
+    explicit IteratorBase(MapIterator map_iter) : map_iter_(map_iter), is_map_(true) {}
+
+    Value& operator*() const { return is_map_ ? *map_iter_ : *pos_; }
+    Value* operator->() const { return &**this; }
+
+    IteratorBase& operator++() {
+      if (is_map_) {
+        ++map_iter_;
+      } else {
+        ++pos_;
+      }
+      return *this;
+    }
+
+    IteratorBase operator++(int) {
+      IteratorBase result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const IteratorBase& rhs) const {
+      return is_map_ ? map_iter_ == rhs.map_iter_ : pos_ == rhs.pos_;
+    }
+
+    bool operator!=(const IteratorBase& rhs) const { return !(*this == rhs); }
+
+   private:
+    Value* pos_ = nullptr;
+    MapIterator map_iter_;
+    bool is_map_ = false;
+  };
+
+  typedef IteratorBase<value_type, Map::iterator> iterator;
+  typedef IteratorBase<const value_type, Map::const_iterator> const_iterator;
+
+  ObjectContainer() = default;
+  ObjectContainer(const ObjectContainer& rhs);
+  ObjectContainer& operator=(const ObjectContainer& rhs) = delete;
+  ~ObjectContainer();
+
+  iterator begin() { return map_ ? iterator(map_->begin()) : iterator(data_); }
+  iterator end() { return map_ ? iterator(map_->end()) : iterator(data_ + size_); }
+
+  const_iterator begin() const {
+    return map_ ? const_iterator(map_->cbegin()) : const_iterator(data_);
+  }
+
+  const_iterator end() const {
+    return map_ ? const_iterator(map_->cend()) : const_iterator(data_ + size_);
+  }
+
+  size_t size() const { return map_ ? map_->size() : size_; }
+  bool empty() const { return size() == 0; }
+
+  iterator find(const PrimitiveValue& key);
+  const_iterator find(const PrimitiveValue& key) const;
+
+  size_t count(const PrimitiveValue& key) const { return find(key) != end() ? 1 : 0; }
+
+  // Same as std::map::emplace: does nothing and returns the existing child when there is already
+  // a child with the same key.
+  std::pair<iterator, bool> emplace(PrimitiveValue key, SubDocument value);
+
+  // Returns the number of removed children.
+  size_t erase(const PrimitiveValue& key);
+
+  // Preallocates room for the specified number of children inserted in key order.
+  void reserve(size_t capacity);
+
+  bool operator==(const ObjectContainer& rhs) const;
+
+ private:
+  value_type* LowerBound(const PrimitiveValue& key) const;
+  void ConvertToMap();
+  void DestroyFlat();
+
+  // Children in key order, while the container is flat.
+  value_type* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+
+  // Children after the container was converted to a map.
+  std::unique_ptr<Map> map_;
+};
+
+template<typename T>
+SubDocument::SubDocument(std::initializer_list<std::initializer_list<T>> elements) {
+  type_ = ValueType::kObject;
+  complex_data_structure_ = nullptr;
+  EnsureContainerAllocated();
+  for (const auto& key_value : elements) {
+    CHECK_EQ(2, key_value.size());
+    auto iter = key_value.begin();
+    const auto& key = *iter;
+    ++iter;
+    const auto& value = *iter;
+    CHECK_EQ(0, object_container().count(PrimitiveValue(key)))
+        << "Duplicate key: " << PrimitiveValue(key).ToString();
+    object_container().emplace(PrimitiveValue(key), SubDocument(PrimitiveValue(value)));
+  }
+}
+
+inline int SubDocument::object_num_keys() const {
+  DCHECK_EQ(ValueType::kObject, type_);
+  if (!has_valid_object_container()) {
+    return 0;
+  }
+  assert(object_container().size() <= std::numeric_limits<int>::max());
+  return static_cast<int>(object_container().size());
+}
+
 std::ostream& operator <<(ostream& out, const SubDocument& subdoc);
 
 static_assert(sizeof(SubDocument) == sizeof(PrimitiveValue),
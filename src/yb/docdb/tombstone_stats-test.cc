@@ -0,0 +1,98 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/tombstone_stats.h"
+#include "yb/docdb/value.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+DECLARE_double(rocksdb_tombstone_compaction_ratio);
+DECLARE_int64(rocksdb_tombstone_compaction_min_count);
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+std::string EncodedKey(int key) {
+  return SubDocKey(DocKey::FromRedisKey(0, std::to_string(key)),
+                   HybridTime::FromMicros(1000)).Encode().data();
+}
+
+class TombstoneStatsTest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+    collector_.reset(TombstoneStatsCollectorFactory()->CreateTablePropertiesCollector(
+        rocksdb::TablePropertiesCollectorFactory::Context()));
+  }
+
+  void Add(int key, const Value& value) {
+    ASSERT_OK(collector_->AddUserKey(EncodedKey(key), value.Encode(), rocksdb::kEntryPut, 0, 0));
+  }
+
+  rocksdb::UserCollectedProperties Finish() {
+    rocksdb::UserCollectedProperties properties;
+    EXPECT_OK(collector_->Finish(&properties));
+    return properties;
+  }
+
+  std::unique_ptr<rocksdb::TablePropertiesCollector> collector_;
+};
+
+} // namespace
+
+TEST_F(TombstoneStatsTest, Simple) {
+  FLAGS_rocksdb_tombstone_compaction_ratio = 0.5;
+  FLAGS_rocksdb_tombstone_compaction_min_count = 3;
+
+  int key = 0;
+  for (int i = 0; i != 4; ++i) {
+    ASSERT_NO_FATALS(Add(++key, Value(PrimitiveValue("value"))));
+  }
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_NO_FATALS(Add(++key, Value(PrimitiveValue(ValueType::kTombstone))));
+  }
+  // 3 of 7 records are tombstones.
+  ASSERT_FALSE(collector_->NeedCompact());
+
+  ASSERT_NO_FATALS(Add(++key, Value(PrimitiveValue(ValueType::kTombstone))));
+  ASSERT_TRUE(collector_->NeedCompact());
+
+  const auto properties = Finish();
+  ASSERT_EQ(8, NumRecords(properties));
+  ASSERT_EQ(4, NumTombstones(properties));
+
+  FLAGS_rocksdb_tombstone_compaction_min_count = 5;
+  ASSERT_FALSE(collector_->NeedCompact());
+
+  FLAGS_rocksdb_tombstone_compaction_min_count = 3;
+  FLAGS_rocksdb_tombstone_compaction_ratio = 0;
+  ASSERT_FALSE(collector_->NeedCompact());
+}
+
+TEST_F(TombstoneStatsTest, Empty) {
+  const auto properties = Finish();
+  ASSERT_EQ(0, NumRecords(properties));
+  ASSERT_EQ(0, NumTombstones(properties));
+  ASSERT_FALSE(collector_->NeedCompact());
+}
+
+} // namespace docdb
+} // namespace yb
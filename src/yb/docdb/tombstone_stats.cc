@@ -0,0 +1,137 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/tombstone_stats.h"
+
+#include <algorithm>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "yb/docdb/value.h"
+#include "yb/docdb/value_type.h"
+#include "yb/rocksdb/util/coding.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_double(rocksdb_tombstone_compaction_ratio, 0.5,
+              "Mark an SST file for compaction when tombstones make up at least this fraction of "
+              "its records. Not positive values disable marking files by their tombstones.");
+TAG_FLAG(rocksdb_tombstone_compaction_ratio, advanced);
+TAG_FLAG(rocksdb_tombstone_compaction_ratio, runtime);
+
+DEFINE_int64(rocksdb_tombstone_compaction_min_count, 10000,
+             "Min number of tombstones in an SST file for it to be marked for compaction.");
+TAG_FLAG(rocksdb_tombstone_compaction_min_count, advanced);
+TAG_FLAG(rocksdb_tombstone_compaction_min_count, runtime);
+
+namespace yb {
+namespace docdb {
+
+const char* const kNumRecordsProperty = "yb.num_records";
+const char* const kNumTombstonesProperty = "yb.num_tombstones";
+
+namespace {
+
+class TombstoneStatsCollector : public rocksdb::TablePropertiesCollector {
+ public:
+  Status AddUserKey(const Slice& key, const Slice& value, rocksdb::EntryType type,
+                    rocksdb::SequenceNumber seq, uint64_t file_size) override {
+    if (key.empty() || static_cast<ValueType>(key[0]) == ValueType::kIntentPrefix) {
+      return Status::OK();
+    }
+    ++num_records_;
+    ValueType value_type;
+    if (Value::DecodePrimitiveValueType(value, &value_type).ok() &&
+        value_type == ValueType::kTombstone) {
+      ++num_tombstones_;
+    }
+    return Status::OK();
+  }
+
+  Status Finish(rocksdb::UserCollectedProperties* properties) override {
+    if (num_records_ == 0) {
+      return Status::OK();
+    }
+    std::string encoded;
+    rocksdb::PutVarint64(&encoded, num_records_);
+    properties->emplace(kNumRecordsProperty, encoded);
+    encoded.clear();
+    rocksdb::PutVarint64(&encoded, num_tombstones_);
+    properties->emplace(kNumTombstonesProperty, std::move(encoded));
+    return Status::OK();
+  }
+
+  rocksdb::UserCollectedProperties GetReadableProperties() const override {
+    return {{kNumRecordsProperty, std::to_string(num_records_)},
+            {kNumTombstonesProperty, std::to_string(num_tombstones_)}};
+  }
+
+  bool NeedCompact() const override {
+    const double ratio = FLAGS_rocksdb_tombstone_compaction_ratio;
+    const auto min_count = std::max<int64_t>(FLAGS_rocksdb_tombstone_compaction_min_count, 1);
+    return ratio > 0 && num_tombstones_ >= static_cast<uint64_t>(min_count) &&
+           num_tombstones_ >= ratio * num_records_;
+  }
+
+  const char* Name() const override {
+    return "TombstoneStatsCollector";
+  }
+
+ private:
+  uint64_t num_records_ = 0;
+  uint64_t num_tombstones_ = 0;
+};
+
+class TombstoneStatsCollectorFactoryImpl : public rocksdb::TablePropertiesCollectorFactory {
+ public:
+  rocksdb::TablePropertiesCollector* CreateTablePropertiesCollector(
+      rocksdb::TablePropertiesCollectorFactory::Context context) override {
+    return new TombstoneStatsCollector();
+  }
+
+  const char* Name() const override {
+    return "TombstoneStatsCollectorFactory";
+  }
+};
+
+uint64_t DecodeCounter(const rocksdb::UserCollectedProperties& properties, const char* name) {
+  auto it = properties.find(name);
+  if (it == properties.end()) {
+    return 0;
+  }
+  Slice encoded(it->second);
+  uint64_t result = 0;
+  if (!rocksdb::GetVarint64(&encoded, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+} // namespace
+
+std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> TombstoneStatsCollectorFactory() {
+  static std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> instance =
+      std::make_shared<TombstoneStatsCollectorFactoryImpl>();
+  return instance;
+}
+
+uint64_t NumTombstones(const rocksdb::UserCollectedProperties& properties) {
+  return DecodeCounter(properties, kNumTombstonesProperty);
+}
+
+uint64_t NumRecords(const rocksdb::UserCollectedProperties& properties) {
+  return DecodeCounter(properties, kNumRecordsProperty);
+}
+
+} // namespace docdb
+} // namespace yb
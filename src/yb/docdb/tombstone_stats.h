@@ -0,0 +1,45 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_TOMBSTONE_STATS_H
+#define YB_DOCDB_TOMBSTONE_STATS_H
+
+#include <memory>
+
+#include "yb/rocksdb/table_properties.h"
+
+namespace yb {
+namespace docdb {
+
+// Names of the user collected table properties of an SST file that keep the number of its regular
+// records and the number of tombstones among them.
+extern const char* const kNumRecordsProperty;
+extern const char* const kNumTombstonesProperty;
+
+// Counts tombstones of each SST file. Provisional records of transactions are not counted.
+//
+// A file is marked for compaction when it has at least --rocksdb_tombstone_compaction_min_count
+// tombstones and they make up at least --rocksdb_tombstone_compaction_ratio of its records, so
+// that ranges full of deleted rows, which readers have to skip, are compacted away early.
+std::shared_ptr<rocksdb::TablePropertiesCollectorFactory> TombstoneStatsCollectorFactory();
+
+// Returns the number of tombstones in an SST file with the specified properties.
+uint64_t NumTombstones(const rocksdb::UserCollectedProperties& properties);
+
+// Returns the number of regular records in an SST file with the specified properties.
+uint64_t NumRecords(const rocksdb::UserCollectedProperties& properties);
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_TOMBSTONE_STATS_H
@@ -26,6 +26,7 @@ string ToString(ValueType value_type) {
     case ValueType::kGroupEnd: return "GroupEnd";
     case ValueType::kGroupEndDescending: return "GroupEndDescending";
     case ValueType::kIntentPrefix: return "IntentPrefix";
+    case ValueType::kTableId: return "TableId";
     case ValueType::kNull: return "Null";
     case ValueType::kNullDescending: return "NullDescending";
     case ValueType::kFalse: return "False";
@@ -35,6 +36,7 @@ string ToString(ValueType value_type) {
     case ValueType::kInt64Descending: return "Int64Descending";
     case ValueType::kInt32Descending: return "Int32Descending";
     case ValueType::kInt64: return "Int64";
+    case ValueType::kInt64Delta: return "Int64Delta";
     case ValueType::kInt32: return "Int32";
     case ValueType::kDouble: return "Double";
     case ValueType::kDoubleDescending: return "DoubleDescending";
@@ -54,7 +56,14 @@ string ToString(ValueType value_type) {
     case ValueType::kUInt16Hash: return "UInt16Hash";
     case ValueType::kObject: return "Object";
     case ValueType::kRedisSet: return "RedisSet";
+    case ValueType::kRedisSortedSet: return "RedisSortedSet";
+    case ValueType::kSSForward: return "SSForward";
+    case ValueType::kRedisCardinality: return "RedisCardinality";
+    case ValueType::kRedisList: return "RedisList";
+    case ValueType::kRedisListBounds: return "RedisListBounds";
+    case ValueType::kSSReverse: return "SSReverse";
     case ValueType::kRedisTS: return "RedisTimeseries";
+    case ValueType::kRedisTSBlocks: return "RedisTimeseriesBlocks";
     case ValueType::kArray: return "Array";
     case ValueType::kArrayIndex: return "ArrayIndex";
     case ValueType::kTombstone: return "Tombstone";
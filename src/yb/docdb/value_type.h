@@ -55,11 +55,22 @@ enum class ValueType : char {
   // Null must be lower than the other primitive types so that it compares as smaller than them.
   // It is used for frozen CQL user-defined types (which can contain null elements) on ASC columns.
   kNull = '$',  // ASCII code 36
+  // Subkey of the number of entries of a redis hash or set.
+  kRedisCardinality = '%', // ASCII code 37
+  // Subkeys of the score -> member and member -> score parts of a redis sorted set.
+  kSSForward = '&', // ASCII code 38
+  kSSReverse = '\'', // ASCII code 39
   kRedisSet = '(', // ASCII code 40
+  kRedisSortedSet = ')', // ASCII code 41
+  // Subkey of the head and tail indexes of a redis list.
+  kRedisListBounds = '*', // ASCII code 42
   // This is the redis timeseries type.
   kRedisTS = '+', // ASCII code 43
+  kRedisList = ',', // ASCII code 44
   kInetaddress = '-',  // ASCII code 45
   kInetaddressDescending = '.',  // ASCII code 46
+  // Redis timeseries stored in compressed blocks of points.
+  kRedisTSBlocks = '/', // ASCII code 47
   kFrozen = '<', // ASCII code 60
   kFrozenDescending = '>', // ASCII code 62
   kArray = 'A',  // ASCII code 65.
@@ -74,8 +85,14 @@ enum class ValueType : char {
   kColumnId = 'K',  // ASCII code 75
   kDoubleDescending = 'L',  // ASCII code 76
   kFloatDescending = 'M', // ASCII code 77
+  // An amount added to the previous value of an int64 column, written by a counter update that
+  // does not read the column. Only used in values.
+  kInt64Delta = 'N',  // ASCII code 78
   kString = 'S',  // ASCII code 83
   kTrue = 'T',  // ASCII code 84
+  // Prefix of the document key of a table that shares its tablet with other tables, followed by
+  // the 16 bytes of the table id.
+  kTableId = 'V',  // ASCII code 86
   kTombstone = 'X',  // ASCII code 88
   kArrayIndex = '[',  // ASCII code 91.
 
@@ -176,17 +193,20 @@ constexpr ValueType kMaxPrimitiveValueType = ValueType::kNullDescending;
 
 std::string ToString(ValueType value_type);
 
-// kArray is handled slightly differently and hence we only have kObject, kRedisTS and kRedisSet.
+// kArray is handled slightly differently and hence we only have kObject, kRedisTS,
+// kRedisTSBlocks, kRedisSet, kRedisSortedSet and kRedisList.
 constexpr inline bool IsObjectType(const ValueType value_type) {
   return value_type == ValueType::kRedisTS || value_type == ValueType::kObject ||
-      value_type == ValueType::kRedisSet;
+      value_type == ValueType::kRedisSet || value_type == ValueType::kRedisSortedSet ||
+      value_type == ValueType::kRedisList || value_type == ValueType::kRedisTSBlocks;
 }
 
 constexpr inline bool IsPrimitiveValueType(const ValueType value_type) {
   return kMinPrimitiveValueType <= value_type && value_type <= kMaxPrimitiveValueType &&
          !IsObjectType(value_type) &&
          value_type != ValueType::kArray &&
-         value_type != ValueType::kTombstone;
+         value_type != ValueType::kTombstone &&
+         value_type != ValueType::kTableId;
 }
 
 // Decode the first byte of the given slice as a ValueType.
@@ -627,6 +627,9 @@ bool AsyncAddServerTask::PrepareRequest(int attempt) {
     return false;
   }
   *peer->mutable_last_known_addr() = peer_reg.common().rpc_addresses(0);
+  if (peer_reg.common().has_cloud_info()) {
+    *peer->mutable_cloud_info() = peer_reg.common().cloud_info();
+  }
 
   return true;
 }
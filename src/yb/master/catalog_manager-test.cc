@@ -100,6 +100,32 @@ TEST(TableInfoTest, TestAssignmentRanges) {
   }
 }
 
+TEST(TabletInfoTest, TestCachedLocations) {
+  scoped_refptr<TableInfo> table(new TableInfo(CURRENT_TEST_NAME()));
+  scoped_refptr<TabletInfo> tablet(new TabletInfo(table, "tablet"));
+  const int64_t kTSVersion = 1;
+
+  TabletInfo::ReplicaMap locs;
+  int64_t locs_version;
+  tablet->GetReplicaLocations(&locs, &locs_version);
+  ASSERT_EQ(nullptr, tablet->GetCachedLocations(kTSVersion));
+
+  auto locations = std::make_shared<TabletLocationsPB>();
+  locations->set_tablet_id(tablet->tablet_id());
+  tablet->SetCachedLocations(locations, locs_version, kTSVersion);
+  ASSERT_EQ(locations, tablet->GetCachedLocations(kTSVersion));
+
+  // A tablet server registration invalidates the locations.
+  ASSERT_EQ(nullptr, tablet->GetCachedLocations(kTSVersion + 1));
+
+  // So does an update of the replica locations.
+  TSDescriptor ts_desc("ts");
+  TabletReplica replica;
+  replica.ts_desc = &ts_desc;
+  ASSERT_TRUE(tablet->AddToReplicaLocations(replica));
+  ASSERT_EQ(nullptr, tablet->GetCachedLocations(kTSVersion));
+}
+
 TEST(TestTSDescriptor, TestReplicaCreationsDecay) {
   TSDescriptor ts("test");
   ASSERT_EQ(0, ts.RecentReplicaCreations());
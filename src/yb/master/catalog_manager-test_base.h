@@ -132,6 +132,12 @@ class TestLoadBalancerBase {
     PrepareTestState(ts_descs);
     TestBalancingLeaders();
 
+    PrepareTestState(ts_descs);
+    TestBalancingLeadersByTabletLoad();
+
+    PrepareTestState(ts_descs);
+    TestBalancingLeadersWithAffinitizedZones();
+
     gflags::SetCommandLineOption("leader_balance_threshold", "2");
     PrepareTestState(ts_descs);
     TestBalancingLeadersWithThreshold();
@@ -680,6 +686,86 @@ class TestLoadBalancerBase {
     ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
   }
 
+  void TestBalancingLeadersByTabletLoad() {
+    LOG(INFO) << "Testing moving leaders of hot tablets";
+    // Leaders are placed round robin, so ts0 leads tablets 0 and 3, which are the hot ones.
+    SetTabletOpsPerSec(ts_descs_[0].get(), tablets_[0]->tablet_id(), 1000);
+    SetTabletOpsPerSec(ts_descs_[0].get(), tablets_[3]->tablet_id(), 1000);
+    SetTabletOpsPerSec(ts_descs_[1].get(), tablets_[1]->tablet_id(), 10);
+    SetTabletOpsPerSec(ts_descs_[2].get(), tablets_[2]->tablet_id(), 10);
+    LOG(INFO) << "Leader distribution: 2 1 1. Leader ops: 2000 10 10";
+
+    // The number of leaders is balanced, so nothing moves unless the tablet load is used.
+    AnalyzeTablets();
+    string placeholder, tablet_id, from_ts, to_ts;
+    ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
+
+    gflags::SetCommandLineOption("load_balancer_use_tablet_load", "true");
+    ResetState();
+    AnalyzeTablets();
+
+    // One of the hot leaders should be moved off ts0.
+    ASSERT_TRUE(HandleLeaderMoves(&tablet_id, &from_ts, &to_ts));
+    ASSERT_EQ(ts_descs_[0]->permanent_uuid(), from_ts);
+    ASSERT_NE(ts_descs_[0]->permanent_uuid(), to_ts);
+    ASSERT_TRUE(tablet_id == tablets_[0]->tablet_id() || tablet_id == tablets_[3]->tablet_id());
+
+    // The remaining hot leader should stay on ts0, as moving it would not reduce the imbalance.
+    while (HandleLeaderMoves(&tablet_id, &from_ts, &to_ts)) {
+      ASSERT_NE(ts_descs_[0]->permanent_uuid(), from_ts);
+    }
+    ASSERT_EQ(1, cb_->state_->GetLeaderLoad(ts_descs_[0]->permanent_uuid()));
+
+    gflags::SetCommandLineOption("load_balancer_use_tablet_load", "false");
+    for (const auto& ts_desc : ts_descs_) {
+      ts_desc->tablet_loads_.clear();
+    }
+  }
+
+  void TestBalancingLeadersWithAffinitizedZones() {
+    LOG(INFO) << "Testing moving leaders into the affinitized zones";
+    AddAffinitizedZone("a");
+    AddAffinitizedZone("b");
+    LOG(INFO) << "Leader distribution: 2 1 1. Affinitized zones: a b";
+
+    AnalyzeTablets();
+
+    // The leader on ts2 should be moved to the least loaded server in the affinitized zones, and
+    // the leaders are then balanced between ts0 and ts1.
+    string placeholder, tablet_id;
+    TestMoveLeader(&tablet_id, ts_descs_[2]->permanent_uuid(), ts_descs_[1]->permanent_uuid());
+    ASSERT_EQ(tablets_[2]->tablet_id(), tablet_id);
+    ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
+
+    // With a single affinitized zone, all the leaders end up on ts0.
+    affinitized_zones_.clear();
+    AddAffinitizedZone("a");
+    LOG(INFO) << "Leader distribution: 2 1 1. Affinitized zones: a";
+
+    ResetState();
+    AnalyzeTablets();
+
+    TestMoveLeader(&placeholder, "", ts_descs_[0]->permanent_uuid());
+    TestMoveLeader(&placeholder, "", ts_descs_[0]->permanent_uuid());
+    ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
+    ASSERT_EQ(4, cb_->state_->GetLeaderLoad(ts_descs_[0]->permanent_uuid()));
+
+    // When no live server is in the affinitized zones, the leaders are balanced as usual.
+    for (const auto tablet : tablets_) {
+      MoveTabletLeader(tablet.get(), ts_descs_[0]);
+    }
+    affinitized_zones_.clear();
+    AddAffinitizedZone("d");
+    LOG(INFO) << "Leader distribution: 4 0 0. Affinitized zones: d";
+
+    ResetState();
+    AnalyzeTablets();
+
+    TestMoveLeader(&placeholder, ts_descs_[0]->permanent_uuid(), "");
+    TestMoveLeader(&placeholder, ts_descs_[0]->permanent_uuid(), "");
+    ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
+  }
+
   // Methods to prepare the state of the current test.
   void PrepareTestState(const TSDescriptorVector& ts_descs) {
     // Clear old state.
@@ -733,6 +819,14 @@ class TestLoadBalancerBase {
     return ts;
   }
 
+  void AddAffinitizedZone(const string& az) {
+    CloudInfoPB ci;
+    ci.set_placement_cloud("aws");
+    ci.set_placement_region("us-west-1");
+    ci.set_placement_zone(az);
+    affinitized_zones_.insert(ci);
+  }
+
   void SetupClusterConfig(bool multi_az) {
     cluster_placement_.set_num_replicas(kNumReplicas);
     auto pb = cluster_placement_.add_placement_blocks();
@@ -816,6 +910,10 @@ class TestLoadBalancerBase {
     tablet->SetReplicaLocations(replicas);
   }
 
+  void SetTabletOpsPerSec(TSDescriptor* ts_desc, const TabletId& tablet_id, double ops_per_sec) {
+    ts_desc->tablet_loads_[tablet_id].load.read_ops_per_sec = ops_per_sec;
+  }
+
   void MoveTabletLeader(TabletInfo* tablet, std::shared_ptr<TSDescriptor> ts_desc) {
     TabletInfo::ReplicaMap replicas;
     tablet->GetReplicaLocations(&replicas);
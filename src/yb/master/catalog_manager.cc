@@ -1015,17 +1015,13 @@ Status CatalogManager::PrepareSystemTable(const TableName& table_name,
   LOG (INFO) << "Inserted new table and tablet info into CatalogManager maps";
 
   // Write Tablets to sys-tablets (in "running" state since we don't want the loadbalancer to
-  // assign these tablets since this table is virtual)
+  // assign these tablets since this table is virtual), together with the "running" table.
   for (TabletInfo *tablet : tablets) {
     tablet->mutable_metadata()->mutable_dirty()->pb.set_state(SysTabletsEntryPB::RUNNING);
   }
-  RETURN_NOT_OK(sys_catalog_->AddItems(tablets));
-  LOG (INFO) << "Wrote tablets to system catalog";
-
-  // Update the on-disk table state to "running".
   table->mutable_metadata()->mutable_dirty()->pb.set_state(SysTablesEntryPB::RUNNING);
-  RETURN_NOT_OK(sys_catalog_->AddItem(table.get()));
-  LOG (INFO) << "Wrote table to system catalog";
+  RETURN_NOT_OK(sys_catalog_->AddItems(tablets, std::vector<TableInfo*>{ table.get() }));
+  LOG (INFO) << "Wrote table and tablets to system catalog";
 
   // Commit the in-memory state.
   table->mutable_metadata()->CommitMutation();
@@ -1308,6 +1304,17 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
 
   Schema schema = client_schema.CopyWithColumnIds();
 
+  // For an index table, map its columns to the columns of the indexed table.
+  if (req.has_index_info()) {
+    s = FillIndexInfo(schema, req.name(), req.mutable_index_info());
+    if (!s.ok()) {
+      SetupError(resp->mutable_error(),
+                 s.IsNotFound() ? MasterErrorPB::TABLE_NOT_FOUND : MasterErrorPB::INVALID_SCHEMA,
+                 s);
+      return s;
+    }
+  }
+
   // Create partitions.
   PartitionSchema partition_schema;
   vector<Partition> partitions;
@@ -1473,21 +1480,10 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
     CHECK_EQ(SysTabletsEntryPB::PREPARING, tablet->metadata().dirty().pb.state());
   }
 
-  // Write Tablets to sys-tablets (in "preparing" state)
-  s = sys_catalog_->AddItems(tablets);
-  if (!s.ok()) {
-    s = s.CloneAndPrepend(Substitute("An error occurred while inserting to sys-tablets: $0",
-                                     s.ToString()));
-    LOG(WARNING) << s.ToString();
-    AbortTableCreation(table.get(), tablets);
-    CheckIfNoLongerLeaderAndSetupError(s, resp);
-    return s;
-  }
-  TRACE("Wrote tablets to system table");
-
-  // Update the on-disk table state to "running".
+  // Write Tablets to sys-tablets (in "preparing" state) and the table (in "running" state) in a
+  // single write, so creating a table with many tablets takes one round of replication.
   table->mutable_metadata()->mutable_dirty()->pb.set_state(SysTablesEntryPB::RUNNING);
-  s = sys_catalog_->AddItem(table.get());
+  s = sys_catalog_->AddItems(tablets, std::vector<TableInfo*>{ table.get() });
   if (!s.ok()) {
     s = s.CloneAndPrepend(Substitute("An error occurred while inserting to sys-tablets: $0",
                                      s.ToString()));
@@ -1496,7 +1492,7 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
     CheckIfNoLongerLeaderAndSetupError(s, resp);
     return s;
   }
-  TRACE("Wrote table to system table");
+  TRACE("Wrote table and tablets to system table");
 
   // Commit the in-memory state.
   table->mutable_metadata()->CommitMutation();
@@ -1509,6 +1505,106 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
   LOG(INFO) << "Successfully created table " << table->ToString()
             << " per request from " << RequestorString(rpc);
   background_tasks_->Wake();
+
+  // Add the new index to the indexed table.
+  if (req.has_index_info()) {
+    IndexInfoPB index_info = req.index_info();
+    index_info.set_table_id(table->id());
+    s = UpdateIndexesOfTable(index_info.indexed_table_id(), [&index_info](SysTablesEntryPB* pb) {
+      pb->add_indexes()->Swap(&index_info);
+    });
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to add index " << table->ToString() << " to the indexed table: "
+                   << s.ToString();
+      CheckIfNoLongerLeaderAndSetupError(s, resp);
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status CatalogManager::FillIndexInfo(const Schema& index_schema,
+                                     const TableName& index_name,
+                                     IndexInfoPB* index_info) {
+  scoped_refptr<TableInfo> indexed_table;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    indexed_table = FindPtrOrNull(table_ids_map_, index_info->indexed_table_id());
+  }
+  if (indexed_table == nullptr) {
+    return STATUS(NotFound, "The indexed table does not exist", index_info->indexed_table_id());
+  }
+
+  auto l = indexed_table->LockForRead();
+  if (l->data().started_deleting()) {
+    return STATUS(NotFound, "The indexed table was deleted", l->data().pb.state_msg());
+  }
+  Schema indexed_schema;
+  RETURN_NOT_OK(SchemaFromPB(l->data().pb.schema(), &indexed_schema));
+
+  // The index columns are copies of the indexed table's columns with the same names.
+  index_info->set_table_name(index_name);
+  index_info->clear_columns();
+  for (size_t idx = 0; idx < index_schema.num_columns(); idx++) {
+    const ColumnSchema& column = index_schema.column(idx);
+    const int indexed_idx = indexed_schema.find_column(column.name());
+    if (indexed_idx == Schema::kColumnNotFound) {
+      return STATUS(InvalidArgument, "Index column not found in the indexed table", column.name());
+    }
+    // The tablet servers maintain the index entries from whole column values of the row.
+    const ColumnSchema& indexed_column = indexed_schema.column(indexed_idx);
+    if (indexed_column.is_static() || indexed_column.is_counter() ||
+        indexed_column.type()->IsParametric()) {
+      return STATUS(InvalidArgument, "Static, counter and collection columns cannot be indexed",
+                    column.name());
+    }
+    IndexInfoPB::IndexColumnPB* index_column = index_info->add_columns();
+    index_column->set_column_id(index_schema.column_id(idx));
+    index_column->set_indexed_column_id(indexed_schema.column_id(indexed_idx));
+  }
+  index_info->set_hash_column_count(index_schema.num_hash_key_columns());
+  index_info->set_range_column_count(index_schema.num_range_key_columns());
+  return Status::OK();
+}
+
+Status CatalogManager::UpdateIndexesOfTable(
+    const TableId& table_id, const std::function<void(SysTablesEntryPB*)>& update) {
+  scoped_refptr<TableInfo> table;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    table = FindPtrOrNull(table_ids_map_, table_id);
+  }
+  if (table == nullptr) {
+    return STATUS(NotFound, "The table does not exist", table_id);
+  }
+
+  TRACE("Locking table");
+  auto l = table->LockForWrite();
+  if (l->data().started_deleting()) {
+    return STATUS(NotFound, "The table was deleted", l->data().pb.state_msg());
+  }
+
+  // Bump the version like AlterTable does. The tablets then reject the writes of the clients
+  // that have not seen the new indexes yet with a schema version mismatch.
+  update(&l->mutable_data()->pb);
+  l->mutable_data()->pb.set_version(l->mutable_data()->pb.version() + 1);
+  l->mutable_data()->set_state(SysTablesEntryPB::ALTERING,
+                               Substitute("Update indexes version=$0 ts=$1",
+                                          l->mutable_data()->pb.version(),
+                                          LocalTimeAsString()));
+
+  TRACE("Updating metadata on disk");
+  Status s = sys_catalog_->UpdateItem(table.get());
+  if (!s.ok()) {
+    return s.CloneAndPrepend(
+        Substitute("An error occurred while updating sys-catalog tables entry: $0",
+                   s.ToString()));
+  }
+
+  TRACE("Committing in-memory state");
+  l->Commit();
+
+  SendAlterTableRequest(table);
   return Status::OK();
 }
 
@@ -1602,6 +1698,10 @@ TableInfo *CatalogManager::CreateTableInfo(const CreateTableRequestPB& req,
   // whereas the user request PB does not.
   CHECK_OK(SchemaToPB(schema, metadata->mutable_schema()));
   partition_schema.ToPB(metadata->mutable_partition_schema());
+  if (req.has_index_info()) {
+    metadata->mutable_index_info()->CopyFrom(req.index_info());
+    metadata->mutable_index_info()->set_table_id(table->id());
+  }
   return table;
 }
 
@@ -1725,6 +1825,8 @@ Status CatalogManager::DeleteTable(const DeleteTableRequestPB* req,
 
   table->AbortTasks();
   scoped_refptr<DeletedTableInfo> deleted_table(new DeletedTableInfo(table.get()));
+  const auto indexes = l->data().pb.indexes();
+  const IndexInfoPB index_info = l->data().pb.index_info();
 
   // Update the internal table maps.
   {
@@ -1751,6 +1853,37 @@ Status CatalogManager::DeleteTable(const DeleteTableRequestPB* req,
   LOG(INFO) << "Successfully deleted table " << table->ToString()
             << " per request from " << RequestorString(rpc);
   background_tasks_->Wake();
+
+  // Delete the indexes of the table along with it.
+  for (const IndexInfoPB& index : indexes) {
+    DeleteTableRequestPB index_req;
+    DeleteTableResponsePB index_resp;
+    index_req.mutable_table()->set_table_id(index.table_id());
+    s = DeleteTable(&index_req, &index_resp, rpc);
+    if (!s.ok() && !s.IsNotFound()) {
+      LOG(WARNING) << "Failed to delete index " << index.table_id() << ": " << s.ToString();
+    }
+  }
+
+  // Remove a deleted index from its indexed table unless that is being deleted too.
+  if (index_info.has_indexed_table_id()) {
+    const TableId index_id = table->id();
+    s = UpdateIndexesOfTable(index_info.indexed_table_id(), [&index_id](SysTablesEntryPB* pb) {
+      auto* indexes = pb->mutable_indexes();
+      for (auto it = indexes->begin(); it != indexes->end(); ++it) {
+        if (it->table_id() == index_id) {
+          indexes->erase(it);
+          break;
+        }
+      }
+    });
+    if (!s.ok() && !s.IsNotFound()) {
+      LOG(WARNING) << "Failed to remove index " << table->ToString()
+                   << " from the indexed table: " << s.ToString();
+      CheckIfNoLongerLeaderAndSetupError(s, resp);
+      return s;
+    }
+  }
   return Status::OK();
 }
 
@@ -2157,6 +2290,10 @@ Status CatalogManager::GetTableSchema(const GetTableSchemaRequestPB* req,
   resp->mutable_identifier()->set_table_id(table->id());
   resp->mutable_identifier()->mutable_namespace_()->set_id(table->namespace_id());
   resp->set_version(l->data().pb.version());
+  resp->mutable_indexes()->CopyFrom(l->data().pb.indexes());
+  if (l->data().pb.has_index_info()) {
+    resp->mutable_index_info()->CopyFrom(l->data().pb.index_info());
+  }
 
   // Get namespace name by id.
   boost::shared_lock<LockType> l_map(lock_);
@@ -2340,12 +2477,33 @@ Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
   // the server should have, compare vs the ones being reported, and somehow mark
   // any that have been "lost" (eg somehow the tablet metadata got corrupted or something).
 
+  // Tablets changed by the report stay locked until they are written to the sys catalog in a
+  // single write. They are handled in id order, so concurrent reports lock them in the same order.
+  std::vector<const ReportedTabletPB*> reported_tablets;
+  reported_tablets.reserve(report.updated_tablets_size());
   for (const ReportedTabletPB& reported : report.updated_tablets()) {
+    reported_tablets.push_back(&reported);
+  }
+  std::sort(reported_tablets.begin(), reported_tablets.end(),
+            [](const ReportedTabletPB* lhs, const ReportedTabletPB* rhs) {
+    return lhs->tablet_id() < rhs->tablet_id();
+  });
+
+  ReportedTabletUpdates updates;
+  for (const ReportedTabletPB* reported : reported_tablets) {
+    if (!updates.empty() && updates.back().tablet->tablet_id() == reported->tablet_id()) {
+      // The same tablet is reported twice, so it should be written before it is locked again.
+      RETURN_NOT_OK(CommitReportedTablets(&updates));
+    }
     ReportedTabletUpdatesPB *tablet_report = report_update->add_tablets();
-    tablet_report->set_tablet_id(reported.tablet_id());
-    RETURN_NOT_OK_PREPEND(HandleReportedTablet(ts_desc, reported, tablet_report),
-                          Substitute("Error handling $0", reported.ShortDebugString()));
+    tablet_report->set_tablet_id(reported->tablet_id());
+    Status s = HandleReportedTablet(ts_desc, *reported, tablet_report, &updates);
+    if (!s.ok()) {
+      WARN_NOT_OK(CommitReportedTablets(&updates), "Failed to write reported tablets");
+      return s.CloneAndPrepend(Substitute("Error handling $0", reported->ShortDebugString()));
+    }
   }
+  RETURN_NOT_OK(CommitReportedTablets(&updates));
 
   ts_desc->set_has_tablet_report(true);
 
@@ -2374,9 +2532,54 @@ bool ShouldTransitionTabletToRunning(const ReportedTabletPB& report) {
 }
 }  // anonymous namespace
 
+Status CatalogManager::CommitReportedTablets(ReportedTabletUpdates* updates) {
+  if (updates->empty()) {
+    return Status::OK();
+  }
+  vector<TabletInfo*> tablets;
+  tablets.reserve(updates->size());
+  for (const auto& update : *updates) {
+    tablets.push_back(update.tablet.get());
+  }
+  Status s = sys_catalog_->UpdateItems(tablets);
+  if (!s.ok()) {
+    LOG(WARNING) << "Error updating " << tablets.size() << " reported tablets: " << s.ToString();
+    updates->clear();
+    return s;
+  }
+  for (auto& update : *updates) {
+    update.tablet_lock->Commit();
+  }
+
+  Status result;
+  for (const auto& update : *updates) {
+    s = FinishReportedTablet(update.tablet, *update.report, update.needs_alter);
+    if (result.ok()) {
+      result = s;
+    }
+  }
+  updates->clear();
+  return result;
+}
+
+Status CatalogManager::FinishReportedTablet(const scoped_refptr<TabletInfo>& tablet,
+                                            const ReportedTabletPB& report,
+                                            bool tablet_needs_alter) {
+  // Need to defer the AlterTable command to after we've committed the new tablet data,
+  // since the tablet report may also be updating the raft config, and the Alter Table
+  // request needs to know who the most recent leader is.
+  if (tablet_needs_alter) {
+    SendAlterTabletRequest(tablet);
+  } else if (report.has_schema_version()) {
+    RETURN_NOT_OK(HandleTabletSchemaVersionReport(tablet.get(), report.schema_version()));
+  }
+  return Status::OK();
+}
+
 Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
                                             const ReportedTabletPB& report,
-                                            ReportedTabletUpdatesPB *report_updates) {
+                                            ReportedTabletUpdatesPB *report_updates,
+                                            ReportedTabletUpdates* updates) {
   TRACE_EVENT1("master", "HandleReportedTablet",
                "tablet_id", report.tablet_id());
   scoped_refptr<TabletInfo> tablet;
@@ -2501,8 +2704,6 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
           << "Tablet in unexpected state: " << tablet->ToString()
           << ": " << tablet_lock->data().pb.ShortDebugString();
       // Mark the tablet as running
-      // TODO: we could batch the IO onto a background thread, or at least
-      // across multiple tablets in the same report.
       VLOG(1) << "Tablet " << tablet->ToString() << " is now online";
       tablet_lock->mutable_data()->set_state(SysTabletsEntryPB::RUNNING,
                                             "Tablet reported with an active leader");
@@ -2581,25 +2782,17 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
   }
 
   table_lock->Unlock();
-  // We update the tablets each time that someone reports it.
-  // This shouldn't be very frequent and should only happen when something in fact changed.
-  Status s = sys_catalog_->UpdateItem(tablet.get());
-  if (!s.ok()) {
-    LOG(WARNING) << "Error updating tablets: " << s.ToString() << ". Tablet report was: "
-                 << report.ShortDebugString();
-    return s;
-  }
-  tablet_lock->Commit();
-
-  // Need to defer the AlterTable command to after we've committed the new tablet data,
-  // since the tablet report may also be updating the raft config, and the Alter Table
-  // request needs to know who the most recent leader is.
-  if (tablet_needs_alter) {
-    SendAlterTabletRequest(tablet);
-  } else if (report.has_schema_version()) {
-    RETURN_NOT_OK(HandleTabletSchemaVersionReport(tablet.get(), report.schema_version()));
+  // Most reports repeat what we already know, e.g. a replica reporting the config we have already
+  // received from another replica, so the tablet is only written when the report changed it.
+  if (tablet_lock->data().pb.SerializeAsString() ==
+          tablet->metadata().state().pb.SerializeAsString()) {
+    tablet_lock->Unlock();
+    return FinishReportedTablet(tablet, report, tablet_needs_alter);
   }
 
+  // The tablet is written together with the other tablets changed by the report.
+  updates->push_back(
+      ReportedTabletUpdate{tablet, std::move(tablet_lock), &report, tablet_needs_alter});
   return Status::OK();
 }
 
@@ -3341,15 +3534,28 @@ void CatalogManager::DeleteTabletReplicas(
 void CatalogManager::DeleteTabletsAndSendRequests(const scoped_refptr<TableInfo>& table) {
   vector<scoped_refptr<TabletInfo>> tablets;
   table->GetAllTablets(&tablets);
+  // Tablets are locked in id order, like tablet reports lock the tablets they update.
+  std::sort(tablets.begin(), tablets.end(),
+            [](const scoped_refptr<TabletInfo>& lhs, const scoped_refptr<TabletInfo>& rhs) {
+    return lhs->tablet_id() < rhs->tablet_id();
+  });
 
   string deletion_msg = "Table deleted at " + LocalTimeAsString();
 
+  // Tablets are marked as deleted in a single write to the sys catalog.
+  vector<TabletInfo*> tablets_to_update;
+  vector<std::unique_ptr<TabletInfo::lock_type>> tablet_locks;
+  tablets_to_update.reserve(tablets.size());
+  tablet_locks.reserve(tablets.size());
   for (const scoped_refptr<TabletInfo>& tablet : tablets) {
     DeleteTabletReplicas(tablet.get(), deletion_msg);
 
-    auto tablet_lock = tablet->LockForWrite();
-    tablet_lock->mutable_data()->set_state(SysTabletsEntryPB::DELETED, deletion_msg);
-    CHECK_OK(sys_catalog_->UpdateItem(tablet.get()));
+    tablet_locks.push_back(tablet->LockForWrite());
+    tablet_locks.back()->mutable_data()->set_state(SysTabletsEntryPB::DELETED, deletion_msg);
+    tablets_to_update.push_back(tablet.get());
+  }
+  CHECK_OK(sys_catalog_->UpdateItems(tablets_to_update));
+  for (auto& tablet_lock : tablet_locks) {
     tablet_lock->Commit();
   }
 }
@@ -3685,6 +3891,7 @@ Status CatalogManager::ProcessPendingAssignments(
   master_->ts_manager()->GetAllLiveDescriptors(&ts_descs);
 
   Status s;
+  std::unordered_map<TabletServerId, int> num_initial_leaders;
   for (TabletInfo *tablet : deferred.needs_create_rpc) {
     // NOTE: if we fail to select replicas on the first pass (due to
     // insufficient Tablet Servers being online), we will still try
@@ -3697,6 +3904,7 @@ Status CatalogManager::ProcessPendingAssignments(
       tablet->table()->SetCreateTableErrorStatus(s);
       break;
     }
+    PickInitialLeader(tablet, &num_initial_leaders);
   }
 
   // Update the sys catalog with the new set of tablets/metadata.
@@ -3862,6 +4070,34 @@ Status CatalogManager::SelectReplicasForTablet(const TSDescriptorVector& ts_desc
   return Status::OK();
 }
 
+void CatalogManager::PickInitialLeader(
+    TabletInfo* tablet, std::unordered_map<TabletServerId, int>* num_initial_leaders) {
+  consensus::RaftConfigPB* config = tablet->mutable_metadata()->mutable_dirty()
+      ->pb.mutable_committed_consensus_state()->mutable_config();
+  int leader_index = -1;
+  int leader_count = 0;
+  for (int i = 0; i != config->peers_size(); ++i) {
+    const RaftPeerPB& peer = config->peers(i);
+    if (peer.member_type() != RaftPeerPB::VOTER) {
+      continue;
+    }
+    const int count = (*num_initial_leaders)[peer.permanent_uuid()];
+    if (leader_index == -1 || count < leader_count) {
+      leader_index = i;
+      leader_count = count;
+    }
+  }
+  if (leader_index == -1) {
+    return;
+  }
+  ++(*num_initial_leaders)[config->peers(leader_index).permanent_uuid()];
+  for (int i = leader_index; i > 0; --i) {
+    config->mutable_peers()->SwapElements(i, i - 1);
+  }
+  VLOG(1) << "Initial leader of tablet " << tablet->tablet_id() << ": "
+          << config->peers(0).permanent_uuid();
+}
+
 void CatalogManager::SendCreateTabletRequests(const vector<TabletInfo*>& tablets) {
   for (TabletInfo *tablet : tablets) {
     const consensus::RaftConfigPB& config =
@@ -3985,6 +4221,9 @@ void CatalogManager::SelectReplicas(
     for (const HostPortPB& addr : reg.common().rpc_addresses()) {
       peer->mutable_last_known_addr()->CopyFrom(addr);
     }
+    if (reg.common().has_cloud_info()) {
+      *peer->mutable_cloud_info() = reg.common().cloud_info();
+    }
   }
 }
 
@@ -4020,7 +4259,11 @@ Status CatalogManager::BuildLocationsForTablet(const scoped_refptr<TabletInfo>&
 
   TSRegistrationPB reg;
 
+  // Read before the replica locations, so that locations built while a tablet server registers
+  // are not served from the cache afterwards.
+  const int64_t ts_registration_version = master_->ts_manager()->registration_version();
   TabletInfo::ReplicaMap locs;
+  int64_t locs_version;
   consensus::ConsensusStatePB cstate;
   {
     auto l_tablet = tablet->LockForRead();
@@ -4032,7 +4275,15 @@ Status CatalogManager::BuildLocationsForTablet(const scoped_refptr<TabletInfo>&
       return STATUS(ServiceUnavailable, "Tablet not running");
     }
 
-    tablet->GetReplicaLocations(&locs);
+    // The locations only depend on the replica locations and the registrations of their tablet
+    // servers, the rest of the tablet metadata they contain does not change while it is running.
+    auto cached = tablet->GetCachedLocations(ts_registration_version);
+    if (cached) {
+      locs_pb->CopyFrom(*cached);
+      return Status::OK();
+    }
+
+    tablet->GetReplicaLocations(&locs, &locs_version);
     if (locs.empty() && l_tablet->data().pb.has_committed_consensus_state()) {
       cstate = l_tablet->data().pb.committed_consensus_state();
     }
@@ -4058,6 +4309,8 @@ Status CatalogManager::BuildLocationsForTablet(const scoped_refptr<TabletInfo>&
       replica_pb->mutable_ts_info()->mutable_cloud_info()->Swap(
           tsinfo_pb.mutable_registration()->mutable_common()->mutable_cloud_info());
     }
+    tablet->SetCachedLocations(std::make_shared<TabletLocationsPB>(*locs_pb), locs_version,
+                               ts_registration_version);
     return Status::OK();
   }
 
@@ -4598,6 +4851,7 @@ void TabletInfo::SetReplicaLocations(const ReplicaMap& replica_locations) {
   std::lock_guard<simple_spinlock> l(lock_);
   last_update_time_ = MonoTime::Now(MonoTime::FINE);
   replica_locations_ = replica_locations;
+  ++replica_locations_version_;
 }
 
 void TabletInfo::GetReplicaLocations(ReplicaMap* replica_locations) const {
@@ -4605,9 +4859,43 @@ void TabletInfo::GetReplicaLocations(ReplicaMap* replica_locations) const {
   *replica_locations = replica_locations_;
 }
 
+void TabletInfo::GetReplicaLocations(ReplicaMap* replica_locations, int64_t* version) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  *replica_locations = replica_locations_;
+  *version = replica_locations_version_;
+}
+
+int64_t TabletInfo::replica_locations_version() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return replica_locations_version_;
+}
+
 bool TabletInfo::AddToReplicaLocations(const TabletReplica& replica) {
   std::lock_guard<simple_spinlock> l(lock_);
-  return InsertIfNotPresent(&replica_locations_, replica.ts_desc->permanent_uuid(), replica);
+  if (!InsertIfNotPresent(&replica_locations_, replica.ts_desc->permanent_uuid(), replica)) {
+    return false;
+  }
+  ++replica_locations_version_;
+  return true;
+}
+
+std::shared_ptr<const TabletLocationsPB> TabletInfo::GetCachedLocations(
+    int64_t ts_registration_version) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (cached_locations_replica_version_ != replica_locations_version_ ||
+      cached_locations_ts_version_ != ts_registration_version) {
+    return nullptr;
+  }
+  return cached_locations_;
+}
+
+void TabletInfo::SetCachedLocations(std::shared_ptr<const TabletLocationsPB> locations,
+                                    int64_t replica_locations_version,
+                                    int64_t ts_registration_version) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  cached_locations_ = std::move(locations);
+  cached_locations_replica_version_ = replica_locations_version;
+  cached_locations_ts_version_ = ts_registration_version;
 }
 
 void TabletInfo::set_last_update_time(const MonoTime& ts) {
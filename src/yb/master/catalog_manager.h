@@ -32,6 +32,7 @@
 #ifndef YB_MASTER_CATALOG_MANAGER_H
 #define YB_MASTER_CATALOG_MANAGER_H
 
+#include <functional>
 #include <list>
 #include <map>
 #include <set>
@@ -225,6 +226,20 @@ class TabletInfo : public RefCountedThreadSafe<TabletInfo>,
   // Returns true iff the replica was inserted.
   bool AddToReplicaLocations(const TabletReplica& replica);
 
+  // Same as GetReplicaLocations, also returning the version of the replica locations, which
+  // changes every time they are updated.
+  void GetReplicaLocations(ReplicaMap* replica_locations, int64_t* version) const;
+  int64_t replica_locations_version() const;
+
+  // Accessors for the locations built from the replica locations of the given version while the
+  // tablet server registrations had the given version. GetCachedLocations returns null if either
+  // version has changed since.
+  std::shared_ptr<const TabletLocationsPB> GetCachedLocations(
+      int64_t ts_registration_version) const;
+  void SetCachedLocations(std::shared_ptr<const TabletLocationsPB> locations,
+                          int64_t replica_locations_version,
+                          int64_t ts_registration_version);
+
   // Accessors for the last time the replica locations were updated.
   void set_last_update_time(const MonoTime& ts);
   MonoTime last_update_time() const;
@@ -268,6 +283,12 @@ class TabletInfo : public RefCountedThreadSafe<TabletInfo>,
   // The locations in the latest Raft config where this tablet has been
   // reported. The map is keyed by tablet server UUID.
   ReplicaMap replica_locations_;
+  int64_t replica_locations_version_ = 0;
+
+  // The locations returned to clients, see GetCachedLocations.
+  std::shared_ptr<const TabletLocationsPB> cached_locations_;
+  int64_t cached_locations_replica_version_ = -1;
+  int64_t cached_locations_ts_version_ = -1;
 
   // Reported schema version (in-memory only).
   uint32_t reported_schema_version_;
@@ -1019,6 +1040,16 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // This method is thread-safe.
   CHECKED_STATUS InitSysCatalogAsync(bool is_first_run);
 
+  // Maps the columns of a new index table to the columns of the indexed table in 'index_info'.
+  CHECKED_STATUS FillIndexInfo(const Schema& index_schema,
+                               const TableName& index_name,
+                               IndexInfoPB* index_info);
+
+  // Applies 'update' to the indexes of the table and bumps its version, so that the clients
+  // holding the previous version reload the table with its current indexes.
+  CHECKED_STATUS UpdateIndexesOfTable(const TableId& table_id,
+                                      const std::function<void(SysTablesEntryPB*)>& update);
+
   // Helper for creating the initial TableInfo state
   // Leaves the table "write locked" with the new info in the
   // "dirty" state field.
@@ -1042,11 +1073,32 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS FindTable(const TableIdentifierPB& table_identifier,
                    scoped_refptr<TableInfo>* table_info);
 
+  // Tablet changed by a tablet report, that is kept locked until it is written to sys catalog.
+  struct ReportedTabletUpdate {
+    scoped_refptr<TabletInfo> tablet;
+    std::unique_ptr<TabletInfo::lock_type> tablet_lock;
+    const ReportedTabletPB* report;
+    bool needs_alter;
+  };
+  typedef std::vector<ReportedTabletUpdate> ReportedTabletUpdates;
+
   // Handle one of the tablets in a tablet reported.
   // Requires that the lock is already held.
+  // When the report changes the tablet, the change is added to updates instead of being written.
   CHECKED_STATUS HandleReportedTablet(TSDescriptor* ts_desc,
                               const ReportedTabletPB& report,
-                              ReportedTabletUpdatesPB *report_updates);
+                              ReportedTabletUpdatesPB *report_updates,
+                              ReportedTabletUpdates* updates);
+
+  // Writes the tablets changed by a tablet report to sys catalog in a single write, commits their
+  // in-memory state and clears updates.
+  CHECKED_STATUS CommitReportedTablets(ReportedTabletUpdates* updates);
+
+  // Sends the alter table request to the reported tablet, or handles its reported schema version,
+  // after the changes of its report have been committed.
+  CHECKED_STATUS FinishReportedTablet(const scoped_refptr<TabletInfo>& tablet,
+                                      const ReportedTabletPB& report,
+                                      bool tablet_needs_alter);
 
   CHECKED_STATUS ResetTabletReplicasFromReportedConfig(const ReportedTabletPB& report,
                                                const scoped_refptr<TabletInfo>& tablet,
@@ -1092,6 +1144,13 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // This method is called by "ProcessPendingAssignments()".
   CHECKED_STATUS SelectReplicasForTablet(const TSDescriptorVector& ts_descs, TabletInfo* tablet);
 
+  // Picks the initial leader among the selected replicas of a new tablet, the one that was picked
+  // for the fewest tablets so far according to num_initial_leaders, and moves it to the front of
+  // the Raft config. The first voter of a new Raft group runs the first election right away,
+  // while other replicas wait for it, so the tablet gets its leader without split votes.
+  void PickInitialLeader(TabletInfo* tablet,
+                         std::unordered_map<TabletServerId, int>* num_initial_leaders);
+
   // Select N Replicas from the online tablet servers that have been chosen to respect the
   // placement information provided. Populate the consensus configuration object with choices and
   // also update the set of selected tablet servers, to not place several replicas on the same TS.
@@ -14,12 +14,14 @@
 #include "yb/master/cluster_balance.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include <boost/thread/locks.hpp>
 
 #include "yb/consensus/quorum_util.h"
 #include "yb/master/master.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/random_util.h"
 
 DEFINE_bool(enable_load_balancing,
@@ -41,6 +43,28 @@ DEFINE_int32(load_balancer_max_concurrent_moves,
              1,
              "Maximum number of concurrent LeaderMoves/Adds/Removals.");
 
+DEFINE_bool(load_balancer_use_tablet_load,
+            false,
+            "Whether to also balance the operations per second served by the tablet servers, as "
+                "reported in their heartbeats, once the number of replicas and leaders is "
+                "balanced. Leaders are moved before replicas, as moving them is cheaper.");
+TAG_FLAG(load_balancer_use_tablet_load, advanced);
+TAG_FLAG(load_balancer_use_tablet_load, runtime);
+
+DEFINE_double(load_balancer_tablet_load_imbalance_ratio,
+              1.5,
+              "Tablet servers are considered imbalanced when the busiest one serves more than this "
+                  "many times the operations per second of the least busy one.");
+TAG_FLAG(load_balancer_tablet_load_imbalance_ratio, advanced);
+TAG_FLAG(load_balancer_tablet_load_imbalance_ratio, runtime);
+
+DEFINE_double(load_balancer_min_ops_per_sec_to_balance,
+              100,
+              "Differences in operations per second between tablet servers below this are too "
+                  "small to move tablets or leaders for.");
+TAG_FLAG(load_balancer_min_ops_per_sec_to_balance, advanced);
+TAG_FLAG(load_balancer_min_ops_per_sec_to_balance, runtime);
+
 DECLARE_int32(min_leader_stepdown_retry_interval_ms);
 
 namespace yb {
@@ -174,6 +198,18 @@ void ClusterLoadBalancer::RunLoadBalancer() {
     TabletServerId out_from_ts;
     TabletServerId out_to_ts;
 
+    // Moving a leader is much cheaper than moving a replica, so when balancing the actual work
+    // handle the leaders first, then the replicas.
+    const bool leaders_first = FLAGS_load_balancer_use_tablet_load;
+    if (leaders_first) {
+      for (int i = 0; i < remaining_leader_moves; ++i) {
+        if (!HandleLeaderMoves(&out_tablet_id, &out_from_ts, &out_to_ts)) {
+          break;
+        }
+        --remaining_leader_moves;
+      }
+    }
+
     // Handle adding and moving replicas.
     for (int i = 0; i < remaining_adds; ++i) {
       if (!HandleAddReplicas(&out_tablet_id, &out_from_ts, &out_to_ts)) {
@@ -191,7 +227,7 @@ void ClusterLoadBalancer::RunLoadBalancer() {
     }
 
     // Handle tablet servers with too many leaders.
-    for (int i = 0; i < remaining_leader_moves; ++i) {
+    for (int i = 0; !leaders_first && i < remaining_leader_moves; ++i) {
       if (!HandleLeaderMoves(&out_tablet_id, &out_from_ts, &out_to_ts)) {
         break;
       }
@@ -211,6 +247,7 @@ void ClusterLoadBalancer::ResetState() {
 bool ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
   // Set the blacklist so we can also mark the tablet servers as we add them up.
   state_->SetBlacklist(GetServerBlacklist());
+  GetAffinitizedZones(table_uuid, &state_->affinitized_zones_);
 
   // Loop over live tablet servers to set empty defaults, so we can also have info on those
   // servers that have yet to receive load (have heartbeated to the master, but have not been
@@ -220,6 +257,7 @@ bool ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
   for (const auto ts_desc : ts_descs) {
     state_->UpdateTabletServer(ts_desc);
   }
+  state_->FallBackFromAffinitizedZones();
 
   vector<scoped_refptr<TabletInfo>> tablets;
   Status s = GetTabletsForTable(table_uuid, &tablets);
@@ -386,8 +424,11 @@ bool ClusterLoadBalancer::HandleAddReplicas(
     return true;
   }
 
-  // Finally, handle normal load balancing.
-  if (!GetLoadToMove(out_tablet_id, out_from_ts, out_to_ts)) {
+  // Finally, handle normal load balancing, by the number of replicas and then by the work the
+  // replicas do.
+  if (!GetLoadToMove(out_tablet_id, out_from_ts, out_to_ts) &&
+      !(FLAGS_load_balancer_use_tablet_load &&
+        GetLoadToMoveByOps(out_tablet_id, out_from_ts, out_to_ts))) {
     VLOG(1) << "Cannot find any more tablets to move, under current constraints.";
     if (VLOG_IS_ON(1)) {
       DumpSortedLoad();
@@ -634,6 +675,213 @@ bool ClusterLoadBalancer::GetLeaderToMove(
   FATAL_ERROR("Load balancing algorithm reached invalid state!");
 }
 
+bool ClusterLoadBalancer::GetLeaderToMoveFromBlacklisted(
+    TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts) {
+  const auto current_time = MonoTime::FineNow();
+  for (const auto& blacklisted_uuid : state_->blacklisted_servers_) {
+    for (const auto& tablet_id : state_->per_ts_meta_[blacklisted_uuid].leaders) {
+      const auto tablet_meta_iter = state_->per_tablet_meta_.find(tablet_id);
+      // sorted_leader_load_ contains servers that are not blacklisted, least loaded first. The
+      // servers outside the affinitized zones are only used if none in the zones can lead.
+      vector<TabletServerId> targets(state_->sorted_leader_load_);
+      targets.insert(targets.end(), state_->sorted_non_affinitized_leader_load_.begin(),
+                     state_->sorted_non_affinitized_leader_load_.end());
+      for (const auto& target_uuid : targets) {
+        if (!state_->per_ts_meta_[target_uuid].running_tablets.count(tablet_id)) {
+          continue;
+        }
+        if (tablet_meta_iter != state_->per_tablet_meta_.end()) {
+          const auto& stepdown_failures = tablet_meta_iter->second.leader_stepdown_failures;
+          const auto stepdown_failure_iter = stepdown_failures.find(target_uuid);
+          if (stepdown_failure_iter != stepdown_failures.end() &&
+              (current_time - stepdown_failure_iter->second).ToMilliseconds() <
+                  FLAGS_min_leader_stepdown_retry_interval_ms) {
+            continue;
+          }
+        }
+        *moving_tablet_id = tablet_id;
+        *from_ts = blacklisted_uuid;
+        *to_ts = target_uuid;
+        LOG(INFO) << "Moving leader of tablet " << tablet_id << " away from blacklisted TS "
+                  << blacklisted_uuid;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool ClusterLoadBalancer::GetLeaderToMoveFromNonAffinitized(
+    TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts) {
+  const auto current_time = MonoTime::FineNow();
+  // Start with the servers with the most leaders outside the affinitized zones.
+  const auto& sources = state_->sorted_non_affinitized_leader_load_;
+  for (auto source = sources.rbegin(); source != sources.rend(); ++source) {
+    for (const auto& tablet_id : state_->per_ts_meta_[*source].leaders) {
+      const auto tablet_meta_iter = state_->per_tablet_meta_.find(tablet_id);
+      // sorted_leader_load_ contains the servers in the affinitized zones, least loaded first.
+      for (const auto& target_uuid : state_->sorted_leader_load_) {
+        if (!state_->per_ts_meta_[target_uuid].running_tablets.count(tablet_id)) {
+          continue;
+        }
+        if (tablet_meta_iter != state_->per_tablet_meta_.end()) {
+          const auto& stepdown_failures = tablet_meta_iter->second.leader_stepdown_failures;
+          const auto stepdown_failure_iter = stepdown_failures.find(target_uuid);
+          if (stepdown_failure_iter != stepdown_failures.end() &&
+              (current_time - stepdown_failure_iter->second).ToMilliseconds() <
+                  FLAGS_min_leader_stepdown_retry_interval_ms) {
+            continue;
+          }
+        }
+        *moving_tablet_id = tablet_id;
+        *from_ts = *source;
+        *to_ts = target_uuid;
+        LOG(INFO) << "Moving leader of tablet " << tablet_id << " from TS " << *source
+                  << " into the affinitized zones";
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool ClusterLoadBalancer::IsOpsLoadImbalanced(double high_load, double low_load) const {
+  return high_load - low_load >= FLAGS_load_balancer_min_ops_per_sec_to_balance &&
+         high_load > low_load * FLAGS_load_balancer_tablet_load_imbalance_ratio;
+}
+
+bool ClusterLoadBalancer::GetLoadToMoveByOps(
+    TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts) {
+  if (state_->sorted_load_.empty()) {
+    return false;
+  }
+
+  // Go from the busiest tablet server down, trying to move work to the least busy ones. Moving a
+  // tablet with load w between servers whose load differs by gap leaves them differing by
+  // |gap - 2w|, so we pick the tablet that minimizes that, and only tablets with w < gap help.
+  vector<TabletServerId> by_ops(state_->sorted_load_);
+  std::sort(by_ops.begin(), by_ops.end(), [this](const TabletServerId& a, const TabletServerId& b) {
+    return state_->GetOpsLoad(a) < state_->GetOpsLoad(b);
+  });
+  for (int right = by_ops.size() - 1; right > 0; --right) {
+    const TabletServerId& high_load_uuid = by_ops[right];
+    const double high_load = state_->GetOpsLoad(high_load_uuid);
+    const auto& high_ts_meta = state_->per_ts_meta_[high_load_uuid];
+    for (int left = 0; left < right; ++left) {
+      const TabletServerId& low_load_uuid = by_ops[left];
+      const double low_load = state_->GetOpsLoad(low_load_uuid);
+      if (!IsOpsLoadImbalanced(high_load, low_load)) {
+        break;
+      }
+      // Do not make the number of replicas imbalanced, it would be moved back by GetLoadToMove.
+      if ((state_->GetLoad(low_load_uuid) + 1) - (state_->GetLoad(high_load_uuid) - 1) >=
+          options_.kMinLoadVarianceToBalance) {
+        continue;
+      }
+      const bool same_placement = high_ts_meta.descriptor->placement_id() ==
+                                  state_->per_ts_meta_[low_load_uuid].descriptor->placement_id();
+      const double gap = high_load - low_load;
+      TabletId best_tablet_id;
+      double best_remaining_gap = gap;
+      uint64_t best_size = 0;
+      for (const TabletId& tablet_id : high_ts_meta.running_tablets) {
+        const auto& tablet_meta = state_->per_tablet_meta_[tablet_id];
+        if (tablet_meta.ops_per_sec <= 0 || tablet_meta.ops_per_sec >= gap ||
+            state_->tablets_over_replicated_.count(tablet_id)) {
+          continue;
+        }
+        const auto& placement_info = GetPlacementByTablet(tablet_id);
+        if (!placement_info.placement_blocks().empty() && !same_placement) {
+          continue;
+        }
+        if (tablet_meta.leader_uuid == high_load_uuid && SkipLeaderAsVictim(tablet_id)) {
+          continue;
+        }
+        if (!state_->CanAddTabletToTabletServer(tablet_id, low_load_uuid, &placement_info)) {
+          continue;
+        }
+        // Among tablets that balance the load equally well, prefer the smaller one to copy.
+        const double remaining_gap = std::abs(gap - 2 * tablet_meta.ops_per_sec);
+        if (remaining_gap < best_remaining_gap ||
+            (remaining_gap == best_remaining_gap && !best_tablet_id.empty() &&
+             tablet_meta.sst_files_size < best_size)) {
+          best_tablet_id = tablet_id;
+          best_remaining_gap = remaining_gap;
+          best_size = tablet_meta.sst_files_size;
+        }
+      }
+      if (!best_tablet_id.empty()) {
+        *moving_tablet_id = best_tablet_id;
+        *from_ts = high_load_uuid;
+        *to_ts = low_load_uuid;
+        MoveReplica(*moving_tablet_id, high_load_uuid, low_load_uuid);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool ClusterLoadBalancer::GetLeaderToMoveByOps(
+    TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts) {
+  if (state_->sorted_leader_load_.empty()) {
+    return false;
+  }
+
+  // Same as GetLoadToMoveByOps, but for the leaders, which serve all the reads and writes of their
+  // tablets.
+  vector<TabletServerId> by_ops(state_->sorted_leader_load_);
+  std::sort(by_ops.begin(), by_ops.end(), [this](const TabletServerId& a, const TabletServerId& b) {
+    return state_->GetLeaderOpsLoad(a) < state_->GetLeaderOpsLoad(b);
+  });
+  for (int right = by_ops.size() - 1; right > 0; --right) {
+    const TabletServerId& high_load_uuid = by_ops[right];
+    const double high_load = state_->GetLeaderOpsLoad(high_load_uuid);
+    const set<TabletId>& leaders = state_->per_ts_meta_[high_load_uuid].leaders;
+    for (int left = 0; left < right; ++left) {
+      const TabletServerId& low_load_uuid = by_ops[left];
+      const double low_load = state_->GetLeaderOpsLoad(low_load_uuid);
+      if (!IsOpsLoadImbalanced(high_load, low_load)) {
+        break;
+      }
+      // Do not make the number of leaders imbalanced, it would be moved back by GetLeaderToMove.
+      const int low_leader_load = state_->GetLeaderLoad(low_load_uuid) + 1;
+      if (low_leader_load - (state_->GetLeaderLoad(high_load_uuid) - 1) >=
+              options_.kMinLeaderLoadVarianceToBalance ||
+          (state_->leader_balance_threshold_ > 0 &&
+           low_leader_load > state_->leader_balance_threshold_)) {
+        continue;
+      }
+      const set<TabletId>& peers = state_->per_ts_meta_[low_load_uuid].running_tablets;
+      const double gap = high_load - low_load;
+      TabletId best_tablet_id;
+      double best_remaining_gap = gap;
+      for (const TabletId& tablet_id : leaders) {
+        if (!peers.count(tablet_id)) {
+          continue;
+        }
+        const auto& tablet_meta = state_->per_tablet_meta_[tablet_id];
+        if (tablet_meta.ops_per_sec <= 0 || tablet_meta.ops_per_sec >= gap ||
+            tablet_meta.leader_stepdown_failures.count(low_load_uuid)) {
+          continue;
+        }
+        const double remaining_gap = std::abs(gap - 2 * tablet_meta.ops_per_sec);
+        if (remaining_gap < best_remaining_gap) {
+          best_tablet_id = tablet_id;
+          best_remaining_gap = remaining_gap;
+        }
+      }
+      if (!best_tablet_id.empty()) {
+        *moving_tablet_id = best_tablet_id;
+        *from_ts = high_load_uuid;
+        *to_ts = low_load_uuid;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 bool ClusterLoadBalancer::HandleRemoveReplicas(
     TabletId* out_tablet_id, TabletServerId* out_from_ts) {
   // Give high priority to removing tablets that are not respecting the placement policy.
@@ -708,7 +956,11 @@ bool ClusterLoadBalancer::HandleRemoveIfWrongPlacement(
 
 bool ClusterLoadBalancer::HandleLeaderMoves(
     TabletId* out_tablet_id, TabletServerId* out_from_ts, TabletServerId* out_to_ts) {
-  if (GetLeaderToMove(out_tablet_id, out_from_ts, out_to_ts)) {
+  if (GetLeaderToMoveFromBlacklisted(out_tablet_id, out_from_ts, out_to_ts) ||
+      GetLeaderToMoveFromNonAffinitized(out_tablet_id, out_from_ts, out_to_ts) ||
+      GetLeaderToMove(out_tablet_id, out_from_ts, out_to_ts) ||
+      (FLAGS_load_balancer_use_tablet_load &&
+       GetLeaderToMoveByOps(out_tablet_id, out_from_ts, out_to_ts))) {
     MoveLeader(*out_tablet_id, *out_from_ts, *out_to_ts);
     return true;
   }
@@ -788,6 +1040,24 @@ const PlacementInfoPB& ClusterLoadBalancer::GetClusterPlacementInfo() const {
   return l->data().pb.replication_info().live_replicas();
 }
 
+void ClusterLoadBalancer::GetAffinitizedZones(const TableId& table_uuid,
+                                              AffinitizedZonesSet* affinitized_zones) const {
+  affinitized_zones->clear();
+  scoped_refptr<TableInfo> table_info = GetTableInfo(table_uuid);
+  if (table_info != nullptr) {
+    auto l = table_info->LockForRead();
+    for (const auto& cloud_info : l->data().pb.replication_info().affinitized_leaders()) {
+      affinitized_zones->insert(cloud_info);
+    }
+  }
+  if (affinitized_zones->empty()) {
+    auto l = catalog_manager_->cluster_config_->LockForRead();
+    for (const auto& cloud_info : l->data().pb.replication_info().affinitized_leaders()) {
+      affinitized_zones->insert(cloud_info);
+    }
+  }
+}
+
 const BlacklistPB& ClusterLoadBalancer::GetServerBlacklist() const {
   auto l = catalog_manager_->cluster_config_->LockForRead();
   return l->data().pb.server_blacklist();
@@ -64,7 +64,9 @@ namespace master {
 //  This class also balances the leaders on tablet servers, starting from the server with the most
 //  leaders and moving some leaders to the servers with less to achieve an even distribution. If
 //  a threshold is set in the configuration, the balancer will just keep the numbers of leaders
-//  on each server below it instead of maintaining an even distribution.
+//  on each server below it instead of maintaining an even distribution. If affinitized leader zones
+//  are configured, the leaders are first moved into those zones, and balanced among the servers in
+//  them.
 class ClusterLoadBalancer {
  public:
   explicit ClusterLoadBalancer(CatalogManager* cm);
@@ -147,6 +149,11 @@ class ClusterLoadBalancer {
   // Get the blacklist information.
   virtual const BlacklistPB& GetServerBlacklist() const;
 
+  // Get the zones preferred for the leaders of the table: those of the table's replication info if
+  // it lists any, otherwise those of the cluster configuration.
+  virtual void GetAffinitizedZones(const TableId& table_uuid,
+                                   AffinitizedZonesSet* affinitized_zones) const;
+
   // Should skip load-balancing of this table?
   virtual bool SkipLoadBalancing(const TableInfo& table) const;
 
@@ -248,6 +255,38 @@ class ClusterLoadBalancer {
   // Returns false otherwise.
   bool GetLeaderToMove(TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
 
+  // Picks a leader on a blacklisted tablet server to move to the least loaded of the other servers
+  // that have a running replica of the tablet. Leaders are moved away from a server being drained
+  // right away, rather than when its replicas are removed, so clients do not fail over to new
+  // leaders only after remote bootstraps.
+  //
+  // Returns true if we could find a leader to move and sets the three output parameters.
+  bool GetLeaderToMoveFromBlacklisted(
+      TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
+
+  // Picks a leader on a tablet server outside the affinitized zones to move to the least loaded
+  // server in those zones that has a running replica of the tablet. A leader whose tablet has no
+  // running replica in the affinitized zones, or whose previous move there failed recently, stays.
+  //
+  // Returns true if we could find a leader to move and sets the three output parameters.
+  bool GetLeaderToMoveFromNonAffinitized(
+      TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
+
+  // Once the number of replicas and leaders is balanced, pick a replica or a leader to move from
+  // the tablet server serving the most operations per second to one serving less, if the servers
+  // are imbalanced by more than --load_balancer_tablet_load_imbalance_ratio. The moved tablet is
+  // the one that brings the two servers closest, and moves that would unbalance the counts are
+  // never picked, so the two phases do not undo each other.
+  //
+  // Returns true if we could find a tablet to rebalance and sets the three output parameters.
+  bool GetLoadToMoveByOps(
+      TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
+  bool GetLeaderToMoveByOps(
+      TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
+
+  // Returns true if the ops load on the two tablet servers is imbalanced enough to move work.
+  bool IsOpsLoadImbalanced(double high_load, double low_load) const;
+
   // Issue the change config and modify the in-memory state for moving a replica from one tablet
   // server to another.
   void MoveReplica(
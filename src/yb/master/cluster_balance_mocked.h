@@ -32,6 +32,11 @@ class ClusterLoadBalancerMocked : public ClusterLoadBalancer {
 
   const BlacklistPB& GetServerBlacklist() const override { return blacklist_; }
 
+  void GetAffinitizedZones(const TableId& table_uuid,
+                           AffinitizedZonesSet* affinitized_zones) const override {
+    *affinitized_zones = affinitized_zones_;
+  }
+
   void SendReplicaChanges(scoped_refptr<TabletInfo> tablet, const string& ts_uuid,
                           const bool is_add, const bool should_remove,
                           const string& new_leader_uuid) override {
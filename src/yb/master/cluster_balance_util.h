@@ -38,6 +38,8 @@ DECLARE_int32(leader_balance_unresponsive_timeout_ms);
 
 DECLARE_int32(load_balancer_max_concurrent_moves);
 
+DECLARE_bool(load_balancer_use_tablet_load);
+
 namespace yb {
 namespace master {
 
@@ -106,6 +108,10 @@ struct CBTabletMetadata {
   // Leader stepdown failures. We use this to prevent retrying the same leader stepdown too soon.
   LeaderStepDownFailureTimes leader_stepdown_failures;
 
+  // Operations per second served by this tablet, as reported by its leader, and the largest size
+  // of its SST files reported by any replica.
+  double ops_per_sec = 0;
+  uint64_t sst_files_size = 0;
 };
 
 struct CBTabletServerMetadata {
@@ -129,11 +135,19 @@ class ClusterLoadState {
         current_time_(MonoTime::FineNow()) {}
   virtual ~ClusterLoadState() {}
 
-  // Comparators used for sorting by load.
+  // Comparators used for sorting by load. When the tablet load is used, servers with the same
+  // number of tablets are ordered by the operations they serve.
   bool CompareByUuid(const TabletServerId& a, const TabletServerId& b) {
     int load_a = GetLoad(a);
     int load_b = GetLoad(b);
     if (load_a == load_b) {
+      if (FLAGS_load_balancer_use_tablet_load) {
+        double ops_load_a = GetOpsLoad(a);
+        double ops_load_b = GetOpsLoad(b);
+        if (ops_load_a != ops_load_b) {
+          return ops_load_a < ops_load_b;
+        }
+      }
       return a < b;
     } else {
       return load_a < load_b;
@@ -163,7 +177,12 @@ class ClusterLoadState {
   struct LeaderLoadComparator {
     explicit LeaderLoadComparator(ClusterLoadState* state) : state_(state) {}
     bool operator()(const TabletServerId& a, const TabletServerId& b) {
-      return state_->GetLeaderLoad(a) < state_->GetLeaderLoad(b);
+      int load_a = state_->GetLeaderLoad(a);
+      int load_b = state_->GetLeaderLoad(b);
+      if (load_a == load_b && FLAGS_load_balancer_use_tablet_load) {
+        return state_->GetLeaderOpsLoad(a) < state_->GetLeaderOpsLoad(b);
+      }
+      return load_a < load_b;
     }
     ClusterLoadState* state_;
   };
@@ -179,6 +198,28 @@ class ClusterLoadState {
     return per_ts_meta_.at(ts_uuid).leaders.size();
   }
 
+  // Get the operations per second served by the tablets of a certain TS.
+  double GetOpsLoad(const TabletServerId& ts_uuid) const {
+    const auto& ts_meta = per_ts_meta_.at(ts_uuid);
+    return GetOpsLoad(ts_meta.running_tablets) + GetOpsLoad(ts_meta.starting_tablets);
+  }
+
+  // Get the operations per second served by the tablet leaders of a certain TS.
+  double GetLeaderOpsLoad(const TabletServerId& ts_uuid) const {
+    return GetOpsLoad(per_ts_meta_.at(ts_uuid).leaders);
+  }
+
+  double GetOpsLoad(const std::set<TabletId>& tablets) const {
+    double result = 0;
+    for (const auto& tablet_id : tablets) {
+      auto it = per_tablet_meta_.find(tablet_id);
+      if (it != per_tablet_meta_.end()) {
+        result += it->second.ops_per_sec;
+      }
+    }
+    return result;
+  }
+
   void SetBlacklist(const BlacklistPB& blacklist) { blacklist_ = blacklist; }
 
   // Update the per-tablet information for this tablet.
@@ -210,6 +251,13 @@ class ClusterLoadState {
         return false;
       }
 
+      // Only the leader serves reads and writes, so the largest reported rate is the load of the
+      // tablet, wherever its leader is.
+      const auto replica_load = ts_meta_it->second.descriptor->GetTabletLoad(tablet_id);
+      tablet_meta.ops_per_sec = std::max(tablet_meta.ops_per_sec, replica_load.ops_per_sec());
+      tablet_meta.sst_files_size =
+          std::max(tablet_meta.sst_files_size, replica_load.sst_files_size);
+
       // Fill leader info.
       if (replica.second.role == consensus::RaftPeerPB::LEADER) {
         tablet_meta.leader_uuid = ts_uuid;
@@ -330,11 +378,16 @@ class ClusterLoadState {
     }
 
     // Add this tablet server for leader load-balancing only if it is not blacklisted and it has
-    // heartbeated recently enough to be considered responsive for leader balancing.
+    // heartbeated recently enough to be considered responsive for leader balancing. Servers outside
+    // the affinitized zones, if any, are only kept to move their leaders away.
     if (!is_blacklisted &&
         ts_desc->TimeSinceHeartbeat().ToMilliseconds() <
         FLAGS_leader_balance_unresponsive_timeout_ms) {
-      sorted_leader_load_.push_back(ts_uuid);
+      if (IsInAffinitizedZones(*ts_desc)) {
+        sorted_leader_load_.push_back(ts_uuid);
+      } else {
+        sorted_non_affinitized_leader_load_.push_back(ts_uuid);
+      }
     }
 
     if (ts_desc->HasTabletDeletePending()) {
@@ -506,6 +559,30 @@ class ClusterLoadState {
   virtual void SortLeaderLoad() {
     auto leader_count_comparator = LeaderLoadComparator(this);
     sort(sorted_leader_load_.begin(), sorted_leader_load_.end(), leader_count_comparator);
+    sort(sorted_non_affinitized_leader_load_.begin(), sorted_non_affinitized_leader_load_.end(),
+         leader_count_comparator);
+  }
+
+  bool IsInAffinitizedZones(const TSDescriptor& ts_desc) const {
+    if (affinitized_zones_.empty()) {
+      return true;
+    }
+    for (const auto& zone : affinitized_zones_) {
+      if (ts_desc.MatchesCloudInfo(zone)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // If no server in the affinitized zones can take leaders, for instance because the zones are
+  // down, the leaders are balanced across the servers of the other zones instead.
+  void FallBackFromAffinitizedZones() {
+    if (sorted_leader_load_.empty() && !sorted_non_affinitized_leader_load_.empty()) {
+      LOG(WARNING) << "No live tablet server in the affinitized zones, balancing leaders across "
+                   << "the other zones";
+      sorted_leader_load_.swap(sorted_non_affinitized_leader_load_);
+    }
   }
 
   inline bool IsLeaderLoadBelowThreshold(const TabletServerId& ts_uuid) {
@@ -580,10 +657,17 @@ class ClusterLoadState {
   // Number of leaders per each tablet server to balance below.
   int leader_balance_threshold_ = 0;
 
+  // Zones preferred for the leaders of the table, or empty if the leaders can be anywhere.
+  AffinitizedZonesSet affinitized_zones_;
+
   // List of table server ids sorted by their leader load.
   // If affinitized leaders is enabled, stores leader load for affinitized nodes.
   vector<TabletServerId> sorted_leader_load_;
 
+  // List of tablet server ids outside the affinitized zones sorted by their leader load. Their
+  // leaders are moved to the servers in sorted_leader_load_.
+  vector<TabletServerId> sorted_non_affinitized_leader_load_;
+
   unordered_map<TableId, TabletToTabletServerMap> pending_add_replica_tasks_;
   unordered_map<TableId, TabletToTabletServerMap> pending_remove_replica_tasks_;
   unordered_map<TableId, TabletToTabletServerMap> pending_stepdown_leader_tasks_;
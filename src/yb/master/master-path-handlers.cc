@@ -230,13 +230,16 @@ void MasterPathHandlers::HandleTablePage(const Webserver::WebRequest& req,
     return;
   }
 
-  CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
-  if (!l.first_failed_status().ok()) {
-    *output << "Master is not ready: " << l.first_failed_status().ToString();
-    return;
+  // Only look the table up under the leader lock, so rendering does not hold up leader changes.
+  scoped_refptr<TableInfo> table;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    if (!l.first_failed_status().ok()) {
+      *output << "Master is not ready: " << l.first_failed_status().ToString();
+      return;
+    }
+    table = master_->catalog_manager()->GetTableInfo(table_id);
   }
-
-  scoped_refptr<TableInfo> table = master_->catalog_manager()->GetTableInfo(table_id);
   if (table == nullptr) {
     *output << "Table not found";
     return;
@@ -315,8 +318,14 @@ void MasterPathHandlers::RootHandler(const Webserver::WebRequest& req,
   // First check if we are the master leader. If not, make a curl call to the master leader and
   // return that as the UI payload.
   vector<ServerEntryPB> masters;
-  CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
-  if (!l.first_failed_status().ok()) {
+  // The leader lock is only held for the check, not while fetching the page from the leader or
+  // rendering it.
+  Status leader_status;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    leader_status = l.first_failed_status();
+  }
+  if (!leader_status.ok()) {
     do {
       // List all the masters.
       Status s = master_->ListMasters(&masters);
@@ -705,6 +714,7 @@ void MasterPathHandlers::HandleGetClusterConfig(
 Status MasterPathHandlers::Register(Webserver* server) {
   bool is_styled = true;
   bool is_on_nav_bar = true;
+  bool is_expensive = true;
   // Cannot use auto with callbacks, as they won't properly deduce types with boost magic...
   server->RegisterPathHandler(
     "/", "Home", std::bind(&MasterPathHandlers::RootHandler, this, _1, _2), is_styled,
@@ -715,24 +725,25 @@ Status MasterPathHandlers::Register(Webserver* server) {
   server->RegisterPathHandler(
       "/tablet-servers", "Tablet Servers",
       std::bind(&MasterPathHandlers::CallIfLeaderOrPrintRedirect, this, _1, _2, cb), is_styled,
-      is_on_nav_bar);
+      is_on_nav_bar, is_expensive);
   cb = std::bind(&MasterPathHandlers::HandleCatalogManager,
                  this, _1, _2, false /* skip_system_tables */);
   server->RegisterPathHandler(
       "/tables", "Tables",
       std::bind(&MasterPathHandlers::CallIfLeaderOrPrintRedirect, this, _1, _2, cb), is_styled,
-      is_on_nav_bar);
+      is_on_nav_bar, is_expensive);
   cb = std::bind(&MasterPathHandlers::HandleTablePage, this, _1, _2);
   server->RegisterPathHandler(
       "/table", "", std::bind(&MasterPathHandlers::CallIfLeaderOrPrintRedirect, this, _1, _2, cb),
-      is_styled, false);
+      is_styled, false, is_expensive);
   server->RegisterPathHandler(
       "/masters", "Masters", std::bind(&MasterPathHandlers::HandleMasters, this, _1, _2), is_styled,
       is_on_nav_bar);
   cb = std::bind(&MasterPathHandlers::HandleDumpEntities, this, _1, _2);
   server->RegisterPathHandler(
       "/dump-entities", "Dump Entities",
-      std::bind(&MasterPathHandlers::CallIfLeaderOrPrintRedirect, this, _1, _2, cb), false, false);
+      std::bind(&MasterPathHandlers::CallIfLeaderOrPrintRedirect, this, _1, _2, cb), false, false,
+      is_expensive);
   cb = std::bind(&MasterPathHandlers::HandleGetClusterConfig, this, _1, _2);
   server->RegisterPathHandler(
       "/cluster-config", "Cluster Config",
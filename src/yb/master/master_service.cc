@@ -164,6 +164,9 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
 
   ts_desc->UpdateHeartbeatTime();
   ts_desc->set_num_live_replicas(req->num_live_tablets());
+  if (req->tablet_loads_size() > 0) {
+    ts_desc->UpdateTabletLoads(req->tablet_loads());
+  }
 
   if (req->has_tablet_report()) {
     s = server_->catalog_manager()->ProcessTabletReport(
@@ -142,6 +142,19 @@ CHECKED_STATUS SysCatalogTable::AddItems(const vector<Item*>& items) {
   return MutateItems(items, QLWriteRequestPB::QL_STMT_INSERT);
 }
 
+template <class Item1, class Item2>
+CHECKED_STATUS SysCatalogTable::AddItems(
+    const vector<Item1*>& items1, const vector<Item2*>& items2) {
+  auto w = NewWriter();
+  for (const auto& item : items1) {
+    RETURN_NOT_OK(w->MutateItem(item, QLWriteRequestPB::QL_STMT_INSERT));
+  }
+  for (const auto& item : items2) {
+    RETURN_NOT_OK(w->MutateItem(item, QLWriteRequestPB::QL_STMT_INSERT));
+  }
+  return SyncWrite(w.get());
+}
+
 template <class Item>
 CHECKED_STATUS SysCatalogTable::AddAndUpdateItems(
     const vector<Item*>& added_items,
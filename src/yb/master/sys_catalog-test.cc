@@ -404,6 +404,39 @@ TEST_F(SysCatalogTest, TestSysCatalogTabletsOperations) {
   }
 }
 
+// Test adding a table together with its tablets in a single write.
+TEST_F(SysCatalogTest, TestSysCatalogAddTableWithTablets) {
+  SysCatalogTable* sys_catalog = master_->catalog_manager()->sys_catalog();
+
+  scoped_refptr<TableInfo> table(new TableInfo("abc"));
+  scoped_refptr<TabletInfo> tablet1(CreateTablet(table.get(), "123", "a", "b"));
+  scoped_refptr<TabletInfo> tablet2(CreateTablet(table.get(), "456", "b", "c"));
+  {
+    auto l = table->LockForWrite();
+    l->mutable_data()->pb.set_name("testtb");
+    l->mutable_data()->pb.set_state(SysTablesEntryPB::RUNNING);
+    ASSERT_OK(SchemaToPB(Schema(), l->mutable_data()->pb.mutable_schema()));
+    auto l1 = tablet1->LockForWrite();
+    auto l2 = tablet2->LockForWrite();
+    ASSERT_OK(sys_catalog->AddItems(std::vector<TabletInfo*>{ tablet1.get(), tablet2.get() },
+                                    std::vector<TableInfo*>{ table.get() }));
+    l->Commit();
+    l1->Commit();
+    l2->Commit();
+  }
+
+  unique_ptr<TestTableLoader> table_loader(new TestTableLoader());
+  ASSERT_OK(sys_catalog->Visit(table_loader.get()));
+  ASSERT_EQ(1 + master_->NumSystemTables(), table_loader->tables.size());
+  ASSERT_TRUE(MetadatasEqual(table.get(), table_loader->tables[table->id()]));
+
+  unique_ptr<TestTabletLoader> tablet_loader(new TestTabletLoader());
+  ASSERT_OK(sys_catalog->Visit(tablet_loader.get()));
+  ASSERT_EQ(2 + master_->NumSystemTables(), tablet_loader->tablets.size());
+  ASSERT_TRUE(MetadatasEqual(tablet1.get(), tablet_loader->tablets[tablet1->id()]));
+  ASSERT_TRUE(MetadatasEqual(tablet2.get(), tablet_loader->tablets[tablet2->id()]));
+}
+
 // Verify that data mutations are not available from metadata() until commit.
 TEST_F(SysCatalogTest, TestTabletInfoCommit) {
   scoped_refptr<TabletInfo> tablet(new TabletInfo(nullptr, "123"));
@@ -106,6 +106,9 @@ class SysCatalogTable {
 
   template <class Item>
   CHECKED_STATUS AddItems(const vector<Item*>& items);
+  // Adds items of two types, e.g. a new table and its tablets, in a single write.
+  template <class Item1, class Item2>
+  CHECKED_STATUS AddItems(const vector<Item1*>& items1, const vector<Item2*>& items2);
 
   template <class Item>
   CHECKED_STATUS UpdateItem(Item* item);
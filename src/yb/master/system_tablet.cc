@@ -40,8 +40,9 @@ const TabletId& SystemTablet::tablet_id() const {
   return tablet_id_;
 }
 
-void SystemTablet::RegisterReaderTimestamp(HybridTime read_point) {
+Status SystemTablet::RegisterReaderTimestamp(HybridTime read_point) {
   // NOOP.
+  return Status::OK();
 }
 
 void SystemTablet::UnregisterReader(HybridTime read_point) {
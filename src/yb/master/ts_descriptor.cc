@@ -165,6 +165,38 @@ double TSDescriptor::RecentReplicaCreations() {
   return recent_replica_creations_;
 }
 
+void TSDescriptor::UpdateTabletLoads(
+    const google::protobuf::RepeatedPtrField<TabletLoadPB>& loads) {
+  MonoTime now = MonoTime::Now(MonoTime::FINE);
+  std::lock_guard<simple_spinlock> l(lock_);
+  const double secs_since_last_update = last_tablet_loads_update_.Initialized()
+      ? now.GetDeltaSince(last_tablet_loads_update_).ToSeconds() : 0;
+  std::unordered_map<std::string, ReportedTabletLoad> new_loads;
+  for (const auto& load_pb : loads) {
+    auto& reported = new_loads[load_pb.tablet_id()];
+    reported.read_ops = load_pb.read_ops();
+    reported.write_ops = load_pb.write_ops();
+    reported.load.sst_files_size = load_pb.sst_files_size();
+    auto it = tablet_loads_.find(load_pb.tablet_id());
+    // Counters restart from 0 when the replica is reopened, in which case we have no rate yet.
+    if (it != tablet_loads_.end() && secs_since_last_update > 0 &&
+        reported.read_ops >= it->second.read_ops && reported.write_ops >= it->second.write_ops) {
+      reported.load.read_ops_per_sec =
+          (reported.read_ops - it->second.read_ops) / secs_since_last_update;
+      reported.load.write_ops_per_sec =
+          (reported.write_ops - it->second.write_ops) / secs_since_last_update;
+    }
+  }
+  tablet_loads_.swap(new_loads);
+  last_tablet_loads_update_ = now;
+}
+
+TabletReplicaLoad TSDescriptor::GetTabletLoad(const std::string& tablet_id) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto it = tablet_loads_.find(tablet_id);
+  return it != tablet_loads_.end() ? it->second.load : TabletReplicaLoad();
+}
+
 void TSDescriptor::GetRegistration(TSRegistrationPB* reg) const {
   std::lock_guard<simple_spinlock> l(lock_);
   CHECK(registration_) << "No registration";
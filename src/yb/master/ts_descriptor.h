@@ -35,6 +35,9 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+
+#include <google/protobuf/repeated_field.h>
 
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -60,6 +63,16 @@ namespace master {
 
 class TSRegistrationPB;
 class TSInformationPB;
+class TabletLoadPB;
+
+// Load of a tablet replica, derived from the loads reported by the tablet server hosting it.
+struct TabletReplicaLoad {
+  double read_ops_per_sec = 0;
+  double write_ops_per_sec = 0;
+  uint64_t sst_files_size = 0;
+
+  double ops_per_sec() const { return read_ops_per_sec + write_ops_per_sec; }
+};
 
 typedef util::SharedPtrTuple<tserver::TabletServerAdminServiceProxy,
                              tserver::TabletServerServiceProxy,
@@ -147,6 +160,15 @@ class TSDescriptor {
     return num_live_replicas_;
   }
 
+  // Update the load of the tablets hosted on this server from a heartbeat. The reported operation
+  // counts are cumulative, so rates are computed against the previous report. Tablets missing from
+  // the report are dropped.
+  void UpdateTabletLoads(const google::protobuf::RepeatedPtrField<TabletLoadPB>& loads);
+
+  // Return the last known load of the replica of the given tablet, or an empty load if the server
+  // has not reported it.
+  TabletReplicaLoad GetTabletLoad(const std::string& tablet_id) const;
+
   // Set of methods to keep track of pending tablet deletes for a tablet server. We use them to
   // avoid assigning more tablets to a tserver that might be potentially unresponsive.
   bool HasTabletDeletePending() const;
@@ -189,6 +211,16 @@ class TSDescriptor {
   // The number of live replicas on this host, from the last heartbeat.
   int num_live_replicas_;
 
+  struct ReportedTabletLoad {
+    uint64_t read_ops = 0;
+    uint64_t write_ops = 0;
+    TabletReplicaLoad load;
+  };
+
+  // Load of the tablets hosted on this server, from the last heartbeat that carried them.
+  std::unordered_map<std::string, ReportedTabletLoad> tablet_loads_;
+  MonoTime last_tablet_loads_update_;
+
   gscoped_ptr<TSRegistrationPB> registration_;
   std::string placement_id_;
 
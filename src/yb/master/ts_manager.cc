@@ -102,6 +102,7 @@ Status TSManager::RegisterTS(const NodeInstancePB& instance,
     LOG(INFO) << "Re-registered known tablet server { " << instance.ShortDebugString()
               << " } with Master";
   }
+  registration_version_.fetch_add(1, std::memory_order_acq_rel);
 
   return Status::OK();
 }
@@ -32,6 +32,7 @@
 #ifndef YB_MASTER_TS_MANAGER_H
 #define YB_MASTER_TS_MANAGER_H
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -101,6 +102,12 @@ class TSManager {
   // Get the TS count.
   int GetCount() const;
 
+  // Returns the number of registrations and re-registrations so far. Information derived from
+  // the registrations is to be rebuilt when it changes.
+  int64_t registration_version() const {
+    return registration_version_.load(std::memory_order_acquire);
+  }
+
   // Return the tablet server descriptor running on the given port.
   const std::shared_ptr<TSDescriptor> GetTSDescriptor(const HostPortPB& host_port) const;
 
@@ -113,6 +120,8 @@ class TSManager {
     std::string, std::shared_ptr<TSDescriptor> > TSDescriptorMap;
   TSDescriptorMap servers_by_id_;
 
+  std::atomic<int64_t> registration_version_{0};
+
   DISALLOW_COPY_AND_ASSIGN(TSManager);
 };
 
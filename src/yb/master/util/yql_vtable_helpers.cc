@@ -21,8 +21,9 @@ namespace util {
 // Ideally, we want clients to use YB's own load-balancing policy for Cassandra to route the
 // requests to the respective nodes hosting the partition keys. But for clients using vanilla
 // drivers and thus Cassandra's own token-aware policy, we still want the requests to hit our nodes
-// evenly. To do that, we split Cassandra's token ring (signed 64-bit number space) evenly and
-// return the token for each node in the node list.
+// evenly. To do that, we split Cassandra's token ring (signed 64-bit number space) evenly, in the
+// same order the hash partitions of a table follow, and return the token for each node in the
+// node list.
 QLValuePB GetTokensValue(size_t index, size_t node_count) {
   CHECK_GT(node_count, 0);
   QLValuePB value_pb;
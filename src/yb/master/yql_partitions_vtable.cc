@@ -14,6 +14,7 @@
 #include "yb/common/ql_value.h"
 #include "yb/common/redis_constants_common.h"
 #include "yb/master/catalog_manager.h"
+#include "yb/master/ts_manager.h"
 #include "yb/master/yql_partitions_vtable.h"
 
 namespace yb {
@@ -23,12 +24,45 @@ YQLPartitionsVTable::YQLPartitionsVTable(const Master* const master)
     : YQLVirtualTable(master::kSystemSchemaPartitionsTableName, master, CreateSchema()) {
 }
 
+bool YQLPartitionsVTable::TableVersion::operator==(const TableVersion& other) const {
+  return table == other.table && namespace_name == other.namespace_name &&
+         table_name == other.table_name && tablets == other.tablets &&
+         replica_locations_versions == other.replica_locations_versions;
+}
+
 Status YQLPartitionsVTable::RetrieveData(const QLReadRequestPB& request,
                                          std::unique_ptr<QLRowBlock>* vtable) const {
-  vtable->reset(new QLRowBlock(schema_));
-  std::vector<scoped_refptr<TableInfo> > tables;
+  Version version;
+  RETURN_NOT_OK(GetVersion(&version));
+
+  std::shared_ptr<const Snapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot = snapshot_;
+  }
+  if (!snapshot || !(snapshot->version == version)) {
+    auto new_snapshot = std::make_shared<Snapshot>(schema_);
+    RETURN_NOT_OK(BuildRows(version, &new_snapshot->rows));
+    new_snapshot->version = std::move(version);
+    snapshot = new_snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot_ = std::move(new_snapshot);
+  }
+
+  // The rows are copied because the caller filters them.
+  vtable->reset(new QLRowBlock(snapshot->rows));
+  return Status::OK();
+}
+
+Status YQLPartitionsVTable::GetVersion(Version* version) const {
   CatalogManager* catalog_manager = master_->catalog_manager();
+  // Read before the replica locations, so that the rows built for this version are never newer
+  // than the replica locations of the version.
+  version->ts_registration_version = master_->ts_manager()->registration_version();
+
+  std::vector<scoped_refptr<TableInfo> > tables;
   catalog_manager->GetAllTables(&tables, true /* includeOnlyRunningTables */);
+  version->tables.reserve(tables.size());
   for (const scoped_refptr<TableInfo>& table : tables) {
 
     // Get namespace for table.
@@ -42,14 +76,28 @@ Status YQLPartitionsVTable::RetrieveData(const QLReadRequestPB& request,
       continue;
     }
 
-    // Get tablets for table.
-    std::vector<scoped_refptr<TabletInfo> > tablets;
-    table->GetAllTablets(&tablets);
-    for (const scoped_refptr<TabletInfo>& tablet : tablets) {
+    version->tables.emplace_back();
+    TableVersion& table_version = version->tables.back();
+    table_version.table = table;
+    table_version.namespace_name = nsInfo->name();
+    table_version.table_name = table->name();
+    table->GetAllTablets(&table_version.tablets);
+    table_version.replica_locations_versions.reserve(table_version.tablets.size());
+    for (const scoped_refptr<TabletInfo>& tablet : table_version.tablets) {
+      table_version.replica_locations_versions.push_back(tablet->replica_locations_version());
+    }
+  }
+  return Status::OK();
+}
+
+Status YQLPartitionsVTable::BuildRows(const Version& version, QLRowBlock* rows) const {
+  CatalogManager* catalog_manager = master_->catalog_manager();
+  for (const TableVersion& table : version.tables) {
+    for (const scoped_refptr<TabletInfo>& tablet : table.tablets) {
 
-      QLRow& row = (*vtable)->Extend();
-      RETURN_NOT_OK(SetColumnValue(kKeyspaceName, nsInfo->name(), &row));
-      RETURN_NOT_OK(SetColumnValue(kTableName, table->name(), &row));
+      QLRow& row = rows->Extend();
+      RETURN_NOT_OK(SetColumnValue(kKeyspaceName, table.namespace_name, &row));
+      RETURN_NOT_OK(SetColumnValue(kTableName, table.table_name, &row));
 
       TabletLocationsPB tabletLocationsPB;
       RETURN_NOT_OK(catalog_manager->GetTabletLocations(tablet->id(), &tabletLocationsPB));
@@ -67,9 +115,10 @@ Status YQLPartitionsVTable::RetrieveData(const QLReadRequestPB& request,
       QLValuePB replica_addresses;
       QLValue::set_map_value(&replica_addresses);
       for (const auto replica : tabletLocationsPB.replicas()) {
-        InetAddress addr;
-        RETURN_NOT_OK(addr.FromString(replica.ts_info().rpc_addresses(0).host()));
-        QLValue::set_inetaddress_value(addr, QLValue::add_map_key(&replica_addresses));
+        // host portion of rpc_address might be a hostname and hence we need to resolve it.
+        std::vector<InetAddress> addresses;
+        RETURN_NOT_OK(InetAddress::Resolve(replica.ts_info().rpc_addresses(0).host(), &addresses));
+        QLValue::set_inetaddress_value(addresses[0], QLValue::add_map_key(&replica_addresses));
         const string& role = consensus::RaftPeerPB::Role_Name(replica.role());
         QLValue::set_string_value(role, QLValue::add_map_value(&replica_addresses));
       }
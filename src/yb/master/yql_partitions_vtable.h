@@ -14,6 +14,9 @@
 #ifndef YB_MASTER_YQL_PARTITIONS_VTABLE_H
 #define YB_MASTER_YQL_PARTITIONS_VTABLE_H
 
+#include <mutex>
+
+#include "yb/master/catalog_manager.h"
 #include "yb/master/master.h"
 #include "yb/master/yql_virtual_table.h"
 
@@ -21,6 +24,11 @@ namespace yb {
 namespace master {
 
 // VTable implementation of system_schema.partitions.
+//
+// The rows are built once for a given version of the tables, of their tablets and of the replica
+// locations of the tablets, and served from that snapshot until any of them changes, so that the
+// topology refreshes of many clients connecting at once do not rebuild them, nor resolve the
+// addresses of all the replicas, each time.
 class YQLPartitionsVTable : public YQLVirtualTable {
  public:
   explicit YQLPartitionsVTable(const Master* const master);
@@ -29,6 +37,40 @@ class YQLPartitionsVTable : public YQLVirtualTable {
  protected:
   Schema CreateSchema() const;
  private:
+  // A table whose tablets are listed in the table.
+  struct TableVersion {
+    scoped_refptr<TableInfo> table;
+    NamespaceName namespace_name;
+    TableName table_name;
+    std::vector<scoped_refptr<TabletInfo>> tablets;
+    std::vector<int64_t> replica_locations_versions;
+
+    bool operator==(const TableVersion& other) const;
+  };
+
+  // The version of the catalog state the rows are built from.
+  struct Version {
+    int64_t ts_registration_version = -1;
+    std::vector<TableVersion> tables;
+
+    bool operator==(const Version& other) const {
+      return ts_registration_version == other.ts_registration_version && tables == other.tables;
+    }
+  };
+
+  struct Snapshot {
+    Version version;
+    QLRowBlock rows;
+
+    explicit Snapshot(const Schema& schema) : rows(schema) {}
+  };
+
+  CHECKED_STATUS GetVersion(Version* version) const;
+  CHECKED_STATUS BuildRows(const Version& version, QLRowBlock* rows) const;
+
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const Snapshot> snapshot_;
+
   static constexpr const char* const kKeyspaceName = "keyspace_name";
   static constexpr const char* const kTableName = "table_name";
   static constexpr const char* const kStartKey = "start_key";
@@ -12,7 +12,11 @@
 //
 
 #include "yb/master/yql_peers_vtable.h"
+
+#include <algorithm>
+
 #include "yb/master/ts_descriptor.h"
+#include "yb/master/ts_manager.h"
 
 namespace yb {
 namespace master {
@@ -34,18 +38,54 @@ Status PeersVTable::RetrieveData(const QLReadRequestPB& request,
   // are dead. As a result, the master can't distinguish between nodes that are part of the
   // cluster and are dead vs nodes that have been removed from the cluster. Since, we might
   // change the cluster topology often, for now its safe to just have the live nodes here.
+  //
+  // Read the registration version first, so that the rows built for it are never older.
+  const int64_t ts_registration_version = master_->ts_manager()->registration_version();
   vector<shared_ptr<TSDescriptor> > descs;
   GetSortedLiveDescriptors(&descs);
 
-  // Collect all unique ip addresses.
+  shared_ptr<const Snapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot = snapshot_;
+  }
+  if (!snapshot || snapshot->ts_registration_version != ts_registration_version ||
+      snapshot->descs != descs) {
+    auto new_snapshot = std::make_shared<Snapshot>(schema_);
+    new_snapshot->ts_registration_version = ts_registration_version;
+    new_snapshot->descs = std::move(descs);
+    RETURN_NOT_OK(BuildSnapshot(new_snapshot.get()));
+    snapshot = new_snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot_ = std::move(new_snapshot);
+  }
+
   InetAddress remote_endpoint;
   RETURN_NOT_OK(remote_endpoint.FromString(request.remote_endpoint().host()));
 
   // Populate the YQL rows.
   vtable->reset(new QLRowBlock(schema_));
+  for (size_t index = 0; index != snapshot->peers.size(); ++index) {
+    // The system.peers table has one entry for each of its peers, whereas there is no entry for
+    // the node that the CQL client connects to. In this case, this node is the 'remote_endpoint'
+    // in QLReadRequestPB since that is address of the CQL proxy which sent this request. As a
+    // result, skip 'remote_endpoint' in the results.
+    const Peer& peer = snapshot->peers[index];
+    if (std::find(peer.addresses.begin(), peer.addresses.end(), remote_endpoint) !=
+        peer.addresses.end()) {
+      continue;
+    }
+    RETURN_NOT_OK(peer.status);
+    RETURN_NOT_OK((*vtable)->AddRow(snapshot->rows.rows()[index]));
+  }
 
-  size_t index = 0;
-  for (const shared_ptr<TSDescriptor>& desc : descs) {
+  return Status::OK();
+}
+
+Status PeersVTable::BuildSnapshot(Snapshot* snapshot) const {
+  snapshot->peers.resize(snapshot->descs.size());
+  for (size_t index = 0; index != snapshot->descs.size(); ++index) {
+    const shared_ptr<TSDescriptor>& desc = snapshot->descs[index];
     TSInformationPB ts_info;
     // This is thread safe since all operations are reads.
     desc->GetTSInformationPB(&ts_info);
@@ -56,46 +96,55 @@ Status PeersVTable::RetrieveData(const QLReadRequestPB& request,
                                desc->permanent_uuid());
     }
 
-    // The system.peers table has one entry for each of its peers, whereas there is no entry for
-    // the node that the CQL client connects to. In this case, this node is the 'remote_endpoint'
-    // in QLReadRequestPB since that is address of the CQL proxy which sent this request. As a
-    // result, skip 'remote_endpoint' in the results.
-    if (!util::RemoteEndpointMatchesTServer(ts_info, remote_endpoint)) {
-      InetAddress addr;
-      // Need to use only 1 rpc address per node since system.peers has only 1 entry for each host,
-      // so pick the first one.
-      const string& ts_host = ts_info.registration().common().rpc_addresses(0).host();
-      RETURN_NOT_OK(addr.FromString(ts_host));
-
-      QLRow& row = (*vtable)->Extend();
-      RETURN_NOT_OK(SetColumnValue(kPeer, addr, &row));
-      RETURN_NOT_OK(SetColumnValue(kRPCAddress, addr, &row));
-      RETURN_NOT_OK(SetColumnValue(kPreferredIp, addr, &row));
-
-      // Datacenter and rack.
-      CloudInfoPB cloud_info = ts_info.registration().common().cloud_info();
-      RETURN_NOT_OK(SetColumnValue(kDataCenter, cloud_info.placement_region(), &row));
-      RETURN_NOT_OK(SetColumnValue(kRack, cloud_info.placement_zone(), &row));
-
-      // HostId.
-      Uuid host_id;
-      RETURN_NOT_OK(host_id.FromHexString(ts_info.tserver_instance().permanent_uuid()));
-      RETURN_NOT_OK(SetColumnValue(kHostId, host_id, &row));
-
-      // schema_version.
-      Uuid schema_version;
-      CHECK_OK(schema_version.FromString(master::kDefaultSchemaVersion));
-      RETURN_NOT_OK(SetColumnValue(kSchemaVersion, schema_version, &row));
-
-      // Tokens.
-      RETURN_NOT_OK(SetColumnValue(kTokens, util::GetTokensValue(index, descs.size()), &row));
+    // Collect all unique ip addresses.
+    Peer& peer = snapshot->peers[index];
+    for (const HostPortPB& rpc_address : ts_info.registration().common().rpc_addresses()) {
+      // host portion of rpc_address might be a hostname and hence we need to resolve it.
+      vector<InetAddress> resolved_addresses;
+      if (!InetAddress::Resolve(rpc_address.host(), &resolved_addresses).ok()) {
+        LOG(WARNING) << "Could not resolve host: " << rpc_address.host();
+        continue;
+      }
+      peer.addresses.insert(
+          peer.addresses.end(), resolved_addresses.begin(), resolved_addresses.end());
     }
-    index++;
-  }
 
+    peer.status = BuildRow(ts_info, index, snapshot->descs.size(), &snapshot->rows.Extend());
+  }
   return Status::OK();
 }
 
+Status PeersVTable::BuildRow(const TSInformationPB& ts_info, size_t index, size_t num_peers,
+                             QLRow* row) const {
+  InetAddress addr;
+  // Need to use only 1 rpc address per node since system.peers has only 1 entry for each host,
+  // so pick the first one.
+  const string& ts_host = ts_info.registration().common().rpc_addresses(0).host();
+  RETURN_NOT_OK(addr.FromString(ts_host));
+
+  RETURN_NOT_OK(SetColumnValue(kPeer, addr, row));
+  RETURN_NOT_OK(SetColumnValue(kRPCAddress, addr, row));
+  RETURN_NOT_OK(SetColumnValue(kPreferredIp, addr, row));
+
+  // Datacenter and rack.
+  CloudInfoPB cloud_info = ts_info.registration().common().cloud_info();
+  RETURN_NOT_OK(SetColumnValue(kDataCenter, cloud_info.placement_region(), row));
+  RETURN_NOT_OK(SetColumnValue(kRack, cloud_info.placement_zone(), row));
+
+  // HostId.
+  Uuid host_id;
+  RETURN_NOT_OK(host_id.FromHexString(ts_info.tserver_instance().permanent_uuid()));
+  RETURN_NOT_OK(SetColumnValue(kHostId, host_id, row));
+
+  // schema_version.
+  Uuid schema_version;
+  CHECK_OK(schema_version.FromString(master::kDefaultSchemaVersion));
+  RETURN_NOT_OK(SetColumnValue(kSchemaVersion, schema_version, row));
+
+  // Tokens.
+  return SetColumnValue(kTokens, util::GetTokensValue(index, num_peers), row);
+}
+
 Schema PeersVTable::CreateSchema() const {
   SchemaBuilder builder;
   CHECK_OK(builder.AddHashKeyColumn(kPeer, QLType::Create(DataType::INET)));
@@ -14,6 +14,8 @@
 #ifndef YB_MASTER_YQL_PEERS_VTABLE_H
 #define YB_MASTER_YQL_PEERS_VTABLE_H
 
+#include <mutex>
+
 #include "yb/master/master.h"
 #include "yb/master/yql_virtual_table.h"
 
@@ -21,6 +23,10 @@ namespace yb {
 namespace master {
 
 // VTable implementation of system.peers.
+//
+// The rows of all the live tablet servers are built once for a given set of live tablet servers
+// and version of their registrations, and served from that snapshot until either changes. Each
+// request only leaves out the row of the tablet server it comes from.
 class PeersVTable : public YQLVirtualTable {
  public:
   explicit PeersVTable(const Master* const master_);
@@ -40,6 +46,31 @@ class PeersVTable : public YQLVirtualTable {
   static constexpr const char* const kRPCAddress = "rpc_address";
   static constexpr const char* const kSchemaVersion = "schema_version";
   static constexpr const char* const kTokens = "tokens";
+
+  // A live tablet server, with the addresses its rpc addresses resolve to.
+  struct Peer {
+    std::vector<InetAddress> addresses;
+    // The status of building the row of the tablet server, which is only returned if the row is
+    // requested.
+    Status status;
+  };
+
+  // The rows of the given live tablet servers, in the same order.
+  struct Snapshot {
+    int64_t ts_registration_version = -1;
+    std::vector<std::shared_ptr<TSDescriptor>> descs;
+    std::vector<Peer> peers;
+    QLRowBlock rows;
+
+    explicit Snapshot(const Schema& schema) : rows(schema) {}
+  };
+
+  CHECKED_STATUS BuildSnapshot(Snapshot* snapshot) const;
+  CHECKED_STATUS BuildRow(const TSInformationPB& ts_info, size_t index, size_t num_peers,
+                          QLRow* row) const;
+
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const Snapshot> snapshot_;
 };
 
 }  // namespace master
@@ -37,6 +37,19 @@ CHECKED_STATUS Executor::ColumnRefsToPB(const PTDmlStmt *tnode,
   return Status::OK();
 }
 
+void Executor::IndexesToPB(const shared_ptr<client::YBTable>& table, QLWriteRequestPB *req) {
+  // The tablet server needs the current values of the indexed columns to update the indexes.
+  const Schema& schema = table->InternalSchema();
+  for (const IndexInfoPB& index : table->indexes()) {
+    req->add_update_indexes()->CopyFrom(index);
+    for (const auto& column : index.columns()) {
+      if (!schema.is_key_column(ColumnId(column.indexed_column_id()))) {
+        req->mutable_column_refs()->add_ids(column.indexed_column_id());
+      }
+    }
+  }
+}
+
 CHECKED_STATUS Executor::ColumnArgsToPB(const shared_ptr<client::YBTable>& table,
                                         const PTDmlStmt *tnode,
                                         QLWriteRequestPB *req) {
@@ -101,5 +101,18 @@ void ExecContext::AdvanceToNextPartition(QLReadRequestPB *req) {
   }
 }
 
+void ExecContext::SetPartition(QLReadRequestPB *req, uint64_t partition_index) const {
+  // Same as in AdvanceToNextPartition, except that all the columns after the fixed ones are set
+  // since the given partition does not have to be adjacent to the one the request references.
+  int hash_key_size = req->hashed_column_values().size();
+  int fixed_cols_size = hash_key_size - hash_values_options_->size();
+  for (int i = hash_key_size - 1; i >= fixed_cols_size; i--) {
+    const auto& options = (*hash_values_options_)[i - fixed_cols_size];
+    int pos = partition_index % options.size();
+    req->mutable_hashed_column_values(i)->CopyFrom(options[pos]);
+    partition_index /= options.size();
+  }
+}
+
 }  // namespace ql
 }  // namespace yb
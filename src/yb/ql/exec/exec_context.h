@@ -20,6 +20,8 @@
 #ifndef YB_QL_EXEC_EXEC_CONTEXT_H_
 #define YB_QL_EXEC_EXEC_CONTEXT_H_
 
+#include <deque>
+
 #include "yb/ql/ptree/process_context.h"
 #include "yb/ql/util/ql_env.h"
 #include "yb/ql/util/statement_result.h"
@@ -140,6 +142,12 @@ class ExecContext : public ProcessContextBase {
   // this will do, index: 2 -> 3 and hashed_column_values: [1, 3, 4, 6] -> [1, 3, 5, 6].
   void AdvanceToNextPartition(QLReadRequestPB *req);
 
+  // Used for multi-partition selects (i.e. with 'IN' conditions on hash columns).
+  // Sets the hashed column values in a copy of the current read request so that it references the
+  // partition at the given index. Does not change the current partition index.
+  // Called from Executor::PrefetchPartitions.
+  void SetPartition(QLReadRequestPB *req, uint64_t partition_index) const;
+
   std::unique_ptr<std::vector<std::vector<QLExpressionPB>>>& hash_values_options() {
     if (hash_values_options_ == nullptr) {
       hash_values_options_ = std::make_unique<std::vector<std::vector<QLExpressionPB>>>();
@@ -171,6 +179,18 @@ class ExecContext : public ProcessContextBase {
     return ql_env_->ApplyRead(op);
   }
 
+  // Apply a read of a partition following the current one so that it is executed concurrently with
+  // the read of the current partition.
+  CHECKED_STATUS ApplyPrefetchRead(std::shared_ptr<client::YBqlReadOp> op) {
+    prefetched_reads_.push_back(op);
+    return ql_env_->ApplyRead(op);
+  }
+
+  // Access function for prefetched_reads.
+  std::deque<std::shared_ptr<client::YBqlReadOp>>& prefetched_reads() {
+    return prefetched_reads_;
+  }
+
   // Variants of ProcessContextBase::Error() that report location of statement tnode as the error
   // location.
   using ProcessContextBase::Error;
@@ -203,6 +223,10 @@ class ExecContext : public ProcessContextBase {
   std::unique_ptr<std::vector<std::vector<QLExpressionPB>>> hash_values_options_;
   uint64_t partitions_count_;
   uint64_t current_partition_index_;
+
+  // Reads of the partitions following the current one, in partition order, that were issued
+  // together with the read of the current partition and are yet to be merged into the result.
+  std::deque<std::shared_ptr<client::YBqlReadOp>> prefetched_reads_;
 };
 
 }  // namespace ql
@@ -14,10 +14,21 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/ql/exec/executor.h"
+
+#include <limits>
+
 #include "yb/util/logging.h"
 #include "yb/client/callbacks.h"
+#include "yb/client/meta_cache.h"
 #include "yb/ql/ql_processor.h"
 #include "yb/util/decimal.h"
+#include "yb/util/flag_tags.h"
+#include "yb/common/ql_expr.h"
+
+DEFINE_int32(ql_max_parallel_partition_reads, 4,
+             "Maximum number of partitions of a multi-partition select (i.e. with 'IN' condition "
+             "on hash columns) that are read concurrently. 1 reads the partitions one at a time.");
+TAG_FLAG(ql_max_parallel_partition_reads, advanced);
 
 namespace yb {
 namespace ql {
@@ -61,7 +72,7 @@ void Executor::ExecuteAsync(const string &ql_stmt, const ParseTree &parse_tree,
   if (PREDICT_FALSE(!s.ok())) {
     return StatementExecuted(s);
   }
-  if (!ql_env_->FlushAsync(&flush_async_cb_)) {
+  if (!FlushAsync()) {
     return StatementExecuted(Status::OK());
   }
 }
@@ -110,7 +121,7 @@ void Executor::ExecuteBatch(const std::string &ql_stmt, const ParseTree &parse_t
 
 void Executor::ApplyBatch() {
   // Invoke statement-executed callback when no async operation is pending.
-  if (!ql_env_->FlushAsync(&flush_async_cb_)) {
+  if (!FlushAsync()) {
     return StatementExecuted(Status::OK());
   }
 }
@@ -127,7 +138,10 @@ Status Executor::Execute(const string &ql_stmt, const ParseTree &parse_tree,
   // Prepare execution context and execute the parse tree's root node.
   exec_contexts_.emplace_back(ql_stmt.c_str(), ql_stmt.length(), &parse_tree, params, ql_env_);
   exec_context_ = &exec_contexts_.back();
-  return ProcessStatementStatus(parse_tree, ExecTreeNode(exec_context_->tnode()));
+  const MonoTime begin_time = MonoTime::Now(MonoTime::FINE);
+  const Status s = ExecTreeNode(exec_context_->tnode());
+  stats_.build_time += MonoTime::Now(MonoTime::FINE).GetDeltaSince(begin_time);
+  return ProcessStatementStatus(parse_tree, s);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -137,7 +151,8 @@ Status Executor::ExecTreeNode(const TreeNode *tnode) {
     return Status::OK();
   }
   switch (tnode->opcode()) {
-    case TreeNodeOpcode::kPTCreateTable:
+    case TreeNodeOpcode::kPTCreateTable: FALLTHROUGH_INTENDED;
+    case TreeNodeOpcode::kPTCreateIndex:
       return ExecPTNode(static_cast<const PTCreateTable *>(tnode));
 
     case TreeNodeOpcode::kPTAlterTable:
@@ -266,8 +281,13 @@ Status Executor::ExecPTNode(const PTCreateTable *tnode) {
     return exec_context_->Error(tnode->columns().front(), s, ErrorCode::INVALID_TABLE_DEFINITION);
   }
 
-  // Create table.
+  // Create table. An index is created as a table in the keyspace of the indexed table.
   shared_ptr<YBTableCreator> table_creator(exec_context_->NewTableCreator());
+  if (tnode->opcode() == TreeNodeOpcode::kPTCreateIndex) {
+    const auto* index_node = static_cast<const PTCreateIndex *>(tnode);
+    table_name = YBTableName(table_name.namespace_name(), index_node->name()->c_str());
+    table_creator->indexed_table(*index_node->indexed_table());
+  }
   s = table_creator->table_name(table_name)
                     .table_type(YBTableType::YQL_TABLE_TYPE)
                     .schema(&schema)
@@ -289,8 +309,15 @@ Status Executor::ExecPTNode(const PTCreateTable *tnode) {
     return exec_context_->Error(tnode->table_name(), s, error_code);
   }
 
-  result_ = std::make_shared<SchemaChangeResult>(
-      "CREATED", "TABLE", table_name.namespace_name(), table_name.table_name());
+  if (tnode->opcode() == TreeNodeOpcode::kPTCreateIndex) {
+    // Like Cassandra, report the creation of an index as an update of the indexed table.
+    result_ = std::make_shared<SchemaChangeResult>(
+        "UPDATED", "TABLE", table_name.namespace_name(),
+        tnode->yb_table_name().table_name());
+  } else {
+    result_ = std::make_shared<SchemaChangeResult>(
+        "CREATED", "TABLE", table_name.namespace_name(), table_name.table_name());
+  }
   return Status::OK();
 }
 
@@ -429,8 +456,34 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     return exec_context_->Error(s, ErrorCode::INVALID_ARGUMENTS);
   }
 
+  // Specify selected list by adding the expressions to selected_exprs in read request.
+  if (tnode->is_aggregate()) {
+    RETURN_NOT_OK(AggregateCallsToPB(tnode, req));
+  } else {
+    QLRSRowDescPB *rsrow_desc_pb = req->mutable_rsrow_desc();
+    for (const auto& expr : tnode->selected_exprs()) {
+      if (expr->opcode() == TreeNodeOpcode::kPTAllColumns) {
+        s = PTExprToPB(static_cast<const PTAllColumns*>(expr.get()), req);
+      } else {
+        s = PTExprToPB(expr, req->add_selected_exprs());
+        if (PREDICT_FALSE(!s.ok())) {
+          return exec_context_->Error(s, ErrorCode::INVALID_ARGUMENTS);
+        }
+
+        // Add the expression metadata (rsrow descriptor).
+        QLRSColDescPB *rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
+        rscol_desc_pb->set_name(expr->QLName());
+        expr->ql_type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+      }
+    }
+  }
+
   // If where clause restrictions guarantee no rows could match, return empty result immediately.
+  // Aggregate functions still return one row computed over no rows.
   if (no_results) {
+    if (tnode->is_aggregate()) {
+      return AggregateResultSets(*req);
+    }
     QLRowBlock empty_row_block(tnode->table()->InternalSchema(), {});
     faststring buffer;
     empty_row_block.Serialize(select_op->request().client(), &buffer);
@@ -439,24 +492,6 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     return Status::OK();
   }
 
-  // Specify selected list by adding the expressions to selected_exprs in read request.
-  QLRSRowDescPB *rsrow_desc_pb = req->mutable_rsrow_desc();
-  for (const auto& expr : tnode->selected_exprs()) {
-    if (expr->opcode() == TreeNodeOpcode::kPTAllColumns) {
-      s = PTExprToPB(static_cast<const PTAllColumns*>(expr.get()), req);
-    } else {
-      s = PTExprToPB(expr, req->add_selected_exprs());
-      if (PREDICT_FALSE(!s.ok())) {
-        return exec_context_->Error(s, ErrorCode::INVALID_ARGUMENTS);
-      }
-
-      // Add the expression metadata (rsrow descriptor).
-      QLRSColDescPB *rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
-      rscol_desc_pb->set_name(expr->QLName());
-      expr->ql_type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
-    }
-  }
-
   // Setup the column values that need to be read.
   s = ColumnRefsToPB(tnode, req->mutable_column_refs());
   if (PREDICT_FALSE(!s.ok())) {
@@ -494,9 +529,10 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
 
     // If the LIMIT clause, subtracting the number of rows we have returned so far, is lower than
     // the page size limit set from above, set the lower limit and do not return paging state when
-    // this limit is hit.
+    // this limit is hit. For aggregate functions, the LIMIT applies to the one aggregated row
+    // instead, and all rows are read page by page.
     limit -= params.total_num_rows_read();
-    if (limit <= req->limit()) {
+    if (!tnode->is_aggregate() && limit <= req->limit()) {
       req->set_limit(limit);
       req->set_return_paging_state(false);
     }
@@ -532,7 +568,163 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
   }
 
   // Apply the operator.
-  return exec_context_->ApplyRead(select_op);
+  RETURN_NOT_OK(exec_context_->ApplyRead(select_op));
+
+  // Read the partitions following the first one concurrently with it.
+  if (exec_context_->UnreadPartitionsRemaining() > 1) {
+    return PrefetchPartitions(tnode, select_op);
+  }
+  return Status::OK();
+}
+
+Status Executor::PrefetchPartitions(const PTSelectStmt *tnode,
+                                    const shared_ptr<YBqlReadOp>& op) {
+  const uint64_t reads_count = std::min<uint64_t>(exec_context_->UnreadPartitionsRemaining(),
+                                                  std::max(FLAGS_ql_max_parallel_partition_reads,
+                                                           1));
+  for (uint64_t i = 1; i < reads_count; i++) {
+    // Each prefetched read starts from the beginning of its partition with the same limit as the
+    // current read. Its result is merged in FetchMoreRowsIfNeeded once the partitions before it
+    // have been exhausted.
+    shared_ptr<YBqlReadOp> read(tnode->table()->NewQLSelect());
+    QLReadRequestPB *req = read->mutable_request();
+    req->CopyFrom(op->request());
+    req->clear_hash_code();
+    req->clear_paging_state();
+    exec_context_->SetPartition(req, exec_context_->current_partition_index() + i);
+    read->set_yb_consistency_level(op->yb_consistency_level());
+    RETURN_NOT_OK(exec_context_->ApplyPrefetchRead(read));
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Sets "result" to "sum / count" in the given datatype, or to 0 if there were no values.
+Status ComputeAverage(const QLValueWithPB& sum, int64_t count, DataType type, QLValue *result) {
+  const bool no_values = sum.IsNull() || count == 0;
+  switch (type) {
+    case DataType::INT8:
+      result->set_int8_value(no_values ? 0 : sum.int8_value() / count);
+      return Status::OK();
+    case DataType::INT16:
+      result->set_int16_value(no_values ? 0 : sum.int16_value() / count);
+      return Status::OK();
+    case DataType::INT32:
+      result->set_int32_value(no_values ? 0 : sum.int32_value() / count);
+      return Status::OK();
+    case DataType::INT64:
+      result->set_int64_value(no_values ? 0 : sum.int64_value() / count);
+      return Status::OK();
+    case DataType::FLOAT:
+      result->set_float_value(no_values ? 0 : sum.float_value() / count);
+      return Status::OK();
+    case DataType::DOUBLE:
+      result->set_double_value(no_values ? 0 : sum.double_value() / count);
+      return Status::OK();
+    default:
+      break;
+  }
+  return STATUS_SUBSTITUTE(NotSupported, "Cannot compute average of datatype $0",
+                           static_cast<int>(type));
+}
+
+} // namespace
+
+Status Executor::AggregateCallsToPB(const PTSelectStmt *tnode, QLReadRequestPB *req) {
+  QLRSRowDescPB *rsrow_desc_pb = req->mutable_rsrow_desc();
+  for (const auto& expr : tnode->selected_exprs()) {
+    const PTBcall *bcall = PTSelectStmt::AggregateCall(expr);
+    const auto opcode = static_cast<bfql::TSOpcode>(bcall->bfopcode());
+    if (opcode == bfql::TSOpcode::kSum || opcode == bfql::TSOpcode::kAvg) {
+      const DataType type = bcall->ql_type()->main();
+      if (type == DataType::VARINT || type == DataType::DECIMAL) {
+        return exec_context_->Error(bcall, "SUM and AVG of varint and decimal are not supported",
+                                    ErrorCode::FEATURE_NOT_SUPPORTED);
+      }
+    }
+
+    QLExpressionPB *expr_pb = req->add_selected_exprs();
+    Status s = PTExprToPB(bcall, expr_pb);
+    if (PREDICT_FALSE(!s.ok())) {
+      return exec_context_->Error(s, ErrorCode::INVALID_ARGUMENTS);
+    }
+    if (!expr_pb->has_tscall()) {
+      return exec_context_->Error(bcall, "Aggregate function result cannot be casted",
+                                  ErrorCode::FEATURE_NOT_SUPPORTED);
+    }
+    QLRSColDescPB *rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
+    rscol_desc_pb->set_name(bcall->QLName());
+    bcall->ql_type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+
+    // Tablet servers return the SUM and the COUNT of the argument of AVG, which are combined into
+    // the average only after all partial results have been merged.
+    if (opcode == bfql::TSOpcode::kAvg) {
+      expr_pb->mutable_tscall()->set_opcode(static_cast<int32_t>(bfql::TSOpcode::kSum));
+      QLExpressionPB *count_pb = req->add_selected_exprs();
+      count_pb->CopyFrom(*expr_pb);
+      count_pb->mutable_tscall()->set_opcode(static_cast<int32_t>(bfql::TSOpcode::kCount));
+      rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
+      rscol_desc_pb->set_name(bcall->QLName());
+      QLType::Create(DataType::INT64)->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+    }
+  }
+  req->set_is_aggregate(true);
+  return Status::OK();
+}
+
+Status Executor::AggregateResultSets(const QLReadRequestPB& req) {
+  const PTSelectStmt *tnode = static_cast<const PTSelectStmt *>(exec_context_->tnode());
+
+  // Merge the partial rows returned by the tablet servers.
+  std::vector<QLValueWithPB> aggr_values(req.selected_exprs().size());
+  for (int i = 0; i < req.selected_exprs().size(); i++) {
+    QLExprExecutor::InitAggregate(
+        static_cast<bfql::TSOpcode>(req.selected_exprs(i).tscall().opcode()), &aggr_values[i]);
+  }
+  if (result_ != nullptr) {
+    const std::unique_ptr<QLRowBlock> partial_rows =
+        std::static_pointer_cast<RowsResult>(result_)->GetRowBlock();
+    for (const QLRow& row : partial_rows->rows()) {
+      for (int i = 0; i < req.selected_exprs().size(); i++) {
+        RETURN_NOT_OK(QLExprExecutor::MergeAggregate(
+            static_cast<bfql::TSOpcode>(req.selected_exprs(i).tscall().opcode()),
+            static_cast<const QLValueWithPB&>(row.column(i)), &aggr_values[i]));
+      }
+    }
+  }
+
+  // Compute the aggregated row. As in Cassandra, SUM and AVG of no values are 0.
+  const shared_ptr<std::vector<ColumnSchema>>& column_schemas = tnode->selected_schemas();
+  QLRowBlock row_block(Schema(*column_schemas, 0));
+  QLRow& row = row_block.Extend();
+  int aggr_index = 0;
+  int column_index = 0;
+  for (const auto& expr : tnode->selected_exprs()) {
+    const PTBcall *bcall = PTSelectStmt::AggregateCall(expr);
+    const QLValueWithPB& aggr_value = aggr_values[aggr_index++];
+    QLValue *column = row.mutable_column(column_index++);
+    switch (static_cast<bfql::TSOpcode>(bcall->bfopcode())) {
+      case bfql::TSOpcode::kSum:
+        // A sum is its own average over a count of 1, which also turns a null sum into 0.
+        RETURN_NOT_OK(ComputeAverage(aggr_value, 1, bcall->ql_type()->main(), column));
+        break;
+      case bfql::TSOpcode::kAvg: {
+        const int64_t count = aggr_values[aggr_index++].int64_value();
+        RETURN_NOT_OK(ComputeAverage(aggr_value, count, bcall->ql_type()->main(), column));
+        break;
+      }
+      default:
+        column->Assign(aggr_value.value());
+        break;
+    }
+  }
+
+  faststring buffer;
+  row_block.Serialize(req.client(), &buffer);
+  result_ = std::make_shared<RowsResult>(tnode->table()->name(), column_schemas,
+                                         buffer.ToString());
+  return Status::OK();
 }
 
 Status Executor::FetchMoreRowsIfNeeded() {
@@ -557,9 +749,12 @@ Status Executor::FetchMoreRowsIfNeeded() {
   StatementParameters current_params;
   RETURN_NOT_OK(current_params.set_paging_state(current_result->paging_state()));
 
-  // The limit for this select: min of page size and result limit (if set).
-  uint64_t fetch_limit = exec_context_->params()->page_size(); // default;
-  if (tnode->has_limit()) {
+  // The limit for this select: min of page size and result limit (if set). Aggregate functions
+  // read all rows page by page and return one partial row per page, so they are not limited.
+  const bool is_aggregate = tnode->is_aggregate();
+  uint64_t fetch_limit = is_aggregate ? std::numeric_limits<uint64_t>::max()
+                                      : exec_context_->params()->page_size(); // default;
+  if (tnode->has_limit() && !is_aggregate) {
     QLExpressionPB limit_pb;
     RETURN_NOT_OK(PTExprToPB(tnode->limit(), &limit_pb));
     int64_t limit = limit_pb.value().int32_value() - previous_fetches_row_count;
@@ -576,6 +771,7 @@ Status Executor::FetchMoreRowsIfNeeded() {
 
   // If there is no paging state the current scan has exhausted its results.
   bool finished_current_read_partition = current_result->paging_state().empty();
+  bool prefetch_next_partitions = false;
   if (finished_current_read_partition) {
 
     // If there or no other partitions to query, we are done.
@@ -586,6 +782,39 @@ Status Executor::FetchMoreRowsIfNeeded() {
     // Otherwise, we continue to the next partition.
     exec_context_->AdvanceToNextPartition(op->mutable_request());
     op->mutable_request()->clear_hash_code();
+
+    // If the next partition has already been read concurrently with the previous ones, merge its
+    // result unless that would exceed the fetch limit, in which case it is read again below with
+    // the remaining limit.
+    auto& prefetched_reads = exec_context_->prefetched_reads();
+    if (!prefetched_reads.empty()) {
+      RowsResult read_result(prefetched_reads.front().get());
+      prefetched_reads.pop_front();
+      size_t read_row_count = 0;
+      if (!read_result.rows_data().empty()) {
+        RETURN_NOT_OK(QLRowBlock::GetRowCount(read_result.client(),
+                                              read_result.rows_data(),
+                                              &read_row_count));
+      }
+      if (current_fetch_row_count + read_row_count <= fetch_limit) {
+        // The prefetched read did not know how many rows were read before it, so fix up the total
+        // and the partition to resume from in its paging state.
+        if (!read_result.paging_state().empty()) {
+          QLPagingStatePB paging_state;
+          if (!paging_state.ParseFromString(read_result.paging_state())) {
+            return STATUS(Corruption, "invalid paging state");
+          }
+          paging_state.set_total_num_rows_read(total_row_count + read_row_count);
+          paging_state.set_next_partition_index(exec_context_->current_partition_index());
+          read_result.set_paging_state(paging_state);
+        }
+        RETURN_NOT_OK(current_result->Append(read_result));
+        return FetchMoreRowsIfNeeded();
+      }
+      prefetched_reads.clear();
+    } else {
+      prefetch_next_partitions = true;
+    }
   }
 
   // If we reached the fetch limit (min of paging state and limit clause) we are done.
@@ -621,14 +850,22 @@ Status Executor::FetchMoreRowsIfNeeded() {
   // Fetch more results.
 
   // Update limit and paging_state information for next scan request.
-  op->mutable_request()->set_limit(fetch_limit - current_fetch_row_count);
+  if (!is_aggregate) {
+    op->mutable_request()->set_limit(fetch_limit - current_fetch_row_count);
+  }
   QLPagingStatePB *paging_state = op->mutable_request()->mutable_paging_state();
   paging_state->set_next_partition_key(current_params.next_partition_key());
   paging_state->set_next_row_key(current_params.next_row_key());
   paging_state->set_total_num_rows_read(total_row_count);
 
   // Apply the request.
-  return exec_context_->ApplyRead(op);
+  RETURN_NOT_OK(exec_context_->ApplyRead(op));
+
+  // Read the partitions following the new one concurrently with it.
+  if (prefetch_next_partitions && exec_context_->UnreadPartitionsRemaining() > 1) {
+    return PrefetchPartitions(tnode, op);
+  }
+  return Status::OK();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -662,6 +899,9 @@ Status Executor::ExecPTNode(const PTInsertStmt *tnode) {
     }
   }
 
+  // Maintain the secondary indexes of the table.
+  IndexesToPB(table, req);
+
   // Apply the operator.
   return exec_context_->ApplyWrite(insert_op);
 }
@@ -700,6 +940,9 @@ Status Executor::ExecPTNode(const PTDeleteStmt *tnode) {
     }
   }
 
+  // Maintain the secondary indexes of the table.
+  IndexesToPB(table, req);
+
   // Apply the operator.
   return exec_context_->ApplyWrite(delete_op);
 }
@@ -743,6 +986,9 @@ Status Executor::ExecPTNode(const PTUpdateStmt *tnode) {
     }
   }
 
+  // Maintain the secondary indexes of the table.
+  IndexesToPB(table, req);
+
   // Apply the operator.
   return exec_context_->ApplyWrite(update_op);
 }
@@ -784,24 +1030,119 @@ Status Executor::ExecPTNode(const PTUseKeyspace *tnode) {
   return Status::OK();
 }
 
+bool Executor::FlushAsync() {
+  // The callback may run before FlushAsync returns, so the flush is counted before it starts.
+  flush_begin_ = MonoTime::Now(MonoTime::FINE);
+  stats_.num_flushes++;
+  if (ql_env_->FlushAsync(&flush_async_cb_)) {
+    return true;
+  }
+  stats_.num_flushes--;
+  return false;
+}
+
+void Executor::AddOpStats(const client::YBqlOp& op) {
+  stats_.num_ops++;
+  if (op.tablet() != nullptr) {
+    stats_.tablet_ids.insert(op.tablet()->tablet_id());
+  }
+  stats_.rows_scanned += op.response().rows_scanned();
+}
+
 void Executor::FlushAsyncDone(const Status &s) {
+  stats_.flush_time += MonoTime::Now(MonoTime::FINE).GetDeltaSince(flush_begin_);
   Status ss = s;
-  if (ss.ok()) {
+  if (ss.ok() && !index_ops_.empty()) {
+    // The writes to the secondary indexes have completed.
+    ss = ProcessIndexResults();
+  } else if (ss.ok()) {
     ss = ProcessAsyncResults();
-    if (ss.ok() && exec_context_->tnode()->opcode() == TreeNodeOpcode::kPTSelectStmt) {
+    if (ss.ok() && exec_context_->tnode()->opcode() != TreeNodeOpcode::kPTSelectStmt) {
+      ql_env_->Reset();
+      ss = ApplyIndexWrites();
+      if (ss.ok() && FlushAsync()) {
+        return;
+      }
+    } else if (ss.ok()) {
 
       ql_env_->Reset();
       ss = FetchMoreRowsIfNeeded();
       if (ss.ok()) {
-        if (ql_env_->FlushAsync(&flush_async_cb_)) {
+        if (FlushAsync()) {
           return;
         }
+
+        // All rows have been read. Combine the partial results of aggregate functions.
+        const auto* tnode = static_cast<const PTSelectStmt*>(exec_context_->tnode());
+        if (tnode->is_aggregate()) {
+          const auto op = std::static_pointer_cast<YBqlReadOp>(exec_context_->op());
+          ss = AggregateResultSets(op->request());
+        }
       }
     }
   }
   StatementExecuted(ss);
 }
 
+Status Executor::ApplyIndexWrites() {
+  for (auto& exec_context : exec_contexts_) {
+    const auto& op = exec_context.op();
+    if (op == nullptr || op->type() != client::YBOperation::QL_WRITE) {
+      continue;
+    }
+    for (QLWriteRequestPB& index_request : *op->mutable_response()->mutable_index_requests()) {
+      const shared_ptr<YBTable> index_table = GetIndexTable(*op->table(), index_request.table_id());
+      if (index_table == nullptr) {
+        return exec_context.Error("Index table not found", ErrorCode::SERVER_ERROR);
+      }
+      shared_ptr<YBqlWriteOp> index_op(index_table->NewQLWrite());
+      QLWriteRequestPB* req = index_op->mutable_request();
+      req->Swap(&index_request);
+      req->clear_table_id();
+      req->set_client(YQL_CLIENT_CQL);
+      req->set_request_id(reinterpret_cast<uint64_t>(index_op.get()));
+      req->set_query_id(reinterpret_cast<int64_t>(index_op.get()));
+      req->set_schema_version(index_table->schema().version());
+      RETURN_NOT_OK(ql_env_->ApplyWrite(index_op));
+      index_ops_.push_back(std::move(index_op));
+    }
+  }
+  return Status::OK();
+}
+
+Status Executor::ProcessIndexResults() {
+  for (const auto& index_op : index_ops_) {
+    AddOpStats(*index_op);
+    const Status s = ql_env_->GetOpError(index_op.get());
+    if (PREDICT_FALSE(!s.ok())) {
+      return exec_context_->Error(s, ErrorCode::SERVER_ERROR);
+    }
+    const QLResponsePB& resp = index_op->response();
+    if (resp.status() != QLResponsePB::YQL_STATUS_OK) {
+      return exec_context_->Error(resp.error_message().c_str(), ErrorCode::SERVER_ERROR);
+    }
+  }
+  return Status::OK();
+}
+
+shared_ptr<YBTable> Executor::GetIndexTable(const YBTable& table, const TableId& index_id) {
+  for (const IndexInfoPB& index : table.indexes()) {
+    if (index.table_id() != index_id) {
+      continue;
+    }
+    // Reload the index table if the cached one with the same name has been dropped.
+    const YBTableName index_name(table.name().namespace_name(), index.table_name());
+    bool cache_used = false;
+    shared_ptr<YBTable> index_table = ql_env_->GetTableDesc(index_name, &cache_used);
+    if (index_table != nullptr && index_table->id() != index_id && cache_used) {
+      ql_env_->RemoveCachedTableDesc(index_name);
+      index_table = ql_env_->GetTableDesc(index_name, &cache_used);
+    }
+    return index_table != nullptr && index_table->id() == index_id ? index_table : nullptr;
+  }
+  return nullptr;
+}
+
 Status Executor::ProcessStatementStatus(const ParseTree &parse_tree, const Status& s) {
   if (PREDICT_FALSE(!s.ok() && s.IsQLError() && !parse_tree.reparsed())) {
     // If execution fails because the statement was analyzed with stale metadata cache, the
@@ -855,6 +1196,7 @@ Status Executor::ProcessAsyncResults() {
       continue; // Skip empty statement.
     }
     client::YBqlOp* op = exec_context.op().get();
+    AddOpStats(*op);
     ss = ql_env_->GetOpError(op);
     if (PREDICT_FALSE(!ss.ok())) {
       // YBOperation returns not-found error when the tablet is not found.
@@ -865,6 +1207,17 @@ Status Executor::ProcessAsyncResults() {
     if (ss.ok()) {
       ss = ProcessOpResponse(op, &exec_context);
     }
+
+    // Drop the prefetched partition reads from the first failed one on. Those partitions are read
+    // again one at a time so that the error, if it persists, is reported for the right partition.
+    auto& prefetched_reads = exec_context.prefetched_reads();
+    for (auto it = prefetched_reads.begin(); it != prefetched_reads.end(); ++it) {
+      if (!ql_env_->GetOpError(it->get()).ok() ||
+          (*it)->response().status() != QLResponsePB::YQL_STATUS_OK) {
+        prefetched_reads.erase(it, prefetched_reads.end());
+        break;
+      }
+    }
     ss = ProcessStatementStatus(*exec_context.parse_tree(), ss);
     if (PREDICT_FALSE(!ss.ok())) {
       s = ss;
@@ -928,6 +1281,7 @@ void Executor::Reset() {
   exec_contexts_.clear();
   exec_context_ = nullptr;
   result_ = nullptr;
+  index_ops_.clear();
   cb_.Reset();
 }
 
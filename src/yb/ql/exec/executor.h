@@ -18,11 +18,15 @@
 #ifndef YB_QL_EXEC_EXECUTOR_H_
 #define YB_QL_EXEC_EXECUTOR_H_
 
+#include <string>
+#include <unordered_set>
+
 #include "yb/common/partial_row.h"
 #include "yb/ql/exec/exec_context.h"
 #include "yb/ql/ptree/pt_create_keyspace.h"
 #include "yb/ql/ptree/pt_use_keyspace.h"
 #include "yb/ql/ptree/pt_create_table.h"
+#include "yb/ql/ptree/pt_create_index.h"
 #include "yb/ql/ptree/pt_alter_table.h"
 #include "yb/ql/ptree/pt_create_type.h"
 #include "yb/ql/ptree/pt_drop.h"
@@ -32,12 +36,32 @@
 #include "yb/ql/ptree/pt_update.h"
 #include "yb/ql/util/statement_params.h"
 #include "yb/ql/util/statement_result.h"
+#include "yb/util/monotime.h"
 
 namespace yb {
 namespace ql {
 
 class QLMetrics;
 
+// Time spent and work done by the statements of a request, for finding out where a slow request
+// spends its time.
+struct ExecutionStats {
+  // Time spent parsing and analyzing statements that are not prepared.
+  MonoDelta parse_time = MonoDelta::FromNanoseconds(0);
+  MonoDelta analyze_time = MonoDelta::FromNanoseconds(0);
+  // Time spent building the operations of the statements.
+  MonoDelta build_time = MonoDelta::FromNanoseconds(0);
+  // Time spent waiting for the operations to be flushed, i.e. batched by the client, sent to and
+  // executed by the tablet servers.
+  MonoDelta flush_time = MonoDelta::FromNanoseconds(0);
+  int num_flushes = 0;
+  int num_ops = 0;
+  // Tablets the operations were sent to.
+  std::unordered_set<std::string> tablet_ids;
+  // Rows the tablets read to answer the read operations.
+  uint64_t rows_scanned = 0;
+};
+
 class Executor {
  public:
   //------------------------------------------------------------------------------------------------
@@ -65,6 +89,10 @@ class Executor {
   // Invoke statement executed callback.
   void StatementExecuted(const Status& s);
 
+  // Statistics of the statements executed since they were last reset.
+  const ExecutionStats& stats() const { return stats_; }
+  ExecutionStats* mutable_stats() { return &stats_; }
+
  private:
   //------------------------------------------------------------------------------------------------
   // Currently, we don't yet have code generator into byte code, so the following ExecTNode()
@@ -128,9 +156,38 @@ class Executor {
   // Continue a multi-partition select (e.g. table scan or query with 'IN' condition on hash cols).
   CHECKED_STATUS FetchMoreRowsIfNeeded();
 
+  // Apply the writes to the secondary indexes returned in the responses of the executed writes.
+  // The writes of all statements are batched together and grouped by index tablet when flushed.
+  CHECKED_STATUS ApplyIndexWrites();
+
+  // Process the results of the writes to the secondary indexes.
+  CHECKED_STATUS ProcessIndexResults();
+
+  // Look up the index table with the given id among the indexes of the table.
+  std::shared_ptr<client::YBTable> GetIndexTable(const client::YBTable& table,
+                                                 const TableId& index_id);
+
+  // Convert the selected aggregate function calls to the partial aggregates that tablet servers
+  // compute for them.
+  CHECKED_STATUS AggregateCallsToPB(const PTSelectStmt *tnode, QLReadRequestPB *req);
+
+  // Combine the partial aggregates returned by tablet servers into the final aggregated row.
+  CHECKED_STATUS AggregateResultSets(const QLReadRequestPB& req);
+
+  // Read the partitions following the current one of a multi-partition select concurrently with
+  // the current read 'op', up to --ql_max_parallel_partition_reads partitions in total.
+  CHECKED_STATUS PrefetchPartitions(const PTSelectStmt *tnode,
+                                    const std::shared_ptr<client::YBqlReadOp>& op);
+
   // Reset execution state.
   void Reset();
 
+  // Flush the buffered operations asynchronously. Returns false if there is none to flush.
+  bool FlushAsync();
+
+  // Add the operation executed by a flush to the execution statistics.
+  void AddOpStats(const client::YBqlOp& op);
+
   //------------------------------------------------------------------------------------------------
   // Expression evaluation.
 
@@ -198,6 +255,9 @@ class Executor {
                                 const PTDmlStmt *tnode,
                                 QLWriteRequestPB *req);
 
+  // Set up the write request to maintain the secondary indexes of the table.
+  void IndexesToPB(const std::shared_ptr<client::YBTable>& table, QLWriteRequestPB *req);
+
   //------------------------------------------------------------------------------------------------
   // Where clause evaluation.
 
@@ -235,6 +295,9 @@ class Executor {
   // Execution result.
   ExecutedResult::SharedPtr result_;
 
+  // Writes to the secondary indexes of the tables written by the statements being executed.
+  std::vector<std::shared_ptr<client::YBqlWriteOp>> index_ops_;
+
   // Statement executed callback.
   StatementExecutedCallback cb_;
 
@@ -243,6 +306,10 @@ class Executor {
 
   // FlushAsync callback.
   Callback<void(const Status&)> flush_async_cb_;
+
+  // Execution statistics and the start time of the current flush.
+  ExecutionStats stats_;
+  MonoTime flush_begin_;
 };
 
 }  // namespace ql
@@ -3365,7 +3365,14 @@ func_application:
     PARSER_UNSUPPORTED(@1);
   }
   | func_name '(' '*' ')' {
-    PARSER_UNSUPPORTED(@1);
+    if (strcmp($1->c_str(), "count") != 0) {
+      PARSER_UNSUPPORTED(@1);
+    } else {
+      // COUNT(*) counts all rows, so it is the same as counting a constant that is never null.
+      PTConstBool::SharedPtr pt_constbool = MAKE_NODE(@3, PTConstBool, true);
+      PTExprListNode::SharedPtr args = MAKE_NODE(@3, PTExprListNode, pt_constbool);
+      $$ = MAKE_NODE(@1, PTBcall, $1, args);
+    }
   }
 ;
 
@@ -68,7 +68,7 @@ class ProcessContextBase {
   // Memory pool for allocating and deallocating operating memory spaces during a process.
   MemoryContext *PTempMem() const {
     if (ptemp_mem_ == nullptr) {
-      ptemp_mem_.reset(new Arena());
+      ptemp_mem_ = AcquirePooledArena();
     }
     return ptemp_mem_.get();
   }
@@ -105,8 +105,8 @@ class ProcessContextBase {
   // completed.
   //
   // For performance, the temp arena and the error message that depends on it are created only when
-  // needed.
-  mutable std::unique_ptr<Arena> ptemp_mem_;
+  // needed, and the arena is taken from the pool of the current thread.
+  mutable PooledArena ptemp_mem_;
 
   // Latest parsing or scanning error code.
   ErrorCode error_code_;
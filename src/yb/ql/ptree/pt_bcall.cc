@@ -227,6 +227,11 @@ CHECKED_STATUS PTBcall::Analyze(SemContext *sem_context) {
       // For variadic functions, accept all arguments without casting.
       break;
     }
+    if (formal_types[pindex] == DataType::NULL_VALUE_TYPE) {
+      // Arguments of any type are accepted as they are without casting.
+      pindex++;
+      continue;
+    }
 
     // Converting or casting arguments to expected type for the function call.
     // - If argument and formal datatypes are the same, no conversion is needed. It's a NOOP.
@@ -270,10 +275,35 @@ CHECKED_STATUS PTBcall::Analyze(SemContext *sem_context) {
     ql_type_ = pt_result->ql_type();
   }
 
+  // Aggregate functions declared to return any type (MIN and MAX) return the type of their
+  // argument.
+  if (IsAggregateCall() && ql_type_->main() == DataType::NULL_VALUE_TYPE) {
+    ql_type_ = exprs.front()->ql_type();
+  }
+
   internal_type_ = yb::client::YBColumnSchema::ToInternalDataType(ql_type_);
   return CheckExpectedTypeCompatibility(sem_context);
 }
 
+bool PTBcall::IsAggregateCall() const {
+  if (!is_server_operator_) {
+    return false;
+  }
+  switch (static_cast<TSOpcode>(bfopcode_)) {
+    case TSOpcode::kCount: FALLTHROUGH_INTENDED;
+    case TSOpcode::kSum: FALLTHROUGH_INTENDED;
+    case TSOpcode::kAvg: FALLTHROUGH_INTENDED;
+    case TSOpcode::kMin: FALLTHROUGH_INTENDED;
+    case TSOpcode::kMax:
+      return true;
+    case TSOpcode::kNoOp: FALLTHROUGH_INTENDED;
+    case TSOpcode::kWriteTime: FALLTHROUGH_INTENDED;
+    case TSOpcode::kTtl:
+      return false;
+  }
+  return false;
+}
+
 CHECKED_STATUS PTBcall::CheckOperator(SemContext *sem_context) {
   if (sem_context->processing_set_clause() &&
       sem_context->lhs_col() != nullptr &&
@@ -61,6 +61,9 @@ class PTBcall : public PTExpr {
     return bfopcode_;
   }
 
+  // Is this a call to an aggregate function (COUNT, SUM, AVG, MIN or MAX)?
+  bool IsAggregateCall() const;
+
   // Access API for cast opcodes.
   const MCVector<yb::bfql::BFOpcode>& cast_ops() const {
     return cast_ops_;
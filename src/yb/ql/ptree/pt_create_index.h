@@ -52,6 +52,9 @@ class PTCreateIndex : public PTCreateTable {
   const PTListNode::SharedPtr& covering() const {
     return covering_;
   }
+  const std::shared_ptr<client::YBTable>& indexed_table() const {
+    return table_;
+  }
 
   // Node semantics analysis.
   virtual CHECKED_STATUS Analyze(SemContext *sem_context) override;
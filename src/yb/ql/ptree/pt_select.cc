@@ -84,7 +84,8 @@ PTSelectStmt::PTSelectStmt(MemoryContext *memctx,
       group_by_clause_(group_by_clause),
       having_clause_(having_clause),
       order_by_clause_(order_by_clause),
-      limit_clause_(limit_clause) {
+      limit_clause_(limit_clause),
+      is_aggregate_(false) {
 }
 
 PTSelectStmt::~PTSelectStmt() {
@@ -115,6 +116,7 @@ CHECKED_STATUS PTSelectStmt::Analyze(SemContext *sem_context) {
   if (distinct_) {
     RETURN_NOT_OK(AnalyzeDistinctClause(sem_context));
   }
+  RETURN_NOT_OK(AnalyzeAggregates(sem_context));
 
   // Run error checking on the WHERE conditions.
   RETURN_NOT_OK(AnalyzeWhereClause(sem_context, where_clause_));
@@ -162,6 +164,41 @@ CHECKED_STATUS PTSelectStmt::AnalyzeDistinctClause(SemContext *sem_context) {
 
 //--------------------------------------------------------------------------------------------------
 
+const PTBcall* PTSelectStmt::AggregateCall(const PTExpr::SharedPtr& expr) {
+  const PTExpr *call = expr->expr_op() == ExprOperator::kAlias ? expr->op1().get() : expr.get();
+  if (call->expr_op() != ExprOperator::kBcall) {
+    return nullptr;
+  }
+  const PTBcall *bcall = static_cast<const PTBcall *>(call);
+  return bcall->IsAggregateCall() ? bcall : nullptr;
+}
+
+CHECKED_STATUS PTSelectStmt::AnalyzeAggregates(SemContext *sem_context) {
+  // Without GROUP BY, aggregate functions compute one row over all selected rows, so they cannot be
+  // selected together with values of individual rows.
+  size_t aggregate_count = 0;
+  for (const auto& expr : selected_exprs()) {
+    if (AggregateCall(expr) != nullptr) {
+      aggregate_count++;
+    }
+  }
+  if (aggregate_count == 0) {
+    return Status::OK();
+  }
+  if (aggregate_count != selected_exprs().size()) {
+    return sem_context->Error(selected_exprs_,
+                              "Aggregate functions cannot be selected with other expressions",
+                              ErrorCode::CQL_STATEMENT_INVALID);
+  }
+  if (distinct_) {
+    return sem_context->Error(selected_exprs_,
+                              "Aggregate functions cannot be selected with distinct",
+                              ErrorCode::CQL_STATEMENT_INVALID);
+  }
+  is_aggregate_ = true;
+  return Status::OK();
+}
+
 CHECKED_STATUS PTSelectStmt::AnalyzeLimitClause(SemContext *sem_context) {
   if (limit_clause_ == nullptr) {
     return Status::OK();
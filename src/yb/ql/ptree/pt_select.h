@@ -25,6 +25,7 @@
 #include "yb/ql/ptree/pt_name.h"
 #include "yb/ql/ptree/pt_expr.h"
 #include "yb/ql/ptree/pt_dml.h"
+#include "yb/ql/ptree/pt_bcall.h"
 
 namespace yb {
 namespace ql {
@@ -183,6 +184,7 @@ class PTSelectStmt : public PTDmlStmt {
   virtual CHECKED_STATUS Analyze(SemContext *sem_context) override;
   CHECKED_STATUS AnalyzeDistinctClause(SemContext *sem_context);
   CHECKED_STATUS AnalyzeLimitClause(SemContext *sem_context);
+  CHECKED_STATUS AnalyzeAggregates(SemContext *sem_context);
   CHECKED_STATUS ConstructSelectedSchema();
   void PrintSemanticAnalysisResult(SemContext *sem_context);
 
@@ -203,6 +205,14 @@ class PTSelectStmt : public PTDmlStmt {
     return distinct_;
   }
 
+  // Are all selected expressions aggregate function calls?
+  bool is_aggregate() const {
+    return is_aggregate_;
+  }
+
+  // Returns the aggregate function call of a selected expression, or null if it is not one.
+  static const PTBcall* AggregateCall(const PTExpr::SharedPtr& expr);
+
   bool has_limit() const {
     return limit_clause_ != nullptr;
   }
@@ -246,6 +256,9 @@ class PTSelectStmt : public PTDmlStmt {
   PTListNode::SharedPtr having_clause_;
   PTListNode::SharedPtr order_by_clause_;
   PTExpr::SharedPtr limit_clause_;
+
+  // Set during analysis when all selected expressions are aggregate function calls.
+  bool is_aggregate_;
 };
 
 }  // namespace ql
@@ -19,6 +19,14 @@
 
 #include "yb/ql/statement.h"
 
+#include "yb/util/flag_tags.h"
+
+DEFINE_int32(ql_parse_tree_cache_size, 64,
+             "Maximum number of analyzed parse trees of unprepared DML statements that each QL "
+             "processor caches to skip parsing and analyzing the same statement again. "
+             "0 disables the cache.");
+TAG_FLAG(ql_parse_tree_cache_size, advanced);
+
 METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_SQLProcessor_ParseRequest,
     "Time spent parsing the SQL query", yb::MetricUnit::kMicroseconds,
@@ -124,8 +132,9 @@ Status QLProcessor::Parse(const string& ql_stmt, ParseTree::UniPtr* parse_tree,
   const MonoTime begin_time = MonoTime::Now(MonoTime::FINE);
   RETURN_NOT_OK(parser_.Parse(ql_stmt, reparsed, mem_tracker));
   const MonoTime end_time = MonoTime::Now(MonoTime::FINE);
+  const MonoDelta elapsed_time = end_time.GetDeltaSince(begin_time);
+  executor_.mutable_stats()->parse_time += elapsed_time;
   if (ql_metrics_ != nullptr) {
-    const MonoDelta elapsed_time = end_time.GetDeltaSince(begin_time);
     ql_metrics_->time_to_parse_ql_query_->Increment(elapsed_time.ToMicroseconds());
   }
   *parse_tree = parser_.Done();
@@ -138,8 +147,9 @@ Status QLProcessor::Analyze(const string& ql_stmt, ParseTree::UniPtr* parse_tree
   const MonoTime begin_time = MonoTime::Now(MonoTime::FINE);
   const Status s = analyzer_.Analyze(ql_stmt, std::move(*parse_tree));
   const MonoTime end_time = MonoTime::Now(MonoTime::FINE);
+  const MonoDelta elapsed_time = end_time.GetDeltaSince(begin_time);
+  executor_.mutable_stats()->analyze_time += elapsed_time;
   if (ql_metrics_ != nullptr) {
-    const MonoDelta elapsed_time = end_time.GetDeltaSince(begin_time);
     ql_metrics_->time_to_analyze_ql_query_->Increment(elapsed_time.ToMicroseconds());
     ql_metrics_->num_rounds_to_analyze_ql_->Increment(1);
   }
@@ -167,28 +177,88 @@ void QLProcessor::ExecuteAsync(const string& ql_stmt, const ParseTree& parse_tre
 
 void QLProcessor::RunAsync(const string& ql_stmt, const StatementParameters& params,
                             StatementExecutedCallback cb, const bool reparsed) {
-  ParseTree::UniPtr parse_tree;
-  const Status s = Prepare(ql_stmt, &parse_tree, reparsed);
-  if (PREDICT_FALSE(!s.ok())) {
-    return cb.Run(s, nullptr /* result */);
+  // The statement is analyzed against the current keyspace so it is part of the cache key. A
+  // reparse is requested only after a cached parse tree has turned stale, so bypass the cache.
+  const string cache_key = ql_env_.CurrentKeyspace() + '\0' + ql_stmt;
+  shared_ptr<const ParseTree> parse_tree = reparsed ? nullptr : LookupParseTree(cache_key);
+  if (parse_tree == nullptr) {
+    ParseTree::UniPtr new_parse_tree;
+    const Status s = Prepare(ql_stmt, &new_parse_tree, reparsed);
+    if (PREDICT_FALSE(!s.ok())) {
+      return cb.Run(s, nullptr /* result */);
+    }
+    parse_tree = std::move(new_parse_tree);
+    CacheParseTree(cache_key, parse_tree);
   }
-  const ParseTree* ptree = parse_tree.release();
-  ExecuteAsync(ql_stmt, *ptree, params,
+  ExecuteAsync(ql_stmt, *parse_tree, params,
                Bind(&QLProcessor::RunAsyncDone, Unretained(this), ql_stmt, Unretained(&params),
-                    Owned(ptree), cb));
+                    parse_tree, cb));
 }
 
 // RunAsync callback added to keep the parse tree in-scope while it is being run asynchronously.
 // When called, just forward the status and result to the actual callback cb.
 void QLProcessor::RunAsyncDone(const string& ql_stmt, const StatementParameters* params,
-                                const ParseTree *parse_tree, StatementExecutedCallback cb,
-                                const Status& s, const ExecutedResult::SharedPtr& result) {
+                                shared_ptr<const ParseTree> parse_tree,
+                                StatementExecutedCallback cb, const Status& s,
+                                const ExecutedResult::SharedPtr& result) {
   if (s.IsQLError() && GetErrorCode(s) == ErrorCode::STALE_METADATA && !parse_tree->reparsed()) {
     return RunAsync(ql_stmt, *params, cb, true /* reparsed */);
   }
   cb.Run(s, result);
 }
 
+shared_ptr<const ParseTree> QLProcessor::LookupParseTree(const string& key) {
+  const auto itr = parse_tree_map_.find(key);
+  if (itr == parse_tree_map_.end()) {
+    return nullptr;
+  }
+  const ParseTreeList::iterator entry = itr->second;
+  if (entry->second->stale()) {
+    parse_tree_list_.erase(entry);
+    parse_tree_map_.erase(itr);
+    return nullptr;
+  }
+  parse_tree_list_.splice(parse_tree_list_.begin(), parse_tree_list_, entry);
+
+  // Like a prepared statement, a cached parse tree may be reparsed again if it turns stale.
+  entry->second->clear_reparsed();
+  return entry->second;
+}
+
+void QLProcessor::CacheParseTree(const string& key, shared_ptr<const ParseTree> parse_tree) {
+  const TreeNode::SharedPtr& root = parse_tree->root();
+  if (root == nullptr) {
+    return;
+  }
+  switch (root->opcode()) {
+    case TreeNodeOpcode::kPTSelectStmt: FALLTHROUGH_INTENDED;
+    case TreeNodeOpcode::kPTInsertStmt: FALLTHROUGH_INTENDED;
+    case TreeNodeOpcode::kPTUpdateStmt: FALLTHROUGH_INTENDED;
+    case TreeNodeOpcode::kPTDeleteStmt:
+      break;
+    default:
+      parse_tree_list_.clear();
+      parse_tree_map_.clear();
+      return;
+  }
+  if (FLAGS_ql_parse_tree_cache_size <= 0) {
+    return;
+  }
+
+  const auto itr = parse_tree_map_.find(key);
+  if (itr != parse_tree_map_.end()) {
+    itr->second->second = std::move(parse_tree);
+    parse_tree_list_.splice(parse_tree_list_.begin(), parse_tree_list_, itr->second);
+    return;
+  }
+  parse_tree_list_.emplace_front(key, std::move(parse_tree));
+  parse_tree_map_.emplace(key, parse_tree_list_.begin());
+  while (parse_tree_list_.size() > static_cast<size_t>(FLAGS_ql_parse_tree_cache_size)) {
+    parse_tree_map_.erase(parse_tree_list_.back().first);
+    parse_tree_list_.pop_back();
+  }
+}
+
 void QLProcessor::BeginBatch(StatementExecutedCallback cb) {
   executor_.BeginBatch(std::move(cb));
 }
@@ -19,6 +19,9 @@
 #ifndef YB_QL_QL_PROCESSOR_H_
 #define YB_QL_QL_PROCESSOR_H_
 
+#include <list>
+#include <unordered_map>
+
 #include "yb/client/callbacks.h"
 
 #include "yb/cqlserver/cql_rpcserver_env.h"
@@ -86,6 +89,10 @@ class QLProcessor {
   void ApplyBatch();
   void AbortBatch();
 
+  // Statistics of the statements processed since they were last reset.
+  const ExecutionStats& execution_stats() const { return executor_.stats(); }
+  void ResetExecutionStats() { *executor_.mutable_stats() = ExecutionStats(); }
+
  protected:
   void SetCurrentCall(rpc::InboundCallPtr call);
   //------------------------------------------------------------------------------------------------
@@ -115,8 +122,22 @@ class QLProcessor {
   CHECKED_STATUS Analyze(const string& ql_stmt, ParseTree::UniPtr* parse_tree);
 
   void RunAsyncDone(const std::string& ql_stmt, const StatementParameters* params,
-                    const ParseTree *parse_tree, StatementExecutedCallback cb,
+                    std::shared_ptr<const ParseTree> parse_tree, StatementExecutedCallback cb,
                     const Status& s, const ExecutedResult::SharedPtr& result);
+
+  // Look up the analyzed parse tree of an unprepared statement in the parse tree cache. Returns
+  // nullptr if it is not cached or has become stale.
+  std::shared_ptr<const ParseTree> LookupParseTree(const std::string& key);
+
+  // Add the analyzed parse tree of an unprepared statement to the parse tree cache. Only DML
+  // statements are cached. Other statements may change the schema so they clear the cache.
+  void CacheParseTree(const std::string& key, std::shared_ptr<const ParseTree> parse_tree);
+
+  // Cache of analyzed parse trees of unprepared statements, keyed by the current keyspace and the
+  // statement text. The list is in LRU order with the most recently used tree at the front.
+  typedef std::list<std::pair<std::string, std::shared_ptr<const ParseTree>>> ParseTreeList;
+  ParseTreeList parse_tree_list_;
+  std::unordered_map<std::string, ParseTreeList::iterator> parse_tree_map_;
 };
 
 }  // namespace ql
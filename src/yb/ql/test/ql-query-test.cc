@@ -25,6 +25,8 @@ using std::unique_ptr;
 using std::shared_ptr;
 using strings::Substitute;
 
+DECLARE_int32(ql_max_parallel_partition_reads);
+
 namespace yb {
 namespace ql {
 
@@ -442,6 +444,26 @@ TEST_F(TestQLQuery, TestPagingState) {
     VerifyPaginationSelect(processor, select_stmt, 3,
         "{ { int32:1, int32:99, int32:199 }, { int32:1, int32:100, int32:200 } }");
   }
+
+  // Repeat the queries with IN condition on hash key reading all partitions concurrently and then
+  // one partition at a time. Verify the same rows are read in the same pages.
+  for (int parallel_reads : {5, 1}) {
+    google::FlagSaver flag_saver;
+    FLAGS_ql_max_parallel_partition_reads = parallel_reads;
+
+    string select_stmt = "SELECT h, r, v FROM t WHERE h IN (1, 12, 23, 34, 45) AND r > 98;";
+    VerifyPaginationSelect(processor, select_stmt, 2,
+        "{ { int32:1, int32:99, int32:199 }, { int32:1, int32:100, int32:200 } }"
+        "{ { int32:1, int32:101, int32:201 }, { int32:12, int32:112, int32:212 } }"
+        "{ { int32:23, int32:123, int32:223 }, { int32:34, int32:134, int32:234 } }"
+        "{ { int32:45, int32:145, int32:245 } }");
+
+    select_stmt = "SELECT h, r, v FROM t WHERE h IN (1, 12, 23, 34, 45) AND r > 98 LIMIT 5;";
+    VerifyPaginationSelect(processor, select_stmt, 2,
+        "{ { int32:1, int32:99, int32:199 }, { int32:1, int32:100, int32:200 } }"
+            "{ { int32:1, int32:101, int32:201 }, { int32:12, int32:112, int32:212 } }"
+            "{ { int32:23, int32:123, int32:223 } }");
+  }
 }
 
 #define RUN_PAGINATION_WITH_DESC_TEST(processor, type, values, rows)                               \
@@ -1155,6 +1177,61 @@ TEST_F(TestQLQuery, TestPagination) {
   EXPECT_EQ(55, sum);
 }
 
+TEST_F(TestQLQuery, TestAggregateFunctions) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  // Create test table and insert 10 hash keys with 4 rows each. They should go to different
+  // tablets.
+  CHECK_OK(processor->Run("CREATE TABLE aggr_test (h int, r int, v int, d double, "
+                          "PRIMARY KEY ((h), r));"));
+  for (int h = 1; h <= 10; h++) {
+    for (int r = 1; r <= 4; r++) {
+      CHECK_OK(processor->Run(Substitute(
+          "INSERT INTO aggr_test (h, r, v, d) VALUES ($0, $1, $2, $3);", h, r, h * r, h * r)));
+    }
+  }
+
+  // Use a small page size so that the partial aggregates of several pages are combined.
+  StatementParameters params;
+  params.set_page_size(3);
+
+  // Full-table aggregates.
+  CHECK_OK(processor->Run(
+      "SELECT count(*), count(v), sum(v), min(v), max(v), avg(v), avg(d) FROM aggr_test;", params));
+  auto row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  const QLRow& row = row_block->row(0);
+  EXPECT_EQ(40, row.column(0).int64_value());
+  EXPECT_EQ(40, row.column(1).int64_value());
+  EXPECT_EQ(550, row.column(2).int32_value());
+  EXPECT_EQ(1, row.column(3).int32_value());
+  EXPECT_EQ(40, row.column(4).int32_value());
+  EXPECT_EQ(13, row.column(5).int32_value());
+  EXPECT_DOUBLE_EQ(13.75, row.column(6).double_value());
+
+  // Aggregates over a multi-partition select.
+  CHECK_OK(processor->Run("SELECT count(*), sum(v) FROM aggr_test WHERE h IN (1, 2, 3);", params));
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(12, row_block->row(0).column(0).int64_value());
+  EXPECT_EQ(60, row_block->row(0).column(1).int32_value());
+
+  // Aggregates over no rows.
+  CHECK_VALID_STMT("SELECT count(*), sum(v), max(v) FROM aggr_test WHERE h = 11;");
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(0, row_block->row(0).column(0).int64_value());
+  EXPECT_EQ(0, row_block->row(0).column(1).int32_value());
+  EXPECT_TRUE(row_block->row(0).column(2).IsNull());
+
+  // Aggregates cannot be mixed with other selected expressions.
+  CHECK_INVALID_STMT("SELECT h, count(*) FROM aggr_test;");
+}
+
 TEST_F(TestQLQuery, TestTokenBcall) {
   //------------------------------------------------------------------------------------------------
   // Setting up cluster
@@ -1218,6 +1295,27 @@ TEST_F(TestQLQuery, TestTokenBcall) {
   ASSERT_EQ(1, row_block->row_count());
 }
 
+TEST_F(TestQLQuery, TestTokenSplit) {
+  // The node tokens in system.local and system.peers must split the token ring the same way the
+  // hash space is split among tablets: the last token of each node maps to the last hash code of
+  // its range and the next token maps to the first hash code of the next range.
+  for (size_t node_count : {1, 3, 5, 16}) {
+    const uint16_t interval = YBPartition::kMaxHashCode / node_count;
+    int64_t prev_token = std::numeric_limits<int64_t>::min();
+    for (size_t index = 0; index < node_count; index++) {
+      const int64_t token = std::stoll(YBPartition::CqlTokenSplit(node_count, index));
+      ASSERT_GT(token, prev_token);
+      if (index + 1 < node_count) {
+        ASSERT_EQ(YBPartition::CqlToYBHashCode(token), (index + 1) * interval - 1);
+        ASSERT_EQ(YBPartition::CqlToYBHashCode(token + 1), (index + 1) * interval);
+      } else {
+        ASSERT_EQ(token, std::numeric_limits<int64_t>::max());
+      }
+      prev_token = token;
+    }
+  }
+}
+
 TEST_F(TestQLQuery, TestScanWithBounds) {
   //------------------------------------------------------------------------------------------------
   // Setting up cluster
@@ -75,6 +75,92 @@ TEST_F(TestQLStatement, TestExecutePrepareAfterTableDrop) {
   LOG(INFO) << "Done.";
 }
 
+TEST_F(TestQLStatement, TestCachedUnpreparedStatement) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get two processors. Statements run in the first one are cached in its parse tree cache while
+  // the table is recreated by the second one.
+  TestQLProcessor *processor = GetQLProcessor();
+  TestQLProcessor *processor2 = GetQLProcessor();
+
+  LOG(INFO) << "Running cached unprepared statement test.";
+
+  // Create test table.
+  EXEC_VALID_STMT("create table t (h1 int primary key, c int);");
+  EXEC_VALID_STMT("insert into t (h1, c) values (1, 2);");
+
+  // Run the same select twice. The second run reuses the cached parse tree.
+  for (int i = 0; i < 2; i++) {
+    CHECK_VALID_STMT("select * from t where h1 = 1;");
+    std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+    CHECK_EQ(row_block->row_count(), 1);
+    CHECK_EQ(row_block->row(0).column(1).int32_value(), 2);
+  }
+
+  // Recreate the table with a different schema from the other processor.
+  CHECK_OK(processor2->Run("drop table t;"));
+  CHECK_OK(processor2->Run("create table t (h1 int primary key, c text);"));
+  CHECK_OK(processor2->Run("insert into t (h1, c) values (1, 'a');"));
+
+  // The cached parse tree is stale now. The select should be reparsed and return the new row.
+  CHECK_VALID_STMT("select * from t where h1 = 1;");
+  std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 1);
+  CHECK_EQ(row_block->row(0).column(1).string_value(), "a");
+
+  LOG(INFO) << "Done.";
+}
+
+TEST_F(TestQLStatement, TestSecondaryIndex) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  LOG(INFO) << "Running secondary index test.";
+
+  // Create test table and index. The index table has columns c, h and v.
+  EXEC_VALID_STMT("create table t (h int primary key, c int, v text);");
+  EXEC_VALID_STMT("create index i on t (c) covering (v);");
+
+  // Inserting a row adds its index entry.
+  EXEC_VALID_STMT("insert into t (h, c, v) values (1, 10, 'a');");
+  CHECK_VALID_STMT("select * from i where c = 10;");
+  std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 1);
+  CHECK_EQ(row_block->row(0).column(1).int32_value(), 1);
+  CHECK_EQ(row_block->row(0).column(2).string_value(), "a");
+
+  // Updating the indexed column moves the index entry.
+  EXEC_VALID_STMT("update t set c = 20 where h = 1;");
+  CHECK_VALID_STMT("select * from i where c = 10;");
+  CHECK_EQ(processor->row_block()->row_count(), 0);
+  CHECK_VALID_STMT("select * from i where c = 20;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 1);
+  CHECK_EQ(row_block->row(0).column(2).string_value(), "a");
+
+  // Updating a covering column updates the index entry in place.
+  EXEC_VALID_STMT("update t set v = 'b' where h = 1;");
+  CHECK_VALID_STMT("select * from i where c = 20;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 1);
+  CHECK_EQ(row_block->row(0).column(2).string_value(), "b");
+
+  // Deleting the row removes its index entry.
+  EXEC_VALID_STMT("delete from t where h = 1;");
+  CHECK_VALID_STMT("select * from i where c = 20;");
+  CHECK_EQ(processor->row_block()->row_count(), 0);
+
+  // Dropping the table drops its index.
+  EXEC_VALID_STMT("drop table t;");
+  EXEC_INVALID_STMT("select * from i where c = 20;");
+
+  LOG(INFO) << "Done.";
+}
+
 TEST_F(TestQLStatement, TestPKIndices) {
   // Init the simulated cluster.
   ASSERT_NO_FATALS(CreateSimulatedCluster());
@@ -166,7 +166,7 @@ RowsResult::~RowsResult() {
 Status RowsResult::Append(const RowsResult& other) {
   if (rows_data_.empty()) {
     rows_data_ = other.rows_data_;
-  } else {
+  } else if (!other.rows_data_.empty()) {
     RETURN_NOT_OK(QLRowBlock::AppendRowsData(other.client_, other.rows_data_, &rows_data_));
   }
   paging_state_ = other.paging_state_;
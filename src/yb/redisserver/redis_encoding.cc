@@ -15,10 +15,13 @@
 
 #include "yb/redisserver/redis_encoding.h"
 
+#include <vector>
+
 #include <google/protobuf/repeated_field.h>
 
 #include "yb/gutil/casts.h"
 #include "yb/gutil/strings/numbers.h"
+#include "yb/gutil/strings/strcat.h"
 
 #include "yb/util/logging.h"
 #include "yb/util/ref_cnt_buffer.h"
@@ -30,6 +33,8 @@ namespace redisserver {
 
 const std::string kNilResponse = "$-1\r\n";
 const std::string kOkResponse = "+OK\r\n";
+const std::string kScanResponseHeader = "*2\r\n";
+const std::string kQueuedResponse = "+QUEUED\r\n";
 const std::string kInfoResponse =
     "# Replication\r\n"
     "role:master\r\n"
@@ -148,9 +153,36 @@ Out ProcessInteger(const std::string& input, Out out) {
   return DoCat(out, ':', input, kNewLine);
 }
 
+// Integers in [kMinSharedInteger, kMaxSharedInteger] have precomputed encodings.
+constexpr int64_t kMinSharedInteger = -2;
+constexpr int64_t kMaxSharedInteger = 1023;
+
+const std::vector<std::string>& SharedIntegerEncodings() {
+  static const std::vector<std::string>* result = [] {
+    auto* encodings = new std::vector<std::string>();
+    for (int64_t i = kMinSharedInteger; i <= kMaxSharedInteger; ++i) {
+      encodings->push_back(StrCat(":", i, "\r\n"));
+    }
+    return encodings;
+  }();
+  return *result;
+}
+
 template <class Out>
 Out ProcessInteger(int64_t input, Out out) {
-  return DoCat(out, ':', input, kNewLine);
+  if (input >= kMinSharedInteger && input <= kMaxSharedInteger) {
+    return CatOne(SharedIntegerEncodings()[input - kMinSharedInteger], out);
+  }
+  if (input < 0) {
+    // Negate in unsigned arithmetic, so the minimal int64_t is also handled.
+    return DoCat(out, ':', '-', -static_cast<uint64_t>(input), kNewLine);
+  }
+  return DoCat(out, ':', static_cast<size_t>(input), kNewLine);
+}
+
+template <class Out>
+Out ProcessArrayHeader(size_t size, Out out) {
+  return DoCat(out, '*', size, kNewLine);
 }
 
 template <class Out>
@@ -174,8 +206,41 @@ Out ProcessEncoded(const std::string& input, Out out) {
   return DoCat(out, input);
 }
 
+const RefCntBuffer* MakeSharedResponse(const std::string& encoded) {
+  return new RefCntBuffer(encoded);
+}
+
 } // namespace
 
+const RefCntBuffer& SharedOkResponse() {
+  static const RefCntBuffer* result = MakeSharedResponse(kOkResponse);
+  return *result;
+}
+
+const RefCntBuffer& SharedNilResponse() {
+  static const RefCntBuffer* result = MakeSharedResponse(kNilResponse);
+  return *result;
+}
+
+const RefCntBuffer& SharedQueuedResponse() {
+  static const RefCntBuffer* result = MakeSharedResponse(kQueuedResponse);
+  return *result;
+}
+
+const RefCntBuffer* SharedIntegerResponse(int64_t value) {
+  static const std::vector<RefCntBuffer>* result = [] {
+    auto* buffers = new std::vector<RefCntBuffer>();
+    for (const auto& encoded : SharedIntegerEncodings()) {
+      buffers->emplace_back(encoded);
+    }
+    return buffers;
+  }();
+  if (value < kMinSharedInteger || value > kMaxSharedInteger) {
+    return nullptr;
+  }
+  return &(*result)[value - kMinSharedInteger];
+}
+
 #define DO_REDIS_PRIMITIVES_DEFINE(name, type) \
   RefCntBuffer BOOST_PP_CAT(EncodeAs, name)(type input) { \
     static constexpr size_t kZero = 0; \
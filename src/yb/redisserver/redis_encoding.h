@@ -32,6 +32,18 @@ namespace redisserver {
 extern const std::string kNilResponse;
 extern const std::string kOkResponse;
 extern const std::string kInfoResponse;
+// Response to commands that are queued by MULTI.
+extern const std::string kQueuedResponse;
+// Header of HSCAN/SSCAN responses, that are arrays of the cursor and the array of entries.
+extern const std::string kScanResponseHeader;
+
+// Encodings of the most common replies, built once and shared by all calls. Copying RefCntBuffer
+// only increments its reference counter, so responding with them does not allocate memory.
+const RefCntBuffer& SharedOkResponse();
+const RefCntBuffer& SharedNilResponse();
+const RefCntBuffer& SharedQueuedResponse();
+// Returns null when there is no shared encoding of the integer, i.e. it is not small enough.
+const RefCntBuffer* SharedIntegerResponse(int64_t value);
 
 // Integer:
 // Encode the given input string as a integer string (eg "123"). Integer(s) are formatted as
@@ -53,6 +65,10 @@ extern const std::string kInfoResponse;
 // $<length>\r\n<string data>\r\n
 // For more info: http://redis.io/topics/protocol
 
+// ArrayHeader:
+// Encode the header of array with the given number of elements, i.e. *<num-elements>\r\n, the
+// elements are encoded separately.
+
 // Array:
 // Encode the vector of encoded elementes into a multi-bulk-array. Bulk array(s) are formatted as
 // *<num-elements>\r\n<encoded data terminating in \r\n> ... <encoded data terminating in \r\n>
@@ -66,6 +82,7 @@ extern const std::string kInfoResponse;
   ((Error, const std::string&)) \
   ((Array, const google::protobuf::RepeatedPtrField<std::string>&)) \
   ((Array, const std::initializer_list<std::string>&)) \
+  ((ArrayHeader, size_t)) \
   ((Encoded, const std::string&)) \
   ((EncodedArray, const google::protobuf::RepeatedPtrField<std::string>&)) \
   /**/
@@ -11,6 +11,9 @@
 // under the License.
 //
 
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -23,6 +26,8 @@
 
 #include "yb/common/redis_protocol.pb.h"
 
+#include "yb/gutil/strings/ascii_ctype.h"
+#include "yb/gutil/strings/escaping.h"
 #include "yb/gutil/strings/substitute.h"
 
 #include "yb/redisserver/redis_constants.h"
@@ -46,6 +51,9 @@ namespace {
 
 constexpr size_t kMaxNumberOfArgs = 1 << 20;
 constexpr size_t kLineEndLength = 2;
+// Numbers in bulk headers are limited by kMaxBufferSize, so longer lines are malformed. It also
+// guarantees that parsed value does not overflow.
+constexpr ptrdiff_t kMaxNumberLength = 18;
 constexpr char kPositiveInfinity[] = "+inf";
 constexpr char kNegativeInfinity[] = "-inf";
 
@@ -75,6 +83,15 @@ Result<int64_t> ParseInt64(const Slice& slice, const char* field) {
   return *result;
 }
 
+Result<double> ParseScore(const Slice& slice) {
+  auto result = util::CheckedStold(slice);
+  if (!result.ok() || std::isnan(*result)) {
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "Score $0 is not a valid float", slice.ToDebugString());
+  }
+  return static_cast<double>(*result);
+}
+
 Result<int32_t> ParseInt32(const Slice& slice, const char* field) {
   auto val = ParseInt64(slice, field);
   if (!val.ok()) {
@@ -256,11 +273,102 @@ CHECKED_STATUS ParseSAdd(YBRedisWriteOp *op, const RedisClientCommand& args) {
   return ParseCollection(op, args, REDIS_TYPE_SET, add_string_subkey);
 }
 
+// ZADD <KEY> [NX|XX] [CH] <SCORE> <MEMBER> [<SCORE> <MEMBER>]*
+CHECKED_STATUS ParseZAdd(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  auto* add_request = op->mutable_request()->mutable_add_request();
+  size_t idx = 2;
+  for (; idx < args.size(); ++idx) {
+    const auto option = to_lower_case(args[idx]);
+    if (option == "nx") {
+      add_request->set_mode(REDIS_WRITEMODE_INSERT);
+    } else if (option == "xx") {
+      add_request->set_mode(REDIS_WRITEMODE_UPDATE);
+    } else if (option == "ch") {
+      add_request->set_ch(true);
+    } else if (option == "incr") {
+      return STATUS(InvalidCommand, "ZADD INCR is not yet supported");
+    } else {
+      break;
+    }
+  }
+  if (idx == args.size() || (args.size() - idx) % 2 != 0) {
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "wrong number of arguments: $0 for command: zadd", args.size());
+  }
+
+  auto* kv = op->mutable_request()->mutable_key_value();
+  kv->set_key(args[1].cdata(), args[1].size());
+  kv->set_type(REDIS_TYPE_SORTEDSET);
+  // We remove duplicates of members here, the last score of a member wins.
+  std::map<string, double> member_scores;
+  for (; idx < args.size(); idx += 2) {
+    auto score = ParseScore(args[idx]);
+    RETURN_NOT_OK(score);
+    member_scores[args[idx + 1].ToBuffer()] = *score;
+  }
+  for (const auto& member_score : member_scores) {
+    kv->add_subkey()->set_double_subkey(member_score.second);
+    kv->add_value(member_score.first);
+  }
+  return Status::OK();
+}
+
 CHECKED_STATUS ParseSRem(YBRedisWriteOp *op, const RedisClientCommand& args) {
   op->mutable_request()->set_allocated_del_request(new RedisDelRequestPB());
   return ParseCollection(op, args, REDIS_TYPE_SET, add_string_subkey);
 }
 
+// Used for LPUSH/RPUSH/LPUSHX/RPUSHX.
+// CMD <KEY> <VALUE> [<VALUE>]*
+CHECKED_STATUS ParsePushLikeCommands(YBRedisWriteOp *op, const RedisClientCommand& args,
+                                     RedisSide side, bool assume_exists) {
+  auto* push_request = op->mutable_request()->mutable_push_request();
+  push_request->set_side(side);
+  push_request->set_assume_exists(assume_exists);
+  auto* kv = op->mutable_request()->mutable_key_value();
+  kv->set_key(args[1].cdata(), args[1].size());
+  kv->set_type(REDIS_TYPE_LIST);
+  for (size_t i = 2; i < args.size(); i++) {
+    kv->add_value(args[i].cdata(), args[i].size());
+  }
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseLPush(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_LEFT, /* assume_exists */ false);
+}
+
+CHECKED_STATUS ParseRPush(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_RIGHT, /* assume_exists */ false);
+}
+
+CHECKED_STATUS ParseLPushX(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_LEFT, /* assume_exists */ true);
+}
+
+CHECKED_STATUS ParseRPushX(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_RIGHT, /* assume_exists */ true);
+}
+
+// Used for LPOP/RPOP.
+// CMD <KEY>
+CHECKED_STATUS ParsePopLikeCommands(YBRedisWriteOp *op, const RedisClientCommand& args,
+                                    RedisSide side) {
+  op->mutable_request()->mutable_pop_request()->set_side(side);
+  auto* kv = op->mutable_request()->mutable_key_value();
+  kv->set_key(args[1].cdata(), args[1].size());
+  kv->set_type(REDIS_TYPE_LIST);
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseLPop(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePopLikeCommands(op, args, REDIS_SIDE_LEFT);
+}
+
+CHECKED_STATUS ParseRPop(YBRedisWriteOp *op, const RedisClientCommand& args) {
+  return ParsePopLikeCommands(op, args, REDIS_SIDE_RIGHT);
+}
+
 CHECKED_STATUS ParseGetSet(YBRedisWriteOp *op, const RedisClientCommand& args) {
   const auto& key = args[1];
   const auto& value = args[2];
@@ -343,41 +451,54 @@ CHECKED_STATUS ParseHGet(YBRedisReadOp* op, const RedisClientCommand& args) {
   return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_HGET);
 }
 
-CHECKED_STATUS ParseTsBoundArg(const Slice& slice, RedisSubKeyBoundPB* bound_pb, bool exclusive) {
-  string bound(slice.cdata(), slice.size());
+CHECKED_STATUS ParseTsBoundArg(const Slice& slice, RedisSubKeyBoundPB* bound_pb) {
+  auto ts_bound = util::CheckedStoll(slice);
+  RETURN_NOT_OK(ts_bound);
+  bound_pb->mutable_subkey_bound()->set_timestamp_subkey(*ts_bound);
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseScoreBoundArg(const Slice& slice, RedisSubKeyBoundPB* bound_pb) {
+  auto score_bound = ParseScore(slice);
+  RETURN_NOT_OK(score_bound);
+  bound_pb->mutable_subkey_bound()->set_double_subkey(*score_bound);
+  return Status::OK();
+}
+
+// Parses range bound in form [(]value|[(]+inf|[(]-inf, where '(' denotes exclusive bound.
+template <typename ParseBoundArg>
+CHECKED_STATUS ParseSubKeyBound(const Slice& slice, RedisSubKeyBoundPB* bound_pb,
+                                ParseBoundArg parse_bound_arg) {
+  if (slice.empty()) {
+    return STATUS(InvalidArgument, "range bound key cannot be empty");
+  }
+
+  auto bound = slice;
+  const bool exclusive = bound[0] == '(' && bound.size() > 1;
+  if (exclusive) {
+    bound.remove_prefix(1);
+  }
   if (bound == kPositiveInfinity) {
     bound_pb->set_infinity_type(RedisSubKeyBoundPB_InfinityType_POSITIVE);
   } else if (bound == kNegativeInfinity) {
     bound_pb->set_infinity_type(RedisSubKeyBoundPB_InfinityType_NEGATIVE);
   } else {
-    auto ts_bound = util::CheckedStoll(slice);
-    RETURN_NOT_OK(ts_bound);
+    RETURN_NOT_OK(parse_bound_arg(bound, bound_pb));
     bound_pb->set_is_exclusive(exclusive);
-    bound_pb->mutable_subkey_bound()->set_timestamp_subkey(*ts_bound);
   }
   return Status::OK();
 }
 
 CHECKED_STATUS ParseTsSubKeyBound(const Slice& slice, RedisSubKeyBoundPB* bound_pb) {
-  if (slice.empty()) {
-    return STATUS(InvalidArgument, "range bound key cannot be empty");
-  }
-
-  if (slice[0] == '(' && slice.size() > 1) {
-    auto slice_copy = slice;
-    slice_copy.remove_prefix(1);
-    RETURN_NOT_OK(ParseTsBoundArg(slice_copy, bound_pb, /* exclusive */ true));
-  } else {
-    RETURN_NOT_OK(ParseTsBoundArg(slice, bound_pb, /* exclusive */ false));
-  }
-  return Status::OK();
+  return ParseSubKeyBound(slice, bound_pb, ParseTsBoundArg);
 }
 
-CHECKED_STATUS ParseTsRangeByTime(YBRedisReadOp* op, const RedisClientCommand& args) {
+CHECKED_STATUS ParseTsRangeByTimeLikeCommands(
+    YBRedisReadOp* op, const RedisClientCommand& args,
+    RedisCollectionGetRangeRequestPB_GetRangeRequestType request_type) {
   op->mutable_request()->set_allocated_get_collection_range_request(
       new RedisCollectionGetRangeRequestPB());
-  op->mutable_request()->mutable_get_collection_range_request()->set_request_type(
-      RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSRANGEBYTIME);
+  op->mutable_request()->mutable_get_collection_range_request()->set_request_type(request_type);
 
   const auto& key = args[1];
   RETURN_NOT_OK(ParseTsSubKeyBound(
@@ -391,6 +512,169 @@ CHECKED_STATUS ParseTsRangeByTime(YBRedisReadOp* op, const RedisClientCommand& a
   return Status::OK();
 }
 
+CHECKED_STATUS ParseTsRangeByTime(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseTsRangeByTimeLikeCommands(
+      op, args, RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSRANGEBYTIME);
+}
+
+// TSREVRANGEBYTIME <KEY> <LOW> <HIGH> [LIMIT <COUNT>]
+// Returns entries from the newest to the oldest, so the most recent entries of a long time series
+// could be read page by page, using "(<last returned timestamp>" as the high bound of next page.
+CHECKED_STATUS ParseTsRevRangeByTime(YBRedisReadOp* op, const RedisClientCommand& args) {
+  RETURN_NOT_OK(ParseTsRangeByTimeLikeCommands(
+      op, args, RedisCollectionGetRangeRequestPB_GetRangeRequestType_TSREVRANGEBYTIME));
+  if (args.size() == 4) {
+    return Status::OK();
+  }
+  if (args.size() != 6 || to_lower_case(args[4]) != "limit") {
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "wrong number of arguments: $0 for command: tsrevrangebytime", args.size());
+  }
+  auto count = ParseInt64(args[5], "Count");
+  RETURN_NOT_OK(count);
+  if (*count <= 0) {
+    return STATUS_FORMAT(InvalidArgument, "Count should be positive: $0", *count);
+  }
+  op->mutable_request()->mutable_get_collection_range_request()->set_count(*count);
+  return Status::OK();
+}
+
+// ZRANGEBYSCORE <KEY> <MIN> <MAX> [WITHSCORES] [LIMIT <OFFSET> <COUNT>]
+CHECKED_STATUS ParseZRangeByScore(YBRedisReadOp* op, const RedisClientCommand& args) {
+  auto* range_request = op->mutable_request()->mutable_get_collection_range_request();
+  range_request->set_request_type(
+      RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGEBYSCORE);
+
+  const auto& key = args[1];
+  RETURN_NOT_OK(ParseSubKeyBound(
+      args[2], op->mutable_request()->mutable_subkey_range()->mutable_lower_bound(),
+      ParseScoreBoundArg));
+  RETURN_NOT_OK(ParseSubKeyBound(
+      args[3], op->mutable_request()->mutable_subkey_range()->mutable_upper_bound(),
+      ParseScoreBoundArg));
+
+  size_t idx = 4;
+  while (idx < args.size()) {
+    const auto option = to_lower_case(args[idx]);
+    if (option == "withscores") {
+      range_request->set_with_scores(true);
+      idx += 1;
+    } else if (option == "limit" && idx + 2 < args.size()) {
+      auto offset = ParseInt64(args[idx + 1], "Offset");
+      RETURN_NOT_OK(offset);
+      auto count = ParseInt64(args[idx + 2], "Count");
+      RETURN_NOT_OK(count);
+      if (*offset < 0) {
+        // Redis returns an empty result for negative offsets.
+        range_request->set_count(0);
+      } else {
+        range_request->set_offset(*offset);
+        range_request->set_count(*count);
+      }
+      idx += 3;
+    } else {
+      return STATUS_FORMAT(InvalidArgument,
+          "Unidentified argument $0 found while parsing zrangebyscore command", args[idx]);
+    }
+  }
+
+  op->mutable_request()->mutable_key_value()->set_key(key.ToBuffer());
+  return Status::OK();
+}
+
+// ZRANGE <KEY> <START> <STOP> [WITHSCORES]
+CHECKED_STATUS ParseZRange(YBRedisReadOp* op, const RedisClientCommand& args) {
+  auto* range_request = op->mutable_request()->mutable_get_collection_range_request();
+  range_request->set_request_type(RedisCollectionGetRangeRequestPB_GetRangeRequestType_ZRANGE);
+
+  const auto& key = args[1];
+  auto start = ParseInt64(args[2], "Start");
+  RETURN_NOT_OK(start);
+  range_request->set_start(*start);
+  auto stop = ParseInt64(args[3], "Stop");
+  RETURN_NOT_OK(stop);
+  range_request->set_stop(*stop);
+
+  if (args.size() == 5 && to_lower_case(args[4]) == "withscores") {
+    range_request->set_with_scores(true);
+  } else if (args.size() != 4) {
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "wrong number of arguments: $0 for command: zrange", args.size());
+  }
+
+  op->mutable_request()->mutable_key_value()->set_key(key.ToBuffer());
+  return Status::OK();
+}
+
+// LRANGE <KEY> <START> <STOP>
+CHECKED_STATUS ParseLRange(YBRedisReadOp* op, const RedisClientCommand& args) {
+  auto* range_request = op->mutable_request()->mutable_get_collection_range_request();
+  range_request->set_request_type(RedisCollectionGetRangeRequestPB_GetRangeRequestType_LRANGE);
+
+  const auto& key = args[1];
+  auto start = ParseInt64(args[2], "Start");
+  RETURN_NOT_OK(start);
+  range_request->set_start(*start);
+  auto stop = ParseInt64(args[3], "Stop");
+  RETURN_NOT_OK(stop);
+  range_request->set_stop(*stop);
+
+  op->mutable_request()->mutable_key_value()->set_key(key.ToBuffer());
+  return Status::OK();
+}
+
+// Used for HSCAN/SSCAN.
+// CMD <KEY> <CURSOR> [COUNT <COUNT>]
+// Cursor is "0" at the start and the end of a scan, otherwise it is the hex encoded cursor that
+// was returned by the previous page.
+CHECKED_STATUS ParseScanLikeCommands(YBRedisReadOp* op, const RedisClientCommand& args,
+                                     RedisScanRequestPB_ScanRequestType request_type) {
+  auto* scan_request = op->mutable_request()->mutable_scan_request();
+  scan_request->set_request_type(request_type);
+
+  const auto& key = args[1];
+  const auto& cursor = args[2];
+  if (cursor != Slice("0")) {
+    if (cursor.empty() || cursor.size() % 2 != 0 ||
+        !std::all_of(cursor.cdata(), cursor.cdata() + cursor.size(), ascii_isxdigit)) {
+      return STATUS_FORMAT(InvalidArgument, "Invalid cursor: $0", cursor.ToBuffer());
+    }
+    string decoded_cursor;
+    a2b_hex(cursor.cdata(), &decoded_cursor, cursor.size() / 2);
+    scan_request->set_cursor(std::move(decoded_cursor));
+  }
+
+  size_t idx = 3;
+  while (idx < args.size()) {
+    const auto option = to_lower_case(args[idx]);
+    if (option == "count" && idx + 1 < args.size()) {
+      auto count = ParseInt64(args[idx + 1], "Count");
+      RETURN_NOT_OK(count);
+      if (*count <= 0) {
+        return STATUS_FORMAT(InvalidArgument, "Count should be positive: $0", *count);
+      }
+      scan_request->set_count(*count);
+      idx += 2;
+    } else if (option == "match") {
+      return STATUS(InvalidCommand, "MATCH option is not supported");
+    } else {
+      return STATUS_FORMAT(InvalidArgument,
+          "Unidentified argument $0 found while parsing scan command", args[idx]);
+    }
+  }
+
+  op->mutable_request()->mutable_key_value()->set_key(key.ToBuffer());
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseHScan(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseScanLikeCommands(op, args, RedisScanRequestPB_ScanRequestType_HSCAN);
+}
+
+CHECKED_STATUS ParseSScan(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseScanLikeCommands(op, args, RedisScanRequestPB_ScanRequestType_SSCAN);
+}
+
 CHECKED_STATUS ParseTsGet(YBRedisReadOp* op, const RedisClientCommand& args) {
   op->mutable_request()->set_allocated_get_request(new RedisGetRequestPB());
   op->mutable_request()->mutable_get_request()->set_request_type(
@@ -445,6 +729,10 @@ CHECKED_STATUS ParseSCard(YBRedisReadOp* op, const RedisClientCommand& args) {
   return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_SCARD);
 }
 
+CHECKED_STATUS ParseLLen(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_LLEN);
+}
+
 CHECKED_STATUS ParseStrLen(YBRedisReadOp* op, const RedisClientCommand& args) {
   op->mutable_request()->set_allocated_strlen_request(new RedisStrLenRequestPB());
   const auto& key = args[1];
@@ -567,12 +855,11 @@ CHECKED_STATUS RedisParser::SingleLine() {
 }
 
 CHECKED_STATUS RedisParser::BulkHeader() {
-  auto status = FindEndOfLine();
-  if (!status.ok() || incomplete_) {
-    return status;
-  }
   ptrdiff_t num_args = 0;
   RETURN_NOT_OK(ParseNumber('*', 1, kMaxNumberOfArgs, "Number of lines in multiline", &num_args));
+  if (incomplete_) {
+    return Status::OK();
+  }
   if (args_) {
     args_->clear();
     args_->reserve(num_args);
@@ -584,12 +871,11 @@ CHECKED_STATUS RedisParser::BulkHeader() {
 }
 
 CHECKED_STATUS RedisParser::BulkArgumentSize() {
-  auto status = FindEndOfLine();
-  if (!status.ok() || incomplete_) {
-    return status;
-  }
   ptrdiff_t current_size = 0;
   RETURN_NOT_OK(ParseNumber('$', 0, kMaxBufferSize, "Argument size", &current_size));
+  if (incomplete_) {
+    return Status::OK();
+  }
   state_ = State::BULK_ARGUMENT_BODY;
   token_begin_ = pos_;
   current_argument_size_ = current_size;
@@ -636,31 +922,63 @@ CHECKED_STATUS RedisParser::FindEndOfLine() {
 }
 
 // Parses number with specified bounds.
-// Number is located in separate line, and contain prefix before actual number.
-// Line starts at token_begin_ and pos_ is a start of next line.
+// Number is located in separate line, that starts at token_begin_ and contains prefix before
+// actual number. Such lines are short, so the number is parsed in the same pass that looks for the
+// end of line. On success pos_ is a start of next line.
 CHECKED_STATUS RedisParser::ParseNumber(char prefix,
                                         ptrdiff_t min,
                                         ptrdiff_t max,
                                         const char* name,
                                         ptrdiff_t* out) {
-  if (*token_begin_ != prefix) {
+  auto p = token_begin_;
+  if (p == end_) {
+    incomplete_ = true;
+    return Status::OK();
+  }
+  if (*p != prefix) {
     return STATUS_SUBSTITUTE(Corruption,
                              "Invalid character before number, expected: $0, but found: $1",
                              prefix,
-                             static_cast<char>(*token_begin_));
-  }
-  auto number_begin = token_begin_ + 1;
-  auto expected_stop = pos_ - kLineEndLength;
-  auto parsed_number = util::CheckedStoll(Slice(number_begin, expected_stop));
-  RETURN_NOT_OK(parsed_number);
-  static_assert(sizeof(*parsed_number) == sizeof(*out), "Expected size");
-  SCHECK_BOUNDS(*parsed_number,
+                             static_cast<char>(*p));
+  }
+  ++p;
+  const bool negative = p != end_ && *p == '-';
+  if (negative) {
+    ++p;
+  }
+  const auto digits_begin = p;
+  int64_t parsed_number = 0;
+  while (p != end_ && *p >= '0' && *p <= '9') {
+    if (p - digits_begin == kMaxNumberLength) {
+      return STATUS_FORMAT(Corruption, "$0 is too long", name);
+    }
+    parsed_number = parsed_number * 10 + (*p - '0');
+    ++p;
+  }
+  if (p + kLineEndLength > end_) {
+    if (p != end_ && *p != '\r') {
+      return STATUS_FORMAT(Corruption, "$0 is not a valid number", name);
+    }
+    incomplete_ = true;
+    return Status::OK();
+  }
+  if (p == digits_begin || *p != '\r') {
+    return STATUS_FORMAT(Corruption, "$0 is not a valid number", name);
+  }
+  if (p[1] != '\n') {
+    return STATUS(NetworkError, "\\r is not followed by \\n");
+  }
+  if (negative) {
+    parsed_number = -parsed_number;
+  }
+  SCHECK_BOUNDS(parsed_number,
                 min,
                 max,
                 Corruption,
                 yb::Format("$0 out of expected range [$1, $2] : $3",
-                           name, min, max, *parsed_number));
-  *out = static_cast<ptrdiff_t>(*parsed_number);
+                           name, min, max, parsed_number));
+  pos_ = p + kLineEndLength;
+  *out = static_cast<ptrdiff_t>(parsed_number);
   return Status::OK();
 }
 
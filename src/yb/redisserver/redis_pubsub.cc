@@ -0,0 +1,153 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/redisserver/redis_pubsub.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include "yb/gutil/strings/join.h"
+#include "yb/gutil/strings/strcat.h"
+
+#include "yb/redisserver/redis_encoding.h"
+
+#include "yb/rpc/connection.h"
+#include "yb/rpc/server_event.h"
+
+#include "yb/util/logging.h"
+#include "yb/util/ref_cnt_buffer.h"
+
+namespace yb {
+namespace redisserver {
+
+namespace {
+
+const std::string kKeyspaceChannelPrefix = "__keyspace@0__:";
+const std::string kKeyeventChannelPrefix = "__keyevent@0__:";
+
+// Message published to a channel, the same instance is queued to all subscribed connections.
+class RedisPubSubMessage : public rpc::ServerEventList {
+ public:
+  RedisPubSubMessage(const std::string& channel, const std::string& message)
+      : data_(EncodeAsArrayOfEncodedElements(std::initializer_list<std::string>{
+            EncodeAsBulkString("message").ToBuffer(),
+            EncodeAsBulkString(channel).ToBuffer(),
+            EncodeAsBulkString(message).ToBuffer()})) {}
+
+  void Transferred(const Status& status) override {
+    if (!status.ok()) {
+      YB_LOG_EVERY_N_SECS(WARNING, 10) << "Transfer of Redis message failed: " << status;
+    }
+  }
+
+  void Serialize(std::deque<RefCntBuffer>* output) const override {
+    output->push_back(data_);
+  }
+
+  std::string ToString() const override {
+    return "RedisPubSubMessage";
+  }
+
+ private:
+  RefCntBuffer data_;
+};
+
+} // namespace
+
+void RedisPubSub::Subscribe(const std::string& channel, const rpc::ConnectionPtr& connection) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  channels_[channel][connection.get()] = connection;
+}
+
+void RedisPubSub::Unsubscribe(const std::string& channel, const rpc::Connection* connection) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = channels_.find(channel);
+  if (it == channels_.end()) {
+    return;
+  }
+  it->second.erase(connection);
+  if (it->second.empty()) {
+    channels_.erase(it);
+  }
+}
+
+size_t RedisPubSub::Publish(const std::string& channel, const std::string& message) {
+  std::vector<rpc::ConnectionPtr> connections;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = channels_.find(channel);
+    if (it == channels_.end()) {
+      return 0;
+    }
+    connections.reserve(it->second.size());
+    for (const auto& subscriber : it->second) {
+      auto connection = subscriber.second.lock();
+      if (connection) {
+        connections.push_back(std::move(connection));
+      }
+    }
+  }
+  if (connections.empty()) {
+    return 0;
+  }
+  auto data = std::make_shared<RedisPubSubMessage>(channel, message);
+  for (const auto& connection : connections) {
+    connection->QueueOutboundData(data);
+  }
+  return connections.size();
+}
+
+void RedisPubSub::NotifyKeyspaceEvent(Slice event, Slice key) {
+  const auto event_name = boost::to_lower_copy(event.ToBuffer());
+  const auto key_name = key.ToBuffer();
+  Publish(kKeyspaceChannelPrefix + key_name, event_name);
+  Publish(kKeyeventChannelPrefix + event_name, key_name);
+}
+
+RedisSubscriptions::~RedisSubscriptions() {
+  for (const auto& channel : channels_) {
+    pubsub_->Unsubscribe(channel, connection_);
+  }
+}
+
+size_t RedisSubscriptions::Subscribe(const std::shared_ptr<RedisPubSub>& pubsub,
+                                     const rpc::ConnectionPtr& connection,
+                                     const std::string& channel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pubsub_) {
+    pubsub_ = pubsub;
+    connection_ = connection.get();
+  }
+  DCHECK_EQ(pubsub_, pubsub);
+  DCHECK_EQ(connection_, connection.get());
+  if (channels_.insert(channel).second) {
+    pubsub_->Subscribe(channel, connection);
+  }
+  return channels_.size();
+}
+
+size_t RedisSubscriptions::Unsubscribe(const std::string& channel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (channels_.erase(channel)) {
+    pubsub_->Unsubscribe(channel, connection_);
+  }
+  return channels_.size();
+}
+
+std::vector<std::string> RedisSubscriptions::Channels() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<std::string>(channels_.begin(), channels_.end());
+}
+
+} // namespace redisserver
+} // namespace yb
@@ -0,0 +1,80 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_REDISSERVER_REDIS_PUBSUB_H
+#define YB_REDISSERVER_REDIS_PUBSUB_H
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/rpc/rpc_fwd.h"
+
+#include "yb/util/slice.h"
+
+namespace yb {
+namespace redisserver {
+
+// Delivers messages published to channels to the connections of this Redis server that are
+// subscribed to them. Messages are queued to such connections directly, as server events, i.e.
+// they do not wait for responses to the calls that are being processed by the connection.
+class RedisPubSub {
+ public:
+  void Subscribe(const std::string& channel, const rpc::ConnectionPtr& connection);
+  void Unsubscribe(const std::string& channel, const rpc::Connection* connection);
+
+  // Sends message to all connections subscribed to the channel, returns the number of them.
+  size_t Publish(const std::string& channel, const std::string& message);
+
+  // Publishes keyspace and keyevent notifications about event, i.e. the name of write command,
+  // that modified the key.
+  void NotifyKeyspaceEvent(Slice event, Slice key);
+
+ private:
+  typedef std::unordered_map<const rpc::Connection*, std::weak_ptr<rpc::Connection>> Subscribers;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Subscribers> channels_;
+};
+
+// Channels that a connection is subscribed to. The connection is unsubscribed from all of them
+// when this object is destroyed, i.e. together with the connection.
+class RedisSubscriptions {
+ public:
+  ~RedisSubscriptions();
+
+  // Subscribes the connection to the channel, returns the number of channels it is subscribed to.
+  size_t Subscribe(const std::shared_ptr<RedisPubSub>& pubsub,
+                   const rpc::ConnectionPtr& connection,
+                   const std::string& channel);
+
+  // Unsubscribes the connection from the channel, returns the number of remaining channels.
+  size_t Unsubscribe(const std::string& channel);
+
+  std::vector<std::string> Channels() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<RedisPubSub> pubsub_;
+  const rpc::Connection* connection_ = nullptr;
+  std::set<std::string> channels_;
+};
+
+} // namespace redisserver
+} // namespace yb
+
+#endif // YB_REDISSERVER_REDIS_PUBSUB_H
@@ -16,6 +16,8 @@
 
 #include "yb/common/redis_protocol.pb.h"
 
+#include "yb/gutil/strings/escaping.h"
+
 #include "yb/redisserver/redis_encoding.h"
 #include "yb/redisserver/redis_parser.h"
 
@@ -30,6 +32,7 @@
 #include "yb/util/debug/trace_event.h"
 
 #include "yb/util/memory/memory.h"
+#include "yb/util/object_pool.h"
 
 using yb::operator"" _KB;
 
@@ -109,9 +112,9 @@ Status RedisConnectionContext::HandleInboundCall(const rpc::ConnectionPtr& conne
   auto reactor = connection->reactor();
   DCHECK(reactor->IsCurrentThread());
 
-  auto call = std::make_shared<RedisInboundCall>(connection, call_processed_listener());
+  auto call = MakePooledShared<RedisInboundCall>(connection, call_processed_listener());
 
-  Status s = call->ParseFrom(commands_in_batch, source);
+  Status s = call->ParseFrom(&multi_state_, commands_in_batch, source);
   if (!s.ok()) {
     return s;
   }
@@ -130,31 +133,31 @@ RedisInboundCall::RedisInboundCall(rpc::ConnectionPtr conn,
     : QueueableInboundCall(std::move(conn), std::move(call_processed_listener)) {
 }
 
-Status RedisInboundCall::ParseFrom(size_t commands, Slice source) {
+Status RedisInboundCall::ParseFrom(RedisMultiState* multi, size_t commands, Slice source) {
   TRACE_EVENT_FLOW_BEGIN0("rpc", "RedisInboundCall", this);
   TRACE_EVENT0("rpc", "RedisInboundCall::ParseFrom");
 
-  request_data_.assign(source.data(), source.end());
-  serialized_request_ = source = Slice(request_data_.data(), request_data_.size());
+  serialized_request_ = source = StoreRequestData(source);
 
-  client_batch_.resize(commands);
-  responses_.resize(commands);
-  ready_.reserve(commands);
-  for (size_t i = 0; i != commands; ++i)
-    ready_.emplace_back(0);
+  client_batch_.reserve(commands);
+  multi_roles_.reserve(commands);
   Status status;
   RedisParser parser(source);
+  const uint8_t* begin_of_command = source.data();
   const uint8_t* end_of_command = nullptr;
   for (size_t i = 0; i != commands; ++i) {
-    parser.SetArgs(&client_batch_[i]);
+    client_batch_.emplace_back();
+    parser.SetArgs(&client_batch_.back());
     RETURN_NOT_OK(parser.NextCommand(&end_of_command));
-    DCHECK_NE(0, client_batch_[i].size());
-    if (client_batch_[i].empty()) { // Should not be there
+    DCHECK_NE(0, client_batch_.back().size());
+    if (client_batch_.back().empty()) { // Should not be there
       return STATUS(Corruption, "Empty command");
     }
     if (!end_of_command) {
       break;
     }
+    RETURN_NOT_OK(ProcessMulti(multi, Slice(begin_of_command, end_of_command)));
+    begin_of_command = end_of_command;
   }
   if (end_of_command != source.end()) {
     return STATUS_SUBSTITUTE(Corruption,
@@ -163,10 +166,64 @@ Status RedisInboundCall::ParseFrom(size_t commands, Slice source) {
                              source.size());
   }
 
+  responses_.resize(client_batch_.size());
+  ready_.reserve(client_batch_.size());
+  for (size_t i = 0; i != client_batch_.size(); ++i)
+    ready_.emplace_back(0);
+
   parsed_.store(true, std::memory_order_release);
   return Status::OK();
 }
 
+namespace {
+
+bool IsCommand(const RedisClientCommand& command, const char* name) {
+  const size_t len = strlen(name);
+  return command[0].size() == len && strncasecmp(command[0].cdata(), name, len) == 0;
+}
+
+} // namespace
+
+Status RedisInboundCall::ProcessMulti(RedisMultiState* multi, Slice command) {
+  const auto& args = client_batch_.back();
+  if (IsCommand(args, "multi")) {
+    multi_roles_.push_back(multi->active ? RedisMultiRole::kMisplaced : RedisMultiRole::kNone);
+    multi->active = true;
+  } else if (IsCommand(args, "discard")) {
+    multi_roles_.push_back(multi->active ? RedisMultiRole::kNone : RedisMultiRole::kMisplaced);
+    multi->Reset();
+  } else if (!multi->active) {
+    multi_roles_.push_back(
+        IsCommand(args, "exec") ? RedisMultiRole::kMisplaced : RedisMultiRole::kNone);
+  } else if (!IsCommand(args, "exec")) {
+    multi_roles_.push_back(RedisMultiRole::kQueued);
+    multi->commands.append(command.cdata(), command.size());
+    ++multi->num_commands;
+  } else {
+    multi_roles_.push_back(RedisMultiRole::kExec);
+    // Queued commands are parsed to the batch right after EXEC, pointing to our own copy of them.
+    executed_commands_.emplace_back(multi->commands);
+    const auto& buffer = executed_commands_.back();
+    RedisParser parser(Slice(buffer.udata(), buffer.size()));
+    const uint8_t* end_of_command = nullptr;
+    for (size_t i = 0; i != multi->num_commands; ++i) {
+      client_batch_.emplace_back();
+      parser.SetArgs(&client_batch_.back());
+      RETURN_NOT_OK(parser.NextCommand(&end_of_command));
+      if (!end_of_command || client_batch_.back().empty()) {
+        return STATUS(Corruption, "Failed to parse commands queued by MULTI");
+      }
+      multi_roles_.push_back(RedisMultiRole::kExecuted);
+    }
+    multi->Reset();
+  }
+  return Status::OK();
+}
+
+RedisConnectionContext& RedisInboundCall::connection_context() const {
+  return static_cast<RedisConnectionContext&>(connection()->context());
+}
+
 const std::string& RedisInboundCall::service_name() const {
   static std::string result = "yb.redisserver.RedisServerService"s;
   return result;
@@ -187,7 +244,7 @@ void RedisInboundCall::LogTrace() const {
 
   if (PREDICT_FALSE(FLAGS_rpc_dump_all_traces)) {
     LOG(INFO) << ToString() << " took " << total_time << "ms. Trace:";
-    trace_->Dump(&LOG(INFO), /* include_time_deltas */ true);
+    DumpTrace(&LOG(INFO));
   }
 }
 
@@ -218,50 +275,119 @@ void RedisInboundCall::DumpPB(const rpc::DumpRunningRpcsRequestPB& req,
   }
 }
 
-template <class Collection, class Out>
-Out DoSerializeResponses(const Collection& responses, Out out) {
+template <class Out>
+Out DoSerializeResponse(const RedisResponsePB& redis_response, Out out) {
   // TODO(Amit): As and when we implement get/set and its h* equivalents, we would have to
   // handle arrays, hashes etc. For now, we only support the string response.
 
-  for (const auto& redis_response : responses) {
-    if (redis_response.code() == RedisResponsePB_RedisStatusCode_SERVER_ERROR) {
-      out = SerializeError("Request was unable to be processed from server.", out);
-    } else if (redis_response.code() == RedisResponsePB_RedisStatusCode_NOT_FOUND) {
-      out = SerializeEncoded(kNilResponse, out);
-    } else if (redis_response.code() != RedisResponsePB_RedisStatusCode_OK) {
-      // We send a nil response for all non-ok statuses as of now.
-      // TODO: Follow redis error messages.
-      out = SerializeError("Error: Something wrong", out);
-    } else if (redis_response.has_string_response()) {
-      out = SerializeBulkString(redis_response.string_response(), out);
-    } else if (redis_response.has_int_response()) {
-      out = SerializeInteger(redis_response.int_response(), out);
-    } else if (redis_response.has_array_response()) {
-      if (redis_response.array_response().has_encoded() &&
-          redis_response.array_response().encoded()) {
-        out = SerializeEncodedArray(redis_response.array_response().elements(), out);
-      } else {
-        out = SerializeArray(redis_response.array_response().elements(), out);
+  if (redis_response.code() == RedisResponsePB_RedisStatusCode_SERVER_ERROR) {
+    out = SerializeError("Request was unable to be processed from server.", out);
+  } else if (redis_response.code() == RedisResponsePB_RedisStatusCode_NOT_FOUND) {
+    out = SerializeEncoded(kNilResponse, out);
+  } else if (redis_response.code() != RedisResponsePB_RedisStatusCode_OK) {
+    // We send a nil response for all non-ok statuses as of now.
+    // TODO: Follow redis error messages.
+    out = SerializeError("Error: Something wrong", out);
+  } else if (redis_response.has_string_response()) {
+    out = SerializeBulkString(redis_response.string_response(), out);
+  } else if (redis_response.has_encoded_response()) {
+    out = SerializeEncoded(redis_response.encoded_response(), out);
+  } else if (redis_response.has_int_response()) {
+    out = SerializeInteger(redis_response.int_response(), out);
+  } else if (redis_response.has_cursor()) {
+    // Cursor is exposed to the client in hex, "0" denotes the start and the end of a scan.
+    const auto& cursor = redis_response.cursor();
+    out = SerializeEncoded(kScanResponseHeader, out);
+    out = SerializeBulkString(
+        cursor.empty() ? "0" : b2a_hex(cursor.data(), cursor.size()), out);
+    out = SerializeArray(redis_response.array_response().elements(), out);
+  } else if (redis_response.has_array_response()) {
+    if (redis_response.array_response().has_encoded() &&
+        redis_response.array_response().encoded()) {
+      out = SerializeEncodedArray(redis_response.array_response().elements(), out);
+    } else {
+      out = SerializeArray(redis_response.array_response().elements(), out);
+    }
+  } else {
+    out = SerializeEncoded(kOkResponse, out);
+  }
+  return out;
+}
+
+template <class Responses, class Roles, class Out>
+Out DoSerializeResponses(const Responses& responses, const Roles& roles, Out out) {
+  for (size_t i = 0; i != responses.size(); ++i) {
+    const auto& redis_response = responses[i];
+    if (roles[i] == RedisMultiRole::kExec) {
+      // Responses of executed commands follow EXEC, so it is enough to prepend them with
+      // the array header.
+      size_t executed = 0;
+      while (i + executed + 1 != responses.size() &&
+             roles[i + executed + 1] == RedisMultiRole::kExecuted) {
+        ++executed;
       }
+      out = SerializeArrayHeader(executed, out);
+    } else if (roles[i] == RedisMultiRole::kQueued &&
+               redis_response.code() == RedisResponsePB_RedisStatusCode_OK) {
+      out = SerializeEncoded(kQueuedResponse, out);
     } else {
-      out = SerializeEncoded(kOkResponse, out);
+      out = DoSerializeResponse(redis_response, out);
     }
   }
   return out;
 }
 
-template <class Collection>
-RefCntBuffer SerializeResponses(const Collection& responses) {
+template <class Responses, class Roles>
+RefCntBuffer SerializeResponses(const Responses& responses, const Roles& roles) {
   constexpr size_t kZero = 0;
-  size_t size = DoSerializeResponses(responses, kZero);
+  size_t size = DoSerializeResponses(responses, roles, kZero);
   RefCntBuffer result(size);
-  uint8_t* end = DoSerializeResponses(responses, result.udata());
+  uint8_t* end = DoSerializeResponses(responses, roles, result.udata());
   DCHECK_EQ(result.uend(), end);
   return result;
 }
 
+namespace {
+
+// Returns shared encoding of the response, or null if it should be serialized.
+const RefCntBuffer* SharedResponse(const RedisResponsePB& redis_response, RedisMultiRole role) {
+  if (role == RedisMultiRole::kQueued) {
+    return redis_response.code() == RedisResponsePB_RedisStatusCode_OK ? &SharedQueuedResponse()
+                                                                        : nullptr;
+  }
+  if (role != RedisMultiRole::kNone) {
+    return nullptr;
+  }
+  if (redis_response.code() == RedisResponsePB_RedisStatusCode_NOT_FOUND) {
+    return &SharedNilResponse();
+  }
+  if (redis_response.code() != RedisResponsePB_RedisStatusCode_OK) {
+    return nullptr;
+  }
+  if (redis_response.has_int_response()) {
+    return SharedIntegerResponse(redis_response.int_response());
+  }
+  // The same condition as for the OK response in DoSerializeResponse.
+  if (!redis_response.has_string_response() && !redis_response.has_encoded_response() &&
+      !redis_response.has_cursor() && !redis_response.has_array_response()) {
+    return &SharedOkResponse();
+  }
+  return nullptr;
+}
+
+} // namespace
+
 void RedisInboundCall::Serialize(std::deque<RefCntBuffer>* output) const {
-  output->push_back(SerializeResponses(responses_));
+  // Calls with a single command, e.g. SET or GET of missing key, are often responded with one of
+  // the most common replies, so they do not need a buffer of their own.
+  if (responses_.size() == 1) {
+    const auto* shared = SharedResponse(responses_[0], multi_roles_[0]);
+    if (shared) {
+      output->push_back(*shared);
+      return;
+    }
+  }
+  output->push_back(SerializeResponses(responses_, multi_roles_));
 }
 
 void RedisInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code,
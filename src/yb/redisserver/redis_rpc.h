@@ -16,22 +16,58 @@
 #ifndef YB_REDISSERVER_REDIS_RPC_H
 #define YB_REDISSERVER_REDIS_RPC_H
 
+#include <string>
+#include <vector>
+
 #include "yb/redisserver/redis_fwd.h"
+#include "yb/redisserver/redis_pubsub.h"
 #include "yb/common/redis_protocol.pb.h"
 
 #include "yb/rpc/connection.h"
 #include "yb/rpc/rpc_with_queue.h"
 
+#include "yb/util/ref_cnt_buffer.h"
+
 namespace yb {
 namespace redisserver {
 
 class RedisParser;
 
+// Role of a command in respect to MULTI/EXEC.
+enum class RedisMultiRole : uint8_t {
+  // Regular command, executed as soon as it is received.
+  kNone,
+  // Command received after MULTI, it is responded with QUEUED and executed by EXEC.
+  kQueued,
+  // EXEC of active MULTI, responded with array of responses of following kExecuted commands.
+  kExec,
+  // Command that was queued after MULTI and is executed by preceding EXEC.
+  kExecuted,
+  // MULTI when MULTI is already active, or EXEC/DISCARD without MULTI.
+  kMisplaced,
+};
+
+// Commands of a connection queued after MULTI, that are waiting for EXEC.
+struct RedisMultiState {
+  bool active = false;
+  // Queued commands in the same format as they were received from the client.
+  std::string commands;
+  size_t num_commands = 0;
+
+  void Reset() {
+    active = false;
+    commands.clear();
+    num_commands = 0;
+  }
+};
+
 class RedisConnectionContext : public rpc::ConnectionContextWithQueue {
  public:
   RedisConnectionContext();
   ~RedisConnectionContext();
 
+  RedisSubscriptions& subscriptions() { return subscriptions_; }
+
  private:
   void RunNegotiation(rpc::ConnectionPtr connection, const MonoTime& deadline) override;
   CHECKED_STATUS ProcessCalls(const rpc::ConnectionPtr& connection,
@@ -45,13 +81,19 @@ class RedisConnectionContext : public rpc::ConnectionContextWithQueue {
 
   std::unique_ptr<RedisParser> parser_;
   size_t commands_in_batch_ = 0;
+  RedisMultiState multi_state_;
+  RedisSubscriptions subscriptions_;
 };
 
 class RedisInboundCall : public rpc::QueueableInboundCall {
  public:
   explicit RedisInboundCall(rpc::ConnectionPtr conn, CallProcessedListener call_processed_listener);
 
-  CHECKED_STATUS ParseFrom(size_t commands, Slice source);
+  // Parses commands from source. multi is MULTI state of the connection, it is updated by commands
+  // of this call. Commands queued by MULTI are appended to the batch right after their EXEC, so
+  // they are executed together, i.e. writes of them to the same tablet are sent in a single RPC
+  // and applied in a single Raft round.
+  CHECKED_STATUS ParseFrom(RedisMultiState* multi, size_t commands, Slice source);
 
   // Serialize the response packet for the finished call.
   // The resulting slices refer to memory in this object.
@@ -65,6 +107,10 @@ class RedisInboundCall : public rpc::QueueableInboundCall {
 
   RedisClientBatch& client_batch() { return client_batch_; }
 
+  RedisMultiRole multi_role(size_t idx) const { return multi_roles_[idx]; }
+
+  RedisConnectionContext& connection_context() const;
+
   const std::string& service_name() const override;
   const std::string& method_name() const override;
   void RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code, const Status& status) override;
@@ -76,6 +122,9 @@ class RedisInboundCall : public rpc::QueueableInboundCall {
  private:
   void Respond(size_t idx, bool is_success, RedisResponsePB* resp);
 
+  // Updates MULTI state with the last parsed command, that is located at the specified slice.
+  CHECKED_STATUS ProcessMulti(RedisMultiState* multi, Slice command);
+
   // The connection on which this inbound call arrived.
   static constexpr size_t batch_capacity = RedisClientBatch::static_capacity;
   boost::container::small_vector<RedisResponsePB, batch_capacity> responses_;
@@ -83,6 +132,9 @@ class RedisInboundCall : public rpc::QueueableInboundCall {
   std::atomic<size_t> ready_count_{0};
   std::atomic<bool> had_failures_{false};
   RedisClientBatch client_batch_;
+  boost::container::small_vector<RedisMultiRole, batch_capacity> multi_roles_;
+  // Storage for commands executed by EXEC(s) of this call.
+  std::vector<RefCntBuffer> executed_commands_;
 
   // Atomic bool to indicate if the command batch has been parsed.
   std::atomic<bool> parsed_ = {false};
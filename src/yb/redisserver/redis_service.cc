@@ -38,6 +38,7 @@
 #include "yb/redisserver/redis_constants.h"
 #include "yb/redisserver/redis_encoding.h"
 #include "yb/redisserver/redis_parser.h"
+#include "yb/redisserver/redis_pubsub.h"
 #include "yb/redisserver/redis_rpc.h"
 #include "yb/redisserver/redis_server.h"
 
@@ -46,6 +47,7 @@
 #include "yb/tserver/tablet_server.h"
 
 #include "yb/util/bytes_formatter.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/memory/mc_types.h"
 #include "yb/util/size_literals.h"
@@ -57,7 +59,7 @@ using yb::operator"" _MB;
       server, BOOST_PP_CAT(handler_latency_yb_redisserver_RedisServerService_, name_identifier), \
       (label_str), yb::MetricUnit::kMicroseconds, \
       "Microseconds spent handling " desc_str " RPC requests", \
-      60000000LU, 2)
+      60000000LU, 2, yb::SHARDED_HISTOGRAM)
 
 #define DEFINE_REDIS_histogram(name_identifier, capitalized_name_str) \
   DEFINE_REDIS_histogram_EX( \
@@ -105,6 +107,22 @@ DEFINE_int32(redis_max_command_size, 33_MB,
 
 DEFINE_bool(redis_safe_batch, true, "Use safe batching with Redis service");
 
+DEFINE_int32(redis_max_read_rpcs_in_flight_per_tablet, 1,
+             "Maximum number of read RPCs that the Redis service sends to the same tablet "
+             "concurrently. Reads from all connections that arrive while this limit is reached are "
+             "combined and sent in a single RPC when one of the RPCs completes. "
+             "0 to send reads of each call separately.");
+TAG_FLAG(redis_max_read_rpcs_in_flight_per_tablet, advanced);
+
+DEFINE_bool(redis_keyspace_notifications, false,
+            "Publish keyspace and keyevent notifications, i.e. messages to __keyspace@0__:<key> "
+            "and __keyevent@0__:<command> channels, about keys modified by successful write "
+            "commands. Notifications are delivered to clients subscribed via the "
+            "same Redis server only.");
+TAG_FLAG(redis_keyspace_notifications, advanced);
+
+DECLARE_bool(ybclient_use_server_messenger);
+
 #define REDIS_COMMANDS \
     ((get, Get, 2, READ)) \
     ((mget, MGet, -2, READ)) \
@@ -117,9 +135,11 @@ DEFINE_bool(redis_safe_batch, true, "Use safe batching with Redis service");
     ((hlen, HLen, 2, READ)) \
     ((hexists, HExists, 3, READ)) \
     ((hstrlen, HStrLen, 3, READ)) \
+    ((hscan, HScan, -3, READ)) \
     ((smembers, SMembers, 2, READ)) \
     ((sismember, SIsMember, 3, READ)) \
     ((scard, SCard, 2, READ)) \
+    ((sscan, SScan, -3, READ)) \
     ((strlen, StrLen, 2, READ)) \
     ((exists, Exists, 2, READ)) \
     ((getrange, GetRange, 4, READ)) \
@@ -132,7 +152,19 @@ DEFINE_bool(redis_safe_batch, true, "Use safe batching with Redis service");
     ((srem, SRem, -3, WRITE)) \
     ((tsadd, TsAdd, -4, WRITE)) \
     ((tsrangebytime, TsRangeByTime, 4, READ)) \
+    ((tsrevrangebytime, TsRevRangeByTime, -4, READ)) \
     ((tsrem, TsRem, -3, WRITE)) \
+    ((zadd, ZAdd, -4, WRITE)) \
+    ((zrange, ZRange, -4, READ)) \
+    ((zrangebyscore, ZRangeByScore, -4, READ)) \
+    ((llen, LLen, 2, READ)) \
+    ((lrange, LRange, 4, READ)) \
+    ((lpush, LPush, -3, WRITE)) \
+    ((rpush, RPush, -3, WRITE)) \
+    ((lpushx, LPushX, -3, WRITE)) \
+    ((rpushx, RPushX, -3, WRITE)) \
+    ((lpop, LPop, 2, WRITE)) \
+    ((rpop, RPop, 2, WRITE)) \
     ((getset, GetSet, 3, WRITE)) \
     ((append, Append, 3, WRITE)) \
     ((del, Del, 2, WRITE)) \
@@ -146,7 +178,13 @@ DEFINE_bool(redis_safe_batch, true, "Use safe batching with Redis service");
     ((ping, Ping, -1, LOCAL)) \
     ((command, Command, -1, LOCAL)) \
     ((quit, Quit, 1, LOCAL)) \
-    ((flushdb, FlushDB, 1, LOCAL))
+    ((flushdb, FlushDB, 1, LOCAL)) \
+    ((multi, Multi, 1, LOCAL)) \
+    ((exec, Exec, 1, LOCAL)) \
+    ((discard, Discard, 1, LOCAL)) \
+    ((subscribe, Subscribe, -2, PUBSUB)) \
+    ((unsubscribe, Unsubscribe, -1, PUBSUB)) \
+    ((publish, Publish, 3, PUBSUB))
     /**/
 
 #define DO_DEFINE_HISTOGRAM(name, cname, arity, type) \
@@ -173,6 +211,7 @@ typedef boost::container::small_vector_base<Slice> RedisKeyList;
 #define READ_OP YBRedisReadOp
 #define WRITE_OP YBRedisWriteOp
 #define LOCAL_OP RedisResponsePB
+#define PUBSUB_OP RedisPubSub
 
 #define DO_PARSER_FORWARD(name, cname, arity, type) \
     CHECKED_STATUS BOOST_PP_CAT(Parse, cname)( \
@@ -190,12 +229,14 @@ class Operation {
   Operation(const std::shared_ptr<RedisInboundCall>& call,
             size_t index,
             std::shared_ptr<Op> operation,
-            const rpc::RpcMethodMetrics& metrics)
+            const rpc::RpcMethodMetrics& metrics,
+            RedisPubSub* pubsub)
     : read_(std::is_same<Op, YBRedisReadOp>::value),
       call_(call),
       index_(index),
       operation_(std::move(operation)),
-      metrics_(metrics) {
+      metrics_(metrics),
+      pubsub_(pubsub) {
     auto status = operation_->GetPartitionKey(&partition_key_);
     if (!status.ok()) {
       Respond(status);
@@ -263,6 +304,9 @@ class Operation {
   void Respond(const Status& status) {
     responded_.store(true, std::memory_order_release);
     if (status.ok()) {
+      if (pubsub_ && !read_ && response().code() == RedisResponsePB_RedisStatusCode_OK) {
+        pubsub_->NotifyKeyspaceEvent(call_->client_batch()[index_][0], operation_->GetKey());
+      }
       call_->RespondSuccess(index_, metrics_, &response());
     } else {
       call_->RespondFailure(index_, status);
@@ -274,6 +318,8 @@ class Operation {
   size_t index_;
   std::shared_ptr<YBRedisOp> operation_;
   rpc::RpcMethodMetrics metrics_;
+  // Used to publish keyspace notifications about successful writes, null when they are disabled.
+  RedisPubSub* pubsub_;
   std::string partition_key_;
   scoped_refptr<client::internal::RemoteTablet> tablet_;
   std::atomic<bool> responded_{false};
@@ -324,17 +370,64 @@ class SessionPool {
 class BatchContext;
 typedef scoped_refptr<BatchContext> BatchContextPtr;
 
+class Block;
+
+void LogSessionErrors(client::YBSession* session) {
+  client::CollectedErrors errors;
+  bool overflowed;
+  session->GetPendingErrors(&errors, &overflowed);
+  for (const auto& error : errors) {
+    LOG(WARNING) << "Explicit error while inserting: " << error->status().ToString();
+  }
+}
+
+// Combines read blocks of different calls to the same tablet, so reads from many connections
+// share RPCs. Up to FLAGS_redis_max_read_rpcs_in_flight_per_tablet RPCs are sent to a tablet
+// concurrently. Blocks that arrive while this limit is reached are queued, and all of them are sent
+// in a single RPC when one of the RPCs completes. So reads to an idle tablet are not delayed, and
+// reads to a busy tablet are batched.
+class ReadCoalescer {
+ public:
+  void Init(SessionPool* session_pool) {
+    session_pool_ = session_pool;
+  }
+
+  void Launch(const std::shared_ptr<Block>& block);
+
+ private:
+  typedef std::vector<std::shared_ptr<Block>> Blocks;
+
+  class FlushCallback;
+
+  struct TabletState {
+    size_t in_flight = 0;
+    Blocks queued;
+  };
+
+  void Flush(const TabletId& tablet_id, Blocks blocks);
+  void Flushed(const TabletId& tablet_id,
+               Blocks blocks,
+               const std::shared_ptr<client::YBSession>& session,
+               const Status& status);
+
+  SessionPool* session_pool_ = nullptr;
+  std::mutex mutex_;
+  std::unordered_map<TabletId, TabletState> tablets_;
+};
+
 class Block : public std::enable_shared_from_this<Block> {
  public:
   typedef MCVector<Operation*> Ops;
 
   Block(const BatchContextPtr& context,
         Ops::allocator_type allocator,
-        rpc::RpcMethodMetrics metrics_internal)
+        rpc::RpcMethodMetrics metrics_internal,
+        ReadCoalescer* read_coalescer)
       : context_(context),
         ops_(allocator),
         metrics_internal_(std::move(metrics_internal)),
-        start_(MonoTime::FineNow()) {}
+        start_(MonoTime::FineNow()),
+        read_coalescer_(read_coalescer) {}
 
   void AddOperation(Operation* operation) {
     ops_.push_back(operation);
@@ -342,18 +435,22 @@ class Block : public std::enable_shared_from_this<Block> {
 
   void Launch(SessionPool* session_pools) {
     session_pools_ = session_pools;
-    session_ = session_pools[ops_.front()->read()].Take();
-    bool has_ok = false;
-    for (auto* op : ops_) {
-      has_ok = op->Apply(session_.get()) || has_ok;
+    if (read_coalescer_ && ops_.front()->read()) {
+      read_coalescer_->Launch(shared_from_this());
+      return;
     }
-    if (has_ok) {
+    session_ = session_pools[ops_.front()->read()].Take();
+    if (Apply(session_.get())) {
       session_->FlushAsync(new BlockCallback(shared_from_this()));
     } else {
       Processed();
     }
   }
 
+  const TabletId& tablet_id() const {
+    return ops_.front()->tablet()->tablet_id();
+  }
+
   std::shared_ptr<Block> SetNext(const std::shared_ptr<Block>& next) {
     std::shared_ptr<Block> result = std::move(next_);
     next_ = next;
@@ -374,23 +471,30 @@ class Block : public std::enable_shared_from_this<Block> {
     std::shared_ptr<Block> block_;
   };
   friend class BlockCallback;
+  friend class ReadCoalescer;
+
+  // Applies operations of this block to the session, returns true if any of them was applied.
+  bool Apply(client::YBSession* session) {
+    bool has_ok = false;
+    for (auto* op : ops_) {
+      has_ok = op->Apply(session) || has_ok;
+    }
+    return has_ok;
+  }
 
   void Done(const Status& status) {
+    if (!status.ok() && session_.get() != nullptr) {
+      LogSessionErrors(session_.get());
+    }
+    Flushed(status);
+  }
+
+  // Invoked when applied operations were flushed, by own or shared session.
+  void Flushed(const Status& status) {
     MonoTime now = MonoTime::Now(MonoTime::FINE);
     metrics_internal_.handler_latency->Increment(now.GetDeltaSince(start_).ToMicroseconds());
     VLOG(3) << "Received status from call " << status.ToString(true);
 
-    if (!status.ok()) {
-      client::CollectedErrors errors;
-      bool overflowed;
-      if (session_.get() != nullptr) {
-        session_->GetPendingErrors(&errors, &overflowed);
-        for (const auto& error : errors) {
-          LOG(WARNING) << "Explicit error while inserting: " << error->status().ToString();
-        }
-      }
-    }
-
     for (auto* op : ops_) {
       op->Respond(status);
     }
@@ -399,8 +503,10 @@ class Block : public std::enable_shared_from_this<Block> {
   }
 
   void Processed() {
-    session_pools_[ops_.front()->read()].Release(session_);
-    session_.reset();
+    if (session_) {
+      session_pools_[ops_.front()->read()].Release(session_);
+      session_.reset();
+    }
     if (next_) {
       next_->Launch(session_pools_);
     }
@@ -414,8 +520,96 @@ class Block : public std::enable_shared_from_this<Block> {
   SessionPool* session_pools_;
   std::shared_ptr<client::YBSession> session_;
   std::shared_ptr<Block> next_;
+  ReadCoalescer* read_coalescer_;
+};
+
+class ReadCoalescer::FlushCallback : public YBStatusCallback {
+ public:
+  FlushCallback(ReadCoalescer* coalescer,
+                const TabletId& tablet_id,
+                Blocks blocks,
+                std::shared_ptr<client::YBSession> session)
+      : coalescer_(coalescer), tablet_id_(tablet_id), blocks_(std::move(blocks)),
+        session_(std::move(session)) {}
+
+  void Run(const Status& status) override {
+    coalescer_->Flushed(tablet_id_, std::move(blocks_), session_, status);
+    delete this;
+  }
+
+ private:
+  ReadCoalescer* coalescer_;
+  TabletId tablet_id_;
+  Blocks blocks_;
+  std::shared_ptr<client::YBSession> session_;
 };
 
+void ReadCoalescer::Launch(const std::shared_ptr<Block>& block) {
+  const auto& tablet_id = block->tablet_id();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = tablets_[tablet_id];
+    if (state.in_flight >= static_cast<size_t>(FLAGS_redis_max_read_rpcs_in_flight_per_tablet)) {
+      state.queued.push_back(block);
+      return;
+    }
+    ++state.in_flight;
+  }
+  Flush(tablet_id, {block});
+}
+
+void ReadCoalescer::Flush(const TabletId& tablet_id, Blocks blocks) {
+  auto session = session_pool_->Take();
+  Blocks applied;
+  // Blocks are allocated in arenas of their contexts, so contexts should outlive them.
+  std::vector<BatchContextPtr> contexts;
+  for (auto& block : blocks) {
+    if (block->Apply(session.get())) {
+      applied.push_back(std::move(block));
+    } else {
+      contexts.push_back(block->context_);
+      block->Processed();
+    }
+  }
+  blocks.clear();
+  if (applied.empty()) {
+    Flushed(tablet_id, Blocks(), session, Status::OK());
+    return;
+  }
+  session->FlushAsync(new FlushCallback(this, tablet_id, std::move(applied), session));
+}
+
+void ReadCoalescer::Flushed(const TabletId& tablet_id,
+                            Blocks blocks,
+                            const std::shared_ptr<client::YBSession>& session,
+                            const Status& status) {
+  if (!status.ok()) {
+    LogSessionErrors(session.get());
+  }
+  std::vector<BatchContextPtr> contexts;
+  contexts.reserve(blocks.size());
+  for (const auto& block : blocks) {
+    contexts.push_back(block->context_);
+    block->Flushed(status);
+  }
+  blocks.clear();
+  session_pool_->Release(session);
+
+  Blocks next;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tablets_.find(tablet_id);
+    DCHECK(it != tablets_.end());
+    next.swap(it->second.queued);
+    if (next.empty() && --it->second.in_flight == 0) {
+      tablets_.erase(it);
+    }
+  }
+  if (!next.empty()) {
+    Flush(tablet_id, std::move(next));
+  }
+}
+
 struct BlockData {
   explicit BlockData(Arena* arena) : used_keys(UsedKeys::allocator_type(arena)) {}
 
@@ -450,7 +644,8 @@ class TabletOperations {
   void Process(const BatchContextPtr& context,
                Arena* arena,
                Operation* operation,
-               rpc::RpcMethodMetrics* metrics_internal) {
+               rpc::RpcMethodMetrics* metrics_internal,
+               ReadCoalescer* read_coalescer) {
     bool read = operation->read();
     boost::container::small_vector<Slice, RedisClientCommand::static_capacity> keys;
     operation->GetKeys(&keys);
@@ -458,7 +653,8 @@ class TabletOperations {
     auto& data = this->data(read);
     if (!data.block) {
       ArenaAllocator<Block> alloc(arena);
-      data.block = std::allocate_shared<Block>(alloc, context, alloc, metrics_internal[read]);
+      data.block = std::allocate_shared<Block>(
+          alloc, context, alloc, metrics_internal[read], read_coalescer);
       if (read == last_conflict_was_read_) {
         auto old_value = this->data(!read).block->SetNext(data.block);
         if (old_value) {
@@ -524,12 +720,16 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
  public:
   BatchContext(const std::shared_ptr<client::YBClient>& client,
                SessionPool* session_pools,
+               ReadCoalescer* read_coalescer,
                const std::shared_ptr<RedisInboundCall>& call,
-               rpc::RpcMethodMetrics* metrics_internal)
+               rpc::RpcMethodMetrics* metrics_internal,
+               RedisPubSub* pubsub)
       : client_(client),
         session_pools_(session_pools),
+        read_coalescer_(read_coalescer),
         call_(call),
         metrics_internal_(metrics_internal),
+        pubsub_(pubsub),
         operations_(&arena_),
         tablets_(&arena_) {}
 
@@ -563,7 +763,7 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
   void Apply(size_t idx,
              std::shared_ptr<Op> op,
              const rpc::RpcMethodMetrics& metrics) {
-    operations_.emplace_back(call_, idx, std::move(op), metrics);
+    operations_.emplace_back(call_, idx, std::move(op), metrics, pubsub_);
     if (PREDICT_FALSE(operations_.back().responded())) {
       operations_.pop_back();
     }
@@ -589,7 +789,7 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
         } else {
           operations = &it->second;
         }
-        operations->Process(self, &arena_, &operation, metrics_internal_);
+        operations->Process(self, &arena_, &operation, metrics_internal_, read_coalescer_);
       }
     }
 
@@ -600,8 +800,10 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
 
   std::shared_ptr<client::YBClient> client_;
   SessionPool* session_pools_;
+  ReadCoalescer* read_coalescer_;
   std::shared_ptr<RedisInboundCall> call_;
   rpc::RpcMethodMetrics* metrics_internal_;
+  RedisPubSub* pubsub_;
 
   Arena arena_;
   MCDeque<Operation> operations_;
@@ -659,6 +861,14 @@ class RedisServiceImpl::Impl {
       RedisResponsePB (*parse)(const RedisClientCommand&),
       BatchContext* context);
 
+  void PubSubCommand(
+      const RedisCommandInfo& info,
+      size_t idx,
+      RedisResponsePB (*parse)(const RedisClientCommand&,
+                               RedisInboundCall*,
+                               const std::shared_ptr<RedisPubSub>&),
+      BatchContext* context);
+
   template<class Op>
   void Command(
       const RedisCommandInfo& info,
@@ -686,7 +896,9 @@ class RedisServiceImpl::Impl {
   std::atomic<bool> yb_client_initialized_;
   std::shared_ptr<client::YBClient> client_;
   std::array<SessionPool, 2> session_pools_;
+  ReadCoalescer read_coalescer_;
   std::shared_ptr<client::YBTable> table_;
+  std::shared_ptr<RedisPubSub> pubsub_ = std::make_shared<RedisPubSub>();
 
   RedisServer* server_;
 };
@@ -754,12 +966,88 @@ RedisResponsePB ParseFlushDB(const RedisClientCommand& command) {
   return RedisResponsePB();
 }
 
+// MULTI state is tracked by the connection, see RedisInboundCall::ProcessMulti.
+RedisResponsePB ParseMulti(const RedisClientCommand& command) {
+  return RedisResponsePB();
+}
+
+// Responses of executed commands are combined by RedisInboundCall::Serialize.
+RedisResponsePB ParseExec(const RedisClientCommand& command) {
+  return RedisResponsePB();
+}
+
+RedisResponsePB ParseDiscard(const RedisClientCommand& command) {
+  return RedisResponsePB();
+}
+
+// Reply to SUBSCRIBE/UNSUBSCRIBE about a single channel, null channel when there are no channels.
+std::string EncodeSubscriptionReply(
+    const std::string& kind, const std::string* channel, size_t subscriptions) {
+  return EncodeAsArrayOfEncodedElements(std::initializer_list<std::string>{
+      EncodeAsBulkString(kind).ToBuffer(),
+      channel ? EncodeAsBulkString(*channel).ToBuffer() : kNilResponse,
+      EncodeAsInteger(static_cast<int64_t>(subscriptions)).ToBuffer()});
+}
+
+// Like in Redis, a separate reply is sent for each of the channels.
+RedisResponsePB ParseSubscribe(const RedisClientCommand& command,
+                               RedisInboundCall* call,
+                               const std::shared_ptr<RedisPubSub>& pubsub) {
+  auto& subscriptions = call->connection_context().subscriptions();
+  std::string encoded;
+  for (size_t i = 1; i != command.size(); ++i) {
+    const auto channel = command[i].ToBuffer();
+    const auto count = subscriptions.Subscribe(pubsub, call->connection(), channel);
+    encoded += EncodeSubscriptionReply("subscribe", &channel, count);
+  }
+  RedisResponsePB responsePB;
+  responsePB.set_code(RedisResponsePB_RedisStatusCode_OK);
+  responsePB.set_encoded_response(std::move(encoded));
+  return responsePB;
+}
+
+// UNSUBSCRIBE without arguments unsubscribes the connection from all channels.
+RedisResponsePB ParseUnsubscribe(const RedisClientCommand& command,
+                                 RedisInboundCall* call,
+                                 const std::shared_ptr<RedisPubSub>& pubsub) {
+  auto& subscriptions = call->connection_context().subscriptions();
+  std::vector<std::string> channels;
+  if (command.size() > 1) {
+    for (size_t i = 1; i != command.size(); ++i) {
+      channels.push_back(command[i].ToBuffer());
+    }
+  } else {
+    channels = subscriptions.Channels();
+  }
+  std::string encoded;
+  for (const auto& channel : channels) {
+    encoded += EncodeSubscriptionReply("unsubscribe", &channel, subscriptions.Unsubscribe(channel));
+  }
+  if (channels.empty()) {
+    encoded = EncodeSubscriptionReply("unsubscribe", nullptr, 0);
+  }
+  RedisResponsePB responsePB;
+  responsePB.set_code(RedisResponsePB_RedisStatusCode_OK);
+  responsePB.set_encoded_response(std::move(encoded));
+  return responsePB;
+}
+
+RedisResponsePB ParsePublish(const RedisClientCommand& command,
+                             RedisInboundCall* call,
+                             const std::shared_ptr<RedisPubSub>& pubsub) {
+  RedisResponsePB responsePB;
+  responsePB.set_code(RedisResponsePB_RedisStatusCode_OK);
+  responsePB.set_int_response(pubsub->Publish(command[1].ToBuffer(), command[2].ToBuffer()));
+  return responsePB;
+}
+
 #define REDIS_METRIC(name) \
     BOOST_PP_CAT(METRIC_handler_latency_yb_redisserver_RedisServerService_, name)
 
 #define READ_COMMAND Command<YBRedisReadOp>
 #define WRITE_COMMAND Command<YBRedisWriteOp>
 #define LOCAL_COMMAND LocalCommand
+#define PUBSUB_COMMAND PubSubCommand
 
 #define DO_POPULATE_HANDLER(name, cname, arity, type) \
   { \
@@ -817,6 +1105,9 @@ Status RedisServiceImpl::Impl::SetUpYBClient() {
     client_builder.default_rpc_timeout(MonoDelta::FromSeconds(kRpcTimeoutSec));
     client_builder.add_master_server_addr(yb_tier_master_addresses_);
     client_builder.set_metric_entity(server_->metric_entity());
+    if (server_->tserver() != nullptr && FLAGS_ybclient_use_server_messenger) {
+      client_builder.use_messenger(server_->tserver()->messenger());
+    }
     RETURN_NOT_OK(client_builder.Build(&client_));
 
     // Add proxy to call local tserver if available.
@@ -830,6 +1121,7 @@ Status RedisServiceImpl::Impl::SetUpYBClient() {
 
     session_pools_[0].Init(client_, server_->metric_entity(), false);
     session_pools_[1].Init(client_, server_->metric_entity(), true);
+    read_coalescer_.Init(&session_pools_[1]);
 
     yb_client_initialized_.store(true, std::memory_order_release);
   }
@@ -865,10 +1157,16 @@ void RedisServiceImpl::Impl::Handle(rpc::InboundCallPtr call_ptr) {
   // We process them as follows:
   // Each read commands are processed individually.
   // Sequential write commands use single session and the same batcher.
+  // Commands queued by MULTI are placed to the call of EXEC, so they are processed in one batch.
+  auto* read_coalescer =
+      FLAGS_redis_max_read_rpcs_in_flight_per_tablet > 0 ? &read_coalescer_ : nullptr;
+  auto* keyspace_pubsub = FLAGS_redis_keyspace_notifications ? pubsub_.get() : nullptr;
   auto context = make_scoped_refptr(new BatchContext(client_,
                                                      session_pools_.data(),
+                                                     read_coalescer,
                                                      call,
-                                                     metrics_internal_.data()));
+                                                     metrics_internal_.data(),
+                                                     keyspace_pubsub));
   const auto& batch = call->client_batch();
   for (size_t idx = 0; idx != batch.size(); ++idx) {
     const RedisClientCommand& c = batch[idx];
@@ -889,6 +1187,12 @@ void RedisServiceImpl::Impl::Handle(rpc::InboundCallPtr call_ptr) {
       YB_LOG_EVERY_N_SECS(ERROR, 60) << "Requested command " << c[0]
                                      << " has wrong number of arguments.";
       RespondWithFailure(call, idx, "Wrong number of arguments.");
+    } else if (call->multi_role(idx) == RedisMultiRole::kMisplaced) {
+      RespondWithFailure(call, idx, "Nested MULTI, or EXEC/DISCARD without MULTI.");
+    } else if (call->multi_role(idx) == RedisMultiRole::kQueued) {
+      // Command will be executed by EXEC, that would append it to its own call.
+      RedisResponsePB queued_response;
+      call->RespondSuccess(idx, cmd_info->metrics, &queued_response);
     } else {
       // Handle the call.
       cmd_info->functor(*cmd_info, idx, context.get());
@@ -910,6 +1214,17 @@ void RedisServiceImpl::Impl::LocalCommand(
   VLOG(4) << "Done responding to " << command[0].ToBuffer();
 }
 
+void RedisServiceImpl::Impl::PubSubCommand(
+    const RedisCommandInfo& info,
+    size_t idx,
+    RedisResponsePB (*parse)(const RedisClientCommand&,
+                             RedisInboundCall*,
+                             const std::shared_ptr<RedisPubSub>&),
+    BatchContext* context) {
+  RedisResponsePB response = parse(context->command(idx), context->call().get(), pubsub_);
+  context->call()->RespondSuccess(idx, info.metrics, &response);
+}
+
 template<class Op>
 void RedisServiceImpl::Impl::Command(
     const RedisCommandInfo& info,
@@ -39,6 +39,7 @@ DECLARE_uint64(redis_max_concurrent_commands);
 DECLARE_uint64(redis_max_batch);
 DECLARE_bool(redis_safe_batch);
 DECLARE_bool(emulate_redis_responses);
+DECLARE_int64(redis_ts_block_width);
 
 DEFINE_uint64(test_redis_max_concurrent_commands, 20,
               "Value of redis_max_concurrent_commands for pipeline test");
@@ -714,6 +715,48 @@ TEST_F(TestRedisService, BatchedCommandMultiPartial) {
   }
 }
 
+TEST_F(TestRedisService, MultiExec) {
+  // Commands are queued until EXEC, even when they are received in different calls.
+  SendCommandAndExpectResponse(__LINE__, "multi\r\nset a 1\r\n", "+OK\r\n+QUEUED\r\n");
+  SendCommandAndExpectResponse(__LINE__, "get a\r\nset b 2\r\n", "+QUEUED\r\n+QUEUED\r\n");
+  SendCommandAndExpectResponse(
+      __LINE__, "exec\r\nget b\r\n", "*3\r\n+OK\r\n$1\r\n1\r\n+OK\r\n$1\r\n2\r\n");
+
+  // Whole transaction in a single call, followed by a transaction without commands.
+  SendCommandAndExpectResponse(
+      __LINE__,
+      "multi\r\nset a 3\r\nget a\r\nexec\r\nmulti\r\nexec\r\nget a\r\n",
+      "+OK\r\n+QUEUED\r\n+QUEUED\r\n*2\r\n+OK\r\n$1\r\n3\r\n+OK\r\n*0\r\n$1\r\n3\r\n");
+
+  // Discarded commands are not executed.
+  SendCommandAndExpectResponse(
+      __LINE__, "multi\r\nset a 4\r\ndiscard\r\nget a\r\n", "+OK\r\n+QUEUED\r\n+OK\r\n$1\r\n3\r\n");
+
+  const std::string kError = "-Request was unable to be processed from server.\r\n";
+  SendCommandAndExpectResponse(__LINE__, "exec\r\n", kError);
+  SendCommandAndExpectResponse(__LINE__, "discard\r\n", kError);
+  SendCommandAndExpectResponse(
+      __LINE__, "multi\r\nmulti\r\nexec\r\n", "+OK\r\n" + kError + "*0\r\n");
+}
+
+TEST_F(TestRedisService, PubSub) {
+  SendCommandAndExpectResponse(__LINE__, "publish ch msg\r\n", ":0\r\n");
+  SendCommandAndExpectResponse(
+      __LINE__, "subscribe ch1 ch2\r\n",
+      "*3\r\n$9\r\nsubscribe\r\n$3\r\nch1\r\n:1\r\n*3\r\n$9\r\nsubscribe\r\n$3\r\nch2\r\n:2\r\n");
+  // Message is queued to the subscribed connection before the response to PUBLISH.
+  SendCommandAndExpectResponse(
+      __LINE__, "publish ch1 hello\r\n",
+      "*3\r\n$7\r\nmessage\r\n$3\r\nch1\r\n$5\r\nhello\r\n:1\r\n");
+  SendCommandAndExpectResponse(
+      __LINE__, "unsubscribe ch1\r\n", "*3\r\n$11\r\nunsubscribe\r\n$3\r\nch1\r\n:1\r\n");
+  SendCommandAndExpectResponse(
+      __LINE__, "unsubscribe\r\n", "*3\r\n$11\r\nunsubscribe\r\n$3\r\nch2\r\n:0\r\n");
+  SendCommandAndExpectResponse(
+      __LINE__, "unsubscribe\r\n", "*3\r\n$11\r\nunsubscribe\r\n$-1\r\n:0\r\n");
+  SendCommandAndExpectResponse(__LINE__, "publish ch1 hello\r\n", ":0\r\n");
+}
+
 TEST_F(TestRedisService, IncompleteCommandInline) {
   expected_no_sessions_ = true;
   SendCommandAndExpectTimeout("TEST");
@@ -755,6 +798,9 @@ TEST_F(TestRedisService, BadCommand) {
   TestBadCommand("1\r\n\r\n", this);
   TestBadCommand("1\r\n \r\n", this);
   TestBadCommand("1\r\n*0\r\n", this);
+  TestBadCommand("*1\r\n$3x\r\nfoo\r\n", this);
+  TestBadCommand("*1\r\n$\r\nfoo\r\n", this);
+  TestBadCommand("*1\r\n$1234567890123456789\r\n", this);
 }
 
 TEST_F(TestRedisService, BadRandom) {
@@ -1046,6 +1092,17 @@ TEST_F(TestRedisService, TestTsRangeByTime) {
   SyncClient();
   DoRedisTestArray(__LINE__, {"TSRANGEBYTIME" , "ts_key", "-35", "25"},
                    {"-30", "v3", "-20", "v4", "-10", "v5", "10", "v6", "20", "v7"});
+  DoRedisTestArray(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "-35", "25"},
+                   {"20", "v7", "10", "v6", "-10", "v5", "-20", "v4", "-30", "v3"});
+  DoRedisTestArray(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "-inf", "+inf", "LIMIT", "2"},
+                   {"50", "v10", "40", "v9"});
+  // Next page starts right after the last returned timestamp.
+  DoRedisTestArray(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "-inf", "(40", "LIMIT", "2"},
+                   {"30", "v8", "20", "v7"});
+  DoRedisTestArray(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "(-40", "-10", "LIMIT", "5"},
+                   {"-10", "v5", "-20", "v4", "-30", "v3"});
+  DoRedisTestExpectError(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "1", "2", "LIMIT", "0"});
+  DoRedisTestExpectError(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "1", "2", "LIMIT"});
 
   // Overwrite and test.
   DoRedisTestOk(__LINE__, {"TSADD", "ts_key",
@@ -1194,6 +1251,201 @@ TEST_F(TestRedisService, TestTsRangeByTime) {
   VerifyCallbacks();
 }
 
+TEST_F(TestRedisService, TestSortedSets) {
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "3", "c", "1", "a", "2", "b", "-1.5", "neg"}, 4);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "4", "b", "5", "e"}, 1);
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "CH", "0", "a", "5", "e"}, 1);
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "NX", "10", "a", "6", "f"}, 1);
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "XX", "7", "f", "8", "g"}, 0);
+  SyncClient();
+
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "-inf", "+inf"},
+                   {"neg", "a", "c", "b", "e", "f"});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "0", "4", "WITHSCORES"},
+                   {"a", "0", "c", "3", "b", "4"});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "(0", "(5"}, {"c", "b"});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "-inf", "+inf", "LIMIT", "1", "2"},
+                   {"a", "c"});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "3", "+inf", "LIMIT", "1", "-1"},
+                   {"b", "e", "f"});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "5", "3"}, {});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "z_key", "+inf", "+inf"}, {});
+  DoRedisTestArray(__LINE__, {"ZRANGEBYSCORE", "no_key", "-inf", "+inf"}, {});
+
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "0", "2"}, {"neg", "a", "c"});
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "-2", "-1", "WITHSCORES"},
+                   {"e", "5", "f", "7"});
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "4", "100"}, {"e", "f"});
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "-100", "0"}, {"neg"});
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "3", "1"}, {});
+
+  // Deleted sorted set does not keep its old members.
+  DoRedisTestInt(__LINE__, {"DEL", "z_key"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "1", "x"}, 1);
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"ZRANGE", "z_key", "0", "-1", "WITHSCORES"}, {"x", "1"});
+
+  DoRedisTestOk(__LINE__, {"SET", "key", "value"});
+  SyncClient();
+  DoRedisTestExpectError(__LINE__, {"ZADD", "key", "1", "a"});
+  DoRedisTestExpectError(__LINE__, {"ZRANGE", "key", "0", "1"});
+  DoRedisTestExpectError(__LINE__, {"ZADD", "z_key", "abc", "a"});
+  DoRedisTestExpectError(__LINE__, {"ZADD", "z_key", "1", "a", "2"});
+  DoRedisTestExpectError(__LINE__, {"ZRANGEBYSCORE", "z_key", "a", "1"});
+  DoRedisTestExpectError(__LINE__, {"ZRANGEBYSCORE", "z_key", "0", "1", "LIMIT", "1"});
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestScanCollections) {
+  DoRedisTestOk(__LINE__, {"HMSET", "map_key",
+      "f1", "v1", "f2", "v2", "f3", "v3", "f4", "v4", "f5", "v5"});
+  DoRedisTestInt(__LINE__, {"SADD", "set_key", "m1", "m2", "m3"}, 3);
+  SyncClient();
+
+  // Reads the collection page by page, until the server returns "0" cursor.
+  auto scan = [this](const std::string& command, const std::string& key, int count,
+                     std::vector<std::string>* elements) {
+    std::string cursor = "0";
+    int pages = 0;
+    do {
+      DoRedisTest(__LINE__, {command, key, cursor, "COUNT", std::to_string(count)},
+          cpp_redis::reply::type::array,
+          [&cursor, elements](const RedisReply& reply) {
+            const auto& replies = reply.as_array();
+            ASSERT_EQ(2, replies.size());
+            cursor = replies[0].as_string();
+            for (const auto& element : replies[1].as_array()) {
+              elements->push_back(element.as_string());
+            }
+          });
+      SyncClient();
+      ++pages;
+    } while (cursor != "0" && pages < 10);
+    return pages;
+  };
+
+  std::vector<std::string> elements;
+  ASSERT_EQ(3, scan("HSCAN", "map_key", 2, &elements));
+  ASSERT_EQ((std::vector<std::string>{
+      "f1", "v1", "f2", "v2", "f3", "v3", "f4", "v4", "f5", "v5"}), elements);
+
+  elements.clear();
+  ASSERT_EQ(1, scan("SSCAN", "set_key", 10, &elements));
+  ASSERT_EQ((std::vector<std::string>{"m1", "m2", "m3"}), elements);
+
+  elements.clear();
+  ASSERT_EQ(1, scan("SSCAN", "no_key", 10, &elements));
+  ASSERT_TRUE(elements.empty());
+
+  DoRedisTestExpectError(__LINE__, {"HSCAN", "map_key", "xyz"});
+  DoRedisTestExpectError(__LINE__, {"HSCAN", "map_key", "0", "COUNT", "0"});
+  DoRedisTestExpectError(__LINE__, {"SSCAN", "set_key", "0", "MATCH", "m*"});
+  DoRedisTestExpectError(__LINE__, {"HSCAN", "set_key", "0"});
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestCollectionSize) {
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, 0);
+  DoRedisTestInt(__LINE__, {"SCARD", "set_key"}, 0);
+  SyncClient();
+
+  // Writes to the same key are pipelined, so they could be applied in the same batch.
+  DoRedisTestOk(__LINE__, {"HMSET", "map_key", "f1", "v1", "f2", "v2", "f3", "v3"});
+  DoRedisTestInt(__LINE__, {"HSET", "map_key", "f1", "v11"}, 0);
+  DoRedisTestInt(__LINE__, {"HSET", "map_key", "f4", "v4"}, 1);
+  DoRedisTestInt(__LINE__, {"SADD", "set_key", "m1", "m2"}, 2);
+  DoRedisTestInt(__LINE__, {"SADD", "set_key", "m2", "m3"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, 4);
+  DoRedisTestInt(__LINE__, {"SCARD", "set_key"}, 3);
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"HDEL", "map_key", "f2", "f5"}, 1);
+  DoRedisTestInt(__LINE__, {"SREM", "set_key", "m1", "m2", "m4"}, 2);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, 3);
+  DoRedisTestInt(__LINE__, {"SCARD", "set_key"}, 1);
+  SyncClient();
+
+  // Recreated collection does not inherit the old size.
+  DoRedisTestInt(__LINE__, {"DEL", "set_key"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"SADD", "set_key", "m5"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"SCARD", "set_key"}, 1);
+  DoRedisTestArray(__LINE__, {"SMEMBERS", "set_key"}, {"m5"});
+  DoRedisTestArray(__LINE__, {"HKEYS", "map_key"}, {"f1", "f3", "f4"});
+
+  DoRedisTestExpectError(__LINE__, {"SCARD", "map_key"});
+  DoRedisTestExpectError(__LINE__, {"HLEN", "set_key"});
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestLists) {
+  DoRedisTestInt(__LINE__, {"LLEN", "list_key"}, 0);
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "0", "-1"}, {});
+  DoRedisTestNull(__LINE__, {"LPOP", "list_key"});
+  DoRedisTestInt(__LINE__, {"RPUSHX", "list_key", "a"}, 0);
+  SyncClient();
+
+  // Writes to the same key are pipelined, so they could be applied in the same batch.
+  DoRedisTestInt(__LINE__, {"RPUSH", "list_key", "c", "d"}, 2);
+  DoRedisTestInt(__LINE__, {"LPUSH", "list_key", "b", "a"}, 4);
+  DoRedisTestInt(__LINE__, {"RPUSHX", "list_key", "e"}, 5);
+  DoRedisTestInt(__LINE__, {"LPUSHX", "list_key", "z"}, 6);
+  DoRedisTestBulkString(__LINE__, {"LPOP", "list_key"}, "z");
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"LLEN", "list_key"}, 5);
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "0", "-1"}, {"a", "b", "c", "d", "e"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "1", "2"}, {"b", "c"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "-2", "100"}, {"d", "e"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "-100", "0"}, {"a"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "3", "1"}, {});
+  SyncClient();
+
+  DoRedisTestBulkString(__LINE__, {"RPOP", "list_key"}, "e");
+  DoRedisTestBulkString(__LINE__, {"LPOP", "list_key"}, "a");
+  DoRedisTestBulkString(__LINE__, {"RPOP", "list_key"}, "d");
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "0", "-1"}, {"b", "c"});
+  DoRedisTestBulkString(__LINE__, {"RPOP", "list_key"}, "c");
+  DoRedisTestBulkString(__LINE__, {"RPOP", "list_key"}, "b");
+  SyncClient();
+
+  // Popping the last element deletes the list, so a new one does not inherit the old elements.
+  DoRedisTestNull(__LINE__, {"RPOP", "list_key"});
+  DoRedisTestInt(__LINE__, {"LPUSHX", "list_key", "x"}, 0);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"LPUSH", "list_key", "x"}, 1);
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "0", "-1"}, {"x"});
+  DoRedisTestInt(__LINE__, {"DEL", "list_key"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"RPUSH", "list_key", "y"}, 1);
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"LRANGE", "list_key", "0", "-1"}, {"y"});
+
+  DoRedisTestOk(__LINE__, {"SET", "key", "value"});
+  SyncClient();
+  DoRedisTestExpectError(__LINE__, {"LPUSH", "key", "a"});
+  DoRedisTestExpectError(__LINE__, {"RPOP", "key"});
+  DoRedisTestExpectError(__LINE__, {"LLEN", "key"});
+  DoRedisTestExpectError(__LINE__, {"LRANGE", "key", "0", "-1"});
+  DoRedisTestExpectError(__LINE__, {"GET", "list_key"});
+  DoRedisTestExpectError(__LINE__, {"LRANGE", "list_key", "a", "1"});
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
 TEST_F(TestRedisService, TestTsRem) {
   DoRedisTestOk(__LINE__, {"TSADD", "ts_key",
       "10", "v1",
@@ -1269,6 +1521,55 @@ TEST_F(TestRedisService, TestTsRem) {
   VerifyCallbacks();
 }
 
+TEST_F(TestRedisService, TestTimeSeriesBlocks) {
+  FLAGS_redis_ts_block_width = 25;
+  DoRedisTestOk(__LINE__, {"TSADD", "ts_key",
+      "-30", "v-30",
+      "-5", "v-5",
+      "0", "v0",
+      "10", "v10",
+      "20", "v20",
+      "25", "v25",
+      "60", "v60",
+  });
+  SyncClient();
+  DoRedisTestOk(__LINE__, {"TSADD", "ts_key", "10", "v10b", "49", "v49", int64Max_, "vmax"});
+  SyncClient();
+
+  DoRedisTestBulkString(__LINE__, {"TSGET", "ts_key", "-5"}, "v-5");
+  DoRedisTestBulkString(__LINE__, {"TSGET", "ts_key", "10"}, "v10b");
+  DoRedisTestBulkString(__LINE__, {"TSGET", "ts_key", "49"}, "v49");
+  DoRedisTestBulkString(__LINE__, {"TSGET", "ts_key", int64Max_}, "vmax");
+  DoRedisTestNull(__LINE__, {"TSGET", "ts_key", "11"});
+  DoRedisTestNull(__LINE__, {"TSGET", "ts_key", "50"});
+  DoRedisTestExpectError(__LINE__, {"GET", "ts_key"});
+
+  DoRedisTestArray(__LINE__, {"TSRANGEBYTIME" , "ts_key", "-5", "(25"},
+                   {"-5", "v-5", "0", "v0", "10", "v10b", "20", "v20"});
+  DoRedisTestArray(__LINE__, {"TSRANGEBYTIME" , "ts_key", "(-30", "60"},
+                   {"-5", "v-5", "0", "v0", "10", "v10b", "20", "v20", "25", "v25", "49", "v49",
+                       "60", "v60"});
+  DoRedisTestArray(__LINE__, {"TSREVRANGEBYTIME" , "ts_key", "-inf", "(60", "LIMIT", "3"},
+                   {"49", "v49", "25", "v25", "20", "v20"});
+
+  DoRedisTestOk(__LINE__, {"TSREM", "ts_key", "0", "25", "49", "70"});
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"TSRANGEBYTIME" , "ts_key", "-inf", "100"},
+                   {"-30", "v-30", "-5", "v-5", "10", "v10b", "20", "v20", "60", "v60"});
+
+  // Changing the width affects only new time series.
+  FLAGS_redis_ts_block_width = 0;
+  DoRedisTestOk(__LINE__, {"TSADD", "ts_key", "30", "v30"});
+  DoRedisTestOk(__LINE__, {"TSADD", "ts_other", "30", "v30"});
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"TSRANGEBYTIME" , "ts_key", "10", "30"},
+                   {"10", "v10b", "20", "v20", "30", "v30"});
+  DoRedisTestBulkString(__LINE__, {"TSGET", "ts_other", "30"}, "v30");
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
 TEST_F(TestRedisService, TestAdditionalCommands) {
 
   // The default value is true, but we explicitly set this here for clarity.
@@ -66,12 +66,19 @@ extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits);
 extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                      bool strict_capacity_limit);
 
+// Create a cache of table readers to be shared by multiple DBs with DBOptions::table_cache, that
+// keeps at most capacity table files open. Its SetMetrics instantiates table cache metrics instead
+// of block cache metrics.
+extern shared_ptr<Cache> NewSharedTableCache(size_t capacity, int num_shard_bits);
+
 using QueryId = int64_t;
 // Query ids to represent values for the default query id.
 constexpr QueryId kDefaultQueryId = 0;
 // Query ids to represent values that should be in multi-touch cache.
 constexpr QueryId kInMultiTouchId = -1;
-// Query ids to represent values that should not be in any cache.
+// Query ids to represent values that should not be in any cache. Lookups with this query id
+// don't move values to the multi touch cache, so that readers which don't fill the cache, like
+// compactions and scans with fill_cache == false, don't push hot values out of it.
 constexpr QueryId kNoCacheQueryId = -2;
 
 class Cache {
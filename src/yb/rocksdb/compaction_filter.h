@@ -33,6 +33,7 @@
 namespace rocksdb {
 
 class SliceTransform;
+struct FileMetaData;
 
 // Context information of a compaction run
 struct CompactionFilterContext {
@@ -148,6 +149,31 @@ class CompactionFilterFactory {
   virtual const char* Name() const = 0;
 };
 
+enum class FilterDecision {
+  kKeep,
+  kDiscard,
+};
+
+// Decides about whole SST files using their metadata only. A file is discarded when the compaction
+// filter would remove all of its entries, and removing them could not make older entries visible.
+// Discarded files are deleted without being read or rewritten.
+class CompactionFileFilter {
+ public:
+  virtual ~CompactionFileFilter() {}
+
+  virtual FilterDecision Filter(const FileMetaData* file) = 0;
+};
+
+class CompactionFileFilterFactory {
+ public:
+  virtual ~CompactionFileFilterFactory() {}
+
+  virtual std::unique_ptr<CompactionFileFilter> CreateCompactionFileFilter() = 0;
+
+  // Returns a name that identifies this compaction file filter factory.
+  virtual const char* Name() const = 0;
+};
+
 }  // namespace rocksdb
 
 #endif // ROCKSDB_INCLUDE_ROCKSDB_COMPACTION_FILTER_H
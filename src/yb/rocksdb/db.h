@@ -784,8 +784,29 @@ class DB {
   // and end key
   virtual void GetLiveFilesMetaData(std::vector<LiveFileMetaData>* /*metadata*/) {}
 
+  // Returns the number of level 0 files of the default column family that count towards
+  // level0_slowdown_writes_trigger and level0_stop_writes_trigger. Does not acquire the DB mutex,
+  // so it is cheap enough to throttle writes before they reach the DB.
+  virtual int GetL0DelayTriggerCount() const { return 0; }
+
+  // Loads data blocks of the SST files of the default column family that overlap [begin, end] of
+  // user keys into the block cache and pins them there, for hot key ranges that should not be
+  // evicted. nullptr means unbounded. Pinned blocks are released when the table reader of their
+  // file is closed, e.g. after the file is compacted away.
+  // Requires BlockBasedTableOptions::pinned_blocks_mem_tracker, Incomplete is returned when its
+  // limit is reached.
+  virtual Status PinKeyRange(const Slice* begin, const Slice* end) {
+    return STATUS(NotSupported, "PinKeyRange is not supported");
+  }
+
   virtual OpId GetFlushedOpId() { return OpId(); }
 
+  // Records op_id as flushed without flushing anything, e.g. when the files of the DB were
+  // replaced by a checkpoint as the result of the operation with op_id.
+  virtual CHECKED_STATUS SetFlushedOpId(const OpId& op_id) {
+    return STATUS(NotSupported, "");
+  }
+
   // Obtains the meta data of the specified column family of the DB.
   // STATUS(NotFound, "") will be returned if the current DB does not have
   // any column family match the specified name.
@@ -852,7 +873,7 @@ class DB {
   // Needed for StackableDB
   virtual DB* GetRootDB() { return this; }
 
-  virtual CHECKED_STATUS Import(const std::string& source_dir) {
+  virtual CHECKED_STATUS Import(const std::string& source_dir, const OpId& op_id = OpId()) {
     return STATUS(NotSupported, "");
   }
 
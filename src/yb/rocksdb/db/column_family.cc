@@ -204,7 +204,7 @@ ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
              xf_transaction_clear_memtable_history,
              &result.max_write_buffer_number_to_maintain);
 
-  if (!result.prefix_extractor) {
+  if (!result.prefix_extractor && !result.memtable_prefix_extractor) {
     assert(result.memtable_factory);
     Slice name = result.memtable_factory->Name();
     if (name.compare("HashSkipListRepFactory") == 0 ||
@@ -576,6 +576,7 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
     auto write_controller = column_family_set_->write_controller_;
     uint64_t compaction_needed_bytes =
         vstorage->estimated_compaction_needed_bytes();
+    l0_delay_trigger_count_.store(vstorage->l0_delay_trigger_count(), std::memory_order_release);
 
     if (imm()->NumNotFlushed() >= mutable_cf_options.max_write_buffer_number) {
       write_controller_token_ = write_controller->GetStopToken();
@@ -337,6 +337,12 @@ class ColumnFamilyData {
   void RecalculateWriteStallConditions(
       const MutableCFOptions& mutable_cf_options);
 
+  // Number of level 0 files that count towards write stall triggers, as of the last
+  // RecalculateWriteStallConditions. Does not require DB mutex.
+  int l0_delay_trigger_count() const {
+    return l0_delay_trigger_count_.load(std::memory_order_acquire);
+  }
+
  private:
   friend class ColumnFamilySet;
   ColumnFamilyData(uint32_t id, const std::string& name,
@@ -407,6 +413,8 @@ class ColumnFamilyData {
   bool pending_compaction_;
 
   uint64_t prev_compaction_needed_bytes_;
+
+  std::atomic<int> l0_delay_trigger_count_{0};
 };
 
 // ColumnFamilySet has interesting thread-safety requirements
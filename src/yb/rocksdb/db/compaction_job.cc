@@ -30,6 +30,7 @@
 #include <inttypes.h>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <vector>
 #include <memory>
 #include <list>
@@ -53,6 +54,7 @@
 #include "yb/rocksdb/port/port.h"
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/env.h"
+#include "yb/rocksdb/slice_transform.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/status.h"
 #include "yb/rocksdb/table.h"
@@ -408,6 +410,24 @@ void CompactionJob::GenSubcompactionBoundaries() {
     }
   }
 
+  // Move the boundaries to the start of their prefixes, so keys sharing a prefix are processed by
+  // the same subcompaction and its compaction filter.
+  const SliceTransform* boundary_extractor = cfd->ioptions()->subcompaction_boundary_extractor;
+  if (boundary_extractor != nullptr) {
+    // Reserve upfront, so bounds could refer to the stored keys.
+    boundary_keys_.reserve(bounds.size());
+    for (auto& bound : bounds) {
+      const Slice user_key = ExtractUserKey(bound);
+      if (!boundary_extractor->InDomain(user_key)) {
+        continue;
+      }
+      const InternalKey prefix_key(
+          boundary_extractor->Transform(user_key), kMaxSequenceNumber, kValueTypeForSeek);
+      boundary_keys_.push_back(prefix_key.Encode().ToString());
+      bound = boundary_keys_.back();
+    }
+  }
+
   std::sort(bounds.begin(), bounds.end(),
     [cfd_comparator] (const Slice& a, const Slice& b) -> bool {
       return cfd_comparator->Compare(ExtractUserKey(a), ExtractUserKey(b)) < 0;
@@ -439,9 +459,15 @@ void CompactionJob::GenSubcompactionBoundaries() {
 
   // Group the ranges into subcompactions
   const double min_file_fill_percent = 4.0 / 5;
+  const MutableCFOptions* mutable_cf_options = cfd->GetCurrentMutableCFOptions();
+  uint64_t max_output_file_size = mutable_cf_options->MaxFileSizeForLevel(out_lvl);
+  if (max_output_file_size == std::numeric_limits<uint64_t>::max()) {
+    // Universal compaction doesn't limit the size of level 0 files, so use the base target file
+    // size as the smallest size worth a subcompaction.
+    max_output_file_size = std::max<uint64_t>(mutable_cf_options->target_file_size_base, 1);
+  }
   uint64_t max_output_files = static_cast<uint64_t>(std::ceil(
-      sum / min_file_fill_percent /
-      cfd->GetCurrentMutableCFOptions()->MaxFileSizeForLevel(out_lvl)));
+      sum / min_file_fill_percent / max_output_file_size));
   uint64_t subcompactions =
       std::min({static_cast<uint64_t>(ranges.size()),
                 static_cast<uint64_t>(db_options_.max_subcompactions),
@@ -979,7 +1005,8 @@ void CompactionJob::RecordCompactionIOStats() {
 Status CompactionJob::OpenFile(const std::string table_name, uint64_t file_number,
     const std::string file_type_label, const std::string fname,
     std::unique_ptr<WritableFile>* writable_file) {
-  Status s = NewWritableFile(env_, fname, writable_file, env_options_);
+  Status s = NewWritableFile(
+      env_, fname, writable_file, env_->OptimizeForCompactionTableWrite(env_options_, db_options_));
   if (!s.ok()) {
     RLOG(InfoLogLevel::ERROR_LEVEL, db_options_.info_log,
         "[%s] [JOB %d] OpenCompactionOutputFiles for table #%" PRIu64
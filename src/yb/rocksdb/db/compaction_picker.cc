@@ -35,6 +35,7 @@
 
 #include <gflags/gflags.h>
 
+#include "yb/rocksdb/compaction_filter.h"
 #include "yb/rocksdb/db/column_family.h"
 #include "yb/rocksdb/db/filename.h"
 #include "yb/rocksdb/util/log_buffer.h"
@@ -1146,7 +1147,65 @@ bool LevelCompactionPicker::PickCompactionBySize(VersionStorageInfo* vstorage,
 bool UniversalCompactionPicker::NeedsCompaction(
     const VersionStorageInfo* vstorage) const {
   const int kLevel0 = 0;
-  return vstorage->CompactionScore(kLevel0) >= 1;
+  return vstorage->CompactionScore(kLevel0) >= 1 || NumDiscardedOldestFiles(*vstorage, 1) != 0 ||
+         !vstorage->FilesMarkedForCompaction().empty();
+}
+
+size_t UniversalCompactionPicker::NumDiscardedOldestFiles(
+    const VersionStorageInfo& vstorage, size_t max_files) const {
+  if (ioptions_.compaction_file_filter_factory == nullptr) {
+    return 0;
+  }
+  // Files of other levels are older than level 0 files.
+  for (int level = 1; level < vstorage.num_levels(); level++) {
+    if (vstorage.NumLevelFiles(level) != 0) {
+      return 0;
+    }
+  }
+  const std::vector<FileMetaData*>& level_files = vstorage.LevelFiles(0);
+  if (level_files.empty()) {
+    return 0;
+  }
+  auto filter = ioptions_.compaction_file_filter_factory->CreateCompactionFileFilter();
+  size_t result = 0;
+  // Level 0 files are sorted from the newest to the oldest.
+  for (auto it = level_files.rbegin(); it != level_files.rend() && result < max_files; ++it) {
+    const FileMetaData* file = *it;
+    if (file->being_compacted || filter->Filter(file) != FilterDecision::kDiscard) {
+      break;
+    }
+    ++result;
+  }
+  return result;
+}
+
+Compaction* UniversalCompactionPicker::PickDiscardedFilesCompaction(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage, LogBuffer* log_buffer) {
+  const int kLevel0 = 0;
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(kLevel0);
+  const size_t num_files = NumDiscardedOldestFiles(*vstorage, level_files.size());
+  if (num_files == 0) {
+    return nullptr;
+  }
+
+  std::vector<CompactionInputFiles> inputs(1);
+  inputs[0].level = kLevel0;
+  for (auto it = level_files.rbegin(); inputs[0].files.size() != num_files; ++it) {
+    FileMetaData* f = *it;
+    inputs[0].files.push_back(f);
+    char tmp_fsize[16];
+    AppendHumanBytes(f->fd.GetTotalFileSize(), tmp_fsize, sizeof(tmp_fsize));
+    LOG_TO_BUFFER(log_buffer, "[%s] Universal: picking discarded file %" PRIu64
+                              " with size %s for deletion",
+                  cf_name.c_str(), f->fd.GetNumber(), tmp_fsize);
+  }
+  Compaction* c = new Compaction(
+      vstorage, mutable_cf_options, std::move(inputs), kLevel0, 0, 0, 0,
+      kNoCompression, {}, /* is manual */ false, vstorage->CompactionScore(kLevel0),
+      /* is deletion compaction */ true, CompactionReason::kUniversalDiscardedFiles);
+  level0_compactions_in_progress_.insert(c);
+  return c;
 }
 
 struct UniversalCompactionPicker::SortedRun {
@@ -1160,6 +1219,18 @@ struct UniversalCompactionPicker::SortedRun {
     assert(compensated_file_size > 0);
     // Allowed either one of level and file.
     assert((level != 0) != (file != nullptr));
+    if (file != nullptr) {
+      files.push_back(file);
+    }
+  }
+
+  // Adds level 0 file that forms a single sorted run with the files of this run.
+  void AddFile(FileMetaData* f) {
+    assert(level == 0);
+    files.push_back(f);
+    size += f->fd.GetTotalFileSize();
+    compensated_file_size += f->compensated_file_size;
+    being_compacted = being_compacted || f->being_compacted;
   }
 
   void Dump(char* out_buf, size_t out_buf_size,
@@ -1171,8 +1242,10 @@ struct UniversalCompactionPicker::SortedRun {
 
   int level;
   // `file` Will be null for level > 0. For level = 0, the sorted run is
-  // for this file.
+  // for this file, and `files` are all files of the sorted run starting with it. There are
+  // several files when they are outputs of a compaction with subcompactions.
   FileMetaData* file;
+  std::vector<FileMetaData*> files;
   // For level > 0, `size` and `compensated_file_size` are sum of sizes all
   // files in the level. `being_compacted` should be the same for all files
   // in a non-zero level. Use the value here.
@@ -1207,8 +1280,7 @@ void UniversalCompactionPicker::SortedRun::DumpSizeInfo(
              "file %" PRIu64 "[%" ROCKSDB_PRIszt
              "] "
              "with size %" PRIu64 " (compensated size %" PRIu64 ")",
-             file->fd.GetNumber(), sorted_run_count, file->fd.GetTotalFileSize(),
-             file->compensated_file_size);
+             file->fd.GetNumber(), sorted_run_count, size, compensated_file_size);
   } else {
     snprintf(out_buf, out_buf_size,
              "level %d[%" ROCKSDB_PRIszt
@@ -1225,7 +1297,12 @@ std::vector<std::vector<UniversalCompactionPicker::SortedRun>>
   std::vector<std::vector<SortedRun>> ret(1);
   for (FileMetaData* f : vstorage.LevelFiles(0)) {
     if (f->fd.GetTotalFileSize() <= max_file_size) {
-      ret.back().emplace_back(0, f, f->fd.GetTotalFileSize(), f->compensated_file_size,
+      auto& runs = ret.back();
+      if (!runs.empty() && vstorage.IsSameSortedRun(*runs.back().files.back(), *f)) {
+        runs.back().AddFile(f);
+        continue;
+      }
+      runs.emplace_back(0, f, f->fd.GetTotalFileSize(), f->compensated_file_size,
           f->being_compacted);
     // If last sequence is empty it means that there are multiple too-large-to-compact files in
     // a row. So we just don't start new sequence in this case.
@@ -1351,11 +1428,27 @@ Compaction* UniversalCompactionPicker::PickCompaction(
     const MutableCFOptions& mutable_cf_options,
     VersionStorageInfo* vstorage,
     LogBuffer* log_buffer) {
+  // Deleting whole files is cheaper than any compaction, so check it first.
+  Compaction* discarded_files_compaction = PickDiscardedFilesCompaction(
+      cf_name, mutable_cf_options, vstorage, log_buffer);
+  if (discarded_files_compaction != nullptr) {
+    return discarded_files_compaction;
+  }
+
   std::vector<std::vector<SortedRun>> sorted_runs = CalculateSortedRuns(
       *vstorage,
       ioptions_,
       mutable_cf_options.max_file_size_for_compaction);
 
+  // Files marked for compaction slow down reads, so compact them before looking at file sizes.
+  for (const auto& block : sorted_runs) {
+    Compaction* result = PickMarkedFilesCompaction(
+        cf_name, mutable_cf_options, vstorage, block, log_buffer);
+    if (result != nullptr) {
+      return result;
+    }
+  }
+
   for (const auto& block : sorted_runs) {
     Compaction* result = DoPickCompaction(cf_name, mutable_cf_options, vstorage, log_buffer, block);
     if (result != nullptr) {
@@ -1365,6 +1458,73 @@ Compaction* UniversalCompactionPicker::PickCompaction(
   return nullptr;
 }
 
+Compaction* UniversalCompactionPicker::PickMarkedFilesCompaction(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage, const std::vector<SortedRun>& sorted_runs,
+    LogBuffer* log_buffer) {
+  if (sorted_runs.size() < 2) {
+    return nullptr;
+  }
+  bool has_marked_files = false;
+  for (size_t i = 0; i != sorted_runs.size(); ++i) {
+    const SortedRun& sr = sorted_runs[i];
+    if (sr.being_compacted) {
+      return nullptr;
+    }
+    if (i + 1 == sorted_runs.size()) {
+      break;
+    }
+    const std::vector<FileMetaData*>& files =
+        sr.level == 0 ? sr.files : vstorage->LevelFiles(sr.level);
+    for (const FileMetaData* f : files) {
+      has_marked_files = has_marked_files || f->marked_for_compaction;
+    }
+  }
+  if (!has_marked_files) {
+    return nullptr;
+  }
+
+  uint64_t estimated_total_size = 0;
+  for (const SortedRun& sr : sorted_runs) {
+    estimated_total_size += sr.size;
+  }
+  uint32_t path_id = GetPathId(ioptions_, estimated_total_size);
+  int start_level = sorted_runs.front().level;
+
+  std::vector<CompactionInputFiles> inputs(vstorage->num_levels());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs[i].level = start_level + static_cast<int>(i);
+  }
+  for (size_t loop = 0; loop < sorted_runs.size(); loop++) {
+    auto& picking_sr = sorted_runs[loop];
+    if (picking_sr.level == 0) {
+      inputs[0].files.insert(
+          inputs[0].files.end(), picking_sr.files.begin(), picking_sr.files.end());
+    } else {
+      auto& files = inputs[picking_sr.level - start_level].files;
+      for (auto* f : vstorage->LevelFiles(picking_sr.level)) {
+        files.push_back(f);
+      }
+    }
+    char file_num_buf[256];
+    picking_sr.DumpSizeInfo(file_num_buf, sizeof(file_num_buf), loop);
+    LOG_TO_BUFFER(log_buffer, "[%s] Universal: marked files picking %s",
+                  cf_name.c_str(), file_num_buf);
+  }
+
+  Compaction* c = new Compaction(
+      vstorage, mutable_cf_options, std::move(inputs),
+      vstorage->num_levels() - 1,
+      mutable_cf_options.MaxFileSizeForLevel(vstorage->num_levels() - 1),
+      /* max_grandparent_overlap_bytes */ LLONG_MAX, path_id,
+      GetCompressionType(ioptions_, vstorage->num_levels() - 1, 1),
+      /* grandparents */ {}, /* is manual */ false, vstorage->CompactionScore(0),
+      false /* deletion_compaction */,
+      CompactionReason::kFilesMarkedForCompaction);
+  level0_compactions_in_progress_.insert(c);
+  return c;
+}
+
 Compaction* UniversalCompactionPicker::DoPickCompaction(
     const std::string& cf_name,
     const MutableCFOptions& mutable_cf_options,
@@ -1451,14 +1611,17 @@ Compaction* UniversalCompactionPicker::DoPickCompaction(
 
   size_t level_index = 0U;
   if (c->start_level() == 0) {
+    const FileMetaData* prev_file = nullptr;
     for (auto f : *c->inputs(0)) {
       assert(f->smallest.seqno <= f->largest.seqno);
       if (is_first) {
         is_first = false;
       } else {
-        assert(prev_smallest_seqno > f->largest.seqno);
+        assert(prev_smallest_seqno > f->largest.seqno ||
+               vstorage->IsSameSortedRun(*prev_file, *f));
       }
       prev_smallest_seqno = f->smallest.seqno;
+      prev_file = f;
     }
     level_index = 1U;
   }
@@ -1686,8 +1849,8 @@ Compaction* UniversalCompactionPicker::PickCompactionUniversalReadAmp(
   for (size_t i = start_index; i < first_index_after; i++) {
     auto& picking_sr = sorted_runs[i];
     if (picking_sr.level == 0) {
-      FileMetaData* picking_file = picking_sr.file;
-      inputs[0].files.push_back(picking_file);
+      inputs[0].files.insert(
+          inputs[0].files.end(), picking_sr.files.begin(), picking_sr.files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage->LevelFiles(picking_sr.level)) {
@@ -1812,8 +1975,8 @@ Compaction* UniversalCompactionPicker::PickCompactionUniversalSizeAmp(
   for (size_t loop = start_index; loop < sorted_runs.size(); loop++) {
     auto& picking_sr = sorted_runs[loop];
     if (picking_sr.level == 0) {
-      FileMetaData* f = picking_sr.file;
-      inputs[0].files.push_back(f);
+      inputs[0].files.insert(
+          inputs[0].files.end(), picking_sr.files.begin(), picking_sr.files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage->LevelFiles(picking_sr.level)) {
@@ -266,6 +266,26 @@ class UniversalCompactionPicker : public CompactionPicker {
       LogBuffer* log_buffer,
       const std::vector<SortedRun>& sorted_runs);
 
+  // Pick a deletion compaction of the oldest files that are discarded by the compaction file
+  // filter.
+  Compaction* PickDiscardedFilesCompaction(
+      const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+      VersionStorageInfo* vstorage, LogBuffer* log_buffer);
+
+  // Returns the number of the oldest files, up to max_files, that could be deleted because they
+  // are discarded by the compaction file filter. Deleting only the oldest files guarantees that
+  // no older entries they hide could become visible.
+  size_t NumDiscardedOldestFiles(const VersionStorageInfo& vstorage, size_t max_files) const;
+
+  // Pick a compaction of all sorted runs when a run other than the oldest one has files marked
+  // for compaction, e.g. because they are dense with tombstones, which only a compaction of all
+  // files could drop. Marked files of the oldest run are ignored, since it is usually the output
+  // of such a compaction, and its remaining tombstones are still needed.
+  Compaction* PickMarkedFilesCompaction(
+      const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+      VersionStorageInfo* vstorage, const std::vector<SortedRun>& sorted_runs,
+      LogBuffer* log_buffer);
+
   // Pick Universal compaction to limit read amplification
   Compaction* PickCompactionUniversalReadAmp(
       const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
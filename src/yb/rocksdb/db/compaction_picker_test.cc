@@ -21,8 +21,10 @@
 #include "yb/rocksdb/db/compaction.h"
 #include "yb/rocksdb/db/compaction_picker.h"
 #include <limits>
+#include <set>
 #include <string>
 #include <utility>
+#include "yb/rocksdb/compaction_filter.h"
 
 #include "yb/rocksdb/util/logging.h"
 #include "yb/rocksdb/util/string_util.h"
@@ -474,6 +476,137 @@ TEST_F(CompactionPickerTest, AllowsTrivialMoveUniversal) {
   ASSERT_TRUE(compaction->is_trivial_move());
 }
 
+// Outputs of a compaction with subcompactions have overlapping sequence number ranges and
+// non-overlapping key ranges, they are a single sorted run and should be compacted together.
+TEST_F(CompactionPickerTest, UniversalSubcompactionOutputsFormSortedRun) {
+  const uint64_t kFileSize = 100000;
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(1, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize * 2, 0, 500, 550);
+  Add(0, 3U, "150", "300", kFileSize, 0, 320, 440);
+  Add(0, 2U, "100", "149", kFileSize, 0, 300, 450);
+  Add(0, 4U, "100", "300", kFileSize * 100, 0, 100, 200);
+  UpdateVersionStorageInfo();
+  ASSERT_EQ(3, vstorage_->l0_delay_trigger_count());
+  ASSERT_TRUE(vstorage_->IsSameSortedRun(*file_map_[3U].first, *file_map_[2U].first));
+  ASSERT_FALSE(vstorage_->IsSameSortedRun(*file_map_[1U].first, *file_map_[3U].first));
+  ASSERT_FALSE(vstorage_->IsSameSortedRun(*file_map_[2U].first, *file_map_[4U].first));
+
+  std::unique_ptr<Compaction> compaction(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction != nullptr);
+  ASSERT_EQ(3U, compaction->num_input_files(0));
+  ASSERT_EQ(1U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(3U, compaction->input(0, 1)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->input(0, 2)->fd.GetNumber());
+}
+
+namespace {
+
+class FileNumberCompactionFileFilter : public CompactionFileFilter {
+ public:
+  explicit FileNumberCompactionFileFilter(const std::set<uint64_t>* discarded)
+      : discarded_(discarded) {}
+
+  FilterDecision Filter(const FileMetaData* file) override {
+    return discarded_->count(file->fd.GetNumber()) ? FilterDecision::kDiscard
+                                                   : FilterDecision::kKeep;
+  }
+
+ private:
+  const std::set<uint64_t>* discarded_;
+};
+
+class FileNumberCompactionFileFilterFactory : public CompactionFileFilterFactory {
+ public:
+  std::unique_ptr<CompactionFileFilter> CreateCompactionFileFilter() override {
+    return std::make_unique<FileNumberCompactionFileFilter>(&discarded);
+  }
+
+  const char* Name() const override { return "FileNumberCompactionFileFilterFactory"; }
+
+  std::set<uint64_t> discarded;
+};
+
+} // namespace
+
+TEST_F(CompactionPickerTest, UniversalDeletesDiscardedOldestFiles) {
+  const uint64_t kFileSize = 100000;
+  FileNumberCompactionFileFilterFactory file_filter_factory;
+  ioptions_.compaction_file_filter_factory = &file_filter_factory;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(1, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(0, 2U, "201", "250", kFileSize, 0, 401, 450);
+  Add(0, 3U, "260", "300", kFileSize, 0, 260, 300);
+  UpdateVersionStorageInfo();
+  ASSERT_LT(vstorage_->CompactionScore(0), 1);
+
+  // Newer files could not be deleted while an older one is kept.
+  file_filter_factory.discarded = {1U};
+  ASSERT_FALSE(universal_compaction_picker.NeedsCompaction(vstorage_.get()));
+  ASSERT_EQ(nullptr, universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+
+  file_filter_factory.discarded = {1U, 2U, 3U};
+  file_map_[3U].first->being_compacted = true;
+  ASSERT_FALSE(universal_compaction_picker.NeedsCompaction(vstorage_.get()));
+  file_map_[3U].first->being_compacted = false;
+
+  file_filter_factory.discarded = {1U, 3U};
+  ASSERT_TRUE(universal_compaction_picker.NeedsCompaction(vstorage_.get()));
+  std::unique_ptr<Compaction> compaction(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction != nullptr);
+  ASSERT_TRUE(compaction->deletion_compaction());
+  ASSERT_EQ(CompactionReason::kUniversalDiscardedFiles, compaction->compaction_reason());
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(3U, compaction->input(0, 0)->fd.GetNumber());
+  universal_compaction_picker.ReleaseCompactionFiles(compaction.get(), Status::OK());
+  file_map_[3U].first->being_compacted = false;
+
+  file_filter_factory.discarded = {2U, 3U};
+  compaction.reset(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction != nullptr);
+  ASSERT_TRUE(compaction->deletion_compaction());
+  ASSERT_EQ(2U, compaction->num_input_files(0));
+  ASSERT_EQ(3U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->input(0, 1)->fd.GetNumber());
+}
+
+TEST_F(CompactionPickerTest, UniversalCompactsMarkedFiles) {
+  const uint64_t kFileSize = 100000;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(1, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(0, 2U, "201", "250", kFileSize, 0, 401, 450);
+  Add(0, 3U, "260", "300", kFileSize, 0, 260, 300);
+  file_map_[3U].first->marked_for_compaction = true;
+  UpdateVersionStorageInfo();
+  ASSERT_LT(vstorage_->CompactionScore(0), 1);
+
+  // The oldest file is usually the output of the previous compaction of all files.
+  ASSERT_TRUE(universal_compaction_picker.NeedsCompaction(vstorage_.get()));
+  ASSERT_EQ(nullptr, universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+
+  file_map_[2U].first->marked_for_compaction = true;
+  UpdateVersionStorageInfo();
+  std::unique_ptr<Compaction> compaction(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction != nullptr);
+  ASSERT_EQ(CompactionReason::kFilesMarkedForCompaction, compaction->compaction_reason());
+  ASSERT_EQ(3U, compaction->num_input_files(0));
+  ASSERT_EQ(1U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(3U, compaction->input(0, 2)->fd.GetNumber());
+  ASSERT_TRUE(compaction->is_full_compaction());
+}
+
 TEST_F(CompactionPickerTest, NeedsCompactionFIFO) {
   NewVersionStorage(1, kCompactionStyleFIFO);
   const int kFileCount =
@@ -115,7 +115,10 @@
 #include "yb/rocksdb/util/thread_status_util.h"
 #include "yb/rocksdb/util/xfunc.h"
 
+#include "yb/util/countdown_latch.h"
 #include "yb/util/debug-util.h"
+#include "yb/util/priority_thread_pool.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_bool(dump_dbimpl_info, false, "Dump RocksDB info during constructor.");
 DEFINE_bool(flush_rocksdb_on_shutdown, true,
@@ -149,6 +152,12 @@ Options SanitizeOptions(const std::string& dbname,
 DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
   DBOptions result = src;
 
+  // Table readers preloaded for "infinite" open files would stay open regardless of the shared
+  // table cache.
+  if (result.table_cache && result.max_open_files == -1) {
+    result.max_open_files = std::numeric_limits<int>::max();
+  }
+
   // result.max_open_files means an "infinite" open files.
   if (result.max_open_files != -1) {
     int max_max_open_files = port::GetMaxOpenFiles();
@@ -205,7 +214,7 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
     result.db_paths.emplace_back(dbname, std::numeric_limits<uint64_t>::max());
   }
 
-  if (result.compaction_readahead_size > 0) {
+  if (result.compaction_readahead_size > 0 || result.use_direct_io_for_compaction_reads) {
     result.new_table_reader_for_compaction_inputs = true;
   }
 
@@ -314,12 +323,16 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       opened_successfully_(false) {
   env_->GetAbsolutePath(dbname, &db_absolute_path_);
 
-  // Reserve ten files or so for other uses and give the rest to TableCache.
-  // Give a large number for setting of "infinite" open files.
-  const int table_cache_size = (db_options_.max_open_files == -1) ?
-        4194304 : db_options_.max_open_files - 10;
-  table_cache_ =
-      NewLRUCache(table_cache_size, db_options_.table_cache_numshardbits);
+  if (db_options_.table_cache) {
+    table_cache_ = NewDBTableCache(db_options_.table_cache);
+  } else {
+    // Reserve ten files or so for other uses and give the rest to TableCache.
+    // Give a large number for setting of "infinite" open files.
+    const int table_cache_size = (db_options_.max_open_files == -1) ?
+          4194304 : db_options_.max_open_files - 10;
+    table_cache_ =
+        NewLRUCache(table_cache_size, db_options_.table_cache_numshardbits);
+  }
 
   versions_.reset(new VersionSet(dbname_, &db_options_, env_options_,
                                  table_cache_.get(), &write_buffer_,
@@ -376,6 +389,10 @@ DBImpl::~DBImpl() {
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
+  if (db_options_.priority_thread_pool_for_compactions_and_flushes) {
+    // Abort callbacks of removed tasks decrement scheduled counters themselves.
+    db_options_.priority_thread_pool_for_compactions_and_flushes->Remove(this);
+  }
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
   int flushes_unscheduled = env_->UnSchedule(this, Env::Priority::HIGH);
   mutex_.Lock();
@@ -1592,7 +1609,7 @@ Status DBImpl::FlushMemTableToOutputFile(
 #ifndef ROCKSDB_LITE
     // may temporarily unlock and lock the mutex.
     NotifyOnFlushCompleted(cfd, &file_meta, mutable_cf_options,
-                           job_context->job_id, flush_job.GetTableProperties());
+                           job_context->job_id, flush_job);
 #endif  // ROCKSDB_LITE
     auto sfm =
         static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
@@ -1628,7 +1645,7 @@ void DBImpl::SetTotalSSTFileSizeTicker() {
 void DBImpl::NotifyOnFlushCompleted(ColumnFamilyData* cfd,
                                     FileMetaData* file_meta,
                                     const MutableCFOptions& mutable_cf_options,
-                                    int job_id, TableProperties prop) {
+                                    int job_id, const FlushJob& flush_job) {
 #ifndef ROCKSDB_LITE
   if (db_options_.listeners.size() == 0U) {
     return;
@@ -1665,7 +1682,10 @@ void DBImpl::NotifyOnFlushCompleted(ColumnFamilyData* cfd,
     info.triggered_writes_stop = triggered_writes_stop;
     info.smallest_seqno = file_meta->smallest.seqno;
     info.largest_seqno = file_meta->largest.seqno;
-    info.table_properties = prop;
+    info.table_properties = flush_job.GetTableProperties();
+    info.elapsed_micros = flush_job.elapsed_micros();
+    info.input_bytes = flush_job.input_bytes();
+    info.output_bytes = file_meta->fd.GetTotalFileSize();
     for (auto listener : db_options_.listeners) {
       listener->OnFlushCompleted(this, info);
     }
@@ -2597,7 +2617,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
          bg_flush_scheduled_ < db_options_.max_background_flushes) {
     unscheduled_flushes_--;
     bg_flush_scheduled_++;
-    env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::HIGH, this);
+    ScheduleFlush(Env::Priority::HIGH);
   }
 
   auto bg_compactions_allowed = BGCompactionsAllowed();
@@ -2610,7 +2630,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
                bg_compactions_allowed) {
       unscheduled_flushes_--;
       bg_flush_scheduled_++;
-      env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::LOW, this);
+      ScheduleFlush(Env::Priority::LOW);
     }
   }
 
@@ -2626,9 +2646,92 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     ca->m = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
-    env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
-                   &DBImpl::UnscheduleCallback);
+    ScheduleCompaction(ca);
+  }
+}
+
+namespace {
+
+// Flushes release memory and are required to unblock writes, so they go before compactions.
+// Work of DBs with stopped or delayed writes goes first.
+constexpr int kFlushPriorityBonus = 1 << 10;
+constexpr int kDelayedWritesPriorityBonus = 1 << 20;
+constexpr int kStoppedWritesPriorityBonus = 1 << 21;
+
+} // namespace
+
+int DBImpl::BackgroundWorkPriority(bool flush) {
+  mutex_.AssertHeld();
+
+  int result = 0;
+  if (write_controller_.IsStopped()) {
+    result += kStoppedWritesPriorityBonus;
+  } else if (write_controller_.NeedsDelay()) {
+    result += kDelayedWritesPriorityBonus;
+  }
+  if (flush) {
+    result += kFlushPriorityBonus;
+  }
+  // Within the same class, prefer DBs with more pending immutable memtables for flushes, and more
+  // L0 files for compactions, since they are the closest to a write stall.
+  int max_pending = 0;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    int pending = flush ? cfd->imm()->NumNotFlushed()
+                        : cfd->current()->storage_info()->l0_delay_trigger_count();
+    max_pending = std::max(max_pending, pending);
   }
+  return result + std::min(max_pending, kFlushPriorityBonus - 1);
+}
+
+void DBImpl::ScheduleFlush(Env::Priority env_priority) {
+  mutex_.AssertHeld();
+  // Tasks in the priority thread pool are not preempted, so flushes that have dedicated threads
+  // don't go there, otherwise they could wait behind long running compactions of other DBs.
+  // Only flushes that share threads with compactions are submitted to it.
+  auto* pool = env_priority == Env::Priority::LOW
+      ? db_options_.priority_thread_pool_for_compactions_and_flushes.get() : nullptr;
+  if (pool) {
+    auto status = pool->Submit(
+        BackgroundWorkPriority(true /* flush */), this,
+        [this] { BGWorkFlush(this); },
+        [this] {
+          InstrumentedMutexLock lock(&mutex_);
+          --bg_flush_scheduled_;
+          bg_cv_.SignalAll();
+        });
+    if (status.ok()) {
+      return;
+    }
+    RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+         "Failed to submit flush to priority thread pool: %s", status.ToString().c_str());
+  }
+  env_->Schedule(&DBImpl::BGWorkFlush, this, env_priority, this);
+}
+
+void DBImpl::ScheduleCompaction(void* compaction_arg) {
+  mutex_.AssertHeld();
+  auto* pool = db_options_.priority_thread_pool_for_compactions_and_flushes.get();
+  if (pool) {
+    auto status = pool->Submit(
+        BackgroundWorkPriority(false /* flush */), this,
+        [compaction_arg] { BGWorkCompaction(compaction_arg); },
+        [this, compaction_arg] {
+          UnscheduleCallback(compaction_arg);
+          InstrumentedMutexLock lock(&mutex_);
+          --bg_compaction_scheduled_;
+          bg_cv_.SignalAll();
+        });
+    if (status.ok()) {
+      return;
+    }
+    RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+         "Failed to submit compaction to priority thread pool: %s", status.ToString().c_str());
+  }
+  env_->Schedule(&DBImpl::BGWorkCompaction, compaction_arg, Env::Priority::LOW, this,
+                 &DBImpl::UnscheduleCallback);
 }
 
 int DBImpl::BGCompactionsAllowed() const {
@@ -3080,8 +3183,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     // file if there is alive snapshot pointing to it
     assert(c->num_input_files(1) == 0);
     assert(c->level() == 0);
-    assert(c->column_family_data()->ioptions()->compaction_style ==
-           kCompactionStyleFIFO);
+    assert(c->column_family_data()->ioptions()->compaction_style == kCompactionStyleFIFO ||
+           c->column_family_data()->ioptions()->compaction_style == kCompactionStyleUniversal);
 
     compaction_job_stats.num_input_files = c->num_input_files(0);
 
@@ -3564,54 +3667,82 @@ std::vector<Status> DBImpl::MultiGet(
   }
   mutex_.Unlock();
 
-  // Contain a list of merge operations if merge occurs.
-  MergeContext merge_context;
-
   // Note: this always resizes the values array
   size_t num_keys = keys.size();
   std::vector<Status> stat_list(num_keys);
   values->resize(num_keys);
+  // Contain a list of merge operations for each key if merge occurs.
+  std::vector<MergeContext> merge_contexts(num_keys);
 
   // Keep track of bytes that we read for statistics-recording later
   uint64_t bytes_read = 0;
   PERF_TIMER_STOP(get_snapshot_time);
 
+  auto get_super_version = [&multiget_cf_data, &column_family](size_t i) {
+    auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
+    auto mgd_iter = multiget_cf_data.find(cfh->cfd()->GetID());
+    assert(mgd_iter != multiget_cf_data.end());
+    return mgd_iter->second->super_version;
+  };
+
   // For each of the given keys, apply the entire "get" process as follows:
   // First look in the memtable, then in the immutable memtable (if any).
   // s is both in/out. When in, s could either be OK or MergeInProgress.
   // merge_operands will contain the sequence of merges in the latter case.
+  // Keys that are not found in memtables are looked up in SST files afterwards.
+  std::vector<size_t> file_lookups;
+  bool skip_memtable =
+      (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
   for (size_t i = 0; i < num_keys; ++i) {
-    merge_context.Clear();
+    if (skip_memtable) {
+      file_lookups.push_back(i);
+      continue;
+    }
     Status& s = stat_list[i];
     std::string* value = &(*values)[i];
+    LookupKey lkey(keys[i], snapshot);
+    auto super_version = get_super_version(i);
+    // TODO(?): RecordTick(stats_, MEMTABLE_HIT)?
+    if (!super_version->mem->Get(lkey, value, &s, &merge_contexts[i]) &&
+        !super_version->imm->Get(lkey, value, &s, &merge_contexts[i])) {
+      file_lookups.push_back(i);
+    }
+  }
 
+  auto file_lookup = [&](size_t i) {
+    PERF_TIMER_GUARD(get_from_output_files_time);
     LookupKey lkey(keys[i], snapshot);
-    auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
-    auto mgd_iter = multiget_cf_data.find(cfh->cfd()->GetID());
-    assert(mgd_iter != multiget_cf_data.end());
-    auto mgd = mgd_iter->second;
-    auto super_version = mgd->super_version;
-    bool skip_memtable =
-        (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
-    bool done = false;
-    if (!skip_memtable) {
-      if (super_version->mem->Get(lkey, value, &s, &merge_context)) {
-        done = true;
-        // TODO(?): RecordTick(stats_, MEMTABLE_HIT)?
-      } else if (super_version->imm->Get(lkey, value, &s, &merge_context)) {
-        done = true;
-        // TODO(?): RecordTick(stats_, MEMTABLE_HIT)?
+    get_super_version(i)->current->Get(read_options, lkey, &(*values)[i], &stat_list[i],
+                                       &merge_contexts[i]);
+    // TODO(?): RecordTick(stats_, MEMTABLE_MISS)?
+  };
+
+  // Block reads of different keys are independent, so they are issued in parallel when a thread
+  // pool is available. The calling thread takes part in the lookups and waits for the rest.
+  auto* pool = db_options_.multi_get_thread_pool.get();
+  if (pool != nullptr && file_lookups.size() > 1) {
+    yb::CountDownLatch latch(file_lookups.size() - 1);
+    for (size_t j = 1; j < file_lookups.size(); ++j) {
+      const size_t i = file_lookups[j];
+      if (!pool->SubmitFunc([&file_lookup, &latch, i] {
+            file_lookup(i);
+            latch.CountDown();
+          }).ok()) {
+        file_lookup(i);
+        latch.CountDown();
       }
     }
-    if (!done) {
-      PERF_TIMER_GUARD(get_from_output_files_time);
-      super_version->current->Get(read_options, lkey, value, &s,
-                                  &merge_context);
-      // TODO(?): RecordTick(stats_, MEMTABLE_MISS)?
+    file_lookup(file_lookups.front());
+    latch.Wait();
+  } else {
+    for (size_t i : file_lookups) {
+      file_lookup(i);
     }
+  }
 
-    if (s.ok()) {
-      bytes_read += value->size();
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (stat_list[i].ok()) {
+      bytes_read += (*values)[i].size();
     }
   }
 
@@ -4561,8 +4692,6 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     // 3. Deletes or SingleDeletes are not okay if filtering deletes
     //    (controlled by both batch and memtable setting)
     // 4. Merges are not okay
-    // 5. YugaByte-specific user-specified sequence numbers are currently not compatible with
-    //    parallel memtable writes.
     //
     // Rules 1..3 are enforced by checking the options
     // during startup (CheckConcurrentWritesSupported), so if
@@ -4580,6 +4709,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         total_byte_size = WriteBatchInternal::AppendedByteSize(
             total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
         parallel = parallel && !writer->batch->HasMerge();
+        // Writers join the group in the order of their op ids, so the last one has the greatest.
+        last_op_id.UpdateIfGreater(writer->batch->UserOpId());
       }
     }
 
@@ -4595,7 +4726,6 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
     // Reserve sequence numbers for all individual updates in this batch group.
     last_sequence += total_count;
-    last_op_id = my_batch->UserOpId();
 
     // Record statistics
     RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
@@ -5183,7 +5313,7 @@ ColumnFamilyHandle* DBImpl::GetColumnFamilyHandleUnlocked(
   return cf_memtables->GetColumnFamilyHandle();
 }
 
-Status DBImpl::Import(const std::string& source_dir) {
+Status DBImpl::Import(const std::string& source_dir, const OpId& op_id) {
   const auto seqno = versions_->LastSequence();
   FlushOptions options;
   Flush(options);
@@ -5192,6 +5322,9 @@ Status DBImpl::Import(const std::string& source_dir) {
   if (!status.ok()) {
     return status;
   }
+  if (op_id) {
+    edit.SetFlushedOpId(op_id);
+  }
   auto cfd = versions_->GetColumnFamilySet()->GetDefault();
   InstrumentedMutexLock lock(&mutex_);
   status = versions_->LogAndApply(cfd, *cfd->GetCurrentMutableCFOptions(), &edit, &mutex_);
@@ -5435,6 +5568,27 @@ void DBImpl::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
   versions_->GetLiveFilesMetaData(metadata);
 }
 
+int DBImpl::GetL0DelayTriggerCount() const {
+  return default_cf_handle_ != nullptr ? default_cf_handle_->cfd()->l0_delay_trigger_count() : 0;
+}
+
+Status DBImpl::PinKeyRange(const Slice* begin, const Slice* end) {
+  auto cfd = default_cf_handle_->cfd();
+
+  mutex_.Lock();
+  auto version = cfd->current();
+  version->Ref();
+  mutex_.Unlock();
+
+  auto s = version->PinKeyRange(begin, end);
+
+  mutex_.Lock();
+  version->Unref();
+  mutex_.Unlock();
+
+  return s;
+}
+
 OpId DBImpl::GetFlushedOpId() {
   InstrumentedMutexLock l(&mutex_);
   auto result = versions_->FlushedOpId();
@@ -5448,11 +5602,21 @@ OpId DBImpl::GetFlushedOpId() {
       }
     }
     DCHECK_LE(last_op_id.index, result.index) << "Live files meta data: " << ToString(files);
-    result = last_op_id;
+    if (!result) {
+      result = last_op_id;
+    }
   }
   return result;
 }
 
+Status DBImpl::SetFlushedOpId(const OpId& op_id) {
+  VersionEdit edit;
+  edit.SetFlushedOpId(op_id);
+  auto cfd = versions_->GetColumnFamilySet()->GetDefault();
+  InstrumentedMutexLock lock(&mutex_);
+  return versions_->LogAndApply(cfd, *cfd->GetCurrentMutableCFOptions(), &edit, &mutex_);
+}
+
 void DBImpl::GetColumnFamilyMetaData(
     ColumnFamilyHandle* column_family,
     ColumnFamilyMetaData* cf_meta) {
@@ -210,7 +210,10 @@ class DBImpl : public DB {
                             const Slice* begin, const Slice* end);
 
   void GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) override;
+  int GetL0DelayTriggerCount() const override;
+  Status PinKeyRange(const Slice* begin, const Slice* end) override;
   OpId GetFlushedOpId() override;
+  CHECKED_STATUS SetFlushedOpId(const OpId& op_id) override;
 
   // Obtains the meta data of the specified column family of the DB.
   // STATUS(NotFound, "") will be returned if the current DB does not have
@@ -450,7 +453,9 @@ class DBImpl : public DB {
   // Checks that source database has appropriate seqno.
   // I.e. seqno ranges of imported database does not overlap with seqno ranges of destination db.
   // And max seqno of imported database is less that active seqno of destination db.
-  CHECKED_STATUS Import(const std::string& source_dir) override;
+  // If op_id is not empty, it is recorded as the flushed op id in the same version edit that adds
+  // the imported files, so the operation that imported them is not replayed after a restart.
+  CHECKED_STATUS Import(const std::string& source_dir, const OpId& op_id = OpId()) override;
 
  protected:
   Env* const env_;
@@ -477,7 +482,7 @@ class DBImpl : public DB {
 
   void NotifyOnFlushCompleted(ColumnFamilyData* cfd, FileMetaData* file_meta,
                               const MutableCFOptions& mutable_cf_options,
-                              int job_id, TableProperties prop);
+                              int job_id, const FlushJob& flush_job);
 
   void NotifyOnCompactionCompleted(ColumnFamilyData* cfd,
                                    Compaction *c, const Status &st,
@@ -594,6 +599,12 @@ class DBImpl : public DB {
   static void BGWorkCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void UnscheduleCallback(void* arg);
+  // Schedule background flush or compaction, using the priority thread pool from options when
+  // it is specified, or Env background threads otherwise.
+  void ScheduleFlush(Env::Priority env_priority);
+  void ScheduleCompaction(void* compaction_arg);
+  // Priority of background work of this DB in the shared priority thread pool.
+  int BackgroundWorkPriority(bool flush);
   void BackgroundCallCompaction(void* arg);
   void BackgroundCallFlush();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
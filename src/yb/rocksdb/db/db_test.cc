@@ -58,6 +58,7 @@
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/perf_context.h"
 #include "yb/util/slice.h"
+#include "yb/util/threadpool.h"
 #include "yb/rocksdb/slice_transform.h"
 #include "yb/rocksdb/snapshot.h"
 #include "yb/rocksdb/sst_file_writer.h"
@@ -5059,6 +5060,44 @@ TEST_F(DBTest, MultiGetSimple) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBTest, MultiGetThreadPool) {
+  std::unique_ptr<yb::ThreadPool> pool;
+  ASSERT_OK(yb::ThreadPoolBuilder("multi-get").set_max_threads(4).Build(&pool));
+  Options options = CurrentOptions();
+  options.multi_get_thread_pool = std::move(pool);
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 100;
+  std::vector<std::string> key_strings;
+  for (int i = 0; i != kNumKeys; ++i) {
+    key_strings.push_back(Key(i));
+    ASSERT_OK(Put(key_strings.back(), "v" + ToString(i)));
+    // Spread the keys over several SST files and keep a few of them in the memtable.
+    if (i % 30 == 29) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Delete(Key(10)));
+  key_strings.push_back("no_key");
+
+  std::vector<Slice> keys(key_strings.begin(), key_strings.end());
+  std::vector<std::string> values;
+  std::vector<Status> s = db_->MultiGet(ReadOptions(), keys, &values);
+  ASSERT_EQ(keys.size(), s.size());
+  ASSERT_EQ(keys.size(), values.size());
+  for (int i = 0; i != kNumKeys; ++i) {
+    if (i == 10) {
+      ASSERT_TRUE(s[i].IsNotFound());
+    } else {
+      ASSERT_OK(s[i]);
+      ASSERT_EQ("v" + ToString(i), values[i]);
+    }
+  }
+  ASSERT_TRUE(s[kNumKeys].IsNotFound());
+
+  options.multi_get_thread_pool->Shutdown();
+}
+
 TEST_F(DBTest, MultiGetEmpty) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -7833,6 +7872,49 @@ TEST_F(DBTest, RowCache) {
 }
 #endif  // ROCKSDB_LITE
 
+TEST_F(DBTest, SharedTableCache) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.table_cache = NewSharedTableCache(10, 0);
+  DestroyAndReopen(options);
+
+  const std::string other_dbname = dbname_ + "_other";
+  ASSERT_OK(DestroyDB(other_dbname, options));
+  DB* other_db = nullptr;
+  ASSERT_OK(DB::Open(options, other_dbname, &other_db));
+  std::unique_ptr<DB> other_db_holder(other_db);
+
+  // The SST files of both DBs have the same numbers.
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(other_db->Put(WriteOptions(), "foo", "v2"));
+  ASSERT_OK(other_db->Flush(FlushOptions()));
+  ASSERT_OK(Put("bar", "v3"));
+  ASSERT_OK(Flush());
+
+  std::string value;
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v3", Get("bar"));
+  ASSERT_OK(other_db->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("v2", value);
+  ASSERT_EQ(3U, options.table_cache->GetUsage());
+
+  // Table readers of a closed DB are erased from the shared cache.
+  other_db_holder.reset();
+  ASSERT_EQ(2U, options.table_cache->GetUsage());
+
+  // The least recently used table readers are closed to stay within the capacity.
+  options.table_cache->SetCapacity(1);
+  const uint64_t opens = TestGetTickerCount(options, NO_FILE_OPENS);
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v3", Get("bar"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(1U, options.table_cache->GetUsage());
+  ASSERT_GT(TestGetTickerCount(options, NO_FILE_OPENS), opens);
+
+  ASSERT_OK(DestroyDB(other_dbname, options));
+}
+
 // TODO(3.13): fix the issue of Seek() + Prev() which might not necessary
 //             return the biggest key which is smaller than the seek key.
 TEST_F(DBTest, PrevAfterMerge) {
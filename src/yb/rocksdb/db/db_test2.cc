@@ -72,6 +72,110 @@ TEST_F(DBTest2, IteratorPropertyVersionNumber) {
   delete iter2;
   delete iter3;
 }
+
+namespace {
+
+class RejectingReadFileFilter : public ReadFileFilter {
+ public:
+  bool Filter(const FdWithBoundaries& file) const override {
+    ++num_calls;
+    return false;
+  }
+
+  mutable int num_calls = 0;
+};
+
+} // namespace
+
+TEST_F(DBTest2, GetSkipsFilteredFiles) {
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("k2", "v2"));
+
+  auto filter = std::make_shared<RejectingReadFileFilter>();
+  ReadOptions read_options;
+  read_options.file_filter = filter;
+  std::string value;
+  ASSERT_TRUE(db_->Get(read_options, "k1", &value).IsNotFound());
+  ASSERT_EQ(1, filter->num_calls);
+  // The memtable isn't affected by the file filter.
+  ASSERT_OK(db_->Get(read_options, "k2", &value));
+  ASSERT_EQ("v2", value);
+
+  ASSERT_EQ("v1", Get("k1"));
+}
+
+TEST_F(DBTest2, MemTablePrefixExtractor) {
+  Options options = CurrentOptions();
+  options.memtable_prefix_extractor.reset(NewFixedPrefixTransform(3));
+  options.memtable_factory.reset(NewHashSkipListRepFactory(16));
+  DestroyAndReopen(options);
+  ASSERT_EQ(nullptr, dbfull()->GetOptions().prefix_extractor);
+  ASSERT_STREQ("HashSkipListRepFactory", dbfull()->GetOptions().memtable_factory->Name());
+
+  ASSERT_OK(Put("aaa1", "v1"));
+  ASSERT_OK(Put("bbb1", "v2"));
+  ASSERT_OK(Put("aaa2", "v3"));
+  ASSERT_EQ("v1", Get("aaa1"));
+  ASSERT_EQ("v3", Get("aaa2"));
+
+  // Prefix iteration over the memtable stays within the prefix of the seek key.
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("aaa");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("aaa1", iter->key().ToString());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("aaa2", iter->key().ToString());
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+  }
+
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("ccc1", "v4"));
+
+  // Total order iteration sees all keys, both from the memtable and from the SST file, which is
+  // not affected by the memtable prefix extractor.
+  ReadOptions read_options;
+  read_options.total_order_seek = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  std::vector<std::string> keys;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    keys.push_back(iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ((std::vector<std::string>{"aaa1", "aaa2", "bbb1", "ccc1"}), keys);
+}
+
+TEST_F(DBTest2, MemTablePrefixBloom) {
+  Options options = CurrentOptions();
+  options.memtable_prefix_extractor.reset(NewFixedPrefixTransform(3));
+  options.memtable_prefix_bloom_bits = 8 * 1024;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("aaa1", "v1"));
+  ASSERT_OK(Put("aaa2", "v2"));
+
+  // A seek into a prefix that is not in the memtable skips it.
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek("bbb");
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_EQ(1, TestGetTickerCount(options, BLOOM_MEMTABLE_MISS));
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOOM_MEMTABLE_HIT));
+
+  iter->Seek("aaa");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("aaa1", iter->key().ToString());
+  ASSERT_EQ(1, TestGetTickerCount(options, BLOOM_MEMTABLE_HIT));
+
+  ASSERT_EQ("NOT_FOUND", Get("ccc1"));
+  ASSERT_EQ(2, TestGetTickerCount(options, BLOOM_MEMTABLE_MISS));
+  ASSERT_EQ("v2", Get("aaa2"));
+  ASSERT_EQ(2, TestGetTickerCount(options, BLOOM_MEMTABLE_HIT));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -1270,6 +1270,56 @@ TEST_P(DBTestUniversalCompaction, UniversalCompactionSecondPathRatio) {
   Destroy(options);
 }
 
+// Subcompactions of a single level universal compaction don't split keys sharing a prefix
+// extracted by the subcompaction boundary extractor.
+TEST_P(DBTestUniversalCompaction, SubcompactionBoundaryExtractor) {
+  if (num_levels_ != 1) {
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  options.max_subcompactions = 4;
+  options.target_file_size_base = 1 << 10;
+  options.level0_file_num_compaction_trigger = 10;
+  options.subcompaction_boundary_extractor.reset(NewFixedPrefixTransform(2));
+  DestroyAndReopen(options);
+
+  // 50 keys per prefix, file boundaries are in the middle of prefixes.
+  auto key = [](int index) {
+    return ToString(10 + index / 50) + ToString(100 + index % 50);
+  };
+  Random rnd(301);
+  std::map<std::string, std::string> values;
+  for (int file = 0; file < 4; ++file) {
+    for (int i = file * 250 + 25; i < file * 250 + 325; ++i) {
+      values[key(i)] = RandomString(&rnd, 100);
+      ASSERT_OK(Put(key(i), values[key(i)]));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  CompactRangeOptions compact_options;
+  compact_options.exclusive_manual_compaction = exclusive_manual_compaction_;
+  ASSERT_OK(db_->CompactRange(compact_options, nullptr, nullptr));
+
+  std::vector<LiveFileMetaData> metadata;
+  db_->GetLiveFilesMetaData(&metadata);
+  ASSERT_GT(metadata.size(), size_t(1));
+  std::vector<std::pair<std::string, std::string>> prefix_ranges;
+  for (const auto& file : metadata) {
+    prefix_ranges.emplace_back(file.smallest.key.substr(0, 2), file.largest.key.substr(0, 2));
+  }
+  std::sort(prefix_ranges.begin(), prefix_ranges.end());
+  for (size_t i = 1; i < prefix_ranges.size(); ++i) {
+    ASSERT_LT(prefix_ranges[i - 1].second, prefix_ranges[i].first);
+  }
+
+  for (const auto& key_and_value : values) {
+    ASSERT_EQ(key_and_value.second, Get(key_and_value.first));
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(UniversalCompactionNumLevels, DBTestUniversalCompaction,
                         ::testing::Combine(::testing::Values(1, 3, 5),
                                            ::testing::Bool()));
@@ -408,6 +408,19 @@ class IterKey {
 
   bool IsKeyPinned() const { return (key_ != buf_); }
 
+  // Returns the buffer of the key, copying the key to it if it is pinned, so bytes of the key could
+  // be updated in place. This function is used in BlockIter::ParseNextKey.
+  char* GetMutableKey() {
+    if (IsKeyPinned()) {
+      const size_t size = key_size_;
+      EnlargeBufferIfNeeded(size);
+      memcpy(buf_, key_, size);
+      key_ = buf_;
+      key_size_ = size;
+    }
+    return buf_;
+  }
+
   void SetInternalKey(const Slice& key_prefix, const Slice& user_key,
                       SequenceNumber s,
                       ValueType value_type = kValueTypeForSeek) {
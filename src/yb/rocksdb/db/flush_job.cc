@@ -237,6 +237,7 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
                          << total_num_entries << "num_deletes"
                          << total_num_deletes << "memory_usage"
                          << total_memory_usage;
+    input_bytes_ = total_memory_usage;
 
     TableFileCreationInfo info;
     {
@@ -318,6 +319,7 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
 
   InternalStats::CompactionStats stats(1);
   stats.micros = db_options_.env->NowMicros() - start_micros;
+  elapsed_micros_ = stats.micros;
   stats.bytes_written = meta->fd.GetTotalFileSize();
   cfd_->internal_stats()->AddCompactionStats(0 /* level */, stats);
   cfd_->internal_stats()->AddCFStats(InternalStats::BYTES_FLUSHED,
@@ -82,6 +82,10 @@ class FlushJob {
 
   Status Run(FileMetaData* file_meta = nullptr);
   TableProperties GetTableProperties() const { return table_properties_; }
+  // Time it took to write the flushed memtables to the level 0 file.
+  uint64_t elapsed_micros() const { return elapsed_micros_; }
+  // Approximate memory used by the flushed memtables.
+  uint64_t input_bytes() const { return input_bytes_; }
 
  private:
   void ReportStartedFlush();
@@ -107,6 +111,8 @@ class FlushJob {
   Statistics* stats_;
   EventLogger* event_logger_;
   TableProperties table_properties_;
+  uint64_t elapsed_micros_ = 0;
+  uint64_t input_bytes_ = 0;
 };
 
 }  // namespace rocksdb
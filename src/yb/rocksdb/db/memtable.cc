@@ -68,6 +68,15 @@ MemTableOptions::MemTableOptions(
     merge_operator(ioptions.merge_operator),
     info_log(ioptions.info_log) {}
 
+namespace {
+
+const SliceTransform* MemTablePrefixExtractor(const ImmutableCFOptions& ioptions) {
+  return ioptions.memtable_prefix_extractor != nullptr ? ioptions.memtable_prefix_extractor
+                                                       : ioptions.prefix_extractor;
+}
+
+} // namespace
+
 MemTable::MemTable(const InternalKeyComparator& cmp,
                    const ImmutableCFOptions& ioptions,
                    const MutableCFOptions& mutable_cf_options,
@@ -79,7 +88,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       arena_(moptions_.arena_block_size, 0),
       allocator_(&arena_, write_buffer),
       table_(ioptions.memtable_factory->CreateMemTableRep(
-          comparator_, &allocator_, ioptions.prefix_extractor,
+          comparator_, &allocator_, MemTablePrefixExtractor(ioptions),
           ioptions.info_log)),
       data_size_(0),
       num_entries_(0),
@@ -93,7 +102,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       locks_(moptions_.inplace_update_support
                  ? moptions_.inplace_update_num_locks
                  : 0),
-      prefix_extractor_(ioptions.prefix_extractor),
+      prefix_extractor_(MemTablePrefixExtractor(ioptions)),
       flush_state_(FLUSH_NOT_REQUESTED),
       env_(ioptions.env) {
   UpdateFlushState();
@@ -236,6 +245,7 @@ class MemTableIterator : public InternalIterator {
       const MemTable& mem, const ReadOptions& read_options, Arena* arena)
       : bloom_(nullptr),
         prefix_extractor_(mem.prefix_extractor_),
+        statistics_(mem.moptions_.statistics),
         valid_(false),
         arena_mode_(arena != nullptr) {
     if (prefix_extractor_ != nullptr && !read_options.total_order_seek) {
@@ -262,10 +272,12 @@ class MemTableIterator : public InternalIterator {
       if (!bloom_->MayContain(
               prefix_extractor_->Transform(ExtractUserKey(k)))) {
         PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+        RecordTick(statistics_, BLOOM_MEMTABLE_MISS);
         valid_ = false;
         return;
       } else {
         PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
+        RecordTick(statistics_, BLOOM_MEMTABLE_HIT);
       }
     }
     iter_->Seek(k, nullptr);
@@ -319,6 +331,7 @@ class MemTableIterator : public InternalIterator {
  private:
   DynamicBloom* bloom_;
   const SliceTransform* const prefix_extractor_;
+  Statistics* const statistics_;
   MemTableRep::Iterator* iter_;
   bool valid_;
   bool arena_mode_;
@@ -598,10 +611,12 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s,
   if (prefix_bloom_ && !may_contain) {
     // iter is null if prefix bloom says the key does not exist
     PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+    RecordTick(moptions_.statistics, BLOOM_MEMTABLE_MISS);
     *seq = kMaxSequenceNumber;
   } else {
     if (prefix_bloom_) {
       PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
+      RecordTick(moptions_.statistics, BLOOM_MEMTABLE_HIT);
     }
     Saver saver;
     saver.status = s;
@@ -824,6 +839,18 @@ void MemTable::SetLastOpId(const OpId& op_id) {
   }
 }
 
+void MemTable::UpdateLastOpIdIfGreater(const OpId& op_id) {
+  OpId old_value = last_op_id_.load(std::memory_order_acquire);
+  while (old_value.term <= op_id.term && old_value.index < op_id.index) {
+    if (last_op_id_.compare_exchange_weak(old_value,
+                                          op_id,
+                                          std::memory_order_release,
+                                          std::memory_order_acquire)) {
+      return;
+    }
+  }
+}
+
 void MemTableRep::Get(const LookupKey& k, void* callback_args,
                       bool (*callback_func)(void* arg, const char* entry)) {
   auto iter = GetDynamicPrefixIterator();
@@ -323,6 +323,9 @@ class MemTable {
   const MemTableOptions* GetMemTableOptions() const { return &moptions_; }
 
   void SetLastOpId(const OpId& op_id);
+  // Same as SetLastOpId, but op_id is allowed to be less than the current last op id. Used when
+  // batches of a write group are inserted concurrently, so they could arrive out of order.
+  void UpdateLastOpIdIfGreater(const OpId& op_id);
   OpId LastOpId() const { return last_op_id_.load(std::memory_order_acquire); }
 
  private:
@@ -23,6 +23,10 @@
 
 #include "yb/rocksdb/db/table_cache.h"
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
 #include "yb/rocksdb/db/dbformat.h"
 #include "yb/rocksdb/db/filename.h"
 #include "yb/rocksdb/db/version_edit.h"
@@ -39,7 +43,18 @@
 #include "yb/rocksdb/util/stop_watch.h"
 #include "yb/rocksdb/util/sync_point.h"
 
+#include "yb/gutil/bind.h"
 #include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+
+METRIC_DEFINE_counter(server, table_cache_reader_opens,
+                      "Table Cache Reader Opens", yb::MetricUnit::kEntries,
+                      "Number of table readers opened because they were not in the table cache "
+                      "shared by the tablets");
+METRIC_DEFINE_gauge_uint64(server, table_cache_open_readers,
+                           "Table Cache Open Readers", yb::MetricUnit::kEntries,
+                           "Number of table readers, and so of open table files, in the table "
+                           "cache shared by the tablets");
 
 namespace rocksdb {
 
@@ -103,7 +118,7 @@ void TableCache::ReleaseHandle(Cache::Handle* handle) {
 namespace {
 
 Status NewFileReader(const ImmutableCFOptions& ioptions, const EnvOptions& env_options,
-    const std::string& fname, bool sequential_mode, bool record_read_stats,
+    const std::string& fname, uint64_t file_size, bool sequential_mode, bool record_read_stats,
     HistogramImpl* file_read_hist, std::unique_ptr<RandomAccessFileReader>* file_reader) {
   unique_ptr<RandomAccessFile> file;
 
@@ -114,7 +129,10 @@ Status NewFileReader(const ImmutableCFOptions& ioptions, const EnvOptions& env_o
   RecordTick(ioptions.statistics, NO_FILE_OPENS);
 
   if (sequential_mode && ioptions.compaction_readahead_size > 0) {
-    file = NewReadaheadRandomAccessFile(std::move(file), ioptions.compaction_readahead_size);
+    // There is no point in a readahead buffer larger than the file.
+    const size_t readahead_size = static_cast<size_t>(std::min<uint64_t>(
+        ioptions.compaction_readahead_size, std::max<uint64_t>(file_size, 1)));
+    file = NewReadaheadRandomAccessFile(std::move(file), readahead_size);
   }
   if (!sequential_mode && ioptions.advise_random_on_open) {
     file->Hint(RandomAccessFile::RANDOM);
@@ -142,8 +160,8 @@ Status TableCache::GetTableReader(
   Status s;
   {
     unique_ptr<RandomAccessFileReader> base_file_reader;
-    s = NewFileReader(ioptions_, env_options, base_fname, sequential_mode, record_read_stats,
-        file_read_hist, &base_file_reader);
+    s = NewFileReader(ioptions_, env_options, base_fname, fd.GetBaseFileSize(), sequential_mode,
+        record_read_stats, file_read_hist, &base_file_reader);
     if (!s.ok()) {
       return s;
     }
@@ -158,7 +176,8 @@ Status TableCache::GetTableReader(
   if ((*table_reader)->IsSplitSst()) {
     const std::string data_fname = TableBaseToDataFileName(base_fname);
     std::unique_ptr<RandomAccessFileReader> data_file_reader;
-    s = NewFileReader(ioptions_, env_options, data_fname, sequential_mode, record_read_stats,
+    s = NewFileReader(ioptions_, env_options, data_fname,
+        fd.GetTotalFileSize() - fd.GetBaseFileSize(), sequential_mode, record_read_stats,
         file_read_hist, &data_file_reader);
     if (!s.ok()) {
       return s;
@@ -436,6 +455,25 @@ Status TableCache::GetTableProperties(
   return s;
 }
 
+Status TableCache::Pin(
+    const EnvOptions& env_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    const Slice* begin, const Slice* end) {
+  auto table_reader = fd.table_reader;
+  if (table_reader) {
+    return table_reader->Pin(begin, end);
+  }
+
+  Cache::Handle* table_handle = nullptr;
+  Status s = FindTable(env_options, internal_comparator, fd, &table_handle, kDefaultQueryId);
+  if (!s.ok()) {
+    return s;
+  }
+  s = GetTableReaderFromHandle(table_handle)->Pin(begin, end);
+  ReleaseHandle(table_handle);
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator,
@@ -463,4 +501,164 @@ void TableCache::Evict(Cache* cache, uint64_t file_number) {
   cache->Erase(GetSliceForFileNumber(&file_number));
 }
 
+namespace {
+
+// Cache that forwards everything to another cache.
+class ForwardingCache : public Cache {
+ public:
+  explicit ForwardingCache(std::shared_ptr<Cache> target) : target_(std::move(target)) {}
+
+  Status Insert(const Slice& key, const QueryId query_id, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value), Handle** handle,
+                Statistics* statistics) override {
+    return target_->Insert(key, query_id, value, charge, deleter, handle, statistics);
+  }
+
+  Handle* Lookup(const Slice& key, const QueryId query_id, Statistics* statistics) override {
+    return target_->Lookup(key, query_id, statistics);
+  }
+
+  void Release(Handle* handle) override { target_->Release(handle); }
+  void* Value(Handle* handle) override { return target_->Value(handle); }
+  void Erase(const Slice& key) override { target_->Erase(key); }
+  uint64_t NewId() override { return target_->NewId(); }
+  void SetCapacity(size_t capacity) override { target_->SetCapacity(capacity); }
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override {
+    target_->SetStrictCapacityLimit(strict_capacity_limit);
+  }
+
+  bool HasStrictCapacityLimit() const override { return target_->HasStrictCapacityLimit(); }
+  size_t GetCapacity() const override { return target_->GetCapacity(); }
+  size_t GetUsage() const override { return target_->GetUsage(); }
+  size_t GetUsage(Handle* handle) const override { return target_->GetUsage(handle); }
+  size_t GetPinnedUsage() const override { return target_->GetPinnedUsage(); }
+  SubCacheType GetSubCacheType(Handle* e) const override { return target_->GetSubCacheType(e); }
+
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t), bool thread_safe) override {
+    target_->ApplyToAllCacheEntries(callback, thread_safe);
+  }
+
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) override {
+    target_->SetMetrics(entity);
+  }
+
+ protected:
+  const std::shared_ptr<Cache> target_;
+};
+
+// Table readers are inserted into the cache only when they are opened.
+class SharedTableCache : public ForwardingCache {
+ public:
+  SharedTableCache(size_t capacity, int num_shard_bits)
+      : ForwardingCache(NewLRUCache(capacity, num_shard_bits)) {}
+
+  Status Insert(const Slice& key, const QueryId query_id, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value), Handle** handle,
+                Statistics* statistics) override {
+    if (reader_opens_) {
+      reader_opens_->Increment();
+    }
+    return target_->Insert(key, query_id, value, charge, deleter, handle, statistics);
+  }
+
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) override {
+    reader_opens_ = METRIC_table_cache_reader_opens.Instantiate(entity);
+    METRIC_table_cache_open_readers.InstantiateFunctionGauge(
+        entity, yb::Bind(&SharedTableCache::OpenReaders, yb::Unretained(this)))
+        ->AutoDetach(&metric_detacher_);
+  }
+
+ private:
+  uint64_t OpenReaders() { return target_->GetUsage(); }
+
+  scoped_refptr<yb::Counter> reader_opens_;
+  yb::FunctionGaugeDetacher metric_detacher_;
+};
+
+// The part of a shared table cache used by a DB. Keys, i.e. file numbers, are prefixed with an id
+// unique in the shared cache, and the table readers of the DB are erased from the shared cache when
+// the DB is closed, because they reference the options of the DB.
+class DBTableCache : public ForwardingCache {
+ public:
+  explicit DBTableCache(std::shared_ptr<Cache> shared_cache)
+      : ForwardingCache(std::move(shared_cache)) {
+    PutVarint64(&prefix_, target_->NewId());
+  }
+
+  ~DBTableCache() {
+    std::unordered_set<std::string> keys;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      keys.swap(keys_);
+    }
+    for (const auto& key : keys) {
+      target_->Erase(key);
+    }
+  }
+
+  Status Insert(const Slice& key, const QueryId query_id, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value), Handle** handle,
+                Statistics* statistics) override {
+    std::string prefixed_key = prefix_;
+    prefixed_key.append(key.cdata(), key.size());
+    {
+      // Readers evicted by the shared cache stay here until the DB closes or erases them, so there
+      // are at most as many keys as table files of the DB.
+      std::lock_guard<std::mutex> lock(mutex_);
+      keys_.insert(prefixed_key);
+    }
+    return target_->Insert(prefixed_key, query_id, value, charge, deleter, handle, statistics);
+  }
+
+  Handle* Lookup(const Slice& key, const QueryId query_id, Statistics* statistics) override {
+    return WithPrefix(key, [this, query_id, statistics](const Slice& prefixed_key) {
+      return target_->Lookup(prefixed_key, query_id, statistics);
+    });
+  }
+
+  void Erase(const Slice& key) override {
+    WithPrefix(key, [this](const Slice& prefixed_key) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys_.erase(prefixed_key.ToBuffer());
+      }
+      target_->Erase(prefixed_key);
+      return true;
+    });
+  }
+
+  // The capacity and metrics belong to the shared cache.
+  void SetCapacity(size_t capacity) override {}
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override {}
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) override {}
+
+ private:
+  // Calls f with the prefixed key, without allocating memory for keys of file numbers.
+  template <class F>
+  auto WithPrefix(const Slice& key, const F& f) -> decltype(f(key)) {
+    char buffer[kMaxVarint64Length + sizeof(uint64_t)];
+    if (prefix_.size() + key.size() > sizeof(buffer)) {
+      return f(prefix_ + key.ToBuffer());
+    }
+    memcpy(buffer, prefix_.data(), prefix_.size());
+    memcpy(buffer + prefix_.size(), key.data(), key.size());
+    return f(Slice(buffer, prefix_.size() + key.size()));
+  }
+
+  std::string prefix_;
+  std::mutex mutex_;
+  std::unordered_set<std::string> keys_;
+};
+
+} // namespace
+
+std::shared_ptr<Cache> NewDBTableCache(std::shared_ptr<Cache> shared_cache) {
+  return std::make_shared<DBTableCache>(std::move(shared_cache));
+}
+
+std::shared_ptr<Cache> NewSharedTableCache(size_t capacity, int num_shard_bits) {
+  return std::make_shared<SharedTableCache>(capacity, num_shard_bits);
+}
+
 }  // namespace rocksdb
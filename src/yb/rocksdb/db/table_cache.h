@@ -134,6 +134,13 @@ class TableCache {
 
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
+  // Loads data blocks of the table overlapping [begin, end] of internal keys into the block cache
+  // and pins them there, see TableReader::Pin.
+  Status Pin(const EnvOptions& toptions,
+             const InternalKeyComparator& internal_comparator,
+             const FileDescriptor& file_meta,
+             const Slice* begin, const Slice* end);
+
   size_t GetMemoryUsageByTableReader(
       const EnvOptions& toptions,
       const InternalKeyComparator& internal_comparator,
@@ -169,6 +176,10 @@ class TableCache {
   std::string row_cache_id_;
 };
 
+// Returns the cache in which a DB keeps its table readers when they are cached in shared_cache,
+// created with NewSharedTableCache and shared by multiple DBs.
+std::shared_ptr<Cache> NewDBTableCache(std::shared_ptr<Cache> shared_cache);
+
 }  // namespace rocksdb
 
 #endif // YB_ROCKSDB_DB_TABLE_CACHE_H
@@ -683,6 +683,30 @@ Status Version::GetPropertiesOfTablesInRange(
   return Status::OK();
 }
 
+Status Version::PinKeyRange(const Slice* begin, const Slice* end) const {
+  std::unique_ptr<InternalKey> k1, k2;
+  if (begin != nullptr) {
+    k1.reset(new InternalKey(*begin, kMaxSequenceNumber, kValueTypeForSeek));
+  }
+  if (end != nullptr) {
+    // Entries of the last user key of the range have lower sequence numbers, so they follow the
+    // seek key for it.
+    k2.reset(new InternalKey(*end, 0, kTypeDeletion));
+  }
+  const Slice k1_encoded = k1 ? k1->Encode() : Slice();
+  const Slice k2_encoded = k2 ? k2->Encode() : Slice();
+  for (int level = 0; level < storage_info_.num_non_empty_levels(); level++) {
+    std::vector<FileMetaData*> files;
+    storage_info_.GetOverlappingInputs(level, k1.get(), k2.get(), &files, -1, nullptr, false);
+    for (const auto& file_meta : files) {
+      RETURN_NOT_OK(cfd_->table_cache()->Pin(
+          vset_->env_options_, cfd_->internal_comparator(), file_meta->fd,
+          k1 ? &k1_encoded : nullptr, k2 ? &k2_encoded : nullptr));
+    }
+  }
+  return Status::OK();
+}
+
 Status Version::GetAggregatedTableProperties(
     std::shared_ptr<const TableProperties>* tp, int level) {
   TablePropertiesCollection props;
@@ -939,6 +963,10 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       user_comparator(), internal_comparator());
   FdWithBoundaries* f = fp.GetNextFile();
   while (f != nullptr) {
+    if (read_options.file_filter && !read_options.file_filter->Filter(*f)) {
+      f = fp.GetNextFile();
+      continue;
+    }
     *status = table_cache_->Get(
         read_options, *internal_comparator(), f->fd, ikey, &get_context,
         cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
@@ -1867,12 +1895,36 @@ uint64_t VersionStorageInfo::MaxBytesForLevel(int level) const {
   return level_max_bytes_[level];
 }
 
+bool VersionStorageInfo::IsSameSortedRun(
+    const FileMetaData& newer, const FileMetaData& older) const {
+  if (older.largest.seqno < newer.smallest.seqno) {
+    return false;
+  }
+  return user_comparator_->Compare(newer.largest.key.user_key(),
+                                   older.smallest.key.user_key()) < 0 ||
+         user_comparator_->Compare(older.largest.key.user_key(),
+                                   newer.smallest.key.user_key()) < 0;
+}
+
 void VersionStorageInfo::CalculateBaseBytes(const ImmutableCFOptions& ioptions,
                                             const MutableCFOptions& options) {
   // Special logic to set number of sorted runs.
   // It is to match the previous behavior when all files are in L0.
   int num_l0_count = 0;
-  if (options.max_file_size_for_compaction == std::numeric_limits<uint64_t>::max()) {
+  if (compaction_style_ == kCompactionStyleUniversal) {
+    // Outputs of a compaction with subcompactions are counted once, as the picker does.
+    const FileMetaData* prev_file = nullptr;
+    for (const auto& file : files_[0]) {
+      if (file->fd.GetTotalFileSize() > options.max_file_size_for_compaction) {
+        prev_file = nullptr;
+        continue;
+      }
+      if (prev_file == nullptr || !IsSameSortedRun(*prev_file, *file)) {
+        ++num_l0_count;
+      }
+      prev_file = file;
+    }
+  } else if (options.max_file_size_for_compaction == std::numeric_limits<uint64_t>::max()) {
     num_l0_count = static_cast<int>(files_[0].size());
   } else {
     for (const auto& file : files_[0]) {
@@ -2089,7 +2141,8 @@ VersionSet::VersionSet(const std::string& dbname, const DBOptions* db_options,
       dbname_(dbname),
       db_options_(db_options),
       env_options_(storage_options),
-      env_options_compactions_(env_options_) {}
+      env_options_compactions_(
+          env_->OptimizeForCompactionTableRead(env_options_, *db_options_)) {}
 
 VersionSet::~VersionSet() {
   // we need to delete column_family_set_ because its destructor depends on
@@ -3479,7 +3532,7 @@ InternalIterator* VersionSet::MakeInputIterator(Compaction* c) {
         // Create concatenating iterator for the files from this level
         list[num++] = NewTwoLevelIterator(
             new LevelFileIteratorState(
-                cfd->table_cache(), read_options, env_options_,
+                cfd->table_cache(), read_options, env_options_compactions_,
                 cfd->internal_comparator(),
                 nullptr /* no per level latency histogram */,
                 true /* for_compaction */, false /* prefix enabled */,
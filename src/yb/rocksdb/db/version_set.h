@@ -210,6 +210,12 @@ class VersionStorageInfo {
   bool HasOverlappingUserKey(const std::vector<FileMetaData*>* inputs,
                              int level);
 
+  // Returns true iff level 0 files newer and older, where older directly follows newer in the
+  // level, form a single sorted run. This is the case for the outputs of a compaction that was
+  // split into subcompactions: their key ranges don't overlap, while their sequence number ranges
+  // do.
+  bool IsSameSortedRun(const FileMetaData& newer, const FileMetaData& older) const;
+
   int num_levels() const { return num_levels_; }
 
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
@@ -502,6 +508,10 @@ class Version {
   Status GetPropertiesOfTablesInRange(const Range* range, std::size_t n,
                                       TablePropertiesCollection* props) const;
 
+  // Pins data blocks of the files of this version overlapping [begin, end] of user keys in the
+  // block cache. nullptr means unbounded.
+  Status PinKeyRange(const Slice* begin, const Slice* end) const;
+
   // REQUIRES: lock is held
   // On success, "tp" will contains the aggregated table property amoug
   // the table properties of all sst files in this version.
@@ -807,8 +817,8 @@ class VersionSet {
   // env options for all reads and writes except compactions
   const EnvOptions& env_options_;
 
-  // env options used for compactions. This is a copy of
-  // env_options_ but with readaheads set to readahead_compactions_.
+  // env options used for compaction inputs. This is a copy of env_options_
+  // optimized by Env::OptimizeForCompactionTableRead().
   const EnvOptions env_options_compactions_;
 
   // No copying allowed
@@ -820,7 +820,11 @@ class MemTableInserter : public WriteBatch::Handler {
     if (!SeekToColumnFamily(0, &seek_status)) {
       return seek_status;
     }
-    cf_mems_->GetMemTable()->SetLastOpId(op_id);
+    if (concurrent_memtable_writes_) {
+      cf_mems_->GetMemTable()->UpdateLastOpIdIfGreater(op_id);
+    } else {
+      cf_mems_->GetMemTable()->SetLastOpId(op_id);
+    }
     return Status::OK();
   }
 
@@ -104,6 +104,12 @@ struct EnvOptions {
   // If true, then use mmap to write data
   bool use_mmap_writes = true;
 
+  // If true, then read data with O_DIRECT, bypassing the OS page cache
+  bool use_direct_reads = false;
+
+  // If true, then write data with O_DIRECT, bypassing the OS page cache
+  bool use_direct_writes = false;
+
   // If false, fallocate() calls are bypassed
   bool allow_fallocate = true;
 
@@ -385,6 +391,18 @@ class Env {
   virtual EnvOptions OptimizeForManifestWrite(const EnvOptions& env_options)
       const;
 
+  // OptimizeForCompactionTableWrite will create a new EnvOptions object that is
+  // a copy of the EnvOptions in the parameters, but is optimized for writing
+  // the output files of compactions.
+  virtual EnvOptions OptimizeForCompactionTableWrite(
+      const EnvOptions& env_options, const DBOptions& db_options) const;
+
+  // OptimizeForCompactionTableRead will create a new EnvOptions object that is
+  // a copy of the EnvOptions in the parameters, but is optimized for reading
+  // the input files of compactions.
+  virtual EnvOptions OptimizeForCompactionTableRead(
+      const EnvOptions& env_options, const DBOptions& db_options) const;
+
   // Returns the status of all threads that belong to the current Env.
   virtual Status GetThreadList(std::vector<ThreadStatus>* thread_list) {
     return STATUS(NotSupported, "Not supported.");
@@ -487,6 +505,10 @@ class RandomAccessFile : public File {
 
   virtual void Hint(AccessPattern pattern) {}
 
+  // Hints that the range from offset to offset+length of this file is about to be read, so the
+  // platform may start reading it in the background. If not supported, this is a noop.
+  virtual void Readahead(uint64_t offset, size_t length) {}
+
   // Remove any kind of caching of data from the offset to offset+length
   // of this file. If the length is 0, then it refers to the end of file.
   // If the system is not caching the file contents, then this is a noop.
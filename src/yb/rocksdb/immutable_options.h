@@ -42,6 +42,8 @@ struct ImmutableCFOptions {
 
   const SliceTransform* prefix_extractor;
 
+  const SliceTransform* memtable_prefix_extractor;
+
   const Comparator* comparator;
 
   MergeOperator* merge_operator;
@@ -50,6 +52,10 @@ struct ImmutableCFOptions {
 
   CompactionFilterFactory* compaction_filter_factory;
 
+  CompactionFileFilterFactory* compaction_file_filter_factory;
+
+  const SliceTransform* subcompaction_boundary_extractor;
+
   bool inplace_update_support;
 
   UpdateStatus (*inplace_callback)(char* existing_value,
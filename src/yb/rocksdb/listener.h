@@ -74,6 +74,8 @@ enum class CompactionReason {
   kManualCompaction,
   // DB::SuggestCompactRange() marked files for compaction
   kFilesMarkedForCompaction,
+  // [Universal] oldest files discarded by the compaction file filter
+  kUniversalDiscardedFiles,
 };
 
 #ifndef ROCKSDB_LITE
@@ -114,6 +116,12 @@ struct FlushJobInfo {
   SequenceNumber largest_seqno;
   // Table properties of the table being flushed
   TableProperties table_properties;
+  // Time it took to write the newly created file.
+  uint64_t elapsed_micros = 0;
+  // Approximate memory used by the flushed memtables.
+  uint64_t input_bytes = 0;
+  // Size of the newly created file.
+  uint64_t output_bytes = 0;
 };
 
 struct CompactionJobInfo {
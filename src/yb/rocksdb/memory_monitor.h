@@ -15,9 +15,11 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include "yb/rocksdb/port/likely.h"
+#include "yb/util/mem_tracker.h"
 
 namespace rocksdb {
 
@@ -25,8 +27,12 @@ namespace rocksdb {
 // callback if the limit is exceeded.
 class MemoryMonitor {
  public:
-  explicit MemoryMonitor(size_t limit, std::function<void()> exceeded_callback)
-    : limit_(limit), exceeded_callback_(std::move(exceeded_callback)) {}
+  // If mem_tracker is specified, the memory of the write buffers is also consumed from it, so it
+  // is accounted for in the MemTracker hierarchy.
+  explicit MemoryMonitor(size_t limit, std::function<void()> exceeded_callback,
+                         std::shared_ptr<yb::MemTracker> mem_tracker = nullptr)
+    : limit_(limit), exceeded_callback_(std::move(exceeded_callback)),
+      mem_tracker_(std::move(mem_tracker)) {}
 
   ~MemoryMonitor() {}
 
@@ -41,6 +47,9 @@ class MemoryMonitor {
   }
 
   void ReservedMem(size_t mem) {
+    if (mem_tracker_) {
+      mem_tracker_->Consume(mem);
+    }
     auto new_value = memory_used_.fetch_add(mem, std::memory_order_release) + mem;
     if (UNLIKELY(Exceeded(new_value))) {
       exceeded_callback_();
@@ -49,6 +58,9 @@ class MemoryMonitor {
 
   void FreedMem(size_t mem) {
     memory_used_.fetch_sub(mem, std::memory_order_relaxed);
+    if (mem_tracker_) {
+      mem_tracker_->Release(mem);
+    }
   }
 
   // No copying allowed
@@ -63,6 +75,7 @@ class MemoryMonitor {
 
   const size_t limit_;
   const std::function<void()> exceeded_callback_;
+  const std::shared_ptr<yb::MemTracker> mem_tracker_;
   std::atomic<size_t> memory_used_ {0};
 
 };
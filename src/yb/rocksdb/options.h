@@ -42,12 +42,18 @@
 #undef max
 #endif
 
+namespace yb {
+class PriorityThreadPool;
+class ThreadPool;
+}
+
 namespace rocksdb {
 
 class BoundaryValuesExtractor;
 class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
+class CompactionFileFilterFactory;
 class Comparator;
 class Env;
 enum InfoLogLevel : unsigned char;
@@ -154,9 +160,22 @@ struct CompressionOptions {
   int window_bits;
   int level;
   int strategy;
-  CompressionOptions() : window_bits(-14), level(-1), strategy(0) {}
-  CompressionOptions(int wbits, int _lev, int _strategy)
-      : window_bits(wbits), level(_lev), strategy(_strategy) {}
+  // Maximum size of the dictionary, that is trained from samples of the data of each table file
+  // and used to compress all its data blocks. Only used with kZSTDNotFinalCompression.
+  // Up to 100 * max_dict_bytes of the first keys and values added to a table are buffered in
+  // memory as samples to train the dictionary.
+  // Default: 0, no dictionary.
+  uint32_t max_dict_bytes;
+  // Number of threads compressing the data blocks of each table file that is being built. With
+  // more than one thread, finished data blocks are compressed by these threads while the thread
+  // building the file writes previously compressed blocks, so that CPU and disk work in parallel.
+  // Default: 1, data blocks are compressed by the thread building the file.
+  uint32_t parallel_threads;
+  CompressionOptions()
+      : window_bits(-14), level(-1), strategy(0), max_dict_bytes(0), parallel_threads(1) {}
+  CompressionOptions(int wbits, int _lev, int _strategy, uint32_t _max_dict_bytes = 0)
+      : window_bits(wbits), level(_lev), strategy(_strategy), max_dict_bytes(_max_dict_bytes),
+        parallel_threads(1) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -256,6 +275,22 @@ struct ColumnFamilyOptions {
   // Default: nullptr
   std::shared_ptr<CompactionFilterFactory> compaction_filter_factory;
 
+  // This is a factory that provides compaction file filter objects which decide whether the oldest
+  // SST files could be deleted as a whole, e.g. because all of their entries have expired.
+  // Only used by universal compaction with all files in level 0. The oldest files that are
+  // discarded by the filter are deleted without being rewritten.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompactionFileFilterFactory> compaction_file_filter_factory;
+
+  // If non-nullptr, the boundaries of subcompactions are moved to the start of the prefix that
+  // this transform extracts from them. So keys sharing a prefix are always processed by the same
+  // subcompaction, and thus by the same compaction filter created by compaction_filter_factory.
+  // Keys that are not in the domain of the transform are used as boundaries as is.
+  //
+  // Default: nullptr
+  std::shared_ptr<const SliceTransform> subcompaction_boundary_extractor;
+
   // -------------------
   // Parameters that affect performance
 
@@ -383,6 +418,15 @@ struct ColumnFamilyOptions {
   // Default: nullptr
   std::shared_ptr<const SliceTransform> prefix_extractor;
 
+  // If non-nullptr, the memtable uses this function instead of prefix_extractor to determine the
+  // prefixes for keys, e.g. for the buckets of a hash based memtable rep. It has no effect on SST
+  // files, so filters and table iterators are not affected. Iterators not created with
+  // total_order_seek only return keys with the same memtable prefix as the seek key from the
+  // memtable. The function must satisfy the same properties as prefix_extractor.
+  //
+  // Default: nullptr
+  std::shared_ptr<const SliceTransform> memtable_prefix_extractor;
+
   // Number of levels for this database
   int num_levels;
 
@@ -1114,6 +1158,29 @@ struct DBOptions {
   // Default: nullptr (disabled)
   std::shared_ptr<MemoryMonitor> memory_monitor;
 
+  // Priority thread pool shared by multiple DBs. When set, automatic compactions are submitted to
+  // this pool instead of Env background threads, so the most urgent background work of all DBs
+  // sharing the pool runs first. Flushes are submitted to it only when max_background_flushes is 0,
+  // i.e. when they would share threads with compactions anyway.
+  //
+  // Default: nullptr (use Env background threads)
+  std::shared_ptr<yb::PriorityThreadPool> priority_thread_pool_for_compactions_and_flushes;
+
+  // Thread pool shared by multiple DBs, used by MultiGet to look up keys that are not in the
+  // memtables in parallel, so the SST block reads of a batch are issued concurrently instead of
+  // one after another.
+  //
+  // Default: nullptr (keys are looked up sequentially by the calling thread)
+  std::shared_ptr<yb::ThreadPool> multi_get_thread_pool;
+
+  // Cache of table readers shared by multiple DBs, created with NewSharedTableCache. When set,
+  // the table files kept open by all the DBs sharing it are bounded by its capacity, and readers
+  // of the least recently used files of any DB are closed first. max_open_files is then only used
+  // to tell whether table readers are preloaded, which is not done when it is -1.
+  //
+  // Default: nullptr (each DB caches max_open_files table readers)
+  std::shared_ptr<Cache> table_cache;
+
   // Specify the file access pattern once a compaction is started.
   // It will be applied to all input files of a compaction.
   // Default: NORMAL
@@ -1307,6 +1374,16 @@ struct DBOptions {
 
   // Max file size for compaction. Supported only for level0 of universal style compactions.
   uint64_t max_file_size_for_compaction = std::numeric_limits<uint64_t>::max();
+
+  // Write the output files of compactions with O_DIRECT, so compactions do not evict the data
+  // read by queries from the OS page cache. The data is written from aligned buffers of up to
+  // writable_file_max_buffer_size bytes. Supported only on Linux, ignored elsewhere.
+  bool use_direct_io_for_compaction_writes = false;
+
+  // Read the input files of compactions with O_DIRECT. Forces
+  // new_table_reader_for_compaction_inputs, and should be used with compaction_readahead_size,
+  // since every read goes to the disk. Supported only on Linux, ignored elsewhere.
+  bool use_direct_io_for_compaction_reads = false;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1470,6 +1547,8 @@ struct ReadOptions {
   // files from being added to MergeIterator. By default doesn't filter files.
   std::shared_ptr<TableAwareReadFileFilter> table_aware_file_filter;
 
+  // Filter for pruning SST files by their boundary values, before their table readers are opened.
+  // Applied to point lookups and to level 0 files of iterators. By default doesn't filter files.
   std::shared_ptr<ReadFileFilter> file_filter;
 
   static const ReadOptions kDefault;
@@ -205,6 +205,24 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_MULTI_TOUCH_BYTES_READ,
   BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE,
 
+  // Number of DocDB seeks that were satisfied by a bounded number of Next() calls.
+  NUMBER_DB_SEEK_AVOIDED_BY_NEXT,
+  // Number of DocDB seeks that had to do an actual Seek() after the Next() calls were exhausted.
+  NUMBER_DB_SEEK_AFTER_NEXTS,
+
+  // Number of DocDB tombstones that hid older values read by an iterator.
+  NUMBER_DOCDB_TOMBSTONES_SKIPPED,
+  // Number of deleted DocDB rows skipped by a row iterator.
+  NUMBER_DOCDB_DELETED_ROWS_SKIPPED,
+
+  // Number of memtable seeks and lookups the memtable prefix bloom filter let through, and of
+  // those it avoided because the prefix of the key is not in the memtable.
+  BLOOM_MEMTABLE_HIT,
+  BLOOM_MEMTABLE_MISS,
+
+  // Number of bytes of data blocks that iterators asked the files to read ahead.
+  BLOCK_READAHEAD_BYTES,
+
   // End of ticker enum.
   TICKER_ENUM_MAX,
 };
@@ -298,7 +316,14 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BLOCK_CACHE_MULTI_TOUCH_HIT, "rocksdb_block_cache_multi_touch_hit"},
     {BLOCK_CACHE_MULTI_TOUCH_ADD, "rocksdb_block_cache_multi_touch_add"},
     {BLOCK_CACHE_MULTI_TOUCH_BYTES_READ, "rocksdb_block_cache_multi_touch_bytes_read"},
-    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"}
+    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"},
+    {NUMBER_DB_SEEK_AVOIDED_BY_NEXT, "rocksdb_number_db_seek_avoided_by_next"},
+    {NUMBER_DB_SEEK_AFTER_NEXTS, "rocksdb_number_db_seek_after_nexts"},
+    {NUMBER_DOCDB_TOMBSTONES_SKIPPED, "rocksdb_number_docdb_tombstones_skipped"},
+    {NUMBER_DOCDB_DELETED_ROWS_SKIPPED, "rocksdb_number_docdb_deleted_rows_skipped"},
+    {BLOOM_MEMTABLE_HIT, "rocksdb_bloom_memtable_hit"},
+    {BLOOM_MEMTABLE_MISS, "rocksdb_bloom_memtable_miss"},
+    {BLOCK_READAHEAD_BYTES, "rocksdb_block_readahead_bytes"}
 };
 
 /**
@@ -42,6 +42,12 @@
 #include "yb/rocksdb/immutable_options.h"
 #include "yb/rocksdb/status.h"
 
+namespace yb {
+
+class MemTracker;
+
+} // namespace yb
+
 namespace rocksdb {
 
 // -- Block-based Table
@@ -63,6 +69,20 @@ enum ChecksumType : char {
   kxxHash = 0x2,
 };
 
+// Encoding of the keys in data blocks of block based tables.
+enum class KeyValueEncodingFormat : uint8_t {
+  // Each key is stored as the size of the prefix shared with the previous key followed by the rest
+  // of the key.
+  kKeyDeltaEncodingSharedPrefix = 1,
+
+  // Same as kKeyDeltaEncodingSharedPrefix, but when a key has the same size as the previous one,
+  // runs of bytes after the shared prefix that are equal to the bytes of the previous key at the
+  // same positions are not stored either. Keys of DocDB records of the same row usually differ
+  // only in the column id, the write id of the hybrid time and the sequence number, while the rest
+  // of the hybrid time and the value type are the same.
+  kKeyDeltaEncodingSharedPrefixAndParts = 2,
+};
+
 // For advanced user only
 struct BlockBasedTableOptions {
   // @flush_block_policy_factory creates the instances of flush block policy.
@@ -90,6 +110,12 @@ struct BlockBasedTableOptions {
     // The hash index, if enabled, will do the hash lookup when
     // `Options.prefix_extractor` is provided.
     kHashSearch,
+
+    // A two-level index: the index is split into partitions of about `index_block_size` bytes
+    // and only a small top-level index block, that maps the last key of each partition to its
+    // block handle, is loaded when the table is opened. Index partitions are read through the
+    // block cache on demand, so they don't have to stay in memory for every open table.
+    kTwoLevelIndexSearch,
   };
 
   IndexType index_type = kBinarySearch;
@@ -100,6 +126,11 @@ struct BlockBasedTableOptions {
   // (less memory consumption)
   bool hash_index_allow_collision = true;
 
+  // Extracts the prefixes kHashSearch indexes the data blocks by. When not set, the
+  // prefix_extractor of the column family is used. Unlike the latter, it only affects the index,
+  // so the filters, the memtables and the iterators of the column family are not prefix based.
+  std::shared_ptr<const SliceTransform> hash_index_prefix_extractor;
+
   // Use the specified checksum type. Newly created table files will be
   // protected with this checksum type. Old table files will still be readable,
   // even though they have different checksum type.
@@ -118,6 +149,13 @@ struct BlockBasedTableOptions {
   // If NULL, rocksdb will not use a compressed block cache.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL, index and filter blocks of opened tables are loaded into the block cache and
+  // pinned there, i.e. referenced by the table reader until the table is closed, so data blocks
+  // don't evict them. Pinned blocks are accounted by this tracker, blocks that do not fit into its
+  // limit are cached as usual. Blocks of hot key ranges pinned through TableReader::Pin are
+  // accounted by it as well. Only used together with cache_index_and_filter_blocks.
+  std::shared_ptr<yb::MemTracker> pinned_blocks_mem_tracker = nullptr;
+
   // Approximate size of user data packed per block, in bytes. Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -129,6 +167,10 @@ struct BlockBasedTableOptions {
   // Size of each filter block, in bytes. Only applicable for fixed size filter block.
   size_t filter_block_size = 64 * 1024;
 
+  // Approximate size of each index partition, in bytes. Only applicable for kTwoLevelIndexSearch
+  // index type.
+  size_t index_block_size = 32 * 1024;
+
   // This is used to close a block before it reaches the configured
   // 'block_size'. If the percentage of free space in the current block is less
   // than this specified number and adding a new record to the block will
@@ -151,6 +193,12 @@ struct BlockBasedTableOptions {
   // Default: true
   bool use_delta_encoding = true;
 
+  // Encoding of the keys in data blocks, only used when use_delta_encoding is true. Index and meta
+  // blocks always use kKeyDeltaEncodingSharedPrefix. The encoding is stored in table properties,
+  // so files written with different encodings can be read.
+  KeyValueEncodingFormat data_block_key_value_encoding_format =
+      KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix;
+
   // If non-nullptr, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
@@ -174,6 +222,13 @@ struct BlockBasedTableOptions {
   // Default: false
   bool skip_table_builder_flush = false;
 
+  // Upper bound of the readahead of the data blocks of a table by an iterator. Once an iterator
+  // has read a few data blocks one after another, it asks the file to read ahead the following
+  // blocks, doubling the readahead on each further block read past the previous readahead up to
+  // this size. A seek to a block that does not follow the previous one stops the readahead.
+  // 0 disables the readahead.
+  size_t max_auto_readahead_size = 256 * 1024;
+
   // We currently have three versions:
   // 0 -- This version is currently written out by all RocksDB's versions by
   // default.  Can be read by really old RocksDB's. Doesn't support changing
@@ -199,6 +254,8 @@ struct BlockBasedTablePropertyNames {
   static const char kWholeKeyFiltering[];
   // value is "1" for true and "0" for false.
   static const char kPrefixFiltering[];
+  // value is a fixed int32 number, KeyValueEncodingFormat of data blocks.
+  static const char kDataBlockKeyValueEncodingFormat[];
 };
 
 // Create default block based table factory.
@@ -44,13 +44,17 @@ namespace rocksdb {
 // storing the number of shared key bytes, non_shared key bytes,
 // and the length of the value in "*shared", "*non_shared", and
 // "*value_length", respectively.  Will not derefence past "limit".
+// "*has_parts" is set when the key of the entry is stored in parts, see block_builder.cc, in this
+// case the parts of the key are not decoded and their size is not checked.
 //
 // If any errors are detected, returns nullptr.  Otherwise, returns a
 // pointer to the key delta (just past the three decoded values).
 static inline const char* DecodeEntry(const char* p, const char* limit,
+                                      KeyValueEncodingFormat key_value_encoding_format,
                                       uint32_t* shared,
                                       uint32_t* non_shared,
-                                      uint32_t* value_length) {
+                                      uint32_t* value_length,
+                                      bool* has_parts) {
   if (limit - p < 3) return nullptr;
   *shared = reinterpret_cast<const unsigned char*>(p)[0];
   *non_shared = reinterpret_cast<const unsigned char*>(p)[1];
@@ -64,7 +68,15 @@ static inline const char* DecodeEntry(const char* p, const char* limit,
     if ((p = GetVarint32Ptr(p, limit, value_length)) == nullptr) return nullptr;
   }
 
-  if (static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
+  if (key_value_encoding_format == KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix) {
+    *has_parts = false;
+  } else {
+    *has_parts = (*non_shared & 1) != 0;
+    *non_shared >>= 1;
+  }
+
+  if (!*has_parts &&
+      static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
     return nullptr;
   }
   return p;
@@ -162,12 +174,21 @@ bool BlockIter::ParseNextKey() {
 
   // Decode next entry
   uint32_t shared, non_shared, value_length;
-  p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
+  bool has_parts;
+  p = DecodeEntry(p, limit, key_value_encoding_format_, &shared, &non_shared, &value_length,
+                  &has_parts);
   if (p == nullptr || key_.Size() < shared) {
     CorruptionError();
     return false;
   } else {
-    if (shared == 0) {
+    if (has_parts) {
+      p = DecodeKeyParts(p, limit, shared, non_shared);
+      if (p == nullptr || static_cast<uint32_t>(limit - p) < value_length) {
+        CorruptionError();
+        return false;
+      }
+      non_shared = 0;
+    } else if (shared == 0) {
       // If this key dont share any bytes with prev key then we dont need
       // to decode it and can use it's address in the block directly.
       key_.SetKey(Slice(p, non_shared), false /* copy */);
@@ -184,6 +205,31 @@ bool BlockIter::ParseNextKey() {
   }
 }
 
+// The key has the same size as the previous key, and consists of its first "shared" bytes
+// followed by parts. Each part is a number of bytes stored in the entry followed by a number of
+// bytes kept from the previous key, so the previous key is updated in place.
+const char* BlockIter::DecodeKeyParts(const char* p, const char* limit, uint32_t shared,
+                                      uint32_t non_shared) {
+  const size_t key_size = key_.Size();
+  char* key = key_.GetMutableKey();
+  size_t pos = shared;
+  size_t stored_total = 0;
+  while (pos < key_size) {
+    uint32_t stored, kept;
+    if ((p = GetVarint32Ptr(p, limit, &stored)) == nullptr) return nullptr;
+    if ((p = GetVarint32Ptr(p, limit, &kept)) == nullptr) return nullptr;
+    if (static_cast<size_t>(limit - p) < stored ||
+        key_size - pos < static_cast<size_t>(stored) + kept) {
+      return nullptr;
+    }
+    memcpy(key + pos, p, stored);
+    p += stored;
+    pos += static_cast<size_t>(stored) + kept;
+    stored_total += stored;
+  }
+  return stored_total == non_shared ? p : nullptr;
+}
+
 // Binary search in restart array to find the first restart point
 // with a key >= target (TODO: this comment is inaccurate)
 bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
@@ -194,10 +240,11 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
     uint32_t mid = (left + right + 1) / 2;
     uint32_t region_offset = GetRestartPoint(mid);
     uint32_t shared, non_shared, value_length;
+    bool has_parts;
     const char* key_ptr =
-        DecodeEntry(data_ + region_offset, data_ + restarts_, &shared,
-                    &non_shared, &value_length);
-    if (key_ptr == nullptr || (shared != 0)) {
+        DecodeEntry(data_ + region_offset, data_ + restarts_, key_value_encoding_format_, &shared,
+                    &non_shared, &value_length, &has_parts);
+    if (key_ptr == nullptr || shared != 0 || has_parts) {
       CorruptionError();
       return false;
     }
@@ -225,9 +272,11 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
 int BlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
   uint32_t region_offset = GetRestartPoint(block_index);
   uint32_t shared, non_shared, value_length;
+  bool has_parts;
   const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                    &shared, &non_shared, &value_length);
-  if (key_ptr == nullptr || (shared != 0)) {
+                                    key_value_encoding_format_, &shared, &non_shared,
+                                    &value_length, &has_parts);
+  if (key_ptr == nullptr || shared != 0 || has_parts) {
     CorruptionError();
     return 1;  // Return target is smaller
   }
@@ -338,7 +387,8 @@ Block::Block(BlockContents&& contents)
 }
 
 InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
-                                     bool total_order_seek) {
+                                     bool total_order_seek,
+                                     KeyValueEncodingFormat key_value_encoding_format) {
   if (size_ < 2*sizeof(uint32_t)) {
     if (iter != nullptr) {
       iter->SetStatus(STATUS(Corruption, "bad block contents"));
@@ -363,10 +413,10 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
 
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                    hash_index_ptr, prefix_index_ptr);
+                    hash_index_ptr, prefix_index_ptr, key_value_encoding_format);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
-                           hash_index_ptr, prefix_index_ptr);
+                           hash_index_ptr, prefix_index_ptr, key_value_encoding_format);
     }
   }
 
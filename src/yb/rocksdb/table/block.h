@@ -32,6 +32,7 @@
 
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/table.h"
 #include "yb/rocksdb/db/dbformat.h"
 #include "yb/rocksdb/table/block_prefix_index.h"
 #include "yb/rocksdb/table/block_hash_index.h"
@@ -82,9 +83,13 @@ class Block {
   // If total_order_seek is true, hash_index_ and prefix_index_ are ignored.
   // This option only applies for index block. For data block, hash_index_
   // and prefix_index_ are null, so this option does not matter.
+  //
+  // key_value_encoding_format is the encoding the block was built with, see BlockBuilder.
   InternalIterator* NewIterator(const Comparator* comparator,
                                 BlockIter* iter = nullptr,
-                                bool total_order_seek = true);
+                                bool total_order_seek = true,
+                                KeyValueEncodingFormat key_value_encoding_format =
+                                    KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix);
   void SetBlockHashIndex(BlockHashIndex* hash_index);
   void SetBlockPrefixIndex(BlockPrefixIndex* prefix_index);
 
@@ -115,19 +120,21 @@ class BlockIter : public InternalIterator {
         restart_index_(0),
         status_(Status::OK()),
         hash_index_(nullptr),
-        prefix_index_(nullptr) {}
+        prefix_index_(nullptr),
+        key_value_encoding_format_(KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
        uint32_t num_restarts, BlockHashIndex* hash_index,
-       BlockPrefixIndex* prefix_index)
+       BlockPrefixIndex* prefix_index,
+       KeyValueEncodingFormat key_value_encoding_format)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts,
-        hash_index, prefix_index);
+        hash_index, prefix_index, key_value_encoding_format);
   }
 
   void Initialize(const Comparator* comparator, const char* data,
       uint32_t restarts, uint32_t num_restarts, BlockHashIndex* hash_index,
-      BlockPrefixIndex* prefix_index) {
+      BlockPrefixIndex* prefix_index, KeyValueEncodingFormat key_value_encoding_format) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
 
@@ -139,6 +146,7 @@ class BlockIter : public InternalIterator {
     restart_index_ = num_restarts_;
     hash_index_ = hash_index;
     prefix_index_ = prefix_index;
+    key_value_encoding_format_ = key_value_encoding_format;
   }
 
   void SetStatus(Status s) {
@@ -192,6 +200,7 @@ class BlockIter : public InternalIterator {
   Status status_;
   BlockHashIndex* hash_index_;
   BlockPrefixIndex* prefix_index_;
+  KeyValueEncodingFormat key_value_encoding_format_;
 
   inline int Compare(const Slice& a, const Slice& b) const {
     return comparator_->Compare(a, b);
@@ -222,6 +231,11 @@ class BlockIter : public InternalIterator {
 
   bool ParseNextKey();
 
+  // Decodes the key of an entry stored in parts into key_. Returns the pointer to the value of the
+  // entry or nullptr if the entry is corrupted.
+  const char* DecodeKeyParts(const char* p, const char* limit, uint32_t shared,
+                             uint32_t non_shared);
+
   bool BinarySeek(const Slice& target, uint32_t left, uint32_t right,
                   uint32_t* index);
 
@@ -27,11 +27,17 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "yb/rocksdb/db/dbformat.h"
 
@@ -100,15 +106,32 @@ FilterBlockBuilder* CreateFilterBlockBuilder(const ImmutableCFOptions& opt,
   return nullptr;
 }
 
+// Compressing data blocks in parallel needs the offset of a data block only when it is written.
+// This is not the case for block based filters, which start a filter block at the offset of each
+// data block, and for hash indexes, which map prefixes of keys added to the index builder to the
+// next index entry.
+bool UseParallelCompression(const BlockBasedTableOptions& table_opt, FilterType filter_type,
+                            CompressionType compression_type,
+                            const CompressionOptions& compression_opts) {
+  return compression_opts.parallel_threads > 1 && compression_type != kNoCompression &&
+         filter_type != FilterType::kBlockBasedFilter &&
+         table_opt.index_type != BlockBasedTableOptions::kHashSearch;
+}
+
+// Max number of data blocks waiting to be compressed or written, per compression thread.
+constexpr size_t kMaxPendingDataBlocksPerThread = 4;
+
 bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
   // Check to see if compressed less than 12.5%
   return compressed_size < raw_size - (raw_size / 8u);
 }
 
 // format_version is the block format as defined in include/rocksdb/table.h
+// compression_dict is only used by ZSTD, it is empty if there is no dictionary.
 Slice CompressBlock(const Slice& raw,
                     const CompressionOptions& compression_options,
                     CompressionType* type, uint32_t format_version,
+                    const Slice& compression_dict,
                     std::string* compressed_output) {
   if (*type == kNoCompression) {
     return raw;
@@ -162,7 +185,7 @@ Slice CompressBlock(const Slice& raw,
       break;     // fall back to no compression.
     case kZSTDNotFinalCompression:
       if (ZSTD_Compress(compression_options, raw.cdata(), raw.size(),
-                        compressed_output) &&
+                        compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -201,10 +224,11 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
  public:
   explicit BlockBasedTablePropertiesCollector(
       BlockBasedTableOptions::IndexType index_type, bool whole_key_filtering,
-      bool prefix_filtering)
+      bool prefix_filtering, KeyValueEncodingFormat data_block_key_value_encoding_format)
       : index_type_(index_type),
         whole_key_filtering_(whole_key_filtering),
-        prefix_filtering_(prefix_filtering) {}
+        prefix_filtering_(prefix_filtering),
+        data_block_key_value_encoding_format_(data_block_key_value_encoding_format) {}
 
   virtual Status InternalAdd(const Slice& key, const Slice& value,
                              uint64_t file_size) override {
@@ -221,6 +245,14 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
                         whole_key_filtering_ ? kPropTrue : kPropFalse});
     properties->insert({BlockBasedTablePropertyNames::kPrefixFiltering,
                         prefix_filtering_ ? kPropTrue : kPropFalse});
+    // Files without this property use kKeyDeltaEncodingSharedPrefix, so it is only written for
+    // other encodings and such files stay readable by older versions.
+    if (data_block_key_value_encoding_format_ !=
+            KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix) {
+      std::string format;
+      PutFixed32(&format, static_cast<uint32_t>(data_block_key_value_encoding_format_));
+      properties->insert({BlockBasedTablePropertyNames::kDataBlockKeyValueEncodingFormat, format});
+    }
     return Status::OK();
   }
 
@@ -238,6 +270,7 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   BlockBasedTableOptions::IndexType index_type_;
   bool whole_key_filtering_;
   bool prefix_filtering_;
+  KeyValueEncodingFormat data_block_key_value_encoding_format_;
 };
 
 // Originally following data was stored in BlockBasedTableBuilder::Rep and related to a single SST
@@ -263,6 +296,100 @@ struct BlockBasedTableBuilder::FileWriterWithOffsetAndCachePrefix {
   BlockBasedTable::CacheKeyBuffer compressed_cache_key_prefix;
 };
 
+// A finished data block that is compressed by a data block compressor thread and then written by
+// the thread building the table.
+struct BlockBasedTableBuilder::PendingDataBlock {
+  std::string raw_contents;
+  // Last key of the block and first key of the next one, to add the index entry of the block.
+  std::string last_key;
+  std::string next_block_first_key;
+
+  // Set by the compressor thread.
+  CompressionType type = kNoCompression;
+  std::string compressed_output;
+  Slice contents;
+
+  // Protected by the mutex of the compressor.
+  bool compressed = false;
+};
+
+// Threads compressing data blocks of a single table builder, see
+// CompressionOptions::parallel_threads.
+class BlockBasedTableBuilder::DataBlockCompressor {
+ public:
+  typedef std::function<void(PendingDataBlock*)> CompressFunction;
+
+  DataBlockCompressor(size_t num_threads, CompressFunction compress)
+      : compress_(std::move(compress)) {
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i != num_threads; ++i) {
+      threads_.emplace_back(&DataBlockCompressor::Run, this);
+    }
+  }
+
+  // Blocks that were not compressed yet are left as is.
+  ~DataBlockCompressor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    queue_cond_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  // The block should stay alive until it is compressed or the compressor is destroyed.
+  void Submit(PendingDataBlock* block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(block);
+    }
+    queue_cond_.notify_one();
+  }
+
+  bool IsCompressed(const PendingDataBlock& block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return block.compressed;
+  }
+
+  void WaitCompressed(const PendingDataBlock& block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    compressed_cond_.wait(lock, [&block] { return block.compressed; });
+  }
+
+  size_t num_threads() const {
+    return threads_.size();
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      queue_cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (stop_) {
+        return;
+      }
+      auto* block = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+      compress_(block);
+      lock.lock();
+      block->compressed = true;
+      compressed_cond_.notify_all();
+    }
+  }
+
+  const CompressFunction compress_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable queue_cond_;
+  std::condition_variable compressed_cond_;
+  std::deque<PendingDataBlock*> queue_;
+  bool stop_ = false;
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const BlockBasedTableOptions table_options;
@@ -303,8 +430,23 @@ struct BlockBasedTableBuilder::Rep {
   std::string compressed_output;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
 
+  // Dictionary used to compress data blocks, see CompressionOptions::max_dict_bytes.
+  std::string compression_dict;
+  // While true, added keys and values are buffered in buffered_entries instead of being added to
+  // data blocks, until there are enough samples to train the compression dictionary.
+  bool buffer_for_compression_dict;
+  std::string buffered_entries;
+  // Sizes of the buffered keys and values.
+  std::vector<std::pair<size_t, size_t>> buffered_entry_sizes;
+
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  // Flushed data blocks that are not written yet, in flush order. Only used when data blocks are
+  // compressed in parallel.
+  std::deque<std::unique_ptr<PendingDataBlock>> pending_data_blocks;
+  // Declared after pending_data_blocks, so its threads are stopped before the blocks are destroyed.
+  std::unique_ptr<DataBlockCompressor> data_block_compressor;
+
   Rep(const ImmutableCFOptions& _ioptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -322,25 +464,31 @@ struct BlockBasedTableBuilder::Rep {
         filter_block_builder(skip_filters ? nullptr : CreateFilterBlockBuilder(
             _ioptions, table_options, filter_type)),
         data_block_builder(table_options.block_restart_interval,
-                   table_options.use_delta_encoding),
-        internal_prefix_transform(_ioptions.prefix_extractor),
+                   table_options.use_delta_encoding,
+                   table_options.data_block_key_value_encoding_format),
+        internal_prefix_transform(
+            HashIndexPrefixExtractor(table_opt, _ioptions.prefix_extractor)),
         filter_key_transformer(table_opt.filter_policy ?
             table_opt.filter_policy->GetKeyTransformer() : nullptr),
         data_index_builder(
             IndexBuilder::CreateIndexBuilder(
                 table_options.index_type, &internal_comparator, &internal_prefix_transform,
-                table_options.index_block_restart_interval)),
+                table_options.index_block_restart_interval, table_options.index_block_size)),
         filter_index_builder(
             // Prefix_extractor is not used by binary search index which we use for bloom filter
             // blocks indexing.
             IndexBuilder::CreateIndexBuilder(
                 BlockBasedTableOptions::kBinarySearch, BytewiseComparator(),
-                nullptr /* prefix_extractor */, table_options.index_block_restart_interval)),
+                nullptr /* prefix_extractor */, table_options.index_block_restart_interval,
+                table_options.index_block_size)),
         compression_type(_compression_type),
         compression_opts(_compression_opts),
         flush_block_policy(
             table_options.flush_block_policy_factory->NewFlushBlockPolicy(
-                table_options, data_block_builder)) {
+                table_options, data_block_builder)),
+        buffer_for_compression_dict(
+            _compression_type == kZSTDNotFinalCompression &&
+            _compression_opts.max_dict_bytes > 0 && ZSTD_TrainDictionarySupported()) {
     metadata_writer = std::make_shared<FileWriterWithOffsetAndCachePrefix>();
     metadata_writer->writer = metadata_file;
     if (data_file != nullptr) {
@@ -356,7 +504,8 @@ struct BlockBasedTableBuilder::Rep {
     table_properties_collectors.emplace_back(
         new BlockBasedTablePropertiesCollector(
             table_options.index_type, table_options.whole_key_filtering,
-            _ioptions.prefix_extractor != nullptr));
+            _ioptions.prefix_extractor != nullptr,
+            table_options.data_block_key_value_encoding_format));
   }
 
   bool is_split_sst() const { return data_writer != metadata_writer; }
@@ -401,6 +550,18 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
           &rep_->metadata_writer->compressed_cache_key_prefix);
     }
   }
+  if (UseParallelCompression(rep_->table_options, rep_->filter_type, compression_type,
+                             compression_opts)) {
+    rep_->data_block_compressor.reset(new DataBlockCompressor(
+        compression_opts.parallel_threads, [this](PendingDataBlock* block) {
+          // The dictionary is trained before the first data block is flushed, and is not changed
+          // after that.
+          block->type = rep_->compression_type;
+          block->contents = CompressBlockContents(
+              block->raw_contents, rep_->compression_dict, &block->type,
+              &block->compressed_output);
+        }));
+  }
 }
 
 BlockBasedTableBuilder::~BlockBasedTableBuilder() {
@@ -412,6 +573,16 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
   Rep* const r = rep_;
   assert(!r->closed);
   if (!ok()) return;
+  if (r->buffer_for_compression_dict) {
+    r->buffered_entries.append(key.cdata(), key.size());
+    r->buffered_entries.append(value.cdata(), value.size());
+    r->buffered_entry_sizes.emplace_back(key.size(), value.size());
+    if (r->buffered_entries.size() >=
+            static_cast<size_t>(r->compression_opts.max_dict_bytes) * kDictTrainingSampleRatio) {
+      TrainCompressionDictAndAddBufferedEntries();
+    }
+    return;
+  }
   if (r->props.num_entries > 0) {
     assert(r->internal_comparator.Compare(key, Slice(r->last_key)) > 0);
   }
@@ -450,18 +621,68 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       r->ioptions.info_log);
 }
 
+void BlockBasedTableBuilder::TrainCompressionDictAndAddBufferedEntries() {
+  Rep* const r = rep_;
+  r->buffer_for_compression_dict = false;
+  std::string entries;
+  std::vector<std::pair<size_t, size_t>> entry_sizes;
+  entries.swap(r->buffered_entries);
+  entry_sizes.swap(r->buffered_entry_sizes);
+
+  // Each key with its value is a sample.
+  std::vector<size_t> sample_lens;
+  sample_lens.reserve(entry_sizes.size());
+  for (const auto& sizes : entry_sizes) {
+    sample_lens.push_back(sizes.first + sizes.second);
+  }
+  r->compression_dict = ZSTD_TrainDictionary(
+      entries, sample_lens, r->compression_opts.max_dict_bytes);
+  if (r->compression_dict.empty()) {
+    RLOG(InfoLogLevel::INFO_LEVEL, r->ioptions.info_log,
+        "Failed to train compression dictionary from %" ROCKSDB_PRIszt " samples",
+        sample_lens.size());
+  }
+
+  const char* p = entries.data();
+  for (const auto& sizes : entry_sizes) {
+    Add(Slice(p, sizes.first), Slice(p + sizes.first, sizes.second));
+    p += sizes.first + sizes.second;
+  }
+}
+
 void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   Rep* const r = rep_;
   assert(!r->closed);
   if (!ok()) return;
-  size_t data_block_size = 0;
 
+  if (r->data_block_compressor) {
+    if (!r->data_block_builder.empty()) {
+      std::unique_ptr<PendingDataBlock> block(new PendingDataBlock());
+      block->raw_contents = r->data_block_builder.Finish().ToBuffer();
+      r->data_block_builder.Reset();
+      block->last_key = r->last_key;
+      block->next_block_first_key = next_block_first_key.ToBuffer();
+      r->data_block_compressor->Submit(block.get());
+      r->pending_data_blocks.push_back(std::move(block));
+    }
+    WritePendingDataBlocks(
+        kMaxPendingDataBlocksPerThread * r->data_block_compressor->num_threads());
+    return;
+  }
+
+  size_t data_block_size = 0;
   if (!r->data_block_builder.empty()) {
     data_block_size = WriteBlock(&r->data_block_builder, &r->data_pending_handle,
         r->data_writer.get());
   }
   if (!ok()) return;
 
+  DataBlockWritten(data_block_size, &r->last_key, next_block_first_key);
+}
+
+void BlockBasedTableBuilder::DataBlockWritten(size_t data_block_size, std::string* last_key,
+                                              const Slice& next_block_first_key) {
+  Rep* const r = rep_;
   if (!r->table_options.skip_table_builder_flush) {
     r->status = r->data_writer->writer->Flush();
   }
@@ -482,11 +703,29 @@ void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   // "the r" as the key for the index block entry since it is >= all
   // entries in the first block and < all entries in subsequent
   // blocks.
-  r->data_index_builder->AddIndexEntry(&r->last_key,
+  r->data_index_builder->AddIndexEntry(last_key,
       next_block_first_key.empty() ? nullptr : &next_block_first_key,
       r->data_pending_handle);
 }
 
+void BlockBasedTableBuilder::WritePendingDataBlocks(size_t max_pending) {
+  Rep* const r = rep_;
+  auto& pending = r->pending_data_blocks;
+  while (!pending.empty() && ok()) {
+    PendingDataBlock* block = pending.front().get();
+    if (pending.size() > max_pending) {
+      r->data_block_compressor->WaitCompressed(*block);
+    } else if (!r->data_block_compressor->IsCompressed(*block)) {
+      break;
+    }
+    const size_t data_block_size = WriteRawBlock(
+        block->contents, block->type, &r->data_pending_handle, r->data_writer.get());
+    if (!ok()) return;
+    DataBlockWritten(data_block_size, &block->last_key, block->next_block_first_key);
+    pending.pop_front();
+  }
+}
+
 void BlockBasedTableBuilder::FlushFilterBlock(const Slice& next_block_first_key) {
   Rep* const r = rep_;
   assert(!r->closed);
@@ -518,14 +757,15 @@ void BlockBasedTableBuilder::FlushFilterBlock(const Slice& next_block_first_key)
 size_t BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
                                           BlockHandle* handle,
                                           FileWriterWithOffsetAndCachePrefix* writer_info) {
-  size_t block_size = WriteBlock(block->Finish(), handle, writer_info);
+  size_t block_size = WriteBlock(block->Finish(), handle, writer_info, rep_->compression_dict);
   block->Reset();
   return block_size;
 }
 
 size_t BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
                                           BlockHandle* handle,
-                                          FileWriterWithOffsetAndCachePrefix* writer_info) {
+                                          FileWriterWithOffsetAndCachePrefix* writer_info,
+                                          const Slice& compression_dict) {
   // File format contains a sequence of blocks where each block has:
   //    block_data: uint8[n]
   //    type: uint8
@@ -534,21 +774,27 @@ size_t BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   Rep* r = rep_;
 
   auto type = r->compression_type;
-  Slice block_contents;
-  if (raw_block_contents.size() < kCompressionSizeLimit) {
-    block_contents =
-        CompressBlock(raw_block_contents, r->compression_opts, &type,
-                      r->table_options.format_version, &r->compressed_output);
-  } else {
-    RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
-    block_contents = raw_block_contents;
-  }
+  Slice block_contents = CompressBlockContents(
+      raw_block_contents, compression_dict, &type, &r->compressed_output);
   size_t block_size = WriteRawBlock(block_contents, type, handle, writer_info);
   r->compressed_output.clear();
   return block_size;
 }
 
+Slice BlockBasedTableBuilder::CompressBlockContents(const Slice& raw_block_contents,
+                                                    const Slice& compression_dict,
+                                                    CompressionType* type,
+                                                    std::string* compressed_output) const {
+  Rep* r = rep_;
+  if (raw_block_contents.size() < kCompressionSizeLimit) {
+    return CompressBlock(raw_block_contents, r->compression_opts, type,
+                         r->table_options.format_version, compression_dict, compressed_output);
+  }
+  RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
+  *type = kNoCompression;
+  return raw_block_contents;
+}
+
 size_t BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
                                              CompressionType type,
                                              BlockHandle* handle,
@@ -651,10 +897,17 @@ Status BlockBasedTableBuilder::InsertBlockInCache(const Slice& block_contents,
 
 Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
+  if (r->buffer_for_compression_dict) {
+    TrainCompressionDictAndAddBufferedEntries();
+  }
   Slice end_slice;
   if (!r->data_block_builder.empty()) {
     FlushDataBlock(end_slice);  // no more data block
   }
+  if (r->data_block_compressor) {
+    WritePendingDataBlocks(0);
+    r->data_block_compressor.reset();
+  }
   if (r->filter_block_builder != nullptr) {
     FlushFilterBlock(end_slice);  // no more filter block
   }
@@ -664,6 +917,18 @@ Status BlockBasedTableBuilder::Finish() {
   BlockHandle meta_index_block_handle, data_index_block_handle;
   IndexBuilder::IndexBlocks index_blocks;
   auto s = r->data_index_builder->Finish(&index_blocks);
+  // Write index partitions for two-level index, the top-level index block is written instead of
+  // single-level index block below.
+  while (s.IsIncomplete()) {
+    BlockHandle partition_block_handle;
+    WriteBlock(index_blocks.index_block_contents, &partition_block_handle,
+        r->metadata_writer.get());
+    if (!ok()) {
+      return status();
+    }
+    r->data_index_builder->OnPartitionWritten(partition_block_handle);
+    s = r->data_index_builder->Finish(&index_blocks);
+  }
   if (!s.ok()) {
     return s;
   }
@@ -681,6 +946,13 @@ Status BlockBasedTableBuilder::Finish() {
     meta_index_builder.Add(item.first, block_handle);
   }
 
+  if (ok() && !r->compression_dict.empty()) {
+    BlockHandle compression_dict_block_handle;
+    WriteRawBlock(r->compression_dict, kNoCompression, &compression_dict_block_handle,
+        r->metadata_writer.get());
+    meta_index_builder.Add(kCompressionDictBlock, compression_dict_block_handle);
+  }
+
   if (ok()) {
     if (r->filter_block_builder != nullptr) {
       // Add mapping from "<filter_block_prefix>.Name" to location of either filter block or
@@ -793,10 +1065,11 @@ void BlockBasedTableBuilder::Abandon() {
   Rep* r = rep_;
   assert(!r->closed);
   r->closed = true;
+  r->data_block_compressor.reset();
 }
 
 uint64_t BlockBasedTableBuilder::NumEntries() const {
-  return rep_->props.num_entries;
+  return rep_->props.num_entries + rep_->buffered_entry_sizes.size();
 }
 
 uint64_t BlockBasedTableBuilder::TotalFileSize() const {
@@ -104,15 +104,21 @@ class BlockBasedTableBuilder : public TableBuilder {
 
  private:
   struct FileWriterWithOffsetAndCachePrefix;
+  struct PendingDataBlock;
+  class DataBlockCompressor;
 
   bool ok() const { return status().ok(); }
+  // Compresses the block contents, falling back to kNoCompression when compression does not pay
+  // off. Returns either raw_block_contents or the contents of compressed_output.
+  Slice CompressBlockContents(const Slice& raw_block_contents, const Slice& compression_dict,
+      CompressionType* type, std::string* compressed_output) const;
   // Call block's Finish() method and then write the finalize block contents to
   // file. Returns number of bytes written to file.
   size_t WriteBlock(BlockBuilder* block, BlockHandle* handle,
       FileWriterWithOffsetAndCachePrefix* writer_info);
   // Directly write block content to the file. Returns number of bytes written to file.
   size_t WriteBlock(const Slice& block_contents, BlockHandle* handle,
-      FileWriterWithOffsetAndCachePrefix* writer_info);
+      FileWriterWithOffsetAndCachePrefix* writer_info, const Slice& compression_dict = Slice());
   size_t WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle,
       FileWriterWithOffsetAndCachePrefix* writer_info);
   Status InsertBlockInCache(const Slice& block_contents,
@@ -130,15 +136,32 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called.
   void FlushDataBlock(const Slice& next_block_first_key);
 
+  // Updates properties, filter and index after a data block of the specified size was written to
+  // the data file at data_pending_handle.
+  void DataBlockWritten(size_t data_block_size, std::string* last_key,
+      const Slice& next_block_first_key);
+
+  // Writes data blocks compressed by the data block compressor, in the order they were flushed.
+  // Waits for compression of the first pending block while more than max_pending blocks are
+  // pending.
+  void WritePendingDataBlocks(size_t max_pending);
+
   // Flush the current filter block into disk. next_block_first_key should be nullptr if this is the
   // last block written to disk.
   // REQUIRES: Finish(), Abandon() have not been called.
   void FlushFilterBlock(const Slice& next_block_first_key);
 
+  // Trains the compression dictionary from the buffered entries and adds them to the table.
+  void TrainCompressionDictAndAddBufferedEntries();
+
   // Some compression libraries fail when the raw size is bigger than int. If
   // uncompressed size is bigger than kCompressionSizeLimit, don't compress it
   const uint64_t kCompressionSizeLimit = std::numeric_limits<int>::max();
 
+  // Bytes of keys and values buffered to train the compression dictionary, per byte of the
+  // dictionary.
+  static constexpr size_t kDictTrainingSampleRatio = 100;
+
   // No copying allowed
   BlockBasedTableBuilder(const BlockBasedTableBuilder&) = delete;
   void operator=(const BlockBasedTableBuilder&) = delete;
@@ -106,7 +106,7 @@ Status BlockBasedTableFactory::SanitizeOptions(
     const DBOptions& db_opts,
     const ColumnFamilyOptions& cf_opts) const {
   if (table_options_.index_type == BlockBasedTableOptions::kHashSearch &&
-      cf_opts.prefix_extractor == nullptr) {
+      HashIndexPrefixExtractor(table_options_, cf_opts.prefix_extractor.get()) == nullptr) {
     return STATUS(InvalidArgument, "Hash index is specified for block-based "
         "table, but prefix_extractor is not given");
   }
@@ -142,6 +142,10 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  hash_index_prefix_extractor: %s\n",
+           table_options_.hash_index_prefix_extractor == nullptr ?
+             "nullptr" : table_options_.hash_index_prefix_extractor->Name());
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  checksum: %d\n",
            table_options_.checksum);
   ret.append(buffer);
@@ -168,6 +172,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  block_size: %" ROCKSDB_PRIszt "\n",
            table_options_.block_size);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  index_block_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.index_block_size);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_size_deviation: %d\n",
            table_options_.block_size_deviation);
   ret.append(buffer);
@@ -187,6 +194,12 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  skip_table_builder_flush: %d\n",
            table_options_.skip_table_builder_flush);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  max_auto_readahead_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.max_auto_readahead_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_key_value_encoding_format: %d\n",
+           static_cast<int>(table_options_.data_block_key_value_encoding_format));
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
@@ -212,9 +225,12 @@ const char BlockBasedTablePropertyNames::kWholeKeyFiltering[] =
     "rocksdb.block.based.table.whole.key.filtering";
 const char BlockBasedTablePropertyNames::kPrefixFiltering[] =
     "rocksdb.block.based.table.prefix.filtering";
+const char BlockBasedTablePropertyNames::kDataBlockKeyValueEncodingFormat[] =
+    "rocksdb.block.based.table.data.block.key.value.encoding.format";
 const char kHashIndexPrefixesBlock[] = "rocksdb.hashindex.prefixes";
 const char kHashIndexPrefixesMetadataBlock[] =
     "rocksdb.hashindex.metadata";
+const char kCompressionDictBlock[] = "rocksdb.compression_dict";
 const char kPropTrue[] = "1";
 const char kPropFalse[] = "0";
 
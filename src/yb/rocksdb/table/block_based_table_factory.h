@@ -41,6 +41,14 @@ struct EnvOptions;
 using std::unique_ptr;
 class BlockBasedTableBuilder;
 
+// Returns the extractor of the prefixes of the hash index of the tables with the options:
+// hash_index_prefix_extractor if set, prefix_extractor of the column family otherwise.
+inline const SliceTransform* HashIndexPrefixExtractor(
+    const BlockBasedTableOptions& table_options, const SliceTransform* prefix_extractor) {
+  return table_options.hash_index_prefix_extractor ?
+      table_options.hash_index_prefix_extractor.get() : prefix_extractor;
+}
+
 class BlockBasedTableFactory : public TableFactory {
  public:
   explicit BlockBasedTableFactory(
@@ -92,6 +100,7 @@ class BlockBasedTableFactory : public TableFactory {
 
 extern const char kHashIndexPrefixesBlock[];
 extern const char kHashIndexPrefixesMetadataBlock[];
+extern const char kCompressionDictBlock[];
 extern const char kPropTrue[];
 extern const char kPropFalse[];
 
@@ -23,7 +23,9 @@
 
 #include "yb/rocksdb/table/block_based_table_reader.h"
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <cinttypes>
 
@@ -62,6 +64,7 @@
 #include "yb/gutil/macros.h"
 #include "yb/util/logging.h"
 #include "yb/util/atomic.h"
+#include "yb/util/mem_tracker.h"
 
 namespace rocksdb {
 
@@ -81,6 +84,11 @@ namespace {
 const size_t kMaxCacheKeyPrefixSize __attribute__((unused)) =
     kMaxVarint64Length * 3 + 1;
 
+// Number of data blocks an iterator reads one after another before it starts to read ahead, so
+// point reads and short scans do not read ahead, and the size of its first readahead.
+const int kMinSequentialBlocksForReadahead = 2;
+const size_t kInitialReadaheadSize = 8 * 1024;
+
 // Read the block identified by "handle" from "file".
 // The only relevant option is options.verify_checksums for now.
 // On failure return non-OK.
@@ -88,10 +96,11 @@ const size_t kMaxCacheKeyPrefixSize __attribute__((unused)) =
 Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& options, const BlockHandle& handle,
                          std::unique_ptr<Block>* result, Env* env,
-                         bool do_uncompress = true) {
+                         bool do_uncompress = true,
+                         const Slice& compression_dict = Slice()) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, env,
-                               do_uncompress);
+                               do_uncompress, compression_dict);
   if (s.ok()) {
     result->reset(new Block(std::move(contents)));
   }
@@ -175,6 +184,10 @@ class BlockBasedTable::IndexReader {
   // that was allocated in block cache.
   virtual size_t ApproximateMemoryUsage() const = 0;
 
+  // Returns true if NewIterator() iterates over the top-level index block, whose values are
+  // handles of index partitions rather than handles of data blocks.
+  virtual bool IsTwoLevel() const { return false; }
+
  protected:
   const Comparator* comparator_;
 };
@@ -348,6 +361,52 @@ class HashIndexReader : public IndexReader {
   BlockContents prefixes_contents_;
 };
 
+// Top-level index of a two-level index. Only the top-level index block, which maps the last key
+// of each index partition to the partition block handle, is kept by this reader. Index partitions
+// are loaded through the block cache by BlockBasedTable::NewIndexIterator.
+class TwoLevelIndexReader : public IndexReader {
+ public:
+  static Status Create(RandomAccessFileReader* file, const Footer& footer,
+                       const BlockHandle& index_handle, Env* env,
+                       const Comparator* comparator,
+                       std::unique_ptr<IndexReader>* index_reader) {
+    std::unique_ptr<Block> index_block;
+    auto s = ReadBlockFromFile(file, footer, ReadOptions::kDefault, index_handle,
+                               &index_block, env);
+
+    if (s.ok()) {
+      index_reader->reset(new TwoLevelIndexReader(comparator, std::move(index_block)));
+    }
+
+    return s;
+  }
+
+  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
+                                        bool dont_care = true) override {
+    return index_block_->NewIterator(comparator_, iter, true);
+  }
+
+  size_t size() const override { return index_block_->size(); }
+  size_t usable_size() const override {
+    return index_block_->usable_size();
+  }
+
+  size_t ApproximateMemoryUsage() const override {
+    assert(index_block_);
+    return index_block_->ApproximateMemoryUsage();
+  }
+
+  bool IsTwoLevel() const override { return true; }
+
+ private:
+  TwoLevelIndexReader(const Comparator* comparator,
+                      std::unique_ptr<Block>&& index_block)
+      : IndexReader(comparator), index_block_(std::move(index_block)) {
+    assert(index_block_ != nullptr);
+  }
+  std::unique_ptr<Block> index_block_;
+};
+
 // Originally following data was stored in BlockBasedTable::Rep and related to a single SST file.
 // Since SST file is now split into two files - data file and metadata file, all file-related data
 // was moved into dedicated structure for each file.
@@ -442,15 +501,38 @@ struct BlockBasedTable::Rep {
   bool hash_index_allow_collision;
   bool whole_key_filtering;
   bool prefix_filtering;
+  KeyValueEncodingFormat data_block_key_value_encoding_format =
+      KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix;
+  // Dictionary that data blocks are compressed with, null if the table does not have it. Loaded
+  // on open, since it is needed to decompress any data block.
+  std::unique_ptr<BlockContents> compression_dict_block;
+
+  Slice compression_dict() const {
+    return compression_dict_block ? compression_dict_block->data : Slice();
+  }
   // TODO(kailiu) It is very ugly to use internal key in table, since table
   // module should not be relying on db module. However to make things easier
   // and compatible with existing code, we introduce a wrapper that allows
   // block to extract prefix without knowing if a key is internal or not.
   unique_ptr<SliceTransform> internal_prefix_transform;
   DataIndexLoadMode data_index_load_mode;
+
+  // Block cache entries referenced by the table until it is closed, by cache key. See
+  // BlockBasedTableOptions::pinned_blocks_mem_tracker.
+  mutable std::mutex pinned_blocks_mutex;
+  std::unordered_map<std::string, Cache::Handle*> pinned_blocks;
+  // Total charge of pinned_blocks, consumed from the pinned blocks memory tracker.
+  size_t pinned_blocks_size = 0;
 };
 
 BlockBasedTable::~BlockBasedTable() {
+  if (!rep_->pinned_blocks.empty()) {
+    Cache* block_cache = rep_->table_options.block_cache.get();
+    for (const auto& entry : rep_->pinned_blocks) {
+      block_cache->Release(entry.second);
+    }
+    rep_->table_options.pinned_blocks_mem_tracker->Release(rep_->pinned_blocks_size);
+  }
   delete rep_;
 }
 
@@ -611,6 +693,22 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  BlockHandle compression_dict_handle;
+  if (FindMetaBlock(meta_iter.get(), kCompressionDictBlock, &compression_dict_handle).ok()) {
+    std::unique_ptr<BlockContents> compression_dict_block(new BlockContents());
+    s = ReadBlockContents(rep->base_reader_with_cache_prefix->reader.get(), rep->footer,
+                          ReadOptions::kDefault, compression_dict_handle,
+                          compression_dict_block.get(), ioptions.env,
+                          false /* decompression_requested */);
+    if (!s.ok()) {
+      RLOG(InfoLogLevel::WARN_LEVEL, rep->ioptions.info_log,
+          "Encountered error while reading compression dictionary block: %s",
+          s.ToString().c_str());
+      return s;
+    }
+    rep->compression_dict_block = std::move(compression_dict_block);
+  }
+
   // Read the properties
   bool found_properties_block = true;
   s = SeekToPropertiesBlock(meta_iter.get(), &found_properties_block);
@@ -648,6 +746,12 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     rep->prefix_filtering &= IsFeatureSupported(
         *(rep->table_properties),
         BlockBasedTablePropertyNames::kPrefixFiltering, rep->ioptions.info_log);
+    auto& props = rep->table_properties->user_collected_properties;
+    auto pos = props.find(BlockBasedTablePropertyNames::kDataBlockKeyValueEncodingFormat);
+    if (pos != props.end()) {
+      rep->data_block_key_value_encoding_format =
+          static_cast<KeyValueEncodingFormat>(DecodeFixed32(pos->second.c_str()));
+    }
   }
 
   if (data_index_load_mode == DataIndexLoadMode::PRELOAD_ON_OPEN) {
@@ -731,6 +835,11 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  if (s.ok() && table_options.pinned_blocks_mem_tracker &&
+      table_options.cache_index_and_filter_blocks && table_options.block_cache) {
+    new_table->PinIndexAndFilterBlocks();
+  }
+
   if (s.ok()) {
     *table_reader = std::move(new_table);
   }
@@ -738,6 +847,117 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   return s;
 }
 
+void BlockBasedTable::PinIndexAndFilterBlocks() {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  const auto& cache_key_prefix = rep_->base_reader_with_cache_prefix->cache_key_prefix;
+
+  {
+    // Creating an index iterator puts the index into the block cache.
+    unique_ptr<InternalIterator> iter(NewIndexIterator(ReadOptions::kDefault));
+    if (!iter->status().ok()) {
+      return;
+    }
+    const auto key = GetCacheKey(cache_key_prefix, rep_->footer.index_handle(), cache_key);
+    if (!PinCachedBlock(key)) {
+      return;
+    }
+  }
+
+  {
+    // Index partitions of a two-level index are read through the block cache on demand.
+    Cache::Handle* index_handle = block_cache->Lookup(
+        GetCacheKey(cache_key_prefix, rep_->footer.index_handle(), cache_key), kNoCacheQueryId);
+    if (index_handle == nullptr) {
+      return;
+    }
+    auto* index_reader = static_cast<IndexReader*>(block_cache->Value(index_handle));
+    std::vector<std::string> partition_handles;
+    if (index_reader->IsTwoLevel()) {
+      unique_ptr<InternalIterator> iter(index_reader->NewIterator());
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        partition_handles.push_back(iter->value().ToBuffer());
+      }
+    }
+    block_cache->Release(index_handle);
+    for (const auto& encoded_handle : partition_handles) {
+      unique_ptr<InternalIterator> iter(NewBlockIterator(
+          rep_, BlockType::kIndex, ReadOptions::kDefault, encoded_handle));
+      BlockHandle handle;
+      Slice input = encoded_handle;
+      if (!iter->status().ok() || !handle.DecodeFrom(&input).ok() ||
+          !PinCachedBlock(GetCacheKey(cache_key_prefix, handle, cache_key))) {
+        return;
+      }
+    }
+  }
+
+  if (rep_->filter_policy == nullptr) {
+    return;
+  }
+  switch (rep_->filter_type) {
+    case FilterType::kFullFilter:
+      FALLTHROUGH_INTENDED;
+    case FilterType::kBlockBasedFilter: {
+      auto filter_entry = GetFilter(kDefaultQueryId);
+      if (filter_entry.cache_handle != nullptr) {
+        filter_entry.Release(block_cache);
+        PinCachedBlock(GetCacheKey(cache_key_prefix, rep_->filter_handle, cache_key));
+      }
+      return;
+    }
+    case FilterType::kFixedSizeFilter: {
+      if (!rep_->filter_index_reader) {
+        return;
+      }
+      unique_ptr<InternalIterator> iter(rep_->filter_index_reader->NewIterator());
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        BlockHandle handle;
+        Slice input = iter->value();
+        if (!handle.DecodeFrom(&input).ok()) {
+          return;
+        }
+        auto filter_entry = GetFilterBlock(handle, kDefaultQueryId, false /* no_io */);
+        if (filter_entry.cache_handle == nullptr) {
+          return;
+        }
+        filter_entry.Release(block_cache);
+        if (!PinCachedBlock(GetCacheKey(cache_key_prefix, handle, cache_key))) {
+          return;
+        }
+      }
+      return;
+    }
+    case FilterType::kNoFilter:
+      return;
+  }
+}
+
+bool BlockBasedTable::PinCachedBlock(const Slice& cache_key) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  const auto& mem_tracker = rep_->table_options.pinned_blocks_mem_tracker;
+  if (block_cache == nullptr || !mem_tracker) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(rep_->pinned_blocks_mutex);
+  if (rep_->pinned_blocks.count(cache_key.ToBuffer())) {
+    return true;
+  }
+  // Lookups with kNoCacheQueryId don't promote the entry to the multi touch part of the cache.
+  Cache::Handle* handle = block_cache->Lookup(cache_key, kNoCacheQueryId);
+  if (handle == nullptr) {
+    return false;
+  }
+  const size_t charge = block_cache->GetUsage(handle);
+  if (!mem_tracker->TryConsume(charge)) {
+    block_cache->Release(handle);
+    return false;
+  }
+  rep_->pinned_blocks.emplace(cache_key.ToBuffer(), handle);
+  rep_->pinned_blocks_size += charge;
+  return true;
+}
+
 void BlockBasedTable::SetDataFileReader(unique_ptr<RandomAccessFileReader> &&data_file) {
   rep_->data_reader_with_cache_prefix =
       std::make_shared<FileReaderWithCachePrefix>(std::move(data_file));
@@ -792,6 +1012,7 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (data_index_reader) {
     usage += data_index_reader->ApproximateMemoryUsage();
   }
+  usage += rep_->compression_dict().size();
   return usage;
 }
 
@@ -829,16 +1050,21 @@ Status BlockBasedTable::GetDataBlockFromCache(
     const Slice& block_cache_key, const Slice& compressed_block_cache_key,
     Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
     const ReadOptions& read_options,
-    BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version) {
+    BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
+    const Slice& compression_dict) {
   Status s;
   Block* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
+  // Readers that don't fill the cache (compactions, scans with fill_cache == false) should not
+  // promote blocks to the multi touch cache either.
+  const QueryId lookup_query_id =
+      read_options.fill_cache ? read_options.query_id : kNoCacheQueryId;
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
     block->cache_handle =
         GetEntryFromCache(block_cache, block_cache_key, BLOCK_CACHE_DATA_MISS,
-                          BLOCK_CACHE_DATA_HIT, statistics, read_options.query_id);
+                          BLOCK_CACHE_DATA_HIT, statistics, lookup_query_id);
     if (block->cache_handle != nullptr) {
       block->value =
           static_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -855,7 +1081,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   assert(!compressed_block_cache_key.empty());
   block_cache_compressed_handle =
-      block_cache_compressed->Lookup(compressed_block_cache_key, read_options.query_id);
+      block_cache_compressed->Lookup(compressed_block_cache_key, lookup_query_id);
   // if we found in the compressed cache, then uncompress and insert into
   // uncompressed cache
   if (block_cache_compressed_handle == nullptr) {
@@ -873,7 +1099,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
   BlockContents contents;
   s = UncompressBlockContents(compressed_block->data(),
                               compressed_block->size(), &contents,
-                              format_version);
+                              format_version, compression_dict);
 
   // Insert uncompressed block into block cache
   if (s.ok()) {
@@ -900,7 +1126,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     const Slice& block_cache_key, const Slice& compressed_block_cache_key,
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, Statistics* statistics,
-    CachableEntry<Block>* block, Block* raw_block, uint32_t format_version) {
+    CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
+    const Slice& compression_dict) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -909,7 +1136,7 @@ Status BlockBasedTable::PutDataBlockToCache(
   BlockContents contents;
   if (raw_block->compression_type() != kNoCompression) {
     s = UncompressBlockContents(raw_block->data(), raw_block->size(), &contents,
-                                format_version);
+                                format_version, compression_dict);
   }
   if (!s.ok()) {
     delete raw_block;
@@ -1093,10 +1320,17 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     filter_block_handle = &rep_->filter_handle;
   }
 
+  return GetFilterBlock(*filter_block_handle, query_id, no_io);
+}
+
+BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilterBlock(
+    const BlockHandle& filter_block_handle, const QueryId query_id, bool no_io) const {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+
   // Fetching from the cache
   char cache_key_buffer[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
   auto filter_block_cache_key = GetCacheKey(rep_->base_reader_with_cache_prefix->cache_key_prefix,
-      *filter_block_handle, cache_key_buffer);
+      filter_block_handle, cache_key_buffer);
 
   Statistics* statistics = rep_->ioptions.statistics;
   auto cache_handle = GetEntryFromCache(block_cache, filter_block_cache_key,
@@ -1112,7 +1346,7 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     // For fixed-size filter we don't prefetch all filter blocks and ignore no_io parameter always
     // loading necessary filter block through block cache.
     size_t filter_size = 0;
-    filter = ReadFilterBlock(*filter_block_handle, rep_, &filter_size);
+    filter = ReadFilterBlock(filter_block_handle, rep_, &filter_size);
     if (filter != nullptr) {
       assert(filter_size > 0);
       Status s = block_cache->Insert(filter_block_cache_key, query_id,
@@ -1151,7 +1385,7 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   // index reader has already been pre-populated.
   IndexReader* index_reader = rep_->data_index_reader.get(std::memory_order_acquire);
   if (index_reader) {
-    return index_reader->NewIterator(input_iter, read_options.total_order_seek);
+    return NewIndexReaderIterator(index_reader, read_options, input_iter);
   }
   PERF_TIMER_GUARD(read_index_block_nanos);
 
@@ -1196,7 +1430,7 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
     }
 
     assert(cache_handle);
-    auto* iter = index_reader->NewIterator(input_iter, read_options.total_order_seek);
+    auto* iter = NewIndexReaderIterator(index_reader, read_options, input_iter);
     iter->RegisterCleanup(&ReleaseCachedEntry, block_cache, cache_handle);
     return iter;
   } else {
@@ -1221,20 +1455,67 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
           return ReturnErrorIterator(s, input_iter);
         }
       }
-      return index_reader->NewIterator(input_iter, read_options.total_order_seek);
+      return NewIndexReaderIterator(index_reader, read_options, input_iter);
     }
   }
 }
 
+// Iterates over index partitions of a two-level index, index_value is the handle of the index
+// partition block stored in the metadata file.
+class BlockBasedTable::IndexPartitionIteratorState : public TwoLevelIteratorState {
+ public:
+  IndexPartitionIteratorState(BlockBasedTable* table, const ReadOptions& read_options)
+      : TwoLevelIteratorState(false /* check_prefix_may_match */),
+        table_(table),
+        read_options_(read_options) {}
+
+  InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    return NewBlockIterator(table_->rep_, BlockType::kIndex, read_options_, index_value);
+  }
+
+  bool PrefixMayMatch(const Slice& internal_key) override {
+    return true;
+  }
+
+ private:
+  // Don't own table_
+  BlockBasedTable* table_;
+  const ReadOptions read_options_;
+};
+
+InternalIterator* BlockBasedTable::NewIndexReaderIterator(
+    IndexReader* index_reader, const ReadOptions& read_options, BlockIter* input_iter) {
+  if (!index_reader->IsTwoLevel()) {
+    return index_reader->NewIterator(input_iter, read_options.total_order_seek);
+  }
+  // Entries of index partitions are iterated by TwoLevelIterator, so input_iter is not used.
+  return NewTwoLevelIterator(new IndexPartitionIteratorState(this, read_options),
+      index_reader->NewIterator());
+}
+
+InternalIterator* BlockBasedTable::NewDataBlockIterator(
+    Rep* rep, const ReadOptions& ro, const Slice& index_value,
+    BlockIter* input_iter) {
+  return NewBlockIterator(rep, BlockType::kData, ro, index_value, input_iter);
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 // If input_iter is null, new a iterator
 // If input_iter is not null, update this iter and return it
-InternalIterator* BlockBasedTable::NewDataBlockIterator(
-    Rep* rep, const ReadOptions& ro, const Slice& index_value,
+InternalIterator* BlockBasedTable::NewBlockIterator(
+    Rep* rep, BlockType block_type, const ReadOptions& ro, const Slice& index_value,
     BlockIter* input_iter) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
+  const bool is_data_block = block_type == BlockType::kData;
+  FileReaderWithCachePrefix* reader = is_data_block ?
+      rep->data_reader_with_cache_prefix.get() : rep->base_reader_with_cache_prefix.get();
+  const KeyValueEncodingFormat key_value_encoding_format = is_data_block ?
+      rep->data_block_key_value_encoding_format :
+      KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix;
+  const Slice compression_dict = is_data_block ? rep->compression_dict() : Slice();
+
   const bool no_io = (ro.read_tier == kBlockCacheTier);
   Cache* block_cache = rep->table_options.block_cache.get();
   Cache* block_cache_compressed =
@@ -1266,31 +1547,30 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
     // create key for block cache
     if (block_cache != nullptr) {
-      key = GetCacheKey(rep->data_reader_with_cache_prefix->cache_key_prefix, handle, cache_key);
+      key = GetCacheKey(reader->cache_key_prefix, handle, cache_key);
     }
 
     if (block_cache_compressed != nullptr) {
-      ckey = GetCacheKey(rep->data_reader_with_cache_prefix->compressed_cache_key_prefix, handle,
-          compressed_cache_key);
+      ckey = GetCacheKey(reader->compressed_cache_key_prefix, handle, compressed_cache_key);
     }
 
     s = GetDataBlockFromCache(key, ckey, block_cache, block_cache_compressed,
                               statistics, ro, &block,
-                              rep->table_options.format_version);
+                              rep->table_options.format_version, compression_dict);
 
     if (block.value == nullptr && !no_io && ro.fill_cache) {
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
-        s = ReadBlockFromFile(rep->data_reader_with_cache_prefix->reader.get(),
+        s = ReadBlockFromFile(reader->reader.get(),
             rep->footer, ro, handle, &raw_block, rep->ioptions.env,
-            block_cache_compressed == nullptr);
+            block_cache_compressed == nullptr, compression_dict);
       }
 
       if (s.ok()) {
         s = PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
                                 ro, statistics, &block, raw_block.release(),
-                                rep->table_options.format_version);
+                                rep->table_options.format_version, compression_dict);
       }
     }
   }
@@ -1307,8 +1587,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
       }
     }
     std::unique_ptr<Block> block_value;
-    s = ReadBlockFromFile(rep->data_reader_with_cache_prefix->reader.get(), rep->footer, ro, handle,
-                          &block_value, rep->ioptions.env);
+    s = ReadBlockFromFile(reader->reader.get(), rep->footer, ro, handle, &block_value,
+                          rep->ioptions.env, true /* do_uncompress */, compression_dict);
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -1316,7 +1596,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
   InternalIterator* iter;
   if (s.ok() && block.value != nullptr) {
-    iter = block.value->NewIterator(&rep->internal_comparator, input_iter);
+    iter = block.value->NewIterator(&rep->internal_comparator, input_iter,
+        true /* total_order_seek */, key_value_encoding_format);
     if (block.cache_handle != nullptr) {
       iter->RegisterCleanup(&ReleaseCachedEntry, block_cache,
           block.cache_handle);
@@ -1345,6 +1626,7 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
         skip_filters_(skip_filters) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    MaybeReadahead(index_value);
     return NewDataBlockIterator(table_->rep_, read_options_, index_value);
   }
 
@@ -1356,10 +1638,52 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   }
 
  private:
+  // Asks the data file to read ahead of the data block of index_value once this iterator reads
+  // the data blocks sequentially. The readahead doubles every time the iterator reads past the
+  // previous one, up to max_auto_readahead_size, and restarts after a seek to another block.
+  void MaybeReadahead(const Slice& index_value) {
+    const auto& rep = *table_->rep_;
+    const size_t max_readahead_size = rep.table_options.max_auto_readahead_size;
+    if (max_readahead_size == 0 || read_options_.read_tier == kBlockCacheTier) {
+      return;
+    }
+    BlockHandle handle;
+    Slice input = index_value;
+    if (!handle.DecodeFrom(&input).ok()) {
+      return;
+    }
+    const uint64_t block_end = handle.offset() + handle.size() + kBlockTrailerSize;
+    if (handle.offset() != next_block_offset_) {
+      sequential_blocks_ = 0;
+      readahead_size_ = 0;
+      readahead_limit_ = 0;
+    }
+    next_block_offset_ = block_end;
+    if (++sequential_blocks_ <= kMinSequentialBlocksForReadahead || block_end <= readahead_limit_) {
+      return;
+    }
+    if (readahead_size_ == 0) {
+      readahead_size_ = std::min<size_t>(kInitialReadaheadSize, max_readahead_size);
+    } else {
+      readahead_size_ = std::min(readahead_size_ * 2, max_readahead_size);
+    }
+    const size_t length = std::max<size_t>(readahead_size_, block_end - handle.offset());
+    rep.data_reader_with_cache_prefix->reader->Readahead(handle.offset(), length);
+    readahead_limit_ = handle.offset() + length;
+    RecordTick(rep.ioptions.statistics, BLOCK_READAHEAD_BYTES, length);
+  }
+
   // Don't own table_
   BlockBasedTable* table_;
   const ReadOptions read_options_;
   bool skip_filters_;
+
+  // Offset of the data block following the last one read, the number of data blocks read one
+  // after another up to it, and the size and the end of the last readahead.
+  uint64_t next_block_offset_ = 0;
+  int sequential_blocks_ = 0;
+  size_t readahead_size_ = 0;
+  uint64_t readahead_limit_ = 0;
 };
 
 // This will be broken if the user specifies an unusual implementation
@@ -1513,13 +1837,17 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& intern
     RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
   } else {
     // Either filter is block-based or key may match.
-    BlockIter iiter;
-    NewIndexIterator(read_options, &iiter);
+    BlockIter iiter_on_stack;
+    InternalIterator* iiter = NewIndexIterator(read_options, &iiter_on_stack);
+    std::unique_ptr<InternalIterator> iiter_holder;
+    if (iiter != &iiter_on_stack) {
+      iiter_holder.reset(iiter);
+    }
 
     bool done = false;
-    for (iiter.Seek(internal_key); iiter.Valid() && !done; iiter.Next()) {
+    for (iiter->Seek(internal_key); iiter->Valid() && !done; iiter->Next()) {
       {
-        Slice data_block_handle_encoded = iiter.value();
+        Slice data_block_handle_encoded = iiter->value();
 
         if (!skip_filters && is_block_based_filter) {
           RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_CHECKED);
@@ -1539,7 +1867,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& intern
       }
 
       BlockIter biter;
-      NewDataBlockIterator(rep_, read_options, iiter.value(), &biter);
+      NewDataBlockIterator(rep_, read_options, iiter->value(), &biter);
 
       if (read_options.read_tier == kBlockCacheTier &&
           biter.status().IsIncomplete()) {
@@ -1569,7 +1897,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& intern
       s = biter.status();
     }
     if (s.ok()) {
-      s = iiter.status();
+      s = iiter->status();
     }
   }
 
@@ -1579,28 +1907,44 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& intern
 
 Status BlockBasedTable::Prefetch(const Slice* const begin,
                                  const Slice* const end) {
+  return LoadDataBlocks(begin, end, false /* pin */);
+}
+
+Status BlockBasedTable::Pin(const Slice* const begin, const Slice* const end) {
+  if (!rep_->table_options.pinned_blocks_mem_tracker || !rep_->table_options.block_cache) {
+    return STATUS(NotSupported, "Pinning blocks requires block cache and pinned blocks tracker");
+  }
+  return LoadDataBlocks(begin, end, true /* pin */);
+}
+
+Status BlockBasedTable::LoadDataBlocks(const Slice* const begin, const Slice* const end,
+                                       bool pin) {
   auto& comparator = rep_->internal_comparator;
   // pre-condition
   if (begin && end && comparator.Compare(*begin, *end) > 0) {
     return STATUS(InvalidArgument, *begin, *end);
   }
 
-  BlockIter iiter;
-  NewIndexIterator(ReadOptions::kDefault, &iiter);
+  BlockIter iiter_on_stack;
+  InternalIterator* iiter = NewIndexIterator(ReadOptions::kDefault, &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_holder;
+  if (iiter != &iiter_on_stack) {
+    iiter_holder.reset(iiter);
+  }
 
-  if (!iiter.status().ok()) {
+  if (!iiter->status().ok()) {
     // error opening index iterator
-    return iiter.status();
+    return iiter->status();
   }
 
   // indicates if we are on the last page that need to be pre-fetched
   bool prefetching_boundary_page = false;
 
-  for (begin ? iiter.Seek(*begin) : iiter.SeekToFirst(); iiter.Valid();
-       iiter.Next()) {
-    Slice block_handle = iiter.value();
+  for (begin ? iiter->Seek(*begin) : iiter->SeekToFirst(); iiter->Valid();
+       iiter->Next()) {
+    Slice block_handle = iiter->value();
 
-    if (end && comparator.Compare(iiter.key(), *end) >= 0) {
+    if (end && comparator.Compare(iiter->key(), *end) >= 0) {
       if (prefetching_boundary_page) {
         break;
       }
@@ -1618,6 +1962,17 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
       // there was an unexpected error while pre-fetching
       return biter.status();
     }
+
+    if (pin) {
+      BlockHandle handle;
+      Slice input = block_handle;
+      RETURN_NOT_OK(handle.DecodeFrom(&input));
+      char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+      if (!PinCachedBlock(GetCacheKey(
+              rep_->data_reader_with_cache_prefix->cache_key_prefix, handle, cache_key))) {
+        return STATUS(Incomplete, "Budget for pinned blocks exhausted");
+      }
+    }
   }
 
   return Status::OK();
@@ -1643,7 +1998,7 @@ bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
   Slice ckey;
 
   s = GetDataBlockFromCache(cache_key, ckey, block_cache, nullptr, nullptr, options, &block,
-      rep_->table_options.format_version);
+      rep_->table_options.format_version, rep_->compression_dict());
   assert(s.ok());
   bool in_cache = block.value != nullptr;
   if (in_cache) {
@@ -1677,11 +2032,13 @@ Status BlockBasedTable::CreateDataBlockIndexReader(
   auto comparator = &rep_->internal_comparator;
   const Footer& footer = rep_->footer;
 
+  const SliceTransform* hash_index_prefix_extractor =
+      HashIndexPrefixExtractor(rep_->table_options, rep_->ioptions.prefix_extractor);
   if (index_type_on_file == BlockBasedTableOptions::kHashSearch &&
-      rep_->ioptions.prefix_extractor == nullptr) {
+      hash_index_prefix_extractor == nullptr) {
     RLOG(InfoLogLevel::WARN_LEVEL, rep_->ioptions.info_log,
         "BlockBasedTableOptions::kHashSearch requires "
-        "options.prefix_extractor to be set."
+        "options.prefix_extractor or hash_index_prefix_extractor to be set."
         " Fall back to binary search index.");
     index_type_on_file = BlockBasedTableOptions::kBinarySearch;
   }
@@ -1691,6 +2048,10 @@ Status BlockBasedTable::CreateDataBlockIndexReader(
       return BinarySearchIndexReader::Create(
           file, footer, footer.index_handle(), env, comparator, index_reader);
     }
+    case BlockBasedTableOptions::kTwoLevelIndexSearch: {
+      return TwoLevelIndexReader::Create(
+          file, footer, footer.index_handle(), env, comparator, index_reader);
+    }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> meta_guard;
       std::unique_ptr<InternalIterator> meta_iter_guard;
@@ -1712,7 +2073,7 @@ Status BlockBasedTable::CreateDataBlockIndexReader(
       // We need to wrap data with internal_prefix_transform to make sure it can
       // handle prefix correctly.
       rep_->internal_prefix_transform.reset(
-          new InternalKeySliceTransform(rep_->ioptions.prefix_extractor));
+          new InternalKeySliceTransform(hash_index_prefix_extractor));
       return HashIndexReader::Create(
           rep_->internal_prefix_transform.get(), footer, file, env, comparator,
           footer.index_handle(), meta_index_iter, index_reader,
@@ -1767,6 +2128,11 @@ bool BlockBasedTable::TEST_index_reader_loaded() const {
   return rep_->data_index_reader.get() != nullptr;
 }
 
+size_t BlockBasedTable::TEST_pinned_blocks_size() const {
+  std::lock_guard<std::mutex> lock(rep_->pinned_blocks_mutex);
+  return rep_->pinned_blocks_size;
+}
+
 Status BlockBasedTable::DumpTable(WritableFile* out_file) {
   // Output Footer
   out_file->Append(
@@ -156,6 +156,10 @@ class BlockBasedTable : public TableReader {
   // IO or iteration error.
   Status Prefetch(const Slice* begin, const Slice* end) override;
 
+  // Same as Prefetch, but also pins the blocks in the block cache, see
+  // BlockBasedTableOptions::pinned_blocks_mem_tracker.
+  Status Pin(const Slice* begin, const Slice* end) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -183,6 +187,8 @@ class BlockBasedTable : public TableReader {
 
   bool TEST_filter_block_preloaded() const;
   bool TEST_index_reader_loaded() const;
+  // Total size of block cache entries pinned by this table.
+  size_t TEST_pinned_blocks_size() const;
   // Implementation of IndexReader will be exposed to internal cc file only.
   class IndexReader;
 
@@ -196,11 +202,27 @@ class BlockBasedTable : public TableReader {
   Rep* rep_;
 
   class BlockEntryIteratorState;
+  class IndexPartitionIteratorState;
+
   // input_iter: if it is not null, update this one and return it as Iterator
   static InternalIterator* NewDataBlockIterator(
       Rep* rep, const ReadOptions& ro, const Slice& index_value,
       BlockIter* input_iter = nullptr);
 
+  enum class BlockType {
+    // Data block, stored in the data file.
+    kData,
+    // Index partition of a two-level index, stored in the metadata file.
+    kIndex,
+  };
+
+  // Same as NewDataBlockIterator, but for blocks of the specified type. Data blocks are read from
+  // the data file and are decoded with the key value encoding format and compression dictionary of
+  // the table.
+  static InternalIterator* NewBlockIterator(
+      Rep* rep, BlockType block_type, const ReadOptions& ro, const Slice& index_value,
+      BlockIter* input_iter = nullptr);
+
   // Returns filter block handle for fixed-size bloom filter using filter index and filter key.
   Status GetFixedSizeFilterBlockHandle(const Slice& filter_key,
       BlockHandle* filter_block_handle) const;
@@ -221,6 +243,24 @@ class BlockBasedTable : public TableReader {
                                              bool no_io = false,
                                              const Slice* filter_key = nullptr) const;
 
+  // Returns the filter block with the specified handle from the block cache, reading it from the
+  // file and adding it to the cache if necessary.
+  CachableEntry<FilterBlockReader> GetFilterBlock(const BlockHandle& filter_block_handle,
+                                                  const QueryId query_id,
+                                                  bool no_io) const;
+
+  // Loads the index and filter blocks into the block cache and pins them there, until the budget
+  // for pinned blocks is exhausted.
+  void PinIndexAndFilterBlocks();
+
+  // Keeps the block cache entry with the specified key referenced until the table is closed.
+  // Returns false if the entry is not in the cache or does not fit into the budget for pinned
+  // blocks.
+  bool PinCachedBlock(const Slice& cache_key);
+
+  // Loads data blocks of the specified range into the block cache, pinning them if pin is true.
+  Status LoadDataBlocks(const Slice* begin, const Slice* end, bool pin);
+
   // Get the iterator from the index reader.
   // If input_iter is not set, return new Iterator
   // If input_iter is set, update it and return it as Iterator
@@ -231,9 +271,17 @@ class BlockBasedTable : public TableReader {
   //  2. index is not present in block cache.
   //  3. We disallowed any io to be performed, that is, read_options ==
   //     kBlockCacheTier
+  //
+  // For two-level index input_iter is not updated and a new iterator over the entries of index
+  // partitions is returned instead.
   InternalIterator* NewIndexIterator(const ReadOptions& read_options,
                                      BlockIter* input_iter = nullptr);
 
+  // Creates an iterator over data index entries using the specified index reader.
+  InternalIterator* NewIndexReaderIterator(IndexReader* index_reader,
+                                           const ReadOptions& read_options,
+                                           BlockIter* input_iter);
+
   // Read block cache from block caches (if set): block_cache and
   // block_cache_compressed.
   // On success, Status::OK with be returned and @block will be populated with
@@ -242,7 +290,8 @@ class BlockBasedTable : public TableReader {
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
       const ReadOptions& read_options,
-      BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version);
+      BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
+      const Slice& compression_dict);
   // Put a raw block (maybe compressed) to the corresponding block caches.
   // This method will perform decompression against raw_block if needed and then
   // populate the block caches.
@@ -255,7 +304,8 @@ class BlockBasedTable : public TableReader {
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, Statistics* statistics,
-      CachableEntry<Block>* block, Block* raw_block, uint32_t format_version);
+      CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
+      const Slice& compression_dict);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -40,6 +40,20 @@
 //     value: char[value_length]
 // shared_bytes == 0 for restart points.
 //
+// With KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefixAndParts, keys that have the same size
+// as the previous key could also be stored in parts:
+//     shared_bytes: varint32
+//     (unshared_bytes << 1) | 1: varint32
+//     value_length: varint32
+//     parts, until the whole key is covered:
+//         stored_bytes: varint32
+//         kept_bytes: varint32
+//         key_part: char[stored_bytes]
+//     value: char[value_length]
+// Each part is stored_bytes of the key followed by kept_bytes equal to the bytes of the previous
+// key at the same positions, unshared_bytes is the sum of stored_bytes. Other entries have
+// (unshared_bytes << 1) as the second field. Restart points are never stored in parts.
+//
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
@@ -57,9 +71,19 @@
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+namespace {
+
+// Minimal number of equal bytes in the middle of a key that are kept from the previous key. Each
+// additional part takes at least 2 bytes for its sizes.
+constexpr size_t kMinKeptPartSize = 3;
+
+}  // namespace
+
+BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding,
+                           KeyValueEncodingFormat key_value_encoding_format)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
+      key_value_encoding_format_(key_value_encoding_format),
       restarts_(),
       counter_(0),
       finished_(false) {
@@ -125,13 +149,36 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   }
   const size_t non_shared = key.size() - shared;
 
-  // Add "<shared><non_shared><value_size>" to buffer_
-  PutVarint32(&buffer_, static_cast<uint32_t>(shared));
-  PutVarint32(&buffer_, static_cast<uint32_t>(non_shared));
-  PutVarint32(&buffer_, static_cast<uint32_t>(value.size()));
-
-  // Add string delta to buffer_ followed by value
-  buffer_.append(key.cdata() + shared, non_shared);
+  if (key_value_encoding_format_ == KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix) {
+    // Add "<shared><non_shared><value_size>" to buffer_
+    PutVarint32(&buffer_, static_cast<uint32_t>(shared));
+    PutVarint32(&buffer_, static_cast<uint32_t>(non_shared));
+    PutVarint32(&buffer_, static_cast<uint32_t>(value.size()));
+
+    // Add string delta to buffer_ followed by value
+    buffer_.append(key.cdata() + shared, non_shared);
+  } else if (counter_ != 0 && use_delta_encoding_ && key.size() == last_key_.size() &&
+             ComputeKeyParts(key, shared)) {
+    size_t stored = 0;
+    for (const auto& part : key_parts_) {
+      stored += part.first;
+    }
+    PutVarint32(&buffer_, static_cast<uint32_t>(shared));
+    PutVarint32(&buffer_, static_cast<uint32_t>((stored << 1) | 1));
+    PutVarint32(&buffer_, static_cast<uint32_t>(value.size()));
+    size_t pos = shared;
+    for (const auto& part : key_parts_) {
+      PutVarint32(&buffer_, static_cast<uint32_t>(part.first));
+      PutVarint32(&buffer_, static_cast<uint32_t>(part.second));
+      buffer_.append(key.cdata() + pos, part.first);
+      pos += part.first + part.second;
+    }
+  } else {
+    PutVarint32(&buffer_, static_cast<uint32_t>(shared));
+    PutVarint32(&buffer_, static_cast<uint32_t>(non_shared << 1));
+    PutVarint32(&buffer_, static_cast<uint32_t>(value.size()));
+    buffer_.append(key.cdata() + shared, non_shared);
+  }
   buffer_.append(value.cdata(), value.size());
 
   // Update state
@@ -141,4 +188,37 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   counter_++;
 }
 
+bool BlockBuilder::ComputeKeyParts(const Slice& key, size_t shared) {
+  const size_t size = key.size();
+  key_parts_.clear();
+  size_t encoded_size = 0;
+  size_t part_start = shared;
+  size_t pos = shared;
+  while (pos < size) {
+    if (key[pos] != last_key_[pos]) {
+      ++pos;
+      continue;
+    }
+    size_t equal_end = pos + 1;
+    while (equal_end < size && key[equal_end] == last_key_[equal_end]) {
+      ++equal_end;
+    }
+    // Equal bytes at the end of the key are always kept, since the last part has the size of kept
+    // bytes anyway.
+    if (equal_end == size || equal_end - pos >= kMinKeptPartSize) {
+      const size_t stored = pos - part_start;
+      key_parts_.emplace_back(stored, equal_end - pos);
+      encoded_size += VarintLength(stored) + VarintLength(equal_end - pos) + stored;
+      part_start = equal_end;
+    }
+    pos = equal_end;
+  }
+  if (part_start < size) {
+    const size_t stored = size - part_start;
+    key_parts_.emplace_back(stored, 0);
+    encoded_size += VarintLength(stored) + 1 + stored;
+  }
+  return encoded_size < size - shared;
+}
+
 }  // namespace rocksdb
@@ -24,7 +24,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <utility>
 #include <vector>
+
+#include "yb/rocksdb/table.h"
 #include "yb/util/slice.h"
 
 namespace rocksdb {
@@ -35,7 +38,9 @@ class BlockBuilder {
   void operator=(const BlockBuilder&) = delete;
 
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        KeyValueEncodingFormat key_value_encoding_format =
+                            KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefix);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -62,14 +67,23 @@ class BlockBuilder {
   }
 
  private:
+  // Splits the part of key after the shared prefix into the parts stored in the block and the parts
+  // kept from the previous key, see kKeyDeltaEncodingSharedPrefixAndParts. Returns false when
+  // storing the parts does not take less space than storing the whole non-shared part of the key.
+  bool ComputeKeyParts(const Slice& key, size_t shared);
+
   const int          block_restart_interval_;
   const bool         use_delta_encoding_;
+  const KeyValueEncodingFormat key_value_encoding_format_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
   std::string           last_key_;
+  // Parts of the last added key computed by ComputeKeyParts: sizes of bytes stored in the block
+  // and of bytes kept from the previous key.
+  std::vector<std::pair<size_t, size_t>> key_parts_;
 };
 
 }  // namespace rocksdb
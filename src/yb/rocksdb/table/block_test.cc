@@ -140,6 +140,71 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+// Keys of the same size, that differ in the middle and at the end like DocDB keys of the columns
+// of a row, which differ in the column id, write id of the hybrid time and the sequence number.
+TEST_F(BlockTest, SharedPrefixAndPartsEncoding) {
+  Random rnd(301);
+  Options options = Options();
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  char buf[64];
+  for (int row = 0; row < 300; ++row) {
+    for (int column = 0; column < 10; ++column) {
+      snprintf(buf, sizeof(buf), "row%06d|col%02d|ht1234567890|%03d|seq%05d",
+               row, column, column, row * 10 + column);
+      keys.emplace_back(buf);
+      values.emplace_back(RandomString(&rnd, rnd.Uniform(20)));
+    }
+  }
+
+  BlockBuilder legacy_builder(16);
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefixAndParts);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    legacy_builder.Add(keys[i], values[i]);
+    builder.Add(keys[i], values[i]);
+  }
+  const size_t legacy_size = legacy_builder.Finish().size();
+  Slice rawblock = builder.Finish();
+  ASSERT_LT(rawblock.size(), legacy_size);
+
+  BlockContents contents;
+  contents.data = rawblock;
+  contents.cachable = false;
+  Block reader(std::move(contents));
+
+  std::unique_ptr<InternalIterator> iter(reader.NewIterator(
+      options.comparator, nullptr /* iter */, true /* total_order_seek */,
+      KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefixAndParts));
+  size_t count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); ++count, iter->Next()) {
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    ASSERT_EQ(values[count], iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(keys.size(), count);
+
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    --count;
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    ASSERT_EQ(values[count], iter->value().ToString());
+  }
+  ASSERT_EQ(0, count);
+
+  for (int i = 0; i < 1000; ++i) {
+    const size_t index = rnd.Uniform(static_cast<int>(keys.size()));
+    iter->Seek(keys[index]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(keys[index], iter->key().ToString());
+    ASSERT_EQ(values[index], iter->value().ToString());
+    if (index + 1 < keys.size()) {
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[index + 1], iter->key().ToString());
+    }
+  }
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
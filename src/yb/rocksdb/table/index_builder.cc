@@ -24,7 +24,8 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
     BlockBasedTableOptions::IndexType type,
     const Comparator* comparator,
     const SliceTransform* prefix_extractor,
-    int index_block_restart_interval) {
+    int index_block_restart_interval,
+    size_t index_block_size) {
   switch (type) {
     case BlockBasedTableOptions::kBinarySearch: {
       return new ShortenedIndexBuilder(comparator,
@@ -34,6 +35,10 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
       return new HashIndexBuilder(comparator, prefix_extractor,
                                   index_block_restart_interval);
     }
+    case BlockBasedTableOptions::kTwoLevelIndexSearch: {
+      return new TwoLevelIndexBuilder(comparator, index_block_restart_interval,
+                                      index_block_size);
+    }
     default: {
       assert(!"Do not recognize the index type ");
       return nullptr;
@@ -115,4 +120,63 @@ void HashIndexBuilder::FlushPendingPrefix() {
   PutVarint32(&prefix_meta_block_, pending_block_num_);
 }
 
+void TwoLevelIndexBuilder::AddIndexEntry(
+    std::string* last_key_in_current_block,
+    const Slice* first_key_in_next_block,
+    const BlockHandle& block_handle) {
+  if (!current_partition_) {
+    current_partition_.reset(new ShortenedIndexBuilder(comparator_, index_block_restart_interval_));
+  }
+  current_partition_->AddIndexEntry(
+      last_key_in_current_block, first_key_in_next_block, block_handle);
+  // last_key_in_current_block now contains the key used by the index entry, which is also the
+  // largest key of the partition.
+  current_partition_last_key_ = *last_key_in_current_block;
+  if (current_partition_->EstimatedSize() >= index_block_size_) {
+    FlushCurrentPartition();
+  }
+}
+
+void TwoLevelIndexBuilder::FlushCurrentPartition() {
+  if (!current_partition_) {
+    return;
+  }
+  pending_partitions_.push_back(Partition{
+      std::move(current_partition_last_key_), std::move(current_partition_)});
+  current_partition_last_key_.clear();
+}
+
+Status TwoLevelIndexBuilder::Finish(IndexBlocks* index_blocks) {
+  if (!finishing_) {
+    FlushCurrentPartition();
+    finishing_ = true;
+  }
+  if (pending_partitions_.empty()) {
+    index_blocks->index_block_contents = top_level_index_block_builder_.Finish();
+    return Status::OK();
+  }
+  RETURN_NOT_OK(pending_partitions_.front().builder->Finish(index_blocks));
+  return STATUS(Incomplete, "Index partitions are not written yet");
+}
+
+void TwoLevelIndexBuilder::OnPartitionWritten(const BlockHandle& partition_block_handle) {
+  assert(finishing_ && !pending_partitions_.empty());
+  std::string handle_encoding;
+  partition_block_handle.EncodeTo(&handle_encoding);
+  top_level_index_block_builder_.Add(pending_partitions_.front().last_key, handle_encoding);
+  written_partitions_size_ += partition_block_handle.size() + kBlockTrailerSize;
+  pending_partitions_.pop_front();
+}
+
+size_t TwoLevelIndexBuilder::EstimatedSize() const {
+  size_t result = written_partitions_size_ + top_level_index_block_builder_.CurrentSizeEstimate();
+  for (const auto& partition : pending_partitions_) {
+    result += partition.builder->EstimatedSize();
+  }
+  if (current_partition_) {
+    result += current_partition_->EstimatedSize();
+  }
+  return result;
+}
+
 } // namespace rocksdb
@@ -14,6 +14,8 @@
 #ifndef YB_ROCKSDB_TABLE_INDEX_BUILDER_H
 #define YB_ROCKSDB_TABLE_INDEX_BUILDER_H
 
+#include <deque>
+
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/table/block_builder.h"
 
@@ -38,7 +40,8 @@ class IndexBuilder {
       BlockBasedTableOptions::IndexType index_type,
       const Comparator* comparator,
       const SliceTransform* prefix_extractor,
-      const int index_block_restart_interval);
+      const int index_block_restart_interval,
+      const size_t index_block_size);
 
   // Index builder will construct a set of blocks which contain:
   //  1. One primary index block.
@@ -75,8 +78,16 @@ class IndexBuilder {
   // may therefore perform any operation required for block finalization.
   //
   // REQUIRES: Finish() has not yet been called.
+  //
+  // Index builders that split the index into partitions return Status::Incomplete() together
+  // with the contents of the next partition to be written. The caller should write it, report
+  // its handle through OnPartitionWritten() and call Finish() again. The last call returns
+  // Status::OK() together with the top-level index block.
   virtual Status Finish(IndexBlocks* index_blocks) = 0;
 
+  // Called after the partition returned by the last Finish() call has been written.
+  virtual void OnPartitionWritten(const BlockHandle& partition_block_handle) {}
+
   // Get the estimated size for index block.
   virtual size_t EstimatedSize() const = 0;
 
@@ -183,6 +194,54 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// TwoLevelIndexBuilder splits the index into partitions, each of them is a space-efficient index
+// block built by ShortenedIndexBuilder, and builds a top-level index block on top of them.
+// A partition is closed once its size reaches index_block_size. The top-level index maps the
+// last key of each partition to the handle of the partition block, so it is much smaller than a
+// single-level index and only the partitions needed by reads have to be loaded.
+class TwoLevelIndexBuilder : public IndexBuilder {
+ public:
+  TwoLevelIndexBuilder(const Comparator* comparator, int index_block_restart_interval,
+                       size_t index_block_size)
+      : IndexBuilder(comparator),
+        index_block_restart_interval_(index_block_restart_interval),
+        index_block_size_(index_block_size),
+        top_level_index_block_builder_(index_block_restart_interval) {}
+
+  void AddIndexEntry(
+      std::string* last_key_in_current_block,
+      const Slice* first_key_in_next_block,
+      const BlockHandle& block_handle) override;
+
+  Status Finish(IndexBlocks* index_blocks) override;
+
+  void OnPartitionWritten(const BlockHandle& partition_block_handle) override;
+
+  size_t EstimatedSize() const override;
+
+ private:
+  void FlushCurrentPartition();
+
+  struct Partition {
+    std::string last_key;
+    std::unique_ptr<ShortenedIndexBuilder> builder;
+  };
+
+  const int index_block_restart_interval_;
+  const size_t index_block_size_;
+
+  std::unique_ptr<ShortenedIndexBuilder> current_partition_;
+  std::string current_partition_last_key_;
+
+  // Partitions that are full but not yet written, the front one is being written during Finish().
+  std::deque<Partition> pending_partitions_;
+  bool finishing_ = false;
+
+  BlockBuilder top_level_index_block_builder_;
+  // Total size of already written partitions.
+  size_t written_partitions_size_ = 0;
+};
+
 } // namespace rocksdb
 
 #endif  // YB_ROCKSDB_TABLE_INDEX_BUILDER_H
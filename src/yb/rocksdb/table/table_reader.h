@@ -110,6 +110,12 @@ class TableReader {
     return Status::OK();
   }
 
+  // Same as Prefetch, but also keeps the loaded blocks in memory until the table is closed, for
+  // key ranges that are read frequently.
+  virtual Status Pin(const Slice* begin = nullptr, const Slice* end = nullptr) {
+    return STATUS(NotSupported, "Pin() not supported");
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* out_file) {
     return STATUS(NotSupported, "DumpTable() not supported");
@@ -62,6 +62,8 @@
 #include "yb/rocksdb/util/testharness.h"
 #include "yb/rocksdb/util/testutil.h"
 
+#include "yb/util/mem_tracker.h"
+
 DECLARE_double(cache_single_touch_ratio);
 
 namespace rocksdb {
@@ -1199,6 +1201,66 @@ TEST_F(BlockBasedTableTest, PrefetchTest) {
                 STATUS(InvalidArgument, Slice("k06 "), Slice("k07")));
 }
 
+TEST_F(BlockBasedTableTest, PinBlocks) {
+  Options opt;
+  opt.compression = kNoCompression;
+  auto mem_tracker = yb::MemTracker::CreateTracker(-1, "pinned_blocks");
+  auto consumption = [](const std::shared_ptr<yb::MemTracker>& tracker) {
+    return static_cast<size_t>(tracker->consumption());
+  };
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.block_cache = NewLRUCache((16 * 1024 * 1024) / FLAGS_cache_single_touch_ratio);
+  table_options.pinned_blocks_mem_tracker = mem_tracker;
+  opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(opt);
+
+  size_t index_size = 0;
+  {
+    TableConstructor c(BytewiseComparator());
+    c.Add("k01", "hello");
+    c.Add("k02", std::string(100000, 'x'));
+    c.Add("k03", std::string(200000, 'x'));
+    c.Add("k04", "hello2");
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    c.Finish(opt, ioptions, table_options, GetPlainInternalComparator(opt.comparator), &keys,
+             &kvmap);
+    auto* reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
+
+    // The index block is pinned when the table is opened.
+    index_size = reader->TEST_pinned_blocks_size();
+    ASSERT_GT(index_size, 0U);
+    ASSERT_EQ(index_size, consumption(mem_tracker));
+
+    Slice begin("k03");
+    ASSERT_OK(reader->Pin(&begin, nullptr));
+    const size_t pinned_size = reader->TEST_pinned_blocks_size();
+    ASSERT_GT(pinned_size, index_size + 200000);
+    ASSERT_LT(pinned_size, index_size + 300000);
+    ASSERT_EQ(pinned_size, consumption(mem_tracker));
+    AssertKeysInCache(reader, {"k03", "k04"}, {"k01", "k02"});
+
+    // Blocks that are already pinned are not accounted again.
+    ASSERT_OK(reader->Pin(&begin, nullptr));
+    ASSERT_EQ(pinned_size, reader->TEST_pinned_blocks_size());
+    ASSERT_EQ(pinned_size, consumption(mem_tracker));
+
+    // Pinning stops when the budget is exhausted.
+    auto small_tracker = yb::MemTracker::CreateTracker(index_size + 1000, "small");
+    table_options.pinned_blocks_mem_tracker = small_tracker;
+    opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableCFOptions ioptions2(opt);
+    ASSERT_OK(c.Reopen(ioptions2));
+    reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
+    ASSERT_EQ(0, mem_tracker->consumption());
+    ASSERT_TRUE(reader->Pin(nullptr, nullptr).IsIncomplete());
+    ASSERT_LE(consumption(small_tracker), index_size + 1000);
+  }
+  ASSERT_EQ(0, mem_tracker->consumption());
+}
+
 TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   BlockBasedTableOptions table_options;
   for (int i = 0; i < 5; ++i) {
@@ -1289,6 +1351,61 @@ TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   }
 }
 
+// The hash index can use its own prefix extractor, while the column family has none.
+TEST_F(BlockBasedTableTest, HashIndexPrefixExtractor) {
+  Options options;
+  BlockBasedTableOptions table_options;
+  // Make each key/value an individual block
+  table_options.block_size = 64;
+  table_options.index_type = BlockBasedTableOptions::kHashSearch;
+  table_options.hash_index_prefix_extractor.reset(NewFixedPrefixTransform(4));
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  ASSERT_OK(options.table_factory->SanitizeOptions(DBOptions(options),
+                                                   ColumnFamilyOptions(options)));
+
+  TableConstructor c(BytewiseComparator(), true);
+  c.Add("aaaa1", std::string('a', 56));
+  c.Add("bbbb1", std::string('a', 56));
+  c.Add("bbbb2", std::string('a', 56));
+  c.Add("bbbb3", std::string('a', 56));
+  c.Add("cccc1", std::string('a', 56));
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  ASSERT_EQ(nullptr, ioptions.prefix_extractor);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+
+  // Prefix seeks find the blocks of the prefix through the hash index.
+  {
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+    iter->Seek(InternalKey("bbbb2", 0, kTypeValue).Encode());
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("bbbb2", ExtractUserKey(iter->key()).ToString());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("bbbb3", ExtractUserKey(iter->key()).ToString());
+  }
+
+  // Total order seeks do not depend on the prefix of the target.
+  {
+    ReadOptions ro;
+    ro.total_order_seek = true;
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ro));
+    iter->Seek(InternalKey("b", 0, kTypeValue).Encode());
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("bbbb1", ExtractUserKey(iter->key()).ToString());
+    size_t count = 0;
+    for (; iter->Valid(); iter->Next()) {
+      ++count;
+    }
+    ASSERT_EQ(4u, count);
+  }
+}
+
 TEST_F(BlockBasedTableTest, NoopTransformSeek) {
   BlockBasedTableOptions table_options;
   for (int it = 0; it < 2; it++) {
@@ -1498,6 +1615,192 @@ TEST_F(BlockBasedTableTest, IndexSizeStat) {
   }
 }
 
+TEST_F(BlockBasedTableTest, TwoLevelIndex) {
+  TableConstructor c(BytewiseComparator());
+  constexpr int kNumKeys = 1000;
+  char buf[16];
+  for (int i = 0; i < kNumKeys; ++i) {
+    snprintf(buf, sizeof(buf), "k%05d", i * 2);
+    c.Add(InternalKey(buf, 0, kTypeValue).Encode().ToString(), std::string(buf) + "_value");
+  }
+
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  Options options;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  // Make each key/value an individual block and put several index entries into each partition.
+  table_options.block_size = 32;
+  table_options.index_block_size = 256;
+  table_options.block_cache = NewLRUCache(1024 * 1024);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+  ASSERT_EQ(static_cast<uint64_t>(kNumKeys), reader->GetTableProperties()->num_data_blocks);
+
+  std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+  auto expected = kvmap.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+    ASSERT_TRUE(expected != kvmap.end());
+    ASSERT_EQ(expected->first, iter->key().ToString());
+    ASSERT_EQ(expected->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected == kvmap.end());
+
+  auto reverse_expected = kvmap.rbegin();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++reverse_expected) {
+    ASSERT_TRUE(reverse_expected != kvmap.rend());
+    ASSERT_EQ(reverse_expected->first, iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(reverse_expected == kvmap.rend());
+
+  for (int i = 0; i < kNumKeys * 2; ++i) {
+    snprintf(buf, sizeof(buf), "k%05d", i);
+    const std::string user_key = buf;
+    const std::string encoded_key = InternalKey(user_key, 0, kTypeValue).Encode().ToString();
+
+    // Seek to odd key should land on the next even key.
+    iter->Seek(encoded_key);
+    ASSERT_OK(iter->status());
+    if (i == kNumKeys * 2 - 1) {
+      ASSERT_FALSE(iter->Valid());
+    } else {
+      ASSERT_TRUE(iter->Valid());
+      snprintf(buf, sizeof(buf), "k%05d", (i + 1) / 2 * 2);
+      ASSERT_EQ(buf, ExtractUserKey(iter->key()).ToString());
+    }
+
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(), encoded_key, &get_context));
+    if (i % 2 == 0) {
+      ASSERT_EQ(user_key + "_value", value);
+    } else {
+      ASSERT_TRUE(value.empty());
+    }
+  }
+}
+
+TEST_F(BlockBasedTableTest, CompressionDict) {
+  if (!ZSTD_TrainDictionarySupported()) {
+    fprintf(stderr, "skipping compression dictionary test\n");
+    return;
+  }
+  Random rnd(301);
+  constexpr int kNumKeys = 2000;
+  // Similar JSON values, that are much smaller than a block and compress poorly on their own.
+  std::vector<std::pair<std::string, std::string>> kvs;
+  char buf[300];
+  for (int i = 0; i < kNumKeys; ++i) {
+    snprintf(buf, sizeof(buf), "k%05d", i);
+    std::string key = InternalKey(buf, 0, kTypeValue).Encode().ToString();
+    snprintf(buf, sizeof(buf),
+             "{\"id\": %d, \"name\": \"%s\", \"status\": \"%s\", \"created_at\": "
+             "\"2018-01-%02d\", \"tags\": [\"alpha\", \"beta\", \"gamma\"], "
+             "\"address\": {\"city\": \"%s\", \"zip\": \"%05d\"}}",
+             i, RandomString(&rnd, 8).c_str(), i % 3 ? "active" : "inactive",
+             1 + i % 28, RandomString(&rnd, 6).c_str(), rnd.Uniform(100000));
+    kvs.emplace_back(std::move(key), buf);
+  }
+
+  uint64_t data_size[2];
+  for (const uint32_t max_dict_bytes : {0, 4096}) {
+    TableConstructor c(BytewiseComparator());
+    for (const auto& kv : kvs) {
+      c.Add(kv.first, kv.second);
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    Options options;
+    options.compression = kZSTDNotFinalCompression;
+    // 100 * max_dict_bytes is less than the total size, so the dictionary is trained before the
+    // last entries are added.
+    options.compression_opts.max_dict_bytes = max_dict_bytes;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    table_options.block_cache = NewLRUCache(1024 * 1024);
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableCFOptions ioptions(options);
+    c.Finish(options, ioptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    auto* reader = c.GetTableReader();
+    data_size[max_dict_bytes != 0] = reader->GetTableProperties()->data_size;
+
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+    auto expected = kvmap.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != kvmap.end());
+      ASSERT_EQ(expected->first, iter->key().ToString());
+      ASSERT_EQ(expected->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected == kvmap.end());
+  }
+  ASSERT_LT(data_size[1], data_size[0]);
+}
+
+TEST_F(BlockBasedTableTest, ParallelCompression) {
+  if (!Snappy_Supported()) {
+    fprintf(stderr, "skipping parallel compression test\n");
+    return;
+  }
+  Random rnd(301);
+  constexpr int kNumKeys = 5000;
+  std::vector<std::pair<std::string, std::string>> kvs;
+  char buf[100];
+  for (int i = 0; i < kNumKeys; ++i) {
+    snprintf(buf, sizeof(buf), "k%05d", i);
+    kvs.emplace_back(InternalKey(buf, 0, kTypeValue).Encode().ToString(),
+                     RandomString(&rnd, 20) + std::string(80, 'x'));
+  }
+
+  TableProperties properties[2];
+  for (const uint32_t parallel_threads : {1, 4}) {
+    TableConstructor c(BytewiseComparator());
+    for (const auto& kv : kvs) {
+      c.Add(kv.first, kv.second);
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    Options options;
+    options.compression = kSnappyCompression;
+    options.compression_opts.parallel_threads = parallel_threads;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableCFOptions ioptions(options);
+    c.Finish(options, ioptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    auto* reader = c.GetTableReader();
+    properties[parallel_threads > 1] = *reader->GetTableProperties();
+
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+    auto expected = kvmap.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != kvmap.end());
+      ASSERT_EQ(expected->first, iter->key().ToString());
+      ASSERT_EQ(expected->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected == kvmap.end());
+
+    iter->Seek(kvs[kNumKeys / 2].first);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(kvs[kNumKeys / 2].second, iter->value().ToString());
+  }
+  // Blocks are the same, only the thread compressing them differs.
+  ASSERT_GT(properties[1].num_data_blocks, 1U);
+  ASSERT_EQ(properties[0].num_data_blocks, properties[1].num_data_blocks);
+  ASSERT_EQ(properties[0].data_size, properties[1].data_size);
+}
+
 TEST_F(BlockBasedTableTest, NumBlockStat) {
   Random rnd(test::RandomSeed());
   TableConstructor c(BytewiseComparator());
@@ -1523,6 +1826,70 @@ TEST_F(BlockBasedTableTest, NumBlockStat) {
             c.GetTableReader()->GetTableProperties()->num_data_blocks);
 }
 
+TEST_F(BlockBasedTableTest, AutoReadahead) {
+  Random rnd(test::RandomSeed());
+  TableConstructor c(BytewiseComparator());
+  Options options;
+  options.compression = kNoCompression;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1000;
+  table_options.max_auto_readahead_size = 32 * 1024;
+
+  for (int i = 0; i < 200; ++i) {
+    // Each block holds a single key/value pair.
+    c.Add(RandomString(&rnd, 900), "val");
+  }
+
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+  auto* statistics = options.statistics.get();
+
+  // Point reads and reads of two blocks do not read ahead.
+  for (size_t i = 0; i + 1 < keys.size(); i += 10) {
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+    iter->Seek(keys[i]);
+    ASSERT_TRUE(iter->Valid());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+  }
+  ASSERT_EQ(0, statistics->getTickerCount(BLOCK_READAHEAD_BYTES));
+
+  // A full scan reads ahead, starting at 8KB and doubling up to 32KB, so the readahead covers
+  // the table once with a few readaheads only.
+  {
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+    size_t count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ++count;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(keys.size(), count);
+  }
+  const uint64_t readahead_bytes = statistics->getTickerCount(BLOCK_READAHEAD_BYTES);
+  const uint64_t file_size = reader->GetTableProperties()->data_size;
+  ASSERT_GT(readahead_bytes, file_size / 2);
+  ASSERT_LT(readahead_bytes, file_size + 64 * 1024);
+
+  // With the readahead disabled, a full scan does not read ahead.
+  table_options.max_auto_readahead_size = 0;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions no_readahead_ioptions(options);
+  ASSERT_OK(c.Reopen(no_readahead_ioptions));
+  {
+    std::unique_ptr<InternalIterator> iter(
+        c.GetTableReader()->NewIterator(ReadOptions()));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {}
+    ASSERT_OK(iter->status());
+  }
+  ASSERT_EQ(readahead_bytes, statistics->getTickerCount(BLOCK_READAHEAD_BYTES));
+}
+
 // A simple tool that takes the snapshot of block cache statistics.
 class BlockCachePropertiesSnapshot {
  public:
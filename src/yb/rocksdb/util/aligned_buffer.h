@@ -88,6 +88,11 @@ public:
     return bufstart_;
   }
 
+  // Used for reads into the buffer.
+  char* Destination() {
+    return bufstart_ + cursize_;
+  }
+
   void Clear() {
     cursize_ = 0;
   }
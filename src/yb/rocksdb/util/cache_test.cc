@@ -442,6 +442,19 @@ TEST_F(CacheTest, MultiTouch) {
   ASSERT_TRUE(LookupAndCheckInMultiTouch(100, 101, qid2));
 }
 
+TEST_F(CacheTest, NoCacheLookupDoesNotPromote) {
+  QueryId qid1 = 1000;
+  QueryId qid2 = 1001;
+
+  ASSERT_OK(Insert(100, 101, 1, qid1));
+  // Lookups by readers that don't fill the cache keep the value in the single touch cache.
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(100, 101, kNoCacheQueryId));
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(100, 101, kNoCacheQueryId));
+  ASSERT_EQ(101, Lookup(100, kNoCacheQueryId));
+  // Lookup by another query still promotes the value.
+  ASSERT_TRUE(LookupAndCheckInMultiTouch(100, 101, qid2));
+}
+
 TEST_F(CacheTest, EvictionPolicyMultiTouch) {
   QueryId qid1 = 1000;
   QueryId qid2 = 1001;
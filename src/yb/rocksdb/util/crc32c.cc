@@ -27,9 +27,17 @@
 #include "yb/rocksdb/util/crc32c.h"
 
 #include <stdint.h>
+
+#include <algorithm>
+
 #ifdef __SSE4_2__
 #include <nmmintrin.h>
 #endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
 #include "yb/rocksdb/util/coding.h"
 
 namespace rocksdb {
@@ -305,13 +313,9 @@ static inline uint32_t LE_LOAD32(const uint8_t *p) {
   return DecodeFixed32(reinterpret_cast<const char*>(p));
 }
 
-#ifdef __SSE4_2__
-#ifdef __LP64__
 static inline uint64_t LE_LOAD64(const uint8_t *p) {
   return DecodeFixed64(reinterpret_cast<const char*>(p));
 }
-#endif
-#endif
 
 static inline void Slow_CRC32(uint64_t* l, uint8_t const **p) {
   uint32_t c = static_cast<uint32_t>(*l ^ LE_LOAD32(*p));
@@ -329,22 +333,6 @@ static inline void Slow_CRC32(uint64_t* l, uint8_t const **p) {
   table0_[c >> 24];
 }
 
-static inline void Fast_CRC32(uint64_t* l, uint8_t const **p) {
-#ifdef __SSE4_2__
-#ifdef __LP64__
-  *l = _mm_crc32_u64(*l, LE_LOAD64(*p));
-  *p += 8;
-#else
-  *l = _mm_crc32_u32(static_cast<unsigned int>(*l), LE_LOAD32(*p));
-  *p += 4;
-  *l = _mm_crc32_u32(static_cast<unsigned int>(*l), LE_LOAD32(*p));
-  *p += 4;
-#endif
-#else
-  Slow_CRC32(l, p);
-#endif
-}
-
 template<void (*CRC32)(uint64_t*, uint8_t const**)>
 uint32_t ExtendImpl(uint32_t crc, const char* buf, size_t size) {
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
@@ -388,13 +376,163 @@ uint32_t ExtendImpl(uint32_t crc, const char* buf, size_t size) {
   return static_cast<uint32_t>(l ^ 0xffffffffu);
 }
 
-// Detect if SS42 or not.
-static bool isSSE42() {
-#if defined(__GNUC__) && defined(__x86_64__) && !defined(IOS_CROSS_COMPILE)
+#if (defined(__SSE4_2__) && defined(__LP64__)) || \
+    (defined(__aarch64__) && defined(__ARM_FEATURE_CRC32))
+#define ROCKSDB_HARDWARE_CRC32C 1
+
+#ifdef __SSE4_2__
+static inline uint64_t HardwareCrc32cWord(uint64_t crc, uint64_t word) {
+  return _mm_crc32_u64(crc, word);
+}
+
+static inline uint64_t HardwareCrc32cByte(uint64_t crc, uint8_t byte) {
+  return _mm_crc32_u8(static_cast<uint32_t>(crc), byte);
+}
+#else
+static inline uint64_t HardwareCrc32cWord(uint64_t crc, uint64_t word) {
+  return __crc32cd(static_cast<uint32_t>(crc), word);
+}
+
+static inline uint64_t HardwareCrc32cByte(uint64_t crc, uint8_t byte) {
+  return __crc32cb(static_cast<uint32_t>(crc), byte);
+}
+#endif
+
+// Appending n zero bytes to the data is a linear operation on the CRC register over GF(2), so it
+// can be done with a 32x32 bit matrix, precomputed here as 4 byte-indexed lookup tables. This is
+// used to combine the CRCs of adjacent blocks: crc(A + B) = shift(crc(A), |B|) ^ crc_0(B), where
+// crc_0(B) is computed starting from a zero register.
+class Crc32cZeros {
+ public:
+  // 'length' must be a power of 2.
+  explicit Crc32cZeros(size_t length) {
+    uint32_t op[32];
+    ZerosOperator(length, op);
+    for (uint32_t n = 0; n < 256; ++n) {
+      table_[0][n] = MatrixTimes(op, n);
+      table_[1][n] = MatrixTimes(op, n << 8);
+      table_[2][n] = MatrixTimes(op, n << 16);
+      table_[3][n] = MatrixTimes(op, n << 24);
+    }
+  }
+
+  uint64_t Shift(uint64_t crc) const {
+    return table_[0][crc & 0xff] ^ table_[1][(crc >> 8) & 0xff] ^
+           table_[2][(crc >> 16) & 0xff] ^ table_[3][(crc >> 24) & 0xff];
+  }
+
+ private:
+  static uint32_t MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (; vector; vector >>= 1, ++matrix) {
+      if (vector & 1) {
+        sum ^= *matrix;
+      }
+    }
+    return sum;
+  }
+
+  static void MatrixSquare(const uint32_t* matrix, uint32_t* square) {
+    for (int n = 0; n < 32; ++n) {
+      square[n] = MatrixTimes(matrix, matrix[n]);
+    }
+  }
+
+  // Builds the operator that appends 'length' zero bytes by repeated squaring of the operator
+  // that appends one zero bit.
+  static void ZerosOperator(size_t length, uint32_t* result) {
+    uint32_t even[32];
+    uint32_t odd[32];
+    odd[0] = 0x82f63b78;  // Reflected CRC32C polynomial.
+    for (int n = 1; n < 32; ++n) {
+      odd[n] = 1u << (n - 1);
+    }
+    MatrixSquare(odd, even);  // 2 zero bits.
+    MatrixSquare(even, odd);  // 4 zero bits.
+    const uint32_t* current = odd;
+    for (;;) {
+      MatrixSquare(odd, even);  // 1, 4, 16, ... zero bytes.
+      current = even;
+      length >>= 1;
+      if (length == 0) {
+        break;
+      }
+      MatrixSquare(even, odd);  // 2, 8, 32, ... zero bytes.
+      current = odd;
+      length >>= 1;
+      if (length == 0) {
+        break;
+      }
+    }
+    std::copy(current, current + 32, result);
+  }
+
+  uint32_t table_[4][256];
+};
+
+// CRC32 instructions have a latency of 3 cycles but a throughput of one per cycle, so a single
+// dependency chain runs at a third of the possible speed. Large buffers are split into 3 adjacent
+// blocks of kBlockSize bytes that are checksummed in parallel and then combined.
+template <size_t kBlockSize>
+static inline void ExtendThreeWay(const Crc32cZeros& zeros, const uint8_t** p,
+                                  const uint8_t* e, uint64_t* crc) {
+  while (static_cast<size_t>(e - *p) >= 3 * kBlockSize) {
+    const uint8_t* block = *p;
+    const uint8_t* const block_end = block + kBlockSize;
+    uint64_t crc0 = *crc;
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    do {
+      crc0 = HardwareCrc32cWord(crc0, LE_LOAD64(block));
+      crc1 = HardwareCrc32cWord(crc1, LE_LOAD64(block + kBlockSize));
+      crc2 = HardwareCrc32cWord(crc2, LE_LOAD64(block + 2 * kBlockSize));
+      block += 8;
+    } while (block != block_end);
+    crc0 = zeros.Shift(crc0) ^ crc1;
+    *crc = zeros.Shift(crc0) ^ crc2;
+    *p += 3 * kBlockSize;
+  }
+}
+
+static uint32_t ExtendHardware(uint32_t crc, const char* buf, size_t size) {
+  constexpr size_t kLongBlockSize = 8192;
+  constexpr size_t kShortBlockSize = 256;
+  static const Crc32cZeros long_zeros(kLongBlockSize);
+  static const Crc32cZeros short_zeros(kShortBlockSize);
+
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  const uint8_t *e = p + size;
+  uint64_t l = crc ^ 0xffffffffu;
+
+  // Process bytes until p is 8-byte aligned.
+  while (p != e && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    l = HardwareCrc32cByte(l, *p++);
+  }
+  ExtendThreeWay<kLongBlockSize>(long_zeros, &p, e, &l);
+  ExtendThreeWay<kShortBlockSize>(short_zeros, &p, e, &l);
+  // Process bytes 8 at a time
+  while ((e - p) >= 8) {
+    l = HardwareCrc32cWord(l, LE_LOAD64(p));
+    p += 8;
+  }
+  // Process the last few bytes
+  while (p != e) {
+    l = HardwareCrc32cByte(l, *p++);
+  }
+  return static_cast<uint32_t>(l ^ 0xffffffffu);
+}
+#endif
+
+// Detect whether the CPU supports the CRC32C instructions.
+static bool IsHardwareCrc32cAvailable() {
+#if defined(__SSE4_2__) && defined(__GNUC__) && defined(__x86_64__) && \
+    !defined(IOS_CROSS_COMPILE)
   uint32_t c_;
   uint32_t d_;
   __asm__("cpuid" : "=c"(c_), "=d"(d_) : "a"(1) : "ebx");
   return c_ & (1U << 20);  // copied from CpuId.h in Folly.
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
 #else
   return false;
 #endif
@@ -403,12 +541,17 @@ static bool isSSE42() {
 typedef uint32_t (*Function)(uint32_t, const char*, size_t);
 
 static inline Function Choose_Extend() {
-  return isSSE42() ? ExtendImpl<Fast_CRC32> : ExtendImpl<Slow_CRC32>;
+#ifdef ROCKSDB_HARDWARE_CRC32C
+  if (IsHardwareCrc32cAvailable()) {
+    return ExtendHardware;
+  }
+#endif
+  return ExtendImpl<Slow_CRC32>;
 }
 
 bool IsFastCrc32Supported() {
-#ifdef __SSE4_2__
-  return isSSE42();
+#ifdef ROCKSDB_HARDWARE_CRC32C
+  return IsHardwareCrc32cAvailable();
 #else
   return false;
 #endif
@@ -21,6 +21,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <algorithm>
+#include <string>
+
 #include "yb/rocksdb/util/crc32c.h"
 #include "yb/rocksdb/util/testharness.h"
 
@@ -75,6 +78,23 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+// Large buffers are checksummed in interleaved blocks, check them against small extends.
+TEST(CRC, ExtendLarge) {
+  std::string data(100000, 0);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 7 + (i >> 8));
+  }
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t size : {767, 768, 24575, 24576, 30001, 99990}) {
+      uint32_t expected = 0;
+      for (size_t i = offset; i < offset + size; i += 100) {
+        expected = Extend(expected, data.data() + i, std::min<size_t>(100, offset + size - i));
+      }
+      ASSERT_EQ(expected, Value(data.data() + offset, size));
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
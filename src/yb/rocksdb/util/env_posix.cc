@@ -84,6 +84,20 @@ ThreadStatusUpdater* CreateThreadStatusUpdater() {
   return new ThreadStatusUpdater();
 }
 
+// Opens the file with O_DIRECT. Returns -1 when the platform or the file system does not support
+// it, in which case the caller falls back to buffered I/O.
+int OpenDirect(const std::string& fname, int flags, mode_t mode) {
+#ifdef OS_LINUX
+  int fd;
+  do {
+    fd = open(fname.c_str(), flags | O_DIRECT, mode);
+  } while (fd < 0 && errno == EINTR);
+  return fd;
+#else
+  return -1;
+#endif
+}
+
 // list of pathnames that are locked
 static std::set<std::string> lockedFiles;
 static port::Mutex mutex_lockedFiles;
@@ -180,13 +194,24 @@ class PosixEnv : public Env {
     result->reset();
     Status s;
     int fd;
+    bool direct = false;
     {
       IOSTATS_TIMER_GUARD(open_nanos);
-      fd = open(fname.c_str(), O_RDONLY);
+      if (options.use_direct_reads && !options.use_mmap_reads) {
+        fd = OpenDirect(fname, O_RDONLY, 0);
+        direct = fd >= 0;
+      } else {
+        fd = -1;
+      }
+      if (fd < 0) {
+        fd = open(fname.c_str(), O_RDONLY);
+      }
     }
     SetFD_CLOEXEC(fd, &options);
     if (fd < 0) {
       s = IOError(fname, errno);
+    } else if (direct) {
+      result->reset(new PosixRandomAccessFile(fname, fd, options, true /* direct */));
     } else if (options.use_mmap_reads && sizeof(void*) >= 8) {
       // Use of mmap for random reads has been removed because it
       // kills performance when storage is fast.
@@ -215,6 +240,15 @@ class PosixEnv : public Env {
     result->reset();
     Status s;
     int fd = -1;
+    if (options.use_direct_writes && !options.use_mmap_writes) {
+      IOSTATS_TIMER_GUARD(open_nanos);
+      fd = OpenDirect(fname, O_CREAT | O_RDWR | O_TRUNC, 0644);
+      if (fd >= 0) {
+        SetFD_CLOEXEC(fd, &options);
+        result->reset(new PosixWritableFile(fname, fd, options, true /* direct */));
+        return s;
+      }
+    }
     do {
       IOSTATS_TIMER_GUARD(open_nanos);
       fd = open(fname.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
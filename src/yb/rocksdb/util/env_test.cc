@@ -46,6 +46,7 @@
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/port/port.h"
 #include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/file_reader_writer.h"
 #include "yb/rocksdb/util/log_buffer.h"
 #include "yb/rocksdb/util/mutexlock.h"
 #include "yb/rocksdb/util/string_util.h"
@@ -967,6 +968,47 @@ TEST_F(EnvPosixTest, Preallocation) {
   ASSERT_EQ(last_allocated_block, 7UL);
 }
 
+// Direct I/O is not supported by every file system, in that case the files fall back to buffered
+// I/O and the test still checks that the contents round trip.
+TEST_F(EnvPosixTest, DirectIO) {
+  const std::string fname = test::TmpDir() + "/" + "direct_io_testfile";
+  EnvOptions soptions;
+  soptions.use_direct_writes = true;
+  soptions.use_direct_reads = true;
+  soptions.writable_file_max_buffer_size = 64 * 1024;
+
+  Random rnd(301);
+  std::string data;
+  test::RandomString(&rnd, 100 * 1024 + 17, &data);
+  {
+    unique_ptr<WritableFile> file;
+    ASSERT_OK(env_->NewWritableFile(fname, &file, soptions));
+    WritableFileWriter writer(std::move(file), soptions);
+    // Unaligned appends, the writer pads the last page and truncates the file at close.
+    for (size_t pos = 0; pos < data.size(); pos += 1000) {
+      ASSERT_OK(writer.Append(Slice(data.data() + pos, std::min<size_t>(1000, data.size() - pos))));
+    }
+    ASSERT_OK(writer.Close());
+  }
+  uint64_t file_size = 0;
+  ASSERT_OK(env_->GetFileSize(fname, &file_size));
+  ASSERT_EQ(data.size(), file_size);
+
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+  std::string scratch(data.size(), 0);
+  Slice result;
+  for (size_t offset : {0, 1, 4095, 4096, 50000}) {
+    const size_t n = std::min<size_t>(10000, data.size() - offset);
+    ASSERT_OK(file->Read(offset, n, &result, &scratch[0]));
+    ASSERT_EQ(Slice(data.data() + offset, n), result);
+  }
+  // Reading past the end returns the remaining bytes.
+  ASSERT_OK(file->Read(data.size() - 10, 100, &result, &scratch[0]));
+  ASSERT_EQ(Slice(data.data() + data.size() - 10, 10), result);
+  ASSERT_OK(env_->DeleteFile(fname));
+}
+
 // Test that the two ways to get children file attributes (in bulk or
 // individually) behave consistently.
 TEST_F(EnvPosixTest, ConsistentChildrenAttributes) {
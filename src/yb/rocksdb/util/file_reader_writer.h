@@ -24,6 +24,7 @@
 #ifndef ROCKSDB_UTIL_FILE_READER_WRITER_H
 #define ROCKSDB_UTIL_FILE_READER_WRITER_H
 
+#include <algorithm>
 #include <string>
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/util/aligned_buffer.h"
@@ -103,6 +104,8 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  void Readahead(uint64_t offset, size_t n) { file_->Readahead(offset, n); }
+
   RandomAccessFile* file() { return file_.get(); }
 };
 
@@ -144,7 +147,8 @@ class WritableFileWriter {
         rate_limiter_(options.rate_limiter) {
 
     buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
-    buf_.AllocateNewBuffer(65536);
+    // Unbuffered I/O writes whole buffers, so start with the largest one.
+    buf_.AllocateNewBuffer(use_os_buffer_ ? 65536 : std::max<size_t>(max_buffer_size_, 65536));
   }
 
   WritableFileWriter(const WritableFileWriter&) = delete;
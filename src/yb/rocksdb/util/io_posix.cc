@@ -40,6 +40,8 @@
 #include <sys/statfs.h>
 #include <sys/syscall.h>
 #endif
+#include <algorithm>
+#include <limits>
 #include "yb/rocksdb/port/port.h"
 #include "yb/util/slice.h"
 #include "yb/rocksdb/util/coding.h"
@@ -154,15 +156,19 @@ static size_t GetUniqueIdFromFile(int fd, char* id, size_t max_size) {
  * pread() based random-access
  */
 PosixRandomAccessFile::PosixRandomAccessFile(const std::string& fname, int fd,
-                                             const EnvOptions& options)
-    : filename_(fname), fd_(fd), use_os_buffer_(options.use_os_buffer) {
+                                             const EnvOptions& options, bool direct)
+    : filename_(fname), fd_(fd), use_os_buffer_(options.use_os_buffer), direct_(direct) {
   assert(!options.use_mmap_reads || sizeof(void*) < 8);
+  direct_buffer_.Alignment(kDirectIOAlignment);
 }
 
 PosixRandomAccessFile::~PosixRandomAccessFile() { close(fd_); }
 
 Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
                                    char* scratch) const {
+  if (direct_) {
+    return DirectRead(offset, n, result, scratch);
+  }
   Status s;
   ssize_t r = -1;
   size_t left = n;
@@ -194,6 +200,47 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+// O_DIRECT reads must cover whole aligned pages, so the pages around the requested range are
+// read into the aligned buffer and the range is copied to scratch.
+Status PosixRandomAccessFile::DirectRead(uint64_t offset, size_t n, Slice* result,
+                                         char* scratch) const {
+  const uint64_t aligned_offset = offset - offset % kDirectIOAlignment;
+  const size_t offset_in_buffer = static_cast<size_t>(offset - aligned_offset);
+  const size_t aligned_size = Roundup(offset_in_buffer + n, kDirectIOAlignment);
+
+  std::lock_guard<std::mutex> lock(direct_buffer_mutex_);
+  if (direct_buffer_.Capacity() < aligned_size) {
+    direct_buffer_.AllocateNewBuffer(aligned_size);
+  }
+  direct_buffer_.Clear();
+  size_t read = 0;
+  while (read < aligned_size) {
+    ssize_t r = pread(fd_, direct_buffer_.Destination(), aligned_size - read,
+                      static_cast<off_t>(aligned_offset + read));
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      *result = Slice(scratch, 0);
+      return IOError(filename_, errno);
+    }
+    if (r == 0) {
+      // End of file.
+      break;
+    }
+    read += r;
+    direct_buffer_.Size(read);
+  }
+
+  const size_t available = read > offset_in_buffer ? read - offset_in_buffer : 0;
+  const size_t size = std::min(n, available);
+  if (size > 0) {
+    direct_buffer_.Read(scratch, offset_in_buffer, size);
+  }
+  *result = Slice(scratch, size);
+  return Status::OK();
+}
+
 #ifdef OS_LINUX
 size_t PosixRandomAccessFile::GetUniqueId(char* id, size_t max_size) const {
   return GetUniqueIdFromFile(fd_, id, max_size);
@@ -223,6 +270,13 @@ void PosixRandomAccessFile::Hint(AccessPattern pattern) {
   }
 }
 
+void PosixRandomAccessFile::Readahead(uint64_t offset, size_t length) {
+  // Reads of a file opened with O_DIRECT do not go through the page cache.
+  if (!direct_) {
+    Fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+  }
+}
+
 Status PosixRandomAccessFile::InvalidateCache(size_t offset, size_t length) {
 #ifndef OS_LINUX
   return Status::OK();
@@ -273,6 +327,10 @@ Status PosixMmapReadableFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+void PosixMmapReadableFile::Readahead(uint64_t offset, size_t length) {
+  Fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+}
+
 Status PosixMmapReadableFile::InvalidateCache(size_t offset, size_t length) {
 #ifndef OS_LINUX
   return Status::OK();
@@ -516,8 +574,8 @@ Status PosixMmapFile::Allocate(uint64_t offset, uint64_t len) {
  * Use posix write to write data to a file.
  */
 PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
-                                     const EnvOptions& options)
-    : filename_(fname), fd_(fd), filesize_(0) {
+                                     const EnvOptions& options, bool direct)
+    : filename_(fname), fd_(fd), filesize_(0), direct_(direct) {
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   allow_fallocate_ = options.allow_fallocate;
   fallocate_with_keep_size_ = options.fallocate_with_keep_size;
@@ -549,6 +607,38 @@ Status PosixWritableFile::Append(const Slice& data) {
   return Status::OK();
 }
 
+Status PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset) {
+  assert(offset <= std::numeric_limits<off_t>::max());
+  const char* src = data.cdata();
+  size_t left = data.size();
+  while (left != 0) {
+    ssize_t done = pwrite(fd_, src, left, static_cast<off_t>(offset));
+    if (done < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return IOError(filename_, errno);
+    }
+    left -= done;
+    offset += done;
+    src += done;
+  }
+  filesize_ = std::max<uint64_t>(filesize_, offset);
+  return Status::OK();
+}
+
+Status PosixWritableFile::Truncate(uint64_t size) {
+  if (!direct_) {
+    return Status::OK();
+  }
+  // The last page written with O_DIRECT is padded with zeros.
+  if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+    return IOError(filename_, errno);
+  }
+  filesize_ = size;
+  return Status::OK();
+}
+
 Status PosixWritableFile::Close() {
   Status s;
 
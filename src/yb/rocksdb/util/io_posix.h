@@ -25,7 +25,11 @@
 
 #pragma once
 #include <unistd.h>
+
+#include <mutex>
+
 #include "yb/rocksdb/env.h"
+#include "yb/rocksdb/util/aligned_buffer.h"
 
 // For non linux platform, the following macros are used only as place
 // holder.
@@ -60,15 +64,25 @@ class PosixSequentialFile : public SequentialFile {
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
+// Alignment of the buffers, offsets and sizes of the files opened with O_DIRECT.
+constexpr size_t kDirectIOAlignment = 4 * 1024;
+
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   std::string filename_;
   int fd_;
   bool use_os_buffer_;
+  // Whether fd_ was opened with O_DIRECT.
+  bool direct_;
+  // Aligned buffer for reads of a file opened with O_DIRECT, reused by subsequent reads.
+  mutable std::mutex direct_buffer_mutex_;
+  mutable AlignedBuffer direct_buffer_;
+
+  Status DirectRead(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
  public:
   PosixRandomAccessFile(const std::string& fname, int fd,
-                        const EnvOptions& options);
+                        const EnvOptions& options, bool direct = false);
   virtual ~PosixRandomAccessFile();
 
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
@@ -77,6 +91,7 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
   virtual void Hint(AccessPattern pattern) override;
+  virtual void Readahead(uint64_t offset, size_t length) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
@@ -85,6 +100,9 @@ class PosixWritableFile : public WritableFile {
   const std::string filename_;
   int fd_;
   uint64_t filesize_;
+  // Whether fd_ was opened with O_DIRECT. Such a file is written by WritableFileWriter with
+  // aligned PositionedAppend() calls only.
+  const bool direct_;
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   bool allow_fallocate_;
   bool fallocate_with_keep_size_;
@@ -92,14 +110,18 @@ class PosixWritableFile : public WritableFile {
 
  public:
   PosixWritableFile(const std::string& fname, int fd,
-                    const EnvOptions& options);
+                    const EnvOptions& options, bool direct = false);
   ~PosixWritableFile();
 
   // Means Close() will properly take care of truncate
-  // and it does not need any additional information
-  virtual Status Truncate(uint64_t size) override { return Status::OK(); }
+  // and it does not need any additional information, unless whole pages were written with
+  // O_DIRECT.
+  virtual Status Truncate(uint64_t size) override;
   virtual Status Close() override;
   virtual Status Append(const Slice& data) override;
+  virtual Status PositionedAppend(const Slice& data, uint64_t offset) override;
+  virtual bool UseOSBuffer() const override { return !direct_; }
+  virtual size_t GetRequiredBufferAlignment() const override { return kDirectIOAlignment; }
   virtual Status Flush() override;
   virtual Status Sync() override;
   virtual Status Fsync() override;
@@ -126,6 +148,7 @@ class PosixMmapReadableFile : public RandomAccessFile {
   virtual ~PosixMmapReadableFile();
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const override;
+  virtual void Readahead(uint64_t offset, size_t length) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
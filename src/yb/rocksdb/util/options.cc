@@ -60,10 +60,13 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
       compaction_options_universal(options.compaction_options_universal),
       compaction_options_fifo(options.compaction_options_fifo),
       prefix_extractor(options.prefix_extractor.get()),
+      memtable_prefix_extractor(options.memtable_prefix_extractor.get()),
       comparator(options.comparator),
       merge_operator(options.merge_operator.get()),
       compaction_filter(options.compaction_filter),
       compaction_filter_factory(options.compaction_filter_factory.get()),
+      compaction_file_filter_factory(options.compaction_file_filter_factory.get()),
+      subcompaction_boundary_extractor(options.subcompaction_boundary_extractor.get()),
       inplace_update_support(options.inplace_update_support),
       inplace_callback(options.inplace_callback),
       info_log(options.info_log.get()),
@@ -102,12 +105,15 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       merge_operator(nullptr),
       compaction_filter(nullptr),
       compaction_filter_factory(nullptr),
+      compaction_file_filter_factory(nullptr),
+      subcompaction_boundary_extractor(nullptr),
       write_buffer_size(FLAGS_memstore_size_mb << 20), // Option expects bytes.
       max_write_buffer_number(2),
       min_write_buffer_number_to_merge(1),
       max_write_buffer_number_to_maintain(0),
       compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
       prefix_extractor(nullptr),
+      memtable_prefix_extractor(nullptr),
       num_levels(7),
       level0_file_num_compaction_trigger(4),
       level0_slowdown_writes_trigger(20),
@@ -157,6 +163,8 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       merge_operator(options.merge_operator),
       compaction_filter(options.compaction_filter),
       compaction_filter_factory(options.compaction_filter_factory),
+      compaction_file_filter_factory(options.compaction_file_filter_factory),
+      subcompaction_boundary_extractor(options.subcompaction_boundary_extractor),
       write_buffer_size(options.write_buffer_size),
       max_write_buffer_number(options.max_write_buffer_number),
       min_write_buffer_number_to_merge(
@@ -167,6 +175,7 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       compression_per_level(options.compression_per_level),
       compression_opts(options.compression_opts),
       prefix_extractor(options.prefix_extractor),
+      memtable_prefix_extractor(options.memtable_prefix_extractor),
       num_levels(options.num_levels),
       level0_file_num_compaction_trigger(
           options.level0_file_num_compaction_trigger),
@@ -415,6 +424,10 @@ void DBOptions::Dump(Logger* log) const {
       RHEADER(log, "                               Options.row_cache: None");
     }
   RHEADER(log, "                           Options.initial_seqno: %" PRIu64, initial_seqno);
+  RHEADER(log, "     Options.use_direct_io_for_compaction_writes: %d",
+      use_direct_io_for_compaction_writes);
+  RHEADER(log, "      Options.use_direct_io_for_compaction_reads: %d",
+      use_direct_io_for_compaction_reads);
 #ifndef ROCKSDB_LITE
   RHEADER(log, "       Options.wal_filter: %s",
       wal_filter ? wal_filter->Name() : "None");
@@ -429,6 +442,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
       compaction_filter ? compaction_filter->Name() : "None");
   RHEADER(log, "       Options.compaction_filter_factory: %s",
       compaction_filter_factory ? compaction_filter_factory->Name() : "None");
+  RHEADER(log, "       Options.compaction_file_filter_factory: %s",
+      compaction_file_filter_factory ? compaction_file_filter_factory->Name() : "None");
+  RHEADER(log, "       Options.subcompaction_boundary_extractor: %s",
+      subcompaction_boundary_extractor ? subcompaction_boundary_extractor->Name() : "None");
   RHEADER(log, "        Options.memtable_factory: %s", memtable_factory->Name());
   RHEADER(log, "           Options.table_factory: %s", table_factory->Name());
   RHEADER(log, "           table_factory options: %s",
@@ -447,6 +464,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     }
   RHEADER(log, "      Options.prefix_extractor: %s",
       prefix_extractor == nullptr ? "nullptr" : prefix_extractor->Name());
+  RHEADER(log, "      Options.memtable_prefix_extractor: %s",
+      memtable_prefix_extractor == nullptr ? "nullptr" : memtable_prefix_extractor->Name());
   RHEADER(log, "            Options.num_levels: %d", num_levels);
   RHEADER(log, "       Options.min_write_buffer_number_to_merge: %d",
       min_write_buffer_number_to_merge);
@@ -458,6 +477,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
       compression_opts.level);
   RHEADER(log, "              Options.compression_opts.strategy: %d",
       compression_opts.strategy);
+  RHEADER(log, "        Options.compression_opts.max_dict_bytes: %" PRIu32,
+      compression_opts.max_dict_bytes);
+  RHEADER(log, "      Options.compression_opts.parallel_threads: %" PRIu32,
+      compression_opts.parallel_threads);
   RHEADER(log, "     Options.level0_file_num_compaction_trigger: %d",
       level0_file_num_compaction_trigger);
   RHEADER(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -344,6 +344,12 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_file_size_for_compaction",
      {offsetof(struct DBOptions, max_file_size_for_compaction),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"use_direct_io_for_compaction_writes",
+     {offsetof(struct DBOptions, use_direct_io_for_compaction_writes),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"use_direct_io_for_compaction_reads",
+     {offsetof(struct DBOptions, use_direct_io_for_compaction_reads),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
@@ -540,6 +546,9 @@ static std::unordered_map<std::string,
     {"filter_block_size",
      {offsetof(struct BlockBasedTableOptions, filter_block_size), OptionType::kSizeT,
       OptionVerificationType::kNormal}},
+    {"index_block_size",
+     {offsetof(struct BlockBasedTableOptions, index_block_size), OptionType::kSizeT,
+      OptionVerificationType::kNormal}},
     {"block_size_deviation",
      {offsetof(struct BlockBasedTableOptions, block_size_deviation),
       OptionType::kInt, OptionVerificationType::kNormal}},
@@ -601,7 +610,8 @@ static std::unordered_map<std::string, CompressionType>
 static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
     block_base_table_index_type_string_map = {
         {"kBinarySearch", BlockBasedTableOptions::IndexType::kBinarySearch},
-        {"kHashSearch", BlockBasedTableOptions::IndexType::kHashSearch}};
+        {"kHashSearch", BlockBasedTableOptions::IndexType::kHashSearch},
+        {"kTwoLevelIndexSearch", BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch}};
 
 static std::unordered_map<std::string, EncodingType> encoding_type_string_map =
     {{"kPlain", kPlain}, {"kPrefix", kPrefix}};
@@ -340,6 +340,10 @@ TEST_F(OptionsTest, GetColumnFamilyOptionsFromStringTest) {
             "write_buffer_size=9;max_write_buffer_number=10", &new_cf_opt));
   ASSERT_EQ(new_cf_opt.write_buffer_size, 9U);
   ASSERT_EQ(new_cf_opt.max_write_buffer_number, 10);
+  ASSERT_OK(GetColumnFamilyOptionsFromString(base_cf_opt,
+            "compression_opts=4:5:6:16384", &new_cf_opt));
+  ASSERT_EQ(new_cf_opt.compression_opts.strategy, 6);
+  ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 16384U);
   ASSERT_OK(GetColumnFamilyOptionsFromString(base_cf_opt,
             "write_buffer_size=11; max_write_buffer_number  =  12 ;",
             &new_cf_opt));
@@ -1617,6 +1621,7 @@ Status GetFromString(BlockBasedTableOptions* source, BlockBasedTableOptions* des
       "cache_index_and_filter_blocks=1;index_type=kHashSearch;"
       "checksum=kxxHash;hash_index_allow_collision=1;no_block_cache=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;filter_block_size=16384;"
+      "index_block_size=2048;"
       "block_size_deviation=8;block_restart_interval=4; "
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
@@ -1625,8 +1630,10 @@ Status GetFromString(BlockBasedTableOptions* source, BlockBasedTableOptions* des
 
   RETURN_NOT_OK(GetBlockBasedTableOptionsFromString(*source, kOptionsString, destination));
 
-  // This option is not setable:
+  // These options are not setable:
   destination->use_delta_encoding = false;
+  destination->data_block_key_value_encoding_format =
+      KeyValueEncodingFormat::kKeyDeltaEncodingSharedPrefixAndParts;
 
   EXPECT_NE(nullptr, destination->block_cache.get());
   EXPECT_NE(nullptr, destination->block_cache_compressed.get());
@@ -1916,6 +1923,9 @@ TEST_F(OptionsParserTest, DBOptionsAllFieldsSettable) {
       BLACKLIST_ENTRY(DBOptions, db_log_dir),
       BLACKLIST_ENTRY(DBOptions, wal_dir),
       BLACKLIST_ENTRY(DBOptions, memory_monitor),
+      BLACKLIST_ENTRY(DBOptions, priority_thread_pool_for_compactions_and_flushes),
+      BLACKLIST_ENTRY(DBOptions, multi_get_thread_pool),
+      BLACKLIST_ENTRY(DBOptions, table_cache),
       BLACKLIST_ENTRY(DBOptions, listeners),
       BLACKLIST_ENTRY(DBOptions, row_cache),
       BLACKLIST_ENTRY(DBOptions, wal_filter),
@@ -1940,8 +1950,11 @@ TEST_F(OptionsParserTest, ColumnFamilyOptionsAllFieldsSettable) {
       BLACKLIST_ENTRY(ColumnFamilyOptions, merge_operator),
       BLACKLIST_ENTRY(ColumnFamilyOptions, compaction_filter),
       BLACKLIST_ENTRY(ColumnFamilyOptions, compaction_filter_factory),
+      BLACKLIST_ENTRY(ColumnFamilyOptions, compaction_file_filter_factory),
+      BLACKLIST_ENTRY(ColumnFamilyOptions, subcompaction_boundary_extractor),
       BLACKLIST_ENTRY(ColumnFamilyOptions, compression_per_level),
       BLACKLIST_ENTRY(ColumnFamilyOptions, prefix_extractor),
+      BLACKLIST_ENTRY(ColumnFamilyOptions, memtable_prefix_extractor),
       BLACKLIST_ENTRY(ColumnFamilyOptions, max_bytes_for_level_multiplier_additional),
       BLACKLIST_ENTRY(ColumnFamilyOptions, memtable_factory),
       BLACKLIST_ENTRY(ColumnFamilyOptions, table_factory),
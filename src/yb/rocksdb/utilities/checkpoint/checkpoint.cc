@@ -32,6 +32,8 @@
 #include <inttypes.h>
 #include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "yb/rocksdb/db/filename.h"
 #include "yb/rocksdb/db/wal_manager.h"
 #include "yb/rocksdb/db.h"
@@ -101,6 +103,16 @@ Status CheckpointImpl::CreateCheckpoint(const std::string& checkpoint_dir) {
     return s;
   }
 
+  // SST files could be in any of the db_paths.
+  std::unordered_map<uint64_t, std::string> table_file_paths;
+  {
+    std::vector<LiveFileMetaData> live_files_metadata;
+    db_->GetLiveFilesMetaData(&live_files_metadata);
+    for (const auto& file : live_files_metadata) {
+      table_file_paths.emplace(TableFileNameToNumber(file.name), file.db_path);
+    }
+  }
+
   size_t wal_size = live_wal_files.size();
   RLOG(db_->GetOptions().info_log,
       "Started the snapshot process -- creating snapshot in directory %s",
@@ -131,18 +143,31 @@ Status CheckpointImpl::CreateCheckpoint(const std::string& checkpoint_dir) {
     // * if it's kDescriptorFile, limit the size to manifest_file_size
     // * always copy if cross-device link
     bool is_table_file = type == kTableFile || type == kTableSBlockFile;
-    if (is_table_file && same_fs) {
+    std::string src_dir = db_->GetName();
+    if (is_table_file) {
+      auto it = table_file_paths.find(number);
+      if (it != table_file_paths.end()) {
+        src_dir = it->second;
+      }
+    }
+    bool copy = !is_table_file || !same_fs;
+    if (!copy) {
       RLOG(db_->GetOptions().info_log, "Hard Linking %s", src_fname.c_str());
-      s = db_->GetEnv()->LinkFile(db_->GetName() + src_fname,
+      s = db_->GetEnv()->LinkFile(src_dir + src_fname,
                                   full_private_path + src_fname);
       if (s.IsNotSupported()) {
-        same_fs = false;
+        // Other db_paths could be on other devices, so only a failure to link a file of the
+        // main path means that the checkpoint is on another device.
+        if (src_dir == db_->GetName()) {
+          same_fs = false;
+        }
+        copy = true;
         s = Status::OK();
       }
     }
-    if (!is_table_file || (!same_fs)) {
+    if (copy) {
       RLOG(db_->GetOptions().info_log, "Copying %s", src_fname.c_str());
-      s = CopyFile(db_->GetEnv(), db_->GetName() + src_fname,
+      s = CopyFile(db_->GetEnv(), src_dir + src_fname,
                    full_private_path + src_fname,
                    (type == kDescriptorFile) ? manifest_file_size : 0);
     }
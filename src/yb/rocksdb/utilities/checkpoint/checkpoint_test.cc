@@ -28,6 +28,7 @@
 #include <unistd.h>
 #endif
 #include <iostream>
+#include <limits>
 #include <thread>
 #include <utility>
 #include "yb/rocksdb/db/db_impl.h"
@@ -360,6 +361,39 @@ TEST_F(DBTest, CheckpointCF) {
   ASSERT_OK(DestroyDB(snapshot_name, options));
 }
 
+TEST_F(DBTest, CheckpointDbPaths) {
+  Options options = CurrentOptions();
+  // Compaction outputs do not fit the first path, so they are placed in the second one.
+  options.db_paths.emplace_back(dbname_, 0);
+  options.db_paths.emplace_back(dbname_ + "_2", std::numeric_limits<uint64_t>::max());
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1, files.size());
+  ASSERT_EQ(dbname_ + "_2", files[0].db_path);
+
+  const std::string snapshot_name = test::TmpDir(env_) + "/snapshot_db_paths";
+  ASSERT_OK(DestroyDB(snapshot_name, CurrentOptions()));
+  Checkpoint* checkpoint;
+  ASSERT_OK(Checkpoint::Create(db_, &checkpoint));
+  ASSERT_OK(checkpoint->CreateCheckpoint(snapshot_name));
+  delete checkpoint;
+
+  // All the files of the checkpoint are in one directory, where a DB with a single path finds them.
+  DB* snapshot_db;
+  ASSERT_OK(DB::Open(CurrentOptions(), snapshot_name, &snapshot_db));
+  std::string result;
+  ASSERT_OK(snapshot_db->Get(ReadOptions(), "foo", &result));
+  ASSERT_EQ("v2", result);
+  delete snapshot_db;
+  ASSERT_OK(DestroyDB(snapshot_name, CurrentOptions()));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
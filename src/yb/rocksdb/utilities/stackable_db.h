@@ -265,6 +265,14 @@ class StackableDB : public DB {
     db_->GetLiveFilesMetaData(metadata);
   }
 
+  int GetL0DelayTriggerCount() const override {
+    return db_->GetL0DelayTriggerCount();
+  }
+
+  Status PinKeyRange(const Slice* begin, const Slice* end) override {
+    return db_->PinKeyRange(begin, end);
+  }
+
   OpId GetFlushedOpId() override {
     return db_->GetFlushedOpId();
   }
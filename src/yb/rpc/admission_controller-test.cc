@@ -0,0 +1,68 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/rpc/admission_controller.h"
+
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace rpc {
+
+class AdmissionControllerTest : public YBTest {
+ protected:
+  void ObserveWindow(AdmissionController* controller, MonoDelta delay) {
+    for (size_t i = 0; i != AdmissionController::kWindowSize; ++i) {
+      controller->Observe(delay);
+    }
+  }
+};
+
+TEST_F(AdmissionControllerTest, AIMD) {
+  constexpr size_t kMinLimit = 10;
+  constexpr size_t kMaxLimit = 640;
+  const auto kTarget = MonoDelta::FromMilliseconds(50);
+  AdmissionController controller(kMinLimit, kMaxLimit, kTarget);
+  ASSERT_EQ(kMaxLimit, controller.limit());
+  ASSERT_EQ(kTarget.ToMicroseconds(), controller.retry_after().ToMicroseconds());
+
+  // Calls that do not wait longer than target delay do not affect the limit.
+  ObserveWindow(&controller, MonoDelta::FromMilliseconds(10));
+  ASSERT_EQ(kMaxLimit, controller.limit());
+
+  // Slow calls halve the limit, down to the min limit.
+  const auto kSlow = MonoDelta::FromMilliseconds(200);
+  ObserveWindow(&controller, kSlow);
+  ASSERT_EQ(kMaxLimit / 2, controller.limit());
+  ASSERT_EQ(kSlow.ToMicroseconds(), controller.retry_after().ToMicroseconds());
+  for (int i = 0; i != 10; ++i) {
+    ObserveWindow(&controller, kSlow);
+  }
+  ASSERT_EQ(kMinLimit, controller.limit());
+
+  // A few slow calls in the window are tolerated, and the limit recovers additively.
+  for (size_t i = 0; i != AdmissionController::kWindowSize; ++i) {
+    controller.Observe(i < 4 ? kSlow : MonoDelta::FromMilliseconds(1));
+  }
+  ASSERT_EQ(kMinLimit + kMaxLimit / 64, controller.limit());
+  ASSERT_EQ(kTarget.ToMicroseconds(), controller.retry_after().ToMicroseconds());
+  for (int i = 0; i != 100; ++i) {
+    ObserveWindow(&controller, MonoDelta::FromMilliseconds(1));
+  }
+  ASSERT_EQ(kMaxLimit, controller.limit());
+}
+
+} // namespace rpc
+} // namespace yb
@@ -0,0 +1,68 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rpc/admission_controller.h"
+
+#include <algorithm>
+
+namespace yb {
+namespace rpc {
+
+constexpr size_t AdmissionController::kWindowSize;
+
+AdmissionController::AdmissionController(
+    size_t min_limit, size_t max_limit, MonoDelta target_delay)
+    : min_limit_(std::max<size_t>(std::min(min_limit, max_limit), 1)),
+      max_limit_(std::max(max_limit, min_limit_)),
+      target_delay_us_(target_delay.ToMicroseconds()),
+      // Restores the full limit from the minimal one in about 64 windows.
+      increase_step_(std::max<size_t>(max_limit_ / 64, 1)),
+      limit_(max_limit_) {
+}
+
+void AdmissionController::Observe(MonoDelta queue_delay) {
+  const int64_t delay_us = queue_delay.ToMicroseconds();
+  window_delay_sum_us_.fetch_add(delay_us, std::memory_order_relaxed);
+  if (delay_us > target_delay_us_) {
+    window_slow_samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if ((window_samples_.fetch_add(1, std::memory_order_acq_rel) + 1) % kWindowSize != 0) {
+    return;
+  }
+
+  // This thread completed the window, so it adjusts the limit. Samples recorded concurrently
+  // could be accounted to the next window, it does not affect the result noticeably.
+  const auto slow_samples = window_slow_samples_.exchange(0, std::memory_order_acq_rel);
+  const auto delay_sum_us = window_delay_sum_us_.exchange(0, std::memory_order_acq_rel);
+  average_delay_us_.store(delay_sum_us / kWindowSize, std::memory_order_release);
+
+  auto limit = limit_.load(std::memory_order_acquire);
+  size_t new_limit;
+  do {
+    if (slow_samples * 4 > kWindowSize) {
+      new_limit = std::max(limit / 2, min_limit_);
+    } else {
+      new_limit = std::min(limit + increase_step_, max_limit_);
+    }
+  } while (new_limit != limit &&
+           !limit_.compare_exchange_weak(limit, new_limit, std::memory_order_acq_rel));
+}
+
+MonoDelta AdmissionController::retry_after() const {
+  return MonoDelta::FromMicroseconds(
+      std::max(average_delay_us_.load(std::memory_order_acquire), target_delay_us_));
+}
+
+} // namespace rpc
+} // namespace yb
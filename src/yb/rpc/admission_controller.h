@@ -0,0 +1,71 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_RPC_ADMISSION_CONTROLLER_H
+#define YB_RPC_ADMISSION_CONTROLLER_H
+
+#include <atomic>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/monotime.h"
+
+namespace yb {
+namespace rpc {
+
+// Adaptive limit on the number of calls queued to a service.
+//
+// The limit is adjusted using AIMD on the time calls spend in the service queue. After each
+// window of observed calls, the limit is halved if a noticeable part of them waited longer than
+// the target delay, otherwise it is increased by a fixed step. So an overloaded service starts to
+// push back early, instead of letting its queue to fill up with calls that would time out anyway.
+//
+// All methods are thread safe and lock free.
+class AdmissionController {
+ public:
+  // Number of observed calls, after which the limit is adjusted.
+  static constexpr size_t kWindowSize = 32;
+
+  AdmissionController(size_t min_limit, size_t max_limit, MonoDelta target_delay);
+
+  // Records the time spent in the queue by a call taken from it.
+  void Observe(MonoDelta queue_delay);
+
+  // Current limit on the number of queued calls.
+  size_t limit() const {
+    return limit_.load(std::memory_order_acquire);
+  }
+
+  // Suggested delay before the client retries a rejected call.
+  MonoDelta retry_after() const;
+
+ private:
+  const size_t min_limit_;
+  const size_t max_limit_;
+  const int64_t target_delay_us_;
+  const size_t increase_step_;
+
+  std::atomic<size_t> limit_;
+  std::atomic<size_t> window_samples_{0};
+  std::atomic<size_t> window_slow_samples_{0};
+  std::atomic<int64_t> window_delay_sum_us_{0};
+  // Average queue delay in the last complete window.
+  std::atomic<int64_t> average_delay_us_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(AdmissionController);
+};
+
+} // namespace rpc
+} // namespace yb
+
+#endif // YB_RPC_ADMISSION_CONTROLLER_H
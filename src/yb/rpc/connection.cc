@@ -266,6 +266,13 @@ void Connection::QueueOutboundCall(const OutboundCallPtr& call) {
   call->SetQueued();
 }
 
+void Connection::QueueOutboundBuffer(RefCntBuffer buffer) {
+  DCHECK(reactor_->IsCurrentThread());
+
+  sending_.push_back(std::move(buffer));
+  sending_outbound_datas_.resize(sending_.size());
+}
+
 void Connection::set_user_credentials(const UserCredentials& user_credentials) {
   user_credentials_.CopyFrom(user_credentials);
 }
@@ -305,7 +312,8 @@ Status Connection::ReadHandler() {
 
   for (;;) {
     bool received = false;
-    auto status = Receive(&received);
+    bool drained = false;
+    auto status = Receive(&received, &drained);
     if (PREDICT_FALSE(!status.ok())) {
       if (status.posix_code() == ESHUTDOWN) {
         VLOG(1) << ToString() << " shut down by remote end.";
@@ -322,13 +330,16 @@ Status Connection::ReadHandler() {
     // If status is ok, it means that we just do not have enough data to process yet.
     bool continue_receiving = false;
     status = TryProcessCalls(&continue_receiving);
-    if (!continue_receiving) {
+    // When socket was drained, the next recv would just fail with EAGAIN, so we wait for the next
+    // read event instead. Reactor uses level triggered events, so data that arrives meanwhile is
+    // not lost.
+    if (!continue_receiving || drained) {
       return status;
     }
   }
 }
 
-Status Connection::Receive(bool* received) {
+Status Connection::Receive(bool* received, bool* drained) {
   auto status = read_buffer_.PrepareRead();
   if (!status.ok()) {
     return status;
@@ -352,6 +363,7 @@ Status Connection::Receive(bool* received) {
   if (!status.ok()) {
     if (Socket::IsTemporarySocketError(status)) {
       *received = false;
+      *drained = true;
       return Status::OK();
     }
     return status;
@@ -359,6 +371,7 @@ Status Connection::Receive(bool* received) {
 
   read_buffer_.DataAppended(nread);
   *received = nread != 0;
+  *drained = nread < remaining_buf_capacity;
   return Status::OK();
 }
 
@@ -429,13 +442,17 @@ Status Connection::DoWrite() {
     return Status::OK();
   }
   while (!sending_.empty()) {
-    const size_t kMaxIov = 16;
+    // All queued buffers, i.e. headers, protobuf bodies and referenced sidecars of all queued
+    // outbound datas, are sent in a single writev call when there are not too many of them.
+    const size_t kMaxIov = 128;
     iovec iov[kMaxIov];
     const int iov_len = static_cast<int>(std::min(kMaxIov, sending_.size()));
     size_t offset = send_position_;
+    size_t total_len = 0;
     for (auto i = 0; i != iov_len; ++i) {
       iov[i].iov_base = sending_[i].data() + offset;
       iov[i].iov_len = sending_[i].size() - offset;
+      total_len += iov[i].iov_len;
       offset = 0;
     }
 
@@ -468,6 +485,14 @@ Status Connection::DoWrite() {
         call->Transferred(Status::OK());
       }
     }
+
+    if (static_cast<size_t>(written) < total_len) {
+      // Socket send buffer is full, so the next write would fail with EAGAIN. Wait until the
+      // socket becomes writable instead of wasting a syscall on it.
+      waiting_write_ready_ = true;
+      io_.set(ev::READ|ev::WRITE);
+      return Status::OK();
+    }
   }
 
   return Status::OK();
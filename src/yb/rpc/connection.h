@@ -81,6 +81,11 @@ class ConnectionContext {
   // Perform negotiation for a connection
   virtual void RunNegotiation(ConnectionPtr connection, const MonoTime& deadline) = 0;
 
+  // Negotiate a client connection on the reactor thread, by queueing the negotiation messages in
+  // front of the first calls. Returns false when the connection should be negotiated by
+  // RunNegotiation on the negotiation thread pool instead.
+  virtual bool PipelineNegotiation(Connection* connection) { return false; }
+
   // Split slice into separate calls and invoke them.
   // Return number of processed bytes in `consumed`.
   virtual CHECKED_STATUS ProcessCalls(const ConnectionPtr& connection,
@@ -185,6 +190,9 @@ class Connection final : public std::enable_shared_from_this<Connection> {
   // This may be called from a non-reactor thread.
   void QueueOutboundCall(const OutboundCallPtr& call);
 
+  // Queue raw data, e.g. pipelined negotiation messages, to be sent in front of the next calls.
+  void QueueOutboundBuffer(RefCntBuffer buffer);
+
   // The address of the remote end of the connection.
   const Endpoint& remote() const { return remote_; }
 
@@ -239,6 +247,10 @@ class Connection final : public std::enable_shared_from_this<Connection> {
 
   ConnectionContext& context() { return *context_; }
 
+  // Buffer that holds data being processed by ConnectionContext::ProcessCalls.
+  // Should be used only from the reactor thread.
+  const GrowableBuffer& read_buffer() const { return read_buffer_; }
+
  private:
   CHECKED_STATUS DoWrite();
 
@@ -251,7 +263,10 @@ class Connection final : public std::enable_shared_from_this<Connection> {
 
   void CallSent(OutboundCallPtr call);
 
-  CHECKED_STATUS Receive(bool* received);
+  // Receives data available in the socket into read buffer.
+  // received - whether any data was received.
+  // drained - whether socket has no more data, i.e. received less than requested.
+  CHECKED_STATUS Receive(bool* received, bool* drained);
 
   // Try to parse received data into calls and process them.
   CHECKED_STATUS TryProcessCalls(bool* had_calls);
@@ -58,6 +58,13 @@ static const int32_t kSaslCallId = -33;
 static const uint8_t kMagicNumberLength = 4;
 static const uint8_t kHeaderFlagsLength = 3;
 
+// Values of the authentication protocol flag of the connection header.
+// The client negotiates the connection with SASL.
+static const uint8_t kAuthProtoSasl = 0;
+// The client skips SASL and sends the connection context right after the connection header,
+// followed by its calls without waiting for the server. See rpc_fast_negotiation.
+static const uint8_t kAuthProtoTrusted = 1;
+
 // There is a 4-byte length prefix before any packet.
 static const uint8_t kMsgLengthPrefixLength = 4;
 
@@ -83,5 +83,42 @@ TEST_F(GrowableBufferTest, TestConsume) {
   }
 }
 
+TEST_F(GrowableBufferTest, TestShare) {
+  GrowableBuffer buffer(kInitialSize, kSizeLimit);
+
+  for (size_t i = 0; i != kInitialSize; ++i) {
+    buffer.write_position()[i] = static_cast<uint8_t>(i);
+  }
+  buffer.DataAppended(kInitialSize);
+
+  // Big chunk shares the buffer, small chunk is copied.
+  RefCntBuffer big_holder;
+  const size_t big_size = kInitialSize / 2 + 1;
+  Slice big = buffer.Share(Slice(buffer.begin(), big_size), &big_holder);
+  ASSERT_EQ(buffer.begin(), big.data());
+  RefCntBuffer small_holder;
+  Slice small = buffer.Share(Slice(buffer.begin() + big_size, 2), &small_holder);
+  ASSERT_NE(buffer.begin() + big_size, small.data());
+  ASSERT_EQ(Slice(buffer.begin() + big_size, 2), small);
+
+  // Remaining data should be moved to a new buffer, since consumed data is still referenced.
+  buffer.Consume(big_size);
+  ASSERT_NE(big.data(), buffer.begin());
+  ASSERT_OK(buffer.EnsureFreeSpace(kSizeLimit - buffer.size()));
+  memset(buffer.write_position(), 0xff, buffer.capacity_left());
+  buffer.DataAppended(buffer.capacity_left());
+  for (size_t i = 0; i != big_size; ++i) {
+    ASSERT_EQ(static_cast<uint8_t>(i), big[i]);
+  }
+  for (size_t i = 0; i != kInitialSize - big_size; ++i) {
+    ASSERT_EQ(static_cast<uint8_t>(big_size + i), buffer.begin()[i]);
+  }
+
+  // Buffer that is not shared is modified in place.
+  auto* old_begin = buffer.begin();
+  buffer.Consume(1);
+  ASSERT_EQ(old_begin, buffer.begin());
+}
+
 } // namespace rpc
 } // namespace yb
@@ -25,7 +25,7 @@ namespace yb {
 namespace rpc {
 
 GrowableBuffer::GrowableBuffer(size_t initial, size_t limit)
-    : buffer_(static_cast<uint8_t*>(malloc(initial))),
+    : buffer_(initial),
       limit_(limit),
       capacity_(initial),
       size_(0) {
@@ -41,13 +41,29 @@ void GrowableBuffer::Consume(size_t count) {
   }
   if (count) {
     size_t left = size_ - count;
-    if (left) {
-      memmove(buffer_.get(), buffer_.get() + count, left);
+    if (!buffer_.unique()) {
+      // Consumed data is still referenced, so remaining data is moved to a new buffer.
+      RefCntBuffer new_buffer(capacity_);
+      memcpy(new_buffer.udata(), buffer_.udata() + count, left);
+      buffer_ = std::move(new_buffer);
+    } else if (left) {
+      memmove(buffer_.udata(), buffer_.udata() + count, left);
     }
     size_ = left;
   }
 }
 
+Slice GrowableBuffer::Share(Slice data, RefCntBuffer* holder) const {
+  DCHECK_GE(data.data(), begin());
+  DCHECK_LE(data.end(), end());
+  if (data.size() * 2 >= capacity_) {
+    *holder = buffer_;
+    return data;
+  }
+  *holder = RefCntBuffer(data.data(), data.size());
+  return Slice(holder->udata(), holder->size());
+}
+
 void GrowableBuffer::Swap(GrowableBuffer* rhs) {
   DCHECK_EQ(limit_, rhs->limit_);
 
@@ -59,13 +75,15 @@ void GrowableBuffer::Swap(GrowableBuffer* rhs) {
 Status GrowableBuffer::Reshape(size_t new_capacity) {
   DCHECK_LE(new_capacity, limit_);
   if (new_capacity != capacity_) {
-    auto new_buffer = static_cast<uint8_t *>(realloc(buffer_.get(), new_capacity));
-    if (!new_buffer) {
+    if (new_capacity < size_) {
       return STATUS(RuntimeError,
-          Substitute("Failed to change buffer size from $0 to $1 bytes", capacity_, new_capacity));
+          Substitute("Failed to change buffer size from $0 to $1 bytes, $2 bytes used",
+                     capacity_, new_capacity, size_));
     }
-    buffer_.release();
-    buffer_.reset(new_buffer);
+    // Buffer could be shared, so data is always copied to a new one instead of reallocation.
+    RefCntBuffer new_buffer(new_capacity);
+    memcpy(new_buffer.udata(), buffer_.udata(), size_);
+    buffer_ = std::move(new_buffer);
     capacity_ = new_capacity;
   }
   return Status::OK();
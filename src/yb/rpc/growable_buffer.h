@@ -20,6 +20,7 @@
 
 #include "yb/gutil/gscoped_ptr.h"
 
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
 #include "yb/util/net/socket.h"
@@ -32,16 +33,17 @@ namespace rpc {
 //   Limit allocated bytes.
 //   Resize depending on used size.
 //   Consume read data.
+//   Share received data without copying it.
 class GrowableBuffer {
  public:
   explicit GrowableBuffer(size_t initial, size_t limit);
 
   inline bool empty() const { return size_ == 0; }
   inline size_t size() const { return size_; }
-  inline const uint8_t* begin() const { return buffer_.get(); }
-  inline const uint8_t* end() const { return buffer_.get() + size_; }
+  inline const uint8_t* begin() const { return buffer_.udata(); }
+  inline const uint8_t* end() const { return buffer_.udata() + size_; }
   inline size_t capacity_left() const { return capacity_ - size_; }
-  inline uint8_t* write_position() { return buffer_.get() + size_; }
+  inline uint8_t* write_position() { return buffer_.udata() + size_; }
   inline size_t limit() const { return limit_; }
 
   void Swap(GrowableBuffer* rhs);
@@ -59,6 +61,15 @@ class GrowableBuffer {
   // Since even a big packet is received by parts, we will move only the first received block.
   void Consume(size_t count);
 
+  // Returns slice with the same content as `data`, that should be located in this buffer, and
+  // stores the buffer holding the returned slice to `holder`. The slice remains valid while
+  // `holder` is alive, even after data is consumed from this buffer.
+  //
+  // When data occupies a significant part of this buffer, the buffer itself is shared, and it is
+  // never modified in place while shared, i.e. a new buffer is allocated by Consume or when the
+  // buffer is resized. Otherwise data is copied, so small chunks don't pin a big buffer.
+  Slice Share(Slice data, RefCntBuffer* holder) const;
+
   // Ensures there is some space to read into. Depending on currently used size.
   CHECKED_STATUS PrepareRead();
 
@@ -79,8 +90,8 @@ class GrowableBuffer {
  private:
   CHECKED_STATUS Reshape(size_t new_capacity);
 
-  // Contained data
-  std::unique_ptr<uint8_t, FreeDeleter> buffer_;
+  // Contained data, could be shared with slices returned by Share.
+  RefCntBuffer buffer_;
 
   // Max capacity for this buffer
   const size_t limit_;
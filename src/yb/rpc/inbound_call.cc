@@ -80,6 +80,9 @@ InboundCall::InboundCall(ConnectionPtr conn, CallProcessedListener call_processe
     : trace_(new Trace),
       conn_(std::move(conn)),
       call_processed_listener_(std::move(call_processed_listener)) {
+  if (Trace::ShouldSample()) {
+    trace_->set_sampled();
+  }
   TRACE_TO(trace_, "Created InboundCall");
   RecordCallReceived();
 }
@@ -115,22 +118,50 @@ ConnectionPtr InboundCall::connection() const {
   return conn_;
 }
 
+Slice InboundCall::StoreRequestData(Slice source) {
+  if (conn_) {
+    return conn_->read_buffer().Share(source, &request_data_);
+  }
+  request_data_ = RefCntBuffer(source.data(), source.size());
+  return Slice(request_data_.udata(), request_data_.size());
+}
+
 Trace* InboundCall::trace() {
   return trace_.get();
 }
 
+void InboundCall::DumpTrace(std::ostream* out) const {
+  if (trace_->enabled()) {
+    trace_->Dump(out, /* include_time_deltas */ true);
+    return;
+  }
+  const auto now = MonoTime::FineNow();
+  *out << "Not sampled for tracing. ";
+  if (timing_.time_handled.Initialized()) {
+    *out << "Queued for " << (timing_.time_handled - timing_.time_received).ToMicroseconds()
+         << "us, handled for " << (now - timing_.time_handled).ToMicroseconds() << "us.";
+  } else {
+    *out << "Queued for " << (now - timing_.time_received).ToMicroseconds() << "us.";
+  }
+}
+
 void InboundCall::RecordCallReceived() {
   TRACE_EVENT_ASYNC_BEGIN0("rpc", "InboundCall", this);
   DCHECK(!timing_.time_received.Initialized());  // Protect against multiple calls.
   timing_.time_received = MonoTime::Now(MonoTime::FINE);
 }
 
-void InboundCall::RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time) {
+void InboundCall::RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time,
+                                        scoped_refptr<Histogram> class_queue_time) {
   DCHECK(incoming_queue_time != nullptr);
   DCHECK(!timing_.time_handled.Initialized());  // Protect against multiple calls.
   timing_.time_handled = MonoTime::Now(MonoTime::FINE);
-  incoming_queue_time->Increment(
-      timing_.time_handled.GetDeltaSince(timing_.time_received).ToMicroseconds());
+  const auto queue_time =
+      timing_.time_handled.GetDeltaSince(timing_.time_received).ToMicroseconds();
+  incoming_queue_time->Increment(queue_time);
+  if (class_queue_time) {
+    class_queue_time->Increment(queue_time);
+  }
 }
 
 void InboundCall::RecordHandlingCompleted(scoped_refptr<Histogram> handler_run_time) {
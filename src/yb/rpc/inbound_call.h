@@ -114,10 +114,12 @@ class InboundCall : public RpcCall {
   void RecordCallReceived();
 
   // When RPC call Handle() was called on the server side.
-  // Updates the Histogram with time elapsed since the call was received,
+  // Updates the Histograms with time elapsed since the call was received,
   // and should only be called once on a given instance.
   // Not thread-safe. Should only be called by the current "owner" thread.
-  virtual void RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time);
+  // class_queue_time, if not null, is also updated with the same value.
+  virtual void RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time,
+                                     scoped_refptr<Histogram> class_queue_time);
 
   // When RPC call Handle() completed execution on the server side.
   // Updates the Histogram with time elapsed since the call was started,
@@ -139,6 +141,12 @@ class InboundCall : public RpcCall {
   virtual const std::string& service_name() const = 0;
   virtual void RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code, const Status& status) = 0;
 
+  // Responds with ERROR_SERVER_TOO_BUSY, suggesting the client to retry after the specified delay.
+  // Protocols that could not pass the hint to the client just respond with failure.
+  virtual void RespondBusy(const Status& status, MonoDelta retry_after) {
+    RespondFailure(ErrorStatusPB::ERROR_SERVER_TOO_BUSY, status);
+  }
+
  protected:
   void NotifyTransferred(const Status& status) override;
 
@@ -148,14 +156,23 @@ class InboundCall : public RpcCall {
   // Also can be configured to log _all_ RPC traces for help debugging.
   virtual void LogTrace() const = 0;
 
+  // Dumps the trace of this call. For a call that was not traced, dumps the time it spent queued
+  // and handled, so slow calls always get a breakdown.
+  void DumpTrace(std::ostream* out) const;
+
   void QueueResponse(bool is_success);
 
+  // Takes ownership of call data, that was received into the connection read buffer, usually
+  // without copying it. Returns slice with the same content that remains valid during the whole
+  // lifetime of this call. Should be invoked from the reactor thread while processing calls.
+  Slice StoreRequestData(Slice source);
+
   // The serialized bytes of the request param protobuf. Set by ParseFrom().
-  // This references memory held by 'transfer_'.
+  // This references memory held by 'request_data_'.
   Slice serialized_request_;
 
   // Data source of this call.
-  std::vector<char> request_data_;
+  RefCntBuffer request_data_;
 
   // The trace buffer.
   scoped_refptr<Trace> trace_;
@@ -15,6 +15,8 @@
 
 #include "yb/rpc/local_call.h"
 
+#include <google/protobuf/io/coded_stream.h>
+
 #include "yb/rpc/rpc_controller.h"
 #include "yb/util/memory/memory.h"
 
@@ -33,7 +35,22 @@ LocalOutboundCall::LocalOutboundCall(
 }
 
 Status LocalOutboundCall::SetRequestParam(const google::protobuf::Message& req) {
-  req_ = &req;
+  const auto& extra_data = controller()->request_extra_data();
+  if (extra_data.empty()) {
+    req_ = &req;
+    return Status::OK();
+  }
+
+  // The service expects a single request message, so merge the extra fields into a copy.
+  owned_req_.reset(req.New());
+  owned_req_->CopyFrom(req);
+  for (const auto& buffer : extra_data) {
+    google::protobuf::io::CodedInputStream input(buffer.udata(), static_cast<int>(buffer.size()));
+    if (!owned_req_->MergePartialFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
+      return STATUS(InvalidArgument, "Failed to parse request extra data");
+    }
+  }
+  req_ = owned_req_.get();
   return Status::OK();
 }
 
@@ -16,6 +16,8 @@
 #ifndef YB_RPC_LOCAL_CALL_H
 #define YB_RPC_LOCAL_CALL_H
 
+#include <memory>
+
 #include "yb/rpc/outbound_call.h"
 #include "yb/rpc/yb_rpc.h"
 
@@ -46,6 +48,9 @@ class LocalOutboundCall : public OutboundCall {
 
   const google::protobuf::Message* req_ = nullptr;
 
+  // Copy of the request merged with the request extra data of the controller, if there is any.
+  std::unique_ptr<google::protobuf::Message> owned_req_;
+
   std::shared_ptr<LocalYBInboundCall> inbound_call_;
 };
 
@@ -67,6 +67,7 @@
 #include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 #include "yb/util/net/socket.h"
+#include "yb/util/net/tls.h"
 #include "yb/util/status.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
@@ -81,6 +82,8 @@ DEFINE_int32(rpc_default_keepalive_time_ms, 65000,
              "will disconnect the client.");
 TAG_FLAG(rpc_default_keepalive_time_ms, advanced);
 DEFINE_uint64(io_thread_pool_size, 4, "Size of allocated IO Thread Pool.");
+DEFINE_bool(rpc_use_tls, false,
+            "Encrypt RPC connections with TLS, using the certificates from the tls_* flags.");
 
 namespace yb {
 namespace rpc {
@@ -126,6 +129,9 @@ MessengerBuilder &MessengerBuilder::set_metric_entity(
 
 Status MessengerBuilder::Build(Messenger **msgr) {
   RETURN_NOT_OK(SaslInit(kSaslAppName)); // Initialize SASL library before we start making requests
+  if (!tls_context_ && FLAGS_rpc_use_tls) {
+    RETURN_NOT_OK(TlsContext::Create(TlsOptions::FromFlags(), &tls_context_));
+  }
   gscoped_ptr<Messenger> new_msgr(new Messenger(*this));
   RETURN_NOT_OK(new_msgr.get()->Init());
   *msgr = new_msgr.release();
@@ -261,6 +267,15 @@ void Messenger::RestoreConnectivityWith(const IpAddress& address) {
   }
 }
 
+std::shared_ptr<OutboundConnectionsLoad> Messenger::ConnectionsLoad(const Endpoint& remote) {
+  std::lock_guard<std::mutex> lock(connections_load_mutex_);
+  auto& result = connections_load_[remote];
+  if (!result) {
+    result = std::make_shared<OutboundConnectionsLoad>(FLAGS_num_connections_to_server);
+  }
+  return result;
+}
+
 bool Messenger::IsArtificiallyDisconnectedFrom(const IpAddress& remote) {
   if (has_broken_connectivity_.load(std::memory_order_acquire)) {
     shared_lock<rw_spinlock> guard(lock_.get_lock());
@@ -379,6 +394,7 @@ void Messenger::RegisterInboundSocket(Socket *new_socket, const Endpoint& remote
 Messenger::Messenger(const MessengerBuilder &bld)
   : name_(bld.name_),
     connection_context_factory_(bld.connection_context_factory_),
+    tls_context_(bld.tls_context_),
     metric_entity_(bld.metric_entity_),
     retain_self_(this),
     io_thread_pool_(FLAGS_io_thread_pool_size),
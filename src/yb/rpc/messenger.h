@@ -63,6 +63,7 @@ namespace yb {
 
 class Socket;
 class ThreadPool;
+class TlsContext;
 
 namespace rpc {
 
@@ -105,6 +106,13 @@ class MessengerBuilder {
     return *this;
   }
 
+  // Encrypts all connections with TLS. When not set, connections use TLS configured by the tls_*
+  // flags if rpc_use_tls is set.
+  MessengerBuilder &set_tls_context(std::shared_ptr<TlsContext> tls_context) {
+    tls_context_ = std::move(tls_context);
+    return *this;
+  }
+
   CHECKED_STATUS Build(std::shared_ptr<Messenger> *msgr);
 
   MonoDelta connection_keepalive_time() const { return connection_keepalive_time_; }
@@ -118,6 +126,7 @@ class MessengerBuilder {
   MonoDelta coarse_timer_granularity_;
   scoped_refptr<MetricEntity> metric_entity_;
   ConnectionContextFactory connection_context_factory_;
+  std::shared_ptr<TlsContext> tls_context_;
 };
 
 // A Messenger is a container for the reactor threads which run event loops
@@ -199,6 +208,9 @@ class Messenger {
 
   yb::ThreadPool* negotiation_pool() const { return negotiation_pool_.get(); }
 
+  // TLS configuration of the connections, or nullptr when they are not encrypted.
+  TlsContext* tls_context() const { return tls_context_.get(); }
+
   std::string name() const {
     return name_;
   }
@@ -222,6 +234,9 @@ class Messenger {
     return scheduler_;
   }
 
+  // Returns load of outbound connections to the specified server, shared by all proxies to it.
+  std::shared_ptr<OutboundConnectionsLoad> ConnectionsLoad(const Endpoint& remote);
+
  private:
   FRIEND_TEST(TestRpc, TestConnectionKeepalive);
   friend class DelayedTask;
@@ -242,6 +257,8 @@ class Messenger {
 
   ConnectionContextFactory connection_context_factory_;
 
+  const std::shared_ptr<TlsContext> tls_context_;
+
   // Protects closing_, acceptor_pools_, rpc_services_.
   mutable percpu_rwlock lock_;
 
@@ -323,6 +340,10 @@ class Messenger {
   // Set of addresses with artificially broken connectivity.
   std::unordered_set<IpAddress, IpAddressHash> broken_connectivity_;
 
+  std::mutex connections_load_mutex_;
+  std::unordered_map<Endpoint, std::shared_ptr<OutboundConnectionsLoad>, EndpointHash>
+      connections_load_;
+
   IoThreadPool io_thread_pool_;
   Scheduler scheduler_;
 
@@ -44,13 +44,16 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rpc/blocking_ops.h"
 #include "yb/rpc/connection.h"
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/reactor.h"
 #include "yb/rpc/rpc_header.pb.h"
 #include "yb/rpc/sasl_client.h"
 #include "yb/rpc/sasl_common.h"
 #include "yb/rpc/sasl_server.h"
+#include "yb/rpc/serialization.h"
 #include "yb/rpc/yb_rpc.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/net/tls.h"
 #include "yb/util/status.h"
 #include "yb/util/trace.h"
 
@@ -60,6 +63,16 @@ TAG_FLAG(rpc_trace_negotiation, runtime);
 TAG_FLAG(rpc_trace_negotiation, advanced);
 TAG_FLAG(rpc_trace_negotiation, experimental);
 
+DEFINE_bool(rpc_fast_negotiation, false,
+            "Skip SASL negotiation of outbound connections, sending the connection context right "
+            "after the connection header and the first calls right after it, without waiting for "
+            "the server. Only for trusted intra-cluster links, with servers that accept it.");
+TAG_FLAG(rpc_fast_negotiation, advanced);
+
+DEFINE_bool(rpc_accept_fast_negotiation, true,
+            "Accept inbound connections that skip SASL negotiation, see rpc_fast_negotiation.");
+TAG_FLAG(rpc_accept_fast_negotiation, advanced);
+
 namespace yb {
 namespace rpc {
 
@@ -68,6 +81,11 @@ namespace {
 using std::shared_ptr;
 using strings::Substitute;
 
+void FillConnectionContext(Connection *conn, ConnectionContextPB* conn_context) {
+  conn_context->mutable_user_info()->set_effective_user(conn->user_credentials().effective_user());
+  conn_context->mutable_user_info()->set_real_user(conn->user_credentials().real_user());
+}
+
 // Client: Send ConnectionContextPB message based on information stored in the Connection object.
 Status SendConnectionContext(Connection *conn, const MonoTime &deadline) {
   TRACE("Sending connection context");
@@ -75,17 +93,61 @@ Status SendConnectionContext(Connection *conn, const MonoTime &deadline) {
   header.set_call_id(kConnectionContextCallId);
 
   ConnectionContextPB conn_context;
-  conn_context.mutable_user_info()->set_effective_user(conn->user_credentials().effective_user());
-  conn_context.mutable_user_info()->set_real_user(conn->user_credentials().real_user());
+  FillConnectionContext(conn, &conn_context);
 
   return SendFramedMessageBlocking(conn->socket(), header, conn_context, deadline);
 }
 
+// Client: Serialize the connection header of a trusted connection followed by the
+// ConnectionContextPB message, which is all the server expects before the calls.
+Status SerializeTrustedPreamble(Connection *conn, RefCntBuffer* buffer) {
+  RequestHeader header;
+  header.set_call_id(kConnectionContextCallId);
+  ConnectionContextPB conn_context;
+  FillConnectionContext(conn, &conn_context);
+
+  RefCntBuffer param_buf;
+  RETURN_NOT_OK(serialization::SerializeMessage(conn_context, &param_buf));
+  RefCntBuffer header_buf;
+  RETURN_NOT_OK(serialization::SerializeHeader(header, param_buf.size(), &header_buf));
+
+  const size_t conn_header_len = kMagicNumberLength + kHeaderFlagsLength;
+  *buffer = RefCntBuffer(conn_header_len + header_buf.size() + param_buf.size());
+  auto* out = buffer->udata();
+  serialization::SerializeConnHeader(out, kAuthProtoTrusted);
+  out += conn_header_len;
+  memcpy(out, header_buf.data(), header_buf.size());
+  out += header_buf.size();
+  memcpy(out, param_buf.data(), param_buf.size());
+  return Status::OK();
+}
+
+// Client: Send the connection header and context of a trusted connection. The server does not
+// respond to them, so the connection is ready for calls right after.
+Status SendTrustedPreamble(Connection *conn, const MonoTime &deadline) {
+  TRACE("Sending trusted connection header and context");
+  RefCntBuffer buffer;
+  RETURN_NOT_OK(SerializeTrustedPreamble(conn, &buffer));
+  size_t nsent;
+  return conn->socket()->BlockingWrite(buffer.udata(), buffer.size(), &nsent, deadline);
+}
+
+// Server: Receive and validate the connection header, storing its authentication protocol flag
+// to auth_proto.
+Status ReceiveConnectionHeader(Connection *conn, const MonoTime &deadline, uint8_t* auth_proto) {
+  TRACE("Waiting for connection header");
+  const size_t conn_header_len = kMagicNumberLength + kHeaderFlagsLength;
+  uint8_t buf[conn_header_len];
+  size_t num_read;
+  RETURN_NOT_OK(conn->socket()->BlockingRecv(buf, conn_header_len, &num_read, deadline));
+  return serialization::ValidateConnHeader(Slice(buf, conn_header_len), auth_proto);
+}
+
 // Server: Receive ConnectionContextPB message and update the corresponding fields in the
 // associated Connection object. Perform validation against SASL-negotiated information
-// as needed.
+// as needed. sasl_server is null when the connection was not negotiated with SASL.
 Status RecvConnectionContext(Connection *conn,
-                             YBConnectionContext *context,
+                             const SaslServer* sasl_server,
                              const MonoTime &deadline) {
   TRACE("Waiting for connection context");
   faststring recv_buf(1024); // Should be plenty for a ConnectionContextPB message.
@@ -109,13 +171,13 @@ Status RecvConnectionContext(Connection *conn,
   // Update the fields of our Connection object from the ConnectionContextPB.
   if (conn_context.has_user_info()) {
     // Validate real user against SASL impl.
-    if (context->sasl_server().negotiated_mechanism() == SaslMechanism::PLAIN) {
-      if (context->sasl_server().plain_auth_user() != conn_context.user_info().real_user()) {
+    if (sasl_server && sasl_server->negotiated_mechanism() == SaslMechanism::PLAIN) {
+      if (sasl_server->plain_auth_user() != conn_context.user_info().real_user()) {
         return STATUS(NotAuthorized,
             "ConnectionContextPB specified different real user than sent in SASL negotiation",
             StringPrintf("\"%s\" vs. \"%s\"",
                 conn_context.user_info().real_user().c_str(),
-                context->sasl_server().plain_auth_user().c_str()));
+                sasl_server->plain_auth_user().c_str()));
       }
     }
     conn->mutable_user_credentials()->set_real_user(conn_context.user_info().real_user());
@@ -210,6 +272,9 @@ Status DoClientNegotiation(Connection *conn,
                            const MonoTime &deadline) {
   RETURN_NOT_OK(WaitForClientConnect(conn, deadline));
   RETURN_NOT_OK(conn->SetNonBlocking(false));
+  if (FLAGS_rpc_fast_negotiation) {
+    return SendTrustedPreamble(conn, deadline);
+  }
   RETURN_NOT_OK(context->InitSaslClient(conn));
   context->sasl_client().set_deadline(deadline);
   RETURN_NOT_OK(context->sasl_client().Negotiate());
@@ -223,21 +288,69 @@ static Status DoServerNegotiation(Connection *conn,
                                   YBConnectionContext *context,
                                   const MonoTime &deadline) {
   RETURN_NOT_OK(conn->SetNonBlocking(false));
+  uint8_t auth_proto = kAuthProtoSasl;
+  RETURN_NOT_OK(ReceiveConnectionHeader(conn, deadline, &auth_proto));
+  if (auth_proto == kAuthProtoTrusted) {
+    if (!FLAGS_rpc_accept_fast_negotiation) {
+      return STATUS(NotAuthorized, "Connections without SASL negotiation are not accepted");
+    }
+    // Calls sent by the client right after the context stay in the socket until the reactor
+    // starts reading it.
+    return RecvConnectionContext(conn, nullptr /* sasl_server */, deadline);
+  }
   RETURN_NOT_OK(context->InitSaslServer(conn));
   context->sasl_server().set_deadline(deadline);
+  context->sasl_server().set_connection_header_received();
   RETURN_NOT_OK(context->sasl_server().Negotiate());
-  RETURN_NOT_OK(RecvConnectionContext(conn, context, deadline));
+  RETURN_NOT_OK(RecvConnectionContext(conn, &context->sasl_server(), deadline));
 
   return Status::OK();
 }
 
+// Perform the TLS handshake before the negotiation of the connection context, so everything that
+// follows, including SASL, is encrypted.
+Status StartTls(Connection *conn, TlsContext* tls_context, const MonoTime &deadline) {
+  TRACE("Starting TLS");
+  const bool server = conn->direction() == ConnectionDirection::SERVER;
+  if (!server) {
+    RETURN_NOT_OK(WaitForClientConnect(conn, deadline));
+  }
+  RETURN_NOT_OK(conn->SetNonBlocking(false));
+  return conn->socket()->StartTls(
+      tls_context, server, yb::ToString(conn->remote()), deadline);
+}
+
 } // namespace
 
 void Negotiation::RunNegotiation(ConnectionPtr conn,
                                  const MonoTime& deadline) {
+  auto* tls_context = conn->reactor()->messenger()->tls_context();
+  if (tls_context != nullptr) {
+    auto status = StartTls(conn.get(), tls_context, deadline);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to start TLS on " << conn->ToString() << ": " << status.ToString();
+      conn->CompleteNegotiation(std::move(status));
+      return;
+    }
+  }
   conn->RunNegotiation(deadline);
 }
 
+bool Negotiation::PipelineYBNegotiation(Connection* conn) {
+  if (!FLAGS_rpc_fast_negotiation || conn->direction() != ConnectionDirection::CLIENT ||
+      conn->reactor()->messenger()->tls_context() != nullptr) {
+    return false;
+  }
+  RefCntBuffer preamble;
+  auto status = SerializeTrustedPreamble(conn, &preamble);
+  if (!status.ok()) {
+    LOG(DFATAL) << "Failed to serialize connection context: " << status.ToString();
+    return false;
+  }
+  conn->QueueOutboundBuffer(std::move(preamble));
+  return true;
+}
+
 void Negotiation::YBNegotiation(ConnectionPtr conn,
                                 YBConnectionContext* context,
                                 const MonoTime& deadline) {
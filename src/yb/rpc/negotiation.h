@@ -49,6 +49,11 @@ class Negotiation {
   static void YBNegotiation(ConnectionPtr conn,
                             YBConnectionContext* context,
                             const MonoTime& deadline);
+
+  // Queues the connection header and context of a trusted client connection in front of its
+  // calls, when rpc_fast_negotiation is set and the connection does not use TLS, whose handshake
+  // needs the negotiation thread. Returns whether the connection was negotiated this way.
+  static bool PipelineYBNegotiation(Connection* conn);
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(Negotiation);
 };
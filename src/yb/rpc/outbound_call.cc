@@ -31,6 +31,7 @@
 //
 
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <mutex>
 #include <vector>
@@ -123,26 +124,32 @@ OutboundCall::OutboundCall(
       callback_(std::move(callback)),
       trace_(new Trace),
       outbound_call_metrics_(outbound_call_metrics) {
+  if (Trace::CurrentTrace()) {
+    Trace::CurrentTrace()->AddChildTrace(trace_.get());
+  }
   if (PREDICT_FALSE(VLOG_IS_ON(1))) {
     TRACE_TO(trace_, "Outbound Call initiated to $0", conn_id.ToString());
   } else {
     // Avoid expensive conn_id.ToString() in production.
     TRACE_TO(trace_, "Outbound Call initiated.");
   }
-  if (Trace::CurrentTrace()) {
-    Trace::CurrentTrace()->AddChildTrace(trace_.get());
-  }
 
   DVLOG(4) << "OutboundCall " << this << " constructed with state_: " << StateName(state_)
            << " and RPC timeout: "
            << (controller->timeout().Initialized() ? controller->timeout().ToString() : "none");
   header_.set_call_id(NextCallId());
   remote_method.ToPB(header_.mutable_remote_method());
+  if (trace_->sampled()) {
+    header_.set_trace_sampled(true);
+  }
   start_ = MonoTime::Now(MonoTime::FINE);
 }
 
 OutboundCall::~OutboundCall() {
   DCHECK(IsFinished());
+  if (connections_load_) {
+    connections_load_->Release(conn_id_.idx());
+  }
   DVLOG(4) << "OutboundCall " << this << " destroyed with state_: " << StateName(state_);
 
   if (PREDICT_FALSE(FLAGS_rpc_dump_all_traces)) {
@@ -173,6 +180,7 @@ void OutboundCall::NotifyTransferred(const Status& status) {
 
 void OutboundCall::Serialize(std::deque<RefCntBuffer>* output) const {
   output->push_back(buffer_);
+  output->insert(output->end(), request_extra_data_.begin(), request_extra_data_.end());
 }
 
 Status OutboundCall::SetRequestParam(const Message& message) {
@@ -184,10 +192,16 @@ Status OutboundCall::SetRequestParam(const Message& message) {
     header_.set_timeout_millis(timeout.ToMilliseconds());
   }
 
+  request_extra_data_ = controller_->request_extra_data();
+  size_t extra_size = 0;
+  for (const auto& buffer : request_extra_data_) {
+    extra_size += buffer.size();
+  }
+
   size_t message_size = 0;
   auto status = SerializeMessage(message,
                                  /* param_buf */ nullptr,
-                                 /* additional_size */ 0,
+                                 static_cast<int>(extra_size),
                                  /* use_cached_size */ false,
                                  /* offset */ 0,
                                  &message_size);
@@ -195,13 +209,14 @@ Status OutboundCall::SetRequestParam(const Message& message) {
     return status;
   }
   size_t header_size = 0;
-  status = SerializeHeader(header_, message_size, &buffer_, message_size, &header_size);
+  status = SerializeHeader(
+      header_, message_size + extra_size, &buffer_, message_size, &header_size);
   if (!status.ok()) {
     return status;
   }
   return SerializeMessage(message,
                           &buffer_,
-                          /* additional_size */ 0,
+                          static_cast<int>(extra_size),
                           /* use_cached_size */ true,
                           header_size);
 }
@@ -277,6 +292,13 @@ void OutboundCall::set_state_unlocked(State new_state) {
 }
 
 void OutboundCall::CallCallback() {
+  // The call is finished, so the connection could be used for new calls, even if the callback is
+  // slow or the call object is retained by the caller.
+  if (connections_load_) {
+    connections_load_->Release(conn_id_.idx());
+    connections_load_.reset();
+  }
+
   int64_t start_cycles = CycleClock::Now();
   {
     SCOPED_WATCH_STACK(100);
@@ -346,6 +368,7 @@ void OutboundCall::SetQueued() {
 
 void OutboundCall::SetSent() {
   buffer_ = RefCntBuffer();
+  request_extra_data_.clear();
   // Track time taken to be sent
   if (outbound_call_metrics_) {
     auto end_time = MonoTime::Now(MonoTime::FINE);
@@ -557,6 +580,41 @@ bool ConnectionId::Equals(const ConnectionId& other) const {
        && idx_ == other.idx_;
 }
 
+///
+/// OutboundConnectionsLoad
+///
+
+OutboundConnectionsLoad::OutboundConnectionsLoad(size_t num_connections)
+    : outstanding_calls_(std::max<size_t>(num_connections, 1)) {
+  CHECK_LE(outstanding_calls_.size(), std::numeric_limits<uint8_t>::max() + 1);
+  for (auto& calls : outstanding_calls_) {
+    calls.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint8_t OutboundConnectionsLoad::Acquire() {
+  const size_t size = outstanding_calls_.size();
+  const size_t start = next_idx_.fetch_add(1, std::memory_order_relaxed) % size;
+  size_t best_idx = start;
+  size_t best_calls = outstanding_calls_[start].load(std::memory_order_acquire);
+  for (size_t i = 1; i != size && best_calls != 0; ++i) {
+    const size_t idx = (start + i) % size;
+    const size_t calls = outstanding_calls_[idx].load(std::memory_order_acquire);
+    if (calls < best_calls) {
+      best_idx = idx;
+      best_calls = calls;
+    }
+  }
+  outstanding_calls_[best_idx].fetch_add(1, std::memory_order_acq_rel);
+  return static_cast<uint8_t>(best_idx);
+}
+
+void OutboundConnectionsLoad::Release(uint8_t idx) {
+  DCHECK_LT(idx, outstanding_calls_.size());
+  auto previous = outstanding_calls_[idx].fetch_sub(1, std::memory_order_acq_rel);
+  DCHECK_GT(previous, 0);
+}
+
 size_t ConnectionIdHash::operator() (const ConnectionId& conn_id) const {
   return conn_id.HashCode();
 }
@@ -32,6 +32,7 @@
 #ifndef YB_RPC_OUTBOUND_CALL_H_
 #define YB_RPC_OUTBOUND_CALL_H_
 
+#include <atomic>
 #include <deque>
 #include <string>
 #include <vector>
@@ -172,6 +173,35 @@ class ConnectionIdEqual {
   bool operator() (const ConnectionId& cid1, const ConnectionId& cid2) const;
 };
 
+// Tracks the number of outstanding outbound calls on each of the connections to the same server,
+// so that a new call is sent over the least loaded connection, instead of queueing behind a slow
+// call on a connection picked in round robin order.
+//
+// Thread safe. Selection is approximate, since concurrent callers could pick the same connection.
+class OutboundConnectionsLoad {
+ public:
+  explicit OutboundConnectionsLoad(size_t num_connections);
+
+  // Picks the connection with the least number of outstanding calls and accounts a new call on it.
+  // Ties are resolved in round robin order. Returns connection index.
+  uint8_t Acquire();
+
+  // Accounts that a call on the connection with the specified index has finished.
+  void Release(uint8_t idx);
+
+  size_t num_connections() const { return outstanding_calls_.size(); }
+
+  size_t outstanding_calls(uint8_t idx) const {
+    return outstanding_calls_[idx].load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<std::atomic<size_t>> outstanding_calls_;
+  std::atomic<size_t> next_idx_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(OutboundConnectionsLoad);
+};
+
 // Container for OutboundCall metrics
 struct OutboundCallMetrics {
   explicit OutboundCallMetrics(const scoped_refptr<MetricEntity>& metric_entity);
@@ -264,6 +294,8 @@ class OutboundCall : public RpcCall {
   virtual ~OutboundCall();
 
   // Serialize the given request PB into this call's internal storage.
+  // Request extra data of the controller is sent after it, see
+  // RpcController::set_request_extra_data().
   //
   // Because the data is fully serialized by this call, 'req' may be
   // subsequently mutated with no ill effects.
@@ -336,6 +368,12 @@ class OutboundCall : public RpcCall {
     return trace_.get();
   }
 
+  // Account this call in the specified connections load, until the call is finished.
+  // Should be invoked before the call is queued.
+  void SetConnectionsLoad(std::shared_ptr<OutboundConnectionsLoad> connections_load) {
+    connections_load_ = std::move(connections_load);
+  }
+
  protected:
   friend class RpcController;
 
@@ -404,6 +442,9 @@ class OutboundCall : public RpcCall {
   // Buffers for storing segments of the wire-format request.
   RefCntBuffer buffer_;
 
+  // Serialized request fields, that are sent after buffer_ without copying.
+  std::vector<RefCntBuffer> request_extra_data_;
+
   // Once a response has been received for this call, contains that response.
   CallResponse call_response_;
 
@@ -412,6 +453,9 @@ class OutboundCall : public RpcCall {
 
   std::shared_ptr<OutboundCallMetrics> outbound_call_metrics_;
 
+  // Load of connections to the remote server, that accounts this call while it is not finished.
+  std::shared_ptr<OutboundConnectionsLoad> connections_load_;
+
   DISALLOW_COPY_AND_ASSIGN(OutboundCall);
 };
 
@@ -450,6 +450,7 @@ class CodeGenerator : public ::google::protobuf::compiler::CodeGenerator {
       "#include \"yb/rpc/rpc_context.h\"\n"
       "#include \"yb/rpc/service_if.h\"\n"
       "#include \"yb/util/metrics.h\"\n"
+      "#include \"yb/util/object_pool.h\"\n"
       "\n");
 
     // Define metric prototypes for each method in the service.
@@ -467,7 +468,7 @@ class CodeGenerator : public ::google::protobuf::compiler::CodeGenerator {
           "  \"$rpc_full_name$ RPC Time\",\n"
           "  yb::MetricUnit::kMicroseconds,\n"
           "  \"Microseconds spent handling $rpc_full_name$() RPC requests\",\n"
-          "  60000000LU, 2);\n"
+          "  60000000LU, 2, yb::SHARDED_HISTOGRAM);\n"
           "\n");
         subs->Pop();
       }
@@ -508,8 +509,8 @@ class CodeGenerator : public ::google::protobuf::compiler::CodeGenerator {
         "            metrics_[$metric_enum_key$]) :\n"
         "        ::yb::rpc::RpcContext(\n"
         "            yb_call, \n"
-        "            std::make_shared<$request$>(),\n"
-        "            std::make_shared<$response$>(),\n"
+        "            ::yb::MakePooledShared<$request$>(),\n"
+        "            ::yb::MakePooledShared<$response$>(),\n"
         "            metrics_[$metric_enum_key$]);\n"
         "    if (!rpc_context.responded()) {\n"
         "      const auto* req = static_cast<const $request$*>(rpc_context.request_pb());\n"
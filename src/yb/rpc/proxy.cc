@@ -52,10 +52,17 @@
 #include "yb/util/net/sockaddr.h"
 #include "yb/util/net/socket.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/object_pool.h"
 #include "yb/util/status.h"
 #include "yb/util/user.h"
 
 DEFINE_int32(num_connections_to_server, 4, "Number of underlying connections to each server");
+DEFINE_bool(pick_least_loaded_connection_to_server, true,
+            "Whether each outbound call should be sent over the connection to the server with the "
+            "least number of outstanding calls, instead of picking connections in round robin "
+            "order. Avoids small calls queueing behind slow calls to the same server.");
+TAG_FLAG(pick_least_loaded_connection_to_server, advanced);
 
 using google::protobuf::Message;
 using std::string;
@@ -83,6 +90,10 @@ Proxy::Proxy(const std::shared_ptr<Messenger>& messenger,
                  << s.ToString() << " before connecting to remote: " << remote;
   }
 
+  if (!call_local_service_ && FLAGS_pick_least_loaded_connection_to_server) {
+    connections_load_ = messenger_->ConnectionsLoad(remote);
+  }
+
   conn_id_.set_remote(remote);
   conn_id_.mutable_user_credentials()->set_real_user(real_user);
   is_started_.store(false, std::memory_order_release);
@@ -99,25 +110,29 @@ void Proxy::AsyncRequest(const string& method,
                          ResponseCallback callback) const {
   CHECK(controller->call_.get() == nullptr) << "Controller should be reset";
   is_started_.store(true, std::memory_order_release);
-  uint8_t idx = num_calls_.fetch_add(1) % FLAGS_num_connections_to_server;
+  uint8_t idx = connections_load_ ? connections_load_->Acquire()
+                                  : num_calls_.fetch_add(1) % FLAGS_num_connections_to_server;
   auto indexed_conn_id = conn_id_;
   indexed_conn_id.set_idx(idx);
 
   controller->call_ =
       call_local_service_ ?
-      std::make_shared<LocalOutboundCall>(indexed_conn_id,
+      MakePooledShared<LocalOutboundCall>(indexed_conn_id,
                                           RemoteMethod(service_name_, method),
                                           outbound_call_metrics_,
                                           resp,
                                           controller,
                                           std::move(callback)) :
-      std::make_shared<OutboundCall>(indexed_conn_id,
+      MakePooledShared<OutboundCall>(indexed_conn_id,
                                      RemoteMethod(service_name_, method),
                                      outbound_call_metrics_,
                                      resp,
                                      controller,
                                      std::move(callback));
   auto call = controller->call_.get();
+  if (connections_load_) {
+    call->SetConnectionsLoad(connections_load_);
+  }
   Status s = call->SetRequestParam(req);
   if (PREDICT_FALSE(!s.ok())) {
     // Failed to serialize request: likely the request is missing a required
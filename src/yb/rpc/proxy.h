@@ -137,6 +137,8 @@ class Proxy {
   ConnectionId conn_id_;
   mutable std::atomic<bool> is_started_;
   mutable std::atomic_uint num_calls_;
+  // Load of connections to the remote server, used to send each call over the least loaded one.
+  std::shared_ptr<OutboundConnectionsLoad> connections_load_;
   std::shared_ptr<OutboundCallMetrics> outbound_call_metrics_;
   const bool call_local_service_;
 
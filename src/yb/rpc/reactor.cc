@@ -58,6 +58,7 @@
 #include "yb/rpc/rpc_introspection.pb.h"
 #include "yb/rpc/sasl_client.h"
 #include "yb/rpc/sasl_server.h"
+#include "yb/rpc/thread_pool.h"
 #include "yb/rpc/yb_rpc.h"
 
 #include "yb/util/countdown_latch.h"
@@ -65,6 +66,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/memory/memory.h"
 #include "yb/util/monotime.h"
+#include "yb/util/numa.h"
 #include "yb/util/thread.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/thread_restrictions.h"
@@ -116,6 +118,7 @@ Reactor::Reactor(const shared_ptr<Messenger>& messenger,
                  const MessengerBuilder &bld)
   : messenger_(messenger),
     name_(StringPrintf("%s_R%03d", messenger->name().c_str(), index)),
+    index_(index),
     loop_(kDefaultLibEvFlags),
     cur_time_(MonoTime::Now(MonoTime::COARSE)),
     last_unused_tcp_scan_(cur_time_),
@@ -150,12 +153,8 @@ Status Reactor::Init() {
 }
 
 void Reactor::Shutdown() {
-  {
-    std::lock_guard<simple_spinlock> l(pending_tasks_lock_);
-    if (closing_) {
-      return;
-    }
-    closing_ = true;
+  if (closing_.exchange(true)) {
+    return;
   }
 
   VLOG(1) << name() << ": shutting down Reactor thread.";
@@ -208,11 +207,8 @@ void Reactor::ShutdownInternal() {
   }
 
 
-  {
-    std::lock_guard<simple_spinlock> lock(outbound_queue_lock_);
-    outbound_queue_stopped_ = true;
-    outbound_queue_.swap(processing_outbound_queue_);
-  }
+  outbound_queue_stopped_.store(true);
+  outbound_queue_.Drain(&processing_outbound_queue_);
 
   for (auto& call : processing_outbound_queue_) {
     call->Transferred(aborted);
@@ -416,13 +412,16 @@ bool Reactor::IsCurrentThread() const {
 }
 
 bool Reactor::closing() const {
-  std::lock_guard<simple_spinlock> l(pending_tasks_lock_);
-  return closing_;
+  return closing_.load(std::memory_order_acquire);
 }
 
 void Reactor::RunThread() {
   ThreadRestrictions::SetWaitAllowed(false);
   ThreadRestrictions::SetIOAllowed(false);
+  // Calls received by this reactor are queued to the sibling worker of the service thread pool.
+  ThreadPool::SetCurrentThreadAffinity(index_);
+  // The sibling worker is bound to the same NUMA node, so the calls of a connection stay on it.
+  BindCurrentThreadToNumaNode(index_);
   DVLOG(6) << "Calling Reactor::RunThread()...";
   loop_.run(0);
   VLOG(1) << name() << " thread exiting.";
@@ -493,15 +492,22 @@ Status Reactor::FindOrStartConnection(const ConnectionId &conn_id,
                             ConnectionDirection::CLIENT);
   (*conn)->set_user_credentials(conn_id.user_credentials());
 
-  // Kick off blocking client connection negotiation.
-  Status s = StartConnectionNegotiation(*conn, deadline);
-  if (s.IsIllegalState()) {
-    // Return a nicer error message to the user indicating -- if we just
-    // forward the status we'd get something generic like "ThreadPool is closing".
-    return STATUS(ServiceUnavailable, "Client RPC Messenger shutting down");
+  if ((*conn)->context().PipelineNegotiation(conn->get())) {
+    // The negotiation messages are sent together with the first calls, as soon as the socket
+    // connects, so the connection is used right away.
+    (*conn)->MarkNegotiationComplete();
+    (*conn)->EpollRegister(loop_);
+  } else {
+    // Kick off blocking client connection negotiation.
+    Status s = StartConnectionNegotiation(*conn, deadline);
+    if (s.IsIllegalState()) {
+      // Return a nicer error message to the user indicating -- if we just
+      // forward the status we'd get something generic like "ThreadPool is closing".
+      return STATUS(ServiceUnavailable, "Client RPC Messenger shutting down");
+    }
+    // Propagate any other errors as-is.
+    RETURN_NOT_OK_PREPEND(s, "Unable to start connection negotiation thread");
   }
-  // Propagate any other errors as-is.
-  RETURN_NOT_OK_PREPEND(s, "Unable to start connection negotiation thread");
 
   // Insert into the client connection map to avoid duplicate connection requests.
   client_conns_.emplace(conn_id, *conn);
@@ -643,10 +649,7 @@ void Reactor::DestroyConnection(Connection *conn, const Status &conn_status) {
 }
 
 void Reactor::ProcessOutboundQueue() {
-  {
-    std::lock_guard<simple_spinlock> lock(outbound_queue_lock_);
-    outbound_queue_.swap(processing_outbound_queue_);
-  }
+  outbound_queue_.Drain(&processing_outbound_queue_);
   if (processing_outbound_queue_.empty()) {
     return;
   }
@@ -671,27 +674,37 @@ void Reactor::QueueOutboundCall(OutboundCallPtr call) {
   DVLOG(3) << "Queueing outbound call "
            << call->ToString() << " to remote " << call->conn_id().remote();
 
-  bool was_empty = false;
-  bool closing = false;
-  {
-    std::lock_guard<simple_spinlock> lock(outbound_queue_lock_);
-    if (!outbound_queue_stopped_) {
-      was_empty = outbound_queue_.empty();
-      outbound_queue_.push_back(call);
-    } else {
-      closing = true;
-    }
-  }
-  if (closing) {
+  if (outbound_queue_stopped_.load(std::memory_order_acquire)) {
     call->Transferred(ShutdownError(true));
     return;
   }
+  // Only the call that finds the queue empty schedules processing, so a batch of calls queued
+  // before the reactor thread gets to them costs a single task and wake up.
+  const bool was_empty = outbound_queue_.Push(call);
+  if (outbound_queue_stopped_.load()) {
+    // The reactor could have stopped the queue and taken its final batch of calls after the check
+    // above, so calls queued meanwhile are aborted here.
+    AbortOutboundQueue();
+    return;
+  }
   if (was_empty) {
     ScheduleReactorTask(process_outbound_queue_task_);
   }
   TRACE_TO(call->trace(), "Scheduled.");
 }
 
+void Reactor::AbortOutboundQueue() {
+  std::vector<OutboundCallPtr> calls;
+  outbound_queue_.Drain(&calls);
+  if (calls.empty()) {
+    return;
+  }
+  auto aborted = ShutdownError(true);
+  for (auto& call : calls) {
+    call->Transferred(aborted);
+  }
+}
+
 DelayedTask::DelayedTask(std::function<void(const Status&)> func, MonoDelta when, int64_t id,
                          std::shared_ptr<Messenger> messenger)
     : func_(std::move(func)),
@@ -783,24 +796,40 @@ void Reactor::RegisterInboundSocket(Socket *socket, const Endpoint& remote) {
 }
 
 void Reactor::ScheduleReactorTask(std::shared_ptr<ReactorTask> task) {
-  {
-    std::unique_lock<simple_spinlock> l(pending_tasks_lock_);
-    if (closing_) {
-      // We guarantee the reactor lock is not taken when calling Abort().
-      l.unlock();
-      task->Abort(ShutdownError(false));
-      return;
-    }
-    pending_tasks_.push_back(std::move(task));
+  if (closing_.load(std::memory_order_acquire)) {
+    task->Abort(ShutdownError(false));
+    return;
+  }
+  // The reactor thread drains all queued tasks on wake up, so only the producer that finds the
+  // queue empty has to wake it.
+  const bool was_empty = pending_tasks_.Push(std::move(task));
+  if (closing_.load()) {
+    // The reactor could have started closing and taken its final batch of tasks after the check
+    // above, so tasks queued meanwhile are aborted here.
+    AbortPendingTasks();
+    return;
+  }
+  if (was_empty) {
+    WakeThread();
+  }
+}
+
+void Reactor::AbortPendingTasks() {
+  std::vector<std::shared_ptr<ReactorTask>> tasks;
+  pending_tasks_.Drain(&tasks);
+  if (tasks.empty()) {
+    return;
+  }
+  auto aborted = ShutdownError(false);
+  for (const auto& task : tasks) {
+    task->Abort(aborted);
   }
-  WakeThread();
 }
 
 bool Reactor::DrainTaskQueue(std::vector<std::shared_ptr<ReactorTask>>* tasks) {
   CHECK(tasks->empty());
-  std::lock_guard<simple_spinlock> l(pending_tasks_lock_);
-  tasks->swap(pending_tasks_);
-  return !closing_;
+  pending_tasks_.Drain(tasks);
+  return !closing_.load(std::memory_order_acquire);
 }
 
 // Task to call an arbitrary function within the reactor thread.
@@ -51,6 +51,7 @@
 #include "yb/util/thread.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
+#include "yb/util/mpsc_queue.h"
 #include "yb/util/net/socket.h"
 #include "yb/util/status.h"
 
@@ -352,6 +353,12 @@ class Reactor {
   // Otherwise, drains the pending_tasks_ queue into the provided list.
   bool DrainTaskQueue(std::vector<std::shared_ptr<ReactorTask>> *tasks);
 
+  // Aborts tasks that were queued after the reactor started closing.
+  void AbortPendingTasks();
+
+  // Aborts outbound calls that were queued after the outbound queue was stopped.
+  void AbortOutboundQueue();
+
   template<class F>
   CHECKED_STATUS RunOnReactorThread(const F& f);
 
@@ -362,15 +369,13 @@ class Reactor {
 
   const std::string name_;
 
-  mutable simple_spinlock pending_tasks_lock_;
+  const int index_;
 
   // Whether the reactor is shutting down.
-  // Guarded by pending_tasks_lock_.
-  bool closing_ = false;
+  std::atomic<bool> closing_{false};
 
   // Tasks to be run within the reactor thread.
-  // Guarded by lock_.
-  std::vector<std::shared_ptr<ReactorTask>> pending_tasks_;
+  MPSCQueue<std::shared_ptr<ReactorTask>> pending_tasks_;
 
   scoped_refptr<yb::Thread> thread_;
 
@@ -412,11 +417,10 @@ class Reactor {
   // Scan for idle connections on this granularity.
   const MonoDelta coarse_timer_granularity_;
 
-  simple_spinlock outbound_queue_lock_;
-  bool outbound_queue_stopped_ = false;
+  std::atomic<bool> outbound_queue_stopped_{false};
   // We found that should shutdown, but not all connections are ready for it.
   bool stopping_ = false;
-  std::vector<OutboundCallPtr> outbound_queue_;
+  MPSCQueue<OutboundCallPtr> outbound_queue_;
   std::vector<OutboundCallPtr> processing_outbound_queue_;
   std::vector<ConnectionPtr> processing_connections_;
   std::shared_ptr<ReactorTask> process_outbound_queue_task_;
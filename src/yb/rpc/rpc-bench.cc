@@ -30,14 +30,22 @@
 // under the License.
 //
 
+#include <atomic>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include "yb/gutil/strings/numbers.h"
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/strings/substitute.h"
 #include "yb/rpc/rpc-test-base.h"
 #include "yb/rpc/rtest.proxy.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/hdr_histogram.h"
+#include "yb/util/stopwatch.h"
 #include "yb/util/test_util.h"
 
 using namespace std::literals;
@@ -45,9 +53,67 @@ using namespace std::literals;
 using std::string;
 using std::shared_ptr;
 
+DEFINE_int32(rpc_bench_duration_secs, 10, "Duration of each benchmark run, in seconds.");
+DEFINE_int32(rpc_bench_client_threads, 0,
+             "Number of client threads sending calls, 0 means a default suitable for the build "
+             "type.");
+DEFINE_string(rpc_bench_payload_sizes, "0,1024,65536",
+              "Comma separated payload sizes swept by BenchmarkPayloadSizes. 0 stands for the Add "
+              "call without payload.");
+DEFINE_string(rpc_bench_connections, "1,4,8",
+              "Comma separated numbers of connections to the server swept by "
+              "BenchmarkConnections.");
+DEFINE_string(rpc_bench_reactors, "1,2,4,8",
+              "Comma separated numbers of server reactors swept by BenchmarkReactors.");
+DEFINE_string(rpc_bench_workers, "1,4,16",
+              "Comma separated numbers of server worker threads swept by BenchmarkWorkers.");
+
+DECLARE_int32(num_connections_to_server);
+
 namespace yb {
 namespace rpc {
 
+namespace {
+
+struct BenchmarkOptions {
+  // Size of the Echo payload, 0 means Add call.
+  size_t payload_size = 0;
+  int connections = 0;
+  size_t client_reactors = 2;
+  size_t server_reactors = kDefaultServerMessengerOptions.n_reactors;
+  size_t server_workers = 1;
+  int client_threads = 0;
+  bool tls = false;
+
+  std::string ToString() const {
+    return strings::Substitute(
+        "{ payload_size: $0 connections: $1 client_reactors: $2 server_reactors: $3 "
+        "server_workers: $4 client_threads: $5 tls: $6 }",
+        payload_size, connections, client_reactors, server_reactors, server_workers,
+        client_threads, tls);
+  }
+};
+
+int DefaultClientThreads() {
+  if (FLAGS_rpc_bench_client_threads > 0) {
+    return FLAGS_rpc_bench_client_threads;
+  }
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  return 4;
+#else
+  return 16;
+#endif
+}
+
+std::vector<int64> ParseList(const std::string& value) {
+  std::vector<int64> result;
+  bool (*parse)(const string&, int64*) = &safe_strto64;
+  CHECK(SplitStringAndParse(value, ",", parse, &result)) << "Bad list: " << value;
+  return result;
+}
+
+} // namespace
+
 class RpcBench : public RpcTestBase {
  public:
   RpcBench()
@@ -56,9 +122,16 @@ class RpcBench : public RpcTestBase {
  protected:
   friend class ClientThread;
 
+  // Runs clients against the calculator service for --rpc_bench_duration_secs and logs
+  // throughput, latency percentiles and CPU usage per call.
+  void RunBenchmark(BenchmarkOptions options);
+
   Endpoint server_endpoint_;
   shared_ptr<Messenger> client_messenger_;
   std::atomic<bool> should_run_{true};
+  BenchmarkOptions options_;
+  // Latency of calls in microseconds.
+  std::unique_ptr<HdrHistogram> latency_;
 };
 
 class ClientThread {
@@ -77,19 +150,28 @@ class ClientThread {
   }
 
   void Run() {
-    shared_ptr<Messenger> client_messenger = bench_->CreateMessenger("Client");
-
-    rpc_test::CalculatorServiceProxy p(client_messenger, bench_->server_endpoint_);
+    rpc_test::CalculatorServiceProxy p(bench_->client_messenger_, bench_->server_endpoint_);
 
-    rpc_test::AddRequestPB req;
-    rpc_test::AddResponsePB resp;
+    rpc_test::AddRequestPB add_req;
+    rpc_test::AddResponsePB add_resp;
+    rpc_test::EchoRequestPB echo_req;
+    rpc_test::EchoResponsePB echo_resp;
+    const size_t payload_size = bench_->options_.payload_size;
+    echo_req.set_data(std::string(payload_size, 'x'));
     while (bench_->should_run_.load(std::memory_order_acquire)) {
-      req.set_x(request_count_);
-      req.set_y(request_count_);
       RpcController controller;
       controller.set_timeout(MonoDelta::FromSeconds(10));
-      CHECK_OK(p.Add(req, &resp, &controller));
-      CHECK_EQ(req.x() + req.y(), resp.result());
+      auto start = MonoTime::FineNow();
+      if (payload_size == 0) {
+        add_req.set_x(request_count_);
+        add_req.set_y(request_count_);
+        CHECK_OK(p.Add(add_req, &add_resp, &controller));
+        CHECK_EQ(add_req.x() + add_req.y(), add_resp.result());
+      } else {
+        CHECK_OK(p.Echo(echo_req, &echo_resp, &controller));
+        CHECK_EQ(payload_size, echo_resp.data().size());
+      }
+      bench_->latency_->Increment(MonoTime::FineNow().GetDeltaSince(start).ToMicroseconds());
       request_count_++;
     }
   }
@@ -99,37 +181,48 @@ class ClientThread {
   int request_count_;
 };
 
-
-// Test making successful RPC calls.
-TEST_F(RpcBench, BenchmarkCalls) {
-  TestServerOptions options;
-  options.n_worker_threads = 1;
+void RpcBench::RunBenchmark(BenchmarkOptions options) {
+  if (options.connections == 0) {
+    options.connections = FLAGS_num_connections_to_server;
+  }
+  if (options.client_threads == 0) {
+    options.client_threads = DefaultClientThreads();
+  }
+  LOG(INFO) << "Running benchmark: " << options.ToString();
+  options_ = options;
+  FLAGS_num_connections_to_server = options.connections;
+  latency_.reset(new HdrHistogram(60000000LU, 2));
+  should_run_.store(true, std::memory_order_release);
 
   // Set up server.
-  StartTestServerWithGeneratedCode(&server_endpoint_);
+  TestServerOptions server_options;
+  server_options.n_worker_threads = options.server_workers;
+  server_options.messenger_options.n_reactors = options.server_reactors;
+  std::shared_ptr<TlsContext> tls_context;
+  if (options.tls) {
+    tls_context = CreateTestTlsContext(test_dir_);
+    server_options.messenger_options.tls_context = tls_context;
+  }
+  StartTestServerWithGeneratedCode(&server_endpoint_, server_options);
 
   // Set up client.
   LOG(INFO) << "Connecting to " << server_endpoint_;
   MessengerOptions client_options = kDefaultClientMessengerOptions;
-  client_options.n_reactors = 2;
+  client_options.n_reactors = options.client_reactors;
+  client_options.tls_context = tls_context;
   client_messenger_ = CreateMessenger("Client", client_options);
 
   Stopwatch sw(Stopwatch::ALL_THREADS);
   sw.start();
 
   std::vector<std::unique_ptr<ClientThread>> threads;
-#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
-  constexpr int kNumThreads = 4;
-#else
-  constexpr int kNumThreads = 16;
-#endif
-  for (int i = 0; i < kNumThreads; i++) {
+  for (int i = 0; i < options.client_threads; i++) {
     auto thr = std::make_unique<ClientThread>(this);
     thr->Start();
     threads.push_back(std::move(thr));
   }
 
-  std::this_thread::sleep_for(10s);
+  std::this_thread::sleep_for(std::chrono::seconds(FLAGS_rpc_bench_duration_secs));
   should_run_.store(false, std::memory_order_release);
 
   int total_reqs = 0;
@@ -139,16 +232,72 @@ TEST_F(RpcBench, BenchmarkCalls) {
     total_reqs += thr->request_count_;
   }
   sw.stop();
+  client_messenger_->Shutdown();
+  client_messenger_.reset();
 
   float reqs_per_second = static_cast<float>(total_reqs / sw.elapsed().wall_seconds());
   float user_cpu_micros_per_req = static_cast<float>(sw.elapsed().user / 1000.0 / total_reqs);
   float sys_cpu_micros_per_req = static_cast<float>(sw.elapsed().system / 1000.0 / total_reqs);
 
   LOG(INFO) << "Reqs/sec:         " << reqs_per_second;
+  LOG(INFO) << "Latency p50:      " << latency_->ValueAtPercentile(50) << "us";
+  LOG(INFO) << "Latency p95:      " << latency_->ValueAtPercentile(95) << "us";
+  LOG(INFO) << "Latency p99:      " << latency_->ValueAtPercentile(99) << "us";
+  LOG(INFO) << "Latency p99.9:    " << latency_->ValueAtPercentile(99.9) << "us";
+  LOG(INFO) << "Latency max:      " << latency_->MaxValue() << "us";
   LOG(INFO) << "User CPU per req: " << user_cpu_micros_per_req << "us";
   LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
 }
 
+// Test making successful RPC calls.
+TEST_F(RpcBench, BenchmarkCalls) {
+  RunBenchmark(BenchmarkOptions());
+}
+
+TEST_F(RpcBench, BenchmarkPayloadSizes) {
+  for (auto payload_size : ParseList(FLAGS_rpc_bench_payload_sizes)) {
+    BenchmarkOptions options;
+    options.payload_size = payload_size;
+    RunBenchmark(options);
+  }
+}
+
+// Compares the throughput and CPU cost of TLS connections with plaintext ones.
+TEST_F(RpcBench, BenchmarkTls) {
+  for (auto payload_size : ParseList(FLAGS_rpc_bench_payload_sizes)) {
+    for (bool tls : {false, true}) {
+      BenchmarkOptions options;
+      options.payload_size = payload_size;
+      options.tls = tls;
+      RunBenchmark(options);
+    }
+  }
+}
+
+TEST_F(RpcBench, BenchmarkConnections) {
+  for (auto connections : ParseList(FLAGS_rpc_bench_connections)) {
+    BenchmarkOptions options;
+    options.connections = static_cast<int>(connections);
+    RunBenchmark(options);
+  }
+}
+
+TEST_F(RpcBench, BenchmarkReactors) {
+  for (auto reactors : ParseList(FLAGS_rpc_bench_reactors)) {
+    BenchmarkOptions options;
+    options.server_reactors = reactors;
+    options.client_reactors = reactors;
+    RunBenchmark(options);
+  }
+}
+
+TEST_F(RpcBench, BenchmarkWorkers) {
+  for (auto workers : ParseList(FLAGS_rpc_bench_workers)) {
+    BenchmarkOptions options;
+    options.server_workers = workers;
+    RunBenchmark(options);
+  }
+}
+
 } // namespace rpc
 } // namespace yb
-
@@ -17,6 +17,11 @@
 
 #include <thread>
 
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include "yb/util/net/tls.h"
+#include "yb/util/path_util.h"
 #include "yb/util/random_util.h"
 
 using namespace std::chrono_literals;
@@ -59,6 +64,48 @@ Slice GetSidecarPointer(const RpcController& controller, int idx, int expected_s
   return Slice(sidecar.data(), expected_size);
 }
 
+std::shared_ptr<TlsContext> CreateTestTlsContext(const std::string& dir) {
+  EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+  CHECK_NOTNULL(key_ctx);
+  CHECK_EQ(1, EVP_PKEY_keygen_init(key_ctx));
+  CHECK_EQ(1, EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx, NID_X9_62_prime256v1));
+  EVP_PKEY* key = nullptr;
+  CHECK_EQ(1, EVP_PKEY_keygen(key_ctx, &key));
+  EVP_PKEY_CTX_free(key_ctx);
+
+  X509* cert = X509_new();
+  CHECK_NOTNULL(cert);
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 60 * 60);
+  X509_set_pubkey(cert, key);
+  X509_NAME* name = X509_get_subject_name(cert);
+  X509_NAME_add_entry_by_txt(
+      name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("yb-test"), -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+  CHECK_NE(0, X509_sign(cert, key, EVP_sha256()));
+
+  TlsOptions options = TlsOptions::FromFlags();
+  options.certificate_file = JoinPathSegments(dir, "test.crt");
+  options.private_key_file = JoinPathSegments(dir, "test.key");
+  options.ca_file = options.certificate_file;
+  FILE* file = fopen(options.certificate_file.c_str(), "w");
+  CHECK_NOTNULL(file);
+  CHECK_EQ(1, PEM_write_X509(file, cert));
+  fclose(file);
+  file = fopen(options.private_key_file.c_str(), "w");
+  CHECK_NOTNULL(file);
+  CHECK_EQ(1, PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr));
+  fclose(file);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+
+  std::shared_ptr<TlsContext> result;
+  CHECK_OK(TlsContext::Create(options, &result));
+  return result;
+}
+
 std::shared_ptr<Messenger> CreateMessenger(const std::string& name,
                                            const scoped_refptr<MetricEntity>& metric_entity,
                                            const MessengerOptions& options) {
@@ -75,6 +122,9 @@ std::shared_ptr<Messenger> CreateMessenger(const std::string& name,
   bld.set_connection_keepalive_time(options.keep_alive_timeout);
   bld.set_coarse_timer_granularity(coarse_time_granularity);
   bld.set_metric_entity(metric_entity);
+  if (options.tls_context) {
+    bld.set_tls_context(options.tls_context);
+  }
   std::shared_ptr<Messenger> messenger;
   CHECK_OK(bld.Build(&messenger));
   return messenger;
@@ -95,8 +95,13 @@ class GenericCalculatorService : public ServiceIf {
 struct MessengerOptions {
   size_t n_reactors;
   std::chrono::milliseconds keep_alive_timeout;
+  std::shared_ptr<TlsContext> tls_context = nullptr;
 };
 
+// Creates a TLS context with a new self-signed certificate, which is also the trusted authority,
+// writing the certificate and the key to dir.
+std::shared_ptr<TlsContext> CreateTestTlsContext(const std::string& dir);
+
 extern const MessengerOptions kDefaultClientMessengerOptions;
 extern const MessengerOptions kDefaultServerMessengerOptions;
 
@@ -52,6 +52,9 @@
 METRIC_DECLARE_histogram(handler_latency_yb_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(rpc_incoming_queue_time);
 
+DECLARE_bool(rpc_fast_negotiation);
+DECLARE_bool(rpc_accept_fast_negotiation);
+
 DEFINE_int32(rpc_test_connection_keepalive_num_iterations, 1,
   "Number of iterations in TestRpc.TestConnectionKeepalive");
 
@@ -110,6 +113,31 @@ TEST_F(TestRpc, Endpoint) {
   ASSERT_NOK(ParseEndpoint("fe80::1:12345", kDefaultPort));
 }
 
+TEST_F(TestRpc, OutboundConnectionsLoad) {
+  OutboundConnectionsLoad load(3);
+
+  // Idle connections are picked in round robin order.
+  ASSERT_EQ(0, load.Acquire());
+  ASSERT_EQ(1, load.Acquire());
+  ASSERT_EQ(2, load.Acquire());
+
+  // Connection 1 has a long running call, so new calls go to other connections.
+  load.Release(0);
+  load.Release(2);
+  for (int i = 0; i != 10; ++i) {
+    auto idx = load.Acquire();
+    ASSERT_NE(1, idx);
+    load.Release(idx);
+  }
+  ASSERT_EQ(1U, load.outstanding_calls(1));
+
+  // Calls are spread over connections with the least outstanding calls.
+  ASSERT_NE(1, load.Acquire());
+  ASSERT_NE(1, load.Acquire());
+  ASSERT_EQ(1U, load.outstanding_calls(0));
+  ASSERT_EQ(1U, load.outstanding_calls(2));
+}
+
 TEST_F(TestRpc, TestMessengerCreateDestroy) {
   shared_ptr<Messenger> messenger(CreateMessenger("TestCreateDestroy"));
   LOG(INFO) << "started messenger " << messenger->name();
@@ -156,6 +184,80 @@ TEST_F(TestRpc, TestCall) {
   }
 }
 
+TEST_F(TestRpc, TestTlsCall) {
+  // Server and clients use the same self-signed certificate, which is also their trusted authority.
+  auto tls_context = CreateTestTlsContext(test_dir_);
+  TestServerOptions server_options;
+  server_options.messenger_options.tls_context = tls_context;
+  Endpoint server_addr;
+  StartTestServer(&server_addr, server_options);
+
+  MessengerOptions client_options = kDefaultClientMessengerOptions;
+  client_options.tls_context = tls_context;
+  shared_ptr<Messenger> client_messenger(CreateMessenger("Client", client_options));
+  Proxy p(client_messenger, server_addr, GenericCalculatorService::static_service_name());
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(DoTestSyncCall(p, GenericCalculatorService::kAddMethodName));
+  }
+  // Large sidecars take several partial writes of encrypted records.
+  DoTestSidecar(p, {123, 456});
+  DoTestSidecar(p, {3000 * 1024, 2000 * 1024});
+
+  // A new connection to the same server resumes the cached session instead of a full handshake.
+  shared_ptr<Messenger> second_messenger(CreateMessenger("Client2", client_options));
+  Proxy second_proxy(
+      second_messenger, server_addr, GenericCalculatorService::static_service_name());
+  ASSERT_OK(DoTestSyncCall(second_proxy, GenericCalculatorService::kAddMethodName));
+  ASSERT_GE(tls_context->num_resumed_handshakes(), 1);
+
+  // Plaintext clients cannot talk to a TLS server.
+  shared_ptr<Messenger> plain_messenger(CreateMessenger("PlainClient"));
+  Proxy plain_proxy(plain_messenger, server_addr, GenericCalculatorService::static_service_name());
+  ASSERT_NOK(DoTestSyncCall(plain_proxy, GenericCalculatorService::kAddMethodName));
+}
+
+TEST_F(TestRpc, TestFastNegotiation) {
+  FLAGS_rpc_fast_negotiation = true;
+  Endpoint server_addr;
+  StartTestServer(&server_addr);
+
+  // The connection context and the first call are sent without waiting for the server.
+  shared_ptr<Messenger> client_messenger(CreateMessenger("Client"));
+  Proxy p(client_messenger, server_addr, GenericCalculatorService::static_service_name());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(DoTestSyncCall(p, GenericCalculatorService::kAddMethodName));
+  }
+  DoTestSidecar(p, {3000 * 1024, 2000 * 1024});
+
+  // Servers could refuse connections that skip SASL.
+  FLAGS_rpc_accept_fast_negotiation = false;
+  shared_ptr<Messenger> rejected_messenger(CreateMessenger("RejectedClient"));
+  Proxy rejected_proxy(
+      rejected_messenger, server_addr, GenericCalculatorService::static_service_name());
+  ASSERT_NOK(DoTestSyncCall(rejected_proxy, GenericCalculatorService::kAddMethodName));
+
+  // SASL negotiation still works for clients that do not use fast negotiation.
+  FLAGS_rpc_fast_negotiation = false;
+  shared_ptr<Messenger> sasl_messenger(CreateMessenger("SaslClient"));
+  Proxy sasl_proxy(sasl_messenger, server_addr, GenericCalculatorService::static_service_name());
+  ASSERT_OK(DoTestSyncCall(sasl_proxy, GenericCalculatorService::kAddMethodName));
+
+  // With TLS, the connection context is sent right after the handshake.
+  FLAGS_rpc_fast_negotiation = true;
+  FLAGS_rpc_accept_fast_negotiation = true;
+  auto tls_context = CreateTestTlsContext(test_dir_);
+  TestServerOptions tls_server_options;
+  tls_server_options.messenger_options.tls_context = tls_context;
+  StartTestServer(&server_addr, tls_server_options);
+  MessengerOptions tls_client_options = kDefaultClientMessengerOptions;
+  tls_client_options.tls_context = tls_context;
+  shared_ptr<Messenger> tls_client_messenger(CreateMessenger("TlsClient", tls_client_options));
+  Proxy tls_proxy(
+      tls_client_messenger, server_addr, GenericCalculatorService::static_service_name());
+  ASSERT_OK(DoTestSyncCall(tls_proxy, GenericCalculatorService::kAddMethodName));
+}
+
 // Test that connecting to an invalid server properly throws an error.
 TEST_F(TestRpc, TestCallToBadServer) {
   shared_ptr<Messenger> client_messenger(CreateMessenger("Client"));
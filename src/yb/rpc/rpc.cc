@@ -66,7 +66,15 @@ bool RpcRetrier::HandleResponse(RpcCommand* rpc, Status* out_status) {
     if (err &&
         err->has_code() &&
         err->code() == ErrorStatusPB::ERROR_SERVER_TOO_BUSY) {
-      DelayedRetry(rpc, controller_status);
+      if (err->has_retry_after_ms()) {
+        // Honor the delay suggested by the overloaded server, with some jitter to avoid retrying
+        // all rejected calls at once.
+        auto delay_ms = err->retry_after_ms();
+        DelayedRetry(rpc, controller_status,
+                     MonoDelta::FromMilliseconds(delay_ms + RandomUniformInt(0U, delay_ms / 4)));
+      } else {
+        DelayedRetry(rpc, controller_status);
+      }
       return true;
     }
   }
@@ -76,18 +84,23 @@ bool RpcRetrier::HandleResponse(RpcCommand* rpc, Status* out_status) {
 }
 
 void RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status) {
-  if (!why_status.ok() && (last_error_.ok() || last_error_.IsTimedOut())) {
-    last_error_ = why_status;
-  }
   // Add some jitter to the retry delay.
   //
   // If the delay causes us to miss our deadline, RetryCb will fail the
   // RPC on our behalf.
-  int num_ms = ++attempt_num_ + RandomUniformInt(0, 4);
+  int num_ms = attempt_num_ + 1 + RandomUniformInt(0, 4);
+  DelayedRetry(rpc, why_status, MonoDelta::FromMilliseconds(num_ms));
+}
+
+void RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoDelta delay) {
+  if (!why_status.ok() && (last_error_.ok() || last_error_.IsTimedOut())) {
+    last_error_ = why_status;
+  }
+  ++attempt_num_;
 
   state_ = RpcRetrierState::kWaiting;
   task_id_ = messenger_->ScheduleOnReactor(
-      std::bind(&RpcRetrier::DelayedRetryCb, this, rpc, _1), MonoDelta::FromMilliseconds(num_ms));
+      std::bind(&RpcRetrier::DelayedRetryCb, this, rpc, _1), delay);
 }
 
 void RpcRetrier::DelayedRetryCb(RpcCommand* rpc, const Status& status) {
@@ -114,6 +114,10 @@ class RpcRetrier {
   // Callers should ensure that 'rpc' remains alive.
   void DelayedRetry(RpcCommand* rpc, const Status& why_status);
 
+  // Same as above, but retries after the specified delay. Used when the server suggested
+  // when the call should be retried.
+  void DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoDelta delay);
+
   RpcController* mutable_controller() { return &controller_; }
   const RpcController& controller() const { return controller_; }
 
@@ -163,7 +163,7 @@ void RpcContext::RespondApplicationError(int error_ext_id, const std::string& me
 }
 
 Status RpcContext::AddRpcSidecar(RefCntBuffer car, int* idx) {
-  return call_->AddRpcSidecar(car, idx);
+  return call_->AddRpcSidecar(std::move(car), idx);
 }
 
 const UserCredentials& RpcContext::user_credentials() const {
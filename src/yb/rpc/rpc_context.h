@@ -38,6 +38,7 @@
 #include "yb/rpc/local_call.h"
 #include "yb/rpc/rpc_header.pb.h"
 #include "yb/rpc/service_if.h"
+#include "yb/util/memory/arena.h"
 #include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
@@ -84,6 +85,7 @@ class RpcContext {
         request_pb_(std::move(rhs.request_pb_)),
         response_pb_(std::move(rhs.response_pb_)),
         metrics_(std::move(rhs.metrics_)),
+        arena_(std::move(rhs.arena_)),
         responded_(rhs.responded_) {
   }
 
@@ -202,6 +204,16 @@ class RpcContext {
   void Panic(const char* filepath, int line_number, const std::string& message)
     __attribute__((noreturn));
 
+  // Returns the arena for memory that lives as long as the call. It is taken from the pool of the
+  // handling thread on first use and released at once, when this context is destroyed after the
+  // response was sent.
+  Arena* arena() {
+    if (!arena_) {
+      arena_ = AcquirePooledArena();
+    }
+    return arena_.get();
+  }
+
   // Returns true if the call has been responded.
   bool responded() const { return responded_; }
 
@@ -212,6 +224,7 @@ class RpcContext {
   std::shared_ptr<const google::protobuf::Message> request_pb_;
   std::shared_ptr<google::protobuf::Message> response_pb_;
   RpcMethodMetrics metrics_;
+  PooledArena arena_;
   bool responded_ = false;
 };
 
@@ -67,6 +67,7 @@ void RpcController::Swap(RpcController* other) {
   }
 
   std::swap(timeout_, other->timeout_);
+  std::swap(request_extra_data_, other->request_extra_data_);
   std::swap(call_, other->call_);
 }
 
@@ -76,6 +77,7 @@ void RpcController::Reset() {
     CHECK(finished());
   }
   call_.reset();
+  request_extra_data_.clear();
 }
 
 bool RpcController::finished() const {
@@ -113,6 +115,11 @@ void RpcController::set_deadline(const MonoTime& deadline) {
   set_timeout(deadline.GetDeltaSince(MonoTime::Now(MonoTime::FINE)));
 }
 
+void RpcController::set_request_extra_data(std::vector<RefCntBuffer> extra_data) {
+  DCHECK(!call_ || call_->state() == OutboundCall::READY);
+  request_extra_data_ = std::move(extra_data);
+}
+
 MonoDelta RpcController::timeout() const {
   std::lock_guard<simple_spinlock> l(lock_);
   return timeout_;
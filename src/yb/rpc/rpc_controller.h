@@ -33,6 +33,7 @@
 #define YB_RPC_RPC_CONTROLLER_H
 
 #include <memory>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -40,6 +41,7 @@
 #include "yb/rpc/rpc_fwd.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -133,12 +135,26 @@ class RpcController {
   // May fail if index is invalid.
   CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const;
 
+  // Set serialized protobuf fields, that are sent right after the serialized request message,
+  // so the receiver parses them as part of the request. Each buffer should contain complete
+  // fields (tag, length and value) of the request message.
+  //
+  // The buffers are sent as is, so the same serialized data could be shared by multiple calls
+  // without copying it, e.g. the replicate messages sent to each follower of a tablet.
+  //
+  // Should be set before the call is sent. Reset() clears it.
+  void set_request_extra_data(std::vector<RefCntBuffer> extra_data);
+
+  const std::vector<RefCntBuffer>& request_extra_data() const { return request_extra_data_; }
+
  private:
   friend class OutboundCall;
   friend class Proxy;
 
   MonoDelta timeout_;
 
+  std::vector<RefCntBuffer> request_extra_data_;
+
   mutable simple_spinlock lock_;
 
   // Once the call is sent, it is tracked here.
@@ -94,9 +94,14 @@ static Status StatusFromRpcError(const ErrorStatusPB& error) {
   }
 }
 
-SaslClient::SaslClient(string app_name, int fd)
+SaslClient::SaslClient(string app_name, int fd) : SaslClient(std::move(app_name), nullptr) {
+  fd_socket_.Reset(fd);
+  sock_ = &fd_socket_;
+}
+
+SaslClient::SaslClient(string app_name, Socket* socket)
     : app_name_(std::move(app_name)),
-      sock_(fd),
+      sock_(socket),
       helper_(SaslHelper::CLIENT),
       client_state_(SaslNegotiationState::NEW),
       negotiated_mech_(SaslMechanism::INVALID),
@@ -111,7 +116,8 @@ SaslClient::SaslClient(string app_name, int fd)
 }
 
 SaslClient::~SaslClient() {
-  sock_.Release();  // Do not close the underlying socket when this object is destroyed.
+  // Do not close the underlying socket when this object is destroyed.
+  fd_socket_.Release();
 }
 
 Status SaslClient::EnableAnonymous() {
@@ -195,7 +201,7 @@ Status SaslClient::Negotiate() {
   }
 
   // Ensure we can use blocking calls on the socket during negotiation.
-  RETURN_NOT_OK(EnsureBlockingMode(&sock_));
+  RETURN_NOT_OK(EnsureBlockingMode(sock_));
 
   // Start by asking the server for a list of available auth mechanisms.
   RETURN_NOT_OK(SendNegotiateMessage());
@@ -209,7 +215,7 @@ Status SaslClient::Negotiate() {
   while (!nego_ok_ || nego_response_expected_) {
     ResponseHeader header;
     Slice param_buf;
-    RETURN_NOT_OK(ReceiveFramedMessageBlocking(&sock_, &recv_buf, &header, &param_buf, deadline_));
+    RETURN_NOT_OK(ReceiveFramedMessageBlocking(sock_, &recv_buf, &header, &param_buf, deadline_));
     nego_response_expected_ = false;
 
     SaslMessagePB response;
@@ -253,7 +259,7 @@ Status SaslClient::SendSaslMessage(const SaslMessagePB& msg) {
   // Create header with SASL-specific callId
   RequestHeader header;
   header.set_call_id(kSaslCallId);
-  return helper_.SendSaslMessage(&sock_, header, msg, deadline_);
+  return helper_.SendSaslMessage(sock_, header, msg, deadline_);
 }
 
 Status SaslClient::ParseSaslMsgResponse(const ResponseHeader& header, const Slice& param_buf,
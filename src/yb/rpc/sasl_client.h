@@ -61,6 +61,10 @@ class SaslClient {
  public:
   // Does not take ownership of the socket indicated by the fd.
   SaslClient(string app_name, int fd);
+
+  // Negotiates over the socket of a connection, so negotiation is encrypted when the socket uses
+  // TLS. Does not take ownership of the socket.
+  SaslClient(string app_name, Socket* socket);
   ~SaslClient();
 
   // Enable ANONYMOUS authentication.
@@ -152,7 +156,9 @@ class SaslClient {
   CHECKED_STATUS ParseError(const Slice& err_data);
 
   string app_name_;
-  Socket sock_;
+  // Wraps the fd the object was constructed with.
+  Socket fd_socket_;
+  Socket* sock_;
   std::vector<sasl_callback_t> callbacks_;
   gscoped_ptr<sasl_conn_t, SaslDeleter> sasl_conn_;
   SaslHelper helper_;
@@ -68,9 +68,14 @@ static int SaslServerPlainAuthCb(sasl_conn_t *conn, void *sasl_server, const cha
     ->PlainAuthCb(conn, user, pass, passlen, propctx);
 }
 
-SaslServer::SaslServer(string app_name, int fd)
+SaslServer::SaslServer(string app_name, int fd) : SaslServer(std::move(app_name), nullptr) {
+  fd_socket_.Reset(fd);
+  sock_ = &fd_socket_;
+}
+
+SaslServer::SaslServer(string app_name, Socket* socket)
     : app_name_(std::move(app_name)),
-      sock_(fd),
+      sock_(socket),
       helper_(SaslHelper::SERVER),
       server_state_(SaslNegotiationState::NEW),
       negotiated_mech_(SaslMechanism::INVALID),
@@ -83,7 +88,8 @@ SaslServer::SaslServer(string app_name, int fd)
 }
 
 SaslServer::~SaslServer() {
-  sock_.Release();  // Do not close the underlying socket when this object is destroyed.
+  // Do not close the underlying socket when this object is destroyed.
+  fd_socket_.Release();
 }
 
 Status SaslServer::EnableAnonymous() {
@@ -173,19 +179,21 @@ Status SaslServer::Negotiate() {
   }
 
   // Ensure we can use blocking calls on the socket during negotiation.
-  RETURN_NOT_OK(EnsureBlockingMode(&sock_));
+  RETURN_NOT_OK(EnsureBlockingMode(sock_));
 
   faststring recv_buf;
 
   // Read connection header
-  RETURN_NOT_OK(ValidateConnectionHeader(&recv_buf));
+  if (!connection_header_received_) {
+    RETURN_NOT_OK(ValidateConnectionHeader(&recv_buf));
+  }
 
   nego_ok_ = false;
   while (!nego_ok_) {
     TRACE("Waiting for next SASL message...");
     RequestHeader header;
     Slice param_buf;
-    RETURN_NOT_OK(ReceiveFramedMessageBlocking(&sock_, &recv_buf, &header, &param_buf, deadline_));
+    RETURN_NOT_OK(ReceiveFramedMessageBlocking(sock_, &recv_buf, &header, &param_buf, deadline_));
 
     SaslMessagePB request;
     RETURN_NOT_OK(ParseSaslMsgRequest(header, param_buf, &request));
@@ -227,7 +235,7 @@ Status SaslServer::ValidateConnectionHeader(faststring* recv_buf) {
   size_t num_read;
   const size_t conn_header_len = kMagicNumberLength + kHeaderFlagsLength;
   recv_buf->resize(conn_header_len);
-  RETURN_NOT_OK(sock_.BlockingRecv(recv_buf->data(), conn_header_len, &num_read, deadline_));
+  RETURN_NOT_OK(sock_->BlockingRecv(recv_buf->data(), conn_header_len, &num_read, deadline_));
   DCHECK_EQ(conn_header_len, num_read);
 
   RETURN_NOT_OK(serialization::ValidateConnHeader(*recv_buf));
@@ -260,7 +268,7 @@ Status SaslServer::SendSaslMessage(const SaslMessagePB& msg) {
   // Create header with SASL-specific callId
   ResponseHeader header;
   header.set_call_id(kSaslCallId);
-  return helper_.SendSaslMessage(&sock_, header, msg, deadline_);
+  return helper_.SendSaslMessage(sock_, header, msg, deadline_);
 }
 
 Status SaslServer::SendSaslError(ErrorStatusPB::RpcErrorCodePB code, const Status& err) {
@@ -282,7 +290,7 @@ Status SaslServer::SendSaslError(ErrorStatusPB::RpcErrorCodePB code, const Statu
   msg.set_code(code);
   msg.set_message(err.ToString());
 
-  RETURN_NOT_OK(helper_.SendSaslMessage(&sock_, header, msg, deadline_));
+  RETURN_NOT_OK(helper_.SendSaslMessage(sock_, header, msg, deadline_));
   TRACE("Sent SASL error: $0", ErrorStatusPB::RpcErrorCodePB_Name(code));
   return Status::OK();
 }
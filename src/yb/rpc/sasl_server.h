@@ -62,6 +62,10 @@ class SaslServer {
  public:
   // Does not take ownership of the socket indicated by the fd.
   SaslServer(string app_name, int fd);
+
+  // Negotiates over the socket of a connection, so negotiation is encrypted when the socket uses
+  // TLS. Does not take ownership of the socket.
+  SaslServer(string app_name, Socket* socket);
   ~SaslServer();
 
   // Enable ANONYMOUS authentication.
@@ -98,6 +102,10 @@ class SaslServer {
   // Get deadline for connection negotiation.
   const MonoTime& deadline() const { return deadline_; }
 
+  // The connection header was already received and validated by the caller, so Negotiate()
+  // starts with the first SASL message.
+  void set_connection_header_received() { connection_header_received_ = true; }
+
   // Initialize a new SASL server. Must be called before Negotiate().
   // Returns OK on success, otherwise RuntimeError.
   CHECKED_STATUS Init(const string& service_type);
@@ -151,7 +159,9 @@ class SaslServer {
   CHECKED_STATUS HandleResponseRequest(const SaslMessagePB& request);
 
   string app_name_;
-  Socket sock_;
+  // Wraps the fd the object was constructed with.
+  Socket fd_socket_;
+  Socket* sock_;
   std::vector<sasl_callback_t> callbacks_;
   gscoped_ptr<sasl_conn_t, SaslDeleter> sasl_conn_;
   SaslHelper helper_;
@@ -173,6 +183,8 @@ class SaslServer {
   // Negotiation timeout deadline.
   MonoTime deadline_;
 
+  bool connection_header_received_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(SaslServer);
 };
 
@@ -198,16 +198,16 @@ Status ParseCQLMessage(const Slice& buf, Slice* parsed_main_message) {
   return Status::OK();
 }
 
-void SerializeConnHeader(uint8_t* buf) {
+void SerializeConnHeader(uint8_t* buf, uint8_t auth_proto) {
   memcpy(reinterpret_cast<char *>(buf), kMagicNumber, kMagicNumberLength);
   buf += kMagicNumberLength;
   buf[kHeaderPosVersion] = kCurrentRpcVersion;
   buf[kHeaderPosServiceClass] = 0; // TODO: implement
-  buf[kHeaderPosAuthProto] = 0; // TODO: implement
+  buf[kHeaderPosAuthProto] = auth_proto;
 }
 
 // validate the entire rpc header (magic number + flags)
-Status ValidateConnHeader(const Slice& slice) {
+Status ValidateConnHeader(const Slice& slice, uint8_t* auth_proto) {
   DCHECK_EQ(kMagicNumberLength + kHeaderFlagsLength, slice.size())
     << "Invalid RPC header length";
 
@@ -228,7 +228,10 @@ Status ValidateConnHeader(const Slice& slice) {
 
   // TODO: validate additional header flags:
   // RPC_SERVICE_CLASS
-  // RPC_AUTH_PROTOCOL
+
+  if (auth_proto) {
+    *auth_proto = data[kHeaderPosAuthProto];
+  }
 
   return Status::OK();
 }
@@ -36,6 +36,8 @@
 #include <inttypes.h>
 #include <string.h>
 
+#include "yb/rpc/constants.h"
+
 namespace google {
 namespace protobuf {
 class MessageLite;
@@ -99,10 +101,11 @@ Status ParseCQLMessage(const Slice& buf, Slice* parsed_main_message);
 
 // Serialize the RPC connection header (magic number + flags).
 // buf must have 7 bytes available (kMagicNumberLength + kHeaderFlagsLength).
-void SerializeConnHeader(uint8_t* buf);
+void SerializeConnHeader(uint8_t* buf, uint8_t auth_proto = kAuthProtoSasl);
 
 // Validate the entire rpc header (magic number + flags).
-Status ValidateConnHeader(const Slice& slice);
+// Stores the authentication protocol flag of the header to auth_proto, when specified.
+Status ValidateConnHeader(const Slice& slice, uint8_t* auth_proto = nullptr);
 
 
 }  // namespace serialization
@@ -59,5 +59,9 @@ ServiceIf::~ServiceIf() {
 void ServiceIf::Shutdown() {
 }
 
+RpcCallClass ServiceIf::CallClass(const InboundCall& call) const {
+  return RpcCallClass::kDefault;
+}
+
 } // namespace rpc
 } // namespace yb
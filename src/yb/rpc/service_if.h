@@ -61,6 +61,17 @@ struct RpcMethodMetrics {
 };
 
 // Handles incoming messages that initiate an RPC.
+// Scheduling class of an inbound call. Queued calls of a lower class are handled first.
+enum class RpcCallClass {
+  kConsensus,
+  kWrite,
+  kRead,
+  kDefault,
+  kScan,
+};
+
+constexpr int kRpcCallClassCount = static_cast<int>(RpcCallClass::kScan) + 1;
+
 class ServiceIf {
  public:
   virtual ~ServiceIf();
@@ -68,6 +79,9 @@ class ServiceIf {
 
   virtual void Shutdown();
   virtual std::string service_name() const = 0;
+
+  // Returns scheduling class of the call, that is used by ServicePool to order queued calls.
+  virtual RpcCallClass CallClass(const InboundCall& call) const;
 };
 
 }  // namespace rpc
@@ -32,21 +32,29 @@
 
 #include "yb/rpc/service_pool.h"
 
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/ref_counted.h"
 
+#include "yb/rpc/admission_controller.h"
 #include "yb/rpc/inbound_call.h"
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/service_if.h"
 #include "yb/rpc/tasks_pool.h"
 
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
 #include "yb/util/metrics.h"
 #include "yb/util/status.h"
 #include "yb/util/thread.h"
@@ -55,11 +63,60 @@
 using std::shared_ptr;
 using strings::Substitute;
 
+DEFINE_bool(enable_rpc_admission_control, true,
+            "Adapt the limit on the number of calls queued to each RPC service to the time calls "
+            "spend in the queue, rejecting calls above the limit with a retry after hint.");
+TAG_FLAG(enable_rpc_admission_control, advanced);
+
+DEFINE_int32(rpc_admission_control_target_queue_delay_ms, 50,
+             "Queue delay, that the RPC service admission control tries to keep calls below.");
+TAG_FLAG(rpc_admission_control_target_queue_delay_ms, advanced);
+
+DEFINE_int32(rpc_admission_control_min_queue_limit, 32,
+             "Admission control never limits the number of calls queued to an RPC service below "
+             "this value.");
+TAG_FLAG(rpc_admission_control_min_queue_limit, advanced);
+
 METRIC_DEFINE_histogram(server, rpc_incoming_queue_time,
                         "RPC Queue Time",
                         yb::MetricUnit::kMicroseconds,
                         "Number of microseconds incoming RPC requests spend in the worker queue",
-                        60000000LU, 3);
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_consensus,
+                        "RPC Queue Time for Consensus Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming consensus RPC requests spend in the "
+                        "worker queue",
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_write,
+                        "RPC Queue Time for Write Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming write RPC requests spend in the worker "
+                        "queue",
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_read,
+                        "RPC Queue Time for Read Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming read RPC requests spend in the worker "
+                        "queue",
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_default,
+                        "RPC Queue Time for Other Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming RPC requests, that are not consensus, "
+                        "write, read or scan calls, spend in the worker queue",
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_scan,
+                        "RPC Queue Time for Scan Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming scan RPC requests spend in the worker "
+                        "queue",
+                        60000000LU, 3, yb::SHARDED_HISTOGRAM);
 
 METRIC_DEFINE_counter(server, rpcs_timed_out_in_queue,
                       "RPC Queue Timeouts",
@@ -73,15 +130,22 @@ METRIC_DEFINE_counter(server, rpcs_queue_overflow,
                       "Number of RPCs dropped because the service queue "
                       "was full.");
 
+METRIC_DEFINE_counter(server, rpcs_rejected_by_admission_control,
+                      "RPCs Rejected By Admission Control",
+                      yb::MetricUnit::kRequests,
+                      "Number of RPCs rejected because the number of queued calls reached "
+                      "the limit adapted to the service queue delay.");
+
 namespace yb {
 namespace rpc {
 
 namespace {
 
+// Task that handles the most urgent call queued to the service pool, when executed by the
+// thread pool. Pool queues exactly one task per queued call.
 class InboundCallTask final {
  public:
-  InboundCallTask(ServicePoolImpl* pool, InboundCallPtr call)
-      : pool_(pool), call_(std::move(call)) {
+  explicit InboundCallTask(ServicePoolImpl* pool) : pool_(pool) {
   }
 
   void Run();
@@ -89,7 +153,6 @@ class InboundCallTask final {
 
  private:
   ServicePoolImpl* pool_;
-  InboundCallPtr call_;
 };
 
 } // namespace
@@ -105,7 +168,24 @@ class ServicePoolImpl {
         incoming_queue_time_(METRIC_rpc_incoming_queue_time.Instantiate(entity)),
         rpcs_timed_out_in_queue_(METRIC_rpcs_timed_out_in_queue.Instantiate(entity)),
         rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
+        rpcs_rejected_by_admission_control_(
+            METRIC_rpcs_rejected_by_admission_control.Instantiate(entity)),
         tasks_pool_(max_tasks) {
+    if (FLAGS_enable_rpc_admission_control) {
+      admission_controller_.reset(new AdmissionController(
+          FLAGS_rpc_admission_control_min_queue_limit, max_tasks,
+          MonoDelta::FromMilliseconds(FLAGS_rpc_admission_control_target_queue_delay_ms)));
+    }
+    class_queue_time_[static_cast<int>(RpcCallClass::kConsensus)] =
+        METRIC_rpc_incoming_queue_time_consensus.Instantiate(entity);
+    class_queue_time_[static_cast<int>(RpcCallClass::kWrite)] =
+        METRIC_rpc_incoming_queue_time_write.Instantiate(entity);
+    class_queue_time_[static_cast<int>(RpcCallClass::kRead)] =
+        METRIC_rpc_incoming_queue_time_read.Instantiate(entity);
+    class_queue_time_[static_cast<int>(RpcCallClass::kDefault)] =
+        METRIC_rpc_incoming_queue_time_default.Instantiate(entity);
+    class_queue_time_[static_cast<int>(RpcCallClass::kScan)] =
+        METRIC_rpc_incoming_queue_time_scan.Instantiate(entity);
   }
 
   ~ServicePoolImpl() {
@@ -122,8 +202,31 @@ class ServicePoolImpl {
   void Enqueue(InboundCallPtr call) {
     TRACE_TO(call->trace(), "Inserting onto call queue");
 
-    if (!tasks_pool_.Enqueue(thread_pool_, this, std::move(call))) {
-      Overflow(call, "service", tasks_pool_.size());
+    const auto call_class = service_->CallClass(*call);
+    const auto now = MonoTime::FineNow();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // Consensus calls are never rejected by admission control, they are required for the
+      // cluster to make progress.
+      const size_t limit = admission_controller_ && call_class != RpcCallClass::kConsensus
+          ? admission_controller_->limit() : std::numeric_limits<size_t>::max();
+      if (queue_.size() >= limit) {
+        lock.unlock();
+        RejectByAdmissionControl(call, limit);
+        return;
+      }
+      queue_.insert(QueuedCall{call_class, call->GetClientDeadline(), serial_no_++, now, call});
+    }
+    // Consensus calls should not wait behind calls of other services sharing the thread pool.
+    const bool added = call_class == RpcCallClass::kConsensus
+        ? tasks_pool_.EnqueueHighPriority(thread_pool_, this)
+        : tasks_pool_.Enqueue(thread_pool_, this);
+    if (!added) {
+      // Reject the least urgent queued call instead of this one, it could be this call itself.
+      auto rejected = PopCall(false /* most_urgent */);
+      if (rejected) {
+        Overflow(rejected, "service", tasks_pool_.size());
+      }
     }
   }
 
@@ -154,10 +257,44 @@ class ServicePoolImpl {
     call->RespondFailure(ErrorStatusPB::ERROR_SERVER_TOO_BUSY, response_status);
   }
 
-  void Processed(const InboundCallPtr& call, const Status& status) {
+  void RejectByAdmissionControl(const InboundCallPtr& call, size_t limit) {
+    const auto retry_after = admission_controller_->retry_after();
+    const auto err_msg =
+        Substitute("$0 request on $1 from $2 rejected by admission control. "
+                   "The service has $3 queued calls, retry after $4.",
+            call->method_name(),
+            service_->service_name(),
+            yb::ToString(call->remote_address()),
+            limit,
+            retry_after.ToString());
+    YB_LOG_EVERY_N_SECS(WARNING, 1) << err_msg << THROTTLE_MSG;
+    rpcs_rejected_by_admission_control_->Increment();
+    call->RespondBusy(STATUS(ServiceUnavailable, err_msg), retry_after);
+  }
+
+  // Handles the most urgent queued call, dropping calls whose deadline already passed.
+  void RunNext() {
+    for (;;) {
+      auto call = PopCall(true /* most_urgent */);
+      if (!call) {
+        // Calls were already processed by other tasks, that dropped expired calls.
+        return;
+      }
+      if (!Handle(std::move(call))) {
+        return;
+      }
+    }
+  }
+
+  void Processed(const Status& status) {
     if (status.ok()) {
       return;
     }
+    // The thread pool failed to run our task, so fail the least urgent call instead.
+    auto call = PopCall(false /* most_urgent */);
+    if (!call) {
+      return;
+    }
     if (status.IsServiceUnavailable()) {
       Overflow(call, "global", thread_pool_->options().queue_limit);
       return;
@@ -169,8 +306,10 @@ class ServicePoolImpl {
     call->RespondFailure(ErrorStatusPB::FATAL_SERVER_SHUTTING_DOWN, response_status);
   }
 
-  void Handle(InboundCallPtr incoming) {
-    incoming->RecordHandlingStarted(incoming_queue_time_);
+  // Returns false if the call was dropped, because its deadline passed while it was queued.
+  bool Handle(InboundCallPtr incoming) {
+    incoming->RecordHandlingStarted(
+        incoming_queue_time_, class_queue_time_[static_cast<int>(service_->CallClass(*incoming))]);
     ADOPT_TRACE(incoming->trace());
 
     if (PREDICT_FALSE(incoming->ClientTimedOut())) {
@@ -183,32 +322,76 @@ class ServicePoolImpl {
           ErrorStatusPB::ERROR_SERVER_TOO_BUSY,
           STATUS(TimedOut, "Call waited in the queue past client deadline"));
 
-      return;
+      return false;
     }
 
     TRACE_TO(incoming->trace(), "Handling call");
 
     service_->Handle(std::move(incoming));
+    return true;
   }
 
  private:
+  struct QueuedCall {
+    RpcCallClass call_class;
+    MonoTime deadline;
+    size_t serial_no;
+    MonoTime enqueue_time;
+    // Not part of the ordering, so could be moved out of a queued call.
+    mutable InboundCallPtr call;
+  };
+
+  struct QueuedCallComparator {
+    // Lower class first, then earlier deadline first, then FIFO.
+    bool operator()(const QueuedCall& lhs, const QueuedCall& rhs) const {
+      if (lhs.call_class != rhs.call_class) {
+        return lhs.call_class < rhs.call_class;
+      }
+      if (lhs.deadline != rhs.deadline) {
+        return lhs.deadline < rhs.deadline;
+      }
+      return lhs.serial_no < rhs.serial_no;
+    }
+  };
+
+  InboundCallPtr PopCall(bool most_urgent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+      return nullptr;
+    }
+    auto it = most_urgent ? queue_.begin() : std::prev(queue_.end());
+    auto result = std::move(it->call);
+    if (most_urgent && admission_controller_) {
+      admission_controller_->Observe(MonoTime::FineNow().GetDeltaSince(it->enqueue_time));
+    }
+    queue_.erase(it);
+    return result;
+  }
+
   ThreadPool* thread_pool_;
   std::unique_ptr<ServiceIf> service_;
   scoped_refptr<Histogram> incoming_queue_time_;
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
+  scoped_refptr<Counter> rpcs_rejected_by_admission_control_;
+  std::unique_ptr<AdmissionController> admission_controller_;
+
+  scoped_refptr<Histogram> class_queue_time_[kRpcCallClassCount];
 
   std::atomic<bool> closing_ = {false};
   TasksPool<InboundCallTask> tasks_pool_;
+
+  std::mutex mutex_;
+  std::set<QueuedCall, QueuedCallComparator> queue_;
+  size_t serial_no_ = 0;
 };
 
 void InboundCallTask::Run() {
-  pool_->Handle(call_);
+  pool_->RunNext();
 }
 
 void InboundCallTask::Done(const Status& status) {
-  InboundCallPtr call = call_;
-  pool_->Processed(call, status);
+  pool_->Processed(status);
 }
 
 ServicePool::ServicePool(size_t max_tasks,
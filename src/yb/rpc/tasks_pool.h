@@ -36,24 +36,38 @@ class TasksPool {
 
   template <class... Args>
   bool Enqueue(ThreadPool* thread_pool, Args&&... args) {
+    return DoEnqueue(thread_pool, false /* high_priority */, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  bool EnqueueHighPriority(ThreadPool* thread_pool, Args&&... args) {
+    return DoEnqueue(thread_pool, true /* high_priority */, std::forward<Args>(args)...);
+  }
+
+  size_t size() const {
+    return tasks_.size();
+  }
+ private:
+  struct WrappedTask;
+  friend struct WrappedTask;
+
+  template <class... Args>
+  bool DoEnqueue(ThreadPool* thread_pool, bool high_priority, Args&&... args) {
     WrappedTask* task = nullptr;
     if (queue_.pop(task)) {
       task->pool = this;
       new (&task->storage) Task(std::forward<Args>(args)...);
-      thread_pool->Enqueue(task);
+      if (high_priority) {
+        thread_pool->EnqueueHighPriority(task);
+      } else {
+        thread_pool->Enqueue(task);
+      }
       return true;
     } else {
       return false;
     }
   }
 
-  size_t size() const {
-    return tasks_.size();
-  }
- private:
-  struct WrappedTask;
-  friend struct WrappedTask;
-
   void Released(WrappedTask* task) {
     CHECK(queue_.bounded_push(task));
   }
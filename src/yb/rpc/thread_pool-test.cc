@@ -178,6 +178,87 @@ TEST_F(ThreadPoolTest, TestQueueOverflow) {
   }
 }
 
+TEST_F(ThreadPoolTest, TestMultiProducersWithAffinity) {
+  constexpr size_t kTotalTasks = 10000;
+  constexpr size_t kTotalWorkers = 4;
+  constexpr size_t kProducers = 8;
+  ThreadPool pool("test", kTotalTasks, kTotalWorkers);
+
+  CountDownLatch latch(kTotalTasks);
+  std::vector<TestTask> tasks(kTotalTasks);
+  std::vector<std::thread> threads;
+  size_t begin = 0;
+  for (size_t i = 0; i != kProducers; ++i) {
+    size_t end = kTotalTasks * (i + 1) / kProducers;
+    threads.emplace_back([&pool, &latch, &tasks, begin, end, i] {
+      ThreadPool::SetCurrentThreadAffinity(i);
+      for (size_t j = begin; j != end; ++j) {
+        tasks[j].SetLatch(&latch);
+        ASSERT_TRUE(pool.Enqueue(&tasks[j]));
+      }
+    });
+    begin = end;
+  }
+  latch.Wait();
+  for (auto& task : tasks) {
+    ASSERT_TRUE(task.IsCompleted());
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+namespace {
+
+class BlockingTask final : public ThreadPoolTask {
+ public:
+  BlockingTask(CountDownLatch* started, CountDownLatch* unblock)
+      : started_(started), unblock_(unblock) {}
+
+ private:
+  void Run() override {
+    started_->CountDown();
+    unblock_->Wait();
+  }
+
+  void Done(const Status& status) override {}
+
+  CountDownLatch* started_;
+  CountDownLatch* unblock_;
+};
+
+} // namespace
+
+// Tasks queued to the local queue of a busy worker should be stolen by other workers.
+TEST_F(ThreadPoolTest, TestSteal) {
+  constexpr size_t kTotalTasks = 100;
+  constexpr size_t kTotalWorkers = 2;
+  ThreadPool pool("test", kTotalTasks, kTotalWorkers);
+
+  CountDownLatch started(1);
+  CountDownLatch unblock(1);
+  BlockingTask blocking_task(&started, &unblock);
+  CountDownLatch latch(kTotalTasks);
+  std::vector<TestTask> tasks(kTotalTasks);
+  std::thread producer([&] {
+    ThreadPool::SetCurrentThreadAffinity(0);
+    ASSERT_TRUE(pool.Enqueue(&blocking_task));
+    started.Wait();
+    for (auto& task : tasks) {
+      task.SetLatch(&latch);
+      ASSERT_TRUE(pool.Enqueue(&task));
+    }
+  });
+  // Only the second worker is free, so it should process all tasks.
+  latch.Wait();
+  for (auto& task : tasks) {
+    ASSERT_TRUE(task.IsCompleted());
+  }
+  unblock.CountDown();
+  producer.join();
+  pool.Shutdown();
+}
+
 TEST_F(ThreadPoolTest, TestShutdown) {
   constexpr size_t kTotalTasks = 10000;
   constexpr size_t kTotalWorkers = 4;
@@ -15,15 +15,28 @@
 
 #include "yb/rpc/thread_pool.h"
 
+#include <algorithm>
 #include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include <boost/lockfree/queue.hpp>
 #include <boost/scope_exit.hpp>
 
+#include <gflags/gflags.h>
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/numa.h"
 #include "yb/util/thread.h"
 
+DEFINE_bool(rpc_thread_pool_local_queues, true,
+            "Queue tasks submitted from reactor and worker threads to the local queue of the "
+            "worker associated with the submitting thread. Idle workers steal tasks from local "
+            "queues of other workers.");
+TAG_FLAG(rpc_thread_pool_local_queues, advanced);
+
 namespace yb {
 namespace rpc {
 
@@ -37,23 +50,55 @@ typedef boost::lockfree::queue<Worker*> WaitingWorkers;
 struct ThreadPoolShare {
   ThreadPoolOptions options;
   TaskQueue task_queue;
+  // Tasks from this queue are popped before any other tasks.
+  TaskQueue high_priority_task_queue;
   WaitingWorkers waiting_workers;
+  // Queue for each worker, that receives tasks submitted from threads associated with this worker.
+  std::vector<std::unique_ptr<TaskQueue>> local_queues;
 
   explicit ThreadPoolShare(ThreadPoolOptions o)
       : options(std::move(o)),
         task_queue(options.queue_limit),
+        high_priority_task_queue(options.queue_limit),
         waiting_workers(options.max_workers) {
+    const size_t local_queue_limit = std::max<size_t>(
+        options.queue_limit / std::max<size_t>(options.max_workers, 1), 1);
+    local_queues.reserve(options.max_workers);
+    while (local_queues.size() != options.max_workers) {
+      local_queues.emplace_back(new TaskQueue(local_queue_limit));
+    }
+  }
+
+  // Pops high priority task, then task from the local queue of the worker with specified index,
+  // then from the shared queue, then steals it from local queues of other workers.
+  bool PopTask(size_t index, ThreadPoolTask** task) {
+    if (high_priority_task_queue.pop(*task) || local_queues[index]->pop(*task) ||
+        task_queue.pop(*task)) {
+      return true;
+    }
+    const size_t size = local_queues.size();
+    for (size_t i = 1; i < size; ++i) {
+      if (local_queues[(index + i) % size]->pop(*task)) {
+        return true;
+      }
+    }
+    return false;
   }
 };
 
 namespace {
 const std::string kRpcThreadCategory = "rpc_thread_pool";
+
+constexpr size_t kNoAffinity = std::numeric_limits<size_t>::max();
+
+// Index of the worker whose local queue receives tasks submitted from the current thread.
+__thread size_t current_thread_affinity = kNoAffinity;
 } // namespace
 
 class Worker {
  public:
   explicit Worker(ThreadPoolShare* share, size_t index)
-      : share_(share) {
+      : share_(share), index_(index) {
     auto name = strings::Substitute("rpc_tp_$0_$1", share_->options.name, index);
     CHECK_OK(yb::Thread::Create(kRpcThreadCategory, name, &Worker::Execute, this, &thread_));
   }
@@ -79,11 +124,14 @@ class Worker {
     // To handle this case we use waiting_task_ flag.
     // If we don't wait task, we return false here, and next worker would be popped from queue
     // and notified.
-    if (!waiting_task_) {
-      return false;
-    }
-    cond_.notify_one();
-    return true;
+    return DoNotify();
+  }
+
+  // Wakes up the worker if it is waiting for a task, w/o removing it from the worker queue.
+  // Used to wake up the worker whose local queue received a task.
+  bool NotifyIfWaiting() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return DoNotify();
   }
 
  private:
@@ -92,6 +140,8 @@ class Worker {
   // Meaning that we does not have work (task queue empty) or
   // does not have free hands (worker queue empty)
   void Execute() {
+    current_thread_affinity = index_;
+    BindCurrentThreadToNumaNode(index_);
     while (!stop_requested_) {
       ThreadPoolTask* task = nullptr;
       if (PopTask(&task)) {
@@ -101,34 +151,46 @@ class Worker {
     }
   }
 
+  // Should be invoked with mutex_ locked.
+  // Notifier resets waiting_task_, so the same wait could not be counted by several notifiers.
+  bool DoNotify() {
+    if (!waiting_task_) {
+      return false;
+    }
+    waiting_task_ = false;
+    cond_.notify_one();
+    return true;
+  }
+
   bool PopTask(ThreadPoolTask** task) {
     // First of all we try to get already queued task, w/o locking.
     // If there is no task, so we could go to waiting state.
-    if (share_->task_queue.pop(*task)) {
+    if (share_->PopTask(index_, task)) {
       return true;
     }
     std::unique_lock<std::mutex> lock(mutex_);
-    waiting_task_ = true;
     BOOST_SCOPE_EXIT(&waiting_task_) {
         waiting_task_ = false;
     } BOOST_SCOPE_EXIT_END;
 
     while (!stop_requested_) {
+      waiting_task_ = true;
       AddToWaitingWorkers();
 
       // There could be situation, when task was queued before we added ourselves to
       // the worker queue. So worker queue could be empty in this case, and nobody was notified
       // about new task. So we check there for this case. This technique is similar to
       // double check.
-      if (share_->task_queue.pop(*task)) {
+      if (share_->PopTask(index_, task)) {
         return true;
       }
 
       cond_.wait(lock);
+      waiting_task_ = false;
 
       // Sometimes another worker could steal task before we wake up. In this case we will
       // just enqueue ourselves back.
-      if (share_->task_queue.pop(*task)) {
+      if (share_->PopTask(index_, task)) {
         return true;
       }
     }
@@ -144,6 +206,7 @@ class Worker {
   }
 
   ThreadPoolShare* share_;
+  const size_t index_;
   scoped_refptr<yb::Thread> thread_;
   std::mutex mutex_;
   std::condition_variable cond_;
@@ -160,7 +223,8 @@ class ThreadPool::Impl {
       : share_(std::move(options)),
         queue_full_status_(STATUS_SUBSTITUTE(ServiceUnavailable,
                                              "Queue is full, max items: $0",
-                                             share_.options.queue_limit)) {
+                                             share_.options.queue_limit)),
+        worker_ptrs_(new std::atomic<Worker*>[share_.options.max_workers]()) {
     workers_.reserve(share_.options.max_workers);
     while (workers_.size() != share_.options.max_workers) {
       workers_.emplace_back(nullptr);
@@ -171,39 +235,42 @@ class ThreadPool::Impl {
     return share_.options;
   }
 
-  bool Enqueue(ThreadPoolTask* task) {
+  bool Enqueue(ThreadPoolTask* task, bool high_priority) {
+    // Workers are not destroyed while adding_ is not zero, so we could notify them.
     ++adding_;
-    if (closing_) {
+    BOOST_SCOPE_EXIT(&adding_) {
       --adding_;
+    } BOOST_SCOPE_EXIT_END;
+    if (closing_) {
       task->Done(shutdown_status_);
       return false;
     }
-    bool added = share_.task_queue.bounded_push(task);
-    --adding_;
-    if (!added) {
-      task->Done(queue_full_status_);
-      return false;
-    }
-    Worker* worker = nullptr;
-    while (share_.waiting_workers.pop(worker)) {
-      if (worker->Notify()) {
-        return true;
+    if (high_priority) {
+      if (!share_.high_priority_task_queue.bounded_push(task)) {
+        task->Done(queue_full_status_);
+        return false;
       }
+      return NotifyOrCreateWorker();
     }
-
-    // We increment created_workers_ every time, the first max_worker increments would produce
-    // a new worker. And after that, we will just increment it doing nothing after that.
-    // So we could be lock free here.
-    auto index = created_workers_++;
-    if (index < share_.options.max_workers) {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (!closing_) {
-        workers_[index].reset(new Worker(&share_, index));
+    const size_t max_workers = share_.options.max_workers;
+    const size_t affinity = current_thread_affinity;
+    if (affinity != kNoAffinity && max_workers != 0 && FLAGS_rpc_thread_pool_local_queues) {
+      const size_t index = affinity % max_workers;
+      if (share_.local_queues[index]->bounded_push(task)) {
+        Worker* worker = worker_ptrs_[index].load(std::memory_order_acquire);
+        if (worker && worker->NotifyIfWaiting()) {
+          return true;
+        }
+        // Associated worker is busy or not yet created, so wake up any waiting worker to steal
+        // this task.
+        return NotifyOrCreateWorker();
       }
-    } else {
-      --created_workers_;
     }
-    return true;
+    if (!share_.task_queue.bounded_push(task)) {
+      task->Done(queue_full_status_);
+      return false;
+    }
+    return NotifyOrCreateWorker();
   }
 
   void Shutdown() {
@@ -213,30 +280,66 @@ class ThreadPool::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       if (closing_) {
         CHECK(share_.task_queue.empty());
+        CHECK(share_.high_priority_task_queue.empty());
         CHECK(workers_.empty());
         return;
       }
       closing_ = true;
     }
-    for (auto& worker : workers_) {
-      if (worker) {
-        worker->Stop();
-      }
-    }
-    workers_.clear();
     // Shutdown is quite rare situation otherwise enqueue is quite frequent.
     // Because of this we use "atomic lock" in enqueue and busy wait in shutdown.
     // So we could process enqueue quickly, and stuck in shutdown for sometime.
     while(adding_ != 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
+    for (size_t i = 0; i != share_.options.max_workers; ++i) {
+      worker_ptrs_[i].store(nullptr, std::memory_order_release);
+    }
+    for (auto& worker : workers_) {
+      if (worker) {
+        worker->Stop();
+      }
+    }
+    workers_.clear();
     ThreadPoolTask* task = nullptr;
+    while (share_.high_priority_task_queue.pop(task)) {
+      task->Done(shutdown_status_);
+    }
     while (share_.task_queue.pop(task)) {
       task->Done(shutdown_status_);
     }
+    for (const auto& queue : share_.local_queues) {
+      while (queue->pop(task)) {
+        task->Done(shutdown_status_);
+      }
+    }
   }
 
  private:
+  bool NotifyOrCreateWorker() {
+    Worker* worker = nullptr;
+    while (share_.waiting_workers.pop(worker)) {
+      if (worker->Notify()) {
+        return true;
+      }
+    }
+
+    // We increment created_workers_ every time, the first max_worker increments would produce
+    // a new worker. And after that, we will just increment it doing nothing after that.
+    // So we could be lock free here.
+    auto index = created_workers_++;
+    if (index < share_.options.max_workers) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!closing_) {
+        workers_[index].reset(new Worker(&share_, index));
+        worker_ptrs_[index].store(workers_[index].get(), std::memory_order_release);
+      }
+    } else {
+      --created_workers_;
+    }
+    return true;
+  }
+
   ThreadPoolShare share_;
   std::vector<std::unique_ptr<Worker>> workers_;
   std::atomic<size_t> created_workers_ = {0};
@@ -245,6 +348,8 @@ class ThreadPool::Impl {
   std::atomic<size_t> adding_ = {0};
   const Status shutdown_status_ = STATUS(Aborted, "Service is shutting down");
   const Status queue_full_status_;
+  // Workers that could be accessed w/o locking, to notify them about tasks in their local queues.
+  std::unique_ptr<std::atomic<Worker*>[]> worker_ptrs_;
 };
 
 ThreadPool::ThreadPool(ThreadPoolOptions options)
@@ -271,8 +376,16 @@ bool ThreadPool::IsCurrentThreadRpcWorker() {
   return thread != nullptr && thread->category() == kRpcThreadCategory;
 }
 
+void ThreadPool::SetCurrentThreadAffinity(size_t affinity) {
+  current_thread_affinity = affinity;
+}
+
 bool ThreadPool::Enqueue(ThreadPoolTask* task) {
-  return impl_->Enqueue(task);
+  return impl_->Enqueue(task, false /* high_priority */);
+}
+
+bool ThreadPool::EnqueueHighPriority(ThreadPoolTask* task) {
+  return impl_->Enqueue(task, true /* high_priority */);
 }
 
 void ThreadPool::Shutdown() {
@@ -60,10 +60,20 @@ class ThreadPool {
   const ThreadPoolOptions& options() const;
 
   bool Enqueue(ThreadPoolTask* task);
+
+  // Enqueues task that would be picked by workers before any task enqueued using Enqueue.
+  bool EnqueueHighPriority(ThreadPoolTask* task);
   void Shutdown();
 
   static bool IsCurrentThreadRpcWorker();
 
+  // Associates the current thread with the worker with index affinity % max_workers.
+  // Tasks enqueued from this thread are placed to the local queue of that worker, so they are
+  // likely to be processed by the same worker, while its caches are warm. Idle workers steal tasks
+  // from local queues of busy workers.
+  // Worker threads are associated with themselves.
+  static void SetCurrentThreadAffinity(size_t affinity);
+
  private:
   class Impl;
 
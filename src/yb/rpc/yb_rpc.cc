@@ -15,6 +15,9 @@
 
 #include "yb/rpc/yb_rpc.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include "yb/gutil/endian.h"
 
 #include "yb/rpc/auth_store.h"
@@ -29,6 +32,7 @@
 #include "yb/util/size_literals.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/memory/memory.h"
+#include "yb/util/object_pool.h"
 
 using yb::operator"" _MB;
 
@@ -67,6 +71,10 @@ void YBConnectionContext::RunNegotiation(ConnectionPtr connection, const MonoTim
   Negotiation::YBNegotiation(std::move(connection), this, deadline);
 }
 
+bool YBConnectionContext::PipelineNegotiation(Connection* connection) {
+  return Negotiation::PipelineYBNegotiation(connection);
+}
+
 size_t YBConnectionContext::BufferLimit() {
   return FLAGS_rpc_max_message_size;
 }
@@ -123,7 +131,7 @@ Status YBConnectionContext::HandleCall(const ConnectionPtr& connection, Slice ca
 }
 
 Status YBConnectionContext::InitSaslClient(Connection* connection) {
-  sasl_client_.reset(new SaslClient(kSaslAppName, connection->socket()->GetFd()));
+  sasl_client_.reset(new SaslClient(kSaslAppName, connection->socket()));
   RETURN_NOT_OK(sasl_client().Init(kSaslProtoName));
   RETURN_NOT_OK(sasl_client().EnableAnonymous());
   const auto& credentials = connection->user_credentials();
@@ -133,7 +141,7 @@ Status YBConnectionContext::InitSaslClient(Connection* connection) {
 }
 
 Status YBConnectionContext::InitSaslServer(Connection* connection) {
-  sasl_server_.reset(new SaslServer(kSaslAppName, connection->socket()->GetFd()));
+  sasl_server_.reset(new SaslServer(kSaslAppName, connection->socket()));
   // TODO: Do necessary configuration plumbing to enable user authentication.
   // Right now we just enable PLAIN with a "dummy" auth store, which allows everyone in.
   RETURN_NOT_OK(sasl_server().Init(kSaslProtoName));
@@ -146,7 +154,7 @@ Status YBConnectionContext::HandleInboundCall(const ConnectionPtr& connection, S
   auto reactor = connection->reactor();
   DCHECK(reactor->IsCurrentThread());
 
-  auto call = std::make_shared<YBInboundCall>(connection, call_processed_listener());
+  auto call = MakePooledShared<YBInboundCall>(connection, call_processed_listener());
 
   Status s = call->ParseFrom(call_data);
   if (!s.ok()) {
@@ -190,8 +198,7 @@ Status YBInboundCall::ParseFrom(Slice source) {
   TRACE_EVENT_FLOW_BEGIN0("rpc", "YBInboundCall", this);
   TRACE_EVENT0("rpc", "YBInboundCall::ParseFrom");
 
-  request_data_.assign(source.data(), source.end());
-  source = Slice(request_data_.data(), request_data_.size());
+  source = StoreRequestData(source);
   RETURN_NOT_OK(serialization::ParseYBMessage(source, &header_, &serialized_request_));
 
   // Adopt the service/method info from the header as soon as it's available.
@@ -204,6 +211,11 @@ Status YBInboundCall::ParseFrom(Slice source) {
   }
   remote_method_.FromPB(header_.remote_method());
 
+  // The caller is traced, so trace this call as well to get an end-to-end breakdown.
+  if (header_.trace_sampled()) {
+    trace_->set_sampled();
+  }
+
   return Status::OK();
 }
 
@@ -291,10 +303,9 @@ void YBInboundCall::LogTrace() const {
       // The traces may also be too large to fit in a log message.
       LOG(WARNING) << ToString() << " took " << total_time << "ms (client timeout "
                    << header_.timeout_millis() << "ms).";
-      std::string s = trace_->DumpToString(true);
-      if (!s.empty()) {
-        LOG(WARNING) << "Trace:\n" << s;
-      }
+      std::stringstream s;
+      DumpTrace(&s);
+      LOG(WARNING) << "Trace:\n" << s.str();
       return;
     }
   }
@@ -303,7 +314,7 @@ void YBInboundCall::LogTrace() const {
           FLAGS_rpc_dump_all_traces ||
           total_time > FLAGS_rpc_slow_query_threshold_ms)) {
     LOG(INFO) << ToString() << " took " << total_time << "ms. Trace:";
-    trace_->Dump(&LOG(INFO), true);
+    DumpTrace(&LOG(INFO));
   }
 }
 
@@ -352,6 +363,17 @@ void YBInboundCall::RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code,
   Respond(err, false);
 }
 
+void YBInboundCall::RespondBusy(const Status& status, MonoDelta retry_after) {
+  TRACE_EVENT0("rpc", "InboundCall::RespondBusy");
+  ErrorStatusPB err;
+  err.set_message(status.ToString());
+  err.set_code(ErrorStatusPB::ERROR_SERVER_TOO_BUSY);
+  const auto retry_after_ms = std::max<int64_t>(retry_after.ToMilliseconds(), 1);
+  err.set_retry_after_ms(static_cast<uint32_t>(retry_after_ms));
+
+  Respond(err, false);
+}
+
 void YBInboundCall::RespondApplicationError(int error_ext_id, const std::string& message,
                                             const MessageLite& app_error_pb) {
   ErrorStatusPB err;
@@ -49,6 +49,8 @@ class YBConnectionContext : public ConnectionContextWithCallId {
 
   void RunNegotiation(ConnectionPtr connection, const MonoTime& deadline) override;
 
+  bool PipelineNegotiation(Connection* connection) override;
+
   CHECKED_STATUS ProcessCalls(const ConnectionPtr& connection,
                               Slice slice,
                               size_t* consumed) override;
@@ -110,6 +112,8 @@ class YBInboundCall : public InboundCall {
   void RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code,
                       const Status &status) override;
 
+  void RespondBusy(const Status& status, MonoDelta retry_after) override;
+
   void RespondApplicationError(int error_ext_id, const std::string& message,
                                const google::protobuf::MessageLite& app_error_pb);
 
@@ -234,7 +234,10 @@ static void WriteMetricsAsJson(const MetricRegistry* const metrics,
 
 static void WriteForPrometheus(const MetricRegistry* const metrics,
                                const Webserver::WebRequest& req, std::stringstream* output) {
-  PrometheusWriter writer(output);
+  // Tablet metrics are summed up per table, unless "aggregation=tablet" is requested.
+  string aggregation = FindWithDefault(req.parsed_args, "aggregation", "table");
+  PrometheusWriter writer(output, aggregation == "tablet" ? PrometheusAggregation::kTablet
+                                                          : PrometheusAggregation::kTable);
   WARN_NOT_OK(metrics->WriteForPrometheus(&writer), "Couldn't write text metrics for Prometheus");
 }
 
@@ -245,14 +248,18 @@ void RegisterMetricsJsonHandler(Webserver* webserver, const MetricRegistry* cons
   bool not_styled = false;
   bool not_on_nav_bar = false;
   bool is_on_nav_bar = true;
-  webserver->RegisterPathHandler("/metrics", "Metrics", callback, not_styled, is_on_nav_bar);
+  bool is_expensive = true;
+  webserver->RegisterPathHandler(
+      "/metrics", "Metrics", callback, not_styled, is_on_nav_bar, is_expensive);
 
   // The old name -- this is preserved for compatibility with older releases of
   // monitoring software which expects the old name.
-  webserver->RegisterPathHandler("/jsonmetricz", "Metrics", callback, not_styled, not_on_nav_bar);
+  webserver->RegisterPathHandler(
+      "/jsonmetricz", "Metrics", callback, not_styled, not_on_nav_bar, is_expensive);
 
   webserver->RegisterPathHandler(
-      "/prometheus-metrics", "Metrics", prometheus_callback, not_styled, not_on_nav_bar);
+      "/prometheus-metrics", "Metrics", prometheus_callback, not_styled, not_on_nav_bar,
+      is_expensive);
 }
 
 } // namespace yb
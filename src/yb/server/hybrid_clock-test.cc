@@ -31,6 +31,9 @@
 //
 
 #include <algorithm>
+#include <thread>
+#include <vector>
+
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -257,6 +260,34 @@ TEST_F(HybridClockTest, TestClockDoesntGoBackwardsWithUpdates) {
   }
 }
 
+// Hybrid times returned to concurrent readers should be unique and increasing in each thread.
+TEST_F(HybridClockTest, TestConcurrentNowIsUnique) {
+  constexpr int kNumThreads = 4;
+  constexpr int kReadsPerThread = 100000;
+
+  std::vector<std::vector<uint64_t>> values(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kNumThreads; ++i) {
+    threads.emplace_back([this, &values, i] {
+      values[i].reserve(kReadsPerThread);
+      for (int j = 0; j != kReadsPerThread; ++j) {
+        values[i].push_back(clock_->Now().value());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint64_t> all;
+  for (const auto& thread_values : values) {
+    ASSERT_TRUE(std::is_sorted(thread_values.begin(), thread_values.end()));
+    all.insert(all.end(), thread_values.begin(), thread_values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+}
+
 TEST_F(HybridClockTest, CompareHybridClocksToDelta) {
   EXPECT_EQ(1, HybridClock::CompareHybridClocksToDelta(
       HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(1000, 10),
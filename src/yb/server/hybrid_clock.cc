@@ -66,6 +66,13 @@ DEFINE_bool(use_mock_wall_clock, false,
             "instead of reading time from the system clock, for tests.");
 TAG_FLAG(use_mock_wall_clock, hidden);
 
+DEFINE_int32(hybrid_clock_error_refresh_interval_ms, 10,
+             "How often HybridClock reads the clock error from NTP. In between the error is "
+             "extrapolated from the last value. If not positive, the error is read on every clock "
+             "read.");
+TAG_FLAG(hybrid_clock_error_refresh_interval_ms, advanced);
+TAG_FLAG(hybrid_clock_error_refresh_interval_ms, runtime);
+
 METRIC_DEFINE_gauge_uint64(server, hybrid_clock_hybrid_time,
                            "Hybrid Clock HybridTime",
                            yb::MetricUnit::kMicroseconds,
@@ -98,6 +105,20 @@ Status CheckDeadlineNotWithinMicros(const MonoTime& deadline, int64_t wait_for_u
   return Status::OK();
 }
 
+// The kernel grows the NTP maximum error by 500 ppm (MAXFREQ) of the elapsed time between
+// synchronizations, so this bounds the growth of the error since it was last read.
+uint64_t MaxErrorGrowthUsec(uint64_t elapsed_usec) {
+  return elapsed_usec / 2000 + 1;
+}
+
+// Stores 'candidate' to 'value' if it is higher.
+void UpdateMax(std::atomic<uint64_t>* value, uint64_t candidate) {
+  uint64_t current = value->load(std::memory_order_acquire);
+  while (current < candidate &&
+         !value->compare_exchange_weak(current, candidate, std::memory_order_acq_rel)) {
+  }
+}
+
 }  // anonymous namespace
 
 const int HybridClock::kBitsToShift = HybridTime::kBitsForLogicalComponent;
@@ -115,8 +136,6 @@ HybridClock::HybridClock()
       divisor_(1),
 #endif
       tolerance_adjustment_(1),
-      last_usec_(0),
-      next_logical_(0),
       state_(kNotInitialized) {
 }
 
@@ -204,6 +223,9 @@ Status HybridClock::Init() {
   LOG(INFO) << "HybridClock initialized. Resolution in nanos?: " << (divisor_ == 1000)
             << " Wait times tolerance adjustment: " << tolerance_adjustment_
             << " Current error (microseconds): " << error_usec;
+
+  cached_error_usec_.store(error_usec, std::memory_order_relaxed);
+  error_refresh_usec_.store(now_usec, std::memory_order_release);
 #endif // defined(__APPLE__)
 
   state_ = kInitialized;
@@ -214,20 +236,14 @@ Status HybridClock::Init() {
 HybridTime HybridClock::Now() {
   HybridTime now;
   uint64_t error;
-
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(&now, &error);
+  NowWithError(&now, &error);
   return now;
 }
 
 HybridTime HybridClock::NowLatest() {
   HybridTime now;
   uint64_t error;
-
-  {
-    std::lock_guard<simple_spinlock> lock(lock_);
-    NowWithErrorUnlocked(&now, &error);
-  }
+  NowWithError(&now, &error);
 
   uint64_t now_latest = GetPhysicalValueMicros(now) + error;
   uint64_t now_logical = GetLogicalValue(now);
@@ -244,28 +260,29 @@ Status HybridClock::GetGlobalLatest(HybridTime* t) {
 }
 
 void HybridClock::NowWithError(HybridTime *hybrid_time, uint64_t *max_error_usec) {
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(hybrid_time, max_error_usec);
-}
-
-void HybridClock::NowWithErrorUnlocked(HybridTime *hybrid_time, uint64_t *max_error_usec) {
-
-  DCHECK(lock_.is_locked());
   DCHECK_EQ(state_, kInitialized) << "Clock not initialized. Must call Init() first.";
 
   uint64_t now_usec;
   uint64_t error_usec;
-  Status s = WalltimeWithError(&now_usec, &error_usec);
+  Status s = WalltimeWithCachedError(&now_usec, &error_usec);
   if (PREDICT_FALSE(!s.ok())) {
     LOG(FATAL) << Substitute("Couldn't get the current time: Clock unsynchronized. "
         "Status: $0", s.ToString());
   }
 
+  // Hand out the current physical time if it is ahead of the last returned or updated value,
+  // otherwise the next logical value after it.
+  const uint64_t now_value = HybridTimeFromMicroseconds(now_usec).ToUint64();
+  uint64_t next = next_hybrid_time_value_.load(std::memory_order_acquire);
+  uint64_t result;
+  do {
+    result = std::max(now_value, next);
+  } while (!next_hybrid_time_value_.compare_exchange_weak(
+      next, result + 1, std::memory_order_acq_rel));
+  *hybrid_time = HybridTime(result);
+
   // If the current time surpasses the last update just return it
-  if (PREDICT_TRUE(now_usec > last_usec_)) {
-    last_usec_ = now_usec;
-    next_logical_ = 1;
-    *hybrid_time = HybridTimeFromMicroseconds(last_usec_);
+  if (PREDICT_TRUE(result == now_value)) {
     *max_error_usec = error_usec;
     if (PREDICT_FALSE(VLOG_IS_ON(2))) {
       VLOG(2) << "Current clock is higher than the last one. Resetting logical values."
@@ -293,14 +310,12 @@ void HybridClock::NowWithErrorUnlocked(HybridTime *hybrid_time, uint64_t *max_er
   // This broadens the error interval for both cases but always returns
   // a correct error interval.
 
-  *max_error_usec = last_usec_ - (now_usec - error_usec);
-  *hybrid_time = HybridTimeFromMicrosecondsAndLogicalValue(last_usec_, next_logical_);
+  *max_error_usec = GetPhysicalValueMicros(*hybrid_time) - (now_usec - error_usec);
   if (PREDICT_FALSE(VLOG_IS_ON(2))) {
     VLOG(2) << "Current clock is lower than the last one. Returning last read and incrementing"
         " logical values. Physical Value: " << now_usec << " usec Logical Value: "
-        << next_logical_ << " Error: " << *max_error_usec;
+        << GetLogicalValue(*hybrid_time) << " Error: " << *max_error_usec;
   }
-  next_logical_++;
 }
 
 void HybridClock::Update(const HybridTime& to_update) {
@@ -308,17 +323,7 @@ void HybridClock::Update(const HybridTime& to_update) {
     return;
   }
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  HybridTime now;
-  uint64_t error_ignored;
-  NowWithErrorUnlocked(&now, &error_ignored);
-
-  if (PREDICT_TRUE(now.CompareTo(to_update) > 0)) {
-    return;
-  }
-
-  last_usec_ = GetPhysicalValueMicros(to_update);
-  next_logical_ = GetLogicalValue(to_update) + 1;
+  UpdateMax(&next_hybrid_time_value_, to_update.ToUint64() + 1);
 }
 
 bool HybridClock::SupportsExternalConsistencyMode(ExternalConsistencyMode mode) {
@@ -330,10 +335,7 @@ Status HybridClock::WaitUntilAfter(const HybridTime& then_latest,
   TRACE_EVENT0("clock", "HybridClock::WaitUntilAfter");
   HybridTime now;
   uint64_t error;
-  {
-    std::lock_guard<simple_spinlock> lock(lock_);
-    NowWithErrorUnlocked(&now, &error);
-  }
+  NowWithError(&now, &error);
 
   // "unshift" the hybrid_times so that we can measure actual time
   uint64_t now_usec = GetPhysicalValueMicros(now);
@@ -374,10 +376,7 @@ Status HybridClock::WaitUntilAfterLocally(const HybridTime& then,
   while (true) {
     HybridTime now;
     uint64_t error;
-    {
-      std::lock_guard<simple_spinlock> lock(lock_);
-      NowWithErrorUnlocked(&now, &error);
-    }
+    NowWithError(&now, &error);
     if (now.CompareTo(then) > 0) {
       return Status::OK();
     }
@@ -393,21 +392,13 @@ bool HybridClock::IsAfter(HybridTime t) {
   // a time update.
   uint64_t now_usec;
   uint64_t error_usec;
-  CHECK_OK(WalltimeWithError(&now_usec, &error_usec));
+  CHECK_OK(WalltimeWithCachedError(&now_usec, &error_usec));
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  now_usec = std::max(now_usec, last_usec_);
+  // The next value may be in the future if we were updated from a remote node.
+  uint64_t now_value = std::max(HybridTimeFromMicroseconds(now_usec).ToUint64(),
+                                next_hybrid_time_value_.load(std::memory_order_acquire));
 
-  HybridTime now;
-  if (now_usec > last_usec_) {
-    now = HybridTimeFromMicroseconds(now_usec);
-  } else {
-    // last_usec_ may be in the future if we were updated from a remote
-    // node.
-    now = HybridTimeFromMicrosecondsAndLogicalValue(last_usec_, next_logical_);
-  }
-
-  return t.value() < now.value();
+  return t.value() < now_value;
 }
 
 yb::Status HybridClock::CheckClockSyncError(uint64_t error_usec) {
@@ -424,6 +415,7 @@ yb::Status HybridClock::WalltimeWithError(uint64_t* now_usec, uint64_t* error_us
     VLOG(1) << "Current clock time: " << mock_clock_time_usec_ << " error: "
             << mock_clock_max_error_usec_ << ". Updating to time: " << now_usec
             << " and error: " << error_usec;
+    std::lock_guard<simple_spinlock> lock(lock_);
     *now_usec = mock_clock_time_usec_;
     *error_usec = mock_clock_max_error_usec_;
   } else {
@@ -447,6 +439,37 @@ yb::Status HybridClock::WalltimeWithError(uint64_t* now_usec, uint64_t* error_us
   return yb::Status::OK();
 }
 
+Status HybridClock::WalltimeWithCachedError(uint64_t* now_usec, uint64_t* error_usec) {
+#if !defined(__APPLE__)
+  const int64_t refresh_interval_usec =
+      static_cast<int64_t>(FLAGS_hybrid_clock_error_refresh_interval_ms) * 1000;
+  if (PREDICT_TRUE(refresh_interval_usec > 0 && !FLAGS_use_mock_wall_clock)) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    *now_usec = ts.tv_sec * kNanosPerSec + ts.tv_nsec / 1000;
+
+    const uint64_t refresh_usec = error_refresh_usec_.load(std::memory_order_acquire);
+    if (PREDICT_TRUE(*now_usec >= refresh_usec &&
+                     *now_usec - refresh_usec < refresh_interval_usec)) {
+      *error_usec = cached_error_usec_.load(std::memory_order_relaxed) +
+                    MaxErrorGrowthUsec(*now_usec - refresh_usec);
+      return Status::OK();
+    }
+
+    // The cached error expired, or the clock was stepped back. Read the clock from NTP and let
+    // one of the threads that got here publish the result.
+    RETURN_NOT_OK(WalltimeWithError(now_usec, error_usec));
+    std::unique_lock<simple_spinlock> lock(error_refresh_lock_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      cached_error_usec_.store(*error_usec, std::memory_order_relaxed);
+      error_refresh_usec_.store(*now_usec, std::memory_order_release);
+    }
+    return Status::OK();
+  }
+#endif // !defined(__APPLE__)
+  return WalltimeWithError(now_usec, error_usec);
+}
+
 void HybridClock::SetMockClockWallTimeForTests(uint64_t now_usec) {
   CHECK(FLAGS_use_mock_wall_clock);
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -470,8 +493,7 @@ uint64_t HybridClock::ErrorForMetrics() {
   HybridTime now;
   uint64_t error;
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(&now, &error);
+  NowWithError(&now, &error);
   return error;
 }
 
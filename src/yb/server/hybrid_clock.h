@@ -33,6 +33,7 @@
 #ifndef YB_SERVER_HYBRID_CLOCK_H_
 #define YB_SERVER_HYBRID_CLOCK_H_
 
+#include <atomic>
 #include <string>
 #if !defined(__APPLE__)
 #include <sys/timex.h>
@@ -51,6 +52,12 @@ namespace server {
 //
 // HybridTime should not be used on a distributed cluster running on OS X hosts,
 // since NTP clock error is not available.
+//
+// Reading the clock does not take a lock. The physical time is read with clock_gettime(), which
+// is served from the vDSO, and the NTP maximum error is only read with ntp_gettime() every
+// --hybrid_clock_error_refresh_interval_ms. In between the cached error is extrapolated by the
+// maximum rate at which the kernel grows it. The next hybrid time to hand out is kept as a single
+// packed value that is advanced with a compare-and-swap.
 class HybridClock : public Clock {
  public:
   HybridClock();
@@ -133,9 +140,6 @@ class HybridClock : public Clock {
   // error in micros. This may fail if the clock is unsynchronized or synchronized
   // but the error is too high and, since we can't do anything about it,
   // LOG(FATAL)'s in that case.
-  void NowWithErrorUnlocked(HybridTime* hybrid_time, uint64_t* max_error_usec);
-
-  // Variation of above method with locking.
   void NowWithError(HybridTime* hybrid_time, uint64_t* max_error_usec);
 
   virtual std::string Stringify(HybridTime hybrid_time) override;
@@ -208,6 +212,10 @@ class HybridClock : public Clock {
   // On OS X, the error will always be 0.
   CHECKED_STATUS WalltimeWithError(uint64_t* now_usec, uint64_t* error_usec);
 
+  // Same as above, but reads the maximum error from NTP only once per
+  // --hybrid_clock_error_refresh_interval_ms and extrapolates it in between.
+  CHECKED_STATUS WalltimeWithCachedError(uint64_t* now_usec, uint64_t* error_usec);
+
   // Returns Status::OK if the clock error_usec provided is within acceptable limits, otherwise
   // it returns a not OK status if disable_clock_sync_error is not true.
   static CHECKED_STATUS CheckClockSyncError(uint64_t error_usec);
@@ -232,12 +240,20 @@ class HybridClock : public Clock {
 
   double tolerance_adjustment_;
 
+  // Protects the mock clock state.
   mutable simple_spinlock lock_;
 
-  // the last clock read/update, in microseconds.
-  uint64_t last_usec_;
-  // the next logical value to be assigned to a hybrid_time
-  uint64_t next_logical_;
+  // The lowest hybrid time value that may be returned by the next clock read, i.e. one more than
+  // the last returned or updated value.
+  std::atomic<uint64_t> next_hybrid_time_value_{0};
+
+  // The maximum error read from NTP at the wall time error_refresh_usec_. The error is stored
+  // before the time, so a reader that loads the time first never pairs it with an older error.
+  std::atomic<uint64_t> cached_error_usec_{0};
+  std::atomic<uint64_t> error_refresh_usec_{0};
+
+  // Held by the thread that refreshes the cached error.
+  simple_spinlock error_refresh_lock_;
 
   // How many bits to left shift a microseconds clock read. The remainder
   // of the hybrid_time will be reserved for logical values.
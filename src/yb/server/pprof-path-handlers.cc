@@ -63,6 +63,7 @@
 #include "yb/util/env.h"
 #include "yb/util/logging.h"
 #include "yb/util/monotime.h"
+#include "yb/util/sampling_profiler.h"
 #include "yb/util/spinlock_profiling.h"
 #include "yb/util/status.h"
 
@@ -204,6 +205,21 @@ static void PprofContentionHandler(const Webserver::WebRequest& req, stringstrea
 #endif // defined(__linux__)
 }
 
+// Samples of the continuous profiler in the folded format of flame graph tools, e.g.
+// /pprof/flamegraph?type=contention&windows=5. 'type' is 'cpu' (default) or 'contention',
+// 'windows' is the number of the most recent windows to include, all by default.
+static void PprofFlameGraphHandler(const Webserver::WebRequest& req, stringstream* output) {
+  string type = FindWithDefault(req.parsed_args, "type", "cpu");
+  string windows_str = FindWithDefault(req.parsed_args, "windows", "");
+  int32_t windows = ParseLeadingInt32Value(windows_str.c_str(), 0);
+  if (type == "cpu") {
+    DumpContinuousProfile(ProfileType::kCpu, windows, output);
+  } else if (type == "contention") {
+    DumpContinuousProfile(ProfileType::kContention, windows, output);
+  } else {
+    *output << "Unknown profile type: " << type;
+  }
+}
 
 // pprof asks for the url /pprof/symbol to map from hex addresses to variable names.
 // When the server receives a GET request for /pprof/symbol, it should return a line
@@ -267,6 +283,7 @@ void AddPprofPathHandlers(Webserver* webserver) {
   webserver->RegisterPathHandler("/pprof/profile", "", PprofCpuProfileHandler, false, false);
   webserver->RegisterPathHandler("/pprof/symbol", "", PprofSymbolHandler, false, false);
   webserver->RegisterPathHandler("/pprof/contention", "", PprofContentionHandler, false, false);
+  webserver->RegisterPathHandler("/pprof/flamegraph", "", PprofFlameGraphHandler, false, false);
 }
 
 } // namespace yb
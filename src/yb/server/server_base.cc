@@ -67,6 +67,7 @@
 #include "yb/util/net/sockaddr.h"
 #include "yb/util/pb_util.h"
 #include "yb/util/rolling_log.h"
+#include "yb/util/sampling_profiler.h"
 #include "yb/util/spinlock_profiling.h"
 #include "yb/util/thread.h"
 #include "yb/util/version_info.h"
@@ -158,6 +159,7 @@ Status RpcServerBase::Init() {
   RegisterSpinLockContentionMetrics(metric_entity_);
 
   InitSpinLockContentionProfiling();
+  WARN_NOT_OK(StartContinuousProfiling(), "Failed to start continuous profiling");
 
   SetStackTraceSignal(SIGUSR2);
 
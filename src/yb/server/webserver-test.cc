@@ -31,6 +31,7 @@
 //
 
 #include <string>
+#include <thread>
 
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
@@ -40,6 +41,7 @@
 #include "yb/gutil/stringprintf.h"
 #include "yb/server/default-path-handlers.h"
 #include "yb/server/webserver.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/curl_util.h"
 #include "yb/util/net/sockaddr.h"
 #include "yb/util/test_util.h"
@@ -59,6 +61,7 @@ class WebserverTest : public YBTest {
     WebserverOptions opts;
     opts.port = 0;
     opts.doc_root = static_dir_;
+    opts.max_concurrent_expensive_requests = 1;
     server_.reset(new Webserver(opts, "WebserverTest"));
   }
 
@@ -176,4 +179,44 @@ TEST_F(WebserverTest, TestStaticFiles) {
   ASSERT_EQ("Remote error: HTTP 403", s.ToString(/* no file/line */ false));
 }
 
+// Test that requests for expensive pages beyond the limit are rejected, while other pages are
+// still served.
+TEST_F(WebserverTest, TestExpensivePageLimit) {
+  CountDownLatch started(1);
+  CountDownLatch release(1);
+  server_->RegisterPathHandler(
+      "/expensive", "",
+      [&started, &release](const Webserver::WebRequest& req, std::stringstream* output) {
+        started.CountDown();
+        release.Wait();
+        *output << "done";
+      },
+      false /* is_styled */, false /* is_on_nav_bar */, true /* is_expensive */);
+  const string url = strings::Substitute("http://$0/expensive", ToString(addr_));
+
+  Status first_status;
+  faststring first_buf;
+  std::thread first([&url, &first_status, &first_buf] {
+    EasyCurl curl;
+    first_status = curl.FetchURL(url, &first_buf);
+  });
+  started.Wait();
+
+  Status busy_status = curl_.FetchURL(url, &buf_);
+  Status varz_status = curl_.FetchURL(
+      strings::Substitute("http://$0/varz?raw=1", ToString(addr_)), &buf_);
+
+  release.CountDown();
+  first.join();
+
+  ASSERT_EQ("Remote error: HTTP 503", busy_status.ToString(/* no file/line */ false));
+  ASSERT_OK(varz_status);
+  ASSERT_OK(first_status);
+  ASSERT_EQ("done", first_buf.ToString());
+
+  // The page is served again once the previous request is done.
+  ASSERT_OK(curl_.FetchURL(url, &buf_));
+  ASSERT_EQ("done", buf_.ToString());
+}
+
 } // namespace yb
@@ -70,6 +70,7 @@
 #include "yb/gutil/strings/stringpiece.h"
 #include "yb/util/env.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/url-coding.h"
 #include "yb/util/version_info.h"
@@ -362,12 +363,36 @@ int Webserver::RunPathHandler(const PathHandler& handler,
     use_style = false;
   }
 
+  // Worker threads are shared by all pages, so expensive pages are rendered by a limited number
+  // of them at a time. Otherwise a few slow scrapes could take all threads and health checks
+  // would time out waiting for the remaining ones.
+  if (handler.is_expensive()) {
+    if (num_expensive_requests_.fetch_add(1, std::memory_order_acq_rel) >=
+            opts_.max_concurrent_expensive_requests) {
+      num_expensive_requests_.fetch_sub(1, std::memory_order_acq_rel);
+      YB_LOG_EVERY_N_SECS(WARNING, 10)
+          << "Rejected request for " << req.redirect_uri << ": too many concurrent requests "
+          << "for expensive pages";
+      static const char kBusyMessage[] = "Too many concurrent requests, retry later\r\n";
+      sq_printf(connection, "HTTP/1.1 503 Service Unavailable\r\n"
+                "Content-Type: text/plain\r\n"
+                "Retry-After: 1\r\n"
+                "Content-Length: %zd\r\n"
+                "\r\n", sizeof(kBusyMessage) - 1);
+      sq_write(connection, kBusyMessage, sizeof(kBusyMessage) - 1);
+      return 1;
+    }
+  }
+
   stringstream output;
   if (use_style) BootstrapPageHeader(&output);
   for (const PathHandlerCallback& callback_ : handler.callbacks()) {
     callback_(req, &output);
   }
   if (use_style) BootstrapPageFooter(&output);
+  if (handler.is_expensive()) {
+    num_expensive_requests_.fetch_sub(1, std::memory_order_acq_rel);
+  }
 
   string str = output.str();
   // Without styling, render the page as plain text
@@ -389,12 +414,12 @@ int Webserver::RunPathHandler(const PathHandler& handler,
 }
 
 void Webserver::RegisterPathHandler(const string& path, const string& alias,
-    const PathHandlerCallback& callback, bool is_styled, bool is_on_nav_bar) {
+    const PathHandlerCallback& callback, bool is_styled, bool is_on_nav_bar, bool is_expensive) {
   std::lock_guard<boost::shared_mutex> lock(lock_);
   auto it = path_handlers_.find(path);
   if (it == path_handlers_.end()) {
     it = path_handlers_.insert(
-        make_pair(path, new PathHandler(is_styled, is_on_nav_bar, alias))).first;
+        make_pair(path, new PathHandler(is_styled, is_on_nav_bar, is_expensive, alias))).first;
   }
   it->second->AddCallback(callback);
 }
@@ -426,6 +451,7 @@ static const char* const NAVIGATION_BAR_SUFFIX =
 "    <div class='yb-main container-fluid'>";
 
 void Webserver::BootstrapPageHeader(stringstream* output) {
+  boost::shared_lock<boost::shared_mutex> l(lock_);
   (*output) << PAGE_HEADER;
   (*output) << NAVIGATION_BAR_PREFIX;
   for (const PathHandlerMap::value_type& handler : path_handlers_) {
@@ -43,6 +43,7 @@
 #ifndef YB_SERVER_WEBSERVER_H
 #define YB_SERVER_WEBSERVER_H
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
@@ -82,7 +83,8 @@ class Webserver : public WebCallbackRegistry {
 
   virtual void RegisterPathHandler(const std::string& path, const std::string& alias,
                                    const PathHandlerCallback& callback,
-                                   bool is_styled = true, bool is_on_nav_bar = true) override;
+                                   bool is_styled = true, bool is_on_nav_bar = true,
+                                   bool is_expensive = false) override;
 
   // Change the footer HTML to be displayed at the bottom of all styled web pages.
   void set_footer_html(const std::string& html);
@@ -93,9 +95,10 @@ class Webserver : public WebCallbackRegistry {
   // Container class for a list of path handler callbacks for a single URL.
   class PathHandler {
    public:
-    PathHandler(bool is_styled, bool is_on_nav_bar, std::string alias)
+    PathHandler(bool is_styled, bool is_on_nav_bar, bool is_expensive, std::string alias)
         : is_styled_(is_styled),
           is_on_nav_bar_(is_on_nav_bar),
+          is_expensive_(is_expensive),
           alias_(std::move(alias)) {}
 
     void AddCallback(const PathHandlerCallback& callback) {
@@ -104,6 +107,7 @@ class Webserver : public WebCallbackRegistry {
 
     bool is_styled() const { return is_styled_; }
     bool is_on_nav_bar() const { return is_on_nav_bar_; }
+    bool is_expensive() const { return is_expensive_; }
     const std::string& alias() const { return alias_; }
     const std::vector<PathHandlerCallback>& callbacks() const { return callbacks_; }
 
@@ -114,6 +118,9 @@ class Webserver : public WebCallbackRegistry {
     // If true, the page appears in the navigation bar.
     bool is_on_nav_bar_;
 
+    // If true, the number of concurrent requests for the page is limited.
+    bool is_expensive_;
+
     // Alias used when displaying this link on the nav bar.
     std::string alias_;
 
@@ -178,6 +185,9 @@ class Webserver : public WebCallbackRegistry {
 
   // Server name for display purposes
   std::string server_name_;
+
+  // Number of requests for expensive pages being rendered.
+  std::atomic<uint32_t> num_expensive_requests_{0};
 };
 
 } // namespace yb
@@ -82,6 +82,13 @@ DEFINE_int32(webserver_num_worker_threads, 50,
              "Maximum number of threads to start for handling web server requests");
 TAG_FLAG(webserver_num_worker_threads, advanced);
 
+DEFINE_int32(webserver_max_concurrent_expensive_requests, 8,
+             "Maximum number of web server threads rendering expensive pages, like metrics or "
+             "tablet lists, at the same time. Further requests for such pages are rejected with "
+             "503 Service Unavailable, so the other threads stay available for cheap pages and "
+             "health checks");
+TAG_FLAG(webserver_max_concurrent_expensive_requests, advanced);
+
 DEFINE_int32(webserver_port, 0,
              "Port to bind to for the web server");
 TAG_FLAG(webserver_port, stable);
@@ -118,7 +125,8 @@ WebserverOptions::WebserverOptions()
     certificate_file(FLAGS_webserver_certificate_file),
     authentication_domain(FLAGS_webserver_authentication_domain),
     password_file(FLAGS_webserver_password_file),
-    num_worker_threads(FLAGS_webserver_num_worker_threads) {
+    num_worker_threads(FLAGS_webserver_num_worker_threads),
+    max_concurrent_expensive_requests(FLAGS_webserver_max_concurrent_expensive_requests) {
 }
 
 } // namespace yb
@@ -51,6 +51,7 @@ struct WebserverOptions {
   std::string authentication_domain;
   std::string password_file;
   uint32_t num_worker_threads;
+  uint32_t max_concurrent_expensive_requests;
 };
 
 } // namespace yb
@@ -46,7 +46,8 @@ class AbstractTablet {
                                                   const size_t row_count,
                                                   QLResponsePB* response) const = 0;
 
-  virtual void RegisterReaderTimestamp(HybridTime read_point) = 0;
+  // Fails if the history at read_point could already be garbage collected.
+  virtual CHECKED_STATUS RegisterReaderTimestamp(HybridTime read_point) = 0;
   virtual void UnregisterReader(HybridTime read_point) = 0;
   virtual HybridTime SafeTimestampToRead() const = 0;
 
@@ -673,6 +673,25 @@ TEST_F(MvccTest, TestMaxSafeTimeToReadAt) {
   ASSERT_EQ(HybridTime(12), mgr.GetMaxSafeTimeToReadAt());
 }
 
+TEST_F(MvccTest, TestMaxSafeTimeToReadAtOutOfOrderCommit) {
+  MvccManager mgr(clock_.get());
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_EQ(i, mgr.StartOperation().ToUint64());
+  }
+
+  // Transaction 1 is still in flight, so nothing could be read yet.
+  mgr.StartApplyingOperation(HybridTime(2));
+  mgr.CommitOperation(HybridTime(2));
+  ASSERT_EQ(HybridTime::kMin, mgr.GetMaxSafeTimeToReadAt());
+
+  mgr.StartApplyingOperation(HybridTime(1));
+  mgr.CommitOperation(HybridTime(1));
+  ASSERT_EQ(HybridTime(2), mgr.GetMaxSafeTimeToReadAt());
+
+  mgr.AbortOperation(HybridTime(3));
+  ASSERT_LT(HybridTime(3), mgr.GetMaxSafeTimeToReadAt());
+}
+
 
 } // namespace tablet
 } // namespace yb
@@ -42,9 +42,11 @@
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/strcat.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/walltime.h"
 #include "yb/server/logical_clock.h"
 #include "yb/util/countdown_latch.h"
 #include "yb/util/debug/trace_event.h"
+#include "yb/util/spinlock_profiling.h"
 #include "yb/util/stopwatch.h"
 
 namespace yb { namespace tablet {
@@ -155,7 +157,11 @@ bool MvccManager::InitOperationUnlocked(const HybridTime& hybrid_time) {
     earliest_in_flight_ = hybrid_time;
   }
 
-  return InsertIfNotPresent(&hybrid_times_in_flight_, hybrid_time.value(), RESERVED);
+  if (!InsertIfNotPresent(&hybrid_times_in_flight_, hybrid_time.value(), RESERVED)) {
+    return false;
+  }
+  UpdateReadStateUnlocked();
+  return true;
 }
 
 void MvccManager::CommitOperation(HybridTime hybrid_time) {
@@ -174,6 +180,7 @@ void MvccManager::CommitOperation(HybridTime hybrid_time) {
     // the max safe hybrid_time to read.
     AdjustMaxSafetimeToRead();
   }
+  UpdateReadStateUnlocked();
 }
 
 void MvccManager::AbortOperation(HybridTime hybrid_time) {
@@ -189,6 +196,7 @@ void MvccManager::AbortOperation(HybridTime hybrid_time) {
   if (earliest_in_flight_.CompareTo(hybrid_time) == 0) {
     AdvanceEarliestInFlightHybridTime();
   }
+  UpdateReadStateUnlocked();
 }
 
 void MvccManager::OfflineCommitOperation(HybridTime hybrid_time) {
@@ -205,6 +213,7 @@ void MvccManager::OfflineCommitOperation(HybridTime hybrid_time) {
     // the max safe hybrid_time to read.
     AdjustMaxSafetimeToRead();
   }
+  UpdateReadStateUnlocked();
 }
 
 MvccManager::TxnState MvccManager::RemoveInFlightAndGetStateUnlocked(HybridTime ts) {
@@ -263,6 +272,23 @@ void MvccManager::OfflineAdjustSafeTime(HybridTime safe_time) {
   }
 
   AdjustMaxSafetimeToRead();
+  UpdateReadStateUnlocked();
+}
+
+void MvccManager::UpdateReadStateUnlocked() {
+  DCHECK(lock_.is_locked());
+  HybridTime last_committed;
+  if (cur_snap_.is_clean() ||
+      (cur_snap_.committed_hybrid_times_.size() == 1 &&
+       cur_snap_.all_committed_before_.value() == cur_snap_.committed_hybrid_times_.front())) {
+    last_committed = cur_snap_.LastCommittedHybridTime();
+  } else {
+    // Transactions committed out of order, use the conservative value.
+    last_committed = cur_snap_.all_committed_before_.Decremented();
+  }
+  // Readers check the number of in-flight transactions first, so last_committed_ is stored first.
+  last_committed_.store(last_committed.ToUint64(), std::memory_order_release);
+  num_in_flight_.store(hybrid_times_in_flight_.size(), std::memory_order_release);
 }
 
 // Remove any elements from 'v' which are < the given watermark.
@@ -335,7 +361,10 @@ Status MvccManager::WaitUntil(WaitFor wait_for, HybridTime ts,
     if (IsDoneWaitingUnlocked(waiting_state)) return Status::OK();
     waiters_.push_back(&waiting_state);
   }
-  if (waiting_state.latch->WaitUntil(deadline)) {
+  const int64_t wait_start = CycleClock::Now();
+  const bool done = waiting_state.latch->WaitUntil(deadline);
+  SubmitWaitProfileData(this, CycleClock::Now() - wait_start);
+  if (done) {
     return Status::OK();
   }
   // We timed out. We need to clean up our entry in the waiters_ array.
@@ -429,8 +458,7 @@ bool MvccManager::AreAllOperationsCommitted(HybridTime ts) const {
 }
 
 HybridTime MvccManager::GetMaxSafeTimeToReadAt() const {
-  std::lock_guard<LockType> l(lock_);
-  if (hybrid_times_in_flight_.empty()) {
+  if (num_in_flight_.load(std::memory_order_acquire) == 0) {
     // Note(TBD): Until we introduce leader leases or have the read operations go through consensus
     // to register the reads across all the nodes, it is possible that a leadership change could
     // end up bringing up a new leader (who is slightly behind the current leader) that accepts
@@ -443,7 +471,7 @@ HybridTime MvccManager::GetMaxSafeTimeToReadAt() const {
     // a safe time to read at.
     return clock_->Now();
   } else {
-    return cur_snap_.LastCommittedHybridTime();
+    return HybridTime(last_committed_.load(std::memory_order_acquire));
   }
 }
 
@@ -32,6 +32,7 @@
 #ifndef YB_TABLET_MVCC_H_
 #define YB_TABLET_MVCC_H_
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -303,6 +304,7 @@ class MvccManager {
 
   // Returns the earliest possible hybrid_time for an uncommitted transaction.
   // All hybrid_times before this one are guaranteed to be committed.
+  // Does not acquire the lock, so it is cheap to call for every read.
   HybridTime GetMaxSafeTimeToReadAt() const;
 
   // Return the hybrid_times of all transactions which are currently 'APPLYING'
@@ -391,9 +393,20 @@ class MvccManager {
 
   void EnforceInvariantsIfNecessary(const HybridTime& next);
 
+  // Publishes the state used by GetMaxSafeTimeToReadAt, should be invoked after every change of
+  // the in-flight set or of the current snapshot.
+  void UpdateReadStateUnlocked();
+
   typedef simple_spinlock LockType;
   mutable LockType lock_;
 
+  // Copies of the state that is required to compute the safe time to read, so that readers do not
+  // have to acquire lock_. Updated under lock_ by UpdateReadStateUnlocked.
+  // Number of in-flight transactions.
+  std::atomic<size_t> num_in_flight_{0};
+  // Hybrid time below or at which all transactions are committed.
+  std::atomic<HybridTime::val_type> last_committed_{HybridTime::kMin.ToUint64()};
+
   MvccSnapshot cur_snap_;
 
   // The set of hybrid_times corresponding to currently in-flight transactions.
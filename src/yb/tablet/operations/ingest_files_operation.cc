@@ -0,0 +1,81 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#include "yb/tablet/operations/ingest_files_operation.h"
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+
+using namespace std::literals;
+
+namespace yb {
+namespace tablet {
+
+void IngestFilesOperationState::UpdateRequestFromConsensusRound() {
+  request_ = consensus_round()->replicate_msg()->mutable_ingest_files_request();
+}
+
+std::string IngestFilesOperationState::ToString() const {
+  return Format("IngestFilesOperationState [$0]",
+                request_ ? request_->ShortDebugString() : "(none)"s);
+}
+
+consensus::ReplicateMsgPtr IngestFilesOperation::NewReplicateMsg() {
+  auto result = std::make_shared<consensus::ReplicateMsg>();
+  result->set_op_type(consensus::INGEST_FILES_OP);
+  *result->mutable_ingest_files_request() = *state()->request();
+  return result;
+}
+
+Status IngestFilesOperation::Prepare() {
+  if (type() != consensus::LEADER) {
+    return Status::OK();
+  }
+  // Replicas cannot reject the operation once it is replicated, so the files are checked by the
+  // leader before replication. Records after the current time could be written before the hybrid
+  // time of the operation.
+  auto* state = this->state();
+  return state->tablet_peer()->tablet()->ValidateIngestFiles(
+      state->request()->source_dir(), state->tablet_peer()->clock().Now());
+}
+
+void IngestFilesOperation::Start() {
+  if (!state()->has_hybrid_time()) {
+    state()->set_hybrid_time(state()->tablet_peer()->clock().Now());
+  }
+}
+
+Status IngestFilesOperation::Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) {
+  auto* state = this->state();
+  RETURN_NOT_OK(state->tablet_peer()->tablet()->IngestFiles(
+      state->request()->source_dir(), state->op_id()));
+  commit_msg->reset(new consensus::CommitMsg());
+  (*commit_msg)->set_op_type(consensus::INGEST_FILES_OP);
+  return Status::OK();
+}
+
+string IngestFilesOperation::ToString() const {
+  return Format("IngestFilesOperation [state=$0]", state()->ToString());
+}
+
+void IngestFilesOperation::Finish(OperationResult result) {
+  if (result == OperationResult::ABORTED) {
+    LOG(INFO) << "Aborted: " << state()->request()->ShortDebugString();
+  }
+}
+
+} // namespace tablet
+} // namespace yb
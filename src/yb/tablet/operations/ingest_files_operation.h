@@ -0,0 +1,72 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#ifndef YB_TABLET_OPERATIONS_INGEST_FILES_OPERATION_H
+#define YB_TABLET_OPERATIONS_INGEST_FILES_OPERATION_H
+
+#include "yb/tserver/tserver.pb.h"
+
+#include "yb/tablet/operations/operation.h"
+
+namespace yb {
+namespace tablet {
+
+// Adds the SST files of an external RocksDB database to the tablet. Only the location of the
+// files is replicated, every replica hard links the files from the same directory.
+class IngestFilesOperationState : public OperationState {
+ public:
+  IngestFilesOperationState(TabletPeer* tablet_peer, const tserver::IngestFilesRequestPB* request)
+      : OperationState(tablet_peer), request_(request) {}
+
+  explicit IngestFilesOperationState(TabletPeer* tablet_peer)
+      : IngestFilesOperationState(tablet_peer, nullptr) {}
+
+  const tserver::IngestFilesRequestPB* request() const override { return request_; }
+
+  std::string ToString() const override;
+
+ private:
+  void UpdateRequestFromConsensusRound() override;
+
+  const tserver::IngestFilesRequestPB* request_;
+};
+
+class IngestFilesOperation : public Operation {
+ public:
+  IngestFilesOperation(std::unique_ptr<IngestFilesOperationState> state,
+                       consensus::DriverType type)
+      : Operation(std::move(state), type, Operation::INGEST_FILES_TXN) {}
+
+  IngestFilesOperationState* state() override {
+    return down_cast<IngestFilesOperationState*>(Operation::state());
+  }
+
+  const IngestFilesOperationState* state() const override {
+    return down_cast<const IngestFilesOperationState*>(Operation::state());
+  }
+
+ private:
+  consensus::ReplicateMsgPtr NewReplicateMsg() override;
+  CHECKED_STATUS Prepare() override;
+  void Start() override;
+  CHECKED_STATUS Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) override;
+  std::string ToString() const override;
+  void Finish(OperationResult result) override;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_OPERATIONS_INGEST_FILES_OPERATION_H
@@ -75,6 +75,7 @@ class Operation {
     ALTER_SCHEMA_TXN,
     UPDATE_TRANSACTION_TXN,
     SNAPSHOT_TXN,
+    INGEST_FILES_TXN,
 
     kOperationTypes // Must be the last one (number of types above).
   };
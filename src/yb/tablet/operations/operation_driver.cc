@@ -36,15 +36,23 @@
 
 #include "yb/client/client.h"
 #include "yb/consensus/consensus.h"
+#include "yb/gutil/casts.h"
 #include "yb/gutil/strings/strcat.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/operations/operation_tracker.h"
+#include "yb/tablet/operations/write_operation.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/debug/trace_event.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
 
+DEFINE_int32(max_group_apply_batch_size, 16,
+             "Maximum number of committed write operations of a tablet to apply using a single "
+             "RocksDB write. 1 means that every operation is written separately.");
+TAG_FLAG(max_group_apply_batch_size, advanced);
+
 namespace yb {
 namespace tablet {
 
@@ -400,11 +408,21 @@ Status OperationDriver::ApplyAsync() {
   TRACE_EVENT_FLOW_BEGIN0("operation", "ApplyTask", this);
   switch (table_type_) {
     case TableType::YQL_TABLE_TYPE: FALLTHROUGH_INTENDED;
-    case TableType::REDIS_TABLE_TYPE:
+    case TableType::REDIS_TABLE_TYPE: {
       // Key-value tables backed by RocksDB require that we apply changes synchronously to enforce
       // the order.
+      auto* apply_batch = OperationApplyBatch::Current();
+      if (apply_batch) {
+        if (operation_type() == Operation::WRITE_TXN) {
+          apply_batch->Add(this);
+          return Status::OK();
+        }
+        // Other operations should observe the changes of writes committed before them.
+        apply_batch->Flush();
+      }
       ApplyTask();
       return Status::OK();
+    }
     case TableType::KUDU_COLUMNAR_TABLE_TYPE:
       return apply_pool_->SubmitClosure(Bind(&OperationDriver::ApplyTask, Unretained(this)));
   }
@@ -412,7 +430,7 @@ Status OperationDriver::ApplyAsync() {
   return STATUS_FORMAT(IllegalState, "Invalid table type: $0", table_type_);
 }
 
-void OperationDriver::ApplyTask() {
+void OperationDriver::ApplyTask(bool applied_to_tablet) {
   TRACE_EVENT_FLOW_END0("operation", "ApplyTask", this);
   ADOPT_TRACE(trace());
 
@@ -430,7 +448,9 @@ void OperationDriver::ApplyTask() {
 
   {
     gscoped_ptr<CommitMsg> commit_msg;
-    CHECK_OK(operation_->Apply(&commit_msg));
+    if (!applied_to_tablet) {
+      CHECK_OK(operation_->Apply(&commit_msg));
+    }
     if (commit_msg) {
       commit_msg->mutable_commited_op_id()->CopyFrom(op_id_copy_);
     }
@@ -543,5 +563,60 @@ std::string OperationDriver::LogPrefix() const {
                              ts_string);
 }
 
+////////////////////////////////////////////////////////////
+// OperationApplyBatch
+////////////////////////////////////////////////////////////
+
+namespace {
+
+__thread OperationApplyBatch* current_apply_batch = nullptr;
+
+} // namespace
+
+void OperationApplyBatch::Start() {
+  DCHECK(current_apply_batch == nullptr);
+  DCHECK(drivers_.empty());
+  current_apply_batch = this;
+}
+
+void OperationApplyBatch::Finish() {
+  DCHECK_EQ(current_apply_batch, this);
+  Flush();
+  current_apply_batch = nullptr;
+}
+
+OperationApplyBatch* OperationApplyBatch::Current() {
+  return current_apply_batch;
+}
+
+void OperationApplyBatch::Add(OperationDriver* driver) {
+  drivers_.emplace_back(driver);
+  if (drivers_.size() >= static_cast<size_t>(std::max(FLAGS_max_group_apply_batch_size, 1))) {
+    Flush();
+  }
+}
+
+void OperationApplyBatch::Flush() {
+  if (drivers_.empty()) {
+    return;
+  }
+
+  if (drivers_.size() == 1) {
+    drivers_.front()->ApplyTask();
+  } else {
+    std::vector<WriteOperationState*> states;
+    states.reserve(drivers_.size());
+    for (const auto& driver : drivers_) {
+      states.push_back(down_cast<WriteOperationState*>(driver->mutable_state()));
+    }
+    TRACE_EVENT1("operation", "OperationApplyBatch::Flush", "operations", states.size());
+    states.front()->tablet_peer()->tablet()->ApplyRowOperations(states);
+    for (const auto& driver : drivers_) {
+      driver->ApplyTask(true /* applied_to_tablet */);
+    }
+  }
+  drivers_.clear();
+}
+
 }  // namespace tablet
 }  // namespace yb
@@ -34,6 +34,7 @@
 #define YB_TABLET_OPERATIONS_OPERATION_DRIVER_H
 
 #include <string>
+#include <vector>
 
 #include "yb/consensus/consensus.h"
 #include "yb/gutil/ref_counted.h"
@@ -52,6 +53,7 @@ class Log;
 namespace tablet {
 class OperationOrderVerifier;
 class OperationTracker;
+class OperationApplyBatch;
 class OperationDriver;
 class PrepareThread;
 
@@ -203,6 +205,8 @@ class OperationDriver : public RefCountedThreadSafe<OperationDriver>,
 
  private:
   friend class RefCountedThreadSafe<OperationDriver>;
+  friend class OperationApplyBatch;
+
   enum ReplicationState {
     // The operation has not yet been sent to consensus for replication
     NOT_REPLICATING,
@@ -232,7 +236,9 @@ class OperationDriver : public RefCountedThreadSafe<OperationDriver>,
 
   // Calls Operation::Apply() followed by Consensus::Commit() with the
   // results from the Apply().
-  void ApplyTask();
+  // applied_to_tablet - Operation::Apply() is skipped, because changes of this operation were
+  // already applied to the tablet by OperationApplyBatch.
+  void ApplyTask(bool applied_to_tablet = false);
 
   // Sleeps until the operation is allowed to commit based on the
   // requested consistency mode.
@@ -295,6 +301,38 @@ class OperationDriver : public RefCountedThreadSafe<OperationDriver>,
   DISALLOW_COPY_AND_ASSIGN(OperationDriver);
 };
 
+// Collects write operations of key-value tablets that are ready to be applied on the current
+// thread between Start() and Finish(), so that their changes are written to RocksDB in a single
+// write batch. Operations of other types are applied immediately, after all collected writes.
+//
+// Consensus applies committed operations one by one while holding its lock, so merging the
+// writes of a group of committed operations saves a RocksDB write per operation.
+class OperationApplyBatch {
+ public:
+  OperationApplyBatch() {}
+
+  // Makes this batch current for the calling thread.
+  void Start();
+
+  // Applies collected operations and resets the current batch of the calling thread.
+  void Finish();
+
+  // Returns the batch started by the calling thread, nullptr if there is none.
+  static OperationApplyBatch* Current();
+
+ private:
+  friend class OperationDriver;
+
+  void Add(OperationDriver* driver);
+
+  // Applies collected operations.
+  void Flush();
+
+  std::vector<scoped_refptr<OperationDriver>> drivers_;
+
+  DISALLOW_COPY_AND_ASSIGN(OperationApplyBatch);
+};
+
 }  // namespace tablet
 }  // namespace yb
 
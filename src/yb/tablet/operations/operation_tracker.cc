@@ -75,6 +75,10 @@ METRIC_DEFINE_gauge_uint64(tablet, snapshot_operations_inflight,
                            "Snapshot Operations In Flight",
                            yb::MetricUnit::kOperations,
                            "Number of snapshot operations currently in-flight");
+METRIC_DEFINE_gauge_uint64(tablet, ingest_files_operations_inflight,
+                           "Ingest Files Operations In Flight",
+                           yb::MetricUnit::kOperations,
+                           "Number of ingest files operations currently in-flight");
 
 METRIC_DEFINE_counter(tablet, operation_memory_pressure_rejections,
                       "Operation Memory Pressure Rejections",
@@ -103,7 +107,9 @@ OperationTracker::Metrics::Metrics(const scoped_refptr<MetricEntity>& entity)
       METRIC_update_transaction_operations_inflight.Instantiate(entity, 0);
   operations_inflight[Operation::SNAPSHOT_TXN] =
       METRIC_snapshot_operations_inflight.Instantiate(entity, 0);
-  static_assert(4 == Operation::kOperationTypes, "Init metrics for all operation types");
+  operations_inflight[Operation::INGEST_FILES_TXN] =
+      METRIC_ingest_files_operations_inflight.Instantiate(entity, 0);
+  static_assert(5 == Operation::kOperationTypes, "Init metrics for all operation types");
 }
 #undef GINIT
 #undef MINIT
@@ -0,0 +1,114 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#include "yb/tablet/operations/snapshot_operation.h"
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/fs/fs_manager.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/util/env.h"
+
+using namespace std::literals;
+
+namespace yb {
+namespace tablet {
+
+using tserver::TabletSnapshotOpRequestPB;
+
+void SnapshotOperationState::UpdateRequestFromConsensusRound() {
+  request_ = consensus_round()->replicate_msg()->mutable_snapshot_request();
+}
+
+Status SnapshotOperationState::Apply(Tablet* tablet) {
+  const auto& snapshot_id = request_->snapshot_id();
+  switch (request_->operation()) {
+    case TabletSnapshotOpRequestPB::CREATE_ON_TABLET:
+      return tablet->CreateSnapshot(snapshot_id);
+    case TabletSnapshotOpRequestPB::RESTORE_ON_TABLET:
+      return tablet->RestoreSnapshot(snapshot_id, op_id());
+    case TabletSnapshotOpRequestPB::DELETE_ON_TABLET:
+      return tablet->DeleteSnapshot(snapshot_id);
+    case TabletSnapshotOpRequestPB::UNKNOWN:
+      break;
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown snapshot operation: $0", request_->operation());
+}
+
+std::string SnapshotOperationState::ToString() const {
+  return Format("SnapshotOperationState [$0]",
+                request_ ? request_->ShortDebugString() : "(none)"s);
+}
+
+consensus::ReplicateMsgPtr SnapshotOperation::NewReplicateMsg() {
+  auto result = std::make_shared<consensus::ReplicateMsg>();
+  result->set_op_type(consensus::SNAPSHOT_OP);
+  *result->mutable_snapshot_request() = *state()->request();
+  return result;
+}
+
+Status SnapshotOperation::Prepare() {
+  if (type() != consensus::LEADER) {
+    return Status::OK();
+  }
+  // Replicas cannot reject the operation once it is replicated, so the leader checks the request.
+  const auto* request = state()->request();
+  if (request->snapshot_id().empty()) {
+    return STATUS(InvalidArgument, "Snapshot id is not specified");
+  }
+  switch (request->operation()) {
+    case TabletSnapshotOpRequestPB::CREATE_ON_TABLET: FALLTHROUGH_INTENDED;
+    case TabletSnapshotOpRequestPB::DELETE_ON_TABLET:
+      return Status::OK();
+    case TabletSnapshotOpRequestPB::RESTORE_ON_TABLET: {
+      auto* tablet = state()->tablet_peer()->tablet();
+      const auto snapshot_dir = tablet->SnapshotDir(request->snapshot_id());
+      if (!tablet->metadata()->fs_manager()->env()->FileExists(snapshot_dir)) {
+        return STATUS_FORMAT(NotFound, "Snapshot $0 not found", request->snapshot_id());
+      }
+      return Status::OK();
+    }
+    case TabletSnapshotOpRequestPB::UNKNOWN:
+      break;
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown snapshot operation: $0", request->operation());
+}
+
+void SnapshotOperation::Start() {
+  if (!state()->has_hybrid_time()) {
+    state()->set_hybrid_time(state()->tablet_peer()->clock().Now());
+  }
+}
+
+Status SnapshotOperation::Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) {
+  auto* state = this->state();
+  RETURN_NOT_OK(state->Apply(state->tablet_peer()->tablet()));
+  commit_msg->reset(new consensus::CommitMsg());
+  (*commit_msg)->set_op_type(consensus::SNAPSHOT_OP);
+  return Status::OK();
+}
+
+string SnapshotOperation::ToString() const {
+  return Format("SnapshotOperation [state=$0]", state()->ToString());
+}
+
+void SnapshotOperation::Finish(OperationResult result) {
+  if (result == OperationResult::ABORTED) {
+    LOG(INFO) << "Aborted: " << state()->request()->ShortDebugString();
+  }
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,76 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#ifndef YB_TABLET_OPERATIONS_SNAPSHOT_OPERATION_H
+#define YB_TABLET_OPERATIONS_SNAPSHOT_OPERATION_H
+
+#include "yb/tserver/backup.pb.h"
+
+#include "yb/tablet/operations/operation.h"
+
+namespace yb {
+namespace tablet {
+
+class Tablet;
+
+// Creates, restores or deletes a snapshot of the tablet, see Tablet::CreateSnapshot.
+class SnapshotOperationState : public OperationState {
+ public:
+  SnapshotOperationState(TabletPeer* tablet_peer,
+                         const tserver::TabletSnapshotOpRequestPB* request)
+      : OperationState(tablet_peer), request_(request) {}
+
+  explicit SnapshotOperationState(TabletPeer* tablet_peer)
+      : SnapshotOperationState(tablet_peer, nullptr) {}
+
+  const tserver::TabletSnapshotOpRequestPB* request() const override { return request_; }
+
+  // Performs the requested operation on the tablet, also used by bootstrap.
+  CHECKED_STATUS Apply(Tablet* tablet);
+
+  std::string ToString() const override;
+
+ private:
+  void UpdateRequestFromConsensusRound() override;
+
+  const tserver::TabletSnapshotOpRequestPB* request_;
+};
+
+class SnapshotOperation : public Operation {
+ public:
+  SnapshotOperation(std::unique_ptr<SnapshotOperationState> state, consensus::DriverType type)
+      : Operation(std::move(state), type, Operation::SNAPSHOT_TXN) {}
+
+  SnapshotOperationState* state() override {
+    return down_cast<SnapshotOperationState*>(Operation::state());
+  }
+
+  const SnapshotOperationState* state() const override {
+    return down_cast<const SnapshotOperationState*>(Operation::state());
+  }
+
+ private:
+  consensus::ReplicateMsgPtr NewReplicateMsg() override;
+  CHECKED_STATUS Prepare() override;
+  void Start() override;
+  CHECKED_STATUS Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) override;
+  std::string ToString() const override;
+  void Finish(OperationResult result) override;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_OPERATIONS_SNAPSHOT_OPERATION_H
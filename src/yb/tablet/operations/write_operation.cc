@@ -244,6 +244,17 @@ WriteOperationState::WriteOperationState(TabletPeer* tablet_peer,
   }
 }
 
+WriteOperationState::WriteOperationState(TabletPeer* tablet_peer,
+                                         std::unique_ptr<tserver::WriteRequestPB> request,
+                                         tserver::WriteResponsePB *response)
+    : OperationState(tablet_peer),
+      request_(request.release()),
+      response_(response),
+      mvcc_tx_(nullptr),
+      schema_at_decode_time_(nullptr) {
+  external_consistency_mode_ = request_->external_consistency_mode();
+}
+
 void WriteOperationState::SetMvccTxAndHybridTime(std::unique_ptr<ScopedWriteOperation> mvcc_tx) {
   DCHECK(!mvcc_tx_) << "Mvcc operation already started/set.";
   if (has_hybrid_time()) {
@@ -103,6 +103,11 @@ class WriteOperationState : public OperationState {
   WriteOperationState(TabletPeer* tablet_peer = nullptr,
                       const tserver::WriteRequestPB *request = nullptr,
                       tserver::WriteResponsePB *response = nullptr);
+  // Takes the request instead of copying it, so that the payload of a client write is not copied
+  // on its way to the replicate message.
+  WriteOperationState(TabletPeer* tablet_peer,
+                      std::unique_ptr<tserver::WriteRequestPB> request,
+                      tserver::WriteResponsePB *response);
   virtual ~WriteOperationState();
 
   // Returns the result of this transaction in its protocol buffers form.
@@ -231,7 +236,7 @@ class WriteOperationState : public OperationState {
  private:
   // Reset the response, and row_ops_ (which refers to data
   // from the request). Request is owned by WriteOperation using a unique_ptr.
-  // A copy is made at initialization, so we don't need to reset it.
+  // A copy is made or taken at initialization, so we don't need to reset it.
   void ResetRpcFields();
 
   // Sets mvcc_tx_ to nullptr after commit/abort in a thread-safe manner.
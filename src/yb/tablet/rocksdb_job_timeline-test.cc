@@ -0,0 +1,90 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include "yb/tablet/rocksdb_job_timeline.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(tablet_rocksdb_job_timeline_size);
+
+namespace yb {
+namespace tablet {
+
+class RocksDBJobTimelineTest : public YBTest {
+};
+
+TEST_F(RocksDBJobTimelineTest, FlushesAndCompactions) {
+  RocksDBJobTimeline timeline;
+
+  rocksdb::FlushJobInfo flush;
+  flush.elapsed_micros = 1500;
+  flush.input_bytes = 4096;
+  flush.output_bytes = 1024;
+  timeline.OnFlushCompleted(nullptr, flush);
+
+  rocksdb::CompactionJobInfo compaction;
+  compaction.base_input_level = 0;
+  compaction.output_level = 1;
+  compaction.compaction_reason = rocksdb::CompactionReason::kLevelL0FilesNum;
+  compaction.stats.elapsed_micros = 20000;
+  compaction.stats.num_input_files = 4;
+  compaction.stats.num_output_files = 1;
+  compaction.stats.total_input_bytes = 4096;
+  compaction.stats.total_output_bytes = 3000;
+  timeline.OnCompactionCompleted(nullptr, compaction);
+
+  const auto jobs = timeline.Jobs();
+  ASSERT_EQ(2U, jobs.size());
+  ASSERT_EQ(RocksDBJob::Type::kFlush, jobs[0].type);
+  ASSERT_EQ(-1, jobs[0].input_level);
+  ASSERT_EQ(0, jobs[0].output_level);
+  ASSERT_EQ(1500U, jobs[0].elapsed_micros);
+  ASSERT_EQ(4096U, jobs[0].input_bytes);
+  ASSERT_EQ(1024U, jobs[0].output_bytes);
+
+  ASSERT_EQ(RocksDBJob::Type::kCompaction, jobs[1].type);
+  ASSERT_EQ(0, jobs[1].input_level);
+  ASSERT_EQ(1, jobs[1].output_level);
+  ASSERT_EQ(4U, jobs[1].num_input_files);
+  ASSERT_EQ(3000U, jobs[1].output_bytes);
+  ASSERT_EQ("level 0 files", jobs[1].reason);
+  ASSERT_EQ("OK", jobs[1].status);
+  ASSERT_EQ("compaction 0 -> 1 in 20.000 ms, 4 files 4096 bytes -> 1 files 3000 bytes "
+            "(level 0 files): OK", jobs[1].ToString());
+
+  std::stringstream html;
+  timeline.HtmlOutput(&html);
+  // Most recent first.
+  ASSERT_LT(html.str().find("compaction"), html.str().find("flush"));
+}
+
+TEST_F(RocksDBJobTimelineTest, Bounded) {
+  FLAGS_tablet_rocksdb_job_timeline_size = 3;
+  RocksDBJobTimeline timeline;
+  for (uint64_t i = 0; i != 5; ++i) {
+    RocksDBJob job;
+    job.elapsed_micros = i;
+    timeline.Record(job);
+  }
+  const auto jobs = timeline.Jobs();
+  ASSERT_EQ(3U, jobs.size());
+  ASSERT_EQ(2U, jobs.front().elapsed_micros);
+  ASSERT_EQ(4U, jobs.back().elapsed_micros);
+}
+
+}  // namespace tablet
+}  // namespace yb
@@ -0,0 +1,163 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/rocksdb_job_timeline.h"
+
+#include <algorithm>
+
+#include "yb/gutil/stringprintf.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/walltime.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/url-coding.h"
+
+DEFINE_int32(tablet_rocksdb_job_timeline_size, 100,
+             "Number of most recent flushes and compactions kept in the RocksDB job timeline of "
+             "each tablet.");
+TAG_FLAG(tablet_rocksdb_job_timeline_size, advanced);
+TAG_FLAG(tablet_rocksdb_job_timeline_size, runtime);
+
+namespace yb {
+namespace tablet {
+
+using strings::Substitute;
+
+namespace {
+
+const char* CompactionReasonToString(rocksdb::CompactionReason reason) {
+  switch (reason) {
+    case rocksdb::CompactionReason::kUnknown:
+      return "unknown";
+    case rocksdb::CompactionReason::kLevelL0FilesNum:
+      return "level 0 files";
+    case rocksdb::CompactionReason::kLevelMaxLevelSize:
+      return "level size";
+    case rocksdb::CompactionReason::kUniversalSizeAmplification:
+      return "size amplification";
+    case rocksdb::CompactionReason::kUniversalSizeRatio:
+      return "size ratio";
+    case rocksdb::CompactionReason::kUniversalSortedRunNum:
+      return "sorted runs";
+    case rocksdb::CompactionReason::kFIFOMaxSize:
+      return "FIFO size";
+    case rocksdb::CompactionReason::kManualCompaction:
+      return "manual";
+    case rocksdb::CompactionReason::kFilesMarkedForCompaction:
+      return "files marked for compaction";
+    case rocksdb::CompactionReason::kUniversalDiscardedFiles:
+      return "discarded files";
+  }
+  return "unknown";
+}
+
+const char* JobTypeToString(RocksDBJob::Type type) {
+  switch (type) {
+    case RocksDBJob::Type::kFlush:
+      return "flush";
+    case RocksDBJob::Type::kCompaction:
+      return "compaction";
+  }
+  return "unknown";
+}
+
+std::string FormatMillis(uint64_t micros) {
+  return StringPrintf("%.3f", micros / 1000.0);
+}
+
+std::string FormatTime(int64_t time_us) {
+  std::string result;
+  StringAppendStrftime(&result, "%Y-%m-%d %H:%M:%S", time_us / 1000000, true /* local */);
+  return result;
+}
+
+std::string FormatLevel(int level) {
+  return level < 0 ? "memtable" : std::to_string(level);
+}
+
+} // namespace
+
+std::string RocksDBJob::ToString() const {
+  return Substitute(
+      "$0 $1 -> $2 in $3 ms, $4 files $5 bytes -> $6 files $7 bytes$8: $9",
+      JobTypeToString(type), FormatLevel(input_level), FormatLevel(output_level),
+      FormatMillis(elapsed_micros), num_input_files, input_bytes, num_output_files, output_bytes,
+      reason.empty() ? "" : " (" + reason + ")", status);
+}
+
+void RocksDBJobTimeline::OnFlushCompleted(rocksdb::DB* db, const rocksdb::FlushJobInfo& info) {
+  RocksDBJob job;
+  job.type = RocksDBJob::Type::kFlush;
+  job.end_time_us = GetCurrentTimeMicros();
+  job.elapsed_micros = info.elapsed_micros;
+  job.input_level = -1;
+  job.output_level = 0;
+  job.num_output_files = 1;
+  job.input_bytes = info.input_bytes;
+  job.output_bytes = info.output_bytes;
+  job.status = "OK";
+  Record(std::move(job));
+}
+
+void RocksDBJobTimeline::OnCompactionCompleted(
+    rocksdb::DB* db, const rocksdb::CompactionJobInfo& info) {
+  RocksDBJob job;
+  job.type = RocksDBJob::Type::kCompaction;
+  job.end_time_us = GetCurrentTimeMicros();
+  job.elapsed_micros = info.stats.elapsed_micros;
+  job.input_level = info.base_input_level;
+  job.output_level = info.output_level;
+  job.num_input_files = info.stats.num_input_files;
+  job.num_output_files = info.stats.num_output_files;
+  job.input_bytes = info.stats.total_input_bytes;
+  job.output_bytes = info.stats.total_output_bytes;
+  job.reason = CompactionReasonToString(info.compaction_reason);
+  job.status = info.status.ToString();
+  Record(std::move(job));
+}
+
+void RocksDBJobTimeline::Record(RocksDBJob job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  jobs_.push_back(std::move(job));
+  const size_t max_size = std::max(FLAGS_tablet_rocksdb_job_timeline_size, 0);
+  while (jobs_.size() > max_size) {
+    jobs_.pop_front();
+  }
+}
+
+std::vector<RocksDBJob> RocksDBJobTimeline::Jobs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<RocksDBJob>(jobs_.begin(), jobs_.end());
+}
+
+void RocksDBJobTimeline::HtmlOutput(std::stringstream* output) const {
+  const std::vector<RocksDBJob> jobs = Jobs();
+  *output << "<table class='table table-striped'>\n";
+  *output << "  <tr><th>End Time</th><th>Job</th><th>Reason</th><th>Levels</th>"
+          << "<th>Duration (ms)</th><th>Input Files</th><th>Input Bytes</th>"
+          << "<th>Output Files</th><th>Output Bytes</th><th>Status</th></tr>\n";
+  for (auto it = jobs.rbegin(); it != jobs.rend(); ++it) {
+    *output << Substitute(
+        "  <tr><td>$0</td><td>$1</td><td>$2</td><td>$3 &rarr; $4</td><td>$5</td><td>$6</td>"
+        "<td>$7</td><td>$8</td><td>$9</td>",
+        FormatTime(it->end_time_us), JobTypeToString(it->type), EscapeForHtmlToString(it->reason),
+        FormatLevel(it->input_level), FormatLevel(it->output_level),
+        FormatMillis(it->elapsed_micros), it->num_input_files, it->input_bytes,
+        it->num_output_files);
+    *output << Substitute(
+        "<td>$0</td><td>$1</td></tr>\n", it->output_bytes, EscapeForHtmlToString(it->status));
+  }
+  *output << "</table>\n";
+}
+
+}  // namespace tablet
+}  // namespace yb
@@ -0,0 +1,87 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TABLET_ROCKSDB_JOB_TIMELINE_H_
+#define YB_TABLET_ROCKSDB_JOB_TIMELINE_H_
+
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/rocksdb/listener.h"
+
+namespace yb {
+namespace tablet {
+
+// A flush or compaction of the RocksDB instance of a tablet.
+struct RocksDBJob {
+  enum class Type {
+    kFlush,
+    kCompaction,
+  };
+
+  Type type = Type::kFlush;
+  // Wall clock time at which the job completed, in microseconds since the epoch.
+  int64_t end_time_us = 0;
+  uint64_t elapsed_micros = 0;
+  // Levels the job read from and wrote to. Flushes read the memtables, which are level -1.
+  int input_level = -1;
+  int output_level = 0;
+  size_t num_input_files = 0;
+  size_t num_output_files = 0;
+  // Flushes read the memtables, their input is the memory the memtables used.
+  uint64_t input_bytes = 0;
+  uint64_t output_bytes = 0;
+  // Why the compaction was run, empty for flushes.
+  std::string reason;
+  // Failed compactions are recorded too, flushes only when they succeed.
+  std::string status;
+
+  std::string ToString() const;
+};
+
+// Bounded timeline of the most recent flushes and compactions of the RocksDB instance of a tablet,
+// with their bytes in and out and duration, to tell which of them a latency regression coincides
+// with. The timeline is not kept across restarts.
+//
+// This class is thread-safe.
+class RocksDBJobTimeline : public rocksdb::EventListener {
+ public:
+  RocksDBJobTimeline() {}
+
+  void OnFlushCompleted(rocksdb::DB* db, const rocksdb::FlushJobInfo& info) override;
+
+  void OnCompactionCompleted(rocksdb::DB* db, const rocksdb::CompactionJobInfo& info) override;
+
+  void Record(RocksDBJob job);
+
+  // Returns the recorded jobs, oldest first.
+  std::vector<RocksDBJob> Jobs() const;
+
+  // Writes the recorded jobs as an HTML table, most recent first.
+  void HtmlOutput(std::stringstream* output) const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<RocksDBJob> jobs_;
+
+  DISALLOW_COPY_AND_ASSIGN(RocksDBJobTimeline);
+};
+
+}  // namespace tablet
+}  // namespace yb
+
+#endif  // YB_TABLET_ROCKSDB_JOB_TIMELINE_H_
@@ -267,6 +267,24 @@ TYPED_TEST(TestTablet, TestMetricsInit) {
   ASSERT_OK(registry->WriteAsJson(&writer, { "*" }, MetricJsonOptions()));
 }
 
+// Test that the history cutoff does not pass active reads, and that reads before it are rejected.
+TYPED_TEST(TestTablet, TestHistoryCutoff) {
+  Tablet* tablet = this->tablet().get();
+  ScopedReadOperation read_op(tablet);
+  ASSERT_OK(read_op.status());
+  const HybridTime read_time = read_op.GetReadTimestamp();
+
+  ASSERT_EQ(read_time, tablet->UpdateHistoryCutoff(HybridTime::kMax));
+  // The cutoff never goes back.
+  ASSERT_EQ(read_time, tablet->UpdateHistoryCutoff(HybridTime::kMin));
+
+  ScopedReadOperation old_read_op(tablet, read_time.Decremented());
+  ASSERT_TRUE(old_read_op.status().IsTryAgain()) << old_read_op.status();
+  ScopedReadOperation new_read_op(tablet);
+  ASSERT_OK(new_read_op.status());
+  ASSERT_GE(new_read_op.GetReadTimestamp(), read_time);
+}
+
 // Test that we find the correct log segment size for different indexes.
 TEST(TestTablet, TestGetLogRetentionSizeForIndex) {
   std::map<int64_t, int64_t> idx_size_map;
@@ -48,6 +48,7 @@
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/statistics.h"
+#include "yb/rocksdb/util/file_util.h"
 #include "yb/rocksdb/utilities/checkpoint.h"
 #include "yb/rocksdb/write_batch.h"
 
@@ -64,20 +65,28 @@
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/opid_util.h"
 
+#include "yb/docdb/columnar_snapshot.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/docdb_compaction_filter.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/docdb_util.h"
+#include "yb/docdb/expiration_index.h"
 #include "yb/docdb/intent.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/lock_batch.h"
+#include "yb/docdb/document_cache.h"
+#include "yb/docdb/redis_value_cache.h"
 
 #include "yb/gutil/atomicops.h"
+#include "yb/gutil/endian.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
+#include "yb/gutil/strings/join.h"
 #include "yb/gutil/strings/numbers.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/strings/util.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
@@ -88,6 +97,7 @@
 #include "yb/tablet/diskrowset.h"
 #include "yb/tablet/key_value_iterator.h"
 #include "yb/tablet/maintenance_manager.h"
+#include "yb/tablet/rocksdb_job_timeline.h"
 #include "yb/tablet/row_op.h"
 #include "yb/tablet/rowset_info.h"
 #include "yb/tablet/rowset_tree.h"
@@ -100,6 +110,7 @@
 #include "yb/tablet/operations/alter_schema_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/tablet/tablet_options.h"
+#include "yb/util/atomic.h"
 #include "yb/util/bloom_filter.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/enums.h"
@@ -109,6 +120,8 @@
 #include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/path_util.h"
+#include "yb/util/random_util.h"
 #include "yb/util/slice.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/string_packer.h"
@@ -135,6 +148,75 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.01f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_bool(redis_tablet_use_hash_memtable, false,
+            "Use a hash based memtable, keyed on the hashed part of the document key, for the "
+            "tablets of Redis tables, which are accessed by point lookups of single keys.");
+TAG_FLAG(redis_tablet_use_hash_memtable, advanced);
+
+DEFINE_int32(redis_tablet_value_cache_size_bytes, 1024 * 1024,
+             "Size of the per tablet cache of the latest values of recently written Redis string "
+             "keys, used by read-modify-write commands like INCR and APPEND instead of reading the "
+             "value from RocksDB. 0 to disable.");
+TAG_FLAG(redis_tablet_value_cache_size_bytes, advanced);
+
+DEFINE_int32(redis_tablet_document_cache_size_bytes, 4 * 1024 * 1024,
+             "Size of the per tablet cache of small Redis hashes and sets, used by reads of whole "
+             "collections and of their fields instead of reading them from RocksDB. 0 to disable.");
+TAG_FLAG(redis_tablet_document_cache_size_bytes, advanced);
+
+DEFINE_bool(tablet_columnar_snapshots, false,
+            "Build a columnar snapshot of the rows of a QL tablet after each major compaction, and "
+            "serve scans without hashed key predicates from it until the tablet is written to "
+            "again. For tables that are loaded once and then scanned by analytic queries.");
+TAG_FLAG(tablet_columnar_snapshots, advanced);
+TAG_FLAG(tablet_columnar_snapshots, runtime);
+
+DEFINE_bool(tablet_delete_expired_sst_files, true,
+            "Delete the oldest SST files of a tablet without compacting them, once all their "
+            "records have expired or are deletes older than the history cutoff.");
+TAG_FLAG(tablet_delete_expired_sst_files, advanced);
+
+DEFINE_int32(transaction_apply_batch_size_bytes, 4 * 1024 * 1024,
+             "Approximate size of intents of a committed transaction that are converted to regular "
+             "records using a single RocksDB write batch. Big transactions are applied using "
+             "several batches.");
+TAG_FLAG(transaction_apply_batch_size_bytes, advanced);
+
+DEFINE_int32(transaction_conflict_max_wait_ms, 100,
+             "Maximal time that a write waits for completion of conflicting transactions with "
+             "higher priority, before it fails with conflict. 0 to fail immediately.");
+TAG_FLAG(transaction_conflict_max_wait_ms, advanced);
+TAG_FLAG(transaction_conflict_max_wait_ms, runtime);
+
+DEFINE_bool(rocksdb_stripe_sst_files_across_data_dirs, false,
+            "Let the SST files of a new tablet span all data directories instead of only the one "
+            "the tablet was placed in. Once the tablet's data directory holds "
+            "--rocksdb_sst_stripe_dir_target_size_bytes of files, larger compaction outputs go to "
+            "the other data directories.");
+TAG_FLAG(rocksdb_stripe_sst_files_across_data_dirs, advanced);
+
+DEFINE_uint64(rocksdb_sst_stripe_dir_target_size_bytes, 64ULL * 1024 * 1024 * 1024,
+              "Size of the SST files of a tablet to keep in each of its data directories before "
+              "placing files in the next one, see --rocksdb_stripe_sst_files_across_data_dirs.");
+TAG_FLAG(rocksdb_sst_stripe_dir_target_size_bytes, advanced);
+
+DEFINE_int32(tablet_hot_key_sample_rate, 100,
+             "Track the key of one in this many reads and writes of a key-value tablet to find its "
+             "hot keys. 0 disables tracking.");
+TAG_FLAG(tablet_hot_key_sample_rate, advanced);
+TAG_FLAG(tablet_hot_key_sample_rate, runtime);
+
+DEFINE_int32(tablet_hot_key_capacity, 32,
+             "Number of keys each hot key sketch of a tablet monitors. Any key accessed by more "
+             "than 1 / capacity of the sampled operations is monitored.");
+TAG_FLAG(tablet_hot_key_capacity, advanced);
+
+DEFINE_int32(tablet_hot_key_window, 100000,
+             "Number of sampled operations after which a hot key sketch of a tablet starts over, "
+             "so that it reflects recent load.");
+TAG_FLAG(tablet_hot_key_window, advanced);
+TAG_FLAG(tablet_hot_key_window, runtime);
+
 METRIC_DEFINE_entity(tablet);
 METRIC_DEFINE_gauge_size(tablet, memrowset_size, "MemRowSet Memory Usage",
                          yb::MetricUnit::kBytes,
@@ -142,6 +224,29 @@ METRIC_DEFINE_gauge_size(tablet, memrowset_size, "MemRowSet Memory Usage",
 METRIC_DEFINE_gauge_size(tablet, on_disk_size, "Tablet Size On Disk",
                          yb::MetricUnit::kBytes,
                          "Size of this tablet on disk.");
+METRIC_DEFINE_gauge_uint64(tablet, hot_read_key_percentage, "Hot Read Key Percentage",
+                           yb::MetricUnit::kUnits,
+                           "Percentage of the recently sampled reads of this tablet that accessed "
+                           "its most frequently read key.");
+METRIC_DEFINE_gauge_uint64(tablet, hot_write_key_percentage, "Hot Write Key Percentage",
+                           yb::MetricUnit::kUnits,
+                           "Percentage of the recently sampled writes of this tablet that accessed "
+                           "its most frequently written key.");
+METRIC_DEFINE_gauge_uint64(tablet, rocksdb_num_level0_files, "RocksDB Level 0 Files",
+                           yb::MetricUnit::kUnits,
+                           "Number of level 0 SST files of this tablet, which RocksDB slows down "
+                           "and stops writes on when compactions fall behind.");
+METRIC_DEFINE_gauge_uint64(tablet, rocksdb_pending_compaction_bytes,
+                           "RocksDB Pending Compaction Bytes", yb::MetricUnit::kBytes,
+                           "Estimated number of bytes compactions of this tablet need to rewrite "
+                           "to bring its levels under their target sizes.");
+METRIC_DEFINE_gauge_uint64(tablet, rocksdb_read_amplification, "RocksDB Read Amplification",
+                           yb::MetricUnit::kUnits,
+                           "Number of sorted runs a read of this tablet could look into: the level "
+                           "0 SST files and the non-empty deeper levels.");
+METRIC_DEFINE_gauge_uint64(tablet, rocksdb_num_immutable_memtables,
+                           "RocksDB Immutable MemTables", yb::MetricUnit::kUnits,
+                           "Number of memtables of this tablet waiting to be flushed.");
 
 using namespace std::placeholders;
 
@@ -180,6 +285,13 @@ using yb::docdb::KeyToIntentTypeMap;
   ScopedPendingOperation shutdown_guard(&pending_op_counter_);
 
 namespace yb {
+
+namespace docdb {
+
+Status GetDocHybridTime(const rocksdb::UserBoundaryValues& values, DocHybridTime* out);
+
+} // namespace docdb
+
 namespace tablet {
 
 using yb::MaintenanceManager;
@@ -271,34 +383,89 @@ void EmitRocksDbMetricsAsJson(
 CHECKED_STATUS EmitRocksDbMetricsAsPrometheus(
     std::shared_ptr<rocksdb::Statistics> rocksdb_statistics,
     PrometheusWriter* writer,
-    const MetricEntity::AttributeMap& attrs) {
+    const PrometheusEntityLabels& labels) {
   // Make sure the class member 'rocksdb_statistics_' exists, as this is the stats object
   // maintained by RocksDB for this tablet.
   if (rocksdb_statistics == nullptr) {
     return Status::OK();
   }
   // Emit all the ticker (gauge) metrics.
-  for (std::pair<rocksdb::Tickers, std::string> entry : rocksdb::TickersNameMap) {
+  for (const auto& entry : rocksdb::TickersNameMap) {
     RETURN_NOT_OK(writer->WriteSingleEntry(
-        attrs, entry.second, rocksdb_statistics->getTickerCount(entry.first)));
+        labels, entry.second.c_str(), rocksdb_statistics->getTickerCount(entry.first)));
   }
   // Emit all the histogram metrics.
   rocksdb::HistogramData histogram_data;
-  for (std::pair<rocksdb::Histograms, std::string> entry : rocksdb::HistogramsNameMap) {
+  for (const auto& entry : rocksdb::HistogramsNameMap) {
     rocksdb_statistics->histogramData(entry.first, &histogram_data);
 
-    auto copy_of_attr = attrs;
-    const std::string hist_name = entry.second;
     RETURN_NOT_OK(writer->WriteSingleEntry(
-        copy_of_attr, hist_name + "_sum", histogram_data.sum));
+        labels, entry.second.c_str(), "_sum", histogram_data.sum));
     RETURN_NOT_OK(writer->WriteSingleEntry(
-        copy_of_attr, hist_name + "_count", histogram_data.count));
+        labels, entry.second.c_str(), "_count", histogram_data.count));
   }
   return Status::OK();
 }
 
 const char* Tablet::kDMSMemTrackerId = "DeltaMemStores";
 
+namespace {
+
+bool IsDocDBHashPartitioned(const TabletMetadata& metadata) {
+  const auto hash_schema = metadata.partition_schema().hash_schema();
+  return metadata.table_type() != TableType::KUDU_COLUMNAR_TABLE_TYPE &&
+         (hash_schema == YBHashSchema::kMultiColumnHash || hash_schema == YBHashSchema::kRedisHash);
+}
+
+// Returns bounds of encoded document keys with hash codes from the specified hash partition.
+docdb::KeyBounds HashKeyBounds(const Partition& partition) {
+  docdb::KeyBounds result;
+  if (!partition.partition_key_start().empty()) {
+    result.lower.AppendValueType(ValueType::kUInt16Hash);
+    result.lower.AppendRawBytes(partition.partition_key_start());
+  }
+  if (!partition.partition_key_end().empty()) {
+    result.upper.AppendValueType(ValueType::kUInt16Hash);
+    result.upper.AppendRawBytes(partition.partition_key_end());
+  }
+  return result;
+}
+
+// Returns hash code of the encoded document key, or none if the key does not start with one.
+boost::optional<uint32_t> DecodeHashCode(const Slice& key) {
+  if (key.size() < 1 + sizeof(uint16_t) || key[0] != static_cast<uint8_t>(ValueType::kUInt16Hash)) {
+    return boost::none;
+  }
+  return BigEndian::Load16(key.data() + 1);
+}
+
+// Subdirectory of the RocksDB directory with the files of columnar snapshots.
+const char* const kColumnarSnapshotsDir = "columnar";
+
+// Builds a columnar snapshot of the tablet after a major compaction, i.e. a compaction that left
+// only its output files.
+class ColumnarSnapshotBuilder : public rocksdb::EventListener {
+ public:
+  explicit ColumnarSnapshotBuilder(Tablet* tablet) : tablet_(tablet) {}
+
+  void OnCompactionCompleted(rocksdb::DB* db, const rocksdb::CompactionJobInfo& info) override {
+    if (!FLAGS_tablet_columnar_snapshots || !info.status.ok()) {
+      return;
+    }
+    std::vector<rocksdb::LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+    if (files.size() != info.output_files.size()) {
+      return;
+    }
+    tablet_->BuildColumnarSnapshot();
+  }
+
+ private:
+  Tablet* const tablet_;
+};
+
+} // namespace
+
 Tablet::Tablet(
     const scoped_refptr<TabletMetadata>& metadata,
     const scoped_refptr<server::Clock>& clock,
@@ -317,10 +484,16 @@ Tablet::Tablet(
       dms_mem_tracker_(MemTracker::CreateTracker(-1, kDMSMemTrackerId, mem_tracker_)),
       clock_(clock),
       mvcc_(clock, metadata->table_type() != TableType::KUDU_COLUMNAR_TABLE_TYPE),
+      hot_read_keys_(std::max(FLAGS_tablet_hot_key_capacity, 1)),
+      hot_write_keys_(std::max(FLAGS_tablet_hot_key_capacity, 1)),
       tablet_options_(tablet_options) {
   CHECK(schema()->has_column_ids());
   compaction_policy_.reset(CreateCompactionPolicy());
 
+  if (IsDocDBHashPartitioned(*metadata_)) {
+    key_bounds_ = HashKeyBounds(metadata_->partition());
+  }
+
   if (metric_registry) {
     MetricEntity::AttributeMap attrs;
     // TODO(KUDU-745): table_id is apparently not set in the metadata.
@@ -339,8 +512,8 @@ Tablet::Tablet(
       });
 
       metric_entity_->AddExternalPrometheusMetricsCb(
-          [rocksdb_statistics, attrs](PrometheusWriter* pw) {
-        auto s = EmitRocksDbMetricsAsPrometheus(rocksdb_statistics, pw, attrs);
+          [rocksdb_statistics](PrometheusWriter* pw, const PrometheusEntityLabels& labels) {
+        auto s = EmitRocksDbMetricsAsPrometheus(rocksdb_statistics, pw, labels);
         if (!s.ok()) {
           YB_LOG_EVERY_N(WARNING, 100) << "Failed to get Prometheus metrics: " << s.ToString();
         }
@@ -353,6 +526,26 @@ Tablet::Tablet(
     METRIC_on_disk_size.InstantiateFunctionGauge(
             metric_entity_, Bind(&Tablet::EstimateOnDiskSize, Unretained(this)))
         ->AutoDetach(&metric_detacher_);
+    METRIC_hot_read_key_percentage.InstantiateFunctionGauge(
+            metric_entity_, Bind(&Tablet::HotReadKeyPercentage, Unretained(this)))
+        ->AutoDetach(&metric_detacher_);
+    METRIC_hot_write_key_percentage.InstantiateFunctionGauge(
+            metric_entity_, Bind(&Tablet::HotWriteKeyPercentage, Unretained(this)))
+        ->AutoDetach(&metric_detacher_);
+    if (table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+      METRIC_rocksdb_num_level0_files.InstantiateFunctionGauge(
+              metric_entity_, Bind(&Tablet::RocksDBNumLevel0Files, Unretained(this)))
+          ->AutoDetach(&metric_detacher_);
+      METRIC_rocksdb_pending_compaction_bytes.InstantiateFunctionGauge(
+              metric_entity_, Bind(&Tablet::RocksDBPendingCompactionBytes, Unretained(this)))
+          ->AutoDetach(&metric_detacher_);
+      METRIC_rocksdb_read_amplification.InstantiateFunctionGauge(
+              metric_entity_, Bind(&Tablet::RocksDBReadAmplification, Unretained(this)))
+          ->AutoDetach(&metric_detacher_);
+      METRIC_rocksdb_num_immutable_memtables.InstantiateFunctionGauge(
+              metric_entity_, Bind(&Tablet::RocksDBNumImmutableMemTables, Unretained(this)))
+          ->AutoDetach(&metric_detacher_);
+    }
   }
 
   if (transaction_participant_context) {
@@ -368,6 +561,13 @@ Tablet::Tablet(
 
   flush_stats_ = make_shared<TabletFlushStats>();
   tablet_options_.listeners.emplace_back(flush_stats_);
+  rocksdb_job_timeline_ = make_shared<RocksDBJobTimeline>();
+  tablet_options_.listeners.emplace_back(rocksdb_job_timeline_);
+
+  if (table_type_ == TableType::YQL_TABLE_TYPE) {
+    columnar_snapshots_ = std::make_unique<docdb::ColumnarSnapshotHolder>();
+    tablet_options_.listeners.emplace_back(std::make_shared<ColumnarSnapshotBuilder>(this));
+  }
 }
 
 Tablet::~Tablet() {
@@ -402,11 +602,25 @@ Status Tablet::Open() {
 Status Tablet::OpenKeyValueTablet() {
   rocksdb::Options rocksdb_options;
   docdb::InitRocksDBOptions(&rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
+  if (table_type_ == TableType::REDIS_TABLE_TYPE && FLAGS_redis_tablet_use_hash_memtable) {
+    docdb::InitRocksDBHashMemTableOptions(&rocksdb_options);
+  }
+  // The hash index expects the keys with the same prefix to be contiguous, which does not hold for
+  // the provisional records of transactions.
+  const auto& table_properties = metadata()->schema().table_properties();
+  if (table_properties.optimize_for_point_lookups() && !table_properties.is_transactional()) {
+    docdb::InitRocksDBPointLookupOptions(&rocksdb_options);
+  }
 
   // Install the history cleanup handler. Note that TabletRetentionPolicy is going to hold a raw ptr
   // to this tablet. So, we ensure that rocksdb_ is reset before this tablet gets destroyed.
-  rocksdb_options.compaction_filter_factory = make_shared<DocDBCompactionFilterFactory>(
-      make_shared<TabletRetentionPolicy>(this));
+  retention_policy_ = make_shared<TabletRetentionPolicy>(this);
+  rocksdb_options.compaction_filter_factory =
+      make_shared<DocDBCompactionFilterFactory>(retention_policy_, &key_bounds_);
+  if (FLAGS_tablet_delete_expired_sst_files) {
+    rocksdb_options.compaction_file_filter_factory =
+        make_shared<docdb::DocDBCompactionFileFilterFactory>(retention_policy_);
+  }
 
   const string db_dir = metadata()->rocksdb_dir();
   LOG(INFO) << "Creating RocksDB database in dir " << db_dir;
@@ -419,6 +633,7 @@ Status Tablet::OpenKeyValueTablet() {
   RETURN_NOT_OK_PREPEND(metadata()->fs_manager()->CreateDirIfMissing(db_dir),
                         Substitute("Failed to create RocksDB tablet directory $0",
                                    db_dir));
+  RETURN_NOT_OK(SetupSstStripeDirs(db_dir, &rocksdb_options));
 
   LOG(INFO) << "Opening RocksDB at: " << db_dir;
   rocksdb::DB* db = nullptr;
@@ -432,11 +647,74 @@ Status Tablet::OpenKeyValueTablet() {
     return STATUS(IllegalState, rocksdb_open_status.ToString());
   }
   rocksdb_.reset(db);
-  ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get()));
+  // Columnar snapshots are not kept across restarts and restores, the next major compaction
+  // builds a new one.
+  if (columnar_snapshots_) {
+    columnar_snapshots_->Invalidate();
+    const auto columnar_dir = JoinPathSegments(db_dir, kColumnarSnapshotsDir);
+    Env* const env = metadata()->fs_manager()->env();
+    if (env->FileExists(columnar_dir)) {
+      RETURN_NOT_OK(env->DeleteRecursively(columnar_dir));
+    }
+  }
+  ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get(), columnar_snapshots_.get()));
+  // Values cached for the previous RocksDB instance could be stale, e.g. after restore.
+  if (table_type_ == TableType::REDIS_TABLE_TYPE && FLAGS_redis_tablet_value_cache_size_bytes > 0) {
+    redis_value_cache_.reset(new docdb::RedisValueCache(
+        FLAGS_redis_tablet_value_cache_size_bytes));
+  } else {
+    redis_value_cache_.reset();
+  }
+  // The previous cache is destroyed first, to release its memory tracker id.
+  document_cache_.reset();
+  if (table_type_ == TableType::REDIS_TABLE_TYPE &&
+      FLAGS_redis_tablet_document_cache_size_bytes > 0) {
+    document_cache_.reset(new docdb::DocumentCache(
+        FLAGS_redis_tablet_document_cache_size_bytes, mem_tracker_));
+  }
+  if (transaction_participant_) {
+    transaction_participant_->CheckPersistedIntents(rocksdb_.get());
+  }
   LOG(INFO) << "Successfully opened a RocksDB database at " << db_dir;
   return Status::OK();
 }
 
+Status Tablet::SetupSstStripeDirs(const std::string& db_dir, rocksdb::Options* options) {
+  FsManager* const fs_manager = metadata()->fs_manager();
+  Env* const env = fs_manager->env();
+  // Directories are only added to the RocksDB of a new tablet. Files restored from a snapshot or
+  // copied by remote bootstrap are all in db_dir, and RocksDB looks for the files recorded with a
+  // path it does not have in the last path, which is db_dir then.
+  const bool new_db = !env->FileExists(JoinPathSegments(db_dir, "CURRENT"));
+  std::vector<std::string> stripe_dirs;
+  for (const auto& dir : metadata()->sst_stripe_dirs()) {
+    if (env->FileExists(dir)) {
+      stripe_dirs.push_back(dir);
+    } else if (new_db && FLAGS_rocksdb_stripe_sst_files_across_data_dirs) {
+      RETURN_NOT_OK_PREPEND(fs_manager->CreateDirIfMissing(DirName(dir)),
+                            Substitute("Failed to create RocksDB table directory $0",
+                                       DirName(dir)));
+      RETURN_NOT_OK_PREPEND(fs_manager->CreateDirIfMissing(dir),
+                            Substitute("Failed to create RocksDB SST directory $0", dir));
+      stripe_dirs.push_back(dir);
+    }
+  }
+  if (stripe_dirs.empty()) {
+    return Status::OK();
+  }
+
+  const auto target_size = FLAGS_rocksdb_sst_stripe_dir_target_size_bytes;
+  options->db_paths.emplace_back(db_dir, target_size);
+  for (const auto& dir : stripe_dirs) {
+    options->db_paths.emplace_back(dir, target_size);
+  }
+  // Whatever does not fit the other directories goes to the last one.
+  options->db_paths.back().target_size = std::numeric_limits<uint64_t>::max();
+  LOG(INFO) << "SST files of tablet " << tablet_id() << " can be placed in "
+            << JoinStrings(stripe_dirs, ", ") << " in addition to " << db_dir;
+  return Status::OK();
+}
+
 Status Tablet::OpenKuduColumnarTablet() {
   next_mrs_id_ = metadata_->last_durable_mrs_id() + 1;
 
@@ -489,7 +767,9 @@ void Tablet::Shutdown() {
 
   std::lock_guard<rw_spinlock> lock(component_lock_);
   components_ = nullptr;
-  // Shutdown the RocksDB instance for this table, if present.
+  // Shutdown the RocksDB instance for this table, if present. The QL storage goes first, as the
+  // cursors it keeps iterate the RocksDB instance.
+  ql_storage_.reset();
   rocksdb_.reset();
   state_ = kShutdown;
 
@@ -809,6 +1089,18 @@ void Tablet::StartApplying(WriteOperationState* operation_state) {
   }
 }
 
+namespace {
+
+const KeyValueWriteBatchPB& KeyValueWriteBatch(const WriteOperationState& operation_state) {
+  return operation_state.consensus_round() && operation_state.consensus_round()->replicate_msg()
+      // Online case.
+      ? operation_state.consensus_round()->replicate_msg()->write_request().write_batch()
+      // Bootstrap case.
+      : operation_state.request()->write_batch();
+}
+
+} // namespace
+
 void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
   last_committed_write_index_.store(operation_state->op_id().index(), std::memory_order_release);
   StartApplying(operation_state);
@@ -821,14 +1113,7 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
     }
     case TableType::YQL_TABLE_TYPE:
     case TableType::REDIS_TABLE_TYPE: {
-      const KeyValueWriteBatchPB& put_batch =
-          operation_state->consensus_round() && operation_state->consensus_round()->replicate_msg()
-              // Online case.
-              ? operation_state->consensus_round()->replicate_msg()->write_request().write_batch()
-              // Bootstrap case.
-              : operation_state->request()->write_batch();
-
-      ApplyKeyValueRowOperations(put_batch,
+      ApplyKeyValueRowOperations(KeyValueWriteBatch(*operation_state),
                                  operation_state->op_id(),
                                  operation_state->hybrid_time());
       return;
@@ -837,6 +1122,25 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
   LOG(FATAL) << "Invalid table type: " << table_type_;
 }
 
+void Tablet::ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states) {
+  DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
+  WriteBatch write_batch;
+  bool has_operations = false;
+  for (auto* operation_state : operation_states) {
+    last_committed_write_index_.store(operation_state->op_id().index(), std::memory_order_release);
+    StartApplying(operation_state);
+    if (PrepareKeyValueRowOperations(KeyValueWriteBatch(*operation_state),
+                                     operation_state->op_id(),
+                                     operation_state->hybrid_time(),
+                                     &write_batch)) {
+      has_operations = true;
+    }
+  }
+  if (has_operations) {
+    WriteToRocksDB(&write_batch);
+  }
+}
+
 Status Tablet::CreateCheckpoint(const std::string& dir,
                                 google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files) {
   GUARD_AGAINST_ROCKSDB_SHUTDOWN;
@@ -888,6 +1192,103 @@ Status Tablet::CreateCheckpoint(const std::string& dir,
   return Status::OK();
 }
 
+std::string Tablet::SnapshotDir(const std::string& snapshot_id) const {
+  return JoinPathSegments(metadata_->snapshots_dir(), snapshot_id);
+}
+
+Status Tablet::CreateSnapshot(const std::string& snapshot_id) {
+  Env* const env = metadata_->fs_manager()->env();
+  const auto snapshot_dir = SnapshotDir(snapshot_id);
+  if (env->FileExists(snapshot_dir)) {
+    LOG(INFO) << "Snapshot " << snapshot_id << " of tablet " << tablet_id() << " already exists";
+    return Status::OK();
+  }
+  RETURN_NOT_OK(metadata_->fs_manager()->CreateDirIfMissing(metadata_->snapshots_dir()));
+  // Leftover of a checkpoint that was interrupted by a crash.
+  const auto tmp_dir = snapshot_dir + ".tmp";
+  if (env->FileExists(tmp_dir)) {
+    RETURN_NOT_OK(env->DeleteRecursively(tmp_dir));
+  }
+  return CreateCheckpoint(snapshot_dir);
+}
+
+Status Tablet::RestoreSnapshot(const std::string& snapshot_id, const consensus::OpId& op_id) {
+  DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
+  const auto snapshot_dir = SnapshotDir(snapshot_id);
+  if (!metadata_->fs_manager()->env()->FileExists(snapshot_dir)) {
+    return STATUS_FORMAT(NotFound, "Snapshot $0 not found in $1", snapshot_id, snapshot_dir);
+  }
+
+  // Reads and writes are rejected, like during shutdown, until RocksDB is reopened.
+  if (shutdown_requested_.exchange(true, std::memory_order_acq_rel)) {
+    return STATUS(IllegalState, "tablet is shutting down");
+  }
+  auto status = pending_op_counter_.WaitForAllOpsToFinish(MonoDelta::FromSeconds(60));
+  if (status.ok()) {
+    status = ReopenFromCheckpoint(snapshot_dir, op_id);
+  }
+  shutdown_requested_.store(false, std::memory_order_release);
+  return status;
+}
+
+Status Tablet::ReopenFromCheckpoint(const std::string& checkpoint_dir,
+                                    const consensus::OpId& op_id) {
+  std::lock_guard<std::mutex> lock(create_checkpoint_lock_);
+  Env* const env = metadata_->fs_manager()->env();
+  rocksdb::Env* const rocksdb_env = rocksdb::Env::Default();
+  const auto db_dir = metadata_->rocksdb_dir();
+
+  // The new files are prepared next to the current ones, so a crash leaves either the old or the
+  // new RocksDB in place. Replaying the restore fixes the former.
+  const auto restore_dir = db_dir + ".restore";
+  if (env->FileExists(restore_dir)) {
+    RETURN_NOT_OK(env->DeleteRecursively(restore_dir));
+  }
+  RETURN_NOT_OK(env->CreateDir(restore_dir));
+  std::vector<std::string> files;
+  RETURN_NOT_OK(env->GetChildren(checkpoint_dir, &files));
+  for (const auto& file : files) {
+    if (file == "." || file == "..") {
+      continue;
+    }
+    const auto source = JoinPathSegments(checkpoint_dir, file);
+    const auto dest = JoinPathSegments(restore_dir, file);
+    // SST files are never modified, so they are shared with the snapshot. The other files, like
+    // the MANIFEST, are copied.
+    if (HasSuffixString(file, ".sst") || file.find(".sst.") != std::string::npos) {
+      RETURN_NOT_OK(rocksdb_env->LinkFile(source, dest));
+    } else {
+      RETURN_NOT_OK(rocksdb::CopyFile(rocksdb_env, source, dest));
+    }
+  }
+
+  ql_storage_.reset();
+  rocksdb_.reset();
+  if (env->FileExists(db_dir)) {
+    RETURN_NOT_OK(env->DeleteRecursively(db_dir));
+  }
+  // All the restored files are placed in db_dir.
+  for (const auto& dir : metadata_->sst_stripe_dirs()) {
+    if (env->FileExists(dir)) {
+      RETURN_NOT_OK(env->DeleteRecursively(dir));
+    }
+  }
+  RETURN_NOT_OK(env->RenameFile(restore_dir, db_dir));
+  RETURN_NOT_OK(OpenKeyValueTablet());
+
+  LOG(INFO) << "Tablet " << tablet_id() << " restored from " << checkpoint_dir;
+  return rocksdb_->SetFlushedOpId(yb::OpId(op_id.term(), op_id.index()));
+}
+
+Status Tablet::DeleteSnapshot(const std::string& snapshot_id) {
+  Env* const env = metadata_->fs_manager()->env();
+  const auto snapshot_dir = SnapshotDir(snapshot_id);
+  if (!env->FileExists(snapshot_dir)) {
+    return Status::OK();
+  }
+  return env->DeleteRecursively(snapshot_dir);
+}
+
 void Tablet::PrepareTransactionWriteBatch(
     const KeyValueWriteBatchPB& put_batch,
     HybridTime hybrid_time,
@@ -917,25 +1318,49 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
     return;
   }
 
+  if (PrepareKeyValueRowOperations(put_batch, op_id, hybrid_time, rocksdb_write_batch)) {
+    WriteToRocksDB(rocksdb_write_batch);
+  }
+}
+
+bool Tablet::PrepareKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
+                                          const consensus::OpId& op_id,
+                                          const HybridTime hybrid_time,
+                                          rocksdb::WriteBatch* rocksdb_write_batch) {
   DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
   if (put_batch.kv_pairs_size() == 0) {
-    return;
+    return false;
   }
 
+  // When several operations share the write batch, the last (i.e. highest) op id is kept.
   rocksdb_write_batch->SetUserOpId(rocksdb::OpId(op_id.term(), op_id.index()));
 
+  if (columnar_snapshots_) {
+    columnar_snapshots_->Invalidate();
+  }
+
   if (put_batch.has_transaction()) {
     PrepareTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
   } else {
     PrepareNonTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
+    if (redis_value_cache_) {
+      redis_value_cache_->Apply(put_batch, hybrid_time);
+    }
+    if (document_cache_) {
+      document_cache_->Apply(put_batch, hybrid_time);
+    }
   }
 
+  flush_stats_->AboutToWriteToDb(hybrid_time);
+  return true;
+}
+
+void Tablet::WriteToRocksDB(rocksdb::WriteBatch* rocksdb_write_batch) {
   // We are using Raft replication index for the RocksDB sequence number for
   // all members of this write batch.
   rocksdb::WriteOptions write_options;
   InitRocksDBWriteOptions(&write_options);
 
-  flush_stats_->AboutToWriteToDb(hybrid_time);
   auto rocksdb_write_status = rocksdb_->Write(write_options, rocksdb_write_batch);
   if (!rocksdb_write_status.ok()) {
     LOG(FATAL) << "Failed to write a batch with " << rocksdb_write_batch->Count() << " operations"
@@ -945,6 +1370,24 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
 
 namespace {
 
+bool ShouldSampleHotKey() {
+  const int32_t sample_rate = FLAGS_tablet_hot_key_sample_rate;
+  return sample_rate > 0 && RandomUniformInt(1, sample_rate) == 1;
+}
+
+void AddHotKey(const Slice& encoded_doc_key, SpaceSaving* sketch) {
+  if (sketch->total() >= static_cast<uint64_t>(std::max(FLAGS_tablet_hot_key_window, 1))) {
+    sketch->Clear();
+  }
+  sketch->Add(encoded_doc_key);
+}
+
+uint64_t HotKeyPercentage(const SpaceSaving& sketch) {
+  const uint64_t total = sketch.total();
+  const auto top = sketch.TopK(1);
+  return total == 0 || top.empty() ? 0 : top[0].count * 100 / total;
+}
+
 // Separate Redis / QL / row operations write batches from write_request in preparation for the
 // write transaction. Leave just the tablet id behind. Return Redis / QL / row operations, etc.
 // in batch_request.
@@ -955,6 +1398,9 @@ void SetupKeyValueBatch(WriteRequestPB* write_request, WriteRequestPB* batch_req
     write_request->mutable_write_batch()->mutable_transaction()->Swap(
         batch_request->mutable_write_batch()->mutable_transaction());
   }
+  if (batch_request->write_batch().one_phase_commit()) {
+    write_request->mutable_write_batch()->set_one_phase_commit(true);
+  }
 }
 
 } // namespace
@@ -974,7 +1420,7 @@ Status Tablet::KeyValueBatchFromRedisWriteBatch(
   doc_ops.reserve(redis_write_batch->size());
   for (size_t i = 0; i < redis_write_batch->size(); i++) {
     doc_ops.emplace_back(new RedisWriteOperation(
-        redis_write_batch->Mutable(i), read_hybrid_time));
+        redis_write_batch->Mutable(i), read_hybrid_time, redis_value_cache_.get()));
   }
   RETURN_NOT_OK(StartDocWriteOperation(
       doc_ops, keys_locked, redis_write_request->mutable_write_batch()));
@@ -991,8 +1437,15 @@ Status Tablet::HandleRedisReadRequest(HybridTime timestamp,
                                       RedisResponsePB* response) {
   GUARD_AGAINST_ROCKSDB_SHUTDOWN;
   ScopedTabletMetricsTracker metrics_tracker(metrics_->redis_read_latency);
+  ScopedStorageCostTracker storage_cost_tracker(metrics_.get());
+
+  if (ShouldSampleHotKey()) {
+    const auto& key_value = redis_read_request.key_value();
+    AddHotKey(DocKey::FromRedisKey(key_value.hash_code(), key_value.key()).Encode().AsSlice(),
+              &hot_read_keys_);
+  }
 
-  docdb::RedisReadOperation doc_op(redis_read_request);
+  docdb::RedisReadOperation doc_op(redis_read_request, document_cache_.get());
   RETURN_NOT_OK(doc_op.Execute(rocksdb_.get(), timestamp));
   *response = std::move(doc_op.response());
   return Status::OK();
@@ -1004,12 +1457,22 @@ Status Tablet::HandleQLReadRequest(
     gscoped_ptr<faststring>* rows_data) {
   GUARD_AGAINST_ROCKSDB_SHUTDOWN;
   ScopedTabletMetricsTracker metrics_tracker(metrics_->ql_read_latency);
+  ScopedStorageCostTracker storage_cost_tracker(metrics_.get());
 
   if (metadata()->schema_version() != ql_read_request.schema_version()) {
     response->set_status(QLResponsePB::YQL_STATUS_SCHEMA_VERSION_MISMATCH);
     return Status::OK();
   }
 
+  if (!ql_read_request.hashed_column_values().empty() && ShouldSampleHotKey()) {
+    vector<PrimitiveValue> hashed_components;
+    RETURN_NOT_OK(docdb::QLKeyColumnValuesToPrimitiveValues(
+        ql_read_request.hashed_column_values(), *schema(), 0, schema()->num_hash_key_columns(),
+        &hashed_components));
+    AddHotKey(DocKey(ql_read_request.hash_code(), hashed_components).Encode().AsSlice(),
+              &hot_read_keys_);
+  }
+
   Result<TransactionOperationContextOpt> txn_op_ctx =
       CreateTransactionOperationContext(transaction_metadata);
   RETURN_NOT_OK(txn_op_ctx);
@@ -1103,6 +1566,14 @@ Status Tablet::AcquireLocksAndPerformDocOperations(WriteOperationState *state) {
         break;
       }
       case TableType::YQL_TABLE_TYPE: {
+        if (key_value_write_request->write_batch().kv_pairs_size() > 0) {
+          // Changes replicated from another cluster, already in the key-value form. Only the
+          // tablet server submits them, clients could not send a write batch.
+          RETURN_NOT_OK(docdb::PrepareKeyValueWriteBatch(
+              key_value_write_request->write_batch(), &shared_lock_manager_, &locks_held));
+          invalid_table_type = false;
+          break;
+        }
         CHECK_NE(key_value_write_request->ql_write_batch_size() > 0,
                  key_value_write_request->row_operations().rows().size() > 0)
             << "QL write and Kudu row operations not supported in the same request";
@@ -1389,6 +1860,43 @@ Status Tablet::ImportData(const std::string& source_dir) {
   return rocksdb_->Import(source_dir);
 }
 
+Status Tablet::ValidateIngestFiles(const std::string& source_dir, HybridTime max_hybrid_time) {
+  DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
+  rocksdb::Options rocksdb_options;
+  docdb::InitRocksDBOptions(&rocksdb_options, tablet_id(), nullptr, tablet_options_);
+  rocksdb::DB* db = nullptr;
+  RETURN_NOT_OK_PREPEND(rocksdb::DB::OpenForReadOnly(rocksdb_options, source_dir, &db),
+                        Format("Failed to open $0", source_dir));
+  std::unique_ptr<rocksdb::DB> source_db(db);
+
+  std::vector<rocksdb::LiveFileMetaData> files;
+  source_db->GetLiveFilesMetaData(&files);
+  if (files.empty()) {
+    return STATUS_FORMAT(InvalidArgument, "No SST files in $0", source_dir);
+  }
+  for (const auto& file : files) {
+    if (!key_bounds_.IsWithinBounds(file.smallest.key) ||
+        !key_bounds_.IsWithinBounds(file.largest.key)) {
+      return STATUS_FORMAT(InvalidArgument, "Keys of $0 are outside of the tablet key range",
+                           file.name);
+    }
+    DocHybridTime largest_time;
+    RETURN_NOT_OK_PREPEND(docdb::GetDocHybridTime(file.largest.user_values, &largest_time),
+                          Format("No hybrid time in $0", file.name));
+    if (largest_time.hybrid_time() > max_hybrid_time) {
+      return STATUS_FORMAT(InvalidArgument, "Records of $0 are after $1: $2",
+                           file.name, max_hybrid_time, largest_time);
+    }
+  }
+  return Status::OK();
+}
+
+Status Tablet::IngestFiles(const std::string& source_dir, const consensus::OpId& op_id) {
+  DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+  return rocksdb_->Import(source_dir, yb::OpId(op_id.term(), op_id.index()));
+}
+
 #define INTENT_KEY_SCHECK(lhs, op, rhs, msg) \
   BOOST_PP_CAT(SCHECK_, op)(lhs, \
                             rhs, \
@@ -1425,8 +1933,16 @@ Result<docdb::IntentType> ExtractIntentType(
 // We apply intents using by iterating over whole transaction reverse index.
 // Using value of reverse index record we find original intent record and apply it.
 // After that we delete both intent record and reverse index record.
+// Intent and reverse index records are written exactly once (their keys include the write hybrid
+// time), so they are removed using SingleDelete, which lets compaction drop the record together
+// with its tombstone as soon as they meet instead of carrying the tombstone to the last level.
+// Transaction metadata record could be written more than once, so it uses a regular Delete.
+//
+// Big transactions are applied in several write batches of about
+// --transaction_apply_batch_size_bytes. Only the last batch is marked with the op id of the apply
+// operation, so the flushed frontier does not pass it until all intents are applied, and a
+// partially applied transaction is completed when the operation is replayed after a restart.
 // TODO(dtxn) use separate thread for applying intents.
-// TODO(dtxn) use multiple batches when applying really big transaction.
 Status Tablet::ApplyIntents(const TransactionApplyData& data) {
   auto reverse_index_iter = docdb::CreateRocksDBIterator(
       rocksdb_.get(),
@@ -1447,6 +1963,7 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
 
   KeyValueWriteBatchPB put_batch;
   WriteBatch rocksdb_write_batch;
+  size_t batch_size = 0;
 
   while (reverse_index_iter->Valid()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
@@ -1455,6 +1972,19 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
       break;
     }
 
+    if (batch_size >= static_cast<size_t>(FLAGS_transaction_apply_batch_size_bytes)) {
+      // Write the intermediate batch without op id, see comment above.
+      if (put_batch.kv_pairs_size() != 0) {
+        PrepareNonTransactionWriteBatch(put_batch, data.commit_time, &rocksdb_write_batch);
+        flush_stats_->AboutToWriteToDb(data.commit_time);
+      }
+      WriteToRocksDB(&rocksdb_write_batch);
+      put_batch.Clear();
+      rocksdb_write_batch.Clear();
+      batch_size = 0;
+    }
+    batch_size += key_slice.size() + reverse_index_iter->value().size();
+
     // If the key ends at the transaction id then it is transaction metadata (status tablet,
     // isolation level etc.).
     if (key_slice.size() > txn_reverse_index_prefix.size()) {
@@ -1474,6 +2004,7 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
           INTENT_VALUE_SCHECK(intent_value.starts_with(transaction_id_slice), EQ, true,
                               "wrong transaction id");
           intent_value.remove_prefix(transaction_id_slice.size());
+          batch_size += intent_key.size() + intent_value.size();
 
           auto* pair = put_batch.add_kv_pairs();
           // After strip of prefix and suffix intent_key contains just SubDocKey w/o a hybrid time.
@@ -1481,14 +2012,18 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
           pair->set_key(intent_key.cdata(), intent_key.size());
           pair->set_value(intent_value.cdata(), intent_value.size());
         }
-        rocksdb_write_batch.Delete(intent_iter->key());
+        rocksdb_write_batch.SingleDelete(intent_iter->key());
       } else {
         LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
                     << " for " << reverse_index_iter->key().ToDebugString();
       }
     }
 
-    rocksdb_write_batch.Delete(reverse_index_iter->key());
+    if (key_slice.size() > txn_reverse_index_prefix.size()) {
+      rocksdb_write_batch.SingleDelete(reverse_index_iter->key());
+    } else {
+      rocksdb_write_batch.Delete(reverse_index_iter->key());
+    }
 
     reverse_index_iter->Next();
   }
@@ -1496,7 +2031,14 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
   // data.hybrid_time contains transaction commit time.
   // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
   // TODO(dtxn) commit_time?
-  ApplyKeyValueRowOperations(put_batch, data.op_id, data.commit_time, &rocksdb_write_batch);
+  if (!PrepareKeyValueRowOperations(put_batch, data.op_id, data.commit_time,
+                                    &rocksdb_write_batch)) {
+    // The last batch could contain only removal of intents.
+    rocksdb_write_batch.SetUserOpId(rocksdb::OpId(data.op_id.term(), data.op_id.index()));
+  }
+  if (rocksdb_write_batch.Count() != 0) {
+    WriteToRocksDB(&rocksdb_write_batch);
+  }
   return Status::OK();
 }
 
@@ -2062,6 +2604,87 @@ yb::OpId Tablet::MaxPersistentOpId() const {
   return rocksdb_->GetFlushedOpId();
 }
 
+Result<std::string> Tablet::GetEncodedMiddleSplitKey() const {
+  if (!IsDocDBHashPartitioned(*metadata_)) {
+    return STATUS(NotSupported, "Only hash partitioned key-value tablets could be split");
+  }
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  // Range of hash codes of this tablet, upper bound is exclusive.
+  const auto& partition = metadata_->partition();
+  const uint32_t lower = partition.partition_key_start().empty()
+      ? 0 : PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_start());
+  const uint32_t upper = partition.partition_key_end().empty()
+      ? std::numeric_limits<uint16_t>::max() + 1
+      : PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_end());
+  if (lower + 1 >= upper) {
+    return STATUS_FORMAT(IllegalState, "Hash range [$0, $1) is too small to split", lower, upper);
+  }
+
+  struct FileRange {
+    uint32_t first;
+    uint32_t last;
+    double size;
+  };
+  std::vector<rocksdb::LiveFileMetaData> files;
+  rocksdb_->GetLiveFilesMetaData(&files);
+  std::vector<FileRange> ranges;
+  double total_size = 0;
+  for (const auto& file : files) {
+    auto first = DecodeHashCode(file.smallest.key);
+    if (!first) {
+      // File does not contain regular records.
+      continue;
+    }
+    // The largest key could be a provisional record, those are stored after regular records.
+    auto last = DecodeHashCode(file.largest.key);
+    FileRange range = { std::max(*first, lower), last ? std::min(*last, upper - 1) : upper - 1,
+                        static_cast<double>(file.total_size) };
+    if (range.first > range.last) {
+      continue;
+    }
+    ranges.push_back(range);
+    total_size += range.size;
+  }
+  if (ranges.empty()) {
+    return STATUS(IllegalState, "Tablet does not have SST files with regular records");
+  }
+
+  // Estimated size of data with hash codes less than the specified one.
+  auto size_below = [&ranges](uint32_t hash_code) {
+    double result = 0;
+    for (const auto& range : ranges) {
+      if (hash_code > range.first) {
+        result += range.size * (std::min(hash_code, range.last + 1) - range.first) /
+                  (range.last + 1 - range.first);
+      }
+    }
+    return result;
+  };
+
+  // Find the smallest hash code that has at least half of data below it, keeping both parts
+  // non empty.
+  uint32_t left = lower + 1;
+  uint32_t right = upper - 1;
+  while (left < right) {
+    uint32_t middle = left + (right - left) / 2;
+    if (size_below(middle) * 2 >= total_size) {
+      right = middle;
+    } else {
+      left = middle + 1;
+    }
+  }
+  return PartitionSchema::EncodeMultiColumnHashValue(left);
+}
+
+uint64_t Tablet::HotReadKeyPercentage() const {
+  return HotKeyPercentage(hot_read_keys_);
+}
+
+uint64_t Tablet::HotWriteKeyPercentage() const {
+  return HotKeyPercentage(hot_write_keys_);
+}
+
 Status Tablet::FlushMetadata(const RowSetVector& to_remove,
                              const RowSetMetadataVector& to_add,
                              int64_t mrs_being_flushed) {
@@ -2471,9 +3094,11 @@ class TransactionConflictResolver {
   explicit TransactionConflictResolver(const KeyValueWriteBatchPB& write_batch,
                                        HybridTime hybrid_time,
                                        rocksdb::DB* db,
-                                       TransactionParticipant* transaction_participant)
+                                       TransactionParticipant* transaction_participant,
+                                       server::Clock* clock)
       : write_batch_(write_batch),
         hybrid_time_(hybrid_time),
+        status_time_(hybrid_time),
         db_(db),
         transaction_id_(FullyDecodeTransactionId(
             write_batch.transaction().transaction_id())),
@@ -2482,7 +3107,8 @@ class TransactionConflictResolver {
             docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
             boost::none /* user_key_for_filter */,
             rocksdb::kDefaultQueryId)),
-        transaction_participant_(transaction_participant)
+        transaction_participant_(transaction_participant),
+        clock_(clock)
   {}
 
   CHECKED_STATUS Resolve() {
@@ -2521,8 +3147,15 @@ class TransactionConflictResolver {
   }
 
  private:
+  // Conflicting transactions with higher priority are not aborted. Instead we wait for their
+  // completion, up to transaction_conflict_max_wait_ms. Since keys of this write are locked while
+  // we wait, other writes of the same keys are queued behind it in the lock manager. Waits are
+  // bounded, so a cycle of waiting transactions is broken when the first of them times out.
   CHECKED_STATUS ResolveConflicts() {
     bool fetched_metadata_for_transactions = false;
+    const auto wait_deadline = MonoTime::FineNow() + MonoDelta::FromMilliseconds(
+        GetAtomicFlag(&FLAGS_transaction_conflict_max_wait_ms));
+    auto wait_delay = MonoDelta::FromMilliseconds(1);
     for (;;) {
       RETURN_NOT_OK(CheckLocalCommits());
 
@@ -2534,6 +3167,7 @@ class TransactionConflictResolver {
       }
 
       auto our_priority = metadata_.priority;
+      const TransactionData* higher_priority_transaction = nullptr;
       for (auto& transaction : transactions_) {
         if (!fetched_metadata_for_transactions) {
           auto their_metadata = transaction_participant_->Metadata(db_, transaction.id);
@@ -2546,12 +3180,26 @@ class TransactionConflictResolver {
           transaction.metadata = std::move(*their_metadata);
         }
         auto their_priority = transaction.metadata.priority;
-        if (our_priority < their_priority) {
-          return MakeConflictStatus(transaction.id, "higher priority");
+        if (our_priority < their_priority && !higher_priority_transaction) {
+          higher_priority_transaction = &transaction;
         }
       }
       fetched_metadata_for_transactions = true;
 
+      if (higher_priority_transaction) {
+        auto now = MonoTime::FineNow();
+        if (now >= wait_deadline) {
+          return MakeConflictStatus(higher_priority_transaction->id, "higher priority");
+        }
+        SleepFor(std::min(wait_delay, wait_deadline - now));
+        wait_delay = std::min(MonoDelta::FromMicroseconds(wait_delay.ToMicroseconds() * 2),
+                              MonoDelta::FromMilliseconds(50));
+        // Last known status of pending transaction covers the previous request time, so we
+        // should request status at the current time to find out whether it was completed.
+        status_time_ = clock_->Now();
+        continue;
+      }
+
       AbortTransactions();
 
       RETURN_NOT_OK(Cleanup());
@@ -2675,7 +3323,7 @@ class TransactionConflictResolver {
       auto& transaction = i;
       transaction_participant_->RequestStatusAt(
           transaction.id,
-          hybrid_time_,
+          status_time_,
           [&transaction, &latch](Result<TransactionStatusResult> result) {
             if (result.ok()) {
               transaction.ProcessStatus(*result);
@@ -2732,10 +3380,13 @@ class TransactionConflictResolver {
 
   const KeyValueWriteBatchPB& write_batch_;
   HybridTime hybrid_time_;
+  // Time that we request statuses of conflicting transactions at.
+  HybridTime status_time_;
   rocksdb::DB* db_;
   Result<TransactionId> transaction_id_;
   std::unique_ptr<rocksdb::Iterator> intent_iter_;
   TransactionParticipant* transaction_participant_;
+  server::Clock* clock_;
   TransactionMetadata metadata_;
   IntentTypePair intent_types_;
   Status result_ = Status::OK();
@@ -2746,14 +3397,27 @@ class TransactionConflictResolver {
 Status Tablet::StartDocWriteOperation(const vector<unique_ptr<DocOperation>> &doc_ops,
                                       LockBatch *keys_locked,
                                       KeyValueWriteBatchPB* write_batch) {
+  ScopedStorageCostTracker storage_cost_tracker(metrics_.get());
   bool need_read_snapshot = false;
   HybridTime hybrid_time;
+  for (const auto& doc_op : doc_ops) {
+    if (ShouldSampleHotKey()) {
+      std::list<docdb::DocPath> paths;
+      IsolationLevel ignored_isolation_level;
+      doc_op->GetDocPathsToLock(&paths, &ignored_isolation_level);
+      if (!paths.empty()) {
+        // The last path is the most specific one, e.g. the primary key of a QL row.
+        AddHotKey(paths.back().encoded_doc_key().AsSlice(), &hot_write_keys_);
+      }
+    }
+  }
   docdb::PrepareDocWriteOperation(
       doc_ops, &shared_lock_manager_, keys_locked, &need_read_snapshot,
       metrics_->write_lock_latency);
   unique_ptr<ScopedReadOperation> read_txn;
   if (need_read_snapshot) {
     read_txn.reset(new ScopedReadOperation(this));
+    RETURN_NOT_OK(read_txn->status());
     hybrid_time = read_txn->GetReadTimestamp();
   }
   // We expect all read operations for this transaction to be done in ApplyDocWriteOperation.
@@ -2765,12 +3429,19 @@ Status Tablet::StartDocWriteOperation(const vector<unique_ptr<DocOperation>> &do
     TransactionConflictResolver resolver(*write_batch,
                                          hybrid_time,
                                          rocksdb_.get(),
-                                         transaction_participant_.get());
+                                         transaction_participant_.get(),
+                                         clock_.get());
     auto result = resolver.Resolve();
     if (!result.ok()) {
       *keys_locked = LockBatch();  // Unlock the keys.
       return result;
     }
+    if (write_batch->one_phase_commit()) {
+      // Conflicts are resolved and we hold the locks, so this write could be applied as regular
+      // values, i.e. committed immediately.
+      write_batch->clear_transaction();
+      write_batch->clear_one_phase_commit();
+    }
   }
 
   return Status::OK();
@@ -2812,6 +3483,108 @@ size_t Tablet::MemRowSetLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_se
                                      max_idx_to_segment_size);
 }
 
+size_t Tablet::MemTablesSize() const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  uint64_t result = 0;
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCurSizeAllMemTables, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+size_t Tablet::ActiveMemTableSize() const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  uint64_t result = 0;
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCurSizeActiveMemTable, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+bool Tablet::MemTablesEmpty() const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return true;
+  }
+  return flush_stats_->oldest_write_in_memstore() == HybridTime::kMax;
+}
+
+int Tablet::NumSstFilesDelayingWrites() const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  return rocksdb_->GetL0DelayTriggerCount();
+}
+
+uint64_t Tablet::RocksDBIntProperty(const std::string& property) const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || IsShutdownRequested()) {
+    return 0;
+  }
+  ScopedPendingOperation shutdown_guard(&pending_op_counter_);
+  uint64_t result = 0;
+  if (!rocksdb_ || !rocksdb_->GetIntProperty(property, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+std::vector<uint64_t> Tablet::RocksDBNumFilesPerLevel() const {
+  std::vector<uint64_t> result;
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || IsShutdownRequested()) {
+    return result;
+  }
+  ScopedPendingOperation shutdown_guard(&pending_op_counter_);
+  if (!rocksdb_) {
+    return result;
+  }
+  const int num_levels = rocksdb_->NumberLevels();
+  result.reserve(num_levels);
+  std::string value;
+  for (int level = 0; level < num_levels; ++level) {
+    uint64_t num_files = 0;
+    if (rocksdb_->GetProperty(
+            rocksdb::DB::Properties::kNumFilesAtLevelPrefix + std::to_string(level), &value)) {
+      num_files = ParseLeadingUInt64Value(value, 0);
+    }
+    result.push_back(num_files);
+  }
+  return result;
+}
+
+uint64_t Tablet::RocksDBNumLevel0Files() const {
+  const auto num_files = RocksDBNumFilesPerLevel();
+  return num_files.empty() ? 0 : num_files[0];
+}
+
+uint64_t Tablet::RocksDBPendingCompactionBytes() const {
+  return RocksDBIntProperty(rocksdb::DB::Properties::kEstimatePendingCompactionBytes);
+}
+
+uint64_t Tablet::RocksDBReadAmplification() const {
+  const auto num_files = RocksDBNumFilesPerLevel();
+  if (num_files.empty()) {
+    return 0;
+  }
+  // Each level 0 file is a sorted run of its own, while each deeper level is a single one.
+  return num_files[0] + std::count_if(
+      num_files.begin() + 1, num_files.end(), [](uint64_t n) { return n != 0; });
+}
+
+uint64_t Tablet::RocksDBNumImmutableMemTables() const {
+  return RocksDBIntProperty(rocksdb::DB::Properties::kNumImmutableMemTable);
+}
+
+size_t Tablet::MemTablesLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_segment_size) const {
+  if (MemTablesEmpty()) {
+    return 0;
+  }
+  // All log entries after the last flushed one could be required to restore the memtables.
+  return GetLogRetentionSizeForIndex(MaxPersistentOpId().index + 1, max_idx_to_segment_size);
+}
+
 size_t Tablet::EstimateOnDiskSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
@@ -2826,6 +3599,53 @@ size_t Tablet::EstimateOnDiskSize() const {
   return ret;
 }
 
+Status Tablet::GetExpiredDataSize(uint64_t* expired_bytes, uint64_t* total_bytes) {
+  *expired_bytes = 0;
+  *total_bytes = 0;
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return Status::OK();
+  }
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  rocksdb::TablePropertiesCollection properties;
+  RETURN_NOT_OK(rocksdb_->GetPropertiesOfAllTables(&properties));
+  // Expired records are removed by compactions only when they expired by the history cutoff.
+  const HybridTime history_cutoff = retention_policy_->GetHistoryCutoff();
+  for (const auto& file_and_properties : properties) {
+    const auto& file_properties = *file_and_properties.second;
+    *expired_bytes += docdb::ExpiredBytes(file_properties.user_collected_properties,
+                                          history_cutoff);
+    *total_bytes += file_properties.raw_key_size + file_properties.raw_value_size;
+  }
+  return Status::OK();
+}
+
+Status Tablet::GetTotalSstFilesSize(uint64_t* size) {
+  *size = 0;
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return Status::OK();
+  }
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kTotalSstFilesSize, size)) {
+    return STATUS(IllegalState, "Failed to get the size of SST files");
+  }
+  return Status::OK();
+}
+
+Status Tablet::CompactExpiredData() {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    return Status::OK();
+  }
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  // Expired records are removed only by full compactions, earlier ones just replace them with
+  // tombstones.
+  return rocksdb_->CompactRange(rocksdb::CompactRangeOptions(),
+                                /* begin = */ nullptr,
+                                /* end = */ nullptr);
+}
+
 size_t Tablet::DeltaMemStoresSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
@@ -3131,6 +3951,30 @@ HybridTime Tablet::SafeTimestampToRead() const {
   return mvcc_.GetMaxSafeTimeToReadAt();
 }
 
+void Tablet::BuildColumnarSnapshot() {
+  // The generation is taken first, so a write applied while the rows are read, even one below the
+  // read time, prevents the snapshot from being installed.
+  const auto write_generation = columnar_snapshots_->write_generation();
+  const HybridTime read_time = SafeTimestampToRead();
+  const auto dir = JoinPathSegments(JoinPathSegments(metadata_->rocksdb_dir(),
+                                                     kColumnarSnapshotsDir),
+                                    std::to_string(read_time.ToUint64()));
+  std::shared_ptr<docdb::ColumnarSnapshot> snapshot;
+  Status s = docdb::ColumnarSnapshot::Build(
+      *schema(), rocksdb_.get(), read_time, metadata_->fs_manager()->env(), dir, &snapshot);
+  if (!s.ok()) {
+    LOG(INFO) << "Tablet " << tablet_id() << ": not building a columnar snapshot: " << s;
+    return;
+  }
+  if (!columnar_snapshots_->Install(snapshot, write_generation)) {
+    LOG(INFO) << "Tablet " << tablet_id() << ": dropped columnar snapshot at " << read_time
+              << ", the tablet was written to while it was built";
+    return;
+  }
+  LOG(INFO) << "Tablet " << tablet_id() << ": built columnar snapshot of " << snapshot->num_rows()
+            << " rows at " << read_time;
+}
+
 HybridTime Tablet::OldestReadPoint() const {
   std::lock_guard<std::mutex> lock(active_readers_mutex_);
   if (active_readers_cnt_.empty()) {
@@ -3139,9 +3983,22 @@ HybridTime Tablet::OldestReadPoint() const {
   return active_readers_cnt_.begin()->first;
 }
 
-void Tablet::RegisterReaderTimestamp(HybridTime read_point) {
+HybridTime Tablet::UpdateHistoryCutoff(HybridTime proposed_cutoff) {
   std::lock_guard<std::mutex> lock(active_readers_mutex_);
+  HybridTime cutoff = std::min(proposed_cutoff, active_readers_cnt_.empty() ?
+      SafeTimestampToRead() : active_readers_cnt_.begin()->first);
+  history_cutoff_ = std::max(history_cutoff_, cutoff);
+  return history_cutoff_;
+}
+
+Status Tablet::RegisterReaderTimestamp(HybridTime read_point) {
+  std::lock_guard<std::mutex> lock(active_readers_mutex_);
+  if (read_point < history_cutoff_) {
+    return STATUS_FORMAT(
+        TryAgain, "Read time $0 is lower than history cutoff $1", read_point, history_cutoff_);
+  }
   active_readers_cnt_[read_point]++;
+  return Status::OK();
 }
 
 void Tablet::UnregisterReader(HybridTime timestamp) {
@@ -3214,13 +4071,25 @@ TransactionOperationContextOpt Tablet::CreateTransactionOperationContext(
   }
 }
 
-ScopedReadOperation::ScopedReadOperation(AbstractTablet* tablet)
+ScopedReadOperation::ScopedReadOperation(AbstractTablet* tablet, HybridTime max_read_time)
     : tablet_(tablet), timestamp_(tablet_->SafeTimestampToRead()) {
-  tablet_->RegisterReaderTimestamp(timestamp_);
+  const bool limited = max_read_time.is_valid() && max_read_time < timestamp_;
+  if (limited) {
+    timestamp_ = max_read_time;
+  }
+  status_ = tablet_->RegisterReaderTimestamp(timestamp_);
+  if (!status_.ok() && !limited) {
+    // The history cutoff could be moved past the safe time we got before registering. It is never
+    // higher than the safe time at the moment it is moved, so the current safe time could be used.
+    timestamp_ = tablet_->SafeTimestampToRead();
+    status_ = tablet_->RegisterReaderTimestamp(timestamp_);
+  }
 }
 
 ScopedReadOperation::~ScopedReadOperation() {
-  tablet_->UnregisterReader(timestamp_);
+  if (status_.ok()) {
+    tablet_->UnregisterReader(timestamp_);
+  }
 }
 
 HybridTime ScopedReadOperation::GetReadTimestamp() {
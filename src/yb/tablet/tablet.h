@@ -79,6 +79,7 @@
 #include "yb/util/pending_op_counter.h"
 #include "yb/util/semaphore.h"
 #include "yb/util/slice.h"
+#include "yb/util/space_saving.h"
 #include "yb/util/status.h"
 #include "yb/util/countdown_latch.h"
 
@@ -112,6 +113,7 @@ class CompactionPolicy;
 class MemRowSet;
 class MvccSnapshot;
 struct RowOp;
+class RocksDBJobTimeline;
 class RowSetsInCompaction;
 class RowSetTree;
 class ScopedReadOperation;
@@ -208,6 +210,14 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   CHECKED_STATUS ImportData(const std::string& source_dir);
 
+  // Checks that the RocksDB database in source_dir could be ingested into this tablet, i.e. that
+  // all its keys belong to the tablet and none of its records is after max_hybrid_time.
+  CHECKED_STATUS ValidateIngestFiles(const std::string& source_dir, HybridTime max_hybrid_time);
+
+  // Hard links the files of the RocksDB database in source_dir into the tablet's RocksDB. The
+  // op_id is recorded as flushed together with the files, so the operation is not replayed.
+  CHECKED_STATUS IngestFiles(const std::string& source_dir, const consensus::OpId& op_id);
+
   CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) override;
 
   // Decode the Write (insert/mutate) operations from within a user's request.
@@ -279,6 +289,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Apply all of the row operations associated with this transaction.
   void ApplyRowOperations(WriteOperationState* operation_state);
 
+  // Apply row operations of several write transactions of a key-value tablet, using a single
+  // RocksDB write. Transactions should be ordered by their op ids.
+  void ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states);
+
   // Apply a single row operation, which must already be prepared.
   // The result is set back into row_op->result
   void ApplyKuduRowOperation(WriteOperationState* operation_state,
@@ -291,6 +305,16 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime hybrid_time,
       rocksdb::WriteBatch* rocksdb_write_batch = nullptr);
 
+  // Adds a set of RocksDB row operations to rocksdb_write_batch without writing it.
+  // Returns false if there was nothing to add.
+  bool PrepareKeyValueRowOperations(
+      const docdb::KeyValueWriteBatchPB& put_batch,
+      const consensus::OpId& op_id,
+      HybridTime hybrid_time,
+      rocksdb::WriteBatch* rocksdb_write_batch);
+
+  void WriteToRocksDB(rocksdb::WriteBatch* rocksdb_write_batch);
+
   // Takes a Redis WriteRequestPB as input with its redis_write_batch.
   // Constructs a WriteRequestPB containing a serialized WriteBatch that will be
   // replicated by Raft. (Makes a copy, it is caller's responsibility to deallocate
@@ -337,6 +361,19 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   CHECKED_STATUS CreateCheckpoint(const std::string& dir,
       google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files = nullptr);
 
+  // Snapshots are RocksDB checkpoints kept in the tablet's snapshots directory. The operations on
+  // them are replicated, so every replica performs them at the same position in its log.
+  std::string SnapshotDir(const std::string& snapshot_id) const;
+
+  // Does nothing if the snapshot already exists, e.g. when the operation is replayed by bootstrap.
+  CHECKED_STATUS CreateSnapshot(const std::string& snapshot_id);
+
+  // Replaces the tablet's RocksDB with hard links to the files of the snapshot, and records op_id
+  // as flushed so the operations before the restore are not replayed over the restored data.
+  CHECKED_STATUS RestoreSnapshot(const std::string& snapshot_id, const consensus::OpId& op_id);
+
+  CHECKED_STATUS DeleteSnapshot(const std::string& snapshot_id);
+
   // Create a new row iterator which yields the rows as of the current MVCC
   // state of this tablet.
   // The returned iterator is not initialized.
@@ -421,6 +458,45 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Returns the size in bytes for the MRS's log retention.
   size_t MemRowSetLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_segment_size) const;
 
+  // Returns the approximate size of RocksDB memtables of a key-value tablet, in bytes.
+  size_t MemTablesSize() const;
+
+  // Returns the approximate size of the RocksDB memtable of a key-value tablet that is not yet
+  // scheduled for flush, in bytes.
+  size_t ActiveMemTableSize() const;
+
+  // Returns true if RocksDB memtables don't have writes that were not scheduled for flush yet.
+  bool MemTablesEmpty() const;
+
+  // Returns the number of SST files of a key-value tablet that RocksDB counts towards its write
+  // slowdown and stop triggers, i.e. how far compactions are behind writes.
+  int NumSstFilesDelayingWrites() const;
+
+  // RocksDB internals of a key-value tablet, exported as tablet metrics. 0 for other tablets.
+  uint64_t RocksDBNumLevel0Files() const;
+  uint64_t RocksDBPendingCompactionBytes() const;
+  // Number of sorted runs a read could look into: the level 0 files and the non-empty levels.
+  uint64_t RocksDBReadAmplification() const;
+  uint64_t RocksDBNumImmutableMemTables() const;
+
+  // The most recent flushes and compactions of RocksDB.
+  const RocksDBJobTimeline& rocksdb_job_timeline() const { return *rocksdb_job_timeline_; }
+
+  // Returns the size in bytes of the log retained because of writes that are not yet flushed from
+  // RocksDB memtables.
+  size_t MemTablesLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_segment_size) const;
+
+  // Estimates, using expiration indexes of SST files of a key-value tablet, the size of records
+  // that expired by the history cutoff, so they would be removed by a full compaction. Sizes are
+  // uncompressed sizes of keys and values, total_bytes is the size of all records in SST files.
+  CHECKED_STATUS GetExpiredDataSize(uint64_t* expired_bytes, uint64_t* total_bytes);
+
+  // Runs a full compaction of a key-value tablet, that removes expired records, and waits for it.
+  CHECKED_STATUS CompactExpiredData();
+
+  // Returns the total size of the SST files of a key-value tablet, 0 for other tablets.
+  CHECKED_STATUS GetTotalSstFilesSize(uint64_t* size);
+
   // Estimate the total on-disk size of this tablet, in bytes.
   size_t EstimateOnDiskSize() const;
 
@@ -536,6 +612,20 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Returns the maximum persistent op id from all SSTables in RocksDB.
   yb::OpId MaxPersistentOpId() const;
 
+  // Returns the partition key that splits data of this hash partitioned tablet into two parts of
+  // approximately equal size. The estimate is based on sizes and key boundaries of SST files, data
+  // of each file is assumed to be uniformly distributed over hash codes between its boundaries.
+  Result<std::string> GetEncodedMiddleSplitKey() const;
+
+  // Most frequent encoded DocKeys among the sampled reads and writes of a key-value tablet, see
+  // --tablet_hot_key_sample_rate. QL reads are counted against the key of their hash partition.
+  const SpaceSaving& hot_read_keys() const { return hot_read_keys_; }
+  const SpaceSaving& hot_write_keys() const { return hot_write_keys_; }
+
+  // Percentage of the sampled reads / writes that accessed the most frequent key.
+  uint64_t HotReadKeyPercentage() const;
+  uint64_t HotWriteKeyPercentage() const;
+
   // Returns the location of the last rocksdb checkpoint. Used for tests only.
   std::string GetLastRocksDBCheckpointDirForTest() { return last_rocksdb_checkpoint_dir_; }
 
@@ -550,6 +640,15 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // This is used to figure out what can be garbage collected during a compaction.
   HybridTime OldestReadPoint() const;
 
+  // Returns the history cutoff for a compaction: the highest hybrid time that is not higher than
+  // proposed_cutoff, the oldest active read point and the safe time to read, and never lower than
+  // a previously returned cutoff. Reads at a time lower than the cutoff are not registered anymore.
+  HybridTime UpdateHistoryCutoff(HybridTime proposed_cutoff);
+
+  // Builds a columnar snapshot of the rows of a QL tablet at the safe time to read, and installs it
+  // unless the tablet is written to meanwhile. Called after major compactions.
+  void BuildColumnarSnapshot();
+
   // The HybridTime of the oldest write that is still not scheduled to be flushed in RocksDB.
   TabletFlushStats* flush_stats() const { return flush_stats_.get(); }
 
@@ -705,9 +804,23 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   CHECKED_STATUS OpenKeyValueTablet();
   CHECKED_STATUS OpenKuduColumnarTablet();
 
+  // Adds the SST directories on the other data roots to the RocksDB options of this tablet, see
+  // --rocksdb_stripe_sst_files_across_data_dirs.
+  CHECKED_STATUS SetupSstStripeDirs(const std::string& db_dir, rocksdb::Options* options);
+
+  // Reopens RocksDB with the files of the checkpoint, reads and writes must be stopped.
+  CHECKED_STATUS ReopenFromCheckpoint(const std::string& checkpoint_dir,
+                                      const consensus::OpId& op_id);
+
   CHECKED_STATUS KuduDebugDump(vector<std::string> *lines);
   CHECKED_STATUS DocDBDebugDump(vector<std::string> *lines);
 
+  // Returns the integer RocksDB property of a key-value tablet, 0 when it is not available.
+  uint64_t RocksDBIntProperty(const std::string& property) const;
+
+  // Returns the number of SST files in each RocksDB level of a key-value tablet.
+  std::vector<uint64_t> RocksDBNumFilesPerLevel() const;
+
   // Helper method to find the rowset that has the DMS with the highest retention.
   std::shared_ptr<RowSet> FindBestDMSToFlush(
       const MaxIdxToSegmentMap& max_idx_to_segment_size) const;
@@ -718,7 +831,7 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   // Register/Unregister a read operation, with an associated timestamp, for the purpose of
   // tracking the oldest read point.
-  void RegisterReaderTimestamp(HybridTime read_point) override;
+  CHECKED_STATUS RegisterReaderTimestamp(HybridTime read_point) override;
   void UnregisterReader(HybridTime read_point) override;
   HybridTime SafeTimestampToRead() const override;
 
@@ -795,6 +908,8 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Maps a timestamp to the number active readers with that timestamp.
   // TODO(ENG-961): Check if this is a point of contention. If so, shard it as suggested in D1219.
   std::map<HybridTime, int64_t> active_readers_cnt_;
+  // History before this hybrid time could be garbage collected by compactions.
+  HybridTime history_cutoff_ = HybridTime::kMin;
   mutable std::mutex active_readers_mutex_;
 
   // This is used for Kudu tables only. Docdb uses shared_lock_manager_. lock_manager_ may be
@@ -813,7 +928,7 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // started earlier completes after the one started later.
   mutable Semaphore rowsets_flush_sem_{1};
 
-  // Lock used to serialize the creation of RocksDB checkpoints.
+  // Lock used to serialize the creation of RocksDB checkpoints and restores from them.
   mutable std::mutex create_checkpoint_lock_;
 
   enum State {
@@ -839,6 +954,22 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   std::unique_ptr<common::QLStorageIf> ql_storage_;
 
+  // Range of keys of this tablet, records outside of it are removed by compactions.
+  docdb::KeyBounds key_bounds_;
+
+  // Latest values of recently written keys, used by read-modify-write operations of Redis tables.
+  std::unique_ptr<docdb::RedisValueCache> redis_value_cache_;
+
+  // Small Redis collections assembled by previous reads, used instead of reading them from RocksDB.
+  std::unique_ptr<docdb::DocumentCache> document_cache_;
+
+  // Sketches of the keys of sampled reads and writes, used to find hot keys.
+  SpaceSaving hot_read_keys_;
+  SpaceSaving hot_write_keys_;
+
+  // Columnar snapshot of the rows of a QL tablet, used by scans until the tablet is written to.
+  std::unique_ptr<docdb::ColumnarSnapshotHolder> columnar_snapshots_;
+
   // This is for docdb fine-grained locking.
   docdb::SharedLockManager shared_lock_manager_;
 
@@ -876,6 +1007,8 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // be flushed in RocksDB.
   std::shared_ptr<TabletFlushStats> flush_stats_;
 
+  std::shared_ptr<RocksDBJobTimeline> rocksdb_job_timeline_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Tablet);
 };
@@ -886,15 +1019,21 @@ typedef std::shared_ptr<Tablet> TabletPtr;
 // when created, and deregisters the read point when this object is destructed.
 class ScopedReadOperation {
  public:
-  explicit ScopedReadOperation(AbstractTablet* tablet);
+  // Reads at the safe time of the tablet, but not higher than max_read_time if it is valid.
+  // status() is not OK if the history at max_read_time could already be garbage collected.
+  explicit ScopedReadOperation(
+      AbstractTablet* tablet, HybridTime max_read_time = HybridTime::kInvalid);
 
   ~ScopedReadOperation();
 
   HybridTime GetReadTimestamp();
 
+  const Status& status() const { return status_; }
+
  private:
   AbstractTablet* tablet_;
   HybridTime timestamp_;
+  Status status_;
 };
 
 // Hooks used in test code to inject faults or other code into interesting
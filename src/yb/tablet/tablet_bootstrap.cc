@@ -39,6 +39,7 @@
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/snapshot_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/util/fault_injection.h"
@@ -51,6 +52,12 @@ DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
 TAG_FLAG(skip_remove_old_recovery_dir, hidden);
 
+DEFINE_int32(tablet_bootstrap_readahead_segments, 1,
+             "Number of WAL segments that are read ahead by a background thread while entries of "
+             "the current segment are replayed during tablet bootstrap. 0 to read segments "
+             "synchronously.");
+TAG_FLAG(tablet_bootstrap_readahead_segments, advanced);
+
 DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after processing a log entry during log replay.");
@@ -84,6 +91,9 @@ using strings::Substitute;
 using tserver::AlterSchemaRequestPB;
 using tserver::WriteRequestPB;
 
+// Maximum number of already flushed entries that are copied to the new log in a single batch.
+static constexpr size_t kMaxFlushedEntriesPerBatch = 1000;
+
 static string DebugInfo(const string& tablet_id,
                         int segment_seqno,
                         int entry_idx,
@@ -455,7 +465,9 @@ Status TabletBootstrap::OpenNewLog() {
   OpId init;
   init.set_term(0);
   init.set_index(0);
-  RETURN_NOT_OK(Log::Open(LogOptions(),
+  LogOptions log_options;
+  log_options.sync_coordinator = tablet_options_.log_sync_coordinator;
+  RETURN_NOT_OK(Log::Open(log_options,
                           tablet_->metadata()->fs_manager(),
                           tablet_->tablet_id(),
                           tablet_->metadata()->wal_dir(),
@@ -549,17 +561,17 @@ Status TabletBootstrap::HandleReplicateMessage(ReplayState* state,
     state->rocksdb_last_entry_hybrid_time = HybridTime(replicate.hybrid_time());
   }
 
-  // Append the replicate message to the log as is
-  RETURN_NOT_OK(log_->Append(replicate_entry_ptr->get()));
-
   if (non_kudu && op_id.index() <= state->last_stored_op_id.index()) {
     // Do not update the bootstrap in-memory state for log records that have already been applied
     // to RocksDB, or were overwritten by a later entry with a higher term that has already been
-    // applied to RocksDB.
-    replicate_entry_ptr->reset();
-    return Status::OK();
+    // applied to RocksDB. Such records are only copied to the new log.
+    return AppendFlushedEntry(replicate_entry_ptr);
   }
 
+  // Append the replicate message to the log as is
+  RETURN_NOT_OK(AppendPendingFlushedEntries());
+  RETURN_NOT_OK(log_->Append(replicate_entry_ptr->get()));
+
   auto iter = state->pending_replicates.lower_bound(op_id.index());
 
   // If there was a entry with the same index we're overwriting then we need to delete
@@ -595,6 +607,28 @@ Status TabletBootstrap::HandleReplicateMessage(ReplayState* state,
   return Status::OK();
 }
 
+Status TabletBootstrap::AppendFlushedEntry(std::unique_ptr<LogEntryPB>* replicate_entry) {
+  pending_flushed_entries_.push_back(std::move(*replicate_entry));
+  if (pending_flushed_entries_.size() >= kMaxFlushedEntriesPerBatch) {
+    return AppendPendingFlushedEntries();
+  }
+  return Status::OK();
+}
+
+Status TabletBootstrap::AppendPendingFlushedEntries() {
+  if (pending_flushed_entries_.empty()) {
+    return Status::OK();
+  }
+  std::vector<LogEntryPB*> entries;
+  entries.reserve(pending_flushed_entries_.size());
+  for (const auto& entry : pending_flushed_entries_) {
+    entries.push_back(entry.get());
+  }
+  Status s = log_->Append(entries);
+  pending_flushed_entries_.clear();
+  return s;
+}
+
 // Takes ownership of 'commit_entry' on OK status.
 Status TabletBootstrap::HandleCommitMessage(ReplayState* state,
                                             std::unique_ptr<LogEntryPB>* commit_entry_ptr) {
@@ -735,11 +769,13 @@ Status TabletBootstrap::HandleOperation(OperationType op_type,
     case consensus::UPDATE_TRANSACTION_OP:
       return PlayUpdateTransactionRequest(replicate, commit);
 
-    // Unexpected cases:
+    case consensus::INGEST_FILES_OP:
+      return PlayIngestFilesRequest(replicate, commit);
+
     case consensus::SNAPSHOT_OP:
-      return STATUS(IllegalState, Substitute(
-          "The operation is not supported in the community edition: $0", op_type));
+      return PlaySnapshotRequest(replicate, commit);
 
+    // Unexpected cases:
     case consensus::UNKNOWN_OP:
       return STATUS(IllegalState, Substitute("Unsupported operation type: $0", op_type));
   }
@@ -870,11 +906,18 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   // writing.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
+  const size_t num_segments = segments.size();
+  log::ReadAheadSegmentReader segment_reader(
+      std::move(segments), std::max(FLAGS_tablet_bootstrap_readahead_segments, 0));
+  segment_reader.Start();
+
+  const MonoTime start_time = MonoTime::Now(MonoTime::FINE);
   int segment_count = 0;
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    log::LogEntries entries;
-    // TODO: Optimize this to not read the whole thing into memory?
-    Status read_status = segment->ReadEntries(&entries);
+  size_t entries_replayed = 0;
+  scoped_refptr<ReadableLogSegment> segment;
+  log::LogEntries entries;
+  Status read_status;
+  while (segment_reader.Next(&segment, &entries, &read_status)) {
     for (int entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
       Status s = HandleEntry(&state, &entries[entry_idx]);
       if (!s.ok()) {
@@ -902,16 +945,17 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
                                            segment->path()));
     }
 
-    // TODO: could be more granular here and log during the segments as well,
-    // plus give info about number of MB processed, but this is better than
-    // nothing.
-    listener_->StatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
-                                        "Stats: $2. Pending: $3 replicates",
-                                        segment_count + 1, log_reader_->num_segments(),
+    entries_replayed += entries.size();
+    const MonoDelta elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start_time);
+    listener_->StatusMessage(Substitute("Bootstrap replayed $0/$1 log segments, $2 entries in "
+                                        "$3 ms. Stats: $4. Pending: $5 replicates",
+                                        segment_count + 1, num_segments, entries_replayed,
+                                        elapsed.ToMilliseconds(),
                                         stats_.ToString(),
                                         state.pending_replicates.size()));
     segment_count++;
   }
+  RETURN_NOT_OK(AppendPendingFlushedEntries());
 
   // If we have non-applied commits they all must belong to pending operations and
   // they should only pertain to unflushed stores. This is specific to Kudu tables, because we don't
@@ -1016,6 +1060,7 @@ Status TabletBootstrap::AppendCommitMsg(const CommitMsg& commit_msg) {
   commit_entry.set_type(log::COMMIT);
   CommitMsg* commit = commit_entry.mutable_commit();
   commit->CopyFrom(commit_msg);
+  RETURN_NOT_OK(AppendPendingFlushedEntries());
   return log_->Append(&commit_entry);
 }
 
@@ -1060,6 +1105,7 @@ Status TabletBootstrap::PlayWriteRequest(ReplicateMsg* replicate_msg,
     CommitMsg* commit = commit_entry.mutable_commit();
     commit->CopyFrom(*commit_msg);
     operation_state.ReleaseTxResultPB(commit->mutable_result());
+    RETURN_NOT_OK(AppendPendingFlushedEntries());
     RETURN_NOT_OK(log_->Append(&commit_entry));
   }
 
@@ -1146,6 +1192,27 @@ Status TabletBootstrap::PlayUpdateTransactionRequest(ReplicateMsg* replicate_msg
   return Status::OK();
 }
 
+Status TabletBootstrap::PlayIngestFilesRequest(ReplicateMsg* replicate_msg,
+                                               const CommitMsg* commit_msg) {
+  // The flushed op id is recorded together with the ingested files, so we only get here when the
+  // files were not ingested before the restart.
+  RETURN_NOT_OK_PREPEND(
+      tablet_->IngestFiles(replicate_msg->ingest_files_request().source_dir(), replicate_msg->id()),
+      "Failed to IngestFiles:");
+
+  return commit_msg == nullptr ? Status::OK() : AppendCommitMsg(*commit_msg);
+}
+
+Status TabletBootstrap::PlaySnapshotRequest(ReplicateMsg* replicate_msg,
+                                            const CommitMsg* commit_msg) {
+  SnapshotOperationState operation_state(nullptr, replicate_msg->mutable_snapshot_request());
+  operation_state.mutable_op_id()->CopyFrom(replicate_msg->id());
+
+  RETURN_NOT_OK(operation_state.Apply(tablet_.get()));
+
+  return commit_msg == nullptr ? Status::OK() : AppendCommitMsg(*commit_msg);
+}
+
 Status TabletBootstrap::PlayRowOperations(WriteOperationState* operation_state,
                                           const TxResultPB* result) {
   Schema inserts_schema;
@@ -216,6 +216,12 @@ class TabletBootstrap {
   Status PlayUpdateTransactionRequest(consensus::ReplicateMsg* replicate_msg,
                                       const consensus::CommitMsg* commit_msg);
 
+  Status PlayIngestFilesRequest(consensus::ReplicateMsg* replicate_msg,
+                                const consensus::CommitMsg* commit_msg);
+
+  Status PlaySnapshotRequest(consensus::ReplicateMsg* replicate_msg,
+                             const consensus::CommitMsg* commit_msg);
+
   Status PlayAlterSchemaRequest(consensus::ReplicateMsg* replicate_msg,
                                 const consensus::CommitMsg* commit_msg);
 
@@ -265,6 +271,12 @@ class TabletBootstrap {
       ReplayState* state, std::unique_ptr<log::LogEntryPB>* replicate_entry);
   CHECKED_STATUS HandleCommitMessage(
       ReplayState* state, std::unique_ptr<log::LogEntryPB>* commit_entry);
+
+  // Entries that were already applied to RocksDB are only copied to the new log, so they are
+  // accumulated and appended as a single batch instead of one by one.
+  CHECKED_STATUS AppendFlushedEntry(std::unique_ptr<log::LogEntryPB>* replicate_entry);
+  // Appends accumulated flushed entries, should be invoked before appending anything else.
+  CHECKED_STATUS AppendPendingFlushedEntries();
   CHECKED_STATUS ApplyCommitMessage(ReplayState* state, const log::LogEntryPB& commit_entry);
   CHECKED_STATUS HandleEntryPair(
       log::LogEntryPB* replicate_entry, const log::LogEntryPB* commit_entry);
@@ -296,6 +308,9 @@ class TabletBootstrap {
   scoped_refptr<log::Log> log_;
   gscoped_ptr<log::LogReader> log_reader_;
 
+  // Entries that were already applied to RocksDB and are not yet appended to the new log.
+  log::LogEntries pending_flushed_entries_;
+
   gscoped_ptr<consensus::ConsensusMetadata> cmeta_;
   TabletOptions tablet_options_;
 
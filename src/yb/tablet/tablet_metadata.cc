@@ -49,12 +49,14 @@
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/strings/util.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/metadata.h"
 #include "yb/tablet/rowset_metadata.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/util/debug/trace_event.h"
+#include "yb/util/env.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/pb_util.h"
@@ -69,6 +71,14 @@ TAG_FLAG(enable_tablet_orphaned_block_deletion, advanced);
 TAG_FLAG(enable_tablet_orphaned_block_deletion, hidden);
 TAG_FLAG(enable_tablet_orphaned_block_deletion, runtime);
 
+DEFINE_bool(retain_rocksdb_files_on_tombstone, false,
+            "Keep the RocksDB files of a tombstoned tablet, so that the files that did not "
+            "change could be reused instead of downloaded when the tablet is remote "
+            "bootstrapped again. The files take disk space until then or until the tablet is "
+            "deleted.");
+TAG_FLAG(retain_rocksdb_files_on_tombstone, advanced);
+TAG_FLAG(retain_rocksdb_files_on_tombstone, runtime);
+
 using std::shared_ptr;
 
 using base::subtle::Barrier_AtomicIncrement;
@@ -235,19 +245,57 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
   }
 
   if (table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
-    rocksdb::Options rocksdb_options;
-    TabletOptions tablet_options;
-    docdb::InitRocksDBOptions(
-        &rocksdb_options, tablet_id_, nullptr /* statistics */, tablet_options);
-
-    LOG(INFO) << "Destroying RocksDB at: " << rocksdb_dir_;
-    rocksdb::Status status = rocksdb::DestroyDB(rocksdb_dir_, rocksdb_options);
+    // Files retained by an earlier tombstone are replaced by the current ones, or are not needed
+    // anymore when the tablet is deleted.
+    Env* const env = fs_manager()->env();
+    const auto retained_dir = retained_rocksdb_dir();
+    if (env->FileExists(retained_dir)) {
+      WARN_NOT_OK(env->DeleteRecursively(retained_dir),
+                  Substitute("Failed to delete retained RocksDB files at $0", retained_dir));
+    }
+    // Snapshots are a part of the tablet data, so they are deleted together with it.
+    const auto snapshots_dir = this->snapshots_dir();
+    if (env->FileExists(snapshots_dir)) {
+      WARN_NOT_OK(env->DeleteRecursively(snapshots_dir),
+                  Substitute("Failed to delete snapshots at $0", snapshots_dir));
+    }
+    // SST files on the other data roots are not retained, since they could not be moved together
+    // with the rest of RocksDB.
+    bool striped = false;
+    for (const auto& dir : sst_stripe_dirs()) {
+      if (env->FileExists(dir)) {
+        striped = true;
+        WARN_NOT_OK(env->DeleteRecursively(dir),
+                    Substitute("Failed to delete RocksDB SST files at $0", dir));
+      }
+    }
+    bool retained = false;
+    if (delete_type == TABLET_DATA_TOMBSTONED && FLAGS_retain_rocksdb_files_on_tombstone &&
+        !striped && env->FileExists(rocksdb_dir_)) {
+      Status s = env->RenameFile(rocksdb_dir_, retained_dir);
+      if (s.ok()) {
+        LOG(INFO) << "Retained RocksDB files of tombstoned tablet at: " << retained_dir;
+        retained = true;
+      } else {
+        LOG(WARNING) << "Failed to retain RocksDB files at " << retained_dir << ": " << s;
+      }
+    }
 
-    if (!status.ok()) {
-      LOG(ERROR) << "Failed to destroy RocksDB at: " << rocksdb_dir_ << ": "
-                 << status.ToString();
-    } else {
-      LOG(INFO) << "Successfully destroyed RocksDB at: " << rocksdb_dir_;
+    if (!retained) {
+      rocksdb::Options rocksdb_options;
+      TabletOptions tablet_options;
+      docdb::InitRocksDBOptions(
+          &rocksdb_options, tablet_id_, nullptr /* statistics */, tablet_options);
+
+      LOG(INFO) << "Destroying RocksDB at: " << rocksdb_dir_;
+      rocksdb::Status status = rocksdb::DestroyDB(rocksdb_dir_, rocksdb_options);
+
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to destroy RocksDB at: " << rocksdb_dir_ << ": "
+                   << status.ToString();
+      } else {
+        LOG(INFO) << "Successfully destroyed RocksDB at: " << rocksdb_dir_;
+      }
     }
   }
 
@@ -731,6 +779,22 @@ string TabletMetadata::data_root_dir() const {
   }
 }
 
+std::vector<std::string> TabletMetadata::sst_stripe_dirs() const {
+  std::vector<std::string> result;
+  const auto data_root = data_root_dir();
+  if (data_root.empty() || !HasPrefixString(rocksdb_dir_, data_root)) {
+    return result;
+  }
+  // The same path relative to the data root is used on every other data root.
+  const auto relative_dir = rocksdb_dir_.substr(data_root.size());
+  for (const auto& dir : fs_manager_->GetDataRootDirs()) {
+    if (dir != data_root) {
+      result.push_back(dir + relative_dir);
+    }
+  }
+  return result;
+}
+
 string TabletMetadata::wal_root_dir() const {
   if (wal_dir_.empty()) {
     return "";
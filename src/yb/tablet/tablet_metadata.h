@@ -145,6 +145,18 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
 
   std::string rocksdb_dir() const { return rocksdb_dir_; }
 
+  // The directory where the RocksDB files of a tombstoned tablet are kept, so a later remote
+  // bootstrap could reuse them. See --retain_rocksdb_files_on_tombstone.
+  std::string retained_rocksdb_dir() const { return rocksdb_dir_ + ".retained"; }
+
+  // The directory with one RocksDB checkpoint per snapshot of the tablet.
+  std::string snapshots_dir() const { return rocksdb_dir_ + ".snapshots"; }
+
+  // The directories on the other data roots where RocksDB could place the SST files of a large
+  // tablet, in the order they are filled after rocksdb_dir(). Only the existing ones are used,
+  // see --rocksdb_stripe_sst_files_across_data_dirs.
+  std::vector<std::string> sst_stripe_dirs() const;
+
   std::string wal_dir() const { return wal_dir_; }
 
   // Given the data directory of a tablet, returns the data root dir for that tablet.
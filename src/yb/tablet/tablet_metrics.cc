@@ -31,7 +31,9 @@
 //
 #include "yb/tablet/tablet_metrics.h"
 
+#include "yb/docdb/intent_aware_iterator.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rocksdb/perf_context.h"
 #include "yb/util/metrics.h"
 #include "yb/util/trace.h"
 
@@ -231,6 +233,42 @@ METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   yb::MetricUnit::kRequests,
   "Number of RPC requests rejected due to memory pressure while LEADER.");
 
+METRIC_DEFINE_counter(tablet, leader_compaction_pressure_rejections,
+  "Leader Compaction Pressure Rejections",
+  yb::MetricUnit::kRequests,
+  "Number of RPC requests rejected while LEADER because compactions fall behind writes.");
+
+METRIC_DEFINE_counter(tablet, docdb_block_cache_hits, "DocDB Block Cache Hits",
+  yb::MetricUnit::kCacheHits,
+  "Number of block cache hits of reads and writes of this tablet.");
+
+METRIC_DEFINE_counter(tablet, docdb_block_reads, "DocDB Block Reads",
+  yb::MetricUnit::kBlocks,
+  "Number of blocks that reads and writes of this tablet missed in the block cache and read "
+  "from files.");
+
+METRIC_DEFINE_counter(tablet, docdb_block_read_bytes, "DocDB Block Read Bytes",
+  yb::MetricUnit::kBytes,
+  "Number of bytes of blocks that reads and writes of this tablet read from files.");
+
+METRIC_DEFINE_counter(tablet, docdb_seeks, "DocDB Seeks",
+  yb::MetricUnit::kOperations,
+  "Number of RocksDB iterator seeks of reads and writes of this tablet.");
+
+METRIC_DEFINE_counter(tablet, docdb_nexts, "DocDB Nexts",
+  yb::MetricUnit::kOperations,
+  "Number of RocksDB iterator Next and Prev calls of reads and writes of this tablet.");
+
+METRIC_DEFINE_counter(tablet, docdb_entries_skipped, "DocDB Entries Skipped",
+  yb::MetricUnit::kEntries,
+  "Number of older versions and deletes of keys that reads and writes of this tablet skipped "
+  "over.");
+
+METRIC_DEFINE_counter(tablet, docdb_intent_seeks, "DocDB Intent Seeks",
+  yb::MetricUnit::kOperations,
+  "Number of seeks for provisional records of transactions done by reads and writes of this "
+  "tablet.");
+
 using strings::Substitute;
 
 namespace yb {
@@ -275,7 +313,15 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(compact_rs_duration),
     MINIT(delta_minor_compact_rs_duration),
     MINIT(delta_major_compact_rs_duration),
-    MINIT(leader_memory_pressure_rejections) {
+    MINIT(leader_memory_pressure_rejections),
+    MINIT(leader_compaction_pressure_rejections),
+    MINIT(docdb_block_cache_hits),
+    MINIT(docdb_block_reads),
+    MINIT(docdb_block_read_bytes),
+    MINIT(docdb_seeks),
+    MINIT(docdb_nexts),
+    MINIT(docdb_entries_skipped),
+    MINIT(docdb_intent_seeks) {
 }
 #undef MINIT
 #undef GINIT
@@ -296,6 +342,56 @@ void TabletMetrics::AddProbeStats(const ProbeStats& stats) {
         stats.deltas_consulted, stats.mrs_consulted);
 }
 
+StorageCost StorageCost::OfThread() {
+  const auto& perf = rocksdb::perf_context;
+  StorageCost result;
+  result.block_cache_hits = perf.block_cache_hit_count;
+  result.block_reads = perf.block_read_count;
+  result.block_read_bytes = perf.block_read_byte;
+  result.seeks = perf.iter_seek_count;
+  result.nexts = perf.iter_next_count + perf.iter_prev_count;
+  result.entries_skipped = perf.internal_key_skipped_count + perf.internal_delete_skipped_count;
+  result.intent_seeks = docdb::ThreadIntentSeekCount();
+  return result;
+}
+
+StorageCost& StorageCost::operator-=(const StorageCost& rhs) {
+  block_cache_hits -= rhs.block_cache_hits;
+  block_reads -= rhs.block_reads;
+  block_read_bytes -= rhs.block_read_bytes;
+  seeks -= rhs.seeks;
+  nexts -= rhs.nexts;
+  entries_skipped -= rhs.entries_skipped;
+  intent_seeks -= rhs.intent_seeks;
+  return *this;
+}
+
+void TabletMetrics::AddStorageCost(const StorageCost& cost) {
+  docdb_block_cache_hits->IncrementBy(cost.block_cache_hits);
+  docdb_block_reads->IncrementBy(cost.block_reads);
+  docdb_block_read_bytes->IncrementBy(cost.block_read_bytes);
+  docdb_seeks->IncrementBy(cost.seeks);
+  docdb_nexts->IncrementBy(cost.nexts);
+  docdb_entries_skipped->IncrementBy(cost.entries_skipped);
+  docdb_intent_seeks->IncrementBy(cost.intent_seeks);
+
+  TRACE("StorageCost: block_cache_hits=$0,block_reads=$1,block_read_bytes=$2,seeks=$3,"
+        "nexts=$4,entries_skipped=$5,intent_seeks=$6",
+        cost.block_cache_hits, cost.block_reads, cost.block_read_bytes, cost.seeks,
+        cost.nexts, cost.entries_skipped, cost.intent_seeks);
+}
+
+ScopedStorageCostTracker::ScopedStorageCostTracker(TabletMetrics* metrics)
+    : metrics_(metrics), start_(StorageCost::OfThread()) {}
+
+ScopedStorageCostTracker::~ScopedStorageCostTracker() {
+  if (metrics_ != nullptr) {
+    auto cost = StorageCost::OfThread();
+    cost -= start_;
+    metrics_->AddStorageCost(cost);
+  }
+}
+
 ScopedTabletMetricsTracker::ScopedTabletMetricsTracker(scoped_refptr<Histogram> latency)
     : latency_(latency), start_time_(MonoTime::FineNow()) {}
 
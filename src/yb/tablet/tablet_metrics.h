@@ -47,12 +47,33 @@ namespace tablet {
 
 struct ProbeStats;
 
+// Work done by the storage engine of a key-value tablet for one read or write.
+struct StorageCost {
+  uint64_t block_cache_hits = 0;
+  // Blocks read from files, i.e. block cache misses.
+  uint64_t block_reads = 0;
+  uint64_t block_read_bytes = 0;
+  uint64_t seeks = 0;
+  // Next and Prev calls.
+  uint64_t nexts = 0;
+  // Older versions and deletes hidden by newer records and skipped over.
+  uint64_t entries_skipped = 0;
+  uint64_t intent_seeks = 0;
+
+  // Work done by the current thread so far.
+  static StorageCost OfThread();
+
+  StorageCost& operator-=(const StorageCost& rhs);
+};
+
 // Container for all metrics specific to a single tablet.
 struct TabletMetrics {
   explicit TabletMetrics(const scoped_refptr<MetricEntity>& metric_entity);
 
   void AddProbeStats(const ProbeStats& stats);
 
+  void AddStorageCost(const StorageCost& cost);
+
   // Operation rates
   scoped_refptr<Counter> rows_inserted;
   scoped_refptr<Counter> rows_updated;
@@ -98,6 +119,16 @@ struct TabletMetrics {
   scoped_refptr<Histogram> delta_major_compact_rs_duration;
 
   scoped_refptr<Counter> leader_memory_pressure_rejections;
+  scoped_refptr<Counter> leader_compaction_pressure_rejections;
+
+  // Storage engine work of reads and writes, see StorageCost.
+  scoped_refptr<Counter> docdb_block_cache_hits;
+  scoped_refptr<Counter> docdb_block_reads;
+  scoped_refptr<Counter> docdb_block_read_bytes;
+  scoped_refptr<Counter> docdb_seeks;
+  scoped_refptr<Counter> docdb_nexts;
+  scoped_refptr<Counter> docdb_entries_skipped;
+  scoped_refptr<Counter> docdb_intent_seeks;
 };
 
 class ProbeStatsSubmitter {
@@ -120,6 +151,20 @@ class ProbeStatsSubmitter {
   DISALLOW_COPY_AND_ASSIGN(ProbeStatsSubmitter);
 };
 
+// Adds the storage engine work done by the current thread during its lifetime to the tablet metrics
+// and to the trace of the current RPC.
+class ScopedStorageCostTracker {
+ public:
+  explicit ScopedStorageCostTracker(TabletMetrics* metrics);
+  ~ScopedStorageCostTracker();
+
+ private:
+  TabletMetrics* const metrics_;
+  const StorageCost start_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStorageCostTracker);
+};
+
 class ScopedTabletMetricsTracker {
  public:
   explicit ScopedTabletMetricsTracker(scoped_refptr<Histogram> latency);
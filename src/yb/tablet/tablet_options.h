@@ -15,15 +15,40 @@
 
 namespace rocksdb {
 class EventListener;
+class RateLimiter;
 }
 
 namespace yb {
+
+class MemTracker;
+class PriorityThreadPool;
+class ThreadPool;
+
+namespace log {
+class LogSyncCoordinator;
+}
+
 namespace tablet {
 
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
+  // Optional second tier of the block cache, stores compressed blocks.
+  std::shared_ptr<rocksdb::Cache> block_cache_compressed;
+  // Limits the part of the block cache that index and filter blocks and blocks of hot key ranges
+  // pinned by tablets could take.
+  std::shared_ptr<MemTracker> pinned_blocks_mem_tracker;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Shared by all tablets of the server, so flushes and compactions of different tablets don't
+  // exceed the configured write rate and compactions run in order of write stall risk.
+  std::shared_ptr<rocksdb::RateLimiter> rate_limiter;
+  std::shared_ptr<PriorityThreadPool> priority_thread_pool_for_compactions_and_flushes;
+  // Shared by all tablets of the server, runs SST lookups of batched reads in parallel.
+  std::shared_ptr<ThreadPool> multi_get_thread_pool;
+  // Shared by all tablets of the server, bounds the number of SST files they keep open together.
+  std::shared_ptr<rocksdb::Cache> table_cache;
+  // Shared by WALs of all tablets of the server, so fsyncs of different tablets are batched.
+  std::shared_ptr<log::LogSyncCoordinator> log_sync_coordinator;
 };
 
 } // namespace tablet
@@ -61,7 +61,9 @@
 #include "yb/tablet/tablet_peer_mm_ops.h"
 
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/ingest_files_operation.h"
 #include "yb/tablet/operations/operation_driver.h"
+#include "yb/tablet/operations/snapshot_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 
@@ -165,6 +167,7 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
 
     ConsensusOptions options;
     options.tablet_id = meta_->tablet_id();
+    options.allow_quiescence = allow_raft_quiescence_;
 
     TRACE("Creating consensus instance");
 
@@ -471,6 +474,9 @@ void TabletPeer::GetInFlightOperations(Operation::TraceType trace_type,
         case Operation::SNAPSHOT_TXN:
           status_pb.set_operation_type(consensus::SNAPSHOT_OP);
           break;
+        case Operation::INGEST_FILES_TXN:
+          status_pb.set_operation_type(consensus::INGEST_FILES_OP);
+          break;
 
         default:
           FATAL_INVALID_ENUM_VALUE(Operation::OperationType, driver->operation_type());
@@ -591,7 +597,18 @@ std::unique_ptr<Operation> TabletPeer::CreateOperation(consensus::ReplicateMsg*
       return std::make_unique<UpdateTxnOperation>(
           std::make_unique<UpdateTxnOperationState>(this), consensus::REPLICA);
 
-    case consensus::SNAPSHOT_OP: FALLTHROUGH_INTENDED;
+    case consensus::INGEST_FILES_OP:
+      DCHECK(replicate_msg->has_ingest_files_request()) << "INGEST_FILES_OP replica"
+          " operation must receive an IngestFilesRequestPB";
+      return std::make_unique<IngestFilesOperation>(
+          std::make_unique<IngestFilesOperationState>(this), consensus::REPLICA);
+
+    case consensus::SNAPSHOT_OP:
+      DCHECK(replicate_msg->has_snapshot_request()) << "SNAPSHOT_OP replica"
+          " operation must receive a TabletSnapshotOpRequestPB";
+      return std::make_unique<SnapshotOperation>(
+          std::make_unique<SnapshotOperationState>(this), consensus::REPLICA);
+
     case consensus::UNKNOWN_OP: FALLTHROUGH_INTENDED;
     case consensus::NO_OP: FALLTHROUGH_INTENDED;
     case consensus::CHANGE_CONFIG_OP:
@@ -600,6 +617,19 @@ std::unique_ptr<Operation> TabletPeer::CreateOperation(consensus::ReplicateMsg*
   FATAL_INVALID_ENUM_VALUE(consensus::OperationType, replicate_msg->op_type());
 }
 
+HybridTime TabletPeer::SafeTimeForFollowers() const {
+  auto tablet = shared_tablet();
+  return tablet ? tablet->SafeTimestampToRead() : HybridTime::kInvalid;
+}
+
+void TabletPeer::StartApplyBatch() {
+  apply_batch_.Start();
+}
+
+void TabletPeer::FinishApplyBatch() {
+  apply_batch_.Finish();
+}
+
 Status TabletPeer::StartReplicaOperation(const scoped_refptr<ConsensusRound>& round) {
   {
     std::lock_guard<simple_spinlock> lock(lock_);
@@ -681,6 +711,14 @@ void TabletPeer::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
     gscoped_ptr<MaintenanceOp> dms_flush_op(new FlushDeltaMemStoresOp(this));
     maint_mgr->RegisterOp(dms_flush_op.get());
     maintenance_ops_.push_back(dms_flush_op.release());
+  } else {
+    gscoped_ptr<MaintenanceOp> memtables_flush_op(new FlushMemTablesOp(this));
+    maint_mgr->RegisterOp(memtables_flush_op.get());
+    maintenance_ops_.push_back(memtables_flush_op.release());
+
+    gscoped_ptr<MaintenanceOp> expired_data_compact_op(new CompactExpiredDataOp(this));
+    maint_mgr->RegisterOp(expired_data_compact_op.get());
+    maintenance_ops_.push_back(expired_data_compact_op.release());
   }
 
   gscoped_ptr<MaintenanceOp> log_gc(new LogGCOp(this));
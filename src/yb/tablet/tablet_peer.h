@@ -49,6 +49,7 @@
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/transaction_coordinator.h"
 #include "yb/tablet/operation_order_verifier.h"
+#include "yb/tablet/operations/operation_driver.h"
 #include "yb/tablet/operations/operation_tracker.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/tablet/tablet_fwd.h"
@@ -107,6 +108,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
                                 const scoped_refptr<log::Log> &log,
                                 const scoped_refptr<MetricEntity> &metric_entity);
 
+  // Allows Raft consensus of the tablet to quiesce while idle, see
+  // consensus::ConsensusOptions::allow_quiescence. Should be set before InitTabletPeer().
+  void set_allow_raft_quiescence(bool value) { allow_raft_quiescence_ = value; }
+
   // Starts the TabletPeer, making it available for Write()s. If this
   // TabletPeer is part of a consensus configuration this will connect it to other peers
   // in the consensus configuration.
@@ -150,6 +155,13 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   virtual CHECKED_STATUS StartReplicaOperation(
       const scoped_refptr<consensus::ConsensusRound>& round) override;
 
+  // Used by consensus to obtain the safe time propagated to followers.
+  HybridTime SafeTimeForFollowers() const override;
+
+  // Used by consensus to merge RocksDB writes of committed write operations.
+  void StartApplyBatch() override;
+  void FinishApplyBatch() override;
+
   consensus::Consensus* consensus() const {
     std::lock_guard<simple_spinlock> lock(lock_);
     return consensus_.get();
@@ -251,6 +263,11 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
     return log_anchor_registry_;
   }
 
+  // Returns the messenger used to talk to the other peers. Set by Init().
+  const std::shared_ptr<rpc::Messenger>& messenger() const {
+    return messenger_;
+  }
+
   // Returns the tablet_id of the tablet managed by this TabletPeer.
   // Returns the correct tablet_id even if the underlying tablet is not available
   // yet.
@@ -348,6 +365,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
 
   std::unique_ptr<PrepareThread> prepare_thread_;
 
+  // Used by consensus, that applies committed operations while holding its lock, so it is never
+  // used by several threads at once.
+  OperationApplyBatch apply_batch_;
+
   // Pool that executes apply tasks for transactions. This is a multi-threaded
   // pool, constructor-injected by either the Master (for system tables) or
   // the Tablet server.
@@ -365,6 +386,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   // and defer any other heavy duty operations to a thread pool.
   Callback<void(std::shared_ptr<consensus::StateChangeContext> context)> mark_dirty_clbk_;
 
+  bool allow_raft_quiescence_ = false;
+
   // List of maintenance operations for the tablet that need information that only the peer
   // can provide.
   std::vector<MaintenanceOp*> maintenance_ops_;
@@ -49,6 +49,45 @@ DEFINE_int32(flush_threshold_mb, 64,
              "A MRS can still flush below this threshold if it if hasn't flushed in a while");
 TAG_FLAG(flush_threshold_mb, experimental);
 
+METRIC_DEFINE_gauge_uint32(tablet, flush_memtables_running,
+                           "MemTable Flushes Running",
+                           yb::MetricUnit::kOperations,
+                           "Number of RocksDB memtable flushes started by the maintenance manager "
+                           "currently running.");
+METRIC_DEFINE_histogram(tablet, flush_memtables_duration,
+                        "MemTable Flush Duration",
+                        yb::MetricUnit::kMilliseconds,
+                        "Time spent flushing RocksDB memtables by the maintenance manager.",
+                        60000LU, 1);
+
+DEFINE_double(tablet_expired_data_compaction_ratio, 0.5,
+              "Estimated fraction of expired records in SST files of a key-value tablet, that "
+              "makes the maintenance manager run a full compaction of the tablet to remove them. "
+              "0 to disable.");
+TAG_FLAG(tablet_expired_data_compaction_ratio, advanced);
+
+DEFINE_int32(tablet_expired_data_compaction_min_mb, 64,
+             "Minimum estimated size of expired records in SST files of a key-value tablet, that "
+             "makes the maintenance manager run a full compaction of the tablet to remove them.");
+TAG_FLAG(tablet_expired_data_compaction_min_mb, advanced);
+
+DEFINE_int32(tablet_expired_data_check_interval_ms, 60000,
+             "How often the size of expired records in SST files of a key-value tablet is "
+             "estimated.");
+TAG_FLAG(tablet_expired_data_check_interval_ms, advanced);
+
+METRIC_DEFINE_gauge_uint32(tablet, compact_expired_data_running,
+                           "Expired Data Compactions Running",
+                           yb::MetricUnit::kOperations,
+                           "Number of full compactions started by the maintenance manager to "
+                           "remove expired records, that are currently running.");
+METRIC_DEFINE_histogram(tablet, compact_expired_data_duration,
+                        "Expired Data Compaction Duration",
+                        yb::MetricUnit::kMilliseconds,
+                        "Time spent on full compactions started by the maintenance manager to "
+                        "remove expired records.",
+                        60000LU * 60, 1);
+
 METRIC_DEFINE_gauge_uint32(tablet, log_gc_running,
                            "Log GCs Running",
                            yb::MetricUnit::kOperations,
@@ -207,6 +246,71 @@ scoped_refptr<AtomicGauge<uint32_t> > FlushDeltaMemStoresOp::RunningGauge() cons
   return tablet_peer_->tablet()->metrics()->flush_dms_running;
 }
 
+//
+// FlushMemTablesOp.
+//
+
+FlushMemTablesOp::FlushMemTablesOp(TabletPeer* tablet_peer)
+    : MaintenanceOp(StringPrintf("FlushMemTablesOp(%s)",
+                                 tablet_peer->tablet()->tablet_id().c_str()),
+                    MaintenanceOp::HIGH_IO_USAGE),
+      tablet_peer_(tablet_peer),
+      flush_duration_(METRIC_flush_memtables_duration.Instantiate(
+                          tablet_peer->tablet()->GetMetricEntity())),
+      flush_running_(METRIC_flush_memtables_running.Instantiate(
+                         tablet_peer->tablet()->GetMetricEntity(), 0)),
+      sem_(1) {
+  time_since_flush_.start();
+}
+
+void FlushMemTablesOp::UpdateStats(MaintenanceOpStats* stats) {
+  std::lock_guard<simple_spinlock> l(lock_);
+
+  map<int64_t, int64_t> max_idx_to_segment_size;
+  const auto tablet = tablet_peer_->shared_tablet();
+  if (!tablet || tablet->MemTablesEmpty() ||
+      !tablet_peer_->GetMaxIndexesToSegmentSizeMap(&max_idx_to_segment_size).ok()) {
+    return;
+  }
+
+  stats->set_runnable(sem_.GetValue() == 1);
+  stats->set_ram_anchored(tablet->MemTablesSize());
+  stats->set_logs_retained_bytes(tablet->MemTablesLogRetentionSize(max_idx_to_segment_size));
+
+  FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(
+      stats,
+      time_since_flush_.elapsed().wall_millis());
+}
+
+bool FlushMemTablesOp::Prepare() {
+  return sem_.try_lock();
+}
+
+void FlushMemTablesOp::Perform() {
+  CHECK(!sem_.try_lock());
+
+  const auto tablet = tablet_peer_->shared_tablet();
+  if (tablet) {
+    // Wait for the flush, so the op is not selected again while memtables are being flushed.
+    WARN_NOT_OK(tablet->Flush(FlushMode::kSync),
+                Substitute("Failed to flush memtables of $0", tablet->tablet_id()));
+  }
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    time_since_flush_.start();
+  }
+
+  sem_.unlock();
+}
+
+scoped_refptr<Histogram> FlushMemTablesOp::DurationHistogram() const {
+  return flush_duration_;
+}
+
+scoped_refptr<AtomicGauge<uint32_t> > FlushMemTablesOp::RunningGauge() const {
+  return flush_running_;
+}
+
 //
 // LogGCOp.
 //
@@ -255,5 +359,90 @@ scoped_refptr<AtomicGauge<uint32_t> > LogGCOp::RunningGauge() const {
   return log_gc_running_;
 }
 
+//
+// CompactExpiredDataOp.
+//
+
+CompactExpiredDataOp::CompactExpiredDataOp(TabletPeer* tablet_peer)
+    : MaintenanceOp(StringPrintf("CompactExpiredDataOp(%s)",
+                                 tablet_peer->tablet()->tablet_id().c_str()),
+                    MaintenanceOp::HIGH_IO_USAGE),
+      next_check_(MonoTime::Min()),
+      tablet_peer_(tablet_peer),
+      compact_duration_(METRIC_compact_expired_data_duration.Instantiate(
+                            tablet_peer->tablet()->GetMetricEntity())),
+      compact_running_(METRIC_compact_expired_data_running.Instantiate(
+                           tablet_peer->tablet()->GetMetricEntity(), 0)),
+      sem_(1) {}
+
+void CompactExpiredDataOp::UpdateStats(MaintenanceOpStats* stats) {
+  if (FLAGS_tablet_expired_data_compaction_ratio <= 0) {
+    return;
+  }
+  const auto tablet = tablet_peer_->shared_tablet();
+  if (!tablet) {
+    return;
+  }
+
+  std::lock_guard<simple_spinlock> l(lock_);
+  // Properties of all SST files are collected to estimate expired data, so it is not done each
+  // time the maintenance manager looks for an op to run.
+  const auto now = MonoTime::FineNow();
+  if (now >= next_check_) {
+    if (!tablet->GetExpiredDataSize(&expired_bytes_, &total_bytes_).ok()) {
+      return;
+    }
+    next_check_ = now + MonoDelta::FromMilliseconds(FLAGS_tablet_expired_data_check_interval_ms);
+  }
+
+  if (total_bytes_ == 0 ||
+      expired_bytes_ < static_cast<uint64_t>(FLAGS_tablet_expired_data_compaction_min_mb) << 20) {
+    return;
+  }
+  const double ratio = static_cast<double>(expired_bytes_) / total_bytes_;
+  if (ratio < FLAGS_tablet_expired_data_compaction_ratio) {
+    return;
+  }
+  stats->set_runnable(sem_.GetValue() == 1);
+  stats->set_perf_improvement(std::min(ratio, 1.0));
+}
+
+bool CompactExpiredDataOp::Prepare() {
+  return sem_.try_lock();
+}
+
+void CompactExpiredDataOp::Perform() {
+  CHECK(!sem_.try_lock());
+
+  const auto tablet = tablet_peer_->shared_tablet();
+  if (tablet) {
+    uint64_t expired_bytes, total_bytes;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      expired_bytes = expired_bytes_;
+      total_bytes = total_bytes_;
+    }
+    LOG(INFO) << "Compacting " << tablet->tablet_id() << " to remove expired data, estimated "
+              << expired_bytes << " of " << total_bytes << " bytes";
+    WARN_NOT_OK(tablet->CompactExpiredData(),
+                Substitute("Failed to compact expired data of $0", tablet->tablet_id()));
+  }
+  {
+    // Estimate is updated after the compaction.
+    std::lock_guard<simple_spinlock> l(lock_);
+    next_check_ = MonoTime::Min();
+  }
+
+  sem_.unlock();
+}
+
+scoped_refptr<Histogram> CompactExpiredDataOp::DurationHistogram() const {
+  return compact_duration_;
+}
+
+scoped_refptr<AtomicGauge<uint32_t> > CompactExpiredDataOp::RunningGauge() const {
+  return compact_running_;
+}
+
 }  // namespace tablet
 }  // namespace yb
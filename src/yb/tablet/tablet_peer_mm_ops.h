@@ -117,6 +117,36 @@ class FlushDeltaMemStoresOp : public MaintenanceOp {
   TabletPeer *const tablet_peer_;
 };
 
+// Maintenance op that flushes RocksDB memtables of a key-value tablet.
+//
+// Reports memory anchored by memtables and log retained because of unflushed writes, so the
+// maintenance manager flushes the tablet that retains the most log, or the one that anchors the
+// most memory when the server is over its soft memory limit.
+class FlushMemTablesOp : public MaintenanceOp {
+ public:
+  explicit FlushMemTablesOp(TabletPeer* tablet_peer);
+
+  virtual void UpdateStats(MaintenanceOpStats* stats) override;
+
+  virtual bool Prepare() override;
+
+  virtual void Perform() override;
+
+  virtual scoped_refptr<Histogram> DurationHistogram() const override;
+
+  virtual scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  // Lock protecting time_since_flush_.
+  mutable simple_spinlock lock_;
+  Stopwatch time_since_flush_;
+
+  TabletPeer *const tablet_peer_;
+  scoped_refptr<Histogram> flush_duration_;
+  scoped_refptr<AtomicGauge<uint32_t> > flush_running_;
+  mutable Semaphore sem_;
+};
+
 // Maintenance task that runs log GC. Reports log retention that represents the amount of data
 // that can be GC'd.
 //
@@ -142,6 +172,39 @@ class LogGCOp : public MaintenanceOp {
   mutable Semaphore sem_;
 };
 
+// Maintenance op that removes expired records of a key-value tablet by a full compaction.
+//
+// Otherwise records with TTL are removed only when they happen to be in a full compaction, so
+// they could occupy disk and block cache for a long time after they expire. Expiration indexes
+// of SST files are used to estimate the size of expired records, and the compaction is performed
+// when expired records make up a significant part of the tablet.
+class CompactExpiredDataOp : public MaintenanceOp {
+ public:
+  explicit CompactExpiredDataOp(TabletPeer* tablet_peer);
+
+  virtual void UpdateStats(MaintenanceOpStats* stats) override;
+
+  virtual bool Prepare() override;
+
+  virtual void Perform() override;
+
+  virtual scoped_refptr<Histogram> DurationHistogram() const override;
+
+  virtual scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  // Lock protecting the estimate of expired data.
+  mutable simple_spinlock lock_;
+  MonoTime next_check_;
+  uint64_t expired_bytes_ = 0;
+  uint64_t total_bytes_ = 0;
+
+  TabletPeer *const tablet_peer_;
+  scoped_refptr<Histogram> compact_duration_;
+  scoped_refptr<AtomicGauge<uint32_t> > compact_running_;
+  mutable Semaphore sem_;
+};
+
 } // namespace tablet
 } // namespace yb
 
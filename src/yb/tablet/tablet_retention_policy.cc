@@ -16,22 +16,21 @@
 #include "yb/common/schema.h"
 #include "yb/server/hybrid_clock.h"
 
-DEFINE_int32(timestamp_history_retention_interval_sec, 10,
-             "The time interval in seconds to retain DocDB history for. This should be "
-             "supplemented with read point tracking.");
+DEFINE_int32(timestamp_history_retention_interval_sec, 0,
+             "The time interval in seconds to retain DocDB history for, in addition to the history "
+             "needed by active reads. Follower reads at a time before the retained history fail.");
 
 namespace yb {
 namespace tablet {
 
 using docdb::TableTTL;
 
-TabletRetentionPolicy::TabletRetentionPolicy(const Tablet* tablet)
+TabletRetentionPolicy::TabletRetentionPolicy(Tablet* tablet)
     : tablet_(tablet),
       retention_delta_(MonoDelta::FromSeconds(-FLAGS_timestamp_history_retention_interval_sec)) {}
 
 HybridTime TabletRetentionPolicy::GetHistoryCutoff() {
-  return std::min<HybridTime>(
-      tablet_->OldestReadPoint(),
+  return tablet_->UpdateHistoryCutoff(
       server::HybridClock::AddPhysicalTimeToHybridTime(tablet_->clock()->Now(), retention_delta_));
 }
 
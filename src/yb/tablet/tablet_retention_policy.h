@@ -21,17 +21,18 @@
 namespace yb {
 namespace tablet {
 
-// History retention policy used by a tablet. Currently just keeps history for a fixed amount of
-// time. As the next step we need to start tracking pending reads.
+// History retention policy used by a tablet. Keeps the history needed by the active reads of the
+// tablet, and additionally the history of the last --timestamp_history_retention_interval_sec
+// seconds. Reads that start at a time before the returned cutoff are rejected by the tablet.
 class TabletRetentionPolicy : public docdb::HistoryRetentionPolicy {
  public:
-  explicit TabletRetentionPolicy(const Tablet* tablet);
+  explicit TabletRetentionPolicy(Tablet* tablet);
   HybridTime GetHistoryCutoff() override;
   ColumnIdsPtr GetDeletedColumns() override;
   MonoDelta GetTableTTL() override;
 
  private:
-  const Tablet* tablet_;
+  Tablet* tablet_;
 
   // The delta to be added to the current time to get the history cutoff timestamp. This is always
   // a negative amount.
@@ -163,6 +163,20 @@ class TransactionState {
     return status;
   }
 
+  // Applies replicated batched heartbeat. Batched heartbeats are not ordered with other updates of
+  // this transaction, so heartbeat is ignored when transaction is not pending anymore.
+  void ProcessReplicatedHeartbeat(const TransactionCoordinator::ReplicatedData& data) {
+    if (status_ != TransactionStatus::PENDING) {
+      return;
+    }
+    if (data.mode == ProcessingMode::LEADER && ExpiredAt(data.hybrid_time)) {
+      Abort();
+      return;
+    }
+    last_touch_ = data.hybrid_time;
+    first_entry_raft_index_ = data.op_id.index();
+  }
+
   // Clear all locks on this transaction.
   // Currently there is only one lock, but user of this function should not care about that.
   void ClearLocks() {
@@ -185,19 +199,16 @@ class TransactionState {
     }
   }
 
-  CHECKED_STATUS GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
+  TransactionStatusResult GetStatus() const {
     if (status_ == TransactionStatus::COMMITTED) {
-      response->set_status(TransactionStatus::COMMITTED);
-      response->set_status_hybrid_time(commit_time_.ToUint64());
+      return TransactionStatusResult{TransactionStatus::COMMITTED, commit_time_};
     } else if (status_ == TransactionStatus::ABORTED) {
-      response->set_status(TransactionStatus::ABORTED);
+      return TransactionStatusResult{TransactionStatus::ABORTED, HybridTime::kMax};
     } else {
       CHECK_EQ(TransactionStatus::PENDING, status_);
-      response->set_status(TransactionStatus::PENDING);
-      response->set_status_hybrid_time(
-          context_.coordinator_context().LastCommittedHybridTime().ToUint64());
+      return TransactionStatusResult{
+          TransactionStatus::PENDING, context_.coordinator_context().LastCommittedHybridTime()};
     }
-    return Status::OK();
   }
 
   void Abort(TransactionAbortCallback callback, std::unique_lock<std::mutex>* lock) {
@@ -481,8 +492,28 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     rpcs_.Shutdown();
   }
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response) {
+    if (request.transaction_ids().empty()) {
+      auto result = GetStatus(request.transaction_id());
+      RETURN_NOT_OK(result);
+      response->set_status(result->status);
+      if (result->status != TransactionStatus::ABORTED) {
+        response->set_status_hybrid_time(result->status_time.ToUint64());
+      }
+      return Status::OK();
+    }
+
+    for (const auto& transaction_id : request.transaction_ids()) {
+      auto result = GetStatus(transaction_id);
+      RETURN_NOT_OK(result);
+      response->add_statuses(result->status);
+      response->add_status_hybrid_times(result->status_time.ToUint64());
+    }
+    return Status::OK();
+  }
+
+  Result<TransactionStatusResult> GetStatus(const std::string& transaction_id) {
     auto id = FullyDecodeTransactionId(transaction_id);
     if (!id.ok()) {
       return std::move(id.status());
@@ -491,10 +522,9 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     std::lock_guard<std::mutex> lock(managed_mutex_);
     auto it = managed_transactions_.find(*id);
     if (it == managed_transactions_.end()) {
-      response->set_status(TransactionStatus::ABORTED);
-      return Status::OK();
+      return TransactionStatusResult{TransactionStatus::ABORTED, HybridTime::kMax};
     }
-    return it->GetStatus(response);
+    return it->GetStatus();
   }
 
   void Abort(const std::string& transaction_id, TransactionAbortCallback callback) {
@@ -530,6 +560,10 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
   }
 
   CHECKED_STATUS ProcessReplicated(const ReplicatedData& data) {
+    if (!data.state.transaction_ids().empty()) {
+      return ProcessReplicatedHeartbeats(data);
+    }
+
     auto id = FullyDecodeTransactionId(data.state.transaction_id());
     if (!id.ok()) {
       return std::move(id.status());
@@ -571,6 +605,31 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     return result;
   }
 
+  CHECKED_STATUS ProcessReplicatedHeartbeats(const ReplicatedData& data) {
+    DCHECK_EQ(TransactionStatus::PENDING, data.state.status());
+    PostponedLeaderActions actions;
+    {
+      std::lock_guard<std::mutex> lock(managed_mutex_);
+      postponed_leader_actions_.leader = data.mode == ProcessingMode::LEADER;
+      for (const auto& transaction_id : data.state.transaction_ids()) {
+        auto id = FullyDecodeTransactionId(transaction_id);
+        if (!id.ok()) {
+          LOG(DFATAL) << "Bad transaction id in heartbeat: " << id.status();
+          continue;
+        }
+        // Transaction is created if it is not known yet, i.e. log entries that created it were
+        // garbage collected, the same way as for non batched heartbeat.
+        auto it = get(*id, data.state.status(), data.hybrid_time);
+        managed_transactions_.modify(it, [&data](TransactionState& state) {
+          state.ProcessReplicatedHeartbeat(data);
+        });
+      }
+      actions.Swap(&postponed_leader_actions_);
+    }
+    ExecutePostponedLeaderActions(&actions);
+    return Status::OK();
+  }
+
   void ClearLocks() {
     std::lock_guard<std::mutex> lock(managed_mutex_);
     for (auto it = managed_transactions_.begin(); it != managed_transactions_.end(); ++it) {
@@ -626,6 +685,35 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     ExecutePostponedLeaderActions(&actions);
   }
 
+  void HandleHeartbeats(std::unique_ptr<tablet::UpdateTxnOperationState> request,
+                        tserver::UpdateTransactionResponsePB* response) {
+    tserver::TransactionStatePB state;
+    state.set_status(TransactionStatus::PENDING);
+    {
+      std::lock_guard<std::mutex> lock(managed_mutex_);
+      for (const auto& transaction_id : request->request()->transaction_ids()) {
+        auto id = FullyDecodeTransactionId(transaction_id);
+        if (!id.ok()) {
+          LOG(DFATAL) << "Bad transaction id in heartbeat: " << id.status();
+          continue;
+        }
+        auto it = managed_transactions_.find(*id);
+        if (it == managed_transactions_.end() || it->status() == TransactionStatus::ABORTED) {
+          response->add_expired_transaction_ids(transaction_id);
+        } else if (it->status() == TransactionStatus::PENDING) {
+          state.add_transaction_ids(transaction_id);
+        }
+      }
+    }
+
+    if (state.transaction_ids().empty()) {
+      request->completion_callback()->CompleteWithStatus(Status::OK());
+      return;
+    }
+    request->TakeRequest(&state);
+    context_.SubmitUpdateTransaction(std::move(request));
+  }
+
   int64_t PrepareGC() {
     std::lock_guard<std::mutex> lock(managed_mutex_);
     if (!managed_transactions_.empty()) {
@@ -813,6 +901,12 @@ void TransactionCoordinator::Handle(std::unique_ptr<tablet::UpdateTxnOperationSt
   impl_->Handle(std::move(request));
 }
 
+void TransactionCoordinator::HandleHeartbeats(
+    std::unique_ptr<tablet::UpdateTxnOperationState> request,
+    tserver::UpdateTransactionResponsePB* response) {
+  impl_->HandleHeartbeats(std::move(request), response);
+}
+
 void TransactionCoordinator::ClearLocks() {
   impl_->ClearLocks();
 }
@@ -825,9 +919,9 @@ void TransactionCoordinator::Shutdown() {
   impl_->Shutdown();
 }
 
-Status TransactionCoordinator::GetStatus(const std::string& transaction_id,
+Status TransactionCoordinator::GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                                          tserver::GetTransactionStatusResponsePB* response) {
-  return impl_->GetStatus(transaction_id, response);
+  return impl_->GetStatus(request, response);
 }
 
 void TransactionCoordinator::Abort(const std::string& transaction_id,
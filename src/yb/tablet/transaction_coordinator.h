@@ -46,8 +46,10 @@ class Clock;
 namespace tserver {
 
 class AbortTransactionResponsePB;
+class GetTransactionStatusRequestPB;
 class GetTransactionStatusResponsePB;
 class TransactionStatePB;
+class UpdateTransactionResponsePB;
 
 }
 
@@ -106,6 +108,11 @@ class TransactionCoordinator {
   // Handles new request for transaction udpate.
   void Handle(std::unique_ptr<tablet::UpdateTxnOperationState> request);
 
+  // Handles batched heartbeat of pending transactions, that is replicated as single operation.
+  // Transactions that are unknown or aborted are added to expired list of response.
+  void HandleHeartbeats(std::unique_ptr<tablet::UpdateTxnOperationState> request,
+                        tserver::UpdateTransactionResponsePB* response);
+
   // Prepares log garbage collection. Return min index that should be preserved.
   int64_t PrepareGC();
 
@@ -116,7 +123,9 @@ class TransactionCoordinator {
   // And like most of other Shutdowns in our codebase it wait until shutdown completes.
   void Shutdown();
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  // Fills response with statuses of transactions specified in request, either a single one or
+  // a batch.
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response);
 
   void Abort(const std::string& transaction_id, TransactionAbortCallback callback);
@@ -15,7 +15,10 @@
 
 #include "yb/tablet/transaction_participant.h"
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -25,6 +28,7 @@
 
 #include <boost/uuid/uuid_io.hpp>
 
+#include "yb/rocksdb/metadata.h"
 #include "yb/rocksdb/write_batch.h"
 
 #include "yb/client/transaction_rpc.h"
@@ -36,11 +40,17 @@
 
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
 
 using namespace std::placeholders;
 
+DEFINE_int32(max_transactions_in_status_request, 128,
+             "Request status for at most specified number of transactions at once. "
+             "0 disables batching.");
+TAG_FLAG(max_transactions_in_status_request, advanced);
+
 namespace yb {
 namespace tablet {
 
@@ -54,12 +64,11 @@ class RunningTransaction {
       : metadata_(std::move(metadata)),
         rpcs_(*rpcs),
         context_(*context),
-        get_status_handle_(rpcs->InvalidHandle()),
         abort_handle_(rpcs->InvalidHandle()) {
   }
 
   ~RunningTransaction() {
-    rpcs_.Abort({&get_status_handle_, &abort_handle_});
+    rpcs_.Abort({&abort_handle_});
   }
 
   const TransactionId& id() const {
@@ -78,8 +87,20 @@ class RunningTransaction {
     local_commit_time_ = time;
   }
 
-  void RequestStatusAt(client::YBClient* client,
-                       HybridTime time,
+  // Whether this transaction was added by this participant and its intents were not applied yet.
+  bool has_pending_intents() const {
+    return has_pending_intents_;
+  }
+
+  void SetHasPendingIntents(bool value) {
+    has_pending_intents_ = value;
+  }
+
+  // Invokes callback if status at specified time could be determined using last known status.
+  // Otherwise adds callback to waiters and returns true if status of this transaction should be
+  // requested from its status tablet, i.e. there is no such request yet. Lock is released only
+  // when callback is invoked.
+  bool RequestStatusAt(HybridTime time,
                        TransactionStatusCallback callback,
                        std::unique_lock<std::mutex>* lock) const {
     if (last_known_status_hybrid_time_ > HybridTime::kMin) {
@@ -88,28 +109,50 @@ class RunningTransaction {
       if (transaction_status) {
         lock->unlock();
         callback(TransactionStatusResult{*transaction_status, last_known_status_hybrid_time_});
-        return;
+        return false;
       }
     }
     bool was_empty = status_waiters_.empty();
     status_waiters_.push_back(StatusWaiter{std::move(callback), time});
-    if (!was_empty) {
-      return;
+    return was_empty;
+  }
+
+  // Updates last known status using status received from status tablet and notifies waiters.
+  // Should be invoked under lock, that is released to invoke waiter callbacks.
+  void StatusReceived(const Status& status,
+                      TransactionStatus transaction_status,
+                      HybridTime time,
+                      std::unique_lock<std::mutex>* lock) const {
+    decltype(status_waiters_) status_waiters;
+    status_waiters_.swap(status_waiters);
+    if (status.ok()) {
+      if (last_known_status_hybrid_time_ <= time) {
+        last_known_status_hybrid_time_ = time;
+        last_known_status_ = transaction_status;
+      }
+      time = last_known_status_hybrid_time_;
+      transaction_status = last_known_status_;
     }
     lock->unlock();
-    auto deadline = MonoTime::FineNow() + MonoDelta::FromSeconds(5); // TODO(dtxn)
-    tserver::GetTransactionStatusRequestPB req;
-    req.set_tablet_id(metadata_.status_tablet);
-    req.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    req.set_propagated_hybrid_time(context_.Now().ToUint64());
-    rpcs_.RegisterAndStart(
-        client::GetTransactionStatus(
-            deadline,
-            nullptr /* tablet */,
-            client,
-            &req,
-            std::bind(&RunningTransaction::StatusReceived, this, _1, _2, lock->mutex())),
-        &get_status_handle_);
+    if (!status.ok()) {
+      for (const auto& waiter : status_waiters) {
+        waiter.callback(status);
+      }
+    } else {
+      for (const auto& waiter : status_waiters) {
+        auto status_for_waiter = GetStatusAt(waiter.time, time, transaction_status);
+        if (status_for_waiter) {
+          waiter.callback(TransactionStatusResult{*status_for_waiter, time});
+        } else {
+          waiter.callback(STATUS_FORMAT(
+              TryAgain,
+              "Cannot determine transaction status at $0, last known: $1 at $2",
+              waiter.time,
+              transaction_status,
+              time));
+        }
+      }
+    }
   }
 
   void Abort(client::YBClient* client,
@@ -159,55 +202,6 @@ class RunningTransaction {
     }
   }
 
-  void StatusReceived(const Status& status,
-                      const tserver::GetTransactionStatusResponsePB& response,
-                      std::mutex* mutex) const {
-    if (response.has_propagated_hybrid_time()) {
-      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
-    }
-
-    rpcs_.Unregister(&get_status_handle_);
-    decltype(status_waiters_) status_waiters;
-    HybridTime time;
-    TransactionStatus transaction_status;
-    {
-      std::unique_lock<std::mutex> lock(*mutex);
-      status_waiters_.swap(status_waiters);
-      if (status.ok()) {
-        DCHECK(response.has_status_hybrid_time() ||
-               response.status() == TransactionStatus::ABORTED);
-        time = response.has_status_hybrid_time()
-            ? HybridTime(response.status_hybrid_time())
-            : HybridTime::kMax;
-        if (last_known_status_hybrid_time_ <= time) {
-          last_known_status_hybrid_time_ = time;
-          last_known_status_ = response.status();
-        }
-        time = last_known_status_hybrid_time_;
-        transaction_status = last_known_status_;
-      }
-    }
-    if (!status.ok()) {
-      for (const auto& waiter : status_waiters) {
-        waiter.callback(status);
-      }
-    } else {
-      for (const auto& waiter : status_waiters) {
-        auto status_for_waiter = GetStatusAt(waiter.time, time, transaction_status);
-        if (status_for_waiter) {
-          waiter.callback(TransactionStatusResult{*status_for_waiter, time});
-        } else {
-          waiter.callback(STATUS_FORMAT(
-              TryAgain,
-              "Cannot determine transaction status at $0, last known: $1 at $2",
-              waiter.time,
-              transaction_status,
-              time));
-        }
-      }
-    }
-  }
-
   static Result<TransactionStatusResult> MakeAbortResult(
       const Status& status,
       const tserver::AbortTransactionResponsePB& response) {
@@ -244,6 +238,7 @@ class RunningTransaction {
   rpc::Rpcs& rpcs_;
   TransactionParticipantContext& context_;
   HybridTime local_commit_time_ = HybridTime::kInvalidHybridTime;
+  bool has_pending_intents_ = false;
 
   struct StatusWaiter {
     TransactionStatusCallback callback;
@@ -253,7 +248,6 @@ class RunningTransaction {
   mutable TransactionStatus last_known_status_;
   mutable HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   mutable std::vector<StatusWaiter> status_waiters_;
-  mutable rpc::Rpcs::Handle get_status_handle_;
   mutable rpc::Rpcs::Handle abort_handle_;
   mutable std::vector<TransactionStatusCallback> abort_waiters_;
 };
@@ -266,6 +260,10 @@ class TransactionParticipant::Impl {
       : context_(*context) {}
 
   ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_ = true;
+    }
     transactions_.clear();
     rpcs_.Shutdown();
   }
@@ -282,7 +280,13 @@ class TransactionParticipant::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       auto it = transactions_.find(metadata->transaction_id);
       if (it == transactions_.end()) {
-        transactions_.emplace(*metadata, &rpcs_, &context_);
+        it = transactions_.emplace(*metadata, &rpcs_, &context_).first;
+        // Intents of this transaction become visible when write_batch is applied, so counter
+        // should be incremented before that.
+        transactions_.modify(it, [](RunningTransaction& transaction) {
+          transaction.SetHasPendingIntents(true);
+        });
+        num_transactions_with_intents_.fetch_add(1, std::memory_order_acq_rel);
         store = true;
       } else {
         DCHECK_EQ(it->metadata(), *metadata);
@@ -325,7 +329,9 @@ class TransactionParticipant::Impl {
       callback(STATUS_FORMAT(NotFound, "Unknown transaction: $1", id));
       return;
     }
-    return it->RequestStatusAt(client(), time, std::move(callback), &lock);
+    if (it->RequestStatusAt(time, std::move(callback), &lock)) {
+      RequestStatus(it->metadata().status_tablet, id, &lock);
+    }
   }
 
   void Abort(const TransactionId& id,
@@ -340,6 +346,46 @@ class TransactionParticipant::Impl {
     return it->Abort(client(), std::move(callback), &lock);
   }
 
+  bool MayHaveIntents() const {
+    // TODO(dtxn) intents of aborted transactions are not cleaned up yet, so such transactions
+    // keep the counter non-zero.
+    return has_persisted_intents_.load(std::memory_order_acquire) ||
+           num_transactions_with_intents_.load(std::memory_order_acquire) != 0;
+  }
+
+  void CheckPersistedIntents(rocksdb::DB* db) {
+    // Both intents and transaction metadata start with kIntentPrefix.
+    const char intent_prefix_char = static_cast<char>(docdb::ValueType::kIntentPrefix);
+    const Slice intent_prefix(&intent_prefix_char, 1);
+    const char intent_prefix_end_char = intent_prefix_char + 1;
+    const Slice intent_prefix_end(&intent_prefix_end_char, 1);
+
+    // This is called right after RocksDB is opened. RocksDB WAL is not used, so the memtable is
+    // empty and only SST files whose key range overlaps the intents could contain them. Checking
+    // the file boundaries first avoids opening all SST files of the tablet on startup.
+    std::vector<rocksdb::LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+    const bool may_have_intents = std::any_of(
+        files.begin(), files.end(),
+        [&intent_prefix, &intent_prefix_end](const rocksdb::LiveFileMetaData& file) {
+      return Slice(file.largest.key).compare(intent_prefix) >= 0 &&
+             Slice(file.smallest.key).compare(intent_prefix_end) < 0;
+    });
+    if (!may_have_intents) {
+      return;
+    }
+
+    auto iter = docdb::CreateRocksDBIterator(db,
+                                             docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
+                                             boost::none,
+                                             rocksdb::kDefaultQueryId);
+    iter->Seek(intent_prefix);
+    if (iter->Valid() && iter->key().starts_with(intent_prefix)) {
+      LOG(INFO) << context_.tablet_id() << ": Found persisted intents";
+      has_persisted_intents_.store(true, std::memory_order_release);
+    }
+  }
+
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data) {
     CHECK_OK(data.applier->ApplyIntents(data));
 
@@ -353,9 +399,15 @@ class TransactionParticipant::Impl {
         LOG(WARNING) << "Apply of unknown transaction: " << data.transaction_id;
         return Status::OK();
       } else {
+        bool had_pending_intents = it->has_pending_intents();
         transactions_.modify(it, [&data](RunningTransaction& transaction) {
           transaction.SetLocalCommitTime(data.commit_time);
+          transaction.SetHasPendingIntents(false);
         });
+        // Intents were already removed by ApplyIntents above.
+        if (had_pending_intents) {
+          num_transactions_with_intents_.fetch_sub(1, std::memory_order_acq_rel);
+        }
         // TODO(dtxn) cleanup
       }
       if (data.mode == ProcessingMode::LEADER) {
@@ -429,11 +481,133 @@ class TransactionParticipant::Impl {
     return context_.client_future().get().get();
   }
 
+  // Status requests of transactions managed by the same status tablet are batched. There is at
+  // most one request in flight to each status tablet, transactions whose status is requested
+  // meanwhile are queued and sent together when the response is received.
+  struct StatusRequests {
+    std::vector<TransactionId> queued;
+    bool in_flight = false;
+  };
+
+  void RequestStatus(const TabletId& status_tablet,
+                     const TransactionId& id,
+                     std::unique_lock<std::mutex>* lock) {
+    auto& requests = status_requests_[status_tablet];
+    requests.queued.push_back(id);
+    if (requests.in_flight) {
+      return;
+    }
+    SendStatusRequest(status_tablet, &requests, lock);
+  }
+
+  void SendStatusRequest(const TabletId& status_tablet,
+                         StatusRequests* requests,
+                         std::unique_lock<std::mutex>* lock) {
+    std::vector<TransactionId> ids;
+    size_t max_size = std::max(FLAGS_max_transactions_in_status_request, 1);
+    if (requests->queued.size() <= max_size) {
+      ids.swap(requests->queued);
+    } else {
+      ids.assign(requests->queued.begin(), requests->queued.begin() + max_size);
+      requests->queued.erase(requests->queued.begin(), requests->queued.begin() + max_size);
+    }
+    requests->in_flight = true;
+    auto handle = rpcs_.Prepare();
+    lock->unlock();
+
+    auto deadline = MonoTime::FineNow() + MonoDelta::FromSeconds(5); // TODO(dtxn)
+    tserver::GetTransactionStatusRequestPB req;
+    req.set_tablet_id(status_tablet);
+    if (ids.size() == 1) {
+      req.set_transaction_id(ids[0].begin(), ids[0].size());
+    } else {
+      for (const auto& id : ids) {
+        req.add_transaction_ids(id.begin(), id.size());
+      }
+    }
+    req.set_propagated_hybrid_time(context_.Now().ToUint64());
+    *handle = client::GetTransactionStatus(
+        deadline,
+        nullptr /* tablet */,
+        client(),
+        &req,
+        [this, handle, status_tablet, ids](
+            const Status& status, const tserver::GetTransactionStatusResponsePB& response) {
+          StatusReceived(status, response, status_tablet, ids, handle);
+        });
+    (**handle).SendRpc();
+  }
+
+  void StatusReceived(const Status& status,
+                      const tserver::GetTransactionStatusResponsePB& response,
+                      const TabletId& status_tablet,
+                      const std::vector<TransactionId>& ids,
+                      rpc::Rpcs::Handle handle) {
+    if (response.has_propagated_hybrid_time()) {
+      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+    rpcs_.Unregister(handle);
+
+    Status batch_status = status;
+    if (batch_status.ok() && ids.size() != 1 &&
+        (static_cast<size_t>(response.statuses().size()) != ids.size() ||
+         static_cast<size_t>(response.status_hybrid_times().size()) != ids.size())) {
+      batch_status = STATUS_FORMAT(
+          IllegalState, "Wrong number of statuses in response: $0, expected: $1",
+          response.statuses().size(), ids.size());
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i != ids.size(); ++i) {
+      auto it = transactions_.find(ids[i]);
+      if (it == transactions_.end()) {
+        continue;
+      }
+      TransactionStatus transaction_status = TransactionStatus::PENDING;
+      HybridTime time;
+      if (batch_status.ok()) {
+        if (ids.size() == 1) {
+          DCHECK(response.has_status_hybrid_time() ||
+                 response.status() == TransactionStatus::ABORTED);
+          transaction_status = response.status();
+          time = response.has_status_hybrid_time()
+              ? HybridTime(response.status_hybrid_time())
+              : HybridTime::kMax;
+        } else {
+          transaction_status = response.statuses(i);
+          time = HybridTime(response.status_hybrid_times(i));
+        }
+      }
+      it->StatusReceived(batch_status, transaction_status, time, &lock);
+      lock.lock();
+    }
+
+    auto requests_it = status_requests_.find(status_tablet);
+    if (requests_it == status_requests_.end()) {
+      return;
+    }
+    requests_it->second.in_flight = false;
+    if (closing_ || requests_it->second.queued.empty()) {
+      status_requests_.erase(requests_it);
+      return;
+    }
+    SendStatusRequest(status_tablet, &requests_it->second, &lock);
+  }
+
   TransactionParticipantContext& context_;
 
   std::mutex mutex_;
   rpc::Rpcs rpcs_;
   Transactions transactions_;
+  std::unordered_map<TabletId, StatusRequests> status_requests_;
+  bool closing_ = false;
+
+  // Number of transactions added by this participant whose intents are not applied yet.
+  std::atomic<int64_t> num_transactions_with_intents_{0};
+
+  // Whether intents written before restart were found in RocksDB. Since we don't track them, once
+  // set this flag is never reset.
+  std::atomic<bool> has_persisted_intents_{false};
 };
 
 TransactionParticipant::TransactionParticipant(TransactionParticipantContext* context)
@@ -472,5 +646,13 @@ CHECKED_STATUS TransactionParticipant::ProcessApply(const TransactionApplyData&
   return impl_->ProcessApply(data);
 }
 
+bool TransactionParticipant::MayHaveIntents() const {
+  return impl_->MayHaveIntents();
+}
+
+void TransactionParticipant::CheckPersistedIntents(rocksdb::DB* db) {
+  impl_->CheckPersistedIntents(db);
+}
+
 } // namespace tablet
 } // namespace yb
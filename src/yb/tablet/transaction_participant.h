@@ -97,6 +97,12 @@ class TransactionParticipant : public TransactionStatusProvider {
                        HybridTime time,
                        TransactionStatusCallback callback) override;
 
+  bool MayHaveIntents() const override;
+
+  // Checks whether RocksDB already contains intents or transaction metadata, i.e. written before
+  // restart. Should be invoked once, when RocksDB of the tablet is opened.
+  void CheckPersistedIntents(rocksdb::DB* db);
+
   void Abort(const TransactionId& id, TransactionStatusCallback callback);
 
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data);
@@ -346,6 +346,9 @@ class YBBulkLoadTest : public YBMiniClusterTestBase<MiniCluster> {
     *rowblock = rowsResult.GetRowBlock();
   }
 
+  // Runs the partition and bulk load tools, imports the generated files and verifies the rows.
+  void RunCLITools(const vector<string>& extra_bulk_load_args);
+
   std::shared_ptr<YBClient> client_;
   YBSchema schema_;
   std::unique_ptr<YBTableName> table_name_;
@@ -387,7 +390,7 @@ TEST_F(YBBulkLoadTest, InvalidLines) {
   ASSERT_NOK(partition_generator_->LookupTabletId("123,123.2", &tablet_id, &partition_key));
 }
 
-TEST_F(YBBulkLoadTest, TestCLITool) {
+void YBBulkLoadTest::RunCLITools(const vector<string>& extra_bulk_load_args) {
   string exe_path = GetToolPath(kPartitionToolName);
   vector<string> argv = {kPartitionToolName, "-master_addresses", master_addresses_comma_separated_,
       "-table_name", kTableName, "-namespace_name", kNamespace};
@@ -460,6 +463,8 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
       "-bulk_load_num_files_per_tablet", std::to_string(kNumFilesPerTablet),
       "-flush_batch_for_tests"
   };
+  bulk_load_argv.insert(bulk_load_argv.end(), extra_bulk_load_args.begin(),
+                        extra_bulk_load_args.end());
 
   std::unique_ptr<Subprocess> bulk_load_process;
   ASSERT_OK(StartProcessAndGetStreams(bulk_load_exec, bulk_load_argv, &out, &in,
@@ -580,5 +585,13 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
   }
 }
 
+TEST_F(YBBulkLoadTest, TestCLITool) {
+  RunCLITools({});
+}
+
+TEST_F(YBBulkLoadTest, TestCLIToolWriteSstFiles) {
+  RunCLITools({"-bulk_load_write_sst_files"});
+}
+
 } // namespace tools
 } // namespace yb
@@ -12,7 +12,9 @@
 //
 
 #include <sched.h>
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <thread>
 #include <boost/algorithm/string.hpp>
 
@@ -21,14 +23,19 @@
 
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/sst_file_writer.h"
 #include "yb/client/client.h"
 #include "yb/common/entity_ids.h"
 #include "yb/common/hybrid_time.h"
 #include "yb/common/schema.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/common/ql_protocol.pb.h"
+#include "yb/common/partition.h"
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/primitive_value.h"
+#include "yb/docdb/value_type.h"
+#include "yb/gutil/endian.h"
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc_controller.h"
 #include "yb/tools/bulk_load_docdb_util.h"
@@ -37,6 +44,7 @@
 #include "yb/tserver/tserver_service.proxy.h"
 #include "yb/util/status.h"
 #include "yb/util/stol_utils.h"
+#include "yb/util/env_util.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/threadpool.h"
@@ -79,16 +87,53 @@ DEFINE_int32(bulk_load_max_background_flushes, 2, "Number of flushes to perform
 DEFINE_uint64(bulk_load_num_files_per_tablet, 5,
               "Determines how to compact the data of a tablet to ensure we have only a certain "
               "number of sst files per tablet");
+DEFINE_bool(bulk_load_write_sst_files, false,
+            "Sort the key/value pairs of each tablet in memory and write them straight to "
+            "--bulk_load_num_files_per_tablet non-overlapping SST files, instead of writing them "
+            "through the RocksDB memtable and compacting the flushed files. The data of a tablet "
+            "has to fit in memory.");
 
 namespace yb {
 namespace tools {
 
 namespace {
 
+// Key/value pairs of a tablet, bucketed by the hash code of their keys. The hash ranges of the
+// buckets do not overlap, so each bucket is sorted and written to its own SST file, and the files
+// are added to the tablet's RocksDB without being compacted.
+class TabletSstBuckets {
+ public:
+  TabletSstBuckets(uint32_t hash_start, uint32_t hash_end, size_t num_buckets);
+
+  // Adds the key/value pairs of the batch, with 'hybrid_time' appended to the keys like
+  // DocDBRocksDBUtil::WriteToRocksDB() does.
+  void Add(const docdb::DocWriteBatch& doc_write_batch, HybridTime hybrid_time);
+
+  size_t num_buckets() const { return buckets_.size(); }
+
+  // Sorts the pairs of the bucket and writes them to an SST file at 'path'. Sets 'file_info' to
+  // an empty path if the bucket is empty.
+  CHECKED_STATUS WriteBucket(size_t index, const string& path, const rocksdb::Options& options,
+                             rocksdb::ExternalSstFileInfo* file_info);
+
+ private:
+  struct Bucket {
+    std::mutex mutex;
+    vector<pair<string, string>> kvs;
+  };
+
+  size_t BucketIndex(const string& key) const;
+
+  const uint32_t hash_start_;
+  const uint32_t hash_end_;
+  vector<std::unique_ptr<Bucket>> buckets_;
+};
+
 class BulkLoadTask : public Runnable {
  public:
   BulkLoadTask(vector<pair<TabletId, string>> rows, BulkLoadDocDBUtil *db_fixture,
-               const YBTable *table, YBPartitionGenerator *partition_generator);
+               const YBTable *table, YBPartitionGenerator *partition_generator,
+               TabletSstBuckets *sst_buckets);
   void Run();
  private:
   CHECKED_STATUS PopulateColumnValue(const string &column,
@@ -103,6 +148,7 @@ class BulkLoadTask : public Runnable {
   BulkLoadDocDBUtil *const db_fixture_;
   const YBTable *const table_;
   YBPartitionGenerator *const partition_generator_;
+  TabletSstBuckets *const sst_buckets_;
 };
 
 class CompactionTask: public Runnable {
@@ -125,14 +171,81 @@ class BulkLoad {
                                         vector<pair<TabletId, string>> rows);
   CHECKED_STATUS RetryableSubmit(vector<pair<TabletId, string>> rows);
   CHECKED_STATUS CompactFiles();
+  CHECKED_STATUS WriteSstFiles();
 
   shared_ptr<YBClient> client_;
   shared_ptr<YBTable> table_;
   unique_ptr<YBPartitionGenerator> partition_generator_;
   gscoped_ptr<ThreadPool> thread_pool_;
   unique_ptr<BulkLoadDocDBUtil> db_fixture_;
+  // Only set with --bulk_load_write_sst_files.
+  unique_ptr<TabletSstBuckets> sst_buckets_;
 };
 
+TabletSstBuckets::TabletSstBuckets(uint32_t hash_start, uint32_t hash_end, size_t num_buckets)
+    : hash_start_(hash_start),
+      hash_end_(std::max(hash_end, hash_start + 1)) {
+  buckets_.reserve(num_buckets);
+  for (size_t i = 0; i < num_buckets; i++) {
+    buckets_.emplace_back(new Bucket);
+  }
+}
+
+size_t TabletSstBuckets::BucketIndex(const string& key) const {
+  // Keys of hash partitioned tables start with the 16 bit hash code.
+  if (key.size() < 3 || key[0] != static_cast<char>(docdb::ValueType::kUInt16Hash)) {
+    return 0;
+  }
+  const uint32_t hash = BigEndian::Load16(key.data() + 1);
+  if (hash <= hash_start_) {
+    return 0;
+  }
+  const size_t index = (hash - hash_start_) * buckets_.size() / (hash_end_ - hash_start_);
+  return std::min(index, buckets_.size() - 1);
+}
+
+void TabletSstBuckets::Add(const docdb::DocWriteBatch& doc_write_batch, HybridTime hybrid_time) {
+  const string encoded_ht =
+      docdb::PrimitiveValue(DocHybridTime(hybrid_time, 0)).ToKeyBytes().data();
+  for (size_t i = 0; i != doc_write_batch.size(); ++i) {
+    string key = doc_write_batch.key(i).ToBuffer() + encoded_ht;
+    Bucket& bucket = *buckets_[BucketIndex(key)];
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.kvs.emplace_back(std::move(key), doc_write_batch.value(i).ToBuffer());
+  }
+}
+
+Status TabletSstBuckets::WriteBucket(size_t index, const string& path,
+                                     const rocksdb::Options& options,
+                                     rocksdb::ExternalSstFileInfo* file_info) {
+  auto& kvs = buckets_[index]->kvs;
+  file_info->file_path.clear();
+  if (kvs.empty()) {
+    return Status::OK();
+  }
+
+  // The sort is stable, so the last of the duplicate keys is kept, like it would overwrite the
+  // previous ones in the memtable.
+  std::stable_sort(kvs.begin(), kvs.end(),
+                   [](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  const rocksdb::ImmutableCFOptions ioptions(options);
+  rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), ioptions, options.comparator);
+  RETURN_NOT_OK(writer.Open(path));
+  for (size_t i = 0; i != kvs.size(); ++i) {
+    if (i + 1 != kvs.size() && kvs[i].first == kvs[i + 1].first) {
+      continue;
+    }
+    RETURN_NOT_OK(writer.Add(kvs[i].first, kvs[i].second));
+  }
+  RETURN_NOT_OK(writer.Finish(file_info));
+
+  vector<pair<string, string>>().swap(kvs);
+  return Status::OK();
+}
+
 CompactionTask::CompactionTask(const vector<string>& sst_filenames, BulkLoadDocDBUtil* db_fixture)
     : sst_filenames_(sst_filenames),
       db_fixture_(db_fixture) {
@@ -152,11 +265,13 @@ void CompactionTask::Run() {
 
 BulkLoadTask::BulkLoadTask(vector<pair<TabletId, string>> rows,
                            BulkLoadDocDBUtil *db_fixture, const YBTable *table,
-                           YBPartitionGenerator *partition_generator)
+                           YBPartitionGenerator *partition_generator,
+                           TabletSstBuckets *sst_buckets)
     : rows_(std::move(rows)),
       db_fixture_(db_fixture),
       table_(table),
-      partition_generator_(partition_generator) {
+      partition_generator_(partition_generator),
+      sst_buckets_(sst_buckets) {
 }
 
 void BulkLoadTask::Run() {
@@ -170,6 +285,11 @@ void BulkLoadTask::Run() {
                        partition_generator_));
   }
 
+  if (sst_buckets_ != nullptr) {
+    sst_buckets_->Add(*doc_write_batch, HybridTime::FromMicros(kYugaByteMicrosecondEpoch));
+    return;
+  }
+
   // Flush the batch.
   CHECK_OK(db_fixture_->WriteToRocksDB(
       *doc_write_batch, HybridTime::FromMicros(kYugaByteMicrosecondEpoch),
@@ -283,7 +403,8 @@ Status BulkLoadTask::InsertRow(const string &row,
 
 Status BulkLoad::RetryableSubmit(vector<pair<TabletId, string>> rows) {
   auto runnable = std::make_shared<BulkLoadTask>(
-      std::move(rows), db_fixture_.get(), table_.get(), partition_generator_.get());
+      std::move(rows), db_fixture_.get(), table_.get(), partition_generator_.get(),
+      sst_buckets_.get());
 
   Status s;
   do {
@@ -344,6 +465,41 @@ Status BulkLoad::CompactFiles() {
   return Status::OK();
 }
 
+Status BulkLoad::WriteSstFiles() {
+  const string sst_dir = db_fixture_->rocksdb_dir() + ".sst";
+  RETURN_NOT_OK(env_util::CreateDirIfMissing(Env::Default(), sst_dir));
+
+  // Buckets are sorted and written in parallel.
+  const size_t num_buckets = sst_buckets_->num_buckets();
+  vector<Status> statuses(num_buckets);
+  vector<rocksdb::ExternalSstFileInfo> file_infos(num_buckets);
+  for (size_t i = 0; i < num_buckets; i++) {
+    auto path = JoinPathSegments(sst_dir, std::to_string(i) + ".sst");
+    auto write_bucket = [this, i, path, &statuses, &file_infos]() {
+      statuses[i] = sst_buckets_->WriteBucket(i, path, db_fixture_->options(), &file_infos[i]);
+    };
+    if (!thread_pool_->SubmitFunc(write_bucket).ok()) {
+      // The queue is full, write the bucket in the current thread.
+      write_bucket();
+    }
+  }
+  thread_pool_->Wait();
+
+  for (size_t i = 0; i < num_buckets; i++) {
+    RETURN_NOT_OK(statuses[i]);
+    if (file_infos[i].file_path.empty()) {
+      continue;
+    }
+    rocksdb::Status s = db_fixture_->rocksdb()->AddFile(&file_infos[i], /* move_file */ true);
+    if (!s.ok()) {
+      return STATUS_SUBSTITUTE(RuntimeError, "Failed to add $0: $1", file_infos[i].file_path,
+                               s.ToString());
+    }
+  }
+  sst_buckets_.reset();
+  return Env::Default()->DeleteRecursively(sst_dir);
+}
+
 Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
                                         vector<pair<TabletId, string>> rows) {
   if (!db_fixture_) {
@@ -357,11 +513,15 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
   // Wait for all tasks for the tablet to complete.
   thread_pool_->Wait();
 
-  // Now flush the DB.
-  RETURN_NOT_OK(db_fixture_->FlushRocksDB());
+  if (sst_buckets_) {
+    RETURN_NOT_OK(WriteSstFiles());
+  } else {
+    // Now flush the DB.
+    RETURN_NOT_OK(db_fixture_->FlushRocksDB());
 
-  // Perform the necessary compactions.
-  RETURN_NOT_OK(CompactFiles());
+    // Perform the necessary compactions.
+    RETURN_NOT_OK(CompactFiles());
+  }
 
   if (!FLAGS_export_files) {
     return Status::OK();
@@ -439,6 +599,19 @@ CHECKED_STATUS BulkLoad::InitDBUtil(const TabletId &tablet_id) {
                                           FLAGS_bulk_load_max_background_flushes));
   RETURN_NOT_OK(db_fixture_->InitRocksDBOptions());
   RETURN_NOT_OK(db_fixture_->DisableCompactions()); // This opens rocksdb.
+
+  if (FLAGS_bulk_load_write_sst_files) {
+    // Bucket boundaries are spread over the hash range of the tablet.
+    master::TabletLocationsPB tablet_locations;
+    RETURN_NOT_OK(client_->GetTabletLocation(tablet_id, &tablet_locations));
+    const auto& partition = tablet_locations.partition();
+    const uint32_t hash_start = partition.partition_key_start().empty() ? 0 :
+        PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_start());
+    const uint32_t hash_end = partition.partition_key_end().empty() ? 0x10000 :
+        PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_end());
+    sst_buckets_.reset(new TabletSstBuckets(hash_start, hash_end,
+                                            FLAGS_bulk_load_num_files_per_tablet));
+  }
   return Status::OK();
 }
 
@@ -0,0 +1,63 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/backup_service.h"
+
+#include "yb/server/clock.h"
+#include "yb/tablet/operations/snapshot_operation.h"
+#include "yb/tserver/service_util.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/trace.h"
+
+namespace yb {
+namespace tserver {
+
+using tablet::SnapshotOperation;
+using tablet::SnapshotOperationState;
+using tablet::TabletPeer;
+
+TabletServiceBackupImpl::TabletServiceBackupImpl(TabletServer* server)
+    : TabletServerBackupServiceIf(server->MetricEnt()),
+      server_(server) {
+}
+
+void TabletServiceBackupImpl::TabletSnapshotOp(const TabletSnapshotOpRequestPB* req,
+                                               TabletSnapshotOpResponsePB* resp,
+                                               rpc::RpcContext context) {
+  if (!CheckUuidMatchOrRespond(server_->tablet_manager(), "TabletSnapshotOp", req, resp,
+                               &context)) {
+    return;
+  }
+  TRACE("TabletSnapshotOp");
+  LOG(INFO) << "TabletSnapshotOp: " << req->ShortDebugString();
+
+  server::UpdateClock(*req, server_->Clock());
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                 &tablet_peer)) {
+    return;
+  }
+
+  auto operation_state = std::make_unique<SnapshotOperationState>(tablet_peer.get(), req);
+  operation_state->set_completion_callback(
+      MakeRpcOperationCompletionCallback(std::move(context), resp, server_->Clock()));
+
+  // Submit the snapshot op. The RPC will be responded to asynchronously.
+  tablet_peer->Submit(std::make_unique<SnapshotOperation>(
+      std::move(operation_state), consensus::LEADER));
+}
+
+}  // namespace tserver
+}  // namespace yb
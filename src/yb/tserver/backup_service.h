@@ -0,0 +1,39 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_BACKUP_SERVICE_H
+#define YB_TSERVER_BACKUP_SERVICE_H
+
+#include "yb/tserver/backup.service.h"
+
+namespace yb {
+namespace tserver {
+
+class TabletServer;
+
+class TabletServiceBackupImpl : public TabletServerBackupServiceIf {
+ public:
+  explicit TabletServiceBackupImpl(TabletServer* server);
+
+  void TabletSnapshotOp(const TabletSnapshotOpRequestPB* req,
+                        TabletSnapshotOpResponsePB* resp,
+                        rpc::RpcContext context) override;
+
+ private:
+  TabletServer* server_;
+};
+
+}  // namespace tserver
+}  // namespace yb
+
+#endif // YB_TSERVER_BACKUP_SERVICE_H
@@ -0,0 +1,348 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/cdc_consumer.h"
+
+#include <atomic>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.h"
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/server/clock.h"
+#include "yb/tablet/operations/write_operation.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/cdc.proxy.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+#include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+
+DEFINE_int32(cdc_consumer_poll_interval_ms, 100,
+             "Time between requests for changes of a producer tablet, once all its changes are "
+             "applied.");
+TAG_FLAG(cdc_consumer_poll_interval_ms, advanced);
+TAG_FLAG(cdc_consumer_poll_interval_ms, runtime);
+
+DEFINE_int32(cdc_consumer_retry_interval_ms, 1000,
+             "Time before retrying to fetch or to apply changes of a producer tablet after an "
+             "error.");
+TAG_FLAG(cdc_consumer_retry_interval_ms, advanced);
+TAG_FLAG(cdc_consumer_retry_interval_ms, runtime);
+
+DEFINE_int32(cdc_consumer_rpc_timeout_ms, 30000,
+             "Timeout of requests for changes of producer tablets.");
+TAG_FLAG(cdc_consumer_rpc_timeout_ms, advanced);
+
+METRIC_DEFINE_gauge_int64(tablet, cdc_consumer_lag_ops, "CDC Consumer Lag",
+                          yb::MetricUnit::kOperations,
+                          "Number of committed operations of the producer tablet whose changes "
+                          "are not applied to this tablet yet.");
+METRIC_DEFINE_gauge_int64(tablet, cdc_consumer_lag_ms, "CDC Consumer Lag Time",
+                          yb::MetricUnit::kMilliseconds,
+                          "Age of the last change of the producer tablet applied to this tablet, "
+                          "0 when all changes are applied.");
+METRIC_DEFINE_counter(tablet, cdc_consumer_applied_records, "CDC Consumer Applied Records",
+                      yb::MetricUnit::kOperations,
+                      "Number of write operations of the producer tablet applied to this tablet.");
+
+namespace yb {
+namespace tserver {
+
+namespace {
+
+class ApplyCompletionCallback : public tablet::OperationCompletionCallback {
+ public:
+  explicit ApplyCompletionCallback(std::function<void(const Status&)> callback)
+      : callback_(std::move(callback)) {}
+
+  void OperationCompleted() override {
+    callback_(status_);
+  }
+
+ private:
+  std::function<void(const Status&)> callback_;
+};
+
+} // namespace
+
+class CDCConsumer::Poller : public std::enable_shared_from_this<CDCConsumer::Poller> {
+ public:
+  Poller(TabletServer* server,
+         tablet::TabletPeerPtr tablet_peer,
+         std::string producer_tablet_id,
+         std::vector<Endpoint> producer_addresses,
+         int64_t after_op_index)
+      : server_(server),
+        tablet_peer_(std::move(tablet_peer)),
+        producer_tablet_id_(std::move(producer_tablet_id)),
+        producer_addresses_(std::move(producer_addresses)),
+        last_applied_op_index_(after_op_index) {
+    const auto& metric_entity = tablet_peer_->tablet()->GetMetricEntity();
+    lag_ops_ = METRIC_cdc_consumer_lag_ops.Instantiate(metric_entity, 0);
+    lag_ms_ = METRIC_cdc_consumer_lag_ms.Instantiate(metric_entity, 0);
+    applied_records_ = METRIC_cdc_consumer_applied_records.Instantiate(metric_entity);
+    ConnectToNextProducer();
+  }
+
+  void Start() {
+    Poll();
+  }
+
+  void Stop() {
+    stopped_.store(true, std::memory_order_release);
+  }
+
+  int64_t last_applied_op_index() const {
+    return last_applied_op_index_.load(std::memory_order_acquire);
+  }
+
+ private:
+  // The changes of a GetChanges response, applied as a single write.
+  struct PendingWrite {
+    WriteRequestPB request;
+    WriteResponsePB response;
+    int64_t last_op_index;
+    int64_t committed_op_index;
+    HybridTime last_hybrid_time;
+    int num_records;
+  };
+
+  std::string LogPrefix() const {
+    return Format("T $0 (producer tablet $1): ", tablet_peer_->tablet_id(), producer_tablet_id_);
+  }
+
+  bool stopped() const {
+    return stopped_.load(std::memory_order_acquire);
+  }
+
+  // Requests for changes are sent to the next replica of the producer tablet after an error.
+  void ConnectToNextProducer() {
+    const auto& address = producer_addresses_[next_address_index_];
+    next_address_index_ = (next_address_index_ + 1) % producer_addresses_.size();
+    proxy_.reset(new CDCServiceProxy(server_->messenger(), address));
+  }
+
+  void ScheduleAfter(int delay_ms) {
+    auto self = shared_from_this();
+    server_->messenger()->ScheduleOnReactor(
+        [self](const Status& status) {
+          if (status.ok()) {
+            self->Poll();
+          }
+        },
+        MonoDelta::FromMilliseconds(delay_ms),
+        server_->messenger());
+  }
+
+  void Poll() {
+    if (stopped()) {
+      return;
+    }
+    // Only the leader of the tablet applies the changes, the followers get them through Raft.
+    if (tablet_peer_->LeaderStatus() != consensus::Consensus::LeaderStatus::LEADER_AND_READY) {
+      ScheduleAfter(FLAGS_cdc_consumer_retry_interval_ms);
+      return;
+    }
+    request_.set_tablet_id(producer_tablet_id_);
+    request_.set_after_op_index(last_applied_op_index());
+    response_.Clear();
+    controller_.Reset();
+    controller_.set_timeout(MonoDelta::FromMilliseconds(FLAGS_cdc_consumer_rpc_timeout_ms));
+    auto self = shared_from_this();
+    proxy_->GetChangesAsync(request_, &response_, &controller_,
+                            [self] { self->ChangesReceived(); });
+  }
+
+  void ChangesReceived() {
+    if (stopped()) {
+      return;
+    }
+    Status status = controller_.status();
+    if (status.ok() && response_.has_error()) {
+      status = StatusFromPB(response_.error().status());
+    }
+    if (!status.ok()) {
+      YB_LOG_EVERY_N_SECS(WARNING, 10) << LogPrefix() << "Failed to get changes: " << status;
+      ConnectToNextProducer();
+      ScheduleAfter(FLAGS_cdc_consumer_retry_interval_ms);
+      return;
+    }
+
+    if (response_.records_size() == 0) {
+      last_applied_op_index_.store(response_.last_op_index(), std::memory_order_release);
+      UpdateLag(response_.last_op_index(), response_.committed_op_index(), HybridTime::kInvalid);
+      if (response_.last_op_index() < response_.committed_op_index()) {
+        Poll();
+      } else {
+        ScheduleAfter(FLAGS_cdc_consumer_poll_interval_ms);
+      }
+      return;
+    }
+
+    auto write = std::make_shared<PendingWrite>();
+    write->request.set_tablet_id(tablet_peer_->tablet_id());
+    auto* kv_pairs = write->request.mutable_write_batch()->mutable_kv_pairs();
+    // Later pairs of the batch get higher write ids, so they override the earlier ones with the
+    // same key, like the later operations did in the producer.
+    for (auto& record : *response_.mutable_records()) {
+      for (auto& kv_pair : *record.mutable_write_batch()->mutable_kv_pairs()) {
+        kv_pairs->Add()->Swap(&kv_pair);
+      }
+      write->last_hybrid_time = HybridTime(record.hybrid_time());
+    }
+    write->last_op_index = response_.last_op_index();
+    write->committed_op_index = response_.committed_op_index();
+    write->num_records = response_.records_size();
+    Apply(write);
+  }
+
+  void Apply(const std::shared_ptr<PendingWrite>& write) {
+    auto self = shared_from_this();
+    auto state = std::make_unique<tablet::WriteOperationState>(
+        tablet_peer_.get(), &write->request, &write->response);
+    state->set_completion_callback(std::make_unique<ApplyCompletionCallback>(
+        [self, write](const Status& status) { self->Applied(write, status); }));
+    // The completion callback is not invoked when the write could not be submitted.
+    const Status status = tablet_peer_->SubmitWrite(std::move(state));
+    if (!status.ok()) {
+      Applied(write, status);
+    }
+  }
+
+  void Applied(const std::shared_ptr<PendingWrite>& write, const Status& status) {
+    if (stopped()) {
+      return;
+    }
+    if (!status.ok()) {
+      // E.g. this replica is not the leader of the tablet anymore. The same changes are fetched
+      // again by the retry.
+      YB_LOG_EVERY_N_SECS(WARNING, 10) << LogPrefix() << "Failed to apply changes: " << status;
+      ScheduleAfter(FLAGS_cdc_consumer_retry_interval_ms);
+      return;
+    }
+    last_applied_op_index_.store(write->last_op_index, std::memory_order_release);
+    applied_records_->IncrementBy(write->num_records);
+    UpdateLag(write->last_op_index, write->committed_op_index, write->last_hybrid_time);
+    Poll();
+  }
+
+  void UpdateLag(int64_t last_op_index, int64_t committed_op_index, HybridTime last_hybrid_time) {
+    lag_ops_->set_value(std::max<int64_t>(committed_op_index - last_op_index, 0));
+    if (last_op_index >= committed_op_index) {
+      lag_ms_->set_value(0);
+    } else if (last_hybrid_time.is_valid()) {
+      const auto now_micros = server_->Clock()->Now().GetPhysicalValueMicros();
+      const auto last_micros = last_hybrid_time.GetPhysicalValueMicros();
+      lag_ms_->set_value(now_micros > last_micros ? (now_micros - last_micros) / 1000 : 0);
+    }
+  }
+
+  TabletServer* const server_;
+  const tablet::TabletPeerPtr tablet_peer_;
+  const std::string producer_tablet_id_;
+  const std::vector<Endpoint> producer_addresses_;
+  size_t next_address_index_ = 0;
+  std::unique_ptr<CDCServiceProxy> proxy_;
+
+  std::atomic<int64_t> last_applied_op_index_;
+  std::atomic<bool> stopped_{false};
+
+  // Only one request is in flight at a time.
+  GetChangesRequestPB request_;
+  GetChangesResponsePB response_;
+  rpc::RpcController controller_;
+
+  scoped_refptr<AtomicGauge<int64_t>> lag_ops_;
+  scoped_refptr<AtomicGauge<int64_t>> lag_ms_;
+  scoped_refptr<Counter> applied_records_;
+};
+
+CDCConsumer::CDCConsumer(TabletServer* server) : server_(server) {
+}
+
+CDCConsumer::~CDCConsumer() {
+  Shutdown();
+}
+
+Status CDCConsumer::StartReplication(const std::string& tablet_id,
+                                     const std::string& producer_tablet_id,
+                                     std::vector<Endpoint> producer_addresses,
+                                     int64_t after_op_index) {
+  if (producer_addresses.empty()) {
+    return STATUS(InvalidArgument, "No producer addresses");
+  }
+  tablet::TabletPeerPtr tablet_peer;
+  RETURN_NOT_OK(server_->tablet_manager()->GetTabletPeer(tablet_id, &tablet_peer));
+  RETURN_NOT_OK(tablet_peer->CheckRunning());
+  if (tablet_peer->tablet()->table_type() != TableType::YQL_TABLE_TYPE) {
+    return STATUS_FORMAT(NotSupported, "Only QL tablets could be replicated, $0 is of type $1",
+                         tablet_id, TableType_Name(tablet_peer->tablet()->table_type()));
+  }
+  std::shared_ptr<Poller> poller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = pollers_[tablet_id];
+    if (slot) {
+      return STATUS_FORMAT(AlreadyPresent, "Tablet $0 is already replicated", tablet_id);
+    }
+    slot = std::make_shared<Poller>(server_, std::move(tablet_peer), producer_tablet_id,
+                                    std::move(producer_addresses), after_op_index);
+    poller = slot;
+  }
+  LOG(INFO) << "Replicating tablet " << producer_tablet_id << " to " << tablet_id
+            << " after op " << after_op_index;
+  poller->Start();
+  return Status::OK();
+}
+
+Status CDCConsumer::StopReplication(const std::string& tablet_id,
+                                    int64_t* last_applied_op_index) {
+  std::shared_ptr<Poller> poller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pollers_.find(tablet_id);
+    if (it == pollers_.end()) {
+      return STATUS_FORMAT(NotFound, "Tablet $0 is not replicated", tablet_id);
+    }
+    poller = std::move(it->second);
+    pollers_.erase(it);
+  }
+  poller->Stop();
+  // A write that is in flight could still complete, it is applied again after a restart from
+  // the returned position, which is harmless for the key-value pairs of the producer.
+  *last_applied_op_index = poller->last_applied_op_index();
+  LOG(INFO) << "Stopped replication to tablet " << tablet_id << " after op "
+            << *last_applied_op_index;
+  return Status::OK();
+}
+
+void CDCConsumer::Shutdown() {
+  std::unordered_map<std::string, std::shared_ptr<Poller>> pollers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pollers.swap(pollers_);
+  }
+  for (const auto& entry : pollers) {
+    entry.second->Stop();
+  }
+}
+
+}  // namespace tserver
+}  // namespace yb
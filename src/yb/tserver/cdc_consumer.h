@@ -0,0 +1,84 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_CDC_CONSUMER_H
+#define YB_TSERVER_CDC_CONSUMER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/net/sockaddr.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace tserver {
+
+class TabletServer;
+
+// Applies the changes of tablets of another (producer) cluster to the tablets of this server.
+//
+// A poller per replicated tablet fetches the committed changes of its producer tablet with
+// GetChanges, from any replica of the producer tablet, and applies each response to the local
+// tablet as a single write, before fetching the next one. So the changes of a producer tablet are
+// applied in the order of its log, and a lagging consumer catches up with writes of up to
+// cdc_max_changes_size_bytes.
+//
+// The changes are applied as they were written by the producer, as key-value pairs, so both
+// tablets should have the same partition and the same schema. Schema changes should be applied to
+// both clusters. Transactional tables are not supported.
+//
+// Failed requests and writes are retried, with the next producer replica for requests. The
+// position of each poller is kept in memory only, so after a restart of this server, or when the
+// producer has garbage collected the log that a poller needs, the replication should be started
+// again with StartReplication, from the position returned by StopReplication or from a copy of the
+// producer tablet.
+//
+// Lag metrics of the local tablets: cdc_consumer_lag_ops is the number of committed producer
+// operations that are not applied yet, and cdc_consumer_lag_ms the age of the last applied change
+// while not caught up.
+class CDCConsumer {
+ public:
+  explicit CDCConsumer(TabletServer* server);
+  ~CDCConsumer();
+
+  // Starts applying the changes of the producer tablet that follow the operation with index
+  // after_op_index to the tablet of this server.
+  CHECKED_STATUS StartReplication(const std::string& tablet_id,
+                                  const std::string& producer_tablet_id,
+                                  std::vector<Endpoint> producer_addresses,
+                                  int64_t after_op_index);
+
+  // Stops the replication to the tablet, returns the index of the last producer operation applied.
+  CHECKED_STATUS StopReplication(const std::string& tablet_id, int64_t* last_applied_op_index);
+
+  void Shutdown();
+
+ private:
+  class Poller;
+
+  TabletServer* const server_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Poller>> pollers_;
+
+  DISALLOW_COPY_AND_ASSIGN(CDCConsumer);
+};
+
+}  // namespace tserver
+}  // namespace yb
+
+#endif // YB_TSERVER_CDC_CONSUMER_H
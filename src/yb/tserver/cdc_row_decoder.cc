@@ -0,0 +1,162 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/cdc_row_decoder.h"
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/primitive_value.h"
+#include "yb/docdb/value.h"
+
+namespace yb {
+namespace tserver {
+
+using docdb::DocKey;
+using docdb::PrimitiveValue;
+using docdb::SubDocKey;
+using docdb::Value;
+using docdb::ValueType;
+
+namespace {
+
+Status DecodeKey(const Schema& schema, const DocKey& doc_key, RowChangePB* change) {
+  size_t column_idx = 0;
+  for (const auto* group : {&doc_key.hashed_group(), &doc_key.range_group()}) {
+    for (const auto& component : *group) {
+      if (column_idx == schema.num_key_columns()) {
+        return STATUS_FORMAT(Corruption, "More components than key columns in $0", doc_key);
+      }
+      auto* column = change->add_key();
+      column->set_column_id(schema.column_id(column_idx));
+      PrimitiveValue::ToQLValuePB(
+          component, schema.column(column_idx).type(), column->mutable_value());
+      ++column_idx;
+    }
+  }
+  return Status::OK();
+}
+
+Status DecodeColumnChange(const Schema& schema,
+                          const SubDocKey& sub_doc_key,
+                          const Value& value,
+                          RowChangePB* change) {
+  const auto& subkeys = sub_doc_key.subkeys();
+  const ColumnId column_id = subkeys[0].GetColumnId();
+  const int column_idx = schema.find_column_by_id(column_id);
+  if (column_idx == Schema::kColumnNotFound) {
+    return Status::OK();
+  }
+  const auto& type = schema.column(column_idx).type();
+  auto* column_change = change->add_columns();
+  column_change->set_column_id(column_id);
+  const bool deleted = value.value_type() == ValueType::kTombstone;
+
+  if (subkeys.size() == 1) {
+    // The init marker of a collection precedes the elements of a collection that replaces the
+    // previous one.
+    if (deleted || value.value_type() == ValueType::kObject ||
+        value.value_type() == ValueType::kArray) {
+      column_change->set_deleted(true);
+    } else if (value.value_type() == ValueType::kInt64Delta) {
+      column_change->set_increment(true);
+      column_change->mutable_value()->set_int64_value(value.primitive_value().GetInt64Delta());
+    } else {
+      PrimitiveValue::ToQLValuePB(value.primitive_value(), type, column_change->mutable_value());
+    }
+    return Status::OK();
+  }
+
+  if (subkeys.size() == 2) {
+    switch (type->main()) {
+      case MAP:
+        PrimitiveValue::ToQLValuePB(
+            subkeys[1], type->param_type(0), column_change->mutable_element_key());
+        if (deleted) {
+          column_change->set_deleted(true);
+        } else {
+          PrimitiveValue::ToQLValuePB(
+              value.primitive_value(), type->param_type(1), column_change->mutable_value());
+        }
+        return Status::OK();
+      case SET:
+        PrimitiveValue::ToQLValuePB(
+            subkeys[1], type->param_type(0), column_change->mutable_element_key());
+        column_change->set_deleted(deleted);
+        return Status::OK();
+      case LIST:
+        if (deleted) {
+          column_change->set_deleted(true);
+        } else {
+          PrimitiveValue::ToQLValuePB(
+              value.primitive_value(), type->param_type(0), column_change->mutable_value());
+        }
+        return Status::OK();
+      default:
+        break;
+    }
+  }
+  return STATUS_FORMAT(NotSupported, "Change of $0 of column $1 with type $2",
+                       sub_doc_key, column_id, type->ToString());
+}
+
+} // namespace
+
+Status DecodeRowChanges(const Schema& schema,
+                        int64_t op_index,
+                        uint64_t hybrid_time,
+                        const docdb::KeyValueWriteBatchPB& write_batch,
+                        google::protobuf::RepeatedPtrField<RowChangePB>* changes) {
+  RowChangePB* change = nullptr;
+  DocKey current_doc_key;
+  for (const auto& kv : write_batch.kv_pairs()) {
+    SubDocKey sub_doc_key;
+    RETURN_NOT_OK(sub_doc_key.FullyDecodeFromKeyWithoutHybridTime(kv.key()));
+    Value value;
+    RETURN_NOT_OK(value.Decode(kv.value()));
+
+    // The operations write the key-value pairs of a row together.
+    if (change == nullptr || sub_doc_key.doc_key() != current_doc_key) {
+      current_doc_key = sub_doc_key.doc_key();
+      change = changes->Add();
+      change->set_op_index(op_index);
+      change->set_hybrid_time(hybrid_time);
+      change->set_type(RowChangePB::WRITE);
+      RETURN_NOT_OK(DecodeKey(schema, current_doc_key, change));
+    }
+
+    if (sub_doc_key.num_subkeys() == 0) {
+      // The whole row is deleted, or its init marker is written.
+      if (value.value_type() == ValueType::kTombstone) {
+        change->set_type(RowChangePB::DELETE_ROW);
+        change->clear_columns();
+      }
+      continue;
+    }
+
+    change->set_type(RowChangePB::WRITE);
+    const auto& first_subkey = sub_doc_key.subkeys()[0];
+    switch (first_subkey.value_type()) {
+      case ValueType::kSystemColumnId:
+        // The liveness column of a row inserted with no other columns.
+        break;
+      case ValueType::kColumnId:
+        RETURN_NOT_OK(DecodeColumnChange(schema, sub_doc_key, value, change));
+        break;
+      default:
+        return STATUS_FORMAT(Corruption, "Unexpected subkey in $0", sub_doc_key);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tserver
+}  // namespace yb
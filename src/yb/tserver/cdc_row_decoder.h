@@ -0,0 +1,41 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_CDC_ROW_DECODER_H
+#define YB_TSERVER_CDC_ROW_DECODER_H
+
+#include "yb/common/schema.h"
+#include "yb/docdb/docdb.pb.h"
+#include "yb/tserver/cdc.pb.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace tserver {
+
+// Decodes the key-value pairs written by an operation of a QL tablet into changes of its rows,
+// a change per row, appended to changes.
+//
+// The columns are decoded with the current schema of the tablet, so the columns dropped since the
+// operation are left out. A row deleted and written again by the same operation is reported as a
+// write of the written columns. Only the elements of maps, sets and lists are decoded, changes of
+// the fields of user defined types are not supported.
+CHECKED_STATUS DecodeRowChanges(const Schema& schema,
+                                int64_t op_index,
+                                uint64_t hybrid_time,
+                                const docdb::KeyValueWriteBatchPB& write_batch,
+                                google::protobuf::RepeatedPtrField<RowChangePB>* changes);
+
+}  // namespace tserver
+}  // namespace yb
+
+#endif // YB_TSERVER_CDC_ROW_DECODER_H
@@ -0,0 +1,193 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/tablet_server-test-base.h"
+
+#include "yb/tserver/cdc.proxy.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace tserver {
+
+namespace {
+
+const char* kConsumerTabletId = "consumer-tablet";
+
+} // namespace
+
+class CDCServiceTest : public TabletServerTestBase {
+ public:
+  void SetUp() override {
+    TabletServerTestBase::SetUp();
+    StartTabletServer();
+    cdc_proxy_.reset(new CDCServiceProxy(client_messenger_, mini_server_->bound_rpc_addr()));
+  }
+
+ protected:
+  Result<size_t> CountRows(const scoped_refptr<tablet::TabletPeer>& tablet_peer) {
+    gscoped_ptr<RowwiseIterator> iter;
+    RETURN_NOT_OK(tablet_peer->tablet()->NewRowIterator(schema_, boost::none, &iter));
+    ScanSpec scan_spec;
+    RETURN_NOT_OK(iter->Init(&scan_spec));
+    Arena arena(32 * 1024, 256 * 1024);
+    RowBlock block(schema_, 100, &arena);
+    size_t count = 0;
+    while (iter->HasNext()) {
+      RETURN_NOT_OK(iter->NextBlock(&block));
+      count += block.selection_vector()->CountSelected();
+    }
+    return count;
+  }
+
+  int64_t CommittedOpIndex() {
+    consensus::OpId op_id;
+    CHECK_OK(tablet_peer_->consensus()->GetLastOpId(consensus::COMMITTED_OPID, &op_id));
+    return op_id.index();
+  }
+
+  gscoped_ptr<CDCServiceProxy> cdc_proxy_;
+};
+
+TEST_F(CDCServiceTest, GetChanges) {
+  ASSERT_NO_FATALS(InsertTestRowsRemote(0, 0, 10));
+
+  GetChangesRequestPB req;
+  GetChangesResponsePB resp;
+  rpc::RpcController controller;
+  req.set_tablet_id(kTabletId);
+  req.set_after_op_index(0);
+  ASSERT_OK(cdc_proxy_->GetChanges(req, &resp, &controller));
+  ASSERT_FALSE(resp.has_error()) << resp.error().ShortDebugString();
+  ASSERT_EQ(10, resp.records_size());
+  int64_t prev_op_index = 0;
+  for (const auto& record : resp.records()) {
+    ASSERT_GT(record.op_index(), prev_op_index);
+    ASSERT_GT(record.write_batch().kv_pairs_size(), 0);
+    prev_op_index = record.op_index();
+  }
+  ASSERT_EQ(CommittedOpIndex(), resp.last_op_index());
+  ASSERT_EQ(resp.last_op_index(), resp.committed_op_index());
+
+  // Nothing was written since.
+  req.set_after_op_index(resp.last_op_index());
+  controller.Reset();
+  ASSERT_OK(cdc_proxy_->GetChanges(req, &resp, &controller));
+  ASSERT_FALSE(resp.has_error()) << resp.error().ShortDebugString();
+  ASSERT_EQ(0, resp.records_size());
+
+  // Unknown tablet.
+  req.set_tablet_id("unknown-tablet");
+  controller.Reset();
+  ASSERT_OK(cdc_proxy_->GetChanges(req, &resp, &controller));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.error().code());
+}
+
+TEST_F(CDCServiceTest, GetRowChanges) {
+  ASSERT_NO_FATALS(InsertTestRowsRemote(0, 0, 10));
+  ASSERT_NO_FATALS(DeleteTestRowsRemote(0, 5));
+  const Schema& tablet_schema = *tablet_peer_->tablet()->schema();
+
+  GetRowChangesRequestPB req;
+  GetRowChangesResponsePB resp;
+  rpc::RpcController controller;
+  req.set_tablet_id(kTabletId);
+  // An operation per request.
+  req.set_max_size_bytes(1);
+  std::vector<RowChangePB> changes;
+  for (;;) {
+    controller.Reset();
+    ASSERT_OK(cdc_proxy_->GetRowChanges(req, &resp, &controller));
+    ASSERT_FALSE(resp.has_error()) << resp.error().ShortDebugString();
+    ASSERT_GE(resp.checkpoint().index(), req.checkpoint().index());
+    changes.insert(changes.end(), resp.changes().begin(), resp.changes().end());
+    if (resp.caught_up()) {
+      break;
+    }
+    *req.mutable_checkpoint() = resp.checkpoint();
+  }
+  ASSERT_EQ(CommittedOpIndex(), resp.checkpoint().index());
+
+  ASSERT_EQ(15, changes.size());
+  for (int i = 0; i != 15; ++i) {
+    const auto& change = changes[i];
+    const int key = i < 10 ? i : i - 10;
+    ASSERT_EQ(1, change.key_size());
+    ASSERT_EQ(tablet_schema.column_id(0), change.key(0).column_id());
+    ASSERT_EQ(key, change.key(0).value().int32_value());
+    if (i < 10) {
+      ASSERT_EQ(RowChangePB::WRITE, change.type());
+      ASSERT_EQ(2, change.columns_size());
+      ASSERT_EQ(tablet_schema.column_id(1), change.columns(0).column_id());
+      ASSERT_EQ(key, change.columns(0).value().int32_value());
+      ASSERT_EQ(tablet_schema.column_id(2), change.columns(1).column_id());
+      ASSERT_EQ(strings::Substitute("original$0", key),
+                change.columns(1).value().string_value());
+    } else {
+      ASSERT_EQ(RowChangePB::DELETE_ROW, change.type());
+      ASSERT_EQ(0, change.columns_size());
+      // The rows were deleted by a single operation.
+      ASSERT_EQ(changes[10].op_index(), change.op_index());
+    }
+  }
+}
+
+TEST_F(CDCServiceTest, Replicate) {
+  // The consumer tablet, of the same table, is on the same server as the producer one.
+  ASSERT_OK(mini_server_->AddTestTablet(
+      kTableName.table_name(), kConsumerTabletId, schema_, table_type_));
+  ASSERT_OK(WaitForTabletRunning(kConsumerTabletId));
+  scoped_refptr<tablet::TabletPeer> consumer_peer;
+  ASSERT_TRUE(mini_server_->server()->tablet_manager()->LookupTablet(
+      kConsumerTabletId, &consumer_peer));
+
+  ASSERT_NO_FATALS(InsertTestRowsRemote(0, 0, 50, 10));
+
+  StartReplicationRequestPB start_req;
+  StartReplicationResponsePB start_resp;
+  rpc::RpcController controller;
+  start_req.set_tablet_id(kConsumerTabletId);
+  start_req.set_producer_tablet_id(kTabletId);
+  const auto& addr = mini_server_->bound_rpc_addr();
+  auto* producer_address = start_req.add_producer_addresses();
+  producer_address->set_host(addr.address().to_string());
+  producer_address->set_port(addr.port());
+  start_req.set_after_op_index(0);
+  ASSERT_OK(cdc_proxy_->StartReplication(start_req, &start_resp, &controller));
+  ASSERT_FALSE(start_resp.has_error()) << start_resp.error().ShortDebugString();
+
+  // Rows written after the start are replicated as well.
+  ASSERT_NO_FATALS(InsertTestRowsRemote(0, 50, 50, 10));
+
+  ASSERT_OK(WaitFor([this, &consumer_peer]() -> Result<bool> {
+    auto count = CountRows(consumer_peer);
+    RETURN_NOT_OK(count);
+    return *count == 100;
+  }, MonoDelta::FromSeconds(30), "Wait for the rows to be replicated"));
+
+  // The tablet is replicated already.
+  controller.Reset();
+  ASSERT_OK(cdc_proxy_->StartReplication(start_req, &start_resp, &controller));
+  ASSERT_TRUE(start_resp.has_error());
+
+  StopReplicationRequestPB stop_req;
+  StopReplicationResponsePB stop_resp;
+  stop_req.set_tablet_id(kConsumerTabletId);
+  controller.Reset();
+  ASSERT_OK(cdc_proxy_->StopReplication(stop_req, &stop_resp, &controller));
+  ASSERT_FALSE(stop_resp.has_error()) << stop_resp.error().ShortDebugString();
+  ASSERT_EQ(CommittedOpIndex(), stop_resp.last_applied_op_index());
+}
+
+}  // namespace tserver
+}  // namespace yb
@@ -0,0 +1,231 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/cdc_service.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+
+#include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/cdc_consumer.h"
+#include "yb/tserver/cdc_row_decoder.h"
+#include "yb/tserver/service_util.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/trace.h"
+
+DEFINE_int32(cdc_max_changes_size_bytes, 4 * 1024 * 1024,
+             "Approximate size of the operations read to serve a request for the changes of a "
+             "tablet. A lagging consumer applies the changes of a request as a single write.");
+TAG_FLAG(cdc_max_changes_size_bytes, advanced);
+TAG_FLAG(cdc_max_changes_size_bytes, runtime);
+
+DEFINE_int32(cdc_max_row_changes_size_bytes, 32 * 1024 * 1024,
+             "Maximum approximate size of the operations read to serve a request for the row "
+             "changes of a tablet.");
+TAG_FLAG(cdc_max_row_changes_size_bytes, advanced);
+TAG_FLAG(cdc_max_row_changes_size_bytes, runtime);
+
+namespace yb {
+namespace tserver {
+
+using tablet::TabletPeer;
+
+namespace {
+
+template <class Resp>
+bool LookupConsensusOrRespond(TabletPeerLookupIf* tablet_manager,
+                              const std::string& tablet_id,
+                              Resp* resp,
+                              rpc::RpcContext* context,
+                              scoped_refptr<TabletPeer>* tablet_peer,
+                              std::shared_ptr<consensus::Consensus>* consensus) {
+  if (!LookupTabletPeerOrRespond(tablet_manager, tablet_id, resp, context, tablet_peer)) {
+    return false;
+  }
+  *consensus = (*tablet_peer)->shared_consensus();
+  if (!*consensus) {
+    SetupErrorAndRespond(
+        resp->mutable_error(),
+        STATUS_FORMAT(IllegalState, "Consensus not available for tablet $0", tablet_id),
+        TabletServerErrorPB::TABLET_NOT_RUNNING, context);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+CDCServiceImpl::CDCServiceImpl(TabletServer* server)
+    : CDCServiceIf(server->MetricEnt()),
+      server_(server) {
+}
+
+void CDCServiceImpl::GetChanges(const GetChangesRequestPB* req,
+                                GetChangesResponsePB* resp,
+                                rpc::RpcContext context) {
+  TRACE("GetChanges");
+  scoped_refptr<TabletPeer> tablet_peer;
+  std::shared_ptr<consensus::Consensus> consensus;
+  if (!LookupConsensusOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                &tablet_peer, &consensus)) {
+    return;
+  }
+
+  consensus::ReplicateMsgs msgs;
+  consensus::OpId committed_op_id;
+  Status s = consensus->ReadCommittedOps(
+      req->after_op_index(), FLAGS_cdc_max_changes_size_bytes, &msgs, &committed_op_id);
+  int64_t last_op_index = req->after_op_index();
+  for (size_t i = 0; s.ok() && i != msgs.size(); ++i) {
+    const auto& msg = msgs[i];
+    if (msg->op_type() == consensus::WRITE_OP) {
+      const auto& write_batch = msg->write_request().write_batch();
+      if (write_batch.has_transaction()) {
+        s = STATUS_FORMAT(NotSupported, "Operation $0 of tablet $1 is transactional",
+                          msg->id().index(), req->tablet_id());
+        break;
+      }
+      if (write_batch.kv_pairs_size() > 0) {
+        auto* record = resp->add_records();
+        record->set_op_index(msg->id().index());
+        record->set_hybrid_time(msg->hybrid_time());
+        *record->mutable_write_batch() = write_batch;
+      }
+    }
+    // Other operations, e.g. schema changes, do not change the rows of the tablet.
+    last_op_index = msg->id().index();
+  }
+  if (!s.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    return;
+  }
+  resp->set_last_op_index(last_op_index);
+  resp->set_committed_op_index(committed_op_id.index());
+  context.RespondSuccess();
+}
+
+void CDCServiceImpl::GetRowChanges(const GetRowChangesRequestPB* req,
+                                   GetRowChangesResponsePB* resp,
+                                   rpc::RpcContext context) {
+  TRACE("GetRowChanges");
+  scoped_refptr<TabletPeer> tablet_peer;
+  std::shared_ptr<consensus::Consensus> consensus;
+  if (!LookupConsensusOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                &tablet_peer, &consensus)) {
+    return;
+  }
+  auto tablet = tablet_peer->shared_tablet();
+  Status s;
+  if (!tablet) {
+    s = STATUS_FORMAT(IllegalState, "Tablet $0 is not running", req->tablet_id());
+  } else if (tablet->table_type() != TableType::YQL_TABLE_TYPE) {
+    s = STATUS_FORMAT(NotSupported, "Row changes of tablet $0 of a non-QL table",
+                      req->tablet_id());
+  }
+  if (!s.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::TABLET_NOT_RUNNING,
+                         &context);
+    return;
+  }
+
+  int max_size_bytes = FLAGS_cdc_max_row_changes_size_bytes;
+  if (req->has_max_size_bytes() && req->max_size_bytes() > 0) {
+    max_size_bytes = std::min(max_size_bytes, req->max_size_bytes());
+  }
+  consensus::ReplicateMsgs msgs;
+  consensus::OpId committed_op_id;
+  s = consensus->ReadCommittedOps(
+      req->checkpoint().index(), max_size_bytes, &msgs, &committed_op_id);
+  // The fields of OpIdPB are required, so they are set even if the request has no checkpoint.
+  consensus::OpId checkpoint;
+  checkpoint.set_term(req->checkpoint().term());
+  checkpoint.set_index(req->checkpoint().index());
+  // Rows are decoded with the current schema, see DecodeRowChanges.
+  const Schema& schema = *tablet->schema();
+  for (size_t i = 0; s.ok() && i != msgs.size(); ++i) {
+    const auto& msg = msgs[i];
+    if (msg->op_type() == consensus::WRITE_OP) {
+      const auto& write_batch = msg->write_request().write_batch();
+      if (write_batch.has_transaction()) {
+        s = STATUS_FORMAT(NotSupported, "Operation $0 of tablet $1 is transactional",
+                          msg->id().index(), req->tablet_id());
+        break;
+      }
+      s = DecodeRowChanges(schema, msg->id().index(), msg->hybrid_time(), write_batch,
+                           resp->mutable_changes());
+      if (!s.ok()) {
+        s = s.CloneAndPrepend(Format("Operation $0 of tablet $1", msg->id().index(),
+                                     req->tablet_id()));
+        break;
+      }
+    }
+    checkpoint = msg->id();
+  }
+  if (!s.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    return;
+  }
+  *resp->mutable_checkpoint() = checkpoint;
+  resp->set_caught_up(checkpoint.index() >= committed_op_id.index());
+  context.RespondSuccess();
+}
+
+void CDCServiceImpl::StartReplication(const StartReplicationRequestPB* req,
+                                      StartReplicationResponsePB* resp,
+                                      rpc::RpcContext context) {
+  LOG(INFO) << "StartReplication: " << req->ShortDebugString();
+  std::vector<Endpoint> producer_addresses;
+  Status s;
+  for (const auto& host_port_pb : req->producer_addresses()) {
+    HostPort host_port;
+    s = HostPortFromPB(host_port_pb, &host_port);
+    if (s.ok()) {
+      s = host_port.ResolveAddresses(&producer_addresses);
+    }
+    if (!s.ok()) {
+      break;
+    }
+  }
+  if (s.ok()) {
+    s = server_->cdc_consumer()->StartReplication(
+        req->tablet_id(), req->producer_tablet_id(), std::move(producer_addresses),
+        req->after_op_index());
+  }
+  if (!s.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    return;
+  }
+  context.RespondSuccess();
+}
+
+void CDCServiceImpl::StopReplication(const StopReplicationRequestPB* req,
+                                     StopReplicationResponsePB* resp,
+                                     rpc::RpcContext context) {
+  LOG(INFO) << "StopReplication: " << req->ShortDebugString();
+  int64_t last_applied_op_index = 0;
+  Status s = server_->cdc_consumer()->StopReplication(req->tablet_id(), &last_applied_op_index);
+  if (!s.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    return;
+  }
+  resp->set_last_applied_op_index(last_applied_op_index);
+  context.RespondSuccess();
+}
+
+}  // namespace tserver
+}  // namespace yb
@@ -0,0 +1,53 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_CDC_SERVICE_H
+#define YB_TSERVER_CDC_SERVICE_H
+
+#include "yb/tserver/cdc.service.h"
+
+namespace yb {
+namespace tserver {
+
+class TabletServer;
+
+// Serves the changes of the tablets of this server to other clusters, and starts and stops the
+// replication of tablets of other clusters to this server, see CDCConsumer.
+class CDCServiceImpl : public CDCServiceIf {
+ public:
+  explicit CDCServiceImpl(TabletServer* server);
+
+  void GetChanges(const GetChangesRequestPB* req,
+                  GetChangesResponsePB* resp,
+                  rpc::RpcContext context) override;
+
+  void GetRowChanges(const GetRowChangesRequestPB* req,
+                     GetRowChangesResponsePB* resp,
+                     rpc::RpcContext context) override;
+
+  void StartReplication(const StartReplicationRequestPB* req,
+                        StartReplicationResponsePB* resp,
+                        rpc::RpcContext context) override;
+
+  void StopReplication(const StopReplicationRequestPB* req,
+                       StopReplicationResponsePB* resp,
+                       rpc::RpcContext context) override;
+
+ private:
+  TabletServer* server_;
+};
+
+}  // namespace tserver
+}  // namespace yb
+
+#endif // YB_TSERVER_CDC_SERVICE_H
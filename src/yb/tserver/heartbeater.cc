@@ -70,6 +70,12 @@ DEFINE_int32(heartbeat_max_failures_before_backoff, 3,
              "rather than retrying.");
 TAG_FLAG(heartbeat_max_failures_before_backoff, advanced);
 
+DEFINE_int32(tablet_load_report_interval_ms, 60000,
+             "Interval at which the TS reports the load of its tablets to the master, as part of "
+             "the heartbeat. 0 disables the reports.");
+TAG_FLAG(tablet_load_report_interval_ms, advanced);
+TAG_FLAG(tablet_load_report_interval_ms, runtime);
+
 using google::protobuf::RepeatedPtrField;
 using yb::HostPortPB;
 using yb::consensus::RaftPeerPB;
@@ -177,6 +183,9 @@ class Heartbeater::Thread {
   // This is tracked so as to back-off heartbeating.
   int consecutive_failed_heartbeats_;
 
+  // The last time the tablet loads were sent to the master.
+  MonoTime last_tablet_load_report_;
+
   // Mutex/condition pair to trigger the heartbeater thread
   // to either heartbeat early or exit.
   Mutex mutex_;
@@ -378,6 +387,15 @@ Status Heartbeater::Thread::DoHeartbeat() {
   }
   req.set_num_live_tablets(server_->tablet_manager()->GetNumLiveTablets());
 
+  const auto now = MonoTime::Now(MonoTime::FINE);
+  const bool report_tablet_loads = FLAGS_tablet_load_report_interval_ms > 0 &&
+      (!last_tablet_load_report_.Initialized() ||
+       now.GetDeltaSince(last_tablet_load_report_).ToMilliseconds() >=
+           FLAGS_tablet_load_report_interval_ms);
+  if (report_tablet_loads) {
+    server_->tablet_manager()->GenerateTabletLoads(req.mutable_tablet_loads());
+  }
+
   RpcController rpc;
   rpc.set_timeout(MonoDelta::FromSeconds(10));
 
@@ -413,6 +431,9 @@ Status Heartbeater::Thread::DoHeartbeat() {
 
   // TODO: Handle TSHeartbeatResponsePB (e.g. deleted tablets and schema changes)
   server_->tablet_manager()->MarkTabletReportAcknowledged(req.tablet_report());
+  if (report_tablet_loads) {
+    last_tablet_load_report_ = now;
+  }
 
   // Update the live tserver list.
   RETURN_NOT_OK(server_->PopulateLiveTServers(resp));
@@ -32,6 +32,10 @@
 
 #include "yb/tserver/remote_bootstrap_client.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
@@ -60,6 +64,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_int32(remote_bootstrap_begin_session_timeout_ms, 3000,
              "Tablet server RPC client timeout for BeginRemoteBootstrapSession calls.");
@@ -83,6 +88,11 @@ DEFINE_int32(committed_config_change_role_timeout_sec, 30,
              "timing out. ");
 TAG_FLAG(committed_config_change_role_timeout_sec, hidden);
 
+DEFINE_int32(remote_bootstrap_max_concurrent_file_downloads, 4,
+             "Maximal number of RocksDB files downloaded at the same time by a remote bootstrap "
+             "client.");
+TAG_FLAG(remote_bootstrap_max_concurrent_file_downloads, advanced);
+
 DECLARE_int32(rpc_max_message_size);
 
 DEFINE_test_flag(double, fault_crash_bootstrap_client_before_changing_role, 0.0,
@@ -209,6 +219,9 @@ Status RemoteBootstrapClient::Start(const string& bootstrap_peer_uuid,
   BeginRemoteBootstrapSessionRequestPB req;
   req.set_requestor_uuid(permanent_uuid_);
   req.set_tablet_id(tablet_id_);
+  if (replace_tombstoned_tablet_) {
+    ListRetainedRocksDBFiles(req.mutable_retained_rocksdb_files());
+  }
 
   rpc::RpcController controller;
   controller.set_timeout(MonoDelta::FromMilliseconds(
@@ -232,7 +245,11 @@ Status RemoteBootstrapClient::Start(const string& bootstrap_peer_uuid,
   if (resp.superblock().table_type() != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
     string files;
     for (const auto& file : resp.superblock().rocksdb_files()) {
-      files += "Name: " + file.name() + " -- size: " + std::to_string(file.size_bytes()) + ", ";
+      files += "Name: " + file.name() + " -- size: " + std::to_string(file.size_bytes());
+      if (file.has_crc32c()) {
+        files += " -- crc32c: " + std::to_string(file.crc32c());
+      }
+      files += ", ";
     }
     LOG(INFO) << "RocksDB files: " << files;
   }
@@ -556,26 +573,126 @@ Status RemoteBootstrapClient::DownloadRocksDBFiles() {
                         Substitute("Failed to create RocksDB tablet directory $0",
                                    rocksdb_dir));
 
+  // Files are downloaded concurrently. The calls are spread over the connections to the remote
+  // server by the proxy.
+  const int num_threads = std::min(FLAGS_remote_bootstrap_max_concurrent_file_downloads,
+                                   new_sb->rocksdb_files_size());
+  gscoped_ptr<ThreadPool> download_pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("rb-download")
+                    .set_min_threads(0)
+                    .set_max_threads(std::max(num_threads, 1))
+                    .Build(&download_pool));
+  std::mutex status_mutex;
+  Status download_status;
+  std::atomic<bool> failed{false};
+  const auto retained_dir = meta_->retained_rocksdb_dir();
+  size_t num_reused_files = 0;
   for (auto const& file_pb : new_sb->rocksdb_files()) {
-    WritableFileOptions opts;
-    opts.sync_on_close = true;
-    gscoped_ptr<WritableFile> rocksdb_file;
     auto file_path = JoinPathSegments(rocksdb_dir, file_pb.name());
-    RETURN_NOT_OK(fs_manager_->env()->NewWritableFile(opts, file_path, &rocksdb_file));
-
-    DataIdPB data_id;
-    data_id.set_type(DataIdPB::ROCKSDB_FILE);
-    data_id.set_file_name(file_pb.name());
-    RETURN_NOT_OK_PREPEND(DownloadFile(data_id, rocksdb_file.get()),
-                          Substitute("Unable to download rocksdb file $0",
-                                     file_path));
-    VLOG(2) << "Downloading file " << file_path;
+    if (file_pb.has_crc32c() && ReuseRetainedRocksDBFile(file_pb, file_path)) {
+      ++num_reused_files;
+      continue;
+    }
+    auto download = [this, &file_pb, file_path, &status_mutex, &download_status, &failed]() {
+      if (failed.load(std::memory_order_acquire)) {
+        return;
+      }
+      Status s = DownloadRocksDBFile(file_pb.name(), file_path);
+      if (!s.ok()) {
+        std::lock_guard<std::mutex> lock(status_mutex);
+        if (download_status.ok()) {
+          download_status = s;
+        }
+        failed.store(true, std::memory_order_release);
+      }
+    };
+    Status s = download_pool->SubmitFunc(download);
+    if (!s.ok()) {
+      // Download in the current thread when the pool could not take the task.
+      download();
+    }
+  }
+  download_pool->Wait();
+  download_pool->Shutdown();
+  RETURN_NOT_OK(download_status);
+
+  if (fs_manager_->env()->FileExists(retained_dir)) {
+    LOG_WITH_PREFIX(INFO) << "Reused " << num_reused_files << " of "
+                          << new_sb->rocksdb_files_size() << " retained RocksDB files";
+    WARN_NOT_OK(fs_manager_->env()->DeleteRecursively(retained_dir),
+                Substitute("Unable to delete retained RocksDB files at $0", retained_dir));
   }
+
   new_superblock_.swap(new_sb);
   downloaded_rocksdb_files_ = true;
   return Status::OK();
 }
 
+void RemoteBootstrapClient::ListRetainedRocksDBFiles(
+    google::protobuf::RepeatedPtrField<tablet::RocksDBFilePB>* files) {
+  Env* const env = fs_manager_->env();
+  const auto retained_dir = meta_->retained_rocksdb_dir();
+  if (!env->FileExists(retained_dir)) {
+    return;
+  }
+  vector<string> children;
+  Status s = env->GetChildren(retained_dir, &children);
+  if (!s.ok()) {
+    LOG_WITH_PREFIX(WARNING) << "Unable to list retained RocksDB files: " << s;
+    return;
+  }
+  for (const auto& name : children) {
+    // Skips "." and "..", and the directories, like the old checkpoints.
+    bool is_dir = true;
+    uint64_t size_bytes;
+    auto path = JoinPathSegments(retained_dir, name);
+    if (!env->IsDirectory(path, &is_dir).ok() || is_dir ||
+        !env->GetFileSize(path, &size_bytes).ok()) {
+      continue;
+    }
+    auto* file_pb = files->Add();
+    file_pb->set_name(name);
+    file_pb->set_size_bytes(size_bytes);
+  }
+}
+
+bool RemoteBootstrapClient::ReuseRetainedRocksDBFile(const tablet::RocksDBFilePB& file_pb,
+                                                     const string& file_path) {
+  Env* const env = fs_manager_->env();
+  const auto retained_path = JoinPathSegments(meta_->retained_rocksdb_dir(), file_pb.name());
+  // RocksDB files are immutable, but the file numbers of two copies of a tablet are assigned
+  // independently after the copies diverged, so the contents have to be compared.
+  uint32_t crc32c;
+  Status s = env_util::Crc32cFile(env, retained_path, &crc32c);
+  if (!s.ok() || crc32c != file_pb.crc32c()) {
+    return false;
+  }
+  s = env->RenameFile(retained_path, file_path);
+  if (!s.ok()) {
+    LOG_WITH_PREFIX(WARNING) << "Unable to reuse retained RocksDB file " << retained_path << ": "
+                             << s;
+    return false;
+  }
+  VLOG(2) << "Reused retained file " << retained_path;
+  return true;
+}
+
+Status RemoteBootstrapClient::DownloadRocksDBFile(const string& file_name,
+                                                  const string& file_path) {
+  VLOG(2) << "Downloading file " << file_path;
+  WritableFileOptions opts;
+  opts.sync_on_close = true;
+  gscoped_ptr<WritableFile> rocksdb_file;
+  RETURN_NOT_OK(fs_manager_->env()->NewWritableFile(opts, file_path, &rocksdb_file));
+
+  DataIdPB data_id;
+  data_id.set_type(DataIdPB::ROCKSDB_FILE);
+  data_id.set_file_name(file_name);
+  RETURN_NOT_OK_PREPEND(DownloadFile(data_id, rocksdb_file.get()),
+                        Substitute("Unable to download rocksdb file $0", file_path));
+  return rocksdb_file->Close();
+}
+
 Status RemoteBootstrapClient::DownloadBlocks() {
   CHECK(started_);
 
@@ -36,6 +36,7 @@
 #include <memory>
 #include <vector>
 
+#include <google/protobuf/repeated_field.h>
 #include <gtest/gtest_prod.h>
 
 #include "yb/consensus/consensus.h"
@@ -60,6 +61,7 @@ class RaftPeerPB;
 } // namespace consensus
 
 namespace tablet {
+class RocksDBFilePB;
 class TabletMetadata;
 class TabletPeer;
 class TabletStatusListener;
@@ -189,8 +191,21 @@ class RemoteBootstrapClient {
   template<class Appendable>
   CHECKED_STATUS DownloadFile(const DataIdPB& data_id, Appendable* appendable);
 
+  // Download the files of the RocksDB checkpoint, up to
+  // --remote_bootstrap_max_concurrent_file_downloads of them at the same time.
   CHECKED_STATUS DownloadRocksDBFiles();
 
+  // Lists the RocksDB files kept when the replaced tablet was tombstoned.
+  void ListRetainedRocksDBFiles(google::protobuf::RepeatedPtrField<tablet::RocksDBFilePB>* files);
+
+  // Moves the retained copy of the file to the specified path, if its contents match the remote
+  // file. Returns false if the file has to be downloaded.
+  bool ReuseRetainedRocksDBFile(const tablet::RocksDBFilePB& file_pb,
+                                const std::string& file_path);
+
+  // Download a single file of the RocksDB checkpoint to the specified path.
+  CHECKED_STATUS DownloadRocksDBFile(const std::string& file_name, const std::string& file_path);
+
   CHECKED_STATUS VerifyData(uint64_t offset, const DataChunkPB& resp);
 
   // Return standard log prefix.
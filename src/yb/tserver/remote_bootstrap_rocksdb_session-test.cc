@@ -75,6 +75,29 @@ TEST_F(RemoteBootstrapRocksDBTest, CheckSuperBlockHasRocksDBFields) {
   }
 }
 
+TEST_F(RemoteBootstrapRocksDBTest, TestChecksumRetainedRocksDBFiles) {
+  auto superblock = session_->tablet_superblock();
+  ASSERT_GT(superblock.rocksdb_files().size(), 1);
+
+  // Only the files with the same name and size as a retained one are checksummed.
+  google::protobuf::RepeatedPtrField<tablet::RocksDBFilePB> retained_files;
+  *retained_files.Add() = superblock.rocksdb_files(0);
+  auto* other_size = retained_files.Add();
+  *other_size = superblock.rocksdb_files(1);
+  other_size->set_size_bytes(other_size->size_bytes() + 1);
+  ASSERT_OK(session_->ChecksumRetainedRocksDBFiles(retained_files, &superblock));
+
+  uint32_t crc32c;
+  ASSERT_OK(env_util::Crc32cFile(
+      env_.get(), JoinPathSegments(session_->checkpoint_dir_, superblock.rocksdb_files(0).name()),
+      &crc32c));
+  ASSERT_TRUE(superblock.rocksdb_files(0).has_crc32c());
+  ASSERT_EQ(crc32c, superblock.rocksdb_files(0).crc32c());
+  for (int i = 1; i < superblock.rocksdb_files().size(); ++i) {
+    ASSERT_FALSE(superblock.rocksdb_files(i).has_crc32c());
+  }
+}
+
 TEST_F(RemoteBootstrapRocksDBTest, TestNonExistentRocksDBFile) {
   string data;
   int64_t total_data_length = 0;
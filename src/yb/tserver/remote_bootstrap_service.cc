@@ -45,6 +45,7 @@
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/map-util.h"
+#include "yb/rocksdb/rate_limiter.h"
 #include "yb/rpc/rpc_context.h"
 #include "yb/tserver/remote_bootstrap_session.h"
 #include "yb/tserver/tablet_peer_lookup.h"
@@ -78,6 +79,11 @@ DEFINE_uint64(remote_bootstrap_timeout_poll_period_ms, 10000,
               "remote bootstrap sessions, in millis");
 TAG_FLAG(remote_bootstrap_timeout_poll_period_ms, hidden);
 
+DEFINE_int64(remote_bootstrap_rate_limit_bytes_per_sec, 256 * 1024 * 1024,
+             "Maximal rate of data sent by all remote bootstrap sessions of a server, in bytes per "
+             "second. Not limited when not positive.");
+TAG_FLAG(remote_bootstrap_rate_limit_bytes_per_sec, advanced);
+
 DEFINE_test_flag(double, fault_crash_on_handle_rb_fetch_data, 0.0,
                  "Fraction of the time when the tablet will crash while "
                  "servicing a RemoteBootstrapService FetchData() RPC call.");
@@ -131,11 +137,18 @@ RemoteBootstrapServiceImpl::RemoteBootstrapServiceImpl(
       fs_manager_(CHECK_NOTNULL(fs_manager)),
       tablet_peer_lookup_(CHECK_NOTNULL(tablet_peer_lookup)),
       shutdown_latch_(1) {
+  if (FLAGS_remote_bootstrap_rate_limit_bytes_per_sec > 0) {
+    rate_limiter_.reset(
+        rocksdb::NewGenericRateLimiter(FLAGS_remote_bootstrap_rate_limit_bytes_per_sec));
+  }
   CHECK_OK(Thread::Create("remote-bootstrap", "rb-session-exp",
                           &RemoteBootstrapServiceImpl::EndExpiredSessions, this,
                           &session_expiration_thread_));
 }
 
+RemoteBootstrapServiceImpl::~RemoteBootstrapServiceImpl() {
+}
+
 void RemoteBootstrapServiceImpl::BeginRemoteBootstrapSession(
         const BeginRemoteBootstrapSessionRequestPB* req,
         BeginRemoteBootstrapSessionResponsePB* resp,
@@ -181,6 +194,13 @@ void RemoteBootstrapServiceImpl::BeginRemoteBootstrapSession(
   resp->set_session_id(session_id);
   resp->set_session_idle_timeout_millis(FLAGS_remote_bootstrap_idle_timeout_ms);
   resp->mutable_superblock()->CopyFrom(session->tablet_superblock());
+  if (req->retained_rocksdb_files_size() > 0) {
+    // Reads the candidate files, so it is done outside of sessions_lock_.
+    RPC_RETURN_NOT_OK(session->ChecksumRetainedRocksDBFiles(req->retained_rocksdb_files(),
+                                                            resp->mutable_superblock()),
+                      RemoteBootstrapErrorPB::IO_ERROR,
+                      Substitute("Unable to checksum RocksDB files of tablet $0", tablet_id));
+  }
   resp->mutable_initial_committed_cstate()->CopyFrom(session->initial_committed_cstate());
 
   for (const scoped_refptr<log::ReadableLogSegment>& segment : session->log_segments()) {
@@ -275,9 +295,24 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   uint32_t crc32 = Crc32c(data->data(), data->length());
   data_chunk->set_crc32(crc32);
 
+  ThrottleFetchedData(data->size());
+
   context.RespondSuccess();
 }
 
+void RemoteBootstrapServiceImpl::ThrottleFetchedData(int64_t bytes) {
+  if (!rate_limiter_) {
+    return;
+  }
+  // A chunk could be larger than the limiter grants at once, so request it piece by piece.
+  const int64_t max_burst = rate_limiter_->GetSingleBurstBytes();
+  while (bytes > 0) {
+    const int64_t piece = std::min(bytes, max_burst);
+    rate_limiter_->Request(piece, rocksdb::Env::IO_LOW);
+    bytes -= piece;
+  }
+}
+
 void RemoteBootstrapServiceImpl::EndRemoteBootstrapSession(
         const EndRemoteBootstrapSessionRequestPB* req,
         EndRemoteBootstrapSessionResponsePB* resp,
@@ -32,6 +32,7 @@
 #ifndef YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 #define YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -45,6 +46,10 @@
 #include "yb/util/status.h"
 #include "yb/util/thread.h"
 
+namespace rocksdb {
+class RateLimiter;
+} // namespace rocksdb
+
 namespace yb {
 class FsManager;
 
@@ -63,6 +68,8 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
                              TabletPeerLookupIf* tablet_peer_lookup,
                              const scoped_refptr<MetricEntity>& metric_entity);
 
+  ~RemoteBootstrapServiceImpl();
+
   virtual void BeginRemoteBootstrapSession(const BeginRemoteBootstrapSessionRequestPB* req,
                                            BeginRemoteBootstrapSessionResponsePB* resp,
                                            rpc::RpcContext context) override;
@@ -107,9 +114,16 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   // removes them from the map.
   void EndExpiredSessions();
 
+  // Waits until the rate limiter lets 'bytes' more bytes to be sent.
+  void ThrottleFetchedData(int64_t bytes);
+
   FsManager* fs_manager_;
   TabletPeerLookupIf* tablet_peer_lookup_;
 
+  // Limits the rate of data sent by all remote bootstrap sessions of this server. Not set when
+  // the rate is not limited.
+  std::unique_ptr<rocksdb::RateLimiter> rate_limiter_;
+
   // Protects sessions_ and session_expirations_ maps.
   mutable simple_spinlock sessions_lock_;
   SessionMap sessions_;
@@ -34,19 +34,28 @@
 #include <algorithm>
 #include <boost/optional.hpp>
 
+#include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_reader.h"
 #include "yb/fs/block_manager.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/type_traits.h"
+#include "yb/rpc/rpc_controller.h"
 #include "yb/server/metadata.h"
 #include "yb/tablet/tablet_peer.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 
 DECLARE_int32(rpc_max_message_size);
 
+DEFINE_int32(remote_bootstrap_change_role_timeout_ms, 10000,
+             "Timeout of the change role request forwarded to the leader, when a peer was "
+             "remote bootstrapped from a follower.");
+TAG_FLAG(remote_bootstrap_change_role_timeout_ms, advanced);
+
 namespace yb {
 namespace tserver {
 
@@ -94,6 +103,65 @@ RemoteBootstrapSession::~RemoteBootstrapSession() {
 
 }
 
+namespace {
+
+struct ForwardedChangeConfig {
+  std::unique_ptr<consensus::ConsensusServiceProxy> proxy;
+  consensus::ChangeConfigRequestPB req;
+  consensus::ChangeConfigResponsePB resp;
+  rpc::RpcController controller;
+};
+
+} // namespace
+
+Status RemoteBootstrapSession::ChangeRoleOnLeader(const consensus::Consensus& consensus,
+                                                  consensus::ChangeConfigRequestPB* req) {
+  const auto cstate = consensus.ConsensusState(consensus::CONSENSUS_CONFIG_ACTIVE);
+  const RaftPeerPB* leader = nullptr;
+  for (const auto& peer_pb : cstate.config().peers()) {
+    if (cstate.has_leader_uuid() && peer_pb.permanent_uuid() == cstate.leader_uuid()) {
+      leader = &peer_pb;
+      break;
+    }
+  }
+  if (leader == nullptr || !leader->has_last_known_addr()) {
+    return STATUS(IllegalState, Substitute("Unable to change role for peer $0 in config for "
+                                           "tablet $1. Leader is not known",
+                                           requestor_uuid_, tablet_peer_->tablet_id()));
+  }
+
+  HostPort leader_hostport;
+  RETURN_NOT_OK(HostPortFromPB(leader->last_known_addr(), &leader_hostport));
+  std::vector<Endpoint> leader_addrs;
+  RETURN_NOT_OK(leader_hostport.ResolveAddresses(&leader_addrs));
+  if (leader_addrs.empty()) {
+    return STATUS(NetworkError, "Unable to resolve leader address", leader_hostport.ToString());
+  }
+
+  auto call = std::make_shared<ForwardedChangeConfig>();
+  call->proxy.reset(
+      new consensus::ConsensusServiceProxy(tablet_peer_->messenger(), leader_addrs[0]));
+  call->req.Swap(req);
+  call->req.set_dest_uuid(leader->permanent_uuid());
+  call->controller.set_timeout(
+      MonoDelta::FromMilliseconds(FLAGS_remote_bootstrap_change_role_timeout_ms));
+
+  LOG(INFO) << "Forwarding change config request: { " << call->req.ShortDebugString() << " } "
+            << "of bootstrap session " << session_id_ << " to leader " << leader->permanent_uuid();
+  // Like the local ChangeConfig() the call is not waited for, the requestor waits for its new
+  // role to be committed.
+  call->proxy->ChangeConfigAsync(call->req, &call->resp, &call->controller, [call]() {
+    Status status = call->controller.status();
+    if (status.ok() && call->resp.has_error()) {
+      status = StatusFromPB(call->resp.error().status());
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Forwarded change config request failed: " << status;
+    }
+  });
+  return Status::OK();
+}
+
 Status RemoteBootstrapSession::ChangeRole() {
   CHECK(succeeded_);
 
@@ -142,6 +210,11 @@ Status RemoteBootstrapSession::ChangeRole() {
 
         boost::optional<TabletServerErrorPB::Code> error_code;
 
+        if (consensus->role() != RaftPeerPB::LEADER) {
+          // The peer was bootstrapped from this follower, only the leader could change its role.
+          return ChangeRoleOnLeader(*consensus, &req);
+        }
+
         LOG(INFO) << "Changing config with request: { " << req.ShortDebugString() << " } "
                   << "in bootstrap session " << session_id_;
 
@@ -161,6 +234,27 @@ Status RemoteBootstrapSession::ChangeRole() {
                                          requestor_uuid_, tablet_peer_->tablet_id()));
 }
 
+Status RemoteBootstrapSession::ChecksumRetainedRocksDBFiles(
+    const google::protobuf::RepeatedPtrField<tablet::RocksDBFilePB>& retained_files,
+    tablet::TabletSuperBlockPB* superblock) const {
+  std::unordered_map<std::string, uint64_t> retained_sizes;
+  for (const auto& file_pb : retained_files) {
+    retained_sizes.emplace(file_pb.name(), file_pb.size_bytes());
+  }
+  for (auto& file_pb : *superblock->mutable_rocksdb_files()) {
+    auto it = retained_sizes.find(file_pb.name());
+    if (it == retained_sizes.end() || it->second != file_pb.size_bytes()) {
+      continue;
+    }
+    uint32_t crc32c;
+    RETURN_NOT_OK(env_util::Crc32cFile(fs_manager_->env(),
+                                       JoinPathSegments(checkpoint_dir_, file_pb.name()),
+                                       &crc32c));
+    file_pb.set_crc32c(crc32c);
+  }
+  return Status::OK();
+}
+
 Status RemoteBootstrapSession::SetInitialCommittedState() {
   scoped_refptr <consensus::Consensus> consensus = tablet_peer_->shared_consensus();
   if (!consensus) {
@@ -393,6 +487,24 @@ Status RemoteBootstrapSession::GetFilePiece(const std::string file_name,
                                             uint64_t offset, int64_t client_maxlen,
                                             std::string* data, int64_t* block_file_size,
                                             RemoteBootstrapErrorPB::Code* error_code) {
+  ImmutableRandomAccessFileInfo* file_info;
+  RETURN_NOT_OK(FindRocksDBFile(file_name, &file_info, error_code));
+  RETURN_NOT_OK(ReadFileChunkToBuf(file_info, offset, client_maxlen,
+                                   Substitute("rocksdb file $0", file_name),
+                                   data, block_file_size, error_code));
+
+  return Status::OK();
+}
+
+Status RemoteBootstrapSession::FindRocksDBFile(const std::string& file_name,
+                                               ImmutableRandomAccessFileInfo** file_info,
+                                               RemoteBootstrapErrorPB::Code* error_code) {
+  boost::lock_guard<simple_spinlock> l(session_lock_);
+  auto it = rocksdb_files_.find(file_name);
+  if (it != rocksdb_files_.end()) {
+    *file_info = it->second.get();
+    return Status::OK();
+  }
 
   auto file_path = JoinPathSegments(checkpoint_dir_, file_name);
   if (!fs_manager_->env()->FileExists(file_path)) {
@@ -402,22 +514,16 @@ Status RemoteBootstrapSession::GetFilePiece(const std::string file_name,
   }
 
   gscoped_ptr<RandomAccessFile> readable_file;
-  shared_ptr<RandomAccessFile> readable_file_shared_ptr;
-
   RETURN_NOT_OK(fs_manager_->env()->NewRandomAccessFile(file_path, &readable_file));
 
   uint64 file_size = 0;
   RETURN_NOT_OK(readable_file->Size(&file_size));
-  VLOG(2) << "Reading RocksDB file. File path: " << file_path << " file size: " << file_size;
-
-  readable_file_shared_ptr.reset(readable_file.release());
-
-  std::unique_ptr<ImmutableRandomAccessFileInfo> file_info(
-      new ImmutableRandomAccessFileInfo(readable_file_shared_ptr, file_size));
-  RETURN_NOT_OK(ReadFileChunkToBuf(file_info.get(), offset, client_maxlen,
-                                   Substitute("rocksdb file $0", file_name),
-                                   data, block_file_size, error_code));
+  VLOG(2) << "Opened RocksDB file. File path: " << file_path << " file size: " << file_size;
 
+  std::unique_ptr<ImmutableRandomAccessFileInfo> info(new ImmutableRandomAccessFileInfo(
+      shared_ptr<RandomAccessFile>(readable_file.release()), file_size));
+  *file_info = info.get();
+  rocksdb_files_.emplace(file_name, std::move(info));
   return Status::OK();
 }
 
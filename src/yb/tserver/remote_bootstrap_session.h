@@ -55,6 +55,11 @@ namespace yb {
 
 class FsManager;
 
+namespace consensus {
+class ChangeConfigRequestPB;
+class Consensus;
+} // namespace consensus
+
 namespace tablet {
 class TabletPeer;
 } // namespace tablet
@@ -146,6 +151,12 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
 
   const tablet::TabletSuperBlockPB& tablet_superblock() const { return tablet_superblock_; }
 
+  // Sets crc32c of the RocksDB files in 'superblock' that have the same name and size as one of
+  // the files retained by the requestor.
+  CHECKED_STATUS ChecksumRetainedRocksDBFiles(
+      const google::protobuf::RepeatedPtrField<tablet::RocksDBFilePB>& retained_files,
+      tablet::TabletSuperBlockPB* superblock) const;
+
   const consensus::ConsensusStatePB& initial_committed_cstate() const {
     return initial_committed_cstate_;
   }
@@ -167,9 +178,12 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
 
   FRIEND_TEST(RemoteBootstrapRocksDBTest, TestCheckpointDirectory);
   FRIEND_TEST(RemoteBootstrapRocksDBTest, CheckSuperBlockHasRocksDBFields);
+  FRIEND_TEST(RemoteBootstrapRocksDBTest, TestChecksumRetainedRocksDBFiles);
 
   typedef std::unordered_map<BlockId, ImmutableReadableBlockInfo*, BlockIdHash> BlockMap;
   typedef std::unordered_map<uint64_t, ImmutableRandomAccessFileInfo*> LogMap;
+  typedef std::unordered_map<std::string, std::unique_ptr<ImmutableRandomAccessFileInfo>>
+      RocksDBFileMap;
 
   ~RemoteBootstrapSession();
 
@@ -189,6 +203,15 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
                         ImmutableRandomAccessFileInfo** file_info,
                         RemoteBootstrapErrorPB::Code* error_code);
 
+  // Look up the RocksDB checkpoint file in the map of open files, opening it if needed.
+  CHECKED_STATUS FindRocksDBFile(const std::string& file_name,
+                                 ImmutableRandomAccessFileInfo** file_info,
+                                 RemoteBootstrapErrorPB::Code* error_code);
+
+  // Sends the CHANGE_ROLE request to the leader, when this session runs on a follower.
+  CHECKED_STATUS ChangeRoleOnLeader(const consensus::Consensus& consensus,
+                                    consensus::ChangeConfigRequestPB* req);
+
   // Unregister log anchor, if it's registered.
   CHECKED_STATUS UnregisterAnchorIfNeededUnlocked();
 
@@ -204,6 +227,9 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
 
   BlockMap blocks_; // Protected by session_lock_.
   LogMap logs_;     // Protected by session_lock_.
+  // RocksDB checkpoint files opened by FetchData, kept open for the following chunks of the same
+  // file. Protected by session_lock_.
+  RocksDBFileMap rocksdb_files_;
   ValueDeleter blocks_deleter_;
   ValueDeleter logs_deleter_;
 
@@ -96,5 +96,31 @@ TEST(ScannerTest, TestExpire) {
   ASSERT_EQ(s2->id(), active_scanners[0]->id());
 }
 
+TEST(ScannerTest, TestExpireAfterAccess) {
+  scoped_refptr<TabletPeer> null_peer(nullptr);
+  FLAGS_scanner_ttl_ms = 500;
+  ScannerManager mgr(nullptr);
+  SharedScanner s1, s2, s3;
+  mgr.NewScanner(null_peer, "", &s1);
+  mgr.NewScanner(null_peer, "", &s2);
+  mgr.NewScanner(null_peer, "", &s3);
+  ASSERT_TRUE(mgr.UnregisterScanner(s3->id()));
+  ASSERT_EQ(2, mgr.CountActiveScanners());
+
+  // s2 is requeued by its access time, and expires once the TTL passes since then.
+  SleepFor(MonoDelta::FromMilliseconds(300));
+  s2->UpdateAccessTime();
+  SleepFor(MonoDelta::FromMilliseconds(300));
+  mgr.RemoveExpiredScanners();
+  ASSERT_EQ(1, mgr.CountActiveScanners());
+  SharedScanner result;
+  ASSERT_FALSE(mgr.LookupScanner(s1->id(), &result));
+  ASSERT_TRUE(mgr.LookupScanner(s2->id(), &result));
+
+  SleepFor(MonoDelta::FromMilliseconds(600));
+  mgr.RemoveExpiredScanners();
+  ASSERT_EQ(0, mgr.CountActiveScanners());
+}
+
 } // namespace tserver
 } // namespace yb
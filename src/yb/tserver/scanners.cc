@@ -135,6 +135,10 @@ void ScannerManager::NewScanner(const scoped_refptr<TabletPeer>& tablet_peer,
     ScannerMapStripe& stripe = GetStripeByScannerId(id);
     std::lock_guard<boost::shared_mutex> l(stripe.lock_);
     success = InsertIfNotPresent(&stripe.scanners_by_id_, id, *scanner);
+    if (success) {
+      stripe.expiry_queue_.push(ExpiryEntry{(*scanner)->last_access_time(), id});
+      num_active_scanners_.fetch_add(1, std::memory_order_relaxed);
+    }
   }
 }
 
@@ -147,16 +151,11 @@ bool ScannerManager::LookupScanner(const string& scanner_id, SharedScanner* scan
 bool ScannerManager::UnregisterScanner(const string& scanner_id) {
   ScannerMapStripe& stripe = GetStripeByScannerId(scanner_id);
   std::lock_guard<boost::shared_mutex> l(stripe.lock_);
-  return stripe.scanners_by_id_.erase(scanner_id) > 0;
-}
-
-size_t ScannerManager::CountActiveScanners() const {
-  size_t total = 0;
-  for (const ScannerMapStripe* e : scanner_maps_) {
-    boost::shared_lock<boost::shared_mutex> l(e->lock_);
-    total += e->scanners_by_id_.size();
+  if (stripe.scanners_by_id_.erase(scanner_id) == 0) {
+    return false;
   }
-  return total;
+  num_active_scanners_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
 }
 
 void ScannerManager::ListScanners(std::vector<SharedScanner>* scanners) {
@@ -172,24 +171,36 @@ void ScannerManager::RemoveExpiredScanners() {
   MonoDelta scanner_ttl = MonoDelta::FromMilliseconds(FLAGS_scanner_ttl_ms);
 
   for (ScannerMapStripe* stripe : scanner_maps_) {
+    const MonoTime now = MonoTime::Now(MonoTime::COARSE);
     std::lock_guard<boost::shared_mutex> l(stripe->lock_);
-    for (auto it = stripe->scanners_by_id_.begin(); it != stripe->scanners_by_id_.end();) {
+    auto& queue = stripe->expiry_queue_;
+    while (!queue.empty() &&
+           now.GetDeltaSince(queue.top().last_access_time).MoreThan(scanner_ttl)) {
+      ExpiryEntry entry = queue.top();
+      queue.pop();
+      auto it = stripe->scanners_by_id_.find(entry.scanner_id);
+      if (it == stripe->scanners_by_id_.end()) {
+        // Already unregistered.
+        continue;
+      }
       SharedScanner& scanner = it->second;
-      MonoDelta time_live =
-          scanner->TimeSinceLastAccess(MonoTime::Now(MonoTime::COARSE));
-      if (time_live.MoreThan(scanner_ttl)) {
-        // TODO: once we have a metric for the number of scanners expired, make this a
-        // VLOG(1).
-        LOG(INFO) << "Expiring scanner id: " << it->first << ", of tablet " << scanner->tablet_id()
-                  << ", after " << time_live.ToMicroseconds()
-                  << " us of inactivity, which is > TTL ("
-                  << scanner_ttl.ToMicroseconds() << " us).";
-        it = stripe->scanners_by_id_.erase(it);
-        if (metrics_) {
-          metrics_->scanners_expired->Increment();
-        }
-      } else {
-        ++it;
+      const MonoTime last_access_time = scanner->last_access_time();
+      MonoDelta time_live = now.GetDeltaSince(last_access_time);
+      if (!time_live.MoreThan(scanner_ttl)) {
+        // Accessed since it was queued.
+        queue.push(ExpiryEntry{last_access_time, std::move(entry.scanner_id)});
+        continue;
+      }
+      // TODO: once we have a metric for the number of scanners expired, make this a
+      // VLOG(1).
+      LOG(INFO) << "Expiring scanner id: " << it->first << ", of tablet " << scanner->tablet_id()
+                << ", after " << time_live.ToMicroseconds()
+                << " us of inactivity, which is > TTL ("
+                << scanner_ttl.ToMicroseconds() << " us).";
+      stripe->scanners_by_id_.erase(it);
+      num_active_scanners_.fetch_sub(1, std::memory_order_relaxed);
+      if (metrics_) {
+        metrics_->scanners_expired->Increment();
       }
     }
   }
@@ -226,6 +237,21 @@ void Scanner::Init(gscoped_ptr<RowwiseIterator> iter,
   spec_.reset(spec.release());
 }
 
+void Scanner::AddStreamedBatch(std::unique_ptr<StreamedScanBatch> batch) {
+  DCHECK(streamed_batches_.empty() ||
+         streamed_batches_.back()->call_seq_id + 1 == batch->call_seq_id);
+  streamed_batches_.push_back(std::move(batch));
+}
+
+std::unique_ptr<StreamedScanBatch> Scanner::TakeStreamedBatch(uint32_t call_seq_id) {
+  if (streamed_batches_.empty() || streamed_batches_.front()->call_seq_id != call_seq_id) {
+    return nullptr;
+  }
+  auto result = std::move(streamed_batches_.front());
+  streamed_batches_.pop_front();
+  return result;
+}
+
 const ScanSpec& Scanner::spec() const {
   return *spec_;
 }
@@ -32,8 +32,11 @@
 #ifndef YB_TSERVER_SCANNERS_H
 #define YB_TSERVER_SCANNERS_H
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -41,11 +44,14 @@
 
 #include <boost/thread/shared_mutex.hpp>
 #include "yb/common/iterator_stats.h"
+#include "yb/common/wire_protocol.pb.h"
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/macros.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/tserver.pb.h"
 #include "yb/util/auto_release_pool.h"
+#include "yb/util/faststring.h"
 #include "yb/util/memory/arena.h"
 #include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
@@ -100,7 +106,9 @@ class ScannerManager {
   // Return the number of scanners currently active.
   // Note this method will not return accurate value
   // if under concurrent modifications.
-  size_t CountActiveScanners() const;
+  size_t CountActiveScanners() const {
+    return num_active_scanners_.load(std::memory_order_relaxed);
+  }
 
   // List all active scanners.
   // Note this method will not return a consistent view
@@ -121,11 +129,31 @@ class ScannerManager {
 
   typedef std::pair<std::string, SharedScanner> ScannerMapEntry;
 
+  // Scanner that could expire once the TTL passes since the last access time.
+  struct ExpiryEntry {
+    MonoTime last_access_time;
+    std::string scanner_id;
+  };
+
+  // Orders the expiry queue by last access time, least recently accessed first.
+  struct ExpiryEntryLater {
+    bool operator()(const ExpiryEntry& lhs, const ExpiryEntry& rhs) const {
+      return rhs.last_access_time.ComesBefore(lhs.last_access_time);
+    }
+  };
+
+  typedef std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, ExpiryEntryLater>
+      ExpiryQueue;
+
   struct ScannerMapStripe {
-    // Lock protecting the scanner map.
+    // Lock protecting the scanner map and the expiry queue.
     mutable boost::shared_mutex lock_;
     // Map of the currently active scanners.
     ScannerMap scanners_by_id_;
+    // Scanners of the stripe by the last access time they had when queued. Accesses don't update
+    // the queue, so the removal thread requeues scanners accessed since then, and drops entries
+    // of unregistered scanners. This way it only visits scanners that could have expired.
+    ExpiryQueue expiry_queue_;
   };
 
   // Periodically call RemoveExpiredScanners().
@@ -144,6 +172,8 @@ class ScannerManager {
 
   std::vector<ScannerMapStripe*> scanner_maps_;
 
+  std::atomic<size_t> num_active_scanners_{0};
+
   // Generator for scanner IDs.
   ObjectIdGenerator oid_generator_;
 
@@ -178,6 +208,26 @@ class ScopedUnregisterScanner {
   bool cancelled_;
 };
 
+// Batch of rows scanned ahead of the request for it, when the client streams the scan.
+// See ScanRequestPB::stream_window_batches.
+struct StreamedScanBatch {
+  // Call sequence ID of the request this batch is the response to.
+  uint32_t call_seq_id = 0;
+
+  // Serialized rows, see ScanResultCopier.
+  RowwiseRowBlockPB data;
+  faststring rows_data;
+  faststring indirect_data;
+  faststring last_primary_key;
+  int blocks_processed = 0;
+
+  bool has_more_results = false;
+
+  // Error of scanning the batch, returned to the request for it.
+  Status status;
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+};
+
 // An open scanner on the server side.
 class Scanner {
  public:
@@ -249,6 +299,11 @@ class Scanner {
     call_seq_id_ += 1;
   }
 
+  MonoTime last_access_time() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return last_access_time_;
+  }
+
   // Return the delta from the last time this scan was updated to 'now'.
   MonoDelta TimeSinceLastAccess(const MonoTime& now) const {
     std::lock_guard<simple_spinlock> l(lock_);
@@ -286,6 +341,22 @@ class Scanner {
     already_reported_stats_ = stats;
   }
 
+  // Serializes requests of a streamed scan with scanning batches ahead of them.
+  std::mutex& stream_mutex() { return stream_mutex_; }
+
+  // Number of batches scanned ahead of requests for them.
+  // REQUIRES: stream_mutex() is held.
+  size_t num_streamed_batches() const { return streamed_batches_.size(); }
+
+  // Queues a batch scanned ahead of the request for it.
+  // REQUIRES: stream_mutex() is held.
+  void AddStreamedBatch(std::unique_ptr<StreamedScanBatch> batch);
+
+  // Returns the batch for the request with the specified call sequence ID, if it was scanned
+  // ahead, nullptr otherwise.
+  // REQUIRES: stream_mutex() is held.
+  std::unique_ptr<StreamedScanBatch> TakeStreamedBatch(uint32_t call_seq_id);
+
  private:
   friend class ScannerManager;
 
@@ -335,6 +406,11 @@ class Scanner {
   // response.
   Arena arena_;
 
+  std::mutex stream_mutex_;
+
+  // Batches scanned ahead of requests for them, in call sequence ID order.
+  std::deque<std::unique_ptr<StreamedScanBatch>> streamed_batches_;
+
   DISALLOW_COPY_AND_ASSIGN(Scanner);
 };
 
@@ -0,0 +1,128 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/tablet_server-test-base.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/hdr_histogram.h"
+#include "yb/util/stopwatch.h"
+
+DEFINE_int32(tserver_rpc_bench_duration_secs, 10, "Duration of each benchmark run, in seconds.");
+DEFINE_int32(tserver_rpc_bench_client_threads, 8, "Number of client threads sending calls.");
+
+namespace yb {
+namespace tserver {
+
+// Drives the real TabletServerService through the whole RPC and tablet stack, so the overhead
+// of the RPC layer could be compared with the cost of actual request processing.
+class TabletServerRpcBench : public TabletServerTestBase {
+ public:
+  void SetUp() override {
+    TabletServerTestBase::SetUp();
+    StartTabletServer();
+  }
+
+ protected:
+  // Runs --tserver_rpc_bench_client_threads threads each invoking call till the end of the
+  // benchmark and logs throughput and latency percentiles.
+  void RunBenchmark(const std::string& name, const std::function<void(int, int64_t)>& call);
+
+  void Write(int thread_idx, int64_t iteration);
+  void Read();
+};
+
+void TabletServerRpcBench::RunBenchmark(
+    const std::string& name, const std::function<void(int, int64_t)>& call) {
+  std::atomic<bool> should_run(true);
+  std::atomic<int64_t> total_calls(0);
+  // Latency of calls in microseconds.
+  HdrHistogram latency(60000000LU, 2);
+
+  Stopwatch sw(Stopwatch::ALL_THREADS);
+  sw.start();
+  std::vector<std::thread> threads;
+  for (int i = 0; i != FLAGS_tserver_rpc_bench_client_threads; ++i) {
+    threads.emplace_back([&should_run, &total_calls, &latency, &call, i] {
+      int64_t iteration = 0;
+      while (should_run.load(std::memory_order_acquire)) {
+        auto start = MonoTime::FineNow();
+        call(i, iteration);
+        latency.Increment(MonoTime::FineNow().GetDeltaSince(start).ToMicroseconds());
+        ++iteration;
+      }
+      total_calls += iteration;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::seconds(FLAGS_tserver_rpc_bench_duration_secs));
+  should_run.store(false, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  sw.stop();
+
+  LOG(INFO) << name << " calls/sec:    " << total_calls.load() / sw.elapsed().wall_seconds();
+  LOG(INFO) << name << " latency p50:   " << latency.ValueAtPercentile(50) << "us";
+  LOG(INFO) << name << " latency p95:   " << latency.ValueAtPercentile(95) << "us";
+  LOG(INFO) << name << " latency p99:   " << latency.ValueAtPercentile(99) << "us";
+  LOG(INFO) << name << " latency p99.9: " << latency.ValueAtPercentile(99.9) << "us";
+  LOG(INFO) << name << " latency max:   " << latency.MaxValue() << "us";
+  LOG(INFO) << name << " CPU per call:  "
+            << sw.elapsed().user_cpu_seconds() * 1e6 / total_calls.load() << "us";
+}
+
+void TabletServerRpcBench::Write(int thread_idx, int64_t iteration) {
+  WriteRequestPB req;
+  WriteResponsePB resp;
+  rpc::RpcController controller;
+  controller.set_timeout(MonoDelta::FromSeconds(FLAGS_rpc_timeout));
+  req.set_tablet_id(kTabletId);
+  CHECK_OK(SchemaToPB(schema_, req.mutable_schema()));
+  // Keys from different threads should not overlap.
+  auto key = static_cast<int32_t>(
+      iteration * FLAGS_tserver_rpc_bench_client_threads + thread_idx);
+  AddTestRowToPB(RowOperationsPB::INSERT, schema_, key, key,
+                 strings::Substitute("bench$0", key), req.mutable_row_operations());
+  CHECK_OK(proxy_->Write(req, &resp, &controller));
+  CHECK(!resp.has_error()) << resp.DebugString();
+}
+
+void TabletServerRpcBench::Read() {
+  // Read without any batches, so it measures the path of the read RPC without query execution.
+  ReadRequestPB req;
+  ReadResponsePB resp;
+  rpc::RpcController controller;
+  controller.set_timeout(MonoDelta::FromSeconds(FLAGS_rpc_timeout));
+  req.set_tablet_id(kTabletId);
+  CHECK_OK(proxy_->Read(req, &resp, &controller));
+  CHECK(!resp.has_error()) << resp.DebugString();
+}
+
+TEST_F(TabletServerRpcBench, Write) {
+  RunBenchmark("Write", [this](int thread_idx, int64_t iteration) {
+    Write(thread_idx, iteration);
+  });
+}
+
+TEST_F(TabletServerRpcBench, Read) {
+  RunBenchmark("Read", [this](int, int64_t) {
+    Read();
+  });
+}
+
+} // namespace tserver
+} // namespace yb
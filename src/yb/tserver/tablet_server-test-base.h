@@ -322,7 +322,8 @@ class TabletServerTestBase : public YBTest {
                              const Schema& projection,
                              vector<string>* results,
                              TabletServerServiceProxy* proxy = NULL,
-                             uint32_t call_seq_id = 1) {
+                             uint32_t call_seq_id = 1,
+                             uint32_t stream_window_batches = 0) {
 
     if (!proxy) {
       proxy = proxy_.get();
@@ -333,6 +334,9 @@ class TabletServerTestBase : public YBTest {
     ScanRequestPB req;
     ScanResponsePB resp;
     req.set_scanner_id(scanner_id);
+    if (stream_window_batches > 0) {
+      req.set_stream_window_batches(stream_window_batches);
+    }
 
     // NOTE: we do not sort the results here, since this function is used
     // by test cases which are verifying the server side's ability to
@@ -710,6 +710,36 @@ TEST_F(TabletServerTest, TestScan) {
   }
 }
 
+TEST_F(TabletServerTest, TestStreamedScan) {
+  int num_rows = AllowSlowTests() ? 10000 : 1000;
+  InsertTestRowsDirect(0, num_rows);
+
+  ScanResponsePB resp;
+  ASSERT_NO_FATALS(OpenScannerWithAllColumns(&resp));
+  string scanner_id = resp.scanner_id();
+  ASSERT_TRUE(!scanner_id.empty());
+
+  // Batches after the first one are scanned ahead of the requests for them.
+  vector<string> results;
+  ASSERT_NO_FATALS(DrainScannerToStrings(
+      scanner_id, schema_, &results, nullptr /* proxy */, 1 /* call_seq_id */,
+      3 /* stream_window_batches */));
+  ASSERT_EQ(num_rows, results.size());
+
+  YBPartialRow row(&schema_);
+  for (int i = 0; i < num_rows; i++) {
+    BuildTestRow(i, &row);
+    string expected = "(" + row.ToString() + ")";
+    ASSERT_EQ(expected, results[i]);
+  }
+
+  // The request for the last streamed batch removes the scanner.
+  {
+    SharedScanner junk;
+    ASSERT_FALSE(mini_server_->server()->scanner_manager()->LookupScanner(scanner_id, &junk));
+  }
+}
+
 TEST_F(TabletServerTest, TestScannerOpenWhenServerShutsDown) {
   InsertTestRowsDirect(0, 1);
 
@@ -35,17 +35,23 @@
 #include <algorithm>
 #include <list>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include <glog/logging.h>
 
 #include "yb/cfile/block_cache.h"
+#include "yb/consensus/consensus.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rpc/service_if.h"
 #include "yb/server/rpc_server.h"
 #include "yb/server/webserver.h"
 #include "yb/tablet/maintenance_manager.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/backup_service.h"
+#include "yb/tserver/cdc_consumer.h"
+#include "yb/tserver/cdc_service.h"
 #include "yb/tserver/heartbeater.h"
 #include "yb/tserver/scanners.h"
 #include "yb/tserver/tablet_service.h"
@@ -56,6 +62,7 @@
 #include "yb/util/net/net_util.h"
 #include "yb/util/net/sockaddr.h"
 #include "yb/util/status.h"
+#include "yb/util/tostring.h"
 
 using std::make_shared;
 using std::shared_ptr;
@@ -96,6 +103,14 @@ DEFINE_int32(ts_remote_bootstrap_svc_queue_length, 50,
              "RPC queue length for the TS remote bootstrap service");
 TAG_FLAG(ts_remote_bootstrap_svc_queue_length, advanced);
 
+DEFINE_int32(ts_backup_svc_queue_length, 50,
+             "RPC queue length for the TS backup service");
+TAG_FLAG(ts_backup_svc_queue_length, advanced);
+
+DEFINE_int32(ts_cdc_svc_queue_length, 50,
+             "RPC queue length for the TS CDC service");
+TAG_FLAG(ts_cdc_svc_queue_length, advanced);
+
 DEFINE_bool(enable_direct_local_tablet_server_call,
             true,
             "Enable direct call to local tablet server");
@@ -113,6 +128,7 @@ TabletServer::TabletServer(const TabletServerOptions& opts)
       scanner_manager_(new ScannerManager(metric_entity())),
       path_handlers_(new TabletServerPathHandlers(this)),
       maintenance_manager_(new MaintenanceManager(MaintenanceManager::DEFAULT_OPTIONS)),
+      cdc_consumer_(new CDCConsumer(this)),
       master_config_index_(0) {
 }
 
@@ -250,6 +266,14 @@ Status TabletServer::RegisterServices() {
       new RemoteBootstrapServiceImpl(fs_manager_.get(), tablet_manager_.get(), metric_entity()));
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_remote_bootstrap_svc_queue_length,
                                                      std::move(remote_bootstrap_service)));
+
+  std::unique_ptr<ServiceIf> backup_service(new TabletServiceBackupImpl(this));
+  RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_backup_svc_queue_length,
+                                                     std::move(backup_service)));
+
+  std::unique_ptr<ServiceIf> cdc_service(new CDCServiceImpl(this));
+  RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_cdc_svc_queue_length,
+                                                     std::move(cdc_service)));
   return Status::OK();
 }
 
@@ -279,6 +303,7 @@ void TabletServer::Shutdown() {
   if (initted_) {
     maintenance_manager_->Shutdown();
     WARN_NOT_OK(heartbeater_->Stop(), "Failed to stop TS Heartbeat thread");
+    cdc_consumer_->Shutdown();
     RpcAndWebServerBase::Shutdown();
     scanner_manager_.reset();
     tablet_manager_->Shutdown();
@@ -288,13 +313,39 @@ void TabletServer::Shutdown() {
 }
 
 Status TabletServer::PopulateLiveTServers(const master::TSHeartbeatResponsePB& heartbeat_resp) {
-  std::lock_guard<simple_spinlock> l(lock_);
-  // We reset the list each time, since we want to keep the tservers that are live from the
-  // master's perspective.
-  // TODO: In the future, we should enhance the logic here to keep track information retrieved
-  // from the master and compare it with information stored here. Based on this information, we
-  // can only send diff updates CQL clients about whether a node came up or went down.
-  live_tservers_.assign(heartbeat_resp.tservers().begin(), heartbeat_resp.tservers().end());
+  std::vector<std::string> down_tservers;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    std::unordered_set<std::string> live_uuids;
+    for (const auto& tserver : heartbeat_resp.tservers()) {
+      live_uuids.insert(tserver.tserver_instance().permanent_uuid());
+    }
+    for (const auto& tserver : live_tservers_) {
+      const auto& uuid = tserver.tserver_instance().permanent_uuid();
+      if (!live_uuids.count(uuid)) {
+        down_tservers.push_back(uuid);
+      }
+    }
+    // We reset the list each time, since we want to keep the tservers that are live from the
+    // master's perspective.
+    // TODO: In the future, we should enhance the logic here to keep track information retrieved
+    // from the master and compare it with information stored here. Based on this information, we
+    // can only send diff updates CQL clients about whether a node came up or went down.
+    live_tservers_.assign(heartbeat_resp.tservers().begin(), heartbeat_resp.tservers().end());
+  }
+
+  // Quiescent followers do not detect failures of their leaders by themselves.
+  if (!down_tservers.empty()) {
+    LOG(INFO) << "Tablet servers went down: " << yb::ToString(down_tservers);
+    std::vector<scoped_refptr<tablet::TabletPeer>> tablet_peers;
+    tablet_manager_->GetTabletPeers(&tablet_peers);
+    for (const auto& tablet_peer : tablet_peers) {
+      auto consensus = tablet_peer->shared_consensus();
+      if (consensus) {
+        consensus->ServersWentDown(down_tservers);
+      }
+    }
+  }
   return Status::OK();
 }
 
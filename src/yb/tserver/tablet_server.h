@@ -57,6 +57,7 @@ class MaintenanceManager;
 
 namespace tserver {
 
+class CDCConsumer;
 class Heartbeater;
 class ScannerManager;
 class TabletServerPathHandlers;
@@ -105,6 +106,8 @@ class TabletServer : public server::RpcAndWebServerBase, public TabletServerIf {
     return maintenance_manager_.get();
   }
 
+  CDCConsumer* cdc_consumer() { return cdc_consumer_.get(); }
+
   int GetCurrentMasterIndex() { return master_config_index_; }
 
   void SetCurrentMasterIndex(int index) { master_config_index_ = index; }
@@ -174,6 +177,9 @@ class TabletServer : public server::RpcAndWebServerBase, public TabletServerIf {
   // The maintenance manager for this tablet server
   std::shared_ptr<MaintenanceManager> maintenance_manager_;
 
+  // Applies the changes of tablets of other clusters to the tablets of this server.
+  gscoped_ptr<CDCConsumer> cdc_consumer_;
+
   // Index at which master sent us the last config
   int master_config_index_;
 
@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -48,6 +49,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/escaping.h"
+#include "yb/rpc/inbound_call.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tserver/remote_bootstrap_service.h"
@@ -57,6 +59,7 @@
 #include "yb/tablet/tablet_metrics.h"
 
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/ingest_files_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 
@@ -70,6 +73,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/monotime.h"
+#include "yb/util/random_util.h"
 #include "yb/util/status.h"
 #include "yb/util/status_callback.h"
 #include "yb/util/trace.h"
@@ -92,6 +96,12 @@ DEFINE_int32(scanner_batch_size_rows, 100,
 TAG_FLAG(scanner_batch_size_rows, advanced);
 TAG_FLAG(scanner_batch_size_rows, runtime);
 
+DEFINE_int32(scanner_max_stream_window_batches, 4,
+             "The maximum number of batches a streamed scan may scan ahead of the requests for "
+             "them. 0 disables streaming of scans.");
+TAG_FLAG(scanner_max_stream_window_batches, advanced);
+TAG_FLAG(scanner_max_stream_window_batches, runtime);
+
 // Fault injection flags.
 DEFINE_int32(scanner_inject_latency_on_each_batch_ms, 0,
              "If set, the scanner will pause the specified number of milliesconds "
@@ -105,6 +115,22 @@ DEFINE_int32(max_wait_for_safe_time_ms, 5000,
              "Maximum time in milliseconds to wait for the safe time to advance when trying to "
              "scan at the given hybrid_time.");
 
+DEFINE_int32(sst_files_soft_limit, 16,
+             "When the number of SST files of a tablet, that RocksDB counts towards its write "
+             "slowdown and stop triggers, exceeds this limit, the leader rejects a part of writes "
+             "to the tablet as busy, growing linearly with the number of files up to "
+             "sst_files_hard_limit. So clients back off gradually before RocksDB stalls writes. "
+             "Not positive values disable the throttling.");
+TAG_FLAG(sst_files_soft_limit, advanced);
+TAG_FLAG(sst_files_soft_limit, runtime);
+
+DEFINE_int32(sst_files_hard_limit, 40,
+             "When the number of SST files of a tablet, that RocksDB counts towards its write "
+             "slowdown and stop triggers, reaches this limit, the leader rejects all writes to "
+             "the tablet as busy. See sst_files_soft_limit.");
+TAG_FLAG(sst_files_hard_limit, advanced);
+TAG_FLAG(sst_files_hard_limit, runtime);
+
 DEFINE_bool(tserver_noop_read_write, false, "Respond NOOP to read/write.");
 TAG_FLAG(tserver_noop_read_write, unsafe);
 TAG_FLAG(tserver_noop_read_write, hidden);
@@ -176,6 +202,67 @@ Status GetTabletRef(const scoped_refptr<TabletPeer>& tablet_peer,
   return Status::OK();
 }
 
+// Probability of rejecting a write to a tablet with the specified number of SST files delaying
+// writes. Grows linearly from 0 at the soft limit to 1 at the hard limit.
+double CompactionPressureRejectionProbability(int num_sst_files) {
+  const int soft_limit = FLAGS_sst_files_soft_limit;
+  if (soft_limit <= 0 || num_sst_files <= soft_limit) {
+    return 0;
+  }
+  const int hard_limit = FLAGS_sst_files_hard_limit;
+  if (num_sst_files >= hard_limit) {
+    return 1;
+  }
+  return static_cast<double>(num_sst_files - soft_limit) / (hard_limit - soft_limit);
+}
+
+void SetupConsensusError(const Status& s,
+                         TabletServerErrorPB::Code code,
+                         ConsensusResponsePB* resp) {
+  resp->Clear();
+  StatusToPB(s, resp->mutable_error()->mutable_status());
+  resp->mutable_error()->set_code(code);
+}
+
+// Applies the consensus request of a single tablet of MultiRaftUpdateConsensus. Errors are stored
+// in the response of the tablet instead of failing the whole RPC, so the leader handles them as if
+// the request was sent alone.
+void UpdateTabletConsensus(TabletPeerLookupIf* tablet_manager,
+                           ConsensusRequestPB* req,
+                           ConsensusResponsePB* resp) {
+  const string& local_uuid = tablet_manager->NodeInstance().permanent_uuid();
+  if (PREDICT_FALSE(req->has_dest_uuid() && req->dest_uuid() != local_uuid)) {
+    SetupConsensusError(
+        STATUS_SUBSTITUTE(InvalidArgument,
+                          "MultiRaftUpdateConsensus: Wrong destination UUID requested. "
+                          "Local UUID: $0. Requested UUID: $1", local_uuid, req->dest_uuid()),
+        TabletServerErrorPB::WRONG_SERVER_UUID, resp);
+    return;
+  }
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  Status s = tablet_manager->GetTabletPeer(req->tablet_id(), &tablet_peer);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupConsensusError(s, s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                                    : TabletServerErrorPB::TABLET_NOT_FOUND,
+                        resp);
+    return;
+  }
+  const tablet::TabletStatePB state = tablet_peer->state();
+  auto consensus = tablet_peer->shared_consensus();
+  if (PREDICT_FALSE(state != tablet::RUNNING || !consensus)) {
+    SetupConsensusError(
+        STATUS(IllegalState, "Tablet not RUNNING", tablet::TabletStatePB_Name(state)),
+        TabletServerErrorPB::TABLET_NOT_RUNNING, resp);
+    return;
+  }
+
+  s = consensus->Update(req, resp);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupConsensusError(s, TabletServerErrorPB::UNKNOWN_ERROR, resp);
+  }
+}
+
 } // namespace
 
 // Prepares modification operation, checks limits, fetches tablet_peer and tablet etc.
@@ -220,6 +307,21 @@ bool TabletServiceImpl::PrepareModify(
     return false;
   }
 
+  // Push back on clients in proportion to how far compactions are behind, instead of letting
+  // RocksDB stall all writes to the tablet once its slowdown and stop triggers are reached.
+  const int num_sst_files = (*tablet)->NumSstFilesDelayingWrites();
+  if (RandomActWithProbability(CompactionPressureRejectionProbability(num_sst_files))) {
+    (*tablet)->metrics()->leader_compaction_pressure_rejections->Increment();
+    string msg = StringPrintf(
+        "SST files limit exceeded (%d files, soft limit %d, hard limit %d)",
+        num_sst_files, FLAGS_sst_files_soft_limit, FLAGS_sst_files_hard_limit);
+    YB_LOG_EVERY_N_SECS(INFO, 1) << "Rejecting Write request: " << msg << THROTTLE_MSG;
+    SetupErrorAndRespond(resp->mutable_error(), STATUS(ServiceUnavailable, msg),
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         context);
+    return false;
+  }
+
   return true;
 }
 
@@ -486,6 +588,20 @@ TabletServiceImpl::TabletServiceImpl(TabletServerIf* server)
       server_(server) {
 }
 
+rpc::RpcCallClass TabletServiceImpl::CallClass(const rpc::InboundCall& call) const {
+  const auto& method_name = call.method_name();
+  if (method_name == "Write") {
+    return rpc::RpcCallClass::kWrite;
+  }
+  if (method_name == "Read") {
+    return rpc::RpcCallClass::kRead;
+  }
+  if (method_name == "Scan") {
+    return rpc::RpcCallClass::kScan;
+  }
+  return rpc::RpcCallClass::kDefault;
+}
+
 TabletServiceAdminImpl::TabletServiceAdminImpl(TabletServer* server)
     : TabletServerAdminServiceIf(server->MetricEnt()),
       server_(server) {
@@ -584,6 +700,10 @@ void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
   state->set_completion_callback(MakeRpcOperationCompletionCallback(
       std::move(context), resp, server_->Clock()));
 
+  if (!req->state().transaction_ids().empty()) {
+    tablet_peer->tablet()->transaction_coordinator()->HandleHeartbeats(std::move(state), resp);
+    return;
+  }
   tablet_peer->tablet()->transaction_coordinator()->Handle(std::move(state));
 }
 
@@ -603,8 +723,7 @@ void TabletServiceImpl::GetTransactionStatus(const GetTransactionStatusRequestPB
     return;
   }
 
-  auto status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(
-      req->transaction_id(), resp);
+  auto status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(*req, resp);
   resp->set_propagated_hybrid_time(server_->Clock()->Now().ToUint64());
   if (status.ok()) {
     context.RespondSuccess();
@@ -828,12 +947,19 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
     return;
   }
 
-  auto operation_state = std::make_unique<WriteOperationState>(tablet_peer.get(), req, resp);
+  // Nothing reads the request once it is handed to the operation, so move its payload into the
+  // operation instead of copying it. The operation in turn hands it to the replicate message that
+  // is appended to the log and kept in the log cache, so the payload is stored only once.
+  const bool include_trace = req->include_trace();
+  auto request = std::make_unique<WriteRequestPB>();
+  request->Swap(const_cast<WriteRequestPB*>(req));
+  auto operation_state = std::make_unique<WriteOperationState>(
+      tablet_peer.get(), std::move(request), resp);
 
   auto context_ptr = std::make_shared<RpcContext>(std::move(context));
   operation_state->set_completion_callback(
       std::make_unique<WriteOperationCompletionCallback>(
-          context_ptr, resp, operation_state.get(), server_->Clock(), req->include_trace()));
+          context_ptr, resp, operation_state.get(), server_->Clock(), include_trace));
 
   auto status = tablet_peer->SubmitWrite(std::move(operation_state));
 
@@ -926,6 +1052,42 @@ bool TabletServiceImpl::GetTabletOrRespond(const ReadRequestPB* req,
   return true;
 }
 
+bool TabletServiceImpl::GetReadLimitOrRespond(const ReadRequestPB* req,
+                                              ReadResponsePB* resp,
+                                              rpc::RpcContext* context,
+                                              HybridTime* read_limit) {
+  *read_limit = HybridTime::kInvalid;
+  if (req->consistency_level() == YBConsistencyLevel::STRONG || !req->has_max_staleness_ms()) {
+    return true;
+  }
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, context,
+                                 &tablet_peer)) {
+    return false;
+  }
+  auto consensus = tablet_peer->shared_consensus();
+  if (!consensus || consensus->role() == consensus::RaftPeerPB::LEADER) {
+    // Leader has all committed operations, so its own safe time is used.
+    return true;
+  }
+
+  HybridTime leader_safe_time = consensus->LeaderSafeTime();
+  auto min_allowed_micros = server_->Clock()->Now().GetPhysicalValueMicros() -
+                            req->max_staleness_ms() * 1000ULL;
+  if (!leader_safe_time.is_valid() ||
+      leader_safe_time.GetPhysicalValueMicros() < min_allowed_micros) {
+    auto status = STATUS_FORMAT(
+        IllegalState, "Follower safe time $0 is staler than $1 ms",
+        leader_safe_time, req->max_staleness_ms());
+    SetupErrorAndRespond(resp->mutable_error(), status, TabletServerErrorPB::STALE_FOLLOWER,
+                         context);
+    return false;
+  }
+  *read_limit = leader_safe_time;
+  return true;
+}
+
 void TabletServiceImpl::Read(const ReadRequestPB* req,
                              ReadResponsePB* resp,
                              rpc::RpcContext context) {
@@ -943,8 +1105,19 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
     return;
   }
 
+  HybridTime read_limit;
+  if (!GetReadLimitOrRespond(req, resp, &context, &read_limit)) {
+    return;
+  }
+
   Status s;
-  tablet::ScopedReadOperation read_tx(tablet.get());
+  tablet::ScopedReadOperation read_tx(tablet.get(), read_limit);
+  if (!read_tx.status().ok()) {
+    // Only a follower read could be limited to a time before the history cutoff.
+    SetupErrorAndRespond(resp->mutable_error(), read_tx.status(),
+                         TabletServerErrorPB::STALE_FOLLOWER, &context);
+    return;
+  }
   switch (tablet->table_type()) {
     case TableType::REDIS_TABLE_TYPE: {
       for (const RedisReadRequestPB& redis_read_req : req->redis_batch()) {
@@ -1042,6 +1215,20 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context.RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(
+    const consensus::MultiRaftConsensusRequestPB* req,
+    consensus::MultiRaftConsensusResponsePB* resp,
+    rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi Raft Consensus Update RPC for " << req->consensus_request_size()
+           << " tablets";
+  // Same as in UpdateConsensus, requests are moved out of for efficiency.
+  auto* mutable_req = const_cast<consensus::MultiRaftConsensusRequestPB*>(req);
+  for (auto& tablet_req : *mutable_req->mutable_consensus_request()) {
+    UpdateTabletConsensus(tablet_manager_, &tablet_req, resp->add_consensus_response());
+  }
+  context.RespondSuccess();
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
@@ -1304,11 +1491,13 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
   }
 
   size_t batch_size_bytes = GetMaxBatchSizeBytesHint(req);
-  faststring rows_data(batch_size_bytes * 11 / 10);
-  faststring indirect_data(batch_size_bytes * 11 / 10);
-  RowwiseRowBlockPB data;
-  ScanResultCopier collector(&data, &rows_data, &indirect_data);
+  std::unique_ptr<StreamedScanBatch> batch(new StreamedScanBatch);
+  batch->rows_data.reserve(batch_size_bytes * 11 / 10);
+  batch->indirect_data.reserve(batch_size_bytes * 11 / 10);
+  ScanResultCopier collector(&batch->data, &batch->rows_data, &batch->indirect_data);
 
+  std::string scanner_id;
+  bool streamed = false;
   bool has_more_results = false;
   TabletServerErrorPB::Code error_code;
   if (req->has_new_scan_request()) {
@@ -1318,7 +1507,6 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
                                    &tablet_peer)) {
       return;
     }
-    string scanner_id;
     HybridTime scan_hybrid_time;
     Status s = HandleNewScanRequest(tablet_peer.get(), req, &context,
                                     &collector, &scanner_id, &scan_hybrid_time, &has_more_results,
@@ -1336,10 +1524,37 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
       resp->set_snap_hybrid_time(scan_hybrid_time.ToUint64());
     }
   } else if (req->has_scanner_id()) {
-    Status s = HandleContinueScanRequest(req, &collector, &has_more_results, &error_code);
-    if (PREDICT_FALSE(!s.ok())) {
-      SetupErrorAndRespond(resp->mutable_error(), s, error_code, &context);
-      return;
+    scanner_id = req->scanner_id();
+    SharedScanner scanner;
+    std::unique_lock<std::mutex> stream_lock;
+    std::unique_ptr<StreamedScanBatch> streamed_batch;
+    if (server_->scanner_manager()->LookupScanner(scanner_id, &scanner)) {
+      // Waits for the batch being scanned ahead, if any.
+      stream_lock = std::unique_lock<std::mutex>(scanner->stream_mutex());
+      if (batch_size_bytes != 0 || !req->close_scanner()) {
+        streamed_batch = scanner->TakeStreamedBatch(req->call_seq_id());
+      }
+    }
+    if (streamed_batch) {
+      TRACE("Found streamed batch");
+      streamed = true;
+      scanner->UpdateAccessTime();
+      has_more_results = !req->close_scanner() && streamed_batch->has_more_results;
+      if (!has_more_results) {
+        server_->scanner_manager()->UnregisterScanner(scanner_id);
+      }
+      if (PREDICT_FALSE(!streamed_batch->status.ok())) {
+        SetupErrorAndRespond(
+            resp->mutable_error(), streamed_batch->status, streamed_batch->error_code, &context);
+        return;
+      }
+      batch = std::move(streamed_batch);
+    } else {
+      Status s = HandleContinueScanRequest(req, &collector, &has_more_results, &error_code);
+      if (PREDICT_FALSE(!s.ok())) {
+        SetupErrorAndRespond(resp->mutable_error(), s, error_code, &context);
+        return;
+      }
     }
   } else {
     context.RespondFailure(STATUS(InvalidArgument,
@@ -1348,32 +1563,42 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
   }
   resp->set_has_more_results(has_more_results);
 
-  DVLOG(2) << "Blocks processed: " << collector.BlocksProcessed();
-  if (collector.BlocksProcessed() > 0) {
-    resp->mutable_data()->CopyFrom(data);
+  if (!streamed) {
+    batch->blocks_processed = collector.BlocksProcessed();
+    batch->last_primary_key.append(collector.last_primary_key().data(),
+                                   collector.last_primary_key().size());
+  }
+  DVLOG(2) << "Blocks processed: " << batch->blocks_processed;
+  if (batch->blocks_processed > 0) {
+    resp->mutable_data()->CopyFrom(batch->data);
 
     // Add sidecar data to context and record the returned indices.
     int rows_idx;
-    CHECK_OK(context.AddRpcSidecar(RefCntBuffer(rows_data), &rows_idx));
+    CHECK_OK(context.AddRpcSidecar(RefCntBuffer(batch->rows_data), &rows_idx));
     resp->mutable_data()->set_rows_sidecar(rows_idx);
 
     // Add indirect data as a sidecar, if applicable.
-    if (indirect_data.size() > 0) {
+    if (batch->indirect_data.size() > 0) {
       int indirect_idx;
-      CHECK_OK(context.AddRpcSidecar(RefCntBuffer(indirect_data), &indirect_idx));
+      CHECK_OK(context.AddRpcSidecar(RefCntBuffer(batch->indirect_data), &indirect_idx));
       resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
     }
 
     // Set the last row found by the collector.
     // We could have an empty batch if all the remaining rows are filtered by the predicate,
     // in which case do not set the last row.
-    const faststring& last = collector.last_primary_key();
+    const faststring& last = batch->last_primary_key;
     if (last.length() > 0) {
       resp->set_last_primary_key(last.ToString());
     }
   }
 
   context.RespondSuccess();
+
+  if (has_more_results && req->stream_window_batches() > 0) {
+    // Scan ahead while the response is on its way and the client processes it.
+    StreamScanBatches(*req, scanner_id);
+  }
 }
 
 void TabletServiceImpl::ListTablets(const ListTabletsRequestPB* req,
@@ -1507,6 +1732,31 @@ void TabletServiceImpl::ImportData(const ImportDataRequestPB* req,
   context.RespondSuccess();
 }
 
+void TabletServiceImpl::IngestFiles(const IngestFilesRequestPB* req,
+                                    IngestFilesResponsePB* resp,
+                                    rpc::RpcContext context) {
+  TRACE("IngestFiles");
+
+  tablet::TabletPeerPtr tablet_peer;
+  tablet::TabletPtr tablet;
+  if (!PrepareModify(*req, resp, &context, &tablet_peer, &tablet)) {
+    return;
+  }
+
+  TabletServerErrorPB::Code error_code;
+  auto status = CheckPeerIsLeader(*tablet_peer, &error_code);
+  if (!status.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(), status, error_code, &context);
+    return;
+  }
+
+  auto state = std::make_unique<tablet::IngestFilesOperationState>(tablet_peer.get(), req);
+  state->set_completion_callback(MakeRpcOperationCompletionCallback(
+      std::move(context), resp, server_->Clock()));
+  tablet_peer->Submit(std::make_unique<tablet::IngestFilesOperation>(
+      std::move(state), consensus::LEADER));
+}
+
 void TabletServiceImpl::Shutdown() {
 }
 
@@ -1894,6 +2144,23 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
     *error_code = TabletServerErrorPB::INVALID_SCAN_CALL_SEQ_ID;
     return STATUS(InvalidArgument, "Invalid call sequence ID in scan request");
   }
+
+  RETURN_NOT_OK(ScanNextBatch(scanner.get(), batch_size_bytes, result_collector, error_code));
+
+  *has_more_results = !req->close_scanner() && scanner->iter()->HasNext();
+  if (*has_more_results) {
+    unreg_scanner.Cancel();
+  } else {
+    VLOG(2) << "Scanner " << scanner->id() << " complete: removing...";
+  }
+
+  return Status::OK();
+}
+
+Status TabletServiceImpl::ScanNextBatch(Scanner* scanner,
+                                        size_t batch_size_bytes,
+                                        ScanResultCollector* result_collector,
+                                        TabletServerErrorPB::Code* error_code) {
   scanner->IncrementCallSeqId();
   scanner->UpdateAccessTime();
 
@@ -1902,9 +2169,9 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
   // TODO: could size the RowBlock based on the user's requested batch size?
   // If people had really large indirect objects, we would currently overshoot
   // their requested batch size by a lot.
-  Arena arena(32 * 1024, 1 * 1024 * 1024);
+  PooledArena arena = AcquirePooledArena();
   RowBlock block(scanner->iter()->schema(),
-                 FLAGS_scanner_batch_size_rows, &arena);
+                 FLAGS_scanner_batch_size_rows, arena.get());
 
   // TODO: in the future, use the client timeout to set a budget. For now,
   // just use a half second, which should be plenty to amortize call overhead.
@@ -1920,7 +2187,7 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
 
     Status s = iter->NextBlock(&block);
     if (PREDICT_FALSE(!s.ok())) {
-      LOG(WARNING) << "Copying rows from internal iterator for request " << req->ShortDebugString();
+      LOG(WARNING) << "Copying rows from internal iterator of scanner " << scanner->id();
       *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
       return s;
     }
@@ -1986,16 +2253,38 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
       delta_stats.bytes_read_from_disk);
 
   scanner->UpdateAccessTime();
-  *has_more_results = !req->close_scanner() && iter->HasNext();
-  if (*has_more_results) {
-    unreg_scanner.Cancel();
-  } else {
-    VLOG(2) << "Scanner " << scanner->id() << " complete: removing...";
-  }
-
   return Status::OK();
 }
 
+void TabletServiceImpl::StreamScanBatches(const ScanRequestPB& req, const std::string& scanner_id) {
+  const size_t window = std::min<size_t>(
+      req.stream_window_batches(), std::max(FLAGS_scanner_max_stream_window_batches, 0));
+  SharedScanner scanner;
+  if (window == 0 || !server_->scanner_manager()->LookupScanner(scanner_id, &scanner)) {
+    return;
+  }
+  const size_t batch_size_bytes = GetMaxBatchSizeBytesHint(&req);
+
+  std::lock_guard<std::mutex> lock(scanner->stream_mutex());
+  while (scanner->num_streamed_batches() < window && scanner->iter()->HasNext()) {
+    std::unique_ptr<StreamedScanBatch> batch(new StreamedScanBatch);
+    batch->call_seq_id = scanner->call_seq_id();
+    batch->rows_data.reserve(batch_size_bytes * 11 / 10);
+    ScanResultCopier collector(&batch->data, &batch->rows_data, &batch->indirect_data);
+    batch->status = ScanNextBatch(scanner.get(), batch_size_bytes, &collector, &batch->error_code);
+    batch->blocks_processed = collector.BlocksProcessed();
+    batch->last_primary_key.append(collector.last_primary_key().data(),
+                                   collector.last_primary_key().size());
+    batch->has_more_results = batch->status.ok() && scanner->iter()->HasNext();
+    // The scanner is unregistered by the request that receives the last batch.
+    const bool done = !batch->has_more_results;
+    scanner->AddStreamedBatch(std::move(batch));
+    if (done) {
+      break;
+    }
+  }
+}
+
 Status TabletServiceImpl::HandleScanAtSnapshot(
     const NewScanRequestPB& scan_pb,
     const RpcContext* rpc_context,
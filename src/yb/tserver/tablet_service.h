@@ -59,6 +59,7 @@ class MvccSnapshot;
 namespace tserver {
 
 class ScanResultCollector;
+class Scanner;
 class TabletPeerLookupIf;
 class TabletServer;
 
@@ -99,6 +100,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                   ImportDataResponsePB* resp,
                   rpc::RpcContext context) override;
 
+  void IngestFiles(const IngestFilesRequestPB* req,
+                   IngestFilesResponsePB* resp,
+                   rpc::RpcContext context) override;
+
   void UpdateTransaction(const UpdateTransactionRequestPB* req,
                          UpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
@@ -113,6 +118,8 @@ class TabletServiceImpl : public TabletServerServiceIf {
 
   void Shutdown() override;
 
+  rpc::RpcCallClass CallClass(const rpc::InboundCall& call) const override;
+
  private:
   CHECKED_STATUS HandleNewScanRequest(tablet::TabletPeer* tablet_peer,
                               const ScanRequestPB* req,
@@ -128,6 +135,16 @@ class TabletServiceImpl : public TabletServerServiceIf {
                                    bool* has_more_results,
                                    TabletServerErrorPB::Code* error_code);
 
+  // Scans the next batch of the scanner, of about batch_size_bytes, into result_collector.
+  CHECKED_STATUS ScanNextBatch(Scanner* scanner,
+                               size_t batch_size_bytes,
+                               ScanResultCollector* result_collector,
+                               TabletServerErrorPB::Code* error_code);
+
+  // Scans batches of a streamed scan ahead of the requests for them, up to the window of the
+  // request, see ScanRequestPB::stream_window_batches.
+  void StreamScanBatches(const ScanRequestPB& req, const std::string& scanner_id);
+
   CHECKED_STATUS HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
                               const rpc::RpcContext* rpc_context,
                               const Schema& projection,
@@ -157,6 +174,15 @@ class TabletServiceImpl : public TabletServerServiceIf {
                                   rpc::RpcContext* context,
                                   std::shared_ptr<tablet::AbstractTablet>* tablet);
 
+  // For reads with bounded staleness served by a follower, returns the maximal hybrid time the read
+  // could be performed at, i.e. the safe time propagated by the leader. Responds with
+  // STALE_FOLLOWER and returns false if this replica lags behind more than allowed.
+  // read_limit is set to HybridTime::kInvalid if the read time should not be limited.
+  bool GetReadLimitOrRespond(const ReadRequestPB* req,
+                             ReadResponsePB* resp,
+                             rpc::RpcContext* context,
+                             HybridTime* read_limit);
+
   template<class Req, class Resp>
   bool PrepareModify(const Req& req,
                      Resp* resp,
@@ -193,10 +219,18 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
 
   virtual ~ConsensusServiceImpl();
 
+  rpc::RpcCallClass CallClass(const rpc::InboundCall& call) const override {
+    return rpc::RpcCallClass::kConsensus;
+  }
+
   virtual void UpdateConsensus(const consensus::ConsensusRequestPB *req,
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  void MultiRaftUpdateConsensus(const consensus::MultiRaftConsensusRequestPB* req,
+                                consensus::MultiRaftConsensusResponsePB* resp,
+                                rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -33,9 +33,13 @@
 #include "yb/tserver/ts_tablet_manager.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/optional/optional.hpp>
@@ -48,6 +52,7 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_sync_coordinator.h"
 #include "yb/consensus/metadata.pb.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
@@ -56,11 +61,14 @@
 
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/strings/util.h"
+#include "yb/gutil/sysinfo.h"
 
 #include "yb/master/master.pb.h"
 #include "yb/master/sys_catalog.h"
 
 #include "yb/rocksdb/memory_monitor.h"
+#include "yb/rocksdb/port/port.h"
+#include "yb/rocksdb/rate_limiter.h"
 
 #include "yb/rpc/messenger.h"
 
@@ -69,6 +77,7 @@
 #include "yb/tablet/tablet.pb.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_metadata.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/tablet_options.h"
 
@@ -85,6 +94,7 @@
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
 #include "yb/util/pb_util.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 #include "yb/util/tsan_util.h"
@@ -94,11 +104,17 @@ using namespace std::literals;
 DEFINE_int32(num_tablets_to_open_simultaneously, 0,
              "Number of threads available to open tablets during startup. If this "
              "is set to 0 (the default), then the number of bootstrap threads will "
-             "be set based on the number of data directories. If the data directories "
-             "are on some very fast storage device such as SSD or a RAID array, it "
-             "may make sense to manually tune this.");
+             "be set to the larger of the number of data directories and the number of CPUs. "
+             "If the data directories are on slow storage devices, it may make sense to "
+             "manually tune this.");
 TAG_FLAG(num_tablets_to_open_simultaneously, advanced);
 
+DEFINE_bool(bootstrap_former_leaders_first, true,
+            "Whether tablets, whose replica on this server was likely the leader before the "
+            "restart, are opened before other tablets during startup. Such replicas voted for "
+            "themselves in their latest term.");
+TAG_FLAG(bootstrap_former_leaders_first, advanced);
+
 DEFINE_int32(tablet_start_warn_threshold_ms, 500,
              "If a tablet takes more than this number of millis to start, issue "
              "a warning with a trace.");
@@ -128,6 +144,8 @@ namespace {
 
 constexpr int kDbCacheSizeUsePercentage = -1;
 constexpr int kDbCacheSizeCacheDisabled = -2;
+constexpr int64_t kUnlimitedOpenFiles = 1000000;
+constexpr int kSharedTableCacheNumShardBits = 6;
 
 } // namespace
 
@@ -144,6 +162,12 @@ DEFINE_int64(global_memstore_size_mb_max, 2048,
              "Global memstore size is determined as a percentage of the available "
              "memory. However, this flag limits it in absolute size. Value of 0 "
              "means no limit on the value obtained by the percentage. Default is 2048.");
+DEFINE_bool(global_memstore_flush_largest_first, false,
+            "When the global memstore size is exceeded, flush the tablet with the largest "
+            "memstore first instead of the tablet with the oldest write in its memstore. The "
+            "latter frees the most log segments, the former the most memory per flush.");
+TAG_FLAG(global_memstore_flush_largest_first, runtime);
+TAG_FLAG(global_memstore_flush_largest_first, advanced);
 
 DEFINE_int64(db_block_cache_size_bytes, kDbCacheSizeUsePercentage,
              "Size of cross-tablet shared RocksDB block cache (in bytes). "
@@ -155,9 +179,63 @@ DEFINE_int32(db_block_cache_size_percentage, 50,
              "Default percentage of total available memory to use as block cache size, if not "
              "asking for a raw number, through FLAGS_db_block_cache_size_bytes.");
 
+DEFINE_int32(db_block_cache_pinned_percentage, 0,
+             "Percentage of the block cache that could be taken by blocks pinned there: index and "
+             "filter blocks of all SST files, and data blocks of key ranges pinned as hot. Pinned "
+             "blocks are never evicted. Value of 0 disables pinning.");
+TAG_FLAG(db_block_cache_pinned_percentage, advanced);
+
+DEFINE_int64(db_block_cache_compressed_size_bytes, 0,
+             "Size of cross-tablet shared RocksDB compressed block cache (in bytes). It is the "
+             "second tier of the block cache: blocks read from SST files are also kept there in "
+             "compressed form, so blocks evicted from the block cache could be served without "
+             "disk reads. Value of 0 disables compressed block cache.");
+
 DEFINE_test_flag(int32, sleep_after_tombstoning_tablet_secs, 0,
                  "Whether we sleep in LogAndTombstone after calling DeleteTabletData.");
 
+DEFINE_bool(use_priority_thread_pool_for_compactions, true,
+            "Whether compactions of all tablets of the tablet server should be scheduled in a "
+            "single priority thread pool, which runs compactions of tablets closest to a write "
+            "stall first.");
+TAG_FLAG(use_priority_thread_pool_for_compactions, advanced);
+
+DEFINE_int32(priority_thread_pool_size, -1,
+             "Max running tasks in the tablet server priority thread pool for compactions. "
+             "Value of -1 means rocksdb_max_background_compactions.");
+TAG_FLAG(priority_thread_pool_size, advanced);
+
+DEFINE_int32(multi_get_thread_pool_size, 8,
+             "Max threads in the tablet server pool that reads SST blocks of batched reads in "
+             "parallel. Value of 0 disables the pool, so batched reads look up keys one by one.");
+TAG_FLAG(multi_get_thread_pool_size, advanced);
+
+DEFINE_bool(enable_log_sync_coordinator, false,
+            "Whether fsyncs of WALs of all tablets of the tablet server should be batched, so "
+            "tablets sharing a WAL device issue fewer device flushes.");
+TAG_FLAG(enable_log_sync_coordinator, advanced);
+
+DEFINE_bool(rocksdb_compact_flush_rate_limit_sharing_across_tablets, true,
+            "Whether rocksdb_compact_flush_rate_limit_bytes_per_sec limits flushes and "
+            "compactions of all tablets of the tablet server together, instead of each tablet "
+            "separately.");
+TAG_FLAG(rocksdb_compact_flush_rate_limit_sharing_across_tablets, advanced);
+
+DEFINE_int64(rocksdb_shared_table_cache_max_open_files, -1,
+             "Number of SST files kept open by the table cache shared by all tablets of the tablet "
+             "server, whose least recently used table readers are closed first. -1 means half of "
+             "the open files limit of the process, 0 means each tablet has its own table cache.");
+TAG_FLAG(rocksdb_shared_table_cache_max_open_files, advanced);
+
+DEFINE_int64(tablet_placement_min_free_space_mb, 1024,
+             "New tablets are placed in a data or WAL directory with less free space only when "
+             "all of the directories have less free space.");
+TAG_FLAG(tablet_placement_min_free_space_mb, advanced);
+TAG_FLAG(tablet_placement_min_free_space_mb, runtime);
+
+DECLARE_int32(rocksdb_max_background_compactions);
+DECLARE_int64(rocksdb_compact_flush_rate_limit_bytes_per_sec);
+
 constexpr int kTServerYbClientDefaultTimeoutMs = yb::RegularBuildVsSanitizers(5, 60) * 1000;
 
 DEFINE_int32(tserver_yb_client_default_timeout_ms, kTServerYbClientDefaultTimeoutMs,
@@ -188,6 +266,7 @@ METRIC_DEFINE_histogram(server, op_apply_run_time, "Operation Apply Run Time",
                         "that operations consist of very large batches.",
                         10000000, 2);
 
+using google::protobuf::RepeatedPtrField;
 using consensus::ConsensusMetadata;
 using consensus::ConsensusStatePB;
 using consensus::OpId;
@@ -196,6 +275,7 @@ using consensus::RaftPeerPB;
 using consensus::StartRemoteBootstrapRequestPB;
 using log::Log;
 using master::ReportedTabletPB;
+using master::TabletLoadPB;
 using master::TabletReportPB;
 using std::shared_ptr;
 using std::string;
@@ -215,6 +295,50 @@ using tablet::TabletStatusListener;
 using tablet::TabletStatusPB;
 using tserver::RemoteBootstrapClient;
 
+namespace {
+
+typedef std::unordered_map<std::string, std::unordered_set<std::string>> DirTabletsMap;
+
+// Selects the directory for a new tablet of the table and registers the tablet there. Directories
+// with enough free space come first. Among them, the one with the fewest tablets of the table is
+// picked, then the one with the fewest tablets in total, which share its I/O, and then the one with
+// the most free space.
+string SelectDirAndRegisterTablet(Env* env,
+                                  const vector<string>& root_dirs,
+                                  const string& table_id,
+                                  const string& tablet_id,
+                                  std::unordered_map<string, DirTabletsMap>* assignment_map) {
+  auto& table_assignment = (*assignment_map)[table_id];
+  const int64_t min_free_space = FLAGS_tablet_placement_min_free_space_mb * 1024 * 1024;
+  string best_dir;
+  std::tuple<bool, size_t, size_t, int64_t> best_key;
+  for (const auto& dir : root_dirs) {
+    const size_t table_tablets = table_assignment[dir].size();
+    size_t total_tablets = 0;
+    for (const auto& entry : *assignment_map) {
+      auto it = entry.second.find(dir);
+      if (it != entry.second.end()) {
+        total_tablets += it->second.size();
+      }
+    }
+    int64_t free_space = 0;
+    Status s = env->GetFreeSpaceBytes(dir, &free_space);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to get free space of " << dir << ": " << s;
+    }
+    auto key = std::make_tuple(free_space < min_free_space, table_tablets, total_tablets,
+                               -free_space);
+    if (best_dir.empty() || key < best_key) {
+      best_dir = dir;
+      best_key = key;
+    }
+  }
+  table_assignment[best_dir].insert(tablet_id);
+  return best_dir;
+}
+
+} // namespace
+
 // Only called from the background task to ensure it's synchronized
 void TSTabletManager::MaybeFlushTablet() {
   int iteration = 0;
@@ -224,27 +348,43 @@ void TSTabletManager::MaybeFlushTablet() {
     // TODO(bojanserafimov): If tablet_to_flush flushes now because of other reasons,
     // we will schedule a second flush, which will unnecessarily stall writes for a short time. This
     // will not happen often, but should be fixed.
-    if (tablet_to_flush) {
-      WARN_NOT_OK(tablet_to_flush->tablet()->Flush(tablet::FlushMode::kAsync),
-          Substitute("Flush failed on $0", tablet_to_flush->tablet_id()));
+    if (!tablet_to_flush) {
+      // All memstores are empty or already flushing, the memory is freed when the flushes
+      // complete.
+      break;
     }
+    WARN_NOT_OK(tablet_to_flush->tablet()->Flush(tablet::FlushMode::kAsync),
+        Substitute("Flush failed on $0", tablet_to_flush->tablet_id()));
   }
 }
 
-// Return the tablet with the oldest write in memstore, or nullptr if all
-// tablet memstores are empty or about to flush.
+// Return the tablet with the oldest write in memstore, or with the largest memstore if
+// global_memstore_flush_largest_first is set. Returns nullptr if all tablet memstores are empty or
+// about to flush.
 scoped_refptr<TabletPeer> TSTabletManager::TabletToFlush() {
+  const bool largest_first = FLAGS_global_memstore_flush_largest_first;
   boost::shared_lock<rw_spinlock> lock(lock_); // For using the tablet map
   HybridTime oldest_write_in_memstores = HybridTime::kMax;
+  size_t largest_memstore_size = 0;
   scoped_refptr<TabletPeer> tablet_to_flush;
   for (const TabletMap::value_type& entry : tablet_map_) {
     const auto tablet = entry.second->shared_tablet();
-    if (tablet) {
-      const HybridTime oldest_write_in_memstore = tablet->flush_stats()->oldest_write_in_memstore();
-      if (oldest_write_in_memstore < oldest_write_in_memstores) {
-        oldest_write_in_memstores = oldest_write_in_memstore;
+    if (!tablet) {
+      continue;
+    }
+    const HybridTime oldest_write_in_memstore = tablet->flush_stats()->oldest_write_in_memstore();
+    if (oldest_write_in_memstore == HybridTime::kMax) {
+      continue;
+    }
+    if (largest_first) {
+      const size_t memstore_size = tablet->ActiveMemTableSize();
+      if (!tablet_to_flush || memstore_size > largest_memstore_size) {
+        largest_memstore_size = memstore_size;
         tablet_to_flush = entry.second;
       }
+    } else if (oldest_write_in_memstore < oldest_write_in_memstores) {
+      oldest_write_in_memstores = oldest_write_in_memstore;
+      tablet_to_flush = entry.second;
     }
   }
   return tablet_to_flush;
@@ -287,6 +427,53 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
   if (FLAGS_db_block_cache_size_bytes != kDbCacheSizeCacheDisabled) {
     tablet_options_.block_cache = rocksdb::NewLRUCache(block_cache_size_bytes);
     tablet_options_.block_cache->SetMetrics(server_->metric_entity());
+    if (FLAGS_db_block_cache_pinned_percentage > 0) {
+      CHECK_LE(FLAGS_db_block_cache_pinned_percentage, 100);
+      tablet_options_.pinned_blocks_mem_tracker = MemTracker::CreateTracker(
+          block_cache_size_bytes * FLAGS_db_block_cache_pinned_percentage / 100,
+          "PinnedBlocks", server_->mem_tracker());
+    }
+  }
+  if (FLAGS_db_block_cache_compressed_size_bytes > 0) {
+    // Hits and misses of this tier are reported by per-tablet RocksDB statistics
+    // (rocksdb_block_cachecompressed_hit/miss), block cache metrics only cover the first tier.
+    tablet_options_.block_cache_compressed =
+        rocksdb::NewLRUCache(FLAGS_db_block_cache_compressed_size_bytes);
+  }
+
+  if (FLAGS_use_priority_thread_pool_for_compactions) {
+    int pool_size = FLAGS_priority_thread_pool_size >= 0
+        ? FLAGS_priority_thread_pool_size : FLAGS_rocksdb_max_background_compactions;
+    tablet_options_.priority_thread_pool_for_compactions_and_flushes =
+        std::make_shared<PriorityThreadPool>(pool_size);
+  }
+  if (FLAGS_multi_get_thread_pool_size > 0) {
+    std::unique_ptr<ThreadPool> multi_get_pool;
+    CHECK_OK(ThreadPoolBuilder("multi-get")
+                 .set_max_threads(FLAGS_multi_get_thread_pool_size)
+                 .Build(&multi_get_pool));
+    tablet_options_.multi_get_thread_pool = std::move(multi_get_pool);
+  }
+  if (FLAGS_enable_log_sync_coordinator) {
+    tablet_options_.log_sync_coordinator =
+        std::make_shared<log::LogSyncCoordinator>(server_->metric_entity());
+  }
+  if (FLAGS_rocksdb_compact_flush_rate_limit_sharing_across_tablets &&
+      FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
+    tablet_options_.rate_limiter.reset(
+        rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
+  }
+
+  if (FLAGS_rocksdb_shared_table_cache_max_open_files != 0) {
+    int64_t max_open_files = FLAGS_rocksdb_shared_table_cache_max_open_files;
+    if (max_open_files < 0) {
+      const int process_max_open_files = rocksdb::port::GetMaxOpenFiles();
+      max_open_files = (process_max_open_files < 0 ? kUnlimitedOpenFiles
+                                                   : process_max_open_files) / 2;
+    }
+    tablet_options_.table_cache =
+        rocksdb::NewSharedTableCache(max_open_files, kSharedTableCacheNumShardBits);
+    tablet_options_.table_cache->SetMetrics(server_->metric_entity());
   }
 
   // Calculate memstore_size_bytes
@@ -310,10 +497,13 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
       "tablet manager",
       "flush scheduler bgtask",
       std::chrono::milliseconds(FLAGS_flush_background_task_interval_msec)));
+    // Memstores of all tablets are accounted for under the server memory tracker, so they count
+    // towards the memory limit of the server.
     tablet_options_.memory_monitor = std::make_shared<rocksdb::MemoryMonitor>(
         memstore_size_bytes,
         std::function<void()>([this](){
-                                YB_WARN_NOT_OK(background_task_->Wake(), "Wakeup error"); }));
+                                YB_WARN_NOT_OK(background_task_->Wake(), "Wakeup error"); }),
+        MemTracker::CreateTracker(memstore_size_bytes, "MemStores", server_->mem_tracker()));
   }
 }
 
@@ -328,8 +518,8 @@ Status TSTabletManager::Init() {
   // FsManager isn't initialized until this point.
   int max_bootstrap_threads = FLAGS_num_tablets_to_open_simultaneously;
   if (max_bootstrap_threads == 0) {
-    // Default to the number of disks.
-    max_bootstrap_threads = fs_manager_->GetDataRootDirs().size();
+    // Default to the number of disks, but don't let fewer disks than CPUs limit the replay.
+    max_bootstrap_threads = std::max<int>(fs_manager_->GetDataRootDirs().size(), base::NumCPUs());
   }
   RETURN_NOT_OK(ThreadPoolBuilder("tablet-bootstrap")
                 .set_max_threads(max_bootstrap_threads)
@@ -365,7 +555,16 @@ Status TSTabletManager::Init() {
     metas.push_back(meta);
   }
 
+  if (FLAGS_bootstrap_former_leaders_first) {
+    // Former leaders are opened first, so the tablets they led become available sooner.
+    std::stable_partition(
+        metas.begin(), metas.end(), [this](const scoped_refptr<TabletMetadata>& meta) {
+      return WasLeader(meta->tablet_id());
+    });
+  }
+
   // Now submit the "Open" task for each.
+  auto num_opened = std::make_shared<std::atomic<size_t>>(0);
   for (const scoped_refptr<TabletMetadata>& meta : metas) {
     scoped_refptr<TransitionInProgressDeleter> deleter;
     {
@@ -374,8 +573,11 @@ Status TSTabletManager::Init() {
     }
 
     scoped_refptr<TabletPeer> tablet_peer = CreateAndRegisterTabletPeer(meta, NEW_PEER);
-    RETURN_NOT_OK(open_tablet_pool_->SubmitFunc(
-        std::bind(&TSTabletManager::OpenTablet, this, meta, deleter)));
+    const size_t num_tablets = metas.size();
+    RETURN_NOT_OK(open_tablet_pool_->SubmitFunc([this, meta, deleter, num_opened, num_tablets] {
+      OpenTablet(meta, deleter);
+      LOG(INFO) << "Opened " << ++*num_opened << " of " << num_tablets << " tablets";
+    }));
   }
 
   {
@@ -677,6 +879,8 @@ scoped_refptr<TabletPeer> TSTabletManager::CreateAndRegisterTabletPeer(
                           Bind(&TSTabletManager::ApplyChange,
                                Unretained(this),
                                meta->tablet_id())));
+  // The tablet server notifies replicas about dead servers, see TabletServer::PopulateLiveTServers.
+  tablet_peer->set_allow_raft_quiescence(true);
   RegisterTablet(meta->tablet_id(), tablet_peer, mode);
   return tablet_peer;
 }
@@ -772,7 +976,10 @@ Status TSTabletManager::DeleteTablet(
   if (delete_type == TABLET_DATA_DELETED) {
     std::lock_guard<rw_spinlock> lock(lock_);
     RETURN_NOT_OK(CheckRunningUnlocked(error_code));
-    CHECK_EQ(1, tablet_map_.erase(tablet_id)) << tablet_id;
+    {
+      std::lock_guard<percpu_rwlock> map_lock(tablet_map_lock_);
+      CHECK_EQ(1, tablet_map_.erase(tablet_id)) << tablet_id;
+    }
     UnregisterDataWalDir(meta->table_id(),
                          tablet_id,
                          meta->table_type(),
@@ -825,6 +1032,16 @@ Status TSTabletManager::OpenTabletMeta(const string& tablet_id,
   return Status::OK();
 }
 
+bool TSTabletManager::WasLeader(const string& tablet_id) const {
+  gscoped_ptr<ConsensusMetadata> cmeta;
+  Status s = ConsensusMetadata::Load(fs_manager_, tablet_id, fs_manager_->uuid(), &cmeta);
+  if (!s.ok()) {
+    // The error will be reported when the tablet is opened.
+    return false;
+  }
+  return cmeta->has_voted_for() && cmeta->voted_for() == fs_manager_->uuid();
+}
+
 void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                  const scoped_refptr<TransitionInProgressDeleter>& deleter) {
   string tablet_id = meta->tablet_id();
@@ -952,13 +1169,24 @@ void TSTabletManager::Shutdown() {
   // Shut down the apply pool.
   apply_pool_->Shutdown();
 
+  // All RocksDB instances are closed at this point, so they have no queued tasks.
+  if (tablet_options_.priority_thread_pool_for_compactions_and_flushes) {
+    tablet_options_.priority_thread_pool_for_compactions_and_flushes->Shutdown();
+  }
+  if (tablet_options_.multi_get_thread_pool) {
+    tablet_options_.multi_get_thread_pool->Shutdown();
+  }
+
   {
     std::lock_guard<rw_spinlock> l(lock_);
     // We don't expect anyone else to be modifying the map after we start the
     // shut down process.
     CHECK_EQ(tablet_map_.size(), peers_to_shutdown.size())
       << "Map contents changed during shutdown!";
-    tablet_map_.clear();
+    {
+      std::lock_guard<percpu_rwlock> map_lock(tablet_map_lock_);
+      tablet_map_.clear();
+    }
     table_data_assignment_map_.clear();
     table_wal_assignment_map_.clear();
 
@@ -970,6 +1198,7 @@ void TSTabletManager::RegisterTablet(const std::string& tablet_id,
                                      const scoped_refptr<TabletPeer>& tablet_peer,
                                      RegisterTabletPeerMode mode) {
   std::lock_guard<rw_spinlock> lock(lock_);
+  std::lock_guard<percpu_rwlock> map_lock(tablet_map_lock_);
   // If we are replacing a tablet peer, we delete the existing one first.
   if (mode == REPLACEMENT_PEER && tablet_map_.erase(tablet_id) != 1) {
     LOG(FATAL) << "Unable to remove previous tablet peer " << tablet_id << ": not registered!";
@@ -984,7 +1213,7 @@ void TSTabletManager::RegisterTablet(const std::string& tablet_id,
 
 bool TSTabletManager::LookupTablet(const string& tablet_id,
                                    scoped_refptr<TabletPeer>* tablet_peer) const {
-  boost::shared_lock<rw_spinlock> shared_lock(lock_);
+  boost::shared_lock<rw_spinlock> shared_lock(tablet_map_lock_.get_lock());
   return LookupTabletUnlocked(tablet_id, tablet_peer);
 }
 
@@ -1129,6 +1358,34 @@ void TSTabletManager::GenerateFullTabletReport(TabletReportPB* report) {
   dirty_tablets_.clear();
 }
 
+void TSTabletManager::GenerateTabletLoads(RepeatedPtrField<TabletLoadPB>* loads) const {
+  vector<scoped_refptr<TabletPeer>> peers;
+  GetTabletPeers(&peers);
+  for (const auto& peer : peers) {
+    if (peer->state() != tablet::RUNNING) {
+      continue;
+    }
+    auto tablet = peer->shared_tablet();
+    if (!tablet) {
+      continue;
+    }
+    auto* load = loads->Add();
+    load->set_tablet_id(peer->tablet_id());
+    const auto* metrics = tablet->metrics();
+    if (metrics != nullptr) {
+      load->set_read_ops(metrics->ql_read_latency->TotalCount() +
+                         metrics->redis_read_latency->TotalCount());
+      load->set_write_ops(
+          metrics->write_op_duration_client_propagated_consistency->TotalCount() +
+          metrics->write_op_duration_commit_wait_consistency->TotalCount());
+    }
+    uint64_t sst_files_size = 0;
+    if (tablet->GetTotalSstFilesSize(&sst_files_size).ok()) {
+      load->set_sst_files_size(sst_files_size);
+    }
+  }
+}
+
 void TSTabletManager::MarkTabletReportAcknowledged(const TabletReportPB& report) {
   std::lock_guard<rw_spinlock> l(lock_);
 
@@ -1203,55 +1460,15 @@ void TSTabletManager::GetAndRegisterDataAndWalDir(FsManager* fs_manager,
   }
   MutexLock l(dir_assignment_lock_);
   LOG(INFO) << "Get and update data/wal directory assignment map for table: " << table_id;
-  // Initialize the map if the directory mapping does not exist.
   auto data_root_dirs = fs_manager->GetDataRootDirs();
   CHECK(!data_root_dirs.empty()) << "No data root directories found";
-  auto table_data_assignment_iter = table_data_assignment_map_.find(table_id);
-  if (table_data_assignment_iter == table_data_assignment_map_.end()) {
-    for (string data_root_iter : data_root_dirs) {
-      unordered_set<string> tablet_id_set;
-      table_data_assignment_map_[table_id][data_root_iter] = tablet_id_set;
-    }
-  }
-  // Find the data directory with the least count of tablets for this table.
-  table_data_assignment_iter = table_data_assignment_map_.find(table_id);
-  auto data_assignment_value_map = table_data_assignment_iter->second;
-  string min_dir;
-  uint64_t min_dir_count = kuint64max;
-  for (auto it = data_assignment_value_map.begin(); it != data_assignment_value_map.end(); ++it) {
-    if (min_dir_count > it->second.size()) {
-      min_dir = it->first;
-      min_dir_count = it->second.size();
-    }
-  }
-  *data_root_dir = min_dir;
-  // Increment the count for min_dir.
-  auto data_assignment_value_iter = table_data_assignment_map_[table_id].find(min_dir);
-  data_assignment_value_iter->second.insert(tablet_id);
+  *data_root_dir = SelectDirAndRegisterTablet(
+      fs_manager->env(), data_root_dirs, table_id, tablet_id, &table_data_assignment_map_);
 
-  // Find the wal directory with the least count of tablets for this table.
-  min_dir = "";
-  min_dir_count = kuint64max;
   auto wal_root_dirs = fs_manager->GetWalRootDirs();
   CHECK(!wal_root_dirs.empty()) << "No wal root directories found";
-  auto table_wal_assignment_iter = table_wal_assignment_map_.find(table_id);
-  if (table_wal_assignment_iter == table_wal_assignment_map_.end()) {
-    for (string wal_root_iter : wal_root_dirs) {
-      unordered_set<string> tablet_id_set;
-      table_wal_assignment_map_[table_id][wal_root_iter] = tablet_id_set;
-    }
-  }
-  table_wal_assignment_iter = table_wal_assignment_map_.find(table_id);
-  auto wal_assignment_value_map = table_wal_assignment_iter->second;
-  for (auto it = wal_assignment_value_map.begin(); it != wal_assignment_value_map.end(); ++it) {
-    if (min_dir_count > it->second.size()) {
-      min_dir = it->first;
-      min_dir_count = it->second.size();
-    }
-  }
-  *wal_root_dir = min_dir;
-  auto wal_assignment_value_iter = table_wal_assignment_map_[table_id].find(min_dir);
-  wal_assignment_value_iter->second.insert(tablet_id);
+  *wal_root_dir = SelectDirAndRegisterTablet(
+      fs_manager->env(), wal_root_dirs, table_id, tablet_id, &table_wal_assignment_map_);
 }
 
 void TSTabletManager::RegisterDataAndWalDir(FsManager* fs_manager,
@@ -74,6 +74,7 @@ class RaftConfigPB;
 
 namespace master {
 class ReportedTabletPB;
+class TabletLoadPB;
 class TabletReportPB;
 } // namespace master
 
@@ -184,7 +185,7 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   bool LookupTablet(const std::string& tablet_id,
                     scoped_refptr<tablet::TabletPeer>* tablet_peer) const;
 
-  // Same as LookupTablet but doesn't acquired the shared lock.
+  // Same as LookupTablet but doesn't acquire a lock, lock_ must be held.
   bool LookupTabletUnlocked(const std::string& tablet_id,
                             scoped_refptr<tablet::TabletPeer>* tablet_peer) const;
 
@@ -221,6 +222,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // tablets which have not changed since the acknowledged report.
   void MarkTabletReportAcknowledged(const master::TabletReportPB& report);
 
+  // Fill the current load of every running tablet, to be reported to the master.
+  void GenerateTabletLoads(google::protobuf::RepeatedPtrField<master::TabletLoadPB>* loads) const;
+
   // Get all of the tablets currently hosted on this server.
   void GetTabletPeers(std::vector<scoped_refptr<tablet::TabletPeer> >* tablet_peers) const;
 
@@ -313,6 +317,10 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS OpenTabletMeta(const std::string& tablet_id,
                         scoped_refptr<tablet::TabletMetadata>* metadata);
 
+  // Returns whether the replica of the tablet on this server was likely the leader, i.e. it
+  // voted for itself in its latest term, according to the consensus metadata on disk.
+  bool WasLeader(const std::string& tablet_id) const;
+
   // Open a tablet whose metadata has already been loaded/created.
   // This method does not return anything as it can be run asynchronously.
   // Upon completion of this method the tablet should be initialized and running.
@@ -366,7 +374,7 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // TABLET_DATA_READY state. Generally, we tombstone the replica.
   CHECKED_STATUS HandleNonReadyTabletOnStartup(const scoped_refptr<tablet::TabletMetadata>& meta);
 
-  // Return the tablet with oldest write still in its memstore
+  // Return the tablet to flush to free memstore memory.
   scoped_refptr<tablet::TabletPeer> TabletToFlush();
 
   TSTabletManagerStatePB state() const {
@@ -397,6 +405,10 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // transition_in_progress_.
   mutable rw_spinlock lock_;
 
+  // Also held exclusively, after lock_, to modify tablet_map_. LookupTablet, called by every RPC
+  // to a tablet, takes only the lock of its CPU, so lookups don't contend on the same cache line.
+  mutable percpu_rwlock tablet_map_lock_;
+
   // Map from tablet ID to tablet
   TabletMap tablet_map_;
 
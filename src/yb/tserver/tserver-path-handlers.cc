@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -41,6 +42,7 @@
 
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/quorum_util.h"
+#include "yb/docdb/doc_key.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/gutil/strings/join.h"
@@ -48,6 +50,7 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/server/webui_util.h"
 #include "yb/tablet/maintenance_manager.h"
+#include "yb/tablet/rocksdb_job_timeline.h"
 #include "yb/tablet/tablet.pb.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_peer.h"
@@ -87,14 +90,14 @@ Status TabletServerPathHandlers::Register(Webserver* server) {
       true /* styled */, false /* is_on_nav_bar */);
   server->RegisterPathHandler(
       "/tablets", "Tablets", std::bind(&TabletServerPathHandlers::HandleTabletsPage, this, _1, _2),
-      true /* styled */, true /* is_on_nav_bar */);
+      true /* styled */, true /* is_on_nav_bar */, true /* is_expensive */);
   server->RegisterPathHandler(
       "/tablet", "", std::bind(&TabletServerPathHandlers::HandleTabletPage, this, _1, _2),
       true /* styled */, false /* is_on_nav_bar */);
   server->RegisterPathHandler(
       "/transactions", "",
       std::bind(&TabletServerPathHandlers::HandleTransactionsPage, this, _1, _2), true /* styled */,
-      false /* is_on_nav_bar */);
+      false /* is_on_nav_bar */, true /* is_expensive */);
   server->RegisterPathHandler(
       "/tablet-rowsetlayout-svg", "",
       std::bind(&TabletServerPathHandlers::HandleTabletSVGPage, this, _1, _2), true /* styled */,
@@ -103,6 +106,14 @@ Status TabletServerPathHandlers::Register(Webserver* server) {
       "/tablet-consensus-status", "",
       std::bind(&TabletServerPathHandlers::HandleConsensusStatusPage, this, _1, _2),
       true /* styled */, false /* is_on_nav_bar */);
+  server->RegisterPathHandler(
+      "/tablet-hot-keys", "",
+      std::bind(&TabletServerPathHandlers::HandleHotKeysPage, this, _1, _2), true /* styled */,
+      false /* is_on_nav_bar */);
+  server->RegisterPathHandler(
+      "/tablet-rocksdb-jobs", "",
+      std::bind(&TabletServerPathHandlers::HandleRocksDBJobsPage, this, _1, _2),
+      true /* styled */, false /* is_on_nav_bar */);
   server->RegisterPathHandler(
       "/log-anchors", "", std::bind(&TabletServerPathHandlers::HandleLogAnchorsPage, this, _1, _2),
       true /* styled */, false /* is_on_nav_bar */);
@@ -354,6 +365,20 @@ void TabletServerPathHandlers::HandleTabletPage(const Webserver::WebRequest& req
                                   "Consensus Status")
           << "</li>" << endl;
 
+  // Hot keys page.
+  *output << "<li>" << Substitute("<a href=\"/tablet-hot-keys?id=$0\">$1</a>",
+                                  UrlEncodeToString(tablet_id),
+                                  "Hot Keys")
+          << "</li>" << endl;
+
+  if (peer->table_type() != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    // Flushes and compactions page.
+    *output << "<li>" << Substitute("<a href=\"/tablet-rocksdb-jobs?id=$0\">$1</a>",
+                                    UrlEncodeToString(tablet_id),
+                                    "Flushes and Compactions")
+            << "</li>" << endl;
+  }
+
   // Log anchors info page.
   *output << "<li>" << Substitute("<a href=\"/log-anchors?id=$0\">$1</a>",
                                   UrlEncodeToString(tablet_id),
@@ -394,6 +419,65 @@ void TabletServerPathHandlers::HandleLogAnchorsPage(const Webserver::WebRequest&
   *output << "<pre>" << EscapeForHtmlToString(dump) << "</pre>" << std::endl;
 }
 
+namespace {
+
+void HtmlOutputHotKeys(const std::string& title, const SpaceSaving& sketch,
+                       std::stringstream* output) {
+  const uint64_t total = sketch.total();
+  *output << "<h2>" << title << "</h2>\n";
+  *output << "<p>Sampled operations: " << total << "</p>\n";
+  *output << "<table class='table table-striped'>\n";
+  *output << "  <tr><th>Key</th><th>Count</th><th>Error</th><th>Share</th></tr>\n";
+  for (const auto& entry : sketch.TopK(std::numeric_limits<size_t>::max())) {
+    *output << Substitute(
+        "  <tr><td>$0</td><td>$1</td><td>$2</td><td>$3%</td></tr>\n",
+        EscapeForHtmlToString(docdb::BestEffortDocDBKeyToStr(Slice(entry.key))),
+        entry.count, entry.error, total == 0 ? 0 : entry.count * 100 / total);
+  }
+  *output << "</table>\n";
+}
+
+} // anonymous namespace
+
+void TabletServerPathHandlers::HandleHotKeysPage(const Webserver::WebRequest& req,
+                                                 std::stringstream* output) {
+  string id;
+  scoped_refptr<TabletPeer> peer;
+  if (!LoadTablet(tserver_, req, &id, &peer, output)) return;
+  shared_ptr<Tablet> tablet = peer->shared_tablet();
+  if (!tablet) {
+    *output << "Tablet " << EscapeForHtmlToString(id) << " not running";
+    return;
+  }
+
+  *output << "<h1>Hot Keys of Tablet " << TabletLink(id) << "</h1>\n";
+  *output << "<p>Counts are upper bounds, each overestimates the number of sampled operations "
+          << "on its key by at most its error.</p>\n";
+  HtmlOutputHotKeys("Reads", tablet->hot_read_keys(), output);
+  HtmlOutputHotKeys("Writes", tablet->hot_write_keys(), output);
+}
+
+void TabletServerPathHandlers::HandleRocksDBJobsPage(const Webserver::WebRequest& req,
+                                                     std::stringstream* output) {
+  string id;
+  scoped_refptr<TabletPeer> peer;
+  if (!LoadTablet(tserver_, req, &id, &peer, output)) return;
+  shared_ptr<Tablet> tablet = peer->shared_tablet();
+  if (!tablet) {
+    *output << "Tablet " << EscapeForHtmlToString(id) << " not running";
+    return;
+  }
+
+  *output << "<h1>Flushes and Compactions of Tablet " << TabletLink(id) << "</h1>\n";
+  *output << Substitute(
+      "<p>Level 0 files: $0, pending compaction bytes: $1, read amplification: $2, immutable "
+      "memtables: $3.</p>\n",
+      tablet->RocksDBNumLevel0Files(), tablet->RocksDBPendingCompactionBytes(),
+      tablet->RocksDBReadAmplification(), tablet->RocksDBNumImmutableMemTables());
+  *output << "<p>Most recent first. The input of a flush is the memory its memtables used.</p>\n";
+  tablet->rocksdb_job_timeline().HtmlOutput(output);
+}
+
 void TabletServerPathHandlers::HandleConsensusStatusPage(const Webserver::WebRequest& req,
                                                          std::stringstream* output) {
   string id;
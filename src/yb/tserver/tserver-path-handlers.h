@@ -75,6 +75,10 @@ class TabletServerPathHandlers {
                            std::stringstream* output);
   void HandleLogAnchorsPage(const Webserver::WebRequest& req,
                             std::stringstream* output);
+  void HandleHotKeysPage(const Webserver::WebRequest& req,
+                         std::stringstream* output);
+  void HandleRocksDBJobsPage(const Webserver::WebRequest& req,
+                             std::stringstream* output);
   void HandleConsensusStatusPage(const Webserver::WebRequest& req,
                                  std::stringstream* output);
   void HandleDashboardsPage(const Webserver::WebRequest& req,
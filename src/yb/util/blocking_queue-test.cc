@@ -77,6 +77,25 @@ TEST(BlockingQueueTest, TestBlockingDrainTo) {
   ASSERT_EQ(3, out[2]);
 }
 
+TEST(BlockingQueueTest, TestBlockingDrainToWithDeadline) {
+  BlockingQueue<int32_t> test_queue(3);
+  vector<int32_t> out;
+  // Empty queue, so it should return after the deadline without elements.
+  ASSERT_TRUE(test_queue.BlockingDrainTo(
+      &out, MonoTime::FineNow() + MonoDelta::FromMilliseconds(10)));
+  ASSERT_TRUE(out.empty());
+
+  ASSERT_EQ(test_queue.Put(1), QUEUE_SUCCESS);
+  ASSERT_EQ(test_queue.Put(2), QUEUE_SUCCESS);
+  out.push_back(0);
+  ASSERT_TRUE(test_queue.BlockingDrainTo(&out, MonoTime::FineNow()));
+  ASSERT_EQ((vector<int32_t>{0, 1, 2}), out);
+
+  test_queue.Shutdown();
+  ASSERT_FALSE(test_queue.BlockingDrainTo(
+      &out, MonoTime::FineNow() + MonoDelta::FromMilliseconds(10)));
+}
+
 TEST(BlockingQueueTest, TestTooManyInsertions) {
   BlockingQueue<int32_t> test_queue(2);
   ASSERT_EQ(test_queue.Put(123), QUEUE_SUCCESS);
@@ -42,6 +42,7 @@
 #include "yb/gutil/basictypes.h"
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/util/condition_variable.h"
+#include "yb/util/monotime.h"
 #include "yb/util/mutex.h"
 
 namespace yb {
@@ -137,6 +138,30 @@ class BlockingQueue {
     }
   }
 
+  // Like BlockingDrainTo, but waits for elements only until the deadline. Returns true without
+  // adding any elements if the deadline passed, and false if shutdown while the queue is empty.
+  bool BlockingDrainTo(std::vector<T>* out, MonoTime deadline) {
+    MutexLock l(lock_);
+    while (list_.empty()) {
+      if (shutdown_) {
+        return false;
+      }
+      MonoDelta left = deadline.GetDeltaSince(MonoTime::FineNow());
+      if (left.ToNanoseconds() <= 0) {
+        return true;
+      }
+      not_empty_.TimedWait(left);
+    }
+    out->reserve(out->size() + list_.size());
+    for (const T& elt : list_) {
+      out->push_back(elt);
+      decrement_size_unlocked(elt);
+    }
+    list_.clear();
+    not_full_.Signal();
+    return true;
+  }
+
   // Attempts to put the given value in the queue.
   // Returns:
   //   QUEUE_SUCCESS: if successfully inserted
@@ -550,6 +550,24 @@ string StackTrace::Symbolize(const StackTraceLineFormat stack_trace_line_format)
   return buf;
 }
 
+string StackTrace::ToFoldedString() const {
+  string buf;
+  for (int i = num_frames_ - 1; i >= 0; i--) {
+    // See the note in Symbolize() about why we subtract 1 from each address.
+    void* const adjusted_pc = reinterpret_cast<char *>(frames_[i]) - 1;
+    char tmp[1024];
+    if (!buf.empty()) {
+      buf.push_back(';');
+    }
+    if (google::Symbolize(adjusted_pc, tmp, sizeof(tmp))) {
+      buf += tmp;
+    } else {
+      StringAppendF(&buf, "%p", adjusted_pc);
+    }
+  }
+  return buf;
+}
+
 string StackTrace::ToLogFormatHexString() const {
   string buf;
   for (int i = 0; i < num_frames_; i++) {
@@ -167,6 +167,11 @@ class StackTrace {
   // resolved (only the hex addresses are given).
   std::string ToLogFormatHexString() const;
 
+  // Return the function names of the frames, outermost first, separated by ';'. This is the
+  // "folded" format consumed by flame graph tools.
+  // This is not async-safe.
+  std::string ToFoldedString() const;
+
   uint64_t HashCode() const;
 
  private:
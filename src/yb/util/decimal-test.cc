@@ -13,6 +13,9 @@
 
 #include "yb/util/decimal.h"
 
+#include <random>
+
+#include "yb/gutil/strings/substitute.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 
@@ -269,6 +272,55 @@ TEST_F(DecimalTest, TestBigDecimalEncoding) {
   EXPECT_TRUE(is_out_of_range);
 }
 
+TEST_F(DecimalTest, TestDirectConversions) {
+  std::vector<std::string> decimals = test_cases;
+  std::mt19937_64 rng(42);
+  for (int i = 0; i != 10000; ++i) {
+    // Cover both sides of the 38 digits and 16 bytes limits of the fast paths.
+    std::string digits(1 + rng() % 45, '0');
+    for (auto& digit : digits) {
+      digit += rng() % 10;
+    }
+    decimals.push_back(strings::Substitute("$0$1e$2", rng() % 2 ? "-" : "", digits,
+                                           static_cast<int64_t>(rng() % 2000) - 1000));
+  }
+  decimals.push_back("0");
+  decimals.push_back("170141183460469231731687303715884105727");
+  decimals.push_back("-170141183460469231731687303715884105728");
+  decimals.push_back("-9847.236780e+2147483654");
+  decimals.push_back("-1.36e-2147483646");
+
+  for (size_t i = 0; i != decimals.size(); ++i) {
+    SCOPED_TRACE(decimals[i]);
+    const Decimal decimal(decimals[i]);
+    const std::string comparable = decimal.EncodeToComparable();
+    if (i < kComparableEncodingLengths.size()) {
+      ASSERT_EQ(kComparableEncodingLengths[i], comparable.size());
+    }
+    // The size is found without reading past the encoding.
+    auto encoded_size = DecimalComparableEncodedSize(comparable + "\x01");
+    ASSERT_OK(encoded_size);
+    ASSERT_EQ(comparable.size(), *encoded_size);
+
+    bool expected_out_of_range = false;
+    const std::string serialized = decimal.EncodeToSerializedBigDecimal(&expected_out_of_range);
+    bool is_out_of_range = false;
+    ASSERT_EQ(serialized, ComparableDecimalToSerializedBigDecimal(comparable, &is_out_of_range));
+    ASSERT_EQ(expected_out_of_range, is_out_of_range);
+    if (is_out_of_range) {
+      continue;
+    }
+
+    std::string converted;
+    ASSERT_OK(SerializedBigDecimalToComparable(serialized, &converted));
+    ASSERT_EQ(comparable, converted);
+  }
+
+  ASSERT_NOK(DecimalComparableEncodedSize(Slice()));
+  std::string converted;
+  ASSERT_NOK(SerializedBigDecimalToComparable(Slice("\0\0\0", 3), &converted));
+}
+
 TEST_F(DecimalTest, TestFloatDoubleCanonicalization) {
   const float float_nan_0 = CreateFloat(1, 0b11111111, (1 << 22));
   const float float_nan_1 = CreateFloat(0, 0b11111111, 1);
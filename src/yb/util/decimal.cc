@@ -16,6 +16,7 @@
 #include <iomanip>
 #include <glog/logging.h>
 
+#include "yb/gutil/endian.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/util/decimal.h"
 #include "yb/util/stol_utils.h"
@@ -401,6 +402,216 @@ Decimal DecimalFromComparable(const std::string& str) {
   return DecimalFromComparable(Slice(str));
 }
 
+namespace {
+
+typedef unsigned __int128 uint128_t;
+
+// Any number with that many decimal digits fits into 127 bits.
+constexpr size_t kMaxFastPathDigits = 38;
+
+// Returns the bit of the comparable encoding with the given index, most significant bit first.
+inline bool EncodedBit(const Slice& slice, size_t index, bool complement) {
+  return ((slice[index / 8] >> (7 - index % 8)) & 1) != complement;
+}
+
+// Decimal read from its comparable encoding. Its value is
+// (negative ? -1 : 1) * 0.d1...dk * 10^exponent, where unscaled is d1...dk and num_digits is k.
+struct ComparableDecimalParts {
+  bool negative = false;
+  int64_t exponent = 0;
+  uint128_t unscaled = 0;
+  size_t num_digits = 0;
+  size_t encoded_size = 0;
+};
+
+// Reads the comparable encoding the same way Decimal::DecodeFromComparable does, but without
+// copying it. fits is set to false when the exponent or the digits do not fit into parts, in
+// which case only encoded_size is valid.
+Status ParseComparableDecimal(const Slice& slice, ComparableDecimalParts* parts, bool* fits) {
+  if (slice.empty()) {
+    return STATUS(Corruption, "Cannot decode Decimal from empty slice.");
+  }
+  *parts = ComparableDecimalParts();
+  *fits = true;
+  if (slice[0] == 128) {
+    // Zero is encoded as a single byte.
+    parts->encoded_size = 1;
+    return Status::OK();
+  }
+  parts->negative = slice[0] < 128;
+
+  // The exponent is a signed comparable varint with 2 reserved bits, complemented when either
+  // the exponent or the decimal is negative, but not both.
+  const size_t num_bits = slice.size() * 8;
+  const bool exponent_positive = EncodedBit(slice, 2, parts->negative);
+  const bool exponent_complement = parts->negative == exponent_positive;
+  size_t index = 3;
+  for (;;) {
+    if (index >= num_bits) {
+      return STATUS(Corruption, "Encoded varint failed parsing");
+    }
+    if (!EncodedBit(slice, index++, exponent_complement)) {
+      break;
+    }
+  }
+  const size_t num_exponent_bytes = index - 3;
+  if (num_exponent_bytes > slice.size()) {
+    return STATUS(Corruption, "Encoded varint failed parsing");
+  }
+  const size_t exponent_end = num_exponent_bytes * 8;
+  if (exponent_end - index > 62) {
+    *fits = false;
+  } else {
+    uint64_t magnitude = 0;
+    for (; index < exponent_end; ++index) {
+      magnitude = magnitude * 2 + EncodedBit(slice, index, exponent_complement);
+    }
+    parts->exponent = exponent_positive ? magnitude : -static_cast<int64_t>(magnitude);
+  }
+
+  // Digit pairs follow, each of them but the last one with the lowest bit set.
+  size_t pos = num_exponent_bytes;
+  for (;;) {
+    if (pos >= slice.size()) {
+      return STATUS(Corruption, "Decoded the whole slice but didn't find the ending");
+    }
+    const uint8_t byte = parts->negative ? ~slice[pos] : slice[pos];
+    ++pos;
+    const uint8_t pair = byte >> 1;
+    if (*fits) {
+      if (pair > 99 || parts->num_digits + 2 > kMaxFastPathDigits) {
+        *fits = false;
+      } else {
+        parts->unscaled = parts->unscaled * 100 + pair;
+        parts->num_digits += 2;
+      }
+    }
+    if ((byte & 1) == 0) {
+      break;
+    }
+  }
+  if (*fits) {
+    while (parts->num_digits > 0 && parts->unscaled % 10 == 0) {
+      parts->unscaled /= 10;
+      --parts->num_digits;
+    }
+  }
+  parts->encoded_size = pos;
+  return Status::OK();
+}
+
+// Appends the exponent in the format of VarInt::EncodeToComparable with 2 reserved bits, with the
+// reserved bits set as Decimal::EncodeToComparable leaves them.
+void AppendComparableExponent(int64_t exponent, std::string* out) {
+  const bool negative = exponent < 0;
+  const uint64_t magnitude = negative ? -static_cast<uint64_t>(exponent) : exponent;
+  const size_t num_bits = magnitude == 0 ? 1 : 64 - __builtin_clzll(magnitude);
+  const size_t num_bytes = (num_bits + 3 + 6) / 7;
+  DCHECK_LT(num_bytes, 8);
+  // Bits from the highest: 2 reserved, sign, num_bytes - 1 ones, zero, padding and magnitude.
+  const size_t magnitude_bits = num_bytes * 7 - 3;
+  uint64_t encoded = magnitude;
+  encoded |= ((1ULL << (num_bytes - 1)) - 1) << (magnitude_bits + 1);
+  encoded |= 1ULL << (num_bytes * 8 - 3);
+  if (negative) {
+    encoded = ~encoded & ((1ULL << (num_bytes * 8)) - 1);
+  }
+  encoded |= 3ULL << (num_bytes * 8 - 2);
+  for (size_t i = num_bytes; i-- > 0;) {
+    out->push_back(static_cast<char>(encoded >> (i * 8)));
+  }
+}
+
+} // namespace
+
+Result<size_t> DecimalComparableEncodedSize(const Slice& slice) {
+  ComparableDecimalParts parts;
+  bool fits = false;
+  RETURN_NOT_OK(ParseComparableDecimal(slice, &parts, &fits));
+  return parts.encoded_size;
+}
+
+std::string ComparableDecimalToSerializedBigDecimal(const Slice& comparable,
+                                                    bool* is_out_of_range) {
+  ComparableDecimalParts parts;
+  bool fits = false;
+  if (!ParseComparableDecimal(comparable, &parts, &fits).ok() || !fits) {
+    return DecimalFromComparable(comparable).EncodeToSerializedBigDecimal(is_out_of_range);
+  }
+  // BigDecimal's scale is the number of digits after the decimal point.
+  const int64_t scale = static_cast<int64_t>(parts.num_digits) - parts.exponent;
+  if (scale < std::numeric_limits<int32_t>::min() ||
+      scale > std::numeric_limits<int32_t>::max()) {
+    return DecimalFromComparable(comparable).EncodeToSerializedBigDecimal(is_out_of_range);
+  }
+  *is_out_of_range = false;
+
+  // The mantissa uses the minimal number of bytes of the magnitude, plus one when the highest bit
+  // is needed for the sign, as VarInt::EncodeToTwosComplement does.
+  size_t num_bytes = 1;
+  while (num_bytes < 16 && (parts.unscaled >> (num_bytes * 8)) != 0) {
+    ++num_bytes;
+  }
+  if ((parts.unscaled >> (num_bytes * 8 - 1)) != 0) {
+    ++num_bytes;
+  }
+  const uint128_t bits = parts.negative ? -parts.unscaled : parts.unscaled;
+  const char sign_byte = parts.negative ? '\xff' : '\0';
+
+  std::string result(4 + num_bytes, sign_byte);
+  BigEndian::Store32(&result[0], static_cast<uint32_t>(static_cast<int32_t>(scale)));
+  for (size_t i = 0; i != std::min<size_t>(num_bytes, 16); ++i) {
+    result[result.size() - 1 - i] = static_cast<char>(bits >> (i * 8));
+  }
+  return result;
+}
+
+Status SerializedBigDecimalToComparable(const Slice& serialized, std::string* comparable) {
+  if (serialized.size() < 5 || serialized.size() > 4 + 16) {
+    Decimal decimal;
+    RETURN_NOT_OK(decimal.DecodeFromSerializedBigDecimal(serialized));
+    *comparable = decimal.EncodeToComparable();
+    return Status::OK();
+  }
+  const int32_t scale = static_cast<int32_t>(BigEndian::Load32(serialized.data()));
+  const bool negative = (serialized[4] & 0x80) != 0;
+  uint128_t bits = negative ? ~static_cast<uint128_t>(0) : 0;
+  for (size_t i = 4; i != serialized.size(); ++i) {
+    bits = (bits << 8) | serialized[i];
+  }
+  uint128_t magnitude = negative ? -bits : bits;
+
+  comparable->clear();
+  if (magnitude == 0) {
+    comparable->push_back(static_cast<char>(128));
+    return Status::OK();
+  }
+
+  // Digits of the magnitude, the most significant first.
+  uint8_t digits[kMaxFastPathDigits + 2];
+  size_t num_digits = 0;
+  for (; magnitude != 0; magnitude /= 10) {
+    digits[num_digits++] = static_cast<uint8_t>(magnitude % 10);
+  }
+  std::reverse(digits, digits + num_digits);
+  const int64_t exponent = static_cast<int64_t>(num_digits) - scale;
+  while (digits[num_digits - 1] == 0) {
+    --num_digits;
+  }
+
+  AppendComparableExponent(exponent, comparable);
+  for (size_t i = 0; i < num_digits; i += 2) {
+    const uint8_t pair = digits[i] * 10 + (i + 1 < num_digits ? digits[i + 1] : 0);
+    comparable->push_back(static_cast<char>(pair * 2 + (i + 2 < num_digits ? 1 : 0)));
+  }
+  if (negative) {
+    for (auto& c : *comparable) {
+      c = ~c;
+    }
+  }
+  return Status::OK();
+}
+
 std::ostream& operator<<(ostream& os, const Decimal& d) {
   os << d.ToString();
   return os;
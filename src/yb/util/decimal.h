@@ -172,6 +172,20 @@ class Decimal {
 Decimal DecimalFromComparable(const Slice& slice);
 Decimal DecimalFromComparable(const std::string& string);
 
+// Returns the number of bytes taken by the comparable encoding of a decimal at the start of the
+// slice, without decoding it.
+Result<size_t> DecimalComparableEncodedSize(const Slice& slice);
+
+// Same as DecimalFromComparable(comparable).EncodeToSerializedBigDecimal(is_out_of_range), but
+// decimals with up to 38 digits are converted without building a Decimal.
+std::string ComparableDecimalToSerializedBigDecimal(const Slice& comparable,
+                                                    bool* is_out_of_range);
+
+// Same as decoding the serialized BigDecimal with DecodeFromSerializedBigDecimal and encoding
+// it with EncodeToComparable, but mantissas of up to 16 bytes are converted without building a
+// Decimal.
+CHECKED_STATUS SerializedBigDecimalToComparable(const Slice& serialized, std::string* comparable);
+
 std::ostream& operator<<(ostream& os, const Decimal& d);
 
 template <typename T>
@@ -712,6 +712,16 @@ TEST_F(TestEnv, TestWalkCbReturnsError) {
   ASSERT_EQ(2, num_calls);
 }
 
+TEST_F(TestEnv, TestGetFreeSpaceBytes) {
+  int64_t free_space;
+
+  // Does not exist.
+  ASSERT_TRUE(env_->GetFreeSpaceBytes(GetTestPath("does_not_exist"), &free_space).IsNotFound());
+
+  ASSERT_OK(env_->GetFreeSpaceBytes(GetTestPath(""), &free_space));
+  ASSERT_GT(free_space, 0);
+}
+
 TEST_F(TestEnv, TestGetBlockSize) {
   uint64_t block_size;
 
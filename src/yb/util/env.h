@@ -179,6 +179,10 @@ class Env {
   // *block_size. fname must exist but it may be a file or a directory.
   virtual CHECKED_STATUS GetBlockSize(const std::string& fname, uint64_t* block_size) = 0;
 
+  // Store the number of bytes available to unprivileged users on the filesystem where path
+  // resides in *free_space. path must exist.
+  virtual CHECKED_STATUS GetFreeSpaceBytes(const std::string& path, int64_t* free_space) = 0;
+
   // Rename file src to target.
   virtual CHECKED_STATUS RenameFile(const std::string& src,
                             const std::string& target) = 0;
@@ -350,10 +354,15 @@ struct WritableFileOptions {
   // See CreateMode for details.
   Env::CreateMode mode;
 
+  // Used with OPEN_EXISTING. The file is written from the beginning, reusing space allocated for
+  // its old content instead of appending to it, and is truncated to the written size on Close().
+  bool reuse_existing_file;
+
   WritableFileOptions()
     : sync_on_close(false),
       o_direct(false),
-      mode(Env::CREATE_IF_NON_EXISTING_TRUNCATE) { }
+      mode(Env::CREATE_IF_NON_EXISTING_TRUNCATE),
+      reuse_existing_file(false) { }
 };
 
 // Options specified when a file is opened for random access.
@@ -581,6 +590,9 @@ class EnvWrapper : public Env {
   CHECKED_STATUS GetBlockSize(const std::string& f, uint64_t* s) override {
     return target_->GetBlockSize(f, s);
   }
+  CHECKED_STATUS GetFreeSpaceBytes(const std::string& path, int64_t* free_space) override {
+    return target_->GetFreeSpaceBytes(path, free_space);
+  }
   CHECKED_STATUS RenameFile(const std::string& s, const std::string& t) override {
     return target_->RenameFile(s, t);
   }
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/uio.h>
@@ -328,12 +329,12 @@ class PosixRandomAccessFile: public RandomAccessFile {
 class PosixWritableFile : public WritableFile {
  public:
   PosixWritableFile(std::string fname, int fd, uint64_t file_size,
-                    bool sync_on_close)
+                    bool sync_on_close, uint64_t pre_allocated_size = 0)
       : filename_(std::move(fname)),
         fd_(fd),
         sync_on_close_(sync_on_close),
         filesize_(file_size),
-        pre_allocated_size_(0),
+        pre_allocated_size_(pre_allocated_size),
         pending_sync_(false) {}
 
   ~PosixWritableFile() {
@@ -519,8 +520,8 @@ class PosixWritableFile : public WritableFile {
 class PosixDirectIOWritableFile : public PosixWritableFile {
  public:
   PosixDirectIOWritableFile(const std::string &fname, int fd, uint64_t file_size,
-                            bool sync_on_close)
-      : PosixWritableFile(fname, fd, file_size, false /* sync_on_close */) {
+                            bool sync_on_close, uint64_t pre_allocated_size = 0)
+      : PosixWritableFile(fname, fd, file_size, false /* sync_on_close */, pre_allocated_size) {
 
     if (file_size != 0) {
       // For now, we don't support appending to an already existing file (of non-zero size).
@@ -1180,6 +1181,17 @@ class PosixEnv : public Env {
     return s;
   }
 
+  Status GetFreeSpaceBytes(const std::string& path, int64_t* free_space) override {
+    TRACE_EVENT1("io", "PosixEnv::GetFreeSpaceBytes", "path", path);
+    ThreadRestrictions::AssertIOAllowed();
+    struct statvfs buf;
+    if (statvfs(path.c_str(), &buf) != 0) {
+      return IOError(path, errno);
+    }
+    *free_space = static_cast<int64_t>(buf.f_bavail) * buf.f_frsize;
+    return Status::OK();
+  }
+
   Status RenameFile(const std::string& src, const std::string& target) override {
     TRACE_EVENT2("io", "PosixEnv::RenameFile", "src", src, "dst", target);
     ThreadRestrictions::AssertIOAllowed();
@@ -1421,16 +1433,24 @@ class PosixEnv : public Env {
                                     const WritableFileOptions& opts,
                                     gscoped_ptr<WritableFile>* result) {
     uint64_t file_size = 0;
+    uint64_t pre_allocated_size = 0;
     if (opts.mode == OPEN_EXISTING) {
       RETURN_NOT_OK(GetFileSize(fname, &file_size));
+      if (opts.reuse_existing_file) {
+        // Old content is treated as preallocated space, so it is overwritten and then truncated.
+        pre_allocated_size = file_size;
+        file_size = 0;
+      }
     }
     PosixWritableFile *posix_writable_file;
 #if defined(__linux)
     if (opts.o_direct)
-      posix_writable_file = new PosixDirectIOWritableFile(fname, fd, file_size, opts.sync_on_close);
+      posix_writable_file = new PosixDirectIOWritableFile(
+          fname, fd, file_size, opts.sync_on_close, pre_allocated_size);
     else
 #endif
-      posix_writable_file = new PosixWritableFile(fname, fd, file_size, opts.sync_on_close);
+      posix_writable_file = new PosixWritableFile(
+          fname, fd, file_size, opts.sync_on_close, pre_allocated_size);
     result->reset(posix_writable_file);
     return Status::OK();
   }
@@ -37,6 +37,7 @@
 #include <string>
 
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/crc.h"
 #include "yb/util/env.h"
 #include "yb/util/env_util.h"
 #include "yb/util/status.h"
@@ -146,6 +147,27 @@ Status CopyFile(Env* env, const string& source_path, const string& dest_path,
   return Status::OK();
 }
 
+Status Crc32cFile(Env* env, const string& path, uint32_t* crc32c) {
+  gscoped_ptr<SequentialFile> file;
+  RETURN_NOT_OK(env->NewSequentialFile(path, &file));
+
+  const int32_t kBufferSize = 1024 * 1024;
+  gscoped_ptr<uint8_t[]> scratch(new uint8_t[kBufferSize]);
+
+  crc::Crc* crc = crc::GetCrc32cInstance();
+  uint64_t result = 0;
+  for (;;) {
+    Slice data;
+    RETURN_NOT_OK(file->Read(kBufferSize, &data, scratch.get()));
+    if (data.empty()) {
+      break;
+    }
+    crc->Compute(data.data(), data.size(), &result);
+  }
+  *crc32c = static_cast<uint32_t>(result);
+  return Status::OK();
+}
+
 ScopedFileDeleter::ScopedFileDeleter(Env* env, std::string path)
     : env_(DCHECK_NOTNULL(env)), path_(std::move(path)), should_delete_(true) {}
 
@@ -83,6 +83,9 @@ Status CreateDirIfMissing(Env* env, const std::string& path,
 Status CopyFile(Env* env, const std::string& source_path, const std::string& dest_path,
                 WritableFileOptions opts);
 
+// Computes the CRC32C of the contents of the file 'path'.
+Status Crc32cFile(Env* env, const std::string& path, uint32_t* crc32c);
+
 // Deletes a file or directory when this object goes out of scope.
 //
 // The deletion may be cancelled by calling .Cancel().
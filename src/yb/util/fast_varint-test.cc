@@ -11,6 +11,7 @@
 // under the License.
 //
 
+#include <algorithm>
 #include <iostream>
 
 #include "yb/gutil/strings/substitute.h"
@@ -119,6 +120,48 @@ TEST(FastVarintTest, TestEncodeDecode) {
   ASSERT_EQ(BINARY_STRING("\xdf\xff"), FastEncodeSignedVarIntToStr(8191));
 }
 
+TEST(FastVarIntTest, TestDecodeBatch) {
+  Random rng(SeedRandom());
+  std::vector<int64_t> values;
+  for (int i = 0; i <= 62; ++i) {
+    values.push_back(1LL << i);
+    values.push_back(-(1LL << i) + 1);
+  }
+  values.push_back(numeric_limits<int64_t>::max());
+  values.push_back(numeric_limits<int64_t>::min());
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(static_cast<int64_t>(rng.Next64()) >> rng.Uniform(64));
+  }
+
+  std::string encoded;
+  std::string descending_encoded;
+  for (auto value : values) {
+    FastAppendSignedVarIntToStr(value, &encoded);
+    if (value != numeric_limits<int64_t>::min()) {
+      FastEncodeDescendingSignedVarInt(value, &descending_encoded);
+    }
+  }
+
+  std::vector<int64_t> decoded(values.size());
+  Slice slice(encoded);
+  ASSERT_OK(FastDecodeSignedVarInts(&slice, decoded.data(), decoded.size()));
+  ASSERT_TRUE(slice.empty());
+  ASSERT_EQ(values, decoded);
+
+  values.erase(std::find(values.begin(), values.end(), numeric_limits<int64_t>::min()));
+  decoded.resize(values.size());
+  slice = Slice(descending_encoded);
+  ASSERT_OK(FastDecodeDescendingSignedVarInts(&slice, decoded.data(), decoded.size()));
+  ASSERT_TRUE(slice.empty());
+  ASSERT_EQ(values, decoded);
+
+  // Decoding past the end fails and leaves the slice unchanged.
+  decoded.resize(values.size() + 2);
+  slice = Slice(encoded.data(), encoded.size() - 1);
+  ASSERT_NOK(FastDecodeSignedVarInts(&slice, decoded.data(), decoded.size()));
+  ASSERT_EQ(encoded.size() - 1, slice.size());
+}
+
 template<class T>
 std::vector<T> GenerateRandomValues() {
   std::mt19937_64 rng(123456);
@@ -11,9 +11,11 @@
 // under the License.
 //
 
+#include "yb/util/fast_varint.h"
+
+#include "yb/gutil/endian.h"
 #include "yb/util/bytes_formatter.h"
 #include "yb/util/cast.h"
-#include "yb/util/fast_varint.h"
 
 using std::string;
 
@@ -48,6 +50,28 @@ inline Status NotEnoughEncodedBytes(int decoded_varint_size, int bytes_provided)
       decoded_varint_size, bytes_provided);
 }
 
+// Decodes a signed VarInt of at most 8 bytes starting at 'src' from a single big endian 64-bit load.
+// At least 8 bytes must be readable at 'src'. Returns the encoded size, or 0 if the VarInt is longer
+// than 8 bytes and has to be decoded by FastDecodeSignedVarInt.
+inline int DecodeSignedVarIntFromWord(const uint8_t* src, int64_t* v) {
+  uint64_t word = BigEndian::Load64(src);
+  // The sign bit is the highest bit. Negative values are stored as the complement of the encoding
+  // of their absolute value.
+  const bool negative = (word >> 63) == 0;
+  if (negative) {
+    word = ~word;
+  }
+  const int n_bytes = kVarIntSizeTable.varint_size[word >> 56];
+  if (n_bytes == 8 && (word & 0x0080000000000000ULL)) {
+    // 9 or 10 byte encoding.
+    return 0;
+  }
+  // The n_bytes highest bytes hold n_bytes + 1 prefix bits followed by 7 * n_bytes - 1 value bits.
+  const uint64_t result = (word >> (64 - 8 * n_bytes)) & ((1ULL << (7 * n_bytes - 1)) - 1);
+  *v = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+  return n_bytes;
+}
+
 }  // anonymous namespace
 
 int SignedPositiveVarIntLength(uint64_t v) {
@@ -262,6 +286,33 @@ Status FastDecodeDescendingSignedVarInt(yb::Slice *slice, int64_t *dest) {
   return Status::OK();
 }
 
+Status FastDecodeSignedVarInts(yb::Slice* slice, int64_t* dest, size_t count) {
+  const uint8_t* src = slice->data();
+  const uint8_t* const end = slice->end();
+  for (size_t i = 0; i != count; ++i) {
+    if (end - src >= 8) {
+      const int decoded_size = DecodeSignedVarIntFromWord(src, dest + i);
+      if (PREDICT_TRUE(decoded_size != 0)) {
+        src += decoded_size;
+        continue;
+      }
+    }
+    int decoded_size = 0;
+    RETURN_NOT_OK(FastDecodeSignedVarInt(src, end - src, dest + i, &decoded_size));
+    src += decoded_size;
+  }
+  slice->remove_prefix(src - slice->data());
+  return Status::OK();
+}
+
+Status FastDecodeDescendingSignedVarInts(yb::Slice* slice, int64_t* dest, size_t count) {
+  RETURN_NOT_OK(FastDecodeSignedVarInts(slice, dest, count));
+  for (size_t i = 0; i != count; ++i) {
+    dest[i] = -dest[i];
+  }
+  return Status::OK();
+}
+
 size_t UnsignedVarIntLength(uint64_t v) {
   size_t result = 1;
   v >>= 7;
@@ -62,6 +62,14 @@ inline void FastEncodeDescendingSignedVarInt(int64_t v, std::string *dest) {
 // Decode a "descending VarInt" encoded by FastEncodeDescendingVarInt.
 CHECKED_STATUS FastDecodeDescendingSignedVarInt(yb::Slice *slice, int64_t *dest);
 
+// Decodes 'count' consecutive VarInts from the beginning of 'slice' into 'dest' and removes them
+// from the slice. While at least 8 bytes remain, VarInts of up to 8 bytes are decoded from a single
+// 64-bit load without a per-byte loop. On failure the slice is left unchanged.
+CHECKED_STATUS FastDecodeSignedVarInts(yb::Slice* slice, int64_t* dest, size_t count);
+
+// The same as FastDecodeSignedVarInts, but for "descending VarInts".
+CHECKED_STATUS FastDecodeDescendingSignedVarInts(yb::Slice* slice, int64_t* dest, size_t count);
+
 size_t UnsignedVarIntLength(uint64_t v);
 void FastEncodeUnsignedVarInt(uint64_t v, uint8_t *dest, size_t *size);
 CHECKED_STATUS FastDecodeUnsignedVarInt(
@@ -33,6 +33,7 @@
 #include "yb/util/mem_tracker.h"
 
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -44,6 +45,8 @@
 
 DECLARE_int32(memory_limit_soft_percentage);
 
+DECLARE_int64(mem_tracker_update_batch_bytes);
+
 namespace yb {
 
 using std::equal_to;
@@ -352,4 +355,44 @@ TEST(MemTrackerTest, UnregisterFromParent) {
   c->UnregisterFromParent();
 }
 
+TEST(MemTrackerTest, BatchedConsumption) {
+  const int64_t kBatchBytes = 1000;
+  google::FlagSaver saver;
+  FLAGS_mem_tracker_update_batch_bytes = kBatchBytes;
+  shared_ptr<MemTracker> p = MemTracker::CreateTracker(-1, "parent");
+  shared_ptr<MemTracker> c = MemTracker::CreateTracker(-1, "child", p);
+
+  // A thread always sees its own updates, even before they add up to a batch.
+  std::thread([&] {
+    c->Consume(kBatchBytes / 2);
+    ASSERT_EQ(kBatchBytes / 2, c->consumption());
+    c->Consume(kBatchBytes / 4);
+  }).join();
+  c->Release(kBatchBytes / 4);
+  // Updates still pending in a thread are applied when it exits.
+  ASSERT_EQ(kBatchBytes / 2, c->consumption());
+  ASSERT_EQ(kBatchBytes / 2, p->consumption());
+
+  std::thread([&] {
+    c->Consume(kBatchBytes / 4);
+    c->Consume(kBatchBytes);
+    c->Release(kBatchBytes / 4);
+  }).join();
+  ASSERT_EQ(kBatchBytes * 3 / 2, c->consumption());
+  ASSERT_EQ(kBatchBytes * 3 / 2, p->consumption());
+
+  // Trackers close to their limit are updated precisely.
+  shared_ptr<MemTracker> l = MemTracker::CreateTracker(kBatchBytes, "limited", p);
+  ASSERT_TRUE(l->TryConsume(kBatchBytes / 2));
+  ASSERT_FALSE(l->TryConsume(kBatchBytes));
+  l->Consume(kBatchBytes);
+  ASSERT_TRUE(l->LimitExceeded());
+  l->Release(kBatchBytes * 3 / 2);
+  ASSERT_EQ(0, l->consumption());
+
+  c->Release(kBatchBytes * 3 / 2);
+  ASSERT_EQ(0, c->consumption());
+  ASSERT_EQ(0, p->consumption());
+}
+
 } // namespace yb
@@ -33,11 +33,13 @@
 #include "yb/util/mem_tracker.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <deque>
 #include <limits>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <unordered_set>
 
 #include <gperftools/malloc_extension.h> // NOLINT
 
@@ -46,6 +48,7 @@
 #include "yb/gutil/strings/join.h"
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/sysinfo.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/env.h"
@@ -93,6 +96,13 @@ DEFINE_bool(mem_tracker_log_stack_trace, false,
             "Enable logging of stack traces on memory tracker consume/release operations. "
             "Only takes effect if mem_tracker_logging is also enabled.");
 
+DEFINE_int64(mem_tracker_update_batch_bytes, 1024 * 1024,
+             "Consume()/Release() calls are accumulated per thread and applied to the memory "
+             "trackers once the pending amount reaches this many bytes. Updates are applied "
+             "immediately when a tracker is close to its limit. 0 disables batching.");
+TAG_FLAG(mem_tracker_update_batch_bytes, advanced);
+TAG_FLAG(mem_tracker_update_batch_bytes, runtime);
+
 namespace yb {
 
 // NOTE: this class has been adapted from Impala, so the code style varies
@@ -134,6 +144,101 @@ static bool dummy[] __attribute__((unused)) = {
 #endif
 };
 
+// Small per-thread table of trackers with consumption that was not applied yet. All caches are
+// registered in a global set, so a tracker that is being destroyed can collect its pending
+// consumption from every thread. The spinlock is only contended in that case.
+class MemTracker::ThreadConsumptionCache {
+ public:
+  ThreadConsumptionCache() {
+    std::lock_guard<std::mutex> l(registry_mutex());
+    registry().insert(this);
+  }
+
+  ~ThreadConsumptionCache() {
+    Flush(nullptr);
+    {
+      std::lock_guard<std::mutex> l(registry_mutex());
+      registry().erase(this);
+    }
+    thread_consumption_cache_ = nullptr;
+  }
+
+  void Add(MemTracker* tracker, int64_t bytes, int64_t batch_bytes) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    Entry* entry = nullptr;
+    for (auto& e : entries_) {
+      if (e.tracker == tracker) {
+        entry = &e;
+        break;
+      }
+      if (e.tracker == nullptr && entry == nullptr) {
+        entry = &e;
+      }
+    }
+    if (entry == nullptr) {
+      entry = &entries_[next_victim_];
+      next_victim_ = (next_victim_ + 1) % kNumEntries;
+      FlushEntry(entry);
+    }
+    entry->tracker = tracker;
+    entry->pending += bytes;
+    if (std::abs(entry->pending) >= batch_bytes) {
+      FlushEntry(entry);
+    }
+  }
+
+  // Applies the pending consumption of 'tracker', or of all trackers if it is null.
+  void Flush(MemTracker* tracker) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    for (auto& e : entries_) {
+      if (tracker == nullptr || e.tracker == tracker) {
+        FlushEntry(&e);
+      }
+    }
+  }
+
+  // Applies the consumption of 'tracker' pending in all threads.
+  static void FlushAllThreads(MemTracker* tracker) {
+    std::lock_guard<std::mutex> l(registry_mutex());
+    for (auto* cache : registry()) {
+      cache->Flush(tracker);
+    }
+  }
+
+ private:
+  static constexpr size_t kNumEntries = 8;
+
+  struct Entry {
+    MemTracker* tracker = nullptr;
+    int64_t pending = 0;
+  };
+
+  static void FlushEntry(Entry* entry) {
+    if (entry->tracker != nullptr && entry->pending != 0) {
+      entry->tracker->ApplyConsumption(entry->pending);
+    }
+    entry->tracker = nullptr;
+    entry->pending = 0;
+  }
+
+  static std::mutex& registry_mutex() {
+    static std::mutex* mutex = new std::mutex;
+    return *mutex;
+  }
+
+  static std::unordered_set<ThreadConsumptionCache*>& registry() {
+    static auto* caches = new std::unordered_set<ThreadConsumptionCache*>;
+    return *caches;
+  }
+
+  simple_spinlock lock_;
+  Entry entries_[kNumEntries];
+  size_t next_victim_ = 0;
+};
+
+DEFINE_STATIC_THREAD_LOCAL(MemTracker::ThreadConsumptionCache, MemTracker,
+                           thread_consumption_cache_);
+
 #ifdef TCMALLOC_ENABLED
 static int64_t GetTCMallocProperty(const char* prop) {
   size_t value;
@@ -214,6 +319,7 @@ MemTracker::MemTracker(ConsumptionFunction consumption_func, int64_t byte_limit,
 
 MemTracker::~MemTracker() {
   VLOG(1) << "Destroying tracker " << ToString();
+  ThreadConsumptionCache::FlushAllThreads(this);
   if (parent_) {
     DCHECK(consumption() == 0) << "Memory tracker " << ToString()
         << " has unreleased consumption " << consumption();
@@ -322,18 +428,59 @@ void MemTracker::Consume(int64_t bytes) {
   if (bytes == 0) {
     return;
   }
+  if (CanBatchConsumption()) {
+    INIT_STATIC_THREAD_LOCAL(ThreadConsumptionCache, thread_consumption_cache_);
+    thread_consumption_cache_->Add(this, bytes, FLAGS_mem_tracker_update_batch_bytes);
+    return;
+  }
   if (PREDICT_FALSE(enable_logging_)) {
     LogUpdate(true, bytes);
   }
+  ApplyConsumption(bytes);
+}
+
+void MemTracker::ApplyConsumption(int64_t bytes) {
+  if (bytes < 0 &&
+      PREDICT_FALSE(base::subtle::Barrier_AtomicIncrement(&released_memory_since_gc, -bytes) >
+                    GC_RELEASE_SIZE)) {
+    GcTcmalloc();
+  }
   for (auto& tracker : all_trackers_) {
     tracker->consumption_.IncrementBy(bytes);
+    // If a UDF calls FunctionContext::TrackAllocation() but allocates less than the
+    // reported amount, the subsequent call to FunctionContext::Free() may cause the
+    // process mem tracker to go negative until it is synced back to the tcmalloc
+    // metric. Don't blow up in this case. (Note that this doesn't affect non-process
+    // trackers since we can enforce that the reported memory usage is internally
+    // consistent.)
     if (tracker->consumption_func_) {
       DCHECK_GE(tracker->consumption_.current_value(), 0);
     }
   }
 }
 
+bool MemTracker::CanBatchConsumption() const {
+  const int64_t batch_bytes = FLAGS_mem_tracker_update_batch_bytes;
+  if (batch_bytes <= 0 || consumption_func_ || PREDICT_FALSE(enable_logging_)) {
+    return false;
+  }
+  // Every CPU may hold back up to a batch, so a tracker whose spare capacity is below that
+  // is updated precisely.
+  const int64_t slack = batch_bytes * base::NumCPUs();
+  for (const auto& tracker : limit_trackers_) {
+    if (tracker->limit_ - tracker->consumption_.current_value() < slack) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MemTracker::FlushThreadConsumptionSlow() {
+  thread_consumption_cache_->Flush(nullptr);
+}
+
 bool MemTracker::TryConsume(int64_t bytes) {
+  FlushThreadConsumption();
   if (consumption_func_) {
     UpdateConsumption();
   }
@@ -393,12 +540,11 @@ void MemTracker::Release(int64_t bytes) {
     return;
   }
 
-  if (PREDICT_FALSE(base::subtle::Barrier_AtomicIncrement(&released_memory_since_gc, bytes) >
-                    GC_RELEASE_SIZE)) {
-    GcTcmalloc();
-  }
-
   if (consumption_func_) {
+    if (PREDICT_FALSE(base::subtle::Barrier_AtomicIncrement(&released_memory_since_gc, bytes) >
+                      GC_RELEASE_SIZE)) {
+      GcTcmalloc();
+    }
     UpdateConsumption();
     return;
   }
@@ -406,22 +552,15 @@ void MemTracker::Release(int64_t bytes) {
   if (bytes == 0) {
     return;
   }
+  if (CanBatchConsumption()) {
+    INIT_STATIC_THREAD_LOCAL(ThreadConsumptionCache, thread_consumption_cache_);
+    thread_consumption_cache_->Add(this, -bytes, FLAGS_mem_tracker_update_batch_bytes);
+    return;
+  }
   if (PREDICT_FALSE(enable_logging_)) {
     LogUpdate(false, bytes);
   }
-
-  for (auto& tracker : all_trackers_) {
-    tracker->consumption_.IncrementBy(-bytes);
-    // If a UDF calls FunctionContext::TrackAllocation() but allocates less than the
-    // reported amount, the subsequent call to FunctionContext::Free() may cause the
-    // process mem tracker to go negative until it is synced back to the tcmalloc
-    // metric. Don't blow up in this case. (Note that this doesn't affect non-process
-    // trackers since we can enforce that the reported memory usage is internally
-    // consistent.)
-    if (tracker->consumption_func_) {
-      DCHECK_GE(tracker->consumption_.current_value(), 0);
-    }
-  }
+  ApplyConsumption(-bytes);
 }
 
 bool MemTracker::AnyLimitExceeded() {
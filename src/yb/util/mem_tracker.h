@@ -45,6 +45,7 @@
 #include "yb/util/locks.h"
 #include "yb/util/mutex.h"
 #include "yb/util/random.h"
+#include "yb/util/threadlocal.h"
 
 namespace yb {
 
@@ -85,6 +86,14 @@ class MemTracker;
 // this will be called before the process limit is reported as exceeded. GcFunctions are
 // called in the order they are added, so expensive functions should be added last.
 //
+// To keep hot Consume()/Release() calls from bouncing the consumption counters of the
+// whole ancestor chain between CPUs, small updates are accumulated in a per-thread cache and
+// applied to the tree once they add up to --mem_tracker_update_batch_bytes. Updates are
+// applied immediately when any tracker in the chain is close to its limit, so limits are
+// still enforced precisely, and TryConsume() always applies the pending updates of the
+// calling thread first. consumption() includes everything the calling thread consumed, but
+// may lag behind other threads by up to one batch per thread.
+//
 // This class is thread-safe.
 //
 // NOTE: this class has been partially ported over from Impala with
@@ -226,6 +235,7 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
 
   // Returns the memory consumed in bytes.
   int64_t consumption() const {
+    FlushThreadConsumption();
     return consumption_.current_value();
   }
 
@@ -264,6 +274,9 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
   // Currently only used by the root tracker.
   typedef std::function<uint64_t()> ConsumptionFunction;
 
+  // Per-thread batch of consumption updates that were not yet applied to the trackers.
+  class ThreadConsumptionCache;
+
   // If consumption_func is not empty, uses it as the consumption value.
   // Consume()/Release() can still be called.
   // byte_limit < 0 means no limit
@@ -289,6 +302,22 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
   // Further initializes the tracker.
   void Init();
 
+  // Applies 'bytes' to the consumption of this tracker and all of its ancestors.
+  void ApplyConsumption(int64_t bytes);
+
+  // Returns true if an update of this tracker may be batched in the thread cache, i.e. there
+  // is no consumption function and no tracker in the chain is close to its limit.
+  bool CanBatchConsumption() const;
+
+  // Applies the consumption batched by the calling thread.
+  static void FlushThreadConsumption() {
+    if (PREDICT_FALSE(thread_consumption_cache_ != nullptr)) {
+      FlushThreadConsumptionSlow();
+    }
+  }
+
+  static void FlushThreadConsumptionSlow();
+
   // Adds tracker to child_trackers_.
   //
   // child_trackers_lock_ must be held.
@@ -365,6 +394,8 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
 
   // If true, log the stack as well.
   bool log_stack_;
+
+  DECLARE_STATIC_THREAD_LOCAL(ThreadConsumptionCache, thread_consumption_cache_);
 };
 
 // An std::allocator that manipulates a MemTracker during allocation
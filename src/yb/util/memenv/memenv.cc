@@ -391,7 +391,20 @@ class InMemoryEnv : public EnvWrapper {
                                  const std::string& fname,
                                  gscoped_ptr<WritableFile>* result) override {
     gscoped_ptr<WritableFileImpl> wf;
-    RETURN_NOT_OK(CreateAndRegisterNewFile(fname, opts.mode, &wf));
+    CreateMode mode = opts.mode;
+    if (mode == OPEN_EXISTING && opts.reuse_existing_file) {
+      // There is no allocated space to reuse in memory, so just rewrite the existing file.
+      bool exists;
+      {
+        MutexLock lock(mutex_);
+        exists = ContainsKey(file_map_, fname);
+      }
+      if (!exists) {
+        return STATUS(IOError, fname, "File not found");
+      }
+      mode = CREATE_IF_NON_EXISTING_TRUNCATE;
+    }
+    RETURN_NOT_OK(CreateAndRegisterNewFile(fname, mode, &wf));
     result->reset(wf.release());
     return Status::OK();
   }
@@ -31,6 +31,7 @@
 //
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -317,4 +318,23 @@ TEST(TestArena, TestString) {
   ASSERT_FALSE(one > ten);
 }
 
+TEST(TestArena, TestPooledArena) {
+  Arena* raw_arena;
+  {
+    PooledArena arena = AcquirePooledArena();
+    raw_arena = arena.get();
+    memset(arena->AllocateBytes(64 * 1024), 0, 64 * 1024);
+  }
+  // The released arena is reset and reused by the next request on this thread.
+  PooledArena arena = AcquirePooledArena();
+  ASSERT_EQ(raw_arena, arena.get());
+  ASSERT_NE(nullptr, arena->AllocateBytes(100));
+  // The pool of another thread does not have it.
+  Arena* other_arena = nullptr;
+  std::thread([&other_arena]() {
+    other_arena = AcquirePooledArena().get();
+  }).join();
+  ASSERT_NE(raw_arena, other_arena);
+}
+
 } // namespace yb
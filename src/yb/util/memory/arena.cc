@@ -35,7 +35,9 @@
 #include "yb/util/memory/arena.h"
 
 #include <algorithm>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "yb/util/debug-util.h"
 #include "yb/util/flag_tags.h"
@@ -52,6 +54,17 @@ DEFINE_int64(arena_warn_threshold_bytes, 256*1024*1024,
              "Number of bytes beyond which to emit a warning for a large arena");
 TAG_FLAG(arena_warn_threshold_bytes, hidden);
 
+DEFINE_int32(arena_pool_max_arenas_per_thread, 8,
+             "Maximal number of released request arenas kept for reuse by each thread.");
+TAG_FLAG(arena_pool_max_arenas_per_thread, advanced);
+TAG_FLAG(arena_pool_max_arenas_per_thread, runtime);
+
+DEFINE_int64(arena_pool_max_retained_bytes, 1024 * 1024,
+             "Released request arenas that keep more memory than this are freed instead of being "
+             "reused.");
+TAG_FLAG(arena_pool_max_retained_bytes, advanced);
+TAG_FLAG(arena_pool_max_retained_bytes, runtime);
+
 namespace yb {
 namespace internal {
 
@@ -264,4 +277,58 @@ template class ArenaBase<ThreadSafeArenaTraits>;
 template class ArenaBase<ArenaTraits>;
 
 }  // namespace internal
+
+namespace {
+
+// Set when the pool of the current thread is destroyed on thread exit, so arenas released after
+// that are freed.
+thread_local bool arena_pool_destroyed = false;
+
+class ThreadArenaPool {
+ public:
+  ~ThreadArenaPool() {
+    arena_pool_destroyed = true;
+  }
+
+  Arena* Take() {
+    if (arenas_.empty()) {
+      return nullptr;
+    }
+    Arena* result = arenas_.back().release();
+    arenas_.pop_back();
+    return result;
+  }
+
+  bool Put(Arena* arena) {
+    if (arenas_.size() >= static_cast<size_t>(FLAGS_arena_pool_max_arenas_per_thread)) {
+      return false;
+    }
+    arenas_.emplace_back(arena);
+    return true;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Arena>> arenas_;
+};
+
+thread_local ThreadArenaPool arena_pool;
+
+} // namespace
+
+void PooledArenaDeleter::operator()(Arena* arena) const {
+  if (!arena_pool_destroyed) {
+    arena->Reset();
+    if (arena->memory_footprint() <= FLAGS_arena_pool_max_retained_bytes &&
+        arena_pool.Put(arena)) {
+      return;
+    }
+  }
+  delete arena;
+}
+
+PooledArena AcquirePooledArena() {
+  Arena* arena = arena_pool_destroyed ? nullptr : arena_pool.Take();
+  return PooledArena(arena != nullptr ? arena : new Arena());
+}
+
 }  // namespace yb
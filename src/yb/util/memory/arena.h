@@ -450,6 +450,21 @@ std::shared_ptr<TObject> ArenaBase<Traits>::ToShared(TObject *raw_ptr) {
 }
 
 } // namespace internal
+
+// Returns an arena to the pool of the thread that releases it, see AcquirePooledArena.
+class PooledArenaDeleter {
+ public:
+  void operator()(Arena* arena) const;
+};
+
+typedef std::unique_ptr<Arena, PooledArenaDeleter> PooledArena;
+
+// Takes an arena from the pool of the current thread, or creates a new one when the pool is empty.
+// Intended for memory that lives as long as a single request: the arena is reset when released and
+// the buffers it grew to are reused by the next request handled by the thread, instead of going
+// through the system allocator for every object.
+PooledArena AcquirePooledArena();
+
 } // namespace yb
 
 template<class Traits>
@@ -34,12 +34,14 @@
 #include <gtest/gtest.h>
 #include <rapidjson/document.h>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include "yb/gutil/bind.h"
 #include "yb/gutil/map-util.h"
 #include "yb/util/hdr_histogram.h"
+#include "yb/util/histogram.pb.h"
 #include "yb/util/jsonreader.h"
 #include "yb/util/jsonwriter.h"
 #include "yb/util/metrics.h"
@@ -181,6 +183,39 @@ TEST_F(MetricsTest, SimpleHistogramTest) {
   // TODO: Test coverage needs to be improved a lot.
 }
 
+METRIC_DEFINE_histogram(test_entity, test_sharded_hist, "Test Sharded Histogram",
+                        MetricUnit::kMilliseconds, "foo", 1000000, 3, yb::SHARDED_HISTOGRAM);
+
+TEST_F(MetricsTest, ShardedHistogramTest) {
+  scoped_refptr<Histogram> hist = METRIC_test_sharded_hist.Instantiate(entity_);
+  const int kNumThreads = 8;
+  const int kIncrementsPerThread = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([hist, i] {
+      for (int j = 0; j < kIncrementsPerThread; ++j) {
+        hist->Increment(i + 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Values recorded on any CPU are seen by the readers.
+  ASSERT_EQ(kNumThreads * kIncrementsPerThread, hist->TotalCount());
+  ASSERT_EQ(1, hist->MinValueForTests());
+  ASSERT_EQ(kNumThreads, hist->MaxValueForTests());
+  for (int i = 1; i <= kNumThreads; ++i) {
+    ASSERT_EQ(kIncrementsPerThread, hist->CountInBucketForValueForTests(i));
+  }
+
+  HistogramSnapshotPB snapshot;
+  ASSERT_OK(hist->GetHistogramSnapshotPB(&snapshot, MetricJsonOptions()));
+  ASSERT_EQ(kNumThreads * kIncrementsPerThread, snapshot.total_count());
+  ASSERT_EQ(kIncrementsPerThread * kNumThreads * (kNumThreads + 1) / 2, snapshot.total_sum());
+}
+
 TEST_F(MetricsTest, JsonPrintTest) {
   scoped_refptr<Counter> bytes_seen = METRIC_reqs_pending.Instantiate(entity_);
   bytes_seen->Increment();
@@ -217,6 +252,56 @@ TEST_F(MetricsTest, JsonPrintTest) {
   ASSERT_EQ("", out.str());
 }
 
+METRIC_DEFINE_entity(tablet);
+
+METRIC_DEFINE_counter(tablet, tablet_reqs, "Tablet Requests", MetricUnit::kRequests,
+                      "Number of requests to the tablet");
+
+TEST_F(MetricsTest, PrometheusAggregationTest) {
+  const MetricEntity::AttributeMap attrs = {{"table_id", "t1"}, {"table_name", "test_table"}};
+  auto tablet1 = METRIC_ENTITY_tablet.Instantiate(&registry_, "tablet-1", attrs);
+  auto tablet2 = METRIC_ENTITY_tablet.Instantiate(&registry_, "tablet-2", attrs);
+  auto reqs1 = METRIC_tablet_reqs.Instantiate(tablet1);
+  auto reqs2 = METRIC_tablet_reqs.Instantiate(tablet2);
+  reqs1->IncrementBy(3);
+  reqs2->IncrementBy(4);
+
+  const string kTableLabels =
+      "exported_instance=\"DEFAULT_NODE_NAME\",metric_type=\"tablet\",table_id=\"t1\","
+      "table_name=\"test_table\"";
+
+  // Tablets of the same table are summed up by default.
+  std::stringstream out;
+  {
+    PrometheusWriter writer(&out);
+    ASSERT_OK(registry_.WriteForPrometheus(&writer));
+  }
+  ASSERT_STR_CONTAINS(out.str(), "tablet_reqs{" + kTableLabels + "} 7 ");
+  ASSERT_EQ(string::npos, out.str().find("metric_id=\"tablet-"));
+
+  // Each tablet is exported separately when requested.
+  out.str("");
+  {
+    PrometheusWriter writer(&out, PrometheusAggregation::kTablet);
+    ASSERT_OK(registry_.WriteForPrometheus(&writer));
+  }
+  ASSERT_STR_CONTAINS(
+      out.str(),
+      "tablet_reqs{exported_instance=\"DEFAULT_NODE_NAME\",metric_id=\"tablet-1\","
+      "metric_type=\"tablet\",table_id=\"t1\",table_name=\"test_table\"} 3 ");
+  ASSERT_STR_CONTAINS(out.str(), "metric_id=\"tablet-2\"");
+  ASSERT_EQ(string::npos, out.str().find("} 7 "));
+
+  // Labels follow attribute changes.
+  tablet1->SetAttribute("table_name", "renamed");
+  out.str("");
+  {
+    PrometheusWriter writer(&out, PrometheusAggregation::kTablet);
+    ASSERT_OK(registry_.WriteForPrometheus(&writer));
+  }
+  ASSERT_STR_CONTAINS(out.str(), "table_name=\"renamed\"} 3 ");
+}
+
 // Test that metrics are retired when they are no longer referenced.
 TEST_F(MetricsTest, RetirementTest) {
   FLAGS_metrics_retirement_age_ms = 100;
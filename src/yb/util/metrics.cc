@@ -31,9 +31,15 @@
 //
 #include "yb/util/metrics.h"
 
+#include <sched.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <map>
 #include <set>
+#include <thread>
 
 #include <gflags/gflags.h>
 
@@ -42,7 +48,9 @@
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/singleton.h"
 #include "yb/gutil/stl_util.h"
+#include "yb/gutil/strings/numbers.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/sysinfo.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/hdr_histogram.h"
 #include "yb/util/histogram.pb.h"
@@ -56,6 +64,12 @@ DEFINE_int32(metrics_retirement_age_ms, 120 * 1000,
 TAG_FLAG(metrics_retirement_age_ms, runtime);
 TAG_FLAG(metrics_retirement_age_ms, advanced);
 
+DEFINE_int32(max_histogram_shards, 8,
+             "Maximum number of shards of the histograms that record values per CPU. CPUs beyond "
+             "this share the shards. Only applies to histograms created after it is set.");
+TAG_FLAG(max_histogram_shards, advanced);
+TAG_FLAG(max_histogram_shards, runtime);
+
 // TODO: changed to empty string and add logic to get this from cluster_uuid in case empty.
 DEFINE_string(metric_node_name, "DEFAULT_NODE_NAME",
               "Value to use as node name for metrics reporting");
@@ -277,51 +291,107 @@ Status MetricEntity::WriteAsJson(JsonWriter* writer,
   return Status::OK();
 }
 
-CHECKED_STATUS MetricEntity::WriteForPrometheus(PrometheusWriter* writer) const {
-  // We want the keys to be in alphabetical order when printing, so we use an ordered map here.
-  typedef std::map<const char*, scoped_refptr<Metric> > OrderedMetricMap;
-  OrderedMetricMap metrics;
-  AttributeMap attrs;
-  std::vector<ExternalPrometheusMetricsCb> external_metrics_cbs;
-  {
-    // Snapshot the metrics, attributes & external metrics callbacks in this metrics entity. (Note:
-    // this is not guaranteed to be a consistent snapshot).
-    std::lock_guard<simple_spinlock> l(lock_);
-    attrs = attributes_;
-    external_metrics_cbs = external_prometheus_metrics_cbs_;
-    for (const MetricMap::value_type& val : metric_map_) {
-      const MetricPrototype* prototype = val.first;
-      const scoped_refptr<Metric>& metric = val.second;
+namespace {
 
-      InsertOrDie(&metrics, prototype->name(), metric);
+typedef std::map<std::string, std::string> PrometheusLabelMap;
+
+void AppendEscapedLabelValue(const std::string& value, std::string* out) {
+  for (char c : value) {
+    switch (c) {
+      case '\\': out->append("\\\\"); break;
+      case '"': out->append("\\\""); break;
+      case '\n': out->append("\\n"); break;
+      default: out->push_back(c); break;
+    }
+  }
+}
+
+std::string RenderPrometheusLabels(const PrometheusLabelMap& labels) {
+  std::string result;
+  if (labels.empty()) {
+    return result;
+  }
+  result.push_back('{');
+  for (const auto& entry : labels) {
+    if (result.size() > 1) {
+      result.push_back(',');
     }
+    result.append(entry.first);
+    result.append("=\"");
+    AppendEscapedLabelValue(entry.second, &result);
+    result.push_back('"');
   }
-  AttributeMap prometheus_attr;
+  result.push_back('}');
+  return result;
+}
+
+} // namespace
+
+std::shared_ptr<const PrometheusEntityLabels> MetricEntity::PrometheusLabelsUnlocked() const {
+  if (prometheus_labels_) {
+    return prometheus_labels_;
+  }
+
+  PrometheusLabelMap labels;
+  auto result = std::make_shared<PrometheusEntityLabels>();
   // Per tablet metrics come with tablet_id, as well as table_id and table_name attributes.
-  // We ignore the tablet part to squash at the table level.
+  // Only the table part is kept, so values could be summed up at the table level.
   if (strcmp(prototype_->name(), "tablet") == 0)  {
-    prometheus_attr["table_id"] = attrs["table_id"];
-    prometheus_attr["table_name"] = attrs["table_name"];
+    result->table_id = FindWithDefault(attributes_, "table_id", "");
+    labels["table_id"] = result->table_id;
+    labels["table_name"] = FindWithDefault(attributes_, "table_name", "");
   } else if (strcmp(prototype_->name(), "server") == 0 ||
       strcmp(prototype_->name(), "cluster") == 0) {
-    prometheus_attr = attrs;
-    // This is tablet_id in the case of tablet, but otherwise names the server type, eg: yb.master
-    prometheus_attr["metric_id"] = id_;
+    labels.insert(attributes_.begin(), attributes_.end());
   } else {
-    return Status::OK();
+    return nullptr;
   }
   // This is currently tablet / server / cluster.
-  prometheus_attr["metric_type"] = prototype_->name();
-  prometheus_attr["exported_instance"] = FLAGS_metric_node_name;
+  labels["metric_type"] = prototype_->name();
+  labels["exported_instance"] = FLAGS_metric_node_name;
+  if (!result->table_id.empty()) {
+    result->table_labels = RenderPrometheusLabels(labels);
+  }
+  // This is tablet_id in the case of tablet, but otherwise names the server type, eg: yb.master
+  labels["metric_id"] = id_;
+  result->labels = RenderPrometheusLabels(labels);
 
-  for (OrderedMetricMap::value_type& val : metrics) {
-    WARN_NOT_OK(val.second->WriteForPrometheus(writer, prometheus_attr),
-                strings::Substitute("Failed to write $0 as Prometheus", val.first));
+  prometheus_labels_ = std::move(result);
+  return prometheus_labels_;
+}
 
+CHECKED_STATUS MetricEntity::WriteForPrometheus(PrometheusWriter* writer) const {
+  std::shared_ptr<const PrometheusEntityLabels> labels;
+  std::vector<scoped_refptr<Metric>> metrics;
+  std::vector<ExternalPrometheusMetricsCb> external_metrics_cbs;
+  {
+    // Snapshot the metrics, labels & external metrics callbacks in this metrics entity. (Note:
+    // this is not guaranteed to be a consistent snapshot).
+    std::lock_guard<simple_spinlock> l(lock_);
+    labels = PrometheusLabelsUnlocked();
+    if (!labels) {
+      return Status::OK();
+    }
+    metrics.reserve(metric_map_.size());
+    for (const MetricMap::value_type& val : metric_map_) {
+      metrics.push_back(val.second);
+    }
+    external_metrics_cbs = external_prometheus_metrics_cbs_;
+  }
+  // We want the metrics to be in alphabetical order when printing.
+  std::sort(metrics.begin(), metrics.end(),
+            [](const scoped_refptr<Metric>& lhs, const scoped_refptr<Metric>& rhs) {
+    return strcmp(lhs->prototype()->name(), rhs->prototype()->name()) < 0;
+  });
+
+  for (const auto& metric : metrics) {
+    WARN_NOT_OK(metric->WriteForPrometheus(writer, *labels),
+                strings::Substitute("Failed to write $0 as Prometheus",
+                                    metric->prototype()->name()));
   }
   // Run the external metrics collection callback if there is one set.
   for (const ExternalPrometheusMetricsCb& cb : external_metrics_cbs) {
-    cb(writer);
+    cb(writer, *labels);
   }
 
   return Status::OK();
@@ -381,11 +451,106 @@ void MetricEntity::NeverRetire(const scoped_refptr<Metric>& metric) {
 void MetricEntity::SetAttributes(const AttributeMap& attrs) {
   std::lock_guard<simple_spinlock> l(lock_);
   attributes_ = attrs;
+  prometheus_labels_.reset();
 }
 
 void MetricEntity::SetAttribute(const string& key, const string& val) {
   std::lock_guard<simple_spinlock> l(lock_);
   attributes_[key] = val;
+  prometheus_labels_.reset();
+}
+
+//
+// PrometheusWriter
+//
+
+struct PrometheusWriter::TableValues {
+  struct Value {
+    const char* name;
+    const char* suffix;
+    double value;
+  };
+
+  struct KeyHash {
+    size_t operator()(const std::pair<const char*, const char*>& key) const {
+      return std::hash<const char*>()(key.first) * 31 + std::hash<const char*>()(key.second);
+    }
+  };
+
+  std::string labels;
+  // Values in the order they were first written.
+  std::vector<Value> values;
+  // Index in values by metric name and suffix. Metrics are identified by their name pointers,
+  // which come from the metric prototypes and are the same for all tablets.
+  std::unordered_map<std::pair<const char*, const char*>, size_t, KeyHash> index;
+};
+
+PrometheusWriter::PrometheusWriter(std::stringstream* output, PrometheusAggregation aggregation)
+    : output_(output),
+      aggregation_(aggregation) {
+  const int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  timestamp_size_ = FastInt64ToBufferLeft(timestamp, timestamp_) - timestamp_;
+}
+
+PrometheusWriter::~PrometheusWriter() {
+}
+
+Status PrometheusWriter::WriteSingleEntry(
+    const PrometheusEntityLabels& labels, const char* name, const char* suffix, double value) {
+  if (aggregation_ == PrometheusAggregation::kTable && !labels.table_id.empty()) {
+    // For tablet level metrics, we roll up on the table level.
+    auto& table = per_table_values_[labels.table_id];
+    if (!table) {
+      table.reset(new TableValues);
+      table->labels = labels.table_labels;
+    }
+    auto key = std::make_pair(name, suffix);
+    auto it = table->index.find(key);
+    if (it == table->index.end()) {
+      table->index.emplace(key, table->values.size());
+      table->values.push_back(TableValues::Value{name, suffix, value});
+    } else {
+      table->values[it->second].value += value;
+    }
+  } else {
+    FlushSingleEntry(labels.labels, name, suffix, value);
+  }
+  return Status::OK();
+}
+
+Status PrometheusWriter::FlushAggregatedValues() {
+  for (const auto& entry : per_table_values_) {
+    const auto& table = *entry.second;
+    for (const auto& value : table.values) {
+      FlushSingleEntry(table.labels, value.name, value.suffix, value.value);
+    }
+  }
+  per_table_values_.clear();
+  return Status::OK();
+}
+
+void PrometheusWriter::FlushSingleEntry(
+    const std::string& labels, const char* name, const char* suffix, double value) {
+  // Counters and most gauges are integral, print them without going through the double formatting.
+  constexpr double kMaxExactInteger = 9007199254740992.0; // 2^53
+  char buffer[kFastToBufferSize];
+  const char* value_end;
+  if (std::abs(value) < kMaxExactInteger && value == std::trunc(value)) {
+    value_end = FastInt64ToBufferLeft(static_cast<int64_t>(value), buffer);
+  } else {
+    DoubleToBuffer(value, buffer);
+    value_end = buffer + strlen(buffer);
+  }
+
+  output_->write(name, strlen(name));
+  output_->write(suffix, strlen(suffix));
+  output_->write(labels.data(), labels.size());
+  output_->put(' ');
+  output_->write(buffer, value_end - buffer);
+  output_->put(' ');
+  output_->write(timestamp_, timestamp_size_);
+  output_->put('\n');
 }
 
 //
@@ -631,9 +796,8 @@ void StringGauge::WriteValue(JsonWriter* writer) const {
 }
 
 CHECKED_STATUS StringGauge::WriteForPrometheus(
-    PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const {
+    PrometheusWriter* writer, const PrometheusEntityLabels& labels) const {
   // TODO(bogdan): don't think we need this?
-  // return writer->WriteSingleEntry(attr, prototype_->name(), value());
   return Status::OK();
 }
 
@@ -675,8 +839,8 @@ Status Counter::WriteAsJson(JsonWriter* writer,
 }
 
 CHECKED_STATUS Counter::WriteForPrometheus(
-    PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const {
-  return writer->WriteSingleEntry(attr, prototype_->name(), value());
+    PrometheusWriter* writer, const PrometheusEntityLabels& labels) const {
+  return writer->WriteSingleEntry(labels, prototype_->name(), value());
 }
 
 
@@ -709,15 +873,65 @@ scoped_refptr<Histogram> HistogramPrototype::Instantiate(
 
 Histogram::Histogram(const HistogramPrototype* proto)
   : Metric(proto),
-    histogram_(new HdrHistogram(proto->max_trackable_value(), proto->num_sig_digits())) {
+    histogram_(new HdrHistogram(proto->max_trackable_value(), proto->num_sig_digits())),
+    num_shards_((proto->flags() & SHARDED_HISTOGRAM)
+                    ? std::max(1, std::min(base::MaxCPUIndex() + 1, FLAGS_max_histogram_shards))
+                    : 1) {
+  if (num_shards_ > 1) {
+    shards_.reset(new std::atomic<HdrHistogram*>[num_shards_]);
+    for (int i = 0; i < num_shards_; ++i) {
+      shards_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+}
+
+Histogram::~Histogram() {
+  for (int i = 1; i < num_shards_; ++i) {
+    delete shards_[i].load(std::memory_order_relaxed);
+  }
+}
+
+HdrHistogram* Histogram::Shard() {
+  if (num_shards_ == 1) {
+    return histogram_.get();
+  }
+#if defined(__APPLE__)
+  // OSX doesn't have a way to get the CPU, so we pick one by thread.
+  int index = std::hash<std::thread::id>()(std::this_thread::get_id()) % num_shards_;
+#else
+  int index = sched_getcpu() % num_shards_;
+#endif  // defined(__APPLE__)
+  if (index <= 0) {
+    return histogram_.get();
+  }
+  HdrHistogram* shard = shards_[index].load(std::memory_order_acquire);
+  if (PREDICT_FALSE(shard == nullptr)) {
+    std::unique_ptr<HdrHistogram> new_shard(
+        new HdrHistogram(histogram_->highest_trackable_value(),
+                         histogram_->num_significant_digits()));
+    if (shards_[index].compare_exchange_strong(
+            shard, new_shard.get(), std::memory_order_acq_rel)) {
+      shard = new_shard.release();
+    }
+  }
+  return shard;
+}
+
+void Histogram::MergeShardsInto(HdrHistogram* snapshot) const {
+  for (int i = 1; i < num_shards_; ++i) {
+    const HdrHistogram* shard = shards_[i].load(std::memory_order_acquire);
+    if (shard != nullptr) {
+      snapshot->MergeFrom(*shard);
+    }
+  }
 }
 
 void Histogram::Increment(int64_t value) {
-  histogram_->Increment(value);
+  Shard()->Increment(value);
 }
 
 void Histogram::IncrementBy(int64_t value, int64_t amount) {
-  histogram_->IncrementBy(value, amount);
+  Shard()->IncrementBy(value, amount);
 }
 
 Status Histogram::WriteAsJson(JsonWriter* writer,
@@ -730,16 +944,15 @@ Status Histogram::WriteAsJson(JsonWriter* writer,
 }
 
 CHECKED_STATUS Histogram::WriteForPrometheus(
-    PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const {
+    PrometheusWriter* writer, const PrometheusEntityLabels& labels) const {
   HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
 
   // Representing the sum and count require suffixed names.
-  std::string hist_name = prototype_->name();
-  auto copy_of_attr = attr;
   RETURN_NOT_OK(writer->WriteSingleEntry(
-        copy_of_attr, hist_name + "_sum", snapshot.TotalSum()));
+        labels, prototype_->name(), "_sum", snapshot.TotalSum()));
   RETURN_NOT_OK(writer->WriteSingleEntry(
-        copy_of_attr, hist_name + "_count", snapshot.TotalCount()));
+        labels, prototype_->name(), "_count", snapshot.TotalCount()));
   /*
   // Copy the label map to add the quatiles.
   copy_of_attr["quantile"] = "0.75";
@@ -765,6 +978,7 @@ CHECKED_STATUS Histogram::WriteForPrometheus(
 Status Histogram::GetHistogramSnapshotPB(HistogramSnapshotPB* snapshot_pb,
                                          const MetricJsonOptions& opts) const {
   HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
   snapshot_pb->set_name(prototype_->name());
   if (opts.include_schema_info) {
     snapshot_pb->set_type(MetricType::Name(prototype_->type()));
@@ -798,22 +1012,47 @@ Status Histogram::GetHistogramSnapshotPB(HistogramSnapshotPB* snapshot_pb,
 }
 
 uint64_t Histogram::CountInBucketForValueForTests(uint64_t value) const {
-  return histogram_->CountInBucketForValue(value);
+  HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
+  return snapshot.CountInBucketForValue(value);
 }
 
 uint64_t Histogram::TotalCount() const {
-  return histogram_->TotalCount();
+  uint64_t result = histogram_->TotalCount();
+  for (int i = 1; i < num_shards_; ++i) {
+    const HdrHistogram* shard = shards_[i].load(std::memory_order_acquire);
+    if (shard != nullptr) {
+      result += shard->TotalCount();
+    }
+  }
+  return result;
+}
+
+uint64_t Histogram::ValueAtPercentile(double percentile) const {
+  if (num_shards_ == 1) {
+    return histogram_->ValueAtPercentile(percentile);
+  }
+  HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
+  return snapshot.ValueAtPercentile(percentile);
 }
 
 uint64_t Histogram::MinValueForTests() const {
-  return histogram_->MinValue();
+  HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
+  return snapshot.MinValue();
 }
 
 uint64_t Histogram::MaxValueForTests() const {
-  return histogram_->MaxValue();
+  HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
+  return snapshot.MaxValue();
 }
+
 double Histogram::MeanValueForTests() const {
-  return histogram_->MeanValue();
+  HdrHistogram snapshot(*histogram_);
+  MergeShardsInto(&snapshot);
+  return snapshot.MeanValue();
 }
 
 ScopedLatencyMetric::ScopedLatencyMetric(Histogram* latency_hist)
@@ -239,6 +239,8 @@
 /////////////////////////////////////////////////////
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <sstream>
@@ -303,13 +305,14 @@
 #define METRIC_DEFINE_gauge_double(entity, name, label, unit, desc, ...) \
     METRIC_DEFINE_gauge(double, entity, name, label, unit, desc, ## __VA_ARGS__)
 
-#define METRIC_DEFINE_histogram(entity, name, label, unit, desc, max_val, num_sig_digits) \
+#define METRIC_DEFINE_histogram(entity, name, label, unit, desc, max_val, num_sig_digits, ...) \
   ::yb::HistogramPrototype BOOST_PP_CAT(METRIC_, name)(                                   \
       ::yb::MetricPrototype::CtorArgs(BOOST_PP_STRINGIZE(entity), \
                                       BOOST_PP_STRINGIZE(name), \
                                       label, \
                                       unit, \
-                                      desc), \
+                                      desc, \
+                                      ## __VA_ARGS__), \
       max_val, \
       num_sig_digits)
 
@@ -371,6 +374,7 @@ class HistogramSnapshotPB;
 
 class MetricEntity;
 class PrometheusWriter;
+struct PrometheusEntityLabels;
 } // namespace yb
 
 // Forward-declare the generic 'server' entity type.
@@ -473,7 +477,7 @@ class MetricEntity : public RefCountedThreadSafe<MetricEntity> {
   typedef std::unordered_map<std::string, std::string> AttributeMap;
   typedef std::function<void (JsonWriter* writer, const MetricJsonOptions& opts)>
     ExternalJsonMetricsCb;
-  typedef std::function<void (PrometheusWriter* writer)>
+  typedef std::function<void (PrometheusWriter* writer, const PrometheusEntityLabels& labels)>
     ExternalPrometheusMetricsCb;
 
   scoped_refptr<Counter> FindOrCreateCounter(const CounterPrototype* proto);
@@ -549,6 +553,10 @@ class MetricEntity : public RefCountedThreadSafe<MetricEntity> {
   // type defined within the metric prototype.
   void CheckInstantiation(const MetricPrototype* proto) const;
 
+  // Returns the Prometheus labels of this entity, rendering them if attributes changed. Returns
+  // nullptr for entities whose metrics are not exported to Prometheus. Requires lock_.
+  std::shared_ptr<const PrometheusEntityLabels> PrometheusLabelsUnlocked() const;
+
   const MetricEntityPrototype* const prototype_;
   const std::string id_;
 
@@ -560,6 +568,9 @@ class MetricEntity : public RefCountedThreadSafe<MetricEntity> {
   // The key/value attributes. Protected by lock_
   AttributeMap attributes_;
 
+  // Prometheus labels rendered from attributes_, reset when they change. Protected by lock_.
+  mutable std::shared_ptr<const PrometheusEntityLabels> prometheus_labels_;
+
   // The set of metrics which should never be retired. Protected by lock_.
   std::vector<scoped_refptr<Metric> > never_retire_metrics_;
 
@@ -572,76 +583,66 @@ class MetricEntity : public RefCountedThreadSafe<MetricEntity> {
 
 typedef scoped_refptr<MetricEntity> MetricEntityPtr;
 
+// How metrics of tablets are exported to Prometheus.
+enum class PrometheusAggregation {
+  // Values of a metric are summed up over the tablets of each table.
+  kTable,
+  // Each tablet is exported separately, labeled with its id.
+  kTablet,
+};
+
+// Prometheus labels of the metrics of an entity. Rendered once when the attributes of the entity
+// change, instead of for every metric on every scrape.
+struct PrometheusEntityLabels {
+  // Labels of the metrics when they are exported as is, e.g. {metric_id="yb.tabletserver",...}.
+  std::string labels;
+
+  // Id of the table that metrics of a tablet are summed up into, empty for other entities.
+  std::string table_id;
+
+  // Labels of the metrics summed up into the table.
+  std::string table_labels;
+};
+
+// Streams metrics in the Prometheus text exposition format directly into the output.
+//
+// Tablet metrics summed up per table are kept in the writer until FlushAggregatedValues(). Metric
+// names are only referenced, not copied, so they should outlive the writer.
 class PrometheusWriter {
  public:
-  explicit PrometheusWriter(std::stringstream* output)
-    : output_(output),
-      timestamp_(std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::system_clock::now().time_since_epoch()).count()) {}
+  explicit PrometheusWriter(std::stringstream* output,
+                            PrometheusAggregation aggregation = PrometheusAggregation::kTable);
 
-  template<typename T>
+  ~PrometheusWriter();
+
+  // Writes a value of the metric named name + suffix of the entity with the specified labels.
   CHECKED_STATUS WriteSingleEntry(
-      const MetricEntity::AttributeMap& attr, const std::string& name, const T& value) {
-    auto it = attr.find("table_id");
-    if (it != attr.end()) {
-      // For tablet level metrics, we roll up on the table level.
-      if (per_table_attributes_.find(it->second) == per_table_attributes_.end()) {
-        // If it's the first time we see this table, create the aggregate structures.
-        per_table_attributes_[it->second] = attr;
-        per_table_values_[it->second];
-      } else {
-        per_table_values_[it->second][name] += value;
-      }
-    } else {
-      // For non-tablet level metrics, export them directly.
-      RETURN_NOT_OK(FlushSingleEntry(attr, name, value));
-    }
-    return Status::OK();
-  }
+      const PrometheusEntityLabels& labels, const char* name, const char* suffix, double value);
 
-  CHECKED_STATUS FlushAggregatedValues() {
-    for (const auto& entry : per_table_values_) {
-      const auto& attrs = per_table_attributes_[entry.first];
-      for (const auto& metric_entry : entry.second) {
-        RETURN_NOT_OK(FlushSingleEntry(attrs, metric_entry.first, metric_entry.second));
-      }
-    }
-    return Status::OK();
+  CHECKED_STATUS WriteSingleEntry(
+      const PrometheusEntityLabels& labels, const char* name, double value) {
+    return WriteSingleEntry(labels, name, "", value);
   }
 
+  // Writes the values summed up per table.
+  CHECKED_STATUS FlushAggregatedValues();
+
  private:
-  template<typename T>
-  CHECKED_STATUS FlushSingleEntry(
-      const MetricEntity::AttributeMap& attr, const std::string& name, const T& value) {
-    *output_ << name;
-    size_t total_elements = attr.size();
-    if (total_elements > 0) {
-      *output_ << "{";
-      for (const auto& entry : attr) {
-        *output_ << entry.first << "=\"" << entry.second << "\"";
-        if (--total_elements > 0) {
-          *output_ << ",";
-        }
-      }
-      *output_ << "}";
-    }
-    *output_ << " " << value;
-    *output_ << " " << timestamp_;
-    *output_ << std::endl;
-    return Status::OK();
-  }
+  struct TableValues;
 
-  // Map from table_id to attributes
-  std::map<std::string, MetricEntity::AttributeMap> per_table_attributes_;
-  // Map from table_id to map of metric_name to value
-  std::map<std::string, std::map<std::string, double>> per_table_values_;
-  // Output stream
-  std::stringstream* output_;
-  // Timestamp for all metrics belonging to this writer instance.
-  int64_t timestamp_;
-};
+  void FlushSingleEntry(const std::string& labels, const char* name, const char* suffix,
+                        double value);
 
+  std::stringstream* const output_;
+  const PrometheusAggregation aggregation_;
 
+  // Values summed up per table, by table id.
+  std::unordered_map<std::string, std::unique_ptr<TableValues>> per_table_values_;
+
+  // Timestamp for all metrics belonging to this writer instance, rendered once.
+  char timestamp_[32];
+  size_t timestamp_size_;
+};
 
 // Base class to allow for putting all metrics into a single container.
 // See documentation at the top of this file for information on metrics ownership.
@@ -652,7 +653,7 @@ class Metric : public RefCountedThreadSafe<Metric> {
                              const MetricJsonOptions& opts) const = 0;
 
   virtual CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const = 0;
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const = 0;
 
   const MetricPrototype* prototype() const { return prototype_; }
 
@@ -768,7 +769,13 @@ class MetricPrototypeRegistry {
 enum PrototypeFlags {
   // Flag which causes a Gauge prototype to expose itself as if it
   // were a counter.
-  EXPOSE_AS_COUNTER = 1 << 0
+  EXPOSE_AS_COUNTER = 1 << 0,
+
+  // Flag which causes a Histogram to record values into a shard per CPU, so that threads running
+  // on different CPUs do not contend on the same cache lines. The shards are merged on read. Each
+  // shard is allocated when a CPU first records a value, so it is meant for server-wide histograms
+  // updated on every request, not for the ones instantiated per tablet.
+  SHARDED_HISTOGRAM = 1 << 1
 };
 
 class MetricPrototype {
@@ -803,6 +810,7 @@ class MetricPrototype {
   const char* label() const { return args_.label_; }
   MetricUnit::Type unit() const { return args_.unit_; }
   const char* description() const { return args_.description_; }
+  uint32_t flags() const { return args_.flags_; }
   virtual MetricType::Type type() const = 0;
 
   // Writes the fields of this prototype to the given JSON writer.
@@ -878,7 +886,7 @@ class StringGauge : public Gauge {
   void set_value(const std::string& value);
 
   CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const override;
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const override;
  protected:
   virtual void WriteValue(JsonWriter* writer) const override;
  private:
@@ -915,8 +923,8 @@ class AtomicGauge : public Gauge {
   }
 
   CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const override {
-    return writer->WriteSingleEntry(attr, prototype_->name(), value());
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const override {
+    return writer->WriteSingleEntry(labels, prototype_->name(), value());
   }
 
  protected:
@@ -1035,8 +1043,8 @@ class FunctionGauge : public Gauge {
   }
 
   CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const override {
-    return writer->WriteSingleEntry(attr, prototype_->name(), value());
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const override {
+    return writer->WriteSingleEntry(labels, prototype_->name(), value());
   }
 
  private:
@@ -1083,7 +1091,7 @@ class Counter : public Metric {
                              const MetricJsonOptions& opts) const override;
 
   CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const override;
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const override;
 
  private:
   FRIEND_TEST(MetricsTest, SimpleCounterTest);
@@ -1126,11 +1134,14 @@ class Histogram : public Metric {
   // or IncrementBy()).
   uint64_t TotalCount() const;
 
+  // Return the value at the given percentile of the values added to the histogram.
+  uint64_t ValueAtPercentile(double percentile) const;
+
   virtual CHECKED_STATUS WriteAsJson(JsonWriter* w,
                              const MetricJsonOptions& opts) const override;
 
   CHECKED_STATUS WriteForPrometheus(
-      PrometheusWriter* writer, const MetricEntity::AttributeMap& attr) const override;
+      PrometheusWriter* writer, const PrometheusEntityLabels& labels) const override;
 
   // Returns a snapshot of this histogram including the bucketed values and counts.
   CHECKED_STATUS GetHistogramSnapshotPB(HistogramSnapshotPB* snapshot,
@@ -1141,12 +1152,29 @@ class Histogram : public Metric {
   uint64_t MaxValueForTests() const;
   double MeanValueForTests() const;
 
+  ~Histogram();
+
  private:
   FRIEND_TEST(MetricsTest, SimpleHistogramTest);
+  FRIEND_TEST(MetricsTest, ShardedHistogramTest);
   friend class MetricEntity;
   explicit Histogram(const HistogramPrototype* proto);
 
+  // Returns the shard to record values into from the current CPU, allocating it if needed.
+  HdrHistogram* Shard();
+
+  // Copies the values recorded by all the shards into snapshot, which must be a copy of
+  // histogram_.
+  void MergeShardsInto(HdrHistogram* snapshot) const;
+
+  // The only shard of a regular histogram, and the first one of a sharded histogram.
   const gscoped_ptr<HdrHistogram> histogram_;
+
+  // The other shards of a sharded histogram, indexed by CPU modulo the number of shards, nullptr
+  // until used.
+  const int num_shards_;
+  std::unique_ptr<std::atomic<HdrHistogram*>[]> shards_;
+
   DISALLOW_COPY_AND_ASSIGN(Histogram);
 };
 
@@ -0,0 +1,95 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/mpsc_queue.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+class MPSCQueueTest : public YBTest {
+};
+
+TEST_F(MPSCQueueTest, Simple) {
+  MPSCQueue<int> queue;
+  ASSERT_TRUE(queue.empty());
+  ASSERT_TRUE(queue.Push(1));
+  ASSERT_FALSE(queue.Push(2));
+  ASSERT_FALSE(queue.Push(3));
+  ASSERT_FALSE(queue.empty());
+
+  std::vector<int> out = {0};
+  queue.Drain(&out);
+  ASSERT_EQ((std::vector<int>{0, 1, 2, 3}), out);
+  ASSERT_TRUE(queue.empty());
+
+  queue.Drain(&out);
+  ASSERT_EQ(4U, out.size());
+  ASSERT_TRUE(queue.Push(4));
+}
+
+TEST_F(MPSCQueueTest, Concurrent) {
+  constexpr int kProducers = 4;
+  constexpr int kValuesPerProducer = 100000;
+
+  MPSCQueue<std::unique_ptr<int>> queue;
+  std::atomic<int> wakeups(0);
+  std::atomic<int> running(kProducers);
+  std::vector<std::thread> producers;
+  for (int i = 0; i != kProducers; ++i) {
+    producers.emplace_back([&queue, &wakeups, &running, i] {
+      for (int j = 0; j != kValuesPerProducer; ++j) {
+        if (queue.Push(std::make_unique<int>(i * kValuesPerProducer + j))) {
+          ++wakeups;
+        }
+      }
+      --running;
+    });
+  }
+
+  std::vector<std::unique_ptr<int>> values;
+  std::vector<int> last(kProducers, -1);
+  size_t drains = 0;
+  for (;;) {
+    bool done = running.load() == 0;
+    size_t start = values.size();
+    queue.Drain(&values);
+    if (values.size() != start) {
+      ++drains;
+    }
+    // Values of each producer should be taken in push order.
+    for (size_t i = start; i != values.size(); ++i) {
+      int producer = *values[i] / kValuesPerProducer;
+      ASSERT_LT(last[producer], *values[i]);
+      last[producer] = *values[i];
+    }
+    if (done && queue.empty()) {
+      break;
+    }
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+
+  ASSERT_EQ(static_cast<size_t>(kProducers * kValuesPerProducer), values.size());
+  // Each non empty drain is preceded by exactly one push that observed an empty queue.
+  ASSERT_EQ(drains, static_cast<size_t>(wakeups.load()));
+}
+
+} // namespace yb
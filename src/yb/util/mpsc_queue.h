@@ -0,0 +1,98 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_MPSC_QUEUE_H
+#define YB_UTIL_MPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+
+namespace yb {
+
+// Lock-free unbounded queue, that supports pushing values from multiple threads and taking all
+// pushed values at once.
+//
+// Push reports whether the queue was empty, so a producer could wake up the consumer only when
+// the queue transitions from empty, and each batch of values costs a single wake up.
+//
+// Values are kept in a linked list, that is pushed to using CAS and taken using exchange, so
+// there is no ABA problem. Drain could be safely invoked by multiple threads, but values pushed
+// concurrently with a drain are not guaranteed to be taken by it.
+template <class T>
+class MPSCQueue {
+ public:
+  MPSCQueue() {}
+
+  ~MPSCQueue() {
+    DeleteList(head_.exchange(nullptr, std::memory_order_acquire));
+  }
+
+  // Returns true if the queue was empty before this push.
+  bool Push(T value) {
+    Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(
+        node->next, node, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+    return node->next == nullptr;
+  }
+
+  // Appends all values from the queue to out, in the order they were pushed.
+  void Drain(std::vector<T>* out) {
+    Node* head = head_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!head) {
+      return;
+    }
+    // The list is in reverse push order.
+    size_t size = 0;
+    for (Node* node = head; node; node = node->next) {
+      ++size;
+    }
+    const size_t start = out->size();
+    out->resize(start + size);
+    size_t idx = start + size;
+    while (head) {
+      (*out)[--idx] = std::move(head->value);
+      Node* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    T value;
+    Node* next;
+  };
+
+  static void DeleteList(Node* head) {
+    while (head) {
+      Node* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+
+  std::atomic<Node*> head_{nullptr};
+
+  DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_MPSC_QUEUE_H
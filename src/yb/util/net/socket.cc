@@ -54,6 +54,7 @@
 #include "yb/util/monotime.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/net/sockaddr.h"
+#include "yb/util/net/tls.h"
 #include "yb/util/random.h"
 #include "yb/util/random_util.h"
 #include "yb/util/subprocess.h"
@@ -86,6 +87,7 @@ void Socket::Reset(int fd) {
 }
 
 int Socket::Release() {
+  tls_.reset();
   int fd = fd_;
   fd_ = -1;
   return fd;
@@ -99,6 +101,7 @@ Socket::~Socket() {
 }
 
 Status Socket::Close() {
+  tls_.reset();
   if (fd_ < 0)
     return Status::OK();
   int err, fd = fd_;
@@ -422,6 +425,10 @@ Status Socket::Write(const uint8_t *buf, int32_t amt, int32_t *nwritten) {
                            amt), Slice(), EINVAL);
   }
   DCHECK_GE(fd_, 0);
+  if (tls_) {
+    struct ::iovec iov = { const_cast<uint8_t*>(buf), static_cast<size_t>(amt) };
+    return tls_->Writev(&iov, 1, nwritten);
+  }
   int res = ::send(fd_, buf, amt, MSG_NOSIGNAL);
   if (res < 0) {
     int err = errno;
@@ -441,6 +448,9 @@ Status Socket::Writev(const struct ::iovec *iov, int iov_len,
                 Slice(), EINVAL);
   }
   DCHECK_GE(fd_, 0);
+  if (tls_) {
+    return tls_->Writev(iov, iov_len, nwritten);
+  }
 
   struct msghdr msg;
   memset(&msg, 0, sizeof(struct msghdr));
@@ -506,6 +516,10 @@ Status Socket::Recv(uint8_t *buf, int32_t amt, int32_t *nread) {
           StringPrintf("invalid recv of %d bytes", amt), Slice(), EINVAL);
   }
 
+  if (tls_) {
+    return tls_->Recv(buf, amt, nread);
+  }
+
   // The recv() call can return fewer than the requested number of bytes.
   // Especially when 'amt' is small, this is very unlikely to happen in
   // the context of unit tests. So, we provide an injection hook which
@@ -586,6 +600,12 @@ Status Socket::BlockingRecv(uint8_t *buf, size_t amt, size_t *nread, const MonoT
   return Status::OK();
 }
 
+Status Socket::StartTls(TlsContext* context, bool server, const std::string& peer,
+                        const MonoTime& deadline) {
+  DCHECK(!tls_);
+  return context->Handshake(this, server, peer, deadline, &tls_);
+}
+
 Status Socket::SetTimeout(int opt, std::string optname, const MonoDelta& timeout) {
   if (PREDICT_FALSE(timeout.ToNanoseconds() < 0)) {
     return STATUS(InvalidArgument, "Timeout specified as negative to SetTimeout",
@@ -33,6 +33,8 @@
 #define YB_UTIL_NET_SOCKET_H
 
 #include <sys/uio.h>
+
+#include <memory>
 #include <string>
 
 #include "yb/gutil/macros.h"
@@ -43,6 +45,8 @@ namespace yb {
 
 class MonoDelta;
 class MonoTime;
+class TlsContext;
+class TlsSession;
 
 class Socket {
  public:
@@ -52,7 +56,7 @@ class Socket {
   // Create a new invalid Socket object.
   Socket();
 
-  Socket(Socket&& rhs) noexcept : fd_(rhs.fd_) { rhs.Release(); }
+  Socket(Socket&& rhs) noexcept : fd_(rhs.fd_), tls_(std::move(rhs.tls_)) { rhs.Release(); }
 
   // Start managing a socket.
   explicit Socket(int fd);
@@ -150,6 +154,15 @@ class Socket {
   // See also readn() from Stevens (2004) or Kerrisk (2010)
   CHECKED_STATUS BlockingRecv(uint8_t *buf, size_t amt, size_t *nread, const MonoTime& deadline);
 
+  // Performs the TLS handshake over the connected socket, which should be in blocking mode. Data
+  // sent and received afterwards, including by the calls above, is encrypted. peer identifies
+  // the remote server, so client sessions could be resumed on the next connection to it.
+  CHECKED_STATUS StartTls(TlsContext* context, bool server, const std::string& peer,
+                          const MonoTime& deadline);
+
+  // The TLS session of the socket, or nullptr when data is sent in the clear.
+  TlsSession* tls_session() const { return tls_.get(); }
+
  private:
   // Called internally from SetSend/RecvTimeout().
   CHECKED_STATUS SetTimeout(int opt, std::string optname, const MonoDelta& timeout);
@@ -162,6 +175,7 @@ class Socket {
   CHECKED_STATUS BindForOutgoingConnection();
 
   int fd_;
+  std::unique_ptr<TlsSession> tls_;
 
   DISALLOW_COPY_AND_ASSIGN(Socket);
 };
@@ -0,0 +1,348 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+
+#include "yb/util/net/tls.h"
+
+#include <signal.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/util/errno.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+#include "yb/util/net/socket.h"
+
+DEFINE_string(tls_certificate_file, "", "PEM file with the TLS certificate chain of this process.");
+DEFINE_string(tls_private_key_file, "", "PEM file with the TLS private key of this process.");
+DEFINE_string(tls_ca_file, "",
+              "PEM file with the certificates of trusted authorities. When set, TLS peers are "
+              "verified.");
+DEFINE_bool(tls_verify_client, false,
+            "Require clients to present a certificate signed by an authority from tls_ca_file.");
+// AES-GCM comes first, as it is accelerated by AES-NI and it is the cipher that kernel TLS
+// supports.
+DEFINE_string(tls_cipher_list, "ECDHE+AESGCM:ECDHE+CHACHA20",
+              "Ciphers allowed for TLS 1.2, in OpenSSL cipher list format.");
+DEFINE_bool(tls_enable_ktls, true,
+            "Let the kernel encrypt TLS records when both the kernel and OpenSSL support it.");
+TAG_FLAG(tls_cipher_list, advanced);
+TAG_FLAG(tls_enable_ktls, advanced);
+
+namespace yb {
+
+namespace {
+
+// Maximum amount of data in a TLS record.
+constexpr size_t kMaxRecordSize = 16384;
+
+// Returns the status for a failed call of the TLS library, with the errors it queued.
+Status TlsError(const std::string& message) {
+  std::string details;
+  while (auto code = ERR_get_error()) {
+    char buffer[256];
+    ERR_error_string_n(code, buffer, sizeof(buffer));
+    if (!details.empty()) {
+      details += "; ";
+    }
+    details += buffer;
+  }
+  return STATUS(NetworkError, message, details, EPROTO);
+}
+
+// Returns the status for a failed read or write of the session, like the socket calls would.
+Status SessionError(SSL* ssl, int rc, const std::string& message) {
+  const int err = errno;
+  switch (SSL_get_error(ssl, rc)) {
+    case SSL_ERROR_WANT_READ: FALLTHROUGH_INTENDED;
+    case SSL_ERROR_WANT_WRITE:
+      return STATUS(NetworkError, message + ErrnoToString(EAGAIN), Slice(), EAGAIN);
+    case SSL_ERROR_ZERO_RETURN:
+      return STATUS(NetworkError, "TLS session closed by remote", Slice(), ESHUTDOWN);
+    case SSL_ERROR_SYSCALL:
+      if (ERR_peek_error() == 0) {
+        if (err == 0) {
+          return STATUS(NetworkError, "Got EOF from remote", Slice(), ESHUTDOWN);
+        }
+        return STATUS(NetworkError, message + ErrnoToString(err), Slice(), err);
+      }
+      break;
+    default:
+      break;
+  }
+  return TlsError(message);
+}
+
+} // namespace
+
+TlsOptions TlsOptions::FromFlags() {
+  TlsOptions result;
+  result.certificate_file = FLAGS_tls_certificate_file;
+  result.private_key_file = FLAGS_tls_private_key_file;
+  result.ca_file = FLAGS_tls_ca_file;
+  result.verify_client = FLAGS_tls_verify_client;
+  result.cipher_list = FLAGS_tls_cipher_list;
+  result.enable_ktls = FLAGS_tls_enable_ktls;
+  return result;
+}
+
+Status TlsContext::Create(const TlsOptions& options, std::shared_ptr<TlsContext>* context) {
+  OPENSSL_init_ssl(0, nullptr);
+  // The TLS library writes to sockets without MSG_NOSIGNAL, so a write to a connection closed by
+  // the remote end would kill the process.
+  struct sigaction old_action;
+  if (sigaction(SIGPIPE, nullptr, &old_action) == 0 && old_action.sa_handler == SIG_DFL) {
+    signal(SIGPIPE, SIG_IGN);
+  }
+
+  ERR_clear_error();
+  SSL_CTX* ctx = SSL_CTX_new(TLS_method());
+  if (ctx == nullptr) {
+    return TlsError("Failed to create TLS context");
+  }
+  std::shared_ptr<TlsContext> result(
+      new TlsContext(ctx, options.verify_client && !options.ca_file.empty()));
+
+  SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+  long options_mask = SSL_OP_NO_COMPRESSION | SSL_OP_CIPHER_SERVER_PREFERENCE; // NOLINT
+#ifdef SSL_OP_ENABLE_KTLS
+  if (options.enable_ktls) {
+    options_mask |= SSL_OP_ENABLE_KTLS;
+  }
+#endif
+  SSL_CTX_set_options(ctx, options_mask);
+  // Writes return after each record, so the caller could send the rest of a large buffer later.
+  SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER |
+                        SSL_MODE_RELEASE_BUFFERS);
+  if (!options.cipher_list.empty() &&
+      SSL_CTX_set_cipher_list(ctx, options.cipher_list.c_str()) != 1) {
+    return TlsError("Invalid TLS cipher list " + options.cipher_list);
+  }
+
+  if (!options.certificate_file.empty() &&
+      SSL_CTX_use_certificate_chain_file(ctx, options.certificate_file.c_str()) != 1) {
+    return TlsError("Failed to load TLS certificate from " + options.certificate_file);
+  }
+  if (!options.private_key_file.empty()) {
+    if (SSL_CTX_use_PrivateKey_file(ctx, options.private_key_file.c_str(),
+                                    SSL_FILETYPE_PEM) != 1) {
+      return TlsError("Failed to load TLS private key from " + options.private_key_file);
+    }
+    if (SSL_CTX_check_private_key(ctx) != 1) {
+      return TlsError("TLS private key does not match the certificate");
+    }
+  }
+  if (!options.ca_file.empty()) {
+    if (SSL_CTX_load_verify_locations(ctx, options.ca_file.c_str(), nullptr) != 1) {
+      return TlsError("Failed to load TLS authorities from " + options.ca_file);
+    }
+    // Peers are addressed by IP, so the certificate chain is verified but not the host name.
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+  }
+
+  // Servers issue session tickets, and remember sessions for clients that do not support them.
+  // Clients keep the sessions themselves, see NewSessionCallback.
+  static const unsigned char kSessionIdContext[] = "yb";
+  SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_BOTH);
+  SSL_CTX_sess_set_new_cb(ctx, &TlsContext::NewSessionCallback);
+
+  *context = std::move(result);
+  return Status::OK();
+}
+
+TlsContext::TlsContext(SSL_CTX* ctx, bool verify_client)
+    : ctx_(ctx), verify_client_(verify_client) {
+}
+
+TlsContext::~TlsContext() {
+  for (const auto& entry : client_sessions_) {
+    SSL_SESSION_free(entry.second);
+  }
+  SSL_CTX_free(ctx_);
+}
+
+int TlsContext::NewSessionCallback(SSL* ssl, SSL_SESSION* session) {
+  if (SSL_is_server(ssl)) {
+    return 0;
+  }
+  auto* tls_session = static_cast<TlsSession*>(SSL_get_app_data(ssl));
+  auto* context = tls_session->context_.get();
+  SSL_SESSION* old_session = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(context->mutex_);
+    auto& entry = context->client_sessions_[tls_session->peer_];
+    old_session = entry;
+    entry = session;
+  }
+  if (old_session != nullptr) {
+    SSL_SESSION_free(old_session);
+  }
+  // Returning 1 keeps the reference to the session.
+  return 1;
+}
+
+Status TlsContext::Handshake(Socket* socket, bool server, const std::string& peer,
+                             const MonoTime& deadline, std::unique_ptr<TlsSession>* session) {
+  ERR_clear_error();
+  SSL* ssl = SSL_new(ctx_);
+  if (ssl == nullptr) {
+    return TlsError("Failed to create TLS session");
+  }
+  std::unique_ptr<TlsSession> result(new TlsSession(shared_from_this(), ssl, peer));
+  SSL_set_app_data(ssl, result.get());
+  if (SSL_set_fd(ssl, socket->GetFd()) != 1) {
+    return TlsError("Failed to attach TLS session to socket");
+  }
+  if (server) {
+    if (verify_client_) {
+      SSL_set_verify(ssl, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+    } else {
+      SSL_set_verify(ssl, SSL_VERIFY_NONE, nullptr);
+    }
+    SSL_set_accept_state(ssl);
+  } else {
+    SSL_set_connect_state(ssl);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = client_sessions_.find(peer);
+    if (it != client_sessions_.end()) {
+      SSL_set_session(ssl, it->second);
+    }
+  }
+
+  for (;;) {
+    const MonoDelta timeout = deadline.GetDeltaSince(MonoTime::Now(MonoTime::FINE));
+    if (PREDICT_FALSE(timeout.ToNanoseconds() <= 0)) {
+      return STATUS(TimedOut, "TLS handshake timed out");
+    }
+    RETURN_NOT_OK(socket->SetRecvTimeout(timeout));
+    RETURN_NOT_OK(socket->SetSendTimeout(timeout));
+    ERR_clear_error();
+    errno = 0;
+    const int rc = SSL_do_handshake(ssl);
+    if (rc == 1) {
+      break;
+    }
+    // The socket timeout expired or the call was interrupted, the deadline is checked above.
+    auto status = SessionError(ssl, rc, "TLS handshake failed: ");
+    if (!Socket::IsTemporarySocketError(status)) {
+      return status;
+    }
+  }
+
+  if (SSL_session_reused(ssl)) {
+    ++num_resumed_handshakes_;
+  } else {
+    ++num_full_handshakes_;
+  }
+  VLOG(2) << "TLS handshake with " << peer << " completed, version: " << SSL_get_version(ssl)
+          << ", cipher: " << SSL_get_cipher_name(ssl) << ", resumed: " << result->resumed()
+          << ", kernel TLS: " << result->ktls_send();
+  *session = std::move(result);
+  return Status::OK();
+}
+
+TlsSession::TlsSession(std::shared_ptr<TlsContext> context, SSL* ssl, std::string peer)
+    : context_(std::move(context)), ssl_(ssl), peer_(std::move(peer)) {
+}
+
+TlsSession::~TlsSession() {
+  SSL_free(ssl_);
+}
+
+bool TlsSession::ktls_send() const {
+#ifdef BIO_get_ktls_send
+  return BIO_get_ktls_send(SSL_get_wbio(ssl_));
+#else
+  return false;
+#endif
+}
+
+bool TlsSession::resumed() const {
+  return SSL_session_reused(ssl_);
+}
+
+Status TlsSession::Recv(uint8_t* buf, int32_t amt, int32_t* nread) {
+  // Decrypted data could stay buffered in the session while the socket has nothing to read, so
+  // we read until the session runs out of data rather than stop after a single record.
+  *nread = 0;
+  while (*nread < amt) {
+    ERR_clear_error();
+    errno = 0;
+    const int rc = SSL_read(ssl_, buf + *nread, amt - *nread);
+    if (rc <= 0) {
+      // Errors after some data was read are returned by the next call.
+      return *nread > 0 ? Status::OK() : SessionError(ssl_, rc, "recv error: ");
+    }
+    *nread += rc;
+  }
+  return Status::OK();
+}
+
+Status TlsSession::Write(const uint8_t* buf, size_t amt, int32_t* nwritten) {
+  ERR_clear_error();
+  errno = 0;
+  const int rc = SSL_write(ssl_, buf, static_cast<int>(amt));
+  if (rc <= 0) {
+    *nwritten = 0;
+    return SessionError(ssl_, rc, "write error: ");
+  }
+  *nwritten = rc;
+  return Status::OK();
+}
+
+Status TlsSession::Writev(const struct ::iovec* iov, int iov_len, int32_t* nwritten) {
+  *nwritten = 0;
+  int index = 0;
+  while (index < iov_len) {
+    const uint8_t* data;
+    size_t size;
+    int next = index;
+    if (iov[index].iov_len >= kMaxRecordSize) {
+      data = static_cast<const uint8_t*>(iov[index].iov_base);
+      size = iov[index].iov_len;
+      ++next;
+    } else {
+      // The same buffers are coalesced again when the write is retried, so the session gets the
+      // data it has encrypted already.
+      coalesce_buffer_.clear();
+      while (next < iov_len && iov[next].iov_len < kMaxRecordSize &&
+             coalesce_buffer_.size() + iov[next].iov_len <= kMaxRecordSize) {
+        coalesce_buffer_.append(static_cast<const char*>(iov[next].iov_base), iov[next].iov_len);
+        ++next;
+      }
+      data = reinterpret_cast<const uint8_t*>(coalesce_buffer_.data());
+      size = coalesce_buffer_.size();
+    }
+
+    size_t offset = 0;
+    while (offset < size) {
+      int32_t written = 0;
+      auto status = Write(data + offset, size - offset, &written);
+      if (!status.ok()) {
+        // Errors after some data was written are returned by the next call.
+        return *nwritten > 0 ? Status::OK() : status;
+      }
+      offset += written;
+      *nwritten += written;
+    }
+    index = next;
+  }
+  return Status::OK();
+}
+
+} // namespace yb
@@ -0,0 +1,136 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+
+#ifndef YB_UTIL_NET_TLS_H
+#define YB_UTIL_NET_TLS_H
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/status.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+namespace yb {
+
+class MonoTime;
+class Socket;
+class TlsSession;
+
+struct TlsOptions {
+  // PEM files with the certificate chain and the private key of this process.
+  std::string certificate_file;
+  std::string private_key_file;
+
+  // PEM file with the certificates of trusted authorities. When set, the certificates of the
+  // servers are verified, and the certificates of the clients too if verify_client is set.
+  std::string ca_file;
+  bool verify_client = false;
+
+  // Ciphers allowed for TLS 1.2. TLS 1.3 always uses AES-GCM or ChaCha20-Poly1305.
+  std::string cipher_list;
+
+  // Let the kernel encrypt the records when it supports that, so data is sent without copying it
+  // through the TLS library.
+  bool enable_ktls = true;
+
+  // Options from the rpc_tls_* flags.
+  static TlsOptions FromFlags();
+};
+
+// TLS configuration shared by all connections of a messenger.
+//
+// Full handshakes are expensive, so both sides support session resumption. Servers issue session
+// tickets, and clients keep the latest session of each server they connected to and resume it on
+// the next connection to the same server.
+class TlsContext : public std::enable_shared_from_this<TlsContext> {
+ public:
+  static CHECKED_STATUS Create(const TlsOptions& options, std::shared_ptr<TlsContext>* context);
+
+  ~TlsContext();
+
+  // Performs the handshake over the connected blocking socket, which should stay open until the
+  // session is destroyed. peer identifies the remote server for session resumption on the client
+  // side.
+  CHECKED_STATUS Handshake(Socket* socket, bool server, const std::string& peer,
+                           const MonoTime& deadline, std::unique_ptr<TlsSession>* session);
+
+  uint64_t num_full_handshakes() const { return num_full_handshakes_.load(); }
+  uint64_t num_resumed_handshakes() const { return num_resumed_handshakes_.load(); }
+
+ private:
+  TlsContext(SSL_CTX* ctx, bool verify_client);
+
+  static int NewSessionCallback(SSL* ssl, SSL_SESSION* session);
+
+  SSL_CTX* const ctx_;
+  const bool verify_client_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, SSL_SESSION*> client_sessions_;
+
+  std::atomic<uint64_t> num_full_handshakes_{0};
+  std::atomic<uint64_t> num_resumed_handshakes_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(TlsContext);
+};
+
+// Established TLS session over a socket. Errors are reported like the errors of the socket calls,
+// so EAGAIN means that the operation should be retried when the socket is ready.
+class TlsSession {
+ public:
+  ~TlsSession();
+
+  // Decrypts as much data as is available, up to amt bytes.
+  CHECKED_STATUS Recv(uint8_t* buf, int32_t amt, int32_t* nread);
+
+  // Encrypts and sends the data of iov. Buffers smaller than a TLS record are coalesced, so a
+  // batch of small messages is sent in a few records, while large buffers are encrypted in place
+  // without being copied first.
+  //
+  // When fewer bytes than requested were written, the next call should start with the unwritten
+  // bytes, as the TLS library could have encrypted them already.
+  CHECKED_STATUS Writev(const struct ::iovec* iov, int iov_len, int32_t* nwritten);
+
+  // Whether records are encrypted by the kernel.
+  bool ktls_send() const;
+
+  bool resumed() const;
+
+ private:
+  friend class TlsContext;
+
+  TlsSession(std::shared_ptr<TlsContext> context, SSL* ssl, std::string peer);
+
+  CHECKED_STATUS Write(const uint8_t* buf, size_t amt, int32_t* nwritten);
+
+  const std::shared_ptr<TlsContext> context_;
+  SSL* const ssl_;
+  const std::string peer_;
+  std::string coalesce_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(TlsSession);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_NET_TLS_H
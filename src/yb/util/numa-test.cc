@@ -0,0 +1,55 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <sched.h>
+
+#include <algorithm>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/numa.h"
+#include "yb/util/test_util.h"
+
+DECLARE_bool(enable_numa_affinity);
+
+namespace yb {
+
+class NumaTest : public YBTest {
+};
+
+TEST_F(NumaTest, Topology) {
+  ASSERT_GE(NumaNodeCount(), 1);
+  for (size_t index = 0; index != 2 * NumaNodeCount(); ++index) {
+    ASSERT_LT(NumaNodeForIndex(index), NumaNodeCount());
+  }
+}
+
+#if defined(__linux__)
+TEST_F(NumaTest, BindThread) {
+  if (NumaNodeCount() < 2) {
+    LOG(INFO) << "Skipping test, host has a single NUMA node";
+    return;
+  }
+  FLAGS_enable_numa_affinity = true;
+  for (size_t index = 0; index != NumaNodeCount(); ++index) {
+    std::thread([index]() {
+      BindCurrentThreadToNumaNode(index);
+      const auto& cpus = NumaNodeCpus(NumaNodeForIndex(index));
+      ASSERT_NE(cpus.end(), std::find(cpus.begin(), cpus.end(), sched_getcpu()));
+    }).join();
+  }
+}
+#endif
+
+} // namespace yb
@@ -0,0 +1,129 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/numa.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <fstream>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/gutil/strings/numbers.h"
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/errno.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_bool(enable_numa_affinity, false,
+            "Bind reactor and RPC worker threads to NUMA nodes, so the calls of a connection are "
+            "handled on a single socket. Threads are spread over the nodes round robin.");
+TAG_FLAG(enable_numa_affinity, advanced);
+
+namespace yb {
+
+namespace {
+
+// Parses a CPU list like "0-11,24-35".
+std::vector<int> ParseCpuList(const std::string& input) {
+  std::vector<int> result;
+  std::vector<std::string> ranges = strings::Split(input, ",", strings::SkipWhitespace());
+  for (const auto& range : ranges) {
+    std::vector<std::string> bounds = strings::Split(range, "-");
+    int32 first, last;
+    if (!safe_strto32(bounds[0], &first)) {
+      continue;
+    }
+    last = first;
+    if (bounds.size() > 1 && !safe_strto32(bounds[1], &last)) {
+      continue;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+  }
+  return result;
+}
+
+class NumaTopology {
+ public:
+  NumaTopology() {
+#if defined(__linux__)
+    for (;;) {
+      std::ifstream input(strings::Substitute(
+          "/sys/devices/system/node/node$0/cpulist", node_cpus_.size()));
+      std::string cpu_list;
+      if (!input || !std::getline(input, cpu_list)) {
+        break;
+      }
+      node_cpus_.push_back(ParseCpuList(cpu_list));
+    }
+#endif
+    if (node_cpus_.empty()) {
+      node_cpus_.emplace_back();
+    }
+  }
+
+  size_t num_nodes() const {
+    return node_cpus_.size();
+  }
+
+  const std::vector<int>& cpus(size_t node) const {
+    return node_cpus_[node];
+  }
+
+ private:
+  std::vector<std::vector<int>> node_cpus_;
+};
+
+const NumaTopology& Topology() {
+  static const NumaTopology topology;
+  return topology;
+}
+
+} // namespace
+
+size_t NumaNodeCount() {
+  return Topology().num_nodes();
+}
+
+const std::vector<int>& NumaNodeCpus(size_t node) {
+  return Topology().cpus(node);
+}
+
+void BindCurrentThreadToNumaNode(size_t index) {
+  if (!FLAGS_enable_numa_affinity || NumaNodeCount() < 2) {
+    return;
+  }
+  const size_t node = NumaNodeForIndex(index);
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : NumaNodeCpus(node)) {
+    CPU_SET(cpu, &cpu_set);
+  }
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (err != 0) {
+    LOG(WARNING) << "Failed to bind thread to NUMA node " << node << ": " << ErrnoToString(err);
+    return;
+  }
+  VLOG(1) << "Bound thread to NUMA node " << node;
+#endif
+}
+
+} // namespace yb
@@ -0,0 +1,41 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_NUMA_H
+#define YB_UTIL_NUMA_H
+
+#include <stddef.h>
+
+#include <vector>
+
+namespace yb {
+
+// Returns the number of NUMA nodes of this host, or 1 when the topology is not known.
+size_t NumaNodeCount();
+
+// Returns the CPUs of the specified NUMA node. Empty when the topology is not known.
+const std::vector<int>& NumaNodeCpus(size_t node);
+
+// Returns the NUMA node that threads with the specified index are bound to.
+inline size_t NumaNodeForIndex(size_t index) {
+  return index % NumaNodeCount();
+}
+
+// When --enable_numa_affinity is set, binds the current thread to the CPUs of the NUMA node
+// NumaNodeForIndex(index). Threads that hand work to each other should use the same index, so they
+// run on the same socket and the memory they first touch is local to it.
+void BindCurrentThreadToNumaNode(size_t index);
+
+} // namespace yb
+
+#endif // YB_UTIL_NUMA_H
@@ -30,6 +30,9 @@
 // under the License.
 //
 
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "yb/util/object_pool.h"
 
@@ -96,4 +99,59 @@ TEST(TestObjectPool, TestScopedPtr) {
   ASSERT_EQ(0, MyClass::instance_count());
 }
 
+class PooledClass {
+ public:
+  explicit PooledClass(int value) : value_(value) {}
+
+  int value() const {
+    return value_;
+  }
+
+ private:
+  int value_;
+};
+
+TEST(TestObjectPool, TestPooledShared) {
+  auto first = MakePooledShared<PooledClass>(1);
+  ASSERT_EQ(1, first->value());
+  const void* first_address = first.get();
+  first.reset();
+
+  // Memory of the freed object should be reused by the next one.
+  auto second = MakePooledShared<PooledClass>(2);
+  ASSERT_EQ(2, second->value());
+  ASSERT_EQ(first_address, second.get());
+  second.reset();
+
+  // Objects allocated and freed by different threads.
+  constexpr int kThreads = 4;
+  constexpr int kObjectsPerThread = 10000;
+  std::vector<std::shared_ptr<PooledClass>> objects(kThreads * kObjectsPerThread);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kThreads; ++i) {
+    threads.emplace_back([&objects, i] {
+      for (int j = 0; j != kObjectsPerThread; ++j) {
+        objects[i * kObjectsPerThread + j] = MakePooledShared<PooledClass>(j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (int i = 0; i != kThreads; ++i) {
+    threads.emplace_back([&objects, i] {
+      // Free objects allocated by another thread.
+      int source = (i + 1) % kThreads;
+      for (int j = 0; j != kObjectsPerThread; ++j) {
+        ASSERT_EQ(j, objects[source * kObjectsPerThread + j]->value());
+        objects[source * kObjectsPerThread + j].reset();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 } // namespace yb
@@ -36,6 +36,13 @@
 
 #include <glog/logging.h>
 #include <stdint.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <boost/lockfree/queue.hpp>
+
 #include "yb/gutil/manual_constructor.h"
 #include "yb/gutil/gscoped_ptr.h"
 
@@ -178,5 +185,111 @@ class ReturnToPool {
 };
 
 
+// Thread safe free list of memory blocks with the same size.
+// Freed blocks are kept for reuse, up to the specified number of blocks, the rest are returned to
+// the system allocator.
+class MemoryBlockFreeList {
+ public:
+  MemoryBlockFreeList(size_t block_size, size_t max_free_blocks)
+      : block_size_(block_size), free_blocks_(max_free_blocks) {
+  }
+
+  ~MemoryBlockFreeList() {
+    void* block = nullptr;
+    while (free_blocks_.pop(block)) {
+      ::operator delete(block);
+    }
+  }
+
+  void* Allocate() {
+    void* block = nullptr;
+    if (free_blocks_.pop(block)) {
+      return block;
+    }
+    return ::operator new(block_size_);
+  }
+
+  void Free(void* block) {
+    if (!free_blocks_.bounded_push(block)) {
+      ::operator delete(block);
+    }
+  }
+
+  size_t block_size() const {
+    return block_size_;
+  }
+
+ private:
+  const size_t block_size_;
+  boost::lockfree::queue<void*> free_blocks_;
+};
+
+// STL allocator, that reuses memory of freed objects of type T.
+// Intended for objects that are allocated and freed with high rate from different threads, like
+// RPC calls. Since it is stateless, std::allocate_shared places control block and the object
+// in a single pooled block:
+//   auto call = std::allocate_shared<OutboundCall>(PooledAllocator<OutboundCall>(), ...);
+//
+// Unlike ObjectPool, objects are constructed and destroyed as usual, so they don't need any reset
+// logic, only their memory is reused.
+template <class T>
+class PooledAllocator {
+ public:
+  typedef T value_type;
+
+  // Maximal number of free blocks kept for each allocated type.
+  static constexpr size_t kMaxFreeBlocks = 4096;
+
+  template <class U>
+  struct rebind {
+    typedef PooledAllocator<U> other;
+  };
+
+  PooledAllocator() {}
+
+  template <class U>
+  PooledAllocator(const PooledAllocator<U>& rhs) {} // NOLINT
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over aligned types are not supported");
+    if (n != 1) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(FreeList().Allocate());
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (n != 1) {
+      ::operator delete(p);
+      return;
+    }
+    FreeList().Free(p);
+  }
+
+  static MemoryBlockFreeList& FreeList() {
+    // Free list is never destroyed, because objects could be freed by other threads during
+    // process shutdown.
+    static MemoryBlockFreeList* free_list = new MemoryBlockFreeList(sizeof(T), kMaxFreeBlocks);
+    return *free_list;
+  }
+};
+
+template <class T, class U>
+bool operator==(const PooledAllocator<T>& lhs, const PooledAllocator<U>& rhs) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const PooledAllocator<T>& lhs, const PooledAllocator<U>& rhs) {
+  return false;
+}
+
+// Creates shared_ptr to the object of type T, whose memory is reused from the previously freed
+// objects of the same type.
+template <class T, class... Args>
+std::shared_ptr<T> MakePooledShared(Args&&... args) {
+  return std::allocate_shared<T>(PooledAllocator<T>(), std::forward<Args>(args)...);
+}
+
 } // namespace yb
 #endif
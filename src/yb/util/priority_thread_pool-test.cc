@@ -0,0 +1,98 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/priority_thread_pool.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+class PriorityThreadPoolTest : public YBTest {
+};
+
+// Blocks the single worker, then checks that queued tasks run by priority and then FIFO.
+TEST_F(PriorityThreadPoolTest, RunsByPriority) {
+  PriorityThreadPool pool(1);
+  CountDownLatch blocker_started(1);
+  CountDownLatch unblock(1);
+  CountDownLatch done(5);
+  std::mutex mutex;
+  std::vector<int> order;
+
+  ASSERT_OK(pool.Submit(0, nullptr, [&blocker_started, &unblock] {
+    blocker_started.CountDown();
+    unblock.Wait();
+  }));
+  blocker_started.Wait();
+
+  auto submit = [&](int priority, int id) {
+    return pool.Submit(priority, nullptr, [&, id] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(id);
+      }
+      done.CountDown();
+    });
+  };
+  ASSERT_OK(submit(1, 1));
+  ASSERT_OK(submit(5, 2));
+  ASSERT_OK(submit(3, 3));
+  ASSERT_OK(submit(5, 4));
+  ASSERT_OK(submit(1, 5));
+
+  unblock.CountDown();
+  done.Wait();
+  ASSERT_EQ((std::vector<int>{2, 4, 3, 1, 5}), order);
+}
+
+TEST_F(PriorityThreadPoolTest, RemoveAndShutdown) {
+  PriorityThreadPool pool(1);
+  CountDownLatch blocker_started(1);
+  CountDownLatch unblock(1);
+  std::atomic<int> runs(0);
+  std::atomic<int> aborts(0);
+  int tag1 = 0;
+  int tag2 = 0;
+
+  ASSERT_OK(pool.Submit(0, nullptr, [&blocker_started, &unblock] {
+    blocker_started.CountDown();
+    unblock.Wait();
+  }));
+  blocker_started.Wait();
+
+  auto run = [&runs] { ++runs; };
+  auto abort = [&aborts] { ++aborts; };
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_OK(pool.Submit(i, &tag1, run, abort));
+    ASSERT_OK(pool.Submit(i, &tag2, run, abort));
+  }
+
+  ASSERT_EQ(3U, pool.Remove(&tag1));
+  ASSERT_EQ(3, aborts.load());
+  ASSERT_EQ(0U, pool.Remove(&tag1));
+
+  unblock.CountDown();
+  pool.Shutdown();
+  // Tasks of tag2 either ran before shutdown or were aborted by it.
+  ASSERT_EQ(6, runs.load() + aborts.load());
+  ASSERT_NOK(pool.Submit(0, &tag2, run, abort));
+}
+
+} // namespace yb
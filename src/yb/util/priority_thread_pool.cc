@@ -0,0 +1,133 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/priority_thread_pool.h"
+
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/thread.h"
+
+namespace yb {
+
+PriorityThreadPool::PriorityThreadPool(size_t max_running_tasks)
+    : max_running_tasks_(std::max<size_t>(max_running_tasks, 1)) {
+}
+
+PriorityThreadPool::~PriorityThreadPool() {
+  Shutdown();
+}
+
+Status PriorityThreadPool::Submit(int priority, void* tag, Callback run, Callback abort) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (stopping_) {
+    return STATUS(ServiceUnavailable, "Priority thread pool is shutting down");
+  }
+  auto it = tasks_.insert(
+      Task{priority, serial_no_++, tag, std::move(run), std::move(abort)}).first;
+  if (idle_threads_ == 0 && threads_.size() < max_running_tasks_) {
+    scoped_refptr<Thread> thread;
+    auto status = Thread::Create(
+        "priority_thread_pool", strings::Substitute("prio-worker-$0", threads_.size()),
+        &PriorityThreadPool::Execute, this, &thread);
+    if (!status.ok()) {
+      // Already started threads will pick up the task eventually.
+      if (threads_.empty()) {
+        tasks_.erase(it);
+        return status;
+      }
+      LOG(WARNING) << "Failed to start priority thread pool worker: " << status;
+    } else {
+      threads_.push_back(std::move(thread));
+      ++idle_threads_;
+    }
+  }
+  lock.unlock();
+  cond_.notify_one();
+  return Status::OK();
+}
+
+size_t PriorityThreadPool::Remove(void* tag) {
+  std::vector<Callback> aborted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+      if (it->tag == tag) {
+        aborted.push_back(it->abort);
+        it = tasks_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (const auto& abort : aborted) {
+    if (abort) {
+      abort();
+    }
+  }
+  return aborted.size();
+}
+
+void PriorityThreadPool::Shutdown() {
+  std::vector<Callback> aborted;
+  std::vector<scoped_refptr<Thread>> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (const auto& task : tasks_) {
+      aborted.push_back(task.abort);
+    }
+    tasks_.clear();
+    threads.swap(threads_);
+  }
+  cond_.notify_all();
+  for (const auto& abort : aborted) {
+    if (abort) {
+      abort();
+    }
+  }
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+}
+
+std::string PriorityThreadPool::StateToString() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return strings::Substitute(
+      "{ max_running_tasks: $0 threads: $1 running: $2 queued: $3 top_priority: $4 }",
+      max_running_tasks_, threads_.size(), running_tasks_, tasks_.size(),
+      tasks_.empty() ? "none" : std::to_string(tasks_.begin()->priority));
+}
+
+void PriorityThreadPool::Execute() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cond_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+    if (stopping_) {
+      break;
+    }
+    auto it = tasks_.begin();
+    Callback run = std::move(it->run);
+    tasks_.erase(it);
+    --idle_threads_;
+    ++running_tasks_;
+    lock.unlock();
+    run();
+    // Destroy captured state of the task before reacquiring the lock.
+    run = Callback();
+    lock.lock();
+    --running_tasks_;
+    ++idle_threads_;
+  }
+  --idle_threads_;
+}
+
+} // namespace yb
@@ -0,0 +1,104 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_PRIORITY_THREAD_POOL_H
+#define YB_UTIL_PRIORITY_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class Thread;
+
+// Thread pool that runs tasks in order of decreasing priority. Tasks with equal priority run in
+// submission order.
+//
+// It is intended to be shared by a number of independent clients (e.g. all RocksDB instances of a
+// tablet server), so that the most urgent background work of the whole process runs first,
+// instead of every client scheduling its work without knowing about the others.
+//
+// Each task is associated with a tag, usually the client that submitted it. Tasks that did not
+// start yet could be removed using this tag, in that case their abort callback is invoked instead.
+class PriorityThreadPool {
+ public:
+  typedef std::function<void()> Callback;
+
+  // max_running_tasks - maximum number of tasks that could be executed simultaneously.
+  explicit PriorityThreadPool(size_t max_running_tasks);
+  ~PriorityThreadPool();
+
+  // Submits task for execution. Tasks with higher priority run first.
+  // abort is invoked instead of run when the task is removed or the pool is shut down before the
+  // task starts. Both callbacks are invoked without any pool locks held.
+  CHECKED_STATUS Submit(int priority, void* tag, Callback run, Callback abort = Callback());
+
+  // Removes tasks with the specified tag that did not start yet, invoking their abort callbacks.
+  // Returns the number of removed tasks.
+  size_t Remove(void* tag);
+
+  // Aborts all queued tasks, waits for running tasks and stops worker threads.
+  // Submit fails after shutdown.
+  void Shutdown();
+
+  std::string StateToString();
+
+  size_t max_running_tasks() const { return max_running_tasks_; }
+
+ private:
+  struct Task {
+    int priority;
+    size_t serial_no;
+    void* tag;
+    // Callbacks are not part of the ordering, so they could be moved out of a queued task.
+    mutable Callback run;
+    mutable Callback abort;
+  };
+
+  struct TaskComparator {
+    // Higher priority first, then lower serial number first.
+    bool operator()(const Task& lhs, const Task& rhs) const {
+      if (lhs.priority != rhs.priority) {
+        return lhs.priority > rhs.priority;
+      }
+      return lhs.serial_no < rhs.serial_no;
+    }
+  };
+
+  void Execute();
+
+  const size_t max_running_tasks_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::set<Task, TaskComparator> tasks_;
+  std::vector<scoped_refptr<Thread>> threads_;
+  size_t idle_threads_ = 0;
+  size_t running_tasks_ = 0;
+  size_t serial_no_ = 0;
+  bool stopping_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(PriorityThreadPool);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_PRIORITY_THREAD_POOL_H
@@ -86,6 +86,12 @@ class RefCntBuffer {
 
   void Reset() { DoReset(nullptr); }
 
+  // Whether this is the only reference to the buffer. Since other references could only be made
+  // by copying an existing one, data of a unique buffer could be safely modified.
+  bool unique() const {
+    return data_ != nullptr && counter_reference().load(std::memory_order_acquire) == 1;
+  }
+
   explicit operator bool() const {
     return data_ != nullptr;
   }
@@ -0,0 +1,324 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/sampling_profiler.h"
+
+#include <signal.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include <gflags/gflags.h>
+
+#include "yb/gutil/once.h"
+#include "yb/gutil/spinlock.h"
+#include "yb/gutil/sysinfo.h"
+#include "yb/util/debug-util.h"
+#include "yb/util/errno.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+#include "yb/util/spinlock_profiling.h"
+#include "yb/util/thread.h"
+
+DEFINE_bool(enable_continuous_profiling, true,
+            "Continuously sample the stacks of running threads and of threads waiting on locks, "
+            "see /pprof/flamegraph.");
+TAG_FLAG(enable_continuous_profiling, advanced);
+
+DEFINE_int32(continuous_profiling_cpu_sample_hz, 19,
+             "Number of CPU stack samples taken per second of process CPU time.");
+TAG_FLAG(continuous_profiling_cpu_sample_hz, advanced);
+
+DEFINE_int32(continuous_profiling_window_secs, 60,
+             "Length of a continuous profiling window in seconds.");
+TAG_FLAG(continuous_profiling_window_secs, advanced);
+TAG_FLAG(continuous_profiling_window_secs, runtime);
+
+DEFINE_int32(continuous_profiling_num_windows, 10,
+             "Number of continuous profiling windows kept.");
+TAG_FLAG(continuous_profiling_num_windows, advanced);
+TAG_FLAG(continuous_profiling_num_windows, runtime);
+
+namespace yb {
+
+namespace {
+
+// Fixed size hashtable of stack samples, filled from the profiling signal handler. Like the
+// contention stacks table, a sample is dropped rather than blocking when its slot is busy.
+class StackSamples {
+ public:
+  void Add(const StackTrace& s) {
+    const uint64_t hash = s.HashCode();
+    for (int i = 0; i < kNumLinearProbeAttempts; i++) {
+      Entry* e = &entries_[(hash + i) % kNumEntries];
+      if (!e->lock.TryLock()) {
+        continue;
+      }
+      if (e->count == 0) {
+        e->hash = hash;
+        e->trace.CopyFrom(s);
+      } else if (e->hash != hash || !e->trace.Equals(s)) {
+        e->lock.Unlock();
+        continue;
+      }
+      e->count++;
+      e->lock.Unlock();
+      return;
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Passes the collected samples to 'callback' and empties the table.
+  void Collect(const SynchronizationProfileCallback& callback, int64_t* dropped) {
+    StackTrace trace;
+    for (auto& e : entries_) {
+      int64_t count;
+      {
+        SpinLockHolder l(&e.lock);
+        count = e.count;
+        if (count == 0) {
+          continue;
+        }
+        trace.CopyFrom(e.trace);
+        e.count = 0;
+      }
+      callback(trace, count, count);
+    }
+    *dropped += dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  enum {
+    kNumEntries = 1024,
+    kNumLinearProbeAttempts = 4
+  };
+
+  struct Entry {
+    base::SpinLock lock;
+    int64_t count = 0;
+    uint64_t hash = 0;
+    StackTrace trace;
+  };
+
+  Entry entries_[kNumEntries];
+  std::atomic<int64_t> dropped_{0};
+};
+
+struct StackValue {
+  StackTrace trace;
+  int64_t value = 0;
+};
+
+// Samples of one window keyed by the hex representation of the stack.
+typedef std::unordered_map<std::string, StackValue> StackValues;
+
+struct ProfileWindow {
+  StackValues cpu;
+  StackValues contention;
+
+  StackValues& values(ProfileType type) {
+    return type == ProfileType::kCpu ? cpu : contention;
+  }
+};
+
+class ContinuousProfiler {
+ public:
+  Status Start();
+
+  void Dump(ProfileType type, int num_windows, std::ostream* out);
+
+  void AddCpuSample(const StackTrace& s) {
+    cpu_samples_.Add(s);
+  }
+
+ private:
+  void Run();
+
+  // Moves the samples collected since the last call to the current window.
+  void CollectSamples();
+
+  StackSamples cpu_samples_;
+
+  scoped_refptr<Thread> thread_;
+
+  std::mutex mutex_;
+  // The current window is at the back.
+  std::deque<ProfileWindow> windows_;
+  int64_t dropped_samples_ = 0;
+};
+
+ContinuousProfiler* g_profiler = nullptr;
+
+void AddStackValue(const StackTrace& trace, int64_t value, StackValues* values) {
+  auto& entry = (*values)[trace.ToHexString()];
+  if (entry.value == 0) {
+    entry.trace.CopyFrom(trace);
+  }
+  entry.value += value;
+}
+
+#if defined(__linux__)
+void HandleProfilingSignal(int signum) {
+  int old_errno = errno;
+  StackTrace stack;
+  // Skip this handler and the signal trampoline.
+  stack.Collect(2);
+  g_profiler->AddCpuSample(stack);
+  errno = old_errno;
+}
+
+Status StartCpuSampling() {
+  const int signum = SIGRTMIN + 2;
+  struct sigaction act;
+  memset(&act, 0, sizeof(act));
+  act.sa_handler = &HandleProfilingSignal;
+  act.sa_flags = SA_RESTART;
+  sigemptyset(&act.sa_mask);
+  if (sigaction(signum, &act, nullptr) != 0) {
+    return STATUS(RuntimeError, "Failed to install profiling signal handler",
+                  ErrnoToString(errno), errno);
+  }
+
+  // The timer counts the CPU time of the whole process, so the signals are delivered to the
+  // threads that are running.
+  struct sigevent sev;
+  memset(&sev, 0, sizeof(sev));
+  sev.sigev_notify = SIGEV_SIGNAL;
+  sev.sigev_signo = signum;
+  timer_t timer;
+  if (timer_create(CLOCK_PROCESS_CPUTIME_ID, &sev, &timer) != 0) {
+    return STATUS(RuntimeError, "Failed to create profiling timer", ErrnoToString(errno), errno);
+  }
+  const int64_t interval_ns =
+      1000000000LL / std::max(FLAGS_continuous_profiling_cpu_sample_hz, 1);
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = interval_ns / 1000000000LL;
+  spec.it_interval.tv_nsec = interval_ns % 1000000000LL;
+  spec.it_value = spec.it_interval;
+  if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+    return STATUS(RuntimeError, "Failed to start profiling timer", ErrnoToString(errno), errno);
+  }
+  return Status::OK();
+}
+#else
+Status StartCpuSampling() {
+  return STATUS(NotSupported, "CPU sampling is only supported on Linux");
+}
+#endif
+
+Status ContinuousProfiler::Start() {
+  windows_.emplace_back();
+  // Contention stacks are only collected while synchronization profiling is on, so keep it on.
+  StartSynchronizationProfiling();
+  if (FLAGS_continuous_profiling_cpu_sample_hz > 0) {
+    WARN_NOT_OK(StartCpuSampling(), "CPU stacks will not be sampled");
+  }
+  return Thread::Create("profiler", "continuous-profiler", &ContinuousProfiler::Run, this,
+                        &thread_);
+}
+
+void ContinuousProfiler::Run() {
+  auto window_start = MonoTime::Now(MonoTime::FINE);
+  for (;;) {
+    SleepFor(MonoDelta::FromSeconds(1));
+    CollectSamples();
+
+    auto now = MonoTime::Now(MonoTime::FINE);
+    if (now.GetDeltaSince(window_start).ToSeconds() < FLAGS_continuous_profiling_window_secs) {
+      continue;
+    }
+    window_start = now;
+    std::lock_guard<std::mutex> l(mutex_);
+    windows_.emplace_back();
+    const size_t max_windows = std::max(FLAGS_continuous_profiling_num_windows, 1);
+    while (windows_.size() > max_windows) {
+      windows_.pop_front();
+    }
+    if (dropped_samples_ != 0) {
+      VLOG(1) << "Dropped " << dropped_samples_ << " profiling samples";
+      dropped_samples_ = 0;
+    }
+  }
+}
+
+void ContinuousProfiler::CollectSamples() {
+  const double micros_per_cycle = 1000000.0 / base::CyclesPerSecond();
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& window = windows_.back();
+  cpu_samples_.Collect([&window](const StackTrace& trace, int64_t count, int64_t) {
+    AddStackValue(trace, count, &window.cpu);
+  }, &dropped_samples_);
+  CollectSynchronizationProfile(
+      [&window, micros_per_cycle](const StackTrace& trace, int64_t count, int64_t cycles) {
+    AddStackValue(trace, static_cast<int64_t>(cycles * micros_per_cycle), &window.contention);
+  }, &dropped_samples_);
+}
+
+void ContinuousProfiler::Dump(ProfileType type, int num_windows, std::ostream* out) {
+  StackValues merged;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    size_t first = 0;
+    if (num_windows > 0 && windows_.size() > static_cast<size_t>(num_windows)) {
+      first = windows_.size() - num_windows;
+    }
+    for (size_t i = first; i != windows_.size(); ++i) {
+      for (const auto& p : windows_[i].values(type)) {
+        AddStackValue(p.second.trace, p.second.value, &merged);
+      }
+    }
+  }
+
+  // Symbolize outside of the lock, since it is slow.
+  for (const auto& p : merged) {
+    if (p.second.value > 0) {
+      *out << p.second.trace.ToFoldedString() << ' ' << p.second.value << '\n';
+    }
+  }
+}
+
+void DoStartContinuousProfiling(Status* status) {
+  if (!FLAGS_enable_continuous_profiling) {
+    *status = Status::OK();
+    return;
+  }
+  InitSpinLockContentionProfiling();
+  auto* profiler = new ContinuousProfiler;
+  g_profiler = profiler;
+  *status = profiler->Start();
+}
+
+} // namespace
+
+Status StartContinuousProfiling() {
+  static GoogleOnceType once = GOOGLE_ONCE_INIT;
+  static Status status;
+  GoogleOnceInitArg(&once, &DoStartContinuousProfiling, &status);
+  return status;
+}
+
+void DumpContinuousProfile(ProfileType type, int num_windows, std::ostream* out) {
+  if (g_profiler == nullptr) {
+    *out << "Continuous profiling is not running, see --enable_continuous_profiling\n";
+    return;
+  }
+  g_profiler->Dump(type, num_windows, out);
+}
+
+} // namespace yb
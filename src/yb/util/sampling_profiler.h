@@ -0,0 +1,46 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_SAMPLING_PROFILER_H
+#define YB_UTIL_SAMPLING_PROFILER_H
+
+#include <iosfwd>
+
+#include "yb/util/status.h"
+
+namespace yb {
+
+enum class ProfileType {
+  // Stacks of the threads that were running on a CPU, sampled at a low frequency.
+  kCpu,
+  // Stacks of the threads that waited on a lock or another synchronization object, weighted by
+  // the time they waited.
+  kContention,
+};
+
+// Starts the always-on profiler if --enable_continuous_profiling is set. The samples are
+// aggregated into windows of --continuous_profiling_window_secs seconds, and the last
+// --continuous_profiling_num_windows windows are kept. Only the first call has an effect.
+CHECKED_STATUS StartContinuousProfiling();
+
+// Writes the samples of the last 'num_windows' windows, including the current one, to 'out'. All
+// kept windows are written if 'num_windows' is not positive.
+//
+// Each line is a stack of function names, outermost first, separated by ';' and followed by the
+// number of samples (kCpu) or the microseconds waited (kContention). This is the "folded" format
+// consumed by flame graph tools.
+void DumpContinuousProfile(ProfileType type, int num_windows, std::ostream* out);
+
+} // namespace yb
+
+#endif // YB_UTIL_SAMPLING_PROFILER_H
@@ -0,0 +1,65 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/space_saving.h"
+
+#include <gtest/gtest.h>
+
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+class SpaceSavingTest : public YBTest {
+};
+
+TEST_F(SpaceSavingTest, ExactBelowCapacity) {
+  SpaceSaving sketch(4);
+  sketch.Add("a", 3);
+  sketch.Add("b");
+  sketch.Add("c", 2);
+  sketch.Add("a");
+
+  auto top = sketch.TopK(2);
+  ASSERT_EQ(2U, top.size());
+  ASSERT_EQ("a", top[0].key);
+  ASSERT_EQ(4U, top[0].count);
+  ASSERT_EQ(0U, top[0].error);
+  ASSERT_EQ("c", top[1].key);
+  ASSERT_EQ(2U, top[1].count);
+  ASSERT_EQ(7U, sketch.total());
+}
+
+TEST_F(SpaceSavingTest, FindsHeavyHitter) {
+  SpaceSaving sketch(8);
+  // One key takes a fifth of a stream of otherwise distinct keys.
+  for (int i = 0; i != 10000; ++i) {
+    if (i % 5 == 0) {
+      sketch.Add("hot");
+    } else {
+      sketch.Add(std::to_string(i));
+    }
+  }
+
+  auto top = sketch.TopK(1);
+  ASSERT_EQ(1U, top.size());
+  ASSERT_EQ("hot", top[0].key);
+  ASSERT_GE(top[0].count, 2000U);
+  ASSERT_LE(top[0].count - top[0].error, 2000U);
+  ASSERT_EQ(10000U, sketch.total());
+
+  sketch.Clear();
+  ASSERT_TRUE(sketch.TopK(1).empty());
+  ASSERT_EQ(0U, sketch.total());
+}
+
+} // namespace yb
@@ -0,0 +1,80 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/space_saving.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace yb {
+
+SpaceSaving::SpaceSaving(size_t capacity) : capacity_(capacity) {
+  CHECK_GT(capacity, 0);
+  entries_.reserve(capacity);
+}
+
+void SpaceSaving::Add(const Slice& key, uint64_t count) {
+  std::string key_str = key.ToBuffer();
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  total_ += count;
+  auto it = index_.find(key_str);
+  if (it != index_.end()) {
+    entries_[it->second].count += count;
+    return;
+  }
+  if (entries_.size() < capacity_) {
+    index_.emplace(key_str, entries_.size());
+    entries_.push_back(Entry{std::move(key_str), count, 0});
+    return;
+  }
+  // The capacity is small, so a linear scan for the minimum is cheaper than keeping the entries
+  // ordered on every increment.
+  auto min = std::min_element(
+      entries_.begin(), entries_.end(),
+      [](const Entry& lhs, const Entry& rhs) { return lhs.count < rhs.count; });
+  index_.erase(min->key);
+  index_.emplace(key_str, min - entries_.begin());
+  min->key = std::move(key_str);
+  min->error = min->count;
+  min->count += count;
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::TopK(size_t limit) const {
+  std::vector<Entry> result;
+  {
+    std::lock_guard<simple_spinlock> lock(mutex_);
+    result = entries_;
+  }
+  std::sort(result.begin(), result.end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.count > rhs.count;
+  });
+  if (result.size() > limit) {
+    result.resize(limit);
+  }
+  return result;
+}
+
+uint64_t SpaceSaving::total() const {
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  return total_;
+}
+
+void SpaceSaving::Clear() {
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  total_ = 0;
+  entries_.clear();
+  index_.clear();
+}
+
+} // namespace yb
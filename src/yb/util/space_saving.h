@@ -0,0 +1,69 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_SPACE_SAVING_H_
+#define YB_UTIL_SPACE_SAVING_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/locks.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+
+// Finds the most frequent keys of a stream with the Space-Saving algorithm of Metwally et al.
+// At most capacity keys are monitored. When a key that is not monitored arrives and all counters
+// are taken, the key replaces the key with the smallest count and inherits its count, which
+// becomes the error bound of the new key. Every key with a frequency above total / capacity is
+// guaranteed to be monitored.
+//
+// Thread safe.
+class SpaceSaving {
+ public:
+  struct Entry {
+    std::string key;
+    // Upper bound of the number of occurrences of the key.
+    uint64_t count = 0;
+    // The count overestimates the number of occurrences of the key by at most error.
+    uint64_t error = 0;
+  };
+
+  explicit SpaceSaving(size_t capacity);
+
+  void Add(const Slice& key, uint64_t count = 1);
+
+  // Returns at most limit monitored keys, most frequent first.
+  std::vector<Entry> TopK(size_t limit) const;
+
+  // Sum of the counts of all added keys.
+  uint64_t total() const;
+
+  void Clear();
+
+ private:
+  const size_t capacity_;
+  mutable simple_spinlock mutex_;
+  uint64_t total_ = 0;
+  std::vector<Entry> entries_;
+  // Index of the entry of each monitored key.
+  std::unordered_map<std::string, size_t> index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpaceSaving);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_SPACE_SAVING_H_
@@ -86,4 +86,27 @@ TEST_F(SpinLockProfilingTest, TestStackCollection) {
   ASSERT_EQ(0, dropped);
 }
 
+TEST_F(SpinLockProfilingTest, TestWaitProfiling) {
+  const uint64_t contention_micros = GetSpinLockContentionMicros();
+  int dummy;
+  StartSynchronizationProfiling();
+  SubmitWaitProfileData(&dummy, 54321);
+  SubmitWaitProfileData(&dummy, 54321);
+  StopSynchronizationProfiling();
+
+  int64_t total_count = 0;
+  int64_t total_cycles = 0;
+  int64_t dropped = 0;
+  CollectSynchronizationProfile([&](const StackTrace& stack, int64_t count, int64_t cycles) {
+    total_count += count;
+    total_cycles += cycles;
+  }, &dropped);
+  ASSERT_EQ(2, total_count);
+  ASSERT_EQ(2 * 54321, total_cycles);
+  ASSERT_EQ(0, dropped);
+
+  // Waits that are not on a spinlock don't count as spinlock contention.
+  ASSERT_EQ(contention_micros, GetSpinLockContentionMicros());
+}
+
 } // namespace yb
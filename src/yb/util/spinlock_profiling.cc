@@ -97,6 +97,9 @@ class ContentionStacks {
   // the call have been flushed. However, new stacks can be added concurrently with this call.
   void Flush(std::stringstream* out, int64_t* dropped);
 
+  // Same as Flush(), but passes the stacks to 'callback'.
+  void Collect(const SynchronizationProfileCallback& callback, int64_t* dropped);
+
  private:
 
   // Collect the next sample from the underlying buffer, and set it back to 0 count
@@ -183,17 +186,23 @@ void ContentionStacks::AddStack(const StackTrace& s, int64_t cycles) {
 }
 
 void ContentionStacks::Flush(std::stringstream* out, int64_t* dropped) {
-  uint64_t iterator = 0;
-  StackTrace t;
-  int64_t cycles;
-  int64_t count;
   *out << "Format: Cycles\tCount @ Call Stack" << std::endl;
-  while (g_contention_stacks->CollectSample(&iterator, &t, &count, &cycles)) {
+  Collect([out](const StackTrace& t, int64_t count, int64_t cycles) {
     *out << cycles << "\t" << count
          << " @ " << t.ToHexString(StackTrace::NO_FIX_CALLER_ADDRESSES)
          << "\n" << t.Symbolize()
          << "\n-----------"
          << std::endl;
+  }, dropped);
+}
+
+void ContentionStacks::Collect(const SynchronizationProfileCallback& callback, int64_t* dropped) {
+  uint64_t iterator = 0;
+  StackTrace t;
+  int64_t cycles;
+  int64_t count;
+  while (CollectSample(&iterator, &t, &count, &cycles)) {
+    callback(t, count, cycles);
   }
 
   *dropped += dropped_samples_.Exchange(0);
@@ -222,7 +231,7 @@ bool ContentionStacks::CollectSample(uint64_t* iterator, StackTrace* s, int64_t*
 // Disable TSAN on this function.
 // https://yugabyte.atlassian.net/browse/ENG-354
 ATTRIBUTE_NO_SANITIZE_THREAD
-void SubmitSpinLockProfileData(const void *contendedlock, int64 wait_cycles) {
+void SubmitProfileData(const void *contendedlock, int64 wait_cycles, bool is_spinlock) {
   bool profiling_enabled = base::subtle::Acquire_Load(&g_profiling_enabled);
   bool long_wait_time = wait_cycles > FLAGS_lock_contention_trace_threshold_cycles;
   // Short circuit this function quickly in the common case.
@@ -247,16 +256,19 @@ void SubmitSpinLockProfileData(const void *contendedlock, int64 wait_cycles) {
       double seconds = static_cast<double>(wait_cycles) / base::CyclesPerSecond();
       char backtrace_buffer[1024];
       stack.StringifyToHex(backtrace_buffer, arraysize(backtrace_buffer));
-      TRACE_TO(t, "Waited $0 on lock $1. stack: $2",
-               HumanReadableElapsedTime::ToShortString(seconds), contendedlock,
+      TRACE_TO(t, "Waited $0 on $1 $2. stack: $3",
+               HumanReadableElapsedTime::ToShortString(seconds),
+               is_spinlock ? "lock" : "object", contendedlock,
                backtrace_buffer);
     }
   }
 
-  LongAdder* la = reinterpret_cast<LongAdder*>(
-      base::subtle::Acquire_Load(reinterpret_cast<AtomicWord*>(&g_contended_cycles)));
-  if (la) {
-    la->IncrementBy(wait_cycles);
+  if (is_spinlock) {
+    LongAdder* la = reinterpret_cast<LongAdder*>(
+        base::subtle::Acquire_Load(reinterpret_cast<AtomicWord*>(&g_contended_cycles)));
+    if (la) {
+      la->IncrementBy(wait_cycles);
+    }
   }
 
   in_func = false;
@@ -307,6 +319,19 @@ void StopSynchronizationProfiling() {
   CHECK_GE(base::subtle::Barrier_AtomicIncrement(&g_profiling_enabled, -1), 0);
 }
 
+void CollectSynchronizationProfile(const SynchronizationProfileCallback& callback,
+                                   int64_t* drop_count) {
+  CHECK_NOTNULL(g_contention_stacks)->Collect(callback, drop_count);
+}
+
+void SubmitSpinLockProfileData(const void *contendedlock, int64 wait_cycles) {
+  SubmitProfileData(contendedlock, wait_cycles, /* is_spinlock */ true);
+}
+
+void SubmitWaitProfileData(const void* waited_on, int64_t wait_cycles) {
+  SubmitProfileData(waited_on, wait_cycles, /* is_spinlock */ false);
+}
+
 } // namespace yb
 
 // The hook expected by gutil is in the gutil namespace. Simply forward into the
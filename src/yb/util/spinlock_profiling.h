@@ -32,6 +32,7 @@
 #ifndef YB_UTIL_SPINLOCK_PROFILING_H
 #define YB_UTIL_SPINLOCK_PROFILING_H
 
+#include <functional>
 #include <iosfwd>
 
 #include "yb/gutil/macros.h"
@@ -40,6 +41,7 @@
 namespace yb {
 
 class MetricEntity;
+class StackTrace;
 
 // Enable instrumentation of spinlock contention.
 //
@@ -83,5 +85,17 @@ void FlushSynchronizationProfile(std::stringstream* out, int64_t* drop_count);
 // Stop collecting contention profiles.
 void StopSynchronizationProfiling();
 
+// Like FlushSynchronizationProfile(), but passes each collected stack with the number of times
+// and the total cycles it waited to 'callback'.
+typedef std::function<void(const StackTrace& stack, int64_t count, int64_t cycles)>
+    SynchronizationProfileCallback;
+void CollectSynchronizationProfile(const SynchronizationProfileCallback& callback,
+                                   int64_t* drop_count);
+
+// Records a wait that is not on a spinlock, e.g. for a lock manager entry or a condition to
+// become true. It is included in synchronization profiles and traced if it is long, but does
+// not count towards the spinlock contention metric.
+void SubmitWaitProfileData(const void* waited_on, int64_t wait_cycles);
+
 } // namespace yb
 #endif /* YB_UTIL_SPINLOCK_PROFILING_H */
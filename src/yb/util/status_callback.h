@@ -32,6 +32,8 @@
 #ifndef YB_UTIL_STATUS_CALLBACK_H
 #define YB_UTIL_STATUS_CALLBACK_H
 
+#include <functional>
+
 #include "yb/gutil/callback_forward.h"
 
 namespace yb {
@@ -42,6 +44,9 @@ class Status;
 // produce asynchronous results and may fail.
 typedef Callback<void(const Status& status)> StatusCallback;
 
+// Same as StatusCallback, for code that passes lambdas around.
+typedef std::function<void(const Status& status)> StatusFunctor;
+
 // To be used when a function signature requires a StatusCallback but none
 // is needed.
 extern void DoNothingStatusCB(const Status& status);
@@ -32,6 +32,8 @@
 
 #include <functional>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -160,27 +162,27 @@ TEST_F(TestThreadPool, TestThreadPoolWithNoMinimum) {
       .set_min_threads(0).set_max_threads(3)
       .set_idle_timeout(idle_timeout).Build(&thread_pool));
   // There are no threads to start with.
-  ASSERT_EQ(0, thread_pool->num_threads_);
+  ASSERT_EQ(0, thread_pool->num_threads_.load());
   // We get up to 3 threads when submitting work.
   CountDownLatch latch(1);
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(2, thread_pool->num_threads_);
+  ASSERT_EQ(2, thread_pool->num_threads_.load());
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(3, thread_pool->num_threads_);
+  ASSERT_EQ(3, thread_pool->num_threads_.load());
   // The 4th piece of work gets queued.
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(3, thread_pool->num_threads_);
+  ASSERT_EQ(3, thread_pool->num_threads_.load());
   // Finish all work
   latch.CountDown();
   thread_pool->Wait();
-  ASSERT_EQ(0, thread_pool->active_threads_);
+  ASSERT_EQ(0, thread_pool->active_threads_.load());
   thread_pool->Shutdown();
-  ASSERT_EQ(0, thread_pool->num_threads_);
+  ASSERT_EQ(0, thread_pool->num_threads_.load());
 }
 
 // Regression test for a bug where a task is submitted exactly
@@ -203,6 +205,33 @@ TEST_F(TestThreadPool, TestRace) {
   }
 }
 
+// Submit from several threads at once, while workers come and go, and check that every task runs.
+TEST_F(TestThreadPool, TestConcurrentSubmit) {
+  constexpr int kNumSubmitters = 8;
+  constexpr int kTasksPerSubmitter = 10000;
+  gscoped_ptr<ThreadPool> thread_pool;
+  ASSERT_OK(ThreadPoolBuilder("test")
+      .set_min_threads(1).set_max_threads(4)
+      .set_idle_timeout(MonoDelta::FromMicroseconds(100)).Build(&thread_pool));
+
+  Atomic32 counter(0);
+  std::vector<std::thread> submitters;
+  for (int i = 0; i < kNumSubmitters; i++) {
+    submitters.emplace_back([&thread_pool, &counter]() {
+      for (int j = 0; j < kTasksPerSubmitter; j++) {
+        CHECK_OK(thread_pool->SubmitFunc(std::bind(&SimpleTaskMethod, 1, &counter)));
+      }
+    });
+  }
+  for (auto& thread : submitters) {
+    thread.join();
+  }
+  thread_pool->Wait();
+  ASSERT_EQ(kNumSubmitters * kTasksPerSubmitter, base::subtle::NoBarrier_Load(&counter));
+  ASSERT_EQ(0, thread_pool->queue_length());
+  thread_pool->Shutdown();
+}
+
 TEST_F(TestThreadPool, TestVariableSizeThreadPool) {
   MonoDelta idle_timeout = MonoDelta::FromMilliseconds(1);
   gscoped_ptr<ThreadPool> thread_pool;
@@ -210,31 +239,31 @@ TEST_F(TestThreadPool, TestVariableSizeThreadPool) {
       .set_min_threads(1).set_max_threads(4)
       .set_idle_timeout(idle_timeout).Build(&thread_pool));
   // There is 1 thread to start with.
-  ASSERT_EQ(1, thread_pool->num_threads_);
+  ASSERT_EQ(1, thread_pool->num_threads_.load());
   // We get up to 4 threads when submitting work.
   CountDownLatch latch(1);
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(1, thread_pool->num_threads_);
+  ASSERT_EQ(1, thread_pool->num_threads_.load());
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(2, thread_pool->num_threads_);
+  ASSERT_EQ(2, thread_pool->num_threads_.load());
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(3, thread_pool->num_threads_);
+  ASSERT_EQ(3, thread_pool->num_threads_.load());
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(4, thread_pool->num_threads_);
+  ASSERT_EQ(4, thread_pool->num_threads_.load());
   // The 5th piece of work gets queued.
   ASSERT_OK(thread_pool->Submit(
         shared_ptr<Runnable>(new SlowTask(&latch))));
-  ASSERT_EQ(4, thread_pool->num_threads_);
+  ASSERT_EQ(4, thread_pool->num_threads_.load());
   // Finish all work
   latch.CountDown();
   thread_pool->Wait();
-  ASSERT_EQ(0, thread_pool->active_threads_);
+  ASSERT_EQ(0, thread_pool->active_threads_.load());
   thread_pool->Shutdown();
-  ASSERT_EQ(0, thread_pool->num_threads_);
+  ASSERT_EQ(0, thread_pool->num_threads_.load());
 }
 
 TEST_F(TestThreadPool, TestMaxQueueSize) {
@@ -33,19 +33,30 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <thread>
 
+#include <boost/scope_exit.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/gutil/atomicops.h"
 #include "yb/gutil/callback.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/sysinfo.h"
+#include "yb/gutil/walltime.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/metrics.h"
 #include "yb/util/thread.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
 
+DEFINE_int32(thread_pool_worker_spin_iterations, 200,
+             "Number of times an idle thread pool worker polls the task queue before it parks. "
+             "Spinning lets a busy pool hand tasks off without waking up threads.");
+TAG_FLAG(thread_pool_worker_spin_iterations, advanced);
+TAG_FLAG(thread_pool_worker_spin_iterations, runtime);
+
 namespace yb {
 
 using strings::Substitute;
@@ -127,9 +138,7 @@ ThreadPool::ThreadPool(const ThreadPoolBuilder& builder)
     idle_cond_(&lock_),
     no_threads_cond_(&lock_),
     not_empty_(&lock_),
-    num_threads_(0),
-    active_threads_(0),
-    queue_size_(0) {
+    queue_(64) {
 }
 
 ThreadPool::~ThreadPool() {
@@ -142,9 +151,11 @@ Status ThreadPool::Init() {
     return STATUS(NotSupported, "The thread pool is already initialized");
   }
   pool_status_ = Status::OK();
+  shutting_down_ = false;
   for (int i = 0; i < min_threads_; i++) {
     Status status = CreateThreadUnlocked();
     if (!status.ok()) {
+      unique_lock.Unlock();
       Shutdown();
       return status;
     }
@@ -152,17 +163,34 @@ Status ThreadPool::Init() {
   return Status::OK();
 }
 
+namespace {
+
+double MicrosPerCycle() {
+  static const double result = 1000000.0 / base::CyclesPerSecond();
+  return result;
+}
+
+} // namespace
+
 void ThreadPool::ClearQueue() {
-  for (QueueEntry& e : queue_) {
-    if (e.trace) {
-      e.trace->Release();
+  QueueEntry* entry;
+  while (queue_.pop(entry)) {
+    if (entry->trace) {
+      entry->trace->Release();
     }
+    delete entry;
+    queue_size_.fetch_sub(1, std::memory_order_acq_rel);
   }
-  queue_.clear();
-  queue_size_ = 0;
 }
 
 void ThreadPool::Shutdown() {
+  // New tasks are rejected once shutting_down_ is set. Wait for submissions that are already in
+  // progress, so the queue could not get new entries after it is cleared.
+  shutting_down_.store(true, std::memory_order_seq_cst);
+  while (submitting_.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+
   MutexLock unique_lock(lock_);
   pool_status_ = STATUS(ServiceUnavailable, "The pool has been shut down.");
   ClearQueue();
@@ -186,17 +214,44 @@ Status ThreadPool::SubmitFunc(const std::function<void()>& func) {
 }
 
 Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
-  MonoTime submit_time = MonoTime::Now(MonoTime::FINE);
-
-  MutexLock guard(lock_);
-  if (PREDICT_FALSE(!pool_status_.ok())) {
-    return pool_status_;
+  const int64_t submit_cycles = queue_time_us_histogram_ ? CycleClock::Now() : 0;
+
+  submitting_.fetch_add(1, std::memory_order_seq_cst);
+  BOOST_SCOPE_EXIT(&submitting_) {
+    submitting_.fetch_sub(1, std::memory_order_seq_cst);
+  } BOOST_SCOPE_EXIT_END;
+  if (PREDICT_FALSE(shutting_down_.load(std::memory_order_seq_cst))) {
+    MutexLock guard(lock_);
+    return pool_status_.ok() ? STATUS(ServiceUnavailable, "The pool is shutting down.")
+                             : pool_status_;
   }
 
   // Size limit check.
-  if (queue_size_ == max_queue_size_) {
+  const int length_at_submit = queue_size_.fetch_add(1, std::memory_order_seq_cst);
+  if (length_at_submit >= max_queue_size_) {
+    queue_size_.fetch_sub(1, std::memory_order_seq_cst);
     return STATUS(ServiceUnavailable, Substitute("Thread pool queue is full ($0 items)",
-                                                 queue_size_));
+                                                 length_at_submit));
+  }
+
+  QueueEntry* entry = new QueueEntry;
+  entry->runnable = task;
+  entry->trace = Trace::CurrentTrace();
+  // Need to AddRef, since the thread which submitted the task may go away,
+  // and we don't want the trace to be destructed while waiting in the queue.
+  if (entry->trace) {
+    entry->trace->AddRef();
+  }
+  entry->submit_cycles = submit_cycles;
+  queue_.push(entry);
+
+  // Pairs with the fences in DispatchThread(): either a parking or exiting worker sees the new
+  // entry, or we see that it parked or exited.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (parked_threads_.load(std::memory_order_seq_cst) > 0) {
+    MutexLock guard(lock_);
+    not_empty_.Signal();
   }
 
   // Should we create another thread?
@@ -209,38 +264,20 @@ Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
   //
   // Of course, we never create more than max_threads_ threads no matter what.
   int inactive_threads = num_threads_ - active_threads_;
-  int additional_threads = (queue_size_ + 1) - inactive_threads;
+  int additional_threads = (length_at_submit + 1) - inactive_threads;
   if (additional_threads > 0 && num_threads_ < max_threads_) {
-    Status status = CreateThreadUnlocked();
-    if (!status.ok()) {
-      if (num_threads_ == 0) {
-        // If we have no threads, we can't do any work.
-        return status;
-      } else {
-        // If we failed to create a thread, but there are still some other
-        // worker threads, log a warning message and continue.
+    MutexLock guard(lock_);
+    if (num_threads_ < max_threads_ && pool_status_.ok()) {
+      Status status = CreateThreadUnlocked();
+      if (!status.ok()) {
+        // The task is already queued, so it will be executed by a thread created by a later
+        // submission if there are no threads now.
         LOG(WARNING) << "Thread pool failed to create thread: "
                      << status.ToString();
       }
     }
   }
 
-  QueueEntry e;
-  e.runnable = task;
-  e.trace = Trace::CurrentTrace();
-  // Need to AddRef, since the thread which submitted the task may go away,
-  // and we don't want the trace to be destructed while waiting in the queue.
-  if (e.trace) {
-    e.trace->AddRef();
-  }
-  e.submit_time = submit_time;
-
-  queue_.push_back(e);
-  int length_at_submit = queue_size_++;
-
-  guard.Unlock();
-  not_empty_.Signal();
-
   if (queue_length_histogram_) {
     queue_length_histogram_->Increment(length_at_submit);
   }
@@ -250,9 +287,12 @@ Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
 
 void ThreadPool::Wait() {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  idle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+  while (queue_size_.load(std::memory_order_seq_cst) > 0 ||
+         active_threads_.load(std::memory_order_seq_cst) > 0) {
     idle_cond_.Wait();
   }
+  idle_waiters_.fetch_sub(1, std::memory_order_seq_cst);
 }
 
 bool ThreadPool::WaitUntil(const MonoTime& until) {
@@ -262,12 +302,17 @@ bool ThreadPool::WaitUntil(const MonoTime& until) {
 
 bool ThreadPool::WaitFor(const MonoDelta& delta) {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  idle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+  bool result = true;
+  while (queue_size_.load(std::memory_order_seq_cst) > 0 ||
+         active_threads_.load(std::memory_order_seq_cst) > 0) {
     if (!idle_cond_.TimedWait(delta)) {
-      return false;
+      result = false;
+      break;
     }
   }
-  return true;
+  idle_waiters_.fetch_sub(1, std::memory_order_seq_cst);
+  return result;
 }
 
 
@@ -283,80 +328,129 @@ void ThreadPool::SetRunTimeMicrosHistogram(const scoped_refptr<Histogram>& hist)
   run_time_us_histogram_ = hist;
 }
 
-
-void ThreadPool::DispatchThread(bool permanent) {
-  MutexLock unique_lock(lock_);
-  while (true) {
-    // Note: STATUS(Aborted, ) is used to indicate normal shutdown.
-    if (!pool_status_.ok()) {
-      VLOG(2) << "DispatchThread exiting: " << pool_status_.ToString();
-      break;
+ThreadPool::QueueEntry* ThreadPool::PopEntry(bool spin) {
+  QueueEntry* entry = nullptr;
+  const int spin_iterations = spin ? FLAGS_thread_pool_worker_spin_iterations : 0;
+  for (int i = 0;; ++i) {
+    if (queue_.pop(entry)) {
+      // Become active before the entry leaves the queue size, so Wait() never sees both at zero
+      // while the entry is pending.
+      active_threads_.fetch_add(1, std::memory_order_seq_cst);
+      queue_size_.fetch_sub(1, std::memory_order_seq_cst);
+      return entry;
     }
-
-    if (queue_.empty()) {
-      if (permanent) {
-        not_empty_.Wait();
-      } else {
-        if (!not_empty_.TimedWait(idle_timeout_)) {
-          // After much investigation, it appears that pthread condition variables have
-          // a weird behavior in which they can return ETIMEDOUT from timed_wait even if
-          // another thread did in fact signal. Apparently after a timeout there is some
-          // brief period during which another thread may actually grab the internal mutex
-          // protecting the state, signal, and release again before we get the mutex. So,
-          // we'll recheck the empty queue case regardless.
-          if (queue_.empty()) {
-            VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
-                    << idle_timeout_.ToMilliseconds() << "ms of idle time.";
-            break;
-          }
-        }
-      }
-      continue;
+    if (i >= spin_iterations || shutting_down_.load(std::memory_order_relaxed)) {
+      return nullptr;
     }
+    PauseCPU();
+  }
+}
 
-    // Fetch a pending task
-    QueueEntry entry = queue_.front();
-    queue_.pop_front();
-    queue_size_--;
-    ++active_threads_;
-
-    unique_lock.Unlock();
-
-    // Update metrics
-    if (queue_time_us_histogram_) {
-      MonoTime now(MonoTime::Now(MonoTime::FINE));
-      queue_time_us_histogram_->Increment(now.GetDeltaSince(entry.submit_time).ToMicroseconds());
-    }
+void ThreadPool::RunEntry(QueueEntry* entry) {
+  // Update metrics
+  int64_t start_cycles = 0;
+  if (queue_time_us_histogram_ || run_time_us_histogram_) {
+    start_cycles = CycleClock::Now();
+  }
+  if (queue_time_us_histogram_) {
+    queue_time_us_histogram_->Increment(
+        (start_cycles - entry->submit_cycles) * MicrosPerCycle());
+  }
 
-    ADOPT_TRACE(entry.trace);
+  {
+    ADOPT_TRACE(entry->trace);
     // Release the reference which was held by the queued item.
-    if (entry.trace) {
-      entry.trace->Release();
+    if (entry->trace) {
+      entry->trace->Release();
     }
     // Execute the task
-    {
-      ScopedLatencyMetric m(run_time_us_histogram_.get());
-      entry.runnable->Run();
-    }
-    unique_lock.Lock();
+    entry->runnable->Run();
+  }
+  delete entry;
 
-    if (--active_threads_ == 0) {
-      idle_cond_.Broadcast();
-    }
+  if (run_time_us_histogram_) {
+    run_time_us_histogram_->Increment((CycleClock::Now() - start_cycles) * MicrosPerCycle());
   }
 
-  // It's important that we hold the lock between exiting the loop and dropping
-  // num_threads_. Otherwise it's possible someone else could come along here
-  // and add a new task just as the last running thread is about to exit.
-  CHECK(unique_lock.OwnsLock());
+  if (active_threads_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+      idle_waiters_.load(std::memory_order_seq_cst) > 0) {
+    MutexLock unique_lock(lock_);
+    idle_cond_.Broadcast();
+  }
+}
 
-  if (--num_threads_ == 0) {
-    no_threads_cond_.Broadcast();
+void ThreadPool::DispatchThread(bool permanent) {
+  bool spin = true;
+  for (;;) {
+    QueueEntry* entry = PopEntry(spin);
+    if (entry) {
+      RunEntry(entry);
+      spin = true;
+      continue;
+    }
+
+    MutexLock unique_lock(lock_);
+    // Note: STATUS(Aborted, ) is used to indicate normal shutdown.
+    if (!pool_status_.ok()) {
+      VLOG(2) << "DispatchThread exiting: " << pool_status_.ToString();
+      // It's important that we hold the lock while dropping num_threads_, since Shutdown() waits
+      // for it under the lock.
+      if (--num_threads_ == 0) {
+        no_threads_cond_.Broadcast();
+
+        // Sanity check: if we're the last thread exiting, the queue ought to be
+        // empty. Otherwise it will never get processed.
+        CHECK_EQ(0, queue_size_.load());
+      }
+      return;
+    }
 
-    // Sanity check: if we're the last thread exiting, the queue ought to be
-    // empty. Otherwise it will never get processed.
-    CHECK(queue_.empty());
-    DCHECK_EQ(0, queue_size_);
+    // Announce that we are about to park, then check the queue again. A submitter either sees us
+    // parked and signals under the lock, or we see its entry here.
+    parked_threads_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    entry = PopEntry(false);
+    if (entry) {
+      parked_threads_.fetch_sub(1, std::memory_order_seq_cst);
+      unique_lock.Unlock();
+      RunEntry(entry);
+      spin = true;
+      continue;
+    }
+
+    bool timed_out = false;
+    if (permanent) {
+      not_empty_.Wait();
+    } else {
+      timed_out = !not_empty_.TimedWait(idle_timeout_);
+    }
+    parked_threads_.fetch_sub(1, std::memory_order_seq_cst);
+    // Parked threads were woken up for a task, do not spin if it was taken by someone else.
+    spin = false;
+
+    if (timed_out) {
+      // After much investigation, it appears that pthread condition variables have
+      // a weird behavior in which they can return ETIMEDOUT from timed_wait even if
+      // another thread did in fact signal. Apparently after a timeout there is some
+      // brief period during which another thread may actually grab the internal mutex
+      // protecting the state, signal, and release again before we get the mutex. So,
+      // we'll recheck the empty queue case regardless.
+      //
+      // The thread is removed from num_threads_ before checking the queue, so a concurrent
+      // Submit() either sees that the thread is gone and creates another one, or its entry is
+      // seen here.
+      --num_threads_;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (queue_size_.load(std::memory_order_seq_cst) == 0) {
+        VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
+                << idle_timeout_.ToMilliseconds() << "ms of idle time.";
+        if (num_threads_ == 0) {
+          no_threads_cond_.Broadcast();
+        }
+        return;
+      }
+      ++num_threads_;
+    }
   }
 }
 
@@ -32,12 +32,13 @@
 #ifndef YB_UTIL_THREAD_POOL_H
 #define YB_UTIL_THREAD_POOL_H
 
+#include <atomic>
 #include <functional>
-#include <list>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <boost/lockfree/queue.hpp>
 #include <gtest/gtest_prod.h>
 
 #include "yb/gutil/callback_forward.h"
@@ -119,6 +120,10 @@ class ThreadPoolBuilder {
 // The pool can execute a class that implements the Runnable interface, or a
 // std::function, which can be obtained via std::bind().
 //
+// Tasks are submitted to a lock-free queue. A worker that runs out of tasks spins on the queue
+// for --thread_pool_worker_spin_iterations before parking on a condition variable, so tasks
+// submitted to a busy pool are handed off without taking the pool lock.
+//
 // Usage Example:
 //    static void Func(int n) { ... }
 //    class Task : public Runnable { ... }
@@ -169,7 +174,7 @@ class ThreadPool {
   // Return the current number of tasks waiting in the queue.
   // Typically used for metrics.
   int queue_length() const {
-    return ANNOTATE_UNPROTECTED_READ(queue_size_);
+    return queue_size_.load(std::memory_order_relaxed);
   }
 
   // Attach a histogram which measures the queue length seen by tasks when they enter
@@ -198,6 +203,15 @@ class ThreadPool {
   // Dispatcher responsible for dequeueing and executing the tasks
   void DispatchThread(bool permanent);
 
+  struct QueueEntry;
+
+  // Takes an entry from the queue, spinning for a while if 'spin' is true and the queue is empty.
+  // Marks the calling thread as active if an entry was taken.
+  QueueEntry* PopEntry(bool spin);
+
+  // Executes the entry, updates metrics and deletes the entry.
+  void RunEntry(QueueEntry* entry);
+
   // Create new thread. Required that lock_ is held.
   CHECKED_STATUS CreateThreadUnlocked();
 
@@ -209,8 +223,8 @@ class ThreadPool {
     std::shared_ptr<Runnable> runnable;
     Trace* trace;
 
-    // Time at which the entry was submitted to the pool.
-    MonoTime submit_time;
+    // CycleClock time at which the entry was submitted to the pool, if the queue time is measured.
+    int64_t submit_cycles;
   };
 
   const std::string name_;
@@ -224,10 +238,26 @@ class ThreadPool {
   ConditionVariable idle_cond_;
   ConditionVariable no_threads_cond_;
   ConditionVariable not_empty_;
-  int num_threads_;
-  int active_threads_;
-  int queue_size_;
-  std::list<QueueEntry> queue_;
+
+  // Changed with lock_ held, but read without it.
+  std::atomic<int> num_threads_{0};
+  std::atomic<int> active_threads_{0};
+
+  // Number of entries submitted and not yet taken by a worker.
+  std::atomic<int> queue_size_{0};
+  boost::lockfree::queue<QueueEntry*> queue_;
+
+  // Number of workers waiting on not_empty_. Submit() signals it only if there are such workers.
+  std::atomic<int> parked_threads_{0};
+
+  // Number of threads waiting on idle_cond_.
+  std::atomic<int> idle_waiters_{0};
+
+  // Submit() calls in progress. Shutdown() waits for them before clearing the queue.
+  std::atomic<int> submitting_{0};
+  // Set until the pool is initialized and after it is shut down. Submit() rejects tasks with
+  // pool_status_ while it is set.
+  std::atomic<bool> shutting_down_{true};
 
   scoped_refptr<Histogram> queue_length_histogram_;
   scoped_refptr<Histogram> queue_time_us_histogram_;
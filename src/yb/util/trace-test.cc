@@ -44,6 +44,9 @@
 #include "yb/util/stopwatch.h"
 #include "yb/util/test_util.h"
 
+DECLARE_bool(enable_tracing);
+DECLARE_int32(sampled_trace_1_in_n);
+
 using yb::debug::TraceLog;
 using yb::debug::TraceResultBuffer;
 using yb::debug::CategoryFilter;
@@ -121,6 +124,45 @@ TEST_F(TraceTest, TestChildTrace) {
             XOutDigits(traceA->DumpToString(false)));
 }
 
+TEST_F(TraceTest, TestSampledTrace) {
+  FLAGS_enable_tracing = false;
+  FLAGS_sampled_trace_1_in_n = 4;
+
+  int num_sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    if (Trace::ShouldSample()) {
+      ++num_sampled;
+    }
+  }
+  ASSERT_EQ(25, num_sampled);
+
+  scoped_refptr<Trace> unsampled(new Trace);
+  scoped_refptr<Trace> sampled(new Trace);
+  scoped_refptr<Trace> child(new Trace);
+  sampled->set_sampled();
+  {
+    ADOPT_TRACE(unsampled.get());
+    ASSERT_TRUE(Trace::CurrentTrace() == nullptr);
+    TRACE("this goes nowhere");
+  }
+  {
+    ADOPT_TRACE(sampled.get());
+    ASSERT_EQ(sampled.get(), Trace::CurrentTrace());
+    TRACE("hello from sampled");
+    // Traces attached to a sampled trace are sampled as well.
+    Trace::CurrentTrace()->AddChildTrace(child.get());
+    ASSERT_TRUE(child->sampled());
+    TRACE_TO(child, "hello from child");
+  }
+  TRACE_TO(unsampled, "this goes nowhere");
+
+  ASSERT_EQ("", unsampled->DumpToString(false));
+  ASSERT_EQ("XXXX XX:XX:XX.XXXXXX trace-test.cc:XXX] hello from sampled\n"
+            "Related trace:\n"
+            "XXXX XX:XX:XX.XXXXXX trace-test.cc:XXX] hello from child\n",
+            XOutDigits(sampled->DumpToString(false)));
+}
+
 static void GenerateTraceEvents(int thread_id,
                                 int num_events) {
   for (int i = 0; i < num_events; i++) {
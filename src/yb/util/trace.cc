@@ -45,11 +45,23 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/walltime.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/memory/arena.h"
 #include "yb/util/memory/memory.h"
 
 DEFINE_bool(enable_tracing, false, "Flag to enable/disable tracing across the code.");
 
+DEFINE_int32(sampled_trace_1_in_n, 1000,
+             "When --enable_tracing is off, trace 1 in this many requests. The sampled traces "
+             "are propagated to the servers called while handling the request. 0 disables "
+             "sampling.");
+TAG_FLAG(sampled_trace_1_in_n, advanced);
+TAG_FLAG(sampled_trace_1_in_n, runtime);
+
+DEFINE_int32(trace_arena_pool_size, 128,
+             "Number of trace buffers kept for reuse by later traces.");
+TAG_FLAG(trace_arena_pool_size, advanced);
+
 namespace yb {
 
 using strings::internal::SubstituteArg;
@@ -149,6 +161,49 @@ void InitGetCurrentMicrosFast() {
   initial_micros_offset -= mid;
 }
 
+// Trace buffers are taken from this pool and returned to it when the trace is destroyed, so
+// sampled tracing does not allocate in the steady state.
+class TraceArenaPool {
+ public:
+  ThreadSafeArena* Take() {
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (!arenas_.empty()) {
+        auto* arena = arenas_.back();
+        arenas_.pop_back();
+        return arena;
+      }
+    }
+    return new ThreadSafeArena(kInitialArenaSize, kMaxArenaSize);
+  }
+
+  void Return(ThreadSafeArena* arena) {
+    // Don't keep the buffers of unusually large traces.
+    if (arena->memory_footprint() <= kMaxPooledArenaSize) {
+      arena->Reset();
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (arenas_.size() < static_cast<size_t>(FLAGS_trace_arena_pool_size)) {
+        arenas_.push_back(arena);
+        return;
+      }
+    }
+    delete arena;
+  }
+
+ private:
+  static constexpr size_t kInitialArenaSize = 1024;
+  static constexpr size_t kMaxArenaSize = 128 * 1024;
+  static constexpr size_t kMaxPooledArenaSize = 16 * 1024;
+
+  simple_spinlock lock_;
+  std::vector<ThreadSafeArena*> arenas_;
+};
+
+TraceArenaPool& arena_pool() {
+  static TraceArenaPool* pool = new TraceArenaPool;
+  return *pool;
+}
+
 int64_t GetCurrentMicrosFast() {
   std::call_once(init_get_current_micros_fast_flag, InitGetCurrentMicrosFast);
   auto now = MonoTime::FineNow();
@@ -158,7 +213,8 @@ int64_t GetCurrentMicrosFast() {
 } // namespace
 
 ScopedAdoptTrace::ScopedAdoptTrace(Trace* t)
-    : old_trace_(Trace::threadlocal_trace_), trace_(t), is_enabled_(FLAGS_enable_tracing) {
+    : old_trace_(Trace::threadlocal_trace_), trace_(t),
+      is_enabled_(FLAGS_enable_tracing || (t && t->sampled())) {
   if (is_enabled_) {
     CHECK(!t || !t->HasOneRef());
     Trace::threadlocal_trace_ = t;
@@ -208,17 +264,26 @@ Trace::Trace()
 Trace::~Trace() {
   auto* arena = arena_.load(std::memory_order_acquire);
   if (arena) {
-    delete arena;
+    arena_pool().Return(arena);
   }
 }
 
+bool Trace::ShouldSample() {
+  const int32_t one_in_n = FLAGS_sampled_trace_1_in_n;
+  if (one_in_n <= 0) {
+    return false;
+  }
+  static __thread uint32_t num_calls = 0;
+  return ++num_calls % one_in_n == 0;
+}
+
 ThreadSafeArena* Trace::GetAndInitArena() {
   auto* arena = arena_.load(std::memory_order_acquire);
   if (arena == nullptr) {
     std::lock_guard<simple_spinlock> l(lock_);
     arena = arena_.load(std::memory_order_relaxed);
     if (arena == nullptr) {
-      arena = new ThreadSafeArena(1024, 128 * 1024);
+      arena = arena_pool().Take();
       arena_.store(arena, std::memory_order_release);
     }
   }
@@ -329,6 +394,9 @@ void Trace::DumpCurrentTrace() {
 
 void Trace::AddChildTrace(Trace* child_trace) {
   CHECK_NOTNULL(child_trace);
+  if (sampled()) {
+    child_trace->set_sampled();
+  }
   {
     std::lock_guard<simple_spinlock> l(lock_);
     scoped_refptr<Trace> ptr(child_trace);
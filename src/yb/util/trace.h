@@ -61,21 +61,21 @@ DECLARE_bool(enable_tracing);
 // See Trace::SubstituteAndTrace for arguments.
 // Example:
 //  TRACE("Acquired timestamp $0", timestamp);
+// Traces are collected when --enable_tracing is set, or for the sampled requests (see
+// Trace::set_sampled()). ScopedAdoptTrace only installs a trace that is collected, so the
+// current trace is always enabled.
 #define TRACE(format, substitutions...) \
   do { \
-    if (FLAGS_enable_tracing) { \
-      yb::Trace* _trace = Trace::CurrentTrace(); \
-      if (_trace) { \
-        _trace->SubstituteAndTrace(__FILE__, __LINE__, (format),  \
-          ##substitutions); \
-      } \
+    yb::Trace* _trace = Trace::CurrentTrace(); \
+    if (_trace) { \
+      _trace->SubstituteAndTrace(__FILE__, __LINE__, (format),  \
+        ##substitutions); \
     } \
   } while (0)
 
-// Like the above, but takes the trace pointer as an explicit argument.
 #define TRACE_TO(trace, format, substitutions...) \
   do { \
-    if (FLAGS_enable_tracing) { \
+    if ((trace)->enabled()) { \
       (trace)->SubstituteAndTrace(__FILE__, __LINE__, (format), ##substitutions); \
     } \
   } while (0)
@@ -143,8 +143,27 @@ class Trace : public RefCountedThreadSafe<Trace> {
   std::string DumpToString(bool include_time_deltas) const;
 
   // Attaches the given trace which will get appended at the end when Dumping.
+  // The child is sampled if this trace is sampled.
   void AddChildTrace(Trace* child_trace);
 
+  // Marks this trace to be collected even if --enable_tracing is off.
+  void set_sampled() {
+    sampled_.store(true, std::memory_order_release);
+  }
+
+  bool sampled() const {
+    return sampled_.load(std::memory_order_acquire);
+  }
+
+  // Returns true if entries added to this trace are collected.
+  bool enabled() const {
+    return FLAGS_enable_tracing || sampled();
+  }
+
+  // Returns true for 1 in --sampled_trace_1_in_n calls made by the current thread. Used to
+  // pick the requests that are traced when --enable_tracing is off.
+  static bool ShouldSample();
+
   // Return the current trace attached to this thread, if there is one.
   static Trace* CurrentTrace() {
     return threadlocal_trace_;
@@ -176,6 +195,8 @@ class Trace : public RefCountedThreadSafe<Trace> {
 
   std::atomic<ThreadSafeArena*> arena_ = {nullptr};
 
+  std::atomic<bool> sampled_ = {false};
+
   // Lock protecting the entries linked list.
   mutable simple_spinlock lock_;
   // The head of the linked list of entries (allocated inside arena_)
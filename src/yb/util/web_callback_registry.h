@@ -72,11 +72,14 @@ class WebCallbackRegistry {
   // printed in the navigation bar at the top of each debug page. Otherwise the
   // link does not appear, and the page is rendered without HTML headers and
   // footers.
-  // The first registration's choice of is_styled overrides all
+  // If is_expensive is true, rendering the page takes noticeable time or resources, e.g. it
+  // iterates over all tablets, and the number of such pages rendered at the same time is limited.
+  // The first registration's choice of is_styled and is_expensive overrides all
   // subsequent registrations for that URL.
   virtual void RegisterPathHandler(const std::string& path, const std::string& alias,
                                    const PathHandlerCallback& callback,
-                                   bool is_styled = true, bool is_on_nav_bar = true) = 0;
+                                   bool is_styled = true, bool is_on_nav_bar = true,
+                                   bool is_expensive = false) = 0;
 };
 
 } // namespace yb
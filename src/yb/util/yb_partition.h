@@ -39,9 +39,15 @@ class YBPartition {
     return cql_hash;
   }
 
+  // Returns the token of the node at the given index when the hash space is split evenly among
+  // node_count nodes the same way PartitionSchema::CreatePartitions() splits it among tablets.
+  // A node owns the tokens up to and including its own token, so the token returned is the
+  // largest CQL token that hashes to the last hash code of the node's range.
   static string CqlTokenSplit(size_t node_count, size_t index) {
-    uint64 hash_code = (UINT16_MAX / node_count * index) << 48;
-    int64_t cql_hash_code = static_cast<int64_t>(hash_code);
+    const uint16_t interval = kMaxHashCode / node_count;
+    const uint16_t last_hash_code =
+        index + 1 < node_count ? (index + 1) * interval - 1 : kMaxHashCode;
+    const int64_t cql_hash_code = YBToCqlHashCode(last_hash_code) | ((1LL << 48) - 1);
     return std::to_string(cql_hash_code);
   }
 